@@ -12,6 +12,8 @@
  */
 #include <ctype.h>
 #include <getopt.h>
+#include <math.h>
+#include <pthread.h>
 #include <stdarg.h>
 #include <unistd.h>
 #include "arrow_ipc.h"
@@ -30,6 +32,7 @@ typedef struct arrowColumn
 	ArrowType	arrow_type;
 	const char *colname;
 	const char *sqltype;
+	const char *json_key;		/* "colname": */
 	bool	  (*print_datum)(ARROW_PRINT_DATUM_ARGS);
 	bool		nullable;
 	int			buffer_index;
@@ -48,7 +51,9 @@ static const char  *output_filename = NULL;
 static FILE		   *output_filp = NULL;
 static bool			print_header = false;
 static char			csv_delimiter = ',';
-static char			current_context = 'n';
+static bool			json_output = false;		/* --format=ndjson */
+static int			num_dump_threads = 1;		/* --parallel */
+static __thread char current_context = 'n';
 static int64_t		num_skip_rows = -1;			/* --offset */
 static int64_t		num_dump_rows = -1;			/* --limit */
 static const char  *create_table_name = NULL;	/* --create-table */
@@ -65,6 +70,10 @@ usage(void)
 		  "  --header       dump column names as csv header\n"
 		  "  --offset NUM   skip first NUM rows\n"
 		  "  --limit NUM    dump only NUM rows\n"
+		  "  --format=FORMAT output format; 'csv' or 'ndjson'\n"
+		  "                 (default: csv)\n"
+		  "  -n|--parallel=N number of threads to format the rows\n"
+		  "                 (default: 1)\n"
 		  "\n"
 		  "  --create-table=TABLE_NAME  dump with CREATE TABLE statement\n"
 		  "  --tablespace=TABLESPACE    specify tablespace of the table, if any\n"
@@ -142,12 +151,201 @@ quote_ident(const char *ident)
 	return ident;
 }
 
+/*
+ * Output buffer of the current thread
+ *
+ * Datum is formatted into the buffer, then written out to the output file
+ * at once for each task (a range of rows in a record batch).
+ */
+static __thread SQLbuffer *output_buf = NULL;
+
+static inline void
+__put_char(int c)
+{
+	SQLbuffer  *buf = output_buf;
+
+	if (buf->usage >= buf->length)
+		sql_buffer_expand(buf, buf->usage + 1);
+	buf->data[buf->usage++] = c;
+}
+
+static inline void
+__put_bytes(const char *addr, size_t sz)
+{
+	sql_buffer_append(output_buf, addr, sz);
+}
+
+static inline void
+__put_str(const char *str)
+{
+	__put_bytes(str, strlen(str));
+}
+
+static inline void
+__put_uint64(uint64_t value)
+{
+	char	buf[32];
+	char   *pos = buf + sizeof(buf);
+
+	do {
+		*--pos = '0' + (value % 10);
+		value /= 10;
+	} while (value != 0);
+	__put_bytes(pos, buf + sizeof(buf) - pos);
+}
+
+static inline void
+__put_int64(int64_t value)
+{
+	if (value >= 0)
+		__put_uint64(value);
+	else
+	{
+		__put_char('-');
+		__put_uint64(-((uint64_t)value));
+	}
+}
+
+/* zero-padded digits, but never truncated */
+static inline void
+__put_digits(uint64_t value, int width)
+{
+	char	buf[32];
+	int		i;
+
+	assert(width < sizeof(buf));
+	for (i=width-1; i >= 0; i--)
+	{
+		buf[i] = '0' + (value % 10);
+		value /= 10;
+	}
+	__put_bytes(buf, width);
+	if (value != 0)
+		Elog("Bug? value overflow at __put_digits");
+}
+
+static inline void
+__put_digits_min(uint64_t value, int width)
+{
+	uint64_t	limit = 1;
+	int			i;
+
+	for (i=0; i < width; i++)
+		limit *= 10;
+	if (value < limit)
+		__put_digits(value, width);
+	else
+		__put_uint64(value);
+}
+
+static inline void
+__put_hex(const unsigned char *addr, size_t sz)
+{
+	static const char hextbl[] = "0123456789abcdef";
+	SQLbuffer  *buf = output_buf;
+	char	   *pos;
+	size_t		i;
+
+	sql_buffer_expand(buf, buf->usage + 2 * sz);
+	pos = buf->data + buf->usage;
+	for (i=0; i < sz; i++)
+	{
+		int		c = addr[i];
+
+		*pos++ = hextbl[(c >> 4) & 0x0f];
+		*pos++ = hextbl[(c & 0x0f)];
+	}
+	buf->usage += 2 * sz;
+}
+
+/* YYYY-MM-DD, like "%04d-%02d-%02d" */
+static inline void
+__put_ymd(int64_t year, uint32_t mon, uint32_t day)
+{
+	if (year < 0)
+	{
+		__put_char('-');
+		year = -year;
+	}
+	__put_digits_min(year, 4);
+	__put_char('-');
+	__put_digits(mon, 2);
+	__put_char('-');
+	__put_digits(day, 2);
+}
+
+/* HH:MI:SS, like "%02d:%02d:%02d" */
+static inline void
+__put_hms(uint64_t hour, uint32_t min, uint32_t sec)
+{
+	__put_digits_min(hour, 2);
+	__put_char(':');
+	__put_digits(min, 2);
+	__put_char(':');
+	__put_digits(sec, 2);
+}
+
+/*
+ * __put_date - days from the UNIX epoch, without gmtime_r(3)
+ *
+ * see http://howardhinnant.github.io/date_algorithms.html#civil_from_days
+ */
+static inline void
+__put_date(int64_t days)
+{
+	int64_t		z = days + 719468;
+	int64_t		era = (z >= 0 ? z : z - 146096) / 146097;
+	uint32_t	doe = (uint32_t)(z - era * 146097);
+	uint32_t	yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+	uint32_t	doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+	uint32_t	mp = (5 * doy + 2) / 153;
+	uint32_t	day = doy - (153 * mp + 2) / 5 + 1;
+	uint32_t	mon = (mp < 10 ? mp + 3 : mp - 9);
+	int64_t		year = (int64_t)yoe + era * 400 + (mon <= 2 ? 1 : 0);
+
+	__put_ymd(year, mon, day);
+}
+
+static void
+__put_json_string(const char *addr, size_t sz)
+{
+	static const char hextbl[] = "0123456789abcdef";
+	const char *tail = addr + sz;
+	const char *pos;
+
+	__put_char('"');
+	for (pos = addr; pos < tail; pos++)
+	{
+		int		c = (unsigned char)*pos;
+
+		if (c >= 0x20 && c != '"' && c != '\\')
+			continue;
+		__put_bytes(addr, pos - addr);
+		addr = pos + 1;
+		switch (c)
+		{
+			case '"':  __put_str("\\\""); break;
+			case '\\': __put_str("\\\\"); break;
+			case '\n': __put_str("\\n");  break;
+			case '\r': __put_str("\\r");  break;
+			case '\t': __put_str("\\t");  break;
+			default:
+				__put_str("\\u00");
+				__put_char(hextbl[(c >> 4) & 0x0f]);
+				__put_char(hextbl[(c & 0x0f)]);
+				break;
+		}
+	}
+	__put_bytes(addr, tail - addr);
+	__put_char('"');
+}
+
 static void
 printNullDatum(void)
 {
-	/* print "null" only if List elements */
-	if (current_context == 'e')
-		fprintf(output_filp, "null");
+	/* print "null" only if List elements or JSON */
+	if (current_context == 'e' || json_output)
+		__put_str("null");
 }
 
 static void
@@ -251,7 +449,7 @@ static bool
 print_arrow_int8(ARROW_PRINT_DATUM_ARGS)
 {
 	ARROW_PRINT_DATUM_SETUP_INLINE(int8_t);
-	fprintf(output_filp, "%d", (int)datum);
+	__put_int64(datum);
 	return true;
 }
 
@@ -259,7 +457,7 @@ static bool
 print_arrow_uint8(ARROW_PRINT_DATUM_ARGS)
 {
 	ARROW_PRINT_DATUM_SETUP_INLINE(uint8_t);
-	fprintf(output_filp, "%u", (unsigned int)datum);
+	__put_uint64(datum);
 	return true;
 }
 
@@ -267,15 +465,15 @@ static bool
 print_arrow_int16(ARROW_PRINT_DATUM_ARGS)
 {
 	ARROW_PRINT_DATUM_SETUP_INLINE(int16_t);
-	fprintf(output_filp, "%d", (int)datum);
+	__put_int64(datum);
 	return true;
 }
 
 static bool
 print_arrow_uint16(ARROW_PRINT_DATUM_ARGS)
 {
-	ARROW_PRINT_DATUM_SETUP_INLINE(int16_t);
-	fprintf(output_filp, "%u", (unsigned int)datum);
+	ARROW_PRINT_DATUM_SETUP_INLINE(uint16_t);
+	__put_uint64(datum);
 	return true;
 }
 
@@ -283,7 +481,7 @@ static bool
 print_arrow_int32(ARROW_PRINT_DATUM_ARGS)
 {
 	ARROW_PRINT_DATUM_SETUP_INLINE(int32_t);
-	fprintf(output_filp, "%d", datum);
+	__put_int64(datum);
 	return true;
 }
 
@@ -291,7 +489,7 @@ static bool
 print_arrow_uint32(ARROW_PRINT_DATUM_ARGS)
 {
 	ARROW_PRINT_DATUM_SETUP_INLINE(uint32_t);
-	fprintf(output_filp, "%u", datum);
+	__put_uint64(datum);
 	return true;
 }
 
@@ -299,7 +497,7 @@ static bool
 print_arrow_int64(ARROW_PRINT_DATUM_ARGS)
 {
 	ARROW_PRINT_DATUM_SETUP_INLINE(int64_t);
-	fprintf(output_filp, "%ld", datum);
+	__put_int64(datum);
 	return true;
 }
 
@@ -307,7 +505,17 @@ static bool
 print_arrow_uint64(ARROW_PRINT_DATUM_ARGS)
 {
 	ARROW_PRINT_DATUM_SETUP_INLINE(uint64_t);
-	fprintf(output_filp, "%lu", datum);
+	__put_uint64(datum);
+	return true;
+}
+
+static bool
+__print_arrow_float_common(double datum)
+{
+	/* JSON has no representation for NaN and Infinity */
+	if (json_output && !isfinite(datum))
+		return false;
+	sql_buffer_printf(output_buf, "%f", datum);
 	return true;
 }
 
@@ -315,41 +523,43 @@ static bool
 print_arrow_float2(ARROW_PRINT_DATUM_ARGS)
 {
 	ARROW_PRINT_DATUM_SETUP_INLINE(uint16_t);
-	fprintf(output_filp, "%f", fp16_to_fp64(datum));
-	return true;
+	return __print_arrow_float_common(fp16_to_fp64(datum));
 }
 
 static bool
 print_arrow_float4(ARROW_PRINT_DATUM_ARGS)
 {
 	ARROW_PRINT_DATUM_SETUP_INLINE(float);
-	fprintf(output_filp, "%f", (double)datum);
-	return true;
+	return __print_arrow_float_common((double)datum);
 }
 
 static bool
 print_arrow_float8(ARROW_PRINT_DATUM_ARGS)
 {
 	ARROW_PRINT_DATUM_SETUP_INLINE(double);
-	fprintf(output_filp, "%f", datum);
-	return true;
+	return __print_arrow_float_common(datum);
 }
 
 static bool
 __print_arrow_utf8_common(const char *addr, size_t sz, const char *quote)
 {
-	size_t	i;
+	const char *tail = addr + sz;
+	const char *pos;
 
-	fprintf(output_filp, "%s", quote);
-	for (i=0; i < sz; i++)
+	if (json_output)
 	{
-		int		c = (unsigned char)addr[i];
-
-		if (c == '"')
-			fputc('"', output_filp);
-		fputc(c, output_filp);
+		__put_json_string(addr, sz);
+		return true;
+	}
+	__put_str(quote);
+	while ((pos = memchr(addr, '"', tail - addr)) != NULL)
+	{
+		__put_bytes(addr, pos - addr + 1);
+		__put_char('"');
+		addr = pos + 1;
 	}
-	fprintf(output_filp, "%s", quote);
+	__put_bytes(addr, tail - addr);
+	__put_str(quote);
 	return true;
 }
 
@@ -380,18 +590,11 @@ print_arrow_large_utf8(ARROW_PRINT_DATUM_ARGS)
 static bool
 __print_arrow_binary_common(const char *addr, size_t sz, const char *quote)
 {
-	static const char hextbl[] = "0123456789abcdef";
-	size_t	i;
-
-	fprintf(output_filp, "%s\\x", quote);
-	for (i=0; i < sz; i++)
-	{
-		int		c = (unsigned char)addr[i];
-
-		fputc(hextbl[(c >> 4) & 0x0f], output_filp);
-		fputc(hextbl[(c & 0x0f)], output_filp);
-	}
-	fprintf(output_filp, "%s", quote);
+	__put_str(quote);
+	/* backslash must be escaped in JSON string */
+	__put_str(json_output ? "\\\\x" : "\\x");
+	__put_hex((const unsigned char *)addr, sz);
+	__put_str(quote);
 	return true;
 }
 
@@ -422,7 +625,7 @@ print_arrow_large_binary(ARROW_PRINT_DATUM_ARGS)
 static bool
 print_arrow_bool(ARROW_PRINT_DATUM_ARGS)
 {
-	int64_t		k = (index << 3);
+	int64_t		k = (index >> 3);
 	int32_t		mask = (1 << (index & 7));
 	const char *bitmap = rb_chunk + buffers[1].offset;
 
@@ -430,9 +633,9 @@ print_arrow_bool(ARROW_PRINT_DATUM_ARGS)
 		return false;
 
 	if ((bitmap[k] & mask) != 0)
-		fprintf(output_filp, "true");
+		__put_str("true");
 	else
-		fprintf(output_filp, "false");
+		__put_str("false");
 	return true;
 }
 
@@ -449,12 +652,12 @@ print_arrow_decimal128(ARROW_PRINT_DATUM_ARGS)
 	/* zero handling */
 	if (datum == 0)
 	{
-		fputc('0', output_filp);
+		__put_char('0');
 		if (scale > 0)
 		{
-			fputc('.', output_filp);
+			__put_char('.');
 			while (scale-- > 0)
-				fputc('0', output_filp);
+				__put_char('0');
 		}
 		return true;
 	}
@@ -501,251 +704,179 @@ print_arrow_decimal128(ARROW_PRINT_DATUM_ARGS)
 
 	if (negative)
 		*--pos = '-';
-	fprintf(output_filp, "%s", pos);
+	__put_str(pos);
 	return true;
 }
 
 static bool
 print_arrow_date_day(ARROW_PRINT_DATUM_ARGS)
 {
-	time_t		t;
-	struct tm	tm;
-	ARROW_PRINT_DATUM_SETUP_INLINE(uint32_t);
-	/* to seconds from the epoch */
-	t = (time_t)datum * 86400LL;
-	gmtime_r(&t, &tm);
-	fprintf(output_filp, "%s%04d-%02d-%02d%s",
-			quote,
-			tm.tm_year + 1900,
-			tm.tm_mon + 1,
-			tm.tm_mday,
-			quote);
+	ARROW_PRINT_DATUM_SETUP_INLINE(int32_t);
+
+	__put_str(quote);
+	__put_date(datum);
+	__put_str(quote);
 	return true;
 }
 
 static bool
-print_arrow_date_ms(ARROW_PRINT_DATUM_ARGS)
+__assign_timestamp_timezone(ArrowTypeTimestamp *timestamp)
 {
-	time_t		t;
-	struct tm	tm;
-	uint32_t	msec;
-	ARROW_PRINT_DATUM_SETUP_INLINE(uint64_t);
+	static const char  *current_tz_name = NULL;
 
-	msec = datum % 1000;
-	t = datum / 1000;
-	gmtime_r(&t, &tm);
-	fprintf(output_filp, "%s%04d-%02d-%02d %02d:%02d:%02d.%03d%s",
-			quote,
-			tm.tm_year + 1900,
-			tm.tm_mon + 1,
-			tm.tm_mday,
-			tm.tm_hour,
-			tm.tm_min,
-			tm.tm_sec,
-			msec,
-			quote);
+	if (!timestamp || !timestamp->timezone)
+		return false;
+	if (!current_tz_name || strcmp(current_tz_name, timestamp->timezone) != 0)
+	{
+		if (setenv("TZ", timestamp->timezone, 1) != 0)
+			Elog("failed on setenv('TZ'): %m");
+        current_tz_name = timestamp->timezone;
+	}
 	return true;
 }
 
+/*
+ * __print_timestamp_common
+ *
+ * 'datum' is elapsed time from the UNIX epoch in 'unitsz' per second,
+ * printed with 'ndigits' digits of the fraction.
+ */
+static void
+__print_timestamp_common(ArrowTypeTimestamp *timestamp,
+						 int64_t datum, int64_t unitsz, int ndigits,
+						 const char *quote)
+{
+	int64_t		sec = datum / unitsz;
+	int64_t		frac = datum % unitsz;
+
+	if (frac < 0)
+	{
+		frac += unitsz;
+		sec--;
+	}
+	__put_str(quote);
+	if (!__assign_timestamp_timezone(timestamp))
+	{
+		int64_t		days = sec / 86400;
+		int64_t		tod = sec % 86400;
+
+		if (tod < 0)
+		{
+			tod += 86400;
+			days--;
+		}
+		__put_date(days);
+		__put_char(' ');
+		__put_hms(tod / 3600, (tod / 60) % 60, tod % 60);
+	}
+	else
+	{
+		time_t		t = (time_t)sec;
+		struct tm	tm;
+
+		localtime_r(&t, &tm);
+		__put_ymd(tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday);
+		__put_char(' ');
+		__put_hms(tm.tm_hour, tm.tm_min, tm.tm_sec);
+	}
+	if (ndigits > 0)
+	{
+		__put_char('.');
+		__put_digits(frac, ndigits);
+	}
+	__put_str(quote);
+}
+
+static bool
+print_arrow_date_ms(ARROW_PRINT_DATUM_ARGS)
+{
+	ARROW_PRINT_DATUM_SETUP_INLINE(int64_t);
+	__print_timestamp_common(NULL, datum, 1000, 3, quote);
+	return true;
+}
+
+static void
+__print_time_common(uint64_t datum, uint64_t unitsz, int ndigits,
+					const char *quote)
+{
+	uint64_t	frac = datum % unitsz;
+	uint64_t	sec = datum / unitsz;
+
+	__put_str(quote);
+	__put_hms(sec / 3600, (sec / 60) % 60, sec % 60);
+	if (ndigits > 0)
+	{
+		__put_char('.');
+		__put_digits(frac, ndigits);
+	}
+	__put_str(quote);
+}
+
 static bool
 print_arrow_time_sec(ARROW_PRINT_DATUM_ARGS)
 {
-	uint32_t	min, sec;
 	ARROW_PRINT_DATUM_SETUP_INLINE(uint32_t);
-
-	sec = datum % 60;
-	datum /= 60;
-	min = datum % 60;
-	datum /= 60;
-	fprintf(output_filp, "%s%02u:%02u:%02u%s",
-			quote,
-			datum, min, sec,
-			quote);
+	__print_time_common(datum, 1, 0, quote);
 	return true;
 }
 
 static bool
 print_arrow_time_ms(ARROW_PRINT_DATUM_ARGS)
 {
-	uint32_t	min, sec, ms;
 	ARROW_PRINT_DATUM_SETUP_INLINE(uint32_t);
-
-	ms = datum % 1000;
-	datum /= 1000;
-	sec = datum % 60;
-	datum /= 60;
-	min = datum % 60;
-	datum /= 60;
-	fprintf(output_filp, "%s%02u:%02u:%02u.%03u%s",
-			quote,
-			datum, min, sec, ms,
-			quote);
+	__print_time_common(datum, 1000, 3, quote);
 	return true;
 }
 
 static bool
 print_arrow_time_us(ARROW_PRINT_DATUM_ARGS)
 {
-	uint32_t	min, sec, us;
 	ARROW_PRINT_DATUM_SETUP_INLINE(uint64_t);
-
-	us = datum % 1000000;
-	datum /= 1000000;
-	sec = datum % 60;
-	datum /= 60;
-	min = datum % 60;
-	datum /= 60;
-	fprintf(output_filp, "%s%02d:%02d:%02d.%06d%s",
-			quote,
-			(uint32_t)datum, min, sec, us,
-			quote);
+	__print_time_common(datum, 1000000, 6, quote);
 	return true;
 }
 
 static bool
 print_arrow_time_ns(ARROW_PRINT_DATUM_ARGS)
 {
-	uint32_t	min, sec, ns;
 	ARROW_PRINT_DATUM_SETUP_INLINE(uint64_t);
-
-	ns = datum % 1000000000;
-	datum /= 1000000000;
-	sec = datum % 60;
-	datum /= 60;
-	min = datum % 60;
-	datum /= 60;
-	fprintf(output_filp, "%s%02d:%02d:%02d.%09d%s",
-			quote,
-			(uint32_t)datum, min, sec, ns,
-			quote);
-	return true;
-}
-
-static bool
-__assign_timestamp_timezone(ArrowTypeTimestamp *timestamp)
-{
-	static const char  *current_tz_name = NULL;
-
-	if (!timestamp->timezone)
-		return false;
-	if (!current_tz_name || strcmp(current_tz_name, timestamp->timezone) != 0)
-	{
-		if (setenv("TZ", timestamp->timezone, 1) != 0)
-			Elog("failed on setenv('TZ'): %m");
-        current_tz_name = timestamp->timezone;
-	}
+	__print_time_common(datum, 1000000000, 9, quote);
 	return true;
 }
 
 static bool
 print_arrow_timestamp_sec(ARROW_PRINT_DATUM_ARGS)
 {
-	time_t		t;
-	struct tm	tm;
-	ARROW_PRINT_DATUM_SETUP_INLINE(uint64_t);
-
-	t = (time_t)datum;
-	if (!__assign_timestamp_timezone(&column->arrow_type.Timestamp))
-		gmtime_r(&t, &tm);
-	else
-		localtime_r(&t, &tm);
-	fprintf(output_filp,
-			"%s%04d-%02d-%02d %02d:%02d:%02d%s",
-			quote,
-			tm.tm_year + 1900,
-			tm.tm_mon + 1,
-			tm.tm_mday,
-			tm.tm_hour,
-			tm.tm_min,
-			tm.tm_sec,
-			quote);
+	ARROW_PRINT_DATUM_SETUP_INLINE(int64_t);
+	__print_timestamp_common(&column->arrow_type.Timestamp,
+							 datum, 1, 0, quote);
 	return true;
 }
 
 static bool
 print_arrow_timestamp_ms(ARROW_PRINT_DATUM_ARGS)
 {
-	time_t		t;
-	struct tm	tm;
-	uint32_t	ms;
-	ARROW_PRINT_DATUM_SETUP_INLINE(uint64_t);
-
-	ms = datum % 1000;
-	datum /= 1000;
-	t = (time_t)datum;
-	if (!__assign_timestamp_timezone(&column->arrow_type.Timestamp))
-		gmtime_r(&t, &tm);
-	else
-		localtime_r(&t, &tm);
-	fprintf(output_filp,
-			"%s%04d-%02d-%02d %02d:%02d:%02d.%03u%s",
-			quote,
-			tm.tm_year + 1900,
-			tm.tm_mon + 1,
-			tm.tm_mday,
-			tm.tm_hour,
-			tm.tm_min,
-			tm.tm_sec,
-			ms,
-			quote);
+	ARROW_PRINT_DATUM_SETUP_INLINE(int64_t);
+	__print_timestamp_common(&column->arrow_type.Timestamp,
+							 datum, 1000, 3, quote);
 	return true;
 }
 
 static bool
 print_arrow_timestamp_us(ARROW_PRINT_DATUM_ARGS)
 {
-	time_t		t;
-	struct tm	tm;
-	uint32_t	us;
-	ARROW_PRINT_DATUM_SETUP_INLINE(uint64_t);
-
-	us = datum % 1000000;
-	datum /= 1000000;
-	t = (time_t)datum;
-	if (!__assign_timestamp_timezone(&column->arrow_type.Timestamp))
-		gmtime_r(&t, &tm);
-	else
-		localtime_r(&t, &tm);
-	fprintf(output_filp,
-			"%s%04d-%02d-%02d %02d:%02d:%02d.%06u%s",
-			quote,
-			tm.tm_year + 1900,
-			tm.tm_mon + 1,
-			tm.tm_mday,
-			tm.tm_hour,
-			tm.tm_min,
-			tm.tm_sec,
-			us,
-			quote);
+	ARROW_PRINT_DATUM_SETUP_INLINE(int64_t);
+	__print_timestamp_common(&column->arrow_type.Timestamp,
+							 datum, 1000000, 6, quote);
 	return true;
 }
 
 static bool
 print_arrow_timestamp_ns(ARROW_PRINT_DATUM_ARGS)
 {
-	time_t		t;
-	struct tm	tm;
-	uint32_t	ns;
-	ARROW_PRINT_DATUM_SETUP_INLINE(uint64_t);
-
-	ns = datum % 1000000000;
-	datum /= 1000000000;
-	t = (time_t)datum;
-	if (!__assign_timestamp_timezone(&column->arrow_type.Timestamp))
-		gmtime_r(&t, &tm);
-	else
-		localtime_r(&t, &tm);
-	fprintf(output_filp,
-			"%s%04d-%02d-%02d %02d:%02d:%02d.%09u%s",
-			quote,
-			tm.tm_year + 1900,
-			tm.tm_mon + 1,
-			tm.tm_mday,
-			tm.tm_hour,
-			tm.tm_min,
-			tm.tm_sec,
-			ns,
-			quote);
+	ARROW_PRINT_DATUM_SETUP_INLINE(int64_t);
+	__print_timestamp_common(&column->arrow_type.Timestamp,
+							 datum, 1000000000, 9, quote);
 	return true;
 }
 
@@ -763,20 +894,20 @@ print_arrow_interval_ym(ARROW_PRINT_DATUM_ARGS)
 	}
 	year = datum / 12;
 	mon = datum % 12;
-	fprintf(output_filp, "%s", quote);
+	sql_buffer_printf(output_buf, "%s", quote);
 	if (year != 0 && mon != 0)
-		fprintf(output_filp, "%d %s %d %s",
+		sql_buffer_printf(output_buf, "%d %s %d %s",
 				year, (year > 1 ? "years" : "year"),
 				mon, (mon > 1 ? "months" : "month"));
 	else if (year != 0)
-		fprintf(output_filp, "%d %s",
+		sql_buffer_printf(output_buf, "%d %s",
 				year, (year > 1 ? "years" : "year"));
 	else
-		fprintf(output_filp, "%d %s",
+		sql_buffer_printf(output_buf, "%d %s",
 				mon, (mon > 1 ? "months" : "month"));
 	if (negative)
-		fprintf(output_filp, " ago");
-	fprintf(output_filp, "%s", quote);
+		sql_buffer_printf(output_buf, " ago");
+	sql_buffer_printf(output_buf, "%s", quote);
 	return true;
 }
 
@@ -802,43 +933,37 @@ print_arrow_interval_dt(ARROW_PRINT_DATUM_ARGS)
 	min = datum % 60;
 	datum /= 60;
 	hour = datum;
-	fprintf(output_filp, "%s", quote);
+	sql_buffer_printf(output_buf, "%s", quote);
 	if (days != 0)
 	{
 		if (hour != 0 || min != 0 || sec != 0)
-			fprintf(output_filp, "%d %s %02d:%02d:%02d",
+			sql_buffer_printf(output_buf, "%d %s %02d:%02d:%02d",
 					days, (days > 1 ? "days" : "day"),
 					hour, min, sec);
 	}
 	else
 	{
-		fprintf(output_filp, "%02d:%02d:%02d",
+		sql_buffer_printf(output_buf, "%02d:%02d:%02d",
 				hour, min, sec);
 	}
 	if (msec != 0)
-		fprintf(output_filp, ".%03d", msec);
+		sql_buffer_printf(output_buf, ".%03d", msec);
 	if (negative)
-		fprintf(output_filp, " ago");
-	fprintf(output_filp, "%s", quote);
+		sql_buffer_printf(output_buf, " ago");
+	sql_buffer_printf(output_buf, "%s", quote);
 	return true;
 }
 
 static bool
 print_arrow_fixedsizebinary(ARROW_PRINT_DATUM_ARGS)
 {
-	int32_t		i, width = column->arrow_type.FixedSizeBinary.byteWidth;
+	int32_t		width = column->arrow_type.FixedSizeBinary.byteWidth;
 	ARROW_PRINT_DATUM_SETUP_FIXEDSIZEBINARY(width);
 
-	fprintf(output_filp, "%s\\x", quote);
-	for (i=0; i < width; i++)
-	{
-		static const char *hextbl = "0123456789abcdef";
-		int		c = addr[i];
-
-		fputc(hextbl[(c >> 4) & 0x0f], output_filp);
-		fputc(hextbl[(c & 0x0f)], output_filp);
-	}
-	fprintf(output_filp, "%s", quote);
+	__put_str(quote);
+	__put_str(json_output ? "\\\\x" : "\\x");
+	__put_hex(addr, width);
+	__put_str(quote);
 	return true;
 }
 
@@ -848,7 +973,7 @@ print_arrow_macaddr(ARROW_PRINT_DATUM_ARGS)
 	int32_t		width = column->arrow_type.FixedSizeBinary.byteWidth;
 	ARROW_PRINT_DATUM_SETUP_FIXEDSIZEBINARY(width);
 	assert(width == 6);
-	fprintf(output_filp,
+	sql_buffer_printf(output_buf,
 			"%s%02x:%02x:%02x:%02x:%02x:%02x%s",
 			quote,
 			(unsigned char)addr[0],
@@ -867,7 +992,7 @@ print_arrow_inet4(ARROW_PRINT_DATUM_ARGS)
 	int32_t		width = column->arrow_type.FixedSizeBinary.byteWidth;
 	ARROW_PRINT_DATUM_SETUP_FIXEDSIZEBINARY(width);
     assert(width == 4);
-	fprintf(output_filp,
+	sql_buffer_printf(output_buf,
 			"%s%u.%u.%u.%u%s",
 			quote,
 			(unsigned char)addr[0],
@@ -911,7 +1036,7 @@ print_arrow_inet6(ARROW_PRINT_DATUM_ARGS)
 	}
 
 	/* print out IPv6 */
-	fprintf(output_filp, "%s", quote);
+	sql_buffer_printf(output_buf, "%s", quote);
 	for (i=0; i < 8; i++)
 	{
 		if (zero_base >= 0 &&
@@ -919,28 +1044,28 @@ print_arrow_inet6(ARROW_PRINT_DATUM_ARGS)
 			i <= zero_base + zero_len)
 		{
 			if (i == zero_base)
-				fputc(':', output_filp);
+				__put_char(':');
 			continue;
 		}
 		if (i > 0)
-			fputc(':', output_filp);
+			__put_char(':');
 		/* Is this address an encapsulated IPv4? */
 		if (i == 6 && zero_base == 0 && ((zero_len == 6) ||
 										 (zero_len == 7 && words[7] != 0x0001) ||
 										 (zero_len == 5 && words[5] == 0xffff)))
 		{
-			fprintf(output_filp, "%u.%u.%u.%u",
+			sql_buffer_printf(output_buf, "%u.%u.%u.%u",
 					(unsigned char)addr[12],
 					(unsigned char)addr[13],
 					(unsigned char)addr[14],
 					(unsigned char)addr[15]);
 			break;
 		}
-		fprintf(output_filp, "%x", words[i]);
+		sql_buffer_printf(output_buf, "%x", words[i]);
 	}
 	if (zero_base >= 0 && zero_base + zero_len == 8)
-		fputc(':', output_filp);
-	fprintf(output_filp, "%s", quote);
+		__put_char(':');
+	sql_buffer_printf(output_buf, "%s", quote);
 	return true;
 }
 
@@ -965,16 +1090,22 @@ print_arrow_list(ARROW_PRINT_DATUM_ARGS)
 	child = &column->children[0];
 	__buffers = buffers + (child->buffer_index -
 						   column->buffer_index);
-	fprintf(output_filp, "%s[", quote);
+	/* JSON array is never quoted, but the string elements are */
+	if (json_output)
+		quote = "";
+	__put_str(quote);
+	__put_char('[');
 	current_context = 'e';
 	for (i=head; i < tail; i++)
 	{
 		if (i > head)
-			fprintf(output_filp, ",");
-		printArrowDatum(child, __buffers, rb_chunk, i, "");
+			__put_char(',');
+		printArrowDatum(child, __buffers, rb_chunk, i,
+						json_output ? "\"" : "");
 	}
 	current_context = saved_context;
-	fprintf(output_filp, "%s]", quote);
+	__put_char(']');
+	__put_str(quote);
 	return true;
 }
 
@@ -984,7 +1115,25 @@ print_arrow_struct(ARROW_PRINT_DATUM_ARGS)
 	char		saved_context = current_context;
 	int			j;
 
-	fprintf(output_filp, "%s(", quote);
+	/* JSON object with the sub-field names */
+	if (json_output)
+	{
+		__put_char('{');
+		for (j=0; j < column->num_children; j++)
+		{
+			arrowColumn *child = &column->children[j];
+			ArrowBuffer *__buffers = buffers + (child->buffer_index -
+												column->buffer_index);
+			if (j > 0)
+				__put_char(',');
+			__put_str(child->json_key);
+			printArrowDatum(child, __buffers, rb_chunk, index, "\"");
+		}
+		__put_char('}');
+		return true;
+	}
+	__put_str(quote);
+	__put_char('(');
 	current_context = 'e';
 	for (j=0; j < column->num_children; j++)
 	{
@@ -992,11 +1141,12 @@ print_arrow_struct(ARROW_PRINT_DATUM_ARGS)
 		ArrowBuffer *__buffers = buffers + (child->buffer_index -
 											column->buffer_index);
 		if (j > 0)
-			fprintf(output_filp, "%c", csv_delimiter);
+			__put_char(csv_delimiter);
 		printArrowDatum(child, __buffers, rb_chunk, index, "");
 	}
 	current_context = saved_context;
-	fprintf(output_filp, "%s)", quote);
+	__put_char(')');
+	__put_str(quote);
 	return true;
 }
 
@@ -1010,6 +1160,19 @@ setupArrowColumn(arrowColumn *column, ArrowField *field, int buffer_index)
 
 	memcpy(&column->arrow_type, &field->type, sizeof(ArrowType));
 	column->colname = pstrdup(field->name);
+	if (json_output)
+	{
+		SQLbuffer	temp;
+		SQLbuffer  *saved = output_buf;
+
+		sql_buffer_init(&temp);
+		output_buf = &temp;
+		__put_json_string(field->name, strlen(field->name));
+		__put_char(':');
+		__put_char('\0');
+		output_buf = saved;
+		column->json_key = temp.data;
+	}
 	column->buffer_index = buffer_index;
 	column->nullable = field->nullable;
 	/* fetch "pg_type" custom-metadata */
@@ -1372,32 +1535,49 @@ printCreateTable(void)
 	fprintf(output_filp, ";\n");
 }
 
+/*
+ * arrowDumpTask - a range of rows in a record batch
+ *
+ * Tasks are formatted by multiple threads (--parallel), but written out
+ * to the output file in order.
+ */
+typedef struct
+{
+	ArrowRecordBatch *rbatch;
+	const char *rb_chunk;
+	int64_t		row_begin;
+	int64_t		row_end;
+} arrowDumpTask;
+
+#define ARROW_DUMP_TASK_NROWS		65536
+
+static arrowDumpTask *dump_tasks = NULL;
+static int64_t		dump_num_tasks = 0;
+static int64_t		dump_task_next = 0;		/* next task to be formatted */
+static int64_t		dump_task_written = 0;	/* next task to be written */
+static pthread_mutex_t dump_task_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  dump_task_cond = PTHREAD_COND_INITIALIZER;
+
 static void
-printRecordBatch(ArrowRecordBatch *rbatch, const char *rb_chunk)
+dumpArrowTask(arrowDumpTask *task)
 {
+	ArrowRecordBatch *rbatch = task->rbatch;
+	const char *rb_chunk = task->rb_chunk;
 	int64_t		i, j;
 
-	/* consider --offset */
-	if (num_skip_rows < 0)
-		i = 0;
-	else
-	{
-		i = num_skip_rows;
-		if (num_skip_rows > rbatch->length)
-			num_skip_rows -= rbatch->length;
-		else
-			num_skip_rows = 0;
-	}
-
-	while (i < rbatch->length && num_dump_rows != 0)
+	for (i=task->row_begin; i < task->row_end; i++)
 	{
+		if (json_output)
+			__put_char('{');
 		for (j=0; j < arrow_num_columns; j++)
 		{
 			arrowColumn	   *column = &arrow_columns[j];
 			ArrowBuffer	   *buffers;
 
 			if (j > 0)
-				fprintf(output_filp, "%c", csv_delimiter);
+				__put_char(json_output ? ',' : csv_delimiter);
+			if (json_output)
+				__put_str(column->json_key);
 			if (j >= rbatch->_num_nodes)
 				printNullDatum();
 			else if (i >= rbatch->nodes[j].length)
@@ -1410,37 +1590,204 @@ printRecordBatch(ArrowRecordBatch *rbatch, const char *rb_chunk)
 				printArrowDatum(column, buffers, rb_chunk, i, "\"");
 			}
 		}
-		fprintf(output_filp, "\r\n");
-		i++;
-		if (num_dump_rows > 0)
-			num_dump_rows--;
+		if (json_output)
+			__put_str("}\n");
+		else
+			__put_str("\r\n");
+	}
+}
+
+static void
+__writeOutputBuffer(SQLbuffer *buf)
+{
+	if (buf->usage > 0 &&
+		fwrite(buf->data, buf->usage, 1, output_filp) != 1)
+		Elog("failed on fwrite('%s'): %m",
+			 output_filename ? output_filename : "stdout");
+	sql_buffer_clear(buf);
+}
+
+static void *
+dumpArrowWorkerMain(void *__priv)
+{
+	SQLbuffer	buf;
+	int64_t		index;
+
+	sql_buffer_init(&buf);
+	output_buf = &buf;
+	for (;;)
+	{
+		pthread_mutex_lock(&dump_task_mutex);
+		index = dump_task_next++;
+		pthread_mutex_unlock(&dump_task_mutex);
+		if (index >= dump_num_tasks)
+			break;
+
+		dumpArrowTask(&dump_tasks[index]);
+
+		/* write out the buffer in order */
+		pthread_mutex_lock(&dump_task_mutex);
+		while (dump_task_written != index)
+			pthread_cond_wait(&dump_task_cond, &dump_task_mutex);
+		pthread_mutex_unlock(&dump_task_mutex);
+
+		__writeOutputBuffer(&buf);
+
+		pthread_mutex_lock(&dump_task_mutex);
+		dump_task_written++;
+		pthread_cond_broadcast(&dump_task_cond);
+		pthread_mutex_unlock(&dump_task_mutex);
 	}
+	if (buf.data)
+		pfree(buf.data);
+	return NULL;
 }
 
+/*
+ * setupDumpTasks - split the record batches into tasks, with --offset and
+ * --limit being considered
+ */
 static void
-dumpArrowFile(ArrowFileInfo *af_info, int fdesc)
+setupDumpTasks(ArrowFileInfo *af_info, const char *mmap_head)
 {
-	static long	__PAGE_SIZE = -1;
-	size_t		file_sz = af_info->stat_buf.st_size;
-	size_t		mmap_sz;
-	char	   *mmap_head;
+	static int64_t nrooms = 0;
 	int			i;
 
-	if (__PAGE_SIZE < 0)
-		__PAGE_SIZE = sysconf(_SC_PAGESIZE);
-	mmap_sz = (file_sz + __PAGE_SIZE - 1) & ~(__PAGE_SIZE - 1);
-	mmap_head = mmap(NULL, mmap_sz, PROT_READ, MAP_SHARED, fdesc, 0);
-	if (mmap_head == MAP_FAILED)
-		Elog("failed on mmap: %m");
 	for (i=0; i < af_info->footer._num_recordBatches; i++)
 	{
 		ArrowBlock *block = &af_info->footer.recordBatches[i];
-		char	   *rb_chunk = (mmap_head + block->offset + block->metaDataLength);
 		ArrowRecordBatch *rbatch = &af_info->recordBatches[i].body.recordBatch;
+		int64_t		row_begin = 0;
+		int64_t		row_end = rbatch->length;
+		int64_t		k;
+
+		/* consider --offset */
+		if (num_skip_rows > 0)
+		{
+			if (num_skip_rows >= row_end)
+			{
+				num_skip_rows -= row_end;
+				continue;
+			}
+			row_begin = num_skip_rows;
+			num_skip_rows = 0;
+		}
+		/* consider --limit */
+		if (num_dump_rows >= 0)
+		{
+			if (row_end - row_begin > num_dump_rows)
+				row_end = row_begin + num_dump_rows;
+			num_dump_rows -= (row_end - row_begin);
+		}
+
+		for (k=row_begin; k < row_end; k += ARROW_DUMP_TASK_NROWS)
+		{
+			arrowDumpTask *task;
+
+			if (dump_num_tasks >= nrooms)
+			{
+				nrooms = 2 * nrooms + 100;
+				dump_tasks = repalloc(dump_tasks, sizeof(arrowDumpTask) * nrooms);
+			}
+			task = &dump_tasks[dump_num_tasks++];
+			task->rbatch = rbatch;
+			task->rb_chunk = (mmap_head + block->offset + block->metaDataLength);
+			task->row_begin = k;
+			task->row_end = k + ARROW_DUMP_TASK_NROWS;
+			if (task->row_end > row_end)
+				task->row_end = row_end;
+		}
+	}
+}
+
+/*
+ * __checkTimestampTimezone
+ *
+ * setenv("TZ") is not thread-safe, so --parallel is available only if all
+ * the Timestamp columns have the identical timezone, if any.
+ */
+static bool
+__checkTimestampTimezone(arrowColumn *column, const char **p_tz_name)
+{
+	int		j;
+
+	if (column->arrow_type.node.tag == ArrowNodeTag__Timestamp &&
+		column->arrow_type.Timestamp.timezone)
+	{
+		const char *tz_name = column->arrow_type.Timestamp.timezone;
+
+		if (!*p_tz_name)
+		{
+			__assign_timestamp_timezone(&column->arrow_type.Timestamp);
+			*p_tz_name = tz_name;
+		}
+		else if (strcmp(*p_tz_name, tz_name) != 0)
+			return false;
+	}
+	for (j=0; j < column->num_children; j++)
+	{
+		if (!__checkTimestampTimezone(&column->children[j], p_tz_name))
+			return false;
+	}
+	return true;
+}
+
+static void
+dumpArrowFiles(void)
+{
+	char	  **mmap_heads = alloca(sizeof(char *) * arrow_num_files);
+	size_t	   *mmap_sizes = alloca(sizeof(size_t) * arrow_num_files);
+	long		page_sz = sysconf(_SC_PAGESIZE);
+	const char *tz_name = NULL;
+	int			i;
+
+	for (i=0; i < arrow_num_files; i++)
+	{
+		size_t	file_sz = arrow_files[i].stat_buf.st_size;
+
+		mmap_sizes[i] = (file_sz + page_sz - 1) & ~(page_sz - 1);
+		mmap_heads[i] = mmap(NULL, mmap_sizes[i], PROT_READ, MAP_SHARED,
+							 arrow_fdescs[i], 0);
+		if (mmap_heads[i] == MAP_FAILED)
+			Elog("failed on mmap: %m");
+		setupDumpTasks(&arrow_files[i], mmap_heads[i]);
+	}
+
+	for (i=0; i < arrow_num_columns; i++)
+	{
+		if (!__checkTimestampTimezone(&arrow_columns[i], &tz_name))
+		{
+			if (num_dump_threads > 1)
+				fprintf(stderr, "warning: --parallel is ignored because Timestamp columns have multiple timezones\n");
+			num_dump_threads = 1;
+			break;
+		}
+	}
+
+	fflush(output_filp);
+	if (num_dump_threads <= 1)
+	{
+		dumpArrowWorkerMain(NULL);
+	}
+	else
+	{
+		pthread_t  *threads = alloca(sizeof(pthread_t) * num_dump_threads);
 
-		printRecordBatch(rbatch, rb_chunk);
+		for (i=0; i < num_dump_threads; i++)
+		{
+			if ((errno = pthread_create(&threads[i], NULL,
+										dumpArrowWorkerMain, NULL)) != 0)
+				Elog("failed on pthread_create: %m");
+		}
+		for (i=0; i < num_dump_threads; i++)
+		{
+			if ((errno = pthread_join(threads[i], NULL)) != 0)
+				Elog("failed on pthread_join: %m");
+		}
 	}
-	munmap(mmap_head, mmap_sz);
+
+	for (i=0; i < arrow_num_files; i++)
+		munmap(mmap_heads[i], mmap_sizes[i]);
 }
 
 int
@@ -1451,6 +1798,8 @@ main(int argc, char * const argv[])
 		{"header",       no_argument,       NULL, 1002},
 		{"offset",       required_argument, NULL, 1004},
 		{"limit",        required_argument, NULL, 1005},
+		{"format",       required_argument, NULL, 1006},
+		{"parallel",     required_argument, NULL, 'n'},
 		/* CREATE TABLE & COPY FROM */
 		{"create-table", required_argument, NULL, 1200},
 		{"tablespace",   required_argument, NULL, 1201},
@@ -1461,7 +1810,7 @@ main(int argc, char * const argv[])
 	};
 	int		i, j, c;
 
-	while ((c = getopt_long(argc, argv, "o:h", long_options, NULL)) >= 0)
+	while ((c = getopt_long(argc, argv, "o:hn:", long_options, NULL)) >= 0)
 	{
 		switch (c)
 		{
@@ -1489,6 +1838,23 @@ main(int argc, char * const argv[])
 				if (num_dump_rows < 0)
 					Elog("--limit=%s is not a numeric value", optarg);
 				break;
+			case 1006:	/* --format */
+				if (strcmp(optarg, "csv") == 0)
+					json_output = false;
+				else if (strcmp(optarg, "ndjson") == 0)
+					json_output = true;
+				else
+					Elog("unknown --format=%s", optarg);
+				break;
+			case 'n':	/* --parallel */
+				{
+					char   *end;
+
+					num_dump_threads = strtol(optarg, &end, 10);
+					if (*end != '\0' || num_dump_threads < 1)
+						Elog("invalid --parallel option: %s", optarg);
+				}
+				break;
 			case 1200:	/* --create-table */
 				if (create_table_name)
 					Elog("--create-table was specified twice");
@@ -1515,6 +1881,8 @@ main(int argc, char * const argv[])
 		Elog("--tablespace must be used with --create-table");
 	if (partition_name && !create_table_name)
 		Elog("--partition-of must be used with --create-table");
+	if (json_output && (create_table_name || print_header))
+		Elog("--format=ndjson is exclusive with --create-table and --header");
 	
 	/* arrow files */
 	if (optind >= argc)
@@ -1609,9 +1977,8 @@ main(int argc, char * const argv[])
 		}
 		fprintf(output_filp, "\r\n");
 	}
-	/* Dump Arrpw files */
-	for (i=0; i < arrow_num_files; i++)
-		dumpArrowFile(&arrow_files[i], arrow_fdescs[i]);
+	/* Dump Arrow files */
+	dumpArrowFiles();
 	if (create_table_name && num_dump_rows != 0)
 		fprintf(output_filp, "\\.\r\n");
 	return 0;
@@ -0,0 +1,1096 @@
+/*
+ * csv2arrow.c
+ *
+ * A tool to convert CSV files into Apache Arrow files by multiple threads
+ * ----
+ * Copyright 2011-2021 (C) KaiGai Kohei <kaigai@kaigai.gr.jp>
+ * Copyright 2014-2021 (C) PG-Strom Developers Team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the PostgreSQL License.
+ */
+#include <ctype.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include "arrow_ipc.h"
+
+/*
+ * definition of the CSV columns
+ */
+typedef bool (*csvParseFunc)(SQLfield *column, const char *str, int len);
+
+typedef struct
+{
+	const char	   *colname;
+	const char	   *typname;
+	csvParseFunc	parse_value;
+} csvColumn;
+
+/* static variables */
+static const char  *output_filename = NULL;
+static const char  *schema_definition = NULL;	/* --schema */
+static char			csv_delimiter = ',';		/* --delimiter */
+static char			csv_quote = '"';
+static bool			csv_header = false;			/* --header */
+static const char  *csv_null_string = "";		/* --null */
+static int			csv_null_length = 0;
+static int			num_worker_threads = -1;	/* --parallel */
+static size_t		batch_segment_sz = 0;		/* --segment-size */
+static bool			shows_progress = false;		/* --progress */
+static char		  **input_filenames = NULL;
+static int			num_input_files = 0;
+
+static csvColumn   *csv_columns = NULL;
+static int			csv_num_columns = 0;
+static SQLtable	   *main_table = NULL;
+static SQLtable	  **worker_tables = NULL;
+static pthread_mutex_t main_table_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/*
+ * state of the parallel parsing of one input file
+ */
+typedef struct
+{
+	pthread_t		thread;
+	int				worker_id;
+	const char	   *filename;
+	const char	   *base;		/* mmap'ed input file */
+	size_t			head;		/* begin of the assigned range */
+	size_t			tail;		/* end of the assigned range */
+	uint64_t		nquotes;	/* # of quote characters (1st pass) */
+	uint64_t		nrows;		/* # of rows (2nd pass) */
+	SQLbuffer		scratch;	/* buffer to unescape quoted fields */
+} csvWorker;
+
+/* ----------------------------------------------------------------
+ *
+ * put_value handlers
+ *
+ * ----------------------------------------------------------------
+ */
+static size_t
+put_inline_value(SQLfield *column, const char *addr, int sz)
+{
+	size_t		index = column->nitems++;
+	int			unitsz = column->arrow_type.Int.bitWidth / 8;
+
+	/* Int, FloatingPoint, Date and Timestamp are all fixed-length */
+	switch (column->arrow_type.node.tag)
+	{
+		case ArrowNodeTag__FloatingPoint:
+			unitsz = (column->arrow_type.FloatingPoint.precision ==
+					  ArrowPrecision__Double ? sizeof(double) : sizeof(float));
+			break;
+		case ArrowNodeTag__Date:
+			unitsz = sizeof(int32_t);
+			break;
+		case ArrowNodeTag__Timestamp:
+			unitsz = sizeof(int64_t);
+			break;
+		default:
+			break;
+	}
+	if (!addr)
+	{
+		column->nullcount++;
+		sql_buffer_clrbit(&column->nullmap, index);
+		sql_buffer_append_zero(&column->values, unitsz);
+	}
+	else
+	{
+		assert(sz == unitsz);
+		sql_buffer_setbit(&column->nullmap, index);
+		sql_buffer_append(&column->values, addr, unitsz);
+	}
+	return __buffer_usage_inline_type(column);
+}
+
+static size_t
+put_bool_value(SQLfield *column, const char *addr, int sz)
+{
+	size_t		index = column->nitems++;
+
+	if (!addr)
+	{
+		column->nullcount++;
+		sql_buffer_clrbit(&column->nullmap, index);
+		sql_buffer_clrbit(&column->values,  index);
+	}
+	else
+	{
+		sql_buffer_setbit(&column->nullmap, index);
+		if (*((const char *)addr))
+			sql_buffer_setbit(&column->values, index);
+		else
+			sql_buffer_clrbit(&column->values, index);
+	}
+	return __buffer_usage_inline_type(column);
+}
+
+static size_t
+put_variable_value(SQLfield *column, const char *addr, int sz)
+{
+	size_t		index = column->nitems++;
+
+	if (index == 0)
+		sql_buffer_append_zero(&column->values, sizeof(uint32_t));
+	if (!addr)
+	{
+		column->nullcount++;
+		sql_buffer_clrbit(&column->nullmap, index);
+	}
+	else
+	{
+		sql_buffer_setbit(&column->nullmap, index);
+		sql_buffer_append(&column->extra, addr, sz);
+	}
+	sql_buffer_append(&column->values,
+					  &column->extra.usage, sizeof(uint32_t));
+	return __buffer_usage_varlena_type(column);
+}
+
+/* ----------------------------------------------------------------
+ *
+ * Text parsers for each data type
+ *
+ * ----------------------------------------------------------------
+ */
+static bool
+__parse_int64(const char *str, int len, int64_t *p_value)
+{
+	const char *end = str + len;
+	uint64_t	value = 0;
+	bool		negative = false;
+
+	if (str < end && (*str == '-' || *str == '+'))
+		negative = (*str++ == '-');
+	if (str == end)
+		return false;
+	while (str < end)
+	{
+		int		c = *str++ - '0';
+
+		if (c < 0 || c > 9)
+			return false;
+		if (value > (uint64_t)INT64_MAX / 10)
+			return false;
+		value = value * 10 + c;
+	}
+	if (negative)
+	{
+		if (value > (uint64_t)INT64_MAX + 1)
+			return false;
+		*p_value = -(int64_t)value;
+	}
+	else
+	{
+		if (value > (uint64_t)INT64_MAX)
+			return false;
+		*p_value = (int64_t)value;
+	}
+	return true;
+}
+
+static bool
+parse_int2_value(SQLfield *column, const char *str, int len)
+{
+	int64_t		ival;
+	int16_t		value;
+
+	if (!__parse_int64(str, len, &ival) ||
+		ival < SHRT_MIN || ival > SHRT_MAX)
+		return false;
+	value = ival;
+	sql_field_put_value(column, (char *)&value, sizeof(int16_t));
+	return true;
+}
+
+static bool
+parse_int4_value(SQLfield *column, const char *str, int len)
+{
+	int64_t		ival;
+	int32_t		value;
+
+	if (!__parse_int64(str, len, &ival) ||
+		ival < INT_MIN || ival > INT_MAX)
+		return false;
+	value = ival;
+	sql_field_put_value(column, (char *)&value, sizeof(int32_t));
+	return true;
+}
+
+static bool
+parse_int8_value(SQLfield *column, const char *str, int len)
+{
+	int64_t		value;
+
+	if (!__parse_int64(str, len, &value))
+		return false;
+	sql_field_put_value(column, (char *)&value, sizeof(int64_t));
+	return true;
+}
+
+static bool
+__parse_float8(const char *str, int len, double *p_value)
+{
+	char		temp[80];
+	char	   *end;
+
+	if (len == 0 || len >= sizeof(temp))
+		return false;
+	memcpy(temp, str, len);
+	temp[len] = '\0';
+	*p_value = strtod(temp, &end);
+	return (*end == '\0');
+}
+
+static bool
+parse_float4_value(SQLfield *column, const char *str, int len)
+{
+	double		fval;
+	float		value;
+
+	if (!__parse_float8(str, len, &fval))
+		return false;
+	value = fval;
+	sql_field_put_value(column, (char *)&value, sizeof(float));
+	return true;
+}
+
+static bool
+parse_float8_value(SQLfield *column, const char *str, int len)
+{
+	double		value;
+
+	if (!__parse_float8(str, len, &value))
+		return false;
+	sql_field_put_value(column, (char *)&value, sizeof(double));
+	return true;
+}
+
+static bool
+parse_bool_value(SQLfield *column, const char *str, int len)
+{
+	char		value;
+
+	if ((len == 1 && (*str == 't' || *str == 'T' || *str == '1')) ||
+		(len == 4 && strncasecmp(str, "true", 4) == 0))
+		value = 1;
+	else if ((len == 1 && (*str == 'f' || *str == 'F' || *str == '0')) ||
+			 (len == 5 && strncasecmp(str, "false", 5) == 0))
+		value = 0;
+	else
+		return false;
+	sql_field_put_value(column, &value, sizeof(char));
+	return true;
+}
+
+static bool
+parse_text_value(SQLfield *column, const char *str, int len)
+{
+	sql_field_put_value(column, str, len);
+	return true;
+}
+
+/*
+ * __parse_digits - fetch fixed number of digits
+ */
+static inline bool
+__parse_digits(const char **p_pos, const char *end, int ndigits, int *p_value)
+{
+	const char *pos = *p_pos;
+	int			value = 0;
+
+	if (end - pos < ndigits)
+		return false;
+	while (ndigits-- > 0)
+	{
+		if (!isdigit(*pos))
+			return false;
+		value = value * 10 + (*pos++ - '0');
+	}
+	*p_value = value;
+	*p_pos = pos;
+	return true;
+}
+
+/*
+ * __parse_date - 'YYYY-MM-DD' to days since the UNIX epoch
+ */
+static bool
+__parse_date(const char **p_pos, const char *end, int32_t *p_days)
+{
+	const char *pos = *p_pos;
+	int			y, m, d;
+	int			era, yoe, doy, doe;
+
+	if (!__parse_digits(&pos, end, 4, &y) ||
+		pos >= end || *pos++ != '-' ||
+		!__parse_digits(&pos, end, 2, &m) ||
+		pos >= end || *pos++ != '-' ||
+		!__parse_digits(&pos, end, 2, &d))
+		return false;
+	if (m < 1 || m > 12 || d < 1 || d > 31)
+		return false;
+	/* civil-from-days algorithm by Howard Hinnant */
+	y -= (m <= 2);
+	era = y / 400;
+	yoe = y - era * 400;
+	doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+	doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+	*p_days = era * 146097 + doe - 719468;
+	*p_pos = pos;
+	return true;
+}
+
+static bool
+parse_date_value(SQLfield *column, const char *str, int len)
+{
+	int32_t		value;
+
+	if (!__parse_date(&str, str + len, &value) || len != 10)
+		return false;
+	sql_field_put_value(column, (char *)&value, sizeof(int32_t));
+	return true;
+}
+
+/*
+ * 'YYYY-MM-DD[ T]HH:MI[:SS[.FFFFFF]]' to microseconds since the UNIX epoch.
+ * Time zone is not supported; the value is written as a local timestamp.
+ */
+static bool
+parse_timestamp_value(SQLfield *column, const char *str, int len)
+{
+	const char *end = str + len;
+	int32_t		days;
+	int			hh, mi, ss = 0, frac = 0, scale = 1000000;
+	int64_t		value;
+
+	if (!__parse_date(&str, end, &days))
+		return false;
+	if (str < end)
+	{
+		if (*str != ' ' && *str != 'T')
+			return false;
+		str++;
+		if (!__parse_digits(&str, end, 2, &hh) ||
+			str >= end || *str++ != ':' ||
+			!__parse_digits(&str, end, 2, &mi))
+			return false;
+		if (str < end && *str == ':')
+		{
+			str++;
+			if (!__parse_digits(&str, end, 2, &ss))
+				return false;
+			if (str < end && *str == '.')
+			{
+				for (str++; str < end && isdigit(*str); str++)
+				{
+					if (scale > 1)
+					{
+						scale /= 10;
+						frac += (*str - '0') * scale;
+					}
+				}
+			}
+		}
+		if (str != end || hh > 24 || mi > 59 || ss > 60)
+			return false;
+		value = ((int64_t)days * 86400L +
+				 hh * 3600L + mi * 60L + ss) * 1000000L + frac;
+	}
+	else
+	{
+		value = (int64_t)days * 86400000000L;
+	}
+	sql_field_put_value(column, (char *)&value, sizeof(int64_t));
+	return true;
+}
+
+/*
+ * supported data types
+ */
+static struct {
+	const char	   *typname;
+	ArrowNodeTag	tag;
+	int				unitsz;
+	int				nbuffers;
+	size_t		  (*put_value)(SQLfield *column, const char *addr, int sz);
+	csvParseFunc	parse_value;
+} csv_type_catalog[] = {
+	{"bool",      ArrowNodeTag__Bool,          1, 2,
+	 put_bool_value,     parse_bool_value},
+	{"int2",      ArrowNodeTag__Int,           2, 2,
+	 put_inline_value,   parse_int2_value},
+	{"int4",      ArrowNodeTag__Int,           4, 2,
+	 put_inline_value,   parse_int4_value},
+	{"int8",      ArrowNodeTag__Int,           8, 2,
+	 put_inline_value,   parse_int8_value},
+	{"float4",    ArrowNodeTag__FloatingPoint, 4, 2,
+	 put_inline_value,   parse_float4_value},
+	{"float8",    ArrowNodeTag__FloatingPoint, 8, 2,
+	 put_inline_value,   parse_float8_value},
+	{"date",      ArrowNodeTag__Date,          4, 2,
+	 put_inline_value,   parse_date_value},
+	{"timestamp", ArrowNodeTag__Timestamp,     8, 2,
+	 put_inline_value,   parse_timestamp_value},
+	{"text",      ArrowNodeTag__Utf8,         -1, 3,
+	 put_variable_value, parse_text_value},
+	{NULL, 0, 0, 0, NULL, NULL},
+};
+
+/*
+ * setupCsvTable - build an SQLtable according to the csv_columns
+ */
+static SQLtable *
+setupCsvTable(void)
+{
+	SQLtable   *table;
+	int			i, j;
+
+	table = palloc0(offsetof(SQLtable, columns[csv_num_columns]));
+	table->fdesc = -1;
+	table->segment_sz = batch_segment_sz;
+	table->nfields = csv_num_columns;
+	for (j=0; j < csv_num_columns; j++)
+	{
+		csvColumn  *ccol = &csv_columns[j];
+		SQLfield   *column = &table->columns[j];
+
+		for (i=0; csv_type_catalog[i].typname != NULL; i++)
+		{
+			if (strcmp(ccol->typname, csv_type_catalog[i].typname) == 0)
+				break;
+		}
+		if (!csv_type_catalog[i].typname)
+			Elog("column '%s' has unsupported data type '%s'",
+				 ccol->colname, ccol->typname);
+		__initArrowNode(&column->arrow_type.node, csv_type_catalog[i].tag);
+		switch (csv_type_catalog[i].tag)
+		{
+			case ArrowNodeTag__Int:
+				column->arrow_type.Int.bitWidth = 8 * csv_type_catalog[i].unitsz;
+				column->arrow_type.Int.is_signed = true;
+				break;
+			case ArrowNodeTag__FloatingPoint:
+				column->arrow_type.FloatingPoint.precision
+					= (csv_type_catalog[i].unitsz == sizeof(double)
+					   ? ArrowPrecision__Double
+					   : ArrowPrecision__Single);
+				break;
+			case ArrowNodeTag__Date:
+				column->arrow_type.Date.unit = ArrowDateUnit__Day;
+				break;
+			case ArrowNodeTag__Timestamp:
+				column->arrow_type.Timestamp.unit = ArrowTimeUnit__MicroSecond;
+				break;
+			default:
+				break;
+		}
+		column->field_name = pstrdup(ccol->colname);
+		column->put_value = csv_type_catalog[i].put_value;
+		ccol->parse_value = csv_type_catalog[i].parse_value;
+
+		table->numFieldNodes++;
+		table->numBuffers += csv_type_catalog[i].nbuffers;
+	}
+	return table;
+}
+
+/* ----------------------------------------------------------------
+ *
+ * Parallel CSV parser
+ *
+ * ----------------------------------------------------------------
+ */
+static void
+writeArrowRecordBatchParallel(SQLtable *worker)
+{
+	SQLtable   *table = main_table;
+
+	if ((errno = pthread_mutex_lock(&main_table_mutex)) != 0)
+		Elog("failed on pthread_mutex_lock: %m");
+	/* write out the record batch at the tail of the main table */
+	worker->fdesc = table->fdesc;
+	worker->filename = table->filename;
+	worker->f_pos = table->f_pos;
+	worker->recordBatches = table->recordBatches;
+	worker->numRecordBatches = table->numRecordBatches;
+	writeArrowRecordBatch(worker);
+	if (shows_progress)
+		printf("RecordBatch[%d]: nitems=%zu, length=%zu at file offset %zu\n",
+			   worker->numRecordBatches - 1,
+			   worker->nitems,
+			   (size_t)(worker->f_pos - table->f_pos),
+			   (size_t)table->f_pos);
+	table->f_pos = worker->f_pos;
+	table->recordBatches = worker->recordBatches;
+	table->numRecordBatches = worker->numRecordBatches;
+	table->nitems += worker->nitems;
+	if ((errno = pthread_mutex_unlock(&main_table_mutex)) != 0)
+		Elog("failed on pthread_mutex_unlock: %m");
+	sql_table_clear(worker);
+}
+
+/*
+ * csvCountQuotesMain - the first pass; counts the quote characters in the
+ * assigned range, so that every worker can know whether its range begins
+ * inside of a quoted field, or not.
+ */
+static void *
+csvCountQuotesMain(void *__priv)
+{
+	csvWorker  *w = __priv;
+	const char *pos = w->base + w->head;
+	const char *end = w->base + w->tail;
+	uint64_t	count = 0;
+
+	while ((pos = memchr(pos, csv_quote, end - pos)) != NULL)
+	{
+		count++;
+		pos++;
+	}
+	w->nquotes = count;
+	return NULL;
+}
+
+/*
+ * csvParseRowsMain - the second pass; parses the rows in the assigned range,
+ * which is already adjusted to the row boundary.
+ */
+static void *
+csvParseRowsMain(void *__priv)
+{
+	csvWorker  *w = __priv;
+	SQLtable   *table = worker_tables[w->worker_id];
+	const char *pos = w->base + w->head;
+	const char *end = w->base + w->tail;
+
+	while (pos < end)
+	{
+		const char *row_head = pos;
+		int			j;
+
+		/* skip empty lines */
+		if (*pos == '\n' || (*pos == '\r' && pos + 1 < end && pos[1] == '\n'))
+		{
+			pos += (*pos == '\n' ? 1 : 2);
+			continue;
+		}
+
+		for (j=0; j < csv_num_columns; j++)
+		{
+			SQLfield   *column = &table->columns[j];
+			const char *fval;
+			int			flen;
+			bool		is_null = false;
+
+			if (pos < end && *pos == csv_quote)
+			{
+				/* quoted field; "" is an escaped quote */
+				SQLbuffer  *buf = &w->scratch;
+
+				sql_buffer_clear(buf);
+				for (pos++;; pos++)
+				{
+					if (pos >= end)
+						Elog("%s: unterminated quoted field at offset %zu",
+							 w->filename, (size_t)(row_head - w->base));
+					if (*pos == csv_quote)
+					{
+						if (pos + 1 < end && pos[1] == csv_quote)
+							pos++;
+						else
+						{
+							pos++;
+							break;
+						}
+					}
+					sql_buffer_append(buf, pos, 1);
+				}
+				fval = (buf->data ? buf->data : "");
+				flen = buf->usage;
+			}
+			else
+			{
+				fval = pos;
+				while (pos < end && *pos != csv_delimiter && *pos != '\n')
+					pos++;
+				flen = pos - fval;
+				if (flen > 0 && fval[flen-1] == '\r' &&
+					(pos >= end || *pos == '\n'))
+					flen--;
+				if (flen == csv_null_length &&
+					memcmp(fval, csv_null_string, flen) == 0)
+					is_null = true;
+			}
+			/* field terminator */
+			if (j < csv_num_columns - 1)
+			{
+				if (pos >= end || *pos != csv_delimiter)
+					Elog("%s: row at offset %zu has %d fields, but %d expected",
+						 w->filename, (size_t)(row_head - w->base),
+						 j+1, csv_num_columns);
+				pos++;
+			}
+			else
+			{
+				if (pos < end && *pos == '\r')
+					pos++;
+				if (pos < end && *pos != '\n')
+					Elog("%s: row at offset %zu has more than %d fields",
+						 w->filename, (size_t)(row_head - w->base),
+						 csv_num_columns);
+				pos++;
+			}
+
+			if (is_null)
+				sql_field_put_value(column, NULL, 0);
+			else if (!csv_columns[j].parse_value(column, fval, flen))
+				Elog("%s: invalid input for %s column '%s' at offset %zu: '%.*s'",
+					 w->filename, csv_columns[j].typname,
+					 csv_columns[j].colname,
+					 (size_t)(row_head - w->base), flen, fval);
+		}
+		/* compute the current usage of the table */
+		table->usage = 0;
+		for (j=0; j < csv_num_columns; j++)
+			table->usage += table->columns[j].__curr_usage__;
+		table->nitems++;
+		w->nrows++;
+
+		if (table->usage > batch_segment_sz)
+			writeArrowRecordBatchParallel(table);
+	}
+	return NULL;
+}
+
+/*
+ * __csvNextRowHead - returns the head of the next row after the 'pos',
+ * but not inside of a quoted field.
+ */
+static size_t
+__csvNextRowHead(const char *base, size_t pos, size_t tail, bool in_quote)
+{
+	while (pos < tail)
+	{
+		char	c = base[pos++];
+
+		if (c == csv_quote)
+			in_quote = !in_quote;
+		else if (c == '\n' && !in_quote)
+			break;
+	}
+	return pos;
+}
+
+static void
+csvProcessOneFile(const char *filename)
+{
+	int			fdesc;
+	struct stat	stat_buf;
+	const char *base;
+	size_t		length;
+	size_t	   *heads;
+	csvWorker  *workers;
+	uint64_t	nquotes = 0;
+	uint64_t	nrows = 0;
+	int			i;
+
+	fdesc = open(filename, O_RDONLY);
+	if (fdesc < 0)
+		Elog("failed on open('%s'): %m", filename);
+	if (fstat(fdesc, &stat_buf) != 0)
+		Elog("failed on fstat('%s'): %m", filename);
+	length = stat_buf.st_size;
+	if (length == 0)
+	{
+		close(fdesc);
+		return;
+	}
+	base = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fdesc, 0);
+	if (base == MAP_FAILED)
+		Elog("failed on mmap('%s'): %m", filename);
+	madvise((void *)base, length, MADV_SEQUENTIAL);
+
+	/* 1st pass: count quote characters for each range */
+	workers = palloc0(sizeof(csvWorker) * num_worker_threads);
+	for (i=0; i < num_worker_threads; i++)
+	{
+		csvWorker  *w = &workers[i];
+
+		w->worker_id = i;
+		w->filename = filename;
+		w->base = base;
+		w->head = (length * i) / num_worker_threads;
+		w->tail = (length * (i+1)) / num_worker_threads;
+		if ((errno = pthread_create(&w->thread, NULL,
+									csvCountQuotesMain, w)) != 0)
+			Elog("failed on pthread_create: %m");
+	}
+	for (i=0; i < num_worker_threads; i++)
+	{
+		if ((errno = pthread_join(workers[i].thread, NULL)) != 0)
+			Elog("failed on pthread_join: %m");
+	}
+
+	/*
+	 * Adjust the ranges to the row boundary. The parity of the quotes
+	 * preceding the range tells us whether it begins inside of a quoted
+	 * field.
+	 */
+	heads = alloca(sizeof(size_t) * (num_worker_threads + 1));
+	for (i=0; i < num_worker_threads; i++)
+	{
+		size_t	head = workers[i].head;
+
+		if (i == 0)
+			head = (csv_header ? __csvNextRowHead(base, 0, length, false) : 0);
+		else if (head > 0 && (base[head-1] != '\n' || (nquotes & 1) != 0))
+			head = __csvNextRowHead(base, head, length, (nquotes & 1) != 0);
+		heads[i] = (i == 0 || head > heads[i-1] ? head : heads[i-1]);
+		nquotes += workers[i].nquotes;
+	}
+	heads[num_worker_threads] = length;
+
+	/* 2nd pass: parse the rows */
+	for (i=0; i < num_worker_threads; i++)
+	{
+		csvWorker  *w = &workers[i];
+
+		w->head = heads[i];
+		w->tail = heads[i+1];
+		if ((errno = pthread_create(&w->thread, NULL,
+									csvParseRowsMain, w)) != 0)
+			Elog("failed on pthread_create: %m");
+	}
+	for (i=0; i < num_worker_threads; i++)
+	{
+		if ((errno = pthread_join(workers[i].thread, NULL)) != 0)
+			Elog("failed on pthread_join: %m");
+		nrows += workers[i].nrows;
+		if (workers[i].scratch.data)
+			pfree(workers[i].scratch.data);
+	}
+	if (shows_progress)
+		printf("%s: %lu rows\n", filename, nrows);
+	pfree(workers);
+	munmap((void *)base, length);
+	close(fdesc);
+}
+
+/* ----------------------------------------------------------------
+ *
+ * Schema definition
+ *
+ * ----------------------------------------------------------------
+ */
+static char *
+__trim(char *token)
+{
+	char   *tail = token + strlen(token) - 1;
+
+	while (*token == ' ' || *token == '\t')
+		token++;
+	while (tail >= token && (*tail == ' ' || *tail == '\t' ||
+							 *tail == '\r' || *tail == '\n'))
+		*tail-- = '\0';
+	return token;
+}
+
+static void
+__appendCsvColumn(const char *colname, const char *typname)
+{
+	csvColumn  *ccol;
+
+	csv_columns = repalloc(csv_columns, sizeof(csvColumn) *
+						   (csv_num_columns + 1));
+	ccol = &csv_columns[csv_num_columns++];
+	ccol->colname = pstrdup(colname);
+	ccol->typname = pstrdup(typname);
+	ccol->parse_value = NULL;
+}
+
+/*
+ * --schema='NAME:TYPE,NAME:TYPE,...'
+ */
+static void
+parseSchemaDefinition(void)
+{
+	char   *temp = pstrdup(schema_definition);
+	char   *tok, *saveptr;
+
+	for (tok = strtok_r(temp, ",", &saveptr);
+		 tok != NULL;
+		 tok = strtok_r(NULL, ",", &saveptr))
+	{
+		char   *pos = strchr(tok, ':');
+
+		if (!pos)
+			Elog("invalid --schema token '%s'; NAME:TYPE is expected", tok);
+		*pos++ = '\0';
+		__appendCsvColumn(__trim(tok), __trim(pos));
+	}
+	if (csv_num_columns == 0)
+		Elog("--schema has no columns");
+}
+
+/*
+ * Without --schema, all the columns in the header line are text
+ */
+static void
+parseSchemaFromHeader(void)
+{
+	FILE	   *filp;
+	char	   *line = NULL;
+	size_t		bufsz = 0;
+	char	   *tok, *saveptr;
+	char		delim[2];
+
+	filp = fopen(input_filenames[0], "rb");
+	if (!filp)
+		Elog("failed on fopen('%s'): %m", input_filenames[0]);
+	if (getline(&line, &bufsz, filp) < 0)
+		Elog("failed to read the header line of '%s'", input_filenames[0]);
+	fclose(filp);
+
+	delim[0] = csv_delimiter;
+	delim[1] = '\0';
+	for (tok = strtok_r(line, delim, &saveptr);
+		 tok != NULL;
+		 tok = strtok_r(NULL, delim, &saveptr))
+	{
+		char   *colname = __trim(tok);
+		size_t	len = strlen(colname);
+
+		if (len >= 2 && colname[0] == csv_quote && colname[len-1] == csv_quote)
+		{
+			colname[len-1] = '\0';
+			colname++;
+		}
+		__appendCsvColumn(colname, "text");
+	}
+	free(line);
+}
+
+static void
+usage(void)
+{
+	fputs("usage: csv2arrow [OPTIONS] <csv files>...\n"
+		  "\n"
+		  "OPTIONS:\n"
+		  "  -o|--output=FILENAME  result file in Apache Arrow format\n"
+		  "  -S|--schema=NAME:TYPE[,NAME:TYPE...]\n"
+		  "       definition of the columns; TYPE is one of bool, int2,\n"
+		  "       int4, int8, float4, float8, date, timestamp or text.\n"
+		  "       (default: all text columns named by the header line)\n"
+		  "  --header           the first line of each file is a header\n"
+		  "  -d|--delimiter=CHAR  field delimiter (default: ',')\n"
+		  "  --null=STRING      string that represents NULL (default: empty)\n"
+		  "  -n|--parallel=N    number of parser threads\n"
+		  "                     (default: number of CPUs)\n"
+		  "  -s|--segment-size=SIZE size of record batch for each\n"
+		  "                     (default: 256MB)\n"
+		  "  --progress         shows progress of the job\n"
+		  "  -h|--help          shows this message\n"
+		  "\n"
+		  "  Copyright (C) 2020-2021 HeteroDB,Inc <contact@heterodb.com>\n"
+		  "  Copyright (C) 2020-2021 KaiGai Kohei <kaigai@kaigai.gr.jp>\n",
+		  stderr);
+	exit(1);
+}
+
+static void
+parse_options(int argc, char * const argv[])
+{
+	static struct option long_options[] = {
+		{"output",       required_argument, NULL, 'o'},
+		{"schema",       required_argument, NULL, 'S'},
+		{"delimiter",    required_argument, NULL, 'd'},
+		{"parallel",     required_argument, NULL, 'n'},
+		{"segment-size", required_argument, NULL, 's'},
+		{"header",       no_argument,       NULL, 1000},
+		{"null",         required_argument, NULL, 1001},
+		{"progress",     no_argument,       NULL, 1002},
+		{"help",         no_argument,       NULL, 'h'},
+		{NULL, 0, NULL, 0},
+	};
+	int			c;
+	char	   *end;
+
+	while ((c = getopt_long(argc, argv, "o:S:d:n:s:h",
+							long_options, NULL)) >= 0)
+	{
+		switch (c)
+		{
+			case 'o':
+				if (output_filename)
+					Elog("-o|--output was given twice");
+				output_filename = optarg;
+				break;
+			case 'S':
+				if (schema_definition)
+					Elog("-S|--schema was given twice");
+				schema_definition = optarg;
+				break;
+			case 'd':
+				if (strcmp(optarg, "\\t") == 0)
+					csv_delimiter = '\t';
+				else if (strlen(optarg) == 1 && *optarg != '\n' &&
+						 *optarg != csv_quote)
+					csv_delimiter = *optarg;
+				else
+					Elog("invalid -d|--delimiter '%s'", optarg);
+				break;
+			case 'n':
+				num_worker_threads = strtol(optarg, &end, 10);
+				if (*end != '\0' || num_worker_threads < 1)
+					Elog("invalid -n|--parallel '%s'", optarg);
+				break;
+			case 's':
+				batch_segment_sz = strtol(optarg, &end, 10);
+				if (strcasecmp(end, "k") == 0 || strcasecmp(end, "kb") == 0)
+					batch_segment_sz <<= 10;
+				else if (strcasecmp(end, "m") == 0 || strcasecmp(end, "mb") == 0)
+					batch_segment_sz <<= 20;
+				else if (strcasecmp(end, "g") == 0 || strcasecmp(end, "gb") == 0)
+					batch_segment_sz <<= 30;
+				else if (*end != '\0')
+					Elog("invalid -s|--segment-size '%s'", optarg);
+				if (batch_segment_sz < (32UL << 20))
+					Elog("too small -s|--segment-size '%s'", optarg);
+				break;
+			case 1000:
+				csv_header = true;
+				break;
+			case 1001:
+				csv_null_string = optarg;
+				break;
+			case 1002:
+				shows_progress = true;
+				break;
+			default:
+				usage();
+		}
+	}
+	if (optind >= argc)
+		Elog("no input CSV files were given");
+	input_filenames = (char **)(argv + optind);
+	num_input_files = argc - optind;
+	if (!output_filename)
+		Elog("-o|--output must be given");
+	csv_null_length = strlen(csv_null_string);
+	if (num_worker_threads < 0)
+	{
+		num_worker_threads = sysconf(_SC_NPROCESSORS_ONLN);
+		if (num_worker_threads < 1)
+			num_worker_threads = 1;
+	}
+	if (batch_segment_sz == 0)
+		batch_segment_sz = (1UL << 28);		/* 256MB in default */
+
+	if (schema_definition)
+		parseSchemaDefinition();
+	else if (csv_header)
+		parseSchemaFromHeader();
+	else
+		Elog("either -S|--schema or --header must be given");
+}
+
+int
+main(int argc, char * const argv[])
+{
+	int		i;
+
+	parse_options(argc, argv);
+
+	/* open the output file, then write out the schema */
+	main_table = setupCsvTable();
+	main_table->filename = output_filename;
+	main_table->fdesc = open(output_filename,
+							 O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (main_table->fdesc < 0)
+		Elog("failed on open('%s'): %m", output_filename);
+	arrowFileWrite(main_table, "ARROW1\0\0", 8);
+	writeArrowSchema(main_table);
+
+	/* per-worker buffers; they are kept across the input files */
+	worker_tables = palloc0(sizeof(SQLtable *) * num_worker_threads);
+	for (i=0; i < num_worker_threads; i++)
+		worker_tables[i] = setupCsvTable();
+
+	for (i=0; i < num_input_files; i++)
+		csvProcessOneFile(input_filenames[i]);
+
+	/* flush the remaining rows */
+	for (i=0; i < num_worker_threads; i++)
+	{
+		if (worker_tables[i]->nitems > 0)
+			writeArrowRecordBatchParallel(worker_tables[i]);
+	}
+	writeArrowFooter(main_table);
+	if (shows_progress)
+		printf("total %zu rows in %d record batches\n",
+			   main_table->nitems, main_table->numRecordBatches);
+	close(main_table->fdesc);
+
+	return 0;
+}
+
+/*
+ * memory allocation handlers
+ */
+void *
+palloc(size_t sz)
+{
+	void   *ptr = malloc(sz);
+
+	if (!ptr)
+		Elog("out of memory");
+	return ptr;
+}
+
+void *
+palloc0(size_t sz)
+{
+	void   *ptr = malloc(sz);
+
+	if (!ptr)
+		Elog("out of memory");
+	memset(ptr, 0, sz);
+	return ptr;
+}
+
+char *
+pstrdup(const char *str)
+{
+	char   *ptr = strdup(str);
+
+	if (!ptr)
+		Elog("out of memory");
+	return ptr;
+}
+
+void *
+repalloc(void *old, size_t sz)
+{
+	char   *ptr = realloc(old, sz);
+
+	if (!ptr)
+		Elog("out of memory");
+	return ptr;
+}
+
+void
+pfree(void *ptr)
+{
+	free(ptr);
+}
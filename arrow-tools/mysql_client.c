@@ -859,6 +859,8 @@ mysql_setup_attribute(MYSQL *conn,
 typedef struct {
 	MYSQL	   *conn;
 	MYSQL_RES  *res;
+	bool		in_transaction;
+	bool		global_lock;	/* FLUSH TABLES WITH READ LOCK by --parallel */
 } MYSTATE;
 
 /*
@@ -883,6 +885,8 @@ sqldb_server_connect(const char *sqldb_hostname,
 
 	if (nestloop_option_list != NULL)
 		Elog("Bug? mysql2arrow does not support --inner-join/--outer-join");
+	if (sqldb_binary_copy)
+		Elog("mysql2arrow does not support --binary-copy option");
 	
 	conn = mysql_init(NULL);
 	if (!conn)
@@ -967,11 +971,24 @@ sqldb_begin_query(void *sqldb_state,
 	int			j, nfields;
 	const char *query;
 
-	/* start transaction with read-only mode */
-	query = "START TRANSACTION READ ONLY";
-	if (mysql_query(conn, query) != 0)
-		Elog("failed on mysql_query('%s'): %s",
-			 query, mysql_error(conn));
+	/* start transaction with read-only mode, unless --parallel did */
+	if (!mystate->in_transaction)
+	{
+		query = "START TRANSACTION READ ONLY";
+		if (mysql_query(conn, query) != 0)
+			Elog("failed on mysql_query('%s'): %s",
+				 query, mysql_error(conn));
+		mystate->in_transaction = true;
+	}
+	/* all the workers already have their snapshot, if --parallel */
+	if (mystate->global_lock)
+	{
+		query = "UNLOCK TABLES";
+		if (mysql_query(conn, query) != 0)
+			Elog("failed on mysql_query('%s'): %s",
+				 query, mysql_error(conn));
+		mystate->global_lock = false;
+	}
 
 	/* exec SQL command  */
 	if (mysql_query(conn, sqldb_command) != 0)
@@ -1049,6 +1066,175 @@ sqldb_close_connection(void *sqldb_state)
 	mysql_close(mystate->conn);
 }
 
+/*
+ * __mysql_begin_consistent_snapshot
+ */
+static void
+__mysql_begin_consistent_snapshot(MYSTATE *mystate)
+{
+	const char *query = "START TRANSACTION WITH CONSISTENT SNAPSHOT, READ ONLY";
+
+	assert(!mystate->in_transaction);
+	if (mysql_query(mystate->conn, query) != 0)
+		Elog("failed on mysql_query('%s'): %s",
+			 query, mysql_error(mystate->conn));
+	mystate->in_transaction = true;
+}
+
+/*
+ * sqldb_export_snapshot
+ *
+ * MySQL has no way to share a snapshot across sessions, so we block any
+ * writes by the global read lock until all the worker sessions start their
+ * consistent snapshot; like mysqldump/mydumper doing. The lock shall be
+ * released at sqldb_begin_query() of the first connection.
+ */
+char *
+sqldb_export_snapshot(void *sqldb_state)
+{
+	MYSTATE	   *mystate = (MYSTATE *)sqldb_state;
+	const char *query = "FLUSH TABLES WITH READ LOCK";
+
+	if (mysql_query(mystate->conn, query) == 0)
+		mystate->global_lock = true;
+	else
+		fprintf(stderr,
+				"warning: failed on mysql_query('%s'): %s\n"
+				"parallel workers may not see a consistent image of the table\n",
+				query, mysql_error(mystate->conn));
+	__mysql_begin_consistent_snapshot(mystate);
+
+	return pstrdup(mystate->global_lock ? "global-read-lock" : "none");
+}
+
+/*
+ * sqldb_import_snapshot
+ */
+void
+sqldb_import_snapshot(void *sqldb_state, const char *snapshot)
+{
+	__mysql_begin_consistent_snapshot((MYSTATE *)sqldb_state);
+}
+
+/*
+ * sqldb_parallel_commands - split the relation by the primary key range
+ *
+ * The leading column of the primary key must be an integer type.
+ */
+char **
+sqldb_parallel_commands(void *sqldb_state, const char *relname, int nworkers)
+{
+	MYSTATE	   *mystate = (MYSTATE *)sqldb_state;
+	MYSQL	   *conn = mystate->conn;
+	MYSQL_RES  *res;
+	MYSQL_ROW	row;
+	char	   *query;
+	char	   *schema;
+	char	   *table;
+	char	   *pkey;
+	char	  **commands;
+	long long	min_value = 0;
+	long long	max_value = 0;
+	__int128	unitsz;
+	long long	lower, upper;
+	int			i;
+
+	/* relname may be qualified by the database name */
+	schema = alloca(strlen(relname) + 10);
+	strcpy(schema, relname);
+	table = strchr(schema, '.');
+	if (table)
+		*table++ = '\0';
+	else
+	{
+		table = schema;
+		schema = NULL;
+	}
+
+	query = alloca(strlen(relname) + 1000);
+	sprintf(query,
+			"SELECT c.COLUMN_NAME, c.DATA_TYPE"
+			"  FROM information_schema.KEY_COLUMN_USAGE k,"
+			"       information_schema.COLUMNS c"
+			" WHERE k.TABLE_SCHEMA = c.TABLE_SCHEMA"
+			"   AND k.TABLE_NAME = c.TABLE_NAME"
+			"   AND k.COLUMN_NAME = c.COLUMN_NAME"
+			"   AND k.CONSTRAINT_NAME = 'PRIMARY'"
+			"   AND k.ORDINAL_POSITION = 1"
+			"   AND k.TABLE_SCHEMA = %s%s%s"
+			"   AND k.TABLE_NAME = '%s'",
+			schema ? "'" : "",
+			schema ? schema : "DATABASE()",
+			schema ? "'" : "",
+			table);
+	if (mysql_query(conn, query) != 0)
+		Elog("failed on mysql_query('%s'): %s",
+			 query, mysql_error(conn));
+	res = mysql_store_result(conn);
+	if (!res)
+		Elog("failed on mysql_store_result: %s", mysql_error(conn));
+	row = mysql_fetch_row(res);
+	if (!row)
+		Elog("--parallel requires primary key on the table '%s'", relname);
+	if (strcasecmp(row[1], "tinyint") != 0 &&
+		strcasecmp(row[1], "smallint") != 0 &&
+		strcasecmp(row[1], "mediumint") != 0 &&
+		strcasecmp(row[1], "int") != 0 &&
+		strcasecmp(row[1], "bigint") != 0)
+		Elog("--parallel requires the primary key of integer type, but '%s.%s' is %s",
+			 relname, row[0], row[1]);
+	pkey = pstrdup(row[0]);
+	mysql_free_result(res);
+
+	/* range of the primary key; on the consistent snapshot */
+	sprintf(query, "SELECT MIN(`%s`), MAX(`%s`) FROM %s",
+			pkey, pkey, relname);
+	if (mysql_query(conn, query) != 0)
+		Elog("failed on mysql_query('%s'): %s",
+			 query, mysql_error(conn));
+	res = mysql_store_result(conn);
+	if (!res)
+		Elog("failed on mysql_store_result: %s", mysql_error(conn));
+	row = mysql_fetch_row(res);
+	if (row && row[0] && row[1])
+	{
+		errno = 0;
+		min_value = strtoll(row[0], NULL, 10);
+		max_value = strtoll(row[1], NULL, 10);
+		if (errno != 0)
+			Elog("primary key range [%s, %s] is not supported by --parallel",
+				 row[0], row[1]);
+	}
+	mysql_free_result(res);
+
+	/*
+	 * [min_value, max_value] is split into nworkers ranges; the first and
+	 * the last worker have no lower / upper bound for safety.
+	 */
+	unitsz = ((__int128)max_value - (__int128)min_value + nworkers) / nworkers;
+	commands = palloc0(sizeof(char *) * nworkers);
+	for (i=0; i < nworkers; i++)
+	{
+		__int128	__lower = (__int128)min_value + unitsz * i;
+		__int128	__upper = (__int128)min_value + unitsz * (i+1);
+
+		lower = (__lower < max_value ? __lower : max_value);
+		upper = (__upper < max_value ? __upper : max_value);
+
+		commands[i] = palloc(strlen(relname) + 2 * strlen(pkey) + 200);
+		if (i == 0)
+			sprintf(commands[i], "SELECT * FROM %s WHERE `%s` < %lld",
+					relname, pkey, upper);
+		else if (i < nworkers - 1)
+			sprintf(commands[i], "SELECT * FROM %s WHERE `%s` >= %lld AND `%s` < %lld",
+					relname, pkey, lower, pkey, upper);
+		else
+			sprintf(commands[i], "SELECT * FROM %s WHERE `%s` >= %lld",
+					relname, pkey, lower);
+	}
+	return commands;
+}
+
 /*
  * PG12 or later replaces XXprintf by pg_XXprintf
  */
@@ -66,6 +66,11 @@ static bool				enable_direct_io = false;
 static bool				only_headers = false;
 static bool				composite_options = false;
 static int				print_stat_interval = -1;
+static int				num_write_threads = 1;
+static int				num_async_writers = 0;
+static bool				flow_mode = false;
+static int				flow_inactive_timeout = 15;		/* sec */
+static int				flow_active_timeout = 300;		/* sec */
 
 /*
  * definition of output Arrow files
@@ -92,6 +97,17 @@ static pthread_cond_t	arrow_workers_cond;
 static bool			   *arrow_workers_completed;
 static SQLtable		  **arrow_chunks_array;			/* chunk buffer per-thread */
 static sem_t			pcap_worker_sem;
+
+/* static variables for asynchronous writer threads */
+static pthread_mutex_t	arrow_async_mutex;
+static pthread_cond_t	arrow_async_cond;
+static SQLtable		  **arrow_async_pending;	/* FIFO of chunks to be written */
+static int				arrow_async_head = 0;
+static int				arrow_async_npending = 0;
+static SQLtable		  **arrow_async_free;		/* spare chunks */
+static int				arrow_async_nfree = 0;
+static int				arrow_async_nrooms = 0;
+static bool				arrow_async_terminate = false;
 #ifndef DIRECT_IO_ALIGN
 #define DIRECT_IO_ALIGN(x)		(((x) + 511UL) & ~511UL)
 #endif /* DIRECT_IO_ALIGN */
@@ -337,6 +353,22 @@ put_uint32_value_bswap(SQLfield *column, const char *addr, int sz)
 	return __buffer_usage_inline_type(column);
 }
 
+static size_t
+put_uint64_value(SQLfield *column, const char *addr, int sz)
+{
+	size_t		index = column->nitems++;
+
+	Assert(!addr || sz == sizeof(uint64_t));
+	if (!addr)
+		__put_inline_null_value(column, index, sizeof(uint64_t));
+	else
+	{
+		sql_buffer_setbit(&column->nullmap, index);
+		sql_buffer_append(&column->values, addr, sizeof(uint64_t));
+	}
+	return __buffer_usage_inline_type(column);
+}
+
 static size_t
 put_timestamp_us_value(SQLfield *column, const char *addr, int sz)
 {
@@ -595,6 +627,22 @@ arrowFieldInitAsUint32Bswap(SQLtable *table, int cindex, const char *field_name)
 	table->numBuffers += 2;
 }
 
+static void
+arrowFieldInitAsUint64(SQLtable *table, int cindex, const char *field_name)
+{
+	SQLfield   *column = &table->columns[cindex];
+
+	memset(column, 0, sizeof(SQLfield));
+	initArrowNode(&column->arrow_type, Int);
+	column->arrow_type.Int.bitWidth = 64;
+	column->arrow_type.Int.is_signed = false;
+	column->put_value = put_uint64_value;
+	column->field_name = pstrdup(field_name);
+
+	table->numFieldNodes++;
+	table->numBuffers += 2;
+}
+
 static void
 arrowFieldInitAsTimestampUs(SQLtable *table, int cindex, const char *field_name)
 {
@@ -757,6 +805,11 @@ static int arrow_cindex__icmp_code			= -1;
 static int arrow_cindex__icmp_checksum		= -1;
 /* Payload */
 static int arrow_cindex__payload			= -1;
+/* Flow records (--flow) */
+static int arrow_cindex__first_timestamp	= -1;
+static int arrow_cindex__last_timestamp		= -1;
+static int arrow_cindex__packets			= -1;
+static int arrow_cindex__bytes				= -1;
 
 static int
 arrowPcapSchemaInit(SQLtable *table)
@@ -772,6 +825,37 @@ arrowPcapSchemaInit(SQLtable *table)
 		arrowFieldInitAs##__TYPE(table, j++, (#__NAME));	\
 	} while(0)
 
+	/* flow records, instead of the packets */
+	if (flow_mode)
+	{
+		__ARROW_FIELD_INIT(first_timestamp, TimestampUs);
+		__ARROW_FIELD_INIT(last_timestamp,  TimestampUs);
+		if ((protocol_mask & __PCAP_PROTO__IPv4) != 0)
+		{
+			__ARROW_FIELD_INIT(src_addr,	IP4Addr);
+			__ARROW_FIELD_INIT(dst_addr,	IP4Addr);
+		}
+		if ((protocol_mask & __PCAP_PROTO__IPv6) != 0)
+		{
+			__ARROW_FIELD_INIT(src_addr6,	IP6Addr);
+			__ARROW_FIELD_INIT(dst_addr6,	IP6Addr);
+		}
+		__ARROW_FIELD_INIT(protocol,		Uint8);
+		if ((protocol_mask & (__PCAP_PROTO__TCP |
+							  __PCAP_PROTO__UDP)) != 0)
+		{
+			__ARROW_FIELD_INIT(src_port,	Uint16);
+			__ARROW_FIELD_INIT(dst_port,	Uint16);
+		}
+		if ((protocol_mask & __PCAP_PROTO__TCP) != 0)
+			__ARROW_FIELD_INIT(tcp_flags,	Uint16);	/* OR of the flags */
+		__ARROW_FIELD_INIT(packets,			Uint64);
+		__ARROW_FIELD_INIT(bytes,			Uint64);
+		table->nfields = j;
+
+		return j;
+	}
+
 	/* timestamp and mac-address */
     __ARROW_FIELD_INIT(timestamp,	TimestampUs);
     __ARROW_FIELD_INIT(dst_mac,		MacAddr);
@@ -1824,6 +1908,487 @@ arrowMergeChunkWriteOut(SQLtable *dchunk, SQLtable *schunk)
 	}
 }
 
+/*
+ * arrowChunkSubmitAsync
+ *
+ * It hands off the filled chunk to the asynchronous writer threads, and
+ * returns a spare chunk to continue packet capture. The caller is blocked
+ * only if all the spare chunks are still pending, that means the storage
+ * cannot follow the capture throughput at all.
+ */
+static SQLtable *
+arrowChunkSubmitAsync(SQLtable *chunk)
+{
+	SQLtable   *spare;
+	int			index;
+
+	pthreadMutexLock(&arrow_async_mutex);
+	Assert(arrow_async_npending < arrow_async_nrooms);
+	index = (arrow_async_head + arrow_async_npending++) % arrow_async_nrooms;
+	arrow_async_pending[index] = chunk;
+	pthreadCondBroadcast(&arrow_async_cond);
+	while (arrow_async_nfree == 0)
+		pthreadCondWait(&arrow_async_cond, &arrow_async_mutex);
+	spare = arrow_async_free[--arrow_async_nfree];
+	pthreadMutexUnlock(&arrow_async_mutex);
+
+	return spare;
+}
+
+/*
+ * arrowChunkFlush
+ */
+static SQLtable *
+arrowChunkFlush(SQLtable *chunk)
+{
+	if (num_async_writers == 0)
+	{
+		arrowChunkWriteOut(chunk);
+		sql_table_clear(chunk);
+	}
+	else
+	{
+		chunk = arrowChunkSubmitAsync(chunk);
+		arrow_chunks_array[worker_id] = chunk;
+	}
+	return chunk;
+}
+
+/*
+ * arrow_async_writer_main
+ */
+static void *
+arrow_async_writer_main(void *__arg)
+{
+	SQLtable   *chunk;
+
+	for (;;)
+	{
+		pthreadMutexLock(&arrow_async_mutex);
+		while (arrow_async_npending == 0 && !arrow_async_terminate)
+			pthreadCondWait(&arrow_async_cond, &arrow_async_mutex);
+		if (arrow_async_npending == 0)
+		{
+			pthreadMutexUnlock(&arrow_async_mutex);
+			break;
+		}
+		chunk = arrow_async_pending[arrow_async_head];
+		arrow_async_head = (arrow_async_head + 1) % arrow_async_nrooms;
+		arrow_async_npending--;
+		pthreadMutexUnlock(&arrow_async_mutex);
+
+		arrowChunkWriteOut(chunk);
+		sql_table_clear(chunk);
+
+		pthreadMutexLock(&arrow_async_mutex);
+		arrow_async_free[arrow_async_nfree++] = chunk;
+		pthreadCondBroadcast(&arrow_async_cond);
+		pthreadMutexUnlock(&arrow_async_mutex);
+	}
+	return NULL;
+}
+
+/* ----------------------------------------------------------------
+ *
+ * Routines for per-flow aggregation mode (--flow)
+ *
+ * Each worker thread has its own flow hash table, so no locks are needed
+ * to update the entries. Flow records are emitted into the chunk buffer
+ * of the worker on FIN/RST of TCP, inactive timeout or active timeout;
+ * these timeouts are checked by the timestamp of the captured packets.
+ * Note that the packets of one flow may be captured by multiple threads,
+ * thus, a flow may be recorded as multiple partial flow records.
+ *
+ * ----------------------------------------------------------------
+ */
+typedef struct
+{
+	uint8_t		ip_version;		/* 4 or 6 */
+	uint8_t		protocol;
+	uint16_t	src_port;		/* 0, if neither TCP nor UDP */
+	uint16_t	dst_port;
+	uint8_t		src_addr[IP6ADDR_LEN];	/* IPv4 uses the first 4 bytes */
+	uint8_t		dst_addr[IP6ADDR_LEN];
+} pcapFlowKey;
+
+typedef struct pcapFlowEntry
+{
+	struct pcapFlowEntry *hnext;	/* hash chain */
+	struct pcapFlowEntry *lru_prev;	/* LRU list; older first */
+	struct pcapFlowEntry *lru_next;
+	uint32_t	hash;
+	pcapFlowKey	key;
+	bool		has_ports;
+	uint16_t	tcp_flags;
+	uint64_t	first_ts;		/* usec */
+	uint64_t	last_ts;		/* usec */
+	uint64_t	packets;
+	uint64_t	bytes;
+} pcapFlowEntry;
+
+typedef struct
+{
+	pcapFlowEntry **slots;
+	uint32_t	nslots;
+	uint32_t	nitems;
+	pcapFlowEntry lru;			/* sentinel of the LRU list */
+	pcapFlowEntry *freelist;
+} pcapFlowTable;
+
+#define PCAP_FLOW_HASH_NSLOTS		(1U << 18)
+#define PCAP_FLOW_MAX_ENTRIES		(1U << 20)	/* per thread */
+#define PCAP_FLOW_EXPIRE_BATCH		64			/* per packet */
+
+static __thread pcapFlowTable *pcap_flow_table = NULL;
+
+static pcapFlowTable *
+pcapFlowTableCreate(void)
+{
+	pcapFlowTable *ftable = palloc0(sizeof(pcapFlowTable));
+
+	ftable->nslots = PCAP_FLOW_HASH_NSLOTS;
+	ftable->slots = palloc0(sizeof(pcapFlowEntry *) * ftable->nslots);
+	ftable->lru.lru_prev = &ftable->lru;
+	ftable->lru.lru_next = &ftable->lru;
+
+	return ftable;
+}
+
+static inline uint32_t
+__pcapFlowHash(const pcapFlowKey *key)
+{
+	const uint8_t *pos = (const uint8_t *)key;
+	uint32_t	hash = 0x811c9dc5U;		/* FNV-1a */
+	int			i;
+
+	for (i=0; i < sizeof(pcapFlowKey); i++)
+	{
+		hash ^= pos[i];
+		hash *= 0x01000193U;
+	}
+	return hash;
+}
+
+static pcapFlowEntry *
+pcapFlowLookupOrCreate(pcapFlowTable *ftable, const pcapFlowKey *key)
+{
+	pcapFlowEntry *entry;
+	uint32_t	hash = __pcapFlowHash(key);
+	uint32_t	index = hash % ftable->nslots;
+	int			i;
+
+	for (entry = ftable->slots[index]; entry; entry = entry->hnext)
+	{
+		if (entry->hash == hash &&
+			memcmp(&entry->key, key, sizeof(pcapFlowKey)) == 0)
+		{
+			/* detach from the LRU list */
+			entry->lru_prev->lru_next = entry->lru_next;
+			entry->lru_next->lru_prev = entry->lru_prev;
+			return entry;
+		}
+	}
+	/* allocation of a new entry */
+	if (!ftable->freelist)
+	{
+		pcapFlowEntry *block = palloc(sizeof(pcapFlowEntry) * 1024);
+
+		for (i=0; i < 1024; i++)
+		{
+			block[i].hnext = ftable->freelist;
+			ftable->freelist = &block[i];
+		}
+	}
+	entry = ftable->freelist;
+	ftable->freelist = entry->hnext;
+	memset(entry, 0, sizeof(pcapFlowEntry));
+	entry->hash = hash;
+	memcpy(&entry->key, key, sizeof(pcapFlowKey));
+	entry->hnext = ftable->slots[index];
+	ftable->slots[index] = entry;
+	ftable->nitems++;
+
+	return entry;
+}
+
+static void
+pcapFlowRemove(pcapFlowTable *ftable, pcapFlowEntry *entry)
+{
+	pcapFlowEntry **prev = &ftable->slots[entry->hash % ftable->nslots];
+
+	while (*prev != entry)
+	{
+		Assert(*prev != NULL);
+		prev = &(*prev)->hnext;
+	}
+	*prev = entry->hnext;
+	entry->lru_prev->lru_next = entry->lru_next;
+	entry->lru_next->lru_prev = entry->lru_prev;
+
+	entry->hnext = ftable->freelist;
+	ftable->freelist = entry;
+	ftable->nitems--;
+}
+
+/*
+ * pcapFlowEmit - put a flow record on the chunk buffer
+ */
+static void
+pcapFlowEmit(SQLtable *chunk, pcapFlowEntry *entry)
+{
+	__FIELD_PUT_VALUE_DECL;
+	pcapFlowKey	   *key = &entry->key;
+	struct timeval	tv;
+	uint8_t			proto = key->protocol;
+
+	tv.tv_sec  = entry->first_ts / 1000000UL;
+	tv.tv_usec = entry->first_ts % 1000000UL;
+	__FIELD_PUT_VALUE(first_timestamp, &tv, sizeof(struct timeval));
+	tv.tv_sec  = entry->last_ts / 1000000UL;
+	tv.tv_usec = entry->last_ts % 1000000UL;
+	__FIELD_PUT_VALUE(last_timestamp, &tv, sizeof(struct timeval));
+	if ((protocol_mask & __PCAP_PROTO__IPv4) != 0)
+	{
+		if (key->ip_version == 4)
+		{
+			__FIELD_PUT_VALUE(src_addr, key->src_addr, IP4ADDR_LEN);
+			__FIELD_PUT_VALUE(dst_addr, key->dst_addr, IP4ADDR_LEN);
+		}
+		else
+		{
+			__FIELD_PUT_VALUE(src_addr, NULL, 0);
+			__FIELD_PUT_VALUE(dst_addr, NULL, 0);
+		}
+	}
+	if ((protocol_mask & __PCAP_PROTO__IPv6) != 0)
+	{
+		if (key->ip_version == 6)
+		{
+			__FIELD_PUT_VALUE(src_addr6, key->src_addr, IP6ADDR_LEN);
+			__FIELD_PUT_VALUE(dst_addr6, key->dst_addr, IP6ADDR_LEN);
+		}
+		else
+		{
+			__FIELD_PUT_VALUE(src_addr6, NULL, 0);
+			__FIELD_PUT_VALUE(dst_addr6, NULL, 0);
+		}
+	}
+	__FIELD_PUT_VALUE(protocol, &proto, sizeof(uint8_t));
+	if ((protocol_mask & (__PCAP_PROTO__TCP | __PCAP_PROTO__UDP)) != 0)
+	{
+		if (entry->has_ports)
+		{
+			__FIELD_PUT_VALUE(src_port, &key->src_port, sizeof(uint16_t));
+			__FIELD_PUT_VALUE(dst_port, &key->dst_port, sizeof(uint16_t));
+		}
+		else
+		{
+			__FIELD_PUT_VALUE(src_port, NULL, 0);
+			__FIELD_PUT_VALUE(dst_port, NULL, 0);
+		}
+	}
+	if ((protocol_mask & __PCAP_PROTO__TCP) != 0)
+	{
+		if (proto == 0x06 && entry->has_ports)
+		{
+			__FIELD_PUT_VALUE(tcp_flags, &entry->tcp_flags, sizeof(uint16_t));
+		}
+		else
+		{
+			__FIELD_PUT_VALUE(tcp_flags, NULL, 0);
+		}
+	}
+	__FIELD_PUT_VALUE(packets, &entry->packets, sizeof(uint64_t));
+	__FIELD_PUT_VALUE(bytes,   &entry->bytes,   sizeof(uint64_t));
+	chunk->usage = usage;
+	chunk->nitems++;
+}
+
+/*
+ * pcapFlowTableFlushAll - emit all the flows at the end of capture
+ */
+static SQLtable *
+pcapFlowTableFlushAll(SQLtable *chunk)
+{
+	pcapFlowTable *ftable = pcap_flow_table;
+
+	if (!ftable)
+		return chunk;
+	while (ftable->lru.lru_next != &ftable->lru)
+	{
+		pcapFlowEntry *entry = ftable->lru.lru_next;
+
+		pcapFlowEmit(chunk, entry);
+		pcapFlowRemove(ftable, entry);
+		if (chunk->usage >= record_batch_threshold)
+			chunk = arrowChunkFlush(chunk);
+	}
+	return chunk;
+}
+
+/*
+ * __execFlowOnePacket
+ */
+static inline uint16_t
+__fetch_uint16_be(const u_char *pos)
+{
+	return ((uint16_t)pos[0] << 8) | (uint16_t)pos[1];
+}
+
+static void
+__execFlowOnePacket(SQLtable *chunk,
+					struct pfring_pkthdr *hdr, const u_char *pos)
+{
+	pcapFlowTable  *ftable = pcap_flow_table;
+	pcapFlowEntry  *entry;
+	pcapFlowKey		key;
+	const u_char   *end = pos + hdr->caplen;
+	uint64_t		ts;
+	uint16_t		ether_type;
+	uint16_t		tcp_flags = 0;
+	bool			has_ports = false;
+	int				count;
+
+	if (!ftable)
+		ftable = pcap_flow_table = pcapFlowTableCreate();
+	if (hdr->caplen < 14)
+		return;
+	if (print_stat_interval > 0)
+		atomicAdd64(&stat_raw_packet_length, hdr->len);
+	ether_type = __fetch_uint16_be(pos + 12);
+	pos += 14;
+
+	memset(&key, 0, sizeof(pcapFlowKey));
+	if (ether_type == 0x0800)		/* IPv4 */
+	{
+		int		head_sz;
+
+		if ((protocol_mask & __PCAP_PROTO__IPv4) == 0 ||
+			end - pos < 20 || (pos[0] & 0xf0) != 0x40)
+			return;
+		if (print_stat_interval > 0)
+			atomicAdd64(&stat_ip4_packet_count, 1);
+		head_sz = 4 * (pos[0] & 0x0f);
+		key.ip_version = 4;
+		key.protocol = pos[9];
+		memcpy(key.src_addr, pos + 12, IP4ADDR_LEN);
+		memcpy(key.dst_addr, pos + 16, IP4ADDR_LEN);
+		/* only the first fragment has the transport header */
+		if ((__fetch_uint16_be(pos + 6) & 0x1fff) != 0)
+			pos = end;
+		else
+			pos += head_sz;
+	}
+	else if (ether_type == 0x86dd)	/* IPv6 */
+	{
+		uint8_t		next;
+		int			sz;
+
+		if ((protocol_mask & __PCAP_PROTO__IPv6) == 0 ||
+			end - pos < 40 || (pos[0] & 0xf0) != 0x60)
+			return;
+		if (print_stat_interval > 0)
+			atomicAdd64(&stat_ip6_packet_count, 1);
+		key.ip_version = 6;
+		next = pos[6];
+		memcpy(key.src_addr, pos + 8,  IP6ADDR_LEN);
+		memcpy(key.dst_addr, pos + 24, IP6ADDR_LEN);
+		pos += 40;
+		/* walk on the IPv6 extension headers */
+		while (end - pos >= 8)
+		{
+			if (next == 0 || next == 43 || next == 60)
+				sz = 8 * pos[1] + 8;
+			else if (next == 44)	/* Fragment */
+				sz = 8;
+			else if (next == 51)	/* Authentication Header */
+				sz = 4 * pos[1] + 8;
+			else
+				break;
+			next = pos[0];
+			pos += sz;
+		}
+		key.protocol = next;
+	}
+	else
+	{
+		return;		/* neither IPv4 nor IPv6 */
+	}
+
+	if (key.protocol == 0x06 &&
+		(protocol_mask & __PCAP_PROTO__TCP) != 0 &&
+		end - pos >= 20)
+	{
+		if (print_stat_interval > 0)
+			atomicAdd64(&stat_tcp_packet_count, 1);
+		key.src_port = __fetch_uint16_be(pos);
+		key.dst_port = __fetch_uint16_be(pos + 2);
+		tcp_flags = __fetch_uint16_be(pos + 12) & 0x0fff;
+		has_ports = true;
+	}
+	else if (key.protocol == 0x11 &&
+			 (protocol_mask & __PCAP_PROTO__UDP) != 0 &&
+			 end - pos >= 8)
+	{
+		if (print_stat_interval > 0)
+			atomicAdd64(&stat_udp_packet_count, 1);
+		key.src_port = __fetch_uint16_be(pos);
+		key.dst_port = __fetch_uint16_be(pos + 2);
+		has_ports = true;
+	}
+	else if ((key.protocol == 0x01 || key.protocol == 0x3a) &&
+			 print_stat_interval > 0)
+	{
+		atomicAdd64(&stat_icmp_packet_count, 1);
+	}
+
+	/* update the flow */
+	ts = hdr->ts.tv_sec * 1000000UL + hdr->ts.tv_usec;
+	entry = pcapFlowLookupOrCreate(ftable, &key);
+	if (entry->packets == 0)
+		entry->first_ts = ts;
+	else if (ts >= entry->first_ts + flow_active_timeout * 1000000UL)
+	{
+		/* active timeout; emit the record, then restart the flow */
+		pcapFlowEmit(chunk, entry);
+		entry->tcp_flags = 0;
+		entry->first_ts = ts;
+		entry->packets = 0;
+		entry->bytes = 0;
+	}
+	entry->has_ports = has_ports;
+	entry->tcp_flags |= tcp_flags;
+	if (entry->last_ts < ts)
+		entry->last_ts = ts;
+	entry->packets++;
+	entry->bytes += hdr->len;
+	/* attach on the tail of the LRU list */
+	entry->lru_prev = ftable->lru.lru_prev;
+	entry->lru_next = &ftable->lru;
+	ftable->lru.lru_prev->lru_next = entry;
+	ftable->lru.lru_prev = entry;
+
+	/* TCP FIN or RST terminates the flow */
+	if ((tcp_flags & 0x0005) != 0)
+	{
+		pcapFlowEmit(chunk, entry);
+		pcapFlowRemove(ftable, entry);
+	}
+
+	/* expire the inactive flows, or the oldest flows if too many */
+	for (count=0; count < PCAP_FLOW_EXPIRE_BATCH; count++)
+	{
+		entry = ftable->lru.lru_next;
+		if (entry == &ftable->lru)
+			break;
+		if (ftable->nitems <= PCAP_FLOW_MAX_ENTRIES &&
+			entry->last_ts + flow_inactive_timeout * 1000000UL > ts)
+			break;
+		pcapFlowEmit(chunk, entry);
+		pcapFlowRemove(ftable, entry);
+	}
+}
+
 /*
  * __execCaptureOnePacket
  */
@@ -1838,6 +2403,11 @@ __execCaptureOnePacket(SQLtable *chunk,
 	int				src_port = -1;
 	int				dst_port = -1;
 
+	if (flow_mode)
+	{
+		__execFlowOnePacket(chunk, hdr, pos);
+		return;
+	}
 	pos = handlePacketRawEthernet(chunk, hdr, pos, &ether_type);
 	if (!pos)
 		goto fillup_by_null;
@@ -2057,8 +2627,10 @@ pfring_worker_main(void *__arg)
             Elog("failed on sem_post: %m");
 
 		if (status > 0)
-			arrowChunkWriteOut(chunk);
+			chunk = arrowChunkFlush(chunk);
 	}
+	if (flow_mode)
+		chunk = pcapFlowTableFlushAll(chunk);
 	return final_merge_pending_chunks(chunk);
 }
 
@@ -2104,14 +2676,13 @@ pcap_file_worker_main(void *__arg)
 			__hdr.len = hdr.len;
 			__execCaptureOnePacket(chunk, &__hdr, buffer);
 			if (chunk->usage >= record_batch_threshold)
-			{
-				arrowChunkWriteOut(chunk);
-				sql_table_clear(chunk);
-			}
+				chunk = arrowChunkFlush(chunk);
 		}
 		/* close */
 		pcap_close(pfdesc->pcap_handle);
     }
+	if (flow_mode)
+		chunk = pcapFlowTableFlushAll(chunk);
 	return final_merge_pending_chunks(chunk);
 }
 
@@ -2145,6 +2716,11 @@ usage(int status)
 		  "       opens multiple output files simultaneously (default: 1)\n"
 		  "     --chunk-size=SIZE : size of record batch (default: 128MB)\n"
 		  "     --direct-io : enables O_DIRECT for write-i/o\n"
+		  "     --write-threads=N_THREADS\n"
+		  "       writes out each record batch by multiple threads (default: 1)\n"
+		  "     --async-write=N_WRITERS\n"
+		  "       writes out record batches by background writer threads with\n"
+		  "       double-buffered chunks (default: 0; synchronous write)\n"
 		  "  -l|--limit=LIMIT : (default: no limit)\n"
 		  "  -p|--protocol=PROTO\n"
 		  "       PROTO is a comma separated string contains\n"
@@ -2153,6 +2729,10 @@ usage(int status)
 		  "       (default: 'tcp4,udp4,icmp4')\n"
 		  "     --composite-options:\n"
 		  "        write out IPv4,IPv6 and TCP options as an array of composite values\n"
+		  "     --flow : writes out flow records (5-tuple, packets, bytes, ...)\n"
+		  "        aggregated per flow, instead of the packets\n"
+		  "     --flow-timeout=INACTIVE[,ACTIVE]\n"
+		  "        timeout of the flows in seconds (default: 15,300)\n"
 		  "  -r|--rule=RULE : packet filtering rules\n"
 		  "       (default: none; valid only capturing mode)\n"
 		  "  -s|--stat=INTERVAL\n"
@@ -2186,6 +2766,10 @@ parse_options(int argc, char *argv[])
 		{"num-queues",     required_argument, NULL, 1004},
 		{"parallel-write", required_argument, NULL, 1005},
 		{"composite-options", no_argument,    NULL, 1006},
+		{"write-threads",  required_argument, NULL, 1007},
+		{"async-write",    required_argument, NULL, 1008},
+		{"flow",           no_argument,       NULL, 1009},
+		{"flow-timeout",   required_argument, NULL, 1010},
 		{"help",           no_argument,       NULL, 'h'},
 		{NULL, 0, NULL, 0}
 	};
@@ -2322,6 +2906,32 @@ parse_options(int argc, char *argv[])
 				composite_options = true;
 				break;
 
+			case 1007:	/* --write-threads */
+				num_write_threads = strtol(optarg, &pos, 10);
+				if (*pos != '\0' || num_write_threads < 1)
+					Elog("invalid --write-threads argument: %s", optarg);
+				break;
+
+			case 1008:	/* --async-write */
+				num_async_writers = strtol(optarg, &pos, 10);
+				if (*pos != '\0' || num_async_writers < 0)
+					Elog("invalid --async-write argument: %s", optarg);
+				break;
+
+			case 1009:	/* --flow */
+				flow_mode = true;
+				break;
+
+			case 1010:	/* --flow-timeout */
+				flow_inactive_timeout = strtol(optarg, &pos, 10);
+				if (*pos == ',')
+					flow_active_timeout = strtol(pos+1, &pos, 10);
+				if (*pos != '\0' ||
+					flow_inactive_timeout < 1 ||
+					flow_active_timeout < 1)
+					Elog("invalid --flow-timeout argument: %s", optarg);
+				break;
+
 			default:
 				usage(code == 'h' ? 0 : 1);
 				break;
@@ -2601,6 +3211,7 @@ init_pfring_input(void)
 int main(int argc, char *argv[])
 {
 	pthread_t  *workers;
+	pthread_t  *writers = NULL;
 	long		i, rv;
 
 	/* init misc variables */
@@ -2619,8 +3230,31 @@ int main(int argc, char *argv[])
 								 columns[PCAP_SCHEMA_MAX_NFIELDS]));
 		arrowPcapSchemaInit(chunk);
 		chunk->fdesc = -1;
+		chunk->write_nthreads = num_write_threads;
 		arrow_chunks_array[i] = chunk;
 	}
+	/* spare chunks for asynchronous writers; double buffered */
+	if (num_async_writers > 0)
+	{
+		int		nspares = 2 * num_async_writers;
+
+		pthreadMutexInit(&arrow_async_mutex);
+		pthreadCondInit(&arrow_async_cond);
+		arrow_async_nrooms = num_threads + nspares;
+		arrow_async_pending = palloc0(sizeof(SQLtable *) * arrow_async_nrooms);
+		arrow_async_free = palloc0(sizeof(SQLtable *) * arrow_async_nrooms);
+		for (i=0; i < nspares; i++)
+		{
+			SQLtable   *chunk;
+
+			chunk = palloc0(offsetof(SQLtable,
+									 columns[PCAP_SCHEMA_MAX_NFIELDS]));
+			arrowPcapSchemaInit(chunk);
+			chunk->fdesc = -1;
+			chunk->write_nthreads = num_write_threads;
+			arrow_async_free[arrow_async_nfree++] = chunk;
+		}
+	}
 
 	if (input_devname)
 		init_pfring_input();
@@ -2648,6 +3282,17 @@ int main(int argc, char *argv[])
 	pthreadCondInit(&arrow_workers_cond);
 	arrow_workers_completed = palloc0(sizeof(bool) * num_threads);
 
+	if (num_async_writers > 0)
+	{
+		writers = alloca(sizeof(pthread_t) * num_async_writers);
+		for (i=0; i < num_async_writers; i++)
+		{
+			rv = pthread_create(&writers[i], NULL,
+								arrow_async_writer_main, NULL);
+			if (rv != 0)
+				Elog("failed on pthread_create: %s", strerror(rv));
+		}
+	}
 	workers = alloca(sizeof(pthread_t) * num_threads);
 	for (i=0; i < num_threads; i++)
 	{
@@ -2676,6 +3321,21 @@ int main(int argc, char *argv[])
 		if (rv != 0)
 			Elog("failed on pthread_join: %s", strerror(rv));
 	}
+	/* wait for completion of the pending writes */
+	if (num_async_writers > 0)
+	{
+		pthreadMutexLock(&arrow_async_mutex);
+		arrow_async_terminate = true;
+		pthreadCondBroadcast(&arrow_async_cond);
+		pthreadMutexUnlock(&arrow_async_mutex);
+
+		for (i=0; i < num_async_writers; i++)
+		{
+			rv = pthread_join(writers[i], NULL);
+			if (rv != 0)
+				Elog("failed on pthread_join: %s", strerror(rv));
+		}
+	}
 	/* close the output files */
 	for (i=0; i < arrow_file_desc_nums; i++)
 		arrowCloseOutputFile(arrow_file_desc_array[i]);
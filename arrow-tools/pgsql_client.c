@@ -8,6 +8,8 @@
  * it under the terms of the PostgreSQL License.
  */
 #include "sql2arrow.h"
+#include <arpa/inet.h>
+#include <ctype.h>
 #include <limits.h>
 #include <libpq-fe.h>
 
@@ -50,6 +52,13 @@ typedef struct
 	PGresult   *res;
 	uint32_t	nitems;
 	uint32_t	index;
+	bool		in_transaction;	/* transaction is already opened */
+	/* if --binary-copy is given */
+	bool		copy_mode;
+	bool		copy_header;	/* true, if file header is already read */
+	char	   *copy_buf;		/* current CopyData message */
+	int			copy_len;
+	int			copy_pos;
 	/* if --nestloop is given */
 	uint32_t	n_depth;
 	PGSTATE_NL	nestloop[1];
@@ -379,6 +388,105 @@ pgsql_move_next(PGSTATE *pgstate, uint32_t *rows_index)
 	}
 }
 
+/*
+ * pgsql_copy_next_tuple
+ *
+ * It ensures the next tuple of COPY BINARY stream is available at
+ * copy_buf + copy_pos, or returns false if end of the stream.
+ * Each CopyData message usually contains exactly one tuple, and the file
+ * header is attached to the first one.
+ */
+static inline int16_t
+__copy_read_int16(PGSTATE *pgstate)
+{
+	uint16_t	ival;
+
+	if (pgstate->copy_pos + sizeof(uint16_t) > pgstate->copy_len)
+		Elog("COPY BINARY stream is broken");
+	memcpy(&ival, pgstate->copy_buf + pgstate->copy_pos, sizeof(uint16_t));
+	pgstate->copy_pos += sizeof(uint16_t);
+	return (int16_t)ntohs(ival);
+}
+
+static inline int32_t
+__copy_read_int32(PGSTATE *pgstate)
+{
+	uint32_t	ival;
+
+	if (pgstate->copy_pos + sizeof(uint32_t) > pgstate->copy_len)
+		Elog("COPY BINARY stream is broken");
+	memcpy(&ival, pgstate->copy_buf + pgstate->copy_pos, sizeof(uint32_t));
+	pgstate->copy_pos += sizeof(uint32_t);
+	return (int32_t)ntohl(ival);
+}
+
+static bool
+pgsql_copy_next_tuple(PGSTATE *pgstate)
+{
+	static const char signature[11] = "PGCOPY\n\377\r\n\0";
+	PGconn	   *conn = pgstate->conn;
+	PGresult   *res;
+	int			nbytes;
+
+	while (pgstate->copy_pos >= pgstate->copy_len)
+	{
+		if (pgstate->copy_buf)
+		{
+			PQfreemem(pgstate->copy_buf);
+			pgstate->copy_buf = NULL;
+			pgstate->copy_len = 0;
+			pgstate->copy_pos = 0;
+		}
+		if (!pgstate->copy_mode)
+			return false;	/* already reached to the end */
+		nbytes = PQgetCopyData(conn, &pgstate->copy_buf, 0);
+		if (nbytes == -1)
+		{
+			/* end of the COPY */
+			res = PQgetResult(conn);
+			if (PQresultStatus(res) != PGRES_COMMAND_OK)
+				Elog("failed on COPY BINARY: %s", PQresultErrorMessage(res));
+			PQclear(res);
+			pgstate->copy_mode = false;
+			return false;
+		}
+		else if (nbytes < 0)
+			Elog("failed on PQgetCopyData: %s", PQerrorMessage(conn));
+		pgstate->copy_len = nbytes;
+		pgstate->copy_pos = 0;
+
+		if (!pgstate->copy_header)
+		{
+			int32_t		flags;
+			int32_t		extlen;
+
+			if (nbytes < sizeof(signature) ||
+				memcmp(pgstate->copy_buf, signature, sizeof(signature)) != 0)
+				Elog("COPY BINARY stream has wrong signature");
+			pgstate->copy_pos = sizeof(signature);
+			flags = __copy_read_int32(pgstate);
+			if ((flags & (1 << 16)) != 0)
+				Elog("COPY BINARY stream with OIDs is not supported");
+			extlen = __copy_read_int32(pgstate);
+			if (extlen < 0 || pgstate->copy_pos + extlen > pgstate->copy_len)
+				Elog("COPY BINARY stream is broken");
+			pgstate->copy_pos += extlen;
+			pgstate->copy_header = true;
+		}
+	}
+	/* end of the stream? */
+	if (pgstate->copy_pos + sizeof(int16_t) <= pgstate->copy_len &&
+		memcmp(pgstate->copy_buf + pgstate->copy_pos, "\377\377", 2) == 0)
+	{
+		pgstate->copy_pos = pgstate->copy_len;
+		/* consume the remaining protocol messages */
+		while (pgsql_copy_next_tuple(pgstate))
+			Elog("COPY BINARY stream has data after the trailer");
+		return false;
+	}
+	return true;
+}
+
 /*
  * pgsql_create_dictionary
  */
@@ -997,6 +1105,111 @@ sqldb_server_connect(const char *sqldb_hostname,
 	return pgstate;
 }
 
+/*
+ * sqldb_export_snapshot - begin a transaction, then export its snapshot
+ */
+char *
+sqldb_export_snapshot(void *sqldb_state)
+{
+	PGSTATE	   *pgstate = sqldb_state;
+	PGconn	   *conn = pgstate->conn;
+	PGresult   *res;
+	char	   *snapshot;
+
+	assert(!pgstate->in_transaction);
+	res = PQexec(conn, "BEGIN ISOLATION LEVEL REPEATABLE READ READ ONLY");
+	if (PQresultStatus(res) != PGRES_COMMAND_OK)
+		Elog("unable to begin transaction: %s", PQresultErrorMessage(res));
+	PQclear(res);
+	pgstate->in_transaction = true;
+
+	res = PQexec(conn, "SELECT pg_catalog.pg_export_snapshot()");
+	if (PQresultStatus(res) != PGRES_TUPLES_OK ||
+		PQntuples(res) != 1 ||
+		PQgetisnull(res, 0, 0))
+		Elog("failed on pg_export_snapshot(): %s", PQresultErrorMessage(res));
+	snapshot = pstrdup(PQgetvalue(res, 0, 0));
+	PQclear(res);
+
+	return snapshot;
+}
+
+/*
+ * sqldb_import_snapshot - begin a transaction with the exported snapshot
+ */
+void
+sqldb_import_snapshot(void *sqldb_state, const char *snapshot)
+{
+	PGSTATE	   *pgstate = sqldb_state;
+	PGconn	   *conn = pgstate->conn;
+	PGresult   *res;
+	char		query[256];
+
+	assert(!pgstate->in_transaction);
+	res = PQexec(conn, "BEGIN ISOLATION LEVEL REPEATABLE READ READ ONLY");
+	if (PQresultStatus(res) != PGRES_COMMAND_OK)
+		Elog("unable to begin transaction: %s", PQresultErrorMessage(res));
+	PQclear(res);
+	pgstate->in_transaction = true;
+
+	snprintf(query, sizeof(query), "SET TRANSACTION SNAPSHOT '%s'", snapshot);
+	res = PQexec(conn, query);
+	if (PQresultStatus(res) != PGRES_COMMAND_OK)
+		Elog("failed on import snapshot: %s", PQresultErrorMessage(res));
+	PQclear(res);
+}
+
+/*
+ * sqldb_parallel_commands - split the relation by ctid range
+ */
+char **
+sqldb_parallel_commands(void *sqldb_state, const char *relname, int nworkers)
+{
+	PGSTATE	   *pgstate = sqldb_state;
+	PGconn	   *conn = pgstate->conn;
+	PGresult   *res;
+	char	   *query;
+	char	  **commands;
+	uint64_t	nblocks;
+	uint64_t	unitsz;
+	int			i;
+
+	query = alloca(strlen(relname) + 200);
+	sprintf(query,
+			"SELECT pg_catalog.pg_relation_size('%s'::regclass)"
+			" / pg_catalog.current_setting('block_size')::int",
+			relname);
+	res = PQexec(conn, query);
+	if (PQresultStatus(res) != PGRES_TUPLES_OK ||
+		PQntuples(res) != 1 ||
+		PQgetisnull(res, 0, 0))
+		Elog("failed on getting relation size of '%s': %s",
+			 relname, PQresultErrorMessage(res));
+	nblocks = strtoul(PQgetvalue(res, 0, 0), NULL, 10);
+	PQclear(res);
+
+	unitsz = (nblocks + nworkers - 1) / nworkers;
+	commands = palloc0(sizeof(char *) * nworkers);
+	for (i=0; i < nworkers; i++)
+	{
+		commands[i] = palloc(strlen(relname) + 200);
+		/* the last worker also scans the blocks beyond nblocks, if any */
+		if (i < nworkers - 1)
+			sprintf(commands[i],
+					"SELECT * FROM %s WHERE ctid >= '(%lu,0)'::tid"
+					" AND ctid < '(%lu,0)'::tid",
+					relname,
+					(unsigned long)(unitsz * i),
+					(unsigned long)(unitsz * (i+1)));
+		else
+			sprintf(commands[i],
+					"SELECT * FROM %s WHERE ctid >= '(%lu,0)'::tid",
+					relname,
+					(unsigned long)(unitsz * i));
+	}
+	return commands;
+}
+
 /*
  * sqldb_begin_query
  */
@@ -1011,11 +1224,61 @@ sqldb_begin_query(void *sqldb_state,
 	PGresult   *res;
 	char	   *query;
 
-	/* begin read-only transaction */
-	res = PQexec(conn, "BEGIN READ ONLY");
-	if (PQresultStatus(res) != PGRES_COMMAND_OK)
-		Elog("unable to begin transaction: %s", PQresultErrorMessage(res));
-	PQclear(res);
+	/* begin read-only transaction, unless snapshot is exported/imported */
+	if (!pgstate->in_transaction)
+	{
+		res = PQexec(conn, "BEGIN READ ONLY");
+		if (PQresultStatus(res) != PGRES_COMMAND_OK)
+			Elog("unable to begin transaction: %s", PQresultErrorMessage(res));
+		PQclear(res);
+		pgstate->in_transaction = true;
+	}
+
+	/* fetch the results by COPY BINARY, instead of the cursor */
+	if (sqldb_binary_copy)
+	{
+		SQLtable   *table;
+		char	   *sql = pstrdup(sqldb_command);
+		char	   *tail = sql + strlen(sql) - 1;
+
+		if (pgstate->n_depth > 0)
+			Elog("--binary-copy does not support --inner-join/--outer-join");
+		while (tail >= sql && (isspace(*tail) || *tail == ';'))
+			*tail-- = '\0';
+
+		/* fetch the result type by describe of the prepared statement */
+		res = PQprepare(conn, "pstmt_copy", sql, 0, NULL);
+		if (PQresultStatus(res) != PGRES_COMMAND_OK)
+			Elog("unable to prepare the SQL command: %s",
+				 PQresultErrorMessage(res));
+		PQclear(res);
+		res = PQdescribePrepared(conn, "pstmt_copy");
+		if (PQresultStatus(res) != PGRES_COMMAND_OK)
+			Elog("unable to describe the SQL command: %s",
+				 PQresultErrorMessage(res));
+		pgstate->res = res;
+		table = pgsql_create_buffer(pgstate, af_info, dictionary_list);
+		pgstate->res = NULL;
+		PQclear(res);
+		res = PQexec(conn, "DEALLOCATE pstmt_copy");
+		if (PQresultStatus(res) != PGRES_COMMAND_OK)
+			Elog("failed on DEALLOCATE: %s", PQresultErrorMessage(res));
+		PQclear(res);
+
+		/* kick COPY BINARY */
+		query = palloc(strlen(sql) + 1024);
+		sprintf(query, "COPY (%s) TO STDOUT (FORMAT binary)", sql);
+		res = PQexec(conn, query);
+		if (PQresultStatus(res) != PGRES_COPY_OUT)
+			Elog("unable to begin COPY BINARY: %s", PQresultErrorMessage(res));
+		PQclear(res);
+		pgstate->copy_mode = true;
+
+		/* move to the first tuple */
+		if (!pgsql_copy_next_tuple(pgstate))
+			return NULL;
+		return table;
+	}
 
 	/* declare cursor */
 	query = palloc(strlen(sqldb_command) + 1024);
@@ -1046,6 +1309,35 @@ sqldb_fetch_results(void *sqldb_state, SQLtable *table)
 	int			i, j, ncols;
 	size_t		usage = 0;
 
+	if (sqldb_binary_copy)
+	{
+		/* decode the COPY BINARY tuple directly */
+		if (!pgsql_copy_next_tuple(pgstate))
+			return false;	/* end of the scan */
+		if (__copy_read_int16(pgstate) != table->nfields)
+			Elog("COPY BINARY tuple has unexpected number of fields");
+		for (i=0; i < table->nfields; i++)
+		{
+			SQLfield   *column = &table->columns[i];
+			int32_t		sz = __copy_read_int32(pgstate);
+
+			if (sz < 0)
+				usage += sql_field_put_value(column, NULL, 0);
+			else
+			{
+				if (pgstate->copy_pos + sz > pgstate->copy_len)
+					Elog("COPY BINARY stream is broken");
+				usage += sql_field_put_value(column, pgstate->copy_buf +
+											 pgstate->copy_pos, sz);
+				pgstate->copy_pos += sz;
+			}
+		}
+		table->usage = usage;
+		table->nitems++;
+
+		return true;
+	}
+
 	rows_index = alloca(sizeof(uint32_t) * (pgstate->n_depth + 1));
 	if (!pgsql_move_next(pgstate, rows_index))
 		return false;		/* end of the scan */
@@ -1110,11 +1402,14 @@ sqldb_close_connection(void *sqldb_state)
 			PQclear(nl->res);
 	}
 	/* close the cursor */
-	res = PQexec(conn, "CLOSE " CURSOR_NAME);
-	if (PQresultStatus(res) != PGRES_COMMAND_OK)
-		Elog("failed on close cursor '%s': %s", CURSOR_NAME,
-			 PQresultErrorMessage(res));
-	PQclear(res);
+	if (!sqldb_binary_copy)
+	{
+		res = PQexec(conn, "CLOSE " CURSOR_NAME);
+		if (PQresultStatus(res) != PGRES_COMMAND_OK)
+			Elog("failed on close cursor '%s': %s", CURSOR_NAME,
+				 PQresultErrorMessage(res));
+		PQclear(res);
+	}
 	/* close the connection */
 	PQfinish(conn);
 }
@@ -12,6 +12,7 @@
 #include <ctype.h>
 #include <getopt.h>
 #include <limits.h>
+#include <pthread.h>
 #include <signal.h>
 #include <stdlib.h>
 #include <stdio.h>
@@ -29,6 +30,12 @@ static char	   *sqldb_password = NULL;
 static char	   *sqldb_database = NULL;
 static char	   *dump_arrow_filename = NULL;
 static char	   *stat_embedded_columns = NULL;
+static char	   *bloom_embedded_columns = NULL;
+static char	   *sort_by_columns = NULL;
+static char	   *sqldb_table_name = NULL;
+static int		num_parallel_workers = 1;
+static int		num_write_threads = 1;
+bool			sqldb_binary_copy = false;
 static int		shows_progress = 0;
 static userConfigOption *sqldb_session_configs = NULL;
 static nestLoopOption *sqldb_nestloop_options = NULL;
@@ -560,6 +567,84 @@ enable_embedded_stats(SQLtable *table)
 	}
 }
 
+static bool
+__enable_field_bloom(SQLfield *field)
+{
+	switch (field->arrow_type.node.tag)
+	{
+		case ArrowNodeTag__Int:
+		case ArrowNodeTag__Date:
+		case ArrowNodeTag__Timestamp:
+		case ArrowNodeTag__Utf8:
+		case ArrowNodeTag__Binary:
+			if (field->enumdict)
+				return false;
+			field->bloom_enabled = true;
+			memset(&field->bloom_datum, 0, sizeof(SQLbloom));
+			field->bloom_list = NULL;
+			return true;
+		default:
+			break;
+	}
+	return false;
+}
+
+static void
+enable_embedded_bloom(SQLtable *table)
+{
+	char	   *buffer;
+	char	   *name, *pos;
+	int			j;
+
+	/* disabled? */
+	if (!bloom_embedded_columns)
+		return;
+
+	/* special case - all available columns? */
+	if (strcmp(bloom_embedded_columns, "*") == 0)
+	{
+		for (j=0; j < table->nfields; j++)
+		{
+			if (__enable_field_bloom(&table->columns[j]))
+				table->has_bloom_filters = true;
+		}
+		return;
+	}
+
+	/* elsewhere, enables bloom filter for each column specified */
+	buffer = alloca(strlen(bloom_embedded_columns) + 1);
+	strcpy(buffer, bloom_embedded_columns);
+	for (name = strtok_r(buffer, ",", &pos);
+		 name != NULL;
+		 name = strtok_r(NULL, ",", &pos))
+	{
+		bool	found = false;
+
+		name = __trim(name);
+		for (j=0; j < table->nfields; j++)
+		{
+			SQLfield   *field = &table->columns[j];
+
+			if (strcmp(field->field_name, name) == 0)
+			{
+				if (__enable_field_bloom(field))
+				{
+					table->has_bloom_filters = found = true;
+				}
+				else
+				{
+					Elog("field [%s; %s] does not support bloom filter",
+						 name, field->arrow_type.node.tagName);
+				}
+			}
+		}
+
+		if (!found)
+			Elog("field name [%s], specified by --bloom option, was not found",
+				 name);
+	}
+}
+
 static void
 usage(void)
 {
@@ -582,12 +667,23 @@ usage(void)
 		  "      --append=FILENAME result Apache Arrow file to be appended\n"
 		  "      (--output and --append are exclusive. If neither of them\n"
 		  "       are given, it creates a temporary file.)\n"
+		  "      --sort-by=COLUMNS sorts the results by COLUMNS (ORDER BY clause)\n"
+		  "                       to cluster the record batches\n"
 		  "  -S, --stat[=COLUMNS] embeds min/max statistics for each record batch\n"
 		  "                       COLUMNS is a comma-separated list of the target\n"
 		  "                       columns if partially enabled.\n"
+		  "      --bloom[=COLUMNS] embeds bloom filter for each record batch\n"
+		  "                       COLUMNS is a comma-separated list of the target\n"
+		  "                       columns if partially enabled.\n"
 		  "\n"
 		  "Arrow format options:\n"
 		  "  -s, --segment-size=SIZE size of record batch for each\n"
+		  "  -n, --parallel=N     number of parallel workers to export the table\n"
+		  "                       specified by -t option (default: 1)\n"
+		  "      --binary-copy    fetch the results by COPY ... TO STDOUT\n"
+		  "                       (FORMAT binary), instead of the cursor\n"
+		  "      --write-threads=N number of threads to write out each\n"
+		  "                       record batch in parallel (default: 1)\n"
 		  "\n"
 		  "Connection options:\n"
 		  "  -h, --host=HOSTNAME  database server host\n"
@@ -638,6 +734,11 @@ parse_options(int argc, char * const argv[])
 		{"inner-join",   required_argument, NULL, 1004},
 		{"outer-join",   required_argument, NULL, 1005},
 		{"stat",         optional_argument, NULL, 'S'},
+		{"bloom",        optional_argument, NULL, 1006},
+		{"sort-by",      required_argument, NULL, 1007},
+		{"parallel",     required_argument, NULL, 'n'},
+		{"binary-copy",  no_argument,       NULL, 1008},
+		{"write-threads", required_argument, NULL, 1009},
 		{"help",         no_argument,       NULL, 9999},
 		{NULL, 0, NULL, 0},
 	};
@@ -650,7 +751,7 @@ parse_options(int argc, char * const argv[])
 	nestLoopOption *last_nest_loop __attribute__((unused)) = NULL;
 
 	while ((c = getopt_long(argc, argv,
-							"d:c:t:o:s:h:p:u:"
+							"d:c:t:o:s:n:h:p:u:"
 #ifdef __PG2ARROW__
 							"wW"
 #endif
@@ -687,6 +788,7 @@ parse_options(int argc, char * const argv[])
 				if (!sqldb_command)
 					Elog("out of memory");
 				sprintf(sqldb_command, "SELECT * FROM %s", optarg);
+				sqldb_table_name = optarg;
 				break;
 
 			case 'o':
@@ -821,6 +923,42 @@ parse_options(int argc, char * const argv[])
 						stat_embedded_columns = "*";
 				}
 				break;
+			case 1006:		/* --bloom */
+				{
+					if (bloom_embedded_columns)
+						Elog("--bloom option was supplied twice");
+					if (optarg)
+						bloom_embedded_columns = optarg;
+					else
+						bloom_embedded_columns = "*";
+				}
+				break;
+			case 'n':		/* --parallel */
+				{
+					char   *end;
+
+					num_parallel_workers = strtol(optarg, &end, 10);
+					if (*end != '\0' || num_parallel_workers < 1)
+						Elog("invalid --parallel option: %s", optarg);
+				}
+				break;
+			case 1008:		/* --binary-copy */
+				sqldb_binary_copy = true;
+				break;
+			case 1009:		/* --write-threads */
+				{
+					char   *end;
+
+					num_write_threads = strtol(optarg, &end, 10);
+					if (*end != '\0' || num_write_threads < 1)
+						Elog("invalid --write-threads option: %s", optarg);
+				}
+				break;
+			case 1007:		/* --sort-by */
+				if (sort_by_columns)
+					Elog("--sort-by option was supplied twice");
+				sort_by_columns = optarg;
+				break;
 			case 9999:		/* --help */
 			default:
 				usage();
@@ -860,10 +998,213 @@ parse_options(int argc, char * const argv[])
 	}
 	if (!sqldb_command)
 		Elog("Neither -c nor -t options are supplied");
+	if (num_parallel_workers > 1)
+	{
+		if (!sqldb_table_name)
+			Elog("--parallel option requires -t option");
+		if (sort_by_columns)
+			Elog("--parallel and --sort-by are exclusive");
+	}
+	if (sqldb_binary_copy && sqldb_nestloop_options)
+		Elog("--binary-copy and --inner-join/--outer-join are exclusive");
+	/*
+	 * --sort-by wraps the command by ORDER BY clause, to cluster the rows
+	 * in the record batches. The sort is processed by the database server
+	 * under its own memory budget (spilled to disk if too large), and makes
+	 * the min/max statistics by -S option selective.
+	 */
+	if (sort_by_columns)
+	{
+		char   *sql = pstrdup(sqldb_command);
+		char   *tail = sql + strlen(sql) - 1;
+
+		while (tail >= sql && (isspace(*tail) || *tail == ';'))
+			*tail-- = '\0';
+		sqldb_command = palloc(strlen(sql) + strlen(sort_by_columns) + 100);
+		sprintf(sqldb_command, "SELECT * FROM (%s) __sort_by__ ORDER BY %s",
+				sql, sort_by_columns);
+	}
 	if (batch_segment_sz == 0)
 		batch_segment_sz = (1UL << 28);		/* 256MB in default */
 }
 
+/*
+ * Parallel export by multiple connections (--parallel=N)
+ *
+ * The first connection exports its snapshot, and the other connections
+ * import it, so all the workers see a consistent image of the table.
+ * Each worker scans a range of the table (ctid on PostgreSQL, primary key
+ * on MySQL), then writes out record batches into the same result file
+ * under the lock.
+ */
+typedef struct
+{
+	pthread_t	thread;
+	void	   *sqldb_state;
+	SQLtable   *table;
+} sqldbWorker;
+
+static SQLtable		   *parallel_main_table = NULL;
+static pthread_mutex_t	parallel_main_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void
+writeArrowRecordBatchParallel(SQLtable *worker)
+{
+	SQLtable   *table = parallel_main_table;
+
+	if ((errno = pthread_mutex_lock(&parallel_main_mutex)) != 0)
+		Elog("failed on pthread_mutex_lock: %m");
+	if (worker != table)
+	{
+		/* write out the record batch at the tail of the main table */
+		worker->fdesc = table->fdesc;
+		worker->filename = table->filename;
+		worker->f_pos = table->f_pos;
+		worker->recordBatches = table->recordBatches;
+		worker->numRecordBatches = table->numRecordBatches;
+	}
+	writeArrowRecordBatch(worker);
+	shows_record_batch_progress(worker, worker->nitems);
+	if (worker != table)
+	{
+		table->f_pos = worker->f_pos;
+		table->recordBatches = worker->recordBatches;
+		table->numRecordBatches = worker->numRecordBatches;
+	}
+	if ((errno = pthread_mutex_unlock(&parallel_main_mutex)) != 0)
+		Elog("failed on pthread_mutex_unlock: %m");
+	sql_table_clear(worker);
+}
+
+static void *
+sqldbWorkerMain(void *__priv)
+{
+	sqldbWorker *worker = __priv;
+	SQLtable   *table = worker->table;
+
+	while (sqldb_fetch_results(worker->sqldb_state, table))
+	{
+		if (table->usage > batch_segment_sz)
+			writeArrowRecordBatchParallel(table);
+	}
+	if (table->nitems > 0)
+		writeArrowRecordBatchParallel(table);
+	return NULL;
+}
+
+/*
+ * mergeWorkerStatistics - moves min/max statistics and bloom filters of the
+ * record batches written by the worker to the main table
+ */
+static void
+mergeWorkerStatistics(SQLfield *dest, SQLfield *src)
+{
+	int		j;
+
+	while (src->stat_list)
+	{
+		SQLstat	   *curr = src->stat_list;
+
+		src->stat_list = curr->next;
+		curr->next = dest->stat_list;
+		dest->stat_list = curr;
+	}
+	while (src->bloom_list)
+	{
+		SQLbloom   *curr = src->bloom_list;
+
+		src->bloom_list = curr->next;
+		curr->next = dest->bloom_list;
+		dest->bloom_list = curr;
+	}
+	if (dest->element && src->element)
+		mergeWorkerStatistics(dest->element, src->element);
+	for (j=0; j < dest->nfields && j < src->nfields; j++)
+		mergeWorkerStatistics(&dest->subfields[j], &src->subfields[j]);
+}
+
+static sqldbWorker *
+setupParallelWorkers(void *sqldb_state,
+					 ArrowFileInfo *af_info,
+					 SQLdictionary *sql_dict_list)
+{
+	sqldbWorker *workers;
+	char	   *snapshot;
+	char	  **commands;
+	SQLdictionary *dict_list = sql_dict_list;
+	int			i;
+
+	workers = palloc0(sizeof(sqldbWorker) * num_parallel_workers);
+	snapshot = sqldb_export_snapshot(sqldb_state);
+	commands = sqldb_parallel_commands(sqldb_state,
+									   sqldb_table_name,
+									   num_parallel_workers);
+
+	workers[0].sqldb_state = sqldb_state;
+	for (i=1; i < num_parallel_workers; i++)
+	{
+		workers[i].sqldb_state = sqldb_server_connect(sqldb_hostname,
+													  sqldb_port_num,
+													  sqldb_username,
+													  sqldb_password,
+													  sqldb_database,
+													  sqldb_session_configs,
+													  sqldb_nestloop_options);
+		sqldb_import_snapshot(workers[i].sqldb_state, snapshot);
+	}
+
+	for (i=0; i < num_parallel_workers; i++)
+	{
+		workers[i].table = sqldb_begin_query(workers[i].sqldb_state,
+											 commands[i], af_info, dict_list);
+		if (workers[i].table)
+		{
+			workers[i].table->segment_sz = batch_segment_sz;
+			workers[i].table->write_nthreads = num_write_threads;
+			enable_embedded_stats(workers[i].table);
+			enable_embedded_bloom(workers[i].table);
+			if (!parallel_main_table)
+			{
+				parallel_main_table = workers[i].table;
+				dict_list = parallel_main_table->sql_dict_list;
+			}
+		}
+	}
+	return workers;
+}
+
+static void
+runParallelWorkers(sqldbWorker *workers)
+{
+	SQLtable   *table = parallel_main_table;
+	int			i, j;
+
+	for (i=0; i < num_parallel_workers; i++)
+	{
+		if (!workers[i].table)
+			continue;
+		if ((errno = pthread_create(&workers[i].thread, NULL,
+									sqldbWorkerMain, &workers[i])) != 0)
+			Elog("failed on pthread_create: %m");
+	}
+	for (i=0; i < num_parallel_workers; i++)
+	{
+		if (!workers[i].table)
+			continue;
+		if ((errno = pthread_join(workers[i].thread, NULL)) != 0)
+			Elog("failed on pthread_join: %m");
+		if (workers[i].table != table)
+		{
+			for (j=0; j < table->nfields; j++)
+				mergeWorkerStatistics(&table->columns[j],
+									  &workers[i].table->columns[j]);
+		}
+	}
+	/* close the connections except for the main */
+	for (i=1; i < num_parallel_workers; i++)
+		sqldb_close_connection(workers[i].sqldb_state);
+}
+
 /*
  * Entrypoint of pg2arrow / mysql2arrow
  */
@@ -875,6 +1216,7 @@ int main(int argc, char * const argv[])
 	SQLtable	   *table;
 	ArrowKeyValue  *kv;
 	SQLdictionary  *sql_dict_list = NULL;
+	sqldbWorker	   *workers = NULL;
 	
 	parse_options(argc, argv);
 
@@ -900,15 +1242,30 @@ int main(int argc, char * const argv[])
 		sql_dict_list = loadArrowDictionaryBatches(append_fdesc, &af_info);
 	}
 	/* begin SQL command execution */
-	table = sqldb_begin_query(sqldb_state,
-							  sqldb_command,
-							  append_filename ? &af_info : NULL,
-							  sql_dict_list);
-	if (!table)
-		Elog("Empty results by the query: %s", sqldb_command);
-	table->segment_sz = batch_segment_sz;
-	/* enables embedded min/max statistics, if any */
-	enable_embedded_stats(table);
+	if (num_parallel_workers > 1)
+	{
+		workers = setupParallelWorkers(sqldb_state,
+									   append_filename ? &af_info : NULL,
+									   sql_dict_list);
+		table = parallel_main_table;
+		if (!table)
+			Elog("Empty results by the query: %s", sqldb_command);
+	}
+	else
+	{
+		table = sqldb_begin_query(sqldb_state,
+								  sqldb_command,
+								  append_filename ? &af_info : NULL,
+								  sql_dict_list);
+		if (!table)
+			Elog("Empty results by the query: %s", sqldb_command);
+		table->segment_sz = batch_segment_sz;
+		table->write_nthreads = num_write_threads;
+		/* enables embedded min/max statistics, if any */
+		enable_embedded_stats(table);
+		/* enables embedded bloom filter, if any */
+		enable_embedded_bloom(table);
+	}
 
 	/* save the SQL command as custom metadata */
 	kv = palloc0(sizeof(ArrowKeyValue));
@@ -933,21 +1290,28 @@ int main(int argc, char * const argv[])
 	writeArrowDictionaryBatches(table);
 	
 	/* main loop to fetch and write result */
-	while (sqldb_fetch_results(sqldb_state, table))
+	if (workers)
 	{
-		if (table->usage > batch_segment_sz)
+		runParallelWorkers(workers);
+	}
+	else
+	{
+		while (sqldb_fetch_results(sqldb_state, table))
+		{
+			if (table->usage > batch_segment_sz)
+			{
+				writeArrowRecordBatch(table);
+				shows_record_batch_progress(table, table->nitems);
+				sql_table_clear(table);
+			}
+		}
+		if (table->nitems > 0)
 		{
 			writeArrowRecordBatch(table);
 			shows_record_batch_progress(table, table->nitems);
 			sql_table_clear(table);
 		}
 	}
-	if (table->nitems > 0)
-	{
-		writeArrowRecordBatch(table);
-		shows_record_batch_progress(table, table->nitems);
-		sql_table_clear(table);
-	}
 	/* write out footer portion */
 	writeArrowFooter(table);
 
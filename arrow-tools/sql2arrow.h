@@ -39,6 +39,17 @@ sqldb_fetch_results(void *sqldb_state, SQLtable *table);
 extern void
 sqldb_close_connection(void *sqldb_state);
 
+/* for --binary-copy option */
+extern bool		sqldb_binary_copy;
+
+/* for --parallel option */
+extern char *
+sqldb_export_snapshot(void *sqldb_state);
+extern void
+sqldb_import_snapshot(void *sqldb_state, const char *snapshot);
+extern char **
+sqldb_parallel_commands(void *sqldb_state, const char *relname, int nworkers);
+
 /* misc functions */
 extern void	   *palloc(size_t sz);
 extern void	   *palloc0(size_t sz);
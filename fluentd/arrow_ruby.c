@@ -1526,6 +1526,7 @@ __arrowFileParseParams(VALUE self,
 	VALUE		ts_column = Qnil;
 	VALUE		tag_column = Qnil;
 	long		f_threshold = 10000;
+	long		rb_threshold = 0;
 	int			i, count;
 
 	if (CLASS_OF(__params) == rb_cHash)
@@ -1549,6 +1550,16 @@ __arrowFileParseParams(VALUE self,
 			if (f_threshold < 16 || f_threshold > 1048576)
 				Elog("filesize_threshold must be [16...1048576]");
 		}
+
+		datum = rb_funcall(__params, rb_intern("fetch"), 2,
+						   rb_str_new_cstr("record_batch_threshold"), Qnil);
+		if (datum != Qnil)
+		{
+			datum = rb_funcall(datum, rb_intern("to_i"), 0);
+			rb_threshold = NUM2LONG(datum);
+			if (rb_threshold < 1 || rb_threshold > 1024)
+				Elog("record_batch_threshold must be [1...1024]");
+		}
 	}
 	else if (__params != Qnil)
 		Elog("ArrowFile: parameters must be Hash");
@@ -1581,6 +1592,8 @@ __arrowFileParseParams(VALUE self,
 	}
 	rb_ivar_set(self, rb_intern("filesize_threshold"),
 				LONG2NUM(f_threshold << 20));
+	rb_ivar_set(self, rb_intern("record_batch_threshold"),
+				LONG2NUM(rb_threshold << 20));
 }
 
 static VALUE
@@ -1911,9 +1924,23 @@ __arrowFileValidateColumn(SQLfield *column,
 		column->stat_list = __arrowFieldParseStats(af_field);
 }
 
+typedef struct
+{
+	VALUE		self;
+	VALUE		chunk;
+	SQLtable   *table;
+	size_t		rb_threshold;	/* streaming mode, if > 0 */
+	/* original Footer to be restored on errors */
+	bool		needs_rollback;
+	off_t		footer_offset;
+	size_t		footer_length;
+	char	   *footer_backup;
+} WriteChunkArgs;
+
 static void
-arrowFileSetupAppend(SQLtable *table)
+arrowFileSetupAppend(WriteChunkArgs *args)
 {
+	SQLtable   *table = args->table;
 	ArrowFileInfo af_info;
 	uint32_t	nitems;
 	size_t		nbytes;
@@ -1946,17 +1973,70 @@ arrowFileSetupAppend(SQLtable *table)
 	if (pread(table->fdesc, buffer, nbytes, offset) != nbytes)
 		Elog("failed on pread('%s'): %m", table->filename);
 	offset -= *((uint32_t *)buffer);
+
+	/*
+	 * Backup of the Footer; the new RecordBatches overwrite the current
+	 * Footer, so we restore the original one if any errors.
+	 * Readers with the cached metadata don't care about the Footer, and
+	 * arrow_fdw reloads the Footer under the shared flock(2).
+	 */
+	args->footer_offset = offset;
+	args->footer_length = af_info.stat_buf.st_size - offset;
+	args->footer_backup = palloc(args->footer_length);
+	if (pread(table->fdesc,
+			  args->footer_backup,
+			  args->footer_length,
+			  args->footer_offset) != args->footer_length)
+		Elog("failed on pread('%s'): %m", table->filename);
+	args->needs_rollback = true;
+
 	if (lseek(table->fdesc, offset, SEEK_SET) < 0)
 		Elog("failed on lseek('%s'): %m", table->filename);
 	table->f_pos = offset;
 }
 
-typedef struct
+/*
+ * arrowFileOpenAndSetup
+ */
+static void
+arrowFileOpenAndSetup(WriteChunkArgs *args)
 {
-	VALUE		self;
-	VALUE		chunk;
-	SQLtable   *table;
-} WriteChunkArgs;
+	if (arrowFileOpenFile(args->self, args->table))
+	{
+		/* new file shall be truncated to empty on errors */
+		args->needs_rollback = true;
+		arrowFileSetupNewFile(args->table);
+	}
+	else
+	{
+		arrowFileSetupAppend(args);
+	}
+}
+
+/*
+ * arrowFileRollback
+ *
+ * restore the original Footer on errors. It is a best effort, and never
+ * raise an exception because we are already in the error handler.
+ */
+static void
+arrowFileRollback(WriteChunkArgs *args)
+{
+	SQLtable   *table = args->table;
+	off_t		length = args->footer_offset + args->footer_length;
+
+	if (!args->needs_rollback || table->fdesc < 0)
+		return;
+	if (args->footer_length > 0 &&
+		pwrite(table->fdesc,
+			   args->footer_backup,
+			   args->footer_length,
+			   args->footer_offset) != args->footer_length)
+		return;
+	if (ftruncate(table->fdesc, length) != 0)
+		return;
+	args->needs_rollback = false;
+}
 
 static SQLtable *
 __arrowFileCreateTable(VALUE self)
@@ -2064,6 +2144,7 @@ __arrowFileWriteRow(RB_BLOCK_CALL_FUNC_ARGLIST(__yield, __private))
 	VALUE		tag;
 	VALUE		ts;
 	VALUE		record;
+	size_t		usage = 0;
 	int			j;
 
 	tag = rb_funcall(__yield, rb_intern("fetch"), 1, INT2NUM(0));
@@ -2083,10 +2164,17 @@ __arrowFileWriteRow(RB_BLOCK_CALL_FUNC_ARGLIST(__yield, __private))
 			datum = rb_funcall(record, rb_intern("fetch"), 2,
 							   rb_str_new_cstr(column->field_name), Qnil);
 		}
-		column->put_value(column, (const char *)datum, -1);
+		usage += column->put_value(column, (const char *)datum, -1);
 	}
 	table->nitems++;
+	table->usage = usage;
 
+	/* streaming mode; write out a record batch once buffer gets full */
+	if (args->rb_threshold > 0 && table->usage >= args->rb_threshold)
+	{
+		writeArrowRecordBatch(table);
+		sql_table_clear(table);
+	}
 	return Qtrue;
 }
 
@@ -2098,6 +2186,12 @@ __arrowFileWriteChunk(VALUE __args)
 
 	/* setup SQLtable buffer */
 	args->table = table = __arrowFileCreateTable(args->self);
+	/*
+	 * open the destination file first on the streaming mode, because
+	 * record batches are written out during the iteration of chunk.
+	 */
+	if (args->rb_threshold > 0)
+		arrowFileOpenAndSetup(args);
 	/* iterate chunk to fill up the buffer */
 	rb_block_call(args->chunk,
 				  rb_intern("each"),
@@ -2106,14 +2200,14 @@ __arrowFileWriteChunk(VALUE __args)
 				  __arrowFileWriteRow,
 				  __args);
 	/* open the destination file */
-	if (arrowFileOpenFile(args->self, args->table))
-		arrowFileSetupNewFile(args->table);
-	else
-		arrowFileSetupAppend(args->table);
+	if (args->rb_threshold == 0)
+		arrowFileOpenAndSetup(args);
 	/* write out a new record-batch */
-	writeArrowRecordBatch(table);
+	if (args->rb_threshold == 0 || table->nitems > 0)
+		writeArrowRecordBatch(table);
 	/* write out a new footer */
 	writeArrowFooter(table);
+	args->needs_rollback = false;
 	/* close the file, and unlock */
 	arrowFileCloseFile(table);
 
@@ -2131,6 +2225,8 @@ rb_ArrowFile__writeChunk(VALUE self,
 	memset(&args, 0, sizeof(WriteChunkArgs));
 	args.self  = self;
 	args.chunk = chunk;
+	args.rb_threshold = NUM2LONG(rb_ivar_get(self,
+											  rb_intern("record_batch_threshold")));
 
 	retval = rb_protect(__arrowFileWriteChunk, (VALUE)&args, &status);
 	if (status != 0)
@@ -2138,13 +2234,20 @@ rb_ArrowFile__writeChunk(VALUE self,
 		if (args.table)
 		{
 			if (args.table->fdesc >= 0)
+			{
+				arrowFileRollback(&args);
 				close(args.table->fdesc);
+			}
 			__arrowFileReleaseTable(args.table);
 		}
+		if (args.footer_backup)
+			pfree(args.footer_backup);
 		rb_jump_tag(status);
 	}
 	assert(args.table->fdesc < 0);
 	__arrowFileReleaseTable(args.table);
+	if (args.footer_backup)
+		pfree(args.footer_backup);
 
 	return retval;
 }
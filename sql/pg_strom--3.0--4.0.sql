@@ -6,6 +6,153 @@ CREATE FUNCTION pgstrom.gpucache_recovery(regclass)
   AS 'MODULE_PATHNAME','pgstrom_gpucache_recovery'
   LANGUAGE C CALLED ON NULL INPUT;
 
+CREATE FUNCTION pgstrom.gpucache_export_ipchandle(regclass)
+  RETURNS bytea
+  AS 'MODULE_PATHNAME','pgstrom_gpucache_export_ipchandle'
+  LANGUAGE C STRICT;
+
+CREATE TYPE pgstrom.__pgstrom_gpucache_stat_t AS (
+  database_oid			oid,
+  database_name			text,
+  table_oid				oid,
+  table_name			text,
+  signature				int8,
+  scan_cached			int8,
+  scan_fallback			int8,
+  apply_count			int8,
+  apply_nitems			int8,
+  apply_time			float8,
+  apply_latency_hist	int8[],
+  compaction_count		int8,
+  compaction_time		float8,
+  lock_wait_count		int8,
+  lock_wait_time		float8,
+  redo_overflow			int8,
+  load_progress			float8,
+  load_nitems			int8,
+  load_time				float8
+);
+CREATE FUNCTION pgstrom.__pgstrom_gpucache_stat()
+  RETURNS SETOF pgstrom.__pgstrom_gpucache_stat_t
+  AS 'MODULE_PATHNAME','pgstrom_gpucache_stat'
+  LANGUAGE C STRICT;
+CREATE VIEW pgstrom.gpucache_stat AS
+  SELECT * FROM pgstrom.__pgstrom_gpucache_stat();
+
+---
+--- GPU device memory usage
+---
+CREATE TYPE pgstrom.__pgstrom_gpu_memory_info_t AS (
+  device_nr				int4,
+  total_size			int8,
+  free_size				int8,
+  normal_usage			int8,
+  managed_usage			int8,
+  iomap_usage			int8,
+  preserved_usage		int8
+);
+CREATE FUNCTION pgstrom.__pgstrom_gpu_memory_info()
+  RETURNS SETOF pgstrom.__pgstrom_gpu_memory_info_t
+  AS 'MODULE_PATHNAME','pgstrom_gpu_memory_info'
+  LANGUAGE C STRICT;
+CREATE VIEW pgstrom.gpu_memory_info AS
+  SELECT * FROM pgstrom.__pgstrom_gpu_memory_info();
+
+---
+--- Cumulative statistics of GPU activity
+---
+CREATE TYPE pgstrom.__pgstrom_stat_gpu_device_t AS (
+  device_nr				int4,
+  num_tasks				int8,
+  kern_launches			int8,
+  dma_send_bytes		int8,
+  dma_recv_bytes		int8,
+  p2p_bytes				int8,
+  busy_time				float8,
+  memory_usage			int8,
+  memory_peak			int8,
+  stats_reset			timestamptz
+);
+CREATE FUNCTION pgstrom.__pgstrom_stat_gpu_device()
+  RETURNS SETOF pgstrom.__pgstrom_stat_gpu_device_t
+  AS 'MODULE_PATHNAME','pgstrom_stat_gpu_device'
+  LANGUAGE C STRICT;
+CREATE VIEW pgstrom.stat_gpu_device AS
+  SELECT * FROM pgstrom.__pgstrom_stat_gpu_device();
+
+CREATE TYPE pgstrom.__pgstrom_stat_gpu_query_t AS (
+  userid				oid,
+  dbid					oid,
+  queryid				int8,
+  gpu_nodes				int8,
+  gpu_tasks				int8,
+  kern_launches			int8,
+  gpu_time				float8,
+  fallback_chunks		int8,
+  fallback_rows			int8,
+  jit_build_time		float8
+);
+CREATE FUNCTION pgstrom.__pgstrom_stat_gpu_query()
+  RETURNS SETOF pgstrom.__pgstrom_stat_gpu_query_t
+  AS 'MODULE_PATHNAME','pgstrom_stat_gpu_query'
+  LANGUAGE C STRICT;
+CREATE VIEW pgstrom.stat_gpu_query AS
+  SELECT * FROM pgstrom.__pgstrom_stat_gpu_query();
+
+CREATE FUNCTION pgstrom.stat_gpu_reset()
+  RETURNS void
+  AS 'MODULE_PATHNAME','pgstrom_stat_gpu_reset'
+  LANGUAGE C STRICT;
+REVOKE ALL ON FUNCTION pgstrom.stat_gpu_reset() FROM public;
+
+---
+--- Per-device cost model
+---
+CREATE TYPE pgstrom.__pgstrom_gpu_cost_model_t AS (
+  device_nr				int4,
+  device_name			text,
+  dma_bandwidth			float8,
+  kernel_bandwidth		float8,
+  dma_cost_factor		float8,
+  operator_cost_factor	float8,
+  calibrated_at			timestamptz
+);
+CREATE FUNCTION pgstrom.__pgstrom_gpu_cost_model()
+  RETURNS SETOF pgstrom.__pgstrom_gpu_cost_model_t
+  AS 'MODULE_PATHNAME','pgstrom_gpu_cost_model'
+  LANGUAGE C STRICT;
+CREATE VIEW pgstrom.gpu_cost_model AS
+  SELECT * FROM pgstrom.__pgstrom_gpu_cost_model();
+
+CREATE FUNCTION pgstrom.calibrate_cost_model()
+  RETURNS SETOF pgstrom.__pgstrom_gpu_cost_model_t
+  AS 'MODULE_PATHNAME','pgstrom_calibrate_cost_model'
+  LANGUAGE C STRICT VOLATILE;
+REVOKE ALL ON FUNCTION pgstrom.calibrate_cost_model() FROM public;
+
+---
+--- Zone-map (min/max statistics) of tables
+---
+CREATE TABLE pgstrom.zonemap (
+  zm_relid          oid,
+  zm_attnum         int2,
+  zm_atttypid       oid,
+  zm_relfilenode    oid,
+  zm_range_sz       int4,
+  zm_nblocks        int4,
+  zm_stats          bytea
+);
+
+CREATE FUNCTION pgstrom.zonemap_refresh(regclass, int4 = 128)
+  RETURNS bigint
+  AS 'MODULE_PATHNAME','pgstrom_zonemap_refresh'
+  LANGUAGE C STRICT;
+
+CREATE FUNCTION pgstrom.zonemap_invalidate()
+  RETURNS trigger
+  AS 'MODULE_PATHNAME','pgstrom_zonemap_invalidate'
+  LANGUAGE C STRICT;
+
 ---
 --- Portable Shared Memory
 ---
@@ -393,6 +540,99 @@ CREATE AGGREGATE pg_catalog.hll_combine(bytea)
   parallel = safe
 );
 
+---
+--- Quantile Sketch for percentile estimation
+---
+CREATE FUNCTION pgstrom.quantile_sketch_key(float8)
+  RETURNS int4
+  AS 'MODULE_PATHNAME','pgstrom_quantile_sketch_key'
+  LANGUAGE C STRICT PARALLEL SAFE;
+
+CREATE FUNCTION pgstrom.quantile_sketch_new(int4)
+  RETURNS bytea
+  AS 'MODULE_PATHNAME','pgstrom_quantile_sketch_new'
+  LANGUAGE C STRICT PARALLEL SAFE;
+
+CREATE FUNCTION pgstrom.quantile_sketch_update(bytea, float8)
+  RETURNS bytea
+  AS 'MODULE_PATHNAME','pgstrom_quantile_sketch_update'
+  LANGUAGE C CALLED ON NULL INPUT PARALLEL SAFE;
+
+CREATE FUNCTION pgstrom.quantile_sketch_merge(bytea, bytea)
+  RETURNS bytea
+  AS 'MODULE_PATHNAME','pgstrom_quantile_sketch_merge'
+  LANGUAGE C CALLED ON NULL INPUT PARALLEL SAFE;
+
+CREATE FUNCTION pg_catalog.quantile_sketch_percentile(bytea, float8)
+  RETURNS float8
+  AS 'MODULE_PATHNAME','pgstrom_quantile_sketch_percentile'
+  LANGUAGE C STRICT PARALLEL SAFE;
+
+CREATE FUNCTION pg_catalog.quantile_sketch_percentile(bytea, float8[])
+  RETURNS float8[]
+  AS 'MODULE_PATHNAME','pgstrom_quantile_sketch_percentile_multi'
+  LANGUAGE C STRICT PARALLEL SAFE;
+
+CREATE AGGREGATE pg_catalog.quantile_sketch(float8)
+(
+  sfunc = pgstrom.quantile_sketch_update,
+  stype = bytea,
+  parallel = safe
+);
+
+CREATE AGGREGATE pg_catalog.quantile_combine(bytea)
+(
+  sfunc = pgstrom.quantile_sketch_merge,
+  stype = bytea,
+  parallel = safe
+);
+
+---
+--- Fixed-point accumulator for SUM/AVG(numeric)
+---
+CREATE FUNCTION pgstrom.numeric_fixed(numeric, int4)
+  RETURNS int8
+  AS 'MODULE_PATHNAME','pgstrom_numeric_fixed'
+  LANGUAGE C STRICT PARALLEL SAFE;
+
+CREATE FUNCTION pgstrom.psum_numeric_fixed(int8, int4)
+  RETURNS bytea
+  AS 'MODULE_PATHNAME','pgstrom_psum_numeric_fixed'
+  LANGUAGE C STRICT PARALLEL SAFE;
+
+CREATE FUNCTION pgstrom.numeric_fixed_merge(bytea, bytea)
+  RETURNS bytea
+  AS 'MODULE_PATHNAME','pgstrom_numeric_fixed_merge'
+  LANGUAGE C CALLED ON NULL INPUT PARALLEL SAFE;
+
+CREATE FUNCTION pgstrom.numeric_fixed_sum(bytea)
+  RETURNS numeric
+  AS 'MODULE_PATHNAME','pgstrom_numeric_fixed_sum'
+  LANGUAGE C STRICT PARALLEL SAFE;
+
+CREATE FUNCTION pgstrom.numeric_fixed_avg(bytea)
+  RETURNS numeric
+  AS 'MODULE_PATHNAME','pgstrom_numeric_fixed_avg'
+  LANGUAGE C STRICT PARALLEL SAFE;
+
+CREATE AGGREGATE pgstrom.fsum_numeric_fixed(bytea)
+(
+  sfunc = pgstrom.numeric_fixed_merge,
+  stype = bytea,
+  finalfunc = pgstrom.numeric_fixed_sum,
+  combinefunc = pgstrom.numeric_fixed_merge,
+  parallel = safe
+);
+
+CREATE AGGREGATE pgstrom.favg_numeric_fixed(bytea)
+(
+  sfunc = pgstrom.numeric_fixed_merge,
+  stype = bytea,
+  finalfunc = pgstrom.numeric_fixed_avg,
+  combinefunc = pgstrom.numeric_fixed_merge,
+  parallel = safe
+);
+
 ---
 --- Re-define of VARIANCE/STDDEV
 ---
@@ -945,6 +1185,96 @@ CREATE OPERATOR CLASS pg_catalog.int81_ops
   operator 5 >  (int8,int1) for search,
   function 1 (int8,int1) pgstrom.btint81cmp(int8,int1);
 
+---
+--- Arrow_Fdw functions
+---
+CREATE FUNCTION pgstrom.arrow_fdw_compact(regclass, int4 = null)
+  RETURNS bigint
+  AS 'MODULE_PATHNAME','pgstrom_arrow_fdw_compact'
+  LANGUAGE C CALLED ON NULL INPUT;
+
+CREATE FUNCTION pgstrom.arrow_fdw_reset_consumer(text = null)
+  RETURNS void
+  AS 'MODULE_PATHNAME','pgstrom_arrow_fdw_reset_consumer'
+  LANGUAGE C CALLED ON NULL INPUT;
+
+CREATE FUNCTION pgstrom.arrow_ipc_stream(text, int4 = null)
+  RETURNS SETOF bytea
+  AS 'MODULE_PATHNAME','pgstrom_arrow_ipc_stream'
+  LANGUAGE C CALLED ON NULL INPUT;
+
+---
+--- Vector similarity functions
+---
+CREATE FUNCTION pgstrom.l2_distance(float4[], float4[])
+  RETURNS float8
+  AS 'MODULE_PATHNAME','pgstrom_l2_distance'
+  LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE;
+
+CREATE FUNCTION pgstrom.inner_product(float4[], float4[])
+  RETURNS float8
+  AS 'MODULE_PATHNAME','pgstrom_inner_product'
+  LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE;
+
+CREATE FUNCTION pgstrom.negative_inner_product(float4[], float4[])
+  RETURNS float8
+  AS 'MODULE_PATHNAME','pgstrom_negative_inner_product'
+  LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE;
+
+CREATE FUNCTION pgstrom.cosine_distance(float4[], float4[])
+  RETURNS float8
+  AS 'MODULE_PATHNAME','pgstrom_cosine_distance'
+  LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE;
+
+CREATE OPERATOR pg_catalog.<-> (
+  PROCEDURE = pgstrom.l2_distance,
+  LEFTARG = float4[],
+  RIGHTARG = float4[],
+  COMMUTATOR = <->
+);
+
+CREATE OPERATOR pg_catalog.<#> (
+  PROCEDURE = pgstrom.negative_inner_product,
+  LEFTARG = float4[],
+  RIGHTARG = float4[],
+  COMMUTATOR = <#>
+);
+
+CREATE OPERATOR pg_catalog.<=> (
+  PROCEDURE = pgstrom.cosine_distance,
+  LEFTARG = float4[],
+  RIGHTARG = float4[],
+  COMMUTATOR = <=>
+);
+
+---
+--- Time-series functions
+---
+CREATE FUNCTION pgstrom.time_bucket(interval, timestamp)
+  RETURNS timestamp
+  AS 'MODULE_PATHNAME','pgstrom_time_bucket_timestamp'
+  LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE;
+
+CREATE FUNCTION pgstrom.time_bucket(interval, timestamp, timestamp)
+  RETURNS timestamp
+  AS 'MODULE_PATHNAME','pgstrom_time_bucket_timestamp_origin'
+  LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE;
+
+CREATE FUNCTION pgstrom.time_bucket(interval, timestamptz)
+  RETURNS timestamptz
+  AS 'MODULE_PATHNAME','pgstrom_time_bucket_timestamptz'
+  LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE;
+
+CREATE FUNCTION pgstrom.time_bucket(interval, timestamptz, timestamptz)
+  RETURNS timestamptz
+  AS 'MODULE_PATHNAME','pgstrom_time_bucket_timestamptz_origin'
+  LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE;
+
+CREATE FUNCTION pgstrom.time_bucket(interval, timestamptz, text)
+  RETURNS timestamptz
+  AS 'MODULE_PATHNAME','pgstrom_time_bucket_timestamptz_zone'
+  LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE;
+
 ---
 --- Deprecated Functions
 ---
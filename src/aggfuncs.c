@@ -61,6 +61,17 @@ PG_FUNCTION_INFO_V1(pgstrom_hll_sketch_new);
 PG_FUNCTION_INFO_V1(pgstrom_hll_sketch_merge);
 PG_FUNCTION_INFO_V1(pgstrom_hll_count_final);
 PG_FUNCTION_INFO_V1(pgstrom_hll_sketch_histogram);
+PG_FUNCTION_INFO_V1(pgstrom_quantile_sketch_key);
+PG_FUNCTION_INFO_V1(pgstrom_quantile_sketch_new);
+PG_FUNCTION_INFO_V1(pgstrom_quantile_sketch_update);
+PG_FUNCTION_INFO_V1(pgstrom_quantile_sketch_merge);
+PG_FUNCTION_INFO_V1(pgstrom_quantile_sketch_percentile);
+PG_FUNCTION_INFO_V1(pgstrom_quantile_sketch_percentile_multi);
+PG_FUNCTION_INFO_V1(pgstrom_numeric_fixed);
+PG_FUNCTION_INFO_V1(pgstrom_psum_numeric_fixed);
+PG_FUNCTION_INFO_V1(pgstrom_numeric_fixed_merge);
+PG_FUNCTION_INFO_V1(pgstrom_numeric_fixed_sum);
+PG_FUNCTION_INFO_V1(pgstrom_numeric_fixed_avg);
 
 /* utility to reference numeric[] */
 static inline Datum
@@ -1405,3 +1416,484 @@ pgstrom_hll_sketch_histogram(PG_FUNCTION_ARGS)
 							 'i');
 	PG_RETURN_POINTER(result);
 }
+
+/*
+ * Quantile sketch support
+ *
+ * The quantile sketch is a fixed-length histogram of float8 values; each
+ * bucket covers [2^E * (1 + M/2^B), 2^E * (1 + (M+1)/2^B)) for the exponent
+ * E and the upper B bits of mantissa M, thus, estimated percentile has
+ * relative error less than 2^-(B+1). Because all the sketches have
+ * identical bucket boundaries, they can be merged by simple addition.
+ * It is the reason why GPU can build the sketch using atomic operations.
+ */
+static kern_quantile_sketch *
+__quantile_sketch_validate(bytea *state)
+{
+	kern_quantile_sketch *qsketch = (kern_quantile_sketch *)state;
+
+	if (VARSIZE(state) < offsetof(kern_quantile_sketch, counters) ||
+		qsketch->nbits < 1 ||
+		qsketch->nbits > QUANTILE_SKETCH_KEY_BITS ||
+		VARSIZE(state) != QUANTILE_SKETCH_LENGTH(qsketch->nbits))
+		elog(ERROR, "quantile sketch looks corrupted");
+	return qsketch;
+}
+
+static kern_quantile_sketch *
+__quantile_sketch_alloc(MemoryContext memcxt, uint32 nbits)
+{
+	kern_quantile_sketch *qsketch;
+	size_t		sz = QUANTILE_SKETCH_LENGTH(nbits);
+
+	qsketch = MemoryContextAllocZero(memcxt, sz);
+	SET_VARSIZE(qsketch, sz);
+	qsketch->nbits = nbits;
+
+	return qsketch;
+}
+
+static inline uint32
+__quantile_sketch_index(kern_quantile_sketch *qsketch, uint32 key)
+{
+	uint32		index = (key >> (QUANTILE_SKETCH_KEY_BITS - qsketch->nbits));
+
+	if (index >= QUANTILE_SKETCH_NBUCKETS(qsketch->nbits))
+		elog(ERROR, "quantile sketch key is out of range (%u)", key);
+	return index;
+}
+
+/*
+ * __quantile_sketch_bucket_value - representative value of the bucket
+ */
+static double
+__quantile_sketch_bucket_value(uint32 nbits, uint32 index)
+{
+	uint32		nhalf = QUANTILE_SKETCH_NBUCKETS(nbits) / 2;
+	uint32		mask = (1U << nbits) - 1;
+	uint32		pos;
+	uint32		mant;
+	int			expo;
+	double		lower;
+	double		upper;
+
+	pos = (index < nhalf ? (nhalf - 1) - index : index - nhalf);
+	if (pos == 0)
+		return 0.0;		/* zero or very tiny values */
+	expo = (int)(pos >> nbits) + QUANTILE_SKETCH_EXPO_MIN;
+	mant = (pos & mask);
+	lower = ldexp(1.0 + (double)mant / (double)(mask + 1), expo);
+	upper = ldexp(1.0 + (double)(mant + 1) / (double)(mask + 1), expo);
+
+	return (index < nhalf ? -(lower + upper) / 2.0 : (lower + upper) / 2.0);
+}
+
+/*
+ * __quantile_sketch_percentile - like percentile_disc, returns the value
+ * of the bucket that contains the first item whose position in the
+ * sorted order is equal to or larger than the fraction.
+ */
+static double
+__quantile_sketch_percentile(kern_quantile_sketch *qsketch, double fraction)
+{
+	uint32		nbuckets = QUANTILE_SKETCH_NBUCKETS(qsketch->nbits);
+	uint64		total = 0;
+	uint64		rank;
+	uint64		count = 0;
+	uint32		index;
+
+	if (fraction < 0.0 || fraction > 1.0 || isnan(fraction))
+		ereport(ERROR,
+				(errcode(ERRCODE_NUMERIC_VALUE_OUT_OF_RANGE),
+				 errmsg("percentile value %g is not between 0 and 1",
+						fraction)));
+	for (index=0; index < nbuckets; index++)
+		total += qsketch->counters[index];
+	Assert(total > 0);
+	rank = (uint64)ceil(fraction * (double)total);
+	if (rank < 1)
+		rank = 1;
+	for (index=0; index < nbuckets; index++)
+	{
+		count += qsketch->counters[index];
+		if (count >= rank)
+			break;
+	}
+	Assert(index < nbuckets);
+	return __quantile_sketch_bucket_value(qsketch->nbits, index);
+}
+
+static bool
+__quantile_sketch_is_empty(kern_quantile_sketch *qsketch)
+{
+	uint32		nbuckets = QUANTILE_SKETCH_NBUCKETS(qsketch->nbits);
+	uint32		index;
+
+	for (index=0; index < nbuckets; index++)
+	{
+		if (qsketch->counters[index] > 0)
+			return false;
+	}
+	return true;
+}
+
+/*
+ * pgstrom_quantile_sketch_key
+ */
+Datum
+pgstrom_quantile_sketch_key(PG_FUNCTION_ARGS)
+{
+	float8		fval = PG_GETARG_FLOAT8(0);
+
+	PG_RETURN_INT32((int32)__quantile_sketch_key(fval));
+}
+
+/*
+ * pgstrom_quantile_sketch_new
+ */
+Datum
+pgstrom_quantile_sketch_new(PG_FUNCTION_ARGS)
+{
+	uint32		key = (uint32)PG_GETARG_INT32(0);
+	kern_quantile_sketch *qsketch;
+
+	qsketch = __quantile_sketch_alloc(CurrentMemoryContext,
+									  pgstrom_quantile_sketch_bits);
+	qsketch->counters[__quantile_sketch_index(qsketch, key)]++;
+
+	PG_RETURN_POINTER(qsketch);
+}
+
+/*
+ * pgstrom_quantile_sketch_update
+ */
+Datum
+pgstrom_quantile_sketch_update(PG_FUNCTION_ARGS)
+{
+	MemoryContext	aggcxt;
+	kern_quantile_sketch *qsketch;
+	uint32			key;
+
+	if (!AggCheckCallContext(fcinfo, &aggcxt))
+		elog(ERROR, "aggregate function called in non-aggregate context");
+	if (PG_ARGISNULL(1))
+	{
+		if (PG_ARGISNULL(0))
+			PG_RETURN_NULL();
+		PG_RETURN_DATUM(PG_GETARG_DATUM(0));
+	}
+	if (PG_ARGISNULL(0))
+		qsketch = __quantile_sketch_alloc(aggcxt, pgstrom_quantile_sketch_bits);
+	else
+		qsketch = __quantile_sketch_validate(PG_GETARG_BYTEA_P(0));
+	key = __quantile_sketch_key(PG_GETARG_FLOAT8(1));
+	qsketch->counters[__quantile_sketch_index(qsketch, key)]++;
+
+	PG_RETURN_POINTER(qsketch);
+}
+
+/*
+ * pgstrom_quantile_sketch_merge
+ */
+Datum
+pgstrom_quantile_sketch_merge(PG_FUNCTION_ARGS)
+{
+	MemoryContext	aggcxt;
+	kern_quantile_sketch *qsketch;
+	kern_quantile_sketch *new_sketch;
+	uint32			nbuckets;
+	uint32			index;
+
+	if (!AggCheckCallContext(fcinfo, &aggcxt))
+		elog(ERROR, "aggregate function called in non-aggregate context");
+	if (PG_ARGISNULL(0))
+	{
+		if (PG_ARGISNULL(1))
+			PG_RETURN_NULL();
+		new_sketch = __quantile_sketch_validate(PG_GETARG_BYTEA_P(1));
+		qsketch = MemoryContextAlloc(aggcxt, VARSIZE(new_sketch));
+		memcpy(qsketch, new_sketch, VARSIZE(new_sketch));
+	}
+	else
+	{
+		qsketch = __quantile_sketch_validate(PG_GETARG_BYTEA_P(0));
+		if (!PG_ARGISNULL(1))
+		{
+			new_sketch = __quantile_sketch_validate(PG_GETARG_BYTEA_P(1));
+			if (qsketch->nbits != new_sketch->nbits)
+				elog(ERROR, "incompatible quantile sketch");
+			nbuckets = QUANTILE_SKETCH_NBUCKETS(qsketch->nbits);
+			for (index=0; index < nbuckets; index++)
+				qsketch->counters[index] += new_sketch->counters[index];
+		}
+	}
+	PG_RETURN_POINTER(qsketch);
+}
+
+/*
+ * pgstrom_quantile_sketch_percentile
+ */
+Datum
+pgstrom_quantile_sketch_percentile(PG_FUNCTION_ARGS)
+{
+	kern_quantile_sketch *qsketch
+		= __quantile_sketch_validate(PG_GETARG_BYTEA_P(0));
+	float8		fraction = PG_GETARG_FLOAT8(1);
+
+	if (__quantile_sketch_is_empty(qsketch))
+		PG_RETURN_NULL();
+	PG_RETURN_FLOAT8(__quantile_sketch_percentile(qsketch, fraction));
+}
+
+/*
+ * pgstrom_quantile_sketch_percentile_multi
+ */
+Datum
+pgstrom_quantile_sketch_percentile_multi(PG_FUNCTION_ARGS)
+{
+	kern_quantile_sketch *qsketch
+		= __quantile_sketch_validate(PG_GETARG_BYTEA_P(0));
+	ArrayType  *fractions = PG_GETARG_ARRAYTYPE_P(1);
+	Datum	   *elems;
+	bool	   *nulls;
+	int			nelems;
+	int			i;
+	ArrayType  *result;
+
+	if (__quantile_sketch_is_empty(qsketch))
+		PG_RETURN_NULL();
+	deconstruct_array(fractions, FLOAT8OID,
+					  sizeof(float8), FLOAT8PASSBYVAL, 'd',
+					  &elems, &nulls, &nelems);
+	for (i=0; i < nelems; i++)
+	{
+		if (nulls[i])
+			continue;
+		elems[i] = Float8GetDatum(__quantile_sketch_percentile(qsketch,
+											DatumGetFloat8(elems[i])));
+	}
+	result = construct_md_array(elems, nulls,
+								ARR_NDIM(fractions),
+								ARR_DIMS(fractions),
+								ARR_LBOUND(fractions),
+								FLOAT8OID,
+								sizeof(float8), FLOAT8PASSBYVAL, 'd');
+	PG_RETURN_POINTER(result);
+}
+
+/*
+ * Fixed-point accumulator for SUM/AVG(numeric)
+ *
+ * GpuPreAgg accumulates numeric values with declared precision and scale
+ * on the 128bit integer, as 10^scale times of the original values.
+ * See kern_numeric_fixed for the layout.
+ */
+static kern_numeric_fixed *
+__numeric_fixed_validate(bytea *state)
+{
+	kern_numeric_fixed *nfixed = (kern_numeric_fixed *)state;
+
+	if (VARSIZE(state) != sizeof(kern_numeric_fixed) ||
+		nfixed->scale < 0 ||
+		nfixed->scale > NUMERIC_FIXED_MAX_PRECISION)
+		elog(ERROR, "fixed-point accumulator looks corrupted");
+	return nfixed;
+}
+
+static kern_numeric_fixed *
+__numeric_fixed_alloc(MemoryContext memcxt, int scale)
+{
+	kern_numeric_fixed *nfixed;
+
+	if (scale < 0 || scale > NUMERIC_FIXED_MAX_PRECISION)
+		elog(ERROR, "scale of fixed-point accumulator is out of range (%d)",
+			 scale);
+	nfixed = MemoryContextAllocZero(memcxt, sizeof(kern_numeric_fixed));
+	SET_VARSIZE(nfixed, sizeof(kern_numeric_fixed));
+	nfixed->scale = scale;
+
+	return nfixed;
+}
+
+static inline void
+__numeric_fixed_add(kern_numeric_fixed *nfixed,
+					uint64 nitems, uint64 sum_lo, int64 sum_hi)
+{
+	nfixed->nitems += nitems;
+	nfixed->sum_lo += sum_lo;
+	nfixed->sum_hi += sum_hi + (nfixed->sum_lo < sum_lo ? 1 : 0);
+}
+
+/*
+ * __numeric_fixed_to_numeric - transforms the 128bit sum to numeric
+ */
+static Datum
+__numeric_fixed_to_numeric(kern_numeric_fixed *nfixed)
+{
+	uint64		lo = nfixed->sum_lo;
+	int64		hi = nfixed->sum_hi;
+	bool		is_negative = (hi < 0);
+	uint32		words[4];
+	char		digits[48];
+	char		buf[64];
+	int			ndigits = 0;
+	int			i, j = 0;
+	bool		nonzero;
+
+	if (is_negative)
+	{
+		lo = ~lo + 1;
+		hi = ~hi + (lo == 0 ? 1 : 0);
+	}
+	words[0] = (uint32)((uint64)hi >> 32);
+	words[1] = (uint32)((uint64)hi & 0xffffffffU);
+	words[2] = (uint32)(lo >> 32);
+	words[3] = (uint32)(lo & 0xffffffffU);
+	/* long division by 10, from the lowest digit */
+	do {
+		uint64	rem = 0;
+
+		nonzero = false;
+		for (i=0; i < 4; i++)
+		{
+			uint64	curr = (rem << 32) | (uint64)words[i];
+
+			words[i] = (uint32)(curr / 10);
+			rem = curr % 10;
+			if (words[i] != 0)
+				nonzero = true;
+		}
+		digits[ndigits++] = '0' + rem;
+	} while (nonzero);
+	while (ndigits <= nfixed->scale)
+		digits[ndigits++] = '0';
+
+	if (is_negative)
+		buf[j++] = '-';
+	for (i=ndigits-1; i >= 0; i--)
+	{
+		buf[j++] = digits[i];
+		if (i == nfixed->scale && i > 0)
+			buf[j++] = '.';
+	}
+	buf[j] = '\0';
+
+	return DirectFunctionCall3(numeric_in,
+							   CStringGetDatum(buf),
+							   ObjectIdGetDatum(InvalidOid),
+							   Int32GetDatum(-1));
+}
+
+/*
+ * pgstrom_numeric_fixed
+ */
+Datum
+pgstrom_numeric_fixed(PG_FUNCTION_ARGS)
+{
+	Datum		value = PG_GETARG_DATUM(0);
+	int32		scale = PG_GETARG_INT32(1);
+	int64		mult = 1;
+	Datum		ival;
+	int			i;
+
+	if (scale < 0 || scale > NUMERIC_FIXED_MAX_PRECISION)
+		elog(ERROR, "scale of fixed-point accumulator is out of range (%d)",
+			 scale);
+	for (i=0; i < scale; i++)
+		mult *= 10;
+	value = DirectFunctionCall2(numeric_mul, value,
+								DirectFunctionCall1(int8_numeric,
+													Int64GetDatum(mult)));
+	ival = DirectFunctionCall1(numeric_int8, value);
+	if (DatumGetInt32(DirectFunctionCall2(numeric_cmp, value,
+										  DirectFunctionCall1(int8_numeric,
+															  ival))) != 0)
+		ereport(ERROR,
+				(errcode(ERRCODE_NUMERIC_VALUE_OUT_OF_RANGE),
+				 errmsg("numeric value has more digits than the scale")));
+	PG_RETURN_DATUM(ival);
+}
+
+/*
+ * pgstrom_psum_numeric_fixed
+ */
+Datum
+pgstrom_psum_numeric_fixed(PG_FUNCTION_ARGS)
+{
+	int64		ival = PG_GETARG_INT64(0);
+	int32		scale = PG_GETARG_INT32(1);
+	kern_numeric_fixed *nfixed;
+
+	nfixed = __numeric_fixed_alloc(CurrentMemoryContext, scale);
+	__numeric_fixed_add(nfixed, 1, (uint64)ival, (ival < 0 ? -1 : 0));
+
+	PG_RETURN_POINTER(nfixed);
+}
+
+/*
+ * pgstrom_numeric_fixed_merge
+ */
+Datum
+pgstrom_numeric_fixed_merge(PG_FUNCTION_ARGS)
+{
+	MemoryContext	aggcxt;
+	kern_numeric_fixed *nfixed;
+	kern_numeric_fixed *new_nfixed;
+
+	if (!AggCheckCallContext(fcinfo, &aggcxt))
+		elog(ERROR, "aggregate function called in non-aggregate context");
+	if (PG_ARGISNULL(0))
+	{
+		if (PG_ARGISNULL(1))
+			PG_RETURN_NULL();
+		new_nfixed = __numeric_fixed_validate(PG_GETARG_BYTEA_P(1));
+		nfixed = MemoryContextAlloc(aggcxt, sizeof(kern_numeric_fixed));
+		memcpy(nfixed, new_nfixed, sizeof(kern_numeric_fixed));
+	}
+	else
+	{
+		nfixed = __numeric_fixed_validate(PG_GETARG_BYTEA_P(0));
+		if (!PG_ARGISNULL(1))
+		{
+			new_nfixed = __numeric_fixed_validate(PG_GETARG_BYTEA_P(1));
+			if (nfixed->scale != new_nfixed->scale)
+				elog(ERROR, "incompatible fixed-point accumulator");
+			__numeric_fixed_add(nfixed,
+								new_nfixed->nitems,
+								new_nfixed->sum_lo,
+								new_nfixed->sum_hi);
+		}
+	}
+	PG_RETURN_POINTER(nfixed);
+}
+
+/*
+ * pgstrom_numeric_fixed_sum
+ */
+Datum
+pgstrom_numeric_fixed_sum(PG_FUNCTION_ARGS)
+{
+	kern_numeric_fixed *nfixed
+		= __numeric_fixed_validate(PG_GETARG_BYTEA_P(0));
+
+	if (nfixed->nitems == 0)
+		PG_RETURN_NULL();
+	PG_RETURN_DATUM(__numeric_fixed_to_numeric(nfixed));
+}
+
+/*
+ * pgstrom_numeric_fixed_avg
+ */
+Datum
+pgstrom_numeric_fixed_avg(PG_FUNCTION_ARGS)
+{
+	kern_numeric_fixed *nfixed
+		= __numeric_fixed_validate(PG_GETARG_BYTEA_P(0));
+
+	if (nfixed->nitems == 0)
+		PG_RETURN_NULL();
+	PG_RETURN_DATUM(DirectFunctionCall2(numeric_div,
+										__numeric_fixed_to_numeric(nfixed),
+										DirectFunctionCall1(int8_numeric,
+											Int64GetDatum(nfixed->nitems))));
+}
@@ -158,6 +158,13 @@ typedef union		ArrowTypeOptions
 	struct {
 		int					byteWidth;
 	} fixed_size_binary;
+	struct {
+		unsigned short		index_width;	/* 0, if not dictionary-encoded */
+		unsigned short		__padding__;
+		unsigned int		dict_nitems;	/* number of dictionary items */
+		unsigned int		dict_data_offset; /* offset of the values from
+											   * the offsets array */
+	} dictionary;
 } ArrowTypeOptions;
 
 #ifndef __CUDACC__
@@ -13,6 +13,13 @@
 #include "arrow_defs.h"
 #include "arrow_ipc.h"
 #include "cuda_numeric.cu"
+#include <sys/file.h>
+#ifdef USE_LZ4
+#include <lz4frame.h>
+#endif
+#ifdef USE_ZSTD
+#include <zstd.h>
+#endif
 
 /*
  * RecordBatchState
@@ -30,10 +37,16 @@ typedef struct RecordBatchFieldState
 	size_t		values_length;
 	off_t		extra_offset;
 	size_t		extra_length;
+	size_t		values_minlen;		/* expected length of the values */
+	bool		extra_offsets;		/* values are offsets of the extra */
 	/* min/max statistics */
 	SQLstat__datum stat_min;
 	SQLstat__datum stat_max;
 	bool		stat_isnull;
+	/* bloom filter, if any */
+	bool		stat_has_bloom;
+	int			stat_bloom_unitsz;	/* 0 for Utf8/Binary */
+	uint64		stat_bloom[ARROW_BLOOM_NWORDS];
 	/* sub-fields if any */
 	int			num_children;
 	struct RecordBatchFieldState *children;
@@ -48,6 +61,7 @@ typedef struct RecordBatchState
 	off_t		rb_offset;	/* offset from the head */
 	size_t		rb_length;	/* length of the entire RecordBatch */
 	int64		rb_nitems;	/* number of items */
+	int			rb_compression;	/* ArrowCompressionType, or -1 if none */
 	/* per column information */
 	int			ncols;
 	RecordBatchFieldState columns[FLEXIBLE_ARRAY_MEMBER];
@@ -76,11 +90,33 @@ typedef struct
 	off_t		rb_offset;	/* offset from the head */
     size_t		rb_length;	/* length of the entire RecordBatch */
     int64		rb_nitems;	/* number of items */
+	int			rb_compression;	/* ArrowCompressionType, or -1 if none */
 	int			ncols;
 	int			nfields;	/* length of fstate[] array */
 	RecordBatchFieldState fstate[FLEXIBLE_ARRAY_MEMBER];
 } arrowMetadataCache;
 
+/*
+ * synchronized scan (on shared memory)
+ *
+ * Like synchronize_seqscans of the heap, a scan on arrow files starts at
+ * the RecordBatch being read by the concurrent scan on the same file, if
+ * any, then wraps around. So, the concurrent scans read the same portion
+ * of the file at the same time, and the second or later scans pick up
+ * the data from the page cache, instead of the storage.
+ */
+typedef struct
+{
+	dev_t		st_dev;
+	ino_t		st_ino;
+	int			rb_index;		/* RecordBatch being read */
+	int			pid;			/* the last reporter */
+	TimestampTz	last_update;	/* 0, if unused */
+} arrowSyncScanItem;
+
+#define ARROW_SYNC_SCAN_NELEM			32
+#define ARROW_SYNC_SCAN_TIMEOUT_MS		5000
+
 #define ARROW_METADATA_HASH_NSLOTS		2048
 typedef struct
 {
@@ -91,6 +127,9 @@ typedef struct
 	LWLock		lock_slots[ARROW_METADATA_HASH_NSLOTS];
 	dlist_head	hash_slots[ARROW_METADATA_HASH_NSLOTS];
 	dlist_head	mvcc_slots[ARROW_METADATA_HASH_NSLOTS];
+
+	slock_t		sync_lock;
+	arrowSyncScanItem sync_items[ARROW_SYNC_SCAN_NELEM];
 } arrowMetadataState;
 
 /* setup of MetadataCacheKey */
@@ -116,8 +155,21 @@ typedef struct
 	Bitmapset	   *stat_attrs;
 	Bitmapset	   *load_attrs;
 	ExprContext	   *econtext;
+	List		   *bloom_quals;	/* list of arrowBloomHint */
+	Bitmapset	   *bloom_attrs;
 } arrowStatsHint;
 
+/*
+ * executor hint by bloom filter per record batch
+ */
+typedef struct
+{
+	AttrNumber		anum;
+	Oid				atttypid;
+	int				nitems;
+	Datum			values[FLEXIBLE_ARRAY_MEMBER];
+} arrowBloomHint;
+
 /*
  * MVCC state for the pending writes
  */
@@ -131,7 +183,7 @@ typedef struct
 } arrowWriteMVCCLog;
 
 /*
- * REDO Log for INSERT/TRUNCATE
+ * REDO Log for INSERT/TRUNCATE/COMPACT
  */
 typedef struct
 {
@@ -141,7 +193,8 @@ typedef struct
 	CommandId	cid;
 	char	   *pathname;
 	bool		is_truncate;
-	/* for TRUNCATE */
+	bool		is_compact;
+	/* for TRUNCATE/COMPACT */
 	uint32		suffix;
 	/* for INSERT */
 	loff_t		footer_offset;
@@ -170,6 +223,8 @@ struct ArrowFdwState
 	List	   *gpuDirectFileDescList;	/* list of GPUDirectFileDesc */
 	List	   *fdescList;				/* list of File (buffered i/o) */
 	Bitmapset  *referenced;
+	Bitmapset  *stat_attrs;			/* attributes with min/max statistics */
+	List	   *stats_quals;		/* qualifiers for stats_hint */
 	arrowStatsHint *stats_hint;
 	pg_atomic_uint32   *rbatch_index;
 	pg_atomic_uint32	__rbatch_index_local;	/* if single process */
@@ -177,13 +232,51 @@ struct ArrowFdwState
 	pg_atomic_uint32	__rbatch_nload_local;	/* if single process */
 	pg_atomic_uint32   *rbatch_nskip;
 	pg_atomic_uint32	__rbatch_nskip_local;	/* if single process */
+	pg_atomic_uint64   *rbatch_comp_sz;
+	pg_atomic_uint64	__rbatch_comp_sz_local;	/* if single process */
+	pg_atomic_uint64   *rbatch_raw_sz;
+	pg_atomic_uint64	__rbatch_raw_sz_local;	/* if single process */
+	pg_atomic_uint64   *rbatch_gpu_comp_sz;		/* decompressed by GPU */
+	pg_atomic_uint64	__rbatch_gpu_comp_sz_local;	/* if single process */
+	bool		gpu_decompression;	/* foreign table option */
+	bool		sync_scan;			/* synchronized scan is enabled */
+	uint32		sync_start;			/* the first RecordBatch to read */
 	pgstrom_data_store *curr_pds;	/* current focused buffer */
 	cl_ulong	curr_index;			/* current index to row on KDS */
+	/* late materialization (CPU scan only) */
+	Bitmapset  *filter_attrs;		/* columns referenced by quals */
+	Bitmapset  *late_attrs;			/* columns loaded after the quals */
+	RecordBatchState *curr_rbstate;	/* RecordBatch of curr_pds */
+	pgstrom_data_store *late_pds;	/* buffer of late_attrs */
+	bool	   *late_passed;		/* rows that satisfied the quals */
+	/* incremental scan by arrow_fdw.consumer */
+	List	   *consumer_marks;		/* list of arrowConsumerEntry */
 	/* state of RecordBatches */
 	uint32		num_rbatches;
 	RecordBatchState *rbatches[FLEXIBLE_ARRAY_MEMBER];
 };
 
+/*
+ * incremental scan by the consumer (session local)
+ *
+ * Once arrow_fdw.consumer is set, the scan skips RecordBatches already
+ * consumed by the earlier scans with the same consumer name, so polling
+ * queries on the arrow files being appended (e.g, by pcap2arrow or
+ * fluentd) process only the RecordBatches newly appended.
+ */
+typedef struct
+{
+	char		name[NAMEDATALEN];
+	dev_t		st_dev;
+	ino_t		st_ino;
+} arrowConsumerKey;
+
+typedef struct
+{
+	arrowConsumerKey key;
+	int			num_consumed;	/* number of RecordBatches consumed */
+} arrowConsumerEntry;
+
 /* ---------- static variables ---------- */
 static FdwRoutine		pgstrom_arrow_fdw_routine;
 static shmem_startup_hook_type shmem_startup_next = NULL;
@@ -194,6 +287,14 @@ static bool				arrow_fdw_stats_hint_enabled;	/* GUC */
 static int				arrow_metadata_cache_size_kb;	/* GUC */
 static size_t			arrow_metadata_cache_size;
 static int				arrow_record_batch_size_kb;		/* GUC */
+static char			   *arrow_metadata_cache_dir = NULL;	/* GUC */
+static int				arrow_io_merge_gap_kb;			/* GUC */
+static int				arrow_readahead_batches;		/* GUC */
+static bool				arrow_late_materialization;		/* GUC */
+static bool				arrow_sync_scan_enabled;		/* GUC */
+static char			   *arrow_fdw_consumer = NULL;		/* GUC */
+static HTAB			   *arrow_consumer_htab = NULL;
+int						arrow_io_parallelism;			/* GUC */
 
 /* ---------- static functions ---------- */
 static Oid		arrowTypeToPGTypeOid(ArrowField *field, int *typmod);
@@ -203,8 +304,11 @@ static bool		arrowSchemaCompatibilityCheck(TupleDesc tupdesc,
 											  RecordBatchState *rb_state);
 static List	   *__arrowFdwExtractFilesList(List *options_list,
 										   int *p_parallel_nworkers,
-										   bool *p_writable);
+										   bool *p_writable,
+										   bool *p_gpu_decompression);
 static List	   *arrowFdwExtractFilesList(List *options_list);
+static List	   *arrowFdwPruneFilesList(List *filesList, List *options_list,
+									   TupleDesc tupdesc, List *quals);
 static List	   *arrowLookupOrBuildMetadataCache(File fdesc, Bitmapset **p_stat_attrs);
 static void		pg_datum_arrow_ref(kern_data_store *kds,
 								   kern_colmeta *cmeta,
@@ -224,7 +328,9 @@ Datum	pgstrom_arrow_fdw_handler(PG_FUNCTION_ARGS);
 Datum	pgstrom_arrow_fdw_validator(PG_FUNCTION_ARGS);
 Datum	pgstrom_arrow_fdw_precheck_schema(PG_FUNCTION_ARGS);
 Datum	pgstrom_arrow_fdw_truncate(PG_FUNCTION_ARGS);
+Datum	pgstrom_arrow_fdw_compact(PG_FUNCTION_ARGS);
 Datum	pgstrom_arrow_fdw_import_file(PG_FUNCTION_ARGS);
+Datum	pgstrom_arrow_fdw_reset_consumer(PG_FUNCTION_ARGS);
 
 /*
  * timespec_comp - compare timespec values
@@ -341,6 +447,13 @@ ArrowGetForeignRelSize(PlannerInfo *root,
 	Bitmapset	   *optimal_gpus = (void *)(~0UL);
 	int				j, k;
 
+	/*
+	 * incremental scan by the consumer relies on the session local state,
+	 * so the parallel workers cannot know which RecordBatches to be skipped.
+	 */
+	if (arrow_fdw_consumer && *arrow_fdw_consumer != '\0')
+		baserel->consider_parallel = false;
+
 	/* columns to be fetched */
 	foreach (lc, baserel->baserestrictinfo)
 	{
@@ -352,7 +465,17 @@ ArrowGetForeignRelSize(PlannerInfo *root,
 
 	filesList = __arrowFdwExtractFilesList(ft->options,
 										   &parallel_nworkers,
-										   &writable);
+										   &writable,
+										   NULL);
+	if (baserel->baserestrictinfo != NIL)
+	{
+		Relation	frel = table_open(foreigntableid, NoLock);
+
+		filesList = arrowFdwPruneFilesList(filesList, ft->options,
+										   RelationGetDescr(frel),
+										   baserel->baserestrictinfo);
+		table_close(frel, NoLock);
+	}
 	foreach (lc, filesList)
 	{
 		char	   *fname = strVal(lfirst(lc));
@@ -632,6 +755,11 @@ ArrowGetForeignPlan(PlannerInfo *root,
  *
  * This min/max array is expected to have as many integer elements or nulls
  * as there are record-batches.
+ *
+ * Also, custom-metadata of "bloom_filters" contains comma separated hex-
+ * strings of the bloom filter (or nulls) per record-batch. It allows to
+ * skip record batches that cannot contain the values of equality or IN
+ * qualifiers, even if min/max statistics are not selective.
  * ----------------------------------------------------------------
  */
 
@@ -648,6 +776,9 @@ typedef struct arrowFieldStatsBinary
 	bool   *isnull;
 	char   *min_values;
 	char   *max_values;
+	int		bloom_unitsz;	/* unit size of the hashed datum, or 0 */
+	bool   *bloom_valid;
+	uint64 *bloom_bits;		/* ARROW_BLOOM_NWORDS per record-batch */
 	int		nfields;	/* if List/Struct data type */
 	struct arrowFieldStatsBinary *subfields;
 } arrowFieldStatsBinary;
@@ -676,6 +807,10 @@ __releaseArrowFieldStatsBinary(arrowFieldStatsBinary *bstats)
 		pfree(bstats->min_values);
 	if (bstats->max_values)
 		pfree(bstats->max_values);
+	if (bstats->bloom_valid)
+		pfree(bstats->bloom_valid);
+	if (bstats->bloom_bits)
+		pfree(bstats->bloom_bits);
 }
 
 static void
@@ -869,6 +1004,86 @@ __parseArrowFieldStatsBinary(arrowFieldStatsBinary *bstats,
 	return false;
 }
 
+static bool
+__parseArrowFieldBloomBinary(arrowFieldStatsBinary *bstats,
+							 ArrowField *field,
+							 const char *bloom_tokens)
+{
+	int			unitsz;
+	char	   *buffer;
+	char	   *tok, *pos;
+	bool	   *bloom_valid;
+	uint64	   *bloom_bits;
+	uint32		index;
+	int			k;
+
+	/* see sql_field_bloom_update() */
+	switch (field->type.node.tag)
+	{
+		case ArrowNodeTag__Int:
+			unitsz = field->type.Int.bitWidth / 8;
+			break;
+		case ArrowNodeTag__Date:
+			if (field->type.Date.unit == ArrowDateUnit__Day)
+				unitsz = sizeof(int32);
+			else
+				unitsz = sizeof(int64);
+			break;
+		case ArrowNodeTag__Timestamp:
+			unitsz = sizeof(int64);
+			break;
+		case ArrowNodeTag__Utf8:
+		case ArrowNodeTag__Binary:
+			if (field->dictionary)
+				return false;
+			unitsz = 0;
+			break;
+		default:
+			return false;
+	}
+	buffer = pstrdup(bloom_tokens);
+	bloom_valid = palloc0(sizeof(bool) * bstats->nrooms);
+	bloom_bits = palloc0(sizeof(uint64) * ARROW_BLOOM_NWORDS * bstats->nrooms);
+	for (tok = strtok_r(buffer, ",", &pos), index = 0;
+		 tok != NULL && index < bstats->nrooms;
+		 tok = strtok_r(NULL, ",", &pos), index++)
+	{
+		uint64	   *bits = bloom_bits + ARROW_BLOOM_NWORDS * index;
+
+		tok = __trim(tok);
+		if (strcmp(tok, "null") == 0)
+			continue;
+		if (strlen(tok) != ARROW_BLOOM_NBITS / 4)
+			break;
+		for (k=0; k < ARROW_BLOOM_NWORDS; k++)
+		{
+			char	temp[17];
+			char   *end;
+
+			memcpy(temp, tok + 16 * k, 16);
+			temp[16] = '\0';
+			bits[k] = strtoul(temp, &end, 16);
+			if (*end != '\0')
+				break;
+		}
+		if (k < ARROW_BLOOM_NWORDS)
+			break;
+		bloom_valid[index] = true;
+	}
+	pfree(buffer);
+	/* sanity checks */
+	if (!tok && index == bstats->nrooms)
+	{
+		bstats->bloom_unitsz = unitsz;
+		bstats->bloom_valid = bloom_valid;
+		bstats->bloom_bits = bloom_bits;
+		return true;
+	}
+	pfree(bloom_valid);
+	pfree(bloom_bits);
+	return false;
+}
+
 static bool
 __buildArrowFieldStatsBinary(arrowFieldStatsBinary *bstats,
 							 ArrowField *field,
@@ -876,6 +1091,7 @@ __buildArrowFieldStatsBinary(arrowFieldStatsBinary *bstats,
 {
 	const char *min_tokens = NULL;
 	const char *max_tokens = NULL;
+	const char *bloom_tokens = NULL;
 	int			j, k;
 	bool		retval = false;
 
@@ -887,9 +1103,14 @@ __buildArrowFieldStatsBinary(arrowFieldStatsBinary *bstats,
 			min_tokens = kv->value;
 		else if (strcmp(kv->key, "max_values") == 0)
 			max_tokens = kv->value;
+		else if (strcmp(kv->key, "bloom_filters") == 0)
+			bloom_tokens = kv->value;
 	}
 
 	bstats->nrooms = numRecordBatches;
+	if (bloom_tokens &&
+		__parseArrowFieldBloomBinary(bstats, field, bloom_tokens))
+		retval = true;
 	bstats->unitsz = -1;
 	if (min_tokens && max_tokens)
 	{
@@ -991,6 +1212,23 @@ __applyArrowFieldStatsBinary(RecordBatchFieldState *fstate,
 		memset(&fstate->stat_max, 0, sizeof(SQLstat__datum));
 		fstate->stat_isnull = true;
 	}
+
+	if (bstats->bloom_valid != NULL &&
+		bstats->bloom_bits != NULL &&
+		bstats->bloom_valid[rb_index])
+	{
+		memcpy(fstate->stat_bloom,
+			   bstats->bloom_bits + ARROW_BLOOM_NWORDS * rb_index,
+			   sizeof(uint64) * ARROW_BLOOM_NWORDS);
+		fstate->stat_bloom_unitsz = bstats->bloom_unitsz;
+		fstate->stat_has_bloom = true;
+	}
+	else
+	{
+		memset(fstate->stat_bloom, 0, sizeof(uint64) * ARROW_BLOOM_NWORDS);
+		fstate->stat_bloom_unitsz = 0;
+		fstate->stat_has_bloom = false;
+	}
 	
 	Assert(fstate->num_children == bstats->nfields);
 	for (j=0; j < fstate->num_children; j++)
@@ -1082,6 +1320,49 @@ __buildArrowFieldStatsList(ArrowField *field, uint32 numRecordBatches)
 	return NULL;
 }
 
+static SQLbloom *
+__buildArrowFieldBloomList(ArrowField *field, uint32 numRecordBatches)
+{
+	arrowFieldStatsBinary bstats;
+	SQLbloom   *results = NULL;
+	int			k;
+	uint32		index;
+
+	for (k=0; k < field->_num_custom_metadata; k++)
+	{
+		ArrowKeyValue *kv = &field->custom_metadata[k];
+
+		if (strcmp(kv->key, "bloom_filters") == 0)
+			break;
+	}
+	if (k >= field->_num_custom_metadata)
+		return NULL;
+
+	memset(&bstats, 0, sizeof(arrowFieldStatsBinary));
+	bstats.nrooms = numRecordBatches;
+	if (!__parseArrowFieldBloomBinary(&bstats, field,
+									  field->custom_metadata[k].value))
+		return NULL;
+	for (index=0; index < numRecordBatches; index++)
+	{
+		SQLbloom   *item;
+
+		if (!bstats.bloom_valid[index])
+			continue;
+		item = palloc0(sizeof(SQLbloom));
+		item->next = results;
+		item->rb_index = index;
+		item->is_valid = true;
+		memcpy(item->bits, bstats.bloom_bits + ARROW_BLOOM_NWORDS * index,
+			   sizeof(uint64) * ARROW_BLOOM_NWORDS);
+		results = item;
+	}
+	pfree(bstats.bloom_valid);
+	pfree(bstats.bloom_bits);
+
+	return results;
+}
+
 /*
  * execInitArrowStatsHint / execCheckArrowStatsHint / execEndArrowStatsHint
  *
@@ -1231,6 +1512,140 @@ __buildArrowStatsOper(arrowStatsHint *arange,
 	return true;
 }
 
+/*
+ * __buildArrowBloomOper / __buildArrowBloomArrayOper
+ *
+ * (VAR = CONST) or (VAR = ANY(CONST_ARRAY)) can be checked by the bloom
+ * filter. Only the default equality operator of the type is supported,
+ * because bloom filter is built on the binary representation.
+ */
+static Var *
+__checkArrowBloomVar(arrowStatsHint *arange,
+					 ScanState *ss,
+					 Oid opcode, Oid inputcollid, Node *node)
+{
+	Index		scanrelid = ((Scan *)ss->ps.plan)->scanrelid;
+	Var		   *var = (Var *)node;
+	TypeCacheEntry *tcache;
+
+	if (!IsA(var, Var) || var->varno != scanrelid)
+		return NULL;
+	if (!bms_is_member(var->varattno, arange->stat_attrs))
+		return NULL;
+	switch (var->vartype)
+	{
+		case INT1OID:
+		case INT2OID:
+		case INT4OID:
+		case INT8OID:
+		case DATEOID:
+		case TIMESTAMPOID:
+		case TIMESTAMPTZOID:
+			break;
+		case TEXTOID:
+		case VARCHAROID:
+#if PG_VERSION_NUM >= 120000
+			if (OidIsValid(inputcollid) &&
+				!get_collation_isdeterministic(inputcollid))
+				return NULL;
+#endif
+			break;
+		case BYTEAOID:
+			break;
+		default:
+			return NULL;
+	}
+	tcache = lookup_type_cache(var->vartype, TYPECACHE_EQ_OPR);
+	if (tcache->eq_opr != opcode)
+		return NULL;
+	return var;
+}
+
+static bool
+__buildArrowBloomOper(arrowStatsHint *arange,
+					  ScanState *ss,
+					  OpExpr *op)
+{
+	Var		   *var;
+	Const	   *con;
+	arrowBloomHint *bhint;
+
+	var = __checkArrowBloomVar(arange, ss, op->opno, op->inputcollid,
+							   linitial(op->args));
+	con = lsecond(op->args);
+	if (!var)
+	{
+		/* (CONST = VAR) form? */
+		var = __checkArrowBloomVar(arange, ss, op->opno, op->inputcollid,
+								   lsecond(op->args));
+		con = linitial(op->args);
+	}
+	if (!var || !IsA(con, Const) || con->constisnull ||
+		con->consttype != var->vartype)
+		return false;
+
+	bhint = palloc0(offsetof(arrowBloomHint, values[1]));
+	bhint->anum = var->varattno;
+	bhint->atttypid = var->vartype;
+	bhint->nitems = 1;
+	bhint->values[0] = con->constvalue;
+	if (con->constlen == -1)
+		bhint->values[0] = PointerGetDatum(PG_DETOAST_DATUM_PACKED(con->constvalue));
+
+	arange->bloom_quals = lappend(arange->bloom_quals, bhint);
+	arange->bloom_attrs = bms_add_member(arange->bloom_attrs,
+										 var->varattno);
+	return true;
+}
+
+static bool
+__buildArrowBloomArrayOper(arrowStatsHint *arange,
+						   ScanState *ss,
+						   ScalarArrayOpExpr *op)
+{
+	Var		   *var;
+	Const	   *con;
+	ArrayType  *array;
+	int16		typlen;
+	bool		typbyval;
+	char		typalign;
+	Datum	   *elem_values;
+	bool	   *elem_isnull;
+	int			i, nitems;
+	arrowBloomHint *bhint;
+
+	if (!op->useOr || list_length(op->args) != 2)
+		return false;
+	var = __checkArrowBloomVar(arange, ss, op->opno, op->inputcollid,
+							   linitial(op->args));
+	con = lsecond(op->args);
+	if (!var || !IsA(con, Const) || con->constisnull ||
+		get_element_type(con->consttype) != var->vartype)
+		return false;
+
+	array = DatumGetArrayTypeP(con->constvalue);
+	get_typlenbyvalalign(var->vartype, &typlen, &typbyval, &typalign);
+	deconstruct_array(array, var->vartype, typlen, typbyval, typalign,
+					  &elem_values, &elem_isnull, &nitems);
+
+	bhint = palloc0(offsetof(arrowBloomHint, values[nitems]));
+	bhint->anum = var->varattno;
+	bhint->atttypid = var->vartype;
+	for (i=0; i < nitems; i++)
+	{
+		/* NULL never matches to the equality operator */
+		if (elem_isnull[i])
+			continue;
+		if (typlen == -1)
+			elem_values[i] = PointerGetDatum(PG_DETOAST_DATUM_PACKED(elem_values[i]));
+		bhint->values[bhint->nitems++] = elem_values[i];
+	}
+	arange->bloom_quals = lappend(arange->bloom_quals, bhint);
+	arange->bloom_attrs = bms_add_member(arange->bloom_attrs,
+										 var->varattno);
+	return true;
+}
+
 static arrowStatsHint *
 execInitArrowStatsHint(ScanState *ss,
 					   Bitmapset *stat_attrs,
@@ -1247,20 +1662,39 @@ execInitArrowStatsHint(ScanState *ss,
 	temp.stat_attrs = stat_attrs;
 	foreach (lc, outer_quals)
 	{
-		OpExpr *op = lfirst(lc);
+		Node   *qual = lfirst(lc);
+		bool	found = false;
+
+		if (IsA(qual, OpExpr))
+		{
+			OpExpr *op = (OpExpr *)qual;
 
-		if (IsA(op, OpExpr) && list_length(op->args) == 2 &&
-			(__buildArrowStatsOper(&temp, ss, op, false) ||
-			 __buildArrowStatsOper(&temp, ss, op, true)))
+			if (list_length(op->args) == 2)
+			{
+				if (__buildArrowStatsOper(&temp, ss, op, false) ||
+					__buildArrowStatsOper(&temp, ss, op, true))
+					found = true;
+				if (__buildArrowBloomOper(&temp, ss, op))
+					found = true;
+			}
+		}
+		else if (IsA(qual, ScalarArrayOpExpr))
 		{
-			temp.orig_quals = lappend(temp.orig_quals, copyObject(op));
+			if (__buildArrowBloomArrayOper(&temp, ss,
+										   (ScalarArrayOpExpr *)qual))
+				found = true;
 		}
+		if (found)
+			temp.orig_quals = lappend(temp.orig_quals, copyObject(qual));
 	}
 	if (!temp.orig_quals)
 		return NULL;
 
-	Assert(list_length(temp.eval_quals) > 0);
-	if (list_length(temp.eval_quals) == 1)
+	Assert(list_length(temp.eval_quals) > 0 ||
+		   list_length(temp.bloom_quals) > 0);
+	if (list_length(temp.eval_quals) == 0)
+		eval_expr = NULL;
+	else if (list_length(temp.eval_quals) == 1)
 		eval_expr = linitial(temp.eval_quals);
 	else
 		eval_expr = make_andclause(temp.eval_quals);
@@ -1272,10 +1706,12 @@ execInitArrowStatsHint(ScanState *ss,
 	result = palloc0(sizeof(arrowStatsHint));
 	result->orig_quals = temp.orig_quals;
 	result->eval_quals = temp.eval_quals;
-	result->eval_state = ExecInitExpr(eval_expr, &ss->ps);
+	result->eval_state = (eval_expr ? ExecInitExpr(eval_expr, &ss->ps) : NULL);
 	result->stat_attrs = bms_copy(stat_attrs);
 	result->load_attrs = temp.load_attrs;
 	result->econtext   = econtext;
+	result->bloom_quals = temp.bloom_quals;
+	result->bloom_attrs = temp.bloom_attrs;
 
 	return result;
 }
@@ -1385,6 +1821,136 @@ __fetchArrowStatsDatum(RecordBatchFieldState *fstate,
 	return true;
 }
 
+/*
+ * __fetchArrowBloomDatum
+ *
+ * It transforms the PostgreSQL datum into the Apache Arrow representation
+ * to be hashed by the bloom filter. It returns false if not available.
+ */
+static bool
+__fetchArrowBloomDatum(RecordBatchFieldState *fstate,
+					   Oid atttypid, Datum datum,
+					   const void **p_addr, size_t *p_len,
+					   int64 *ival)
+{
+	int			unitsz = fstate->stat_bloom_unitsz;
+	int64		shift;
+
+	switch (atttypid)
+	{
+		case INT1OID:
+			*ival = DatumGetChar(datum);
+			break;
+		case INT2OID:
+			*ival = DatumGetInt16(datum);
+			break;
+		case INT4OID:
+			*ival = DatumGetInt32(datum);
+			break;
+		case INT8OID:
+			*ival = DatumGetInt64(datum);
+			break;
+		case DATEOID:
+			shift = POSTGRES_EPOCH_JDATE - UNIX_EPOCH_JDATE;
+			switch (fstate->attopts.date.unit)
+			{
+				case ArrowDateUnit__Day:
+					*ival = (int64)DatumGetDateADT(datum) + shift;
+					break;
+				case ArrowDateUnit__MilliSecond:
+					*ival = ((int64)DatumGetDateADT(datum) + shift) * 86400000L;
+					break;
+				default:
+					return false;
+			}
+			break;
+		case TIMESTAMPOID:
+		case TIMESTAMPTZOID:
+			shift = (POSTGRES_EPOCH_JDATE - UNIX_EPOCH_JDATE) * USECS_PER_DAY;
+			*ival = DatumGetTimestamp(datum) + shift;
+			switch (fstate->attopts.timestamp.unit)
+			{
+				case ArrowTimeUnit__Second:
+					if (*ival % 1000000L != 0)
+						return false;
+					*ival /= 1000000L;
+					break;
+				case ArrowTimeUnit__MilliSecond:
+					if (*ival % 1000L != 0)
+						return false;
+					*ival /= 1000L;
+					break;
+				case ArrowTimeUnit__MicroSecond:
+					break;
+				case ArrowTimeUnit__NanoSecond:
+					*ival *= 1000L;
+					break;
+				default:
+					return false;
+			}
+			break;
+		case TEXTOID:
+		case VARCHAROID:
+		case BYTEAOID:
+			if (unitsz != 0)
+				return false;
+			*p_addr = VARDATA_ANY(datum);
+			*p_len = VARSIZE_ANY_EXHDR(datum);
+			return true;
+		default:
+			return false;
+	}
+	/* fixed-length integer in little endian */
+	if (unitsz <= 0 || unitsz > sizeof(int64))
+		return false;
+	*p_addr = ival;
+	*p_len = unitsz;
+	return true;
+}
+
+/*
+ * __execCheckArrowBloomHint
+ *
+ * It returns true, if any of bloom filters tells us the record-batch cannot
+ * contain the values required by the qualifiers.
+ */
+static bool
+__execCheckArrowBloomHint(arrowStatsHint *stats_hint,
+						  RecordBatchState *rb_state)
+{
+	ListCell   *lc;
+
+	foreach (lc, stats_hint->bloom_quals)
+	{
+		arrowBloomHint *bhint = lfirst(lc);
+		RecordBatchFieldState *fstate = &rb_state->columns[bhint->anum-1];
+		bool		maybe_match = false;
+		int			i;
+
+		Assert(bhint->anum > 0 && bhint->anum <= rb_state->ncols);
+		if (!fstate->stat_has_bloom)
+			continue;
+		for (i=0; i < bhint->nitems; i++)
+		{
+			const void *addr;
+			size_t		len;
+			int64		ival;
+
+			if (!__fetchArrowBloomDatum(fstate, bhint->atttypid,
+										bhint->values[i],
+										&addr, &len, &ival) ||
+				sql_bloom_check(fstate->stat_bloom, addr, len))
+			{
+				maybe_match = true;
+				break;
+			}
+		}
+		if (!maybe_match)
+			return true;
+	}
+	return false;
+}
+
 static bool
 execCheckArrowStatsHint(arrowStatsHint *stats_hint,
 						RecordBatchState *rb_state)
@@ -1396,6 +1962,13 @@ execCheckArrowStatsHint(arrowStatsHint *stats_hint,
 	Datum			datum;
 	bool			isnull;
 
+	/* check the bloom filter first */
+	if (stats_hint->bloom_quals != NIL &&
+		__execCheckArrowBloomHint(stats_hint, rb_state))
+		return true;
+	if (!stats_hint->eval_state)
+		return false;
+
 	/* load the min/max statistics */
 	ExecStoreAllNullTuple(min_values);
 	ExecStoreAllNullTuple(max_values);
@@ -1454,6 +2027,9 @@ typedef struct
 	ArrowBuffer    *buffer_tail;
 	ArrowFieldNode *fnode_curr;
 	ArrowFieldNode *fnode_tail;
+	bool			compressed;		/* buffers are compressed */
+	off_t			rb_offset;		/* file position of the RecordBatch */
+	ArrowFileInfo  *af_info;		/* to lookup DictionaryBatch */
 } setupRecordBatchContext;
 
 static void
@@ -1513,24 +2089,162 @@ assignArrowTypeOptions(ArrowTypeOptions *attopts, const ArrowType *atype)
 	}
 }
 
+/*
+ * setupRecordBatchDictionary
+ *
+ * A dictionary-encoded field has its nullmap and index values in the
+ * RecordBatch, and the dictionary itself (Utf8 or Binary) in the
+ * DictionaryBatch with the same id. The offset and value buffers of the
+ * dictionary are loaded as extra buffer of the field; its position is
+ * relative to the RecordBatch, so it may be negative.
+ */
 static void
-setupRecordBatchField(setupRecordBatchContext *con,
-					  RecordBatchFieldState *fstate,
-					  ArrowField  *field,
-					  int depth)
+setupRecordBatchDictionary(setupRecordBatchContext *con,
+						   RecordBatchFieldState *fstate,
+						   ArrowField *field,
+						   int depth)
 {
+	ArrowDictionaryEncoding *dict = field->dictionary;
+	ArrowFileInfo  *af_info = con->af_info;
+	ArrowRecordBatch *dbatch = NULL;
+	ArrowBlock	   *dblock = NULL;
 	ArrowBuffer	   *buffer_curr;
-	ArrowFieldNode *fnode;
-
-	if (con->fnode_curr >= con->fnode_tail)
-		elog(ERROR, "RecordBatch has less ArrowFieldNode than expected");
-	fnode = con->fnode_curr++;
-	fstate->atttypid   = arrowTypeToPGTypeOid(field, &fstate->atttypmod);
-	fstate->nitems     = fnode->length;
-	fstate->null_count = fnode->null_count;
-	fstate->stat_isnull = true;
-
-	switch (field->type.node.tag)
+	ArrowBuffer	   *dict_offsets;
+	ArrowBuffer	   *dict_values;
+	off_t			dict_pos;
+	int				index_width;
+	int				i;
+
+	if (depth > 0)
+		elog(ERROR, "arrow_fdw: dictionary-encoded sub-field is not supported");
+	if (field->type.node.tag != ArrowNodeTag__Utf8 &&
+		field->type.node.tag != ArrowNodeTag__Binary)
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("arrow_fdw: dictionary-encoded field '%s' must have Utf8 or Binary values",
+						field->name)));
+	if (con->compressed)
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("arrow_fdw: dictionary-encoded field '%s' in compressed RecordBatch is not supported",
+						field->name)));
+	/* Int32 is the default index type of DictionaryEncoding */
+	index_width = (dict->indexType.bitWidth == 0
+				   ? sizeof(int32)
+				   : dict->indexType.bitWidth / BITS_PER_BYTE);
+	if (index_width != sizeof(int8)  &&
+		index_width != sizeof(int16) &&
+		index_width != sizeof(int32) &&
+		index_width != sizeof(int64))
+		elog(ERROR, "arrow_fdw: unexpected index bitWidth (%d) of the dictionary",
+			 dict->indexType.bitWidth);
+
+	/* lookup the DictionaryBatch */
+	for (i=0; i < af_info->footer._num_dictionaries; i++)
+	{
+		ArrowDictionaryBatch *__dbatch
+			= &af_info->dictionaries[i].body.dictionaryBatch;
+
+		if (__dbatch->id != dict->id)
+			continue;
+		if (dbatch || __dbatch->isDelta)
+			ereport(ERROR,
+					(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+					 errmsg("arrow_fdw: delta or replacement of the dictionary (id=%ld) is not supported",
+							dict->id)));
+		dbatch = &__dbatch->data;
+		dblock = &af_info->footer.dictionaries[i];
+	}
+	if (!dbatch)
+		elog(ERROR, "arrow_fdw: DictionaryBatch (id=%ld) was not found",
+			 dict->id);
+	if (dbatch->compression)
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("arrow_fdw: compressed DictionaryBatch (id=%ld) is not supported",
+						dict->id)));
+	if (dbatch->_num_nodes != 1 || dbatch->_num_buffers != 3)
+		elog(ERROR, "arrow_fdw: DictionaryBatch (id=%ld) has unexpected layout",
+			 dict->id);
+	if (dbatch->nodes[0].null_count > 0)
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("arrow_fdw: DictionaryBatch (id=%ld) with NULL entries is not supported",
+						dict->id)));
+	if (dbatch->length < 0 || dbatch->length >= UINT_MAX)
+		elog(ERROR, "arrow_fdw: DictionaryBatch (id=%ld) has too many items",
+			 dict->id);
+	dict_offsets = &dbatch->buffers[1];
+	dict_values  = &dbatch->buffers[2];
+	if (dict_offsets->length < sizeof(uint32) * (dbatch->length + 1))
+		elog(ERROR, "offset array of the dictionary is smaller than expected");
+	if ((dict_offsets->offset & (MAXIMUM_ALIGNOF - 1)) != 0 ||
+		(dict_values->offset & (MAXIMUM_ALIGNOF - 1)) != 0)
+		elog(ERROR, "dictionary buffers are not aligned well");
+	if (dict_offsets->offset + dict_offsets->length > dict_values->offset)
+		elog(ERROR, "arrow_fdw: DictionaryBatch (id=%ld) has unexpected layout",
+			 dict->id);
+
+	/* nullmap */
+	if (con->buffer_curr + 2 > con->buffer_tail)
+		elog(ERROR, "RecordBatch has less buffers than expected");
+	buffer_curr = con->buffer_curr++;
+	if (fstate->null_count > 0)
+	{
+		fstate->nullmap_offset = buffer_curr->offset;
+		fstate->nullmap_length = buffer_curr->length;
+		if (fstate->nullmap_length < BITMAPLEN(fstate->nitems))
+			elog(ERROR, "nullmap length is smaller than expected");
+		if ((fstate->nullmap_offset & (MAXIMUM_ALIGNOF - 1)) != 0)
+			elog(ERROR, "nullmap is not aligned well");
+	}
+	/* index values */
+	buffer_curr = con->buffer_curr++;
+	fstate->values_offset = buffer_curr->offset;
+	fstate->values_length = buffer_curr->length;
+	fstate->values_minlen = index_width * fstate->nitems;
+	if (fstate->values_length < fstate->values_minlen)
+		elog(ERROR, "index array is smaller than expected");
+	if ((fstate->values_offset & (MAXIMUM_ALIGNOF - 1)) != 0)
+		elog(ERROR, "index array is not aligned well");
+	/* offsets and values of the dictionary */
+	dict_pos = dblock->offset + dblock->metaDataLength;
+	fstate->extra_offset = dict_pos + dict_offsets->offset - con->rb_offset;
+	fstate->extra_length = (dict_values->offset +
+							dict_values->length - dict_offsets->offset);
+
+	/* assign extra attributes after the type options */
+	assignArrowTypeOptions(&fstate->attopts, &field->type);
+	fstate->attopts.dictionary.index_width = index_width;
+	fstate->attopts.dictionary.dict_nitems = dbatch->length;
+	fstate->attopts.dictionary.dict_data_offset = (dict_values->offset -
+												   dict_offsets->offset);
+}
+
+static void
+setupRecordBatchField(setupRecordBatchContext *con,
+					  RecordBatchFieldState *fstate,
+					  ArrowField  *field,
+					  int depth)
+{
+	ArrowBuffer	   *buffer_curr;
+	ArrowFieldNode *fnode;
+
+	if (con->fnode_curr >= con->fnode_tail)
+		elog(ERROR, "RecordBatch has less ArrowFieldNode than expected");
+	fnode = con->fnode_curr++;
+	fstate->atttypid   = arrowTypeToPGTypeOid(field, &fstate->atttypmod);
+	fstate->nitems     = fnode->length;
+	fstate->null_count = fnode->null_count;
+	fstate->stat_isnull = true;
+
+	if (field->dictionary)
+	{
+		setupRecordBatchDictionary(con, fstate, field, depth);
+		return;
+	}
+
+	switch (field->type.node.tag)
 	{
 		case ArrowNodeTag__Int:
 		case ArrowNodeTag__FloatingPoint:
@@ -1549,7 +2263,8 @@ setupRecordBatchField(setupRecordBatchContext *con,
 			{
 				fstate->nullmap_offset = buffer_curr->offset;
 				fstate->nullmap_length = buffer_curr->length;
-				if (fstate->nullmap_length < BITMAPLEN(fstate->nitems))
+				if (!con->compressed &&
+					fstate->nullmap_length < BITMAPLEN(fstate->nitems))
 					elog(ERROR, "nullmap length is smaller than expected");
 				if ((fstate->nullmap_offset & (MAXIMUM_ALIGNOF - 1)) != 0)
 					elog(ERROR, "nullmap is not aligned well");
@@ -1557,7 +2272,9 @@ setupRecordBatchField(setupRecordBatchContext *con,
 			buffer_curr = con->buffer_curr++;
 			fstate->values_offset = buffer_curr->offset;
 			fstate->values_length = buffer_curr->length;
-			if (fstate->values_length < arrowFieldLength(field,fstate->nitems))
+			fstate->values_minlen = arrowFieldLength(field,fstate->nitems);
+			if (!con->compressed &&
+				fstate->values_length < fstate->values_minlen)
 				elog(ERROR, "values array is smaller than expected");
 			if ((fstate->values_offset & (MAXIMUM_ALIGNOF - 1)) != 0)
 				elog(ERROR, "values array is not aligned well");
@@ -1576,7 +2293,8 @@ setupRecordBatchField(setupRecordBatchContext *con,
 			{
 				fstate->nullmap_offset = buffer_curr->offset;
 				fstate->nullmap_length = buffer_curr->length;
-				if (fstate->nullmap_length < BITMAPLEN(fstate->nitems))
+				if (!con->compressed &&
+					fstate->nullmap_length < BITMAPLEN(fstate->nitems))
 					elog(ERROR, "nullmap length is smaller than expected");
 				if ((fstate->nullmap_offset & (MAXIMUM_ALIGNOF - 1)) != 0)
 					elog(ERROR, "nullmap is not aligned well");
@@ -1585,7 +2303,9 @@ setupRecordBatchField(setupRecordBatchContext *con,
 			buffer_curr = con->buffer_curr++;
 			fstate->values_offset = buffer_curr->offset;
 			fstate->values_length = buffer_curr->length;
-			if (fstate->values_length < arrowFieldLength(field,fstate->nitems))
+			fstate->values_minlen = arrowFieldLength(field,fstate->nitems);
+			if (!con->compressed &&
+				fstate->values_length < fstate->values_minlen)
 				elog(ERROR, "offset array is smaller than expected");
 			if ((fstate->values_offset & (MAXIMUM_ALIGNOF - 1)) != 0)
 				elog(ERROR, "offset array is not aligned well");
@@ -1601,6 +2321,7 @@ setupRecordBatchField(setupRecordBatchContext *con,
 		case ArrowNodeTag__Utf8:
 		case ArrowNodeTag__Binary:
 			/* variable length values */
+			fstate->extra_offsets = true;
 			if (con->buffer_curr + 3 > con->buffer_tail)
 				elog(ERROR, "RecordBatch has less buffers than expected");
 			buffer_curr = con->buffer_curr++;
@@ -1608,7 +2329,8 @@ setupRecordBatchField(setupRecordBatchContext *con,
 			{
 				fstate->nullmap_offset = buffer_curr->offset;
 				fstate->nullmap_length = buffer_curr->length;
-				if (fstate->nullmap_length < BITMAPLEN(fstate->nitems))
+				if (!con->compressed &&
+					fstate->nullmap_length < BITMAPLEN(fstate->nitems))
 					elog(ERROR, "nullmap length is smaller than expected");
 				if ((fstate->nullmap_offset & (MAXIMUM_ALIGNOF - 1)) != 0)
 					elog(ERROR, "nullmap is not aligned well");
@@ -1617,7 +2339,9 @@ setupRecordBatchField(setupRecordBatchContext *con,
 			buffer_curr = con->buffer_curr++;
 			fstate->values_offset = buffer_curr->offset;
 			fstate->values_length = buffer_curr->length;
-			if (fstate->values_length < arrowFieldLength(field,fstate->nitems))
+			fstate->values_minlen = arrowFieldLength(field,fstate->nitems);
+			if (!con->compressed &&
+				fstate->values_length < fstate->values_minlen)
 				elog(ERROR, "offset array is smaller than expected");
 			if ((fstate->values_offset & (MAXIMUM_ALIGNOF - 1)) != 0)
 				elog(ERROR, "offset array is not aligned well (%lu %lu)", fstate->values_offset, fstate->values_length);
@@ -1640,7 +2364,8 @@ setupRecordBatchField(setupRecordBatchContext *con,
 			{
 				fstate->nullmap_offset = buffer_curr->offset;
 				fstate->nullmap_length = buffer_curr->length;
-				if (fstate->nullmap_length < BITMAPLEN(fstate->nitems))
+				if (!con->compressed &&
+					fstate->nullmap_length < BITMAPLEN(fstate->nitems))
 					elog(ERROR, "nullmap length is smaller than expected");
 				if ((fstate->nullmap_offset & (MAXIMUM_ALIGNOF - 1)) != 0)
 					elog(ERROR, "nullmap is not aligned well");
@@ -1670,33 +2395,50 @@ setupRecordBatchField(setupRecordBatchContext *con,
 }
 
 static RecordBatchState *
-makeRecordBatchState(ArrowSchema *schema,
+makeRecordBatchState(ArrowFileInfo *af_info,
 					 ArrowBlock *block,
 					 ArrowRecordBatch *rbatch)
 {
+	ArrowSchema *schema = &af_info->footer.schema;
 	setupRecordBatchContext con;
 	RecordBatchState *result;
 	int			j, ncols = schema->_num_fields;
 
 	/*
-	 * Right now, we have no support for compressed RecordBatches
+	 * Compressed RecordBatches are decompressed per buffer on loading
 	 */
 	if (rbatch->compression)
-		ereport(ERROR,
-				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
-				 errmsg("arrow_fdw: compressed record-batches are not supported")));
-	
+	{
+		ArrowBodyCompression *comp = rbatch->compression;
+
+		if (comp->method != ArrowBodyCompressionMethod__BUFFER)
+			ereport(ERROR,
+					(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+					 errmsg("arrow_fdw: unknown body compression method (%d)",
+							(int)comp->method)));
+		if (comp->codec != ArrowCompressionType__LZ4_FRAME &&
+			comp->codec != ArrowCompressionType__ZSTD)
+			ereport(ERROR,
+					(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+					 errmsg("arrow_fdw: unknown compression codec (%d)",
+							(int)comp->codec)));
+	}
 	result = palloc0(offsetof(RecordBatchState, columns[ncols]));
 	result->ncols = ncols;
 	result->rb_offset = block->offset + block->metaDataLength;
 	result->rb_length = block->bodyLength;
 	result->rb_nitems = rbatch->length;
+	result->rb_compression = (rbatch->compression
+							  ? (int)rbatch->compression->codec : -1);
 
 	memset(&con, 0, sizeof(setupRecordBatchContext));
 	con.buffer_curr = rbatch->buffers;
 	con.buffer_tail = rbatch->buffers + rbatch->_num_buffers;
 	con.fnode_curr  = rbatch->nodes;
 	con.fnode_tail  = rbatch->nodes + rbatch->_num_nodes;
+	con.compressed  = (rbatch->compression != NULL);
+	con.rb_offset   = result->rb_offset;
+	con.af_info     = af_info;
 
 	for (j=0; j < ncols; j++)
 	{
@@ -1712,6 +2454,113 @@ makeRecordBatchState(ArrowSchema *schema,
 	return result;
 }
 
+/*
+ * arrowFdwSortRecordBatches
+ *
+ * In parallel scan, every worker fetches the next RecordBatch from the
+ * shared counter in the order of af_state->rbatches[]. If a large one
+ * is picked up at the tail of the scan, other workers have nothing to
+ * do until its completion. So, we sort RecordBatches by the length to
+ * be loaded (only referenced columns) in descending order, then smaller
+ * ones fill up the idle workers at the end of the scan.
+ * All the processes must have identical order, so ties are resolved by
+ * the original position.
+ */
+typedef struct
+{
+	RecordBatchState *rb_state;
+	size_t		load_sz;
+	uint32		ordinal;
+} arrowRecordBatchOrder;
+
+static int
+__arrowFdwSortRecordBatchesComp(const void *__a, const void *__b)
+{
+	const arrowRecordBatchOrder *a = __a;
+	const arrowRecordBatchOrder *b = __b;
+
+	if (a->load_sz > b->load_sz)
+		return -1;
+	if (a->load_sz < b->load_sz)
+		return 1;
+	return (a->ordinal < b->ordinal ? -1 : 1);
+}
+
+static void
+arrowFdwSortRecordBatches(ArrowFdwState *af_state)
+{
+	arrowRecordBatchOrder *rb_order;
+	uint32		i, nitems = af_state->num_rbatches;
+	int			j, k;
+
+	rb_order = palloc(sizeof(arrowRecordBatchOrder) * nitems);
+	for (i=0; i < nitems; i++)
+	{
+		RecordBatchState *rb_state = af_state->rbatches[i];
+		size_t		load_sz = 0;
+
+		for (k = bms_next_member(af_state->referenced, -1);
+			 k >= 0;
+			 k = bms_next_member(af_state->referenced, k))
+		{
+			j = k + FirstLowInvalidHeapAttributeNumber - 1;
+			if (j < 0 || j >= rb_state->ncols)
+				continue;
+			load_sz += RecordBatchFieldLength(&rb_state->columns[j]);
+		}
+		rb_order[i].rb_state = rb_state;
+		rb_order[i].load_sz  = load_sz;
+		rb_order[i].ordinal  = i;
+	}
+	qsort(rb_order, nitems, sizeof(arrowRecordBatchOrder),
+		  __arrowFdwSortRecordBatchesComp);
+	for (i=0; i < nitems; i++)
+		af_state->rbatches[i] = rb_order[i].rb_state;
+	pfree(rb_order);
+}
+
+/*
+ * arrowConsumerLookup / arrowConsumerAdvance
+ */
+static int
+arrowConsumerLookup(arrowConsumerKey *key)
+{
+	arrowConsumerEntry *entry;
+
+	if (!arrow_consumer_htab)
+		return 0;
+	entry = hash_search(arrow_consumer_htab, key, HASH_FIND, NULL);
+
+	return (entry ? entry->num_consumed : 0);
+}
+
+static void
+arrowConsumerAdvance(List *consumer_marks)
+{
+	ListCell   *lc;
+
+	if (!arrow_consumer_htab)
+	{
+		HASHCTL		hctl;
+
+		memset(&hctl, 0, sizeof(HASHCTL));
+		hctl.keysize = sizeof(arrowConsumerKey);
+		hctl.entrysize = sizeof(arrowConsumerEntry);
+		hctl.hcxt = TopMemoryContext;
+		arrow_consumer_htab = hash_create("Arrow_Fdw Consumers", 64, &hctl,
+										  HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+	}
+	foreach (lc, consumer_marks)
+	{
+		arrowConsumerEntry *mark = lfirst(lc);
+		arrowConsumerEntry *entry;
+
+		entry = hash_search(arrow_consumer_htab, &mark->key,
+							HASH_ENTER, NULL);
+		entry->num_consumed = mark->num_consumed;
+	}
+}
+
 /*
  * ExecInitArrowFdw
  */
@@ -1732,8 +2581,10 @@ ExecInitArrowFdw(ScanState *ss,
 	bool			whole_row_ref = false;
 	ArrowFdwState  *af_state;
 	List		   *rb_state_list = NIL;
+	List		   *consumer_marks = NIL;
 	ListCell	   *lc;
 	bool			writable;
+	bool			gpu_decompression;
 	int				i, num_rbatches;
 
 	Assert(RelationGetForm(relation)->relkind == RELKIND_FOREIGN_TABLE &&
@@ -1755,7 +2606,10 @@ ExecInitArrowFdw(ScanState *ss,
 
 	filesList = __arrowFdwExtractFilesList(ft->options,
 										   NULL,
-										   &writable);
+										   &writable,
+										   &gpu_decompression);
+	filesList = arrowFdwPruneFilesList(filesList, ft->options,
+									   tupdesc, outer_quals);
 	foreach (lc, filesList)
 	{
 		char	   *fname = strVal(lfirst(lc));
@@ -1763,6 +2617,7 @@ ExecInitArrowFdw(ScanState *ss,
 		List	   *rb_cached = NIL;
 		ListCell   *cell;
 		GPUDirectFileDesc *dfile = NULL;
+		int			num_skips;
 
 		fdesc = PathNameOpenFile(fname, O_RDONLY | PG_BINARY);
 		if (fdesc < 0)
@@ -1791,6 +2646,25 @@ ExecInitArrowFdw(ScanState *ss,
 		}
 
 		rb_cached = arrowLookupOrBuildMetadataCache(fdesc, &stat_attrs);
+		/* skip RecordBatches already consumed, if any */
+		if (arrow_fdw_consumer && *arrow_fdw_consumer != '\0' &&
+			rb_cached != NIL)
+		{
+			RecordBatchState   *rb_head = linitial(rb_cached);
+			arrowConsumerEntry *mark = palloc0(sizeof(arrowConsumerEntry));
+
+			strncpy(mark->key.name, arrow_fdw_consumer, NAMEDATALEN - 1);
+			mark->key.st_dev = rb_head->stat_buf.st_dev;
+			mark->key.st_ino = rb_head->stat_buf.st_ino;
+			mark->num_consumed = list_length(rb_cached);
+			num_skips = arrowConsumerLookup(&mark->key);
+			/* the file was truncated or compacted; read it again */
+			if (num_skips > mark->num_consumed)
+				num_skips = 0;
+			consumer_marks = lappend(consumer_marks, mark);
+		}
+		else
+			num_skips = 0;
 		/* check schema compatibility */
 		foreach (cell, rb_cached)
 		{
@@ -1799,10 +2673,12 @@ ExecInitArrowFdw(ScanState *ss,
 			if (!arrowSchemaCompatibilityCheck(tupdesc, rb_state))
 				elog(ERROR, "arrow file '%s' on behalf of foreign table '%s' has incompatible schema definition",
 					 fname, RelationGetRelationName(relation));
+			if (rb_state->rb_index < num_skips)
+				continue;
 			/* GPUDirect I/O state, if any */
 			rb_state->dfile = dfile;
+			rb_state_list = lappend(rb_state_list, rb_state);
 		}
-		rb_state_list = list_concat(rb_state_list, rb_cached);
 	}
 	num_rbatches = list_length(rb_state_list);
 	af_state = palloc0(offsetof(ArrowFdwState, rbatches[num_rbatches]));
@@ -1810,16 +2686,34 @@ ExecInitArrowFdw(ScanState *ss,
 	af_state->gpuDirectFileDescList = gpuDirectFileDescList;
 	af_state->fdescList = fdescList;
 	af_state->referenced = referenced;
+	af_state->stat_attrs = stat_attrs;
+	af_state->stats_quals = outer_quals;
 	if (arrow_fdw_stats_hint_enabled)
 		af_state->stats_hint = execInitArrowStatsHint(ss, stat_attrs,
 													  outer_quals);
 	af_state->rbatch_index = &af_state->__rbatch_index_local;
 	af_state->rbatch_nload = &af_state->__rbatch_nload_local;
 	af_state->rbatch_nskip = &af_state->__rbatch_nskip_local;
+	af_state->rbatch_comp_sz = &af_state->__rbatch_comp_sz_local;
+	af_state->rbatch_raw_sz = &af_state->__rbatch_raw_sz_local;
+	af_state->rbatch_gpu_comp_sz = &af_state->__rbatch_gpu_comp_sz_local;
+	af_state->gpu_decompression = gpu_decompression;
+	af_state->consumer_marks = consumer_marks;
 	i = 0;
 	foreach (lc, rb_state_list)
 		af_state->rbatches[i++] = (RecordBatchState *)lfirst(lc);
 	af_state->num_rbatches = num_rbatches;
+	/* larger RecordBatches first, to avoid stragglers in parallel scan */
+	if (ss->ps.plan->parallel_aware && num_rbatches > 1)
+		arrowFdwSortRecordBatches(af_state);
+	/*
+	 * synchronized scan changes the order of rows, and parallel scan
+	 * would need to share the start position with the workers.
+	 */
+	af_state->sync_scan = (arrow_sync_scan_enabled &&
+						   !pgstrom_regression_test_mode &&
+						   !ss->ps.plan->parallel_aware &&
+						   num_rbatches > 1);
 
 	return af_state;
 }
@@ -1848,6 +2742,10 @@ ArrowBeginForeignScan(ForeignScanState *node, int eflags)
 									   NULL,
 									   fscan->scan.plan.qual,
 									   referenced);
+	if (arrow_late_materialization && node->ss.ps.qual)
+		arrowFdwSetupLateMaterialization(node->fdw_state,
+										 fscan->scan.plan.qual,
+										 fscan->scan.scanrelid);
 }
 
 typedef struct
@@ -1885,19 +2783,21 @@ __setupIOvectorField(arrowFdwSetupIOContext *con,
 		con->f_offset += __length;
 	}
 	else if (f_pos > con->f_offset &&
-			 (f_pos & ~PAGE_MASK) == (con->f_offset & ~PAGE_MASK) &&
+			 ((f_pos & ~PAGE_MASK) == (con->f_offset & ~PAGE_MASK) ||
+			  f_pos - con->f_offset <= ((size_t)arrow_io_merge_gap_kb << 10)) &&
 			 ((f_pos - con->f_offset) & (MAXIMUM_ALIGNOF-1)) == 0)
 	{
 		/*
 		 * we can also consolidate the i/o of two chunks, if file position
 		 * of the next chunk (f_pos) and the current file tail position
-		 * (con->f_offset) locate within the same file page, and if gap bytes
-		 * on the file does not break alignment.
+		 * (con->f_offset) locate within the same file page, or the gap is
+		 * less than arrow_fdw.io_merge_gap, and if gap bytes on the file
+		 * does not break alignment. One larger read is usually faster
+		 * than many small reads on NVMe-SSD, even if the gap is also read.
 		 */
 		size_t	__gap = (f_pos - con->f_offset);
 
 		/* put gap bytes */
-		Assert(__gap < PAGE_SIZE);
 		con->m_offset += __gap;
 		con->f_offset += __gap;
 
@@ -2001,6 +2901,79 @@ arrowFdwSetupIOvectorField(arrowFdwSetupIOContext *con,
 	}
 }
 
+/*
+ * __splitIOchunkByStripe - split an i/o chunk on the stripe boundary of
+ *                          the striped device, and returns number of the
+ *                          chunks. @dst can be NULL to count them only.
+ */
+static int
+__splitIOchunkByStripe(strom_io_chunk *dst, const strom_io_chunk *src,
+					   cl_uint stripe_pages)
+{
+	unsigned long m_offset = src->m_offset;
+	cl_uint		fchunk_id = src->fchunk_id;
+	cl_uint		nr_pages = src->nr_pages;
+	int			count = 0;
+
+	do {
+		cl_uint		n = nr_pages;
+
+		if (stripe_pages > 0)
+			n = Min(n, stripe_pages - fchunk_id % stripe_pages);
+		if (dst)
+		{
+			dst[count].m_offset  = m_offset;
+			dst[count].fchunk_id = fchunk_id;
+			dst[count].nr_pages  = n;
+		}
+		count++;
+		m_offset  += (unsigned long)n * PAGE_SIZE;
+		fchunk_id += n;
+		nr_pages  -= n;
+	} while (nr_pages > 0);
+
+	return count;
+}
+
+/*
+ * __arrowFdwBuildIOvector - closes the last i/o chunk, then build
+ *                           strom_io_vector according to the context
+ *
+ * If the source file is on the striped device, i/o chunks are split on the
+ * stripe boundary, to keep P2P DMA requests within a particular drive.
+ */
+static strom_io_vector *
+__arrowFdwBuildIOvector(arrowFdwSetupIOContext *con, kern_data_store *kds,
+						cl_uint stripe_pages)
+{
+	strom_io_vector *iovec;
+	int			nr_chunks = 0;
+	int			nr_splits = 0;
+	int			i;
+
+	if (con->io_index >= 0)
+	{
+		/* close the last I/O chunks */
+		strom_io_chunk *ioc = &con->ioc[con->io_index];
+
+		ioc->nr_pages = (TYPEALIGN(PAGE_SIZE, con->f_offset) / PAGE_SIZE -
+						 ioc->fchunk_id);
+		con->m_offset = ioc->m_offset + PAGE_SIZE * ioc->nr_pages;
+		nr_chunks = con->io_index + 1;
+	}
+	kds->length = con->m_offset;
+
+	for (i=0; i < nr_chunks; i++)
+		nr_splits += __splitIOchunkByStripe(NULL, &con->ioc[i], stripe_pages);
+	iovec = palloc0(offsetof(strom_io_vector, ioc[nr_splits]));
+	iovec->nr_chunks = nr_splits;
+	for (i=0, nr_splits=0; i < nr_chunks; i++)
+		nr_splits += __splitIOchunkByStripe(&iovec->ioc[nr_splits],
+											&con->ioc[i], stripe_pages);
+	Assert(iovec->nr_chunks == nr_splits);
+	return iovec;
+}
+
 /*
  * arrowFdwSetupIOvector
  */
@@ -2010,8 +2983,8 @@ arrowFdwSetupIOvector(kern_data_store *kds,
 					  Bitmapset *referenced)
 {
 	arrowFdwSetupIOContext *con;
-	strom_io_vector *iovec = NULL;
-	int			j, nr_chunks = 0;
+	size_t		stripe_sz;
+	int			j;
 
 	Assert(kds->nr_colmeta >= kds->ncols);
 	con = alloca(offsetof(arrowFdwSetupIOContext,
@@ -2031,23 +3004,8 @@ arrowFdwSetupIOvector(kern_data_store *kds,
 		else
 			cmeta->atttypkind = TYPE_KIND__NULL;	/* unreferenced */
 	}
-	if (con->io_index >= 0)
-	{
-		/* close the last I/O chunks */
-		strom_io_chunk *ioc = &con->ioc[con->io_index];
-
-		ioc->nr_pages = (TYPEALIGN(PAGE_SIZE, con->f_offset) / PAGE_SIZE -
-						 ioc->fchunk_id);
-		con->m_offset = ioc->m_offset + PAGE_SIZE * ioc->nr_pages;
-		nr_chunks = con->io_index + 1;
-	}
-	kds->length = con->m_offset;
-
-	iovec = palloc0(offsetof(strom_io_vector, ioc[nr_chunks]));
-	iovec->nr_chunks = nr_chunks;
-	if (nr_chunks > 0)
-		memcpy(iovec->ioc, con->ioc, sizeof(strom_io_chunk) * nr_chunks);
-	return iovec;
+	stripe_sz = GetStripeSizeOfDevice(rb_state->stat_buf.st_dev);
+	return __arrowFdwBuildIOvector(con, kds, stripe_sz / PAGE_SIZE);
 }
 
 /*
@@ -2131,103 +3089,836 @@ __arrowFdwAssignTypeOptions(kern_data_store *kds,
 	}
 }
 
-static pgstrom_data_store *
-__arrowFdwLoadRecordBatch(RecordBatchState *rb_state,
-						  Relation relation,
-						  Bitmapset *referenced,
-						  GpuContext *gcontext,
-						  MemoryContext mcontext,
-						  const Bitmapset *optimal_gpus)
+/*
+ * Routines to load compressed RecordBatches
+ *
+ * When RecordBatch has BodyCompression, each buffer begins with a 64bit
+ * little-endian integer that is the uncompressed length, then compressed
+ * bytes follow. The length -1 means the buffer is not compressed actually.
+ * Usually, these are decompressed on the host side at the load time.
+ * If 'gpu_decompression' option is enabled on LZ4_FRAME compressed files,
+ * the compressed images are loaded onto the device as is (by P2P DMA if
+ * available), then decompressed by the kern_arrow_decompress kernel.
+ */
+typedef struct
 {
-	TupleDesc			tupdesc = RelationGetDescr(relation);
-	pgstrom_data_store *pds;
-	kern_data_store	   *kds;
-	strom_io_vector	   *iovec;
-	size_t				head_sz;
-	CUresult			rc;
+	off_t		f_pos;			/* file position of the (compressed) body */
+	size_t		c_length;		/* length of the (compressed) body */
+	int64		rawsize;		/* uncompressed length, or -1 */
+	size_t		m_offset;		/* destination offset from the KDS head */
+	/* validation of the offsets array, if any */
+	cl_uint		offsets_nitems;	/* offsets[nitems] is the last offset */
+	cl_ulong	offsets_limit;	/* upper limit of the last offset, or
+								 * ULONG_MAX if not an offsets array */
+} arrowFdwDecompressChunk;
 
-	/* setup KDS and I/O-vector */
-	head_sz = KDS_calculateHeadSize(tupdesc);
-	kds = alloca(head_sz);
-	init_kernel_data_store(kds, tupdesc, 0, KDS_FORMAT_ARROW, 0);
-	kds->nitems = rb_state->rb_nitems;
-	kds->nrooms = rb_state->rb_nitems;
-	kds->table_oid = RelationGetRelid(relation);
-	Assert(head_sz == KERN_DATA_STORE_HEAD_LENGTH(kds));
-	Assert(kds->ncols == rb_state->ncols);
-	__arrowFdwAssignTypeOptions(kds, 0, kds->ncols, rb_state->columns);
-	iovec = arrowFdwSetupIOvector(kds, rb_state, referenced);
-	__dump_kds_and_iovec(kds, iovec);
+typedef struct
+{
+	int			fdesc;
+	const char *fname;
+	off_t		rb_offset;
+	size_t		m_offset;
+	size_t		comp_sz;		/* total length of the compressed buffers */
+	size_t		raw_sz;			/* total length of the decompressed buffers */
+	int			nchunks;
+	arrowFdwDecompressChunk chunks[FLEXIBLE_ARRAY_MEMBER];
+} arrowFdwDecompressContext;
 
-	/*
-	 * If SSD-to-GPU Direct SQL is available on the arrow file, setup a small
-	 * PDS on host-pinned memory, with strom_io_vector.
-	 */
-	if (gcontext &&
-		bms_is_member(gcontext->cuda_dindex, optimal_gpus) &&
-		iovec->nr_chunks > 0 &&
-		kds->length <= gpuMemAllocIOMapMaxLength() &&
-		rb_state->dfile != NULL)
-	{
-		size_t	iovec_sz = offsetof(strom_io_vector, ioc[iovec->nr_chunks]);
+/*
+ * __setupDecompressChunk
+ *
+ * It checks the uncompressed length of the buffer, as the buffer length of
+ * uncompressed RecordBatch is checked by the metadata, because it is used
+ * as the length of the decompressed buffer referenced by the readers.
+ * Arrow format allows padding of the buffers up to 64 bytes, but no more.
+ */
+static arrowFdwDecompressChunk *
+__setupDecompressChunk(arrowFdwDecompressContext *con,
+					   off_t buffer_offset,
+					   size_t buffer_length,
+					   size_t min_length,
+					   size_t max_length,
+					   cl_uint *p_cmeta_offset,
+					   cl_uint *p_cmeta_length)
+{
+	arrowFdwDecompressChunk *chunk = &con->chunks[con->nchunks++];
+	off_t		f_pos = con->rb_offset + buffer_offset;
+	int64		rawsize;
+	ssize_t		nbytes;
+
+	if (buffer_length < sizeof(int64))
+		elog(ERROR, "arrow_fdw: compressed buffer at %lu of '%s' is too short",
+			 f_pos, con->fname);
+	nbytes = __preadFile(con->fdesc, &rawsize, sizeof(int64), f_pos);
+	if (nbytes != sizeof(int64))
+		elog(ERROR, "failed on pread('%s'): %m", con->fname);
+	chunk->f_pos    = f_pos + sizeof(int64);
+	chunk->c_length = buffer_length - sizeof(int64);
+	chunk->rawsize  = rawsize;
+	chunk->offsets_nitems = 0;
+	chunk->offsets_limit  = ULONG_MAX;
+	if (rawsize < 0)
+	{
+		if (rawsize != -1)
+			elog(ERROR, "arrow_fdw: compressed buffer at %lu of '%s' has corrupted length (%ld)",
+				 f_pos, con->fname, rawsize);
+		rawsize = chunk->c_length;
+		if ((size_t)rawsize < min_length)
+			elog(ERROR, "arrow_fdw: buffer at %lu of '%s' is smaller than expected (%ld, but %zu required)",
+				 f_pos, con->fname, rawsize, min_length);
+	}
+	else if ((size_t)rawsize < min_length || (size_t)rawsize > max_length)
+		elog(ERROR, "arrow_fdw: compressed buffer at %lu of '%s' has unexpected uncompressed length (%ld, but %zu..%zu expected)",
+			 f_pos, con->fname, rawsize, min_length, max_length);
+	if (con->m_offset + MAXALIGN(rawsize) > (0xffffffffUL << MAXIMUM_ALIGNOF_SHIFT))
+		elog(ERROR, "arrow_fdw: decompressed RecordBatch of '%s' is too large",
+			 con->fname);
+	chunk->m_offset = con->m_offset;
+
+	*p_cmeta_offset = __kds_packed(con->m_offset);
+	*p_cmeta_length = __kds_packed(MAXALIGN(rawsize));
+	con->m_offset += MAXALIGN(rawsize);
+	con->comp_sz  += buffer_length;
+	con->raw_sz   += rawsize;
+
+	return chunk;
+}
 
-		rc = gpuMemAllocHost(gcontext, (void **)&pds,
-							 offsetof(pgstrom_data_store, kds) +
-							 head_sz + iovec_sz);
-		if (rc != CUDA_SUCCESS)
-			elog(ERROR, "failed on gpuMemAllocHost: %s", errorText(rc));
+static void
+setupDecompressChunkField(arrowFdwDecompressContext *con,
+						  RecordBatchFieldState *fstate,
+						  kern_data_store *kds,
+						  kern_colmeta *cmeta)
+{
+	arrowFdwDecompressChunk *offsets = NULL;
 
-		pds->gcontext = gcontext;
-		pg_atomic_init_u32(&pds->refcnt, 1);
-		pds->nblocks_uncached = 0;
-		memcpy(&pds->filedesc, rb_state->dfile, sizeof(GPUDirectFileDesc));
-		pds->iovec = (strom_io_vector *)((char *)&pds->kds + head_sz);
-		memcpy(&pds->kds, kds, head_sz);
-		memcpy(pds->iovec, iovec, iovec_sz);
-	}
-	else
+	if (fstate->nullmap_length > 0)
+		__setupDecompressChunk(con,
+							   fstate->nullmap_offset,
+							   fstate->nullmap_length,
+							   BITMAPLEN(fstate->nitems),
+							   ARROWALIGN(BITMAPLEN(fstate->nitems)),
+							   &cmeta->nullmap_offset,
+							   &cmeta->nullmap_length);
+	if (fstate->values_length > 0)
 	{
-		/* Elsewhere, load RecordBatch by filesystem */
-		int		fdesc = FileGetRawDesc(rb_state->fdesc);
-
-		if (gcontext)
+		arrowFdwDecompressChunk *chunk
+			= __setupDecompressChunk(con,
+									 fstate->values_offset,
+									 fstate->values_length,
+									 fstate->values_minlen,
+									 ARROWALIGN(fstate->values_minlen),
+									 &cmeta->values_offset,
+									 &cmeta->values_length);
+		/*
+		 * The last item of the offsets array must not point out of the
+		 * extra buffer (Utf8/Binary), or the items of the sub-field (List).
+		 */
+		if (cmeta->atttypkind == TYPE_KIND__ARRAY)
 		{
-			rc = gpuMemAllocManaged(gcontext,
-									(CUdeviceptr *)&pds,
-									offsetof(pgstrom_data_store,
-											 kds) + kds->length,
-									CU_MEM_ATTACH_GLOBAL);
-			if (rc != CUDA_SUCCESS)
-				elog(ERROR, "failed on gpuMemAllocManaged: %s", errorText(rc));
+			Assert(fstate->num_children == 1);
+			chunk->offsets_nitems = fstate->nitems;
+			chunk->offsets_limit  = fstate->children[0].nitems;
 		}
-		else
+		else if (fstate->extra_offsets)
 		{
-			pds = MemoryContextAllocHuge(mcontext,
-										 offsetof(pgstrom_data_store,
-												  kds) + kds->length);
+			chunk->offsets_nitems = fstate->nitems;
+			chunk->offsets_limit  = 0;	/* no extra buffer, if empty */
+			offsets = chunk;
+		}
+	}
+	else if (fstate->values_minlen > 0)
+		elog(ERROR, "arrow_fdw: values buffer of '%s' is missing", con->fname);
+	if (fstate->extra_length > 0)
+	{
+		arrowFdwDecompressChunk *chunk
+			= __setupDecompressChunk(con,
+									 fstate->extra_offset,
+									 fstate->extra_length,
+									 0, UINT_MAX,
+									 &cmeta->extra_offset,
+									 &cmeta->extra_length);
+		if (offsets)
+			offsets->offsets_limit = (chunk->rawsize < 0
+									  ? chunk->c_length
+									  : chunk->rawsize);
+	}
+	/* nested sub-fields if composite types */
+	if (cmeta->atttypkind == TYPE_KIND__ARRAY ||
+		cmeta->atttypkind == TYPE_KIND__COMPOSITE)
+	{
+		kern_colmeta *subattr;
+		int		j;
+
+		Assert(fstate->num_children == cmeta->num_subattrs);
+		for (j=0, subattr = &kds->colmeta[cmeta->idx_subattrs];
+			 j < cmeta->num_subattrs;
+			 j++, subattr++)
+		{
+			setupDecompressChunkField(con, &fstate->children[j],
+									  kds, subattr);
 		}
-		__PDS_fillup_arrow(pds, gcontext, kds, fdesc, iovec);
 	}
-	pfree(iovec);
-	return pds;
 }
 
-static pgstrom_data_store *
-arrowFdwLoadRecordBatch(ArrowFdwState *af_state,
-						Relation relation,
-						EState *estate,
-						GpuContext *gcontext,
-						const Bitmapset *optimal_gpus)
+static void
+__arrowDecompressBuffer(int codec,
+						char *dst_buf, size_t dst_len,
+						const char *src_buf, size_t src_len,
+						const char *fname)
+{
+	switch (codec)
+	{
+#ifdef USE_LZ4
+		case ArrowCompressionType__LZ4_FRAME:
+			{
+				LZ4F_dctx  *dctx;
+				LZ4F_errorCode_t rc;
+				size_t		dst_pos = 0;
+				size_t		src_pos = 0;
+
+				rc = LZ4F_createDecompressionContext(&dctx, LZ4F_VERSION);
+				if (LZ4F_isError(rc))
+					elog(ERROR, "failed on LZ4F_createDecompressionContext: %s",
+						 LZ4F_getErrorName(rc));
+				while (src_pos < src_len)
+				{
+					size_t	dst_sz = dst_len - dst_pos;
+					size_t	src_sz = src_len - src_pos;
+
+					rc = LZ4F_decompress(dctx,
+										 dst_buf + dst_pos, &dst_sz,
+										 src_buf + src_pos, &src_sz,
+										 NULL);
+					if (LZ4F_isError(rc))
+					{
+						LZ4F_freeDecompressionContext(dctx);
+						elog(ERROR, "arrow_fdw: failed on LZ4F_decompress of '%s': %s",
+							 fname, LZ4F_getErrorName(rc));
+					}
+					dst_pos += dst_sz;
+					src_pos += src_sz;
+					if (rc == 0 || (dst_sz == 0 && src_sz == 0))
+						break;
+				}
+				LZ4F_freeDecompressionContext(dctx);
+				if (dst_pos != dst_len)
+					elog(ERROR, "arrow_fdw: LZ4 buffer of '%s' is decompressed to %zu bytes, but %zu bytes are expected",
+						 fname, dst_pos, dst_len);
+			}
+			break;
+#endif	/* USE_LZ4 */
+#ifdef USE_ZSTD
+		case ArrowCompressionType__ZSTD:
+			{
+				size_t		rv;
+
+				rv = ZSTD_decompress(dst_buf, dst_len, src_buf, src_len);
+				if (ZSTD_isError(rv))
+					elog(ERROR, "arrow_fdw: failed on ZSTD_decompress of '%s': %s",
+						 fname, ZSTD_getErrorName(rv));
+				if (rv != dst_len)
+					elog(ERROR, "arrow_fdw: ZSTD buffer of '%s' is decompressed to %zu bytes, but %zu bytes are expected",
+						 fname, rv, dst_len);
+			}
+			break;
+#endif	/* USE_ZSTD */
+		default:
+			ereport(ERROR,
+					(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+					 errmsg("arrow_fdw: %s compressed record-batch is not supported in this build",
+							codec == ArrowCompressionType__LZ4_FRAME ? "LZ4_FRAME" :
+							codec == ArrowCompressionType__ZSTD ? "ZSTD" : "unknown")));
+	}
+}
+
+/*
+ * arrowFdwSetupDecompressContext
+ *
+ * It assigns the destination buffers of the referenced columns from
+ * @m_offset, according to the uncompressed length of the buffers.
+ */
+static arrowFdwDecompressContext *
+arrowFdwSetupDecompressContext(RecordBatchState *rb_state,
+							   kern_data_store *kds_head,
+							   Bitmapset *referenced,
+							   size_t m_offset)
+{
+	arrowFdwDecompressContext *con;
+	int			j;
+
+	con = palloc(offsetof(arrowFdwDecompressContext,
+						  chunks[3 * kds_head->nr_colmeta]));
+	con->fdesc     = FileGetRawDesc(rb_state->fdesc);
+	con->fname     = FilePathName(rb_state->fdesc);
+	con->rb_offset = rb_state->rb_offset;
+	con->m_offset  = MAXALIGN(m_offset);
+	con->comp_sz   = 0;
+	con->raw_sz    = 0;
+	con->nchunks   = 0;
+	for (j=0; j < kds_head->ncols; j++)
+	{
+		RecordBatchFieldState *fstate = &rb_state->columns[j];
+		kern_colmeta *cmeta = &kds_head->colmeta[j];
+		int			attidx = j + 1 - FirstLowInvalidHeapAttributeNumber;
+
+		if (referenced && bms_is_member(attidx, referenced))
+			setupDecompressChunkField(con, fstate, kds_head, cmeta);
+		else
+			cmeta->atttypkind = TYPE_KIND__NULL;	/* unreferenced */
+	}
+	return con;
+}
+
+static pgstrom_data_store *
+__arrowFdwLoadCompressedRecordBatch(RecordBatchState *rb_state,
+									kern_data_store *kds_head,
+									Bitmapset *referenced,
+									GpuContext *gcontext,
+									MemoryContext mcontext,
+									size_t *p_comp_sz,
+									size_t *p_raw_sz)
+{
+	arrowFdwDecompressContext *con;
+	pgstrom_data_store *pds;
+	size_t		head_sz = KERN_DATA_STORE_HEAD_LENGTH(kds_head);
+	char	   *cbuf = NULL;
+	size_t		cbuf_sz = 0;
+	int			i;
+	CUresult	rc;
+
+	con = arrowFdwSetupDecompressContext(rb_state,
+										 kds_head,
+										 referenced,
+										 head_sz);
+	kds_head->length = con->m_offset;
+
+	/* allocation of the destination buffer */
+	if (gcontext)
+	{
+		rc = gpuMemAllocManaged(gcontext,
+								(CUdeviceptr *)&pds,
+								offsetof(pgstrom_data_store,
+										 kds) + kds_head->length,
+								CU_MEM_ATTACH_GLOBAL);
+		if (rc != CUDA_SUCCESS)
+			elog(ERROR, "failed on gpuMemAllocManaged: %s", errorText(rc));
+	}
+	else
+	{
+		pds = MemoryContextAllocHuge(mcontext,
+									 offsetof(pgstrom_data_store,
+											  kds) + kds_head->length);
+	}
+	memset(pds, 0, offsetof(pgstrom_data_store, kds));
+	pds->gcontext = gcontext;
+	pg_atomic_init_u32(&pds->refcnt, 1);
+	pds->nblocks_uncached = 0;
+	pds->filedesc.rawfd = -1;
+	pds->iovec = NULL;
+	pds->gpu_decompress = false;
+	memcpy(&pds->kds, kds_head, head_sz);
+
+	/* read and decompress buffers */
+	for (i=0; i < con->nchunks; i++)
+	{
+		arrowFdwDecompressChunk *chunk = &con->chunks[i];
+		char	   *dest = (char *)&pds->kds + chunk->m_offset;
+		ssize_t		nbytes;
+
+		CHECK_FOR_INTERRUPTS();
+		if (chunk->rawsize < 0)
+		{
+			/* not compressed actually */
+			nbytes = __preadFile(con->fdesc, dest,
+								 chunk->c_length, chunk->f_pos);
+			if (nbytes != chunk->c_length)
+				elog(ERROR, "failed on pread('%s'): %m", con->fname);
+		}
+		else
+		{
+			if (chunk->c_length > cbuf_sz)
+			{
+				cbuf_sz = TYPEALIGN(BLCKSZ, chunk->c_length);
+				if (cbuf)
+					pfree(cbuf);
+				cbuf = MemoryContextAllocHuge(CurrentMemoryContext, cbuf_sz);
+			}
+			nbytes = __preadFile(con->fdesc, cbuf,
+								 chunk->c_length, chunk->f_pos);
+			if (nbytes != chunk->c_length)
+				elog(ERROR, "failed on pread('%s'): %m", con->fname);
+			__arrowDecompressBuffer(rb_state->rb_compression,
+									dest, chunk->rawsize,
+									cbuf, chunk->c_length,
+									con->fname);
+		}
+		/* the last offset must be in the range, if offsets array */
+		if (chunk->offsets_limit != ULONG_MAX &&
+			((cl_uint *)dest)[chunk->offsets_nitems] > chunk->offsets_limit)
+			elog(ERROR, "arrow_fdw: offsets array of '%s' points out of the range (%u, but %lu at most)",
+				 con->fname,
+				 ((cl_uint *)dest)[chunk->offsets_nitems],
+				 chunk->offsets_limit);
+	}
+	if (cbuf)
+		pfree(cbuf);
+	*p_comp_sz = con->comp_sz;
+	*p_raw_sz  = con->raw_sz;
+	pfree(con);
+
+	return pds;
+}
+
+/*
+ * __arrowFdwLoadCompressedRecordBatchGpu
+ *
+ * It loads the compressed images of the buffers as is, then the device
+ * decompresses them prior to the main kernel; see PDS_decompress_arrow().
+ * KDS shall have the layout below:
+ *
+ *   [KDS header][kern_arrow_decomp][decompressed buffers][compressed images]
+ *
+ * Only the compressed images are transferred over the PCIe bus.
+ */
+static pgstrom_data_store *
+__arrowFdwLoadCompressedRecordBatchGpu(RecordBatchState *rb_state,
+									   kern_data_store *kds_head,
+									   Bitmapset *referenced,
+									   GpuContext *gcontext,
+									   const Bitmapset *optimal_gpus,
+									   size_t *p_comp_sz,
+									   size_t *p_raw_sz)
+{
+	arrowFdwDecompressContext *con;
+	arrowFdwSetupIOContext *io_con;
+	kern_arrow_decomp *kdecomp;
+	strom_io_vector	*iovec;
+	pgstrom_data_store *pds;
+	size_t		head_sz = KERN_DATA_STORE_HEAD_LENGTH(kds_head);
+	size_t		kdecomp_sz;
+	size_t		stripe_sz;
+	int			i;
+	CUresult	rc;
+
+	kdecomp_sz = KERN_ARROW_DECOMP_LENGTH(3 * kds_head->nr_colmeta);
+	con = arrowFdwSetupDecompressContext(rb_state,
+										 kds_head,
+										 referenced,
+										 head_sz + kdecomp_sz);
+	/* compressed images are put next to the destination buffers */
+	kdecomp = palloc0(kdecomp_sz);
+	kdecomp->nitems = con->nchunks;
+	io_con = palloc(offsetof(arrowFdwSetupIOContext, ioc[con->nchunks]));
+	io_con->rb_offset = 0;
+	io_con->f_offset  = ~0UL;	/* invalid offset */
+	io_con->m_offset  = TYPEALIGN(PAGE_SIZE, con->m_offset);
+	io_con->io_index  = -1;
+	io_con->depth     = 0;
+	for (i=0; i < con->nchunks; i++)
+	{
+		arrowFdwDecompressChunk *chunk = &con->chunks[i];
+		kern_arrow_decomp_chunk *kchunk = &kdecomp->chunks[i];
+		cl_uint		__offset;
+		cl_uint		__length;
+
+		/* buffer shall be loaded with its uncompressed length prefix */
+		__setupIOvectorField(io_con,
+							 chunk->f_pos - sizeof(int64),
+							 chunk->c_length + sizeof(int64),
+							 &__offset,
+							 &__length);
+		kchunk->src_offset = __kds_unpack(__offset) + sizeof(int64);
+		kchunk->src_length = chunk->c_length;
+		kchunk->dst_offset = chunk->m_offset;
+		kchunk->offsets_limit  = chunk->offsets_limit;
+		kchunk->offsets_nitems = chunk->offsets_nitems;
+		if (chunk->rawsize < 0)
+		{
+			kchunk->dst_length = chunk->c_length;
+			kchunk->codec = KERN_ARROW_DECOMP__RAW;
+		}
+		else
+		{
+			kchunk->dst_length = chunk->rawsize;
+			kchunk->codec = KERN_ARROW_DECOMP__LZ4_FRAME;
+		}
+	}
+	stripe_sz = GetStripeSizeOfDevice(rb_state->stat_buf.st_dev);
+	iovec = __arrowFdwBuildIOvector(io_con, kds_head, stripe_sz / PAGE_SIZE);
+	__dump_kds_and_iovec(kds_head, iovec);
+
+	if (bms_is_member(gcontext->cuda_dindex, optimal_gpus) &&
+		iovec->nr_chunks > 0 &&
+		kds_head->length <= gpuMemAllocIOMapMaxLength() &&
+		rb_state->dfile != NULL)
+	{
+		size_t	iovec_sz = offsetof(strom_io_vector, ioc[iovec->nr_chunks]);
+
+		rc = gpuMemAllocHost(gcontext, (void **)&pds,
+							 offsetof(pgstrom_data_store, kds) +
+							 head_sz + kdecomp_sz + iovec_sz);
+		if (rc != CUDA_SUCCESS)
+			elog(ERROR, "failed on gpuMemAllocHost: %s", errorText(rc));
+
+		memset(pds, 0, offsetof(pgstrom_data_store, kds));
+		pds->gcontext = gcontext;
+		pg_atomic_init_u32(&pds->refcnt, 1);
+		pds->nblocks_uncached = 0;
+		memcpy(&pds->filedesc, rb_state->dfile, sizeof(GPUDirectFileDesc));
+		pds->iovec = (strom_io_vector *)((char *)&pds->kds +
+										 head_sz + kdecomp_sz);
+		memcpy(&pds->kds, kds_head, head_sz);
+		memcpy(pds->iovec, iovec, iovec_sz);
+	}
+	else
+	{
+		/* Elsewhere, load the compressed images by filesystem */
+		rc = gpuMemAllocManaged(gcontext,
+								(CUdeviceptr *)&pds,
+								offsetof(pgstrom_data_store,
+										 kds) + kds_head->length,
+								CU_MEM_ATTACH_GLOBAL);
+		if (rc != CUDA_SUCCESS)
+			elog(ERROR, "failed on gpuMemAllocManaged: %s", errorText(rc));
+		__PDS_fillup_arrow(pds, gcontext, kds_head,
+						   FileGetRawDesc(rb_state->fdesc), iovec);
+	}
+	memcpy(KERN_DATA_STORE_ARROW_DECOMP(&pds->kds), kdecomp, kdecomp_sz);
+	pds->gpu_decompress = true;
+
+	*p_comp_sz = con->comp_sz;
+	*p_raw_sz  = con->raw_sz;
+	pfree(iovec);
+	pfree(io_con);
+	pfree(kdecomp);
+	pfree(con);
+
+	return pds;
+}
+
+static pgstrom_data_store *
+__arrowFdwLoadRecordBatch(RecordBatchState *rb_state,
+						  Relation relation,
+						  Bitmapset *referenced,
+						  GpuContext *gcontext,
+						  MemoryContext mcontext,
+						  const Bitmapset *optimal_gpus,
+						  bool gpu_decompression,
+						  size_t *p_comp_sz,
+						  size_t *p_raw_sz)
+{
+	TupleDesc			tupdesc = RelationGetDescr(relation);
+	pgstrom_data_store *pds;
+	kern_data_store	   *kds;
+	strom_io_vector	   *iovec;
+	size_t				head_sz;
+	CUresult			rc;
+
+	/* setup KDS and I/O-vector */
+	head_sz = KDS_calculateHeadSize(tupdesc);
+	kds = alloca(head_sz);
+	init_kernel_data_store(kds, tupdesc, 0, KDS_FORMAT_ARROW, 0);
+	kds->nitems = rb_state->rb_nitems;
+	kds->nrooms = rb_state->rb_nitems;
+	kds->table_oid = RelationGetRelid(relation);
+	Assert(head_sz == KERN_DATA_STORE_HEAD_LENGTH(kds));
+	Assert(kds->ncols == rb_state->ncols);
+	__arrowFdwAssignTypeOptions(kds, 0, kds->ncols, rb_state->columns);
+	/*
+	 * compressed RecordBatch shall be decompressed on the host side, unless
+	 * device can decompress it.
+	 */
+	*p_comp_sz = 0;
+	*p_raw_sz  = 0;
+	if (rb_state->rb_compression >= 0)
+	{
+		if (gcontext && gpu_decompression &&
+			rb_state->rb_compression == ArrowCompressionType__LZ4_FRAME)
+			return __arrowFdwLoadCompressedRecordBatchGpu(rb_state,
+														  kds,
+														  referenced,
+														  gcontext,
+														  optimal_gpus,
+														  p_comp_sz,
+														  p_raw_sz);
+		return __arrowFdwLoadCompressedRecordBatch(rb_state,
+												   kds,
+												   referenced,
+												   gcontext,
+												   mcontext,
+												   p_comp_sz,
+												   p_raw_sz);
+	}
+	iovec = arrowFdwSetupIOvector(kds, rb_state, referenced);
+	__dump_kds_and_iovec(kds, iovec);
+
+	/*
+	 * If SSD-to-GPU Direct SQL is available on the arrow file, setup a small
+	 * PDS on host-pinned memory, with strom_io_vector.
+	 */
+	if (gcontext &&
+		bms_is_member(gcontext->cuda_dindex, optimal_gpus) &&
+		iovec->nr_chunks > 0 &&
+		kds->length <= gpuMemAllocIOMapMaxLength() &&
+		rb_state->dfile != NULL)
+	{
+		size_t	iovec_sz = offsetof(strom_io_vector, ioc[iovec->nr_chunks]);
+
+		rc = gpuMemAllocHost(gcontext, (void **)&pds,
+							 offsetof(pgstrom_data_store, kds) +
+							 head_sz + iovec_sz);
+		if (rc != CUDA_SUCCESS)
+			elog(ERROR, "failed on gpuMemAllocHost: %s", errorText(rc));
+
+		pds->gcontext = gcontext;
+		pg_atomic_init_u32(&pds->refcnt, 1);
+		pds->nblocks_uncached = 0;
+		memcpy(&pds->filedesc, rb_state->dfile, sizeof(GPUDirectFileDesc));
+		pds->iovec = (strom_io_vector *)((char *)&pds->kds + head_sz);
+		pds->gpu_decompress = false;
+		memcpy(&pds->kds, kds, head_sz);
+		memcpy(pds->iovec, iovec, iovec_sz);
+	}
+	else
+	{
+		/* Elsewhere, load RecordBatch by filesystem */
+		int		fdesc = FileGetRawDesc(rb_state->fdesc);
+
+		if (gcontext)
+		{
+			rc = gpuMemAllocManaged(gcontext,
+									(CUdeviceptr *)&pds,
+									offsetof(pgstrom_data_store,
+											 kds) + kds->length,
+									CU_MEM_ATTACH_GLOBAL);
+			if (rc != CUDA_SUCCESS)
+				elog(ERROR, "failed on gpuMemAllocManaged: %s", errorText(rc));
+		}
+		else
+		{
+			pds = MemoryContextAllocHuge(mcontext,
+										 offsetof(pgstrom_data_store,
+												  kds) + kds->length);
+		}
+		__PDS_fillup_arrow(pds, gcontext, kds, fdesc, iovec);
+	}
+	pfree(iovec);
+	return pds;
+}
+
+/*
+ * arrowFdwReadAheadRecordBatch
+ *
+ * It gives the kernel hints to read-ahead the referenced portion of the
+ * RecordBatch that shall be loaded later, by posix_fadvise(WILLNEED)
+ * through FilePrefetch(), so the buffered read of __PDS_fillup_arrow()
+ * and the compressed paths overlap with the execution. It is not used
+ * if the RecordBatch would be loaded by SSD-to-GPU Direct SQL.
+ */
+static void
+__arrowFdwReadAheadField(RecordBatchState *rb_state,
+						 RecordBatchFieldState *fstate)
+{
+	int		i;
+
+	if (fstate->nullmap_length > 0)
+		FilePrefetch(rb_state->fdesc,
+					 rb_state->rb_offset + fstate->nullmap_offset,
+					 Min(fstate->nullmap_length, INT_MAX),
+					 WAIT_EVENT_DATA_FILE_PREFETCH);
+	if (fstate->values_length > 0)
+		FilePrefetch(rb_state->fdesc,
+					 rb_state->rb_offset + fstate->values_offset,
+					 Min(fstate->values_length, INT_MAX),
+					 WAIT_EVENT_DATA_FILE_PREFETCH);
+	if (fstate->extra_length > 0)
+		FilePrefetch(rb_state->fdesc,
+					 rb_state->rb_offset + fstate->extra_offset,
+					 Min(fstate->extra_length, INT_MAX),
+					 WAIT_EVENT_DATA_FILE_PREFETCH);
+	for (i=0; i < fstate->num_children; i++)
+		__arrowFdwReadAheadField(rb_state, &fstate->children[i]);
+}
+
+static void
+arrowFdwReadAheadRecordBatch(ArrowFdwState *af_state,
+							 uint32 rb_index,
+							 GpuContext *gcontext,
+							 const Bitmapset *optimal_gpus)
 {
 	RecordBatchState *rb_state;
+	Bitmapset  *load_attrs = (af_state->late_attrs
+							  ? af_state->filter_attrs
+							  : af_state->referenced);
+	int			j, k;
+
+	if (rb_index >= af_state->num_rbatches)
+		return;
+	rb_state = af_state->rbatches[rb_index];
+	if (gcontext &&
+		rb_state->dfile != NULL &&
+		rb_state->rb_compression < 0 &&
+		bms_is_member(gcontext->cuda_dindex, optimal_gpus))
+		return;		/* SSD-to-GPU Direct SQL shall be used */
+
+	for (k = bms_next_member(load_attrs, -1);
+		 k >= 0;
+		 k = bms_next_member(load_attrs, k))
+	{
+		j = k + FirstLowInvalidHeapAttributeNumber - 1;
+		if (j < 0 || j >= rb_state->ncols)
+			continue;
+		__arrowFdwReadAheadField(rb_state, &rb_state->columns[j]);
+	}
+}
+
+/*
+ * arrowSyncScanStart
+ *
+ * It returns the index of RecordBatch being read by the concurrent scan
+ * on the same file, or 0 if none.
+ */
+static uint32
+arrowSyncScanStart(ArrowFdwState *af_state)
+{
+	TimestampTz	now = GetCurrentTimestamp();
+	uint32		i;
+	int			j;
+
+	SpinLockAcquire(&arrow_metadata_state->sync_lock);
+	for (i=0; i < af_state->num_rbatches; i++)
+	{
+		RecordBatchState *rb_state = af_state->rbatches[i];
+
+		for (j=0; j < ARROW_SYNC_SCAN_NELEM; j++)
+		{
+			arrowSyncScanItem *item = &arrow_metadata_state->sync_items[j];
+
+			if (item->last_update != 0 &&
+				item->st_dev == rb_state->stat_buf.st_dev &&
+				item->st_ino == rb_state->stat_buf.st_ino &&
+				item->rb_index == rb_state->rb_index &&
+				!TimestampDifferenceExceeds(item->last_update, now,
+											ARROW_SYNC_SCAN_TIMEOUT_MS))
+			{
+				SpinLockRelease(&arrow_metadata_state->sync_lock);
+				return i;
+			}
+		}
+	}
+	SpinLockRelease(&arrow_metadata_state->sync_lock);
+
+	return 0;
+}
+
+/*
+ * arrowSyncScanReport
+ *
+ * It reports the RecordBatch to be read, or the end of scan if NULL.
+ */
+static void
+arrowSyncScanReport(ArrowFdwState *af_state, RecordBatchState *rb_state)
+{
+	arrowSyncScanItem *item = NULL;
+	int			j;
+
+	SpinLockAcquire(&arrow_metadata_state->sync_lock);
+	if (!rb_state)
+	{
+		/* forget the positions, not to sync to the finished scan */
+		for (j=0; j < ARROW_SYNC_SCAN_NELEM; j++)
+		{
+			item = &arrow_metadata_state->sync_items[j];
+			if (item->pid == MyProcPid)
+				memset(item, 0, sizeof(arrowSyncScanItem));
+		}
+	}
+	else
+	{
+		for (j=0; j < ARROW_SYNC_SCAN_NELEM; j++)
+		{
+			arrowSyncScanItem *temp = &arrow_metadata_state->sync_items[j];
+
+			if (temp->last_update != 0 &&
+				temp->st_dev == rb_state->stat_buf.st_dev &&
+				temp->st_ino == rb_state->stat_buf.st_ino)
+			{
+				item = temp;
+				break;
+			}
+			/* elsewhere, replace the oldest item */
+			if (!item || temp->last_update < item->last_update)
+				item = temp;
+		}
+		item->st_dev = rb_state->stat_buf.st_dev;
+		item->st_ino = rb_state->stat_buf.st_ino;
+		item->rb_index = rb_state->rb_index;
+		item->pid = MyProcPid;
+		item->last_update = GetCurrentTimestamp();
+	}
+	SpinLockRelease(&arrow_metadata_state->sync_lock);
+}
+
+/*
+ * arrowFdwRecordBatchIndex
+ *
+ * It maps the sequence number of the scan to the index of RecordBatch,
+ * according to the start position of the synchronized scan.
+ */
+static inline uint32
+arrowFdwRecordBatchIndex(ArrowFdwState *af_state, uint32 rb_seq)
+{
+	if (rb_seq >= af_state->num_rbatches)
+		return af_state->num_rbatches;
+	return (af_state->sync_start + rb_seq) % af_state->num_rbatches;
+}
+
+static pgstrom_data_store *
+arrowFdwLoadRecordBatch(ArrowFdwState *af_state,
+						Relation relation,
+						EState *estate,
+						GpuContext *gcontext,
+						const Bitmapset *optimal_gpus)
+{
+	RecordBatchState *rb_state;
+	pgstrom_data_store *pds;
+	uint32		rb_seq;
 	uint32		rb_index;
+	size_t		comp_sz;
+	size_t		raw_sz;
 
 retry:
 	/* fetch next RecordBatch */
-	rb_index = pg_atomic_fetch_add_u32(af_state->rbatch_index, 1);
-	if (rb_index >= af_state->num_rbatches)
+	rb_seq = pg_atomic_fetch_add_u32(af_state->rbatch_index, 1);
+	if (rb_seq >= af_state->num_rbatches)
+	{
+		if (af_state->sync_scan && rb_seq == af_state->num_rbatches)
+			arrowSyncScanReport(af_state, NULL);
 		return NULL;	/* no more RecordBatch to read */
+	}
+	if (af_state->sync_scan && rb_seq == 0)
+		af_state->sync_start = arrowSyncScanStart(af_state);
+	rb_index = arrowFdwRecordBatchIndex(af_state, rb_seq);
 	rb_state = af_state->rbatches[rb_index];
+	if (af_state->sync_scan)
+		arrowSyncScanReport(af_state, rb_state);
+	/*
+	 * read-ahead of the upcoming RecordBatches; the head of the window
+	 * at the first call, then one by one.
+	 */
+	if (arrow_readahead_batches > 0)
+	{
+		uint32	i = (rb_seq < arrow_readahead_batches
+					 ? rb_seq + 1
+					 : rb_seq + arrow_readahead_batches);
+
+		while (i <= rb_seq + arrow_readahead_batches)
+			arrowFdwReadAheadRecordBatch(af_state,
+										 arrowFdwRecordBatchIndex(af_state,
+																  i++),
+										 gcontext, optimal_gpus);
+	}
 
 	if (af_state->stats_hint)
 	{
@@ -2239,12 +3930,28 @@ retry:
 			goto retry;
 		}
 	}
-	return __arrowFdwLoadRecordBatch(rb_state,
-									 relation,
-									 af_state->referenced,
-									 gcontext,
-									 estate->es_query_cxt,
-									 optimal_gpus);
+	/* only columns referenced by quals, if late materialization */
+	af_state->curr_rbstate = rb_state;
+	pds = __arrowFdwLoadRecordBatch(rb_state,
+									relation,
+									(af_state->late_attrs
+									 ? af_state->filter_attrs
+									 : af_state->referenced),
+									gcontext,
+									estate->es_query_cxt,
+									optimal_gpus,
+									af_state->gpu_decompression,
+									&comp_sz,
+									&raw_sz);
+	if (comp_sz > 0)
+	{
+		pg_atomic_fetch_add_u64(af_state->rbatch_comp_sz, comp_sz);
+		pg_atomic_fetch_add_u64(af_state->rbatch_raw_sz, raw_sz);
+		/* ZSTD and CPU scan are decompressed on the host side */
+		if (pds->gpu_decompress)
+			pg_atomic_fetch_add_u64(af_state->rbatch_gpu_comp_sz, comp_sz);
+	}
+	return pds;
 }
 
 /*
@@ -2255,15 +3962,96 @@ ExecScanChunkArrowFdw(GpuTaskState *gts)
 {
 	pgstrom_data_store *pds;
 
-	InstrStartNode(&gts->outer_instrument);
-	pds = arrowFdwLoadRecordBatch(gts->af_state,
-								  gts->css.ss.ss_currentRelation,
-								  gts->css.ss.ps.state,
-								  gts->gcontext,
-								  gts->optimal_gpus);
-	InstrStopNode(&gts->outer_instrument,
-				  !pds ? 0.0 : (double)pds->kds.nitems);
-	return pds;
+	InstrStartNode(&gts->outer_instrument);
+	pds = arrowFdwLoadRecordBatch(gts->af_state,
+								  gts->css.ss.ss_currentRelation,
+								  gts->css.ss.ps.state,
+								  gts->gcontext,
+								  gts->optimal_gpus);
+	InstrStopNode(&gts->outer_instrument,
+				  !pds ? 0.0 : (double)pds->kds.nitems);
+	return pds;
+}
+
+/*
+ * Late materialization of arrow_fdw CPU scan
+ *
+ * If scan qualifiers reference a part of the columns, we first load only
+ * the columns referenced by the quals, and evaluate them for each row.
+ * The rest of columns are loaded only if any rows satisfied the quals,
+ * so RecordBatches that have no matched rows are not read at all except
+ * for the filter columns.
+ */
+static void
+arrowFdwSetupLateMaterialization(ArrowFdwState *af_state,
+								 List *quals, Index scanrelid)
+{
+	Bitmapset  *filter_attrs = NULL;
+	Bitmapset  *late_attrs;
+	int			k;
+
+	pull_varattnos((Node *)quals, scanrelid, &filter_attrs);
+	k = bms_next_member(filter_attrs, -1);
+	if (k < 0 || k <= -FirstLowInvalidHeapAttributeNumber)
+		return;		/* system column or whole-row reference */
+	if (!bms_is_subset(filter_attrs, af_state->referenced))
+		return;
+	late_attrs = bms_difference(af_state->referenced, filter_attrs);
+	if (bms_is_empty(late_attrs))
+		return;
+	af_state->filter_attrs = filter_attrs;
+	af_state->late_attrs = late_attrs;
+}
+
+static bool
+arrowFdwLateMaterialization(ForeignScanState *node,
+							ArrowFdwState *af_state)
+{
+	EState		   *estate = node->ss.ps.state;
+	ExprContext	   *econtext = node->ss.ps.ps_ExprContext;
+	TupleTableSlot *slot = node->ss.ss_ScanTupleSlot;
+	kern_data_store *kds = &af_state->curr_pds->kds;
+	size_t			i, npassed = 0;
+	size_t			comp_sz;
+	size_t			raw_sz;
+
+	if (af_state->late_passed)
+		pfree(af_state->late_passed);
+	af_state->late_passed = MemoryContextAlloc(estate->es_query_cxt,
+											   sizeof(bool) * kds->nitems);
+	econtext->ecxt_scantuple = slot;
+	for (i=0; i < kds->nitems; i++)
+	{
+		ResetExprContext(econtext);
+		if (KDS_fetch_tuple_arrow(slot, kds, i) &&
+			ExecQual(node->ss.ps.qual, econtext))
+		{
+			af_state->late_passed[i] = true;
+			npassed++;
+		}
+		else
+			af_state->late_passed[i] = false;
+	}
+	ResetExprContext(econtext);
+	if (npassed == 0)
+		return false;
+
+	af_state->late_pds =
+		__arrowFdwLoadRecordBatch(af_state->curr_rbstate,
+								  node->ss.ss_currentRelation,
+								  af_state->late_attrs,
+								  NULL,
+								  estate->es_query_cxt,
+								  NULL,
+								  af_state->gpu_decompression,
+								  &comp_sz,
+								  &raw_sz);
+	if (comp_sz > 0)
+	{
+		pg_atomic_fetch_add_u64(af_state->rbatch_comp_sz, comp_sz);
+		pg_atomic_fetch_add_u64(af_state->rbatch_raw_sz, raw_sz);
+	}
+	return true;
 }
 
 /*
@@ -2276,7 +4064,9 @@ ArrowIterateForeignScan(ForeignScanState *node)
 	Relation		relation = node->ss.ss_currentRelation;
 	TupleTableSlot *slot = node->ss.ss_ScanTupleSlot;
 	pgstrom_data_store *pds;
+	size_t			index;
 
+retry:
 	while ((pds = af_state->curr_pds) == NULL ||
 		   af_state->curr_index >= pds->kds.nitems)
 	{
@@ -2285,6 +4075,9 @@ ArrowIterateForeignScan(ForeignScanState *node)
 		/* unload the previous RecordBatch, if any */
 		if (pds)
 			PDS_release(pds);
+		if (af_state->late_pds)
+			PDS_release(af_state->late_pds);
+		af_state->late_pds = NULL;
 		af_state->curr_index = 0;
 		af_state->curr_pds = arrowFdwLoadRecordBatch(af_state,
 													 relation,
@@ -2293,9 +4086,39 @@ ArrowIterateForeignScan(ForeignScanState *node)
 													 NULL);
 		if (!af_state->curr_pds)
 			return NULL;
+		if (af_state->late_attrs &&
+			!arrowFdwLateMaterialization(node, af_state))
+		{
+			/* no rows in this RecordBatch satisfied the quals */
+			PDS_release(af_state->curr_pds);
+			af_state->curr_pds = NULL;
+		}
 	}
 	Assert(pds && af_state->curr_index < pds->kds.nitems);
-	if (KDS_fetch_tuple_arrow(slot, &pds->kds, af_state->curr_index++))
+	index = af_state->curr_index++;
+	if (af_state->late_pds)
+	{
+		kern_data_store *kds = &af_state->late_pds->kds;
+		int		j;
+
+		if (!af_state->late_passed[index])
+			goto retry;
+		if (!KDS_fetch_tuple_arrow(slot, &pds->kds, index))
+			return NULL;
+		for (j=0; j < kds->ncols; j++)
+		{
+			kern_colmeta   *cmeta = &kds->colmeta[j];
+
+			if (cmeta->atttypkind == TYPE_KIND__NULL)
+				continue;	/* filter or unreferenced columns */
+			pg_datum_arrow_ref(kds, cmeta,
+							   index,
+							   slot->tts_values + j,
+							   slot->tts_isnull + j);
+		}
+		return slot;
+	}
+	if (KDS_fetch_tuple_arrow(slot, &pds->kds, index))
 		return slot;
 	return NULL;
 }
@@ -2311,9 +4134,36 @@ ExecReScanArrowFdw(ArrowFdwState *af_state)
 	if (af_state->curr_pds)
 		PDS_release(af_state->curr_pds);
 	af_state->curr_pds = NULL;
+	if (af_state->late_pds)
+		PDS_release(af_state->late_pds);
+	af_state->late_pds = NULL;
 	af_state->curr_index = 0;
 }
 
+/*
+ * ExecRuntimeQualsArrowFdw
+ *
+ * It replaces the runtime qualifiers, supplied by the upper node on the
+ * execution time (e.g, range of join-keys once GpuJoin loaded the inner
+ * relations), to skip record-batches by the min/max statistics. These
+ * qualifiers are merged to the scan qualifiers.
+ */
+void
+ExecRuntimeQualsArrowFdw(ArrowFdwState *af_state,
+						 ScanState *ss,
+						 List *runtime_quals)
+{
+	List	   *quals;
+
+	if (!arrow_fdw_stats_hint_enabled)
+		return;
+	if (af_state->stats_hint)
+		execEndArrowStatsHint(af_state->stats_hint);
+	quals = list_concat(list_copy(af_state->stats_quals), runtime_quals);
+	af_state->stats_hint = execInitArrowStatsHint(ss, af_state->stat_attrs,
+												  quals);
+}
+
 static void
 ArrowReScanForeignScan(ForeignScanState *node)
 {
@@ -2339,6 +4189,13 @@ ExecEndArrowFdw(ArrowFdwState *af_state)
 	}
 	if (af_state->stats_hint)
 		execEndArrowStatsHint(af_state->stats_hint);
+	/* e.g, LIMIT terminated the scan prior to the end */
+	if (af_state->sync_scan)
+		arrowSyncScanReport(af_state, NULL);
+	/* RecordBatches are consumed only if the scan reached the end */
+	if (af_state->consumer_marks != NIL &&
+		pg_atomic_read_u32(af_state->rbatch_index) > af_state->num_rbatches)
+		arrowConsumerAdvance(af_state->consumer_marks);
 }
 
 static void
@@ -2392,11 +4249,13 @@ ExplainArrowFdw(ArrowFdwState *af_state,
 
 		if (dcontext == NIL)
 		{
+			Bitmapset  *hint_attrs = bms_union(stats_hint->load_attrs,
+											   stats_hint->bloom_attrs);
 			int		anum;
 
-			for (anum = bms_next_member(stats_hint->load_attrs, -1);
+			for (anum = bms_next_member(hint_attrs, -1);
 				 anum >= 0;
-				 anum = bms_next_member(stats_hint->load_attrs, anum))
+				 anum = bms_next_member(hint_attrs, anum))
 			{
 				Form_pg_attribute attr = tupleDescAttr(tupdesc, anum-1);
 				const char *attName = NameStr(attr->attname);
@@ -2429,6 +4288,45 @@ ExplainArrowFdw(ArrowFdwState *af_state,
 		ExplainPropertyText("Stats-Hint", buf.data, es);
 	}
 
+	/* shows compressed and decompressed size of RecordBatches, if any */
+	if (es->analyze && pg_atomic_read_u64(af_state->rbatch_comp_sz) > 0)
+	{
+		uint64		comp_sz = pg_atomic_read_u64(af_state->rbatch_comp_sz);
+		uint64		raw_sz = pg_atomic_read_u64(af_state->rbatch_raw_sz);
+		uint64		gpu_sz = pg_atomic_read_u64(af_state->rbatch_gpu_comp_sz);
+		const char *label;
+
+		/* which side actually decompressed the RecordBatches */
+		if (gpu_sz == 0)
+			label = "CPU";
+		else if (gpu_sz >= comp_sz)
+			label = "GPU";
+		else
+			label = "GPU+CPU";
+
+		if (es->format == EXPLAIN_FORMAT_TEXT)
+		{
+			resetStringInfo(&buf);
+			appendStringInfo(&buf, "%s -> %s (%s",
+							 format_bytesz(comp_sz),
+							 format_bytesz(raw_sz),
+							 label);
+			if (gpu_sz > 0 && gpu_sz < comp_sz)
+				appendStringInfo(&buf, "; GPU: %s", format_bytesz(gpu_sz));
+			appendStringInfoChar(&buf, ')');
+			ExplainPropertyText("Decompression", buf.data, es);
+		}
+		else
+		{
+			ExplainPropertyText("Compressed-Size",
+								format_bytesz(comp_sz), es);
+			ExplainPropertyText("Decompressed-Size",
+								format_bytesz(raw_sz), es);
+			ExplainPropertyText("GPU-Decompressed-Size",
+								format_bytesz(gpu_sz), es);
+		}
+	}
+
 	/* shows files on behalf of the foreign table */
 	foreach (lc, af_state->fdescList)
 	{
@@ -2556,6 +4454,8 @@ RecordBatchAcquireSampleRows(Relation relation,
 	Bitmapset	   *referenced = NULL;
 	Datum		   *values;
 	bool		   *isnull;
+	size_t			comp_sz;
+	size_t			raw_sz;
 	int				count;
 	int				i, j, nwords;
 
@@ -2571,7 +4471,10 @@ RecordBatchAcquireSampleRows(Relation relation,
 									referenced,
 									NULL,
 									CurrentMemoryContext,
-									NULL);
+									NULL,
+									false,
+									&comp_sz,
+									&raw_sz);
 	values = alloca(sizeof(Datum) * tupdesc->natts);
 	isnull = alloca(sizeof(bool)  * tupdesc->natts);
 	for (count = 0; count < nsamples; count++)
@@ -2623,7 +4526,8 @@ ArrowAcquireSampleRows(Relation relation,
 
 	filesList = __arrowFdwExtractFilesList(ft->options,
 										   NULL,
-										   &writable);
+										   &writable,
+										   NULL);
 	foreach (lc, filesList)
 	{
 		char	   *fname = strVal(lfirst(lc));
@@ -3017,7 +4921,8 @@ static Size
 ArrowEstimateDSMForeignScan(ForeignScanState *node,
 							ParallelContext *pcxt)
 {
-	return MAXALIGN(sizeof(pg_atomic_uint32) * 3);
+	return (MAXALIGN(sizeof(pg_atomic_uint32) * 3) +
+			MAXALIGN(sizeof(pg_atomic_uint64) * 3));
 }
 
 /*
@@ -3027,7 +4932,10 @@ static inline void
 __ExecInitDSMArrowFdw(ArrowFdwState *af_state,
 					  pg_atomic_uint32 *rbatch_index,
 					  pg_atomic_uint32 *rbatch_nload,
-					  pg_atomic_uint32 *rbatch_nskip)
+					  pg_atomic_uint32 *rbatch_nskip,
+					  pg_atomic_uint64 *rbatch_comp_sz,
+					  pg_atomic_uint64 *rbatch_raw_sz,
+					  pg_atomic_uint64 *rbatch_gpu_comp_sz)
 {
 	pg_atomic_init_u32(rbatch_index, 0);
 	af_state->rbatch_index = rbatch_index;
@@ -3035,6 +4943,12 @@ __ExecInitDSMArrowFdw(ArrowFdwState *af_state,
 	af_state->rbatch_nload = rbatch_nload;
 	pg_atomic_init_u32(rbatch_nskip, 0);
 	af_state->rbatch_nskip = rbatch_nskip;
+	pg_atomic_init_u64(rbatch_comp_sz, 0);
+	af_state->rbatch_comp_sz = rbatch_comp_sz;
+	pg_atomic_init_u64(rbatch_raw_sz, 0);
+	af_state->rbatch_raw_sz = rbatch_raw_sz;
+	pg_atomic_init_u64(rbatch_gpu_comp_sz, 0);
+	af_state->rbatch_gpu_comp_sz = rbatch_gpu_comp_sz;
 }
 
 void
@@ -3043,7 +4957,10 @@ ExecInitDSMArrowFdw(ArrowFdwState *af_state, GpuTaskSharedState *gtss)
 	__ExecInitDSMArrowFdw(af_state,
 						  &gtss->af_rbatch_index,
 						  &gtss->af_rbatch_nload,
-						  &gtss->af_rbatch_nskip);
+						  &gtss->af_rbatch_nskip,
+						  &gtss->af_rbatch_comp_sz,
+						  &gtss->af_rbatch_raw_sz,
+						  &gtss->af_rbatch_gpu_comp_sz);
 }
 
 static void
@@ -3052,11 +4969,16 @@ ArrowInitializeDSMForeignScan(ForeignScanState *node,
 							  void *coordinate)
 {
 	pg_atomic_uint32 *atomic_buffer = coordinate;
+	pg_atomic_uint64 *atomic_bytesz = (pg_atomic_uint64 *)
+		((char *)coordinate + MAXALIGN(sizeof(pg_atomic_uint32) * 3));
 
 	__ExecInitDSMArrowFdw((ArrowFdwState *)node->fdw_state,
 						  atomic_buffer,
 						  atomic_buffer + 1,
-						  atomic_buffer + 2);
+						  atomic_buffer + 2,
+						  atomic_bytesz,
+						  atomic_bytesz + 1,
+						  atomic_bytesz + 2);
 }
 
 /*
@@ -3090,11 +5012,17 @@ static inline void
 __ExecInitWorkerArrowFdw(ArrowFdwState *af_state,
 						 pg_atomic_uint32 *rbatch_index,
 						 pg_atomic_uint32 *rbatch_nload,
-						 pg_atomic_uint32 *rbatch_nskip)
+						 pg_atomic_uint32 *rbatch_nskip,
+						 pg_atomic_uint64 *rbatch_comp_sz,
+						 pg_atomic_uint64 *rbatch_raw_sz,
+						 pg_atomic_uint64 *rbatch_gpu_comp_sz)
 {
 	af_state->rbatch_index = rbatch_index;
 	af_state->rbatch_nload = rbatch_nload;
 	af_state->rbatch_nskip = rbatch_nskip;
+	af_state->rbatch_comp_sz = rbatch_comp_sz;
+	af_state->rbatch_raw_sz = rbatch_raw_sz;
+	af_state->rbatch_gpu_comp_sz = rbatch_gpu_comp_sz;
 }
 
 void
@@ -3104,7 +5032,10 @@ ExecInitWorkerArrowFdw(ArrowFdwState *af_state,
 	__ExecInitWorkerArrowFdw(af_state,
 							 &gtss->af_rbatch_index,
 							 &gtss->af_rbatch_nload,
-							 &gtss->af_rbatch_nskip);
+							 &gtss->af_rbatch_nskip,
+							 &gtss->af_rbatch_comp_sz,
+							 &gtss->af_rbatch_raw_sz,
+							 &gtss->af_rbatch_gpu_comp_sz);
 }
 
 static void
@@ -3113,11 +5044,16 @@ ArrowInitializeWorkerForeignScan(ForeignScanState *node,
 								 void *coordinate)
 {
 	pg_atomic_uint32 *atomic_buffer = coordinate;
+	pg_atomic_uint64 *atomic_bytesz = (pg_atomic_uint64 *)
+		((char *)coordinate + MAXALIGN(sizeof(pg_atomic_uint32) * 3));
 
 	__ExecInitWorkerArrowFdw((ArrowFdwState *)node->fdw_state,
 							 atomic_buffer,
 							 atomic_buffer + 1,
-							 atomic_buffer + 2);
+							 atomic_buffer + 2,
+							 atomic_bytesz,
+							 atomic_bytesz + 1,
+							 atomic_bytesz + 2);
 }
 
 /*
@@ -3127,6 +5063,7 @@ static inline void
 __ExecShutdownArrowFdw(ArrowFdwState *af_state)
 {
 	uint32		temp;
+	uint64		bytesz;
 
 	temp = pg_atomic_read_u32(af_state->rbatch_index);
 	pg_atomic_write_u32(&af_state->__rbatch_index_local, temp);
@@ -3139,6 +5076,18 @@ __ExecShutdownArrowFdw(ArrowFdwState *af_state)
 	temp = pg_atomic_read_u32(af_state->rbatch_nskip);
 	pg_atomic_write_u32(&af_state->__rbatch_nskip_local, temp);
 	af_state->rbatch_nskip = &af_state->__rbatch_nskip_local;
+
+	bytesz = pg_atomic_read_u64(af_state->rbatch_comp_sz);
+	pg_atomic_write_u64(&af_state->__rbatch_comp_sz_local, bytesz);
+	af_state->rbatch_comp_sz = &af_state->__rbatch_comp_sz_local;
+
+	bytesz = pg_atomic_read_u64(af_state->rbatch_raw_sz);
+	pg_atomic_write_u64(&af_state->__rbatch_raw_sz_local, bytesz);
+	af_state->rbatch_raw_sz = &af_state->__rbatch_raw_sz_local;
+
+	bytesz = pg_atomic_read_u64(af_state->rbatch_gpu_comp_sz);
+	pg_atomic_write_u64(&af_state->__rbatch_gpu_comp_sz_local, bytesz);
+	af_state->rbatch_gpu_comp_sz = &af_state->__rbatch_gpu_comp_sz_local;
 }
 
 void
@@ -3172,7 +5121,8 @@ ArrowPlanForeignModify(PlannerInfo *root,
 
 	filesList = __arrowFdwExtractFilesList(ft->options,
 										   NULL,
-										   &writable);
+										   &writable,
+										   NULL);
 	if (!writable)
 		elog(ERROR, "arrow_fdw: foreign table \"%s\" is not writable",
 			 get_rel_name(rte->relid));
@@ -3270,6 +5220,45 @@ ArrowBeginForeignModify(ModifyTableState *mtstate,
 /*
  * ArrowExecForeignInsert
  */
+static inline size_t
+__arrowPutDatumValue(SQLfield *column, Form_pg_attribute attr,
+					 Datum datum, bool isnull)
+{
+	if (isnull)
+		return sql_field_put_value(column, NULL, 0);
+	else if (attr->attbyval)
+	{
+		Assert(column->sql_type.pgsql.typbyval);
+		return sql_field_put_value(column, (char *)&datum, attr->attlen);
+	}
+	else if (attr->attlen == -1)
+	{
+		int		vl_len = VARSIZE_ANY_EXHDR(datum);
+		char   *vl_ptr = VARDATA_ANY(datum);
+
+		Assert(column->sql_type.pgsql.typlen == -1);
+		return sql_field_put_value(column, vl_ptr, vl_len);
+	}
+	elog(ERROR, "Bug? unsupported type format");
+}
+
+static size_t
+__arrowPutTupleValues(SQLtable *table, TupleDesc tupdesc,
+					  Datum *values, bool *isnull)
+{
+	size_t		usage = 0;
+	int			j;
+
+	for (j=0; j < tupdesc->natts; j++)
+	{
+		usage += __arrowPutDatumValue(&table->columns[j],
+									  tupleDescAttr(tupdesc, j),
+									  values[j],
+									  isnull[j]);
+	}
+	return usage;
+}
+
 static TupleTableSlot *
 ArrowExecForeignInsert(EState *estate,
 					   ResultRelInfo *rrinfo,
@@ -3281,53 +5270,94 @@ ArrowExecForeignInsert(EState *estate,
 	arrowWriteState *aw_state = rrinfo->ri_FdwState;
 	SQLtable	   *table = &aw_state->sql_table;
 	MemoryContext	oldcxt;
-	size_t			usage = 0;
-	int				j;
+	size_t			usage;
 
 	slot_getallattrs(slot);
 	oldcxt = MemoryContextSwitchTo(aw_state->memcxt);
+	usage = __arrowPutTupleValues(table, tupdesc,
+								  slot->tts_values,
+								  slot->tts_isnull);
+	table->usage = usage;
+	table->nitems++;
+	MemoryContextSwitchTo(oldcxt);
+
+	/*
+	 * If usage exceeds the threshold of record-batch size, make a redo-log
+	 * on demand, and write out the buffer.
+	 */
+	if (usage > table->segment_sz)
+		writeOutArrowRecordBatch(aw_state, false);
+
+	return slot;
+}
+
+#if PG_VERSION_NUM >= 140000
+/*
+ * ArrowGetForeignModifyBatchSize / ArrowExecForeignBatchInsert
+ *
+ * INSERT ... SELECT delivers multiple rows at once, then we put the values
+ * column by column, to keep the SQLbuffer of the column hot in CPU cache and
+ * to save the per-row invocation of the executor. Record-batch is written
+ * out once the usage exceeds the threshold at end of the batch.
+ */
+#define ARROW_INSERT_BATCH_SIZE		256
+
+static int
+ArrowGetForeignModifyBatchSize(ResultRelInfo *rrinfo)
+{
+	TriggerDesc *trigdesc = rrinfo->ri_TrigDesc;
+
+	/* row triggers and RETURNING need per-row processing */
+	if (rrinfo->ri_projectReturning != NULL ||
+		(trigdesc && (trigdesc->trig_insert_before_row ||
+					  trigdesc->trig_insert_after_row)))
+		return 1;
+	return ARROW_INSERT_BATCH_SIZE;
+}
+
+static TupleTableSlot **
+ArrowExecForeignBatchInsert(EState *estate,
+							ResultRelInfo *rrinfo,
+							TupleTableSlot **slots,
+							TupleTableSlot **planSlots,
+							int *numSlots)
+{
+	Relation		frel = rrinfo->ri_RelationDesc;
+	TupleDesc		tupdesc = RelationGetDescr(frel);
+	arrowWriteState *aw_state = rrinfo->ri_FdwState;
+	SQLtable	   *table = &aw_state->sql_table;
+	MemoryContext	oldcxt;
+	size_t			usage = 0;
+	int				nslots = *numSlots;
+	int				i, j;
+
+	for (i=0; i < nslots; i++)
+		slot_getallattrs(slots[i]);
+	oldcxt = MemoryContextSwitchTo(aw_state->memcxt);
 	for (j=0; j < tupdesc->natts; j++)
 	{
 		Form_pg_attribute attr = tupleDescAttr(tupdesc, j);
 		SQLfield   *column = &table->columns[j];
-		Datum		datum = slot->tts_values[j];
-		bool		isnull = slot->tts_isnull[j];
+		size_t		__usage = column->__curr_usage__;
 
-		if (isnull)
-		{
-			usage += sql_field_put_value(column, NULL, 0);
-		}
-		else if (attr->attbyval)
-		{
-			Assert(column->sql_type.pgsql.typbyval);
-			usage += sql_field_put_value(column, (char *)&datum, attr->attlen);
-		}
-		else if (attr->attlen == -1)
-		{
-			int		vl_len = VARSIZE_ANY_EXHDR(datum);
-			char   *vl_ptr = VARDATA_ANY(datum);
-
-			Assert(column->sql_type.pgsql.typlen == -1);
-			usage += sql_field_put_value(column, vl_ptr, vl_len);
-		}
-		else
+		for (i=0; i < nslots; i++)
 		{
-			elog(ERROR, "Bug? unsupported type format");
+			__usage = __arrowPutDatumValue(column, attr,
+										   slots[i]->tts_values[j],
+										   slots[i]->tts_isnull[j]);
 		}
+		usage += __usage;
 	}
 	table->usage = usage;
-	table->nitems++;
+	table->nitems += nslots;
 	MemoryContextSwitchTo(oldcxt);
 
-	/*
-	 * If usage exceeds the threshold of record-batch size, make a redo-log
-	 * on demand, and write out the buffer.
-	 */
 	if (usage > table->segment_sz)
 		writeOutArrowRecordBatch(aw_state, false);
 
-	return slot;
+	return slots;
 }
+#endif
 
 /*
  * ArrowEndForeignModify
@@ -3965,14 +5995,46 @@ pg_varlena_arrow_ref(kern_data_store *kds,
 	cl_uint	   *offset = (cl_uint *)
 		((char *)kds + __kds_unpack(cmeta->values_offset));
 	char	   *extra = (char *)kds + __kds_unpack(cmeta->extra_offset);
+	size_t		extra_length = __kds_unpack(cmeta->extra_length);
+	int			index_width = cmeta->attopts.dictionary.index_width;
 	cl_uint		len;
 	struct varlena *res;
 
-	if (sizeof(uint32) * (index+2) > __kds_unpack(cmeta->values_length))
+	if (index_width > 0)
+	{
+		/* dictionary-encoded; the index value points the dictionary */
+		char	   *ivalues = (char *)offset;
+		uint64		dindex;
+
+		if (index_width * (index+1) > __kds_unpack(cmeta->values_length))
+			elog(ERROR, "corruption? dictionary index out of range");
+		switch (index_width)
+		{
+			case sizeof(uint8):
+				dindex = ((uint8 *)ivalues)[index];
+				break;
+			case sizeof(uint16):
+				dindex = ((uint16 *)ivalues)[index];
+				break;
+			case sizeof(uint32):
+				dindex = ((uint32 *)ivalues)[index];
+				break;
+			default:
+				dindex = ((uint64 *)ivalues)[index];
+				break;
+		}
+		if (dindex >= cmeta->attopts.dictionary.dict_nitems)
+			elog(ERROR, "corruption? dictionary index out of range");
+		index = dindex;
+		offset = (cl_uint *)extra;
+		extra += cmeta->attopts.dictionary.dict_data_offset;
+		extra_length -= cmeta->attopts.dictionary.dict_data_offset;
+	}
+	else if (sizeof(uint32) * (index+2) > __kds_unpack(cmeta->values_length))
 		elog(ERROR, "corruption? varlena index out of range");
 	len = offset[index+1] - offset[index];
 	if (offset[index] > offset[index+1] ||
-		offset[index+1] > __kds_unpack(cmeta->extra_length))
+		offset[index+1] > extra_length)
 		elog(ERROR, "corruption? varlena points out of extra buffer");
 
 	res = palloc(VARHDRSZ + len);
@@ -4535,23 +6597,392 @@ KDS_fetch_tuple_arrow(TupleTableSlot *slot,
 						   slot->tts_values + j,
 						   slot->tts_isnull + j);
 	}
-	return true;
+	return true;
+}
+
+/*
+ * Directory-partitioned arrow files
+ *
+ * If 'partition_keys' option is given with 'dir', arrow files are
+ * located under the Hive-style sub-directories; like
+ *   <dir>/<key1>=<value1>/<key2>=<value2>/<file>
+ * The partition keys are mapped to the foreign table columns by name,
+ * then the files are pruned at plan time if WHERE-clause on the keys
+ * are never satisfied by the values in the path.
+ */
+#define ARROW_HIVE_DEFAULT_PARTITION	"__HIVE_DEFAULT_PARTITION__"
+
+static List *
+__arrowFdwParsePartitionKeys(const char *partition_keys)
+{
+	char	   *temp = pstrdup(partition_keys);
+	char	   *saveptr;
+	char	   *tok, *pos;
+	List	   *result = NIL;
+
+	while ((tok = strtok_r(temp, ",", &saveptr)) != NULL)
+	{
+		while (isspace(*tok))
+			tok++;
+		pos = tok + strlen(tok) - 1;
+		while (pos >= tok && isspace(*pos))
+			*pos-- = '\0';
+		if (*tok == '\0' || strchr(tok, '=') || strchr(tok, '/'))
+			elog(ERROR, "arrow: invalid partition key '%s'", tok);
+		result = lappend(result, makeString(pstrdup(tok)));
+
+		temp = NULL;
+	}
+	if (result == NIL)
+		elog(ERROR, "arrow: 'partition_keys' has no valid keys");
+	return result;
+}
+
+static bool
+__arrowFdwMatchSuffix(const char *d_name, const char *dir_suffix)
+{
+	int		dlen = strlen(d_name);
+	int		slen = strlen(dir_suffix);
+	int		diff;
+
+	if (dlen < 2 + slen)
+		return false;
+	diff = dlen - slen;
+	if (d_name[diff-1] != '.' ||
+		strcmp(d_name + diff, dir_suffix) != 0)
+		return false;
+	return true;
+}
+
+static List *
+__arrowFdwScanPartitionDir(List *filesList,
+						   const char *dir_path,
+						   const char *dir_suffix,
+						   int key_index,
+						   List *partition_keys)
+{
+	struct dirent *dentry;
+	DIR		   *dir;
+	const char *key = NULL;
+	int			klen = 0;
+
+	if (key_index < list_length(partition_keys))
+	{
+		key = strVal(list_nth(partition_keys, key_index));
+		klen = strlen(key);
+	}
+	dir = AllocateDir(dir_path);
+	while ((dentry = ReadDir(dir, dir_path)) != NULL)
+	{
+		char	   *temp;
+		struct stat	stat_buf;
+
+		if (strcmp(dentry->d_name, ".") == 0 ||
+			strcmp(dentry->d_name, "..") == 0)
+			continue;
+		temp = psprintf("%s/%s", dir_path, dentry->d_name);
+		if (stat(temp, &stat_buf) != 0)
+			elog(ERROR, "failed on stat('%s'): %m", temp);
+		if (key)
+		{
+			/* sub-directory must be '<key>=<value>' */
+			if (!S_ISDIR(stat_buf.st_mode) ||
+				strncmp(dentry->d_name, key, klen) != 0 ||
+				dentry->d_name[klen] != '=')
+			{
+				pfree(temp);
+				continue;
+			}
+			filesList = __arrowFdwScanPartitionDir(filesList,
+												   temp,
+												   dir_suffix,
+												   key_index + 1,
+												   partition_keys);
+		}
+		else if (S_ISREG(stat_buf.st_mode) &&
+				 (!dir_suffix ||
+				  __arrowFdwMatchSuffix(dentry->d_name, dir_suffix)))
+		{
+			filesList = lappend(filesList, makeString(temp));
+		}
+	}
+	FreeDir(dir);
+
+	return filesList;
+}
+
+/*
+ * __arrowFdwPartitionValue - extract the partition value from the path
+ */
+static char *
+__arrowFdwPartitionValue(const char *fname, const char *dir_path,
+						 int key_index, const char *key)
+{
+	size_t		dlen = strlen(dir_path);
+	const char *pos;
+	const char *tail;
+	size_t		klen = strlen(key);
+	char	   *result;
+	char	   *dst;
+	int			i;
+
+	if (strncmp(fname, dir_path, dlen) != 0 || fname[dlen] != '/')
+		return NULL;
+	pos = fname + dlen + 1;
+	for (i=0; i < key_index; i++)
+	{
+		pos = strchr(pos, '/');
+		if (!pos)
+			return NULL;
+		pos++;
+	}
+	tail = strchr(pos, '/');
+	if (!tail ||
+		strncmp(pos, key, klen) != 0 || pos[klen] != '=')
+		return NULL;
+	pos += klen + 1;
+
+	/* unescape %XX of the Hive-style path */
+	result = dst = palloc(tail - pos + 1);
+	while (pos < tail)
+	{
+		if (pos[0] == '%' && pos + 2 < tail &&
+			isxdigit(pos[1]) && isxdigit(pos[2]))
+		{
+			char	hex[3] = { pos[1], pos[2], '\0' };
+
+			*dst++ = (char)strtol(hex, NULL, 16);
+			pos += 3;
+		}
+		else
+			*dst++ = *pos++;
+	}
+	*dst = '\0';
+	return result;
+}
+
+typedef struct
+{
+	int			nkeys;
+	AttrNumber *key_attnums;
+	Const	  **key_values;
+} arrowFdwPartitionContext;
+
+static Node *
+__arrowFdwReplacePartitionKeys(Node *node, arrowFdwPartitionContext *con)
+{
+	if (!node)
+		return NULL;
+	if (IsA(node, Var))
+	{
+		Var	   *var = (Var *)node;
+		int		i;
+
+		if (var->varlevelsup == 0)
+		{
+			for (i=0; i < con->nkeys; i++)
+			{
+				if (var->varattno == con->key_attnums[i])
+					return (Node *)copyObject(con->key_values[i]);
+			}
+		}
+		return node;
+	}
+	return expression_tree_mutator(node, __arrowFdwReplacePartitionKeys, con);
+}
+
+/*
+ * arrowFdwPruneFilesList
+ *
+ * It removes files from the list, if quals referencing only partition
+ * keys are never satisfied by their values in the file path.
+ */
+static List *
+arrowFdwPruneFilesList(List *filesList, List *options_list,
+					   TupleDesc tupdesc, List *quals)
+{
+	ListCell   *lc;
+	ListCell   *cell;
+	const char *dir_path = NULL;
+	const char *partition_keys = NULL;
+	List	   *key_names = NIL;
+	List	   *prune_quals = NIL;
+	List	   *results = NIL;
+	arrowFdwPartitionContext con;
+	Bitmapset  *key_attrs = NULL;
+	int			i, j;
+
+	foreach (lc, options_list)
+	{
+		DefElem	   *defel = lfirst(lc);
+
+		if (strcmp(defel->defname, "dir") == 0)
+			dir_path = strVal(defel->arg);
+		else if (strcmp(defel->defname, "partition_keys") == 0)
+			partition_keys = strVal(defel->arg);
+	}
+	if (!dir_path || !partition_keys || quals == NIL)
+		return filesList;
+
+	/* map partition keys to the columns */
+	key_names = __arrowFdwParsePartitionKeys(partition_keys);
+	memset(&con, 0, sizeof(arrowFdwPartitionContext));
+	con.key_attnums = palloc0(sizeof(AttrNumber) * list_length(key_names));
+	con.key_values  = palloc0(sizeof(Const *) * list_length(key_names));
+	foreach (lc, key_names)
+	{
+		const char *key = strVal(lfirst(lc));
+
+		for (j=0; j < tupdesc->natts; j++)
+		{
+			Form_pg_attribute attr = tupleDescAttr(tupdesc, j);
+
+			if (!attr->attisdropped &&
+				strcmp(NameStr(attr->attname), key) == 0)
+			{
+				con.key_attnums[con.nkeys] = attr->attnum;
+				key_attrs = bms_add_member(key_attrs, attr->attnum);
+				break;
+			}
+		}
+		con.nkeys++;	/* key_attnums[] is zero, if no such column */
+	}
+
+	/* pick up quals that reference only partition keys */
+	foreach (lc, quals)
+	{
+		Node	   *qual = lfirst(lc);
+		List	   *vars;
+		bool		is_valid = true;
+
+		if (IsA(qual, RestrictInfo))
+			qual = (Node *)((RestrictInfo *)qual)->clause;
+		if (contain_volatile_functions(qual))
+			continue;
+		vars = pull_var_clause(qual, PVC_RECURSE_PLACEHOLDERS);
+		if (vars == NIL)
+			continue;
+		foreach (cell, vars)
+		{
+			Var	   *var = lfirst(cell);
+
+			if (!IsA(var, Var) || var->varlevelsup != 0 ||
+				!bms_is_member(var->varattno, key_attrs))
+			{
+				is_valid = false;
+				break;
+			}
+		}
+		if (is_valid)
+			prune_quals = lappend(prune_quals, qual);
+		list_free(vars);
+	}
+	if (prune_quals == NIL)
+		return filesList;
+
+	foreach (lc, filesList)
+	{
+		const char *fname = strVal(lfirst(lc));
+		Expr	   *expr;
+		bool		is_pruned = false;
+
+		/* setup constant values of the partition keys */
+		i = 0;
+		foreach (cell, key_names)
+		{
+			AttrNumber	anum = con.key_attnums[i];
+			Form_pg_attribute attr;
+			char	   *value;
+			Oid			typinput;
+			Oid			typioparam;
+
+			if (anum <= 0)
+			{
+				i++;
+				continue;
+			}
+			attr = tupleDescAttr(tupdesc, anum - 1);
+			value = __arrowFdwPartitionValue(fname, dir_path, i,
+											 strVal(lfirst(cell)));
+			if (!value)
+				elog(ERROR, "arrow: file '%s' has no partition key '%s' in the path",
+					 fname, strVal(lfirst(cell)));
+			if (strcmp(value, ARROW_HIVE_DEFAULT_PARTITION) == 0)
+			{
+				con.key_values[i] = makeNullConst(attr->atttypid,
+												  attr->atttypmod,
+												  attr->attcollation);
+			}
+			else
+			{
+				getTypeInputInfo(attr->atttypid, &typinput, &typioparam);
+				con.key_values[i] =
+					makeConst(attr->atttypid,
+							  attr->atttypmod,
+							  attr->attcollation,
+							  attr->attlen,
+							  OidInputFunctionCall(typinput, value,
+												   typioparam,
+												   attr->atttypmod),
+							  false,
+							  attr->attbyval);
+			}
+			i++;
+		}
+		/* try to evaluate the quals by the partition values */
+		expr = (Expr *)__arrowFdwReplacePartitionKeys((Node *)prune_quals,
+													  &con);
+		expr = (Expr *)eval_const_expressions(NULL, (Node *)
+											  make_ands_explicit((List *)expr));
+		if (IsA(expr, Const) &&
+			(((Const *)expr)->constisnull ||
+			 !DatumGetBool(((Const *)expr)->constvalue)))
+			is_pruned = true;
+
+		if (!is_pruned)
+			results = lappend(results, lfirst(lc));
+		else
+			elog(DEBUG2, "arrow_fdw: file '%s' was pruned by partition keys",
+				 fname);
+	}
+	return results;
 }
 
 /*
  * arrowFdwExtractFilesList
  */
+/*
+ * __arrowFdwCheckRemoteURL
+ *
+ * Arrow_Fdw reads the files through VFD, so the object storage has to be
+ * mounted on the local filesystem (e.g, FUSE) prior to the access.
+ */
+static void
+__arrowFdwCheckRemoteURL(const char *fname)
+{
+	if (strncmp(fname, "s3://", 5) == 0 ||
+		strncmp(fname, "http://", 7) == 0 ||
+		strncmp(fname, "https://", 8) == 0)
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("arrow_fdw does not support remote URL '%s'", fname),
+				 errhint("Mount the object storage using a FUSE filesystem, then specify the local path; arrow_fdw.io_parallelism allows concurrent ranged reads.")));
+}
+
 static List *
 __arrowFdwExtractFilesList(List *options_list,
 						   int *p_parallel_nworkers,
-						   bool *p_writable)
+						   bool *p_writable,
+						   bool *p_gpu_decompression)
 {
 	ListCell   *lc;
 	List	   *filesList = NIL;
 	char	   *dir_path = NULL;
 	char	   *dir_suffix = NULL;
+	char	   *partition_keys = NULL;
 	int			parallel_nworkers = -1;
 	bool		writable = false;	/* default: read-only */
+	bool		gpu_decompression = false;
 
 	foreach (lc, options_list)
 	{
@@ -4590,6 +7021,10 @@ __arrowFdwExtractFilesList(List *options_list,
 		{
 			dir_suffix = strVal(defel->arg);
 		}
+		else if (strcmp(defel->defname, "partition_keys") == 0)
+		{
+			partition_keys = strVal(defel->arg);
+		}
 		else if (strcmp(defel->defname, "parallel_workers") == 0)
 		{
 			if (parallel_nworkers >= 0)
@@ -4600,11 +7035,17 @@ __arrowFdwExtractFilesList(List *options_list,
 		{
 			writable = defGetBoolean(defel);
 		}
+		else if (strcmp(defel->defname, "gpu_decompression") == 0)
+		{
+			gpu_decompression = defGetBoolean(defel);
+		}
 		else
 			elog(ERROR, "arrow: unknown option (%s)", defel->defname);
 	}
 	if (dir_suffix && !dir_path)
 		elog(ERROR, "arrow: cannot use 'suffix' option without 'dir'");
+	if (partition_keys && !dir_path)
+		elog(ERROR, "arrow: cannot use 'partition_keys' option without 'dir'");
 
 	if (writable)
 	{
@@ -4617,6 +7058,18 @@ __arrowFdwExtractFilesList(List *options_list,
 	}
 
 	if (dir_path)
+		__arrowFdwCheckRemoteURL(dir_path);
+	if (dir_path && partition_keys)
+	{
+		List   *key_names = __arrowFdwParsePartitionKeys(partition_keys);
+
+		filesList = __arrowFdwScanPartitionDir(filesList,
+											   dir_path,
+											   dir_suffix,
+											   0,
+											   key_names);
+	}
+	else if (dir_path)
 	{
 		struct dirent *dentry;
 		DIR	   *dir;
@@ -4628,19 +7081,9 @@ __arrowFdwExtractFilesList(List *options_list,
 			if (strcmp(dentry->d_name, ".") == 0 ||
 				strcmp(dentry->d_name, "..") == 0)
 				continue;
-			if (dir_suffix)
-			{
-				int		dlen = strlen(dentry->d_name);
-				int		slen = strlen(dir_suffix);
-				int		diff;
-
-				if (dlen < 2 + slen)
-					continue;
-				diff = dlen - slen;
-				if (dentry->d_name[diff-1] != '.' ||
-					strcmp(dentry->d_name + diff, dir_suffix) != 0)
-					continue;
-			}
+			if (dir_suffix &&
+				!__arrowFdwMatchSuffix(dentry->d_name, dir_suffix))
+				continue;
 			temp = psprintf("%s/%s", dir_path, dentry->d_name);
 			filesList = lappend(filesList, makeString(temp));
 		}
@@ -4653,6 +7096,7 @@ __arrowFdwExtractFilesList(List *options_list,
 	{
 		const char *fname = strVal((Value *)lfirst(lc));
 
+		__arrowFdwCheckRemoteURL(fname);
 		if (!writable)
 		{
 			if (access(fname, R_OK) != 0)
@@ -4681,6 +7125,8 @@ __arrowFdwExtractFilesList(List *options_list,
 		*p_parallel_nworkers = parallel_nworkers;
 	if (p_writable)
 		*p_writable = writable;
+	if (p_gpu_decompression)
+		*p_gpu_decompression = gpu_decompression;
 
 	return filesList;
 }
@@ -4688,7 +7134,7 @@ __arrowFdwExtractFilesList(List *options_list,
 static List *
 arrowFdwExtractFilesList(List *options_list)
 {
-	return __arrowFdwExtractFilesList(options_list, NULL, NULL);
+	return __arrowFdwExtractFilesList(options_list, NULL, NULL, NULL);
 }
 
 
@@ -4775,7 +7221,8 @@ arrow_fdw_precheck_schema(Relation rel)
 #endif
 	filesList = __arrowFdwExtractFilesList(ft->options,
 										   NULL,
-										   &writable);
+										   &writable,
+										   NULL);
 	foreach (lc, filesList)
 	{
 		const char *fname = strVal(lfirst(lc));
@@ -4964,7 +7411,7 @@ copyMetadataFieldCache(RecordBatchFieldState *dest_curr,
 			dest_next += k;
 			nslots += k;
 		}
-		if (p_stat_attrs && !__orig->stat_isnull)
+		if (p_stat_attrs && (!__orig->stat_isnull || __orig->stat_has_bloom))
 			*p_stat_attrs = bms_add_member(*p_stat_attrs, j+1);
 	}
 	return nslots;
@@ -4989,6 +7436,7 @@ makeRecordBatchStateFromCache(arrowMetadataCache *mcache,
 	rbstate->rb_offset = mcache->rb_offset;
 	rbstate->rb_length = mcache->rb_length;
 	rbstate->rb_nitems = mcache->rb_nitems;
+	rbstate->rb_compression = mcache->rb_compression;
 	rbstate->ncols = mcache->ncols;
 	copyMetadataFieldCache(rbstate->columns,
 						   rbstate->columns + mcache->nfields,
@@ -5107,6 +7555,7 @@ __arrowBuildMetadataCache(List *rb_state_list, uint32 hash)
         mtemp->rb_offset = rbstate->rb_offset;
         mtemp->rb_length = rbstate->rb_length;
         mtemp->rb_nitems = rbstate->rb_nitems;
+		mtemp->rb_compression = rbstate->rb_compression;
         mtemp->ncols     = rbstate->ncols;
 		mtemp->nfields   =
 			copyMetadataFieldCache(mtemp->fstate,
@@ -5156,6 +7605,275 @@ checkArrowRecordBatchIsVisible(RecordBatchState *rbstate,
 	return true;
 }
 
+/*
+ * Persistent metadata cache file
+ *
+ * If arrow_fdw.metadata_cache_dir is configured, RecordBatchStates parsed
+ * from the footer are also written out to a file per arrow file, then
+ * loaded on the next reference instead of reading the footer again, even
+ * after the restart or the eviction from the shared memory.
+ * The file image is the array of arrowMetadataFileBatch just after the
+ * header; pointers to sub-fields are saved as index of fstate[].
+ * It is valid only if st_dev, st_ino, st_size, st_mtim and st_ctim are
+ * identical to the arrow file, and built by the binary with the same
+ * layout of RecordBatchFieldState.
+ */
+#define ARROW_METADATA_FILE_MAGIC		0x41524d43	/* 'ARMC' */
+#define ARROW_METADATA_FILE_VERSION		2
+
+typedef struct
+{
+	uint32		magic;		/* =ARROW_METADATA_FILE_MAGIC */
+	uint32		version;	/* =ARROW_METADATA_FILE_VERSION */
+	uint32		fstate_sz;	/* =sizeof(RecordBatchFieldState) */
+	uint32		nbatches;	/* number of RecordBatches */
+	uint32		nfields;	/* length of fstate[] array per batch */
+	uint32		ncols;
+	dev_t		st_dev;
+	ino_t		st_ino;
+	off_t		st_size;
+	struct timespec st_mtim;
+	struct timespec st_ctim;
+} arrowMetadataFileHead;
+
+typedef struct
+{
+	int			rb_index;
+	int			rb_compression;
+	off_t		rb_offset;
+	size_t		rb_length;
+	int64		rb_nitems;
+	RecordBatchFieldState fstate[FLEXIBLE_ARRAY_MEMBER];
+} arrowMetadataFileBatch;
+
+static void
+arrowMetadataFilePath(char *fpath, size_t fpath_sz, struct stat *stat_buf)
+{
+	snprintf(fpath, fpath_sz, "%s/arrow_meta_%lu_%lu.cache",
+			 arrow_metadata_cache_dir,
+			 (unsigned long)stat_buf->st_dev,
+			 (unsigned long)stat_buf->st_ino);
+}
+
+/*
+ * arrowLoadMetadataCacheFile
+ *   - returns a list of RecordBatchState, or NIL if no valid cache file
+ */
+static List *
+arrowLoadMetadataCacheFile(File fdesc, struct stat *stat_buf,
+						   Bitmapset **p_stat_attrs)
+{
+	char		fpath[MAXPGPATH];
+	int			fd;
+	struct stat	fstat_buf;
+	char	   *buffer;
+	arrowMetadataFileHead *head;
+	size_t		unitsz;
+	List	   *results = NIL;
+	Bitmapset  *stat_attrs = NULL;
+	uint32		i, j;
+
+	if (!arrow_metadata_cache_dir || arrow_metadata_cache_dir[0] == '\0')
+		return NIL;
+	arrowMetadataFilePath(fpath, sizeof(fpath), stat_buf);
+	fd = open(fpath, O_RDONLY | PG_BINARY);
+	if (fd < 0)
+		return NIL;
+	if (fstat(fd, &fstat_buf) != 0 ||
+		fstat_buf.st_size < sizeof(arrowMetadataFileHead))
+	{
+		close(fd);
+		return NIL;
+	}
+	buffer = palloc(fstat_buf.st_size);
+	if (__readFile(fd, buffer, fstat_buf.st_size) != fstat_buf.st_size)
+	{
+		close(fd);
+		pfree(buffer);
+		return NIL;
+	}
+	close(fd);
+
+	head = (arrowMetadataFileHead *)buffer;
+	unitsz = MAXALIGN(offsetof(arrowMetadataFileBatch,
+							   fstate[head->nfields]));
+	if (head->magic != ARROW_METADATA_FILE_MAGIC ||
+		head->version != ARROW_METADATA_FILE_VERSION ||
+		head->fstate_sz != sizeof(RecordBatchFieldState) ||
+		head->st_dev != stat_buf->st_dev ||
+		head->st_ino != stat_buf->st_ino ||
+		head->st_size != stat_buf->st_size ||
+		timespec_comp(&head->st_mtim, &stat_buf->st_mtim) != 0 ||
+		timespec_comp(&head->st_ctim, &stat_buf->st_ctim) != 0 ||
+		head->nbatches == 0 ||
+		head->ncols > head->nfields ||
+		fstat_buf.st_size != (MAXALIGN(sizeof(arrowMetadataFileHead)) +
+							  unitsz * head->nbatches))
+	{
+		elog(DEBUG2, "arrow_fdw: metadata cache file '%s' is not valid for '%s'",
+			 fpath, FilePathName(fdesc));
+		pfree(buffer);
+		return NIL;
+	}
+
+	for (i=0; i < head->nbatches; i++)
+	{
+		arrowMetadataFileBatch *fbatch = (arrowMetadataFileBatch *)
+			(buffer + MAXALIGN(sizeof(arrowMetadataFileHead)) + unitsz * i);
+		RecordBatchState *rbstate;
+
+		rbstate = palloc0(offsetof(RecordBatchState,
+								   columns[head->nfields]));
+		rbstate->fdesc = fdesc;
+		memcpy(&rbstate->stat_buf, stat_buf, sizeof(struct stat));
+		rbstate->rb_index  = fbatch->rb_index;
+		rbstate->rb_offset = fbatch->rb_offset;
+		rbstate->rb_length = fbatch->rb_length;
+		rbstate->rb_nitems = fbatch->rb_nitems;
+		rbstate->rb_compression = fbatch->rb_compression;
+		rbstate->ncols = head->ncols;
+		memcpy(rbstate->columns, fbatch->fstate,
+			   sizeof(RecordBatchFieldState) * head->nfields);
+		for (j=0; j < head->nfields; j++)
+		{
+			RecordBatchFieldState *fstate = &rbstate->columns[j];
+			uintptr_t	cindex = (uintptr_t)fstate->children;
+
+			/*
+			 * type OID might be dropped after the cache file creation,
+			 * if it is user defined type.
+			 */
+			if (!SearchSysCacheExists1(TYPEOID,
+									   ObjectIdGetDatum(fstate->atttypid)) ||
+				(fstate->num_children > 0
+				 ? (cindex < head->ncols ||
+					cindex + fstate->num_children > head->nfields)
+				 : (fstate->children != NULL)))
+			{
+				elog(DEBUG2, "arrow_fdw: metadata cache file '%s' is not valid for '%s'",
+					 fpath, FilePathName(fdesc));
+				pfree(buffer);
+				return NIL;
+			}
+			if (fstate->num_children > 0)
+				fstate->children = rbstate->columns + cindex;
+			if (j < head->ncols && (!fstate->stat_isnull ||
+									fstate->stat_has_bloom))
+				stat_attrs = bms_add_member(stat_attrs, j+1);
+		}
+		results = lappend(results, rbstate);
+	}
+	pfree(buffer);
+
+	if (p_stat_attrs)
+		*p_stat_attrs = bms_add_members(*p_stat_attrs, stat_attrs);
+	elog(DEBUG2, "arrow_fdw: metadata of '%s' was loaded from '%s'",
+		 FilePathName(fdesc), fpath);
+
+	return results;
+}
+
+/*
+ * arrowSaveMetadataCacheFile
+ */
+static void
+arrowSaveMetadataCacheFile(File fdesc, struct stat *stat_buf,
+						   List *rb_state_list)
+{
+	char		fpath[MAXPGPATH];
+	char		tpath[MAXPGPATH];
+	arrowMetadataFileHead *head;
+	RecordBatchState *rbstate;
+	char	   *buffer;
+	size_t		unitsz;
+	size_t		length;
+	int			nfields;
+	int			fd;
+	uint32		i, j;
+	ListCell   *lc;
+
+	if (!arrow_metadata_cache_dir || arrow_metadata_cache_dir[0] == '\0' ||
+		rb_state_list == NIL)
+		return;
+	rbstate = linitial(rb_state_list);
+	nfields = RecordBatchFieldCount(rbstate);
+	unitsz = MAXALIGN(offsetof(arrowMetadataFileBatch, fstate[nfields]));
+	length = (MAXALIGN(sizeof(arrowMetadataFileHead)) +
+			  unitsz * list_length(rb_state_list));
+	buffer = palloc0(length);
+
+	head = (arrowMetadataFileHead *)buffer;
+	head->magic     = ARROW_METADATA_FILE_MAGIC;
+	head->version   = ARROW_METADATA_FILE_VERSION;
+	head->fstate_sz = sizeof(RecordBatchFieldState);
+	head->nbatches  = list_length(rb_state_list);
+	head->nfields   = nfields;
+	head->ncols     = rbstate->ncols;
+	head->st_dev    = stat_buf->st_dev;
+	head->st_ino    = stat_buf->st_ino;
+	head->st_size   = stat_buf->st_size;
+	head->st_mtim   = stat_buf->st_mtim;
+	head->st_ctim   = stat_buf->st_ctim;
+
+	i = 0;
+	foreach (lc, rb_state_list)
+	{
+		arrowMetadataFileBatch *fbatch = (arrowMetadataFileBatch *)
+			(buffer + MAXALIGN(sizeof(arrowMetadataFileHead)) + unitsz * i++);
+
+		rbstate = lfirst(lc);
+		fbatch->rb_index  = rbstate->rb_index;
+		fbatch->rb_compression = rbstate->rb_compression;
+		fbatch->rb_offset = rbstate->rb_offset;
+		fbatch->rb_length = rbstate->rb_length;
+		fbatch->rb_nitems = rbstate->rb_nitems;
+		if (copyMetadataFieldCache(fbatch->fstate,
+								   fbatch->fstate + nfields,
+								   rbstate->ncols,
+								   rbstate->columns,
+								   NULL) != nfields)
+			goto skip;
+		/* pointers are saved as index of fstate[] */
+		for (j=0; j < nfields; j++)
+		{
+			RecordBatchFieldState *fstate = &fbatch->fstate[j];
+
+			if (fstate->children)
+				fstate->children = (RecordBatchFieldState *)
+					(uintptr_t)(fstate->children - fbatch->fstate);
+		}
+	}
+
+	/* write to the temporary file, then rename */
+	arrowMetadataFilePath(fpath, sizeof(fpath), stat_buf);
+	snprintf(tpath, sizeof(tpath), "%s.%d.tmp", fpath, MyProcPid);
+	fd = open(tpath, O_WRONLY | O_CREAT | O_TRUNC | PG_BINARY,
+			  S_IRUSR | S_IWUSR);
+	if (fd < 0)
+	{
+		elog(LOG, "arrow_fdw: could not create metadata cache file \"%s\": %m",
+			 tpath);
+		goto skip;
+	}
+	if (__writeFile(fd, buffer, length) != length)
+	{
+		elog(LOG, "arrow_fdw: could not write metadata cache file \"%s\": %m",
+			 tpath);
+		close(fd);
+		unlink(tpath);
+		goto skip;
+	}
+	close(fd);
+	if (rename(tpath, fpath) != 0)
+	{
+		elog(LOG, "arrow_fdw: could not rename \"%s\" to \"%s\": %m",
+			 tpath, fpath);
+		unlink(tpath);
+	}
+skip:
+	pfree(buffer);
+}
+
 /*
  * arrowLookupOrBuildMetadataCache
  */
@@ -5266,39 +7984,76 @@ retry:
 		arrowMetadataCache *mcache;
 		arrowStatsBinary *arrow_bstats;
 		List		   *rb_state_any = NIL;
+		int				rawfd = FileGetRawDesc(fdesc);
+		bool			has_flock = false;
+		ListCell	   *lc;
 
-		readArrowFileDesc(FileGetRawDesc(fdesc), &af_info);
-		if (af_info.dictionaries != NULL)
-			elog(ERROR, "DictionaryBatch is not supported");
-		Assert(af_info.footer._num_dictionaries == 0);
-
-		if (af_info.recordBatches == NULL)
-			elog(DEBUG2, "arrow file '%s' contains no RecordBatch",
-				 FilePathName(fdesc));
+		/*
+		 * External writers (like the fluentd plugin) append RecordBatches
+		 * and swap the Footer under the exclusive flock(2) on the file.
+		 * We take the shared flock during the metadata is built, to avoid
+		 * picking up the Footer in the half-written state. Cached metadata
+		 * is still valid on the concurrent appends, because the writers
+		 * never overwrite the RecordBatches referenced by the older Footer,
+		 * and newer st_mtime invalidates the cache on the next reference.
+		 */
+		for (;;)
+		{
+			if (flock(rawfd, LOCK_SH) == 0)
+			{
+				has_flock = true;
+				break;
+			}
+			if (errno != EINTR)
+			{
+				elog(DEBUG2, "failed on flock('%s'): %m", FilePathName(fdesc));
+				break;
+			}
+		}
+		if (fstat(rawfd, &stat_buf) != 0)
+			elog(ERROR, "failed on fstat('%s'): %m", FilePathName(fdesc));
 
-		arrow_bstats = buildArrowStatsBinary(&af_info.footer, p_stat_attrs);
-		for (index = 0; index < af_info.footer._num_recordBatches; index++)
+		/* try to load the persistent metadata cache file first */
+		rb_state_any = arrowLoadMetadataCacheFile(fdesc, &stat_buf,
+												  p_stat_attrs);
+		if (rb_state_any == NIL)
 		{
-			RecordBatchState *rb_state;
-			ArrowBlock       *block
-				= &af_info.footer.recordBatches[index];
-			ArrowRecordBatch *rbatch
-			   = &af_info.recordBatches[index].body.recordBatch;
+			readArrowFileDesc(FileGetRawDesc(fdesc), &af_info);
+			if (af_info.recordBatches == NULL)
+				elog(DEBUG2, "arrow file '%s' contains no RecordBatch",
+					 FilePathName(fdesc));
 
-			rb_state = makeRecordBatchState(&af_info.footer.schema,
-											block, rbatch);
-			rb_state->fdesc = fdesc;
-			memcpy(&rb_state->stat_buf, &stat_buf, sizeof(struct stat));
-			rb_state->rb_index = index;
+			arrow_bstats = buildArrowStatsBinary(&af_info.footer, p_stat_attrs);
+			for (index = 0; index < af_info.footer._num_recordBatches; index++)
+			{
+				RecordBatchState *rb_state;
+				ArrowBlock       *block
+					= &af_info.footer.recordBatches[index];
+				ArrowRecordBatch *rbatch
+					= &af_info.recordBatches[index].body.recordBatch;
+
+				rb_state = makeRecordBatchState(&af_info, block, rbatch);
+				rb_state->fdesc = fdesc;
+				memcpy(&rb_state->stat_buf, &stat_buf, sizeof(struct stat));
+				rb_state->rb_index = index;
+
+				if (arrow_bstats)
+					applyArrowStatsBinary(rb_state, arrow_bstats);
+				rb_state_any = lappend(rb_state_any, rb_state);
+			}
+			releaseArrowStatsBinary(arrow_bstats);
+			arrowSaveMetadataCacheFile(fdesc, &stat_buf, rb_state_any);
+		}
+		if (has_flock)
+			flock(rawfd, LOCK_UN);
 
-			if (arrow_bstats)
-				applyArrowStatsBinary(rb_state, arrow_bstats);
+		foreach (lc, rb_state_any)
+		{
+			RecordBatchState *rb_state = lfirst(lc);
 
 			if (checkArrowRecordBatchIsVisible(rb_state, mvcc_slot))
 				results = lappend(results, rb_state);
-			rb_state_any = lappend(rb_state_any, rb_state);
 		}
-		releaseArrowStatsBinary(arrow_bstats);
 		/* try to build a metadata cache for further references */
 		mcache = __arrowBuildMetadataCache(rb_state_any, key.hash);
 		if (mcache)
@@ -5383,6 +8138,7 @@ __setupArrowSQLbufferField(SQLtable *table,
 	const char	   *extname;
 	const char	   *extschema;
 	SQLstat		   *stat_list;
+	SQLbloom	   *bloom_list;
 
 	/* walk down to the base type, if domain */
 	for (;;)
@@ -5430,6 +8186,14 @@ __setupArrowSQLbufferField(SQLtable *table,
 			column->stat_enabled = true;
 			table->has_statistics = true;
 		}
+		/* also, existing bloom filter, if any */
+		bloom_list = __buildArrowFieldBloomList(afield, table->numRecordBatches);
+		if (bloom_list)
+		{
+			column->bloom_list = bloom_list;
+			column->bloom_enabled = true;
+			table->has_bloom_filters = true;
+		}
 	}
 	
 	if (OidIsValid(__type->typelem) && __type->typlen == -1)
@@ -5501,7 +8265,14 @@ setupArrowSQLbufferSchema(SQLtable *table, TupleDesc tupdesc,
 		ArrowField	   *afield = NULL;
 
 		if (af_info)
+		{
 			afield = &af_info->footer.schema.fields[j];
+			if (afield->dictionary)
+				ereport(ERROR,
+						(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+						 errmsg("arrow_fdw: unable to write out dictionary-encoded field '%s'",
+								afield->name)));
+		}
 		__setupArrowSQLbufferField(table,
 								   &table->columns[j],
 								   NameStr(attr->attname),
@@ -5708,35 +8479,194 @@ writeOutArrowRecordBatch(arrowWriteState *aw_state, bool with_footer)
 				 (uint32)mvcc->xid, (uint32)mvcc->cid, mvcc->record_batch,
 				 table->nitems);
 		}
-		if (with_footer)
-			writeArrowFooter(table);
-
-		/*
-		 * Invalidation of the metadata cache, if any
-		 *
-		 * NOTE: metadata cache shall be invalidated on the next reference,
-		 * if st_mtime of the file is newer than st_mtime of the mcache.
-		 * Linux kernel offers nanosecond precision in st_Xtime, but it never
-		 * guarantee the st_Xtime is recorded in nanosecond precision...
-		 */
-		arrowInvalidateMetadataCache(&aw_state->key, true);
-
-		LWLockRelease(&arrow_metadata_state->lock_slots[index]);
+		if (with_footer)
+			writeArrowFooter(table);
+
+		/*
+		 * Invalidation of the metadata cache, if any
+		 *
+		 * NOTE: metadata cache shall be invalidated on the next reference,
+		 * if st_mtime of the file is newer than st_mtime of the mcache.
+		 * Linux kernel offers nanosecond precision in st_Xtime, but it never
+		 * guarantee the st_Xtime is recorded in nanosecond precision...
+		 */
+		arrowInvalidateMetadataCache(&aw_state->key, true);
+
+		LWLockRelease(&arrow_metadata_state->lock_slots[index]);
+	}
+	PG_CATCH();
+	{
+		if (mvcc)
+			pfree(mvcc);
+		PG_RE_THROW();
+	}
+	PG_END_TRY();
+}
+
+/*
+ * __checkArrowPendingCompaction
+ *
+ * The compacted image replaces the arrow file at commit time, so any other
+ * modification on the file within the same transaction would be lost.
+ */
+static void
+__checkArrowPendingCompaction(const char *path_name)
+{
+	TransactionId curr_xid = GetCurrentTransactionId();
+	dlist_iter	iter;
+
+	dlist_foreach(iter, &arrow_write_redo_list)
+	{
+		arrowWriteRedoLog *redo = dlist_container(arrowWriteRedoLog,
+												  chain, iter.cur);
+		if (redo->xid == curr_xid &&
+			redo->is_compact &&
+			strcmp(redo->pathname, path_name) == 0)
+			ereport(ERROR,
+					(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+					 errmsg("arrow file \"%s\" is already compacted in this transaction", path_name)));
+	}
+}
+
+/*
+ * TRUNCATE support
+ */
+static void
+__arrowExecTruncateRelation(Relation frel)
+{
+	TupleDesc	tupdesc = RelationGetDescr(frel);
+	Oid			frel_oid = RelationGetRelid(frel);
+	ForeignTable *ft = GetForeignTable(frel_oid);
+	arrowWriteRedoLog *redo;
+	ArrowFileInfo af_info;
+	struct stat	stat_buf;
+	MetadataCacheKey key;
+	int			index;
+	List	   *filesList;
+	SQLtable   *table;
+	const char *path_name;
+	const char *dir_name;
+	const char *file_name;
+	size_t		main_sz;
+	int			fdesc = -1;
+	char		backup_path[MAXPGPATH];
+	bool		writable;
+
+	filesList = __arrowFdwExtractFilesList(ft->options,
+										   NULL,
+										   &writable,
+										   NULL);
+	if (!writable)
+		elog(ERROR, "arrow_fdw: foreign table \"%s\" is not writable",
+			 RelationGetRelationName(frel));
+	Assert(list_length(filesList) == 1);
+	path_name = strVal(linitial(filesList));
+	__checkArrowPendingCompaction(path_name);
+	readArrowFile(path_name, &af_info, false);
+	if (stat(path_name, &stat_buf) != 0)
+		elog(ERROR, "failed on stat('%s'): %m", path_name);
+	/* metadata cache invalidation */
+	index = initMetadataCacheKey(&key, &stat_buf);
+	LWLockAcquire(&arrow_metadata_state->lock_slots[index], LW_EXCLUSIVE);
+	arrowInvalidateMetadataCache(&key, true);
+	LWLockRelease(&arrow_metadata_state->lock_slots[index]);
+
+	/* build SQLtable to write out schema */
+	table = palloc0(offsetof(SQLtable, columns[tupdesc->natts]));
+	setupArrowSQLbufferSchema(table, tupdesc, &af_info);
+
+	/* create REDO log entry */
+	main_sz = MAXALIGN(offsetof(arrowWriteRedoLog, footer_backup));
+	redo = MemoryContextAllocZero(CacheMemoryContext,
+								  main_sz + strlen(path_name) + 1);
+	redo->xid    = GetCurrentTransactionId();
+	redo->cid    = GetCurrentCommandId(true);
+	redo->pathname = (char *)redo + main_sz;
+	strcpy(redo->pathname, path_name);
+	redo->is_truncate = true;
+
+	PG_TRY();
+	{
+		/*
+		 * move the current arrow file to the backup
+		 */
+		dir_name = dirname(pstrdup(path_name));
+		file_name = basename(pstrdup(path_name));
+		for (;;)
+		{
+			redo->suffix = random();
+			snprintf(backup_path, sizeof(backup_path),
+					 "%s/%s.%u.backup",
+					 dir_name, file_name, redo->suffix);
+			if (stat(backup_path, &stat_buf) != 0)
+			{
+				if (errno == ENOENT)
+					break;
+				elog(ERROR, "failed on stat('%s'): %m", backup_path);
+			}
+		}
+		if (rename(path_name, backup_path) != 0)
+			elog(ERROR, "failed on rename('%s','%s'): %m",
+				 path_name, backup_path);
+
+		/*
+		 * create an empty arrow file
+		 */
+		PG_TRY();
+		{
+			fdesc = open(path_name, O_RDWR | O_CREAT | O_EXCL, 0600);
+			if (fdesc < 0)
+				elog(ERROR, "failed on open('%s'): %m", path_name);
+			if (fstat(fdesc, &stat_buf) != 0)
+				elog(ERROR, "failed on fstat('%s'): %m", path_name);
+			initMetadataCacheKey(&redo->key, &stat_buf);
+			table->filename = path_name;
+			table->fdesc = fdesc;
+			arrowFileWrite(table, "ARROW1\0\0", 8);
+			writeArrowSchema(table);
+			writeArrowFooter(table);
+		}
+		PG_CATCH();
+		{
+			if (fdesc >= 0)
+				close(fdesc);
+			if (rename(backup_path, path_name) != 0)
+				elog(WARNING, "failed on rename('%s', '%s'): %m",
+					 backup_path, path_name);
+			PG_RE_THROW();
+		}
+		PG_END_TRY();
+		close(fdesc);
 	}
 	PG_CATCH();
 	{
-		if (mvcc)
-			pfree(mvcc);
+		pfree(redo);
 		PG_RE_THROW();
 	}
 	PG_END_TRY();
+	/* save the REDO log entry */
+	dlist_push_head(&arrow_write_redo_list, &redo->chain);
 }
 
 /*
- * TRUNCATE support
+ * COMPACT support
  */
 static void
-__arrowExecTruncateRelation(Relation frel)
+__resetArrowSQLfieldStats(SQLfield *column)
+{
+	int		j;
+
+	/* statistics are re-built according to the new record-batches */
+	column->stat_list = NULL;
+	column->bloom_list = NULL;
+	if (column->element)
+		__resetArrowSQLfieldStats(column->element);
+	for (j=0; j < column->nfields; j++)
+		__resetArrowSQLfieldStats(&column->subfields[j]);
+}
+
+static int64
+__arrowExecCompactRelation(Relation frel, size_t segment_sz)
 {
 	TupleDesc	tupdesc = RelationGetDescr(frel);
 	Oid			frel_oid = RelationGetRelid(frel);
@@ -5745,96 +8675,175 @@ __arrowExecTruncateRelation(Relation frel)
 	ArrowFileInfo af_info;
 	struct stat	stat_buf;
 	MetadataCacheKey key;
-	int			index;
 	List	   *filesList;
+	List	   *rb_cached;
+	ListCell   *lc;
 	SQLtable   *table;
+	Bitmapset  *referenced;
+	MemoryContext tuple_cxt;
+	MemoryContext oldcxt;
+	Datum	   *values;
+	bool	   *isnull;
 	const char *path_name;
 	const char *dir_name;
 	const char *file_name;
+	File		filp;
 	size_t		main_sz;
 	int			fdesc = -1;
-	char		backup_path[MAXPGPATH];
+	int			j, nwords;
+	int64		nrows = 0;
+	char		compact_path[MAXPGPATH];
 	bool		writable;
 
 	filesList = __arrowFdwExtractFilesList(ft->options,
 										   NULL,
-										   &writable);
+										   &writable,
+										   NULL);
 	if (!writable)
 		elog(ERROR, "arrow_fdw: foreign table \"%s\" is not writable",
 			 RelationGetRelationName(frel));
 	Assert(list_length(filesList) == 1);
 	path_name = strVal(linitial(filesList));
-	readArrowFile(path_name, &af_info, false);
-	if (stat(path_name, &stat_buf) != 0)
-		elog(ERROR, "failed on stat('%s'): %m", path_name);
-	/* metadata cache invalidation */
-	index = initMetadataCacheKey(&key, &stat_buf);
-	LWLockAcquire(&arrow_metadata_state->lock_slots[index], LW_EXCLUSIVE);
-	arrowInvalidateMetadataCache(&key, true);
-	LWLockRelease(&arrow_metadata_state->lock_slots[index]);
+	__checkArrowPendingCompaction(path_name);
 
-	/* build SQLtable to write out schema */
+	filp = PathNameOpenFile(path_name, O_RDONLY | PG_BINARY);
+	if (filp < 0)
+	{
+		if (errno == ENOENT)
+			return 0;		/* nothing to compact */
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not open file \"%s\": %m", path_name)));
+	}
+	if (fstat(FileGetRawDesc(filp), &stat_buf) != 0)
+		elog(ERROR, "failed on fstat('%s'): %m", path_name);
+	initMetadataCacheKey(&key, &stat_buf);
+	readArrowFileDesc(FileGetRawDesc(filp), &af_info);
+
+	/*
+	 * build SQLtable to write out; columns that have min/max statistics
+	 * or bloom-filter in the current file keep them in the new one.
+	 */
 	table = palloc0(offsetof(SQLtable, columns[tupdesc->natts]));
+	table->numRecordBatches = af_info.footer._num_recordBatches;
 	setupArrowSQLbufferSchema(table, tupdesc, &af_info);
+	table->numRecordBatches = 0;
+	for (j=0; j < tupdesc->natts; j++)
+		__resetArrowSQLfieldStats(&table->columns[j]);
+	table->segment_sz = segment_sz;
 
 	/* create REDO log entry */
 	main_sz = MAXALIGN(offsetof(arrowWriteRedoLog, footer_backup));
 	redo = MemoryContextAllocZero(CacheMemoryContext,
 								  main_sz + strlen(path_name) + 1);
+	memcpy(&redo->key, &key, sizeof(MetadataCacheKey));
 	redo->xid    = GetCurrentTransactionId();
 	redo->cid    = GetCurrentCommandId(true);
 	redo->pathname = (char *)redo + main_sz;
 	strcpy(redo->pathname, path_name);
-	redo->is_truncate = true;
+	redo->is_compact = true;
 
+	/* fetch all the attributes */
+	nwords = (tupdesc->natts - FirstLowInvalidHeapAttributeNumber +
+			  BITS_PER_BITMAPWORD - 1) / BITS_PER_BITMAPWORD;
+	referenced = alloca(offsetof(Bitmapset, words[nwords]));
+	referenced->nwords = nwords;
+	memset(referenced->words, -1, sizeof(bitmapword) * nwords);
+	values = palloc(sizeof(Datum) * tupdesc->natts);
+	isnull = palloc(sizeof(bool)  * tupdesc->natts);
+	tuple_cxt = AllocSetContextCreate(CurrentMemoryContext,
+									  "arrow_fdw compaction",
+									  ALLOCSET_DEFAULT_SIZES);
 	PG_TRY();
 	{
 		/*
-		 * move the current arrow file to the backup
+		 * create a new arrow file next to the current one; it shall
+		 * replace the current file by rename(2) on commit.
 		 */
 		dir_name = dirname(pstrdup(path_name));
 		file_name = basename(pstrdup(path_name));
 		for (;;)
 		{
 			redo->suffix = random();
-			snprintf(backup_path, sizeof(backup_path),
-					 "%s/%s.%u.backup",
+			snprintf(compact_path, sizeof(compact_path),
+					 "%s/%s.%u.compact",
 					 dir_name, file_name, redo->suffix);
-			if (stat(backup_path, &stat_buf) != 0)
-			{
-				if (errno == ENOENT)
-					break;
-				elog(ERROR, "failed on stat('%s'): %m", backup_path);
-			}
+			fdesc = open(compact_path, O_RDWR | O_CREAT | O_EXCL, 0600);
+			if (fdesc >= 0)
+				break;
+			if (errno != EEXIST)
+				elog(ERROR, "failed on open('%s'): %m", compact_path);
 		}
-		if (rename(path_name, backup_path) != 0)
-			elog(ERROR, "failed on rename('%s','%s'): %m",
-				 path_name, backup_path);
 
-		/*
-		 * create an empty arrow file
-		 */
 		PG_TRY();
 		{
-			fdesc = open(path_name, O_RDWR | O_CREAT | O_EXCL, 0600);
-			if (fdesc < 0)
-				elog(ERROR, "failed on open('%s'): %m", path_name);
-			if (fstat(fdesc, &stat_buf) != 0)
-				elog(ERROR, "failed on fstat('%s'): %m", path_name);
-			initMetadataCacheKey(&redo->key, &stat_buf);
-			table->filename = path_name;
+			table->filename = compact_path;
 			table->fdesc = fdesc;
 			arrowFileWrite(table, "ARROW1\0\0", 8);
 			writeArrowSchema(table);
+
+			rb_cached = arrowLookupOrBuildMetadataCache(filp, NULL);
+			foreach (lc, rb_cached)
+			{
+				RecordBatchState *rb_state = lfirst(lc);
+				pgstrom_data_store *pds;
+				size_t		comp_sz;
+				size_t		raw_sz;
+				size_t		i;
+
+				if (!arrowSchemaCompatibilityCheck(tupdesc, rb_state))
+					elog(ERROR, "arrow file '%s' on behalf of foreign table '%s' has incompatible schema definition",
+						 path_name, RelationGetRelationName(frel));
+				if (rb_state->rb_nitems == 0)
+					continue;
+				pds = __arrowFdwLoadRecordBatch(rb_state,
+												frel,
+												referenced,
+												NULL,
+												CurrentMemoryContext,
+												NULL,
+												false,
+												&comp_sz,
+												&raw_sz);
+				for (i=0; i < pds->kds.nitems; i++)
+				{
+					oldcxt = MemoryContextSwitchTo(tuple_cxt);
+					for (j=0; j < pds->kds.ncols; j++)
+						pg_datum_arrow_ref(&pds->kds,
+										   &pds->kds.colmeta[j],
+										   i,
+										   values + j,
+										   isnull + j);
+					MemoryContextSwitchTo(oldcxt);
+
+					table->usage = __arrowPutTupleValues(table, tupdesc,
+														 values, isnull);
+					table->nitems++;
+					if (table->usage > table->segment_sz)
+					{
+						writeArrowRecordBatch(table);
+						sql_table_clear(table);
+					}
+					MemoryContextReset(tuple_cxt);
+					nrows++;
+				}
+				PDS_release(pds);
+				CHECK_FOR_INTERRUPTS();
+			}
+			if (table->nitems > 0)
+			{
+				writeArrowRecordBatch(table);
+				sql_table_clear(table);
+			}
 			writeArrowFooter(table);
+			if (pg_fsync(fdesc) != 0)
+				elog(ERROR, "failed on fsync('%s'): %m", compact_path);
 		}
 		PG_CATCH();
 		{
-			if (fdesc >= 0)
-				close(fdesc);
-			if (rename(backup_path, path_name) != 0)
-				elog(WARNING, "failed on rename('%s', '%s'): %m",
-					 backup_path, path_name);
+			close(fdesc);
+			if (unlink(compact_path) != 0)
+				elog(WARNING, "failed on unlink('%s'): %m", compact_path);
 			PG_RE_THROW();
 		}
 		PG_END_TRY();
@@ -5846,9 +8855,99 @@ __arrowExecTruncateRelation(Relation frel)
 		PG_RE_THROW();
 	}
 	PG_END_TRY();
+	MemoryContextDelete(tuple_cxt);
+	FileClose(filp);
+
+	elog(DEBUG2, "arrow: compaction of '%s' into '%s' (%ld rows, %u record-batches)",
+		 path_name, compact_path, nrows, table->numRecordBatches);
 	/* save the REDO log entry */
 	dlist_push_head(&arrow_write_redo_list, &redo->chain);
+
+	return nrows;
+}
+
+/*
+ * pgstrom_arrow_fdw_compact
+ */
+Datum
+pgstrom_arrow_fdw_compact(PG_FUNCTION_ARGS)
+{
+	Oid			frel_oid;
+	Relation	frel;
+	FdwRoutine *routine;
+	size_t		segment_sz;
+	int64		nrows;
+
+	if (PG_ARGISNULL(0))
+		PG_RETURN_NULL();
+	frel_oid = PG_GETARG_OID(0);
+	if (PG_ARGISNULL(1))
+		segment_sz = (size_t)arrow_record_batch_size_kb << 10;
+	else
+	{
+		int32	batch_sz_kb = PG_GETARG_INT32(1);
+
+		/* same range as arrow_fdw.record_batch_size */
+		if (batch_sz_kb < 4 * 1024 || batch_sz_kb > 2048 * 1024)
+			ereport(ERROR,
+					(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+					 errmsg("target record-batch size (%dkB) is out of range [4MB...2GB]",
+							batch_sz_kb)));
+		segment_sz = (size_t)batch_sz_kb << 10;
+	}
+	/*
+	 * ShareRowExclusiveLock blocks concurrent INSERT, TRUNCATE and any
+	 * other compaction, but readers can run concurrently; they continue
+	 * to reference the current file until the new one replaces it.
+	 */
+	frel = table_open(frel_oid, ShareRowExclusiveLock);
+	if (frel->rd_rel->relkind != RELKIND_FOREIGN_TABLE)
+		ereport(ERROR,
+				(errcode(ERRCODE_WRONG_OBJECT_TYPE),
+				 errmsg("\"%s\" is not arrow_fdw foreign table",
+						RelationGetRelationName(frel))));
+	routine = GetFdwRoutineForRelation(frel, false);
+	if (memcmp(routine, &pgstrom_arrow_fdw_routine, sizeof(FdwRoutine)) != 0)
+		ereport(ERROR,
+				(errcode(ERRCODE_WRONG_OBJECT_TYPE),
+				 errmsg("\"%s\" is not arrow_fdw foreign table",
+						RelationGetRelationName(frel))));
+	nrows = __arrowExecCompactRelation(frel, segment_sz);
+
+	table_close(frel, NoLock);
+
+	PG_RETURN_INT64(nrows);
+}
+PG_FUNCTION_INFO_V1(pgstrom_arrow_fdw_compact);
+
+/*
+ * pgstrom_arrow_fdw_reset_consumer
+ *
+ * It forgets RecordBatches consumed by the supplied consumer, or all the
+ * consumers if NULL, so the next scan reads the arrow files from the head.
+ */
+Datum
+pgstrom_arrow_fdw_reset_consumer(PG_FUNCTION_ARGS)
+{
+	char	   *name = NULL;
+	HASH_SEQ_STATUS hseq;
+	arrowConsumerEntry *entry;
+
+	if (!PG_ARGISNULL(0))
+		name = text_to_cstring(PG_GETARG_TEXT_PP(0));
+	if (arrow_consumer_htab)
+	{
+		hash_seq_init(&hseq, arrow_consumer_htab);
+		while ((entry = hash_seq_search(&hseq)) != NULL)
+		{
+			if (!name || strncmp(entry->key.name, name, NAMEDATALEN - 1) == 0)
+				hash_search(arrow_consumer_htab, &entry->key,
+							HASH_REMOVE, NULL);
+		}
+	}
+	PG_RETURN_VOID();
 }
+PG_FUNCTION_INFO_V1(pgstrom_arrow_fdw_reset_consumer);
 
 #if PG_VERSION_NUM >= 140000
 /*
@@ -5901,6 +9000,162 @@ pgstrom_arrow_fdw_truncate(PG_FUNCTION_ARGS)
 }
 PG_FUNCTION_INFO_V1(pgstrom_arrow_fdw_truncate);
 
+/*
+ * pgstrom_arrow_ipc_stream
+ *
+ * It runs the supplied query, then returns the results as a series of
+ * Apache Arrow IPC stream messages; Schema, RecordBatch..., and EOS.
+ * Concatenation of the returned bytea chunks is a valid IPC stream, so
+ * clients can read the query results without per-datum deserialization.
+ * Messages are built by arrow_write.c on a temporary file, then read back
+ * for each record-batch.
+ */
+static void
+__arrowIpcStreamFlush(SQLtable *table,
+					  Tuplestorestate *tupstore, TupleDesc rs_tupdesc)
+{
+	bytea	   *chunk;
+	Datum		value;
+	bool		isnull = false;
+
+	if (table->f_pos == 0)
+		return;
+	chunk = palloc(VARHDRSZ + table->f_pos);
+	if (__preadFile(table->fdesc, VARDATA(chunk),
+					table->f_pos, 0) != table->f_pos)
+		elog(ERROR, "failed on pread('%s'): %m", table->filename);
+	SET_VARSIZE(chunk, VARHDRSZ + table->f_pos);
+	value = PointerGetDatum(chunk);
+	tuplestore_putvalues(tupstore, rs_tupdesc, &value, &isnull);
+	pfree(chunk);
+	/* rewind the temporary file for the next message */
+	table->f_pos = 0;
+}
+
+Datum
+pgstrom_arrow_ipc_stream(PG_FUNCTION_ARGS)
+{
+	ReturnSetInfo  *rsinfo = (ReturnSetInfo *) fcinfo->resultinfo;
+	char		   *query;
+	size_t			segment_sz;
+	TupleDesc		rs_tupdesc;
+	TupleDesc		tupdesc;
+	Tuplestorestate *tupstore;
+	MemoryContext	oldcxt;
+	MemoryContext	tuple_cxt;
+	SPIPlanPtr		plan;
+	Portal			portal;
+	SQLtable	   *table;
+	File			filp;
+	Datum		   *values;
+	bool		   *isnull;
+	uint64_t		eos = 0x00000000ffffffffUL;
+	uint64			i;
+	int				j;
+
+	if (PG_ARGISNULL(0))
+		PG_RETURN_NULL();
+	query = text_to_cstring(PG_GETARG_TEXT_PP(0));
+	if (PG_ARGISNULL(1))
+		segment_sz = (size_t)arrow_record_batch_size_kb << 10;
+	else
+	{
+		int32	kb_sz = PG_GETARG_INT32(1);
+
+		if (kb_sz < 4 || kb_sz > 2097151)
+			elog(ERROR, "record batch size is out of range");
+		segment_sz = (size_t)kb_sz << 10;
+	}
+	if (!rsinfo || !IsA(rsinfo, ReturnSetInfo) ||
+		(rsinfo->allowedModes & SFRM_Materialize) == 0)
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("set-valued function called in context that cannot accept a set")));
+
+	/* setup result set in the per-query memory */
+	oldcxt = MemoryContextSwitchTo(rsinfo->econtext->ecxt_per_query_memory);
+	rs_tupdesc = CreateTemplateTupleDesc(1);
+	TupleDescInitEntry(rs_tupdesc, 1, "chunk", BYTEAOID, -1, 0);
+	tupstore = tuplestore_begin_heap(true, false, work_mem);
+	rsinfo->returnMode = SFRM_Materialize;
+	rsinfo->setResult = tupstore;
+	rsinfo->setDesc = rs_tupdesc;
+	MemoryContextSwitchTo(oldcxt);
+
+	if (SPI_connect() != SPI_OK_CONNECT)
+		elog(ERROR, "failed on SPI_connect");
+	plan = SPI_prepare(query, 0, NULL);
+	if (!plan)
+		elog(ERROR, "failed on SPI_prepare: %s",
+			 SPI_result_code_string(SPI_result));
+	if (!SPI_is_cursor_plan(plan))
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("query must return tuples: %s", query)));
+	portal = SPI_cursor_open(NULL, plan, NULL, NULL, true);
+	tupdesc = portal->tupDesc;
+
+	/* build SQLtable on the temporary file */
+	table = palloc0(offsetof(SQLtable, columns[tupdesc->natts]));
+	setupArrowSQLbufferSchema(table, tupdesc, NULL);
+	table->segment_sz = segment_sz;
+	filp = OpenTemporaryFile(false);
+	table->filename = FilePathName(filp);
+	table->fdesc = FileGetRawDesc(filp);
+
+	values = palloc(sizeof(Datum) * tupdesc->natts);
+	isnull = palloc(sizeof(bool)  * tupdesc->natts);
+	tuple_cxt = AllocSetContextCreate(CurrentMemoryContext,
+									  "arrow ipc stream",
+									  ALLOCSET_DEFAULT_SIZES);
+	writeArrowSchema(table);
+	__arrowIpcStreamFlush(table, tupstore, rs_tupdesc);
+	for (;;)
+	{
+		SPI_cursor_fetch(portal, true, 10000);
+		if (SPI_processed == 0)
+			break;
+		for (i=0; i < SPI_processed; i++)
+		{
+			oldcxt = MemoryContextSwitchTo(tuple_cxt);
+			heap_deform_tuple(SPI_tuptable->vals[i], tupdesc, values, isnull);
+			for (j=0; j < tupdesc->natts; j++)
+			{
+				if (!isnull[j] && tupleDescAttr(tupdesc, j)->attlen == -1)
+					values[j] = PointerGetDatum(PG_DETOAST_DATUM_PACKED(values[j]));
+			}
+			MemoryContextSwitchTo(oldcxt);
+
+			table->usage = __arrowPutTupleValues(table, tupdesc,
+												 values, isnull);
+			table->nitems++;
+			if (table->usage > table->segment_sz)
+			{
+				writeArrowRecordBatch(table);
+				sql_table_clear(table);
+				__arrowIpcStreamFlush(table, tupstore, rs_tupdesc);
+			}
+			MemoryContextReset(tuple_cxt);
+		}
+		SPI_freetuptable(SPI_tuptable);
+		CHECK_FOR_INTERRUPTS();
+	}
+	if (table->nitems > 0)
+	{
+		writeArrowRecordBatch(table);
+		sql_table_clear(table);
+	}
+	arrowFileWrite(table, (const char *)&eos, sizeof(uint64_t));
+	__arrowIpcStreamFlush(table, tupstore, rs_tupdesc);
+
+	FileClose(filp);
+	SPI_cursor_close(portal);
+	SPI_finish();
+
+	return (Datum) 0;
+}
+PG_FUNCTION_INFO_V1(pgstrom_arrow_ipc_stream);
+
 static void
 __applyArrowTruncateRedoLog(arrowWriteRedoLog *redo, bool is_commit)
 {
@@ -5932,6 +9187,37 @@ __applyArrowTruncateRedoLog(arrowWriteRedoLog *redo, bool is_commit)
 	}
 }
 
+static void
+__applyArrowCompactRedoLog(arrowWriteRedoLog *redo, bool is_commit)
+{
+	char		compact[MAXPGPATH];
+
+	snprintf(compact, MAXPGPATH, "%s.%u.compact",
+			 redo->pathname, redo->suffix);
+	if (is_commit)
+	{
+		elog(DEBUG2, "arrow-redo: rename [%s]->[%s]", compact, redo->pathname);
+		if (rename(compact, redo->pathname) != 0)
+			ereport(WARNING,
+					(errcode_for_file_access(),
+					 errmsg("could not replace \"%s\" by the compacted file: %m",
+							redo->pathname),
+					 errhint("remove the \"%s\" manually", compact)));
+		/* readers shall open the new file on the next reference */
+		arrowInvalidateMetadataCache(&redo->key, true);
+	}
+	else
+	{
+		elog(DEBUG2, "arrow-redo: unlink [%s]", compact);
+		if (unlink(compact) != 0)
+			ereport(WARNING,
+					(errcode_for_file_access(),
+					 errmsg("could not remove compacted file \"%s\": %m",
+							compact),
+					 errhint("remove the \"%s\" manually", compact)));
+	}
+}
+
 static void
 __applyArrowInsertRedoLog(arrowWriteRedoLog *redo, bool is_commit)
 {
@@ -6053,6 +9339,8 @@ __arrowFdwXactCallback(TransactionId curr_xid, bool is_commit)
 		}
 		if (redo->is_truncate)
 			__applyArrowTruncateRedoLog(redo, is_commit);
+		else if (redo->is_compact)
+			__applyArrowCompactRedoLog(redo, is_commit);
 		else
 			__applyArrowInsertRedoLog(redo, is_commit);
 
@@ -6120,6 +9408,9 @@ pgstrom_startup_arrow_fdw(void)
 			dlist_init(&arrow_metadata_state->hash_slots[i]);
 			dlist_init(&arrow_metadata_state->mvcc_slots[i]);
 		}
+		SpinLockInit(&arrow_metadata_state->sync_lock);
+		memset(arrow_metadata_state->sync_items, 0,
+			   sizeof(arrow_metadata_state->sync_items));
 	}
 }
 
@@ -6162,6 +9453,10 @@ pgstrom_init_arrow_fdw(void)
 	r->BeginForeignModify			= ArrowBeginForeignModify;
 	r->ExecForeignInsert			= ArrowExecForeignInsert;
 	r->EndForeignModify				= ArrowEndForeignModify;
+#if PG_VERSION_NUM >= 140000
+	r->GetForeignModifyBatchSize	= ArrowGetForeignModifyBatchSize;
+	r->ExecForeignBatchInsert		= ArrowExecForeignBatchInsert;
+#endif
 #if PG_VERSION_NUM >= 110000
 	r->BeginForeignInsert			= ArrowBeginForeignInsert;
 	r->EndForeignInsert				= ArrowEndForeignInsert;
@@ -6219,6 +9514,93 @@ pgstrom_init_arrow_fdw(void)
 							GUC_NOT_IN_SAMPLE | GUC_UNIT_KB,
 							NULL, NULL, NULL);
 
+	/*
+	 * Threshold of the gap to consolidate i/o chunks
+	 */
+	DefineCustomIntVariable("arrow_fdw.io_merge_gap",
+							"maximum gap between column buffers to be read in a single i/o",
+							NULL,
+							&arrow_io_merge_gap_kb,
+							128,		/* 128kB */
+							0,
+							64 * 1024,	/* 64MB */
+							PGC_USERSET,
+							GUC_NOT_IN_SAMPLE | GUC_UNIT_KB,
+							NULL, NULL, NULL);
+
+	/*
+	 * Number of concurrent reads to load a RecordBatch
+	 */
+	DefineCustomIntVariable("arrow_fdw.io_parallelism",
+							"number of concurrent reads to load a RecordBatch",
+							NULL,
+							&arrow_io_parallelism,
+							1,
+							1,
+							64,
+							PGC_USERSET,
+							GUC_NOT_IN_SAMPLE,
+							NULL, NULL, NULL);
+
+	/*
+	 * Turn on/off late materialization of CPU scan
+	 */
+	DefineCustomBoolVariable("arrow_fdw.late_materialization",
+							 "Enables to load columns not referenced by quals after the filtering",
+							 NULL,
+							 &arrow_late_materialization,
+							 true,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+
+	/*
+	 * Number of RecordBatches to be read-ahead
+	 */
+	DefineCustomBoolVariable("arrow_fdw.sync_scan",
+							 "Enables synchronized scan on arrow files with the concurrent scans",
+							 NULL,
+							 &arrow_sync_scan_enabled,
+							 true,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+
+	/*
+	 * Name of the consumer for incremental scan
+	 */
+	DefineCustomStringVariable("arrow_fdw.consumer",
+							   "name of the consumer to scan only RecordBatches appended since the last scan",
+							   NULL,
+							   &arrow_fdw_consumer,
+							   "",
+							   PGC_USERSET,
+							   GUC_NOT_IN_SAMPLE,
+							   NULL, NULL, NULL);
+
+	DefineCustomIntVariable("arrow_fdw.readahead_batches",
+							"number of RecordBatches to be read-ahead",
+							NULL,
+							&arrow_readahead_batches,
+							2,
+							0,
+							64,
+							PGC_USERSET,
+							GUC_NOT_IN_SAMPLE,
+							NULL, NULL, NULL);
+
+	/*
+	 * Directory for persistent metadata cache files
+	 */
+	DefineCustomStringVariable("arrow_fdw.metadata_cache_dir",
+							   "directory to store metadata cache files of arrow files",
+							   NULL,
+							   &arrow_metadata_cache_dir,
+							   NULL,
+							   PGC_SIGHUP,
+							   GUC_NOT_IN_SAMPLE,
+							   NULL, NULL, NULL);
+
 	/* shared memory size */
 	RequestAddinShmemSpace(MAXALIGN(sizeof(arrowMetadataState)));
 	shmem_startup_next = shmem_startup_hook;
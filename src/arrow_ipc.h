@@ -68,6 +68,7 @@ typedef struct SQLtable			SQLtable;
 typedef struct SQLfield			SQLfield;
 typedef struct SQLdictionary	SQLdictionary;
 typedef struct SQLstat			SQLstat;
+typedef struct SQLbloom			SQLbloom;
 typedef union  SQLstat__datum	SQLstat__datum;
 typedef union  SQLtype			SQLtype;
 typedef struct SQLtype__pgsql	SQLtype__pgsql;
@@ -135,6 +136,75 @@ struct SQLstat
 	SQLstat__datum	max;
 };
 
+/*
+ * Bloom filter per record-batch
+ *
+ * It is embedded to the custom-metadata "bloom_filters" of the Field, as
+ * a comma separated list of hex strings (or "null"). The bit-positions are
+ * determined by the FNV-1a hash of the datum in Apache Arrow representation
+ * (little-endian value for fixed-length types, or raw bytes for Utf8/Binary),
+ * so arrow_fdw can check the filter without any type specific hash function.
+ */
+#define ARROW_BLOOM_NBITS		1024
+#define ARROW_BLOOM_NWORDS		(ARROW_BLOOM_NBITS / 64)
+#define ARROW_BLOOM_NHASHES		3
+
+struct SQLbloom
+{
+	SQLbloom	   *next;
+	int				rb_index;	/* record-batch index */
+	bool			is_valid;	/* true, if one or more values are added */
+	uint64_t		bits[ARROW_BLOOM_NWORDS];
+};
+
+static inline uint64_t
+__sql_bloom_hash(const void *addr, size_t len)
+{
+	const unsigned char *pos = (const unsigned char *)addr;
+	uint64_t	hash = 0xcbf29ce484222325UL;	/* FNV-1a offset basis */
+
+	while (len-- > 0)
+	{
+		hash ^= *pos++;
+		hash *= 0x100000001b3UL;				/* FNV-1a prime */
+	}
+	return hash;
+}
+
+static inline void
+sql_bloom_add(uint64_t *bits, const void *addr, size_t len)
+{
+	uint64_t	hash = __sql_bloom_hash(addr, len);
+	uint32_t	h1 = (uint32_t)(hash & 0xffffffffU);
+	uint32_t	h2 = (uint32_t)(hash >> 32);
+	int			k;
+
+	for (k=0; k < ARROW_BLOOM_NHASHES; k++)
+	{
+		uint32_t	pos = (h1 + k * h2) % ARROW_BLOOM_NBITS;
+
+		bits[pos / 64] |= (1UL << (pos % 64));
+	}
+}
+
+static inline bool
+sql_bloom_check(const uint64_t *bits, const void *addr, size_t len)
+{
+	uint64_t	hash = __sql_bloom_hash(addr, len);
+	uint32_t	h1 = (uint32_t)(hash & 0xffffffffU);
+	uint32_t	h2 = (uint32_t)(hash >> 32);
+	int			k;
+
+	for (k=0; k < ARROW_BLOOM_NHASHES; k++)
+	{
+		uint32_t	pos = (h1 + k * h2) % ARROW_BLOOM_NBITS;
+
+		if ((bits[pos / 64] & (1UL << (pos % 64))) == 0)
+			return false;
+	}
+	return true;
+}
+
 struct SQLfield
 {
 	char	   *field_name;		/* name of the column, element or sub-field */
@@ -160,15 +230,24 @@ struct SQLfield
 	bool		stat_enabled;
 	SQLstat		stat_datum;
 	SQLstat	   *stat_list;
+	/* bloom filter */
+	bool		bloom_enabled;
+	SQLbloom	bloom_datum;
+	SQLbloom   *bloom_list;
 	/* custom metadata(optional) */
 	ArrowKeyValue *customMetadata;
 	int			numCustomMetadata;
 };
 
+extern void		sql_field_bloom_update(SQLfield *column);
+
 static inline size_t
 sql_field_put_value(SQLfield *column, const char *addr, int sz)
 {
-	return (column->__curr_usage__ = column->put_value(column, addr, sz));
+	column->__curr_usage__ = column->put_value(column, addr, sz);
+	if (column->bloom_enabled && addr != NULL)
+		sql_field_bloom_update(column);
+	return column->__curr_usage__;
 }
 
 #ifndef FLEXIBLE_ARRAY_MEMBER
@@ -198,6 +277,9 @@ struct SQLtable
 	size_t		nitems;			/* number of items */
 	int			nfields;		/* number of attributes */
 	bool		has_statistics;	/* one or more columns enable min/max statistics */
+	bool		has_bloom_filters; /* one or more columns enable bloom filter */
+	int			write_nthreads;	/* # of threads to write out a record batch
+								 * (not used in the PostgreSQL backend) */
 	SQLfield columns[FLEXIBLE_ARRAY_MEMBER];
 };
 
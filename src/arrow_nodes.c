@@ -1913,6 +1913,8 @@ readArrowFooter(ArrowFooter *node, const char *pos)
 #define ARROW_FILE_HEAD_SIGNATURE_SZ	(sizeof(ARROW_FILE_HEAD_SIGNATURE) - 1)
 #define ARROW_FILE_TAIL_SIGNATURE		"ARROW1"
 #define ARROW_FILE_TAIL_SIGNATURE_SZ	(sizeof(ARROW_FILE_TAIL_SIGNATURE) - 1)
+#define PARQUET_FILE_SIGNATURE			"PAR1"
+#define PARQUET_FILE_SIGNATURE_SZ		(sizeof(PARQUET_FILE_SIGNATURE) - 1)
 
 #ifdef __PGSTROM_MODULE__
 #include "pg_strom.h"
@@ -1948,7 +1950,18 @@ readArrowFileDesc(int fdesc, ArrowFileInfo *af_info)
 	mmap_tail = mmap_head + file_sz - ARROW_FILE_TAIL_SIGNATURE_SZ;
 
 	/* check signature */
-	if (memcmp(mmap_head,
+	if (file_sz >= 2 * PARQUET_FILE_SIGNATURE_SZ &&
+		memcmp(mmap_head,
+			   PARQUET_FILE_SIGNATURE,
+			   PARQUET_FILE_SIGNATURE_SZ) == 0 &&
+		memcmp(mmap_head + file_sz - PARQUET_FILE_SIGNATURE_SZ,
+			   PARQUET_FILE_SIGNATURE,
+			   PARQUET_FILE_SIGNATURE_SZ) == 0)
+	{
+		Elog("Apache Parquet file is not supported, convert it to Apache Arrow file");
+	}
+	if (file_sz < ARROW_FILE_HEAD_SIGNATURE_SZ + ARROW_FILE_TAIL_SIGNATURE_SZ ||
+		memcmp(mmap_head,
 			   ARROW_FILE_HEAD_SIGNATURE,
 			   ARROW_FILE_HEAD_SIGNATURE_SZ) != 0 ||
 		memcmp(mmap_tail,
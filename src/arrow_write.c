@@ -13,6 +13,9 @@
 #include "postgres.h"
 #endif
 #include <limits.h>
+#ifndef __PGSTROM_MODULE__
+#include <pthread.h>
+#endif
 #include "arrow_ipc.h"
 
 /* alignment macros, if not */
@@ -31,6 +34,11 @@
 #ifndef ARROWALIGN
 #define ARROWALIGN(x)	TYPEALIGN(64,(x))
 #endif
+#ifndef PAGE_ALIGN
+#define PAGE_ALIGN(x)	TYPEALIGN(4096,(x))
+#endif
+/* minimum length per thread to write out a record-batch in parallel */
+#define ARROW_PARALLEL_WRITE_MINSZ		(4UL << 20)
 
 typedef struct
 {
@@ -869,45 +877,187 @@ arrowFileWrite(SQLtable *table, const char *buffer, ssize_t length)
 	table->f_pos += length;
 }
 
-void
-arrowFileWriteIOV(SQLtable *table)
+/*
+ * __arrowFileWriteIOVChunk
+ *
+ * It writes out the iovec array at the f_pos, then returns 0 on success,
+ * or errno on failure. It never raises an error by itself, because it may
+ * run on the worker threads.
+ */
+static int
+__arrowFileWriteIOVChunk(int fdesc, struct iovec *iov, int iov_cnt,
+						 off_t f_pos)
 {
 	int			index = 0;
 	ssize_t		nbytes;
 
-	while (index < table->__iov_cnt)
+	while (index < iov_cnt)
 	{
-		int		__iov_cnt = table->__iov_cnt - index;
+		int		__iov_cnt = iov_cnt - index;
 
-		nbytes = pwritev(table->fdesc,
-						 table->__iov + index,
+		nbytes = pwritev(fdesc,
+						 iov + index,
 						 __iov_cnt < IOV_MAX ? __iov_cnt : IOV_MAX,
-						 table->f_pos);
+						 f_pos);
 		if (nbytes < 0)
 		{
 			if (errno == EINTR)
 				continue;
-			Elog("failed on pwritev('%s'): %m", table->filename);
+			return errno;
 		}
 		else if (nbytes == 0)
 		{
-			Elog("unable to write on '%s' any more", table->filename);
+			return ENOSPC;
 		}
 
-		table->f_pos += nbytes;
-		while (index < table->__iov_cnt &&
-			   nbytes >= table->__iov[index].iov_len)
+		f_pos += nbytes;
+		while (index < iov_cnt &&
+			   nbytes >= iov[index].iov_len)
 		{
-			nbytes -= table->__iov[index++].iov_len;
+			nbytes -= iov[index++].iov_len;
 		}
-		assert(index < table->__iov_cnt || nbytes == 0);
+		assert(index < iov_cnt || nbytes == 0);
 		if (nbytes > 0)
 		{
-			table->__iov[index].iov_len -= nbytes;
-			table->__iov[index].iov_base =
-				((char *)table->__iov[index].iov_base + nbytes);
+			iov[index].iov_len -= nbytes;
+			iov[index].iov_base = ((char *)iov[index].iov_base + nbytes);
+		}
+	}
+	return 0;
+}
+
+#ifndef __PGSTROM_MODULE__
+/*
+ * __arrowFileWriteIOVParallel
+ *
+ * It splits the iovec array into the (almost) same length chunks, then
+ * writes them out by multiple threads concurrently. Because each chunk
+ * has its own file position, no coordination is needed between threads.
+ * PostgreSQL backend never uses this path, so arrow_fdw is not affected.
+ */
+typedef struct
+{
+	pthread_t	thread;
+	int			fdesc;
+	off_t		f_pos;
+	struct iovec *iov;
+	int			iov_cnt;
+	int			errcode;
+} arrowFileWriteWorker;
+
+static void *
+__arrowFileWriteWorkerMain(void *__priv)
+{
+	arrowFileWriteWorker *worker = __priv;
+
+	worker->errcode = __arrowFileWriteIOVChunk(worker->fdesc,
+											   worker->iov,
+											   worker->iov_cnt,
+											   worker->f_pos);
+	return NULL;
+}
+
+static bool
+__arrowFileWriteIOVParallel(SQLtable *table)
+{
+	arrowFileWriteWorker *workers;
+	struct iovec *iov_array;
+	size_t		total_sz = 0;
+	size_t		chunk_sz;
+	size_t		remain;
+	off_t		f_pos = table->f_pos;
+	int			nthreads = table->write_nthreads;
+	int			i, k, nworkers = 0;
+
+	for (i=0; i < table->__iov_cnt; i++)
+		total_sz += table->__iov[i].iov_len;
+	if (total_sz < ARROW_PARALLEL_WRITE_MINSZ * nthreads)
+		return false;	/* too small to parallelize */
+	chunk_sz = PAGE_ALIGN((total_sz + nthreads - 1) / nthreads);
+
+	/* split iovec; each split adds one more entry at most */
+	workers = palloc0(sizeof(arrowFileWriteWorker) * nthreads);
+	iov_array = palloc(sizeof(struct iovec) * (table->__iov_cnt + nthreads));
+	for (i=0, k=0; i < table->__iov_cnt && nworkers < nthreads; nworkers++)
+	{
+		arrowFileWriteWorker *worker = &workers[nworkers];
+
+		worker->fdesc = table->fdesc;
+		worker->f_pos = f_pos;
+		worker->iov = iov_array + k;
+		remain = (nworkers == nthreads - 1 ? total_sz : chunk_sz);
+		while (i < table->__iov_cnt && remain > 0)
+		{
+			struct iovec *src = &table->__iov[i];
+			struct iovec *dst = &iov_array[k++];
+
+			dst->iov_base = src->iov_base;
+			if (src->iov_len <= remain)
+			{
+				dst->iov_len = src->iov_len;
+				i++;
+			}
+			else
+			{
+				/* split this iovec into two chunks */
+				dst->iov_len = remain;
+				src->iov_base = (char *)src->iov_base + remain;
+				src->iov_len -= remain;
+			}
+			remain -= dst->iov_len;
+			f_pos += dst->iov_len;
+			total_sz -= dst->iov_len;
+			worker->iov_cnt++;
 		}
 	}
+	assert(i == table->__iov_cnt && total_sz == 0);
+
+	for (i=0; i < nworkers; i++)
+	{
+		if ((errno = pthread_create(&workers[i].thread, NULL,
+									__arrowFileWriteWorkerMain,
+									&workers[i])) != 0)
+			Elog("failed on pthread_create: %m");
+	}
+	for (i=0; i < nworkers; i++)
+	{
+		if ((errno = pthread_join(workers[i].thread, NULL)) != 0)
+			Elog("failed on pthread_join: %m");
+	}
+	for (i=0; i < nworkers; i++)
+	{
+		if ((errno = workers[i].errcode) != 0)
+			Elog("failed on pwritev('%s'): %m", table->filename);
+	}
+	pfree(iov_array);
+	pfree(workers);
+
+	table->f_pos = f_pos;
+	table->__iov_cnt = 0;
+
+	return true;
+}
+#endif	/* !__PGSTROM_MODULE__ */
+
+void
+arrowFileWriteIOV(SQLtable *table)
+{
+	size_t		length = 0;
+	int			i;
+
+#ifndef __PGSTROM_MODULE__
+	if (table->write_nthreads > 1 &&
+		__arrowFileWriteIOVParallel(table))
+		return;
+#endif
+	for (i=0; i < table->__iov_cnt; i++)
+		length += table->__iov[i].iov_len;
+	if ((errno = __arrowFileWriteIOVChunk(table->fdesc,
+										  table->__iov,
+										  table->__iov_cnt,
+										  table->f_pos)) != 0)
+		Elog("failed on pwritev('%s'): %m", table->filename);
+	table->f_pos += length;
 	table->__iov_cnt = 0;
 }
 
@@ -1137,6 +1287,54 @@ __setupArrowFieldStat(ArrowKeyValue *customMetadata,
 	}
 }
 
+static void
+__setupArrowFieldBloom(ArrowKeyValue *kv,
+					   SQLfield *column, int numRecordBatches)
+{
+	SQLbloom  **bloom_values = alloca(sizeof(SQLbloom *) * numRecordBatches);
+	SQLbloom   *curr;
+	size_t		len, off = 0;
+	char	   *buf;
+	int			i, k;
+
+	memset(bloom_values, 0, sizeof(SQLbloom *) * numRecordBatches);
+	for (curr = column->bloom_list; curr; curr = curr->next)
+	{
+		int		rb_index = curr->rb_index;
+
+		if (rb_index < 0 || rb_index >= numRecordBatches)
+			Elog("bloom filter at [%s] is out of range (%d of %d)",
+				 column->field_name, rb_index, numRecordBatches);
+		if (bloom_values[rb_index])
+			Elog("duplicate bloom filter at [%s] rb_index=%d",
+				 column->field_name, rb_index);
+		bloom_values[rb_index] = curr;
+	}
+	/* build a bloom filter array in hex-string */
+	len = (ARROW_BLOOM_NBITS / 4 + 1) * numRecordBatches + 1;
+	buf = palloc(len);
+	for (i=0; i < numRecordBatches; i++)
+	{
+		curr = bloom_values[i];
+		if (i > 0)
+			buf[off++] = ',';
+		if (!curr || !curr->is_valid)
+		{
+			off += snprintf(buf+off, len-off, "null");
+			continue;
+		}
+		for (k=0; k < ARROW_BLOOM_NWORDS; k++)
+			off += snprintf(buf+off, len-off, "%016lx",
+							(unsigned long)curr->bits[k]);
+	}
+	buf[off] = '\0';
+	initArrowNode(kv, KeyValue);
+	kv->key = pstrdup("bloom_filters");
+	kv->_key_len = strlen(kv->key);
+	kv->value = buf;
+	kv->_value_len = off;
+}
+
 static void
 setupArrowField(ArrowField *field, SQLtable *table, SQLfield *column)
 {
@@ -1185,6 +1383,20 @@ setupArrowField(ArrowField *field, SQLtable *table, SQLfield *column)
 							  column, table->numRecordBatches);
 		numCustomMetadata += 2;
 	}
+	/* bloom filter */
+	if (column->bloom_enabled)
+	{
+		size_t		sz = sizeof(ArrowKeyValue) * (numCustomMetadata + 1);
+
+		if (!customMetadata)
+			customMetadata = palloc0(sz);
+		else
+			customMetadata = repalloc(customMetadata, sz);
+
+		__setupArrowFieldBloom(customMetadata + numCustomMetadata,
+							   column, table->numRecordBatches);
+		numCustomMetadata++;
+	}
 	/* custom metadata, if any */
 	field->_num_custom_metadata = numCustomMetadata;
 	field->custom_metadata = customMetadata;
@@ -1610,6 +1822,78 @@ __saveArrowRecordBatchStats(int rb_index, SQLfield *field)
 	}
 }
 
+/*
+ * sql_field_bloom_update
+ *
+ * It adds the latest value of the field to the bloom filter of the current
+ * record-batch. The hash is computed on the Apache Arrow representation,
+ * so the reader side can check the filter for any writer implementation.
+ */
+void
+sql_field_bloom_update(SQLfield *column)
+{
+	size_t		row_index = column->nitems - 1;
+	const char *addr = NULL;
+	size_t		len = 0;
+	int			unitsz = 0;
+
+	switch (column->arrow_type.node.tag)
+	{
+		case ArrowNodeTag__Int:
+			unitsz = column->arrow_type.Int.bitWidth / 8;
+			break;
+		case ArrowNodeTag__Date:
+			if (column->arrow_type.Date.unit == ArrowDateUnit__Day)
+				unitsz = sizeof(int32_t);
+			else
+				unitsz = sizeof(int64_t);
+			break;
+		case ArrowNodeTag__Timestamp:
+			unitsz = sizeof(int64_t);
+			break;
+		case ArrowNodeTag__Utf8:
+		case ArrowNodeTag__Binary:
+			{
+				uint32_t   *offset = (uint32_t *)column->values.data;
+
+				if (column->values.usage < sizeof(uint32_t) * (row_index + 2))
+					return;
+				addr = column->extra.data + offset[row_index];
+				len = offset[row_index + 1] - offset[row_index];
+			}
+			break;
+		default:
+			return;		/* not supported */
+	}
+	if (unitsz > 0)
+	{
+		if (column->values.usage < unitsz * (row_index + 1))
+			return;
+		addr = column->values.data + unitsz * row_index;
+		len = unitsz;
+	}
+	sql_bloom_add(column->bloom_datum.bits, addr, len);
+	column->bloom_datum.is_valid = true;
+}
+
+static void
+__saveArrowRecordBatchBloom(int rb_index, SQLfield *field)
+{
+	if (field->bloom_datum.is_valid)
+	{
+		SQLbloom   *item = palloc(sizeof(SQLbloom));
+
+		/* save the SQLbloom item for the record-batch */
+		memcpy(item, &field->bloom_datum, sizeof(SQLbloom));
+		item->rb_index = rb_index;
+		item->next = field->bloom_list;
+		field->bloom_list = item;
+
+		/* reset bloom filter */
+		memset(&field->bloom_datum, 0, sizeof(SQLbloom));
+	}
+}
+
 int
 writeArrowRecordBatch(SQLtable *table)
 {
@@ -1641,6 +1925,16 @@ writeArrowRecordBatch(SQLtable *table)
 				__saveArrowRecordBatchStats(rb_index, field);
 		}
 	}
+	if (table->has_bloom_filters)
+	{
+		for (j=0; j < table->nfields; j++)
+		{
+			SQLfield   *field = &table->columns[j];
+
+			if (field->bloom_enabled)
+				__saveArrowRecordBatchBloom(rb_index, field);
+		}
+	}
 	return rb_index;
 }
 
@@ -12,6 +12,7 @@
 #include "pg_strom.h"
 #include "cuda_numeric.h"
 #include "cuda_postgis.h"
+#include "cuda_textlib.h"
 
 static MemoryContext	devinfo_memcxt;
 static dlist_head	devtype_info_slot[128];
@@ -1124,6 +1125,50 @@ vlbuf_estimate_substring(codegen_context *context,
 	return vl_width[0];
 }
 
+static int
+vlbuf_estimate_textcopy(codegen_context *context,
+						devfunc_info *dfunc,
+						Expr **args, int *vl_width)
+{
+	if (vl_width[0] < 0)
+		__ELog("unable to estimate result size of %s",
+			   dfunc->func_sqlname);
+	/* it consumes varlena buffer on run-time */
+	context->extra_bufsz += MAXALIGN(vl_width[0] + VARHDRSZ);
+
+	return vl_width[0];
+}
+
+static int
+vlbuf_estimate_split_part(codegen_context *context,
+						  devfunc_info *dfunc,
+						  Expr **args, int *vl_width)
+{
+	/* result is a part of the source string */
+	return vl_width[0];
+}
+
+static int
+vlbuf_estimate_concat_ws(codegen_context *context,
+						 devfunc_info *dfunc,
+						 Expr **args, int *vl_width)
+{
+	int		i, nargs = list_length(dfunc->func_args);
+	int		maxlen = 0;
+
+	for (i=0; i < nargs; i++)
+	{
+		if (vl_width[i] < 0)
+			__ELog("unable to estimate result size of concat_ws");
+		/* separator appears (nargs-2) times at most */
+		maxlen += (i == 0 ? vl_width[i] * (nargs - 2) : vl_width[i]);
+	}
+	/* it consumes varlena buffer on run-time */
+	context->extra_bufsz += MAXALIGN(maxlen + VARHDRSZ);
+
+	return maxlen;
+}
+
 static int
 vlbuf_estimate_jsonb(codegen_context *context,
 					 devfunc_info *dfunc,
@@ -1185,6 +1230,8 @@ vlbuf_estimate__st_expand(codegen_context *context,
  * attributes:
  * 'L' : this function is locale aware, thus, available only if simple
  *       collation configuration (none, and C-locale).
+ * 'U' : this function depends on LC_CTYPE (case mapping), thus, available
+ *       only if ctype of the collation is C-locale.
  * 'C' : this function uses its special callback to estimate the result
  *       width of varlena-buffer.
  * 'p' : this function needs cuda_primitive.h
@@ -1747,6 +1794,25 @@ static devfunc_catalog_t devfunc_common_catalog[] = {
 	{ NULL, "float8 sin(float8)",     5, "m/f:sin" },
 	{ NULL, "float8 tan(float8)",     5, "m/f:tan" },
 
+	/*
+	 * Array functions
+	 */
+	{ NULL, "int4 cardinality(array)",        2, "m/f:array_cardinality" },
+	{ NULL, "int4 array_ndims(array)",        1, "m/f:array_ndims" },
+	{ NULL, "int4 array_length(array,int4)",  2, "m/f:array_length" },
+
+	/*
+	 * Vector similarity functions (float4[])
+	 */
+	{ PGSTROM, "float8 l2_distance(array,array)",
+	  20, "m/f:vector_l2_distance" },
+	{ PGSTROM, "float8 inner_product(array,array)",
+	  20, "m/f:vector_inner_product" },
+	{ PGSTROM, "float8 negative_inner_product(array,array)",
+	  20, "m/f:vector_negative_inner_product" },
+	{ PGSTROM, "float8 cosine_distance(array,array)",
+	  20, "m/f:vector_cosine_distance" },
+
 	/*
 	 * Numeric functions
 	 * ------------------------- */
@@ -1982,6 +2048,29 @@ static devfunc_catalog_t devfunc_common_catalog[] = {
 	  20, "t/f:overlaps_timestamp" },
 	{ NULL, "bool overlaps(timestamptz,timestamptz,timestamptz,timestamptz)",
 	  20, "t/f:overlaps_timestamptz" },
+	/* date_trunc() */
+	{ NULL, "timestamp date_trunc(text,timestamp)",
+	  100, "t/f:timestamp_trunc" },
+	{ NULL, "timestamptz date_trunc(text,timestamptz)",
+	  100, "t/f:timestamptz_trunc" },
+	{ NULL, "timestamptz date_trunc(text,timestamptz,text)",
+	  100, "t/f:timestamptz_trunc_zone" },
+	/* time_bucket(); zone name must be a constant */
+	{ PGSTROM, "timestamp time_bucket(interval,timestamp)",
+	  20, "t/f:time_bucket_timestamp" },
+	{ PGSTROM, "timestamp time_bucket(interval,timestamp,timestamp)",
+	  20, "t/f:time_bucket_timestamp_origin" },
+	{ PGSTROM, "timestamptz time_bucket(interval,timestamptz)",
+	  20, "t/f:time_bucket_timestamptz" },
+	{ PGSTROM, "timestamptz time_bucket(interval,timestamptz,timestamptz)",
+	  20, "t/f:time_bucket_timestamptz_origin" },
+	{ PGSTROM, "timestamptz time_bucket(interval,timestamptz,text)",
+	  100, "t/f:time_bucket_timestamptz_zone" },
+	/* AT TIME ZONE; zone name must be a constant */
+	{ NULL, "timestamp timezone(text,timestamptz)",
+	  20, "t/f:timestamptz_zone" },
+	{ NULL, "timestamptz timezone(text,timestamp)",
+	  20, "t/f:timestamp_zone" },
 	/* extract() - PG14 changed to return numeric, not float8 */
 	{ NULL, "float8 date_part(text,timestamp)",
 	  100, "t/f:date_part_timestamp"},
@@ -2065,6 +2154,30 @@ static devfunc_catalog_t devfunc_common_catalog[] = {
 	{ NULL, "bool bpcharicnlike(bpchar,text)",9999, "Ls/f:bpcharicnlike" },
 	/* string operations */
 	{ NULL, "int4 length(text)", 2, "s/f:textlen" },
+	{ NULL, "int4 char_length(text)", 2, "s/f:textlen" },
+	{ NULL, "int4 character_length(text)", 2, "s/f:textlen" },
+	{ NULL, "text lower(text)",
+	  10, "UCs/f:text_lower",
+	  vlbuf_estimate_textcopy
+	},
+	{ NULL, "text upper(text)",
+	  10, "UCs/f:text_upper",
+	  vlbuf_estimate_textcopy
+	},
+	{ NULL, "int4 strpos(text,text)", 100, "s/f:textpos" },
+	{ NULL, "int4 position(text,text)", 100, "s/f:textpos" },
+	{ NULL, "text split_part(text,text,int4)",
+	  100, "Cs/f:split_part",
+	  vlbuf_estimate_split_part
+	},
+	{ NULL, "text concat_ws(text,text,text)",
+	  999, "Cs/f:text_concat_ws2",
+	  vlbuf_estimate_concat_ws
+	},
+	{ NULL, "text concat_ws(text,text,text,text)",
+	  999, "Cs/f:text_concat_ws3",
+	  vlbuf_estimate_concat_ws
+	},
 	{ NULL, "text textcat(text,text)",
 	  999, "Cs/f:textcat",
 	  vlbuf_estimate_textcat
@@ -2117,6 +2230,9 @@ static devfunc_catalog_t devfunc_common_catalog[] = {
 	{ NULL, "bool jsonb_exists(jsonb,text)",
 	  100, "j/f:jsonb_exists"
 	},
+	{ NULL, "bool jsonb_contains(jsonb,jsonb)",
+	  200, "j/f:jsonb_contains"
+	},
 	/*
 	 * int4range operators
 	 */
@@ -2403,7 +2519,15 @@ static devfunc_catalog_t devfunc_common_catalog[] = {
 	{ PGSTROM, "int8 hll_hash(timestamptz)", 1, "t/f:hll_hash_timestamptz" },
 	{ PGSTROM, "int8 hll_hash(bpchar)",      1, "s/f:hll_hash_bpchar" },
 	{ PGSTROM, "int8 hll_hash(text)",        1, "s/f:hll_hash_text" },
-	{ PGSTROM, "int8 hll_hash(uuid)",        1, "m/f:hll_hash_uuid"}
+	{ PGSTROM, "int8 hll_hash(uuid)",        1, "m/f:hll_hash_uuid"},
+	/*
+	 * GpuPreAgg quantile_sketch(X) support
+	 */
+	{ PGSTROM, "int4 quantile_sketch_key(float8)", 1, "f:quantile_sketch_key" },
+	/*
+	 * GpuPreAgg fixed-point SUM/AVG(numeric) support
+	 */
+	{ PGSTROM, "int8 numeric_fixed(numeric,int4)", 8, "f:numeric_fixed" },
 };
 
 /* default of dfunc->dfunc_varlena_sz if not specified */
@@ -2441,6 +2565,7 @@ __construct_devfunc_info(const char *func_extension,
 	int32			flags = 0;
 	int				j;
 	bool			has_collation = false;
+	bool			has_ctype = false;
 	bool			has_callbacks = false;
 
 	/* fetch attribute */
@@ -2454,6 +2579,9 @@ __construct_devfunc_info(const char *func_extension,
 				case 'L':
 					has_collation = true;
 					break;
+				case 'U':
+					has_ctype = true;
+					break;
 				case 'C':
 					has_callbacks = true;
 					break;
@@ -2507,6 +2635,12 @@ __construct_devfunc_info(const char *func_extension,
 			dfunc->func_is_negative = true;
 		dfunc->func_collid = dfunc_collid;
 	}
+	if (has_ctype)
+	{
+		if (OidIsValid(dfunc_collid) && !lc_ctype_is_c(dfunc_collid))
+			dfunc->func_is_negative = true;
+		dfunc->func_collid = dfunc_collid;
+	}
 	dfunc->func_is_strict = proc->proisstrict;
 	dfunc->func_flags = flags;
 	dfunc->func_args = dfunc_args;
@@ -3355,6 +3489,16 @@ static struct {
 	  "box2df@postgis",
 	  "box2df@postgis",
 	},
+	/*
+	 * range overlap operator; index handler is polymorphic, so ivar/iarg
+	 * types are NULL, and resolved by the actual type of the index.
+	 */
+	{ NULL, "anyrange && anyrange",
+	  "gist", RTOverlapStrategyNumber,
+	  "gist_range_overlap",
+	  NULL,
+	  NULL,
+	},
 };
 
 devindex_info *
@@ -3418,11 +3562,13 @@ pgstrom_devindex_lookup(Oid opcode, Oid opfamily)
 		if (strcmp(__signature, signature) != 0)
 			continue;
 
-		ivar_dtype = pgstrom_devtype_lookup_by_name(__ivar_typname);
-		if (!ivar_dtype)
+		if (!__ivar_typname)
+			ivar_dtype = NULL;
+		else if (!(ivar_dtype = pgstrom_devtype_lookup_by_name(__ivar_typname)))
 			continue;
-		iarg_dtype = pgstrom_devtype_lookup_by_name(__iarg_typname);
-		if (!iarg_dtype)
+		if (!__iarg_typname)
+			iarg_dtype = NULL;
+		else if (!(iarg_dtype = pgstrom_devtype_lookup_by_name(__iarg_typname)))
 			continue;
 
 		dindex = MemoryContextAllocZero(devinfo_memcxt, sizeof(devindex_info));
@@ -3466,6 +3612,9 @@ static void codegen_expression_walker(codegen_context *context,
 									  StringInfo body,
 									  Node *node, int *p_varlena_sz);
 
+static int	codegen_scalar_array_op_expression(codegen_context *context,
+											   StringInfo body,
+											   ScalarArrayOpExpr *opexpr);
 static Node *__codegen_current_node = NULL;
 static void
 __appendStringInfo(StringInfo str, const char *fmt,...)
@@ -3652,6 +3801,144 @@ codegen_varnode_expression(codegen_context *context,
 	return width;
 }
 
+/*
+ * codegen_textlike_fastpath
+ *
+ * LIKE/NOT LIKE with a constant pattern, that consists of a literal with
+ * leading and/or trailing '%', is replaced by the device function that
+ * compares the literal embedded in the device code, instead of the pattern
+ * interpretation per row.
+ * It returns the extra arguments of pgfn_XXXlike_fastpath, or NULL if not
+ * applicable.
+ */
+static char *
+codegen_textlike_fastpath(devfunc_info *dfunc, List *args,
+						  const char **p_fastpath)
+{
+	const char *devname = dfunc->func_devname;
+	const char *fastpath;
+	bool		negative;
+	Const	   *con;
+	char	   *pat;
+	int			len, i;
+	int			mode = LIKE_FASTPATH_EXACT;
+	StringInfoData buf;
+
+	if (strcmp(devname, "textlike") == 0 ||
+		strcmp(devname, "textnlike") == 0)
+		fastpath = "textlike_fastpath";
+	else if (strcmp(devname, "bpcharlike") == 0 ||
+			 strcmp(devname, "bpcharnlike") == 0)
+		fastpath = "bpcharlike_fastpath";
+	else
+		return NULL;
+	negative = (strstr(devname, "nlike") != NULL);
+
+	if (list_length(args) != 2)
+		return NULL;
+	con = lsecond(args);
+	if (!IsA(con, Const) || con->constisnull)
+		return NULL;
+	pat = TextDatumGetCString(con->constvalue);
+
+	while (*pat == '%')
+	{
+		mode |= LIKE_FASTPATH_SUFFIX;
+		pat++;
+	}
+	len = strlen(pat);
+	while (len > 0 && pat[len-1] == '%')
+	{
+		mode |= LIKE_FASTPATH_PREFIX;
+		len--;
+	}
+	/*
+	 * The literal must not have any wildcard or escape character. Also,
+	 * non-ASCII characters are allowed only if UTF-8, because we compare
+	 * the literal at any byte position for '%literal'/'%literal%'.
+	 */
+	for (i=0; i < len; i++)
+	{
+		unsigned char	c = pat[i];
+
+		if (c == '%' || c == '_' || c == '\\')
+			return NULL;
+		if (!isascii(c) && GetDatabaseEncoding() != PG_UTF8)
+			return NULL;
+	}
+
+	initStringInfo(&buf);
+	appendStringInfoChar(&buf, '"');
+	for (i=0; i < len; i++)
+	{
+		unsigned char	c = pat[i];
+
+		if (isalnum(c) || c == ' ' || (ispunct(c) && c != '"' && c != '?'))
+			appendStringInfoChar(&buf, c);
+		else
+			appendStringInfo(&buf, "\\%03o", c);
+	}
+	appendStringInfo(&buf, "\", %d, %d, %s",
+					 len, mode, negative ? "true" : "false");
+	*p_fastpath = fastpath;
+
+	return buf.data;
+}
+
+/*
+ * codegen_timezone_fastpath
+ *
+ * Functions that take a time zone name (AT TIME ZONE, date_trunc and
+ * time_bucket with zone) are device executable only if the name is a constant. The transition table
+ * of the zone is embedded in the device code, and the function is replaced
+ * by pgfn_XXX_fastpath that takes a pointer to the tz_state instead.
+ * It returns the variable name of the tz_state, or NULL if not applicable.
+ */
+static char *
+codegen_timezone_fastpath(codegen_context *context,
+						  devfunc_info *dfunc, List *args, int *p_argno)
+{
+	const char *devname = dfunc->func_devname;
+	Const	   *con;
+	int			argno;
+	char	   *tzname;
+	char	   *lowzone;
+	int			type, val;
+	pg_tz	   *tzp;
+	char		varname[NAMEDATALEN];
+
+	if (strcmp(devname, "timestamptz_zone") == 0 ||
+		strcmp(devname, "timestamp_zone") == 0)
+		argno = 0;
+	else if (strcmp(devname, "timestamptz_trunc_zone") == 0 ||
+			 strcmp(devname, "time_bucket_timestamptz_zone") == 0)
+		argno = 2;
+	else
+		return NULL;
+
+	con = list_nth(args, argno);
+	if (!IsA(con, Const) || con->constisnull)
+		__ELog("time zone of %s must be a constant", devname);
+	tzname = TextDatumGetCString(con->constvalue);
+	/* time zone abbreviations have its own rules, not supported */
+	lowzone = downcase_truncate_identifier(tzname, strlen(tzname), false);
+	type = DecodeTimezoneAbbrev(0, lowzone, &val, &tzp);
+	if (type != UNKNOWN_FIELD)
+		__ELog("time zone abbreviation \"%s\" is not supported", tzname);
+	tzp = pg_tzset(tzname);
+	if (!tzp)
+		__ELog("time zone \"%s\" not recognized", tzname);
+
+	snprintf(varname, sizeof(varname), "__tz_state_%08x",
+			 DatumGetUInt32(hash_any((unsigned char *)tzname,
+									 strlen(tzname))));
+	if (!context->decl.data || !strstr(context->decl.data, varname))
+		pgstrom_codegen_tz_state(&context->decl, varname, true, tzp);
+	*p_argno = argno;
+
+	return pstrdup(varname);
+}
+
 static int
 codegen_function_expression(codegen_context *context,
 							StringInfo body,
@@ -3661,10 +3948,18 @@ codegen_function_expression(codegen_context *context,
 	Expr  **fn_args = alloca(sizeof(Expr *) * list_length(args));
 	int	   *vl_width = alloca(sizeof(int) * list_length(args));
 	int		index = 0;
-
+	const char *fastpath = NULL;
+	char   *fastpath_args;
+	char   *tz_varname;
+	int		tz_argno = -1;
+
+	fastpath_args = codegen_textlike_fastpath(dfunc, args, &fastpath);
+	tz_varname = codegen_timezone_fastpath(context, dfunc, args, &tz_argno);
+	if (tz_varname)
+		fastpath = psprintf("%s_fastpath", dfunc->func_devname);
 	__appendStringInfo(body,
 					   "pgfn_%s(kcxt",
-					   dfunc->func_devname);
+					   fastpath ? fastpath : dfunc->func_devname);
 	forboth (lc1, dfunc->func_args,
 			 lc2, args)
 	{
@@ -3673,6 +3968,22 @@ codegen_function_expression(codegen_context *context,
 		Oid		expr_type_oid = exprType(expr);
 
 		__appendStringInfo(body, ", ");
+		if (fastpath_args && index > 0)
+		{
+			/* pattern is already embedded */
+			__appendStringInfo(body, "%s", fastpath_args);
+			vl_width[index] = 0;
+			fn_args[index++] = (Expr *)expr;
+			continue;
+		}
+		if (index == tz_argno)
+		{
+			/* transition table of the zone is already embedded */
+			__appendStringInfo(body, "&%s", tz_varname);
+			vl_width[index] = 0;
+			fn_args[index++] = (Expr *)expr;
+			continue;
+		}
 
 		if (dtype->type_oid == expr_type_oid)
 			codegen_expression_walker(context, body, expr, &vl_width[index]);
@@ -3786,13 +4097,100 @@ codegen_booleantest_expression(codegen_context *context,
 	return sizeof(cl_bool);
 }
 
+/*
+ * fold_or_equality_chain
+ *
+ * It transforms an OR-chain of the same operator between a common
+ * expression and constant values, like (X = 1 OR X = 2 OR X = 3),
+ * into an equivalent ScalarArrayOpExpr; X = ANY('{1,2,3}').
+ * Constants are delivered by kern_parambuf, so queries with different
+ * number of the OR-clauses can share an identical GPU program.
+ * It returns NULL if not applicable.
+ */
+static ScalarArrayOpExpr *
+fold_or_equality_chain(BoolExpr *b)
+{
+	ScalarArrayOpExpr *sa_op;
+	OpExpr	   *op_first = NULL;
+	Node	   *expr_s = NULL;
+	Oid			const_type = InvalidOid;
+	Oid			array_type;
+	Datum	   *values;
+	int			nitems = 0;
+	int16		typlen;
+	bool		typbyval;
+	char		typalign;
+	ArrayType  *array;
+	ListCell   *lc;
+
+	Assert(b->boolop == OR_EXPR);
+	if (list_length(b->args) < 2)
+		return NULL;
+	values = palloc(sizeof(Datum) * list_length(b->args));
+	foreach (lc, b->args)
+	{
+		OpExpr	   *op = lfirst(lc);
+		Const	   *con;
+
+		if (!IsA(op, OpExpr) ||
+			list_length(op->args) != 2 ||
+			op->opresulttype != BOOLOID ||
+			op->opretset ||
+			!IsA(lsecond(op->args), Const))
+			return NULL;
+		con = lsecond(op->args);
+		if (con->constisnull)
+			return NULL;
+		if (!op_first)
+		{
+			op_first = op;
+			expr_s = linitial(op->args);
+			const_type = con->consttype;
+			if (contain_volatile_functions(expr_s))
+				return NULL;
+		}
+		else if (op->opno != op_first->opno ||
+				 op->inputcollid != op_first->inputcollid ||
+				 con->consttype != const_type ||
+				 !equal(linitial(op->args), expr_s))
+			return NULL;
+		values[nitems++] = con->constvalue;
+	}
+	array_type = get_array_type(const_type);
+	if (!OidIsValid(array_type) ||
+		!pgstrom_devtype_lookup(array_type))
+		return NULL;
+	get_typlenbyvalalign(const_type, &typlen, &typbyval, &typalign);
+	array = construct_array(values, nitems, const_type,
+							typlen, typbyval, typalign);
+
+	sa_op = makeNode(ScalarArrayOpExpr);
+	sa_op->opno = op_first->opno;
+	sa_op->opfuncid = op_first->opfuncid;
+	sa_op->useOr = true;
+	sa_op->inputcollid = op_first->inputcollid;
+	sa_op->args = list_make2(expr_s,
+							 makeConst(array_type, -1, InvalidOid, -1,
+									   PointerGetDatum(array),
+									   false, false));
+	sa_op->location = b->location;
+
+	return sa_op;
+}
+
 static int
 codegen_bool_expression(codegen_context *context,
 						StringInfo body, BoolExpr *b)
 {
+	ScalarArrayOpExpr *sa_op;
 	Node	   *node;
 
-	if (b->boolop == NOT_EXPR)
+	if (b->boolop == OR_EXPR &&
+		(sa_op = fold_or_equality_chain(b)) != NULL)
+	{
+		return codegen_scalar_array_op_expression(context, body, sa_op);
+	}
+	else if (b->boolop == NOT_EXPR)
 	{
 		Assert(list_length(b->args) == 1);
 		node = linitial(b->args);
@@ -4303,6 +4701,133 @@ codegen_casetest_expression(codegen_context *context,
 	return 0;
 }
 
+/*
+ * codegen_scalar_array_op_bsearch
+ *
+ * Large IN-list like (X IN (1,2,...)) or (X = ANY('{...}')) are evaluated
+ * element-by-element by PG_SCALAR_ARRAY_OP for each row. If the array is
+ * a constant of integer values, we sort and de-duplicate the elements
+ * here, then deliver the sorted int8[] array by kern_parambuf, and
+ * PG_SCALAR_ARRAY_BSEARCH probes the array by binary search instead.
+ * NOT IN (X <> ALL('{...}')) is also supported as a negation of the
+ * binary search.
+ * It returns false if not applicable.
+ */
+#define SCALAR_ARRAY_BSEARCH_THRESHOLD		16
+
+static int
+__int64_compare_cb(const void *__a, const void *__b)
+{
+	int64		a = *((const int64 *)__a);
+	int64		b = *((const int64 *)__b);
+
+	if (a < b)
+		return -1;
+	if (a > b)
+		return 1;
+	return 0;
+}
+
+static bool
+codegen_scalar_array_op_bsearch(codegen_context *context,
+								StringInfo body,
+								ScalarArrayOpExpr *opexpr,
+								devfunc_info *dfunc,
+								Node *node_s, Node *node_a)
+{
+	static const char *int_eq_funcs[] = {
+		"int2eq",  "int24eq", "int28eq",
+		"int42eq", "int4eq",  "int48eq",
+		"int82eq", "int84eq", "int8eq",
+		NULL,
+	};
+	static const char *int_ne_funcs[] = {
+		"int2ne",  "int24ne", "int28ne",
+		"int42ne", "int4ne",  "int48ne",
+		"int82ne", "int84ne", "int8ne",
+		NULL,
+	};
+	const char **func_names = (opexpr->useOr ? int_eq_funcs : int_ne_funcs);
+	Const	   *con = (Const *) node_a;
+	ArrayType  *array;
+	Oid			elemtype;
+	int16		typlen;
+	bool		typbyval;
+	char		typalign;
+	Datum	   *elems;
+	bool	   *nulls;
+	int			nitems;
+	int64	   *values;
+	Datum	   *sorted;
+	Oid			array_type;
+	int			i, j;
+
+	if (!IsA(con, Const) || con->constisnull)
+		return false;
+	for (i=0; func_names[i] != NULL; i++)
+	{
+		if (strcmp(dfunc->func_devname, func_names[i]) == 0)
+			break;
+	}
+	if (!func_names[i])
+		return false;
+
+	array = DatumGetArrayTypeP(con->constvalue);
+	elemtype = ARR_ELEMTYPE(array);
+	if (elemtype != INT2OID &&
+		elemtype != INT4OID &&
+		elemtype != INT8OID)
+		return false;
+	/* NULL elements make the result NULL, not false; not supported */
+	if (ARR_HASNULL(array) ||
+		ArrayGetNItems(ARR_NDIM(array),
+					   ARR_DIMS(array)) < SCALAR_ARRAY_BSEARCH_THRESHOLD)
+		return false;
+	array_type = get_array_type(INT8OID);
+	if (!OidIsValid(array_type) ||
+		!pgstrom_devtype_lookup_and_track(array_type, context))
+		return false;
+
+	get_typlenbyvalalign(elemtype, &typlen, &typbyval, &typalign);
+	deconstruct_array(array, elemtype, typlen, typbyval, typalign,
+					  &elems, &nulls, &nitems);
+	values = palloc(sizeof(int64) * nitems);
+	for (i=0; i < nitems; i++)
+	{
+		if (elemtype == INT2OID)
+			values[i] = DatumGetInt16(elems[i]);
+		else if (elemtype == INT4OID)
+			values[i] = DatumGetInt32(elems[i]);
+		else
+			values[i] = DatumGetInt64(elems[i]);
+	}
+	qsort(values, nitems, sizeof(int64), __int64_compare_cb);
+	sorted = palloc(sizeof(Datum) * nitems);
+	for (i=0, j=0; i < nitems; i++)
+	{
+		if (i == 0 || values[i] != values[i-1])
+			sorted[j++] = Int64GetDatum(values[i]);
+	}
+	con = makeConst(array_type, -1, InvalidOid, -1,
+					PointerGetDatum(construct_array(sorted, j, INT8OID,
+													sizeof(int64),
+													FLOAT8PASSBYVAL, 'd')),
+					false, false);
+
+	__appendStringInfo(body, "PG_SCALAR_ARRAY_BSEARCH(kcxt, ");
+	codegen_expression_walker(context, body, node_s, NULL);
+	__appendStringInfo(body, ", ");
+	codegen_const_expression(context, body, con);
+	__appendStringInfo(body, ", %s)",
+					   opexpr->useOr ? "true" : "false");
+	/* cost for binary search; log2(nitems) comparisons */
+	for (i=1; j > 1; j >>= 1)
+		i++;
+	context->devcost += i * dfunc->func_devcost;
+
+	return true;
+}
+
 static int
 codegen_scalar_array_op_expression(codegen_context *context,
 								   StringInfo body,
@@ -4366,6 +4891,10 @@ codegen_scalar_array_op_expression(codegen_context *context,
 	PG_END_TRY();
 	ReleaseSysCache(fn_tup);
 
+	if (codegen_scalar_array_op_bsearch(context, body, opexpr,
+										dfunc, node_s, node_a))
+		return sizeof(cl_bool);
+
 	__appendStringInfo(body,
 					   "PG_SCALAR_ARRAY_OP(kcxt, pgfn_%s, ",
 					   dfunc->func_devname);
@@ -4397,6 +4926,26 @@ codegen_expression_walker(codegen_context *context,
 
 	if (node == NULL)
 		return;
+	/* common sub-expression already evaluated? */
+	if (context->cse_exprs != NIL &&
+		(IsA(node, FuncExpr) || IsA(node, OpExpr)))
+	{
+		ListCell   *lc1, *lc2;
+		int			index = 0;
+
+		forboth (lc1, context->cse_exprs,
+				 lc2, context->cse_widths)
+		{
+			if (equal(node, lfirst(lc1)))
+			{
+				__appendStringInfo(body, "__CSE_%d", index);
+				if (p_width)
+					*p_width = lfirst_int(lc2);
+				return;
+			}
+			index++;
+		}
+	}
 	/* save the current node for error message */
 	__codegen_saved_node   = __codegen_current_node;
 	__codegen_current_node = node;
@@ -4469,22 +5018,45 @@ codegen_expression_walker(codegen_context *context,
 												   (BooleanTest *) node);
 			break;
 
+		/*
+		 * NOTE: BoolExpr, CoalesceExpr, MinMaxExpr and CaseExpr are
+		 * generated as separate device functions, so common sub-
+		 * expressions (local variables of the caller) are invisible.
+		 */
 		case T_BoolExpr:
-			width = codegen_bool_expression(context,
-											body,
-											(BoolExpr *) node);
+			{
+				List   *cse_saved = context->cse_exprs;
+
+				context->cse_exprs = NIL;
+				width = codegen_bool_expression(context,
+												body,
+												(BoolExpr *) node);
+				context->cse_exprs = cse_saved;
+			}
 			break;
 
 		case T_CoalesceExpr:
-			width = codegen_coalesce_expression(context,
-												body,
-												(CoalesceExpr *) node);
+			{
+				List   *cse_saved = context->cse_exprs;
+
+				context->cse_exprs = NIL;
+				width = codegen_coalesce_expression(context,
+													body,
+													(CoalesceExpr *) node);
+				context->cse_exprs = cse_saved;
+			}
 			break;
 
 		case T_MinMaxExpr:
-			width = codegen_minmax_expression(context,
-											  body,
-											  (MinMaxExpr *) node);
+			{
+				List   *cse_saved = context->cse_exprs;
+
+				context->cse_exprs = NIL;
+				width = codegen_minmax_expression(context,
+												  body,
+												  (MinMaxExpr *) node);
+				context->cse_exprs = cse_saved;
+			}
 			break;
 
 		case T_RelabelType:
@@ -4506,9 +5078,15 @@ codegen_expression_walker(codegen_context *context,
 			break;
 
 		case T_CaseExpr:
-			width = codegen_casewhen_expression(context,
-												body,
-												(CaseExpr *) node);
+			{
+				List   *cse_saved = context->cse_exprs;
+
+				context->cse_exprs = NIL;
+				width = codegen_casewhen_expression(context,
+													body,
+													(CaseExpr *) node);
+				context->cse_exprs = cse_saved;
+			}
 			break;
 
 		case T_CaseTestExpr:
@@ -4571,6 +5149,101 @@ pgstrom_codegen_expression(Node *expr, codegen_context *context)
 	return body.data;
 }
 
+/*
+ * pgstrom_codegen_common_subexprs
+ *
+ * It finds out function/operator invocations that appear multiple times
+ * in the supplied expressions, then puts declarations of local variables
+ * (__CSE_N) initialized by these sub-expressions on the @body. Once
+ * context->cse_exprs is set, the code generator references the local
+ * variable instead of the re-evaluation, until caller resets it.
+ * Only sub-expressions evaluated unconditionally are picked up, because
+ * eager evaluation of conditional branch (CASE, COALESCE, AND/OR, ...)
+ * may raise an error that shall not happen in the original expression.
+ */
+typedef struct
+{
+	List	   *exprs;
+	List	   *counts;
+} common_subexprs_context;
+
+static bool
+common_subexprs_walker(Node *node, void *__context)
+{
+	common_subexprs_context *con = __context;
+
+	if (!node)
+		return false;
+	if (IsA(node, BoolExpr) ||
+		IsA(node, CoalesceExpr) ||
+		IsA(node, MinMaxExpr) ||
+		IsA(node, CaseExpr))
+		return false;
+	if ((IsA(node, FuncExpr) || IsA(node, OpExpr)) &&
+		!contain_volatile_functions(node))
+	{
+		ListCell   *lc1, *lc2;
+
+		forboth (lc1, con->exprs,
+				 lc2, con->counts)
+		{
+			if (equal(node, lfirst(lc1)))
+			{
+				lfirst_int(lc2)++;
+				/* sub-expressions are also counted on the first time */
+				return false;
+			}
+		}
+		con->exprs = lappend(con->exprs, node);
+		con->counts = lappend_int(con->counts, 1);
+	}
+	return expression_tree_walker(node, common_subexprs_walker, con);
+}
+
+void
+pgstrom_codegen_common_subexprs(StringInfo body,
+								List *exprs_list,
+								codegen_context *context)
+{
+	common_subexprs_context con;
+	ListCell   *lc;
+	int			i;
+
+	memset(&con, 0, sizeof(common_subexprs_context));
+	foreach (lc, exprs_list)
+		common_subexprs_walker(lfirst(lc), &con);
+
+	/*
+	 * NOTE: expression_tree_walker visits the parent node prior to its
+	 * children, so the reverse order ensures sub-expressions are declared
+	 * before the larger expression that contains them.
+	 */
+	context->cse_exprs = NIL;
+	context->cse_widths = NIL;
+	for (i = list_length(con.exprs) - 1; i >= 0; i--)
+	{
+		Node	   *expr = list_nth(con.exprs, i);
+		devtype_info *dtype;
+		StringInfoData temp;
+		int			width;
+
+		if (list_nth_int(con.counts, i) < 2)
+			continue;
+		dtype = pgstrom_devtype_lookup_and_track(exprType(expr), context);
+		if (!dtype)
+			continue;
+		initStringInfo(&temp);
+		codegen_expression_walker(context, &temp, expr, &width);
+		appendStringInfo(body, "  pg_%s_t __CSE_%d = %s;\n",
+						 dtype->type_name,
+						 list_length(context->cse_exprs),
+						 temp.data);
+		context->cse_exprs = lappend(context->cse_exprs, expr);
+		context->cse_widths = lappend_int(context->cse_widths, width);
+		pfree(temp.data);
+	}
+}
+
 /*
  * pgstrom_union_type_declarations
  *
@@ -4680,6 +5353,7 @@ __pgstrom_device_expression(PlannerInfo *root,
 						edata->filename, edata->lineno),
 				 errdetail("expression: %s",
 						   nodeToString(__codegen_current_node))));
+		pgstrom_record_offload_blocker("%s", edata->message);
 		__codegen_current_node = NULL;
 		FreeErrorData(edata);
 		result = false;
@@ -4692,6 +5366,8 @@ __pgstrom_device_expression(PlannerInfo *root,
 		{
 			elog(DEBUG2, "Expression consumes too much buffer (%u): %s",
 				 con.extra_bufsz, nodeToString(expr));
+			pgstrom_record_offload_blocker("expression consumes too much varlena buffer (%u bytes)",
+										   con.extra_bufsz);
 			return false;
 		}
 		Assert(con.devcost >= 0);
@@ -917,6 +917,101 @@ STROMCL_SIMPLE_HLL_HASH_TEMPLATE(int4)
 STROMCL_SIMPLE_HLL_HASH_TEMPLATE(int8)
 #endif	/* __CUDACC__ */
 
+/*
+ * Bucket-key of the quantile sketch for percentile estimation
+ *
+ * A float8 value is mapped to the key that consists of its sign, exponent
+ * (clipped to [QUANTILE_SKETCH_EXPO_MIN, QUANTILE_SKETCH_EXPO_MAX)) and
+ * the upper QUANTILE_SKETCH_KEY_BITS bits of mantissa. The key preserves
+ * the order of the original values, so the upper pg_strom.quantile_sketch_bits
+ * portion of the mantissa part chooses the bucket of sketch to be counted.
+ */
+#define QUANTILE_SKETCH_KEY_BITS		6
+#define QUANTILE_SKETCH_EXPO_MIN		(-64)
+#define QUANTILE_SKETCH_EXPO_MAX		64
+#define QUANTILE_SKETCH_NBUCKETS(nbits)									\
+	((2U * (QUANTILE_SKETCH_EXPO_MAX -									\
+			QUANTILE_SKETCH_EXPO_MIN)) << (nbits))
+
+typedef struct {
+	cl_uint		vl_len_;	/* varlena header (only 4B) */
+	cl_uint		nbits;		/* = pg_strom.quantile_sketch_bits */
+	cl_ulong	counters[FLEXIBLE_ARRAY_MEMBER];
+} kern_quantile_sketch;
+
+#define QUANTILE_SKETCH_LENGTH(nbits)									\
+	(offsetof(kern_quantile_sketch, counters) +							\
+	 sizeof(cl_ulong) * QUANTILE_SKETCH_NBUCKETS(nbits))
+
+STATIC_INLINE(cl_uint)
+__quantile_sketch_key(cl_double fval)
+{
+	union {
+		cl_double	fval;
+		cl_ulong	ival;
+	}			u;
+	cl_uint		nhalf = QUANTILE_SKETCH_NBUCKETS(QUANTILE_SKETCH_KEY_BITS) / 2;
+	cl_uint		mask = (1U << QUANTILE_SKETCH_KEY_BITS) - 1;
+	cl_uint		mant;
+	cl_uint		pos;
+	cl_int		expo;
+
+	u.fval = fval;
+	/* NaN is larger than any other values, like PostgreSQL */
+	if ((u.ival & 0x7fffffffffffffffUL) > 0x7ff0000000000000UL)
+		return 2 * nhalf - 1;
+	expo = (cl_int)((u.ival >> 52) & 0x7ffU) - 1023;
+	mant = (cl_uint)(u.ival >> (52 - QUANTILE_SKETCH_KEY_BITS)) & mask;
+	if (expo < QUANTILE_SKETCH_EXPO_MIN)
+	{
+		/* zero, denormalized or very tiny values */
+		expo = QUANTILE_SKETCH_EXPO_MIN;
+		mant = 0;
+	}
+	else if (expo >= QUANTILE_SKETCH_EXPO_MAX)
+	{
+		/* infinity or very large values */
+		expo = QUANTILE_SKETCH_EXPO_MAX - 1;
+		mant = mask;
+	}
+	pos = ((cl_uint)(expo - QUANTILE_SKETCH_EXPO_MIN) << QUANTILE_SKETCH_KEY_BITS) | mant;
+	if ((u.ival & 0x8000000000000000UL) != 0)
+		return (nhalf - 1) - pos;	/* negative values in reverse order */
+	return nhalf + pos;
+}
+
+#ifdef __CUDACC__
+DEVICE_INLINE(pg_int4_t)
+pgfn_quantile_sketch_key(kern_context *kcxt, pg_float8_t arg1)
+{
+	pg_int4_t	result;
+
+	result.isnull = arg1.isnull;
+	if (!result.isnull)
+		result.value = (cl_int)__quantile_sketch_key(arg1.value);
+	return result;
+}
+#endif	/* __CUDACC__ */
+
+/*
+ * Fixed-point accumulator for sum/avg of numeric
+ *
+ * When numeric column has declared precision and scale, every value can be
+ * represented by 64bit integer multiplied by 10^scale, and its total sum is
+ * accumulated on the 128bit integer without precision loss. The carry from
+ * the lower 64bit is propagated separately, so GPU can update the
+ * accumulator by a pair of atomic operations.
+ */
+#define NUMERIC_FIXED_MAX_PRECISION		18
+
+typedef struct {
+	cl_uint		vl_len_;	/* varlena header (only 4B) */
+	cl_int		scale;		/* digits after the decimal point */
+	cl_ulong	nitems;		/* number of accumulated values */
+	cl_ulong	sum_lo;		/* lower 64bit of the 128bit sum */
+	cl_long		sum_hi;		/* upper 64bit of the 128bit sum */
+} kern_numeric_fixed;
+
 /* pg_bytea_t */
 #ifndef PG_BYTEA_TYPE_DEFINED
 #define PG_BYTEA_TYPE_DEFINED
@@ -39,6 +39,8 @@
 #define DEVKERNEL_NEEDS_RANGETYPE		0x00002000
 #define DEVKERNEL_NEEDS_POSTGIS			0x00004000
 
+#define DEVKERNEL_BUILD_PROFILING		0x00800000
+
 #define DEVKERNEL_NEEDS_USERS_EXTRA1	0x01000000
 #define DEVKERNEL_NEEDS_USERS_EXTRA2	0x02000000
 #define DEVKERNEL_NEEDS_USERS_EXTRA3	0x04000000
@@ -147,8 +149,8 @@ typedef struct devindex_info {
 	int16			opstrategy;
 	const char	   *index_kind;		/* only "gist" is available now */
 	const char	   *index_fname;	/* device index handler name */
-	devtype_info   *ivar_dtype;		/* device type of index'ed value */
-	devtype_info   *iarg_dtype;		/* device type of index argument for search */
+	devtype_info   *ivar_dtype;		/* device type of index'ed value, or NULL if polymorphic */
+	devtype_info   *iarg_dtype;		/* device type of index argument for search, or NULL if polymorphic */
 	bool			index_is_negative;
 } devindex_info;
 
@@ -1014,6 +1014,268 @@ toast_decompress_datum(char *buffer, cl_uint buflen,
 	return true;
 }
 
+/*
+ * Decompression of KDS_FORMAT_ARROW buffers
+ *
+ * Every chunk is processed by a warp. All the lanes in the warp walk on
+ * the same LZ4 sequences, so branches are never divergent, then literals
+ * and matches are copied by the lanes in parallel.
+ */
+STATIC_INLINE(cl_uint)
+__lz4_read_u32(const cl_uchar *pos)
+{
+	return ((cl_uint)pos[0]       | ((cl_uint)pos[1] <<  8) |
+			((cl_uint)pos[2] << 16) | ((cl_uint)pos[3] << 24));
+}
+
+STATIC_FUNCTION(cl_bool)
+__lz4_block_decompress_warp(const cl_uchar *sp,
+							const cl_uchar *srcend,
+							cl_uchar *dst_head,
+							cl_uchar **p_dp,
+							cl_uchar *dstend)
+{
+	cl_uchar   *dp = *p_dp;
+	cl_uint		lane_id = get_lane_id();
+
+	while (sp < srcend)
+	{
+		cl_uint		token = *sp++;
+		size_t		len = (token >> 4);
+		size_t		off;
+		size_t		i, step;
+		cl_uint		c;
+
+		/* literals */
+		if (len == 15)
+		{
+			do {
+				if (sp >= srcend)
+					return false;
+				c = *sp++;
+				len += c;
+			} while (c == 255);
+		}
+		if (len > srcend - sp || len > dstend - dp)
+			return false;
+		for (i=lane_id; i < len; i += warpSize)
+			dp[i] = sp[i];
+		sp += len;
+		dp += len;
+		__syncwarp();
+		/* the last sequence has no match part */
+		if (sp == srcend)
+			break;
+
+		/* match */
+		if (srcend - sp < 2)
+			return false;
+		off = ((size_t)sp[0] | ((size_t)sp[1] << 8));
+		sp += 2;
+		if (off == 0 || off > dp - dst_head)
+			return false;
+		len = (token & 0x0f);
+		if (len == 15)
+		{
+			do {
+				if (sp >= srcend)
+					return false;
+				c = *sp++;
+				len += c;
+			} while (c == 255);
+		}
+		len += 4;		/* MINMATCH */
+		if (len > dstend - dp)
+			return false;
+		/*
+		 * Match may overlap to the destination if @off is shorter than @len,
+		 * so we copy @step bytes at once; no lanes read bytes being written
+		 * by the other lanes in the same round.
+		 */
+		step = Min(off, warpSize);
+		for (i=0; i < len; i += step)
+		{
+			if (lane_id < step && i + lane_id < len)
+				dp[i + lane_id] = dp[i + lane_id - off];
+			__syncwarp();
+		}
+		dp += len;
+	}
+	*p_dp = dp;
+	return true;
+}
+
+STATIC_FUNCTION(cl_bool)
+__lz4_frame_decompress_warp(kern_context *kcxt,
+							const cl_uchar *src, size_t src_len,
+							cl_uchar *dst, size_t dst_len)
+{
+	const cl_uchar *sp = src;
+	const cl_uchar *srcend = src + src_len;
+	cl_uchar   *dp = dst;
+	cl_uchar   *dstend = dst + dst_len;
+	cl_uint		lane_id = get_lane_id();
+
+	while (sp < srcend)
+	{
+		cl_uint		magic;
+		cl_uint		flags;
+		cl_uint		bsize;
+		size_t		i, hsize;
+
+		if (srcend - sp < 4)
+			goto corrupted;
+		magic = __lz4_read_u32(sp);
+		sp += 4;
+		if ((magic & 0xfffffff0U) == 0x184d2a50U)
+		{
+			/* skippable frame */
+			if (srcend - sp < 4)
+				goto corrupted;
+			bsize = __lz4_read_u32(sp);
+			sp += 4;
+			if (bsize > srcend - sp)
+				goto corrupted;
+			sp += bsize;
+			continue;
+		}
+		if (magic != 0x184d2204U)
+			goto corrupted;
+		/* FLG, BD, [content size], [dictionary id], HC */
+		if (srcend - sp < 3)
+			goto corrupted;
+		flags = sp[0];
+		if ((flags & 0xc0) != 0x40)		/* version must be 01 */
+			goto corrupted;
+		if ((flags & 0x01) != 0)
+		{
+			STROM_EREPORT(kcxt, ERRCODE_STROM_DATA_CORRUPTION,
+						  "LZ4 frame with dictionary is not supported");
+			return false;
+		}
+		hsize = 3 + ((flags & 0x08) != 0 ? 8 : 0);
+		if (srcend - sp < hsize)
+			goto corrupted;
+		sp += hsize;
+
+		/* data blocks */
+		for (;;)
+		{
+			if (srcend - sp < 4)
+				goto corrupted;
+			bsize = __lz4_read_u32(sp);
+			sp += 4;
+			if (bsize == 0)
+				break;		/* EndMark */
+			if ((bsize & 0x7fffffffU) > srcend - sp)
+				goto corrupted;
+			if ((bsize & 0x80000000U) != 0)
+			{
+				/* uncompressed block */
+				bsize &= 0x7fffffffU;
+				if (bsize > dstend - dp)
+					goto corrupted;
+				for (i=lane_id; i < bsize; i += warpSize)
+					dp[i] = sp[i];
+				dp += bsize;
+				__syncwarp();
+			}
+			else if (!__lz4_block_decompress_warp(sp, sp + bsize,
+												  dst, &dp, dstend))
+				goto corrupted;
+			sp += bsize;
+			/* block checksum, if any */
+			if ((flags & 0x10) != 0)
+			{
+				if (srcend - sp < 4)
+					goto corrupted;
+				sp += 4;
+			}
+		}
+		/* content checksum, if any */
+		if ((flags & 0x04) != 0)
+		{
+			if (srcend - sp < 4)
+				goto corrupted;
+			sp += 4;
+		}
+	}
+	if (dp != dstend)
+		goto corrupted;
+	return true;
+
+corrupted:
+	STROM_EREPORT(kcxt, ERRCODE_STROM_DATA_CORRUPTION,
+				  "LZ4 compressed buffer is corrupted");
+	return false;
+}
+
+/*
+ * kern_arrow_decompress
+ *
+ * It decompresses the buffers listed on the kern_arrow_decomp table of
+ * the supplied KDS, then the following kernel can consume the KDS as if
+ * it is loaded without compression.
+ */
+KERNEL_FUNCTION(void)
+kern_arrow_decompress(kern_errorbuf *kerror,
+					  kern_data_store *kds)
+{
+	kern_arrow_decomp *kdecomp = KERN_DATA_STORE_ARROW_DECOMP(kds);
+	kern_context kcxt;
+	cl_uint		lane_id = get_lane_id();
+	cl_uint		index;
+
+	assert((get_local_size() & (warpSize - 1)) == 0);
+	memset(&kcxt, 0, offsetof(kern_context, vlbuf));
+	for (index = get_global_id() / warpSize;
+		 index < kdecomp->nitems;
+		 index += get_global_size() / warpSize)
+	{
+		kern_arrow_decomp_chunk *chunk = &kdecomp->chunks[index];
+		const cl_uchar *src = (const cl_uchar *)kds + chunk->src_offset;
+		cl_uchar   *dst = (cl_uchar *)kds + chunk->dst_offset;
+		size_t		i;
+
+		if (chunk->codec == KERN_ARROW_DECOMP__RAW)
+		{
+			if (chunk->src_length != chunk->dst_length)
+			{
+				STROM_EREPORT(&kcxt, ERRCODE_STROM_DATA_CORRUPTION,
+							  "uncompressed buffer length mismatch");
+				break;
+			}
+			for (i=lane_id; i < chunk->dst_length; i += warpSize)
+				dst[i] = src[i];
+		}
+		else if (chunk->codec == KERN_ARROW_DECOMP__LZ4_FRAME)
+		{
+			if (!__lz4_frame_decompress_warp(&kcxt,
+											 src, chunk->src_length,
+											 dst, chunk->dst_length))
+				break;
+		}
+		else
+		{
+			STROM_EREPORT(&kcxt, ERRCODE_STROM_DATA_CORRUPTION,
+						  "unsupported compression codec");
+			break;
+		}
+		/* the last offset must be in the range, if offsets array */
+		if (chunk->offsets_limit != ULONG_MAX)
+		{
+			__syncwarp();
+			if (((cl_uint *)dst)[chunk->offsets_nitems] > chunk->offsets_limit)
+			{
+				STROM_EREPORT(&kcxt, ERRCODE_STROM_DATA_CORRUPTION,
+							  "offsets array points out of the range");
+				break;
+			}
+		}
+	}
+	kern_writeback_error_status(kerror, &kcxt);
+}
+
 /*
  * kern_get_datum_xxx
  *
@@ -1155,6 +1417,163 @@ xmin_is_visible:
 	return true;
 }
 
+/*
+ * kern_check_visibility_heap
+ *
+ * It checks MVCC visibility of the heap tuple, on the page loaded by
+ * GPUDirect SQL without all-visible flag. It is a simplified version of
+ * HeapTupleSatisfiesMVCC(), and requests CPU fallback if visibility cannot
+ * be determined on the device side.
+ */
+#define __VISIBILITY__INVISIBLE		0
+#define __VISIBILITY__VISIBLE		1
+#define __VISIBILITY__UNKNOWN		2
+
+STATIC_INLINE(cl_bool)
+__xid_precedes(TransactionId xid1, TransactionId xid2)
+{
+	if (!TransactionIdIsNormal(xid1) || !TransactionIdIsNormal(xid2))
+		return (xid1 < xid2);
+	return ((cl_int)(xid1 - xid2) < 0);
+}
+
+STATIC_FUNCTION(cl_bool)
+__xid_is_current_xact(kern_parambuf *kparams, TransactionId xid)
+{
+	xidvector  *xvec = (xidvector *)
+		kparam_get_value(kparams, kparams->xactIdVector);
+
+	if (xvec)
+	{
+		for (int i=0; i < xvec->dim1; i++)
+		{
+			if (xid == xvec->values[i])
+				return true;
+		}
+	}
+	return false;
+}
+
+/* see XidInMVCCSnapshot() */
+STATIC_FUNCTION(cl_bool)
+__xid_in_snapshot(kern_snapshot *ksnap, TransactionId xid)
+{
+	if (__xid_precedes(xid, ksnap->xmin))
+		return false;
+	if (!__xid_precedes(xid, ksnap->xmax))
+		return true;
+	for (cl_uint i=0; i < ksnap->xcnt; i++)
+	{
+		if (xid == ksnap->xip[i])
+			return true;
+	}
+	return false;
+}
+
+STATIC_FUNCTION(cl_int)
+__xid_get_status(kern_snapshot *ksnap, TransactionId xid)
+{
+	cl_uchar   *clog = KERN_SNAPSHOT_CLOG(ksnap);
+	cl_uint		index = xid - ksnap->clog_base;
+
+	if (!TransactionIdIsNormal(xid) || index >= ksnap->clog_nxids)
+		return KERN_XACT_STATUS__IN_PROGRESS;
+	return (clog[index >> 2] >> ((index & 3) << 1)) & 0x03;
+}
+
+STATIC_FUNCTION(cl_int)
+__heap_tuple_satisfies_mvcc(kern_parambuf *kparams,
+							kern_snapshot *ksnap,
+							HeapTupleHeaderData *htup)
+{
+	cl_ushort	infomask = htup->t_infomask;
+	TransactionId xmin = htup->t_choice.t_heap.t_xmin;
+	TransactionId xmax = htup->t_choice.t_heap.t_xmax;
+
+	if ((infomask & HEAP_XMIN_COMMITTED) == 0)
+	{
+		if ((infomask & HEAP_XMIN_INVALID) != 0)
+			return __VISIBILITY__INVISIBLE;
+		if ((infomask & (HEAP_MOVED_OFF | HEAP_MOVED_IN)) != 0 ||
+			__xid_is_current_xact(kparams, xmin))
+			return __VISIBILITY__UNKNOWN;
+		if (__xid_in_snapshot(ksnap, xmin))
+			return __VISIBILITY__INVISIBLE;
+		switch (__xid_get_status(ksnap, xmin))
+		{
+			case KERN_XACT_STATUS__COMMITTED:
+				break;
+			case KERN_XACT_STATUS__ABORTED:
+				return __VISIBILITY__INVISIBLE;
+			default:
+				return __VISIBILITY__UNKNOWN;
+		}
+	}
+	else if ((infomask & HEAP_XMIN_INVALID) == 0)
+	{
+		/* xmin is committed, but maybe not according to our snapshot */
+		if (__xid_in_snapshot(ksnap, xmin))
+			return __VISIBILITY__INVISIBLE;
+	}
+	/* by here, the inserting transaction has committed */
+	if ((infomask & HEAP_XMAX_INVALID) != 0 ||
+		(infomask & HEAP_XMAX_LOCK_ONLY) != 0 ||
+		(infomask & (HEAP_XMAX_IS_MULTI |
+					 HEAP_XMAX_EXCL_LOCK |
+					 HEAP_XMAX_KEYSHR_LOCK)) == HEAP_XMAX_EXCL_LOCK)
+		return __VISIBILITY__VISIBLE;	/* see HEAP_XMAX_IS_LOCKED_ONLY */
+	if ((infomask & HEAP_XMAX_IS_MULTI) != 0 ||
+		__xid_is_current_xact(kparams, xmax))
+		return __VISIBILITY__UNKNOWN;
+	if (__xid_in_snapshot(ksnap, xmax))
+		return __VISIBILITY__VISIBLE;
+	if ((infomask & HEAP_XMAX_COMMITTED) == 0)
+	{
+		switch (__xid_get_status(ksnap, xmax))
+		{
+			case KERN_XACT_STATUS__COMMITTED:
+				break;
+			case KERN_XACT_STATUS__ABORTED:
+				return __VISIBILITY__VISIBLE;
+			default:
+				return __VISIBILITY__UNKNOWN;
+		}
+	}
+	return __VISIBILITY__INVISIBLE;
+}
+
+DEVICE_FUNCTION(cl_bool)
+kern_check_visibility_heap(kern_context *kcxt,
+						   PageHeaderData *pg_page,
+						   HeapTupleHeaderData *htup)
+{
+	kern_parambuf  *kparams = kcxt->kparams;
+	kern_snapshot  *ksnap;
+
+	if ((pg_page->pd_flags & PD_ALL_VISIBLE) != 0)
+		return true;
+	ksnap = (kern_snapshot *)
+		kparam_get_value(kparams, kparams->xactSnapshot);
+	if (ksnap)
+	{
+		switch (__heap_tuple_satisfies_mvcc(kparams, ksnap, htup))
+		{
+			case __VISIBILITY__VISIBLE:
+				return true;
+			case __VISIBILITY__INVISIBLE:
+				return false;
+			default:
+				break;
+		}
+	}
+	STROM_CPU_FALLBACK(kcxt, ERRCODE_STROM_VISIBILITY_UNKNOWN,
+					   "tuple visibility is not determined on device");
+	return false;
+}
+#undef __VISIBILITY__INVISIBLE
+#undef __VISIBILITY__VISIBLE
+#undef __VISIBILITY__UNKNOWN
+
 /*
  * Routines to reference values on KDS_FORMAT_ARROW for base types.
  * Usually, these routines are referenced via pg_datum_ref_arrow().
@@ -386,6 +386,7 @@ __volatileWrite(volatile T *ptr, T val)
 #define ERRCODE_STROM_DATA_CORRUPTION		MAKE_SQLSTATE('H','D','B','0','7')
 #define ERRCODE_STROM_VARLENA_UNSUPPORTED	MAKE_SQLSTATE('H','D','B','0','8')
 #define ERRCODE_STROM_RECURSION_TOO_DEEP	MAKE_SQLSTATE('H','D','B','0','9')
+#define ERRCODE_STROM_VISIBILITY_UNKNOWN	MAKE_SQLSTATE('H','D','B','1','0')
 
 #define KERN_ERRORBUF_FILENAME_LEN		24
 #define KERN_ERRORBUF_FUNCNAME_LEN		64
@@ -399,6 +400,28 @@ typedef struct
 	char		message[KERN_ERRORBUF_MESSAGE_LEN];
 } kern_errorbuf;
 
+/*
+ * kern_profile - per-stage cycle counters of the device kernel
+ *
+ * It is valid only when the device code is built with
+ * pg_strom.debug_kernel_profiling. Each thread accumulates clock64()
+ * cycles consumed since the previous KERN_PROFILE_STAGE() mark onto the
+ * stage, then KERN_PROFILE_FLUSH() writes back the counters of the first
+ * thread of the block. Since the main loops of GPU kernels are synchronized
+ * per block, it is the block-level elapsed cycles, not a sum of threads.
+ */
+#define KERN_PROFILE__LOAD			0	/* fetch / visibility checks */
+#define KERN_PROFILE__QUALS			1	/* WHERE-clause evaluation */
+#define KERN_PROFILE__JOIN			2	/* hash probe / nest-loop / gist */
+#define KERN_PROFILE__PROJECTION	3	/* projection and result store */
+#define KERN_PROFILE__ATOMICS		4	/* buffer allocation by atomics */
+#define KERN_PROFILE__NUM_STAGES	5
+
+typedef struct
+{
+	cl_ulong		cycles[KERN_PROFILE__NUM_STAGES];
+} kern_profile;
+
 /*
  * kern_context - a set of run-time information
  */
@@ -413,11 +436,45 @@ typedef struct
 	const char	   *error_message;	/* !!only const static cstring!! */
 	struct kern_parambuf *kparams;
 	void		   *stack_bounds;
+#ifdef PGSTROM_KERNEL_PROFILING
+	/*
+	 * NOTE: kern_context is shared between the run-time compiled code and
+	 * the pre-built libraries, so the profiling build links *.pfatbin that
+	 * is also built with PGSTROM_KERNEL_PROFILING.
+	 */
+	cl_ulong		prof_clock;
+	cl_ulong		prof_cycles[KERN_PROFILE__NUM_STAGES];
+#endif
 	cl_char		   *vlpos;
 	cl_char		   *vlend;
 	cl_char			vlbuf[1];
 } kern_context;
 
+#if defined(__CUDACC__) && defined(PGSTROM_KERNEL_PROFILING)
+#define KERN_PROFILE_INIT(kcxt)							\
+	((kcxt)->prof_clock = clock64())
+#define KERN_PROFILE_STAGE(kcxt,stage)					\
+	do {												\
+		cl_ulong	__curr = clock64();					\
+														\
+		(kcxt)->prof_cycles[(stage)] += __curr - (kcxt)->prof_clock;	\
+		(kcxt)->prof_clock = __curr;					\
+	} while(0)
+#define KERN_PROFILE_FLUSH(kprof,kcxt)					\
+	do {												\
+		if (get_local_id() == 0)						\
+		{												\
+			for (int __i=0; __i < KERN_PROFILE__NUM_STAGES; __i++)	\
+				atomicAdd(&(kprof)->cycles[__i],		\
+						  (kcxt)->prof_cycles[__i]);	\
+		}												\
+	} while(0)
+#else
+#define KERN_PROFILE_INIT(kcxt)				((void)0)
+#define KERN_PROFILE_STAGE(kcxt,stage)		((void)0)
+#define KERN_PROFILE_FLUSH(kprof,kcxt)		((void)0)
+#endif
+
 /*
  * Usually, kern_context is declared at the auto-generated portion,
  * then its pointer shall be passed to the pre-built GPU binary part.
@@ -442,6 +499,7 @@ typedef struct
 		(kcxt)->stack_bounds = (char *)(kcxt) - KERN_CONTEXT_STACK_LIMIT; \
 		(kcxt)->vlpos = (kcxt)->vlbuf;									\
 		(kcxt)->vlend = (kcxt)->vlbuf + KERN_CONTEXT_VARLENA_BUFSZ;		\
+		KERN_PROFILE_INIT(kcxt);										\
 	} while(0)
 
 #define PTR_ON_VLBUF(kcxt,ptr,len)							\
@@ -702,6 +760,8 @@ typedef struct IndexAttributeBitMapData
 typedef cl_uint		TransactionId;
 #define InvalidTransactionId		((TransactionId) 0)
 #define FrozenTransactionId			((TransactionId) 2)
+#define FirstNormalTransactionId	((TransactionId) 3)
+#define TransactionIdIsNormal(xid)	((xid) >= FirstNormalTransactionId)
 #define InvalidCommandId			(~0U)
 #else
 #include "access/htup_details.h"
@@ -718,6 +778,37 @@ typedef struct
 	TransactionId values[FLEXIBLE_ARRAY_MEMBER];
 } xidvector;
 
+/*
+ * kern_snapshot
+ *
+ * MVCC snapshot of the scan, to check visibility of the heap tuples on
+ * the blocks that are loaded by GPUDirect SQL but not all-visible.
+ * xip[] contains both of the top-level and sub-transaction IDs in progress.
+ * A slice of CLOG, 2bits per XID in the range of [clog_base, xmax), follows
+ * the xip[] array; it is a hint for XIDs without HEAP_XMIN/XMAX_* bits.
+ * XIDs out of the range, tuples inserted/deleted by the current transaction
+ * or multixact shall be checked by CPU fallback.
+ */
+typedef struct
+{
+	cl_int		vl_len_;		/* varlena header */
+	TransactionId xmin;			/* all XID < xmin are visible to me */
+	TransactionId xmax;			/* all XID >= xmax are invisible to me */
+	cl_uint		xcnt;			/* # of XIDs in xip[] */
+	TransactionId clog_base;	/* first XID of the CLOG slice */
+	cl_uint		clog_nxids;		/* # of XIDs in the CLOG slice */
+	TransactionId xip[FLEXIBLE_ARRAY_MEMBER];
+} kern_snapshot;
+
+#define KERN_SNAPSHOT_CLOG(ksnap)					\
+	((cl_uchar *)((ksnap)->xip + (ksnap)->xcnt))
+#define KERN_SNAPSHOT_LENGTH(xcnt,clog_nxids)		\
+	(offsetof(kern_snapshot, xip[(xcnt)]) + ((clog_nxids) + 3) / 4)
+#define KERN_XACT_STATUS__IN_PROGRESS	0x00	/* or unknown */
+#define KERN_XACT_STATUS__COMMITTED		0x01
+#define KERN_XACT_STATUS__ABORTED		0x02
+#define KERN_XACT_STATUS__SUB_COMMITTED	0x03
+
 #ifdef __CUDACC__
 /* definitions at storage/itemid.h */
 typedef struct ItemIdData
@@ -1261,17 +1352,90 @@ kern_fetch_varlena_datum_arrow(kern_colmeta *cmeta,
 			return NULL;
 	}
 	Assert(cmeta->values_offset > 0 &&
-		   cmeta->extra_offset > 0 &&
-		   sizeof(cl_uint) * (index+1) <= __kds_unpack(cmeta->values_length));
+		   cmeta->extra_offset > 0);
 	offset = (cl_uint *)(base + __kds_unpack(cmeta->values_offset));
 	extra = base + __kds_unpack(cmeta->extra_offset);
 
-	Assert(offset[index] <= offset[index+1] &&
-		   offset[index+1] <= __kds_unpack(cmeta->extra_length));
+	if (cmeta->attopts.dictionary.index_width > 0)
+	{
+		/* dictionary-encoded; the index value points the dictionary */
+		cl_char	   *ivalues = (cl_char *)offset;
+		cl_ulong	dindex;
+
+		switch (cmeta->attopts.dictionary.index_width)
+		{
+			case sizeof(cl_uchar):
+				dindex = ((cl_uchar *)ivalues)[index];
+				break;
+			case sizeof(cl_ushort):
+				dindex = ((cl_ushort *)ivalues)[index];
+				break;
+			case sizeof(cl_uint):
+				dindex = ((cl_uint *)ivalues)[index];
+				break;
+			default:
+				dindex = ((cl_ulong *)ivalues)[index];
+				break;
+		}
+		if (dindex >= cmeta->attopts.dictionary.dict_nitems)
+			return NULL;	/* corrupted index */
+		index = dindex;
+		offset = (cl_uint *)extra;
+		extra += cmeta->attopts.dictionary.dict_data_offset;
+		Assert(offset[index] <= offset[index+1] &&
+			   cmeta->attopts.dictionary.dict_data_offset +
+			   offset[index+1] <= __kds_unpack(cmeta->extra_length));
+	}
+	else
+	{
+		Assert(sizeof(cl_uint) * (index+1) <= __kds_unpack(cmeta->values_length));
+		Assert(offset[index] <= offset[index+1] &&
+			   offset[index+1] <= __kds_unpack(cmeta->extra_length));
+	}
 	*p_length = offset[index+1] - offset[index];
 	return (extra + offset[index]);
 }
 
+/*
+ * kern_arrow_decomp
+ *
+ * A table of compressed buffers of KDS_FORMAT_ARROW, to be decompressed
+ * on the device side prior to the main kernel. It is located just after
+ * the KDS header, then the destination buffers (pointed by colmeta[]) and
+ * the compressed images (loaded by P2P DMA or host) follow.
+ */
+typedef struct
+{
+	cl_ulong	src_offset;		/* offset of the compressed image from kds */
+	cl_ulong	src_length;		/* length of the compressed image */
+	cl_ulong	dst_offset;		/* offset of the destination from kds */
+	cl_ulong	dst_length;		/* length of the decompressed image */
+	cl_ulong	offsets_limit;	/* upper limit of the last offset, or
+								 * ULONG_MAX if not an offsets array */
+	cl_uint		offsets_nitems;	/* offsets[nitems] is the last offset */
+	cl_int		codec;			/* one of KERN_ARROW_DECOMP__* */
+} kern_arrow_decomp_chunk;
+
+#define KERN_ARROW_DECOMP__RAW			(-1)	/* not compressed actually */
+#define KERN_ARROW_DECOMP__LZ4_FRAME	0		/* ArrowCompressionType */
+
+typedef struct
+{
+	cl_uint		nitems;			/* number of chunks */
+	cl_uint		__padding__;
+	kern_arrow_decomp_chunk chunks[FLEXIBLE_ARRAY_MEMBER];
+} kern_arrow_decomp;
+
+#define KERN_ARROW_DECOMP_LENGTH(nitems)							\
+	STROMALIGN(offsetof(kern_arrow_decomp, chunks[(nitems)]))
+
+STATIC_INLINE(kern_arrow_decomp *)
+KERN_DATA_STORE_ARROW_DECOMP(kern_data_store *kds)
+{
+	Assert(kds->format == KDS_FORMAT_ARROW);
+	return (kern_arrow_decomp *)KERN_DATA_STORE_BODY(kds);
+}
+
 /*
  * kern_parambuf
  *
@@ -1286,6 +1450,7 @@ typedef struct kern_parambuf
 	 */
 	cl_long		xactStartTimestamp;	/* timestamp when transaction start */
 	cl_uint		xactIdVector;		/* offset to xidvector */
+	cl_uint		xactSnapshot;		/* offset to kern_snapshot */
 
 	/* variable length parameters / constants */
 	cl_uint		length;		/* total length of parambuf */
@@ -1758,6 +1923,12 @@ pglz_decompress(const char *source, cl_int slen,
 DEVICE_FUNCTION(cl_bool)
 toast_decompress_datum(char *buffer, cl_uint buflen,
 					   const varlena *datum);
+/*
+ * kernel function to decompress KDS_FORMAT_ARROW buffers
+ */
+KERNEL_FUNCTION(void)
+kern_arrow_decompress(kern_errorbuf *kerror,
+					  kern_data_store *kds);
 /*
  * device functions to reference a particular datum in a tuple
  */
@@ -1773,6 +1944,10 @@ DEVICE_FUNCTION(cl_bool)
 kern_check_visibility_column(kern_context *kcxt,
 							 kern_data_store *kds,
 							 cl_uint rowidx);
+DEVICE_FUNCTION(cl_bool)
+kern_check_visibility_heap(kern_context *kcxt,
+						   PageHeaderData *pg_page,
+						   HeapTupleHeaderData *htup);
 /*
  * device functions to form/deform HeapTuple
  */
@@ -304,11 +304,29 @@ gpucache_apply_insert(kern_context *kcxt,
 
 		if (j >= natts || (tup_hasnull && att_isnull(j, htup->t_bits)))
 		{
+			if (cmeta->values_offset == 0)
+				continue;		/* column is not cached */
 			assert(cmeta->nullmap_offset != 0);
 			nullmap = (cl_uint *)((char *)kds + __kds_unpack(cmeta->nullmap_offset));
 			atomicAnd(&nullmap[rowid>>5], ~(1U << (rowid & 0x1f)));
 			continue;
 		}
+		else if (cmeta->values_offset == 0)
+		{
+			/* column is not cached, so just move to the next */
+			if (cmeta->attlen > 0)
+			{
+				pos = (char *)TYPEALIGN(cmeta->attalign, pos);
+				pos += cmeta->attlen;
+			}
+			else
+			{
+				if (!VARATT_NOT_PAD_BYTE(pos))
+					pos = (char *)TYPEALIGN(cmeta->attalign, pos);
+				pos += VARSIZE_ANY(pos);
+			}
+			continue;
+		}
 		else if (cmeta->nullmap_offset != 0)
 		{
 			nullmap = (cl_uint *)((char *)kds + __kds_unpack(cmeta->nullmap_offset));
@@ -792,35 +810,51 @@ kern_gpucache_apply_redo(kern_gpucache_redolog *redo,
 	kern_writeback_error_status(&redo->kerror, &kcxt);
 }
 
+/*
+ * kern_gpucache_compaction
+ *
+ * It copies the varlena datum in rows [row_base, row_base + row_nums)
+ * to the new extra buffer. The new offsets are written to the shadow
+ * values array (for the k-th varlena column, at shadow + k * nrooms),
+ * not to the main store, so concurrent readers can still walk on the
+ * old extra buffer until host code swaps them.
+ */
 KERNEL_FUNCTION(void)
 kern_gpucache_compaction(kern_data_store *kds,
 						 kern_data_extra *old_extra,
-						 kern_data_extra *new_extra)
+						 kern_data_extra *new_extra,
+						 cl_uint *shadow,
+						 cl_uint row_base,
+						 cl_uint row_nums)
 {
-	
 	__shared__ cl_uint required;
 	__shared__ cl_ulong extra_base;
 	cl_uint		nloops;
+	cl_uint		row_limit = Min(row_base + row_nums, kds->nitems);
+	cl_uint	   *values = shadow;
 
-	nloops = (kds->nitems + get_global_size() - 1) / get_global_size();
+	nloops = (row_nums + get_global_size() - 1) / get_global_size();
 	for (int j=0; j < kds->ncols; j++)
 	{
 		kern_colmeta *cmeta = &kds->colmeta[j];
+		cl_uint	   *vindex;
 
 		if (cmeta->attbyval || cmeta->attlen != -1)
 			continue;		/* not varlena */
+		if (cmeta->values_offset == 0)
+			continue;		/* not cached */
+		vindex = (cl_uint *)((char *)kds + __kds_unpack(cmeta->values_offset));
 		for (int loop=0; loop < nloops; loop++)
 		{
 			GpuCacheSysattr *sysattr;
-			cl_uint		rowid = loop * get_global_size() + get_global_id();
+			cl_uint		rowid = row_base + loop * get_global_size() + get_global_id();
 			cl_bool		isnull = false;
-			cl_uint	   *values;
 			char	   *orig = NULL;
 			char	   *dest;
 			cl_uint		sz, l_off = 0;
 
 			sysattr = kds_get_column_sysattr(kds, rowid);
-			if (rowid >= kds->nitems)
+			if (rowid >= row_limit)
 				isnull = true;		/* out of range */
 			else if (sysattr->xmin == InvalidTransactionId ||
 					 sysattr->xmax == FrozenTransactionId)
@@ -832,14 +866,13 @@ kern_gpucache_compaction(kern_data_store *kds,
 				if ((nullmap[rowid>>5] & (1U << (rowid & 0x1f))) == 0)
 					isnull = true;
 			}
-			values = (cl_uint *)((char *)kds + __kds_unpack(cmeta->values_offset));
 			/* copy the varlena to new extra buffer */
 			if (get_local_id() == 0)
 				required = 0;
 			__syncthreads();
 			if (!isnull)
 			{
-				orig = (char *)old_extra + __kds_unpack(values[rowid]);
+				orig = (char *)old_extra + __kds_unpack(vindex[rowid]);
 				sz = VARSIZE_ANY(orig);
 				assert(orig > (char *)old_extra &&
 					   orig + sz <= (char *)old_extra + old_extra->length);
@@ -852,7 +885,7 @@ kern_gpucache_compaction(kern_data_store *kds,
 			dest = (char *)new_extra + extra_base + l_off;
 			if (isnull)
 			{
-				if (rowid < kds->nitems)
+				if (rowid < row_limit)
 					values[rowid] = 0;
 			}
 			else if (dest + sz <= (char *)new_extra + new_extra->length)
@@ -865,5 +898,6 @@ kern_gpucache_compaction(kern_data_store *kds,
 				assert(new_extra->length == 0);
 			}
 		}
+		values += kds->nrooms;
 	}
 }
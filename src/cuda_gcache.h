@@ -69,6 +69,23 @@ struct GpuCacheSysattr
 };
 typedef struct GpuCacheSysattr	GpuCacheSysattr;
 
+/*
+ * GpuCacheIpcHandle
+ *
+ * A token returned by pgstrom.gpucache_export_ipchandle(), to map the main
+ * buffer (KDS_FORMAT_COLUMN) of GPU cache from the external process.
+ */
+#define GPUCACHE_IPC_HANDLE_MAGIC	0xEBAD7C10
+typedef struct
+{
+	cl_int		vl_len_;		/* varlena header (do not touch directly!) */
+	cl_uint		magic;			/* = GPUCACHE_IPC_HANDLE_MAGIC */
+	cl_int		cuda_device_id;	/* device ordinal of the GPU cache */
+	cl_uint		table_oid;		/* OID of the source table */
+	cl_ulong	main_size;		/* length of the main buffer */
+	char		ipc_mhandle[64];	/* CUipcMemHandle of the main buffer */
+} GpuCacheIpcHandle;
+
 /*
  * kds_get_column_sysattr
  */
@@ -234,7 +234,9 @@ gpujoin_load_source(kern_context *kcxt,
 			if (line_no <= n_lines)
 			{
 				ItemIdData *lpp = PageGetItemId(pg_page, line_no);
-				if (ItemIdIsNormal(lpp))
+				if (ItemIdIsNormal(lpp) &&
+					kern_check_visibility_heap(kcxt, pg_page,
+											   PageGetItem(pg_page, lpp)))
 				{
 					t_offset = (cl_uint)((char *)lpp - (char *)kds_src);
 					t_self.ip_blkid.bi_hi = block_nr >> 16;
@@ -602,6 +604,116 @@ gpupreagg_projection_slot(kern_context *kcxt_gpreagg,
 						  Datum   *src_values,
 						  cl_char *dst_dclass,
 						  Datum   *dst_values);
+/* to be defined by cuda_gpupreagg.cu */
+DEVICE_FUNCTION(void)
+gpupreagg_nogroup_combined_update(cl_char *p_dclass,
+								  Datum   *p_values,
+								  cl_char *tup_dclass,
+								  Datum   *tup_values);
+DEVICE_FUNCTION(void)
+gpupreagg_nogroup_combined_merge(struct kern_gpupreagg *kgpreagg,
+								 kern_data_store *kds_final,
+								 cl_char *p_dclass,
+								 Datum   *p_values);
+
+/*
+ * gpujoin_projection_nogroup
+ *
+ * It runs the initial projection of GpuPreAgg on the joined rows, then
+ * accumulates them on the private buffer of the fused NoGroup reduction.
+ * Unlike gpujoin_projection_slot, nothing is written to kds_dst, so it
+ * never suspends the kernel.
+ */
+STATIC_FUNCTION(cl_int)
+gpujoin_projection_nogroup(kern_context *kcxt,
+						   kern_parambuf *kparams_gpreagg,
+						   gpujoinNoGroupState *nogroup,
+						   kern_gpujoin *kgjoin,
+						   kern_multirels *kmrels,
+						   kern_data_store *kds_src,
+						   kern_data_extra *kds_extra,
+						   kern_data_store *kds_dst,
+						   cl_uint *rd_stack,
+						   cl_uint *l_state,
+						   cl_bool *matched)
+{
+	kern_parambuf *kparams_saved = kcxt->kparams;
+	cl_uint		nrels = kgjoin->num_rels;
+	cl_uint		read_index;
+	cl_uint		nvalids;
+	cl_char	   *tup_dclass = NULL;
+	Datum	   *tup_values = NULL;
+	cl_uint	   *tup_extras = NULL;
+	cl_char	   *dst_dclass = NULL;
+	Datum	   *dst_values = NULL;
+
+	/* sanity checks */
+	assert(rd_stack != NULL);
+
+	/* Any more result rows to be accumulated? */
+	if (read_pos[nrels] >= write_pos[nrels])
+		return gpujoin_rewind_stack(kgjoin, nrels, l_state, matched);
+
+	/* Allocation of tup_dclass/values/extra, and projection by GpuPreAgg */
+	tup_dclass = (cl_char *)
+		kern_context_alloc(kcxt, sizeof(cl_char) * kds_dst->ncols);
+	tup_values = (Datum *)
+		kern_context_alloc(kcxt, sizeof(Datum) * kds_dst->ncols);
+	tup_extras = (cl_uint *)
+		kern_context_alloc(kcxt, sizeof(cl_uint) * kds_dst->ncols);
+	dst_dclass = (cl_char *)
+		kern_context_alloc(kcxt, sizeof(cl_char) * kds_dst->ncols);
+	dst_values = (Datum *)
+		kern_context_alloc(kcxt, sizeof(Datum) * kds_dst->ncols);
+	if (!tup_dclass || !tup_values || !tup_extras || !dst_dclass || !dst_values)
+		STROM_EREPORT(kcxt, ERRCODE_OUT_OF_MEMORY, "out of memory");
+	if (__syncthreads_count(kcxt->errcode) > 0)
+		return -1;		/* bailout GpuJoin */
+
+	/* pick up combinations from the pseudo-stack */
+	nvalids = Min(write_pos[nrels] - read_pos[nrels],
+				  get_local_size());
+	read_index = read_pos[nrels] + get_local_id();
+	__syncthreads();
+
+	if (read_index < write_pos[nrels])
+	{
+		rd_stack += read_index * (nrels + 1);
+
+		/*
+		 * Datum references by the projection are valid until the end of
+		 * this function, so no need to copy them to the kds_dst.
+		 */
+		gpujoin_projection(kcxt,
+						   kds_src,
+						   kds_extra,
+						   kmrels,
+						   rd_stack,
+						   kds_dst,
+						   tup_dclass,
+						   tup_values,
+						   tup_extras);
+		kcxt->kparams = kparams_gpreagg;
+		gpupreagg_projection_slot(kcxt,
+								  tup_dclass,
+								  tup_values,
+								  dst_dclass,
+								  dst_values);
+		kcxt->kparams = kparams_saved;
+		if (kcxt->errcode == 0)
+			gpupreagg_nogroup_combined_update(nogroup->p_dclass,
+											  nogroup->p_values,
+											  dst_dclass,
+											  dst_values);
+	}
+	if (__syncthreads_count(kcxt->errcode) > 0)
+		return -1;	/* bailout */
+
+	/* make advance the read position */
+	if (get_local_id() == 0)
+		read_pos[nrels] += nvalids;
+	return nrels + 1;
+}
 
 /*
  * gpujoin_projection_slot
@@ -795,6 +907,8 @@ gpujoin_exec_nestloop(kern_context *kcxt,
 	cl_uint			wr_index;
 	cl_uint			count;
 	cl_bool			result = false;
+	cl_bool			semi_or_anti;
+	cl_bool			skip_quals = false;
 	__shared__ cl_bool matched_sync[MAXTHREADS_PER_BLOCK];
 
 	assert(kds_in->format == KDS_FORMAT_ROW);
@@ -826,31 +940,60 @@ gpujoin_exec_nestloop(kern_context *kcxt,
 	x_index = get_local_id() % x_unitsz;
 	y_index = get_local_id() / x_unitsz;
 
+	/*
+	 * In case of SEMI/ANTI JOIN, outer combinations that already found
+	 * a matched inner tuple don't need to evaluate join-quals any more.
+	 * If all of them are matched, we can skip the rest of inner tuples.
+	 */
+	semi_or_anti = (KERN_MULTIRELS_SEMI_JOIN(kmrels, depth) ||
+					KERN_MULTIRELS_ANTI_JOIN(kmrels, depth));
+	if (semi_or_anti)
+	{
+		if (get_local_id() < x_unitsz)
+			matched_sync[get_local_id()] = false;
+		__syncthreads();
+		if (matched[depth])
+			matched_sync[x_index] = true;
+		if (__syncthreads_count(!matched_sync[x_index]) == 0)
+			l_state[depth] = (kds_in->nitems + y_unitsz - 1) / y_unitsz;
+		skip_quals = matched_sync[x_index];
+		__syncthreads();
+	}
+
 	if (y_unitsz * l_state[depth] >= kds_in->nitems)
 	{
 		/*
 		 * In case of LEFT OUTER JOIN, we need to check whether the outer
 		 * combination had any matched inner tuples, or not.
+		 * SEMI/ANTI JOIN also generate the results here, because only one
+		 * tuple shall be generated for each outer combination.
 		 */
-		if (KERN_MULTIRELS_LEFT_OUTER_JOIN(kmrels, depth))
+		if (KERN_MULTIRELS_LEFT_OUTER_JOIN(kmrels, depth) || semi_or_anti)
 		{
+			cl_bool		is_valid;
+
 			if (get_local_id() < x_unitsz)
 				matched_sync[get_local_id()] = false;
 			__syncthreads();
 			if (matched[depth])
 				matched_sync[x_index] = true;
-			if (__syncthreads_count(!matched_sync[x_index]) > 0)
+			__syncthreads();
+			if (KERN_MULTIRELS_SEMI_JOIN(kmrels, depth))
+				is_valid = matched_sync[x_index];
+			else
+				is_valid = !matched_sync[x_index];
+			if (__syncthreads_count(is_valid) > 0)
 			{
 				if (y_index == 0 && y_index < y_unitsz)
-					result = !matched_sync[x_index];
+					result = is_valid;
 				else
 					result = false;
 				/* adjust x_index and rd_stack as usual */
 				x_index += read_pos[depth-1];
 				assert(x_index < write_pos[depth-1]);
 				rd_stack += (x_index * depth);
-				/* don't generate LEFT OUTER tuple any more */
-				matched[depth] = true;
+				/* don't generate LEFT OUTER/SEMI/ANTI tuple any more */
+				matched[depth] = !KERN_MULTIRELS_SEMI_JOIN(kmrels, depth);
 				goto left_outer;
 			}
 		}
@@ -868,7 +1011,7 @@ gpujoin_exec_nestloop(kern_context *kcxt,
 	if (x_index < write_pos[depth-1] && y_index < y_unitsz)
 	{
 		y_index += y_unitsz * l_state[depth];
-		if (y_index < kds_in->nitems)
+		if (y_index < kds_in->nitems && !skip_quals)
 		{
 			tupitem = KERN_DATA_STORE_TUPITEM(kds_in, y_index);
 
@@ -886,6 +1029,9 @@ gpujoin_exec_nestloop(kern_context *kcxt,
 				if (oj_map && !oj_map[y_index])
 					oj_map[y_index] = true;
 			}
+			/* SEMI/ANTI JOIN generate the results at the end */
+			if (semi_or_anti)
+				result = false;
 		}
 	}
 	l_state[depth]++;
@@ -916,6 +1062,117 @@ left_outer:
 	return depth + 1;
 }
 
+/*
+ * gpujoin_exec_hashjoin_skew
+ *
+ * It probes the inner rows of the heavy-hitter key cooperatively by all the
+ * threads in the block, for the first outer row that is waiting for.
+ * The waiting thread shall advance its l_state by the block size, then
+ * finally marks UINT_MAX when all the inner rows are probed.
+ */
+STATIC_FUNCTION(cl_int)
+gpujoin_exec_hashjoin_skew(kern_context *kcxt,
+						   kern_multirels *kmrels,
+						   kern_data_store *kds_src,
+						   kern_data_extra *kds_extra,
+						   cl_int depth,
+						   cl_uint *rd_stack,
+						   cl_uint *wr_stack,
+						   cl_uint *l_state)
+{
+	kern_data_store	   *kds_hash = KERN_MULTIRELS_INNER_KDS(kmrels, depth);
+	cl_bool			   *oj_map = KERN_MULTIRELS_OUTER_JOIN_MAP(kmrels, depth);
+	cl_uint			   *row_index = KERN_DATA_STORE_ROWINDEX(kds_hash);
+	const kern_hashskew *hskew;
+	cl_uint				t_offset = UINT_MAX;
+	cl_uint				row_end;
+	cl_uint				rowid;
+	cl_uint				wr_index;
+	cl_uint				count;
+	cl_bool				result = false;
+	__shared__ cl_uint	skew_owner;
+	__shared__ cl_uint	skew_state;
+
+	/* pick up the first thread waiting for the cooperative probe */
+	if (get_local_id() == 0)
+		skew_owner = UINT_MAX;
+	__syncthreads();
+	if (l_state[depth] != UINT_MAX)
+		atomicMin(&skew_owner, get_local_id());
+	__syncthreads();
+	assert(skew_owner < get_local_size());
+	if (get_local_id() == skew_owner)
+		skew_state = l_state[depth];
+	__syncthreads();
+	assert((skew_state & GPUJOIN_HASH_SKEW_LSTATE) != 0);
+
+	rowid = (skew_state & ~GPUJOIN_HASH_SKEW_LSTATE);
+	hskew = gpujoin_hash_skew_lookup_rowid(kmrels, depth, rowid);
+	assert(hskew != NULL);
+	row_end = hskew->row_base + hskew->nitems;
+	rd_stack += (read_pos[depth-1] + skew_owner) * depth;
+
+	rowid += get_local_id();
+	if (rowid < row_end)
+	{
+		kern_hashitem  *khitem = (kern_hashitem *)
+			((char *)kds_hash + __kds_unpack(row_index[rowid])
+			 - offsetof(kern_hashitem, t));
+		cl_bool		joinquals_matched;
+
+		assert(khitem->hash == hskew->hash &&
+			   khitem->t.rowid == rowid);
+		result = gpujoin_join_quals(kcxt,
+									kds_src,
+									kds_extra,
+									kmrels,
+									depth,
+									rd_stack,
+									&khitem->t.htup,
+									&joinquals_matched);
+		if (joinquals_matched)
+		{
+			/* No RIGHT/FULL JOIN are needed */
+			if (oj_map && !oj_map[rowid])
+				oj_map[rowid] = true;
+		}
+		t_offset = __kds_packed((char *)&khitem->t.htup -
+								(char *)kds_hash);
+	}
+	/* make advance the position of the waiting thread */
+	if (get_local_id() == skew_owner)
+	{
+		rowid = (skew_state & ~GPUJOIN_HASH_SKEW_LSTATE) + get_local_size();
+		l_state[depth] = (rowid < row_end
+						  ? (GPUJOIN_HASH_SKEW_LSTATE | rowid)
+						  : UINT_MAX);
+	}
+
+	wr_index = write_pos[depth];
+	wr_index += pgstromStairlikeBinaryCount(result, &count);
+	if (get_local_id() == 0)
+	{
+		write_pos[depth] += count;
+		stat_nitems[depth] += count;
+	}
+	wr_stack += wr_index * (depth + 1);
+	if (result)
+	{
+		memcpy(wr_stack, rd_stack, sizeof(cl_uint) * depth);
+		wr_stack[depth] = t_offset;
+	}
+	/* count number of threads still in-progress */
+	count = __syncthreads_count(l_state[depth] != UINT_MAX);
+	if (get_local_id() == 0)
+		wip_count[depth] = count;
+	/* see the comment in gpujoin_exec_hashjoin */
+	wr_index = write_pos[depth];
+	__syncthreads();
+	if (wr_index + get_local_size() <= GPUJOIN_PSEUDO_STACK_NROOMS)
+		return depth;
+	return depth+1;
+}
+
 /*
  * gpujoin_exec_hashjoin
  */
@@ -941,6 +1198,8 @@ gpujoin_exec_hashjoin(kern_context *kcxt,
 	cl_uint				wr_index;
 	cl_uint				count;
 	cl_bool				result;
+	cl_bool				chain_done = false;
+	cl_bool				has_skew = (KERN_MULTIRELS_HASH_SKEW(kmrels, depth) != NULL);
 
 	assert(kds_hash->format == KDS_FORMAT_HASH);
 	assert(depth >= 1 && depth <= max_depth);
@@ -977,6 +1236,39 @@ gpujoin_exec_hashjoin(kern_context *kcxt,
 		/* elsewhere, dive into the deeper depth or projection */
 		return depth + 1;
 	}
+	else if (has_skew &&
+			 __syncthreads_count(l_state[depth] != UINT_MAX &&
+								 (l_state[depth] &
+								  GPUJOIN_HASH_SKEW_LSTATE) == 0) == 0)
+	{
+		/*
+		 * All the threads reached to the end of hash-slot chain, except for
+		 * the ones waiting for the cooperative probe on heavy-hitter keys.
+		 */
+		return gpujoin_exec_hashjoin_skew(kcxt,
+										  kmrels,
+										  kds_src,
+										  kds_extra,
+										  depth,
+										  rd_stack,
+										  wr_stack,
+										  l_state);
+	}
+	else if (depth > base_depth + 1 &&
+			 write_pos[depth-1] - read_pos[depth-1] < get_local_size() &&
+			 write_pos[depth-1] + get_local_size() <= GPUJOIN_PSEUDO_STACK_NROOMS &&
+			 (read_pos[depth-2] < write_pos[depth-2] || wip_count[depth-1] > 0) &&
+			 __syncthreads_count(l_state[depth] != 0) == 0)
+	{
+		/*
+		 * The next outer window is not filled up, so a part of threads shall
+		 * be idle during the walk on the hash-slot chain. If the upper depth
+		 * can generate more outer combinations, we can fill up the window
+		 * prior to the probe, because no thread begins the window yet and
+		 * all the deeper depths are already empty.
+		 */
+		return depth-1;
+	}
 	rd_index = read_pos[depth-1] + get_local_id();
 	rd_stack += (rd_index * depth);
 
@@ -994,9 +1286,30 @@ gpujoin_exec_hashjoin(kern_context *kcxt,
 											depth,
 											rd_stack,
 											&is_null_keys);
-			/* MEMO: NULL-keys will never match to inner-join */
-			if (!is_null_keys)
-				khitem = KERN_HASH_FIRST_ITEM(kds_hash, hash_value);
+			/*
+			 * MEMO: NULL-keys will never match to inner-join, and Bloom-
+			 * filter (if any) eliminates most of outer tuples that have
+			 * no matched inner tuples, without walk on the hash-slot chain.
+			 */
+			if (!is_null_keys &&
+				gpujoin_bloom_filter_test(kmrels, depth, hash_value))
+			{
+				const kern_hashskew *hskew = (!has_skew ? NULL :
+					gpujoin_hash_skew_lookup(kmrels, depth, hash_value));
+
+				if (hskew)
+				{
+					/* heavy-hitter key shall be probed cooperatively */
+					t_offset = (GPUJOIN_HASH_SKEW_LSTATE | hskew->row_base);
+				}
+				else if (KERN_MULTIRELS_HASH_BUCKETS(kmrels, depth))
+					khitem = gpujoin_hash_bucket_lookup(kmrels, depth,
+														kds_hash,
+														hash_value,
+														NULL);
+				else
+					khitem = KERN_HASH_FIRST_ITEM(kds_hash, hash_value);
+			}
 			/* rewind the varlena buffer */
 			kcxt->vlpos = kcxt->vlbuf;
 		}
@@ -1009,7 +1322,16 @@ gpujoin_exec_hashjoin(kern_context *kcxt,
 			l_state[depth] = UINT_MAX;
 		}
 	}
-	else if (l_state[depth] != UINT_MAX)
+	else if (l_state[depth] == UINT_MAX)
+	{
+		/* already reached to the end of hash-slot chain */
+	}
+	else if (has_skew && (l_state[depth] & GPUJOIN_HASH_SKEW_LSTATE) != 0)
+	{
+		/* still waiting for the cooperative probe */
+		t_offset = l_state[depth];
+	}
+	else
 	{
 		/* walks on the hash-slot chain */
 		khitem = (kern_hashitem *)((char *)kds_hash
@@ -1018,7 +1340,13 @@ gpujoin_exec_hashjoin(kern_context *kcxt,
 		hash_value = khitem->hash;
 
 		/* pick up next one if any */
-		khitem = KERN_HASH_NEXT_ITEM(kds_hash, khitem);
+		if (KERN_MULTIRELS_HASH_BUCKETS(kmrels, depth))
+			khitem = gpujoin_hash_bucket_lookup(kmrels, depth,
+												kds_hash,
+												hash_value,
+												khitem);
+		else
+			khitem = KERN_HASH_NEXT_ITEM(kds_hash, khitem);
 	}
 
 	while (khitem && khitem->hash != hash_value)
@@ -1047,22 +1375,35 @@ gpujoin_exec_hashjoin(kern_context *kcxt,
 			assert(khitem->t.rowid < kds_hash->nitems);
 			if (oj_map && !oj_map[khitem->t.rowid])
 				oj_map[khitem->t.rowid] = true;
+			/*
+			 * SEMI/ANTI JOIN don't need to walk on the hash-slot chain
+			 * any more once the outer row found its first pair.
+			 * ANTI JOIN never generates the matched combination.
+			 */
+			if (KERN_MULTIRELS_SEMI_JOIN(kmrels, depth))
+				chain_done = true;
+			else if (KERN_MULTIRELS_ANTI_JOIN(kmrels, depth))
+			{
+				result = false;
+				chain_done = true;
+			}
 		}
 		t_offset = __kds_packed((char *)&khitem->t.htup -
 								(char *)kds_hash);
 	}
-	else if (KERN_MULTIRELS_LEFT_OUTER_JOIN(kmrels, depth) &&
+	else if ((KERN_MULTIRELS_LEFT_OUTER_JOIN(kmrels, depth) ||
+			  KERN_MULTIRELS_ANTI_JOIN(kmrels, depth)) &&
 			 l_state[depth] != UINT_MAX &&
 			 !matched[depth])
 	{
-		/* No matched outer rows, but LEFT/FULL OUTER */
+		/* No matched outer rows, but LEFT/FULL OUTER or ANTI */
 		result = true;
 	}
 	else
 		result = false;
 
 	/* save the current hash item */
-	l_state[depth] = t_offset;
+	l_state[depth] = (chain_done ? UINT_MAX : t_offset);
 	wr_index = write_pos[depth];
 	wr_index += pgstromStairlikeBinaryCount(result, &count);
 	if (get_local_id() == 0)
@@ -1077,7 +1418,7 @@ gpujoin_exec_hashjoin(kern_context *kcxt,
 		wr_stack[depth] = (!khitem ? 0U : t_offset);
 	}
 	/* count number of threads still in-progress */
-	count = __syncthreads_count(khitem != NULL);
+	count = __syncthreads_count(l_state[depth] != UINT_MAX);
 	if (get_local_id() == 0)
 		wip_count[depth] = count;
 	/*
@@ -1167,6 +1508,82 @@ gpujoin_prep_gistindex(kern_multirels *kmrels, int depth)
 	}
 }
 
+/*
+ * gpujoin_build_hash_buckets
+ *
+ * It sets up the Bloom-filter and the open-addressing hash-buckets of the
+ * inner hash table on the device, from the kern_hashitems already loaded
+ * to the KDS_FORMAT_HASH. Both of the areas must be zero-cleared prior to
+ * the kernel launch. Each thread registers its own inner rows, and an empty
+ * entry of the hash-buckets is acquired by atomic operation.
+ */
+KERNEL_FUNCTION(void)
+gpujoin_build_hash_buckets(kern_multirels *kmrels, int depth)
+{
+	kern_data_store *kds_hash = KERN_MULTIRELS_INNER_KDS(kmrels, depth);
+	cl_uint		   *bloom = KERN_MULTIRELS_BLOOM_FILTER(kmrels, depth);
+	kern_hashbucket *hbuckets = KERN_MULTIRELS_HASH_BUCKETS(kmrels, depth);
+	cl_uint			bloom_nblocks = kmrels->chunks[depth-1].bloom_nblocks;
+	cl_uint			nbuckets = kmrels->chunks[depth-1].hbucket_nbuckets;
+	cl_uint		   *row_index = KERN_DATA_STORE_ROWINDEX(kds_hash);
+	cl_uint			rowid;
+
+	assert(kds_hash->format == KDS_FORMAT_HASH);
+	assert(depth >= 1 && depth <= kmrels->nrels);
+
+	for (rowid = get_global_id();
+		 rowid < kds_hash->nitems;
+		 rowid += get_global_size())
+	{
+		kern_hashitem *khitem = (kern_hashitem *)
+			((char *)kds_hash + __kds_unpack(row_index[rowid])
+			 - offsetof(kern_hashitem, t));
+		cl_uint		hash = khitem->hash;
+		cl_int		i;
+
+		if (bloom)
+		{
+			cl_uint	   *block;
+			cl_uint		masks[GPUJOIN_BLOOM_BLOCK_NWORDS];
+
+			block = bloom + GPUJOIN_BLOOM_BLOCK_NWORDS *
+				__gpujoin_bloom_block_index(hash, bloom_nblocks);
+			__gpujoin_bloom_block_masks(hash, masks);
+#pragma unroll
+			for (i=0; i < GPUJOIN_BLOOM_BLOCK_NWORDS; i++)
+				atomicOr(&block[i], masks[i]);
+		}
+
+		if (hbuckets)
+		{
+			cl_uint		self = __kds_packed((char *)khitem -
+											(char *)kds_hash);
+			cl_uint		bindex = __gpujoin_hash_bucket_index(hash, nbuckets);
+			cl_uint		loop;
+
+			for (loop=0; loop < nbuckets; loop++)
+			{
+				kern_hashbucket *hbucket = &hbuckets[bindex];
+
+				for (i=0; i < GPUJOIN_HASH_BUCKET_NITEMS; i++)
+				{
+					if (hbucket->offset[i] == 0 &&
+						atomicCAS(&hbucket->offset[i], 0, self) == 0)
+					{
+						hbucket->hash[i] = hash;
+						goto next;
+					}
+				}
+				bindex = (bindex + 1) & (nbuckets - 1);
+			}
+			/* hash-buckets are larger than the number of inner rows */
+			assert(loop < nbuckets);
+		}
+	next:
+		;
+	}
+}
+
 /*
  * gpujoin_gist_getnext
  */
@@ -1590,6 +2007,7 @@ gpujoin_main(kern_context *kcxt,
 			 kern_data_extra *kds_extra,
 			 kern_data_store *kds_dst,
 			 kern_parambuf *kparams_gpreagg, /* only if combined GpuJoin */
+			 gpujoinNoGroupState *nogroup,	 /* only if fused NoGroup */
 			 cl_uint *l_state,
 			 cl_bool *matched)
 {
@@ -1641,6 +2059,7 @@ gpujoin_main(kern_context *kcxt,
 										kds_extra,
 										PSTACK_DEPTH(depth),
 										l_state);
+			KERN_PROFILE_STAGE(kcxt, KERN_PROFILE__LOAD);
 		}
 		else if (depth > max_depth)
 		{
@@ -1657,6 +2076,23 @@ gpujoin_main(kern_context *kcxt,
 											   PSTACK_DEPTH(kgjoin->num_rels),
 											   l_state,
 											   matched);
+				KERN_PROFILE_STAGE(kcxt, KERN_PROFILE__PROJECTION);
+			}
+			else if (nogroup)
+			{
+				/* PROJECTION (fused NoGroup reduction) */
+				depth = gpujoin_projection_nogroup(kcxt,
+												   kparams_gpreagg,
+												   nogroup,
+												   kgjoin,
+												   kmrels,
+												   kds_src,
+												   kds_extra,
+												   kds_dst,
+												   PSTACK_DEPTH(kgjoin->num_rels),
+												   l_state,
+												   matched);
+				KERN_PROFILE_STAGE(kcxt, KERN_PROFILE__PROJECTION);
 			}
 			else
 			{
@@ -1671,6 +2107,7 @@ gpujoin_main(kern_context *kcxt,
 												PSTACK_DEPTH(kgjoin->num_rels),
 												l_state,
 												matched);
+				KERN_PROFILE_STAGE(kcxt, KERN_PROFILE__PROJECTION);
 			}
 		}
 		else if (kmrels->chunks[depth-1].is_nestloop)
@@ -1686,6 +2123,7 @@ gpujoin_main(kern_context *kcxt,
 										  PSTACK_DEPTH(depth),
 										  l_state,
 										  matched);
+			KERN_PROFILE_STAGE(kcxt, KERN_PROFILE__JOIN);
 		}
 		else if (kmrels->chunks[depth-1].gist_offset != 0)
 		{
@@ -1700,6 +2138,7 @@ gpujoin_main(kern_context *kcxt,
 										   PSTACK_DEPTH(depth),
 										   l_state,
 										   matched);
+			KERN_PROFILE_STAGE(kcxt, KERN_PROFILE__JOIN);
 		}
 		else
 		{
@@ -1714,6 +2153,7 @@ gpujoin_main(kern_context *kcxt,
 										  PSTACK_DEPTH(depth),
 										  l_state,
 										  matched);
+			KERN_PROFILE_STAGE(kcxt, KERN_PROFILE__JOIN);
 		}
 		if (get_local_id() == 0)
 			depth_thread0 = depth;
@@ -1737,6 +2177,15 @@ gpujoin_main(kern_context *kcxt,
 			atomicAdd(&kgjoin->stat[i].nitems2, stat_nitems2[i+1]);
 		}
 	}
+	/* merge the private accumulation of the fused NoGroup reduction */
+	if (nogroup && depth == -1)
+	{
+		__syncthreads();
+		gpupreagg_nogroup_combined_merge(nogroup->kgpreagg,
+										 nogroup->kds_final,
+										 nogroup->p_dclass,
+										 nogroup->p_values);
+	}
 }
 
 /*
@@ -1777,6 +2226,7 @@ gpujoin_right_outer(kern_context *kcxt,
 					cl_int outer_depth,
 					kern_data_store *kds_dst,
 					kern_parambuf *kparams_gpreagg,
+					gpujoinNoGroupState *nogroup,
 					cl_uint *l_state,
 					cl_bool *matched)
 {
@@ -1844,6 +2294,21 @@ gpujoin_right_outer(kern_context *kcxt,
 											   l_state,
 											   matched);
 			}
+			else if (nogroup)
+			{
+				/* PROJECTION (fused NoGroup reduction) */
+				depth = gpujoin_projection_nogroup(kcxt,
+												   kparams_gpreagg,
+												   nogroup,
+												   kgjoin,
+												   kmrels,
+												   NULL,
+												   NULL,
+												   kds_dst,
+												   PSTACK_DEPTH(kgjoin->num_rels),
+												   l_state,
+												   matched);
+			}
 			else
 			{
 				/* PROJECTION (SLOT) */
@@ -1924,4 +2389,10 @@ gpujoin_right_outer(kern_context *kcxt,
 		}
 	}
 	__syncthreads();
+	/* merge the private accumulation of the fused NoGroup reduction */
+	if (nogroup)
+		gpupreagg_nogroup_combined_merge(nogroup->kgpreagg,
+										 nogroup->kds_final,
+										 nogroup->p_dclass,
+										 nogroup->p_values);
 }
@@ -27,10 +27,20 @@ typedef struct
 		cl_ulong	chunk_offset;	/* offset to KDS or Hash */
 		cl_ulong	ojmap_offset;	/* offset to outer-join map, if any */
 		cl_ulong	gist_offset;	/* offset to GiST-index pages, if any */
+		cl_ulong	bloom_offset;	/* offset to Bloom-filter, if any */
+		cl_ulong	hbucket_offset;	/* offset to hash-buckets, if any */
+		cl_ulong	hskew_offset;	/* offset to heavy-hitter keys, if any */
+		cl_uint		bloom_nblocks;	/* number of Bloom-filter blocks */
+		cl_uint		hbucket_nbuckets; /* number of hash-buckets */
+		cl_uint		hskew_nkeys;	/* number of heavy-hitter keys */
 		cl_bool		is_nestloop;	/* true, if NestLoop. */
 		cl_bool		left_outer;		/* true, if JOIN_LEFT or JOIN_FULL */
 		cl_bool		right_outer;	/* true, if JOIN_RIGHT or JOIN_FULL */
-		cl_char		__padding__[5];
+		cl_bool		semi_join;		/* true, if JOIN_SEMI */
+		cl_bool		anti_join;		/* true, if JOIN_ANTI */
+		cl_bool		device_build;	/* true, if Bloom-filter and hash-buckets
+									 * are built on the device */
+		cl_char		__padding__[6];
 	} chunks[FLEXIBLE_ARRAY_MEMBER];
 } kern_multirels;
 
@@ -51,12 +61,248 @@ typedef struct
 	  ? NULL															\
 	  : (char *)(kmrels) + (kmrels)->chunks[(depth)-1].gist_offset))
 
+#define KERN_MULTIRELS_BLOOM_FILTER(kmrels, depth)						\
+	((cl_uint *)((kmrels)->chunks[(depth)-1].bloom_offset == 0			\
+				 ? NULL													\
+				 : (char *)(kmrels) + (kmrels)->chunks[(depth)-1].bloom_offset))
+
+#define KERN_MULTIRELS_HASH_BUCKETS(kmrels, depth)						\
+	((kern_hashbucket *)((kmrels)->chunks[(depth)-1].hbucket_offset == 0	\
+						 ? NULL											\
+						 : (char *)(kmrels) + (kmrels)->chunks[(depth)-1].hbucket_offset))
+
+/*
+ * Blocked Bloom-filter of the inner hash table
+ *
+ * A block consists of eight 32bit words (32 bytes), and a hash value sets
+ * one bit for each word of the block chosen by the hash value. So, a probe
+ * touches only one memory sector, prior to walk on the hash-slot chain.
+ * The number of blocks is always power of 2.
+ */
+#define GPUJOIN_BLOOM_BLOCK_NWORDS		8
+#define GPUJOIN_BLOOM_BLOCK_SIZE		(sizeof(cl_uint) * GPUJOIN_BLOOM_BLOCK_NWORDS)
+#define GPUJOIN_BLOOM_BITS_PER_ITEM		16
+#define GPUJOIN_BLOOM_MAX_LENGTH		(4UL << 20)		/* 4MB */
+#define GPUJOIN_BLOOM_MIN_HASH_LENGTH	(8UL << 20)		/* 8MB */
+
+STATIC_INLINE(cl_uint)
+__gpujoin_bloom_block_index(cl_uint hash, cl_uint nblocks)
+{
+	/* fmix32 of MurmurHash3, not to correlate with the bit positions */
+	hash ^= hash >> 16;
+	hash *= 0x85ebca6bU;
+	hash ^= hash >> 13;
+	hash *= 0xc2b2ae35U;
+	hash ^= hash >> 16;
+
+	return (hash & (nblocks - 1));
+}
+
+STATIC_INLINE(void)
+__gpujoin_bloom_block_masks(cl_uint hash, cl_uint *masks)
+{
+	masks[0] = 1U << ((hash * 0x47b6137bU) >> 27);
+	masks[1] = 1U << ((hash * 0x44974d91U) >> 27);
+	masks[2] = 1U << ((hash * 0x8824ad5bU) >> 27);
+	masks[3] = 1U << ((hash * 0xa2b7289dU) >> 27);
+	masks[4] = 1U << ((hash * 0x705495c7U) >> 27);
+	masks[5] = 1U << ((hash * 0x2df1424bU) >> 27);
+	masks[6] = 1U << ((hash * 0x9efc4947U) >> 27);
+	masks[7] = 1U << ((hash * 0x5c6bfb31U) >> 27);
+}
+
+#ifdef __CUDACC__
+/*
+ * gpujoin_bloom_filter_test
+ *
+ * It returns false, if the hash value never appears in the inner hash
+ * table of this depth. Elsewhere, it returns true (may be false-positive).
+ */
+DEVICE_INLINE(cl_bool)
+gpujoin_bloom_filter_test(kern_multirels *kmrels, cl_int depth, cl_uint hash)
+{
+	const cl_uint  *bloom = KERN_MULTIRELS_BLOOM_FILTER(kmrels, depth);
+	cl_uint			nblocks;
+	cl_uint			masks[GPUJOIN_BLOOM_BLOCK_NWORDS];
+	cl_int			i;
+
+	if (!bloom)
+		return true;
+	nblocks = kmrels->chunks[depth-1].bloom_nblocks;
+	bloom += GPUJOIN_BLOOM_BLOCK_NWORDS * __gpujoin_bloom_block_index(hash, nblocks);
+	__gpujoin_bloom_block_masks(hash, masks);
+#pragma unroll
+	for (i=0; i < GPUJOIN_BLOOM_BLOCK_NWORDS; i++)
+	{
+		if ((__ldg(&bloom[i]) & masks[i]) != masks[i])
+			return false;
+	}
+	return true;
+}
+#endif	/* __CUDACC__ */
+
+/*
+ * Open-addressing hash-buckets of the inner hash table
+ *
+ * A bucket consists of 16 pairs of the hash value and the offset of
+ * kern_hashitem on the KDS_FORMAT_HASH, and its size is 128 bytes; one
+ * L1 cache line. A probe compares the inline hash values of the bucket,
+ * then dereferences only the kern_hashitem that has the same hash value,
+ * instead of the walk on the hash-slot chain. If the bucket has no empty
+ * entry, the probe moves to the next bucket (linear probing).
+ * It is built only when all the hash-keys are fixed-length, because
+ * comparison of variable-length keys is much more expensive than the walk
+ * on the hash-chain. The number of buckets is always power of 2.
+ */
+#define GPUJOIN_HASH_BUCKET_NITEMS		16
+
+typedef struct
+{
+	cl_uint		hash[GPUJOIN_HASH_BUCKET_NITEMS];
+	cl_uint		offset[GPUJOIN_HASH_BUCKET_NITEMS];	/* (PACKED), or 0 */
+} kern_hashbucket;
+
+STATIC_INLINE(cl_uint)
+__gpujoin_hash_bucket_index(cl_uint hash, cl_uint nbuckets)
+{
+	return (hash & (nbuckets - 1));
+}
+
+#ifdef __CUDACC__
+/*
+ * gpujoin_hash_bucket_lookup
+ *
+ * It returns the next kern_hashitem that has the same hash value, next to
+ * the supplied 'khitem', or the first one if 'khitem' is NULL.
+ * The probe sequence is usually one or two buckets, so it checks the probe
+ * sequence again from the head to resume the scan, rather than saving the
+ * position of the bucket.
+ */
+DEVICE_INLINE(kern_hashitem *)
+gpujoin_hash_bucket_lookup(kern_multirels *kmrels, cl_int depth,
+						   kern_data_store *kds_hash, cl_uint hash,
+						   kern_hashitem *khitem)
+{
+	const kern_hashbucket *hbuckets = KERN_MULTIRELS_HASH_BUCKETS(kmrels, depth);
+	cl_uint		nbuckets = kmrels->chunks[depth-1].hbucket_nbuckets;
+	cl_uint		curr = (!khitem ? 0 : __kds_packed((char *)khitem -
+												   (char *)kds_hash));
+	cl_bool		found = (curr == 0);
+	cl_uint		bindex = __gpujoin_hash_bucket_index(hash, nbuckets);
+	cl_uint		loop;
+	cl_int		i;
+
+	assert(hbuckets != NULL);
+	for (loop=0; loop < nbuckets; loop++)
+	{
+		const kern_hashbucket *hbucket = &hbuckets[bindex];
+
+#pragma unroll
+		for (i=0; i < GPUJOIN_HASH_BUCKET_NITEMS; i++)
+		{
+			cl_uint		offset = __ldg(&hbucket->offset[i]);
+
+			/* an empty entry terminates the probe sequence */
+			if (offset == 0)
+				return NULL;
+			if (__ldg(&hbucket->hash[i]) != hash)
+				continue;
+			if (found)
+				return (kern_hashitem *)((char *)kds_hash +
+										 __kds_unpack(offset));
+			if (offset == curr)
+				found = true;
+		}
+		bindex = (bindex + 1) & (nbuckets - 1);
+	}
+	return NULL;
+}
+#endif	/* __CUDACC__ */
+
+/*
+ * Heavy-hitter keys of the inner hash table
+ *
+ * If a particular key has massive number of inner rows, a thread that
+ * walks on its hash-slot chain makes the other threads in the same block
+ * idle for a long time. So, the inner rows of the heavy-hitter keys are
+ * rearranged to the contiguous range of the row-index on the preload, and
+ * all the threads in the block probe these inner rows cooperatively for
+ * each outer row that has the heavy-hitter key.
+ * The thread waiting for the cooperative probe has the next row-index with
+ * GPUJOIN_HASH_SKEW_LSTATE bit on the l_state; so, it is only built when
+ * the inner hash table is less than 16GB (packed offset is 31bit).
+ */
+#define GPUJOIN_HASH_SKEW_MAX_KEYS		32
+#define GPUJOIN_HASH_SKEW_NSAMPLES		10000
+#define GPUJOIN_HASH_SKEW_LSTATE		0x80000000U
+#define GPUJOIN_HASH_SKEW_MAX_LENGTH	(16UL << 30)	/* 16GB */
+
+typedef struct
+{
+	cl_uint		hash;		/* hash value of the heavy-hitter key */
+	cl_uint		row_base;	/* first row-index of the inner rows */
+	cl_uint		nitems;		/* number of the inner rows */
+} kern_hashskew;
+
+#define KERN_MULTIRELS_HASH_SKEW(kmrels, depth)							\
+	((kern_hashskew *)((kmrels)->chunks[(depth)-1].hskew_nkeys == 0		\
+					   ? NULL											\
+					   : (char *)(kmrels) + (kmrels)->chunks[(depth)-1].hskew_offset))
+
+#ifdef __CUDACC__
+/*
+ * gpujoin_hash_skew_lookup
+ *
+ * It returns the heavy-hitter key that has the supplied hash value, if any.
+ */
+DEVICE_INLINE(const kern_hashskew *)
+gpujoin_hash_skew_lookup(kern_multirels *kmrels, cl_int depth, cl_uint hash)
+{
+	const kern_hashskew *hskew = KERN_MULTIRELS_HASH_SKEW(kmrels, depth);
+	cl_uint		i, nkeys = kmrels->chunks[depth-1].hskew_nkeys;
+
+	for (i=0; i < nkeys; i++)
+	{
+		if (__ldg(&hskew[i].hash) == hash)
+			return &hskew[i];
+	}
+	return NULL;
+}
+
+/*
+ * gpujoin_hash_skew_lookup_rowid
+ *
+ * It returns the heavy-hitter key that contains the supplied row-index.
+ */
+DEVICE_INLINE(const kern_hashskew *)
+gpujoin_hash_skew_lookup_rowid(kern_multirels *kmrels, cl_int depth,
+							   cl_uint rowid)
+{
+	const kern_hashskew *hskew = KERN_MULTIRELS_HASH_SKEW(kmrels, depth);
+	cl_uint		i, nkeys = kmrels->chunks[depth-1].hskew_nkeys;
+
+	for (i=0; i < nkeys; i++)
+	{
+		if (rowid >= hskew[i].row_base &&
+			rowid <  hskew[i].row_base + hskew[i].nitems)
+			return &hskew[i];
+	}
+	return NULL;
+}
+#endif	/* __CUDACC__ */
+
 #define KERN_MULTIRELS_LEFT_OUTER_JOIN(kmrels, depth)	\
 	((kmrels)->chunks[(depth)-1].left_outer)
 
 #define KERN_MULTIRELS_RIGHT_OUTER_JOIN(kmrels, depth)	\
 	((kmrels)->chunks[(depth)-1].right_outer)
 
+#define KERN_MULTIRELS_SEMI_JOIN(kmrels, depth)		\
+	((kmrels)->chunks[(depth)-1].semi_join)
+
+#define KERN_MULTIRELS_ANTI_JOIN(kmrels, depth)		\
+	((kmrels)->chunks[(depth)-1].anti_join)
+
 /*
  * kern_gpujoin - control object of GpuJoin
  *
@@ -110,6 +356,8 @@ struct kern_gpujoin
 	cl_ulong		debug_counter1;
 	cl_ulong		debug_counter2;
 	cl_ulong		debug_counter3;
+	/* per-stage cycle counters (only PGSTROM_KERNEL_PROFILING) */
+	kern_profile	profile;
 	/* error status to be backed (OUT) */
 	cl_uint			source_nitems;		/* out: # of source rows */
 	cl_uint			outer_nitems;		/* out: # of filtered source rows */
@@ -175,6 +423,23 @@ typedef struct gpujoinSuspendContext	gpujoinSuspendContext;
 	 ((char *)(kgjoin) + (kgjoin)->suspend_offset +			\
 	  (group_id) * STROMALIGN(offsetof(gpujoinSuspendContext, \
 									   pd[(kgjoin)->num_rels + 1]))))
+/*
+ * gpujoinNoGroupState - private accumulation of the combined GpuPreAgg
+ *
+ * If combined GpuPreAgg has no grouping keys, the joined rows are never
+ * written to kds_dst; the final depth accumulates the initial projection
+ * of GpuPreAgg on the private buffer of each thread, then they are merged
+ * into kds_final at the end of the kernel. kds_dst is referenced only to
+ * know the layout of tlist_prep.
+ */
+typedef struct
+{
+	struct kern_gpupreagg *kgpreagg;
+	kern_data_store *kds_final;
+	cl_char	   *p_dclass;		/* __private__ */
+	Datum	   *p_values;		/* __private__ */
+} gpujoinNoGroupState;
+
 /* utility macros for automatically generated code */
 #define GPUJOIN_REF_HTUP(chunk,offset)			\
 	((offset) == 0								\
@@ -290,6 +555,7 @@ gpujoin_main(kern_context *kcxt,
 			 kern_data_extra *kds_extra,
 			 kern_data_store *kds_dst,
 			 kern_parambuf *kparams_gpreagg,		/* only if combined Join */
+			 gpujoinNoGroupState *nogroup,			/* only if fused NoGroup */
 			 cl_uint *l_state,
 			 cl_bool *matched);
 /*
@@ -302,6 +568,7 @@ gpujoin_right_outer(kern_context *kcxt,
 					cl_int outer_depth,
 					kern_data_store *kds_dst,
 					kern_parambuf *kparams_gpreagg, /* only if combined Join */
+					gpujoinNoGroupState *nogroup,	/* only if fused NoGroup */
 					cl_uint *l_state,
 					cl_bool *matched);
 #endif	/* __CUDACC__ */
@@ -342,8 +609,10 @@ kern_gpujoin_main(kern_gpujoin *kgjoin,
 				 kds_extra,
 				 kds_dst,
 				 kparams_gpreagg,
+				 NULL,
 				 l_state,
 				 matched);
+	KERN_PROFILE_FLUSH(&kgjoin->profile, &u.kcxt);
 	kern_writeback_error_status(&kgjoin->kerror, &u.kcxt);
 }
 
@@ -369,8 +638,10 @@ kern_gpujoin_right_outer(kern_gpujoin *kgjoin,
 						outer_depth,
 						kds_dst,
 						kparams_gpreagg,
+						NULL,
 						l_state,
 						matched);
+	KERN_PROFILE_FLUSH(&kgjoin->profile, &u.kcxt);
 	kern_writeback_error_status(&kgjoin->kerror, &u.kcxt);
 }
 
@@ -385,6 +656,26 @@ gpupreagg_projection_slot(kern_context *kcxt_gpreagg,
 	/* should never be called */
 	assert(false);
 }
+
+DEVICE_FUNCTION(void)
+gpupreagg_nogroup_combined_update(cl_char *p_dclass,
+								  Datum   *p_values,
+								  cl_char *tup_dclass,
+								  Datum   *tup_values)
+{
+	/* should never be called */
+	assert(false);
+}
+
+DEVICE_FUNCTION(void)
+gpupreagg_nogroup_combined_merge(struct kern_gpupreagg *kgpreagg,
+								 kern_data_store *kds_final,
+								 cl_char *p_dclass,
+								 Datum   *p_values)
+{
+	/* should never be called */
+	assert(false);
+}
 #endif	/* !GPUPREAGG_COMBINED_JOIN */
 #endif	/* __CUDACC_RTC__ */
 #endif	/* CUDA_GPUJOIN_H */
@@ -111,6 +111,7 @@ gpupreagg_setup_common(kern_context    *kcxt,
 		}
 	}
 
+	KERN_PROFILE_STAGE(kcxt, KERN_PROFILE__PROJECTION);
 	/*
 	 * allocation of extra buffer for indirect/varlena values
 	 */
@@ -146,6 +147,7 @@ gpupreagg_setup_common(kern_context    *kcxt,
 	}
 	if (__syncthreads_count(suspend_kernel) > 0)
 		return false;
+	KERN_PROFILE_STAGE(kcxt, KERN_PROFILE__ATOMICS);
 
 	if (slot_index != UINT_MAX)
 	{
@@ -177,6 +179,7 @@ gpupreagg_setup_common(kern_context    *kcxt,
 		memcpy(KERN_DATA_STORE_DCLASS(kds_slot, slot_index),
 			   tup_dclass, sizeof(cl_char) * kds_slot->ncols);
 	}
+	KERN_PROFILE_STAGE(kcxt, KERN_PROFILE__PROJECTION);
 	return true;
 }
 
@@ -247,6 +250,7 @@ gpupreagg_setup_row(kern_context *kcxt,
 		/* bailout if any errors on gpupreagg_quals_eval */
 		if (__syncthreads_count(kcxt->errcode) > 0)
 			break;
+		KERN_PROFILE_STAGE(kcxt, KERN_PROFILE__QUALS);
 		/* allocation of kds_slot buffer, if any */
 		slot_index = pgstromStairlikeBinaryCount(rc, &nvalids);
 		if (nvalids > 0)
@@ -263,6 +267,7 @@ gpupreagg_setup_row(kern_context *kcxt,
 			/* bailout if any errors */
 			if (__syncthreads_count(kcxt->errcode) > 0)
 				break;
+			KERN_PROFILE_STAGE(kcxt, KERN_PROFILE__PROJECTION);
 
 			if (!gpupreagg_setup_common(kcxt,
 										kgpreagg,
@@ -379,7 +384,11 @@ gpupreagg_setup_block(kern_context *kcxt,
 				{
 					curr_lpp = PageGetItemId(pg_page, line_no + 1);
 					if (ItemIdIsNormal(curr_lpp))
+					{
 						htup = PageGetItem(pg_page, curr_lpp);
+						if (!kern_check_visibility_heap(kcxt, pg_page, htup))
+							htup = NULL;
+					}
 				}
 			}
 			else
@@ -388,6 +397,8 @@ gpupreagg_setup_block(kern_context *kcxt,
 				n_lines = 0;
 			}
 
+			KERN_PROFILE_STAGE(kcxt, KERN_PROFILE__LOAD);
+
 			/* evaluation of the qualifier */
 			if (htup)
 			{
@@ -397,6 +408,7 @@ gpupreagg_setup_block(kern_context *kcxt,
 			/* bailout if any errors on gpupreagg_quals_eval */
 			if (__syncthreads_count(kcxt->errcode) > 0)
 				goto out;
+			KERN_PROFILE_STAGE(kcxt, KERN_PROFILE__QUALS);
 			/* allocation of the kds_slot buffer */
 			slot_index = pgstromStairlikeBinaryCount(rc, &nvalids);
 			if (nvalids > 0)
@@ -412,6 +424,7 @@ gpupreagg_setup_block(kern_context *kcxt,
 				/* bailout if any errors */
 				if (__syncthreads_count(kcxt->errcode) > 0)
 					goto out;
+				KERN_PROFILE_STAGE(kcxt, KERN_PROFILE__PROJECTION);
 
 				if (!gpupreagg_setup_common(kcxt,
 											kgpreagg,
@@ -514,6 +527,7 @@ gpupreagg_setup_arrow(kern_context *kcxt,
 		/* Bailout if any error on gpupreagg_quals_eval_arrow */
 		if (__syncthreads_count(kcxt->errcode) > 0)
 			break;
+		KERN_PROFILE_STAGE(kcxt, KERN_PROFILE__QUALS);
 		/* allocation of kds_slot buffer, if any */
 		slot_index = pgstromStairlikeBinaryCount(rc ? 1 : 0, &nvalids);
 		if (nvalids > 0)
@@ -529,6 +543,7 @@ gpupreagg_setup_arrow(kern_context *kcxt,
 			/* Bailout if any error */
 			if (__syncthreads_count(kcxt->errcode) > 0)
 				break;
+			KERN_PROFILE_STAGE(kcxt, KERN_PROFILE__PROJECTION);
 			/* common portion */
 			if (!gpupreagg_setup_common(kcxt,
 										kgpreagg,
@@ -623,6 +638,7 @@ gpupreagg_setup_column(kern_context *kcxt,
 		/* bailout if any errors */
 		if (__syncthreads_count(kcxt->errcode) > 0)
 			break;
+		KERN_PROFILE_STAGE(kcxt, KERN_PROFILE__QUALS);
 		/* allocation of kds_slot buffer, if any */
 		slot_index = pgstromStairlikeBinaryCount(rc ? 1 : 0, &nvalids);
 		if (nvalids > 0)
@@ -639,6 +655,7 @@ gpupreagg_setup_column(kern_context *kcxt,
 			/* bailout if any errors */
 			if (__syncthreads_count(kcxt->errcode) > 0)
 				break;
+			KERN_PROFILE_STAGE(kcxt, KERN_PROFILE__PROJECTION);
 			/* common portion */
 			if (!gpupreagg_setup_common(kcxt,
 										kgpreagg,
@@ -668,66 +685,18 @@ skip:
 }
 
 /*
- * gpupreagg_nogroup_reduction
+ * __gpupreagg_nogroup_final_merge
+ *
+ * It merges the private accumulation of each thread into the final buffer,
+ * by the shuffle operations in warp and atomic operations on kds_final.
  */
-DEVICE_FUNCTION(void)
-gpupreagg_nogroup_reduction(kern_context *kcxt,
-							kern_gpupreagg *kgpreagg,		/* in/out */
-							kern_errorbuf *kgjoin_errorbuf,	/* in */
-							kern_data_store *kds_slot,		/* in */
-							kern_data_store *kds_final,		/* global out */
-                            cl_char *p_dclass,		/* __private__ */
-                            Datum   *p_values,		/* __private__ */
-							char	*p_extras)		/* __private__ */
+STATIC_FUNCTION(void)
+__gpupreagg_nogroup_final_merge(kern_gpupreagg *kgpreagg,
+								kern_data_store *kds_final,
+								cl_char *p_dclass,
+								Datum   *p_values)
 {
-	cl_bool		is_last_reduction = false;
-	cl_bool		try_final_merge = true;
-	cl_uint		lane_id = (get_local_id() & warpSize - 1);
-
-	/* init local/private buffer */
-	assert(MAXWARPS_PER_BLOCK <= get_local_size() &&
-		   MAXWARPS_PER_BLOCK == warpSize);
-	gpupreagg_init_local_slot(p_dclass, p_values, p_extras);
-
-	/* skip if previous stage reported an error */
-	if (kgjoin_errorbuf &&
-		__syncthreads_count(kgjoin_errorbuf->errcode) != 0)
-		return;
-	if (__syncthreads_count(kgpreagg->kerror.errcode) != 0)
-		return;
-
-	assert(kgpreagg->num_group_keys == 0);
-	assert(kds_slot->format == KDS_FORMAT_SLOT);
-	assert(kds_final->format == KDS_FORMAT_SLOT);
-	assert(kds_slot->ncols == kds_final->ncols);
-	if (get_global_id() == 0)
-		kgpreagg->setup_slot_done = true;
-
-	/* start private reduction */
-	is_last_reduction = false;
-	do {
-		cl_uint		index;
-
-		if (lane_id == 0)
-			index = atomicAdd(&kgpreagg->read_slot_pos, warpSize);
-		index = __shfl_sync(__activemask(), index, 0);
-		if (index + warpSize >= kds_slot->nitems)
-			is_last_reduction = true;
-		index += lane_id;
-
-		/* accumulate to the private buffer */
-		if (index < kds_slot->nitems)
-		{
-			gpupreagg_update_normal(p_dclass,
-									p_values,
-									GPUPREAGG_ACCUM_MAP_LOCAL,
-									KERN_DATA_STORE_DCLASS(kds_slot, index),
-									KERN_DATA_STORE_VALUES(kds_slot, index),
-									GPUPREAGG_ACCUM_MAP_GLOBAL);
-		}
-	} while (!is_last_reduction);
-
-	__syncthreads();
+	cl_bool		try_final_merge;
 
 	/*
 	 * inter-warp reduction using shuffle operations
@@ -802,6 +771,248 @@ gpupreagg_nogroup_reduction(kern_context *kcxt,
 	} while (__syncthreads_count(try_final_merge) > 0);
 }
 
+/*
+ * gpupreagg_nogroup_reduction
+ */
+DEVICE_FUNCTION(void)
+gpupreagg_nogroup_reduction(kern_context *kcxt,
+							kern_gpupreagg *kgpreagg,		/* in/out */
+							kern_errorbuf *kgjoin_errorbuf,	/* in */
+							kern_data_store *kds_slot,		/* in */
+							kern_data_store *kds_final,		/* global out */
+                            cl_char *p_dclass,		/* __private__ */
+                            Datum   *p_values,		/* __private__ */
+							char	*p_extras)		/* __private__ */
+{
+	cl_bool		is_last_reduction = false;
+	cl_uint		lane_id = (get_local_id() & warpSize - 1);
+
+	/* init local/private buffer */
+	assert(MAXWARPS_PER_BLOCK <= get_local_size() &&
+		   MAXWARPS_PER_BLOCK == warpSize);
+	gpupreagg_init_local_slot(p_dclass, p_values, p_extras);
+
+	/* skip if previous stage reported an error */
+	if (kgjoin_errorbuf &&
+		__syncthreads_count(kgjoin_errorbuf->errcode) != 0)
+		return;
+	if (__syncthreads_count(kgpreagg->kerror.errcode) != 0)
+		return;
+
+	assert(kgpreagg->num_group_keys == 0);
+	assert(kds_slot->format == KDS_FORMAT_SLOT);
+	assert(kds_final->format == KDS_FORMAT_SLOT);
+	assert(kds_slot->ncols == kds_final->ncols);
+	if (get_global_id() == 0)
+		kgpreagg->setup_slot_done = true;
+
+	/* start private reduction */
+	is_last_reduction = false;
+	do {
+		cl_uint		index;
+
+		if (lane_id == 0)
+			index = atomicAdd(&kgpreagg->read_slot_pos, warpSize);
+		index = __shfl_sync(__activemask(), index, 0);
+		if (index + warpSize >= kds_slot->nitems)
+			is_last_reduction = true;
+		index += lane_id;
+
+		/* accumulate to the private buffer */
+		if (index < kds_slot->nitems)
+		{
+			gpupreagg_update_normal(p_dclass,
+									p_values,
+									GPUPREAGG_ACCUM_MAP_LOCAL,
+									KERN_DATA_STORE_DCLASS(kds_slot, index),
+									KERN_DATA_STORE_VALUES(kds_slot, index),
+									GPUPREAGG_ACCUM_MAP_GLOBAL);
+		}
+	} while (!is_last_reduction);
+
+	__syncthreads();
+
+	__gpupreagg_nogroup_final_merge(kgpreagg, kds_final, p_dclass, p_values);
+}
+
+/*
+ * gpupreagg_nogroup_arrow
+ *
+ * It runs the setup and the nogroup reduction at once on Apache Arrow input.
+ * The projection result of each row is accumulated on the private buffer
+ * immediately, thus, no need to materialize kds_slot; only its header is
+ * referenced to know the layout of tlist_prep.
+ * Unlike gpupreagg_setup_arrow(), it never set setup_slot_done, so CPU
+ * fallback routine refers kds_src if any.
+ */
+DEVICE_FUNCTION(void)
+gpupreagg_nogroup_arrow(kern_context *kcxt,
+						kern_gpupreagg *kgpreagg,
+						kern_data_store *kds_src,	/* in: KDS_FORMAT_ARROW */
+						kern_data_store *kds_slot,	/* in: header only */
+						kern_data_store *kds_final,	/* global out */
+						cl_char *p_dclass,			/* __private__ */
+						Datum   *p_values,			/* __private__ */
+						char    *p_extras)			/* __private__ */
+{
+	cl_uint			src_nitems = __ldg(&kds_src->nitems);
+	cl_uint			src_base;
+	cl_uint			src_index;
+	cl_uint			count;
+	cl_uint			nvalids;
+	cl_char		   *vlbuf_base;
+	cl_char		   *tup_dclass;
+	Datum		   *tup_values;
+	cl_bool			rc;
+
+	assert(kgpreagg->num_group_keys == 0);
+	assert(kds_src->format == KDS_FORMAT_ARROW &&
+		   kds_slot->format == KDS_FORMAT_SLOT &&
+		   kds_final->format == KDS_FORMAT_SLOT);
+	assert(kds_slot->ncols == kds_final->ncols);
+	assert(MAXWARPS_PER_BLOCK <= get_local_size() &&
+		   MAXWARPS_PER_BLOCK == warpSize);
+	/* init local/private buffer */
+	gpupreagg_init_local_slot(p_dclass, p_values, p_extras);
+
+	tup_dclass = (cl_char *)
+		kern_context_alloc(kcxt, sizeof(cl_char) * kds_slot->ncols);
+	tup_values = (Datum *)
+		kern_context_alloc(kcxt, sizeof(Datum) * kds_slot->ncols);
+	if (!tup_dclass || !tup_values)
+		STROM_EREPORT(kcxt, ERRCODE_OUT_OF_MEMORY, "out of memory");
+	/* bailout if any errors */
+	if (__syncthreads_count(kcxt->errcode) > 0)
+		return;
+	vlbuf_base = kcxt->vlpos;
+
+	for (src_base = get_global_base();
+		 src_base < src_nitems;
+		 src_base += get_global_size())
+	{
+		kcxt->vlpos = vlbuf_base;		/* rewind */
+		src_index = src_base + get_local_id();
+		if (src_index < src_nitems)
+		{
+			rc = gpupreagg_quals_eval_arrow(kcxt, kds_src, src_index);
+			kcxt->vlpos = vlbuf_base;	/* rewind */
+		}
+		else
+		{
+			rc = false;
+		}
+		/* bailout if any error on gpupreagg_quals_eval_arrow */
+		if (__syncthreads_count(kcxt->errcode) > 0)
+			return;
+		/* accumulate to the private buffer */
+		if (rc)
+		{
+			gpupreagg_projection_arrow(kcxt,
+									   kds_src,
+									   src_index,
+									   tup_dclass,
+									   tup_values);
+			if (kcxt->errcode == 0)
+				gpupreagg_update_normal(p_dclass,
+										p_values,
+										GPUPREAGG_ACCUM_MAP_LOCAL,
+										tup_dclass,
+										tup_values,
+										GPUPREAGG_ACCUM_MAP_GLOBAL);
+		}
+		/* bailout if any error, prior to modification of kds_final */
+		if (__syncthreads_count(kcxt->errcode) > 0)
+			return;
+		/* update statistics */
+		count = __syncthreads_count(src_index < src_nitems);
+		nvalids = __syncthreads_count(rc);
+		if (get_local_id() == 0)
+		{
+			atomicAdd(&kgpreagg->nitems_real, count);
+			atomicAdd(&kgpreagg->nitems_filtered, count - nvalids);
+		}
+	}
+	__syncthreads();
+
+	__gpupreagg_nogroup_final_merge(kgpreagg, kds_final, p_dclass, p_values);
+}
+
+/*
+ * gpupreagg_nogroup_combined_update
+ *
+ * It accumulates a row projected by the combined GpuJoin, on the private
+ * buffer of the fused NoGroup reduction.
+ */
+DEVICE_FUNCTION(void)
+gpupreagg_nogroup_combined_update(cl_char *p_dclass,
+								  Datum   *p_values,
+								  cl_char *tup_dclass,
+								  Datum   *tup_values)
+{
+	gpupreagg_update_normal(p_dclass,
+							p_values,
+							GPUPREAGG_ACCUM_MAP_LOCAL,
+							tup_dclass,
+							tup_values,
+							GPUPREAGG_ACCUM_MAP_GLOBAL);
+}
+
+/*
+ * gpupreagg_nogroup_combined_merge
+ *
+ * It merges the private buffer of the fused NoGroup reduction into the
+ * kds_final, at the end of the combined GpuJoin kernel.
+ */
+DEVICE_FUNCTION(void)
+gpupreagg_nogroup_combined_merge(kern_gpupreagg *kgpreagg,
+								 kern_data_store *kds_final,
+								 cl_char *p_dclass,
+								 Datum   *p_values)
+{
+	assert(kgpreagg->num_group_keys == 0);
+	assert(MAXWARPS_PER_BLOCK <= get_local_size() &&
+		   MAXWARPS_PER_BLOCK == warpSize);
+	__gpupreagg_nogroup_final_merge(kgpreagg, kds_final, p_dclass, p_values);
+}
+
+/*
+ * gpupreagg_nogroup_merge_shared
+ *
+ * It merges the final buffer of NoGroup reduction in a parallel worker into
+ * the final buffer shared by the workers on the same device (kds_shared).
+ */
+DEVICE_FUNCTION(void)
+gpupreagg_nogroup_merge_shared(kern_context *kcxt,
+							   kern_gpupreagg *kgpreagg,
+							   kern_data_store *kds_shared,	/* global out */
+							   kern_data_store *kds_final,	/* in */
+							   cl_char *p_dclass,			/* __private__ */
+							   Datum   *p_values,			/* __private__ */
+							   char    *p_extras)			/* __private__ */
+{
+	assert(kgpreagg->num_group_keys == 0);
+	assert(kds_shared->format == KDS_FORMAT_SLOT &&
+		   kds_final->format == KDS_FORMAT_SLOT &&
+		   kds_shared->ncols == kds_final->ncols);
+	assert(MAXWARPS_PER_BLOCK <= get_local_size() &&
+		   MAXWARPS_PER_BLOCK == warpSize);
+	/* init local/private buffer */
+	gpupreagg_init_local_slot(p_dclass, p_values, p_extras);
+
+	if (get_global_id() == 0 && kds_final->nitems > 0)
+	{
+		gpupreagg_merge_atomic(p_dclass,
+							   p_values,
+							   GPUPREAGG_ACCUM_MAP_LOCAL,
+							   KERN_DATA_STORE_DCLASS(kds_final, 0),
+							   KERN_DATA_STORE_VALUES(kds_final, 0),
+							   GPUPREAGG_ACCUM_MAP_GLOBAL);
+	}
+	__syncthreads();
+
+	__gpupreagg_nogroup_final_merge(kgpreagg, kds_shared, p_dclass, p_values);
+}
+
 #define HASHITEM_EMPTY		(0xffffffffU)
 #define HASHITEM_LOCKED		(0xfffffffeU)
 
@@ -821,6 +1032,12 @@ gpupreagg_init_final_hash(kern_global_hashslot *f_hash,
 		f_hash->lock = 0;
 		f_hash->usage = 0;
 		f_hash->nslots = f_hash_nslots;
+		f_hash->rehash_nslots = 0;
+		f_hash->rehash_helpers = 0;
+		f_hash->rehash_reset_index = 0;
+		f_hash->rehash_reset_done = 0;
+		f_hash->rehash_insert_index = 0;
+		f_hash->rehash_insert_done = 0;
 	}
 
 	for (size_t i = get_global_id(); i < f_hash_nslots; i += get_global_size())
@@ -1018,6 +1235,99 @@ gpupreagg_create_final_slot(kern_context *kcxt,
 	return dst_index;
 }
 
+/*
+ * __rehash_global_hash - re-construction of the global hash-slot
+ *
+ * The CUDA block that acquired the exclusive lock to expand the global hash
+ * slot calls this function with is_helper = false. Other CUDA blocks which
+ * are waiting for the lock also join the rehash with is_helper = true, then
+ * the slots[] reset and re-insertion of the hash-items are distributed to
+ * the participant blocks in chunks, instead of a single block.
+ */
+STATIC_FUNCTION(void)
+__rehash_global_hash(kern_global_hashslot *f_hash, cl_bool is_helper)
+{
+	__shared__ cl_uint nslots;
+	__shared__ cl_uint base;
+	cl_uint		nitems;
+	cl_uint		chunk;
+	cl_uint		i, next;
+	cl_bool		wait = false;
+
+	if (get_local_id() == 0)
+	{
+		if (!is_helper)
+			nslots = f_hash->rehash_nslots;
+		else
+		{
+			atomicAdd(&f_hash->rehash_helpers, 1);
+			nslots = __volatileRead(&f_hash->rehash_nslots);
+			if (nslots == 0)
+				atomicSub(&f_hash->rehash_helpers, 1);
+		}
+	}
+	__syncthreads();
+	if (nslots == 0)
+		return;		/* rehash is already done */
+	/* hash-items are never added under the exclusive lock */
+	nitems = __volatileRead(&f_hash->usage);
+
+	/* 1st phase: reset the hash slots */
+	for (;;)
+	{
+		if (get_local_id() == 0)
+			base = atomicAdd(&f_hash->rehash_reset_index, get_local_size());
+		__syncthreads();
+		chunk = base;
+		if (chunk >= nslots)
+			break;
+		i = chunk + get_local_id();
+		if (i < nslots)
+			f_hash->slots[i] = HASHITEM_EMPTY;
+		__threadfence();
+		__syncthreads();
+		if (get_local_id() == 0)
+			atomicAdd(&f_hash->rehash_reset_done,
+					  Min(nslots - chunk, get_local_size()));
+	}
+	/* wait for completion of the 1st phase by other blocks */
+	do {
+		if (get_local_id() == 0)
+			wait = (__volatileRead(&f_hash->rehash_reset_done) < nslots);
+	} while (__syncthreads_count(wait) > 0);
+
+	/* 2nd phase: re-insert the hash items */
+	for (;;)
+	{
+		if (get_local_id() == 0)
+			base = atomicAdd(&f_hash->rehash_insert_index, get_local_size());
+		__syncthreads();
+		chunk = base;
+		if (chunk >= nitems)
+			break;
+		i = chunk + get_local_id();
+		if (i < nitems)
+		{
+			preagg_hash_item *hitem = GLOBAL_HASHSLOT_GETITEM(f_hash, i);
+			cl_uint		hindex = hitem->hash % nslots;
+
+			do {
+				next = __volatileRead(&f_hash->slots[hindex]);
+				assert(next == HASHITEM_EMPTY || next < nitems);
+				hitem->next = next;
+			} while (atomicCAS(&f_hash->slots[hindex], next, i) != next);
+		}
+		__threadfence();
+		__syncthreads();
+		if (get_local_id() == 0)
+			atomicAdd(&f_hash->rehash_insert_done,
+					  Min(nitems - chunk, get_local_size()));
+	}
+	__syncthreads();
+	if (is_helper && get_local_id() == 0)
+		atomicSub(&f_hash->rehash_helpers, 1);
+}
+
 /*
  * gpupreagg_expand_global_hash - expand size of the global hash slot on demand.
  * up to the f_hashlimit. It internally acquires shared lock of the final
@@ -1028,7 +1338,7 @@ STATIC_FUNCTION(cl_bool)
 __expand_global_hash(kern_context *kcxt, kern_global_hashslot *f_hash)
 {
 	cl_bool		expanded = false;
-	cl_uint		i, j;
+	cl_bool		wait = false;
 
 	/*
 	 * Expand the global hash-slot
@@ -1045,6 +1355,13 @@ __expand_global_hash(kern_context *kcxt, kern_global_hashslot *f_hash)
 		if (consumed <= f_hash->length)
 		{
 			f_hash->nslots = __nslots;
+			f_hash->rehash_reset_index = 0;
+			f_hash->rehash_reset_done = 0;
+			f_hash->rehash_insert_index = 0;
+			f_hash->rehash_insert_done = 0;
+			__threadfence();
+			/* OK, other blocks can join the rehash */
+			atomicExch(&f_hash->rehash_nslots, __nslots);
 			expanded = true;
 		}
 		else
@@ -1057,36 +1374,23 @@ __expand_global_hash(kern_context *kcxt, kern_global_hashslot *f_hash)
 		return false;		/* failed */
 
 	/* fix up the global hash-slot */
-	for (i = get_local_id(); i < f_hash->nslots; i += get_local_size())
-	{
-		f_hash->slots[i] = HASHITEM_EMPTY;
-	}
-	__syncthreads();
+	__rehash_global_hash(f_hash, false);
 
-	for (i = 0; i < f_hash->usage; i += get_local_size())
-	{
-		preagg_hash_item *hitem = NULL;
-		cl_uint		hindex = UINT_MAX;
-		cl_uint		next;
+	/* wait for completion of the rehash by other blocks */
+	do {
+		if (get_local_id() == 0)
+			wait = (__volatileRead(&f_hash->rehash_insert_done) <
+					__volatileRead(&f_hash->usage));
+	} while (__syncthreads_count(wait) > 0);
 
-		j = i + get_local_id();
-		if (j < f_hash->usage)
-		{
-			hitem = GLOBAL_HASHSLOT_GETITEM(f_hash, j);
-			hindex = hitem->hash % f_hash->nslots;
-		}
+	/* no more blocks can join, then wait for the helpers to exit */
+	if (get_local_id() == 0)
+		atomicExch(&f_hash->rehash_nslots, 0);
+	do {
+		if (get_local_id() == 0)
+			wait = (__volatileRead(&f_hash->rehash_helpers) > 0);
+	} while (__syncthreads_count(wait) > 0);
 
-		do {
-			if (hitem)
-			{
-				next = __volatileRead(&f_hash->slots[hindex]);
-				assert(next == HASHITEM_EMPTY || next < f_hash->usage);
-				hitem->next = next;
-				if (atomicCAS(&f_hash->slots[hindex], next, j) == next)
-					hitem = NULL;
-			}
-		} while(__syncthreads_count(hitem != NULL) > 0);
-	}
 	return true;
 }
 
@@ -1097,12 +1401,14 @@ gpupreagg_expand_global_hash(kern_context *kcxt,
 {
 	cl_bool		lock_wait = false;
 	cl_bool		expand_hash = false;
+	cl_bool		rehash_help;
 	cl_uint		old_lock;
 	cl_uint		new_lock;
 	cl_uint		curr_usage;
 
 	/* Get shared/exclusive lock on the final hash slot */
 	do {
+		rehash_help = false;
 		if (get_local_id() == 0)
 		{
 			curr_usage = __volatileRead(&f_hash->usage);
@@ -1110,7 +1416,11 @@ gpupreagg_expand_global_hash(kern_context *kcxt,
 
 			old_lock = __volatileRead(&f_hash->lock);
 			if ((old_lock & 0x0001) != 0)
-				lock_wait = true;	/* someone has exclusive lock */
+			{
+				/* someone has exclusive lock, and may be in rehash */
+				lock_wait = true;
+				rehash_help = (__volatileRead(&f_hash->rehash_nslots) != 0);
+			}
 			else
 			{
 				if (expand_hash)
@@ -1126,6 +1436,9 @@ gpupreagg_expand_global_hash(kern_context *kcxt,
 					lock_wait = true;	/* Oops, conflict. Retry again. */
 			}
 		}
+		/* help the rehash by the exclusive lock holder, if any */
+		if (__syncthreads_count(rehash_help) > 0)
+			__rehash_global_hash(f_hash, true);
 	} while (__syncthreads_count(lock_wait) > 0);
 
 	if (__syncthreads_count(expand_hash) > 0)
@@ -1463,6 +1776,7 @@ gpupreagg_groupby_reduction(kern_context *kcxt,
 		int			status;
 		int			index;
 		int			count;
+		int			nmisses;
 
 		/* fetch next items from the kds_slot */
 		if (get_local_id() == 0)
@@ -1486,26 +1800,41 @@ gpupreagg_groupby_reduction(kern_context *kcxt,
 			return;		/* error */
 
 		/*
-		 * 1st path - try local reduction
+		 * 1st path - try local reduction, unless host-side told us the group
+		 * cardinality is too large to fit the local hash-table.
 		 */
-		status = -1;
-		do {
-			if (status < 0 && index < kds_slot->nitems)
-				status = gpupreagg_local_reduction(kcxt,
-												   kds_slot,
-												   index,
-												   hash,
-												   &l_htable,
-												   l_hitems,
-												   l_dclass,
-												   l_values,
-												   l_extras);
-			else
-				status = 1;
+		if (kgpreagg->skip_local_reduction)
+			status = (index < kds_slot->nitems ? 0 : 1);
+		else
+		{
+			status = -1;
+			do {
+				if (status < 0 && index < kds_slot->nitems)
+					status = gpupreagg_local_reduction(kcxt,
+													   kds_slot,
+													   index,
+													   hash,
+													   &l_htable,
+													   l_hitems,
+													   l_dclass,
+													   l_values,
+													   l_extras);
+				else
+					status = 1;
 
-			if (__syncthreads_count(kcxt->errcode) > 0)
-				return;		/* error */
-		} while (__syncthreads_count(status < 0) > 0);
+				if (__syncthreads_count(kcxt->errcode) > 0)
+					return;		/* error */
+			} while (__syncthreads_count(status < 0) > 0);
+
+			/* runtime statistics for the adaptive local reduction */
+			count = __syncthreads_count(index < kds_slot->nitems);
+			nmisses = __syncthreads_count(status == 0);
+			if (get_local_id() == 0)
+			{
+				atomicAdd(&kgpreagg->local_nitems, count);
+				atomicAdd(&kgpreagg->local_nmisses, nmisses);
+			}
+		}
 
 		/*
 		 * 2nd path - try global reduction
@@ -1771,3 +2100,245 @@ aggcalc_update_hll_sketch(cl_char *p_accum_dclass,
 		*p_accum_dclass = DATUM_CLASS__NORMAL;
 	}
 }
+
+/*
+ * aggcalc operations for quantile sketch
+ */
+DEVICE_FUNCTION(void)
+aggcalc_init_quantile_sketch(cl_char *p_accum_dclass,
+							 Datum   *p_accum_datum,
+							 char    *extra_pos)
+{
+	kern_quantile_sketch *qsketch = (kern_quantile_sketch *)extra_pos;
+	cl_uint		sz = QUANTILE_SKETCH_LENGTH(GPUPREAGG_QUANTILE_SKETCH_BITS);
+
+	*p_accum_dclass = DATUM_CLASS__NULL;
+	memset(extra_pos, 0, sz);
+	SET_VARSIZE(extra_pos, sz);
+	qsketch->nbits = GPUPREAGG_QUANTILE_SKETCH_BITS;
+	*p_accum_datum = PointerGetDatum(extra_pos);
+}
+
+DEVICE_FUNCTION(void)
+aggcalc_shuffle_quantile_sketch(cl_char *p_accum_dclass,
+								Datum   *p_accum_datum,
+								int      lane_id)
+{
+	kern_quantile_sketch *qsketch = (kern_quantile_sketch *)
+		DatumGetPointer(*p_accum_datum);
+	cl_uint		nbuckets = QUANTILE_SKETCH_NBUCKETS(GPUPREAGG_QUANTILE_SKETCH_BITS);
+	cl_char		buddy_dclass;
+	cl_ulong	buddy;
+	cl_uint		index;
+
+	assert(qsketch->nbits == GPUPREAGG_QUANTILE_SKETCH_BITS);
+	assert(__activemask() == ~0U);
+	buddy_dclass = __shfl_sync(__activemask(), *p_accum_dclass, lane_id);
+	for (index=0; index < nbuckets; index++)
+	{
+		buddy = __shfl_sync(__activemask(), qsketch->counters[index], lane_id);
+		if (buddy_dclass != DATUM_CLASS__NULL)
+			qsketch->counters[index] += buddy;
+	}
+	if (buddy_dclass != DATUM_CLASS__NULL)
+	{
+		assert(buddy_dclass == DATUM_CLASS__NORMAL);
+		*p_accum_dclass = DATUM_CLASS__NORMAL;
+	}
+}
+
+DEVICE_FUNCTION(void)
+aggcalc_normal_quantile_sketch(cl_char *p_accum_dclass,
+							   Datum   *p_accum_datum,
+							   cl_char  newval_dclass,
+							   Datum    newval_datum)	/* = int4 key */
+{
+	kern_quantile_sketch *qsketch;
+	cl_uint		index;
+
+	if (newval_dclass != DATUM_CLASS__NULL)
+	{
+		assert(newval_dclass == DATUM_CLASS__NORMAL);
+		qsketch = (kern_quantile_sketch *)DatumGetPointer(*p_accum_datum);
+		index = ((cl_uint)(newval_datum & 0xffffffffU) >>
+				 (QUANTILE_SKETCH_KEY_BITS - GPUPREAGG_QUANTILE_SKETCH_BITS));
+		assert(index < QUANTILE_SKETCH_NBUCKETS(GPUPREAGG_QUANTILE_SKETCH_BITS));
+		qsketch->counters[index]++;
+		*p_accum_dclass = DATUM_CLASS__NORMAL;
+	}
+}
+
+DEVICE_FUNCTION(void)
+aggcalc_merge_quantile_sketch(cl_char *p_accum_dclass,
+							  Datum   *p_accum_datum,
+							  cl_char  newval_dclass,
+							  Datum    newval_datum)	/* = bytea sketch */
+{
+	if (newval_dclass != DATUM_CLASS__NULL)
+	{
+		kern_quantile_sketch *dst_sketch = (kern_quantile_sketch *)
+			DatumGetPointer(*p_accum_datum);
+		kern_quantile_sketch *new_sketch = (kern_quantile_sketch *)
+			DatumGetPointer(newval_datum);
+		cl_uint		nbuckets = QUANTILE_SKETCH_NBUCKETS(GPUPREAGG_QUANTILE_SKETCH_BITS);
+		cl_ulong	count;
+		cl_uint		index;
+
+		assert(newval_dclass == DATUM_CLASS__NORMAL);
+		assert(dst_sketch->nbits == GPUPREAGG_QUANTILE_SKETCH_BITS &&
+			   new_sketch->nbits == GPUPREAGG_QUANTILE_SKETCH_BITS);
+		for (index=0; index < nbuckets; index++)
+		{
+			count = __volatileRead(&new_sketch->counters[index]);
+			if (count > 0)
+				atomicAdd(&dst_sketch->counters[index], count);
+		}
+		*p_accum_dclass = DATUM_CLASS__NORMAL;
+	}
+}
+
+DEVICE_FUNCTION(void)
+aggcalc_update_quantile_sketch(cl_char *p_accum_dclass,
+							   Datum   *p_accum_datum,
+							   cl_char  newval_dclass,
+							   Datum    newval_datum)	/* = int4 key */
+{
+	kern_quantile_sketch *qsketch;
+	cl_uint		index;
+
+	if (newval_dclass != DATUM_CLASS__NULL)
+	{
+		assert(newval_dclass == DATUM_CLASS__NORMAL);
+		qsketch = (kern_quantile_sketch *)DatumGetPointer(*p_accum_datum);
+		index = ((cl_uint)(newval_datum & 0xffffffffU) >>
+				 (QUANTILE_SKETCH_KEY_BITS - GPUPREAGG_QUANTILE_SKETCH_BITS));
+		assert(index < QUANTILE_SKETCH_NBUCKETS(GPUPREAGG_QUANTILE_SKETCH_BITS));
+		atomicAdd(&qsketch->counters[index], 1UL);
+		*p_accum_dclass = DATUM_CLASS__NORMAL;
+	}
+}
+
+/*
+ * aggcalc operations for fixed-point sum of numeric
+ */
+STATIC_INLINE(void)
+__atomic_add_numeric_fixed(kern_numeric_fixed *nfixed,
+						   cl_ulong nitems, cl_ulong sum_lo, cl_long sum_hi)
+{
+	cl_ulong	oldval;
+
+	atomicAdd(&nfixed->nitems, nitems);
+	oldval = atomicAdd(&nfixed->sum_lo, sum_lo);
+	/* propagate the carry to the upper 64bit */
+	if (oldval + sum_lo < oldval)
+		sum_hi++;
+	if (sum_hi != 0)
+		atomicAdd((cl_ulong *)&nfixed->sum_hi, (cl_ulong)sum_hi);
+}
+
+DEVICE_FUNCTION(void)
+aggcalc_init_numeric_fixed(cl_char *p_accum_dclass,
+						   Datum   *p_accum_datum,
+						   char    *extra_pos,
+						   cl_int   scale)
+{
+	kern_numeric_fixed *nfixed = (kern_numeric_fixed *)extra_pos;
+
+	*p_accum_dclass = DATUM_CLASS__NULL;
+	memset(nfixed, 0, sizeof(kern_numeric_fixed));
+	SET_VARSIZE(nfixed, sizeof(kern_numeric_fixed));
+	nfixed->scale = scale;
+	*p_accum_datum = PointerGetDatum(extra_pos);
+}
+
+DEVICE_FUNCTION(void)
+aggcalc_shuffle_numeric_fixed(cl_char *p_accum_dclass,
+							  Datum   *p_accum_datum,
+							  int      lane_id)
+{
+	kern_numeric_fixed *nfixed = (kern_numeric_fixed *)
+		DatumGetPointer(*p_accum_datum);
+	cl_char		buddy_dclass;
+	cl_ulong	buddy_nitems;
+	cl_ulong	buddy_lo;
+	cl_long		buddy_hi;
+
+	assert(__activemask() == ~0U);
+	buddy_dclass = __shfl_sync(__activemask(), *p_accum_dclass, lane_id);
+	buddy_nitems = __shfl_sync(__activemask(), nfixed->nitems, lane_id);
+	buddy_lo = __shfl_sync(__activemask(), nfixed->sum_lo, lane_id);
+	buddy_hi = __shfl_sync(__activemask(), nfixed->sum_hi, lane_id);
+	if (buddy_dclass != DATUM_CLASS__NULL)
+	{
+		assert(buddy_dclass == DATUM_CLASS__NORMAL);
+		nfixed->nitems += buddy_nitems;
+		nfixed->sum_lo += buddy_lo;
+		nfixed->sum_hi += buddy_hi + (nfixed->sum_lo < buddy_lo ? 1 : 0);
+		*p_accum_dclass = DATUM_CLASS__NORMAL;
+	}
+}
+
+DEVICE_FUNCTION(void)
+aggcalc_normal_numeric_fixed(cl_char *p_accum_dclass,
+							 Datum   *p_accum_datum,
+							 cl_char  newval_dclass,
+							 Datum    newval_datum)	/* = int8 scaled value */
+{
+	kern_numeric_fixed *nfixed;
+	cl_long		ival;
+
+	if (newval_dclass != DATUM_CLASS__NULL)
+	{
+		assert(newval_dclass == DATUM_CLASS__NORMAL);
+		nfixed = (kern_numeric_fixed *)DatumGetPointer(*p_accum_datum);
+		ival = (cl_long)newval_datum;
+		nfixed->nitems++;
+		nfixed->sum_lo += (cl_ulong)ival;
+		nfixed->sum_hi += (ival < 0 ? -1 : 0) +
+			(nfixed->sum_lo < (cl_ulong)ival ? 1 : 0);
+		*p_accum_dclass = DATUM_CLASS__NORMAL;
+	}
+}
+
+DEVICE_FUNCTION(void)
+aggcalc_merge_numeric_fixed(cl_char *p_accum_dclass,
+							Datum   *p_accum_datum,
+							cl_char  newval_dclass,
+							Datum    newval_datum)	/* = bytea accumulator */
+{
+	if (newval_dclass != DATUM_CLASS__NULL)
+	{
+		kern_numeric_fixed *dst_nfixed = (kern_numeric_fixed *)
+			DatumGetPointer(*p_accum_datum);
+		kern_numeric_fixed *new_nfixed = (kern_numeric_fixed *)
+			DatumGetPointer(newval_datum);
+
+		assert(newval_dclass == DATUM_CLASS__NORMAL);
+		assert(dst_nfixed->scale == new_nfixed->scale);
+		__atomic_add_numeric_fixed(dst_nfixed,
+								   __volatileRead(&new_nfixed->nitems),
+								   __volatileRead(&new_nfixed->sum_lo),
+								   __volatileRead(&new_nfixed->sum_hi));
+		*p_accum_dclass = DATUM_CLASS__NORMAL;
+	}
+}
+
+DEVICE_FUNCTION(void)
+aggcalc_update_numeric_fixed(cl_char *p_accum_dclass,
+							 Datum   *p_accum_datum,
+							 cl_char  newval_dclass,
+							 Datum    newval_datum)	/* = int8 scaled value */
+{
+	kern_numeric_fixed *nfixed;
+	cl_long		ival;
+
+	if (newval_dclass != DATUM_CLASS__NULL)
+	{
+		assert(newval_dclass == DATUM_CLASS__NORMAL);
+		nfixed = (kern_numeric_fixed *)DatumGetPointer(*p_accum_datum);
+		ival = (cl_long)newval_datum;
+		__atomic_add_numeric_fixed(nfixed, 1, (cl_ulong)ival,
+								   (ival < 0 ? -1 : 0));
+		*p_accum_dclass = DATUM_CLASS__NORMAL;
+	}
+}
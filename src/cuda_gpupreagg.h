@@ -22,6 +22,7 @@ struct kern_gpupreagg
 	cl_uint			block_sz;			/* block-size of setup/join kernel */
 	cl_bool			setup_slot_done;	/* setup stage is done, if true */
 	cl_bool			final_buffer_modified; /* true, if kds_final is modified */
+	cl_bool			skip_local_reduction; /* global reduction only, if true */
 	/* -- suspend/resume (KDS_FORMAT_BLOCK) */
 	cl_bool			resume_context;		/* resume kernel, if true */
 	cl_uint			suspend_count;		/* number of suspended blocks */
@@ -31,11 +32,14 @@ struct kern_gpupreagg
 	cl_uint			nitems_filtered;	/* out: # of removed rows by quals */
 	cl_uint			num_groups;			/* out: # of new groups */
 	cl_uint			extra_usage;		/* out: size of new allocation */
+	cl_uint			local_nitems;		/* out: # of rows tried local hash */
+	cl_uint			local_nmisses;		/* out: # of rows missed local hash */
 	/* -- debug counter -- */
 	cl_ulong		tv_stat_debug1;		/* out: debug counter 1 */
 	cl_ulong		tv_stat_debug2;		/* out: debug counter 2 */
 	cl_ulong		tv_stat_debug3;		/* out: debug counter 3 */
 	cl_ulong		tv_stat_debug4;		/* out: debug counter 4 */
+	kern_profile	profile;			/* out: per-stage cycle counters */
 	/* -- variable length buffer -- */
 	cl_ulong		data[1];
 	/* <-- gpupreaggSuspendContext[], if any --> */
@@ -96,6 +100,8 @@ typedef struct
  * An array of pagg_datum and its usage statistics, to be placed on
  * global memory area. Usage counter is used to break a loop to find-
  * out an empty slot if hash-slot is already filled-up.
+ * The rehash_* fields are used to expand the hash slot by multiple
+ * CUDA blocks, under the exclusive lock.
  */
 typedef struct
 {
@@ -103,6 +109,12 @@ typedef struct
 	cl_uint		lock;		/* shared/exclusive lock */
 	cl_uint		usage;		/* current usage of the hash item in the tail */
 	cl_uint		nslots;		/* current size of the hash slots */
+	cl_uint		rehash_nslots;	/* new nslots, if rehash is in-progress */
+	cl_uint		rehash_helpers;	/* # of blocks that join the rehash */
+	cl_uint		rehash_reset_index;	/* next slot index to be reset */
+	cl_uint		rehash_reset_done;	/* # of slots already reset */
+	cl_uint		rehash_insert_index;/* next item index to be re-inserted */
+	cl_uint		rehash_insert_done;	/* # of items already re-inserted */
 	cl_uint		slots[FLEXIBLE_ARRAY_MEMBER];
 } kern_global_hashslot;
 
@@ -173,6 +185,7 @@ extern __device__ cl_int		GPUPREAGG_NUM_ACCUM_VALUES;
 extern __device__ cl_int		GPUPREAGG_ACCUM_EXTRA_BUFSZ;
 extern __device__ cl_int		GPUPREAGG_LOCAL_HASH_NROOMS;
 extern __device__ cl_int		GPUPREAGG_HLL_REGISTER_BITS;
+extern __device__ cl_int		GPUPREAGG_QUANTILE_SKETCH_BITS;
 extern __device__ cl_short		GPUPREAGG_ACCUM_MAP_LOCAL[];
 extern __device__ cl_short		GPUPREAGG_ACCUM_MAP_GLOBAL[];
 extern __device__ cl_bool		GPUPREAGG_ATTR_IS_ACCUM_VALUES[];
@@ -308,6 +321,33 @@ gpupreagg_nogroup_reduction(kern_context *kcxt,
 							Datum   *p_values,		/* __private__ */
 							char    *p_extras);		/* __private__ */
 DEVICE_FUNCTION(void)
+gpupreagg_nogroup_arrow(kern_context *kcxt,
+						kern_gpupreagg *kgpreagg,		/* in/out */
+						kern_data_store *kds_src,		/* in: KDS_FORMAT_ARROW */
+						kern_data_store *kds_slot,		/* in: header only */
+						kern_data_store *kds_final,		/* global out */
+						cl_char *p_dclass,		/* __private__ */
+						Datum   *p_values,		/* __private__ */
+						char    *p_extras);		/* __private__ */
+DEVICE_FUNCTION(void)
+gpupreagg_nogroup_combined_update(cl_char *p_dclass,	/* __private__ */
+								  Datum   *p_values,	/* __private__ */
+								  cl_char *tup_dclass,	/* tlist_prep */
+								  Datum   *tup_values);	/* tlist_prep */
+DEVICE_FUNCTION(void)
+gpupreagg_nogroup_combined_merge(kern_gpupreagg *kgpreagg, /* in/out */
+								 kern_data_store *kds_final, /* global out */
+								 cl_char *p_dclass,		/* __private__ */
+								 Datum   *p_values);	/* __private__ */
+DEVICE_FUNCTION(void)
+gpupreagg_nogroup_merge_shared(kern_context *kcxt,
+							   kern_gpupreagg *kgpreagg,	/* in/out */
+							   kern_data_store *kds_shared,	/* global out */
+							   kern_data_store *kds_final,	/* in */
+							   cl_char *p_dclass,		/* __private__ */
+							   Datum   *p_values,		/* __private__ */
+							   char    *p_extras);		/* __private__ */
+DEVICE_FUNCTION(void)
 gpupreagg_groupby_reduction(kern_context *kcxt,
 							kern_gpupreagg *kgpreagg,		/* in/out */
 							kern_errorbuf *kgjoin_errorbuf,	/* in */
@@ -846,6 +886,61 @@ aggcalc_update_hll_sketch(cl_char *p_accum_dclass,
 						  cl_char  newval_dclass,
 						  Datum    newval_datum);
 
+/*
+ * aggcalc operations for quantile sketch support
+ */
+DEVICE_FUNCTION(void)
+aggcalc_init_quantile_sketch(cl_char *p_accum_dclass,
+							 Datum   *p_accum_datum,
+							 char    *extra_buffer);
+DEVICE_FUNCTION(void)
+aggcalc_shuffle_quantile_sketch(cl_char *p_accum_dclass,
+								Datum   *p_accum_datum,
+								int      lane_id);
+DEVICE_FUNCTION(void)
+aggcalc_normal_quantile_sketch(cl_char *p_accum_dclass,
+							   Datum   *p_accum_datum,
+							   cl_char  newval_dclass,
+							   Datum    newval_datum);
+DEVICE_FUNCTION(void)
+aggcalc_merge_quantile_sketch(cl_char *p_accum_dclass,
+							  Datum   *p_accum_datum,
+							  cl_char  newval_dclass,
+							  Datum    newval_datum);
+DEVICE_FUNCTION(void)
+aggcalc_update_quantile_sketch(cl_char *p_accum_dclass,
+							   Datum   *p_accum_datum,
+							   cl_char  newval_dclass,
+							   Datum    newval_datum);
+
+/*
+ * aggcalc operations for fixed-point sum of numeric
+ */
+DEVICE_FUNCTION(void)
+aggcalc_init_numeric_fixed(cl_char *p_accum_dclass,
+						   Datum   *p_accum_datum,
+						   char    *extra_buffer,
+						   cl_int   scale);
+DEVICE_FUNCTION(void)
+aggcalc_shuffle_numeric_fixed(cl_char *p_accum_dclass,
+							  Datum   *p_accum_datum,
+							  int      lane_id);
+DEVICE_FUNCTION(void)
+aggcalc_normal_numeric_fixed(cl_char *p_accum_dclass,
+							 Datum   *p_accum_datum,
+							 cl_char  newval_dclass,
+							 Datum    newval_datum);
+DEVICE_FUNCTION(void)
+aggcalc_merge_numeric_fixed(cl_char *p_accum_dclass,
+							Datum   *p_accum_datum,
+							cl_char  newval_dclass,
+							Datum    newval_datum);
+DEVICE_FUNCTION(void)
+aggcalc_update_numeric_fixed(cl_char *p_accum_dclass,
+							 Datum   *p_accum_datum,
+							 cl_char  newval_dclass,
+							 Datum    newval_datum);
+
 #endif	/* __CUDACC__ */
 
 #ifdef __CUDACC_RTC__
@@ -863,6 +958,7 @@ kern_gpupreagg_setup_row(kern_gpupreagg *kgpreagg,
 
 	INIT_KERNEL_CONTEXT(&u.kcxt, kparams);
 	gpupreagg_setup_row(&u.kcxt, kgpreagg, kds_src, kds_slot);
+	KERN_PROFILE_FLUSH(&kgpreagg->profile, &u.kcxt);
 	kern_writeback_error_status(&kgpreagg->kerror, &u.kcxt);
 }
 
@@ -877,6 +973,7 @@ kern_gpupreagg_setup_block(kern_gpupreagg *kgpreagg,
 
 	INIT_KERNEL_CONTEXT(&u.kcxt, kparams);
 	gpupreagg_setup_block(&u.kcxt, kgpreagg, kds_src, kds_slot);
+	KERN_PROFILE_FLUSH(&kgpreagg->profile, &u.kcxt);
 	kern_writeback_error_status(&kgpreagg->kerror, &u.kcxt);
 }
 
@@ -891,6 +988,7 @@ kern_gpupreagg_setup_arrow(kern_gpupreagg *kgpreagg,
 
 	INIT_KERNEL_CONTEXT(&u.kcxt, kparams);
 	gpupreagg_setup_arrow(&u.kcxt, kgpreagg, kds_src, kds_slot);
+	KERN_PROFILE_FLUSH(&kgpreagg->profile, &u.kcxt);
 	kern_writeback_error_status(&kgpreagg->kerror, &u.kcxt);
 }
 
@@ -905,6 +1003,7 @@ kern_gpupreagg_setup_column(kern_gpupreagg *kgpreagg,
 
 	INIT_KERNEL_CONTEXT(&u.kcxt, kparams);
 	gpupreagg_setup_column(&u.kcxt, kgpreagg, kds_src, kds_extra, kds_slot);
+	KERN_PROFILE_FLUSH(&kgpreagg->profile, &u.kcxt);
 	kern_writeback_error_status(&kgpreagg->kerror, &u.kcxt);
 }
 
@@ -943,9 +1042,188 @@ kern_gpupreagg_nogroup_reduction(kern_gpupreagg *kgpreagg,
 								nogroup_p_dclass,
 								nogroup_p_values,
 								nogroup_p_extras);
+	KERN_PROFILE_FLUSH(&kgpreagg->profile, &u.kcxt);
+	kern_writeback_error_status(&kgpreagg->kerror, &u.kcxt);
+}
+
+KERNEL_FUNCTION(void)
+kern_gpupreagg_nogroup_arrow(kern_gpupreagg *kgpreagg,
+							 kern_parambuf *kparams,
+							 kern_data_store *kds_src,
+							 kern_data_store *kds_slot,
+							 kern_data_store *kds_final)
+{
+	DECL_KERNEL_CONTEXT(u);
+#if __GPUPREAGG_NUM_ACCUM_VALUES > 0
+	cl_char		nogroup_p_dclass[__GPUPREAGG_NUM_ACCUM_VALUES];
+	Datum		nogroup_p_values[__GPUPREAGG_NUM_ACCUM_VALUES];
+#else
+#define nogroup_p_dclass	NULL
+#define nogroup_p_values	NULL
+#endif
+#if __GPUPREAGG_ACCUM_EXTRA_BUFSZ > 0
+	char		nogroup_p_extras[__GPUPREAGG_ACCUM_EXTRA_BUFSZ]
+				__attribute__ ((aligned(16)));
+#else
+#define nogroup_p_extras	NULL
+#endif
+	INIT_KERNEL_CONTEXT(&u.kcxt, kparams);
+	gpupreagg_nogroup_arrow(&u.kcxt,
+							kgpreagg,
+							kds_src,
+							kds_slot,
+							kds_final,
+							nogroup_p_dclass,
+							nogroup_p_values,
+							nogroup_p_extras);
+	KERN_PROFILE_FLUSH(&kgpreagg->profile, &u.kcxt);
 	kern_writeback_error_status(&kgpreagg->kerror, &u.kcxt);
 }
 
+KERNEL_FUNCTION(void)
+kern_gpupreagg_nogroup_merge_shared(kern_gpupreagg *kgpreagg,
+									kern_parambuf *kparams,
+									kern_data_store *kds_shared,
+									kern_data_store *kds_final)
+{
+	DECL_KERNEL_CONTEXT(u);
+#if __GPUPREAGG_NUM_ACCUM_VALUES > 0
+	cl_char		nogroup_p_dclass[__GPUPREAGG_NUM_ACCUM_VALUES];
+	Datum		nogroup_p_values[__GPUPREAGG_NUM_ACCUM_VALUES];
+#else
+#define nogroup_p_dclass	NULL
+#define nogroup_p_values	NULL
+#endif
+#if __GPUPREAGG_ACCUM_EXTRA_BUFSZ > 0
+	char		nogroup_p_extras[__GPUPREAGG_ACCUM_EXTRA_BUFSZ]
+				__attribute__ ((aligned(16)));
+#else
+#define nogroup_p_extras	NULL
+#endif
+	INIT_KERNEL_CONTEXT(&u.kcxt, kparams);
+	gpupreagg_nogroup_merge_shared(&u.kcxt,
+								   kgpreagg,
+								   kds_shared,
+								   kds_final,
+								   nogroup_p_dclass,
+								   nogroup_p_values,
+								   nogroup_p_extras);
+	KERN_PROFILE_FLUSH(&kgpreagg->profile, &u.kcxt);
+	kern_writeback_error_status(&kgpreagg->kerror, &u.kcxt);
+}
+
+#ifdef GPUPREAGG_COMBINED_JOIN
+/*
+ * kern_gpujoin_main_nogroup / kern_gpujoin_right_outer_nogroup
+ *
+ * Combined GpuJoin with the fused NoGroup reduction. The joined rows are
+ * accumulated on the private buffer of each thread, instead of kds_slot.
+ */
+KERNEL_FUNCTION(void)
+kern_gpujoin_main_nogroup(kern_gpujoin *kgjoin,
+						  kern_parambuf *kparams,
+						  kern_multirels *kmrels,
+						  kern_data_store *kds_src,
+						  kern_data_extra *kds_extra,
+						  kern_data_store *kds_slot,	/* header only */
+						  kern_parambuf *kparams_gpreagg,
+						  kern_gpupreagg *kgpreagg,
+						  kern_data_store *kds_final)
+{
+	cl_uint			l_state[GPUJOIN_MAX_DEPTH+1];
+	cl_bool			matched[GPUJOIN_MAX_DEPTH+1];
+	gpujoinNoGroupState nogroup;
+	DECL_KERNEL_CONTEXT(u);
+#if __GPUPREAGG_NUM_ACCUM_VALUES > 0
+	cl_char		nogroup_p_dclass[__GPUPREAGG_NUM_ACCUM_VALUES];
+	Datum		nogroup_p_values[__GPUPREAGG_NUM_ACCUM_VALUES];
+#else
+#define nogroup_p_dclass	NULL
+#define nogroup_p_values	NULL
+#endif
+#if __GPUPREAGG_ACCUM_EXTRA_BUFSZ > 0
+	char		nogroup_p_extras[__GPUPREAGG_ACCUM_EXTRA_BUFSZ]
+				__attribute__ ((aligned(16)));
+#else
+#define nogroup_p_extras	NULL
+#endif
+	assert(kgjoin->num_rels == GPUJOIN_MAX_DEPTH);
+	memset(l_state, 0, sizeof(l_state));
+	memset(matched, 0, sizeof(matched));
+	gpupreagg_init_local_slot(nogroup_p_dclass,
+							  nogroup_p_values,
+							  nogroup_p_extras);
+	nogroup.kgpreagg  = kgpreagg;
+	nogroup.kds_final = kds_final;
+	nogroup.p_dclass  = nogroup_p_dclass;
+	nogroup.p_values  = nogroup_p_values;
+	INIT_KERNEL_CONTEXT(&u.kcxt, kparams);
+	gpujoin_main(&u.kcxt,
+				 kgjoin,
+				 kmrels,
+				 kds_src,
+				 kds_extra,
+				 kds_slot,
+				 kparams_gpreagg,
+				 &nogroup,
+				 l_state,
+				 matched);
+	KERN_PROFILE_FLUSH(&kgjoin->profile, &u.kcxt);
+	kern_writeback_error_status(&kgjoin->kerror, &u.kcxt);
+}
+
+KERNEL_FUNCTION(void)
+kern_gpujoin_right_outer_nogroup(kern_gpujoin *kgjoin,
+								 kern_parambuf *kparams,
+								 kern_multirels *kmrels,
+								 cl_int outer_depth,
+								 kern_data_store *kds_slot,	/* header only */
+								 kern_parambuf *kparams_gpreagg,
+								 kern_gpupreagg *kgpreagg,
+								 kern_data_store *kds_final)
+{
+	cl_uint			l_state[GPUJOIN_MAX_DEPTH+1];
+	cl_bool			matched[GPUJOIN_MAX_DEPTH+1];
+	gpujoinNoGroupState nogroup;
+	DECL_KERNEL_CONTEXT(u);
+#if __GPUPREAGG_NUM_ACCUM_VALUES > 0
+	cl_char		nogroup_p_dclass[__GPUPREAGG_NUM_ACCUM_VALUES];
+	Datum		nogroup_p_values[__GPUPREAGG_NUM_ACCUM_VALUES];
+#else
+#define nogroup_p_dclass	NULL
+#define nogroup_p_values	NULL
+#endif
+#if __GPUPREAGG_ACCUM_EXTRA_BUFSZ > 0
+	char		nogroup_p_extras[__GPUPREAGG_ACCUM_EXTRA_BUFSZ]
+				__attribute__ ((aligned(16)));
+#else
+#define nogroup_p_extras	NULL
+#endif
+	assert(kgjoin->num_rels == GPUJOIN_MAX_DEPTH);
+	memset(l_state, 0, sizeof(l_state));
+	memset(matched, 0, sizeof(matched));
+	gpupreagg_init_local_slot(nogroup_p_dclass,
+							  nogroup_p_values,
+							  nogroup_p_extras);
+	nogroup.kgpreagg  = kgpreagg;
+	nogroup.kds_final = kds_final;
+	nogroup.p_dclass  = nogroup_p_dclass;
+	nogroup.p_values  = nogroup_p_values;
+	INIT_KERNEL_CONTEXT(&u.kcxt, kparams);
+	gpujoin_right_outer(&u.kcxt,
+						kgjoin,
+						kmrels,
+						outer_depth,
+						kds_slot,
+						kparams_gpreagg,
+						&nogroup,
+						l_state,
+						matched);
+	KERN_PROFILE_FLUSH(&kgjoin->profile, &u.kcxt);
+	kern_writeback_error_status(&kgjoin->kerror, &u.kcxt);
+}
+#endif	/* GPUPREAGG_COMBINED_JOIN */
+
 KERNEL_FUNCTION(void)
 kern_gpupreagg_groupby_reduction(kern_gpupreagg *kgpreagg,
 								 kern_parambuf *kparams,
@@ -991,6 +1269,7 @@ kern_gpupreagg_groupby_reduction(kern_gpupreagg *kgpreagg,
 								groupby_l_dclass,
 								groupby_l_values,
 								groupby_l_extras);
+	KERN_PROFILE_FLUSH(&kgpreagg->profile, &u.kcxt);
 	kern_writeback_error_status(&kgpreagg->kerror, &u.kcxt);
 }
 
@@ -999,6 +1278,7 @@ __device__ cl_int	GPUPREAGG_NUM_ACCUM_VALUES  = __GPUPREAGG_NUM_ACCUM_VALUES;
 __device__ cl_int	GPUPREAGG_ACCUM_EXTRA_BUFSZ = __GPUPREAGG_ACCUM_EXTRA_BUFSZ;
 __device__ cl_int	GPUPREAGG_LOCAL_HASH_NROOMS = __GPUPREAGG_LOCAL_HASH_NROOMS;
 __device__ cl_int	GPUPREAGG_HLL_REGISTER_BITS = __GPUPREAGG_HLL_REGISTER_BITS;
+__device__ cl_int	GPUPREAGG_QUANTILE_SKETCH_BITS = __GPUPREAGG_QUANTILE_SKETCH_BITS;
 
 #endif /* __CUDACC_RTC__ */
 #endif /* CUDA_GPUPREAGG_H */
@@ -75,6 +75,7 @@ gpuscan_main_row(kern_context *kcxt,
 		/* bailout if any error */
 		if (__syncthreads_count(kcxt->errcode) > 0)
 			break;
+		KERN_PROFILE_STAGE(kcxt, KERN_PROFILE__QUALS);
 		/* how many rows servived WHERE-clause evaluation? */
 		nitems_offset = pgstromStairlikeBinaryCount(rc, &nvalids);
 		if (nvalids > 0)
@@ -110,6 +111,7 @@ gpuscan_main_row(kern_context *kcxt,
 			/* bailout if any error */
 			if (__syncthreads_count(kcxt->errcode) > 0)
 				break;;
+			KERN_PROFILE_STAGE(kcxt, KERN_PROFILE__PROJECTION);
 			/* allocation of the destination buffer */
 			usage_offset = pgstromStairlikeSum(__kds_packed(required),
 											   &usage_length);
@@ -145,6 +147,7 @@ gpuscan_main_row(kern_context *kcxt,
 			}
 			if (__syncthreads_count(suspend_kernel) > 0)
 				break;
+			KERN_PROFILE_STAGE(kcxt, KERN_PROFILE__ATOMICS);
 			/* store the result tuple on the destination buffer */
 			if (rc)
 			{
@@ -159,6 +162,7 @@ gpuscan_main_row(kern_context *kcxt,
 									  tup_dclass,
 									  tup_values);
 			}
+			KERN_PROFILE_STAGE(kcxt, KERN_PROFILE__PROJECTION);
 		}
 		/* update statistics */
 		if (get_local_id() == 0)
@@ -277,11 +281,17 @@ gpuscan_main_block(kern_context *kcxt,
 				{
 					ItemIdData *lpp = PageGetItemId(pg_page, line_no+1);
 					if (ItemIdIsNormal(lpp))
+					{
 						htup = PageGetItem(pg_page, lpp);
+						if (!kern_check_visibility_heap(kcxt, pg_page, htup))
+							htup = NULL;
+					}
 					t_len = ItemIdGetLength(lpp);
 				}
 			}
 
+			KERN_PROFILE_STAGE(kcxt, KERN_PROFILE__LOAD);
+
 			/* evaluation of the qualifiers */
 			if (htup)
 			{
@@ -293,6 +303,7 @@ gpuscan_main_block(kern_context *kcxt,
 			/* bailout if any error */
 			if (__syncthreads_count(kcxt->errcode) > 0)
 				goto out_nostat;
+			KERN_PROFILE_STAGE(kcxt, KERN_PROFILE__QUALS);
 
 			/* how many rows servived WHERE-clause evaluations? */
 			nitems_offset = pgstromStairlikeBinaryCount(rc, &nvalids);
@@ -328,6 +339,7 @@ gpuscan_main_block(kern_context *kcxt,
 				/* bailout if any error */
 				if (__syncthreads_count(kcxt->errcode) > 0)
 					goto out;
+				KERN_PROFILE_STAGE(kcxt, KERN_PROFILE__PROJECTION);
 				/* allocation of the destination buffer */
 				usage_offset = pgstromStairlikeSum(__kds_packed(required),
 												   &usage_length);
@@ -363,6 +375,7 @@ gpuscan_main_block(kern_context *kcxt,
 				}
 				if (__syncthreads_count(suspend_kernel) > 0)
 					goto out;
+				KERN_PROFILE_STAGE(kcxt, KERN_PROFILE__ATOMICS);
 				/* store the result heap tuple */
 				if (rc)
 				{
@@ -377,6 +390,7 @@ gpuscan_main_block(kern_context *kcxt,
 										  tup_dclass,
 										  tup_values);
 				}
+				KERN_PROFILE_STAGE(kcxt, KERN_PROFILE__PROJECTION);
 			}
 			/* update statistics */
 			nitems_real = __syncthreads_count(htup != NULL);
@@ -468,13 +482,20 @@ gpuscan_main_arrow(kern_context *kcxt,
 
 		/* Evalidation of the rows by WHERE-clause */
 		src_index = src_base + get_local_id();
-		if (src_index < kds_src->nitems)
-			rc = gpuscan_quals_eval_arrow(kcxt, kds_src, src_index);
-		else
+		if (src_index >= kds_src->nitems)
 			rc = false;
+		else if (kgpuscan->arrow_selmap)
+		{
+			/* already evaluated by the vectorized quals */
+			rc = ((kgpuscan->arrow_selmap[src_index / 32] &
+				   (1U << (src_index % 32))) != 0);
+		}
+		else
+			rc = gpuscan_quals_eval_arrow(kcxt, kds_src, src_index);
 		/* bailout if any error */
 		if (__syncthreads_count(kcxt->errcode) > 0)
 			break;
+		KERN_PROFILE_STAGE(kcxt, KERN_PROFILE__QUALS);
 
 		/* how many rows servived WHERE-clause evaluation? */
 		nitems_offset = pgstromStairlikeBinaryCount(rc, &nvalids);
@@ -509,6 +530,7 @@ gpuscan_main_arrow(kern_context *kcxt,
 			/* bailout if any error */
 			if (__syncthreads_count(kcxt->errcode) > 0)
 				break;
+			KERN_PROFILE_STAGE(kcxt, KERN_PROFILE__PROJECTION);
 			/* allocation of the destination buffer */
 			usage_offset = pgstromStairlikeSum(__kds_packed(required),
 											   &usage_length);
@@ -544,6 +566,7 @@ gpuscan_main_arrow(kern_context *kcxt,
 			}
 			if (__syncthreads_count(suspend_kernel) > 0)
 				break;
+			KERN_PROFILE_STAGE(kcxt, KERN_PROFILE__ATOMICS);
 			/* store the result virtual-tuple on the destination buffer */
 			if (rc)
 			{
@@ -561,6 +584,7 @@ gpuscan_main_arrow(kern_context *kcxt,
 			/* bailout if any error */
 			if (__syncthreads_count(kcxt->errcode) > 0)
 				break;
+			KERN_PROFILE_STAGE(kcxt, KERN_PROFILE__PROJECTION);
 		}
 		/* write back statistics */
 		if (get_local_id() == 0)
@@ -640,6 +664,7 @@ gpuscan_main_column(kern_context *kcxt,
 		{
 			if (kern_check_visibility_column(kcxt, kds_src, src_index))
 			{
+				KERN_PROFILE_STAGE(kcxt, KERN_PROFILE__LOAD);
 				rc = gpuscan_quals_eval_column(kcxt,
 											   kds_src,
 											   kds_extra,
@@ -649,6 +674,7 @@ gpuscan_main_column(kern_context *kcxt,
 		/* bailout if any error */
 		if (__syncthreads_count(kcxt->errcode) > 0)
 			break;
+		KERN_PROFILE_STAGE(kcxt, KERN_PROFILE__QUALS);
 		/* how many rows servived the evaluation above? */
 		nitems_offset = pgstromStairlikeBinaryCount(rc, &nvalids);
 		if (nvalids > 0)
@@ -675,6 +701,7 @@ gpuscan_main_column(kern_context *kcxt,
 			/* bailout if any error */
 			if (__syncthreads_count(kcxt->errcode) > 0)
 				break;
+			KERN_PROFILE_STAGE(kcxt, KERN_PROFILE__PROJECTION);
 			/* allocation of the destination buffer */
 			usage_offset = pgstromStairlikeSum(__kds_packed(required),
 											   &usage_length);
@@ -710,6 +737,7 @@ gpuscan_main_column(kern_context *kcxt,
 			}
 			if (__syncthreads_count(suspend_kernel) > 0)
 				break;
+			KERN_PROFILE_STAGE(kcxt, KERN_PROFILE__ATOMICS);
 			/* store the result tuple on the destination buffer */
 			if (rc)
 			{
@@ -724,6 +752,7 @@ gpuscan_main_column(kern_context *kcxt,
 									  tup_dclass,
 									  tup_values);
 			}
+			KERN_PROFILE_STAGE(kcxt, KERN_PROFILE__PROJECTION);
 		}
 		/* update statistics */
 		if (get_local_id() == 0)
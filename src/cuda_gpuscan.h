@@ -11,6 +11,12 @@
  */
 #ifndef CUDA_GPUSCAN_H
 #define CUDA_GPUSCAN_H
+/*
+ * Max number of the device qualifiers to be re-ordered at run-time;
+ * see gpuscan_adaptive_reorder_quals()
+ */
+#define GPUSCAN_ADAPTIVE_NQUALS_MAX		8
+
 /*
  * kern_gpuscan
  */
@@ -26,6 +32,15 @@ struct kern_gpuscan {
 	cl_uint			suspend_sz;			/* size of suspend context buffer */
 	cl_uint			suspend_count;		/* # of suspended workgroups */
 	cl_bool			resume_context;		/* true, if kernel should resume */
+	/* selection bitmap by vectorized quals (only KDS_FORMAT_ARROW) */
+	cl_uint		   *arrow_selmap;
+	/* adaptive ordering of the device qualifiers */
+	cl_bool			quals_sampling;		/* true, if counters are updated */
+	cl_uchar		quals_order[GPUSCAN_ADAPTIVE_NQUALS_MAX];
+	cl_uint			quals_nevals[GPUSCAN_ADAPTIVE_NQUALS_MAX];
+	cl_uint			quals_npassed[GPUSCAN_ADAPTIVE_NQUALS_MAX];
+	/* per-stage cycle counters (only PGSTROM_KERNEL_PROFILING) */
+	kern_profile	profile;
 	cl_ulong		data[1];			/* variable length area */
 	/* <-- gpuscanSuspendContext --> */
 };
@@ -60,6 +75,132 @@ gpuscan_quals_eval_column(kern_context *kcxt,
 						  kern_data_store *kds,
 						  kern_data_extra *extra,
 						  cl_uint src_index);
+#if GPUSCAN_HAS_ARROW_VECTORIZED_QUALS
+DEVICE_FUNCTION(cl_uint)
+gpuscan_quals_eval_arrow_vectorized(kern_context *kcxt,
+									kern_data_store *kds,
+									cl_uint word_index);
+#endif
+
+/*
+ * arrow_vectorized_nullmask - returns 32bits of the null-bitmap (1 means
+ * valid value) on the @word_index'th word of the column.
+ */
+STATIC_INLINE(cl_uint)
+arrow_vectorized_nullmask(kern_data_store *kds,
+						  cl_uint colidx,
+						  cl_uint word_index)
+{
+	kern_colmeta   *cmeta = &kds->colmeta[colidx];
+	cl_uchar	   *nullmap;
+	cl_uint			offset = sizeof(cl_uint) * word_index;
+	cl_uint			length;
+	cl_uint			mask = 0;
+	cl_uint			i;
+
+	assert(kds->format == KDS_FORMAT_ARROW);
+	if (cmeta->nullmap_offset == 0)
+		return ~0U;
+	nullmap = (cl_uchar *)kds + __kds_unpack(cmeta->nullmap_offset);
+	length = __kds_unpack(cmeta->nullmap_length);
+	if (offset + sizeof(cl_uint) <= length)
+		return *((cl_uint *)(nullmap + offset));
+	for (i=0; offset + i < length; i++)
+		mask |= ((cl_uint)nullmap[offset + i]) << (8 * i);
+	return mask;
+}
+
+/*
+ * arrow_vectorized_fetch - loads 4 fixed-width values from @row_index at
+ * once, using vector load if aligned. Values out of the range are filled
+ * by zero; caller has to mask them out.
+ */
+#define ARROW_VECTORIZED_FETCH_TEMPLATE(BASE,VTYPE)				\
+	STATIC_INLINE(void)											\
+	arrow_vectorized_fetch(kern_data_store *kds,				\
+						   cl_uint colidx,						\
+						   cl_uint row_index,					\
+						   BASE values[4])						\
+	{															\
+		kern_colmeta *cmeta = &kds->colmeta[colidx];			\
+		BASE	   *addr;										\
+		cl_uint		i;											\
+																\
+		assert(kds->format == KDS_FORMAT_ARROW);				\
+		addr = (BASE *)((char *)kds +							\
+						__kds_unpack(cmeta->values_offset)) +	\
+			row_index;											\
+		if (row_index + 4 <= kds->nitems &&						\
+			((cl_ulong)addr & (sizeof(VTYPE) - 1)) == 0)		\
+		{														\
+			const cl_uint unitsz = sizeof(VTYPE) / sizeof(BASE);	\
+			VTYPE	temp;										\
+																\
+			for (i=0; i < 4; i += unitsz)						\
+			{													\
+				temp = *((VTYPE *)(addr + i));					\
+				memcpy(values + i, &temp, sizeof(VTYPE));		\
+			}													\
+		}														\
+		else													\
+		{														\
+			for (i=0; i < 4; i++)								\
+				values[i] = (row_index + i < kds->nitems ? addr[i] : 0); \
+		}														\
+	}
+ARROW_VECTORIZED_FETCH_TEMPLATE(cl_char,  char4)
+ARROW_VECTORIZED_FETCH_TEMPLATE(cl_short, short4)
+ARROW_VECTORIZED_FETCH_TEMPLATE(cl_int,   int4)
+ARROW_VECTORIZED_FETCH_TEMPLATE(cl_long,  longlong2)
+
+/*
+ * arrow_vectorized_<op>_int1/int2 - compares 4 narrow integers with the
+ * constant by SIMD-within-a-register intrinsics; int1 values are packed in
+ * a 32bit word, and int2 values are in two words. It returns 4bits mask of
+ * the rows that satisfied the comparison. The constant must be in the range
+ * of the column type.
+ */
+STATIC_INLINE(cl_uint)
+__arrow_vectorized_bytemask(cl_uint m)
+{
+	/* 0xff/0x00 per byte to 1bit per byte; no carries across bit 28..31 */
+	return ((m & 0x01010101U) * 0x10204080U) >> 28;
+}
+
+STATIC_INLINE(cl_uint)
+__arrow_vectorized_halfmask(cl_uint m0, cl_uint m1)
+{
+	/* 0xffff/0x0000 per half-word to 1bit per half-word */
+	return ((m0 & 1U) | ((m0 >> 15) & 2U) |
+			((m1 & 1U) << 2) | ((m1 >> 13) & 8U));
+}
+
+#define ARROW_VECTORIZED_CMP_TEMPLATE(NAME,VCMP4,VCMP2)					\
+	STATIC_INLINE(cl_uint)												\
+	arrow_vectorized_##NAME##_int1(const cl_char values[4], cl_int cval)	\
+	{																	\
+		cl_uint		x;													\
+																		\
+		memcpy(&x, values, sizeof(cl_uint));							\
+		return __arrow_vectorized_bytemask(								\
+			VCMP4(x, __byte_perm((cl_uint)cval, 0, 0x0000)));			\
+	}																	\
+	STATIC_INLINE(cl_uint)												\
+	arrow_vectorized_##NAME##_int2(const cl_short values[4], cl_int cval)	\
+	{																	\
+		cl_uint		x[2];												\
+		cl_uint		y = __byte_perm((cl_uint)cval, 0, 0x1010);			\
+																		\
+		memcpy(x, values, sizeof(x));									\
+		return __arrow_vectorized_halfmask(VCMP2(x[0], y),				\
+										   VCMP2(x[1], y));				\
+	}
+ARROW_VECTORIZED_CMP_TEMPLATE(lt, __vcmplts4, __vcmplts2)
+ARROW_VECTORIZED_CMP_TEMPLATE(le, __vcmples4, __vcmples2)
+ARROW_VECTORIZED_CMP_TEMPLATE(eq, __vcmpeq4,  __vcmpeq2)
+ARROW_VECTORIZED_CMP_TEMPLATE(ge, __vcmpges4, __vcmpges2)
+ARROW_VECTORIZED_CMP_TEMPLATE(gt, __vcmpgts4, __vcmpgts2)
+#undef ARROW_VECTORIZED_FETCH_TEMPLATE
 
 DEVICE_FUNCTION(void)
 gpuscan_projection_tuple(kern_context *kcxt,
@@ -110,6 +251,42 @@ gpuscan_main_column(kern_context *kcxt,
                     kern_data_store *kds_dst);
 #endif	/* __CUDACC__ */
 #ifdef __CUDACC_RTC__
+#if GPUSCAN_ADAPTIVE_NQUALS > 0
+/*
+ * Order of the device qualifiers, and the counters of evaluated/passed rows
+ * (NULL, if not sampling), referenced by the generated gpuscan_quals_eval.
+ * They are loaded from kern_gpuscan once at the kernel entry, so all the
+ * threads evaluate the qualifiers in the consistent order during a kernel
+ * invocation.
+ */
+__shared__ cl_uchar		gpuscan_quals_order[GPUSCAN_ADAPTIVE_NQUALS];
+__shared__ cl_uint	   *gpuscan_quals_nevals;
+__shared__ cl_uint	   *gpuscan_quals_npassed;
+
+STATIC_INLINE(void)
+gpuscan_setup_quals_order(kern_gpuscan *kgpuscan)
+{
+	if (get_local_id() == 0)
+	{
+		for (int i=0; i < GPUSCAN_ADAPTIVE_NQUALS; i++)
+			gpuscan_quals_order[i] = kgpuscan->quals_order[i];
+		if (kgpuscan->quals_sampling)
+		{
+			gpuscan_quals_nevals = kgpuscan->quals_nevals;
+			gpuscan_quals_npassed = kgpuscan->quals_npassed;
+		}
+		else
+		{
+			gpuscan_quals_nevals = NULL;
+			gpuscan_quals_npassed = NULL;
+		}
+	}
+	__syncthreads();
+}
+#else
+#define gpuscan_setup_quals_order(kgpuscan)		((void)0)
+#endif	/* GPUSCAN_ADAPTIVE_NQUALS */
+
 /*
  * GPU kernel entrypoint - valid only NVRTC
  */
@@ -123,8 +300,10 @@ kern_gpuscan_main_row(kern_gpuscan *kgpuscan,
 	DECL_KERNEL_CONTEXT(u);
 
 	INIT_KERNEL_CONTEXT(&u.kcxt, kparams);
+	gpuscan_setup_quals_order(kgpuscan);
 	gpuscan_main_row(&u.kcxt, kgpuscan, kds_src, kds_dst,
 					 GPUSCAN_HAS_DEVICE_PROJECTION);
+	KERN_PROFILE_FLUSH(&kgpuscan->profile, &u.kcxt);
 	kern_writeback_error_status(&kgpuscan->kerror, &u.kcxt);
 }
 
@@ -138,8 +317,10 @@ kern_gpuscan_main_block(kern_gpuscan *kgpuscan,
 	DECL_KERNEL_CONTEXT(u);
 
 	INIT_KERNEL_CONTEXT(&u.kcxt, kparams);
+	gpuscan_setup_quals_order(kgpuscan);
 	gpuscan_main_block(&u.kcxt, kgpuscan, kds_src, kds_dst,
 					   GPUSCAN_HAS_DEVICE_PROJECTION);
+	KERN_PROFILE_FLUSH(&kgpuscan->profile, &u.kcxt);
 	kern_writeback_error_status(&kgpuscan->kerror, &u.kcxt);
 }
 
@@ -153,10 +334,40 @@ kern_gpuscan_main_arrow(kern_gpuscan *kgpuscan,
 	DECL_KERNEL_CONTEXT(u);
 
 	INIT_KERNEL_CONTEXT(&u.kcxt, kparams);
+	gpuscan_setup_quals_order(kgpuscan);
 	gpuscan_main_arrow(&u.kcxt, kgpuscan, kds_src, kds_dst,
 					   GPUSCAN_HAS_DEVICE_PROJECTION);
+	KERN_PROFILE_FLUSH(&kgpuscan->profile, &u.kcxt);
+	kern_writeback_error_status(&kgpuscan->kerror, &u.kcxt);
+}
+
+#if GPUSCAN_HAS_ARROW_VECTORIZED_QUALS
+KERNEL_FUNCTION(void)
+kern_gpuscan_quals_arrow_vectorized(kern_gpuscan *kgpuscan,
+									kern_parambuf *kparams,
+									kern_data_store *kds_src)
+{
+	DECL_KERNEL_CONTEXT(u);
+	cl_uint		nwords = (kds_src->nitems + 31) / 32;
+	cl_uint		index;
+	cl_uint		mask;
+
+	assert(kds_src->format == KDS_FORMAT_ARROW);
+	INIT_KERNEL_CONTEXT(&u.kcxt, kparams);
+	for (index = get_global_id();
+		 index < nwords;
+		 index += get_global_size())
+	{
+		mask = gpuscan_quals_eval_arrow_vectorized(&u.kcxt, kds_src, index);
+		/* rows out of the range */
+		if (32 * (index + 1) > kds_src->nitems)
+			mask &= (1U << (kds_src->nitems - 32 * index)) - 1;
+		kgpuscan->arrow_selmap[index] = mask;
+	}
+	KERN_PROFILE_FLUSH(&kgpuscan->profile, &u.kcxt);
 	kern_writeback_error_status(&kgpuscan->kerror, &u.kcxt);
 }
+#endif	/* GPUSCAN_HAS_ARROW_VECTORIZED_QUALS */
 
 KERNEL_FUNCTION(void)
 kern_gpuscan_main_column(kern_gpuscan *kgpuscan,
@@ -168,11 +379,13 @@ kern_gpuscan_main_column(kern_gpuscan *kgpuscan,
 	DECL_KERNEL_CONTEXT(u);
 
 	INIT_KERNEL_CONTEXT(&u.kcxt, kparams);
+	gpuscan_setup_quals_order(kgpuscan);
 	gpuscan_main_column(&u.kcxt,
 						kgpuscan,
 						kds_src,
 						kds_extra,
 						kds_dst);
+	KERN_PROFILE_FLUSH(&kgpuscan->profile, &u.kcxt);
 	kern_writeback_error_status(&kgpuscan->kerror, &u.kcxt);
 }
 
@@ -12,19 +12,26 @@
 #include "cuda_common.h"
 #include "cuda_gpusort.h"
 /*
- * gpusort_setup_column
+ * gpusort_setup_index
+ *
+ * It initializes the result index according to the rows that satisfies
+ * the device qualifier. KDS_FORMAT_ROW/SLOT buffers are the results of
+ * the outer plan (e.g, GpuJoin or GpuPreAgg), and KDS_FORMAT_COLUMN is
+ * GPU cache.
  */
 DEVICE_FUNCTION(void)
-gpusort_setup_column(kern_context *kcxt,
-					 kern_gpusort *kgpusort,
-					 kern_data_store *kds_src)
+gpusort_setup_index(kern_context *kcxt,
+					kern_gpusort *kgpusort,
+					kern_data_store *kds_src)
 {
 	gpusortResultIndex *kresults = KERN_GPUSORT_RESULT_INDEX(kgpusort);
 	cl_uint			globalSz = get_global_size();
 	cl_uint			loop, nloops;
 	__shared__ cl_uint pos;
 
-	assert(kds_src->format == KDS_FORMAT_COLUMN);
+	assert(kds_src->format == KDS_FORMAT_ROW ||
+		   kds_src->format == KDS_FORMAT_SLOT ||
+		   kds_src->format == KDS_FORMAT_COLUMN);
 	nloops = (kds_src->nitems + globalSz - 1) / globalSz;
 	for (loop=0; loop < nloops; loop++)
 	{
@@ -230,3 +237,234 @@ gpusort_bitonic_merge(kern_context *kcxt,
 		kresults->results[partBase + i] = localIdx[i];
 	__syncthreads();
 }
+
+/*
+ * gpusort_radix_keyset
+ *
+ * It fetches the @keyno-th sorting key (or its NULL flag) of the rows
+ * according to the current order of the result index.
+ */
+DEVICE_FUNCTION(void)
+gpusort_radix_keyset(kern_context *kcxt,
+					 kern_gpusort *kgpusort,
+					 kern_data_store *kds_src,
+					 cl_uint *index_in,
+					 cl_ulong *keys,
+					 cl_int keyno,
+					 cl_bool null_pass)
+{
+	gpusortResultIndex *kresults = KERN_GPUSORT_RESULT_INDEX(kgpusort);
+	cl_uint			nitems = kresults->nitems;
+	cl_uint			i;
+
+	/* quick bailout if any error happen in the prior kernel */
+	if (__syncthreads_count(kgpusort->kerror.errcode) != 0)
+		return;
+	for (i = get_global_id(); i < nitems; i += get_global_size())
+	{
+		keys[i] = gpusort_radix_key(kcxt, kds_src, index_in[i],
+									keyno, null_pass);
+	}
+}
+
+/*
+ * gpusort_radix_count
+ *
+ * It counts number of the digits on the tile of the thread-block.
+ * The histogram is saved in digit-major order (hist[digit][block]),
+ * so the exclusive prefix sum of the entire histogram gives the
+ * destination of the first item for each pair of digit and block.
+ */
+DEVICE_FUNCTION(void)
+gpusort_radix_count(kern_context *kcxt,
+					kern_gpusort *kgpusort,
+					cl_ulong *keys_in,
+					cl_uint *hist,
+					cl_uint shift,
+					cl_uint tilesz)
+{
+	gpusortResultIndex *kresults = KERN_GPUSORT_RESULT_INDEX(kgpusort);
+	cl_uint			nitems = kresults->nitems;
+	cl_uint			tile_head = get_group_id() * tilesz;
+	cl_uint			tile_tail = Min(tile_head + tilesz, nitems);
+	cl_uint			i;
+	__shared__ cl_uint counters[GPUSORT_RADIX_NBUCKETS];
+
+	/* quick bailout if any error happen in the prior kernel */
+	if (__syncthreads_count(kgpusort->kerror.errcode) != 0)
+		return;
+	for (i = get_local_id(); i < GPUSORT_RADIX_NBUCKETS; i += get_local_size())
+		counters[i] = 0;
+	__syncthreads();
+
+	for (i = tile_head + get_local_id(); i < tile_tail; i += get_local_size())
+	{
+		cl_uint		digit = (keys_in[i] >> shift) & GPUSORT_RADIX_MASK;
+
+		atomicAdd(&counters[digit], 1);
+	}
+	__syncthreads();
+
+	for (i = get_local_id(); i < GPUSORT_RADIX_NBUCKETS; i += get_local_size())
+		hist[i * get_num_groups() + get_group_id()] = counters[i];
+}
+
+/*
+ * gpusort_radix_scan
+ *
+ * It makes exclusive prefix sum of the histogram. Only one thread-block
+ * shall be launched.
+ */
+DEVICE_FUNCTION(void)
+gpusort_radix_scan(kern_context *kcxt,
+				   kern_gpusort *kgpusort,
+				   cl_uint *hist,
+				   cl_uint nhists)
+{
+	cl_uint			base = 0;
+	cl_uint			i;
+
+	assert(get_num_groups() == 1);
+	/* quick bailout if any error happen in the prior kernel */
+	if (__syncthreads_count(kgpusort->kerror.errcode) != 0)
+		return;
+	for (i = 0; i < nhists; i += get_local_size())
+	{
+		cl_uint		j = i + get_local_id();
+		cl_uint		value = (j < nhists ? hist[j] : 0);
+		cl_uint		offset;
+		cl_uint		total;
+
+		offset = pgstromStairlikeSum(value, &total);
+		if (j < nhists)
+			hist[j] = base + offset - value;
+		base += total;
+		__syncthreads();
+	}
+}
+
+/*
+ * gpusort_radix_scatter
+ *
+ * It moves the keys and the result index to the destination according to
+ * the digit. The order of the items with same digit is preserved (stable),
+ * because LSD radix sort depends on the stability of the prior passes.
+ */
+DEVICE_FUNCTION(void)
+gpusort_radix_scatter(kern_context *kcxt,
+					  kern_gpusort *kgpusort,
+					  cl_ulong *keys_in,
+					  cl_ulong *keys_out,
+					  cl_uint *index_in,
+					  cl_uint *index_out,
+					  cl_uint *hist,
+					  cl_uint shift,
+					  cl_uint tilesz)
+{
+	gpusortResultIndex *kresults = KERN_GPUSORT_RESULT_INDEX(kgpusort);
+	cl_uint			nitems = kresults->nitems;
+	cl_uint			tile_head = get_group_id() * tilesz;
+	cl_uint			tile_tail = Min(tile_head + tilesz, nitems);
+	cl_uint			nwarps = get_local_size() / warpSize;
+	cl_uint			warp_id = get_local_id() / warpSize;
+	cl_uint			lanemask_lt = (1U << get_lane_id()) - 1;
+	cl_uint			base;
+	cl_uint			d, w;
+	__shared__ cl_uint bucket_pos[GPUSORT_RADIX_NBUCKETS];
+	__shared__ cl_uint warp_pos[GPUSORT_RADIX_NBUCKETS][GPUSORT_RADIX_MAX_NWARPS];
+
+	assert(get_local_size() % warpSize == 0 &&
+		   nwarps <= GPUSORT_RADIX_MAX_NWARPS);
+	/* quick bailout if any error happen in the prior kernel */
+	if (__syncthreads_count(kgpusort->kerror.errcode) != 0)
+		return;
+	for (d = get_local_id(); d < GPUSORT_RADIX_NBUCKETS; d += get_local_size())
+		bucket_pos[d] = hist[d * get_num_groups() + get_group_id()];
+	__syncthreads();
+
+	for (base = tile_head; base < tile_tail; base += get_local_size())
+	{
+		cl_uint		i = base + get_local_id();
+		cl_uint		digit = GPUSORT_RADIX_NBUCKETS;	/* invalid */
+		cl_uint		rank = 0;
+
+		if (i < tile_tail)
+			digit = (keys_in[i] >> shift) & GPUSORT_RADIX_MASK;
+		/* rank of the item within the warp */
+		for (d=0; d < GPUSORT_RADIX_NBUCKETS; d++)
+		{
+			cl_uint		mask = __ballot_sync(~0U, digit == d);
+
+			if (digit == d)
+				rank = __popc(mask & lanemask_lt);
+			if (get_lane_id() == 0)
+				warp_pos[d][warp_id] = __popc(mask);
+		}
+		__syncthreads();
+		/* position of the warp for each digit */
+		for (d = get_local_id(); d < GPUSORT_RADIX_NBUCKETS; d += get_local_size())
+		{
+			cl_uint		pos = bucket_pos[d];
+
+			for (w=0; w < nwarps; w++)
+			{
+				cl_uint		count = warp_pos[d][w];
+
+				warp_pos[d][w] = pos;
+				pos += count;
+			}
+			bucket_pos[d] = pos;
+		}
+		__syncthreads();
+		if (digit < GPUSORT_RADIX_NBUCKETS)
+		{
+			cl_uint		pos = warp_pos[digit][warp_id] + rank;
+
+			keys_out[pos] = keys_in[i];
+			index_out[pos] = index_in[i];
+		}
+		__syncthreads();
+	}
+}
+
+/*
+ * gpusort_window_flags
+ *
+ * It marks the head of partitions and peer groups on the sorted rows.
+ * Every row is compared to the previous one independently, so the host
+ * side can compute the ranks by one-pass scan of the flags.
+ */
+DEVICE_FUNCTION(void)
+gpusort_window_flags(kern_context *kcxt,
+					 kern_gpusort *kgpusort,
+					 kern_data_store *kds_src,
+					 cl_uint *sorted_index,
+					 cl_uchar *window_flags)
+{
+	gpusortResultIndex *kresults = KERN_GPUSORT_RESULT_INDEX(kgpusort);
+	cl_uint			nitems = kresults->nitems;
+	cl_uint			i;
+
+	/* quick bailout if any error happen in the prior kernel */
+	if (__syncthreads_count(kgpusort->kerror.errcode) != 0)
+		return;
+	for (i = get_global_id(); i < nitems; i += get_global_size())
+	{
+		cl_uint		x_index;
+		cl_uint		y_index;
+		cl_uchar	flags = 0;
+
+		if (i == 0)
+			flags = (GPUSORT_WINDOW_NEW_PARTITION | GPUSORT_WINDOW_NEW_PEER);
+		else
+		{
+			x_index = sorted_index[i-1];
+			y_index = sorted_index[i];
+			if (gpusort_partition_keycomp(kcxt, kds_src, x_index, y_index) != 0)
+				flags = (GPUSORT_WINDOW_NEW_PARTITION | GPUSORT_WINDOW_NEW_PEER);
+			else if (gpusort_keycomp(kcxt, kds_src, x_index, y_index) != 0)
+				flags = GPUSORT_WINDOW_NEW_PEER;
+		}
+		window_flags[i] = flags;
+	}
+}
@@ -18,7 +18,6 @@ typedef struct {
 	kern_errorbuf	kerror;
 	cl_uint			nitems_in;
 	cl_uint			nitems_out;
-	kern_parambuf	kparams;
 	/* <-- gpusortResultIndex --> */
 } kern_gpusort;
 
@@ -27,18 +26,57 @@ typedef struct {
 	cl_uint			results[FLEXIBLE_ARRAY_MEMBER];
 } gpusortResultIndex;
 
-#define KERN_GPUSORT_PARAMBUF(kgpusort)			\
-	(&((kern_gpusort *)(kgpusort))->kparams)
-#define KERN_GPUSORT_PARAMBUF_LENGTH(kgpusort)	\
-	STROMALIGN(KERN_GPUSORT_PARAMBUF(kgpusort)->length)
 #define KERN_GPUSORT_RESULT_INDEX(kgpusort)		\
 	((gpusortResultIndex *)						\
-	 ((char *)KERN_GPUSORT_PARAMBUF(kgpusort) + \
-	  KERN_GPUSORT_PARAMBUF_LENGTH(kgpusort)))
+	 ((char *)(kgpusort) + STROMALIGN(sizeof(kern_gpusort))))
+#define KERN_GPUSORT_LENGTH(nitems)				\
+	(STROMALIGN(sizeof(kern_gpusort)) +			\
+	 STROMALIGN(offsetof(gpusortResultIndex, results[(nitems)])))
 
 #define BITONIC_MAX_LOCAL_SHIFT		12
 #define BITONIC_MAX_LOCAL_SZ		(1<<BITONIC_MAX_LOCAL_SHIFT)
 
+/*
+ * Radix sort for fixed-width sorting keys
+ *
+ * If all the sorting keys are fixed-width and have order-preserving
+ * unsigned integer representation, GpuSort runs LSD radix sort instead
+ * of the bitonic sorting. Each key is sorted by RADIX_BITS digits from
+ * the least significant digit, then one more pass on the NULL flag.
+ * The work area below follows the result index.
+ *
+ *   cl_ulong  keys[2][nitems]   ... digits of the current key
+ *   cl_uint   index[nitems]     ... alternative result index
+ *   cl_uint   hist[RADIX_NBUCKETS * RADIX_MAX_NBLOCKS]
+ */
+#define GPUSORT_RADIX_BITS			4
+#define GPUSORT_RADIX_NBUCKETS		(1<<GPUSORT_RADIX_BITS)
+#define GPUSORT_RADIX_MASK			(GPUSORT_RADIX_NBUCKETS - 1)
+#define GPUSORT_RADIX_MAX_NBLOCKS	1024
+#define GPUSORT_RADIX_MAX_NWARPS	32
+
+#define KERN_GPUSORT_RADIX_LENGTH(nitems)						\
+	(2 * STROMALIGN(sizeof(cl_ulong) * (nitems)) +				\
+	 STROMALIGN(sizeof(cl_uint) * (nitems)) +					\
+	 STROMALIGN(sizeof(cl_uint) * GPUSORT_RADIX_NBUCKETS *		\
+				GPUSORT_RADIX_MAX_NBLOCKS))
+
+/*
+ * Window functions on the sorted rows
+ *
+ * If GpuSort feeds ranking window functions (row_number, rank and
+ * dense_rank), it marks the boundary of partitions and peer groups on the
+ * sorted result index. The host side accumulates the ranks according to
+ * the flags below during the fetch of the rows.
+ *
+ *   cl_uchar  flags[nitems]     ... follows the work area of radix sort
+ */
+#define GPUSORT_WINDOW_NEW_PARTITION	0x01
+#define GPUSORT_WINDOW_NEW_PEER			0x02
+
+#define KERN_GPUSORT_WINDOW_LENGTH(nitems)						\
+	STROMALIGN(sizeof(cl_uchar) * (nitems))
+
 #ifdef __CUDACC__
 /*
  * gpusort_quals_eval - evaluation of device qualifier
@@ -55,13 +93,72 @@ gpusort_keycomp(kern_context *kcxt,
 				kern_data_store *kds_src,
 				cl_uint x_index,
 				cl_uint y_index);
+/*
+ * gpusort_partition_keycomp - comparison of the PARTITION BY keys
+ *
+ * It compares the leading sorting keys that come from PARTITION BY clause
+ * of the window. It always returns 0 unless GpuSort runs window functions.
+ */
+DEVICE_FUNCTION(cl_int)
+gpusort_partition_keycomp(kern_context *kcxt,
+						  kern_data_store *kds_src,
+						  cl_uint x_index,
+						  cl_uint y_index);
+/*
+ * gpusort_radix_key - order-preserving unsigned integer of the sorting key
+ *
+ * It returns the key value of @keyno-th sorting key, or the NULL flag of
+ * the key if @null_pass is true.
+ */
+DEVICE_FUNCTION(cl_ulong)
+gpusort_radix_key(kern_context *kcxt,
+				  kern_data_store *kds_src,
+				  cl_uint row_index,
+				  cl_int keyno,
+				  cl_bool null_pass);
+/*
+ * gpusort_radix_float4/float8 - order-preserving representation of float
+ *
+ * NaN is larger than any other values, and -0.0 is equal to 0.0 according
+ * to the float comparison of PostgreSQL.
+ */
+DEVICE_INLINE(cl_ulong)
+gpusort_radix_float4(cl_float fval)
+{
+	cl_uint		bits;
+
+	if (isnan(fval))
+		bits = 0x7fc00000U;
+	else if (fval == 0.0)
+		bits = 0;
+	else
+		bits = __float_as_uint(fval);
+	return (cl_ulong)((bits & 0x80000000U) != 0 ? ~bits : (bits | 0x80000000U));
+}
+
+DEVICE_INLINE(cl_ulong)
+gpusort_radix_float8(cl_double fval)
+{
+	cl_ulong	bits;
+
+	if (isnan(fval))
+		bits = 0x7ff8000000000000UL;
+	else if (fval == 0.0)
+		bits = 0;
+	else
+		bits = (cl_ulong)__double_as_longlong(fval);
+	return ((bits & 0x8000000000000000UL) != 0
+			? ~bits
+			: (bits | 0x8000000000000000UL));
+}
+
 /*
  * GpuSort main logic;
  */
 DEVICE_FUNCTION(void)
-gpusort_setup_column(kern_context *kcxt,
-					 kern_gpusort *kgpusort,
-					 kern_data_store *kds_src);
+gpusort_setup_index(kern_context *kcxt,
+					kern_gpusort *kgpusort,
+					kern_data_store *kds_src);
 DEVICE_FUNCTION(void)
 gpusort_bitonic_local(kern_context *kcxt,
 					  kern_gpusort *kgpusort,
@@ -76,53 +173,174 @@ DEVICE_FUNCTION(void)
 gpusort_bitonic_merge(kern_context *kcxt,
 					  kern_gpusort *kgpusort,
 					  kern_data_store *kds_src);
+DEVICE_FUNCTION(void)
+gpusort_radix_keyset(kern_context *kcxt,
+					 kern_gpusort *kgpusort,
+					 kern_data_store *kds_src,
+					 cl_uint *index_in,
+					 cl_ulong *keys,
+					 cl_int keyno,
+					 cl_bool null_pass);
+DEVICE_FUNCTION(void)
+gpusort_radix_count(kern_context *kcxt,
+					kern_gpusort *kgpusort,
+					cl_ulong *keys_in,
+					cl_uint *hist,
+					cl_uint shift,
+					cl_uint tilesz);
+DEVICE_FUNCTION(void)
+gpusort_radix_scan(kern_context *kcxt,
+				   kern_gpusort *kgpusort,
+				   cl_uint *hist,
+				   cl_uint nhists);
+DEVICE_FUNCTION(void)
+gpusort_radix_scatter(kern_context *kcxt,
+					  kern_gpusort *kgpusort,
+					  cl_ulong *keys_in,
+					  cl_ulong *keys_out,
+					  cl_uint *index_in,
+					  cl_uint *index_out,
+					  cl_uint *hist,
+					  cl_uint shift,
+					  cl_uint tilesz);
+DEVICE_FUNCTION(void)
+gpusort_window_flags(kern_context *kcxt,
+					 kern_gpusort *kgpusort,
+					 kern_data_store *kds_src,
+					 cl_uint *sorted_index,
+					 cl_uchar *window_flags);
 #endif	/* __CUDACC__ */
 
 #ifdef	__CUDACC_RTC__
 KERNEL_FUNCTION(void)
-kern_gpusort_setup_column(kern_gpusort *kgpusort,
-						  kern_data_store *kds_src)
+kern_gpusort_setup_index(kern_gpusort *kgpusort,
+						 kern_parambuf *kparams,
+						 kern_data_store *kds_src)
 {
 	DECL_KERNEL_CONTEXT(u);
 
-	INIT_KERNEL_CONTEXT(&u.kcxt, &kgpusort->kparams);
-	gpusort_setup_column(&u.kcxt, kgpusort, kds_src);
+	INIT_KERNEL_CONTEXT(&u.kcxt, kparams);
+	gpusort_setup_index(&u.kcxt, kgpusort, kds_src);
 	kern_writeback_error_status(&kgpusort->kerror, &u.kcxt);
 }
 
 KERNEL_FUNCTION_MAXTHREADS(void)
 kern_gpusort_bitonic_local(kern_gpusort *kgpusort,
+						   kern_parambuf *kparams,
 						   kern_data_store *kds_src)
 {
 	DECL_KERNEL_CONTEXT(u);
 
-	INIT_KERNEL_CONTEXT(&u.kcxt, &kgpusort->kparams);
+	INIT_KERNEL_CONTEXT(&u.kcxt, kparams);
 	gpusort_bitonic_local(&u.kcxt, kgpusort, kds_src);
 	kern_writeback_error_status(&kgpusort->kerror, &u.kcxt);
 }
 
 KERNEL_FUNCTION_MAXTHREADS(void)
 kern_gpusort_bitonic_step(kern_gpusort *kgpusort,
+						  kern_parambuf *kparams,
 						  kern_data_store *kds_src,
 						  cl_uint unitsz,
 						  cl_bool reversing)
 {
 	DECL_KERNEL_CONTEXT(u);
 
-	INIT_KERNEL_CONTEXT(&u.kcxt, &kgpusort->kparams);
+	INIT_KERNEL_CONTEXT(&u.kcxt, kparams);
 	gpusort_bitonic_step(&u.kcxt, kgpusort, kds_src, unitsz, reversing);
 	kern_writeback_error_status(&kgpusort->kerror, &u.kcxt);
 }
 
 KERNEL_FUNCTION_MAXTHREADS(void)
 kern_gpusort_bitonic_merge(kern_gpusort *kgpusort,
+						   kern_parambuf *kparams,
 						   kern_data_store *kds_src)
 {
 	DECL_KERNEL_CONTEXT(u);
 
-	INIT_KERNEL_CONTEXT(&u.kcxt, &kgpusort->kparams);
+	INIT_KERNEL_CONTEXT(&u.kcxt, kparams);
 	gpusort_bitonic_merge(&u.kcxt, kgpusort, kds_src);
 	kern_writeback_error_status(&kgpusort->kerror, &u.kcxt);
 }
+
+KERNEL_FUNCTION(void)
+kern_gpusort_radix_keyset(kern_gpusort *kgpusort,
+						  kern_parambuf *kparams,
+						  kern_data_store *kds_src,
+						  cl_uint *index_in,
+						  cl_ulong *keys,
+						  cl_int keyno,
+						  cl_bool null_pass)
+{
+	DECL_KERNEL_CONTEXT(u);
+
+	INIT_KERNEL_CONTEXT(&u.kcxt, kparams);
+	gpusort_radix_keyset(&u.kcxt, kgpusort, kds_src,
+						 index_in, keys, keyno, null_pass);
+	kern_writeback_error_status(&kgpusort->kerror, &u.kcxt);
+}
+
+KERNEL_FUNCTION_MAXTHREADS(void)
+kern_gpusort_radix_count(kern_gpusort *kgpusort,
+						 kern_parambuf *kparams,
+						 cl_ulong *keys_in,
+						 cl_uint *hist,
+						 cl_uint shift,
+						 cl_uint tilesz)
+{
+	DECL_KERNEL_CONTEXT(u);
+
+	INIT_KERNEL_CONTEXT(&u.kcxt, kparams);
+	gpusort_radix_count(&u.kcxt, kgpusort, keys_in, hist, shift, tilesz);
+	kern_writeback_error_status(&kgpusort->kerror, &u.kcxt);
+}
+
+KERNEL_FUNCTION_MAXTHREADS(void)
+kern_gpusort_radix_scan(kern_gpusort *kgpusort,
+						kern_parambuf *kparams,
+						cl_uint *hist,
+						cl_uint nhists)
+{
+	DECL_KERNEL_CONTEXT(u);
+
+	INIT_KERNEL_CONTEXT(&u.kcxt, kparams);
+	gpusort_radix_scan(&u.kcxt, kgpusort, hist, nhists);
+	kern_writeback_error_status(&kgpusort->kerror, &u.kcxt);
+}
+
+KERNEL_FUNCTION_MAXTHREADS(void)
+kern_gpusort_radix_scatter(kern_gpusort *kgpusort,
+						   kern_parambuf *kparams,
+						   cl_ulong *keys_in,
+						   cl_ulong *keys_out,
+						   cl_uint *index_in,
+						   cl_uint *index_out,
+						   cl_uint *hist,
+						   cl_uint shift,
+						   cl_uint tilesz)
+{
+	DECL_KERNEL_CONTEXT(u);
+
+	INIT_KERNEL_CONTEXT(&u.kcxt, kparams);
+	gpusort_radix_scatter(&u.kcxt, kgpusort,
+						  keys_in, keys_out,
+						  index_in, index_out,
+						  hist, shift, tilesz);
+	kern_writeback_error_status(&kgpusort->kerror, &u.kcxt);
+}
+
+KERNEL_FUNCTION(void)
+kern_gpusort_window_flags(kern_gpusort *kgpusort,
+						  kern_parambuf *kparams,
+						  kern_data_store *kds_src,
+						  cl_uint *sorted_index,
+						  cl_uchar *window_flags)
+{
+	DECL_KERNEL_CONTEXT(u);
+
+	INIT_KERNEL_CONTEXT(&u.kcxt, kparams);
+	gpusort_window_flags(&u.kcxt, kgpusort, kds_src,
+						 sorted_index, window_flags);
+	kern_writeback_error_status(&kgpusort->kerror, &u.kcxt);
+}
 #endif	/* __CUDACC_RTC__ */
 #endif	/* CUDA_GPUSORT_H */
@@ -817,6 +817,157 @@ pgfn_jsonb_exists(kern_context *kcxt,
 	return result;
 }
 
+/*
+ * compareJsonbScalarEntry - equality of two scalar JEntry items
+ */
+STATIC_FUNCTION(cl_bool)
+compareJsonbScalarEntry(kern_context *kcxt,
+						JsonbContainer *jc1, cl_int index1, char *base1,
+						JsonbContainer *jc2, cl_int index2, char *base2)
+{
+	JEntry		entry1 = __Fetch(&jc1->children[index1]);
+	JEntry		entry2 = __Fetch(&jc2->children[index2]);
+
+	if ((entry1 & JENTRY_TYPEMASK) != (entry2 & JENTRY_TYPEMASK))
+		return false;
+	if (JBE_ISSTRING(entry1))
+	{
+		return (compareJsonbStringValue(base1 + getJsonbOffset(jc1, index1),
+										getJsonbLength(jc1, index1),
+										base2 + getJsonbOffset(jc2, index2),
+										getJsonbLength(jc2, index2)) == 0);
+	}
+	else if (JBE_ISNUMERIC(entry1))
+	{
+		char	   *data1 = base1 + INTALIGN(getJsonbOffset(jc1, index1));
+		char	   *data2 = base2 + INTALIGN(getJsonbOffset(jc2, index2));
+		pg_bool_t	rv;
+
+		rv = pgfn_numeric_eq(kcxt,
+							 pg_numeric_from_varlena(kcxt, (varlena *)data1),
+							 pg_numeric_from_varlena(kcxt, (varlena *)data2));
+		return (!rv.isnull && rv.value);
+	}
+	/* null, true and false are equal if type matches */
+	return true;
+}
+
+/*
+ * pgfn_jsonb_contains - jsonb @> jsonb
+ *
+ * It supports the common case where the right-hand side is a flat object
+ * or array of scalar values. A nested container on the right-hand side
+ * needs a recursive walk with de-duplication of the array elements, so it
+ * is processed by CPU fallback.
+ */
+DEVICE_FUNCTION(pg_bool_t)
+pgfn_jsonb_contains(kern_context *kcxt,
+					pg_jsonb_t arg1, pg_jsonb_t arg2)
+{
+	pg_bool_t	result;
+	char	   *jdata1;
+	char	   *jdata2;
+	cl_int		jlen1, jlen2;
+	JsonbContainer *jc1;
+	JsonbContainer *jc2;
+	cl_uint		jheader1;
+	cl_uint		jheader2;
+	cl_uint		count1;
+	cl_uint		count2;
+	char	   *base1;
+	char	   *base2;
+	cl_uint		i, j;
+
+	if (!pg_varlena_datum_extract(kcxt, arg1, &jdata1, &jlen1) ||
+		!pg_varlena_datum_extract(kcxt, arg2, &jdata2, &jlen2))
+	{
+		result.isnull = true;
+		return result;
+	}
+	jc1 = (JsonbContainer *)jdata1;
+	jc2 = (JsonbContainer *)jdata2;
+	jheader1 = __Fetch(&jc1->header);
+	jheader2 = __Fetch(&jc2->header);
+	count1 = JsonContainerSize(jheader1);
+	count2 = JsonContainerSize(jheader2);
+
+	result.isnull = false;
+	result.value = false;
+	/*
+	 * raw scalar can contain only another raw scalar, but an array may
+	 * contain a raw scalar. See JsonbDeepContains.
+	 */
+	if (JsonContainerIsScalar(jheader1) && !JsonContainerIsScalar(jheader2))
+		return result;
+
+	if (JsonContainerIsObject(jheader1) &&
+		JsonContainerIsObject(jheader2))
+	{
+		base1 = (char *)(jc1->children + 2 * count1);
+		base2 = (char *)(jc2->children + 2 * count2);
+		if (count2 > count1)
+			return result;
+		for (j=0; j < count2; j++)
+		{
+			JEntry		entry1;
+			JEntry		entry2 = __Fetch(&jc2->children[j + count2]);
+			cl_int		index;
+
+			if (JBE_ISCONTAINER(entry2))
+			{
+				STROM_CPU_FALLBACK(kcxt, ERRCODE_STROM_VARLENA_UNSUPPORTED,
+								   "nested jsonb containment on GPU");
+				result.isnull = true;
+				return result;
+			}
+			index = findJsonbIndexFromObject(jc1,
+											 base2 + getJsonbOffset(jc2, j),
+											 getJsonbLength(jc2, j));
+			if (index < 0)
+				return result;
+			entry1 = __Fetch(&jc1->children[index + count1]);
+			if (JBE_ISCONTAINER(entry1) ||
+				!compareJsonbScalarEntry(kcxt,
+										 jc1, index + count1, base1,
+										 jc2, j + count2, base2))
+				return result;
+		}
+		result.value = true;
+	}
+	else if (JsonContainerIsArray(jheader1) &&
+			 JsonContainerIsArray(jheader2))
+	{
+		base1 = (char *)(jc1->children + count1);
+		base2 = (char *)(jc2->children + count2);
+		for (j=0; j < count2; j++)
+		{
+			JEntry		entry2 = __Fetch(&jc2->children[j]);
+
+			if (JBE_ISCONTAINER(entry2))
+			{
+				STROM_CPU_FALLBACK(kcxt, ERRCODE_STROM_VARLENA_UNSUPPORTED,
+								   "nested jsonb containment on GPU");
+				result.isnull = true;
+				return result;
+			}
+			for (i=0; i < count1; i++)
+			{
+				JEntry		entry1 = __Fetch(&jc1->children[i]);
+
+				if (!JBE_ISCONTAINER(entry1) &&
+					compareJsonbScalarEntry(kcxt,
+											jc1, i, base1,
+											jc2, j, base2))
+					break;
+			}
+			if (i == count1)
+				return result;		/* not found */
+		}
+		result.value = true;
+	}
+	return result;
+}
+
 /*
  * Special shortcut for CoerceViaIO; fetch jsonb element as numeric values
  */
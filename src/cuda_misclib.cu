@@ -2067,3 +2067,269 @@ pgfn_tan(kern_context *kcxt, pg_float8_t arg1)
 	}
 	return result;
 }
+
+/*
+ * Array functions
+ *
+ * pg_array_t may be either of PostgreSQL array (length < 0) or Arrow::List
+ * (length >= 0). Arrow::List is always one-dimensional, and its number of
+ * elements is already known by the list offsets.
+ */
+DEVICE_FUNCTION(pg_int4_t)
+pgfn_array_cardinality(kern_context *kcxt, pg_array_t arg1)
+{
+	pg_int4_t	result;
+
+	result.isnull = arg1.isnull;
+	if (arg1.isnull)
+		return result;
+	if (arg1.length >= 0)
+		result.value = arg1.length;
+	else
+	{
+		cl_int	   *dims = ARR_DIMS(arg1.value);
+		cl_int		ndim = ARR_NDIM(arg1.value);
+		cl_int		i;
+
+		result.value = (ndim > 0 ? 1 : 0);
+		for (i=0; i < ndim; i++)
+			result.value *= __Fetch(dims + i);
+	}
+	return result;
+}
+
+DEVICE_FUNCTION(pg_int4_t)
+pgfn_array_ndims(kern_context *kcxt, pg_array_t arg1)
+{
+	pg_int4_t	result;
+
+	result.isnull = true;
+	if (arg1.isnull)
+		return result;
+	if (arg1.length >= 0)
+	{
+		if (arg1.length > 0)
+		{
+			result.isnull = false;
+			result.value = 1;
+		}
+	}
+	else
+	{
+		cl_int		ndim = ARR_NDIM(arg1.value);
+
+		if (ndim > 0)
+		{
+			result.isnull = false;
+			result.value = ndim;
+		}
+	}
+	return result;
+}
+
+DEVICE_FUNCTION(pg_int4_t)
+pgfn_array_length(kern_context *kcxt, pg_array_t arg1, pg_int4_t arg2)
+{
+	pg_int4_t	result;
+
+	result.isnull = true;
+	if (arg1.isnull || arg2.isnull)
+		return result;
+	if (arg1.length >= 0)
+	{
+		if (arg1.length > 0 && arg2.value == 1)
+		{
+			result.isnull = false;
+			result.value = arg1.length;
+		}
+	}
+	else
+	{
+		cl_int		ndim = ARR_NDIM(arg1.value);
+
+		if (arg2.value > 0 && arg2.value <= ndim)
+		{
+			result.isnull = false;
+			result.value = __Fetch(ARR_DIMS(arg1.value) + arg2.value - 1);
+		}
+	}
+	return result;
+}
+
+/*
+ * Vector similarity functions
+ *
+ * float4[] is used as a vector of embedding; both of PostgreSQL array and
+ * Arrow::List<Float32> are supported. Vectors must not contain NULLs, and
+ * both sides must have the same number of elements, as CPU version doing.
+ */
+STATIC_FUNCTION(const cl_float *)
+__vector_float4_values(kern_context *kcxt,
+					   const pg_array_t &arg, cl_uint *p_nitems)
+{
+	const char *nullmap = NULL;
+	cl_uint		start = 0;
+	cl_uint		i, nitems;
+	const cl_float *values;
+
+	if (arg.length < 0)
+	{
+		cl_int	   *dims = ARR_DIMS(arg.value);
+		cl_int		ndim = ARR_NDIM(arg.value);
+
+		nitems = (ndim > 0 ? 1 : 0);
+		for (i=0; i < ndim; i++)
+			nitems *= __Fetch(dims + i);
+		nullmap = ARR_NULLBITMAP(arg.value);
+		values = (const cl_float *)ARR_DATA_PTR(arg.value);
+	}
+	else
+	{
+		kern_data_store *kds = (kern_data_store *)arg.value;
+		kern_colmeta   *smeta = arg.smeta;
+
+		nitems = arg.length;
+		start = arg.start;
+		if (smeta->nullmap_offset != 0)
+			nullmap = (char *)kds + __kds_unpack(smeta->nullmap_offset);
+		values = (const cl_float *)
+			((char *)kds + __kds_unpack(smeta->values_offset)) + start;
+	}
+	if (nullmap)
+	{
+		for (i=0; i < nitems; i++)
+		{
+			if (att_isnull(start + i, nullmap))
+			{
+				STROM_EREPORT(kcxt, ERRCODE_NULL_VALUE_NOT_ALLOWED,
+							  "vector must not contain nulls");
+				return NULL;
+			}
+		}
+	}
+	*p_nitems = nitems;
+	return values;
+}
+
+/*
+ * __vector_float4_compute - accumulates sum of (x-y)^2, x*y, x^2 and y^2
+ */
+STATIC_FUNCTION(cl_bool)
+__vector_float4_compute(kern_context *kcxt,
+						const pg_array_t &arg1,
+						const pg_array_t &arg2,
+						cl_double *p_l2,
+						cl_double *p_dot,
+						cl_double *p_norm1,
+						cl_double *p_norm2)
+{
+	const cl_float *x;
+	const cl_float *y;
+	cl_uint		i, nitems1, nitems2;
+	cl_double	l2 = 0.0, dot = 0.0, norm1 = 0.0, norm2 = 0.0;
+
+	x = __vector_float4_values(kcxt, arg1, &nitems1);
+	if (!x)
+		return false;
+	y = __vector_float4_values(kcxt, arg2, &nitems2);
+	if (!y)
+		return false;
+	if (nitems1 != nitems2)
+	{
+		STROM_EREPORT(kcxt, ERRCODE_DATA_EXCEPTION,
+					  "different vector dimensions");
+		return false;
+	}
+	for (i=0; i < nitems1; i++)
+	{
+		cl_double	xv = __Fetch(x + i);
+		cl_double	yv = __Fetch(y + i);
+
+		l2    += (xv - yv) * (xv - yv);
+		dot   += xv * yv;
+		norm1 += xv * xv;
+		norm2 += yv * yv;
+	}
+	*p_l2 = l2;
+	*p_dot = dot;
+	*p_norm1 = norm1;
+	*p_norm2 = norm2;
+	return true;
+}
+
+DEVICE_FUNCTION(pg_float8_t)
+pgfn_vector_l2_distance(kern_context *kcxt,
+						pg_array_t arg1, pg_array_t arg2)
+{
+	pg_float8_t	result;
+	cl_double	l2, dot, norm1, norm2;
+
+	result.isnull = true;
+	if (!arg1.isnull && !arg2.isnull &&
+		__vector_float4_compute(kcxt, arg1, arg2,
+								&l2, &dot, &norm1, &norm2))
+	{
+		result.isnull = false;
+		result.value = sqrt(l2);
+	}
+	return result;
+}
+
+DEVICE_FUNCTION(pg_float8_t)
+pgfn_vector_inner_product(kern_context *kcxt,
+						  pg_array_t arg1, pg_array_t arg2)
+{
+	pg_float8_t	result;
+	cl_double	l2, dot, norm1, norm2;
+
+	result.isnull = true;
+	if (!arg1.isnull && !arg2.isnull &&
+		__vector_float4_compute(kcxt, arg1, arg2,
+								&l2, &dot, &norm1, &norm2))
+	{
+		result.isnull = false;
+		result.value = dot;
+	}
+	return result;
+}
+
+DEVICE_FUNCTION(pg_float8_t)
+pgfn_vector_negative_inner_product(kern_context *kcxt,
+								   pg_array_t arg1, pg_array_t arg2)
+{
+	pg_float8_t	result = pgfn_vector_inner_product(kcxt, arg1, arg2);
+
+	if (!result.isnull)
+		result.value = -result.value;
+	return result;
+}
+
+DEVICE_FUNCTION(pg_float8_t)
+pgfn_vector_cosine_distance(kern_context *kcxt,
+							pg_array_t arg1, pg_array_t arg2)
+{
+	pg_float8_t	result;
+	cl_double	l2, dot, norm1, norm2;
+
+	result.isnull = true;
+	if (!arg1.isnull && !arg2.isnull &&
+		__vector_float4_compute(kcxt, arg1, arg2,
+								&l2, &dot, &norm1, &norm2))
+	{
+		result.isnull = false;
+		if (norm1 == 0.0 || norm2 == 0.0)
+			result.value = DBL_NAN;
+		else
+		{
+			cl_double	sim = dot / sqrt(norm1 * norm2);
+
+			/* keep in range, against the rounding error */
+			if (sim > 1.0)
+				sim = 1.0;
+			else if (sim < -1.0)
+				sim = -1.0;
+			result.value = 1.0 - sim;
+		}
+	}
+	return result;
+}
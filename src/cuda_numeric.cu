@@ -470,7 +470,8 @@ pg_comp_hash(kern_context *kcxt, pg_numeric_t datum)
 {
 	if (datum.isnull)
 		return 0;
-
+	/* operators may return values with trailing zeros */
+	datum = pg_numeric_normalize(datum);
 	return pg_hash_any((cl_uchar *)&datum.value,
 					   offsetof(pg_numeric_t, weight) + sizeof(cl_short));
 }
@@ -1013,6 +1014,54 @@ pg_numeric_to_cstring(kern_context *kcxt, varlena *numeric,
 	return (cl_int)(cp - buf);
 }
 
+/*
+ * numeric_rescale
+ *
+ * It scales up the supplied numeric to the given weight at most 18 digits
+ * at once, instead of multiplication by 10 for each digit. Operators below
+ * keep the results in this scaled-integer form, and don't normalize them
+ * on every operation; trailing zeros are eliminated only when the value is
+ * hashed. It returns false if the scaled value overflows.
+ */
+STATIC_FUNCTION(cl_bool)
+numeric_rescale(pg_numeric_t *num, cl_int weight)
+{
+	Int128_t	curr = num->value;
+	cl_int		curr_weight = num->weight;
+	cl_bool		is_negative;
+
+	if (curr_weight >= weight)
+		return true;
+	is_negative = (__Int128_sign(curr) < 0);
+	if (is_negative)
+		curr = __Int128_inverse(curr);
+	while (curr_weight < weight)
+	{
+		cl_int		k = Min(weight - curr_weight, 18);
+		cl_ulong	pow10 = 1;
+		cl_ulong	hi;
+
+		while (k-- > 0)
+		{
+			pow10 *= 10;
+			curr_weight++;
+		}
+		if (__umul64hi((cl_ulong)curr.hi, pow10) != 0)
+			return false;
+		hi = (cl_ulong)curr.hi * pow10;
+		if (hi + __umul64hi(curr.lo, pow10) < hi)
+			return false;
+		hi += __umul64hi(curr.lo, pow10);
+		if ((cl_long)hi < 0)
+			return false;
+		curr.lo = curr.lo * pow10;
+		curr.hi = hi;
+	}
+	num->value = (is_negative ? __Int128_inverse(curr) : curr);
+	num->weight = curr_weight;
+	return true;
+}
+
 /*
  * Numeric operator functions
  */
@@ -1038,7 +1087,7 @@ pgfn_numeric_abs(kern_context *kcxt, pg_numeric_t arg)
 		if (__Int128_sign(arg.value) < 0)
 			arg.value = __Int128_inverse(arg.value);
 	}
-	return pg_numeric_normalize(arg);
+	return arg;
 }
 
 DEVICE_FUNCTION(pg_numeric_t)
@@ -1050,15 +1099,13 @@ pgfn_numeric_add(kern_context *kcxt,
 	result.isnull = arg1.isnull | arg2.isnull;
 	if (result.isnull)
 		return result;
-	while (arg1.weight > arg2.weight)
+	if (!numeric_rescale(&arg1, arg2.weight) ||
+		!numeric_rescale(&arg2, arg1.weight))
 	{
-		arg2.value = __Int128_mul(arg2.value, 10);
-		arg2.weight++;
-	}
-	while (arg1.weight < arg2.weight)
-	{
-		arg1.value = __Int128_mul(arg1.value, 10);
-		arg1.weight++;
+		result.isnull = true;
+		STROM_CPU_FALLBACK(kcxt, ERRCODE_NUMERIC_VALUE_OUT_OF_RANGE,
+						   "numeric value overflow");
+		return result;
 	}
 	asm volatile("add.cc.u64     %0, %2, %3;\n"
 				 "addc.u64       %1, %4, %5;\n"
@@ -1070,7 +1117,7 @@ pgfn_numeric_add(kern_context *kcxt,
 				   "l" (arg2.value.hi));
 	result.weight = arg1.weight;
 
-	return pg_numeric_normalize(result);
+	return result;
 }
 
 DEVICE_FUNCTION(pg_numeric_t)
@@ -1121,7 +1168,7 @@ pgfn_numeric_mul(kern_context *kcxt,
 	if (is_negative_1 != is_negative_2)
 		result.value = __Int128_inverse(result.value);
 	result.weight = arg1.weight + arg2.weight;
-	return pg_numeric_normalize(result);
+	return result;
 }
 
 /*
@@ -1140,15 +1187,22 @@ numeric_cmp(kern_context *kcxt, pg_numeric_t arg1, pg_numeric_t arg2)
 	else if (sign1 < sign2)
 		return -1;
 	/* ok, both of arg1 and arg2 is not zero, and have same sign */
-	while (arg1.weight > arg2.weight)
-	{
-		arg2.value = __Int128_mul(arg2.value, 10);
-		arg2.weight++;
-	}
-	while (arg1.weight < arg2.weight)
+	if (!numeric_rescale(&arg1, arg2.weight) ||
+		!numeric_rescale(&arg2, arg1.weight))
 	{
-		arg1.value = __Int128_mul(arg1.value, 10);
-		arg1.weight++;
+		/* one side has trailing zeros enough to overflow */
+		arg1 = pg_numeric_normalize(arg1);
+		arg2 = pg_numeric_normalize(arg2);
+		while (arg1.weight > arg2.weight)
+		{
+			arg2.value = __Int128_mul(arg2.value, 10);
+			arg2.weight++;
+		}
+		while (arg1.weight < arg2.weight)
+		{
+			arg1.value = __Int128_mul(arg1.value, 10);
+			arg1.weight++;
+		}
 	}
 	return __Int128_compare(arg1.value, arg2.value);
 }
@@ -1247,8 +1301,60 @@ pgfn_hll_hash_numeric(kern_context *kcxt, pg_numeric_t arg1)
 
 	result.isnull = arg1.isnull;
 	if (!result.isnull)
+	{
+		arg1 = pg_numeric_normalize(arg1);
 		result.value = pg_siphash_any((unsigned char *)&arg1.value,
 									  offsetof(pg_numeric_t, weight) + sizeof(cl_short));
+	}
+	return result;
+}
+
+/*
+ * Scaled integer for the fixed-point accumulator of GpuPreAgg
+ *
+ * It returns the supplied numeric multiplied by 10^scale as int8. Any digits
+ * below the scale and values out of int8 range are not expected, because
+ * the planner chooses the accumulator only if numeric has declared
+ * precision and scale.
+ */
+DEVICE_FUNCTION(pg_int8_t)
+pgfn_numeric_fixed(kern_context *kcxt, pg_numeric_t arg1, pg_int4_t arg2)
+{
+	pg_int8_t	result;
+	Int128_t	curr;
+	cl_int		weight;
+	cl_bool		is_negative;
+
+	result.isnull = (arg1.isnull | arg2.isnull);
+	if (result.isnull)
+		return result;
+
+	arg1 = pg_numeric_normalize(arg1);
+	curr = arg1.value;
+	weight = arg1.weight;
+	is_negative = (__Int128_sign(curr) < 0);
+	if (is_negative)
+		curr = __Int128_inverse(curr);
+	if (weight > arg2.value)
+	{
+		result.isnull = true;
+		STROM_EREPORT(kcxt, ERRCODE_NUMERIC_VALUE_OUT_OF_RANGE,
+					  "numeric value has more digits than the scale");
+		return result;
+	}
+	while (weight < arg2.value && curr.hi == 0)
+	{
+		curr = __Int128_mul(curr, 10);
+		weight++;
+	}
+	if (weight != arg2.value || curr.hi != 0 || curr.lo > LONG_MAX)
+	{
+		result.isnull = true;
+		STROM_EREPORT(kcxt, ERRCODE_NUMERIC_VALUE_OUT_OF_RANGE,
+					  "numeric value out of range for the scale");
+		return result;
+	}
+	result.value = (!is_negative ? (cl_long)curr.lo : -((cl_long)curr.lo));
 	return result;
 }
 
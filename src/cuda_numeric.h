@@ -410,6 +410,11 @@ pgfn_type_compare(kern_context *kcxt,
  */
 DEVICE_FUNCTION(pg_int8_t)
 pgfn_hll_hash_numeric(kern_context *kcxt, pg_numeric_t arg1);
+/*
+ * Scaled integer for the fixed-point accumulator of GpuPreAgg
+ */
+DEVICE_FUNCTION(pg_int8_t)
+pgfn_numeric_fixed(kern_context *kcxt, pg_numeric_t arg1, pg_int4_t arg2);
 
 #endif /* __CUDACC__ */
 #endif /* CUDA_NUMERIC_H */
@@ -714,10 +714,21 @@ pgfn_st_makepoint4(kern_context *kcxt,
 #define PT_OUTSIDE		(-1)
 #define PT_ERROR		9999
 
+/*
+ * Vertices are usually aligned to double, unless the geometry datum has
+ * short varlena header. memcpy() with unknown alignment is compiled to
+ * byte-by-byte loads, so we use 64bit loads if possible.
+ */
 STATIC_INLINE(const char *)
 __loadPoint2d(POINT2D *pt, const char *rawdata, cl_uint unitsz)
 {
-	memcpy(pt, rawdata, sizeof(POINT2D));
+	if (((cl_ulong)rawdata & (sizeof(double) - 1)) == 0)
+	{
+		pt->x = ((const double *)rawdata)[0];
+		pt->y = ((const double *)rawdata)[1];
+	}
+	else
+		memcpy(pt, rawdata, sizeof(POINT2D));
 	return rawdata + unitsz;
 }
 
@@ -726,8 +737,7 @@ __loadPoint2dIndex(POINT2D *pt,
 				   const char *rawdata, cl_uint unitsz, cl_uint index)
 {
 	rawdata += unitsz * index;
-	memcpy(pt, rawdata, sizeof(POINT2D));
-	return rawdata + unitsz;
+	return __loadPoint2d(pt, rawdata, unitsz);
 }
 
 STATIC_INLINE(int)
@@ -3168,6 +3178,27 @@ pgfn_st_dwithin(kern_context *kcxt,
 		}
 		else
 		{
+			geom_bbox_2d	bbox1;
+			geom_bbox_2d	bbox2;
+
+			/*
+			 * shortcut: if bounding boxes expanded by the tolerance don't
+			 * overlap, no need to walk on the geometries. Ad-hoc spatial
+			 * join without GiST-index is processed by nested-loop, and
+			 * most of the pairs shall be rejected here.
+			 */
+			if (__geometry_get_bbox2d(kcxt, &geom1, &bbox1) &&
+				__geometry_get_bbox2d(kcxt, &geom2, &bbox2) &&
+				!__geom_bbox_2d_is_empty(&bbox1) &&
+				!__geom_bbox_2d_is_empty(&bbox2) &&
+				((double)bbox1.xmin - arg3.value > (double)bbox2.xmax ||
+				 (double)bbox1.xmax + arg3.value < (double)bbox2.xmin ||
+				 (double)bbox1.ymin - arg3.value > (double)bbox2.ymax ||
+				 (double)bbox1.ymax + arg3.value < (double)bbox2.ymin))
+			{
+				result.value = false;
+				return result;
+			}
 			memset(&dl, 0, sizeof(DISTPTS));
 			dl.kcxt = kcxt;
 			dl.distance = DBL_MAX;
@@ -3388,6 +3419,14 @@ __geom_point_in_ring(const pg_geometry_t *geom, const POINT2D *pt,
 		/* zero length segments are ignored. */
 		if (seg1.x == seg2.x && seg1.y == seg2.y)
 			continue;
+		/*
+		 * segments entirely above, below or left of the point neither
+		 * contain the point nor cross the ray; skip determineSide().
+		 */
+		if ((seg1.y > pt->y && seg2.y > pt->y) ||
+			(seg1.y < pt->y && seg2.y < pt->y) ||
+			(seg1.x < pt->x && seg2.x < pt->x))
+			continue;
 
 		side = determineSide(&seg1, &seg2, pt);
 		if (side == 0.0)
@@ -14,6 +14,9 @@
 #include "access/xact.h"
 #include "pgtime.h"
 #include "utils/pg_locale.h"
+#include "port/pg_crc32c.h"
+#include <dirent.h>
+#include <utime.h>
 
 typedef struct
 {
@@ -38,6 +41,9 @@ typedef struct
 	pg_crc32		ptx_crc;
 	char		   *ptx_image;		/* may be CUDA_PROGRAM_BUILD_FAILURE */
 	size_t			ptx_length;
+	/* build time breakdown; negative if loaded from persistent cache */
+	cl_float		compile_msec;	/* NVRTC (on build) */
+	cl_float		link_msec;		/* cuLink (on the last load) */
 	char		   *error_msg;
 	int				error_code;
 	char			data[FLEXIBLE_ARRAY_MEMBER];
@@ -80,8 +86,11 @@ typedef struct
 static int		program_cache_size_kb;
 static int		num_program_builders;
 static bool		pgstrom_debug_jit_compile_options;
+static bool		pgstrom_debug_kernel_profiling;
 static bool		pgstrom_debug_cuda_enable_coredump_on_exception;
 static int		pgstrom_extra_kernel_stack_size;
+static bool		pgstrom_persistent_program_cache;
+static int		pgstrom_persistent_program_cache_size_kb;
 
 /* ---- static variables ---- */
 static shmem_startup_hook_type shmem_startup_next;
@@ -235,6 +244,10 @@ construct_flat_cuda_source(cl_uint extra_flags,
 	if ((extra_flags & DEVKERNEL_BUILD_DEBUG_INFO) != 0)
 		ofs += snprintf(source + ofs, len - ofs,
 						"#define PGSTROM_KERNEL_DEBUG 1\n");
+	/* Enables per-stage cycle counters? */
+	if ((extra_flags & DEVKERNEL_BUILD_PROFILING) != 0)
+		ofs += snprintf(source + ofs, len - ofs,
+						"#define PGSTROM_KERNEL_PROFILING 1\n");
 	/* Common PG-Strom device routine */
 	ofs += snprintf(source + ofs, len - ofs,
 					"#include \"cuda_common.h\"\n");
@@ -296,7 +309,8 @@ construct_flat_cuda_source(cl_uint extra_flags,
 static char *
 link_cuda_libraries(char *ptx_image,
 					size_t ptx_length,
-					cl_uint extra_flags)
+					cl_uint extra_flags,
+					size_t *p_bin_length)
 {
 	CUlinkState		lstate;
 	CUresult		rc;
@@ -352,6 +366,13 @@ link_cuda_libraries(char *ptx_image,
 		/* link libraries with debug options */
 		lib_suffix = "gfatbin";
 	}
+	else if ((extra_flags & DEVKERNEL_BUILD_PROFILING) != 0)
+	{
+		/* link libraries with per-stage cycle counters */
+		lib_suffix = "pfatbin";
+	}
+	Assert((extra_flags & DEVKERNEL_BUILD_DEBUG_INFO) == 0 ||
+		   (extra_flags & DEVKERNEL_BUILD_PROFILING) == 0);
 	/* Link log buffer */
 	jit_options[jit_index] = CU_JIT_ERROR_LOG_BUFFER;
 	jit_option_values[jit_index] = (void *)log_buffer;
@@ -457,6 +478,7 @@ link_cuda_libraries(char *ptx_image,
 	rc = cuLinkDestroy(lstate);
 	if (rc != CUDA_SUCCESS)
 		elog(ERROR, "failed on cuLinkDestroy: %s", errorText(rc));
+	*p_bin_length = bin_length;
 
 	return bin_image;
 }
@@ -506,6 +528,481 @@ writeout_temporary_file(char *tempfile, const char *suffix,
 	fclose(filp);
 }
 
+/*
+ * Persistent program cache
+ *
+ * PTX images built by NVRTC and cubin images linked with the fatbin
+ * libraries are also saved on $PGDATA/pg_strom_program_cache, then
+ * reused on the next startup of the database instance, to skip the
+ * expensive JIT compile/link steps. The file name is derived from the
+ * hash of the 'key' (flat source or PTX with build parameters), and the
+ * key itself is stored in the cache file and compared on the load time.
+ * The key also contains the build-id of the installed device headers and
+ * libraries, because the flat source only #include's them; reinstall of
+ * PG-Strom with the same githash (e.g, local changes) must not pick up
+ * the images built for the older data structures.
+ * The total size of the directory is kept within
+ * pg_strom.persistent_program_cache_size, by removal of the files least
+ * recently used.
+ */
+#define PGCACHE_PERSISTENT_DIR		"pg_strom_program_cache"
+#define PGCACHE_PERSISTENT_MAGIC	0x50475332		/* "PGS2" */
+
+typedef struct
+{
+	cl_uint		magic;
+	pg_crc32c	key_crc;
+	size_t		key_len;
+	pg_crc32c	image_crc;
+	size_t		image_len;
+	/* key, then image follows */
+} persistent_program_cache_header;
+
+/*
+ * persistent_program_cache_build_id
+ *
+ * It returns CRC32C of the device headers and libraries installed on
+ * PGSHAREDIR/pg_strom. Contents of the headers are hashed, but only the
+ * size and mtime of the fatbin libraries, because they are large.
+ */
+static int
+__build_id_fname_comp(const void *__a, const void *__b)
+{
+	return strcmp(*((const char **)__a), *((const char **)__b));
+}
+
+static pg_crc32c
+persistent_program_cache_build_id(void)
+{
+	static pg_crc32c build_id;
+	static bool		build_id_ready = false;
+	const char	   *dirname = PGSHAREDIR "/pg_strom";
+	char		  **fnames = NULL;
+	int				nitems = 0;
+	int				nrooms = 0;
+	DIR			   *dir;
+	struct dirent  *dentry;
+	int				i;
+
+	if (build_id_ready)
+		return build_id;
+
+	INIT_CRC32C(build_id);
+	dir = opendir(dirname);
+	if (!dir)
+		elog(ERROR, "could not open directory \"%s\": %m", dirname);
+	while ((dentry = readdir(dir)) != NULL)
+	{
+		const char *pos = strrchr(dentry->d_name, '.');
+
+		if (!pos || (strcmp(pos, ".h") != 0 &&
+					 strcmp(pos, ".fatbin") != 0 &&
+					 strcmp(pos, ".gfatbin") != 0 &&
+					 strcmp(pos, ".pfatbin") != 0))
+			continue;
+		if (nitems >= nrooms)
+		{
+			nrooms = 2 * nrooms + 40;
+			fnames = realloc(fnames, sizeof(char *) * nrooms);
+			if (!fnames)
+			{
+				closedir(dir);
+				elog(ERROR, "out of memory");
+			}
+		}
+		fnames[nitems] = strdup(dentry->d_name);
+		if (!fnames[nitems])
+		{
+			closedir(dir);
+			elog(ERROR, "out of memory");
+		}
+		nitems++;
+	}
+	closedir(dir);
+	/* readdir(3) returns the entries in arbitrary order */
+	if (nitems > 0)
+		qsort(fnames, nitems, sizeof(char *), __build_id_fname_comp);
+
+	for (i=0; i < nitems; i++)
+	{
+		char		path[MAXPGPATH];
+		struct stat	stat_buf;
+
+		snprintf(path, MAXPGPATH, "%s/%s", dirname, fnames[i]);
+		COMP_CRC32C(build_id, fnames[i], strlen(fnames[i]));
+		if (stat(path, &stat_buf) != 0)
+			elog(ERROR, "could not stat \"%s\": %m", path);
+		if (strcmp(strrchr(fnames[i], '.'), ".h") == 0)
+		{
+			char		buf[8192];
+			size_t		nbytes;
+			FILE	   *filp = fopen(path, "rb");
+
+			if (!filp)
+				elog(ERROR, "could not open \"%s\": %m", path);
+			while ((nbytes = fread(buf, 1, sizeof(buf), filp)) > 0)
+				COMP_CRC32C(build_id, buf, nbytes);
+			fclose(filp);
+		}
+		else
+		{
+			COMP_CRC32C(build_id, &stat_buf.st_size, sizeof(off_t));
+			COMP_CRC32C(build_id, &stat_buf.st_mtime, sizeof(time_t));
+		}
+		free(fnames[i]);
+	}
+	if (fnames)
+		free(fnames);
+	FIN_CRC32C(build_id);
+	build_id_ready = true;
+
+	return build_id;
+}
+
+static void
+persistent_program_cache_fname(char *fname, const char *suffix,
+							   const char *key, size_t key_len,
+							   pg_crc32c *p_key_crc)
+{
+	uint32		hash;
+	pg_crc32c	key_crc;
+
+	hash = hash_any((const unsigned char *)key, key_len);
+	INIT_CRC32C(key_crc);
+	COMP_CRC32C(key_crc, key, key_len);
+	FIN_CRC32C(key_crc);
+
+	snprintf(fname, MAXPGPATH, "%s/%s/%08x%08x.%s",
+			 DataDir, PGCACHE_PERSISTENT_DIR,
+			 hash, key_crc, suffix);
+	*p_key_crc = key_crc;
+}
+
+/*
+ * load_persistent_program_cache
+ *
+ * It returns a malloc'ed image if a valid cache file exists, or NULL.
+ */
+static char *
+load_persistent_program_cache(const char *suffix,
+							  const char *key, size_t key_len,
+							  size_t *p_image_len)
+{
+	persistent_program_cache_header hdr;
+	char		fname[MAXPGPATH];
+	pg_crc32c	key_crc;
+	pg_crc32c	image_crc;
+	char	   *temp;
+	char	   *image;
+	FILE	   *filp;
+
+	if (!pgstrom_persistent_program_cache)
+		return NULL;
+	persistent_program_cache_fname(fname, suffix, key, key_len, &key_crc);
+	filp = fopen(fname, "rb");
+	if (!filp)
+		return NULL;
+	if (fread(&hdr, sizeof(hdr), 1, filp) != 1 ||
+		hdr.magic != PGCACHE_PERSISTENT_MAGIC ||
+		hdr.key_crc != key_crc ||
+		hdr.key_len != key_len)
+	{
+		fclose(filp);
+		return NULL;
+	}
+	/* the file name is just a hash, so compare the entire key */
+	temp = malloc(key_len);
+	if (!temp)
+	{
+		fclose(filp);
+		return NULL;
+	}
+	if (fread(temp, 1, key_len, filp) != key_len ||
+		memcmp(temp, key, key_len) != 0)
+	{
+		free(temp);
+		fclose(filp);
+		return NULL;
+	}
+	free(temp);
+
+	image = malloc(hdr.image_len + 1);
+	if (!image)
+	{
+		fclose(filp);
+		return NULL;
+	}
+	if (fread(image, 1, hdr.image_len, filp) != hdr.image_len)
+	{
+		free(image);
+		fclose(filp);
+		return NULL;
+	}
+	fclose(filp);
+
+	INIT_CRC32C(image_crc);
+	COMP_CRC32C(image_crc, image, hdr.image_len);
+	FIN_CRC32C(image_crc);
+	if (image_crc != hdr.image_crc)
+	{
+		elog(LOG, "persistent program cache \"%s\" is corrupted", fname);
+		free(image);
+		return NULL;
+	}
+	/* update mtime for the LRU eviction */
+	utime(fname, NULL);
+	*p_image_len = hdr.image_len;
+
+	return image;
+}
+
+/*
+ * cleanup_persistent_program_cache
+ *
+ * It removes the cache files least recently used (by mtime), if total
+ * size of the directory exceeds pg_strom.persistent_program_cache_size.
+ * The files are removed until 90% of the limit, not to run the cleanup
+ * on every save. Temporary files left by crashed writers are also removed.
+ */
+typedef struct
+{
+	char		fname[MAXPGPATH];
+	off_t		fsize;
+	time_t		mtime;
+} persistent_program_cache_file;
+
+static int
+__cleanup_persistent_file_comp(const void *__a, const void *__b)
+{
+	const persistent_program_cache_file *a = __a;
+	const persistent_program_cache_file *b = __b;
+
+	if (a->mtime < b->mtime)
+		return -1;
+	if (a->mtime > b->mtime)
+		return 1;
+	return 0;
+}
+
+static void
+cleanup_persistent_program_cache(void)
+{
+	persistent_program_cache_file *files = NULL;
+	char		dirname[MAXPGPATH];
+	uint64		limit = (uint64)pgstrom_persistent_program_cache_size_kb << 10;
+	uint64		total_sz = 0;
+	time_t		now = time(NULL);
+	int			nitems = 0;
+	int			nrooms = 0;
+	DIR		   *dir;
+	struct dirent *dentry;
+	int			i;
+
+	if (pgstrom_persistent_program_cache_size_kb <= 0)
+		return;		/* unlimited */
+	snprintf(dirname, MAXPGPATH, "%s/%s", DataDir, PGCACHE_PERSISTENT_DIR);
+	dir = opendir(dirname);
+	if (!dir)
+		return;
+	while ((dentry = readdir(dir)) != NULL)
+	{
+		persistent_program_cache_file *curr;
+		struct stat	stat_buf;
+
+		if (dentry->d_name[0] == '.')
+			continue;
+		if (nitems >= nrooms)
+		{
+			nrooms = 2 * nrooms + 100;
+			curr = realloc(files, sizeof(persistent_program_cache_file) * nrooms);
+			if (!curr)
+				break;
+			files = curr;
+		}
+		curr = &files[nitems];
+		snprintf(curr->fname, MAXPGPATH, "%s/%s", dirname, dentry->d_name);
+		if (stat(curr->fname, &stat_buf) != 0 ||
+			!S_ISREG(stat_buf.st_mode))
+			continue;
+		/* temporary file of the crashed writer? */
+		if (strstr(dentry->d_name, ".tmp.") != NULL)
+		{
+			if (now - stat_buf.st_mtime > 600)
+				unlink(curr->fname);
+			continue;
+		}
+		curr->fsize = stat_buf.st_size;
+		curr->mtime = stat_buf.st_mtime;
+		total_sz += stat_buf.st_size;
+		nitems++;
+	}
+	closedir(dir);
+
+	if (total_sz > limit)
+	{
+		qsort(files, nitems, sizeof(persistent_program_cache_file),
+			  __cleanup_persistent_file_comp);
+		for (i=0; i < nitems && total_sz > limit - limit / 10; i++)
+		{
+			if (unlink(files[i].fname) == 0 || errno == ENOENT)
+				total_sz -= files[i].fsize;
+		}
+		elog(LOG, "persistent program cache: %d files removed", i);
+	}
+	if (files)
+		free(files);
+}
+
+/*
+ * save_persistent_program_cache
+ *
+ * It writes out the key and image to the cache file. Concurrent writers
+ * are harmless because a temporary file is renamed to the final name.
+ * Any errors are not fatal; it merely loses the chance of reuse.
+ */
+static void
+save_persistent_program_cache(const char *suffix,
+							  const char *key, size_t key_len,
+							  const char *image, size_t image_len)
+{
+	static pg_atomic_uint64 cacheFileCounter = {0};
+	persistent_program_cache_header hdr;
+	char		fname[MAXPGPATH];
+	char		tempfile[MAXPGPATH];
+	pg_crc32c	key_crc;
+	FILE	   *filp;
+
+	if (!pgstrom_persistent_program_cache)
+		return;
+	persistent_program_cache_fname(fname, suffix, key, key_len, &key_crc);
+	snprintf(tempfile, MAXPGPATH, "%s.tmp.%d.%ld",
+			 fname, MyProcPid,
+			 pg_atomic_fetch_add_u64(&cacheFileCounter, 1));
+	filp = fopen(tempfile, "wb");
+	if (!filp)
+	{
+		char	dirname[MAXPGPATH];
+
+		snprintf(dirname, MAXPGPATH, "%s/%s",
+				 DataDir, PGCACHE_PERSISTENT_DIR);
+		mkdir(dirname, S_IRWXU);
+
+		filp = fopen(tempfile, "wb");
+		if (!filp)
+		{
+			elog(LOG, "unable to open \"%s\": %m", tempfile);
+			return;
+		}
+	}
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.magic		= PGCACHE_PERSISTENT_MAGIC;
+	hdr.key_crc		= key_crc;
+	hdr.key_len		= key_len;
+	INIT_CRC32C(hdr.image_crc);
+	COMP_CRC32C(hdr.image_crc, image, image_len);
+	FIN_CRC32C(hdr.image_crc);
+	hdr.image_len	= image_len;
+
+	if (fwrite(&hdr, sizeof(hdr), 1, filp) != 1 ||
+		fwrite(key, 1, key_len, filp) != key_len ||
+		fwrite(image, 1, image_len, filp) != image_len)
+	{
+		elog(LOG, "failed on write \"%s\": %m", tempfile);
+		fclose(filp);
+		unlink(tempfile);
+		return;
+	}
+	if (fclose(filp) != 0 || rename(tempfile, fname) != 0)
+	{
+		elog(LOG, "failed on save \"%s\": %m", fname);
+		unlink(tempfile);
+		return;
+	}
+	cleanup_persistent_program_cache();
+}
+
+/*
+ * persistent_ptx_cache_key - key of the PTX image built by NVRTC
+ */
+static char *
+persistent_ptx_cache_key(program_cache_entry *entry, const char *source,
+						 size_t *p_key_len)
+{
+	char	   *key;
+	size_t		len = strlen(source) + 200;
+
+	key = malloc(len);
+	if (!key)
+		elog(ERROR, "out of memory");
+	*p_key_len = snprintf(key, len, "git=%s build=%08x flags=%08x cc=%d\n%s",
+						  PGSTROM_GITHASH,
+						  persistent_program_cache_build_id(),
+						  entry->extra_flags,
+						  entry->target_cc,
+						  source);
+	return key;
+}
+
+/*
+ * persistent_bin_cache_key - key of the binary image linked for the
+ * device of the current CUDA context
+ */
+static char *
+persistent_bin_cache_key(program_cache_entry *entry, size_t *p_key_len)
+{
+	CUdevice	cuda_device;
+	CUresult	rc;
+	int			major;
+	int			minor;
+	int			version;
+	char	   *key;
+	size_t		len = 200 + entry->ptx_length;
+	size_t		off;
+	int			i;
+
+	rc = cuCtxGetDevice(&cuda_device);
+	if (rc != CUDA_SUCCESS)
+		elog(ERROR, "failed on cuCtxGetDevice: %s", errorText(rc));
+	rc = cuDeviceGetAttribute(&major,
+							  CU_DEVICE_ATTRIBUTE_COMPUTE_CAPABILITY_MAJOR,
+							  cuda_device);
+	if (rc != CUDA_SUCCESS)
+		elog(ERROR, "failed on cuDeviceGetAttribute: %s", errorText(rc));
+	rc = cuDeviceGetAttribute(&minor,
+							  CU_DEVICE_ATTRIBUTE_COMPUTE_CAPABILITY_MINOR,
+							  cuda_device);
+	if (rc != CUDA_SUCCESS)
+		elog(ERROR, "failed on cuDeviceGetAttribute: %s", errorText(rc));
+	rc = cuDriverGetVersion(&version);
+	if (rc != CUDA_SUCCESS)
+		elog(ERROR, "failed on cuDriverGetVersion: %s", errorText(rc));
+
+	for (i=0; i < pgstrom_num_users_extra; i++)
+		len += strlen(pgstrom_users_extra_desc[i].extra_name) + 2;
+	key = malloc(len);
+	if (!key)
+		elog(ERROR, "out of memory");
+	off = snprintf(key, len,
+				   "git=%s build=%08x flags=%08x sm_%d%d driver=%d ptx=%08x/%zu",
+				   PGSTROM_GITHASH,
+				   persistent_program_cache_build_id(),
+				   entry->extra_flags,
+				   major, minor,
+				   version,
+				   entry->ptx_crc,
+				   entry->ptx_length);
+	for (i=0; i < pgstrom_num_users_extra; i++)
+		off += snprintf(key + off, len - off, " %s",
+						pgstrom_users_extra_desc[i].extra_name);
+	/* PTX image itself, to compare the entire key on load */
+	key[off++] = '\n';
+	memcpy(key + off, entry->ptx_image, entry->ptx_length);
+	off += entry->ptx_length;
+	*p_key_len = off;
+
+	return key;
+}
+
 /*
  * pgstrom_cuda_source_string
  *
@@ -605,12 +1102,18 @@ build_cuda_program(program_cache_entry *src_entry)
 	size_t			ptx_length = 0;
 	char		   *build_log = NULL;
 	size_t			log_length;
+	char		   *cache_key = NULL;
+	size_t			cache_key_len;
+	struct timeval	tv1, tv2;
+	cl_float		compile_msec = -1.0;
 	int				pindex;
 	int				hindex;
 	size_t			offset;
 	size_t			length;
+	uint64			nvtx_range;
 
 	Assert(!src_entry->build_chain.prev && !src_entry->build_chain.next);
+	nvtx_range = pgstromNvtxBegin("build_cuda_program", NULL, 0);
 
 	/* Make a nvrtcProgram object */
 	source = construct_flat_cuda_source(src_entry->extra_flags,
@@ -624,6 +1127,23 @@ build_cuda_program(program_cache_entry *src_entry)
 	{
 		char	gpu_arch_option[256];
 
+		/* Try the persistent program cache first */
+		cache_key = persistent_ptx_cache_key(src_entry, source,
+											 &cache_key_len);
+		ptx_image = load_persistent_program_cache("ptx",
+												  cache_key,
+												  cache_key_len,
+												  &ptx_length);
+		if (ptx_image)
+		{
+			build_log = strdup("loaded from the persistent program cache");
+			if (!build_log)
+				elog(ERROR, "out of memory");
+			log_length = strlen(build_log);
+			goto build_done;
+		}
+
+		gettimeofday(&tv1, NULL);
 		rc = nvrtcCreateProgram(&program,
 								source,
 								"pg-strom",
@@ -709,7 +1229,18 @@ build_cuda_program(program_cache_entry *src_entry)
 		if (rc != NVRTC_SUCCESS)
 			elog(ERROR, "failed on nvrtcDestroyProgram: %s",
 				   nvrtcGetErrorString(rc));
+		program = NULL;
+		gettimeofday(&tv2, NULL);
+		compile_msec = TV_DIFF(tv2, tv1);
 
+		/* Save the PTX image for the next startup */
+		if (ptx_image)
+			save_persistent_program_cache("ptx",
+										  cache_key,
+										  cache_key_len,
+										  ptx_image,
+										  ptx_length);
+	build_done:
 		/*
 		 * Allocation of a new entry, to keep ptx_image/build_log
 		 */
@@ -744,6 +1275,8 @@ build_cuda_program(program_cache_entry *src_entry)
 		strcpy(bin_entry->kern_source, src_entry->kern_source);
 		offset += MAXALIGN(bin_entry->kern_srclen + 1);
 		bin_entry->varlena_bufsz	= src_entry->varlena_bufsz;
+		bin_entry->compile_msec		= compile_msec;
+		bin_entry->link_msec		= 0.0;
 
 		if (!ptx_image)
 			bin_entry->ptx_image	= CUDA_PROGRAM_BUILD_FAILURE;
@@ -797,6 +1330,8 @@ build_cuda_program(program_cache_entry *src_entry)
 	}
 	PG_CATCH();
 	{
+		if (cache_key)
+			free(cache_key);
 		if (build_log)
 			free(build_log);
 		if (ptx_image)
@@ -810,14 +1345,17 @@ build_cuda_program(program_cache_entry *src_entry)
 		}
 		if (source)
 			free(source);
+		pgstromNvtxEnd(nvtx_range);
 		PG_RE_THROW();
 	}
 	PG_END_TRY();
+	free(cache_key);
 	if (build_log)
 		free(build_log);
 	if (ptx_image)
 		free(ptx_image);
 	free(source);
+	pgstromNvtxEnd(nvtx_range);
 
 	return bin_entry;
 }
@@ -854,6 +1392,21 @@ __pgstrom_create_cuda_program(GpuContext *gcontext,
 	/* build with debug option? */
 	if (pgstrom_debug_jit_compile_options)
 		extra_flags |= DEVKERNEL_BUILD_DEBUG_INFO;
+	/*
+	 * build with per-stage cycle counters?
+	 *
+	 * The debug build links *.gfatbin, which has no cycle counters on
+	 * kern_context, so the profiling cannot be combined with.
+	 */
+	if (pgstrom_debug_kernel_profiling)
+	{
+		if ((extra_flags & DEVKERNEL_BUILD_DEBUG_INFO) != 0)
+			ereport(WARNING,
+					(errmsg("pg_strom.debug_kernel_profiling is ignored"),
+					 errdetail("It cannot be used with pg_strom.debug_jit_compile_options.")));
+		else
+			extra_flags |= DEVKERNEL_BUILD_PROFILING;
+	}
 
 	/* Target binary to build
 	 *
@@ -895,6 +1448,25 @@ __pgstrom_create_cuda_program(GpuContext *gcontext,
 			target_cc = 60;
 	}
 
+	/*
+	 * An extra margin on the @varlena_bufsz might be valuable to avoid
+	 * unnecessary program rebuild if program contains device functions
+	 * that can return varlena datum. Because @varlena_bufsz estimation
+	 * can be affected by small changes in query;
+	 * e.g, substring(X from 0 for 3) will make different value from
+	 * the substring(X from 1 for 4), or length of text literals, but code
+	 * itself shall not be changed. So, we round up the @varlena_bufsz to
+	 * a coarse unit (1/4 of the next power of 2, but 256B at least).
+	 */
+	if (varlena_bufsz > 0)
+	{
+		cl_uint		unitsz;
+
+		varlena_bufsz += 36;
+		unitsz = (1U << Max(get_next_log2(varlena_bufsz) - 2, 8));
+		varlena_bufsz = TYPEALIGN(unitsz, varlena_bufsz);
+	}
+
 	/* makes a hash value */
 	INIT_LEGACY_CRC32(crc);
 	COMP_LEGACY_CRC32(crc, &target_cc, sizeof(cl_int));
@@ -1022,19 +1594,7 @@ __pgstrom_create_cuda_program(GpuContext *gcontext,
 	memcpy(entry->kern_source, kern_source, kern_srclen + 1);
 	usage += MAXALIGN(kern_srclen + 1);
 
-	/*
-	 * An extra margin on the @varlena_bufsz might be valuable to avoid
-	 * unnecessary program rebuild if program contains device functions
-	 * that can return varlena datum. Because @varlena_bufsz estimation
-	 * can be affected by small changes in query;
-	 * e.g, substring(X from 0 for 3) will make different value from
-	 * the substring(X from 1 for 4), but code itself shall not be
-	 * changed. So, extra margin will help the case.
-	 */
-	if (varlena_bufsz == 0)
-		entry->varlena_bufsz = 0;
-	else
-		entry->varlena_bufsz = MAXALIGN(varlena_bufsz + 36);
+	entry->varlena_bufsz = varlena_bufsz;
 
 	/* no cuda binary at this moment */
 	entry->ptx_image = NULL;
@@ -1113,6 +1673,67 @@ __pgstrom_create_cuda_program(GpuContext *gcontext,
 	return program_id;
 }
 
+/*
+ * pgstrom_cuda_program_build_info
+ *
+ * It returns a human readable build time breakdown of the program.
+ */
+char *
+pgstrom_cuda_program_build_info(ProgramId program_id)
+{
+	program_cache_entry *entry;
+	cl_float	compile_msec;
+	cl_float	link_msec;
+	char		compile_buf[64];
+	char		link_buf[64];
+
+	SpinLockAcquire(&pgcache_head->lock);
+	entry = lookup_cuda_program_entry_nolock(program_id);
+	if (!entry || !entry->ptx_image ||
+		entry->ptx_image == CUDA_PROGRAM_BUILD_FAILURE)
+	{
+		SpinLockRelease(&pgcache_head->lock);
+		return NULL;
+	}
+	compile_msec = entry->compile_msec;
+	link_msec = entry->link_msec;
+	SpinLockRelease(&pgcache_head->lock);
+
+	if (compile_msec < 0.0)
+		strcpy(compile_buf, "cached");
+	else
+		snprintf(compile_buf, sizeof(compile_buf), "%.2fms", compile_msec);
+	if (link_msec < 0.0)
+		strcpy(link_buf, "cached");
+	else if (link_msec == 0.0)
+		strcpy(link_buf, "n/a");
+	else
+		snprintf(link_buf, sizeof(link_buf), "%.2fms", link_msec);
+
+	return psprintf("compile: %s, link: %s", compile_buf, link_buf);
+}
+
+/*
+ * pgstrom_cuda_program_is_ready
+ *
+ * It checks whether the program build is already completed (or failed)
+ * without blocking, so that caller can run something else in the meantime.
+ */
+bool
+pgstrom_cuda_program_is_ready(ProgramId program_id)
+{
+	program_cache_entry *entry;
+	bool		retval = true;
+
+	SpinLockAcquire(&pgcache_head->lock);
+	entry = lookup_cuda_program_entry_nolock(program_id);
+	if (entry && !entry->ptx_image)
+		retval = false;
+	SpinLockRelease(&pgcache_head->lock);
+
+	return retval;
+}
+
 /*
  * pgstrom_put_cuda_program
  *
@@ -1358,25 +1979,23 @@ struct pg_tz
 	struct state	state;
 };
 
-STATIC_INLINE(void)
-assign_timelib_session_info(StringInfo buf)
+/*
+ * pgstrom_codegen_tz_state
+ *
+ * It writes out the transition table of the supplied timezone as a tz_state
+ * structure of the device code, with the given variable name.
+ */
+void
+pgstrom_codegen_tz_state(StringInfo buf, const char *varname,
+						 bool is_static, pg_tz *tz)
 {
-	const struct state *sp;
+	const struct state *sp = &tz->state;
 	int			i;
 
-	appendStringInfo(
-		buf,
-		"/* ================================================\n"
-		" * session information for device time library\n"
-		" * ================================================ */\n");
-
-	/* put session timezone info */
-	sp = &session_timezone->state;
-
 	/* ats[] */
 	appendStringInfo(
 		buf,
-		"static __device__ cl_long __session_timezone_state_ats[] =\n");
+		"static __device__ cl_long __%s_ats[] =\n", varname);
 	appendStringInfo(buf, "  {\n");
 	if (sp->timecnt == 0)
 		appendStringInfo(buf, " 0");
@@ -1392,8 +2011,8 @@ assign_timelib_session_info(StringInfo buf)
 	/* types[] */
 	appendStringInfo(
 		buf,
-		"static __device__ cl_uchar __session_timezone_state_types[] =\n"
-		"  {");
+		"static __device__ cl_uchar __%s_types[] =\n"
+		"  {", varname);
 	if (sp->timecnt == 0)
 		appendStringInfo(buf, " 0");
 	else
@@ -1408,7 +2027,7 @@ assign_timelib_session_info(StringInfo buf)
 	/* ttis[] */
 	appendStringInfo(
 		buf,
-		"static __device__ tz_ttinfo __session_timezone_state_ttis[] = {\n");
+		"static __device__ tz_ttinfo __%s_ttis[] = {\n", varname);
 	if (sp->typecnt == 0)
 		appendStringInfo(buf, "  { 0, 0, 0, 0, 0 },\n");
 	else
@@ -1430,7 +2049,7 @@ assign_timelib_session_info(StringInfo buf)
 	/* lsis[] */
 	appendStringInfo(
 		buf,
-		"static __device__ tz_lsinfo __session_timezone_state_lsis[] = {\n");
+		"static __device__ tz_lsinfo __%s_lsis[] = {\n", varname);
 	if (sp->leapcnt == 0)
 		appendStringInfo(buf, "  { 0, 0 },\n");
 	else
@@ -1445,10 +2064,10 @@ assign_timelib_session_info(StringInfo buf)
 		}
 	}
 	appendStringInfo(buf, "};\n");
-	/* session_timezone_state */
+	/* tz_state */
 	appendStringInfo(
         buf,
-		"__device__ const tz_state session_timezone_state =\n"
+		"%s__device__ const tz_state %s =\n"
 		"{\n"
 		"    %d,    /* leapcnt */\n"
 		"    %d,    /* timecnt */\n"
@@ -1456,19 +2075,39 @@ assign_timelib_session_info(StringInfo buf)
 		"    %d,    /* charcnt */\n"
 		"    %s,    /* goback */\n"
 		"    %s,    /* goahead */\n"
-		"    __session_timezone_state_ats,   /* ats[] */\n"
-		"    __session_timezone_state_types, /* types[] */\n"
-		"    __session_timezone_state_ttis,  /* ttis[] */\n"
-		"    __session_timezone_state_lsis,  /* lsis[] */\n"
+		"    __%s_ats,   /* ats[] */\n"
+		"    __%s_types, /* types[] */\n"
+		"    __%s_ttis,  /* ttis[] */\n"
+		"    __%s_lsis,  /* lsis[] */\n"
 		"    %d,    /* defaulttype */\n"
 		"};\n",
+		is_static ? "static " : "",
+		varname,
 		sp->leapcnt,
 		sp->timecnt,
 		sp->typecnt,
 		sp->charcnt,
 		sp->goback  ? "true" : "false",
 		sp->goahead ? "true" : "false",
+		varname,
+		varname,
+		varname,
+		varname,
 		sp->defaulttype);
+}
+
+STATIC_INLINE(void)
+assign_timelib_session_info(StringInfo buf)
+{
+	appendStringInfo(
+		buf,
+		"/* ================================================\n"
+		" * session information for device time library\n"
+		" * ================================================ */\n");
+
+	/* put session timezone info */
+	pgstrom_codegen_tz_state(buf, "session_timezone_state",
+							 false, session_timezone);
 
 	/* SetEpochTimestamp() */
 	appendStringInfo(
@@ -1552,6 +2191,11 @@ pgstrom_load_cuda_program(ProgramId program_id)
 	CUresult	rc;
 	size_t		stack_sz, lvalue;
 	char	   *bin_image;
+	size_t		bin_length;
+	char	   *cache_key = NULL;
+	size_t		cache_key_len;
+	struct timeval tv1, tv2;
+	cl_float	link_msec = -1.0;
 
 	Assert(!GpuWorkerCurrentContext);
 
@@ -1600,17 +2244,40 @@ retry_checks:
 #endif /* USE_ASSERT_CHECKING */
 		PG_TRY();
 		{
-			bin_image = link_cuda_libraries(entry->ptx_image,
-											entry->ptx_length,
-											entry->extra_flags);
+			cache_key = persistent_bin_cache_key(entry, &cache_key_len);
+			bin_image = load_persistent_program_cache("cubin",
+													  cache_key,
+													  cache_key_len,
+													  &bin_length);
+			if (!bin_image)
+			{
+				gettimeofday(&tv1, NULL);
+				bin_image = link_cuda_libraries(entry->ptx_image,
+												entry->ptx_length,
+												entry->extra_flags,
+												&bin_length);
+				gettimeofday(&tv2, NULL);
+				link_msec = TV_DIFF(tv2, tv1);
+				save_persistent_program_cache("cubin",
+											  cache_key,
+											  cache_key_len,
+											  bin_image,
+											  bin_length);
+			}
+			free(cache_key);
 		}
 		PG_CATCH();
 		{
+			if (cache_key)
+				free(cache_key);
 			put_cuda_program_entry(entry);
 			PG_RE_THROW();
 		}
 		PG_END_TRY();
-		put_cuda_program_entry(entry);
+		SpinLockAcquire(&pgcache_head->lock);
+		entry->link_msec = link_msec;
+		put_cuda_program_entry_nolock(entry);
+		SpinLockRelease(&pgcache_head->lock);
 	}
 	else if (entry->build_chain.prev || entry->build_chain.next)
 	{
@@ -1905,6 +2572,17 @@ pgstrom_init_cuda_program(void)
 							 PGC_SUSET,
 							 GUC_NOT_IN_SAMPLE | GUC_SUPERUSER_ONLY,
 							 NULL, NULL, NULL);
+	/*
+	 * Enables per-stage cycle counters on GPU kernel build
+	 */
+	DefineCustomBoolVariable("pg_strom.debug_kernel_profiling",
+							 "Enables per-stage cycle counters on GPU kernel build",
+							 NULL,
+							 &pgstrom_debug_kernel_profiling,
+							 false,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
 	/*
 	 * Enables CUDA coredump on GPU kernel crash
 	 */
@@ -1929,6 +2607,27 @@ pgstrom_init_cuda_program(void)
 							PGC_USERSET,
 							GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE,
 							NULL, NULL, NULL);
+	/*
+	 * Enables persistent program cache on $PGDATA
+	 */
+	DefineCustomBoolVariable("pg_strom.persistent_program_cache",
+							 "Enables to save/load CUDA programs on the storage",
+							 NULL,
+							 &pgstrom_persistent_program_cache,
+							 true,
+							 PGC_SIGHUP,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	DefineCustomIntVariable("pg_strom.persistent_program_cache_size",
+							"Max total size of the persistent program cache",
+							NULL,
+							&pgstrom_persistent_program_cache_size_kb,
+							1024 * 1024,	/* 1GB */
+							0,
+							INT_MAX,
+							PGC_SIGHUP,
+							GUC_NOT_IN_SAMPLE | GUC_UNIT_KB,
+							NULL, NULL, NULL);
 
 	/* allocation of static shared memory */
 	RequestAddinShmemSpace(MAXALIGN(sizeof(program_cache_head)) +
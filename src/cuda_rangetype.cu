@@ -1059,6 +1059,18 @@ __generic_range_minus(kern_context *kcxt, const R &arg1, const R &arg2)
 						 const pg_##RANGE##_t &arg2)			\
 	{															\
 		return __generic_range_minus(kcxt,arg1,arg2);			\
+	}															\
+	DEVICE_FUNCTION(cl_bool)									\
+	pgindex_gist_range_overlap(kern_context *kcxt,				\
+							   PageHeaderData *i_page,			\
+							   const pg_##RANGE##_t &i_var,		\
+							   const pg_##RANGE##_t &i_arg)		\
+	{															\
+		/* same check for both of leaf and internal pages */	\
+		if (!i_var.isnull && !i_arg.isnull)						\
+			return __range_overlaps_internal(&i_var.value,		\
+											 &i_arg.value);		\
+		return false;											\
 	}
 
 PG_RANGETYPE_FUNCTION_TEMPLATE(int4,int4range)
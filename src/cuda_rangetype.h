@@ -173,7 +173,12 @@ PG_RANGETYPE_TEMPLATE(daterange,DateADT)
 	DEVICE_FUNCTION(pg_##RANGE##_t)								\
 	pgfn_##RANGE##_minus(kern_context *kcxt,					\
 						 const pg_##RANGE##_t &arg1,			\
-						 const pg_##RANGE##_t &arg2);
+						 const pg_##RANGE##_t &arg2);			\
+	DEVICE_FUNCTION(cl_bool)									\
+	pgindex_gist_range_overlap(kern_context *kcxt,				\
+							   PageHeaderData *i_page,			\
+							   const pg_##RANGE##_t &i_var,		\
+							   const pg_##RANGE##_t &i_arg);
 
 PG_RANGETYPE_DECLARATION_TEMPLATE(int4,int4range)
 PG_RANGETYPE_DECLARATION_TEMPLATE(int8,int8range)
@@ -678,6 +678,293 @@ pgfn_text_substring_nolen(kern_context *kcxt,
 	return result;
 }
 
+/*
+ * lower / upper
+ *
+ * Only ASCII characters are converted, as str_tolower() / str_toupper()
+ * doing on C-locale. Any bytes of multibyte characters in the server
+ * encodings have the high bit, so byte-wise conversion is safe.
+ */
+STATIC_FUNCTION(pg_text_t)
+text_case_convert(kern_context *kcxt, pg_text_t arg, cl_bool to_upper)
+{
+	pg_text_t	result;
+	char	   *s;
+	char	   *pos;
+	cl_int		i, len;
+
+	if (arg.isnull)
+	{
+		result.isnull = true;
+		return result;
+	}
+	if (!pg_varlena_datum_extract(kcxt, arg, &s, &len))
+	{
+		result.isnull = true;
+		return result;
+	}
+	pos = (char *)kern_context_alloc(kcxt, VARHDRSZ + len);
+	if (!pos)
+	{
+		STROM_CPU_FALLBACK(kcxt, ERRCODE_OUT_OF_MEMORY,
+						   "out of memory");
+		result.isnull = true;
+		return result;
+	}
+	result.isnull = false;
+	result.value = pos;
+	result.length = -1;
+	SET_VARSIZE(pos, VARHDRSZ + len);
+	pos += VARHDRSZ;
+	for (i=0; i < len; i++)
+	{
+		cl_uchar	c = s[i];
+
+		if (to_upper)
+		{
+			if (c >= 'a' && c <= 'z')
+				c += 'A' - 'a';
+		}
+		else
+		{
+			if (c >= 'A' && c <= 'Z')
+				c += 'a' - 'A';
+		}
+		pos[i] = c;
+	}
+	return result;
+}
+
+DEVICE_FUNCTION(pg_text_t)
+pgfn_text_lower(kern_context *kcxt, pg_text_t arg1)
+{
+	return text_case_convert(kcxt, arg1, false);
+}
+
+DEVICE_FUNCTION(pg_text_t)
+pgfn_text_upper(kern_context *kcxt, pg_text_t arg1)
+{
+	return text_case_convert(kcxt, arg1, true);
+}
+
+/*
+ * text_find_position
+ *
+ * It looks up the byte offset of the first occurrence of t1 in s1 from
+ * the offset 'start', only at the character boundary, or -1 if not found.
+ * If p_nchars is given, number of characters prior to the match is
+ * returned.
+ */
+STATIC_FUNCTION(cl_int)
+text_find_position(const char *s1, cl_int len1, cl_int start,
+				   const char *s2, cl_int len2, cl_int *p_nchars)
+{
+	cl_bool		is_single_byte = (pg_database_encoding_max_length() == 1);
+	cl_int		pos = start;
+	cl_int		nchars = 0;
+
+	while (pos + len2 <= len1)
+	{
+		if (__memcmp(s1 + pos, s2, len2) == 0)
+		{
+			if (p_nchars)
+				*p_nchars = nchars;
+			return pos;
+		}
+		pos += (is_single_byte ? 1 : pg_wchar_mblen(s1 + pos));
+		nchars++;
+	}
+	return -1;
+}
+
+/*
+ * strpos / position
+ */
+DEVICE_FUNCTION(pg_int4_t)
+pgfn_textpos(kern_context *kcxt, pg_text_t arg1, pg_text_t arg2)
+{
+	pg_int4_t	result;
+	char	   *s1, *s2;
+	cl_int		len1, len2;
+	cl_int		nchars;
+
+	result.isnull = (arg1.isnull | arg2.isnull);
+	if (result.isnull)
+		return result;
+	if (!pg_varlena_datum_extract(kcxt, arg1, &s1, &len1) ||
+		!pg_varlena_datum_extract(kcxt, arg2, &s2, &len2))
+	{
+		result.isnull = true;
+		return result;
+	}
+	/* empty needle always matches at the first position */
+	if (len2 == 0)
+		result.value = 1;
+	else if (text_find_position(s1, len1, 0, s2, len2, &nchars) < 0)
+		result.value = 0;
+	else
+		result.value = nchars + 1;
+	return result;
+}
+
+/*
+ * split_part
+ *
+ * The result points a part of the source string, so no varlena buffer is
+ * consumed. Negative field position is handled by CPU fallback, because
+ * its semantics depends on the PostgreSQL version.
+ */
+DEVICE_FUNCTION(pg_text_t)
+pgfn_split_part(kern_context *kcxt,
+				pg_text_t arg1, pg_text_t arg2, pg_int4_t arg3)
+{
+	pg_text_t	result;
+	char	   *s1, *s2;
+	cl_int		len1, len2;
+	cl_int		start = 0;
+	cl_int		pos;
+	cl_int		fldnum;
+
+	result.isnull = (arg1.isnull | arg2.isnull | arg3.isnull);
+	if (result.isnull)
+		return result;
+	fldnum = arg3.value;
+	if (fldnum == 0)
+	{
+		result.isnull = true;
+		STROM_EREPORT(kcxt, ERRCODE_INVALID_PARAMETER_VALUE,
+					  "field position must not be zero");
+		return result;
+	}
+	if (fldnum < 0)
+	{
+		result.isnull = true;
+		STROM_CPU_FALLBACK(kcxt, ERRCODE_FEATURE_NOT_SUPPORTED,
+						   "negative field position of split_part");
+		return result;
+	}
+	if (!pg_varlena_datum_extract(kcxt, arg1, &s1, &len1) ||
+		!pg_varlena_datum_extract(kcxt, arg2, &s2, &len2))
+	{
+		result.isnull = true;
+		return result;
+	}
+	result.isnull = false;
+	result.length = 0;
+	result.value = s1;
+	/* empty input string or delimiter */
+	if (len1 == 0)
+		return result;
+	if (len2 == 0)
+	{
+		if (fldnum == 1)
+			result.length = len1;
+		return result;
+	}
+	while (--fldnum > 0)
+	{
+		pos = text_find_position(s1, len1, start, s2, len2, NULL);
+		if (pos < 0)
+			return result;		/* empty */
+		start = pos + len2;
+	}
+	pos = text_find_position(s1, len1, start, s2, len2, NULL);
+	result.value = s1 + start;
+	result.length = (pos < 0 ? len1 : pos) - start;
+
+	return result;
+}
+
+/*
+ * concat_ws
+ */
+STATIC_FUNCTION(pg_text_t)
+text_concat_ws(kern_context *kcxt, pg_text_t sep,
+			   pg_text_t *args, cl_int nargs)
+{
+	pg_text_t	result;
+	char	   *s, *sep_s;
+	cl_int		len, sep_len;
+	cl_int		i, sz = VARHDRSZ;
+	cl_bool		is_first = true;
+	char	   *pos;
+
+	if (sep.isnull)
+	{
+		result.isnull = true;
+		return result;
+	}
+	if (!pg_varlena_datum_extract(kcxt, sep, &sep_s, &sep_len))
+	{
+		result.isnull = true;
+		return result;
+	}
+	for (i=0; i < nargs; i++)
+	{
+		if (args[i].isnull)
+			continue;
+		if (!pg_varlena_datum_extract(kcxt, args[i], &s, &len))
+		{
+			result.isnull = true;
+			return result;
+		}
+		sz += (is_first ? 0 : sep_len) + len;
+		is_first = false;
+	}
+	pos = (char *)kern_context_alloc(kcxt, sz);
+	if (!pos)
+	{
+		STROM_CPU_FALLBACK(kcxt, ERRCODE_OUT_OF_MEMORY,
+						   "out of memory");
+		result.isnull = true;
+		return result;
+	}
+	result.isnull = false;
+	result.value = pos;
+	result.length = -1;
+	SET_VARSIZE(pos, sz);
+	pos += VARHDRSZ;
+	is_first = true;
+	for (i=0; i < nargs; i++)
+	{
+		if (args[i].isnull)
+			continue;
+		pg_varlena_datum_extract(kcxt, args[i], &s, &len);
+		if (!is_first)
+		{
+			memcpy(pos, sep_s, sep_len);
+			pos += sep_len;
+		}
+		memcpy(pos, s, len);
+		pos += len;
+		is_first = false;
+	}
+	return result;
+}
+
+DEVICE_FUNCTION(pg_text_t)
+pgfn_text_concat_ws2(kern_context *kcxt, pg_text_t sep,
+					 pg_text_t arg1, pg_text_t arg2)
+{
+	pg_text_t	args[2];
+
+	args[0] = arg1;
+	args[1] = arg2;
+	return text_concat_ws(kcxt, sep, args, 2);
+}
+
+DEVICE_FUNCTION(pg_text_t)
+pgfn_text_concat_ws3(kern_context *kcxt, pg_text_t sep,
+					 pg_text_t arg1, pg_text_t arg2, pg_text_t arg3)
+{
+	pg_text_t	args[3];
+
+	args[0] = arg1;
+	args[1] = arg2;
+	args[2] = arg3;
+	return text_concat_ws(kcxt, sep, args, 3);
+}
+
 /*
  * Support for LIKE operator
  */
@@ -1121,6 +1408,95 @@ pgfn_bpcharicnlike(kern_context *kcxt, pg_bpchar_t arg1, pg_text_t arg2)
 	return result;
 }
 
+/*
+ * LIKE operator with constant pattern
+ *
+ * If LIKE pattern is a constant that consists of a literal with leading
+ * and/or trailing '%', code generator embeds the literal in the device
+ * code and calls the functions below, instead of the generic pattern
+ * matching. The literal never contains any wildcard and escape characters.
+ */
+STATIC_FUNCTION(cl_bool)
+__textlike_fastpath(const char *s, cl_int slen,
+					const char *lit, cl_int llen, cl_int mode)
+{
+	cl_int		i;
+
+	if (slen < llen)
+		return false;
+	switch (mode)
+	{
+		case LIKE_FASTPATH_EXACT:
+			return (slen == llen && __memcmp(s, lit, llen) == 0);
+		case LIKE_FASTPATH_PREFIX:
+			return (__memcmp(s, lit, llen) == 0);
+		case LIKE_FASTPATH_SUFFIX:
+			return (__memcmp(s + slen - llen, lit, llen) == 0);
+		case LIKE_FASTPATH_CONTAINS:
+			if (llen == 0)
+				return true;
+			/* compare the first byte prior to the entire literal */
+			for (i=0; i <= slen - llen; i++)
+			{
+				if (s[i] == lit[0] &&
+					__memcmp(s + i + 1, lit + 1, llen - 1) == 0)
+					return true;
+			}
+			return false;
+		default:
+			break;
+	}
+	return false;
+}
+
+DEVICE_FUNCTION(pg_bool_t)
+pgfn_textlike_fastpath(kern_context *kcxt, pg_text_t arg1,
+					   const char *lit, cl_int llen,
+					   cl_int mode, cl_bool negative)
+{
+	pg_bool_t	result;
+
+	result.isnull = arg1.isnull;
+	if (!result.isnull)
+	{
+		char	   *s;
+		cl_int		slen;
+
+		if (!pg_varlena_datum_extract(kcxt, arg1, &s, &slen))
+		{
+			result.isnull = true;
+			return result;
+		}
+		result.value = (__textlike_fastpath(s, slen, lit, llen,
+											mode) != negative);
+	}
+	return result;
+}
+
+DEVICE_FUNCTION(pg_bool_t)
+pgfn_bpcharlike_fastpath(kern_context *kcxt, pg_bpchar_t arg1,
+						 const char *lit, cl_int llen,
+						 cl_int mode, cl_bool negative)
+{
+	pg_bool_t	result;
+
+	result.isnull = arg1.isnull;
+	if (!result.isnull)
+	{
+		char	   *s;
+		cl_int		slen;
+
+		if (!pg_bpchar_datum_extract(kcxt, arg1, &s, &slen))
+		{
+			result.isnull = true;
+			return result;
+		}
+		result.value = (__textlike_fastpath(s, slen, lit, llen,
+											mode) != negative);
+	}
+	return result;
+}
+
 #undef LIKE_TRUE
 #undef LIKE_FALSE
 #undef LIKE_ABORT
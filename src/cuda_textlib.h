@@ -11,6 +11,13 @@
  */
 #ifndef CUDA_TEXTLIB_H
 #define CUDA_TEXTLIB_H
+
+/* mode of LIKE operator with constant pattern */
+#define LIKE_FASTPATH_EXACT			0	/* 'literal' */
+#define LIKE_FASTPATH_PREFIX		1	/* 'literal%' */
+#define LIKE_FASTPATH_SUFFIX		2	/* '%literal' */
+#define LIKE_FASTPATH_CONTAINS		3	/* '%literal%' */
+
 #ifdef __CUDACC__
 DEVICE_INLINE(cl_int)
 bpchar_truelen(const char *s, cl_int len)
@@ -77,6 +84,21 @@ pgfn_text_substring(kern_context *kcxt,
 DEVICE_FUNCTION(pg_text_t)
 pgfn_text_substring_nolen(kern_context *kcxt,
 						  pg_text_t arg1, pg_int4_t arg2);
+DEVICE_FUNCTION(pg_text_t)
+pgfn_text_lower(kern_context *kcxt, pg_text_t arg1);
+DEVICE_FUNCTION(pg_text_t)
+pgfn_text_upper(kern_context *kcxt, pg_text_t arg1);
+DEVICE_FUNCTION(pg_int4_t)
+pgfn_textpos(kern_context *kcxt, pg_text_t arg1, pg_text_t arg2);
+DEVICE_FUNCTION(pg_text_t)
+pgfn_split_part(kern_context *kcxt,
+				pg_text_t arg1, pg_text_t arg2, pg_int4_t arg3);
+DEVICE_FUNCTION(pg_text_t)
+pgfn_text_concat_ws2(kern_context *kcxt, pg_text_t sep,
+					 pg_text_t arg1, pg_text_t arg2);
+DEVICE_FUNCTION(pg_text_t)
+pgfn_text_concat_ws3(kern_context *kcxt, pg_text_t sep,
+					 pg_text_t arg1, pg_text_t arg2, pg_text_t arg3);
 /* binary compatible type cast */
 DEVICE_INLINE(pg_text_t)
 to_text(pg_varchar_t arg)
@@ -115,6 +137,15 @@ DEVICE_FUNCTION(pg_bool_t)
 pgfn_bpchariclike(kern_context *kcxt, pg_bpchar_t arg1, pg_text_t arg2);
 DEVICE_FUNCTION(pg_bool_t)
 pgfn_bpcharicnlike(kern_context *kcxt, pg_bpchar_t arg1, pg_text_t arg2);
+/* LIKE operator with constant pattern; see codegen_textlike_fastpath() */
+DEVICE_FUNCTION(pg_bool_t)
+pgfn_textlike_fastpath(kern_context *kcxt, pg_text_t arg1,
+					   const char *lit, cl_int llen,
+					   cl_int mode, cl_bool negative);
+DEVICE_FUNCTION(pg_bool_t)
+pgfn_bpcharlike_fastpath(kern_context *kcxt, pg_bpchar_t arg1,
+						 const char *lit, cl_int llen,
+						 cl_int mode, cl_bool negative);
 
 /*
  * Hyper-Log-Log Hash Functions
@@ -4054,6 +4054,475 @@ pgfn_extract_time(kern_context *kcxt,
 	return result;
 }
 
+/*
+ * date_trunc(text,timestamp[tz][,text])
+ */
+STATIC_FUNCTION(void)
+isoweek2date(int woy, int *year, int *mon, int *mday)
+{
+	cl_int		day4 = date2j(*year, 1, 4);
+	cl_int		day0 = j2day(day4 - 1);
+
+	j2date(((woy - 1) * 7) + (day4 - day0), year, mon, mday);
+}
+
+/*
+ * timestamp_trunc_tm - truncates pg_tm according to the unit, as
+ * timestamp_trunc() doing. It returns false if unsupported unit.
+ * *p_redotz shall be set if timezone offset must be determined again.
+ */
+STATIC_FUNCTION(cl_bool)
+timestamp_trunc_tm(cl_int val, struct pg_tm *tm, fsec_t *fsec,
+				   cl_bool *p_redotz)
+{
+	int			woy;
+
+	*p_redotz = false;
+	switch (val)
+	{
+		case DTK_WEEK:
+			woy = date2isoweek(tm->tm_year, tm->tm_mon, tm->tm_mday);
+			/*
+			 * If it is week 52/53 and the month is January, then the
+			 * week must belong to the previous year. Also, some December
+			 * dates belong to the next year.
+			 */
+			if (woy >= 52 && tm->tm_mon == 1)
+				--tm->tm_year;
+			if (woy <= 1 && tm->tm_mon == MONTHS_PER_YEAR)
+				++tm->tm_year;
+			isoweek2date(woy, &tm->tm_year, &tm->tm_mon, &tm->tm_mday);
+			tm->tm_hour = 0;
+			tm->tm_min = 0;
+			tm->tm_sec = 0;
+			*fsec = 0;
+			*p_redotz = true;
+			break;
+		case DTK_MILLENNIUM:
+			/* see comments in timestamptz_trunc */
+			if (tm->tm_year > 0)
+				tm->tm_year = ((tm->tm_year + 999) / 1000) * 1000 - 999;
+			else
+				tm->tm_year = -((999 - (tm->tm_year - 1)) / 1000) * 1000 + 1;
+			/* FALLTHROUGH */
+		case DTK_CENTURY:
+			/* see comments in timestamptz_trunc */
+			if (tm->tm_year > 0)
+				tm->tm_year = ((tm->tm_year + 99) / 100) * 100 - 99;
+			else
+				tm->tm_year = -((99 - (tm->tm_year - 1)) / 100) * 100 + 1;
+			/* FALLTHROUGH */
+		case DTK_DECADE:
+			/* see comments in timestamptz_trunc */
+			if (val != DTK_MILLENNIUM && val != DTK_CENTURY)
+			{
+				if (tm->tm_year > 0)
+					tm->tm_year = (tm->tm_year / 10) * 10;
+				else
+					tm->tm_year = -((8 - (tm->tm_year - 1)) / 10) * 10;
+			}
+			/* FALLTHROUGH */
+		case DTK_YEAR:
+			tm->tm_mon = 1;
+			/* FALLTHROUGH */
+		case DTK_QUARTER:
+			tm->tm_mon = (3 * ((tm->tm_mon - 1) / 3)) + 1;
+			/* FALLTHROUGH */
+		case DTK_MONTH:
+			tm->tm_mday = 1;
+			/* FALLTHROUGH */
+		case DTK_DAY:
+			tm->tm_hour = 0;
+			*p_redotz = true;	/* for all cases >= DAY */
+			/* FALLTHROUGH */
+		case DTK_HOUR:
+			tm->tm_min = 0;
+			/* FALLTHROUGH */
+		case DTK_MINUTE:
+			tm->tm_sec = 0;
+			/* FALLTHROUGH */
+		case DTK_SECOND:
+			*fsec = 0;
+			break;
+		case DTK_MILLISEC:
+			*fsec = (*fsec / 1000) * 1000;
+			break;
+		case DTK_MICROSEC:
+			break;
+		default:
+			return false;
+	}
+	return true;
+}
+
+DEVICE_FUNCTION(pg_timestamp_t)
+pgfn_timestamp_trunc(kern_context *kcxt,
+					 pg_text_t arg1, pg_timestamp_t arg2)
+{
+	pg_timestamp_t	result;
+	char		   *s;
+	cl_int			slen;
+	cl_int			type, val;
+	struct pg_tm	tm;
+	fsec_t			fsec;
+	cl_bool			redotz;
+
+	result.isnull = arg1.isnull | arg2.isnull;
+	if (result.isnull)
+		return result;
+	if (TIMESTAMP_NOT_FINITE(arg2.value))
+	{
+		result.value = arg2.value;
+		return result;
+	}
+	if (!pg_varlena_datum_extract(kcxt, arg1, &s, &slen) ||
+		!extract_decode_unit(s, slen, &type, &val) ||
+		type != UNITS)
+	{
+		result.isnull = true;
+		STROM_EREPORT(kcxt, ERRCODE_FEATURE_NOT_SUPPORTED,
+					  "timestamp units not recognized");
+	}
+	else if (!timestamp2tm(arg2.value, NULL, &tm, &fsec, NULL))
+	{
+		result.isnull = true;
+		STROM_EREPORT(kcxt, ERRCODE_DATETIME_VALUE_OUT_OF_RANGE,
+					  "timestamp out of range");
+	}
+	else if (!timestamp_trunc_tm(val, &tm, &fsec, &redotz))
+	{
+		result.isnull = true;
+		STROM_EREPORT(kcxt, ERRCODE_FEATURE_NOT_SUPPORTED,
+					  "timestamp units not supported");
+	}
+	else if (!tm2timestamp(&tm, fsec, NULL, &result.value))
+	{
+		result.isnull = true;
+		STROM_EREPORT(kcxt, ERRCODE_DATETIME_VALUE_OUT_OF_RANGE,
+					  "timestamp out of range");
+	}
+	return result;
+}
+
+STATIC_FUNCTION(pg_timestamptz_t)
+timestamptz_trunc_internal(kern_context *kcxt,
+						   pg_text_t arg1, pg_timestamptz_t arg2,
+						   const tz_state *sp)
+{
+	pg_timestamptz_t result;
+	char		   *s;
+	cl_int			slen;
+	cl_int			type, val;
+	struct pg_tm	tm;
+	fsec_t			fsec;
+	int				tz;
+	cl_bool			redotz;
+
+	result.isnull = arg1.isnull | arg2.isnull;
+	if (result.isnull)
+		return result;
+	if (TIMESTAMP_NOT_FINITE(arg2.value))
+	{
+		result.value = arg2.value;
+		return result;
+	}
+	if (!pg_varlena_datum_extract(kcxt, arg1, &s, &slen) ||
+		!extract_decode_unit(s, slen, &type, &val) ||
+		type != UNITS)
+	{
+		result.isnull = true;
+		STROM_EREPORT(kcxt, ERRCODE_FEATURE_NOT_SUPPORTED,
+					  "timestamp with time zone units not recognized");
+	}
+	else if (!timestamp2tm(arg2.value, &tz, &tm, &fsec, sp))
+	{
+		result.isnull = true;
+		STROM_EREPORT(kcxt, ERRCODE_DATETIME_VALUE_OUT_OF_RANGE,
+					  "timestamp with timezone out of range");
+	}
+	else if (!timestamp_trunc_tm(val, &tm, &fsec, &redotz))
+	{
+		result.isnull = true;
+		STROM_EREPORT(kcxt, ERRCODE_FEATURE_NOT_SUPPORTED,
+					  "timestamp with time zone units not supported");
+	}
+	else
+	{
+		if (redotz)
+			tz = DetermineTimeZoneOffset(&tm, (sp ? sp : &session_timezone_state));
+		if (!tm2timestamp(&tm, fsec, &tz, &result.value))
+		{
+			result.isnull = true;
+			STROM_EREPORT(kcxt, ERRCODE_DATETIME_VALUE_OUT_OF_RANGE,
+						  "timestamp with timezone out of range");
+		}
+	}
+	return result;
+}
+
+DEVICE_FUNCTION(pg_timestamptz_t)
+pgfn_timestamptz_trunc(kern_context *kcxt,
+					   pg_text_t arg1, pg_timestamptz_t arg2)
+{
+	return timestamptz_trunc_internal(kcxt, arg1, arg2, NULL);
+}
+
+DEVICE_FUNCTION(pg_timestamptz_t)
+pgfn_timestamptz_trunc_zone_fastpath(kern_context *kcxt,
+									 pg_text_t arg1, pg_timestamptz_t arg2,
+									 const tz_state *sp)
+{
+	return timestamptz_trunc_internal(kcxt, arg1, arg2, sp);
+}
+
+/*
+ * timezone(text,timestamp[tz]) - AT TIME ZONE
+ *
+ * The zone name is a constant, so its transition table is embedded in
+ * the device code by the code generator; see codegen_timezone_fastpath().
+ */
+DEVICE_FUNCTION(pg_timestamp_t)
+pgfn_timestamptz_zone_fastpath(kern_context *kcxt,
+							   const tz_state *sp, pg_timestamptz_t arg)
+{
+	pg_timestamp_t	result;
+	struct pg_tm	tm;
+	fsec_t			fsec;
+	int				tz;
+
+	result.isnull = arg.isnull;
+	if (result.isnull)
+		return result;
+	if (TIMESTAMP_NOT_FINITE(arg.value))
+	{
+		result.value = arg.value;
+		return result;
+	}
+	if (!timestamp2tm(arg.value, &tz, &tm, &fsec, sp) ||
+		!tm2timestamp(&tm, fsec, NULL, &result.value))
+	{
+		result.isnull = true;
+		STROM_EREPORT(kcxt, ERRCODE_DATETIME_VALUE_OUT_OF_RANGE,
+					  "timestamp out of range");
+	}
+	return result;
+}
+
+DEVICE_FUNCTION(pg_timestamptz_t)
+pgfn_timestamp_zone_fastpath(kern_context *kcxt,
+							 const tz_state *sp, pg_timestamp_t arg)
+{
+	pg_timestamptz_t result;
+	struct pg_tm	tm;
+	fsec_t			fsec;
+	int				tz;
+
+	result.isnull = arg.isnull;
+	if (result.isnull)
+		return result;
+	if (TIMESTAMP_NOT_FINITE(arg.value))
+	{
+		result.value = arg.value;
+		return result;
+	}
+	if (!timestamp2tm(arg.value, NULL, &tm, &fsec, NULL))
+	{
+		result.isnull = true;
+		STROM_EREPORT(kcxt, ERRCODE_DATETIME_VALUE_OUT_OF_RANGE,
+					  "timestamp out of range");
+		return result;
+	}
+	tz = DetermineTimeZoneOffset(&tm, sp);
+	if (!tm2timestamp(&tm, fsec, &tz, &result.value))
+	{
+		result.isnull = true;
+		STROM_EREPORT(kcxt, ERRCODE_DATETIME_VALUE_OUT_OF_RANGE,
+					  "timestamp out of range");
+	}
+	return result;
+}
+
+/*
+ * time_bucket(interval,timestamp[tz][,timestamp[tz]|text])
+ *
+ * It returns the beginning of the bucket that contains the timestamp.
+ * Buckets are aligned to the origin; 2000-01-03 (Monday) by default.
+ * Width in months is aligned to the first day of the origin's month, and
+ * cannot be mixed with days and time. timestamptz is bucketed on UTC,
+ * unless the time zone is given. Keep the logic consistent with the host
+ * implementation in misc.c.
+ */
+#define TIME_BUCKET_DEFAULT_ORIGIN		(2 * USECS_PER_DAY)
+
+STATIC_FUNCTION(cl_bool)
+time_bucket_internal(kern_context *kcxt, const Interval *iv,
+					 Timestamp ts, Timestamp origin, Timestamp *p_result)
+{
+	if (TIMESTAMP_NOT_FINITE(ts))
+	{
+		*p_result = ts;
+		return true;
+	}
+	if (iv->month != 0)
+	{
+		struct pg_tm tm, otm;
+		fsec_t		fsec, ofsec;
+		cl_long		base, months;
+
+		if (iv->month < 0 || iv->day != 0 || iv->time != 0)
+		{
+			STROM_EREPORT(kcxt, ERRCODE_FEATURE_NOT_SUPPORTED,
+						  "month intervals cannot have day or time component");
+			return false;
+		}
+		if (!timestamp2tm(ts, NULL, &tm, &fsec, NULL) ||
+			!timestamp2tm(origin, NULL, &otm, &ofsec, NULL))
+		{
+			STROM_EREPORT(kcxt, ERRCODE_DATETIME_VALUE_OUT_OF_RANGE,
+						  "timestamp out of range");
+			return false;
+		}
+		base = (cl_long)otm.tm_year * MONTHS_PER_YEAR + (otm.tm_mon - 1);
+		months = (cl_long)tm.tm_year * MONTHS_PER_YEAR + (tm.tm_mon - 1) - base;
+		months -= ((months % iv->month) + iv->month) % iv->month;
+		months += base;
+		tm.tm_mon  = ((months % MONTHS_PER_YEAR) + MONTHS_PER_YEAR) % MONTHS_PER_YEAR;
+		tm.tm_year = (months - tm.tm_mon) / MONTHS_PER_YEAR;
+		tm.tm_mon += 1;
+		tm.tm_mday = 1;
+		tm.tm_hour = 0;
+		tm.tm_min  = 0;
+		tm.tm_sec  = 0;
+		if (!tm2timestamp(&tm, 0, NULL, p_result))
+		{
+			STROM_EREPORT(kcxt, ERRCODE_DATETIME_VALUE_OUT_OF_RANGE,
+						  "timestamp out of range");
+			return false;
+		}
+	}
+	else
+	{
+		cl_long		width = (cl_long)iv->day * USECS_PER_DAY + iv->time;
+		cl_long		rem;
+
+		if (width <= 0)
+		{
+			STROM_EREPORT(kcxt, ERRCODE_INVALID_PARAMETER_VALUE,
+						  "period must be greater than 0");
+			return false;
+		}
+		rem = (ts - origin) % width;
+		if (rem < 0)
+			rem += width;
+		*p_result = ts - rem;
+	}
+	return true;
+}
+
+DEVICE_FUNCTION(pg_timestamp_t)
+pgfn_time_bucket_timestamp_origin(kern_context *kcxt,
+								  pg_interval_t arg1, pg_timestamp_t arg2,
+								  pg_timestamp_t arg3)
+{
+	pg_timestamp_t	result;
+
+	result.isnull = arg1.isnull | arg2.isnull | arg3.isnull;
+	if (!result.isnull &&
+		!time_bucket_internal(kcxt, &arg1.value,
+							  arg2.value, arg3.value, &result.value))
+		result.isnull = true;
+	return result;
+}
+
+DEVICE_FUNCTION(pg_timestamp_t)
+pgfn_time_bucket_timestamp(kern_context *kcxt,
+						   pg_interval_t arg1, pg_timestamp_t arg2)
+{
+	pg_timestamp_t	origin;
+
+	origin.isnull = false;
+	origin.value = TIME_BUCKET_DEFAULT_ORIGIN;
+	return pgfn_time_bucket_timestamp_origin(kcxt, arg1, arg2, origin);
+}
+
+DEVICE_FUNCTION(pg_timestamptz_t)
+pgfn_time_bucket_timestamptz_origin(kern_context *kcxt,
+									pg_interval_t arg1, pg_timestamptz_t arg2,
+									pg_timestamptz_t arg3)
+{
+	pg_timestamptz_t result;
+
+	result.isnull = arg1.isnull | arg2.isnull | arg3.isnull;
+	if (!result.isnull &&
+		!time_bucket_internal(kcxt, &arg1.value,
+							  arg2.value, arg3.value, &result.value))
+		result.isnull = true;
+	return result;
+}
+
+DEVICE_FUNCTION(pg_timestamptz_t)
+pgfn_time_bucket_timestamptz(kern_context *kcxt,
+							 pg_interval_t arg1, pg_timestamptz_t arg2)
+{
+	pg_timestamptz_t origin;
+
+	origin.isnull = false;
+	origin.value = TIME_BUCKET_DEFAULT_ORIGIN;
+	return pgfn_time_bucket_timestamptz_origin(kcxt, arg1, arg2, origin);
+}
+
+DEVICE_FUNCTION(pg_timestamptz_t)
+pgfn_time_bucket_timestamptz_zone_fastpath(kern_context *kcxt,
+										   pg_interval_t arg1,
+										   pg_timestamptz_t arg2,
+										   const tz_state *sp)
+{
+	pg_timestamptz_t result;
+	Timestamp		local;
+	struct pg_tm	tm;
+	fsec_t			fsec;
+	int				tz;
+
+	result.isnull = arg1.isnull | arg2.isnull;
+	if (result.isnull)
+		return result;
+	if (TIMESTAMP_NOT_FINITE(arg2.value))
+	{
+		result.value = arg2.value;
+		return result;
+	}
+	/* bucketing on the local time of the zone */
+	if (!timestamp2tm(arg2.value, &tz, &tm, &fsec, sp) ||
+		!tm2timestamp(&tm, fsec, NULL, &local))
+	{
+		result.isnull = true;
+		STROM_EREPORT(kcxt, ERRCODE_DATETIME_VALUE_OUT_OF_RANGE,
+					  "timestamp out of range");
+		return result;
+	}
+	if (!time_bucket_internal(kcxt, &arg1.value, local,
+							  TIME_BUCKET_DEFAULT_ORIGIN, &local))
+	{
+		result.isnull = true;
+		return result;
+	}
+	if (!timestamp2tm(local, NULL, &tm, &fsec, NULL))
+	{
+		result.isnull = true;
+		STROM_EREPORT(kcxt, ERRCODE_DATETIME_VALUE_OUT_OF_RANGE,
+					  "timestamp out of range");
+		return result;
+	}
+	tz = DetermineTimeZoneOffset(&tm, sp);
+	if (!tm2timestamp(&tm, fsec, &tz, &result.value))
+	{
+		result.isnull = true;
+		STROM_EREPORT(kcxt, ERRCODE_DATETIME_VALUE_OUT_OF_RANGE,
+					  "timestamp out of range");
+	}
+	return result;
+}
+
 /*
  * Hyper-Log-Log hash functions
  */
@@ -559,6 +559,41 @@ DEVICE_FUNCTION(pg_numeric_t)
 pgfn_extract_timetz(kern_context *kcxt, pg_text_t arg1, pg_timetz_t arg2);
 DEVICE_FUNCTION(pg_numeric_t)
 pgfn_extract_time(kern_context *kcxt, pg_text_t arg1, pg_time_t arg2);
+DEVICE_FUNCTION(pg_timestamp_t)
+pgfn_timestamp_trunc(kern_context *kcxt,
+					 pg_text_t arg1, pg_timestamp_t arg2);
+DEVICE_FUNCTION(pg_timestamptz_t)
+pgfn_timestamptz_trunc(kern_context *kcxt,
+					   pg_text_t arg1, pg_timestamptz_t arg2);
+DEVICE_FUNCTION(pg_timestamptz_t)
+pgfn_timestamptz_trunc_zone_fastpath(kern_context *kcxt,
+									 pg_text_t arg1, pg_timestamptz_t arg2,
+									 const tz_state *sp);
+DEVICE_FUNCTION(pg_timestamp_t)
+pgfn_timestamptz_zone_fastpath(kern_context *kcxt,
+							   const tz_state *sp, pg_timestamptz_t arg);
+DEVICE_FUNCTION(pg_timestamptz_t)
+pgfn_timestamp_zone_fastpath(kern_context *kcxt,
+							 const tz_state *sp, pg_timestamp_t arg);
+DEVICE_FUNCTION(pg_timestamp_t)
+pgfn_time_bucket_timestamp(kern_context *kcxt,
+						   pg_interval_t arg1, pg_timestamp_t arg2);
+DEVICE_FUNCTION(pg_timestamp_t)
+pgfn_time_bucket_timestamp_origin(kern_context *kcxt,
+								  pg_interval_t arg1, pg_timestamp_t arg2,
+								  pg_timestamp_t arg3);
+DEVICE_FUNCTION(pg_timestamptz_t)
+pgfn_time_bucket_timestamptz(kern_context *kcxt,
+							 pg_interval_t arg1, pg_timestamptz_t arg2);
+DEVICE_FUNCTION(pg_timestamptz_t)
+pgfn_time_bucket_timestamptz_origin(kern_context *kcxt,
+									pg_interval_t arg1, pg_timestamptz_t arg2,
+									pg_timestamptz_t arg3);
+DEVICE_FUNCTION(pg_timestamptz_t)
+pgfn_time_bucket_timestamptz_zone_fastpath(kern_context *kcxt,
+										   pg_interval_t arg1,
+										   pg_timestamptz_t arg2,
+										   const tz_state *sp);
 
 /*
  * Hyper-Log-Log hash functions
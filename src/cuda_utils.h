@@ -815,5 +815,53 @@ PG_SCALAR_ARRAY_OP(kern_context *kcxt,
 	}
 	return result;
 }
+
+/*
+ * PG_SCALAR_ARRAY_BSEARCH - A variation of PG_SCALAR_ARRAY_OP for integer
+ * equality (ANY) or inequality (ALL) towards a constant array. Host code
+ * already sorted and de-duplicated the array elements, and delivers them
+ * as int8[] array without NULLs, so we can probe by binary search.
+ */
+template <typename ScalarType>
+DEVICE_INLINE(pg_bool_t)
+PG_SCALAR_ARRAY_BSEARCH(kern_context *kcxt,
+						ScalarType scalar,
+						pg_array_t array,
+						cl_bool useOr)	/* true = ANY, false = ALL */
+{
+	pg_bool_t	result;
+	const cl_long *items;
+	cl_long		key;
+	cl_uint		head, tail, curr;
+	cl_uint		nitems;
+
+	if (array.isnull || scalar.isnull)
+	{
+		result.isnull = true;
+		result.value = false;
+		return result;
+	}
+	assert(array.length < 0);
+	nitems = ArrayGetNItems(kcxt,
+							ARR_NDIM(array.value),
+							ARR_DIMS(array.value));
+	items = (const cl_long *)ARR_DATA_PTR(array.value);
+	key = scalar.value;
+	head = 0;
+	tail = nitems;
+	while (head < tail)
+	{
+		curr = (head + tail) / 2;
+		if (__Fetch(items + curr) < key)
+			head = curr + 1;
+		else
+			tail = curr;
+	}
+	result.isnull = false;
+	result.value = (head < nitems && __Fetch(items + head) == key);
+	if (!useOr)
+		result.value = !result.value;
+	return result;
+}
 #endif  /* __CUDACC__ */
 #endif  /* CUDA_UTILS_H */
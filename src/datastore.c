@@ -104,6 +104,7 @@ KDS_fetch_tuple_block(TupleTableSlot *slot,
 					  GpuTaskState *gts)
 {
 	Relation	rel = gts->css.ss.ss_currentRelation;
+	Snapshot	snapshot = gts->css.ss.ps.state->es_snapshot;
 	HeapTuple	tuple = &gts->curr_tuple;
 	BlockNumber	block_nr;
 	PageHeader	hpage;
@@ -114,7 +115,6 @@ KDS_fetch_tuple_block(TupleTableSlot *slot,
 	{
 		block_nr = KERN_DATA_STORE_BLOCK_BLCKNR(kds, gts->curr_index);
 		hpage = KERN_DATA_STORE_BLOCK_PGPAGE(kds, gts->curr_index);
-		Assert(PageIsAllVisible(hpage));
 		max_lp_index = PageGetMaxOffsetNumber(hpage);
 		while (gts->curr_lp_index < max_lp_index)
 		{
@@ -130,6 +130,10 @@ KDS_fetch_tuple_block(TupleTableSlot *slot,
 			tuple->t_tableOid = (rel ? RelationGetRelid(rel) : InvalidOid);
 			tuple->t_data = (HeapTupleHeader)((char *)hpage +
 											  ItemIdGetOffset(lpp));
+			/* blocks loaded by GPUDirect SQL may not be all-visible */
+			if (!PageIsAllVisible(hpage) &&
+				!pgstromHeapTupleSatisfiesMVCC(tuple->t_data, snapshot))
+				continue;
 			ExecForceStoreHeapTuple(tuple, slot, false);
 			return true;
 		}
@@ -145,6 +149,9 @@ PDS_fetch_tuple(TupleTableSlot *slot,
 				pgstrom_data_store *pds,
 				GpuTaskState *gts)
 {
+	MemoryContext	oldcxt;
+	bool			retval;
+
 	switch (pds->kds.format)
 	{
 		case KDS_FORMAT_ROW:
@@ -158,8 +165,23 @@ PDS_fetch_tuple(TupleTableSlot *slot,
 		case KDS_FORMAT_BLOCK:
 			return KDS_fetch_tuple_block(slot, &pds->kds, gts);
 		case KDS_FORMAT_ARROW:
-			return KDS_fetch_tuple_arrow(slot, &pds->kds,
-										 gts->curr_index++);
+			/*
+			 * Some of Arrow values (varlena, numeric, ...) have to be built
+			 * on the memory. The previous row is no longer referenced once
+			 * the next row is fetched, so the short-lived memory context
+			 * shall be reset for each row, then its keeper block is reused
+			 * without malloc(3) and the memory consumption is bounded by
+			 * a row, not by the entire query.
+			 */
+			if (!gts->fetch_memcxt)
+				return KDS_fetch_tuple_arrow(slot, &pds->kds,
+											 gts->curr_index++);
+			MemoryContextReset(gts->fetch_memcxt);
+			oldcxt = MemoryContextSwitchTo(gts->fetch_memcxt);
+			retval = KDS_fetch_tuple_arrow(slot, &pds->kds,
+										   gts->curr_index++);
+			MemoryContextSwitchTo(oldcxt);
+			return retval;
 		default:
 			elog(ERROR, "Bug? unsupported data store format: %d",
 				pds->kds.format);
@@ -762,14 +784,15 @@ pgstrom_data_store *
 __PDS_create_block(GpuContext *gcontext,
 				   TupleDesc tupdesc,
 				   NVMEScanState *nvme_sstate,
+				   cl_uint nrooms,
 				   const char *filename, int lineno)
 {
 	pgstrom_data_store *pds = NULL;
-	cl_uint		nrooms = nvme_sstate->nblocks_per_chunk;
 	size_t		length;
 	size_t		iovec_sz;
 	CUresult	rc;
 
+	Assert(nrooms > 0 && nrooms <= nvme_sstate->nblocks_per_chunk);
 	length = KDS_calculateHeadSize(tupdesc)
 		+ STROMALIGN(sizeof(BlockNumber) * nrooms)
 		+ BLCKSZ * nrooms;
@@ -921,6 +944,7 @@ PDS_init_heapscan_state(GpuTaskState *gts)
 	cl_uint			nrooms_max;
 	cl_uint			nchunks;
 	cl_uint			nblocks_per_chunk;
+	struct stat		stat_buf;
 
 	/*
 	 * Check storage capability of NVMe-Strom
@@ -972,6 +996,9 @@ PDS_init_heapscan_state(GpuTaskState *gts)
 	nvme_sstate->curr_vmbuffer = InvalidBuffer;
 	nvme_sstate->nr_segs = nr_segs;
 	nvme_sstate_open_files(gcontext, nvme_sstate, relation);
+	if (fstat(nvme_sstate->files[0].rawfd, &stat_buf) == 0)
+		nvme_sstate->stripe_pages = (GetStripeSizeOfDevice(stat_buf.st_dev)
+									 / PAGE_SIZE);
 
 	gts->nvme_sstate = nvme_sstate;
 }
@@ -1120,12 +1147,14 @@ PDS_fillup_blocks(pgstrom_data_store *pds)
 	loff_t			curr_fpos;
 	size_t			curr_size;
 	BlockNumber	   *block_nums;
+	uint64			nvtx_range;
 
 	if (pds->kds.format != KDS_FORMAT_BLOCK)
 		elog(ERROR, "Bug? only KDS_FORMAT_BLOCK can be filled up");
 
 	if (pds->nblocks_uncached == 0)
 		return;		/* already filled up */
+	nvtx_range = pgstromNvtxBegin("PDS_fillup_blocks", NULL, 0);
 
 	Assert(filedesc >= 0);
 	Assert(pds->nblocks_uncached <= pds->kds.nitems);
@@ -1174,6 +1203,155 @@ PDS_fillup_blocks(pgstrom_data_store *pds)
 	Assert(dest_addr == (char *)KERN_DATA_STORE_BLOCK_PGPAGE(&pds->kds,
 															 pds->kds.nitems));
 	pds->nblocks_uncached = 0;
+	pgstromNvtxEnd(nvtx_range);
+}
+
+/*
+ * __PDS_fillup_arrow_parallel
+ *
+ * It reads the i/o chunks by multiple threads concurrently, if
+ * arrow_fdw.io_parallelism > 1. On the filesystems with long latency
+ * per request (like object storage mounted by FUSE), concurrent ranged
+ * reads hide the latency; a large chunk is also split into pieces.
+ */
+#define ARROW_IO_PIECE_SIZE		(8UL << 20)		/* 8MB */
+
+typedef struct
+{
+	char	   *dest;
+	off_t		f_pos;
+	size_t		len;
+} arrowIOPiece;
+
+typedef struct
+{
+	int			fdesc;
+	int			npieces;
+	pg_atomic_uint32 next_piece;
+	volatile int error_code;	/* errno, or -1 if unexpected EOF */
+	arrowIOPiece pieces[FLEXIBLE_ARRAY_MEMBER];
+} arrowIOParallelState;
+
+static void *
+__PDS_fillup_arrow_worker(void *__pstate)
+{
+	arrowIOParallelState *pstate = __pstate;
+	uint32		index;
+
+	while ((index = pg_atomic_fetch_add_u32(&pstate->next_piece, 1))
+		   < pstate->npieces)
+	{
+		arrowIOPiece *piece = &pstate->pieces[index];
+		char	   *dest = piece->dest;
+		off_t		f_pos = piece->f_pos;
+		size_t		len = piece->len;
+		ssize_t		sz;
+
+		if (pstate->error_code != 0)
+			break;
+		while (len > 0)
+		{
+			sz = pread(pstate->fdesc, dest, len, f_pos);
+			if (sz > 0)
+			{
+				dest += sz;
+				f_pos += sz;
+				len -= sz;
+			}
+			else if (sz == 0)
+			{
+				/* see the comment in __PDS_fillup_arrow */
+				if (len >= PAGE_SIZE)
+					pstate->error_code = -1;
+				memset(dest, 0, len);
+				break;
+			}
+			else if (errno != EINTR)
+			{
+				pstate->error_code = errno;
+				break;
+			}
+		}
+	}
+	return NULL;
+}
+
+static bool
+__PDS_fillup_arrow_parallel(pgstrom_data_store *pds_dst,
+							int fdesc, strom_io_vector *iovec)
+{
+	arrowIOParallelState *pstate;
+	pthread_t  *threads;
+	int			nthreads;
+	int			npieces = 0;
+	int			i, j;
+
+	if (arrow_io_parallelism <= 1 || iovec->nr_chunks == 0)
+		return false;
+	for (j=0; j < iovec->nr_chunks; j++)
+	{
+		size_t	len = (size_t)iovec->ioc[j].nr_pages * PAGE_SIZE;
+
+		npieces += (len + ARROW_IO_PIECE_SIZE - 1) / ARROW_IO_PIECE_SIZE;
+	}
+	if (npieces <= 1)
+		return false;
+
+	/* NOTE: this routine may run on the GPU worker thread */
+	pstate = malloc(offsetof(arrowIOParallelState, pieces[npieces]));
+	if (!pstate)
+		return false;
+	pstate->fdesc = fdesc;
+	pstate->npieces = npieces;
+	pg_atomic_init_u32(&pstate->next_piece, 0);
+	pstate->error_code = 0;
+	for (i=0, j=0; j < iovec->nr_chunks; j++)
+	{
+		strom_io_chunk *ioc = &iovec->ioc[j];
+		char   *dest = (char *)&pds_dst->kds + ioc->m_offset;
+		off_t	f_pos = (size_t)ioc->fchunk_id * PAGE_SIZE;
+		size_t	len = (size_t)ioc->nr_pages * PAGE_SIZE;
+
+		while (len > 0)
+		{
+			arrowIOPiece *piece = &pstate->pieces[i++];
+
+			piece->dest  = dest;
+			piece->f_pos = f_pos;
+			piece->len   = Min(len, ARROW_IO_PIECE_SIZE);
+			dest  += piece->len;
+			f_pos += piece->len;
+			len   -= piece->len;
+		}
+	}
+	Assert(i == npieces);
+
+	nthreads = Min(arrow_io_parallelism, npieces);
+	threads = alloca(sizeof(pthread_t) * nthreads);
+	for (i=1; i < nthreads; i++)
+	{
+		if (pthread_create(&threads[i], NULL,
+						   __PDS_fillup_arrow_worker, pstate) != 0)
+			break;
+	}
+	nthreads = i;
+	/* the current thread also performs as a reader */
+	__PDS_fillup_arrow_worker(pstate);
+	for (i=1; i < nthreads; i++)
+		pthread_join(threads[i], NULL);
+
+	if (pstate->error_code != 0)
+	{
+		int		error_code = pstate->error_code;
+
+		free(pstate);
+		if (error_code < 0)
+			werror("unable to read arrow file any more");
+		errno = error_code;
+		werror("failed on pread(2) of arrow file: %m");
+	}
+	free(pstate);
+	return true;
 }
 
 /*
@@ -1197,6 +1375,8 @@ __PDS_fillup_arrow(pgstrom_data_store *pds_dst,
 	pds_dst->iovec = NULL;
 	memcpy(&pds_dst->kds, kds_head, head_sz);
 
+	if (__PDS_fillup_arrow_parallel(pds_dst, fdesc, iovec))
+		return;
 	for (j=0; j < iovec->nr_chunks; j++)
 	{
 		strom_io_chunk *ioc = &iovec->ioc[j];
@@ -1268,10 +1448,18 @@ PDS_fillup_arrow(pgstrom_data_store *pds_src)
 	if (rc != CUDA_SUCCESS)
 		werror("failed on gpuMemAllocManaged: %s", errorText(rc));
 	__PDS_fillup_arrow(pds_dst,
-					   pds_dst->gcontext,
+					   pds_src->gcontext,
 					   &pds_src->kds,
 					   pds_src->filedesc.rawfd,
 					   pds_src->iovec);
+	if (pds_src->gpu_decompress)
+	{
+		kern_arrow_decomp *kdecomp = KERN_DATA_STORE_ARROW_DECOMP(&pds_src->kds);
+
+		memcpy(KERN_DATA_STORE_ARROW_DECOMP(&pds_dst->kds), kdecomp,
+			   KERN_ARROW_DECOMP_LENGTH(kdecomp->nitems));
+		pds_dst->gpu_decompress = true;
+	}
 	return pds_dst;
 }
 
@@ -1309,3 +1497,82 @@ PDS_writeback_arrow(pgstrom_data_store *pds_src,
 
 	return pds_dst;
 }
+
+/*
+ * PDS_decompress_arrow - kicks GPU kernel to decompress the buffers of
+ *                        the KDS_FORMAT_ARROW already on the device.
+ *
+ * It raises an error on the corrupted buffers, so the caller never
+ * launches the main kernel towards the half-decompressed KDS.
+ */
+void
+PDS_decompress_arrow(CUmodule cuda_module,
+					 CUdeviceptr m_kds,
+					 pgstrom_data_store *pds,
+					 CUdeviceptr m_kerror)
+{
+	GpuContext *gcontext = GpuWorkerCurrentContext;
+	kern_arrow_decomp *kdecomp;
+	kern_errorbuf *kerror;
+	CUfunction	kern_decompress;
+	void	   *kern_args[2];
+	int			warp_sz;
+	int			grid_sz;
+	int			block_sz;
+	CUresult	rc;
+
+	if (pds->kds.format != KDS_FORMAT_ARROW || !pds->gpu_decompress)
+		return;
+	kdecomp = KERN_DATA_STORE_ARROW_DECOMP(&pds->kds);
+	if (kdecomp->nitems == 0)
+		return;
+
+	rc = cuModuleGetFunction(&kern_decompress,
+							 cuda_module,
+							 "kern_arrow_decompress");
+	if (rc != CUDA_SUCCESS)
+		werror("failed on cuModuleGetFunction: %s", errorText(rc));
+
+	rc = gpuOptimalBlockSize(&grid_sz,
+							 &block_sz,
+							 kern_decompress,
+							 CU_DEVICE_PER_THREAD,
+							 0, 0);
+	if (rc != CUDA_SUCCESS)
+		werror("failed on gpuOptimalBlockSize: %s", errorText(rc));
+	/* one warp per chunk */
+	warp_sz = devAttrs[gcontext->cuda_dindex].WARP_SIZE;
+	block_sz = TYPEALIGN_DOWN(warp_sz, block_sz);
+	grid_sz = Min(grid_sz, (kdecomp->nitems * warp_sz +
+							block_sz - 1) / block_sz);
+
+	kern_args[0] = &m_kerror;
+	kern_args[1] = &m_kds;
+	rc = cuLaunchKernel(kern_decompress,
+						grid_sz, 1, 1,
+						block_sz, 1, 1,
+						0,
+						CU_STREAM_PER_THREAD,
+						kern_args,
+						NULL);
+	if (rc != CUDA_SUCCESS)
+		werror("failed on cuLaunchKernel: %s", errorText(rc));
+
+	/*
+	 * The main kernel must not consume the buffers partially decompressed,
+	 * so we wait for completion of the decompression, then raise an error
+	 * if the buffers are corrupted.
+	 */
+	rc = cuStreamSynchronize(CU_STREAM_PER_THREAD);
+	if (rc != CUDA_SUCCESS)
+		werror("failed on cuStreamSynchronize: %s", errorText(rc));
+	kerror = (kern_errorbuf *)m_kerror;
+	if (kerror->errcode != ERRCODE_STROM_SUCCESS)
+		GpuContextWorkerReportError(ERROR,
+									kerror->errcode & ~ERRCODE_FLAGS_CPU_FALLBACK,
+									kerror->filename,
+									kerror->lineno,
+									kerror->funcname,
+									"GPU kernel: %s",
+									kerror->message);
+}
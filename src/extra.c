@@ -264,6 +264,194 @@ gpuDirectFileReadIOV(const GPUDirectFileDesc *gds_fdesc,
 		werror("failed on gpuDirectFileReadIOV");
 }
 
+/*
+ * gpuDirectFileWriteIOV
+ *
+ * A reverse direction of gpuDirectFileReadIOV; it writes out the device
+ * memory regions to the file. If the driver has no write path (older
+ * extra module), it falls back to the write via host bounce buffer.
+ */
+static int (*p_gpudirect_file_write_iov)(
+	const GPUDirectFileDesc *gds_fdesc,
+	CUdeviceptr m_segment,
+	unsigned long iomap_handle,
+	off_t m_offset,
+	strom_io_vector *iovec) = NULL;
+
+#define GPUDIRECT_BOUNCE_BUFFER_SIZE	(4UL << 20)		/* 4MB */
+
+bool
+gpuDirectFileWriteIsSupported(void)
+{
+	return (p_gpudirect_file_write_iov != NULL);
+}
+
+void
+gpuDirectFileWriteIOV(const GPUDirectFileDesc *gds_fdesc,
+					  CUdeviceptr m_segment,
+					  unsigned long iomap_handle,
+					  off_t m_offset,
+					  strom_io_vector *iovec)
+{
+	char	   *buffer;
+	int			i;
+
+	if (p_gpudirect_file_write_iov)
+	{
+		if (p_gpudirect_file_write_iov(gds_fdesc,
+									   m_segment,
+									   iomap_handle,
+									   m_offset,
+									   iovec))
+			werror("failed on gpuDirectFileWriteIOV");
+		return;
+	}
+
+	/* fallback by the host bounce buffer */
+	buffer = malloc(GPUDIRECT_BOUNCE_BUFFER_SIZE);
+	if (!buffer)
+		werror("out of memory");
+	for (i=0; i < iovec->nr_chunks; i++)
+	{
+		strom_io_chunk *ioc = &iovec->ioc[i];
+		CUdeviceptr	m_addr = m_segment + m_offset + ioc->m_offset;
+		off_t		f_pos = (off_t)ioc->fchunk_id * PAGE_SIZE;
+		size_t		remain = (size_t)ioc->nr_pages * PAGE_SIZE;
+
+		while (remain > 0)
+		{
+			size_t		sz = Min(remain, GPUDIRECT_BOUNCE_BUFFER_SIZE);
+			size_t		offset = 0;
+			ssize_t		nbytes;
+			CUresult	rc;
+
+			rc = cuMemcpyDtoH(buffer, m_addr, sz);
+			if (rc != CUDA_SUCCESS)
+			{
+				free(buffer);
+				werror("failed on cuMemcpyDtoH: %s", errorText(rc));
+			}
+			while (offset < sz)
+			{
+				nbytes = pwrite(gds_fdesc->rawfd,
+								buffer + offset,
+								sz - offset,
+								f_pos + offset);
+				if (nbytes < 0)
+				{
+					if (errno == EINTR)
+						continue;
+					free(buffer);
+					werror("failed on pwrite: %m");
+				}
+				offset += nbytes;
+			}
+			m_addr += sz;
+			f_pos  += sz;
+			remain -= sz;
+		}
+	}
+	free(buffer);
+}
+
+/*
+ * GpuDirectTempFile - temporary file manager for spills of the device
+ * memory. Every region is written at PAGE_SIZE aligned position, so it
+ * can be read back by gpuDirectFileReadIOV as is.
+ */
+GpuDirectTempFile *
+gpuDirectTempFileCreate(GpuContext *gcontext)
+{
+	GpuDirectTempFile *tfile;
+
+	tfile = palloc0(sizeof(GpuDirectTempFile));
+	tfile->vfd = OpenTemporaryFile(false);
+	gpuDirectFileDescOpen(&tfile->dfile, tfile->vfd);
+	if (!trackRawFileDesc(gcontext, &tfile->dfile, __FILE__, __LINE__))
+	{
+		gpuDirectFileDescClose(&tfile->dfile);
+		FileClose(tfile->vfd);
+		elog(ERROR, "out of memory");
+	}
+	tfile->f_tail = 0;
+
+	return tfile;
+}
+
+/*
+ * gpuDirectTempFileWrite
+ *
+ * It appends the device memory region at the tail of the temporary file,
+ * then returns the file position to be read back later. Note that the
+ * region is written in PAGE_SIZE unit, so caller must ensure the device
+ * memory is accessible until the next page boundary.
+ */
+off_t
+gpuDirectTempFileWrite(GpuDirectTempFile *tfile,
+					   CUdeviceptr m_segment,
+					   unsigned long iomap_handle,
+					   off_t m_offset,
+					   size_t length)
+{
+	strom_io_vector	*iovec = alloca(offsetof(strom_io_vector, ioc[1]));
+	off_t		f_pos = tfile->f_tail;
+
+	Assert((f_pos & (PAGE_SIZE-1)) == 0);
+	iovec->nr_chunks = 1;
+	iovec->ioc[0].m_offset  = 0;
+	iovec->ioc[0].fchunk_id = f_pos / PAGE_SIZE;
+	iovec->ioc[0].nr_pages  = TYPEALIGN(PAGE_SIZE, length) / PAGE_SIZE;
+	gpuDirectFileWriteIOV(&tfile->dfile,
+						  m_segment,
+						  iomap_handle,
+						  m_offset,
+						  iovec);
+	tfile->f_tail += (size_t)iovec->ioc[0].nr_pages * PAGE_SIZE;
+
+	return f_pos;
+}
+
+/*
+ * gpuDirectTempFileRead
+ *
+ * It loads the region written by gpuDirectTempFileWrite onto the device
+ * memory, by SSD2GPU Direct DMA.
+ */
+void
+gpuDirectTempFileRead(GpuDirectTempFile *tfile,
+					  CUdeviceptr m_segment,
+					  unsigned long iomap_handle,
+					  off_t m_offset,
+					  off_t f_pos,
+					  size_t length)
+{
+	strom_io_vector	*iovec = alloca(offsetof(strom_io_vector, ioc[1]));
+
+	Assert((f_pos & (PAGE_SIZE-1)) == 0 &&
+		   f_pos + length <= tfile->f_tail);
+	iovec->nr_chunks = 1;
+	iovec->ioc[0].m_offset  = 0;
+	iovec->ioc[0].fchunk_id = f_pos / PAGE_SIZE;
+	iovec->ioc[0].nr_pages  = TYPEALIGN(PAGE_SIZE, length) / PAGE_SIZE;
+	gpuDirectFileReadIOV(&tfile->dfile,
+						 m_segment,
+						 iomap_handle,
+						 m_offset,
+						 iovec);
+}
+
+/*
+ * gpuDirectTempFileClose
+ */
+void
+gpuDirectTempFileClose(GpuContext *gcontext, GpuDirectTempFile *tfile)
+{
+	untrackRawFileDesc(gcontext, &tfile->dfile);
+	gpuDirectFileDescClose(&tfile->dfile);
+	FileClose(tfile->vfd);
+	pfree(tfile);
+}
+
 /*
  * extraSysfsSetupDistanceMap
  */
@@ -522,6 +710,13 @@ pgstrom_init_extra(void)
 			LOOKUP_GPUDIRECT_EXTRA_FUNCTION(prefix, map_gpu_memory);
 			LOOKUP_GPUDIRECT_EXTRA_FUNCTION(prefix, unmap_gpu_memory);
 			LOOKUP_GPUDIRECT_EXTRA_FUNCTION(prefix, file_read_iov);
+			/* write path is optional; fallback by bounce buffer if none */
+			{
+				char	symbol[128];
+
+				snprintf(symbol, sizeof(symbol), "%s__file_write_iov", prefix);
+				p_gpudirect_file_write_iov = dlsym(handle, symbol);
+			}
 		}
 		LOOKUP_HETERODB_EXTRA_FUNCTION(sysfs_setup_distance_map);
 		LOOKUP_HETERODB_EXTRA_FUNCTION(sysfs_lookup_optimal_gpus);
@@ -540,6 +735,7 @@ pgstrom_init_extra(void)
 		p_gpudirect_map_gpu_memory = NULL;
 		p_gpudirect_unmap_gpu_memory = NULL;
 		p_gpudirect_file_read_iov = NULL;
+		p_gpudirect_file_write_iov = NULL;
 		p_sysfs_setup_distance_map = NULL;
 		p_sysfs_lookup_optimal_gpus = NULL;
 		p_sysfs_print_nvme_info = NULL;
@@ -0,0 +1,415 @@
+/*
+ * feedback.c
+ *
+ * Cardinality feedback from the runtime statistics to the planner
+ * ----
+ * Copyright 2011-2021 (C) KaiGai Kohei <kaigai@kaigai.gr.jp>
+ * Copyright 2014-2021 (C) PG-Strom Developers Team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the PostgreSQL License.
+ */
+#include "pg_strom.h"
+
+/*
+ * CardinalityFeedbackItem
+ *
+ * GpuJoin and GpuPreAgg record the number of rows actually processed at
+ * the end of execution, keyed by the signature of the plan node; a hash
+ * value of the underlying relations, their scan qualifiers and the
+ * join-quals or grouping-keys. The planner picks them up for the repeated
+ * query shapes, instead of the selectivity estimation.
+ * The signature consists of a 64bit hash and the length of the serialized
+ * plan shape, and both of them must match.
+ * The plan shapes that depend on Param (like prepared statements with
+ * bound values) have no signature, because the number of rows may vary
+ * for each execution.
+ * The table is a set-associative cache; each signature is mapped to
+ * a set of CARDINALITY_FEEDBACK_NWAYS items, and the oldest item in the
+ * set is replaced by a new signature.
+ */
+#define CARDINALITY_FEEDBACK_NSLOTS		4096
+#define CARDINALITY_FEEDBACK_NWAYS		8
+
+typedef struct
+{
+	Oid			database_oid;	/* InvalidOid, if unused */
+	cl_uint		sig_keylen;
+	cl_ulong	sig_hash;
+	cl_uint		nsamples;
+	double		nrows_in;
+	double		nrows_out;
+	TimestampTz	last_update;
+} CardinalityFeedbackItem;
+
+typedef struct
+{
+	slock_t		lock;
+	CardinalityFeedbackItem items[CARDINALITY_FEEDBACK_NSLOTS];
+} CardinalityFeedbackHead;
+
+static CardinalityFeedbackHead *cardinality_feedback = NULL;
+static shmem_startup_hook_type shmem_startup_next = NULL;
+static bool		pgstrom_enable_cardinality_feedback;	/* GUC */
+
+/*
+ * pgstromCardinalityFeedbackSignature
+ *
+ * It computes a signature of the plan node from the relations, their
+ * scan qualifiers, and the supplied expressions (join-quals or grouping
+ * keys). Var-nodes are identified by the relation OID and attribute
+ * number, so the signature is stable across the range-table layout
+ * of individual queries. It returns an invalid signature (keylen == 0)
+ * if any Param node is referenced.
+ */
+typedef struct
+{
+	PlannerInfo	   *root;
+	bool			has_param;
+	StringInfoData	buf;
+} feedback_signature_context;
+
+static bool
+__cardinality_feedback_signature_walker(Node *node,
+										feedback_signature_context *con)
+{
+	NodeTag		tag;
+
+	if (!node)
+		return false;
+	if (IsA(node, RestrictInfo))
+	{
+		RestrictInfo   *rinfo = (RestrictInfo *) node;
+
+		return __cardinality_feedback_signature_walker((Node *)rinfo->clause,
+													   con);
+	}
+	tag = nodeTag(node);
+	appendBinaryStringInfo(&con->buf, (char *)&tag, sizeof(NodeTag));
+
+	if (IsA(node, Var))
+	{
+		Var		   *var = (Var *) node;
+		PlannerInfo *root = con->root;
+		Oid			relid = InvalidOid;
+
+		if (var->varlevelsup == 0 &&
+			var->varno > 0 &&
+			var->varno < root->simple_rel_array_size)
+		{
+			RangeTblEntry *rte = root->simple_rte_array[var->varno];
+
+			if (rte && rte->rtekind == RTE_RELATION)
+				relid = rte->relid;
+		}
+		appendBinaryStringInfo(&con->buf, (char *)&relid, sizeof(Oid));
+		appendBinaryStringInfo(&con->buf, (char *)&var->varattno,
+							   sizeof(AttrNumber));
+		return false;
+	}
+	else if (IsA(node, Const))
+	{
+		Const	   *con_node = (Const *) node;
+
+		appendBinaryStringInfo(&con->buf, (char *)&con_node->consttype,
+							   sizeof(Oid));
+		if (con_node->constisnull)
+			appendStringInfoChar(&con->buf, 'N');
+		else if (con_node->constbyval)
+			appendBinaryStringInfo(&con->buf,
+								   (char *)&con_node->constvalue,
+								   sizeof(Datum));
+		else if (con_node->constlen > 0)
+			appendBinaryStringInfo(&con->buf,
+								   DatumGetPointer(con_node->constvalue),
+								   con_node->constlen);
+		else if (con_node->constlen == -1)
+		{
+			struct varlena *vl = (struct varlena *)
+				pg_detoast_datum_packed((struct varlena *)
+										DatumGetPointer(con_node->constvalue));
+
+			appendBinaryStringInfo(&con->buf,
+								   VARDATA_ANY(vl),
+								   VARSIZE_ANY_EXHDR(vl));
+		}
+		else
+			appendStringInfoString(&con->buf,
+								   DatumGetCString(con_node->constvalue));
+		return false;
+	}
+	else if (IsA(node, Param))
+	{
+		/* the value is not known on planning; no signature */
+		con->has_param = true;
+		return true;
+	}
+	else if (IsA(node, OpExpr) ||
+			 IsA(node, DistinctExpr) ||
+			 IsA(node, NullIfExpr))
+	{
+		OpExpr	   *op = (OpExpr *) node;
+
+		appendBinaryStringInfo(&con->buf, (char *)&op->opno, sizeof(Oid));
+	}
+	else if (IsA(node, ScalarArrayOpExpr))
+	{
+		ScalarArrayOpExpr *sa_op = (ScalarArrayOpExpr *) node;
+
+		appendBinaryStringInfo(&con->buf, (char *)&sa_op->opno, sizeof(Oid));
+		appendStringInfoChar(&con->buf, sa_op->useOr ? 'O' : 'A');
+	}
+	else if (IsA(node, FuncExpr))
+	{
+		FuncExpr   *func = (FuncExpr *) node;
+
+		appendBinaryStringInfo(&con->buf, (char *)&func->funcid, sizeof(Oid));
+	}
+	else if (IsA(node, BoolExpr))
+	{
+		BoolExpr   *b = (BoolExpr *) node;
+
+		appendBinaryStringInfo(&con->buf, (char *)&b->boolop,
+							   sizeof(BoolExprType));
+	}
+	else if (IsA(node, NullTest))
+	{
+		NullTest   *nt = (NullTest *) node;
+
+		appendBinaryStringInfo(&con->buf, (char *)&nt->nulltesttype,
+							   sizeof(NullTestType));
+	}
+	else if (IsA(node, BooleanTest))
+	{
+		BooleanTest *bt = (BooleanTest *) node;
+
+		appendBinaryStringInfo(&con->buf, (char *)&bt->booltesttype,
+							   sizeof(BoolTestType));
+	}
+	return expression_tree_walker(node,
+								  __cardinality_feedback_signature_walker,
+								  con);
+}
+
+pgstromFeedbackSignature
+pgstromCardinalityFeedbackSignature(PlannerInfo *root,
+									Relids relids,
+									List *exprs)
+{
+	feedback_signature_context con;
+	pgstromFeedbackSignature signature;
+	int			x = -1;
+
+	con.root = root;
+	con.has_param = false;
+	initStringInfo(&con.buf);
+	while ((x = bms_next_member(relids, x)) >= 0)
+	{
+		RangeTblEntry *rte;
+		RelOptInfo *rel;
+
+		if (x >= root->simple_rel_array_size)
+			continue;
+		rte = root->simple_rte_array[x];
+		if (!rte)
+			continue;
+		appendBinaryStringInfo(&con.buf, (char *)&rte->rtekind,
+							   sizeof(RTEKind));
+		appendBinaryStringInfo(&con.buf, (char *)&rte->relid,
+							   sizeof(Oid));
+		rel = root->simple_rel_array[x];
+		if (rel &&
+			__cardinality_feedback_signature_walker((Node *)
+													rel->baserestrictinfo,
+													&con))
+			break;
+	}
+	if (!con.has_param)
+		__cardinality_feedback_signature_walker((Node *)exprs, &con);
+
+	if (con.has_param || con.buf.len == 0)
+	{
+		signature.hash = 0;
+		signature.keylen = 0;		/* invalid signature */
+	}
+	else
+	{
+		signature.hash = DatumGetUInt64(hash_any_extended((const unsigned char *)
+														  con.buf.data,
+														  con.buf.len, 0));
+		signature.keylen = con.buf.len;
+	}
+	pfree(con.buf.data);
+
+	return signature;
+}
+
+/*
+ * pgstromFeedbackSignatureToList / pgstromFeedbackSignatureFromList
+ *
+ * (de-)serialization of the signature in the custom_private; the 64bit
+ * hash is split into two halves, because Value node has only 'int'.
+ */
+List *
+pgstromFeedbackSignatureToList(pgstromFeedbackSignature signature)
+{
+	return list_make3(makeInteger((cl_uint)(signature.hash >> 32)),
+					  makeInteger((cl_uint)(signature.hash & 0xffffffffUL)),
+					  makeInteger(signature.keylen));
+}
+
+pgstromFeedbackSignature
+pgstromFeedbackSignatureFromList(List *l)
+{
+	pgstromFeedbackSignature signature;
+
+	Assert(list_length(l) == 3);
+	signature.hash = (((cl_ulong)(cl_uint)intVal(linitial(l)) << 32) |
+					  ((cl_ulong)(cl_uint)intVal(lsecond(l))));
+	signature.keylen = (cl_uint)intVal(lthird(l));
+
+	return signature;
+}
+
+/*
+ * pgstromLookupCardinalityFeedback
+ *
+ * It returns the number of input/output rows observed by the earlier
+ * execution of the plan node with the supplied signature, if any.
+ */
+bool
+pgstromLookupCardinalityFeedback(pgstromFeedbackSignature signature,
+								 double *p_nrows_in,
+								 double *p_nrows_out)
+{
+	CardinalityFeedbackItem *items;
+	bool		found = false;
+	int			i;
+
+	/* feedback makes EXPLAIN output unstable in the regression test */
+	if (!cardinality_feedback ||
+		!pgstrom_enable_cardinality_feedback ||
+		pgstrom_regression_test_mode ||
+		signature.keylen == 0)
+		return false;
+
+	items = cardinality_feedback->items +
+		(signature.hash % (CARDINALITY_FEEDBACK_NSLOTS /
+						   CARDINALITY_FEEDBACK_NWAYS)) * CARDINALITY_FEEDBACK_NWAYS;
+	SpinLockAcquire(&cardinality_feedback->lock);
+	for (i=0; i < CARDINALITY_FEEDBACK_NWAYS; i++)
+	{
+		if (items[i].database_oid == MyDatabaseId &&
+			items[i].sig_hash == signature.hash &&
+			items[i].sig_keylen == signature.keylen)
+		{
+			*p_nrows_in  = items[i].nrows_in;
+			*p_nrows_out = items[i].nrows_out;
+			found = true;
+			break;
+		}
+	}
+	SpinLockRelease(&cardinality_feedback->lock);
+
+	return found;
+}
+
+/*
+ * pgstromUpdateCardinalityFeedback
+ *
+ * It records the number of input/output rows of the plan node. The new
+ * observation is blended with the recorded value by the half weight; that
+ * is an exponential moving average, to follow the changes of the data but
+ * not to be swayed by a particular execution.
+ */
+void
+pgstromUpdateCardinalityFeedback(pgstromFeedbackSignature signature,
+								 double nrows_in,
+								 double nrows_out)
+{
+	CardinalityFeedbackItem *items;
+	CardinalityFeedbackItem *item = NULL;
+	TimestampTz	now = GetCurrentTimestamp();
+	int			i;
+
+	if (!cardinality_feedback ||
+		!pgstrom_enable_cardinality_feedback ||
+		signature.keylen == 0)
+		return;
+
+	items = cardinality_feedback->items +
+		(signature.hash % (CARDINALITY_FEEDBACK_NSLOTS /
+						   CARDINALITY_FEEDBACK_NWAYS)) * CARDINALITY_FEEDBACK_NWAYS;
+	SpinLockAcquire(&cardinality_feedback->lock);
+	for (i=0; i < CARDINALITY_FEEDBACK_NWAYS; i++)
+	{
+		if (items[i].database_oid == MyDatabaseId &&
+			items[i].sig_hash == signature.hash &&
+			items[i].sig_keylen == signature.keylen)
+		{
+			item = &items[i];
+			item->nrows_in  = (item->nrows_in  + nrows_in)  / 2.0;
+			item->nrows_out = (item->nrows_out + nrows_out) / 2.0;
+			item->nsamples++;
+			item->last_update = now;
+			break;
+		}
+		if (!item ||
+			!OidIsValid(items[i].database_oid) ||
+			(OidIsValid(item->database_oid) &&
+			 items[i].last_update < item->last_update))
+			item = &items[i];
+	}
+	if (i == CARDINALITY_FEEDBACK_NWAYS)
+	{
+		/* replace the unused or the oldest item */
+		item->database_oid = MyDatabaseId;
+		item->sig_hash = signature.hash;
+		item->sig_keylen = signature.keylen;
+		item->nsamples = 1;
+		item->nrows_in = nrows_in;
+		item->nrows_out = nrows_out;
+		item->last_update = now;
+	}
+	SpinLockRelease(&cardinality_feedback->lock);
+}
+
+/*
+ * pgstrom_startup_feedback
+ */
+static void
+pgstrom_startup_feedback(void)
+{
+	bool		found;
+
+	if (shmem_startup_next)
+		(*shmem_startup_next)();
+
+	cardinality_feedback = ShmemInitStruct("PG-Strom Cardinality Feedback",
+										   sizeof(CardinalityFeedbackHead),
+										   &found);
+	if (found)
+		elog(ERROR, "Bug? PG-Strom Cardinality Feedback exists");
+	memset(cardinality_feedback, 0, sizeof(CardinalityFeedbackHead));
+	SpinLockInit(&cardinality_feedback->lock);
+}
+
+/*
+ * pgstrom_init_feedback
+ */
+void
+pgstrom_init_feedback(void)
+{
+	/* pg_strom.cardinality_feedback */
+	DefineCustomBoolVariable("pg_strom.cardinality_feedback",
+							 "Enables to use the number of rows observed by the earlier execution for planning",
+							 NULL,
+							 &pgstrom_enable_cardinality_feedback,
+							 false,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	RequestAddinShmemSpace(MAXALIGN(sizeof(CardinalityFeedbackHead)));
+	shmem_startup_next = shmem_startup_hook;
+	shmem_startup_hook = pgstrom_startup_feedback;
+}
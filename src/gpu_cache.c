@@ -55,6 +55,34 @@ typedef struct
 	} bgworkers[FLEXIBLE_ARRAY_MEMBER];
 } GpuCacheSharedHead;
 
+/*
+ * GpuCacheStatistics - cumulative statistics per GPU cache
+ *
+ * apply_hist[] is a histogram of the REDO apply latency; bucket-0 is less
+ * than 1ms, then every bucket covers 4 times wider range than the previous
+ * one, and the last bucket is 4sec or longer.
+ */
+#define GPUCACHE_STAT_NBUCKETS		8
+
+typedef struct
+{
+	pg_atomic_uint64	scan_cached;		/* # of scans on the GPU cache */
+	pg_atomic_uint64	scan_fallback;		/* # of scans fallen back to heap */
+	pg_atomic_uint64	apply_count;
+	pg_atomic_uint64	apply_nitems;
+	pg_atomic_uint64	apply_time;			/* in us */
+	pg_atomic_uint64	apply_hist[GPUCACHE_STAT_NBUCKETS];
+	pg_atomic_uint64	compaction_count;
+	pg_atomic_uint64	compaction_time;	/* in us */
+	pg_atomic_uint64	lock_wait_count;
+	pg_atomic_uint64	lock_wait_time;		/* in us */
+	pg_atomic_uint64	redo_overflow;		/* # of REDO buffer full */
+	pg_atomic_uint64	load_nblocks;		/* # of blocks to be loaded */
+	pg_atomic_uint64	load_blocks;		/* # of blocks already loaded */
+	pg_atomic_uint64	load_nitems;		/* # of rows already loaded */
+	pg_atomic_uint64	load_time;			/* in us */
+} GpuCacheStatistics;
+
 /*
  * GpuCacheSharedState (shared structure; dynamic portable)
  */
@@ -88,12 +116,19 @@ typedef struct
 	slock_t			redo_lock;
 	uint64			redo_write_timestamp;
 	uint64			redo_write_nitems;
-	uint64			redo_write_pos;
+	uint64			redo_write_pos;		/* end of the REDO logs written */
+	uint64			redo_reserve_pos;	/* end of the area reserved by
+										 * backends, but may be copying */
 	uint64			redo_read_nitems;
 	uint64			redo_read_pos;
 	uint64			redo_sync_pos;
+	uint64			redo_scan_timestamp;	/* last scan on the GPU cache */
+	uint64			redo_load_timestamp;	/* last initial loading */
 	char		   *redo_buffer;
 
+	/* cumulative statistics */
+	GpuCacheStatistics stats;
+
 	/* schema definitions (KDS_FORMAT_COLUMN) */
 	size_t			kds_extra_sz;
 	kern_data_store	kds_head;
@@ -113,8 +148,16 @@ typedef struct
 	bool			drop_on_commit;
 	uint32			nitems;
 	StringInfoData	buf;		/* array of PendingCtidItem */
+	StringInfoData	redo_batch;	/* REDO logs not written to the shared buffer */
 } GpuCacheDesc;
 
+/*
+ * REDO logs are once accumulated on the per-backend batch buffer, then
+ * written to the shared REDO buffer at once, to reduce the number of
+ * spinlock acquisition on bulk-loading (like COPY FROM).
+ */
+#define GPUCACHE_REDO_BATCH_SIZE	(256UL << 10)	/* 256kB */
+
 typedef struct
 {
 	char			tag;
@@ -138,6 +181,7 @@ static CUfunction	gcache_kfunc_compaction = NULL;
 /* --- function declarations --- */
 static bool		__gpuCacheAppendLog(GpuCacheDesc *gc_desc,
 									GCacheTxLogCommon *tx_log);
+static bool		__gpuCacheFlushRedoBatch(GpuCacheDesc *gc_desc);
 
 static CUresult gpuCacheInvokeApplyRedo(GpuCacheSharedState *gc_sstate,
 										uint64 end_pos,
@@ -152,6 +196,8 @@ PG_FUNCTION_INFO_V1(pgstrom_gpucache_apply_redo);
 PG_FUNCTION_INFO_V1(pgstrom_gpucache_compaction);
 PG_FUNCTION_INFO_V1(pgstrom_gpucache_recovery);
 PG_FUNCTION_INFO_V1(pgstrom_gpucache_info);
+PG_FUNCTION_INFO_V1(pgstrom_gpucache_stat);
+PG_FUNCTION_INFO_V1(pgstrom_gpucache_export_ipchandle);
 
 /*
  * gpucache_sync_trigger_function_oid
@@ -206,20 +252,33 @@ typedef struct
 	size_t		gpu_sync_threshold;
 	int64		max_num_rows;
 	size_t		redo_buffer_size;
+	bool		partial_columns;	/* true, if some columns are not cached */
+	bits8		cached_attrs[(MaxHeapAttributeNumber +
+							  BITS_PER_BYTE - 1) / BITS_PER_BYTE];
 } GpuCacheOptions;
 
+#define GPUCACHE_ATTR_IS_CACHED(gc_options,anum)						\
+	(((gc_options)->cached_attrs[((anum)-1) / BITS_PER_BYTE] &			\
+	  (1 << (((anum)-1) % BITS_PER_BYTE))) != 0)
+
 static bool
-__parseSyncTriggerOptions(const char *__config, GpuCacheOptions *gc_options)
+__parseSyncTriggerOptions(const char *__config,
+						  TupleDesc tupdesc,
+						  GpuCacheOptions *gc_options)
 {
 	int			cuda_dindex = 0;				/* default: GPU0 */
 	int			gpu_sync_interval = 5000000L;	/* default: 5sec = 5000000us */
 	ssize_t		gpu_sync_threshold = -1;		/* default: auto */
 	int64		max_num_rows = (10UL << 20);	/* default: 10M rows */
 	ssize_t		redo_buffer_size = (160UL << 20);	/* default: 160MB */
+	bool		partial_columns = false;		/* default: all the columns */
+	bits8		cached_attrs[(MaxHeapAttributeNumber +
+							  BITS_PER_BYTE - 1) / BITS_PER_BYTE];
 	char	   *config;
 	char	   *key, *value;
 	char	   *saved;
 
+	memset(cached_attrs, ~0, sizeof(cached_attrs));
 	if (!__config)
 		goto out;
 	config = alloca(strlen(__config) + 1);
@@ -343,6 +402,45 @@ __parseSyncTriggerOptions(const char *__config, GpuCacheOptions *gc_options)
 				return false;
 			}
 		}
+		else if (strcmp(key, "columns") == 0)
+		{
+			char   *name;
+			char   *__saved;
+			int		j;
+
+			/* columns=NAME1 NAME2 ... (delimited by space) */
+			memset(cached_attrs, 0, sizeof(cached_attrs));
+			for (name = strtok_r(value, " \t", &__saved);
+				 name != NULL;
+				 name = strtok_r(NULL,  " \t", &__saved))
+			{
+				for (j=0; j < tupdesc->natts; j++)
+				{
+					Form_pg_attribute attr = tupleDescAttr(tupdesc, j);
+
+					if (!attr->attisdropped &&
+						strcmp(NameStr(attr->attname), name) == 0)
+					{
+						cached_attrs[j / BITS_PER_BYTE] |= (1 << (j % BITS_PER_BYTE));
+						break;
+					}
+				}
+				if (j == tupdesc->natts)
+				{
+					elog(WARNING, "gpucache: column '%s' in 'columns' option not found",
+						 name);
+					return false;
+				}
+			}
+			for (j=0; j < tupdesc->natts; j++)
+			{
+				Form_pg_attribute attr = tupleDescAttr(tupdesc, j);
+
+				if (!attr->attisdropped &&
+					(cached_attrs[j / BITS_PER_BYTE] & (1 << (j % BITS_PER_BYTE))) == 0)
+					partial_columns = true;
+			}
+		}
 		else
 		{
 			elog(WARNING, "gpucache: unknown option [%s]=[%s]", key, value);
@@ -363,6 +461,36 @@ out:
 		gc_options->gpu_sync_threshold = gpu_sync_threshold;
 		gc_options->max_num_rows      = max_num_rows;
 		gc_options->redo_buffer_size  = redo_buffer_size;
+		gc_options->partial_columns   = partial_columns;
+		memcpy(gc_options->cached_attrs, cached_attrs, sizeof(cached_attrs));
+	}
+	return true;
+}
+
+/*
+ * gpuCacheCoversReferencedAttrs
+ *
+ * It checks whether all the referenced columns (offset by
+ * FirstLowInvalidHeapAttributeNumber) are kept on the GPU cache.
+ */
+static bool
+gpuCacheCoversReferencedAttrs(GpuCacheOptions *gc_options,
+							  Bitmapset *referenced)
+{
+	int		k;
+
+	if (!gc_options->partial_columns)
+		return true;
+	for (k = bms_next_member(referenced, -1);
+		 k >= 0;
+		 k = bms_next_member(referenced, k))
+	{
+		AttrNumber	anum = k + FirstLowInvalidHeapAttributeNumber;
+
+		if (anum < 0)
+			continue;		/* system columns */
+		if (anum == 0 || !GPUCACHE_ATTR_IS_CACHED(gc_options, anum))
+			return false;	/* whole-row or uncached column */
 	}
 	return true;
 }
@@ -437,10 +565,10 @@ __gpuCacheTableSignature(Relation rel, GpuCacheTableSignatureCache *entry)
 			if (OidIsValid(sig->gc_options.tg_sync_row))
 				goto no_gpu_cache;		/* should not call trigger twice per row */
 			if ((trig->tgnargs == 0 &&
-				 __parseSyncTriggerOptions(NULL,
+				 __parseSyncTriggerOptions(NULL, tupdesc,
 										   &sig->gc_options)) ||
 				(trig->tgnargs == 1 &&
-				 __parseSyncTriggerOptions(trig->tgargs[0],
+				 __parseSyncTriggerOptions(trig->tgargs[0], tupdesc,
 										   &sig->gc_options)))
 			{
 				sig->gc_options.tg_sync_row = trig->tgoid;
@@ -525,6 +653,7 @@ __gpuCacheTableSignatureSnapshot(HeapTuple pg_class_tuple,
 	GpuCacheTableSignatureBuffer *sig;
 	Form_pg_class pg_class = (Form_pg_class) GETSTRUCT(pg_class_tuple);
 	Oid			table_oid = PgClassTupleGetOid(pg_class_tuple);
+	TupleDesc	tupdesc;
 	Relation	srel;
 	ScanKeyData	skey[2];
 	SysScanDesc	sscan;
@@ -548,6 +677,35 @@ __gpuCacheTableSignatureSnapshot(HeapTuple pg_class_tuple,
 	sig->relfilenode    = pg_class->relfilenode;
 	sig->relnatts       = pg_class->relnatts;
 
+	/* pg_attribute */
+	tupdesc = CreateTemplateTupleDesc(pg_class->relnatts);
+	srel = table_open(AttributeRelationId, AccessShareLock);
+	ScanKeyInit(&skey[0],
+				Anum_pg_attribute_attrelid,
+				BTEqualStrategyNumber, F_OIDEQ,
+				ObjectIdGetDatum(table_oid));
+	ScanKeyInit(&skey[1],
+				Anum_pg_attribute_attnum,
+				BTGreaterStrategyNumber, F_INT2GT,
+				Int16GetDatum(0));
+	sscan = systable_beginscan(srel, AttributeRelidNumIndexId,
+							   true, snapshot, 2, skey);
+	while ((tuple = systable_getnext(sscan)) != NULL)
+	{
+		Form_pg_attribute attr = (Form_pg_attribute) GETSTRUCT(tuple);
+
+		Assert(attr->attnum > 0 && attr->attnum <= sig->relnatts);
+		j = attr->attnum - 1;
+		sig->attrs[j].atttypid  = attr->atttypid;
+		sig->attrs[j].atttypmod = attr->atttypmod;
+		sig->attrs[j].attnotnull = attr->attnotnull;
+		sig->attrs[j].attisdropped = attr->attisdropped;
+		/* attribute names are referenced by 'columns' option */
+		memcpy(tupleDescAttr(tupdesc, j), attr, ATTRIBUTE_FIXED_PART_SIZE);
+	}
+	systable_endscan(sscan);
+	table_close(srel, AccessShareLock);
+
 	/* pg_trigger */
 	srel = table_open(TriggerRelationId, AccessShareLock);
 	ScanKeyInit(&skey[0],
@@ -575,7 +733,8 @@ __gpuCacheTableSignatureSnapshot(HeapTuple pg_class_tuple,
 				goto no_gpu_cache;
 			if (pg_trig->tgnargs == 0)
 			{
-				if (!__parseSyncTriggerOptions(NULL, &sig->gc_options))
+				if (!__parseSyncTriggerOptions(NULL, tupdesc,
+											   &sig->gc_options))
 					goto no_gpu_cache;
 			}
 			else if (pg_trig->tgnargs == 1)
@@ -587,7 +746,7 @@ __gpuCacheTableSignatureSnapshot(HeapTuple pg_class_tuple,
 									RelationGetDescr(srel), &isnull);
 				if (isnull)
 					goto no_gpu_cache;
-				if (!__parseSyncTriggerOptions(VARDATA_ANY(datum),
+				if (!__parseSyncTriggerOptions(VARDATA_ANY(datum), tupdesc,
 											   &sig->gc_options))
 					goto no_gpu_cache;
 			}
@@ -617,32 +776,6 @@ __gpuCacheTableSignatureSnapshot(HeapTuple pg_class_tuple,
 	systable_endscan(sscan);
 	table_close(srel, AccessShareLock);
 
-	/* pg_attribute */
-	srel = table_open(AttributeRelationId, AccessShareLock);
-	ScanKeyInit(&skey[0],
-				Anum_pg_attribute_attrelid,
-				BTEqualStrategyNumber, F_OIDEQ,
-				ObjectIdGetDatum(table_oid));
-	ScanKeyInit(&skey[1],
-				Anum_pg_attribute_attnum,
-				BTGreaterStrategyNumber, F_INT2GT,
-				Int16GetDatum(0));
-	sscan = systable_beginscan(srel, AttributeRelidNumIndexId,
-							   true, snapshot, 2, skey);
-	while ((tuple = systable_getnext(sscan)) != NULL)
-	{
-		Form_pg_attribute attr = (Form_pg_attribute) GETSTRUCT(tuple);
-
-		Assert(attr->attnum > 0 && attr->attnum <= sig->relnatts);
-		j = attr->attnum - 1;
-		sig->attrs[j].atttypid  = attr->atttypid;
-		sig->attrs[j].atttypmod = attr->atttypmod;
-		sig->attrs[j].attnotnull = attr->attnotnull;
-		sig->attrs[j].attisdropped = attr->attisdropped;
-	}
-	systable_endscan(sscan);
-	table_close(srel, AccessShareLock);
-
 	if (gc_options)
 		memcpy(gc_options, &sig->gc_options, sizeof(GpuCacheOptions));
 	return hash_any((unsigned char *)sig, len) | 0x100000000UL;
@@ -693,6 +826,8 @@ gpuCacheTableSignatureInvalidation(Oid table_oid)
 {
 	hash_search(gcache_signatures_htab,
 				&table_oid, HASH_REMOVE, NULL);
+	/* also, IPC mappings of the GPU cache buffers */
+	gpuIpcInvalidateMemHandleCached(MyDatabaseId, table_oid);
 }
 
 /*
@@ -733,6 +868,23 @@ baseRelHasGpuCache(PlannerInfo *root, RelOptInfo *baserel)
 		Assert(entry->table_oid == rte->relid);
 
 		retval = (entry->signature != 0UL);
+		if (retval && entry->gc_options.partial_columns)
+		{
+			Bitmapset  *referenced = NULL;
+			ListCell   *lc;
+
+			/* GPU cache must keep all the referenced columns */
+			foreach (lc, baserel->baserestrictinfo)
+			{
+				RestrictInfo   *rinfo = lfirst(lc);
+
+				pull_varattnos((Node *)rinfo->clause, baserel->relid,
+							   &referenced);
+			}
+			referenced = pgstrom_pullup_outer_refs(root, baserel, referenced);
+			retval = gpuCacheCoversReferencedAttrs(&entry->gc_options,
+												   referenced);
+		}
 	}
 	return (enable_gpucache ? retval : false);
 }
@@ -1021,6 +1173,7 @@ __gpuCacheInitLoadTrackCtid(GpuCacheDesc *gc_desc,
 			__gc_temp->drop_on_commit = false;
 			__gc_temp->nitems = 0;
 			memset(&__gc_temp->buf, 0, sizeof(StringInfoData));
+			memset(&__gc_temp->redo_batch, 0, sizeof(StringInfoData));
 		}
 		gc_desc = __gc_temp;
 	}
@@ -1129,8 +1282,13 @@ __execGpuCacheInitLoad(GpuCacheSharedState *gc_sstate, Relation rel)
 {
 	GpuCacheDesc	hkey;
 	GpuCacheDesc   *gc_desc;
+	GpuCacheStatistics *stats = &gc_sstate->stats;
 	TableScanDesc	scandesc;
 	HeapTuple		scantup;
+	BlockNumber		curr_blkno = InvalidBlockNumber;
+	uint64			nblocks = 0;
+	uint64			nitems = 0;
+	TimestampTz		tv_start;
 	size_t			item_sz = 2048;
 	GCacheTxLogInsert *item = palloc(item_sz);
 	bool			found = false;
@@ -1158,6 +1316,7 @@ __execGpuCacheInitLoad(GpuCacheSharedState *gc_sstate, Relation rel)
 		gc_desc->drop_on_commit = false;
 		gc_desc->nitems = 0;
 		memset(&gc_desc->buf, 0, sizeof(StringInfoData));
+		memset(&gc_desc->redo_batch, 0, sizeof(StringInfoData));
 	}
 	else if (!gc_desc->gc_sstate)
 	{
@@ -1175,16 +1334,30 @@ __execGpuCacheInitLoad(GpuCacheSharedState *gc_sstate, Relation rel)
 	}
 
 	/* rewind the position of REDO log buffer */
+	tv_start = GetCurrentTimestamp();
 	SpinLockAcquire(&gc_sstate->redo_lock);
+	gc_sstate->redo_load_timestamp  = tv_start;
 	gc_sstate->redo_write_timestamp = 0;
 	gc_sstate->redo_write_nitems    = 0;
 	gc_sstate->redo_write_pos       = 0;
+	gc_sstate->redo_reserve_pos     = 0;
 	gc_sstate->redo_read_nitems     = 0;
 	gc_sstate->redo_read_pos        = 0;
 	gc_sstate->redo_sync_pos        = 0;
 	SpinLockRelease(&gc_sstate->redo_lock);
 
 	scandesc = table_beginscan(rel, SnapshotAny, 0, NULL);
+	/*
+	 * progress of the initial loading, for pgstrom.gpucache_stat; it is
+	 * updated per block, not to put atomic operations for each row.
+	 * Blocks are counted rather than the block number, because the
+	 * synchronized scan may start in the middle of the table.
+	 */
+	pg_atomic_write_u64(&stats->load_nblocks,
+						((HeapScanDesc) scandesc)->rs_nblocks);
+	pg_atomic_write_u64(&stats->load_blocks, 0);
+	pg_atomic_write_u64(&stats->load_nitems, 0);
+	pg_atomic_write_u64(&stats->load_time, 0);
 	while ((scantup = heap_getnext(scandesc, ForwardScanDirection)) != NULL)
 	{
 		TransactionId	gcache_xmin;
@@ -1192,6 +1365,18 @@ __execGpuCacheInitLoad(GpuCacheSharedState *gc_sstate, Relation rel)
 		HeapTuple		tuple;
 		size_t			sz;
 
+		if (((HeapScanDesc) scandesc)->rs_cblock != curr_blkno)
+		{
+			curr_blkno = ((HeapScanDesc) scandesc)->rs_cblock;
+			if (nblocks > 0)
+			{
+				pg_atomic_write_u64(&stats->load_blocks, nblocks);
+				pg_atomic_write_u64(&stats->load_nitems, nitems);
+				pg_atomic_write_u64(&stats->load_time,
+									GetCurrentTimestamp() - tv_start);
+			}
+			nblocks++;
+		}
 		if (!__gpuCacheInitLoadVisibilityCheck(scantup,
 											   &gcache_xmin,
 											   &gcache_xmax))
@@ -1221,13 +1406,59 @@ __execGpuCacheInitLoad(GpuCacheSharedState *gc_sstate, Relation rel)
 			__gpuCacheInitLoadTrackCtid(gc_desc, gcache_xmax, 'D', &tuple->t_self);
 		if (tuple != scantup)
 			pfree(tuple);
+		nitems++;
 		CHECK_FOR_INTERRUPTS();
 	}
 	table_endscan(scandesc);
+	__gpuCacheFlushRedoBatch(gc_desc);
+	pg_atomic_write_u64(&stats->load_blocks, nblocks);
+	pg_atomic_write_u64(&stats->load_nitems, nitems);
+	pg_atomic_write_u64(&stats->load_time, GetCurrentTimestamp() - tv_start);
 
 	pfree(item);
 }
 
+/*
+ * gpuCacheStatInit / gpuCacheStatUpdateApply
+ */
+static void
+gpuCacheStatInit(GpuCacheStatistics *stats)
+{
+	int		k;
+
+	pg_atomic_init_u64(&stats->scan_cached, 0);
+	pg_atomic_init_u64(&stats->scan_fallback, 0);
+	pg_atomic_init_u64(&stats->apply_count, 0);
+	pg_atomic_init_u64(&stats->apply_nitems, 0);
+	pg_atomic_init_u64(&stats->apply_time, 0);
+	for (k=0; k < GPUCACHE_STAT_NBUCKETS; k++)
+		pg_atomic_init_u64(&stats->apply_hist[k], 0);
+	pg_atomic_init_u64(&stats->compaction_count, 0);
+	pg_atomic_init_u64(&stats->compaction_time, 0);
+	pg_atomic_init_u64(&stats->lock_wait_count, 0);
+	pg_atomic_init_u64(&stats->lock_wait_time, 0);
+	pg_atomic_init_u64(&stats->redo_overflow, 0);
+	pg_atomic_init_u64(&stats->load_nblocks, 0);
+	pg_atomic_init_u64(&stats->load_blocks, 0);
+	pg_atomic_init_u64(&stats->load_nitems, 0);
+	pg_atomic_init_u64(&stats->load_time, 0);
+}
+
+static void
+gpuCacheStatUpdateApply(GpuCacheStatistics *stats,
+						uint64 nitems, uint64 elapsed)
+{
+	uint64	limit = 1000;		/* 1ms */
+	int		k;
+
+	for (k=0; k < GPUCACHE_STAT_NBUCKETS-1 && elapsed >= limit; k++)
+		limit *= 4;
+	pg_atomic_fetch_add_u64(&stats->apply_count, 1);
+	pg_atomic_fetch_add_u64(&stats->apply_nitems, nitems);
+	pg_atomic_fetch_add_u64(&stats->apply_time, elapsed);
+	pg_atomic_fetch_add_u64(&stats->apply_hist[k], 1);
+}
+
 /*
  * __createGpuCacheSharedState
  */
@@ -1269,6 +1500,7 @@ __createGpuCacheSharedState(Relation rel,
 	pthreadRWLockInit(&gc_sstate->gpu_buffer_lock);
 	pg_atomic_init_u32(&gc_sstate->gpu_buffer_corrupted, 0);
 	SpinLockInit(&gc_sstate->redo_lock);
+	gpuCacheStatInit(&gc_sstate->stats);
 	gc_sstate->redo_buffer = (char *)gc_sstate + MAXALIGN(sz);
 
 	/* init schema definition in KDS_FORMAT_COLUMN */
@@ -1287,6 +1519,9 @@ __createGpuCacheSharedState(Relation rel,
 		Form_pg_attribute attr = tupleDescAttr(tupdesc, j);
 
 		cmeta = &kds_head->colmeta[j];
+		/* columns out of 'columns' option have neither nullmap nor values */
+		if (!GPUCACHE_ATTR_IS_CACHED(gc_options, attr->attnum))
+			continue;
 		if (!attr->attnotnull)
 		{
 			sz = MAXALIGN(BITMAPLEN(nrooms));
@@ -1509,6 +1744,7 @@ __lookupGpuCacheDescCommon(GpuCacheDesc *hkey,
 		gc_desc->drop_on_commit = false;
 		gc_desc->nitems = 0;
 		memset(&gc_desc->buf, 0, sizeof(StringInfoData));
+		memset(&gc_desc->redo_batch, 0, sizeof(StringInfoData));
 
 		gc_desc->gc_sstate = __lookupGpuCacheSharedState(hkey, rel, gc_options, false);
 	}
@@ -1587,6 +1823,7 @@ releaseGpuCacheDesc(GpuCacheDesc *gc_desc, bool is_normal_commit)
 				tag = (is_normal_commit ? pitem->tag : tolower(pitem->tag));
 				x_log.type   = GCACHE_TX_LOG__XACT;
 				x_log.length = sizeof(GCacheTxLogXact);
+				x_log.xid    = gc_desc->xid;
 				x_log.rowid  = UINT_MAX;
 				x_log.rowid_found = false;
 				x_log.tag    = tag;
@@ -1597,6 +1834,7 @@ releaseGpuCacheDesc(GpuCacheDesc *gc_desc, bool is_normal_commit)
 					break;
 				pos += sizeof(PendingCtidItem);
 			}
+			__gpuCacheFlushRedoBatch(gc_desc);
 			elog(DEBUG2, "AddXactLog: %s:%lx xid=%u nitems=%u",
 				 gc_sstate->table_name,
 				 gc_sstate->signature,
@@ -1607,82 +1845,224 @@ releaseGpuCacheDesc(GpuCacheDesc *gc_desc, bool is_normal_commit)
 	}
 	if (gc_desc->buf.data)
 		pfree(gc_desc->buf.data);
+	if (gc_desc->redo_batch.data)
+		pfree(gc_desc->redo_batch.data);
 	hash_search(gcache_descriptors_htab, gc_desc, HASH_REMOVE, NULL);
 }
 
 /*
- * __gpuCacheAppendLog
+ * __gpuCacheReserveRedoBufferNoLock
+ *
+ * It reserves an area of the shared REDO buffer for the REDO logs in the
+ * batch buffer (from the 'index'), as much as possible. Caller must hold
+ * the redo_lock; however, copy of the REDO logs can be done without the
+ * lock. It returns the end of the batch buffer reserved.
  */
-static bool
-__gpuCacheAppendLog(GpuCacheDesc *gc_desc, GCacheTxLogCommon *tx_log)
+static int
+__gpuCacheReserveRedoBufferNoLock(GpuCacheSharedState *gc_sstate,
+								  StringInfo batch, int index,
+								  uint64 *p_nitems)
+{
+	size_t		buffer_sz = gc_sstate->redo_buffer_size;
+	uint64		limit_pos = gc_sstate->redo_read_pos + buffer_sz;
+	uint64		curr_pos = gc_sstate->redo_reserve_pos;
+	uint64		nitems = 0;
+
+	Assert(gc_sstate->redo_write_pos >= gc_sstate->redo_read_pos &&
+		   gc_sstate->redo_reserve_pos >= gc_sstate->redo_write_pos &&
+		   gc_sstate->redo_reserve_pos <= limit_pos &&
+		   gc_sstate->redo_sync_pos >= gc_sstate->redo_read_pos &&
+		   gc_sstate->redo_sync_pos <= gc_sstate->redo_write_pos);
+	while (index < batch->len)
+	{
+		GCacheTxLogCommon *tx_log = (GCacheTxLogCommon *)
+			(batch->data + index);
+		uint64		next_pos = curr_pos;
+		uint64		offset = next_pos % buffer_sz;
+
+		/* rewind to the head */
+		if (offset + tx_log->length > buffer_sz)
+			next_pos += (buffer_sz - offset);
+		/* check overwrites */
+		next_pos += tx_log->length;
+		if (next_pos > limit_pos)
+			break;
+		curr_pos = next_pos;
+		index += tx_log->length;
+		nitems++;
+	}
+	gc_sstate->redo_reserve_pos = curr_pos;
+	*p_nitems = nitems;
+
+	return index;
+}
+
+/*
+ * __gpuCacheCopyRedoBatch
+ *
+ * It copies the REDO logs in the batch buffer (from 'index' to 'until') to
+ * the area of the shared REDO buffer; already reserved from 'curr_pos'.
+ */
+static void
+__gpuCacheCopyRedoBatch(GpuCacheSharedState *gc_sstate,
+						StringInfo batch, int index, int until,
+						uint64 curr_pos)
 {
-	GpuCacheSharedState *gc_sstate = gc_desc->gc_sstate;
 	char	   *redo_buffer = gc_sstate->redo_buffer;
 	size_t		buffer_sz = gc_sstate->redo_buffer_size;
-	uint64		offset;
+
+	while (index < until)
+	{
+		GCacheTxLogCommon *tx_log = (GCacheTxLogCommon *)
+			(batch->data + index);
+		uint64		offset = curr_pos % buffer_sz;
+
+		if (offset + tx_log->length > buffer_sz)
+		{
+			/* fill-up by zero, then rewind to the head */
+			memset(redo_buffer + offset, 0, buffer_sz - offset);
+			curr_pos += (buffer_sz - offset);
+			offset = 0;
+		}
+		memcpy(redo_buffer + offset, tx_log, tx_log->length);
+		curr_pos += tx_log->length;
+		index += tx_log->length;
+	}
+}
+
+/*
+ * __gpuCacheFlushRedoBatch
+ *
+ * It writes out the REDO logs accumulated on the batch buffer of the
+ * GpuCacheDesc. The redo_lock is held only to reserve an area of the
+ * shared REDO buffer and to publish it; the REDO logs are copied without
+ * the lock, so concurrent backends can copy their own batches at the same
+ * time. The reserved areas are published in the order of reservation,
+ * because readers assume all the area until redo_write_pos is valid.
+ * If shared REDO buffer has no space, it synchronously applies the pending
+ * REDO logs to make a room, instead of polling.
+ */
+static bool
+__gpuCacheFlushRedoBatch(GpuCacheDesc *gc_desc)
+{
+	GpuCacheSharedState *gc_sstate = gc_desc->gc_sstate;
+	StringInfo	batch = &gc_desc->redo_batch;
+	uint64		head_pos, tail_pos;
+	uint64		nitems;
 	uint64		sync_pos;
-	bool		append_done = false;
+	int			index = 0;
+	int			until;
 
-	Assert(tx_log->length == MAXALIGN(tx_log->length));
-	for (;;)
+	while (index < batch->len)
 	{
 		/*
 		 * Once GPU buffer is marked to 'corrupted', any following REDO-logs
 		 * make no sense, until pgstrom.gpucache_recovery() is called.
 		 */
 		if (pg_atomic_read_u32(&gc_sstate->gpu_buffer_corrupted))
+		{
+			resetStringInfo(batch);
 			return false;
+		}
 
+		/* reservation */
 		SpinLockAcquire(&gc_sstate->redo_lock);
-		Assert(gc_sstate->redo_write_pos >= gc_sstate->redo_read_pos &&
-			   gc_sstate->redo_write_pos <= gc_sstate->redo_read_pos + buffer_sz &&
-			   gc_sstate->redo_sync_pos >= gc_sstate->redo_read_pos &&
-			   gc_sstate->redo_sync_pos <= gc_sstate->redo_write_pos);
-		offset = gc_sstate->redo_write_pos % buffer_sz;
-		/* rewind to the head */
-		if (offset + tx_log->length > buffer_sz)
+		head_pos = gc_sstate->redo_reserve_pos;
+		until = __gpuCacheReserveRedoBufferNoLock(gc_sstate, batch, index,
+												  &nitems);
+		tail_pos = gc_sstate->redo_reserve_pos;
+		SpinLockRelease(&gc_sstate->redo_lock);
+
+		/* copy without lock */
+		if (nitems > 0)
+			__gpuCacheCopyRedoBatch(gc_sstate, batch, index, until, head_pos);
+
+		/* publish, after the preceding reservations are published */
+		for (;;)
 		{
-			size_t	sz = buffer_sz - offset;
-
-			/* oops, it looks overwrites... */
-			if (gc_sstate->redo_write_pos + sz > gc_sstate->redo_read_pos + buffer_sz)
-				goto skip;
-			/* fill-up by zero */
-			memset(redo_buffer + offset, 0, sz);
-			gc_sstate->redo_write_pos += sz;
-			offset = 0;
+			SpinLockAcquire(&gc_sstate->redo_lock);
+			if (gc_sstate->redo_write_pos == head_pos)
+				break;
+			SpinLockRelease(&gc_sstate->redo_lock);
+			pg_usleep(10L);
 		}
-		/* check overwrites */
-		if ((gc_sstate->redo_write_pos +
-			 tx_log->length) > gc_sstate->redo_read_pos + buffer_sz)
-			goto skip;
-
-		/* Ok, append the log item */
-		memcpy(redo_buffer + offset, tx_log, tx_log->length);
-		gc_sstate->redo_write_pos += tx_log->length;
-		gc_sstate->redo_write_nitems++;
-		gc_sstate->redo_write_timestamp = GetCurrentTimestamp();
-		append_done = true;
-	skip:
-		/* 25% of REDO buffer is in-use. Async kick of GPU kernel */
+		if (nitems > 0)
+		{
+			gc_sstate->redo_write_pos = tail_pos;
+			gc_sstate->redo_write_nitems += nitems;
+			gc_sstate->redo_write_timestamp = GetCurrentTimestamp();
+		}
+		/* 25% of REDO buffer is in-use. Kick of GPU kernel */
 		if (gc_sstate->redo_write_pos > (gc_sstate->redo_sync_pos +
 										 gc_sstate->gpu_sync_threshold))
 		{
 			sync_pos = gc_sstate->redo_sync_pos = gc_sstate->redo_write_pos;
 			SpinLockRelease(&gc_sstate->redo_lock);
-			gpuCacheInvokeApplyRedo(gc_sstate, sync_pos, true);
+			/* wait for completion, if we still have logs to be written */
+			if (until < batch->len)
+				pg_atomic_fetch_add_u64(&gc_sstate->stats.redo_overflow, 1);
+			gpuCacheInvokeApplyRedo(gc_sstate, sync_pos, until == batch->len);
 		}
 		else
 		{
 			SpinLockRelease(&gc_sstate->redo_lock);
+			if (until < batch->len)
+			{
+				pg_atomic_fetch_add_u64(&gc_sstate->stats.redo_overflow, 1);
+				pg_usleep(1000L);	/* 1ms wait */
+			}
 		}
-		if (append_done)
-			break;
-		pg_usleep(1000L);	/* 1ms wait */
+		index = until;
 	}
+	resetStringInfo(batch);
 	return true;
 }
 
+/*
+ * __gpuCacheAppendLog
+ */
+static bool
+__gpuCacheAppendLog(GpuCacheDesc *gc_desc, GCacheTxLogCommon *tx_log)
+{
+	GpuCacheSharedState *gc_sstate = gc_desc->gc_sstate;
+	size_t		batch_sz = Min(GPUCACHE_REDO_BATCH_SIZE,
+							   gc_sstate->gpu_sync_threshold / 2);
+
+	Assert(tx_log->length == MAXALIGN(tx_log->length));
+	if (pg_atomic_read_u32(&gc_sstate->gpu_buffer_corrupted))
+		return false;
+	if (!gc_desc->redo_batch.data)
+		initStringInfoContext(&gc_desc->redo_batch, CacheMemoryContext);
+	appendBinaryStringInfo(&gc_desc->redo_batch,
+						   (char *)tx_log, tx_log->length);
+	if (gc_desc->redo_batch.len >= batch_sz)
+		return __gpuCacheFlushRedoBatch(gc_desc);
+	return true;
+}
+
+/*
+ * gpuCacheFlushRedoBatchAll
+ *
+ * It writes out the REDO logs of the table kept in the local batch buffers,
+ * prior to the scan on the GPU cache; to make own writes visible.
+ */
+static void
+gpuCacheFlushRedoBatchAll(GpuCacheSharedState *gc_sstate)
+{
+	HASH_SEQ_STATUS	hseq;
+	GpuCacheDesc   *gc_desc;
+
+	if (hash_get_num_entries(gcache_descriptors_htab) == 0)
+		return;
+	hash_seq_init(&hseq, gcache_descriptors_htab);
+	while ((gc_desc = hash_seq_search(&hseq)) != NULL)
+	{
+		if (gc_desc->gc_sstate == gc_sstate &&
+			gc_desc->redo_batch.len > 0)
+			__gpuCacheFlushRedoBatch(gc_desc);
+	}
+}
+
 /*
  * __gpuCacheInsertLog
  */
@@ -1875,6 +2255,7 @@ pgstrom_gpucache_apply_redo(PG_FUNCTION_ARGS)
 		GpuCacheSharedState *gc_sstate = gc_desc->gc_sstate;
 		uint64		sync_pos;
 
+		__gpuCacheFlushRedoBatch(gc_desc);
 		SpinLockAcquire(&gc_sstate->redo_lock);
 		sync_pos = gc_sstate->redo_sync_pos = gc_sstate->redo_write_pos;
 		SpinLockRelease(&gc_sstate->redo_lock);
@@ -1941,6 +2322,72 @@ pgstrom_gpucache_recovery(PG_FUNCTION_ARGS)
 	PG_RETURN_INT32(retval);
 }
 
+/*
+ * pgstrom_gpucache_export_ipchandle
+ *
+ * It returns IPC handle of the main buffer of GPU cache, to map the columnar
+ * data store from the external process (like Python script) without any
+ * data copy over the PCI-E bus. Note that it is not a MVCC snapshot; REDO
+ * logs applied later are visible for the consumer, and compaction or expand
+ * of the buffer invalidates the exported handle.
+ */
+Datum
+pgstrom_gpucache_export_ipchandle(PG_FUNCTION_ARGS)
+{
+	Oid			table_oid = PG_GETARG_OID(0);
+	Relation	rel;
+	GpuCacheDesc *gc_desc;
+	GpuCacheSharedState *gc_sstate;
+	GpuCacheIpcHandle *handle;
+	uint64		sync_pos;
+	CUresult	rc;
+
+	rel = table_open(table_oid, AccessShareLock);
+	gc_desc = lookupGpuCacheDesc(rel);
+	if (!gc_desc)
+		ereport(ERROR,
+				(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+				 errmsg("relation \"%s\" has no GPU cache",
+						RelationGetRelationName(rel))));
+	gc_sstate = gc_desc->gc_sstate;
+
+	/* apply pending REDO logs prior to the export */
+	__gpuCacheFlushRedoBatch(gc_desc);
+	SpinLockAcquire(&gc_sstate->redo_lock);
+	sync_pos = gc_sstate->redo_sync_pos = gc_sstate->redo_write_pos;
+	SpinLockRelease(&gc_sstate->redo_lock);
+
+	rc = gpuCacheInvokeApplyRedo(gc_sstate, sync_pos, false);
+	if (rc != CUDA_SUCCESS)
+		elog(ERROR, "failed on GpuCache APPLY REDO: %s", errorText(rc));
+
+	handle = palloc0(sizeof(GpuCacheIpcHandle));
+	SET_VARSIZE(handle, sizeof(GpuCacheIpcHandle));
+	handle->magic = GPUCACHE_IPC_HANDLE_MAGIC;
+	handle->table_oid = RelationGetRelid(rel);
+
+	pthreadRWLockReadLock(&gc_sstate->gpu_buffer_lock);
+	if (gc_sstate->gpu_main_devptr == 0UL ||
+		gc_sstate->cuda_dindex < 0 ||
+		gc_sstate->cuda_dindex >= numDevAttrs)
+	{
+		pthreadRWLockUnlock(&gc_sstate->gpu_buffer_lock);
+		elog(ERROR, "GPU cache of \"%s\" is not loaded on the device",
+			 RelationGetRelationName(rel));
+	}
+	handle->cuda_device_id = devAttrs[gc_sstate->cuda_dindex].DEV_ID;
+	handle->main_size = gc_sstate->gpu_main_size;
+	StaticAssertStmt(sizeof(handle->ipc_mhandle) == sizeof(CUipcMemHandle),
+					 "unexpected size of CUipcMemHandle");
+	memcpy(handle->ipc_mhandle, &gc_sstate->gpu_main_mhandle,
+		   sizeof(CUipcMemHandle));
+	pthreadRWLockUnlock(&gc_sstate->gpu_buffer_lock);
+
+	table_close(rel, AccessShareLock);
+
+	PG_RETURN_BYTEA_P(handle);
+}
+
 /*
  * pgstrom_gpucache_info
  */
@@ -2088,6 +2535,120 @@ pgstrom_gpucache_info(PG_FUNCTION_ARGS)
 	SRF_RETURN_NEXT(fncxt, HeapTupleGetDatum(tuple));
 }
 
+/*
+ * pgstrom_gpucache_stat
+ */
+#ifndef INT8ARRAYOID
+#define INT8ARRAYOID		1016	/* see pg_type.h */
+#endif
+
+Datum
+pgstrom_gpucache_stat(PG_FUNCTION_ARGS)
+{
+	FuncCallContext *fncxt;
+	GpuCacheSharedState *gc_sstate;
+	GpuCacheStatistics *stats;
+	List	   *info_list;
+	Datum		values[19];
+	bool		isnull[19];
+	Datum		hist[GPUCACHE_STAT_NBUCKETS];
+	HeapTuple	tuple;
+	uint64		load_nblocks;
+	int			k;
+
+	if (SRF_IS_FIRSTCALL())
+	{
+		TupleDesc	tupdesc;
+		MemoryContext oldcxt;
+
+		fncxt = SRF_FIRSTCALL_INIT();
+		oldcxt = MemoryContextSwitchTo(fncxt->multi_call_memory_ctx);
+		tupdesc = CreateTemplateTupleDesc(19);
+		TupleDescInitEntry(tupdesc,  1, "database_oid",
+						   OIDOID, -1, 0);
+		TupleDescInitEntry(tupdesc,  2, "database_name",
+						   TEXTOID, -1, 0);
+		TupleDescInitEntry(tupdesc,  3, "table_oid",
+						   OIDOID, -1, 0);
+		TupleDescInitEntry(tupdesc,  4, "table_name",
+						   TEXTOID, -1, 0);
+		TupleDescInitEntry(tupdesc,  5, "signature",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc,  6, "scan_cached",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc,  7, "scan_fallback",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc,  8, "apply_count",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc,  9, "apply_nitems",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, 10, "apply_time",
+						   FLOAT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, 11, "apply_latency_hist",
+						   INT8ARRAYOID, -1, 0);
+		TupleDescInitEntry(tupdesc, 12, "compaction_count",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, 13, "compaction_time",
+						   FLOAT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, 14, "lock_wait_count",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, 15, "lock_wait_time",
+						   FLOAT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, 16, "redo_overflow",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, 17, "load_progress",
+						   FLOAT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, 18, "load_nitems",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, 19, "load_time",
+						   FLOAT8OID, -1, 0);
+		fncxt->tuple_desc = BlessTupleDesc(tupdesc);
+		fncxt->user_fctx = __pgstrom_gpucache_info();
+
+		MemoryContextSwitchTo(oldcxt);
+	}
+	fncxt = SRF_PERCALL_SETUP();
+	info_list = (List *)fncxt->user_fctx;
+	if (info_list == NIL)
+		SRF_RETURN_DONE(fncxt);
+	gc_sstate = linitial(info_list);
+	fncxt->user_fctx = list_delete_first(info_list);
+	stats = &gc_sstate->stats;
+
+	memset(isnull, 0, sizeof(isnull));
+	values[0] = ObjectIdGetDatum(gc_sstate->database_oid);
+	values[1] = CStringGetTextDatum(get_database_name(gc_sstate->database_oid));
+	values[2] = ObjectIdGetDatum(gc_sstate->table_oid);
+	values[3] = CStringGetTextDatum(gc_sstate->table_name);
+	values[4] = Int64GetDatum(gc_sstate->signature);
+	values[5] = Int64GetDatum(pg_atomic_read_u64(&stats->scan_cached));
+	values[6] = Int64GetDatum(pg_atomic_read_u64(&stats->scan_fallback));
+	values[7] = Int64GetDatum(pg_atomic_read_u64(&stats->apply_count));
+	values[8] = Int64GetDatum(pg_atomic_read_u64(&stats->apply_nitems));
+	values[9] = Float8GetDatum((double)pg_atomic_read_u64(&stats->apply_time) / 1000.0);
+	for (k=0; k < GPUCACHE_STAT_NBUCKETS; k++)
+		hist[k] = Int64GetDatum(pg_atomic_read_u64(&stats->apply_hist[k]));
+	values[10] = PointerGetDatum(construct_array(hist, GPUCACHE_STAT_NBUCKETS,
+												 INT8OID, sizeof(int64),
+												 FLOAT8PASSBYVAL, 'd'));
+	values[11] = Int64GetDatum(pg_atomic_read_u64(&stats->compaction_count));
+	values[12] = Float8GetDatum((double)pg_atomic_read_u64(&stats->compaction_time) / 1000.0);
+	values[13] = Int64GetDatum(pg_atomic_read_u64(&stats->lock_wait_count));
+	values[14] = Float8GetDatum((double)pg_atomic_read_u64(&stats->lock_wait_time) / 1000.0);
+	values[15] = Int64GetDatum(pg_atomic_read_u64(&stats->redo_overflow));
+	load_nblocks = pg_atomic_read_u64(&stats->load_nblocks);
+	if (load_nblocks > 0)
+		values[16] = Float8GetDatum((double)pg_atomic_read_u64(&stats->load_blocks) /
+									(double)load_nblocks);
+	else
+		isnull[16] = true;
+	values[17] = Int64GetDatum(pg_atomic_read_u64(&stats->load_nitems));
+	values[18] = Float8GetDatum((double)pg_atomic_read_u64(&stats->load_time) / 1000.0);
+
+	tuple = heap_form_tuple(fncxt->tuple_desc, values, isnull);
+	SRF_RETURN_NEXT(fncxt, HeapTupleGetDatum(tuple));
+}
+
 /* ---------------------------------------------------------------- *
  *
  * Executor callbacks
@@ -2166,6 +2727,13 @@ ExecInitGpuCache(ScanState *ss, int eflags, Bitmapset *outer_refs)
 			 RelationGetRelationName(relation));
 		return NULL;
 	}
+	/* GpuCache must keep all the referenced columns */
+	if (!gpuCacheCoversReferencedAttrs(&gc_options, outer_refs))
+	{
+		elog(DEBUG2, "gpucache: table '%s' does not cache all the referenced columns",
+			 RelationGetRelationName(relation));
+		return NULL;
+	}
 	/* Lookup GpuCacheSharedState, if any */
 	memset(&hkey, 0, sizeof(GpuCacheDesc));
 	hkey.database_oid = MyDatabaseId;
@@ -2175,7 +2743,10 @@ ExecInitGpuCache(ScanState *ss, int eflags, Bitmapset *outer_refs)
 	if (!gc_sstate || pg_atomic_read_u32(&gc_sstate->gpu_buffer_corrupted))
 	{
 		if (gc_sstate)
+		{
+			pg_atomic_fetch_add_u64(&gc_sstate->stats.scan_fallback, 1);
 			putGpuCacheSharedState(gc_sstate, false);
+		}
 		return NULL;
 	}
 	/* Setup GpuCacheState */
@@ -2203,6 +2774,90 @@ ExecInitGpuCache(ScanState *ss, int eflags, Bitmapset *outer_refs)
 	return gcache_state;
 }
 
+/*
+ * __gpuCacheXidIsVisible
+ *
+ * It returns true, if the transaction may be visible to the snapshot.
+ * Unknown cases are also considered as visible.
+ */
+static bool
+__gpuCacheXidIsVisible(TransactionId xid, Snapshot snapshot)
+{
+	int		i;
+
+	if (!TransactionIdIsNormal(xid))
+		return true;
+	if (TransactionIdPrecedes(xid, snapshot->xmin))
+		return true;
+	if (TransactionIdFollowsOrEquals(xid, snapshot->xmax))
+		return false;
+	for (i=0; i < snapshot->xcnt; i++)
+	{
+		if (TransactionIdEquals(xid, snapshot->xip[i]))
+			return false;
+	}
+	if (snapshot->suboverflowed)
+		return true;
+	for (i=0; i < snapshot->subxcnt; i++)
+	{
+		if (TransactionIdEquals(xid, snapshot->subxip[i]))
+			return false;
+	}
+	return true;
+}
+
+/*
+ * __gpuCacheRedoHasVisibleCommit
+ *
+ * It checks whether the REDO logs not applied yet contain any commit log
+ * that is visible to the snapshot (or invisible, if @visible is false).
+ * If no visible ones, GPU cache is already consistent to the snapshot;
+ * rows inserted or deleted by in-progress or later transactions are not
+ * visible anyway.
+ * Because we walk on the REDO buffer without lock, the caller must ensure
+ * redo_read_pos was not moved during the walk; it could be overwritten.
+ */
+static bool
+__gpuCacheRedoHasVisibleCommit(GpuCacheSharedState *gc_sstate,
+							   uint64 head_pos, uint64 tail_pos,
+							   Snapshot snapshot, bool visible)
+{
+	char	   *base = gc_sstate->redo_buffer;
+	uint64		curr_pos = head_pos;
+
+	if (!snapshot || !IsMVCCSnapshot(snapshot))
+		return true;
+	while (curr_pos < tail_pos)
+	{
+		GCacheTxLogCommon *tx_log;
+		uint64		__curr_pos = (curr_pos % gc_sstate->redo_buffer_size);
+
+		tx_log = (GCacheTxLogCommon *)(base + __curr_pos);
+		if (__curr_pos + offsetof(GCacheTxLogCommon,
+								  data) > gc_sstate->redo_buffer_size ||
+			(tx_log->type & 0xffffff00U) != GCACHE_TX_LOG__MAGIC)
+		{
+			curr_pos += (gc_sstate->redo_buffer_size - __curr_pos);
+			continue;
+		}
+		if (tx_log->length < offsetof(GCacheTxLogCommon, data) ||
+			tx_log->length != MAXALIGN(tx_log->length) ||
+			__curr_pos + tx_log->length > gc_sstate->redo_buffer_size)
+			return true;	/* likely overwritten */
+		if (tx_log->type == GCACHE_TX_LOG__XACT)
+		{
+			GCacheTxLogXact *x_log = (GCacheTxLogXact *)tx_log;
+
+			/* upper case tag means COMMIT */
+			if (x_log->tag >= 'A' && x_log->tag <= 'Z' &&
+				__gpuCacheXidIsVisible(x_log->xid, snapshot) == visible)
+				return true;
+		}
+		curr_pos += tx_log->length;
+	}
+	return false;
+}
+
 pgstrom_data_store *
 ExecScanChunkGpuCache(GpuTaskState *gts)
 {
@@ -2213,20 +2868,49 @@ ExecScanChunkGpuCache(GpuTaskState *gts)
 	if (pg_atomic_fetch_add_u32(gcache_state->gc_fetch_count, 1) == 0)
 	{
 		GpuCacheSharedState *gc_sstate = gcache_state->gc_sstate;
+		uint64		read_pos;
 		uint64		write_pos;
 		uint64		sync_pos = ULONG_MAX;
 		size_t		head_sz;
 
+		/* REDO logs by this backend itself, but not written yet */
+		gpuCacheFlushRedoBatchAll(gc_sstate);
+
 		SpinLockAcquire(&gc_sstate->redo_lock);
+		read_pos = gc_sstate->redo_read_pos;
 		write_pos = gc_sstate->redo_write_pos;
-		if (gc_sstate->redo_sync_pos < gc_sstate->redo_write_pos)
-			sync_pos = gc_sstate->redo_sync_pos = gc_sstate->redo_write_pos;
+		gc_sstate->redo_scan_timestamp = GetCurrentTimestamp();
 		SpinLockRelease(&gc_sstate->redo_lock);
 
 		/* Is the target table empty? */
 		if (write_pos == 0)
 			return NULL;
 
+		/*
+		 * If REDO logs not applied yet contain no commit logs visible to
+		 * the query snapshot, we don't need to wait for the REDO logs being
+		 * applied synchronously, because the GPU kernel never see the rows
+		 * of in-progress (or later) transactions, except for ourselves
+		 * being checked by xactIdVector.
+		 */
+		if (read_pos < write_pos &&
+			!__gpuCacheRedoHasVisibleCommit(gc_sstate, read_pos, write_pos,
+											estate->es_snapshot, true))
+		{
+			bool	walk_is_valid;
+
+			SpinLockAcquire(&gc_sstate->redo_lock);
+			/* REDO logs may be overwritten, if redo_read_pos was moved */
+			walk_is_valid = (gc_sstate->redo_read_pos == read_pos);
+			SpinLockRelease(&gc_sstate->redo_lock);
+			if (walk_is_valid)
+				goto skip_sync;
+		}
+		SpinLockAcquire(&gc_sstate->redo_lock);
+		if (gc_sstate->redo_sync_pos < gc_sstate->redo_write_pos)
+			sync_pos = gc_sstate->redo_sync_pos = gc_sstate->redo_write_pos;
+		SpinLockRelease(&gc_sstate->redo_lock);
+
 		/* Force to apply pending REDO logs, if any */
 		if (sync_pos != ULONG_MAX)
 		{
@@ -2239,11 +2923,14 @@ ExecScanChunkGpuCache(GpuTaskState *gts)
 			 */
 			if (gpuCacheInvokeApplyRedo(gc_sstate, sync_pos, false) != CUDA_SUCCESS)
 			{
+				pg_atomic_fetch_add_u64(&gc_sstate->stats.scan_fallback, 1);
 				ExecEndGpuCache(gcache_state);
 				gts->gc_state = NULL;
 				return pgstromExecScanChunk(gts);
 			}
 		}
+	skip_sync:
+		pg_atomic_fetch_add_u64(&gc_sstate->stats.scan_cached, 1);
 		/* Ok, build a PDS with KDS_FORMAT_COLUMN */
 		head_sz = KERN_DATA_STORE_HEAD_LENGTH(&gc_sstate->kds_head);
 		pds = MemoryContextAllocZero(estate->es_query_cxt,
@@ -2255,6 +2942,54 @@ ExecScanChunkGpuCache(GpuTaskState *gts)
 	return pds;
 }
 
+/*
+ * gpuCacheGetScanVersion
+ *
+ * It returns the version of GPU cache contents visible to the snapshot.
+ * Any later changes of the contents, including the visibility of the rows
+ * by commit of the transactions, shall write REDO logs, and move the
+ * redo_write_pos. It returns false if the contents visible to the snapshot
+ * may change without REDO logs; when the snapshot does not see commits
+ * already logged, or the current transaction itself has written.
+ */
+bool
+gpuCacheGetScanVersion(GpuCacheState *gcache_state,
+					   Snapshot snapshot,
+					   GpuCacheScanVersion *version)
+{
+	GpuCacheSharedState *gc_sstate = gcache_state->gc_sstate;
+	uint64		read_pos;
+	uint64		write_pos;
+	bool		walk_is_valid;
+
+	if (TransactionIdIsValid(GetCurrentTransactionIdIfAny()) ||
+		pg_atomic_read_u32(&gc_sstate->gpu_buffer_corrupted))
+		return false;
+
+	SpinLockAcquire(&gc_sstate->redo_lock);
+	read_pos = gc_sstate->redo_read_pos;
+	write_pos = gc_sstate->redo_write_pos;
+	memset(version, 0, sizeof(GpuCacheScanVersion));
+	version->database_oid = gc_sstate->database_oid;
+	version->table_oid = gc_sstate->table_oid;
+	version->signature = gc_sstate->signature;
+	version->load_timestamp = gc_sstate->redo_load_timestamp;
+	version->write_pos = write_pos;
+	SpinLockRelease(&gc_sstate->redo_lock);
+
+	if (read_pos < write_pos &&
+		__gpuCacheRedoHasVisibleCommit(gc_sstate, read_pos, write_pos,
+									   snapshot, false))
+		return false;
+
+	SpinLockAcquire(&gc_sstate->redo_lock);
+	/* REDO logs may be overwritten, if redo_read_pos was moved */
+	walk_is_valid = (gc_sstate->redo_read_pos == read_pos);
+	SpinLockRelease(&gc_sstate->redo_lock);
+
+	return walk_is_valid;
+}
+
 void
 ExecReScanGpuCache(GpuCacheState *gcache_state)
 {
@@ -2395,25 +3130,35 @@ gpuCacheMapDeviceMemory(GpuContext *gcontext,
 	CUresult	rc = CUDA_ERROR_NOT_MAPPED;
 
 	Assert(pds->kds.format == KDS_FORMAT_COLUMN);
-	pthreadRWLockReadLock(&gc_sstate->gpu_buffer_lock);
+	if (!pthreadRWLockReadTryLock(&gc_sstate->gpu_buffer_lock))
+	{
+		TimestampTz	tv1 = GetCurrentTimestamp();
+
+		pthreadRWLockReadLock(&gc_sstate->gpu_buffer_lock);
+		pg_atomic_fetch_add_u64(&gc_sstate->stats.lock_wait_count, 1);
+		pg_atomic_fetch_add_u64(&gc_sstate->stats.lock_wait_time,
+								GetCurrentTimestamp() - tv1);
+	}
 	if (gc_sstate->gpu_main_devptr != 0UL)
 	{
-		rc = gpuIpcOpenMemHandle(gcontext,
-								 &m_kds_main,
-								 gc_sstate->gpu_main_mhandle,
-								 CU_IPC_MEM_LAZY_ENABLE_PEER_ACCESS);
+		rc = gpuIpcOpenMemHandleCached(gcontext,
+									   gc_sstate->database_oid,
+									   gc_sstate->table_oid, 0,
+									   gc_sstate->gpu_main_mhandle,
+									   &m_kds_main);
 		if (rc != CUDA_SUCCESS)
 			goto out_unlock;
 
 		if (gc_sstate->gpu_extra_devptr != 0UL)
 		{
-			rc = gpuIpcOpenMemHandle(gcontext,
-									 &m_kds_extra,
-									 gc_sstate->gpu_extra_mhandle,
-									 CU_IPC_MEM_LAZY_ENABLE_PEER_ACCESS);
+			rc = gpuIpcOpenMemHandleCached(gcontext,
+										   gc_sstate->database_oid,
+										   gc_sstate->table_oid, 1,
+										   gc_sstate->gpu_extra_mhandle,
+										   &m_kds_extra);
 			if (rc != CUDA_SUCCESS)
 			{
-				gpuIpcCloseMemHandle(gcontext, m_kds_main);
+				gpuIpcCloseMemHandleCached(gcontext, m_kds_main);
 				goto out_unlock;
 			}
 		}
@@ -2436,12 +3181,12 @@ gpuCacheUnmapDeviceMemory(GpuContext *gcontext,
 	Assert(pds->kds.format == KDS_FORMAT_COLUMN);
 	if (pds->m_kds_main != 0UL)
 	{
-		gpuIpcCloseMemHandle(gcontext, pds->m_kds_main);
+		gpuIpcCloseMemHandleCached(gcontext, pds->m_kds_main);
 		pds->m_kds_main = 0UL;
 	}
 	if (pds->m_kds_extra != 0UL)
 	{
-		gpuIpcCloseMemHandle(gcontext, pds->m_kds_extra);
+		gpuIpcCloseMemHandleCached(gcontext, pds->m_kds_extra);
 		pds->m_kds_extra = 0UL;
 	}
 	pthreadRWLockUnlock(&gc_sstate->gpu_buffer_lock);	
@@ -2946,6 +3691,38 @@ gpuCacheLoadCudaModule(void)
 	return __gpuCacheLoadCudaModule();
 }
 
+/*
+ * __gpuCacheReportOutOfMemory
+ *
+ * It reports how much device memory is required for the GPU cache, and how
+ * much is available, when cuMemAlloc() failed due to out of memory. The
+ * whole column store must reside on a single device, because it is shared
+ * with backends by the IPC handles, so DBA has to adjust max_num_rows.
+ */
+static void
+__gpuCacheReportOutOfMemory(GpuCacheSharedState *gc_sstate,
+							size_t main_sz, CUresult rc)
+{
+	size_t		required = main_sz + gc_sstate->kds_extra_sz;
+	size_t		free_sz = 0;
+	size_t		total_sz = 0;
+
+	if (rc != CUDA_ERROR_OUT_OF_MEMORY ||
+		cuMemGetInfo(&free_sz, &total_sz) != CUDA_SUCCESS)
+		return;
+	ereport(LOG,
+			(errmsg("gpucache: table %s:%lx requires %s of device memory, but only %s is available on GPU%d (total %s)",
+					gc_sstate->table_name,
+					gc_sstate->signature,
+					format_bytesz(required),
+					format_bytesz(free_sz),
+					devAttrs[gc_sstate->cuda_dindex].DEV_ID,
+					format_bytesz(total_sz)),
+			 errhint("max_num_rows=%ld would fit the available device memory",
+					 (long)((double)gc_sstate->max_num_rows *
+							(double)free_sz / (double)required))));
+}
+
 /*
  * gpuCacheAllocDeviceMemory
  */
@@ -2975,6 +3752,7 @@ gpuCacheAllocDeviceMemory(GpuCacheSharedState *gc_sstate)
 	{
 		elog(LOG, "gpucache: failed on cuMemAlloc(%zu): %s",
 			 main_sz, errorText(rc));
+		__gpuCacheReportOutOfMemory(gc_sstate, main_sz, rc);
 		goto error_0;
 	}
 
@@ -3007,6 +3785,7 @@ gpuCacheAllocDeviceMemory(GpuCacheSharedState *gc_sstate)
 		{
 			elog(LOG, "gpucache: failed on cuMemAlloc(%zu): %s",
 				 kds_extra.length, errorText(rc));
+			__gpuCacheReportOutOfMemory(gc_sstate, main_sz, rc);
 			goto error_1;
 		}
 
@@ -3100,20 +3879,80 @@ error_0:
 /*
  * GCACHE_BGWORKER_CMD__COMPACTION command
  *
- * caller must hold exclusive lock on gc_sstate->gpu_buffer_lock
+ * The compaction kernel runs on a chunk of rows at once, and writes the new
+ * offsets of varlena datum to the shadow values array, not to the main
+ * store. So, the heavy portion can run under the shared lock of the
+ * gpu_buffer_lock, and the exclusive lock is acquired only to copy the
+ * shadow values array and swap the extra buffer.
+ * Note that only the bgworker modifies the GPU device buffers, thus, the
+ * main store is never updated in the middle of compaction.
  */
+#define GPUCACHE_COMPACTION_CHUNK_NROWS		(4U << 20)
+
 static CUresult
-gpuCacheBgWorkerExecCompactionNoLock(GpuCacheSharedState *gc_sstate)
+__gpuCacheLaunchCompactionKernel(GpuCacheSharedState *gc_sstate,
+								 CUdeviceptr m_new_extra,
+								 CUdeviceptr m_shadow,
+								 int grid_sz, int block_sz)
 {
+	cl_uint		nrooms = gc_sstate->kds_head.nrooms;
+	cl_uint		row_base;
+	cl_uint		row_nums;
+	void	   *kern_args[6];
+	CUresult	rc;
+
+	for (row_base=0; row_base < nrooms; row_base += row_nums)
+	{
+		row_nums = Min(nrooms - row_base, GPUCACHE_COMPACTION_CHUNK_NROWS);
+
+		kern_args[0] = &gc_sstate->gpu_main_devptr;
+		kern_args[1] = &gc_sstate->gpu_extra_devptr;
+		kern_args[2] = &m_new_extra;
+		kern_args[3] = &m_shadow;
+		kern_args[4] = &row_base;
+		kern_args[5] = &row_nums;
+		rc = cuLaunchKernel(gcache_kfunc_compaction,
+							grid_sz, 1, 1,
+							block_sz, 1, 1,
+							0,
+							CU_STREAM_PER_THREAD,
+							kern_args,
+							NULL);
+		if (rc != CUDA_SUCCESS)
+			elog(ERROR, "failed on cuLaunchKernel: %s", errorText(rc));
+
+		/* check status of the kernel execution status */
+		rc = cuStreamSynchronize(CU_STREAM_PER_THREAD);
+		if (rc != CUDA_SUCCESS)
+			elog(ERROR, "failed on cuStreamSynchronize: %s", errorText(rc));
+	}
+	return CUDA_SUCCESS;
+}
+
+/*
+ * __gpuCacheExecCompaction
+ *
+ * If 'concurrent', caller must hold shared lock on gc_sstate->gpu_buffer_lock,
+ * then it is released and exclusive lock is acquired for the swap.
+ * Elsewhere, caller must hold exclusive lock on gc_sstate->gpu_buffer_lock.
+ */
+static CUresult
+__gpuCacheExecCompaction(GpuCacheSharedState *gc_sstate, bool concurrent)
+{
+	kern_data_store *kds_head = &gc_sstate->kds_head;
 	kern_data_extra	h_extra;
 	int				grid_sz, block_sz;
+	int				j, nvarlena = 0;
 	size_t			curr_usage;
+	size_t			shadow_unitsz = sizeof(cl_uint) * kds_head->nrooms;
 	CUdeviceptr		m_try_extra = 0UL;
 	CUdeviceptr		m_new_extra = 0UL;
+	CUdeviceptr		m_old_extra = gc_sstate->gpu_extra_devptr;
+	CUdeviceptr		m_shadow = 0UL;
 	CUdeviceptr		m_temp;
 	CUipcMemHandle	new_mhandle;
+	TimestampTz		tv1 = GetCurrentTimestamp();
 	CUresult		rc;
-	void		   *kern_args[3];
 
 	if (gc_sstate->gpu_extra_devptr == 0UL)
 		return CUDA_SUCCESS;	/* nothing to do, if no extra buffer */
@@ -3126,6 +3965,22 @@ gpuCacheBgWorkerExecCompactionNoLock(GpuCacheSharedState *gc_sstate)
 	if (rc != CUDA_SUCCESS)
 		return rc;
 
+	/* shadow values array for each varlena column */
+	for (j=0; j < kds_head->ncols; j++)
+	{
+		kern_colmeta   *cmeta = &kds_head->colmeta[j];
+
+		if (!cmeta->attbyval && cmeta->attlen == -1 &&
+			cmeta->values_offset != 0)
+			nvarlena++;
+	}
+	if (nvarlena == 0)
+		return CUDA_SUCCESS;
+	rc = cuMemAlloc(&m_shadow, shadow_unitsz * nvarlena);
+	if (rc != CUDA_SUCCESS)
+		elog(ERROR, "failed on cuMemAlloc(%zu): %s",
+			 shadow_unitsz * nvarlena, errorText(rc));
+
 	/*
 	 * phase-1: Estimation of the required device memory. This dummy
 	 * extra buffer is initialized to usage > length, so compaction
@@ -3140,24 +3995,8 @@ gpuCacheBgWorkerExecCompactionNoLock(GpuCacheSharedState *gc_sstate)
 	h_extra.usage  = offsetof(kern_data_extra, data);
 	memcpy((void *)m_try_extra, &h_extra, offsetof(kern_data_extra, data));
 
-	kern_args[0] = &gc_sstate->gpu_main_devptr;
-	kern_args[1] = &gc_sstate->gpu_extra_devptr;
-	kern_args[2] = &m_try_extra;
-	rc = cuLaunchKernel(gcache_kfunc_compaction,
-						grid_sz, 1, 1,
-						block_sz, 1, 1,
-						0,
-						CU_STREAM_PER_THREAD,
-						kern_args,
-						NULL);
-	if (rc != CUDA_SUCCESS)
-		elog(ERROR, "failed on cuLaunchKernel: %s", errorText(rc));
-
-	/* check status of the kernel execution status */
-	rc = cuStreamSynchronize(CU_STREAM_PER_THREAD);
-	if (rc != CUDA_SUCCESS)
-		elog(ERROR, "failed on cuStreamSynchronize: %s", errorText(rc));
-
+	__gpuCacheLaunchCompactionKernel(gc_sstate, m_try_extra, m_shadow,
+									 grid_sz, block_sz);
 	curr_usage = ((kern_data_extra *)m_try_extra)->usage;
 
 	/*
@@ -3182,29 +4021,48 @@ gpuCacheBgWorkerExecCompactionNoLock(GpuCacheSharedState *gc_sstate)
 	if (rc != CUDA_SUCCESS)
 		elog(ERROR, "failed on cuMemcpyHtoD: %s", errorText(rc));
 
-	/* kick the compaction kernel */
-	kern_args[0] = &gc_sstate->gpu_main_devptr;
-	kern_args[1] = &gc_sstate->gpu_extra_devptr;
-	kern_args[2] = &m_new_extra;
-	rc = cuLaunchKernel(gcache_kfunc_compaction,
-						grid_sz, 1, 1,
-						block_sz, 1, 1,
-						0,
-						CU_STREAM_PER_THREAD,
-						kern_args,
-						NULL);
-	if (rc != CUDA_SUCCESS)
-		elog(ERROR, "failed on cuLaunchKernel: %s", errorText(rc));
-
-	/* check status of the kernel execution status */
-	rc = cuStreamSynchronize(CU_STREAM_PER_THREAD);
-	if (rc != CUDA_SUCCESS)
-		elog(ERROR, "failed on cuStreamSynchronize: %s", errorText(rc));
+	/* kick the compaction kernel for each chunk */
+	__gpuCacheLaunchCompactionKernel(gc_sstate, m_new_extra, m_shadow,
+									 grid_sz, block_sz);
 
 	rc = cuMemcpyDtoH(&h_extra, m_new_extra, offsetof(kern_data_extra, data));
 	if (rc != CUDA_SUCCESS)
 		elog(ERROR, "failed on cuMemcpyDtoH: %s", errorText(rc));
 
+	/*
+	 * phase-3: copy the shadow values array to the main store, and swap
+	 * the extra buffer under the exclusive lock.
+	 */
+	if (concurrent)
+	{
+		pthreadRWLockUnlock(&gc_sstate->gpu_buffer_lock);
+		pthreadRWLockWriteLock(&gc_sstate->gpu_buffer_lock);
+		if (pg_atomic_read_u32(&gc_sstate->gpu_buffer_corrupted) ||
+			gc_sstate->gpu_extra_devptr != m_old_extra)
+		{
+			/* GPU cache was reset, so compaction result is meaningless */
+			cuMemFree(m_new_extra);
+			cuMemFree(m_try_extra);
+			cuMemFree(m_shadow);
+			return CUDA_ERROR_NOT_READY;
+		}
+	}
+	m_temp = m_shadow;
+	for (j=0; j < kds_head->ncols; j++)
+	{
+		kern_colmeta   *cmeta = &kds_head->colmeta[j];
+
+		if (cmeta->attbyval || cmeta->attlen != -1 ||
+			cmeta->values_offset == 0)
+			continue;
+		rc = cuMemcpyDtoD(gc_sstate->gpu_main_devptr +
+						  __kds_unpack(cmeta->values_offset),
+						  m_temp, shadow_unitsz);
+		if (rc != CUDA_SUCCESS)
+			elog(ERROR, "failed on cuMemcpyDtoD: %s", errorText(rc));
+		m_temp += shadow_unitsz;
+	}
+
 	elog(LOG, "gpucache: extra compaction (%s:%lx) {length=%zu->%zu, usage=%zu}",
 		 gc_sstate->table_name,
 		 gc_sstate->signature,
@@ -3222,9 +4080,24 @@ gpuCacheBgWorkerExecCompactionNoLock(GpuCacheSharedState *gc_sstate)
 		cuMemFree(m_new_extra);
 	if (m_try_extra != 0UL)
 		cuMemFree(m_try_extra);
+	if (m_shadow != 0UL)
+		cuMemFree(m_shadow);
+
+	pg_atomic_fetch_add_u64(&gc_sstate->stats.compaction_count, 1);
+	pg_atomic_fetch_add_u64(&gc_sstate->stats.compaction_time,
+							GetCurrentTimestamp() - tv1);
 	return rc;
 }
 
+/*
+ * caller must hold exclusive lock on gc_sstate->gpu_buffer_lock
+ */
+static CUresult
+gpuCacheBgWorkerExecCompactionNoLock(GpuCacheSharedState *gc_sstate)
+{
+	return __gpuCacheExecCompaction(gc_sstate, false);
+}
+
 static inline CUresult
 gpuCacheBgWorkerExecCompaction(GpuCacheSharedState *gc_sstate)
 {
@@ -3234,11 +4107,24 @@ gpuCacheBgWorkerExecCompaction(GpuCacheSharedState *gc_sstate)
 	if (rc != CUDA_SUCCESS)
 		return rc;
 
-	pthreadRWLockWriteLock(&gc_sstate->gpu_buffer_lock);
-	if (pg_atomic_read_u32(&gc_sstate->gpu_buffer_corrupted))
-		rc = CUDA_ERROR_NOT_READY;
-	else
-		rc = gpuCacheBgWorkerExecCompactionNoLock(gc_sstate);
+	/*
+	 * GPU cache readers can continue to scan during the compaction;
+	 * __gpuCacheExecCompaction upgrades the lock only for buffer swap.
+	 */
+	pthreadRWLockReadLock(&gc_sstate->gpu_buffer_lock);
+	PG_TRY();
+	{
+		if (pg_atomic_read_u32(&gc_sstate->gpu_buffer_corrupted))
+			rc = CUDA_ERROR_NOT_READY;
+		else
+			rc = __gpuCacheExecCompaction(gc_sstate, true);
+	}
+	PG_CATCH();
+	{
+		pthreadRWLockUnlock(&gc_sstate->gpu_buffer_lock);
+		PG_RE_THROW();
+	}
+	PG_END_TRY();
 	pthreadRWLockUnlock(&gc_sstate->gpu_buffer_lock);
 
 	return rc;
@@ -3471,7 +4357,16 @@ gpuCacheBgWorkerApplyRedoLog(GpuCacheSharedState *gc_sstate, uint64 end_pos)
 			goto out_unlock;
 		if (m_redo != 0UL)
 		{
+			uint64		nitems = ((kern_gpucache_redolog *)m_redo)->nitems;
+			TimestampTz	tv1 = GetCurrentTimestamp();
+			uint64		nvtx_range;
+
+			nvtx_range = pgstromNvtxBegin("gpuCacheApplyRedo", NULL, 0);
 			rc = __gpuCacheLaunchApplyRedoKernel(gc_sstate, m_redo);
+			pgstromNvtxEnd(nvtx_range);
+			if (rc == CUDA_SUCCESS)
+				gpuCacheStatUpdateApply(&gc_sstate->stats, nitems,
+										GetCurrentTimestamp() - tv1);
 
 			__rc = cuMemFree(m_redo);
 			if (__rc != CUDA_SUCCESS)
@@ -3671,7 +4566,16 @@ gpuCacheBgWorkerDispatch(int cuda_dindex)
 
 /*
  * gpuCacheBgWorkerIdleTask
+ *
+ * In addition to the static gpu_sync_interval/gpu_sync_threshold, pending
+ * REDO logs are applied on the idle time of GPU, if the table was scanned
+ * recently (within gpu_sync_interval) and writers are quiet for a moment.
+ * It saves the next query from the synchronous apply of large REDO logs.
+ * On the other hands, REDO logs are accumulated as long as writers are
+ * active, or nobody scans the table, to apply them in larger batches.
  */
+#define GPUCACHE_SYNC_QUIET_INTERVAL	(500 * 1000L)	/* 500ms in us */
+
 bool
 gpuCacheBgWorkerIdleTask(int cuda_dindex)
 {
@@ -3703,7 +4607,12 @@ gpuCacheBgWorkerIdleTask(int cuda_dindex)
 				 timestamp > (gc_sstate->redo_write_timestamp +
 							  gc_sstate->gpu_sync_interval)) ||
 				(gc_sstate->redo_write_pos > (gc_sstate->redo_sync_pos +
-											  gc_sstate->gpu_sync_threshold)))
+											  gc_sstate->gpu_sync_threshold)) ||
+				(gc_sstate->redo_write_pos > gc_sstate->redo_sync_pos &&
+				 timestamp > (gc_sstate->redo_write_timestamp +
+							  GPUCACHE_SYNC_QUIET_INTERVAL) &&
+				 timestamp < (gc_sstate->redo_scan_timestamp +
+							  gc_sstate->gpu_sync_interval)))
 			{
 				SpinLockAcquire(cmd_lock);
 				if (!dlist_is_empty(free_cmds))
@@ -3986,6 +4895,7 @@ gpuCacheAutoPreloadConnectDatabase(int32 *p_start, int32 *p_end)
 
 		if (strcmp(database_name, entry->database_name) != 0)
 			break;
+		curr++;
 	}
 	gcache_shared_head->gcache_auto_preload_count = curr;
 
@@ -26,8 +26,34 @@ typedef struct CudaResource
 	CUdevice		cuda_device;
 	CUcontext		cuda_context;
 	bool			can_reuse;
+	/* long-lived IPC mappings of GPU cache buffers */
+	pthread_mutex_t	ipc_mutex;
+	dlist_head		ipc_mappings;
 } CudaResource;
 
+/*
+ * CudaIpcMapping
+ *
+ * GpuTasks on a GPU cache open the IPC handles of the main and extra
+ * buffers for each, but cuIpcOpenMemHandle() takes a few milliseconds.
+ * So, these mappings are kept per CUDA context, and reused by the later
+ * GpuTasks, and queries also if the CUDA context is reused (see
+ * pg_strom.reuse_cuda_context).
+ * A mapping is replaced once the IPC handle of the buffer is changed,
+ * and closed on invalidation of the table signature unless it is in use.
+ */
+typedef struct
+{
+	dlist_node		chain;
+	Oid				database_oid;
+	Oid				table_oid;
+	int				slot;		/* 0: main, 1: extra buffer */
+	CUipcMemHandle	handle;
+	CUdeviceptr		ptr;
+	int				refcnt;
+	bool			invalid;
+} CudaIpcMapping;
+
 /* variables */
 int					pgstrom_max_async_tasks;		/* GUC */
 bool				pgstrom_reuse_cuda_context;	/* GUC */
@@ -58,11 +84,13 @@ typedef struct ResourceTracker
 		struct {
 			CUdeviceptr	ptr;	/* RESTRACK_CLASS__GPUMEMORY */
 			void   *extra;
+			size_t	bytesize;	/* device memory consumption */
 		} devmem;
 		struct {				/* RESTRACK_CLASS__GPUMEMORY_IPC */
 			CUdeviceptr ptr;
 			CUipcMemHandle handle;
 			cl_uint		mapcount;
+			size_t		bytesize;
 		} ipcmem;
 		struct {				/* RESTRACK_CLASS__GPUMODULE */
 			ProgramId	program_id;
@@ -143,12 +171,36 @@ untrackCudaProgram(GpuContext *gcontext, ProgramId program_id)
 	wnotice("Bug? CUDA Program %lu was not tracked", program_id);
 }
 
+/*
+ * gpuContextUpdateMemUsage - accounting of device memory per query
+ */
+static void
+gpuContextUpdateMemUsage(GpuContext *gcontext, int64 delta)
+{
+	uint64		usage;
+	uint64		peak;
+
+	if (delta < 0)
+	{
+		pg_atomic_sub_fetch_u64(&gcontext->gm_query_usage, -delta);
+		return;
+	}
+	usage = pg_atomic_add_fetch_u64(&gcontext->gm_query_usage, delta);
+	peak = pg_atomic_read_u64(&gcontext->gm_query_peak);
+	while (peak < usage)
+	{
+		if (pg_atomic_compare_exchange_u64(&gcontext->gm_query_peak,
+										   &peak, usage))
+			break;
+	}
+}
+
 /*
  * resource tracker for device memory
  */
 bool
 trackGpuMem(GpuContext *gcontext, CUdeviceptr devptr, void *extra,
-			const char *filename, int lineno)
+			size_t bytesize, const char *filename, int lineno)
 {
 	ResourceTracker *tracker = calloc(1, sizeof(ResourceTracker));
 	pg_crc32	crc;
@@ -164,11 +216,14 @@ trackGpuMem(GpuContext *gcontext, CUdeviceptr devptr, void *extra,
 	tracker->lineno = lineno;
 	tracker->u.devmem.ptr = devptr;
 	tracker->u.devmem.extra = extra;
+	tracker->u.devmem.bytesize = bytesize;
 
 	SpinLockAcquire(&gcontext->restrack_lock);
 	dlist_push_tail(&gcontext->restrack[crc % RESTRACK_HASHSIZE],
 					&tracker->chain);
 	SpinLockRelease(&gcontext->restrack_lock);
+	if (bytesize > 0)
+		gpuContextUpdateMemUsage(gcontext, bytesize);
 	return true;
 }
 
@@ -225,6 +280,9 @@ untrackGpuMem(GpuContext *gcontext, CUdeviceptr devptr)
 			dlist_delete(&tracker->chain);
 			extra = tracker->u.devmem.extra;
 			SpinLockRelease(&gcontext->restrack_lock);
+			if (tracker->u.devmem.bytesize > 0)
+				gpuContextUpdateMemUsage(gcontext,
+										 -(int64)tracker->u.devmem.bytesize);
 			free(tracker);
 			return extra;
 		}
@@ -302,6 +360,187 @@ untrackRawFileDesc(GpuContext *gcontext, GPUDirectFileDesc *filedesc)
  * of CUDA API.
  */
 
+/*
+ * __cudaIpcMappingClose
+ *
+ * Caller must hold cuda_resource->ipc_mutex.
+ */
+static void
+__cudaIpcMappingClose(CudaResource *cuda_resource, CudaIpcMapping *ipcmap)
+{
+	CUresult	rc;
+
+	Assert(ipcmap->refcnt == 0);
+	dlist_delete(&ipcmap->chain);
+	GPUCONTEXT_PUSH(cuda_resource);
+	rc = cuIpcCloseMemHandle(ipcmap->ptr);
+	if (rc != CUDA_SUCCESS)
+		wnotice("failed on cuIpcCloseMemHandle: %s", errorText(rc));
+	GPUCONTEXT_POP(cuda_resource);
+	free(ipcmap);
+}
+
+/*
+ * __cudaIpcMappingCloseAll
+ *
+ * It closes all the IPC mappings prior to cuCtxDestroy(); see the comment
+ * in ReleaseLocalResources() also.
+ */
+static void
+__cudaIpcMappingCloseAll(CudaResource *cuda_resource)
+{
+	pthreadMutexLock(&cuda_resource->ipc_mutex);
+	while (!dlist_is_empty(&cuda_resource->ipc_mappings))
+	{
+		dlist_node *dnode = dlist_head_node(&cuda_resource->ipc_mappings);
+		CudaIpcMapping *ipcmap = dlist_container(CudaIpcMapping,
+												 chain, dnode);
+		ipcmap->refcnt = 0;
+		__cudaIpcMappingClose(cuda_resource, ipcmap);
+	}
+	pthreadMutexUnlock(&cuda_resource->ipc_mutex);
+}
+
+/*
+ * gpuIpcOpenMemHandleCached
+ *
+ * It maps the IPC handle of the GPU cache buffer identified by the table
+ * and slot, or reuses the mapping already opened on the CUDA context.
+ * Caller must release the mapping by gpuIpcCloseMemHandleCached().
+ */
+CUresult
+gpuIpcOpenMemHandleCached(GpuContext *gcontext,
+						  Oid database_oid,
+						  Oid table_oid,
+						  int slot,
+						  CUipcMemHandle m_handle,
+						  CUdeviceptr *p_deviceptr)
+{
+	CudaResource   *cuda_resource = &cuda_resources_array[gcontext->cuda_dindex];
+	CudaIpcMapping *ipcmap = NULL;
+	dlist_mutable_iter iter;
+	CUresult		rc = CUDA_SUCCESS;
+
+	Assert(cuda_resource->cuda_context == gcontext->cuda_context);
+	pthreadMutexLock(&cuda_resource->ipc_mutex);
+	dlist_foreach_modify(iter, &cuda_resource->ipc_mappings)
+	{
+		CudaIpcMapping *curr = dlist_container(CudaIpcMapping,
+											   chain, iter.cur);
+		if (curr->database_oid != database_oid ||
+			curr->table_oid != table_oid ||
+			curr->slot != slot)
+			continue;
+		if (memcmp(&curr->handle, &m_handle, sizeof(CUipcMemHandle)) == 0)
+		{
+			curr->invalid = false;
+			ipcmap = curr;
+		}
+		else
+		{
+			/* buffer was reallocated, so the old mapping is stale */
+			curr->invalid = true;
+			if (curr->refcnt == 0)
+				__cudaIpcMappingClose(cuda_resource, curr);
+		}
+	}
+
+	if (!ipcmap)
+	{
+		ipcmap = calloc(1, sizeof(CudaIpcMapping));
+		if (!ipcmap)
+		{
+			rc = CUDA_ERROR_OUT_OF_MEMORY;
+			goto out_unlock;
+		}
+		GPUCONTEXT_PUSH(gcontext);
+		rc = cuIpcOpenMemHandle(&ipcmap->ptr, m_handle,
+								CU_IPC_MEM_LAZY_ENABLE_PEER_ACCESS);
+		GPUCONTEXT_POP(gcontext);
+		if (rc != CUDA_SUCCESS)
+		{
+			free(ipcmap);
+			goto out_unlock;
+		}
+		ipcmap->database_oid = database_oid;
+		ipcmap->table_oid = table_oid;
+		ipcmap->slot = slot;
+		memcpy(&ipcmap->handle, &m_handle, sizeof(CUipcMemHandle));
+		dlist_push_head(&cuda_resource->ipc_mappings, &ipcmap->chain);
+	}
+	ipcmap->refcnt++;
+	*p_deviceptr = ipcmap->ptr;
+out_unlock:
+	pthreadMutexUnlock(&cuda_resource->ipc_mutex);
+	return rc;
+}
+
+/*
+ * gpuIpcCloseMemHandleCached
+ *
+ * It releases the mapping acquired by gpuIpcOpenMemHandleCached(). The
+ * mapping is kept open for the later use, unless it is already invalid.
+ */
+void
+gpuIpcCloseMemHandleCached(GpuContext *gcontext, CUdeviceptr m_deviceptr)
+{
+	CudaResource   *cuda_resource = &cuda_resources_array[gcontext->cuda_dindex];
+	dlist_iter		iter;
+
+	pthreadMutexLock(&cuda_resource->ipc_mutex);
+	dlist_foreach(iter, &cuda_resource->ipc_mappings)
+	{
+		CudaIpcMapping *ipcmap = dlist_container(CudaIpcMapping,
+												 chain, iter.cur);
+		if (ipcmap->ptr == m_deviceptr)
+		{
+			Assert(ipcmap->refcnt > 0);
+			if (--ipcmap->refcnt == 0 && ipcmap->invalid)
+				__cudaIpcMappingClose(cuda_resource, ipcmap);
+			pthreadMutexUnlock(&cuda_resource->ipc_mutex);
+			return;
+		}
+	}
+	pthreadMutexUnlock(&cuda_resource->ipc_mutex);
+	wnotice("Bug? GPU cache mapping (IPC) %p was not tracked",
+			(void *)m_deviceptr);
+}
+
+/*
+ * gpuIpcInvalidateMemHandleCached
+ *
+ * It closes the mappings of the GPU cache buffers of the supplied table,
+ * or all the tables of the database if InvalidOid. The mappings in use are
+ * closed when they are released.
+ */
+void
+gpuIpcInvalidateMemHandleCached(Oid database_oid, Oid table_oid)
+{
+	int			dindex;
+
+	for (dindex=0; dindex < numDevAttrs; dindex++)
+	{
+		CudaResource   *cuda_resource = &cuda_resources_array[dindex];
+		dlist_mutable_iter iter;
+
+		if (!cuda_resource->cuda_context)
+			continue;
+		pthreadMutexLock(&cuda_resource->ipc_mutex);
+		dlist_foreach_modify(iter, &cuda_resource->ipc_mappings)
+		{
+			CudaIpcMapping *ipcmap = dlist_container(CudaIpcMapping,
+													 chain, iter.cur);
+			if (ipcmap->database_oid != database_oid ||
+				(OidIsValid(table_oid) && ipcmap->table_oid != table_oid))
+				continue;
+			ipcmap->invalid = true;
+			if (ipcmap->refcnt == 0)
+				__cudaIpcMappingClose(cuda_resource, ipcmap);
+		}
+		pthreadMutexUnlock(&cuda_resource->ipc_mutex);
+	}
+}
+
 /*
  * __gpuIpcOpenMemHandle
  */
@@ -314,6 +553,7 @@ __gpuIpcOpenMemHandle(GpuContext *gcontext,
 {
 	ResourceTracker *tracker;
 	CUdeviceptr	m_deviceptr;
+	size_t		bytesize = 0;
 	CUresult	rc = CUDA_ERROR_OUT_OF_MEMORY;
 	dlist_iter	iter;
 	int			i;
@@ -344,6 +584,10 @@ __gpuIpcOpenMemHandle(GpuContext *gcontext,
 
 	GPUCONTEXT_PUSH(gcontext);
 	rc = cuIpcOpenMemHandle(&m_deviceptr, m_handle, flags);
+	/* size of the mapped region; only for the accounting */
+	if (rc == CUDA_SUCCESS &&
+		cuMemGetAddressRange(NULL, &bytesize, m_deviceptr) != CUDA_SUCCESS)
+		bytesize = 0;
 	GPUCONTEXT_POP(gcontext);
 	if (rc != CUDA_SUCCESS)
 		goto error;
@@ -356,10 +600,13 @@ __gpuIpcOpenMemHandle(GpuContext *gcontext,
 	tracker->u.ipcmem.ptr = m_deviceptr;
 	memcpy(&tracker->u.ipcmem.handle, &m_handle, sizeof(CUipcMemHandle));
 	tracker->u.ipcmem.mapcount = 1;
+	tracker->u.ipcmem.bytesize = bytesize;
 
 	dlist_push_tail(&gcontext->restrack[tracker->crc % RESTRACK_HASHSIZE],
 					&tracker->chain);
 	SpinLockRelease(&gcontext->restrack_lock);
+	if (bytesize > 0)
+		gpuContextUpdateMemUsage(gcontext, bytesize);
 
 	*p_deviceptr = m_deviceptr;
 
@@ -408,6 +655,9 @@ gpuIpcCloseMemHandle(GpuContext *gcontext, CUdeviceptr m_deviceptr)
 			GPUCONTEXT_POP(gcontext);
 			
 			SpinLockRelease(&gcontext->restrack_lock);
+			if (tracker->u.ipcmem.bytesize > 0)
+				gpuContextUpdateMemUsage(gcontext,
+										 -(int64)tracker->u.ipcmem.bytesize);
 			free(tracker);
 
 			return rc;
@@ -597,6 +847,7 @@ ReleaseLocalResources(GpuContext *gcontext, bool normal_exit)
 			(!cuda_resource->can_reuse ||
 			 !pgstrom_reuse_cuda_context))
 		{
+			__cudaIpcMappingCloseAll(cuda_resource);
 			rc = cuCtxDestroy(cuda_resource->cuda_context);
 			if (rc != CUDA_SUCCESS)
 				elog(WARNING, "failed on cuCtxDestroy: %s", errorText(rc));
@@ -663,6 +914,94 @@ GpuContextWorkerReportError(int elevel,
 	siglongjmp(*GpuWorkerExceptionStack, 1);
 }
 
+/*
+ * gpuTaskTimerBegin / gpuTaskTimerRecord / gpuTaskTimerEnd
+ *
+ * Per-phase timing of GpuTask by CUDA events on the per-thread stream.
+ * The interval BEGIN..KERN_BEGIN is considered as DMA send, KERN_BEGIN..
+ * KERN_END as kernel execution, and KERN_END..END as DMA receive.
+ * Only when EXPLAIN ANALYZE is running (gtask->with_timer).
+ */
+static void
+gpuTaskTimerBegin(GpuTask *gtask)
+{
+	CUresult	rc;
+	int			i;
+
+	gtask->timer_mask = 0;
+	if (!gtask->with_timer)
+		return;
+	for (i=0; i < GPUTASK_TIMER__NUM_EVENTS; i++)
+	{
+		if (gtask->ev_timer[i])
+			continue;
+		rc = cuEventCreate(&gtask->ev_timer[i], CU_EVENT_DEFAULT);
+		if (rc != CUDA_SUCCESS)
+			werror("failed on cuEventCreate: %s", errorText(rc));
+	}
+	gpuTaskTimerRecord(gtask, GPUTASK_TIMER__BEGIN);
+}
+
+void
+gpuTaskTimerRecord(GpuTask *gtask, int event)
+{
+	CUresult	rc;
+
+	Assert(event >= 0 && event < GPUTASK_TIMER__NUM_EVENTS);
+	/* # of kernel launches are counted regardless of the timer */
+	if (event == GPUTASK_TIMER__KERN_BEGIN)
+		gtask->num_kern_exec++;
+	if (!gtask->with_timer || !gtask->ev_timer[event])
+		return;
+	/* only the first kernel launch is the beginning */
+	if (event == GPUTASK_TIMER__KERN_BEGIN &&
+		(gtask->timer_mask & (1U << event)) != 0)
+		return;
+	rc = cuEventRecord(gtask->ev_timer[event], CU_STREAM_PER_THREAD);
+	if (rc != CUDA_SUCCESS)
+		werror("failed on cuEventRecord: %s", errorText(rc));
+	gtask->timer_mask |= (1U << event);
+}
+
+static void
+gpuTaskTimerEnd(GpuTask *gtask)
+{
+	const cl_uint required = ((1U << GPUTASK_TIMER__NUM_EVENTS) - 1);
+	float		elapsed[GPUTASK_TIMER__NUM_EVENTS - 1];
+	CUresult	rc;
+	int			i;
+
+	if (!gtask->with_timer)
+		return;
+	gpuTaskTimerRecord(gtask, GPUTASK_TIMER__END);
+	rc = cuEventSynchronize(gtask->ev_timer[GPUTASK_TIMER__END]);
+	if (rc != CUDA_SUCCESS)
+		werror("failed on cuEventSynchronize: %s", errorText(rc));
+	/* timing is valid only if all the events were recorded */
+	if ((gtask->timer_mask & required) == required)
+	{
+		for (i=0; i < GPUTASK_TIMER__NUM_EVENTS - 1; i++)
+		{
+			rc = cuEventElapsedTime(&elapsed[i],
+									gtask->ev_timer[i],
+									gtask->ev_timer[i+1]);
+			if (rc != CUDA_SUCCESS)
+				werror("failed on cuEventElapsedTime: %s", errorText(rc));
+		}
+		gtask->tv_dma_send  += (cl_ulong)(1000.0 * elapsed[0]);
+		gtask->tv_kern_exec += (cl_ulong)(1000.0 * elapsed[1]);
+		gtask->tv_dma_recv  += (cl_ulong)(1000.0 * elapsed[2]);
+	}
+	for (i=0; i < GPUTASK_TIMER__NUM_EVENTS; i++)
+	{
+		rc = cuEventDestroy(gtask->ev_timer[i]);
+		if (rc != CUDA_SUCCESS)
+			werror("failed on cuEventDestroy: %s", errorText(rc));
+		gtask->ev_timer[i] = NULL;
+	}
+	gtask->timer_mask = 0;
+}
+
 /*
  * GpuContextWorkerMain
  */
@@ -671,9 +1010,19 @@ __thread CUevent		CU_EVENT_PER_THREAD = NULL;
 static void *
 GpuContextWorkerMain(void *arg)
 {
+#ifdef WITH_NVTX
+	static const char *gpu_task_kind_labels[] = {
+		"gpuscan_process_task",
+		"gpujoin_process_task",
+		"gpupreagg_process_task",
+		"gpusort_process_task",
+		"plcuda_process_task",
+	};
+#endif
 	GpuContext	   *gcontext = arg;
 	dlist_node	   *dnode;
 	GpuTask		   *gtask;
+	volatile bool	task_admitted = false;
 	CUresult		rc;
 
 	/* setup worker index */
@@ -704,6 +1053,10 @@ GpuContextWorkerMain(void *arg)
 			CUmodule	cuda_module;
 			cl_int		retval;
 			bool		is_wakeup;
+			cl_uint		num_kern_exec;
+			instr_time	tv_start;
+			instr_time	tv_end;
+			uint64		nvtx_range;
 
 			pthreadMutexLock(&gcontext->worker_mutex);
 			/* workers are required to terminate, so exit */
@@ -755,7 +1108,40 @@ GpuContextWorkerMain(void *arg)
 			 * <0 : GpuTask gets completed successfully, and the
 			 *      handler wants to release GpuTask immediately.
 			 */
+			if (!gpuTaskAdmit(gcontext))
+			{
+				/* GpuContext is shutting down during admission wait */
+				pthreadMutexLock(&gcontext->worker_mutex);
+				dlist_push_tail(&gcontext->pending_tasks,
+								&gtask->chain);
+				gts->num_running_tasks--;
+				pthreadMutexUnlock(&gcontext->worker_mutex);
+				break;
+			}
+			task_admitted = true;
+			INSTR_TIME_SET_CURRENT(tv_start);
+			num_kern_exec = gtask->num_kern_exec;
+			gpuTaskTimerBegin(gtask);
+			nvtx_range = pgstromNvtxBegin(gpu_task_kind_labels[gtask->task_kind],
+										  gts, gtask->task_id);
 			retval = gts->cb_process_task(gtask, cuda_module);
+			pgstromNvtxEnd(nvtx_range);
+			if (retval > 0)
+			{
+				/* discard the timing of the attempt; it shall be retried */
+				gtask->num_kern_exec = num_kern_exec;
+				gtask->timer_mask = 0;
+			}
+			gpuTaskTimerEnd(gtask);
+			INSTR_TIME_SET_CURRENT(tv_end);
+			INSTR_TIME_SUBTRACT(tv_end, tv_start);
+			gtask->process_usec = INSTR_TIME_GET_MICROSEC(tv_end);
+			if (retval <= 0)
+				gpuMemStatTask(gcontext,
+							   gtask->num_kern_exec - num_kern_exec,
+							   gtask->process_usec);
+			gpuTaskAdmitRelease(gcontext);
+			task_admitted = false;
 			if (retval > 0)
 			{
 				pg_usleep(20000L);		/* 20ms */
@@ -828,6 +1214,8 @@ GpuContextWorkerMain(void *arg)
 	}
 	STROM_CATCH();
 	{
+		if (task_admitted)
+			gpuTaskAdmitRelease(gcontext);
 		/* Wake up and terminate other workers also */
 		pthreadMutexLock(&gcontext->worker_mutex);
 		pg_atomic_write_u32(&gcontext->terminate_workers, 1);
@@ -902,6 +1290,8 @@ activate_cuda_context(GpuContext *gcontext)
 	cuda_resource->cuda_context = cuda_context;
 	cuda_resource->refcnt = 1;
 	cuda_resource->can_reuse = true;
+	pthreadMutexInit(&cuda_resource->ipc_mutex, 0);
+	dlist_init(&cuda_resource->ipc_mappings);
 }
 
 /*
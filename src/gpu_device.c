@@ -42,7 +42,41 @@ static struct {
 #undef DEV_ATTR
 };
 
+/*
+ * Per-device cost model
+ *
+ * pg_strom.gpu_dma_cost and pg_strom.gpu_operator_cost are tuned for
+ * a PCIe 3.0 x16 host interface and a V100-class device. The measured
+ * throughput of each device adjusts them by the ratio to the reference.
+ */
+#define COST_MODEL_FILENAME			"pg_strom_cost_model.dat"
+#define COST_MODEL_REF_DMA_BW		12.0e9		/* 12GB/s */
+#define COST_MODEL_REF_KERN_BW		750.0e9		/* 750GB/s */
+#define COST_MODEL_BUFSZ			(64UL << 20)	/* 64MB */
+#define COST_MODEL_NLOOPS			20
+
+typedef struct
+{
+	double		dma_bandwidth;		/* bytes/sec; 0 if not calibrated */
+	double		kern_bandwidth;		/* bytes/sec; 0 if not calibrated */
+	TimestampTz	calibrated_at;
+} GpuCostModelDevice;
+
+typedef struct
+{
+	slock_t		lock;
+	double		dma_cost_factor;		/* average of the devices */
+	double		operator_cost_factor;	/* average of the devices */
+	GpuCostModelDevice devices[FLEXIBLE_ARRAY_MEMBER];
+} GpuCostModelHead;
+
+static GpuCostModelHead *gpu_cost_model = NULL;
+static shmem_startup_hook_type shmem_startup_next = NULL;
+static bool		pgstrom_device_cost_model;	/* GUC */
+
 /* declaration */
+Datum pgstrom_gpu_cost_model(PG_FUNCTION_ARGS);
+Datum pgstrom_calibrate_cost_model(PG_FUNCTION_ARGS);
 Datum pgstrom_device_info(PG_FUNCTION_ARGS);
 Datum pgstrom_gpu_device_name(PG_FUNCTION_ARGS);
 Datum pgstrom_gpu_global_memsize(PG_FUNCTION_ARGS);
@@ -324,6 +358,253 @@ pgstrom_collect_gpu_device(void)
 	return false;
 }
 
+/*
+ * pgstrom_device_dma_cost / pgstrom_device_operator_cost
+ *
+ * pg_strom.gpu_dma_cost and pg_strom.gpu_operator_cost adjusted by the
+ * calibrated throughput of the installed devices. As GpuTasks are
+ * distributed to all the devices unless the relation has an affinity,
+ * the average of the devices is applied.
+ */
+static double
+gpuCostModelFactor(double ref, double measured)
+{
+	if (measured <= 0.0)
+		return 1.0;
+	return Min(Max(ref / measured, 0.1), 10.0);
+}
+
+double
+pgstrom_device_dma_cost(void)
+{
+	double		factor = 1.0;
+
+	if (gpu_cost_model && pgstrom_device_cost_model)
+	{
+		SpinLockAcquire(&gpu_cost_model->lock);
+		factor = gpu_cost_model->dma_cost_factor;
+		SpinLockRelease(&gpu_cost_model->lock);
+	}
+	return pgstrom_gpu_dma_cost * factor;
+}
+
+double
+pgstrom_device_operator_cost(void)
+{
+	double		factor = 1.0;
+
+	if (gpu_cost_model && pgstrom_device_cost_model)
+	{
+		SpinLockAcquire(&gpu_cost_model->lock);
+		factor = gpu_cost_model->operator_cost_factor;
+		SpinLockRelease(&gpu_cost_model->lock);
+	}
+	return pgstrom_gpu_operator_cost * factor;
+}
+
+/*
+ * gpuCostModelUpdateFactors - must be called under the lock
+ */
+static void
+gpuCostModelUpdateFactors(void)
+{
+	double		dma_factor = 0.0;
+	double		op_factor = 0.0;
+	int			i;
+
+	for (i=0; i < numDevAttrs; i++)
+	{
+		GpuCostModelDevice *dcost = &gpu_cost_model->devices[i];
+
+		dma_factor += gpuCostModelFactor(COST_MODEL_REF_DMA_BW,
+										 dcost->dma_bandwidth);
+		op_factor  += gpuCostModelFactor(COST_MODEL_REF_KERN_BW,
+										 dcost->kern_bandwidth);
+	}
+	gpu_cost_model->dma_cost_factor = dma_factor / (double)numDevAttrs;
+	gpu_cost_model->operator_cost_factor = op_factor / (double)numDevAttrs;
+}
+
+/*
+ * gpuCostModelLoadFile / gpuCostModelSaveFile
+ *
+ * The calibrated throughput is saved on the data directory, identified by
+ * the device UUID, to survive restart and reordering of the devices.
+ */
+static void
+gpuCostModelLoadFile(void)
+{
+	FILE	   *filp;
+	char		linebuf[256];
+	char		uuid[48];
+	double		dma_bw;
+	double		kern_bw;
+	int64		ts;
+	int			i;
+
+	filp = AllocateFile(COST_MODEL_FILENAME, "r");
+	if (!filp)
+	{
+		if (errno != ENOENT)
+			elog(LOG, "could not open \"%s\": %m", COST_MODEL_FILENAME);
+		return;
+	}
+	while (fgets(linebuf, sizeof(linebuf), filp) != NULL)
+	{
+		if (sscanf(linebuf, "%47s %lf %lf " INT64_FORMAT,
+				   uuid, &dma_bw, &kern_bw, &ts) != 4)
+			continue;
+		for (i=0; i < numDevAttrs; i++)
+		{
+			if (strcmp(devAttrs[i].DEV_UUID, uuid) == 0)
+			{
+				gpu_cost_model->devices[i].dma_bandwidth  = dma_bw;
+				gpu_cost_model->devices[i].kern_bandwidth = kern_bw;
+				gpu_cost_model->devices[i].calibrated_at  = (TimestampTz)ts;
+				break;
+			}
+		}
+	}
+	FreeFile(filp);
+}
+
+static void
+gpuCostModelSaveFile(GpuCostModelDevice *devices)
+{
+	const char *tmpname = COST_MODEL_FILENAME ".tmp";
+	FILE	   *filp;
+	int			i;
+
+	filp = AllocateFile(tmpname, "w");
+	if (!filp)
+		elog(ERROR, "could not open \"%s\": %m", tmpname);
+	for (i=0; i < numDevAttrs; i++)
+	{
+		if (devices[i].calibrated_at == 0)
+			continue;
+		fprintf(filp, "%s %.0f %.0f " INT64_FORMAT "\n",
+				devAttrs[i].DEV_UUID,
+				devices[i].dma_bandwidth,
+				devices[i].kern_bandwidth,
+				(int64)devices[i].calibrated_at);
+	}
+	if (FreeFile(filp) != 0)
+		elog(ERROR, "could not write \"%s\": %m", tmpname);
+	durable_rename(tmpname, COST_MODEL_FILENAME, ERROR);
+}
+
+/*
+ * gpuCostModelMeasure
+ *
+ * It measures the bandwidth of DMA from the pinned host memory, and the
+ * throughput of the device memory copy kernel; the SQL workloads by
+ * PG-Strom are mostly device memory bound.
+ */
+static void
+gpuCostModelMeasure(int dindex, GpuCostModelDevice *dcost)
+{
+	CUdevice	cuda_device;
+	CUcontext	cuda_context;
+	CUdeviceptr	m_src = 0UL;
+	CUdeviceptr	m_dst = 0UL;
+	void	   *h_buf = NULL;
+	CUevent		ev_start = NULL;
+	CUevent		ev_stop = NULL;
+	float		dma_msec = 0.0;
+	float		kern_msec = 0.0;
+	const char *fn_name;
+	CUresult	rc;
+	int			i;
+
+	rc = gpuInit(0);
+	if (rc != CUDA_SUCCESS)
+		elog(ERROR, "failed on cuInit: %s", errorText(rc));
+	rc = cuDeviceGet(&cuda_device, devAttrs[dindex].DEV_ID);
+	if (rc != CUDA_SUCCESS)
+		elog(ERROR, "failed on cuDeviceGet: %s", errorText(rc));
+	rc = cuCtxCreate(&cuda_context, CU_CTX_SCHED_AUTO, cuda_device);
+	if (rc != CUDA_SUCCESS)
+		elog(ERROR, "failed on cuCtxCreate: %s", errorText(rc));
+
+#define __CHECK(expr)							\
+	do {										\
+		fn_name = #expr;						\
+		if ((rc = (expr)) != CUDA_SUCCESS)		\
+			goto bailout;						\
+	} while(0)
+
+	__CHECK(cuMemAlloc(&m_src, COST_MODEL_BUFSZ));
+	__CHECK(cuMemAlloc(&m_dst, COST_MODEL_BUFSZ));
+	__CHECK(cuMemAllocHost(&h_buf, COST_MODEL_BUFSZ));
+	__CHECK(cuEventCreate(&ev_start, CU_EVENT_DEFAULT));
+	__CHECK(cuEventCreate(&ev_stop, CU_EVENT_DEFAULT));
+	memset(h_buf, 0xff, COST_MODEL_BUFSZ);
+
+	/* DMA from the pinned host memory */
+	__CHECK(cuMemcpyHtoD(m_src, h_buf, COST_MODEL_BUFSZ));	/* warm up */
+	__CHECK(cuEventRecord(ev_start, NULL));
+	for (i=0; i < COST_MODEL_NLOOPS; i++)
+		__CHECK(cuMemcpyHtoDAsync(m_src, h_buf, COST_MODEL_BUFSZ, NULL));
+	__CHECK(cuEventRecord(ev_stop, NULL));
+	__CHECK(cuEventSynchronize(ev_stop));
+	__CHECK(cuEventElapsedTime(&dma_msec, ev_start, ev_stop));
+
+	/* device memory copy; both of read and write are counted */
+	__CHECK(cuMemcpyDtoD(m_dst, m_src, COST_MODEL_BUFSZ));	/* warm up */
+	__CHECK(cuEventRecord(ev_start, NULL));
+	for (i=0; i < COST_MODEL_NLOOPS; i++)
+		__CHECK(cuMemcpyDtoDAsync(m_dst, m_src, COST_MODEL_BUFSZ, NULL));
+	__CHECK(cuEventRecord(ev_stop, NULL));
+	__CHECK(cuEventSynchronize(ev_stop));
+	__CHECK(cuEventElapsedTime(&kern_msec, ev_start, ev_stop));
+#undef __CHECK
+	rc = CUDA_SUCCESS;
+bailout:
+	if (ev_stop)
+		cuEventDestroy(ev_stop);
+	if (ev_start)
+		cuEventDestroy(ev_start);
+	if (h_buf)
+		cuMemFreeHost(h_buf);
+	if (m_dst)
+		cuMemFree(m_dst);
+	if (m_src)
+		cuMemFree(m_src);
+	cuCtxDestroy(cuda_context);
+	if (rc != CUDA_SUCCESS)
+		elog(ERROR, "failed on %s: %s", fn_name, errorText(rc));
+
+	dcost->dma_bandwidth = ((double)COST_MODEL_BUFSZ * COST_MODEL_NLOOPS /
+							((double)Max(dma_msec, 0.001) / 1000.0));
+	dcost->kern_bandwidth = (2.0 * (double)COST_MODEL_BUFSZ * COST_MODEL_NLOOPS /
+							 ((double)Max(kern_msec, 0.001) / 1000.0));
+	dcost->calibrated_at = GetCurrentTimestamp();
+}
+
+/*
+ * pgstrom_startup_gpu_device
+ */
+static void
+pgstrom_startup_gpu_device(void)
+{
+	bool		found;
+
+	if (shmem_startup_next)
+		(*shmem_startup_next)();
+
+	gpu_cost_model = ShmemInitStruct("GPU Device Cost Model",
+									 offsetof(GpuCostModelHead,
+											  devices[numDevAttrs]),
+									 &found);
+	if (found)
+		elog(ERROR, "Bug? GPU Device Cost Model exists");
+	memset(gpu_cost_model, 0, offsetof(GpuCostModelHead,
+									   devices[numDevAttrs]));
+	SpinLockInit(&gpu_cost_model->lock);
+	gpuCostModelLoadFile();
+	gpuCostModelUpdateFactors();
+}
+
 /*
  * pgstrom_init_gpu_device
  */
@@ -399,6 +680,19 @@ pgstrom_init_gpu_device(void)
 							GUC_NOT_IN_SAMPLE | GUC_UNIT_KB,
 							NULL, NULL, NULL);
 
+	/* pg_strom.device_cost_model */
+	DefineCustomBoolVariable("pg_strom.device_cost_model",
+							 "Enables to adjust GPU cost factors by the calibrated device throughput",
+							 NULL,
+							 &pgstrom_device_cost_model,
+							 true,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	RequestAddinShmemSpace(MAXALIGN(offsetof(GpuCostModelHead,
+											 devices[numDevAttrs])));
+	shmem_startup_next = shmem_startup_hook;
+	shmem_startup_hook = pgstrom_startup_gpu_device;
 }
 
 /*
@@ -456,6 +750,76 @@ gpuOccupancyMaxPotentialBlockSize(int *p_min_grid_sz,
 	return rc;
 }
 
+/*
+ * Per-thread cache of the launch configuration
+ *
+ * GPU tasks launch the same set of kernel functions chunk-by-chunk, and
+ * the occupancy calculator has to be consulted for each launch. It is not
+ * free, so CUDA worker threads remember the latest results per kernel
+ * function. The CUfunction handles are valid during the lifetime of
+ * the worker thread, because CUDA modules are unloaded only on release
+ * of the GpuContext, after the termination of its worker threads.
+ */
+#define LAUNCH_CONFIG_CACHE_NSLOTS		32
+
+typedef struct
+{
+	CUfunction	kern_function;
+	CUdevice	cuda_device;
+	size_t		dynamic_shmem_per_block;
+	size_t		dynamic_shmem_per_thread;
+	cl_int		grid_sz;
+	cl_int		block_sz;
+} LaunchConfigCache;
+
+static __thread LaunchConfigCache launch_config_cache[LAUNCH_CONFIG_CACHE_NSLOTS];
+
+static inline LaunchConfigCache *
+lookupLaunchConfigCache(CUfunction kern_function)
+{
+	uintptr_t	hash = ((uintptr_t) kern_function >> 4);
+
+	hash ^= (hash >> 7);
+	return &launch_config_cache[hash % LAUNCH_CONFIG_CACHE_NSLOTS];
+}
+
+/*
+ * setupKernelCacheConfig
+ *
+ * Heavy JIT kernels (PostGIS, numeric, ...) often spill registers to the
+ * local memory, and it is cached by L1 that shares the on-chip memory with
+ * the shared memory. If the kernel function uses no shared memory at all,
+ * we prefer the largest L1 cache for them. It is just a hint; the driver
+ * can choose another carveout if a launch requires shared memory.
+ */
+static void
+setupKernelCacheConfig(CUfunction kern_function,
+					   size_t dynamic_shmem_per_block,
+					   size_t dynamic_shmem_per_thread)
+{
+	int			local_sz;
+	int			shared_sz;
+	CUresult	rc;
+
+	if (dynamic_shmem_per_block > 0 || dynamic_shmem_per_thread > 0)
+		return;
+	rc = cuFuncGetAttribute(&shared_sz,
+							CU_FUNC_ATTRIBUTE_SHARED_SIZE_BYTES,
+							kern_function);
+	if (rc != CUDA_SUCCESS || shared_sz > 0)
+		return;
+	rc = cuFuncGetAttribute(&local_sz,
+							CU_FUNC_ATTRIBUTE_LOCAL_SIZE_BYTES,
+							kern_function);
+	if (rc != CUDA_SUCCESS || local_sz == 0)
+		return;
+	rc = cuFuncSetAttribute(kern_function,
+							CU_FUNC_ATTRIBUTE_PREFERRED_SHARED_MEMORY_CARVEOUT,
+							CU_SHAREDMEM_CARVEOUT_MAX_L1);
+	if (rc != CUDA_SUCCESS)
+		wnotice("failed on cuFuncSetAttribute: %s", errorText(rc));
+}
+
 CUresult
 gpuOptimalBlockSize(int *p_grid_sz,
 					int *p_block_sz,
@@ -464,6 +828,7 @@ gpuOptimalBlockSize(int *p_grid_sz,
 					size_t dynamic_shmem_per_block,
 					size_t dynamic_shmem_per_thread)
 {
+	LaunchConfigCache *lc_cache = NULL;
 	cl_int		mp_count;
 	cl_int		min_grid_sz;
 	cl_int		max_block_sz;
@@ -471,6 +836,26 @@ gpuOptimalBlockSize(int *p_grid_sz,
 	size_t		dynamic_shmem_sz;
 	CUresult	rc;
 
+	/* only CUDA worker threads can use the cache; see above */
+	if (GpuWorkerCurrentContext != NULL)
+	{
+		lc_cache = lookupLaunchConfigCache(kern_function);
+		if (lc_cache->kern_function == kern_function &&
+			lc_cache->cuda_device == cuda_device &&
+			lc_cache->dynamic_shmem_per_block == dynamic_shmem_per_block &&
+			lc_cache->dynamic_shmem_per_thread == dynamic_shmem_per_thread)
+		{
+			*p_grid_sz = lc_cache->grid_sz;
+			*p_block_sz = lc_cache->block_sz;
+			return CUDA_SUCCESS;
+		}
+		/* first launch of the kernel function on this thread */
+		if (lc_cache->kern_function != kern_function)
+			setupKernelCacheConfig(kern_function,
+								   dynamic_shmem_per_block,
+								   dynamic_shmem_per_thread);
+	}
+
 	rc = cuDeviceGetAttribute(&mp_count,
 							  CU_DEVICE_ATTRIBUTE_MULTIPROCESSOR_COUNT,
 							  cuda_device);
@@ -498,6 +883,15 @@ gpuOptimalBlockSize(int *p_grid_sz,
 					 max_multiplicity) * mp_count;
 	*p_block_sz = max_block_sz;
 
+	if (lc_cache)
+	{
+		lc_cache->kern_function = kern_function;
+		lc_cache->cuda_device = cuda_device;
+		lc_cache->dynamic_shmem_per_block = dynamic_shmem_per_block;
+		lc_cache->dynamic_shmem_per_thread = dynamic_shmem_per_thread;
+		lc_cache->grid_sz = *p_grid_sz;
+		lc_cache->block_sz = *p_block_sz;
+	}
 	return CUDA_SUCCESS;
 }
 
@@ -683,3 +1077,121 @@ pgstrom_device_info(PG_FUNCTION_ARGS)
 	SRF_RETURN_NEXT(fncxt, HeapTupleGetDatum(tuple));
 }
 PG_FUNCTION_INFO_V1(pgstrom_device_info);
+
+/*
+ * pgstrom_gpu_cost_model - SQL function to dump the per-device cost model
+ *
+ * pgstrom_calibrate_cost_model - SQL function to measure the throughput of
+ * the installed devices, then save the cost model.
+ */
+static Datum
+__pgstrom_gpu_cost_model(FunctionCallInfo fcinfo, bool calibrate)
+{
+	FuncCallContext *fncxt;
+	GpuCostModelDevice *devices;
+	GpuCostModelDevice *dcost;
+	int			dindex;
+	Datum		values[7];
+	bool		isnull[7];
+	HeapTuple	tuple;
+
+	if (SRF_IS_FIRSTCALL())
+	{
+		TupleDesc		tupdesc;
+		MemoryContext	oldcxt;
+
+		fncxt = SRF_FIRSTCALL_INIT();
+		oldcxt = MemoryContextSwitchTo(fncxt->multi_call_memory_ctx);
+
+		tupdesc = CreateTemplateTupleDesc(7);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 1, "device_nr",
+						   INT4OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 2, "device_name",
+						   TEXTOID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 3, "dma_bandwidth",
+						   FLOAT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 4, "kernel_bandwidth",
+						   FLOAT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 5, "dma_cost_factor",
+						   FLOAT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 6, "operator_cost_factor",
+						   FLOAT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 7, "calibrated_at",
+						   TIMESTAMPTZOID, -1, 0);
+		fncxt->tuple_desc = BlessTupleDesc(tupdesc);
+
+		devices = palloc0(sizeof(GpuCostModelDevice) * Max(numDevAttrs, 1));
+		if (gpu_cost_model)
+		{
+			if (calibrate)
+			{
+				for (dindex=0; dindex < numDevAttrs; dindex++)
+				{
+					CHECK_FOR_INTERRUPTS();
+					gpuCostModelMeasure(dindex, &devices[dindex]);
+				}
+				gpuCostModelSaveFile(devices);
+				SpinLockAcquire(&gpu_cost_model->lock);
+				memcpy(gpu_cost_model->devices, devices,
+					   sizeof(GpuCostModelDevice) * numDevAttrs);
+				gpuCostModelUpdateFactors();
+				SpinLockRelease(&gpu_cost_model->lock);
+			}
+			else
+			{
+				SpinLockAcquire(&gpu_cost_model->lock);
+				memcpy(devices, gpu_cost_model->devices,
+					   sizeof(GpuCostModelDevice) * numDevAttrs);
+				SpinLockRelease(&gpu_cost_model->lock);
+			}
+		}
+		fncxt->user_fctx = devices;
+
+		MemoryContextSwitchTo(oldcxt);
+	}
+	fncxt = SRF_PERCALL_SETUP();
+	devices = fncxt->user_fctx;
+
+	dindex = fncxt->call_cntr;
+	if (!gpu_cost_model || dindex >= numDevAttrs)
+		SRF_RETURN_DONE(fncxt);
+	dcost = &devices[dindex];
+
+	memset(isnull, 0, sizeof(isnull));
+	values[0] = Int32GetDatum(devAttrs[dindex].DEV_ID);
+	values[1] = CStringGetTextDatum(devAttrs[dindex].DEV_NAME);
+	if (dcost->calibrated_at == 0)
+	{
+		isnull[2] = true;
+		isnull[3] = true;
+		isnull[6] = true;
+	}
+	else
+	{
+		/* in MB/s */
+		values[2] = Float8GetDatum(dcost->dma_bandwidth / 1048576.0);
+		values[3] = Float8GetDatum(dcost->kern_bandwidth / 1048576.0);
+		values[6] = TimestampTzGetDatum(dcost->calibrated_at);
+	}
+	values[4] = Float8GetDatum(gpuCostModelFactor(COST_MODEL_REF_DMA_BW,
+												  dcost->dma_bandwidth));
+	values[5] = Float8GetDatum(gpuCostModelFactor(COST_MODEL_REF_KERN_BW,
+												  dcost->kern_bandwidth));
+	tuple = heap_form_tuple(fncxt->tuple_desc, values, isnull);
+
+	SRF_RETURN_NEXT(fncxt, HeapTupleGetDatum(tuple));
+}
+
+Datum
+pgstrom_gpu_cost_model(PG_FUNCTION_ARGS)
+{
+	return __pgstrom_gpu_cost_model(fcinfo, false);
+}
+PG_FUNCTION_INFO_V1(pgstrom_gpu_cost_model);
+
+Datum
+pgstrom_calibrate_cost_model(PG_FUNCTION_ARGS)
+{
+	return __pgstrom_gpu_cost_model(fcinfo, true);
+}
+PG_FUNCTION_INFO_V1(pgstrom_calibrate_cost_model);
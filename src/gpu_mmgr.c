@@ -10,6 +10,7 @@
  * it under the terms of the PostgreSQL License.
  */
 #include "pg_strom.h"
+#include <sys/syscall.h>
 
 #define GPUMEM_CHUNKSZ_MAX_BIT		30		/* 1GB */
 #define GPUMEM_CHUNKSZ_MIN_BIT		14		/* 16KB */
@@ -57,6 +58,34 @@ typedef struct
 	GpuMemChunk		gm_chunks[FLEXIBLE_ARRAY_MEMBER];
 } GpuMemSegment;
 
+/*
+ * GpuMemSlab - a chunk of the smallest class (16KB) that is divided into
+ * equal-sized slots for small allocations; like kern_parambuf or selection
+ * bitmap of small chunks. It is linked to gm_slab_normal or gm_slab_managed
+ * of GpuContext. Slabs with free slots are kept at the head of the list.
+ * The extra pointer of slab allocation is tagged by GPUMEM_SLAB_EXTRA().
+ */
+typedef struct
+{
+	dlist_node		chain;
+	GpuMemSegment  *gm_seg;		/* segment that owns m_chunk */
+	CUdeviceptr		m_chunk;	/* head of the chunk */
+	cl_int			sclass;		/* size of slots in bits */
+	cl_int			nslots;
+	cl_int			nfree;
+	uint64			freemap;	/* bitmap of free slots */
+} GpuMemSlab;
+
+#define GPUMEM_SLAB_EXTRA(slab)			((void *)((uintptr_t)(slab) | 1UL))
+#define GPUMEM_EXTRA_IS_SLAB(extra)		(((uintptr_t)(extra) & 1UL) != 0)
+#define GPUMEM_EXTRA_GET_SLAB(extra)	((GpuMemSlab *)((uintptr_t)(extra) & ~1UL))
+
+/* priority of GpuTasks on admission control */
+#define GPUTASK_PRIORITY__LOW		0
+#define GPUTASK_PRIORITY__NORMAL	1
+#define GPUTASK_PRIORITY__HIGH		2
+#define GPUTASK_PRIORITY__NUMS		3
+
 /* statistics of GPU memory usage (shared; per device) */
 //to be used for memory release request mechanism
 typedef struct
@@ -65,6 +94,20 @@ typedef struct
 	pg_atomic_uint64	normal_usage;
 	pg_atomic_uint64	managed_usage;
 	pg_atomic_uint64	iomap_usage;
+	pg_atomic_uint64	preserved_usage;
+	pg_atomic_uint64	device_free_size;	/* by cuMemGetInfo; bgworker updates */
+	/* admission control of GpuTasks across backends */
+	pg_atomic_uint32	num_running_tasks;
+	pg_atomic_uint32	num_waiting_tasks[GPUTASK_PRIORITY__NUMS];
+	/* cumulative activity statistics; pgstrom.stat_gpu_device */
+	pg_atomic_uint64	num_tasks;			/* # of GpuTasks processed */
+	pg_atomic_uint64	num_kern_exec;		/* # of kernel launches */
+	pg_atomic_uint64	dma_send_bytes;		/* RAM-to-GPU DMA */
+	pg_atomic_uint64	dma_recv_bytes;		/* GPU-to-RAM DMA */
+	pg_atomic_uint64	p2p_bytes;			/* SSD-to-GPU P2P DMA */
+	pg_atomic_uint64	busy_usec;			/* time consumed by GpuTasks */
+	pg_atomic_uint64	peak_usage;			/* high-water mark of usage */
+	pg_atomic_uint64	stat_reset_ts;		/* timestamp of the last reset */
 } GpuMemStatistics;
 
 /*
@@ -116,6 +159,16 @@ static shmem_startup_hook_type shmem_startup_next = NULL;
 static GpuMemStatistics *gm_stat_array = NULL;
 static int			gpu_memory_segment_size_kb;	/* GUC */
 static size_t		gm_segment_sz;	/* bytesize */
+static int			pgstrom_max_device_tasks;	/* GUC */
+static bool			pgstrom_memory_aware_planning;	/* GUC */
+static int			pgstrom_query_priority;		/* GUC */
+static int			pgstrom_max_gpu_memory_per_query;	/* GUC; MB */
+static struct config_enum_entry pgstrom_query_priority_options[] = {
+	{"low",    GPUTASK_PRIORITY__LOW,    false},
+	{"normal", GPUTASK_PRIORITY__NORMAL, false},
+	{"high",   GPUTASK_PRIORITY__HIGH,   false},
+	{NULL, 0, false}
+};
 
 static bool			gpummgr_bgworker_got_signal = false;
 static GpuMemPreservedHead *gmemp_head = NULL;
@@ -201,6 +254,52 @@ gpuMemFreeChunk(GpuContext *gcontext,
     return CUDA_SUCCESS;
 }
 
+/*
+ * gpuMemFreeSlab
+ */
+static CUresult
+gpuMemFreeSlab(GpuContext *gcontext,
+			   CUdeviceptr m_deviceptr,
+			   GpuMemSlab *gm_slab)
+{
+	cl_int		index;
+
+	Assert(m_deviceptr >= gm_slab->m_chunk &&
+		   m_deviceptr <  gm_slab->m_chunk + GPUMEM_CHUNKSZ_MIN);
+	index = (m_deviceptr - gm_slab->m_chunk) >> gm_slab->sclass;
+	Assert(index >= 0 && index < gm_slab->nslots);
+
+	SpinLockAcquire(&gcontext->gm_slab_lock);
+	Assert((gm_slab->freemap & (1UL << index)) == 0);
+	gm_slab->freemap |= (1UL << index);
+	if (++gm_slab->nfree < gm_slab->nslots)
+	{
+		/* move to the head, because it now has free slots */
+		if (gm_slab->nfree == 1)
+		{
+			dlist_head *slab_list = (gm_slab->gm_seg->gm_kind == GpuMemKind__ManagedMemory
+									 ? gcontext->gm_slab_managed
+									 : gcontext->gm_slab_normal);
+			dlist_delete(&gm_slab->chain);
+			dlist_push_head(&slab_list[gm_slab->sclass - GPUMEM_SLAB_MIN_BIT],
+							&gm_slab->chain);
+		}
+		SpinLockRelease(&gcontext->gm_slab_lock);
+		return CUDA_SUCCESS;
+	}
+	/*
+	 * Release the slab once it gets empty; it allows gpuMemReclaimSegment()
+	 * to release the segment on idle time.
+	 */
+	dlist_delete(&gm_slab->chain);
+	SpinLockRelease(&gcontext->gm_slab_lock);
+
+	gpuMemFreeChunk(gcontext, gm_slab->m_chunk, gm_slab->gm_seg);
+	free(gm_slab);
+
+	return CUDA_SUCCESS;
+}
+
 /*
  * gpuMemFreeExtra
  */
@@ -218,6 +317,9 @@ gpuMemFreeExtra(GpuContext *gcontext,
 		rc = cuMemFree(m_deviceptr);
 	else if (extra == GPUMEM_HOST_RAW_EXTRA)
 		rc = cuMemFreeHost((void *)m_deviceptr);
+	else if (GPUMEM_EXTRA_IS_SLAB(extra))
+		rc = gpuMemFreeSlab(gcontext, m_deviceptr,
+							GPUMEM_EXTRA_GET_SLAB(extra));
 	else
 		rc = gpuMemFreeChunk(gcontext, m_deviceptr, (GpuMemSegment *)extra);
 	GPUCONTEXT_POP(gcontext);
@@ -266,7 +368,7 @@ __gpuMemAllocRaw(GpuContext *gcontext,
 	if (rc != CUDA_SUCCESS)
 		wnotice("failed on cuMemAlloc(%zu): %s", bytesize, errorText(rc));
 	else if (!trackGpuMem(gcontext, m_deviceptr,
-						  GPUMEM_DEVICE_RAW_EXTRA,
+						  GPUMEM_DEVICE_RAW_EXTRA, bytesize,
 						  filename, lineno))
 	{
 		cuMemFree(m_deviceptr);
@@ -299,7 +401,7 @@ __gpuMemAllocManagedRaw(GpuContext *gcontext,
 		wnotice("failed on cuMemAllocManaged(%zu): %s",
 				bytesize, errorText(rc));
 	else if (!trackGpuMem(gcontext, m_deviceptr,
-						  GPUMEM_DEVICE_RAW_EXTRA,
+						  GPUMEM_DEVICE_RAW_EXTRA, bytesize,
 						  filename, lineno))
 	{
 		cuMemFree(m_deviceptr);
@@ -314,6 +416,54 @@ __gpuMemAllocManagedRaw(GpuContext *gcontext,
 	return rc;
 }
 
+/*
+ * gpuMemHostBindNumaNode / gpuMemHostUnbindNumaNode
+ *
+ * Page-locked host memory is populated on allocation, according to the
+ * memory policy of the calling thread. So, we prefer the NUMA node that is
+ * local to the GPU device during the allocation, unless the thread already
+ * has its own policy; remote pinned buffers degrade the DMA bandwidth over
+ * the inter-socket link.
+ * We use the raw system call to avoid dependency on libnuma.
+ */
+#ifndef MPOL_DEFAULT
+#define MPOL_DEFAULT		0
+#endif
+#ifndef MPOL_PREFERRED
+#define MPOL_PREFERRED		1
+#endif
+#define GPUMEM_NUMA_MAXNODES	1024
+#define GPUMEM_NUMA_MASK_BITS	(BITS_PER_BYTE * sizeof(unsigned long))
+
+static bool
+gpuMemHostBindNumaNode(GpuContext *gcontext)
+{
+	int			numa_node_id = devAttrs[gcontext->cuda_dindex].NUMA_NODE_ID;
+	unsigned long nodemask[GPUMEM_NUMA_MAXNODES / GPUMEM_NUMA_MASK_BITS];
+	int			mode;
+
+	if (numa_node_id < 0 || numa_node_id >= GPUMEM_NUMA_MAXNODES)
+		return false;
+	/* respect the policy if someone (like numactl) already set up */
+	if (syscall(SYS_get_mempolicy, &mode, NULL, 0, NULL, 0) != 0 ||
+		mode != MPOL_DEFAULT)
+		return false;
+	memset(nodemask, 0, sizeof(nodemask));
+	nodemask[numa_node_id / GPUMEM_NUMA_MASK_BITS]
+		|= (1UL << (numa_node_id % GPUMEM_NUMA_MASK_BITS));
+	if (syscall(SYS_set_mempolicy, MPOL_PREFERRED,
+				nodemask, GPUMEM_NUMA_MAXNODES + 1) != 0)
+		return false;
+	return true;
+}
+
+static void
+gpuMemHostUnbindNumaNode(bool numa_bound)
+{
+	if (numa_bound)
+		syscall(SYS_set_mempolicy, MPOL_DEFAULT, NULL, 0);
+}
+
 /*
  * __gpuMemAllocHostRaw
  */
@@ -324,14 +474,17 @@ __gpuMemAllocHostRaw(GpuContext *gcontext,
 					 const char *filename, int lineno)
 {
 	void	   *hostptr;
+	bool		numa_bound;
 	CUresult	rc;
 
 	GPUCONTEXT_PUSH(gcontext);
+	numa_bound = gpuMemHostBindNumaNode(gcontext);
 	rc = cuMemAllocHost(&hostptr, bytesize);
+	gpuMemHostUnbindNumaNode(numa_bound);
 	if (rc != CUDA_SUCCESS)
 		wnotice("failed on cuMemAllocHost(%zu): %s", bytesize, errorText(rc));
 	else if (!trackGpuMem(gcontext, (CUdeviceptr)hostptr,
-						  GPUMEM_HOST_RAW_EXTRA,
+						  GPUMEM_HOST_RAW_EXTRA, 0,
 						  filename, lineno))
 	{
 		cuMemFreeHost(hostptr);
@@ -377,7 +530,7 @@ __gpuMemAllocDev(GpuContext *gcontext,
 		if (rc == CUDA_SUCCESS)
 		{
 			if (!trackGpuMem(gcontext, m_deviceptr,
-							 GPUMEM_DEVICE_RAW_EXTRA,
+							 GPUMEM_DEVICE_RAW_EXTRA, bytesize,
 							 filename, lineno))
 			{
 				cuMemFree(m_deviceptr);
@@ -431,6 +584,27 @@ gpuMemSplitChunk(GpuMemSegment *gm_seg, cl_int mclass)
 	return true;
 }
 
+/*
+ * gpuMemUpdatePeakUsage - update the high-water mark of device memory usage
+ */
+static void
+gpuMemUpdatePeakUsage(GpuMemStatistics *gm_stat)
+{
+	uint64		usage;
+	uint64		peak;
+
+	usage = (pg_atomic_read_u64(&gm_stat->normal_usage) +
+			 pg_atomic_read_u64(&gm_stat->managed_usage) +
+			 pg_atomic_read_u64(&gm_stat->iomap_usage));
+	peak = pg_atomic_read_u64(&gm_stat->peak_usage);
+	while (usage > peak)
+	{
+		if (pg_atomic_compare_exchange_u64(&gm_stat->peak_usage,
+										   &peak, usage))
+			break;
+	}
+}
+
 /*
  * gpuMemAllocChunk
  */
@@ -438,6 +612,7 @@ static CUresult
 gpuMemAllocChunk(GpuMemKind gm_kind,
 				 GpuContext *gcontext,
 				 CUdeviceptr *p_deviceptr,
+				 GpuMemSegment **p_gm_seg,
 				 cl_int mclass,
 				 const char *filename, int lineno)
 {
@@ -504,13 +679,20 @@ retry:
 				   (gm_chunk - gm_seg->gm_chunks) < nchunks);
 			i = gm_chunk - gm_seg->gm_chunks;
 			m_deviceptr = gm_seg->m_segment + i * unitsz;
-			if (!trackGpuMem(gcontext, m_deviceptr, gm_seg,
-							 filename, lineno))
+			if (p_gm_seg)
+			{
+				/* untracked chunk; caller shall release by itself */
+				*p_gm_seg = gm_seg;
+			}
+			else if (!trackGpuMem(gcontext, m_deviceptr, gm_seg,
+								  gm_kind == GpuMemKind__HostMemory
+								  ? 0 : (1UL << mclass),
+								  filename, lineno))
 			{
 				gpuMemFreeChunk(gcontext, m_deviceptr, gm_seg);
 				return CUDA_ERROR_OUT_OF_MEMORY;
 			}
-			*p_deviceptr = gm_seg->m_segment + i * unitsz;
+			*p_deviceptr = m_deviceptr;
 			return CUDA_SUCCESS;
 		}
 		SpinLockRelease(&gm_seg->lock);
@@ -573,8 +755,13 @@ retry:
 			break;
 
 		case GpuMemKind__HostMemory:
-			rc = cuMemHostAlloc((void **)&m_segment, gm_segment_sz,
-								CU_MEMHOSTALLOC_PORTABLE);
+			{
+				bool	numa_bound = gpuMemHostBindNumaNode(gcontext);
+
+				rc = cuMemHostAlloc((void **)&m_segment, gm_segment_sz,
+									CU_MEMHOSTALLOC_PORTABLE);
+				gpuMemHostUnbindNumaNode(numa_bound);
+			}
 			//wnotice("hostmem m_segment = %p - %p", (void *)m_segment, (void *)(m_segment - gm_segment_sz));
 			break;
 
@@ -636,9 +823,92 @@ retry:
 		default:
 			break;
 	}
+	gpuMemUpdatePeakUsage(gm_stat);
 	goto retry;
 }
 
+/*
+ * gpuMemAllocSlab - allocation of small device memory less than the
+ * smallest chunk size, by division of a chunk.
+ */
+static CUresult
+gpuMemAllocSlab(GpuMemKind gm_kind,
+				GpuContext *gcontext,
+				CUdeviceptr *p_deviceptr,
+				size_t bytesize,
+				const char *filename, int lineno)
+{
+	GpuMemSlab	   *gm_slab;
+	GpuMemSegment  *gm_seg;
+	dlist_head	   *slab_list;
+	CUdeviceptr		m_deviceptr;
+	CUdeviceptr		m_chunk;
+	cl_int			sclass = Max(get_next_log2(bytesize),
+								 GPUMEM_SLAB_MIN_BIT);
+	cl_int			index;
+	CUresult		rc;
+
+	Assert(sclass <= GPUMEM_SLAB_MAX_BIT);
+	Assert(gm_kind == GpuMemKind__NormalMemory ||
+		   gm_kind == GpuMemKind__ManagedMemory);
+	slab_list = (gm_kind == GpuMemKind__ManagedMemory
+				 ? &gcontext->gm_slab_managed[sclass - GPUMEM_SLAB_MIN_BIT]
+				 : &gcontext->gm_slab_normal[sclass - GPUMEM_SLAB_MIN_BIT]);
+	SpinLockAcquire(&gcontext->gm_slab_lock);
+	if (dlist_is_empty(slab_list) ||
+		(gm_slab = dlist_head_element(GpuMemSlab, chain,
+									  slab_list))->nfree == 0)
+	{
+		SpinLockRelease(&gcontext->gm_slab_lock);
+
+		/* no slabs with free slots, so allocate a new one */
+		gm_slab = calloc(1, sizeof(GpuMemSlab));
+		if (!gm_slab)
+			return CUDA_ERROR_OUT_OF_MEMORY;
+		rc = gpuMemAllocChunk(gm_kind, gcontext,
+							  &m_chunk, &gm_seg,
+							  GPUMEM_CHUNKSZ_MIN_BIT,
+							  filename, lineno);
+		if (rc != CUDA_SUCCESS)
+		{
+			free(gm_slab);
+			return rc;
+		}
+		gm_slab->gm_seg	= gm_seg;
+		gm_slab->m_chunk = m_chunk;
+		gm_slab->sclass	= sclass;
+		gm_slab->nslots	= (GPUMEM_CHUNKSZ_MIN >> sclass);
+		gm_slab->nfree	= gm_slab->nslots;
+		gm_slab->freemap = (gm_slab->nslots < 64
+							? (1UL << gm_slab->nslots) - 1
+							: ~0UL);
+		SpinLockAcquire(&gcontext->gm_slab_lock);
+		dlist_push_head(slab_list, &gm_slab->chain);
+	}
+	Assert(gm_slab->nfree > 0 && gm_slab->freemap != 0);
+	index = __builtin_ctzl(gm_slab->freemap);
+	gm_slab->freemap &= ~(1UL << index);
+	if (--gm_slab->nfree == 0)
+	{
+		/* slabs without free slots are kept at the tail */
+		dlist_delete(&gm_slab->chain);
+		dlist_push_tail(slab_list, &gm_slab->chain);
+	}
+	SpinLockRelease(&gcontext->gm_slab_lock);
+
+	m_deviceptr = gm_slab->m_chunk + ((size_t)index << sclass);
+	if (!trackGpuMem(gcontext, m_deviceptr,
+					 GPUMEM_SLAB_EXTRA(gm_slab),
+					 (1UL << sclass),
+					 filename, lineno))
+	{
+		gpuMemFreeSlab(gcontext, m_deviceptr, gm_slab);
+		return CUDA_ERROR_OUT_OF_MEMORY;
+	}
+	*p_deviceptr = m_deviceptr;
+	return CUDA_SUCCESS;
+}
+
 /*
  * gpuMemAlloc
  */
@@ -648,13 +918,17 @@ __gpuMemAlloc(GpuContext *gcontext,
 			  size_t bytesize,
 			  const char *filename, int lineno)
 {
+	if (bytesize <= (1UL << GPUMEM_SLAB_MAX_BIT))
+		return gpuMemAllocSlab(GpuMemKind__NormalMemory,
+							   gcontext, p_deviceptr, bytesize,
+							   filename, lineno);
 	if (bytesize <= gm_segment_sz / 2)
 	{
 		cl_int	mclass = Max(get_next_log2(bytesize),
 							 GPUMEM_CHUNKSZ_MIN_BIT);
 
 		return gpuMemAllocChunk(GpuMemKind__NormalMemory,
-								gcontext, p_deviceptr, mclass,
+								gcontext, p_deviceptr, NULL, mclass,
 								filename, lineno);
 	}
 	return __gpuMemAllocRaw(gcontext,
@@ -678,7 +952,7 @@ __gpuMemAllocIOMap(GpuContext *gcontext,
 							 GPUMEM_CHUNKSZ_MIN_BIT);
 
 		return gpuMemAllocChunk(GpuMemKind__IOMapMemory,
-								gcontext, p_deviceptr, mclass,
+								gcontext, p_deviceptr, NULL, mclass,
 								filename, lineno);
 	}
 	/*
@@ -704,6 +978,11 @@ __gpuMemAllocManaged(GpuContext *gcontext,
 					 int flags,
 					 const char *filename, int lineno)
 {
+	if (flags == CU_MEM_ATTACH_GLOBAL &&
+		bytesize <= (1UL << GPUMEM_SLAB_MAX_BIT))
+		return gpuMemAllocSlab(GpuMemKind__ManagedMemory,
+							   gcontext, p_deviceptr, bytesize,
+							   filename, lineno);
 	if (flags == CU_MEM_ATTACH_GLOBAL &&
 		bytesize <= gm_segment_sz / 2)
 	{
@@ -711,7 +990,7 @@ __gpuMemAllocManaged(GpuContext *gcontext,
 							 GPUMEM_CHUNKSZ_MIN_BIT);
 
 		return gpuMemAllocChunk(GpuMemKind__ManagedMemory,
-								gcontext, p_deviceptr, mclass,
+								gcontext, p_deviceptr, NULL, mclass,
 								filename, lineno);
 	}
 	return __gpuMemAllocManagedRaw(gcontext,
@@ -739,7 +1018,7 @@ __gpuMemAllocHost(GpuContext *gcontext,
 							 GPUMEM_CHUNKSZ_MIN_BIT);
 
 		rc = gpuMemAllocChunk(GpuMemKind__HostMemory,
-							  gcontext, &m_devptr, mclass,
+							  gcontext, &m_devptr, NULL, mclass,
 							  filename, lineno);
 		if (rc == CUDA_SUCCESS)
 			*p_hostptr = (void *)m_devptr;
@@ -1014,11 +1293,21 @@ gpuMemReclaimSegment(GpuContext *gcontext)
 void
 pgstrom_gpu_mmgr_init_gpucontext(GpuContext *gcontext)
 {
+	int		i;
+
 	pthreadRWLockInit(&gcontext->gm_rwlock);
 	dlist_init(&gcontext->gm_normal_list);
 	dlist_init(&gcontext->gm_iomap_list);
 	dlist_init(&gcontext->gm_managed_list);
 	dlist_init(&gcontext->gm_hostmem_list);
+	SpinLockInit(&gcontext->gm_slab_lock);
+	for (i=0; i < GPUMEM_SLAB_NCLASSES; i++)
+	{
+		dlist_init(&gcontext->gm_slab_normal[i]);
+		dlist_init(&gcontext->gm_slab_managed[i]);
+	}
+	pg_atomic_init_u64(&gcontext->gm_query_usage, 0);
+	pg_atomic_init_u64(&gcontext->gm_query_peak, 0);
 }
 
 /*
@@ -1035,6 +1324,22 @@ pgstrom_gpu_mmgr_cleanup_gpucontext(GpuContext *gcontext)
 	GpuMemSegment  *gm_seg;
 	dlist_node	   *dnode;
 	CUresult		rc;
+	int				i;
+
+	/* slabs are released with the segments below */
+	for (i=0; i < GPUMEM_SLAB_NCLASSES; i++)
+	{
+		while (!dlist_is_empty(&gcontext->gm_slab_normal[i]))
+		{
+			dnode = dlist_pop_head_node(&gcontext->gm_slab_normal[i]);
+			free(dlist_container(GpuMemSlab, chain, dnode));
+		}
+		while (!dlist_is_empty(&gcontext->gm_slab_managed[i]))
+		{
+			dnode = dlist_pop_head_node(&gcontext->gm_slab_managed[i]);
+			free(dlist_container(GpuMemSlab, chain, dnode));
+		}
+	}
 
 	while (!dlist_is_empty(&gcontext->gm_normal_list))
 	{
@@ -1125,6 +1430,9 @@ gpummgrHandleAllocPreserved(GpuMemPreservedRequest *gmemp_req)
 		gmemp->m_devptr = m_devptr;
 		gmemp->owner = gmemp_req->owner;
 		gmemp->ctime = GetCurrentTimestamp();
+
+		pg_atomic_add_fetch_u64(&gm_stat_array[gmemp->cuda_dindex].preserved_usage,
+								gmemp->bytesize);
 	}
 	PG_CATCH();
 	{
@@ -1160,6 +1468,8 @@ gpummgrHandleFreePreserved(GpuMemPreservedRequest *gmemp_req)
 	rc = cuMemFree(gmemp->m_devptr);
 	if (rc != CUDA_SUCCESS)
 		elog(WARNING, "failed on cuMemFree: %s", errorText(rc));
+	pg_atomic_sub_fetch_u64(&gm_stat_array[gmemp->cuda_dindex].preserved_usage,
+							gmemp->bytesize);
 
 	hash_search(gmemp_htab, &gmemp_req->m_handle, HASH_REMOVE, NULL);
 
@@ -1235,6 +1545,13 @@ gpummgrBgWorkerDispatch(int cuda_dindex)
 static bool
 gpummgrBgWorkerIdleTask(int cuda_dindex)
 {
+	GpuMemStatistics *gm_stat = &gm_stat_array[cuda_dindex];
+	size_t		free_size;
+	size_t		total_size;
+
+	/* publish the free device memory for memory-aware planning */
+	if (cuMemGetInfo(&free_size, &total_size) == CUDA_SUCCESS)
+		pg_atomic_write_u64(&gm_stat->device_free_size, free_size);
 	return true;
 }
 
@@ -1339,6 +1656,339 @@ pgstrom_device_preserved_meminfo(PG_FUNCTION_ARGS)
 }
 PG_FUNCTION_INFO_V1(pgstrom_device_preserved_meminfo);
 
+/*
+ * gpuMemAvailableForPlanning
+ *
+ * It returns the largest free device memory of the candidate GPUs (or all
+ * the GPUs if empty), according to the latest report by the bgworkers.
+ * Planner uses this value to avoid plans that cannot fit the device memory
+ * under the current load. It returns SIZE_MAX if disabled.
+ */
+size_t
+gpuMemAvailableForPlanning(const Bitmapset *optimal_gpus)
+{
+	size_t		avail_sz = 0;
+	int			i;
+
+	if (!pgstrom_memory_aware_planning || !gm_stat_array)
+		return SIZE_MAX;
+	for (i=0; i < numDevAttrs; i++)
+	{
+		GpuMemStatistics *gm_stat = &gm_stat_array[i];
+
+		if (!bms_is_empty(optimal_gpus) && !bms_is_member(i, optimal_gpus))
+			continue;
+		avail_sz = Max(avail_sz, pg_atomic_read_u64(&gm_stat->device_free_size));
+	}
+	return avail_sz;
+}
+
+/*
+ * pgstrom_gpu_memory_info - SQL function to dump device memory usage
+ */
+Datum pgstrom_gpu_memory_info(PG_FUNCTION_ARGS);
+
+Datum
+pgstrom_gpu_memory_info(PG_FUNCTION_ARGS)
+{
+	FuncCallContext *fncxt;
+	GpuMemStatistics *gm_stat;
+	int			dindex;
+	Datum		values[7];
+	bool		isnull[7];
+	HeapTuple	tuple;
+
+	if (SRF_IS_FIRSTCALL())
+	{
+		TupleDesc		tupdesc;
+		MemoryContext	oldcxt;
+
+		fncxt = SRF_FIRSTCALL_INIT();
+		oldcxt = MemoryContextSwitchTo(fncxt->multi_call_memory_ctx);
+
+		tupdesc = CreateTemplateTupleDesc(7);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 1, "device_nr",
+						   INT4OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 2, "total_size",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 3, "free_size",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 4, "normal_usage",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 5, "managed_usage",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 6, "iomap_usage",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 7, "preserved_usage",
+						   INT8OID, -1, 0);
+		fncxt->tuple_desc = BlessTupleDesc(tupdesc);
+		fncxt->user_fctx = 0;
+
+		MemoryContextSwitchTo(oldcxt);
+	}
+	fncxt = SRF_PERCALL_SETUP();
+
+	dindex = fncxt->call_cntr;
+	if (dindex >= numDevAttrs)
+		SRF_RETURN_DONE(fncxt);
+	gm_stat = &gm_stat_array[dindex];
+
+	memset(isnull, 0, sizeof(isnull));
+	values[0] = Int32GetDatum(devAttrs[dindex].DEV_ID);
+	values[1] = Int64GetDatum(gm_stat->total_size);
+	values[2] = Int64GetDatum(pg_atomic_read_u64(&gm_stat->device_free_size));
+	values[3] = Int64GetDatum(pg_atomic_read_u64(&gm_stat->normal_usage));
+	values[4] = Int64GetDatum(pg_atomic_read_u64(&gm_stat->managed_usage));
+	values[5] = Int64GetDatum(pg_atomic_read_u64(&gm_stat->iomap_usage));
+	values[6] = Int64GetDatum(pg_atomic_read_u64(&gm_stat->preserved_usage));
+
+	tuple = heap_form_tuple(fncxt->tuple_desc, values, isnull);
+
+	SRF_RETURN_NEXT(fncxt, HeapTupleGetDatum(tuple));
+}
+PG_FUNCTION_INFO_V1(pgstrom_gpu_memory_info);
+
+/*
+ * gpuMemStatDma / gpuMemStatTask
+ *
+ * Accumulation of the cumulative activity statistics per device. The former
+ * is called by the GPU worker threads on DMA requests, and the latter is
+ * called on completion of GpuTask.
+ */
+void
+gpuMemStatDma(size_t send_sz, size_t recv_sz)
+{
+	GpuContext *gcontext = GpuWorkerCurrentContext;
+	GpuMemStatistics *gm_stat;
+
+	if (!gcontext || !gm_stat_array)
+		return;
+	gm_stat = &gm_stat_array[gcontext->cuda_dindex];
+	if (send_sz > 0)
+		pg_atomic_add_fetch_u64(&gm_stat->dma_send_bytes, send_sz);
+	if (recv_sz > 0)
+		pg_atomic_add_fetch_u64(&gm_stat->dma_recv_bytes, recv_sz);
+}
+
+void
+gpuMemStatTask(GpuContext *gcontext, cl_uint num_kern_exec, cl_ulong busy_usec)
+{
+	GpuMemStatistics *gm_stat = &gm_stat_array[gcontext->cuda_dindex];
+
+	pg_atomic_add_fetch_u64(&gm_stat->num_tasks, 1);
+	pg_atomic_add_fetch_u64(&gm_stat->num_kern_exec, num_kern_exec);
+	pg_atomic_add_fetch_u64(&gm_stat->busy_usec, busy_usec);
+}
+
+/*
+ * pgstrom_stat_gpu_device - SQL function to dump cumulative statistics
+ * of GPU devices
+ */
+Datum pgstrom_stat_gpu_device(PG_FUNCTION_ARGS);
+
+Datum
+pgstrom_stat_gpu_device(PG_FUNCTION_ARGS)
+{
+	FuncCallContext *fncxt;
+	GpuMemStatistics *gm_stat;
+	int			dindex;
+	Datum		values[10];
+	bool		isnull[10];
+	HeapTuple	tuple;
+
+	if (SRF_IS_FIRSTCALL())
+	{
+		TupleDesc		tupdesc;
+		MemoryContext	oldcxt;
+
+		fncxt = SRF_FIRSTCALL_INIT();
+		oldcxt = MemoryContextSwitchTo(fncxt->multi_call_memory_ctx);
+
+		tupdesc = CreateTemplateTupleDesc(10);
+		TupleDescInitEntry(tupdesc, (AttrNumber)  1, "device_nr",
+						   INT4OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber)  2, "num_tasks",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber)  3, "kern_launches",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber)  4, "dma_send_bytes",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber)  5, "dma_recv_bytes",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber)  6, "p2p_bytes",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber)  7, "busy_time",
+						   FLOAT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber)  8, "memory_usage",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber)  9, "memory_peak",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 10, "stats_reset",
+						   TIMESTAMPTZOID, -1, 0);
+		fncxt->tuple_desc = BlessTupleDesc(tupdesc);
+		fncxt->user_fctx = 0;
+
+		MemoryContextSwitchTo(oldcxt);
+	}
+	fncxt = SRF_PERCALL_SETUP();
+
+	dindex = fncxt->call_cntr;
+	if (dindex >= numDevAttrs)
+		SRF_RETURN_DONE(fncxt);
+	gm_stat = &gm_stat_array[dindex];
+
+	memset(isnull, 0, sizeof(isnull));
+	values[0] = Int32GetDatum(devAttrs[dindex].DEV_ID);
+	values[1] = Int64GetDatum(pg_atomic_read_u64(&gm_stat->num_tasks));
+	values[2] = Int64GetDatum(pg_atomic_read_u64(&gm_stat->num_kern_exec));
+	values[3] = Int64GetDatum(pg_atomic_read_u64(&gm_stat->dma_send_bytes));
+	values[4] = Int64GetDatum(pg_atomic_read_u64(&gm_stat->dma_recv_bytes));
+	values[5] = Int64GetDatum(pg_atomic_read_u64(&gm_stat->p2p_bytes));
+	values[6] = Float8GetDatum((double)pg_atomic_read_u64(&gm_stat->busy_usec) / 1000.0);
+	values[7] = Int64GetDatum(pg_atomic_read_u64(&gm_stat->normal_usage) +
+							  pg_atomic_read_u64(&gm_stat->managed_usage) +
+							  pg_atomic_read_u64(&gm_stat->iomap_usage));
+	values[8] = Int64GetDatum(pg_atomic_read_u64(&gm_stat->peak_usage));
+	values[9] = TimestampTzGetDatum(pg_atomic_read_u64(&gm_stat->stat_reset_ts));
+
+	tuple = heap_form_tuple(fncxt->tuple_desc, values, isnull);
+
+	SRF_RETURN_NEXT(fncxt, HeapTupleGetDatum(tuple));
+}
+PG_FUNCTION_INFO_V1(pgstrom_stat_gpu_device);
+
+/*
+ * gpuMemStatReset - reset the cumulative statistics of GPU devices
+ */
+void
+gpuMemStatReset(void)
+{
+	TimestampTz	now = GetCurrentTimestamp();
+	int			i;
+
+	for (i=0; i < numDevAttrs; i++)
+	{
+		GpuMemStatistics *gm_stat = &gm_stat_array[i];
+
+		pg_atomic_write_u64(&gm_stat->num_tasks, 0);
+		pg_atomic_write_u64(&gm_stat->num_kern_exec, 0);
+		pg_atomic_write_u64(&gm_stat->dma_send_bytes, 0);
+		pg_atomic_write_u64(&gm_stat->dma_recv_bytes, 0);
+		pg_atomic_write_u64(&gm_stat->p2p_bytes, 0);
+		pg_atomic_write_u64(&gm_stat->busy_usec, 0);
+		pg_atomic_write_u64(&gm_stat->peak_usage, 0);
+		gpuMemUpdatePeakUsage(gm_stat);
+		pg_atomic_write_u64(&gm_stat->stat_reset_ts, now);
+	}
+}
+
+/*
+ * gpuTaskAdmit / gpuTaskAdmitRelease
+ *
+ * Admission control of GpuTasks on a particular GPU device across all the
+ * backends. A GpuTask can run if the number of running GpuTasks on the
+ * device is less than pg_strom.max_device_tasks, and no GpuTasks with
+ * higher pg_strom.query_priority are waiting for admission. Elsewhere,
+ * the worker thread waits for the admission, rather than oversubscribing
+ * the GPU device.
+ * It returns false, if GpuContext is terminated during the wait.
+ */
+bool
+gpuTaskAdmit(GpuContext *gcontext)
+{
+	GpuMemStatistics *gm_stat = &gm_stat_array[gcontext->cuda_dindex];
+	int			priority = pgstrom_query_priority;
+	bool		is_waiting = false;
+	uint32		nrunning;
+	int			k;
+
+	Assert(priority >= 0 && priority < GPUTASK_PRIORITY__NUMS);
+	for (;;)
+	{
+		for (k=priority+1; k < GPUTASK_PRIORITY__NUMS; k++)
+		{
+			if (pg_atomic_read_u32(&gm_stat->num_waiting_tasks[k]) > 0)
+				break;
+		}
+		if (k == GPUTASK_PRIORITY__NUMS)
+		{
+			nrunning = pg_atomic_read_u32(&gm_stat->num_running_tasks);
+			while (pgstrom_max_device_tasks == 0 ||
+				   nrunning < pgstrom_max_device_tasks)
+			{
+				if (pg_atomic_compare_exchange_u32(&gm_stat->num_running_tasks,
+												   &nrunning,
+												   nrunning + 1))
+				{
+					if (is_waiting)
+						pg_atomic_fetch_sub_u32(&gm_stat->num_waiting_tasks[priority], 1);
+					return true;
+				}
+			}
+		}
+		if (!is_waiting)
+		{
+			pg_atomic_fetch_add_u32(&gm_stat->num_waiting_tasks[priority], 1);
+			is_waiting = true;
+		}
+		if (pg_atomic_read_u32(&gcontext->terminate_workers) != 0)
+		{
+			pg_atomic_fetch_sub_u32(&gm_stat->num_waiting_tasks[priority], 1);
+			return false;
+		}
+		pg_usleep(1000L);	/* 1ms */
+	}
+}
+
+void
+gpuTaskAdmitRelease(GpuContext *gcontext)
+{
+	GpuMemStatistics *gm_stat = &gm_stat_array[gcontext->cuda_dindex];
+
+	pg_atomic_fetch_sub_u32(&gm_stat->num_running_tasks, 1);
+}
+
+/*
+ * gpuMemUsageRatio - ratio of the device memory consumed by PG-Strom
+ */
+double
+gpuMemUsageRatio(GpuContext *gcontext)
+{
+	GpuMemStatistics *gm_stat = &gm_stat_array[gcontext->cuda_dindex];
+	uint64		usage;
+
+	if (gm_stat->total_size == 0)
+		return 0.0;
+	usage = (pg_atomic_read_u64(&gm_stat->normal_usage) +
+			 pg_atomic_read_u64(&gm_stat->managed_usage) +
+			 pg_atomic_read_u64(&gm_stat->iomap_usage));
+	return (double) usage / (double) gm_stat->total_size;
+}
+
+/*
+ * gpuMemQueryLimitExceeded - checks whether the device memory consumed by
+ * the query (GpuContext) already reaches pg_strom.max_gpu_memory_per_query.
+ */
+bool
+gpuMemQueryLimitExceeded(GpuContext *gcontext)
+{
+	uint64		limit;
+
+	if (pgstrom_max_gpu_memory_per_query == 0)
+		return false;
+	limit = (uint64)pgstrom_max_gpu_memory_per_query << 20;
+	return (pg_atomic_read_u64(&gcontext->gm_query_usage) >= limit);
+}
+
+/*
+ * gpuMemQueryPeakUsage - peak device memory consumption by the query
+ */
+size_t
+gpuMemQueryPeakUsage(GpuContext *gcontext)
+{
+	return pg_atomic_read_u64(&gcontext->gm_query_peak);
+}
+
 /*
  * pgstrom_startup_gpu_mmgr
  */
@@ -1362,7 +2012,18 @@ pgstrom_startup_gpu_mmgr(void)
 		elog(ERROR, "Bug? GPU Device Memory Statistics exists");
 	memset(gm_stat_array, 0, required);
 	for (i=0; i < numDevAttrs; i++)
-		gm_stat_array[i].total_size = devAttrs[i].DEV_TOTAL_MEMSZ;
+	{
+		GpuMemStatistics *gm_stat = &gm_stat_array[i];
+		int		k;
+
+		gm_stat->total_size = devAttrs[i].DEV_TOTAL_MEMSZ;
+		pg_atomic_init_u64(&gm_stat->preserved_usage, 0);
+		pg_atomic_init_u64(&gm_stat->device_free_size, gm_stat->total_size);
+		pg_atomic_init_u32(&gm_stat->num_running_tasks, 0);
+		for (k=0; k < GPUTASK_PRIORITY__NUMS; k++)
+			pg_atomic_init_u32(&gm_stat->num_waiting_tasks[k], 0);
+		pg_atomic_init_u64(&gm_stat->stat_reset_ts, GetCurrentTimestamp());
+	}
 
 	/*
 	 * GpuMemPreservedHead
@@ -1411,6 +2072,46 @@ pgstrom_init_gpu_mmgr(void)
 							PGC_POSTMASTER,
 							GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE | GUC_UNIT_KB,
 							NULL, NULL, NULL);
+	/*
+	 * admission control of GpuTasks across backends
+	 */
+	DefineCustomIntVariable("pg_strom.max_device_tasks",
+							"max number of concurrent GpuTasks per GPU device (0 = unlimited)",
+							NULL,
+							&pgstrom_max_device_tasks,
+							0,
+							0,
+							INT_MAX,
+							PGC_SIGHUP,
+							GUC_NOT_IN_SAMPLE,
+							NULL, NULL, NULL);
+	DefineCustomEnumVariable("pg_strom.query_priority",
+							 "priority of GpuTasks on admission control",
+							 NULL,
+							 &pgstrom_query_priority,
+							 GPUTASK_PRIORITY__NORMAL,
+							 pgstrom_query_priority_options,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	DefineCustomIntVariable("pg_strom.max_gpu_memory_per_query",
+							"max GPU device memory consumed by a query (0 = unlimited)",
+							NULL,
+							&pgstrom_max_gpu_memory_per_query,
+							0,
+							0,
+							INT_MAX,
+							PGC_USERSET,
+							GUC_NOT_IN_SAMPLE | GUC_UNIT_MB,
+							NULL, NULL, NULL);
+	DefineCustomBoolVariable("pg_strom.memory_aware_planning",
+							 "Enables to consider the current free GPU device memory on planning",
+							 NULL,
+							 &pgstrom_memory_aware_planning,
+							 true,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
 	segment_sz = (size_t)gpu_memory_segment_size_kb << 10;
 	if (segment_sz % pgstrom_chunk_size() != 0)
 		elog(ERROR, "pg_strom.gpu_memory_segment_size(%dkB) must be multiple number of pg_strom.chunk_size(%dkB)",
@@ -1478,6 +2179,7 @@ __gpuMemCopyFromSSD_Block(GpuContext *gcontext,
 							   CU_STREAM_PER_THREAD);
 		if (rc != CUDA_SUCCESS)
 			werror("failed on cuMemcpyHtoDAsync: %s", errorText(rc));
+		gpuMemStatDma(pds->kds.length, 0);
 		return;
 	}
 	Assert(pds->nblocks_uncached <= pds->kds.nitems);
@@ -1494,6 +2196,8 @@ __gpuMemCopyFromSSD_Block(GpuContext *gcontext,
 	if (rc != CUDA_SUCCESS)
 		werror("failed on cuMemcpyHtoDAsync: %s", errorText(rc));
 
+	gpuMemStatDma(length, 0);
+
 	/* (2) kick SSD2GPU P2P DMA, if any */
 	if (pds->iovec)
 	{
@@ -1502,6 +2206,8 @@ __gpuMemCopyFromSSD_Block(GpuContext *gcontext,
 							 gm_seg->iomap_handle,
 							 offset,
 							 pds->iovec);
+		pg_atomic_add_fetch_u64(&gm_stat_array[gcontext->cuda_dindex].p2p_bytes,
+								(uint64)pds->nblocks_uncached * BLCKSZ);
 	}
 }
 
@@ -1519,15 +2225,22 @@ __gpuMemCopyFromSSD_Arrow(GpuContext *gcontext,
 
 	Assert(pds->kds.format == KDS_FORMAT_ARROW);
 
-	/* (1) RAM2GPU DMA (header portion) */
+	/* (1) RAM2GPU DMA (header portion, and decompression table if any) */
 	head_sz = KERN_DATA_STORE_HEAD_LENGTH(&pds->kds);
+	if (pds->gpu_decompress)
+	{
+		kern_arrow_decomp *kdecomp = KERN_DATA_STORE_ARROW_DECOMP(&pds->kds);
+
+		head_sz += KERN_ARROW_DECOMP_LENGTH(kdecomp->nitems);
+	}
 	rc = cuMemcpyHtoDAsync(m_kds,
 						   &pds->kds,
 						   head_sz,
 						   CU_STREAM_PER_THREAD);
 	if (rc != CUDA_SUCCESS)
 		werror("failed on cuMemcpyHtoDAsync: %s", errorText(rc));
-	
+	gpuMemStatDma(head_sz, 0);
+
 	/* (2) SSD2GPU P2P DMA */
 	if (pds->iovec)
 	{
@@ -1536,6 +2249,9 @@ __gpuMemCopyFromSSD_Arrow(GpuContext *gcontext,
 							 gm_seg->iomap_handle,
 							 m_kds - gm_seg->m_segment,
 							 pds->iovec);
+		if (pds->kds.length > head_sz)
+			pg_atomic_add_fetch_u64(&gm_stat_array[gcontext->cuda_dindex].p2p_bytes,
+									pds->kds.length - head_sz);
 	}
 }
 
@@ -1547,7 +2263,9 @@ gpuMemCopyFromSSD(CUdeviceptr m_kds, pgstrom_data_store *pds)
 {
 	GpuContext	   *gcontext = GpuWorkerCurrentContext;
 	GpuMemSegment  *gm_seg;
+	uint64			nvtx_range;
 
+	nvtx_range = pgstromNvtxBegin("gpuMemCopyFromSSD", NULL, 0);
 	/* ensure the @m_kds is exactly i/o mapped buffer */
 	Assert(gcontext != NULL);
 	gm_seg = lookupGpuMem(gcontext, m_kds);
@@ -1568,4 +2286,5 @@ gpuMemCopyFromSSD(CUdeviceptr m_kds, pgstrom_data_store *pds)
 				   pds->kds.format);
 			break;
 	}
+	pgstromNvtxEnd(nvtx_range);
 }
@@ -11,6 +11,58 @@
  */
 #include "pg_strom.h"
 
+/*
+ * GpuQueryStatEntry / GpuQueryStatHead
+ *
+ * Cumulative statistics of GPU activity per query (pgstrom.stat_gpu_query),
+ * identified by the user, database and query identifier; like what
+ * pg_stat_statements doing.
+ */
+#define GPU_QUERY_STAT_NSLOTS		251
+
+typedef struct
+{
+	Oid				userid;
+	Oid				dbid;
+	uint64			queryid;
+} GpuQueryStatKey;
+
+typedef struct
+{
+	dlist_node		chain;
+	GpuQueryStatKey	key;
+	uint64			num_nodes;			/* # of GPU nodes executed */
+	uint64			num_tasks;			/* # of GpuTasks processed */
+	uint64			kern_exec;			/* # of kernel launches */
+	uint64			gpu_usec;			/* time consumed by GpuTasks */
+	uint64			fallback_chunks;	/* # of chunks by CPU fallback */
+	uint64			fallback_rows;		/* # of rows by CPU fallback */
+	uint64			jit_usec;			/* wait time for JIT build */
+} GpuQueryStatEntry;
+
+typedef struct
+{
+	LWLock			lock;
+	dlist_head		free_list;
+	dlist_head		hash_slots[GPU_QUERY_STAT_NSLOTS];
+	GpuQueryStatEntry entries[FLEXIBLE_ARRAY_MEMBER];
+} GpuQueryStatHead;
+
+static shmem_startup_hook_type shmem_startup_next = NULL;
+static GpuQueryStatHead *gq_stat_head = NULL;
+static bool		pgstrom_adaptive_chunk_size;	/* GUC */
+static bool		pgstrom_adaptive_execution;		/* GUC */
+static int		pgstrom_adaptive_execution_samples;	/* GUC */
+static int		pgstrom_stat_gpu_query_max;		/* GUC */
+static bool		pgstrom_enable_async_append;	/* GUC */
+static ExecutorStart_hook_type executor_start_next = NULL;
+
+/* adaptive chunk size of heap scan */
+#define CHUNK_SIZE_MIN				(pgstrom_chunk_size() / 16)
+#define CHUNK_SIZE_INITIAL			(pgstrom_chunk_size() / 4)
+#define CHUNK_SIZE_NUM_SAMPLES		4
+#define CHUNK_SIZE_STABLE_SAMPLES	64
+
 /*
  * see definition at xact.c
  *
@@ -68,6 +120,101 @@ __appendXactIdVector(StringInfo buf)
 	return poffset;
 }
 
+/*
+ * __appendXactSnapshot
+ *
+ * It puts kern_snapshot, for MVCC visibility checks on the device side.
+ * Commit status of the recent pg_strom.gpu_mvcc_clog_xids transactions
+ * prior to the snapshot's xmax is also attached, as a hint for the tuples
+ * without HEAP_XMIN/XMAX_* bits. Transactions in progress from the
+ * standpoint of the snapshot are marked as KERN_XACT_STATUS__IN_PROGRESS,
+ * so the device code never sees its status changed after the snapshot.
+ * Snapshot with overflowed subxip[] is not supported (see
+ * heapScanDeviceMvccCheck), because sub-transactions in progress are not
+ * identifiable without pg_subtrans.
+ */
+static cl_uint
+__appendXactSnapshot(StringInfo buf, GpuTaskState *gts)
+{
+	Relation	relation = gts->css.ss.ss_currentRelation;
+	Snapshot	snapshot = gts->css.ss.ps.state->es_snapshot;
+	cl_uint		poffset = buf->len;
+	kern_snapshot *ksnap;
+	cl_uchar   *clog;
+	TransactionId clog_base;
+	TransactionId xid;
+	cl_uint		xcnt;
+	cl_uint		nxids = 0;
+	size_t		sz;
+	uint32		i;
+
+	if (!pgstrom_gpu_mvcc_check ||
+		!relation ||
+		!RelationCanUseNvmeStrom(relation) ||
+		gts->af_state || gts->gc_state ||
+		!IsMVCCSnapshot(snapshot) ||
+		snapshot->takenDuringRecovery ||
+		snapshot->suboverflowed)
+		return 0;	/* null; device code always runs CPU fallback */
+
+	xcnt = snapshot->xcnt + snapshot->subxcnt;
+	clog_base = snapshot->xmax;
+	if (TransactionIdIsNormal(snapshot->xmax))
+	{
+		TransactionId	oldest_xid = ShmemVariableCache->oldestClogXid;
+
+		while (nxids < pgstrom_gpu_mvcc_clog_xids)
+		{
+			xid = clog_base;
+			TransactionIdRetreat(xid);
+			if (!TransactionIdIsNormal(xid) ||
+				TransactionIdPrecedes(xid, oldest_xid))
+				break;
+			clog_base = xid;
+			nxids++;
+		}
+	}
+	sz = KERN_SNAPSHOT_LENGTH(xcnt, nxids);
+	enlargeStringInfo(buf, MAXALIGN(sz));
+	ksnap = (kern_snapshot *)(buf->data + buf->len);
+	buf->len += MAXALIGN(sz);
+
+	memset(ksnap, 0, MAXALIGN(sz));
+	SET_VARSIZE(ksnap, sz);
+	ksnap->xmin = snapshot->xmin;
+	ksnap->xmax = snapshot->xmax;
+	ksnap->xcnt = xcnt;
+	ksnap->clog_base = clog_base;
+	ksnap->clog_nxids = nxids;
+	memcpy(ksnap->xip, snapshot->xip,
+		   sizeof(TransactionId) * snapshot->xcnt);
+	memcpy(ksnap->xip + snapshot->xcnt, snapshot->subxip,
+		   sizeof(TransactionId) * snapshot->subxcnt);
+	clog = KERN_SNAPSHOT_CLOG(ksnap);
+	for (i=0, xid = clog_base; i < nxids; i++, TransactionIdAdvance(xid))
+	{
+		XLogRecPtr	lsn;
+		int			status = KERN_XACT_STATUS__IN_PROGRESS;
+
+		if (!pgstromXidInMVCCSnapshot(xid, snapshot))
+		{
+			switch (TransactionIdGetStatus(xid, &lsn))
+			{
+				case TRANSACTION_STATUS_COMMITTED:
+					status = KERN_XACT_STATUS__COMMITTED;
+					break;
+				case TRANSACTION_STATUS_ABORTED:
+					status = KERN_XACT_STATUS__ABORTED;
+					break;
+				default:
+					break;
+			}
+		}
+		clog[i >> 2] |= (status << ((i & 3) << 1));
+	}
+	return poffset;
+}
+
 /*
  * pgstromSetupKernParambuf
  *
@@ -90,10 +237,11 @@ __pgstromSetupKernParambuf(GpuTaskState *gts)
 	int			index = 0;
 	int			nparams = list_length(used_params);
 	cl_uint		xid_vec_offset;
+	cl_uint		snapshot_offset;
 
 	/* seek to the head of variable length field */
 	offset = MAXALIGN(offsetof(kern_parambuf,
-							   poffset[nparams + 1]));
+							   poffset[nparams + 2]));
 	initStringInfo(&str);
 	enlargeStringInfo(&str, offset);
 	memset(str.data, 0, offset);
@@ -257,13 +405,16 @@ __pgstromSetupKernParambuf(GpuTaskState *gts)
 		index++;
 	}
 	xid_vec_offset = __appendXactIdVector(&str);
+	snapshot_offset = __appendXactSnapshot(&str, gts);
 
-	/* array of current transaction id */
+	/* array of current transaction id, and MVCC snapshot */
 	Assert(MAXALIGN(str.len) == str.len);
 	kparams = (kern_parambuf *)str.data;
 	kparams->xactStartTimestamp = GetCurrentTransactionStartTimestamp();
 	kparams->xactIdVector = nparams;
 	kparams->poffset[nparams++] = xid_vec_offset;
+	kparams->xactSnapshot = nparams;
+	kparams->poffset[nparams++] = snapshot_offset;
 	kparams->length = str.len;
 	kparams->nparams = nparams;
 
@@ -324,6 +475,8 @@ pgstromInitGpuTaskState(GpuTaskState *gts,
 	gts->program_id = INVALID_PROGRAM_ID;	/* to be set later */
 	gts->kern_params = 0UL;					/* to be set later */
 	gts->used_params = used_params;
+	gts->query_id = estate->es_plannedstmt->queryId;
+	gts->last_task_id = 0;
 
 	if (relation)
 	{
@@ -371,6 +524,9 @@ pgstromInitGpuTaskState(GpuTaskState *gts,
 	}
 	gts->outer_refs = outer_refs;
 	gts->scan_done = false;
+	gts->fetch_memcxt = AllocSetContextCreate(estate->es_query_cxt,
+											  "PDS fetch tuple",
+											  ALLOCSET_DEFAULT_SIZES);
 
 	InstrInit(&gts->outer_instrument, estate->es_instrument);
 	gts->scan_overflow = NULL;
@@ -386,10 +542,355 @@ pgstromInitGpuTaskState(GpuTaskState *gts,
 	/* callbacks shall be set by the caller */
 	dlist_init(&gts->ready_tasks);
 	gts->num_ready_tasks = 0;
+	gts->num_async_limit = pgstrom_max_async_tasks;
+	gts->chunk_size_curr = (pgstrom_adaptive_chunk_size
+							? CHUNK_SIZE_INITIAL : pgstrom_chunk_size());
+	gts->chunk_size_dir = 1;
+	gts->chunk_num_tasks = 0;
+	gts->chunk_sum_usec = 0;
+	gts->chunk_tput_prev = 0.0;
+	gts->adaptive_mode = (pgstrom_adaptive_execution
+						  ? GTS_ADAPTIVE__SAMPLE_GPU
+						  : GTS_ADAPTIVE__DISABLED);
 	/* co-operation with CPU parallel (setup by DSM init handler) */
 	gts->pcxt = NULL;
 }
 
+/*
+ * adjust_async_limit
+ *
+ * It adjusts the number of in-flight GpuTasks of the GpuTaskState at
+ * runtime. If device memory is running out, it shrinks the depth
+ * quickly, because every in-flight task pins its own buffers. If the
+ * backend is waiting for the GPU while there is enough headroom, it
+ * extends the depth step by step, up to pg_strom.max_async_tasks.
+ * If completed tasks are piled up on the backend side, deeper pipeline
+ * just consumes device memory, so it shrinks the depth by one.
+ */
+#define ASYNC_LIMIT_MEM_HIGH_WATERMARK		0.90
+#define ASYNC_LIMIT_MEM_LOW_WATERMARK		0.75
+
+static void
+adjust_async_limit(GpuTaskState *gts, bool gpu_bound)
+{
+	double		mem_ratio = gpuMemUsageRatio(gts->gcontext);
+	cl_int		limit = gts->num_async_limit;
+
+	if (mem_ratio >= ASYNC_LIMIT_MEM_HIGH_WATERMARK)
+		limit = limit / 2;
+	else if (!gpu_bound)
+		limit--;
+	else if (mem_ratio < ASYNC_LIMIT_MEM_LOW_WATERMARK)
+		limit++;
+	gts->num_async_limit = Max(Min(limit, pgstrom_max_async_tasks), 1);
+}
+
+/*
+ * adjust_chunk_size
+ *
+ * It adjusts the chunk size of heap scan using the time consumed by the
+ * GPU worker to process a task (DMA send, kernel execution and DMA recv).
+ * A small chunk cannot amortize the fixed cost per task, and a large chunk
+ * makes the pipeline coarse and consumes more device memory. So, it looks
+ * for the size with the best throughput by hill-climbing; once throughput
+ * does not improve, it steps back and stays there for a while, then tries
+ * to probe again, because the best size may change over the scan (e.g,
+ * selectivity or BRIN-index holes).
+ */
+static void
+adjust_chunk_size(GpuTaskState *gts, GpuTask *gtask)
+{
+	size_t		sz = gts->chunk_size_curr;
+	double		tput;
+
+	if (!pgstrom_adaptive_chunk_size ||
+		gtask->chunk_size != sz ||
+		gtask->process_usec == 0)
+		return;		/* built at the previous size, or not processed */
+
+	gts->chunk_num_tasks++;
+	gts->chunk_sum_usec += gtask->process_usec;
+	if (gts->chunk_size_dir == 0)
+	{
+		/* stable; probe the larger size again after a while */
+		if (gts->chunk_num_tasks < CHUNK_SIZE_STABLE_SAMPLES)
+			return;
+		gts->chunk_size_dir = 1;
+	}
+	else if (gts->chunk_num_tasks < CHUNK_SIZE_NUM_SAMPLES)
+		return;
+
+	tput = ((double)sz * (double)gts->chunk_num_tasks /
+			(double)gts->chunk_sum_usec);
+	if (gpuMemUsageRatio(gts->gcontext) >= ASYNC_LIMIT_MEM_HIGH_WATERMARK)
+	{
+		/* device memory pressure; shrink the chunk */
+		sz /= 2;
+		gts->chunk_size_dir = 0;
+	}
+	else if (gts->chunk_tput_prev == 0.0 ||
+			 tput >= gts->chunk_tput_prev * 1.05)
+	{
+		/* better than the previous size; go ahead */
+		if (gts->chunk_size_dir > 0)
+			sz *= 2;
+		else
+			sz /= 2;
+	}
+	else
+	{
+		/* no improvement; step back, then stay there */
+		if (gts->chunk_size_dir > 0)
+			sz /= 2;
+		else
+			sz *= 2;
+		gts->chunk_size_dir = 0;
+		tput = gts->chunk_tput_prev;
+	}
+	sz = Max(Min(sz, pgstrom_chunk_size()), CHUNK_SIZE_MIN);
+	if (sz == gts->chunk_size_curr && gts->chunk_size_dir != 0)
+		gts->chunk_size_dir = 0;	/* touched the boundary */
+	gts->chunk_size_curr = sz;
+	gts->chunk_tput_prev = tput;
+	gts->chunk_num_tasks = 0;
+	gts->chunk_sum_usec = 0;
+}
+
+/*
+ * adaptive_account_task
+ *
+ * If the planner misestimated the workload (e.g, far fewer rows than the
+ * estimation), GPU may be slower than CPU because of the fixed cost per
+ * chunk; DMA and kernel launch. So, GTS measures the time the backend
+ * consumed for the first chunks processed by GPU, then the same number of
+ * chunks processed by CPU (using the code path of CPU fallback), and keeps
+ * running on the faster one for the rest of the scan. It is normalized by
+ * the chunk size, because of the adaptive chunk size.
+ */
+static void
+adaptive_account_task(GpuTaskState *gts, GpuTask *gtask)
+{
+	int			k = (gtask->adaptive_cpu ? 1 : 0);
+	double		gpu_cost;
+	double		cpu_cost;
+
+	if (gtask->chunk_size == 0 ||
+		(gtask->cpu_fallback && !gtask->adaptive_cpu) ||
+		(k == 0 && gtask->task_id == 1))
+		return;		/* not a sample, or warm-up of GPU */
+	gts->adaptive_nchunks[k]++;
+	gts->adaptive_cost[k] += (gts->adaptive_curr_usec /
+							  ((double)gtask->chunk_size / 1048576.0));
+	if (gts->adaptive_mode == GTS_ADAPTIVE__SAMPLE_GPU)
+	{
+		if (gts->adaptive_nchunks[0] < pgstrom_adaptive_execution_samples)
+			return;
+		gts->adaptive_mode = GTS_ADAPTIVE__SAMPLE_CPU;
+	}
+	else if (gts->adaptive_mode == GTS_ADAPTIVE__SAMPLE_CPU)
+	{
+		if (gts->adaptive_nchunks[1] < pgstrom_adaptive_execution_samples)
+			return;
+		gpu_cost = gts->adaptive_cost[0] / (double)gts->adaptive_nchunks[0];
+		cpu_cost = gts->adaptive_cost[1] / (double)gts->adaptive_nchunks[1];
+		gts->adaptive_mode = (cpu_cost < gpu_cost
+							  ? GTS_ADAPTIVE__RUN_CPU
+							  : GTS_ADAPTIVE__RUN_GPU);
+	}
+}
+
+/*
+ * try_adaptive_gputask
+ *
+ * It processes the supplied GpuTask by CPU, if the adaptive execution is
+ * sampling CPU or decided CPU is faster.
+ */
+static bool
+try_adaptive_gputask(GpuTaskState *gts, GpuTask *gtask)
+{
+	if (gts->adaptive_mode != GTS_ADAPTIVE__SAMPLE_CPU &&
+		gts->adaptive_mode != GTS_ADAPTIVE__RUN_CPU)
+		return false;
+	if (gts->cb_speculative_task &&
+		gts->cb_speculative_task(gts, gtask))
+	{
+		gtask->adaptive_cpu = true;
+		return true;
+	}
+	/* this chunk cannot run on CPU; likely the rest also */
+	gts->adaptive_mode = GTS_ADAPTIVE__RUN_GPU;
+	return false;
+}
+
+/*
+ * pgstromLookupCudaModule
+ *
+ * It loads the CUDA module of the GTS, with accounting of the time to wait
+ * for the run-time compile of the GPU program.
+ */
+static void
+pgstromLookupCudaModule(GpuTaskState *gts)
+{
+	instr_time	tv_start;
+	instr_time	tv_end;
+
+	INSTR_TIME_SET_CURRENT(tv_start);
+	gts->cuda_module = GpuContextLookupModule(gts->gcontext,
+											  gts->program_id);
+	INSTR_TIME_SET_CURRENT(tv_end);
+	INSTR_TIME_SUBTRACT(tv_end, tv_start);
+	gts->tv_jit_build += INSTR_TIME_GET_MICROSEC(tv_end);
+	gts->qstat_jit_usec += INSTR_TIME_GET_MICROSEC(tv_end);
+}
+
+/*
+ * try_speculative_gputask
+ *
+ * If run-time compile of the GPU program is still in-progress, GTS may
+ * process the supplied GpuTask by CPU (using the same code path as CPU
+ * fallback) instead of waiting for the build completion. Once the program
+ * gets ready, CUDA module is loaded and GpuTasks are sent to GPU again.
+ */
+static bool
+try_speculative_gputask(GpuTaskState *gts, GpuTask *gtask)
+{
+	if (gts->cuda_module || gts->program_id == INVALID_PROGRAM_ID)
+		return false;
+	if (gts->cb_speculative_task &&
+		!pgstrom_cuda_program_is_ready(gts->program_id) &&
+		gts->cb_speculative_task(gts, gtask))
+		return true;
+	pgstromLookupCudaModule(gts);
+	return false;
+}
+
+/*
+ * try_degrade_gputask
+ *
+ * If device memory consumed by the query already reaches the limit by
+ * pg_strom.max_gpu_memory_per_query, and no GpuTasks are running (thus,
+ * no device memory will be released soon), GTS tries to process the
+ * supplied GpuTask by CPU, instead of the allocation of more device memory.
+ */
+static bool
+try_degrade_gputask(GpuTaskState *gts, GpuTask *gtask)
+{
+	if (gts->cb_speculative_task &&
+		gpuMemQueryLimitExceeded(gts->gcontext) &&
+		gts->cb_speculative_task(gts, gtask))
+	{
+		gtask->fallback_errcode = ERRCODE_OUT_OF_MEMORY;
+		return true;
+	}
+	return false;
+}
+
+/*
+ * setup_gputask_exec
+ */
+static void
+setup_gputask_exec(GpuTaskState *gts)
+{
+	if (!gts->cuda_module &&
+		gts->program_id != INVALID_PROGRAM_ID &&
+		(!gts->cb_speculative_task ||
+		 pgstrom_cuda_program_is_ready(gts->program_id)))
+		pgstromLookupCudaModule(gts);
+	pgstromSetupKernParambuf(gts);
+}
+
+/*
+ * launch_async_gputasks
+ *
+ * It launches GpuTasks of the supplied GTS up to the concurrency limit,
+ * prior to its execution by the Append node. The completed tasks are
+ * kept on the ready_tasks, then picked up by fetch_next_gputask() later.
+ */
+static void
+launch_async_gputasks(GpuTaskState *gts)
+{
+	GpuContext	   *gcontext = gts->gcontext;
+	GpuTask		   *gtask;
+	bool			speculative;
+
+	gts->async_launched = true;
+	/* not yet rescanned, if any parameter changed */
+	if (gts->css.ss.ps.chgParam != NULL ||
+		!gts->cb_begin_exec ||
+		!gts->cb_begin_exec(gts))
+		return;
+	setup_gputask_exec(gts);
+
+	pthreadMutexLock(&gcontext->worker_mutex);
+	while (!gts->scan_done &&
+		   (gts->num_ready_tasks +
+			gts->num_running_tasks) < gts->num_async_limit &&
+		   (gts->num_running_tasks == 0 ||
+			!gpuMemQueryLimitExceeded(gcontext)))
+	{
+		pthreadMutexUnlock(&gcontext->worker_mutex);
+		speculative = false;
+		gtask = gts->cb_next_task(gts);
+		if (gtask)
+		{
+			gtask->chunk_size = gts->chunk_size_curr;
+			speculative = (try_speculative_gputask(gts, gtask) ||
+						   try_adaptive_gputask(gts, gtask) ||
+						   try_degrade_gputask(gts, gtask));
+		}
+		pthreadMutexLock(&gcontext->worker_mutex);
+		if (!gtask)
+		{
+			gts->scan_done = true;
+			break;
+		}
+		if (speculative)
+		{
+			dlist_push_tail(&gts->ready_tasks, &gtask->chain);
+			gts->num_ready_tasks++;
+		}
+		else
+		{
+			dlist_push_tail(&gcontext->pending_tasks, &gtask->chain);
+			gts->num_running_tasks++;
+			pthreadCondSignal(&gcontext->worker_cond);
+		}
+	}
+	pthreadMutexUnlock(&gcontext->worker_mutex);
+}
+
+/*
+ * launch_async_siblings
+ *
+ * It launches GpuTasks of the siblings under the same Append node, to keep
+ * multiple partitions in-flight. If @other_devices, the siblings are
+ * launched in order as long as they run on the device not in use yet.
+ * Elsewhere, only the next sibling not launched yet is launched.
+ */
+static void
+launch_async_siblings(GpuTaskState *gts, bool other_devices)
+{
+	GpuTaskState   *curr;
+	List		   *gcontext_list = list_make1(gts->gcontext);
+
+	for (curr = gts->async_next; curr != NULL; curr = curr->async_next)
+	{
+		if (curr->async_launched)
+		{
+			gcontext_list = lappend(gcontext_list, curr->gcontext);
+			continue;
+		}
+		if (other_devices &&
+			list_member_ptr(gcontext_list, curr->gcontext))
+			break;
+		launch_async_gputasks(curr);
+		if (!other_devices)
+			break;
+		gcontext_list = lappend(gcontext_list, curr->gcontext);
+	}
+	list_free(gcontext_list);
+}
+
 /*
  * fetch_next_gputask
  */
@@ -401,28 +902,64 @@ fetch_next_gputask(GpuTaskState *gts)
 	dlist_node	   *dnode;
 	cl_int			num_async_tasks;
 	cl_int			ev;
+	bool			scan_done_now = false;
+	instr_time		tv_start;
+	instr_time		tv_end;
 
 	/* force activate GpuContext on demand */
 	Assert(gcontext->worker_is_running);
 	CHECK_FOR_GPUCONTEXT(gcontext);
 
+	/* kick the siblings under Append on the other devices */
+	if (!gts->async_launched)
+	{
+		gts->async_launched = true;
+		launch_async_siblings(gts, true);
+	}
+
 	pthreadMutexLock(&gcontext->worker_mutex);
 	while (!gts->scan_done)
 	{
 		ResetLatch(MyLatch);
 		num_async_tasks = (gts->num_ready_tasks +
 						   gts->num_running_tasks);
-		if (num_async_tasks < pgstrom_max_async_tasks &&
-			(dlist_is_empty(&gts->ready_tasks) || gts->num_running_tasks == 0))
+		/*
+		 * Once the query consumes device memory more than the limit, no
+		 * more GpuTasks are launched until the running ones get completed.
+		 */
+		if (num_async_tasks < gts->num_async_limit &&
+			(dlist_is_empty(&gts->ready_tasks) || gts->num_running_tasks == 0) &&
+			(gts->num_running_tasks == 0 ||
+			 !gpuMemQueryLimitExceeded(gcontext)))
 		{
+			bool	speculative = false;
+
 			pthreadMutexUnlock(&gcontext->worker_mutex);
+			INSTR_TIME_SET_CURRENT(tv_start);
 			gtask = gts->cb_next_task(gts);
+			INSTR_TIME_SET_CURRENT(tv_end);
+			INSTR_TIME_SUBTRACT(tv_end, tv_start);
+			gts->tv_build_chunk += INSTR_TIME_GET_MICROSEC(tv_end);
+			if (gtask)
+			{
+				gtask->chunk_size = gts->chunk_size_curr;
+				speculative = (try_speculative_gputask(gts, gtask) ||
+							   try_adaptive_gputask(gts, gtask) ||
+							   try_degrade_gputask(gts, gtask));
+			}
 			pthreadMutexLock(&gcontext->worker_mutex);
 			if (!gtask)
 			{
 				gts->scan_done = true;
+				scan_done_now = true;
 				break;
 			}
+			if (speculative)
+			{
+				dlist_push_tail(&gts->ready_tasks, &gtask->chain);
+				gts->num_ready_tasks++;
+				goto pickup_gputask;
+			}
 			dlist_push_tail(&gcontext->pending_tasks, &gtask->chain);
 			gts->num_running_tasks++;
 			pthreadCondSignal(&gcontext->worker_cond);
@@ -434,6 +971,8 @@ fetch_next_gputask(GpuTaskState *gts)
 			 * the number of concurrent tasks, GTS already has ready tasks,
 			 * so pick them up instead of wait.
 			 */
+			if (gts->num_ready_tasks > 1)
+				adjust_async_limit(gts, false);
 			goto pickup_gputask;
 		}
 		else if (gts->num_running_tasks > 0)
@@ -442,14 +981,19 @@ fetch_next_gputask(GpuTaskState *gts)
 			 * Even though a few GpuTasks are running, but nobody gets
 			 * completed yet. Try to wait for completion to 
 			 */
+			adjust_async_limit(gts, true);
 			pthreadMutexUnlock(&gcontext->worker_mutex);
 
+			INSTR_TIME_SET_CURRENT(tv_start);
 			ev = WaitLatch(MyLatch,
 						   WL_LATCH_SET |
 						   WL_TIMEOUT |
 						   WL_POSTMASTER_DEATH,
 						   500L,
 						   PG_WAIT_EXTENSION);
+			INSTR_TIME_SET_CURRENT(tv_end);
+			INSTR_TIME_SUBTRACT(tv_end, tv_start);
+			gts->tv_wait_task += INSTR_TIME_GET_MICROSEC(tv_end);
 			if (ev & WL_POSTMASTER_DEATH)
 				ereport(FATAL,
 						(errcode(ERRCODE_ADMIN_SHUTDOWN),
@@ -464,7 +1008,11 @@ fetch_next_gputask(GpuTaskState *gts)
 			/*
 			 * Sadly, we touched a threshold. Taks a short break.
 			 */
+			INSTR_TIME_SET_CURRENT(tv_start);
 			pg_usleep(20000L);	/* wait for 20msec */
+			INSTR_TIME_SET_CURRENT(tv_end);
+			INSTR_TIME_SUBTRACT(tv_end, tv_start);
+			gts->tv_wait_task += INSTR_TIME_GET_MICROSEC(tv_end);
 
 			CHECK_FOR_GPUCONTEXT(gcontext);
 			pthreadMutexLock(&gcontext->worker_mutex);
@@ -472,6 +1020,13 @@ fetch_next_gputask(GpuTaskState *gts)
 	}
 	pthreadMutexUnlock(&gcontext->worker_mutex);
 
+	/*
+	 * No more GpuTasks shall be launched by this GTS, so the next sibling
+	 * under Append can use the device during the tail of the scan.
+	 */
+	if (scan_done_now)
+		launch_async_siblings(gts, false);
+
 	/*
 	 * Once we exit the above loop, either a completed task was returned,
 	 * or relation scan has already done thus wait for synchronously.
@@ -520,12 +1075,16 @@ retry:
 
 		CHECK_FOR_GPUCONTEXT(gcontext);
 
+		INSTR_TIME_SET_CURRENT(tv_start);
 		ev = WaitLatch(MyLatch,
 					   WL_LATCH_SET |
 					   WL_TIMEOUT |
 					   WL_POSTMASTER_DEATH,
 					   500L,
 					   PG_WAIT_EXTENSION);
+		INSTR_TIME_SET_CURRENT(tv_end);
+		INSTR_TIME_SUBTRACT(tv_end, tv_start);
+		gts->tv_wait_task += INSTR_TIME_GET_MICROSEC(tv_end);
 		if (ev & WL_POSTMASTER_DEATH)
 			ereport(FATAL,
 					(errcode(ERRCODE_ADMIN_SHUTDOWN),
@@ -542,9 +1101,119 @@ pickup_gputask:
 	gts->num_ready_tasks--;
 	pthreadMutexUnlock(&gcontext->worker_mutex);
 
+	adjust_chunk_size(gts, gtask);
+	/* per-phase timing on the GPU side */
+	gts->tv_dma_send   += gtask->tv_dma_send;
+	gts->tv_kern_exec  += gtask->tv_kern_exec;
+	gts->tv_dma_recv   += gtask->tv_dma_recv;
+	gts->num_kern_exec += gtask->num_kern_exec;
+	/* cumulative statistics per query */
+	gts->qstat_num_tasks++;
+	gts->qstat_kern_exec += gtask->num_kern_exec;
+	gts->qstat_gpu_usec  += gtask->process_usec;
+
 	return gtask;
 }
 
+#ifdef WITH_NVTX
+/*
+ * __pgstromNvtxBegin / __pgstromNvtxEnd
+ *
+ * It opens/closes a NVTX range labeled with the query-id and task-id.
+ * NVTX API is thread-safe, so GPU worker threads can also use them.
+ */
+uint64
+__pgstromNvtxBegin(const char *label, uint64 query_id, cl_uint task_id)
+{
+	nvtxEventAttributes_t ev;
+	char		message[256];
+
+	snprintf(message, sizeof(message), "%s [qid=%lu task=%u]",
+			 label, query_id, task_id);
+	memset(&ev, 0, sizeof(nvtxEventAttributes_t));
+	ev.version = NVTX_VERSION;
+	ev.size = NVTX_EVENT_ATTRIB_STRUCT_SIZE;
+	ev.messageType = NVTX_MESSAGE_TYPE_ASCII;
+	ev.message.ascii = message;
+	ev.payloadType = NVTX_PAYLOAD_TYPE_UNSIGNED_INT64;
+	ev.payload.ullValue = query_id;
+
+	return nvtxRangeStartEx(&ev);
+}
+
+void
+__pgstromNvtxEnd(uint64 range_id)
+{
+	nvtxRangeEnd(range_id);
+}
+#endif	/* WITH_NVTX */
+
+/*
+ * pgstrom_cpu_fallback_reason
+ *
+ * It classifies the error code that caused CPU fallback.
+ */
+static const char *cpu_fallback_reason_labels[GPUTASK_FALLBACK__NUM_REASONS] = {
+	"speculative",
+	"out of memory",
+	"varlena",
+	"numeric",
+	"recursion",
+	"visibility",
+	"unsupported",
+	"others",
+};
+
+static int
+pgstrom_cpu_fallback_reason(cl_int errcode)
+{
+	switch (errcode & ~ERRCODE_FLAGS_CPU_FALLBACK)
+	{
+		case ERRCODE_STROM_SUCCESS:
+			return GPUTASK_FALLBACK__SPECULATIVE;
+		case ERRCODE_OUT_OF_MEMORY:
+		case ERRCODE_STROM_DATASTORE_NOSPACE:
+			return GPUTASK_FALLBACK__OUT_OF_MEMORY;
+		case ERRCODE_STROM_VARLENA_UNSUPPORTED:
+			return GPUTASK_FALLBACK__VARLENA;
+		case ERRCODE_NUMERIC_VALUE_OUT_OF_RANGE:
+			return GPUTASK_FALLBACK__NUMERIC;
+		case ERRCODE_STROM_RECURSION_TOO_DEEP:
+			return GPUTASK_FALLBACK__RECURSION;
+		case ERRCODE_STROM_VISIBILITY_UNKNOWN:
+			return GPUTASK_FALLBACK__VISIBILITY;
+		case ERRCODE_FEATURE_NOT_SUPPORTED:
+			return GPUTASK_FALLBACK__UNSUPPORTED;
+		default:
+			break;
+	}
+	return GPUTASK_FALLBACK__OTHERS;
+}
+
+/*
+ * assign_curr_gputask
+ */
+static void
+assign_curr_gputask(GpuTaskState *gts, GpuTask *gtask)
+{
+	if (gtask->adaptive_cpu)
+		gts->num_adaptive_cpu++;
+	else if (gtask->cpu_fallback)
+	{
+		int		reason = pgstrom_cpu_fallback_reason(gtask->fallback_errcode);
+
+		gts->num_cpu_fallbacks++;
+		gts->fallback_reasons[reason]++;
+		gts->qstat_fallback_chunks++;
+	}
+	gts->curr_task = gtask;
+	gts->curr_index = 0;
+	gts->curr_lp_index = 0;
+	/* notify a new task is assigned */
+	if (gts->cb_switch_task)
+		gts->cb_switch_task(gts, gtask);
+}
+
 /*
  * pgstromExecGpuTaskState
  */
@@ -552,11 +1221,25 @@ TupleTableSlot *
 pgstromExecGpuTaskState(GpuTaskState *gts)
 {
 	TupleTableSlot *slot = NULL;
+	bool		adaptive_sampling = false;
+	instr_time	tv_start;
+	instr_time	tv_end;
 
-	if (!gts->cuda_module && gts->program_id != INVALID_PROGRAM_ID)
-		gts->cuda_module = GpuContextLookupModule(gts->gcontext,
-												  gts->program_id);
-	pgstromSetupKernParambuf(gts);
+	setup_gputask_exec(gts);
+
+	if (gts->adaptive_mode == GTS_ADAPTIVE__SAMPLE_GPU ||
+		gts->adaptive_mode == GTS_ADAPTIVE__SAMPLE_CPU)
+	{
+		/* no way to process the chunks by CPU */
+		if (!gts->cb_speculative_task)
+			gts->adaptive_mode = GTS_ADAPTIVE__DISABLED;
+		else
+			adaptive_sampling = true;
+	}
+	if (adaptive_sampling)
+	{
+		INSTR_TIME_SET_CURRENT(tv_start);
+	}
 
 	while (!gts->curr_task || !(slot = gts->cb_next_tuple(gts)))
 	{
@@ -565,6 +1248,15 @@ pgstromExecGpuTaskState(GpuTaskState *gts)
 		/* release the current GpuTask object that was already scanned */
 		if (gtask)
 		{
+			if (adaptive_sampling)
+			{
+				INSTR_TIME_SET_CURRENT(tv_end);
+				INSTR_TIME_SUBTRACT(tv_end, tv_start);
+				gts->adaptive_curr_usec += INSTR_TIME_GET_MICROSEC(tv_end);
+				adaptive_account_task(gts, gtask);
+				INSTR_TIME_SET_CURRENT(tv_start);
+			}
+			gts->adaptive_curr_usec = 0.0;
 			gts->cb_release_task(gtask);
 			gts->curr_task = NULL;
 			gts->curr_index = 0;
@@ -574,16 +1266,71 @@ pgstromExecGpuTaskState(GpuTaskState *gts)
 		gtask = fetch_next_gputask(gts);
 		if (!gtask)
 			return NULL;
+		assign_curr_gputask(gts, gtask);
+	}
+	if (gts->curr_task->cpu_fallback && !gts->curr_task->adaptive_cpu)
+		gts->qstat_fallback_rows++;
+	if (adaptive_sampling)
+	{
+		INSTR_TIME_SET_CURRENT(tv_end);
+		INSTR_TIME_SUBTRACT(tv_end, tv_start);
+		gts->adaptive_curr_usec += INSTR_TIME_GET_MICROSEC(tv_end);
+	}
+	return slot;
+}
+
+/*
+ * pgstromBulkExecGpuTaskState
+ *
+ * It hands over the result data store of the next GpuTask as is, instead
+ * of the tuple-by-tuple fetch, for the parent GPU node that consumes the
+ * results on the device (@device_handoff). It returns NULL if the rows
+ * have to be fetched by pgstromExecGpuTaskState(); a task processed by CPU,
+ * or the rest of a task already fetched partially. @p_scan_done is set
+ * when no more tasks exist.
+ */
+pgstrom_data_store *
+pgstromBulkExecGpuTaskState(GpuTaskState *gts, bool *p_scan_done)
+{
+	GpuTask	   *gtask;
+	pgstrom_data_store *pds;
+
+	*p_scan_done = false;
+	if (!gts->device_handoff || !gts->cb_bulk_exec)
+		return NULL;
+	setup_gputask_exec(gts);
+	for (;;)
+	{
+		gtask = gts->curr_task;
+		if (gtask)
+		{
+			if (gts->curr_index > 0 || gts->curr_lp_index > 0)
+				return NULL;
+		}
+		else
+		{
+			gtask = fetch_next_gputask(gts);
+			if (!gtask)
+			{
+				*p_scan_done = true;
+				return NULL;
+			}
+			assign_curr_gputask(gts, gtask);
+		}
 		if (gtask->cpu_fallback)
-			gts->num_cpu_fallbacks++;
-		gts->curr_task = gtask;
+			return NULL;
+		pds = gts->cb_bulk_exec(gts, gtask);
+		if (!pds)
+			return NULL;
+		gts->cb_release_task(gtask);
+		gts->curr_task = NULL;
 		gts->curr_index = 0;
 		gts->curr_lp_index = 0;
-		/* notify a new task is assigned */
-		if (gts->cb_switch_task)
-			gts->cb_switch_task(gts, gtask);
+		if (pds->kds.nitems > 0)
+			return pds;
+		/* empty results; skip to the next task */
+		PDS_release(pds);
 	}
-	return slot;
 }
 
 /*
@@ -603,6 +1350,7 @@ pgstromRescanGpuTaskState(GpuTaskState *gts)
 		Assert(gts->num_ready_tasks >= 0);
 		gts->cb_release_task(gtask);
 	}
+	gts->async_launched = false;
 	/* rewind the scan position if GTS scans a table */
 	pgstromRewindScanChunk(gts);
 	pgstromReleaseKernParambuf(gts);
@@ -642,6 +1390,8 @@ pgstromReleaseGpuTaskState(GpuTaskState *gts, GpuTaskRuntimeStat *gt_rtstat)
 		ExecEndArrowFdw(gts->af_state);
 	if (gts->gc_state)
 		ExecEndGpuCache(gts->gc_state);
+	/* cumulative statistics per query */
+	pgstromStatGpuQueryUpdate(gts);
 	/* unreference CUDA program */
 	if (gts->program_id != INVALID_PROGRAM_ID)
 		pgstrom_put_cuda_program(gts->gcontext, gts->program_id);
@@ -698,11 +1448,15 @@ pgstromExplainGpuTaskState(GpuTaskState *gts,
 			ExplainPropertyText("GPUDirect SQL", "enabled", es);
 		else if (es->format == EXPLAIN_FORMAT_TEXT)
 		{
-			if (gts->nvme_count == 0)
+			if (gts->nvme_count == 0 && gts->nvme_cached_count == 0)
 				ExplainPropertyText("GPUDirect SQL", "enabled", es);
 			else
 			{
-				snprintf(temp, sizeof(temp), "load=%ld", gts->nvme_count);
+				snprintf(temp, sizeof(temp), "load=%ld (%s), cached=%ld (%s)",
+						 gts->nvme_count,
+						 format_bytesz((Size)gts->nvme_count * BLCKSZ),
+						 gts->nvme_cached_count,
+						 format_bytesz((Size)gts->nvme_cached_count * BLCKSZ));
 				ExplainPropertyText("GPUDirect SQL", temp, es);
 			}
 		}
@@ -711,6 +1465,12 @@ pgstromExplainGpuTaskState(GpuTaskState *gts,
 			ExplainPropertyText("GPUDirect SQL", "enabled", es);
 			ExplainPropertyInteger("GPUDirect SQL Load Blocks",
 								   NULL, gts->nvme_count, es);
+			ExplainPropertyInteger("GPUDirect SQL Load Size", "bytes",
+								   (int64)gts->nvme_count * BLCKSZ, es);
+			ExplainPropertyInteger("GPUDirect SQL Cached Blocks",
+								   NULL, gts->nvme_cached_count, es);
+			ExplainPropertyInteger("GPUDirect SQL Cached Size", "bytes",
+								   (int64)gts->nvme_cached_count * BLCKSZ, es);
 		}
 	}
 	else if (es->format != EXPLAIN_FORMAT_TEXT)
@@ -718,8 +1478,171 @@ pgstromExplainGpuTaskState(GpuTaskState *gts,
 
 	/* Number of CPU fallbacks, if any */
 	if (es->analyze && gts->num_cpu_fallbacks > 0)
+	{
 		ExplainPropertyInteger("CPU fallbacks",
 							   NULL, gts->num_cpu_fallbacks, es);
+		if (es->format == EXPLAIN_FORMAT_TEXT)
+		{
+			size_t	off = 0;
+
+			for (int i=0; i < GPUTASK_FALLBACK__NUM_REASONS; i++)
+			{
+				if (gts->fallback_reasons[i] == 0)
+					continue;
+				off += snprintf(temp + off, sizeof(temp) - off,
+								"%s%s=%lu",
+								off > 0 ? ", " : "",
+								cpu_fallback_reason_labels[i],
+								gts->fallback_reasons[i]);
+			}
+			if (off > 0)
+				ExplainPropertyText("CPU fallback reasons", temp, es);
+		}
+		else
+		{
+			for (int i=0; i < GPUTASK_FALLBACK__NUM_REASONS; i++)
+			{
+				if (gts->fallback_reasons[i] == 0)
+					continue;
+				snprintf(temp, sizeof(temp), "CPU fallback %s",
+						 cpu_fallback_reason_labels[i]);
+				ExplainPropertyInteger(temp, NULL,
+									   gts->fallback_reasons[i], es);
+			}
+		}
+	}
+	/* Adaptive execution between GPU and CPU */
+	if (es->analyze && !pgstrom_regression_test_mode &&
+		gts->adaptive_mode != GTS_ADAPTIVE__DISABLED)
+	{
+		static const char *adaptive_labels[] = {
+			"disabled", "sampling", "sampling", "GPU", "CPU"
+		};
+		cl_ulong	num_adaptive_cpu = (gts->num_adaptive_cpu +
+										gts->adaptive_cpu_count);
+
+		if (es->format == EXPLAIN_FORMAT_TEXT)
+		{
+			size_t	off = 0;
+
+			off += snprintf(temp + off, sizeof(temp) - off, "%s",
+							adaptive_labels[gts->adaptive_mode]);
+			if (gts->adaptive_nchunks[0] > 0 && gts->adaptive_nchunks[1] > 0)
+				off += snprintf(temp + off, sizeof(temp) - off,
+								" (GPU: %.2fms/MB, CPU: %.2fms/MB)",
+								gts->adaptive_cost[0] /
+								(1000.0 * (double)gts->adaptive_nchunks[0]),
+								gts->adaptive_cost[1] /
+								(1000.0 * (double)gts->adaptive_nchunks[1]));
+			if (num_adaptive_cpu > 0)
+				off += snprintf(temp + off, sizeof(temp) - off,
+								", %lu chunks by CPU", num_adaptive_cpu);
+			ExplainPropertyText("Adaptive Execution", temp, es);
+		}
+		else
+		{
+			ExplainPropertyText("Adaptive Execution",
+								adaptive_labels[gts->adaptive_mode], es);
+			ExplainPropertyInteger("Adaptive CPU Chunks", NULL,
+								   num_adaptive_cpu, es);
+		}
+	}
+	/*
+	 * Peak device memory consumption of the query; sum of the peaks of
+	 * the leader and parallel workers, if any.
+	 */
+	if (es->analyze && !pgstrom_regression_test_mode)
+	{
+		size_t	gpumem_peak = (gts->gpumem_peak +
+							   gpuMemQueryPeakUsage(gts->gcontext));
+
+		if (gpumem_peak > 0)
+		{
+			if (es->format == EXPLAIN_FORMAT_TEXT)
+				ExplainPropertyText("GPU Memory Peak",
+									format_bytesz(gpumem_peak), es);
+			else
+				ExplainPropertyInteger("GPU Memory Peak", "bytes",
+									   gpumem_peak, es);
+		}
+	}
+	/* Per-phase timing breakdown */
+	if (es->analyze && es->timing && gts->num_kern_exec > 0)
+	{
+		if (es->format == EXPLAIN_FORMAT_TEXT)
+		{
+			snprintf(temp, sizeof(temp),
+					 "build=%.3fms, dma-send=%.3fms, "
+					 "kernel=%.3fms (%lu launches), dma-recv=%.3fms, "
+					 "wait=%.3fms, jit=%.3fms",
+					 (double)gts->tv_build_chunk / 1000.0,
+					 (double)gts->tv_dma_send / 1000.0,
+					 (double)gts->tv_kern_exec / 1000.0,
+					 gts->num_kern_exec,
+					 (double)gts->tv_dma_recv / 1000.0,
+					 (double)gts->tv_wait_task / 1000.0,
+					 (double)gts->tv_jit_build / 1000.0);
+			ExplainPropertyText("GPU Timing", temp, es);
+		}
+		else
+		{
+			ExplainPropertyFloat("GPU Timing Build", "ms",
+								 (double)gts->tv_build_chunk / 1000.0, 3, es);
+			ExplainPropertyFloat("GPU Timing DMA Send", "ms",
+								 (double)gts->tv_dma_send / 1000.0, 3, es);
+			ExplainPropertyFloat("GPU Timing Kernel", "ms",
+								 (double)gts->tv_kern_exec / 1000.0, 3, es);
+			ExplainPropertyInteger("GPU Kernel Launches", NULL,
+								   gts->num_kern_exec, es);
+			ExplainPropertyFloat("GPU Timing DMA Recv", "ms",
+								 (double)gts->tv_dma_recv / 1000.0, 3, es);
+			ExplainPropertyFloat("GPU Timing Wait", "ms",
+								 (double)gts->tv_wait_task / 1000.0, 3, es);
+			ExplainPropertyFloat("GPU Timing JIT", "ms",
+								 (double)gts->tv_jit_build / 1000.0, 3, es);
+		}
+	}
+	/* Per-stage cycle counters of GPU kernel, if profiling build */
+	if (es->analyze && es->verbose)
+	{
+		static const char *kprof_labels[KERN_PROFILE__NUM_STAGES] = {
+			"load", "quals", "join", "projection", "atomics"
+		};
+		cl_ulong	kprof_total = 0;
+		int			i;
+
+		for (i=0; i < KERN_PROFILE__NUM_STAGES; i++)
+			kprof_total += gts->kern_profile[i];
+		if (kprof_total > 0)
+		{
+			if (es->format == EXPLAIN_FORMAT_TEXT)
+			{
+				size_t	off = 0;
+
+				for (i=0; i < KERN_PROFILE__NUM_STAGES; i++)
+				{
+					off += snprintf(temp + off, sizeof(temp) - off,
+									"%s%s=%.2fM (%.1f%%)",
+									i > 0 ? ", " : "",
+									kprof_labels[i],
+									(double)gts->kern_profile[i] / 1000000.0,
+									100.0 * (double)gts->kern_profile[i] /
+									(double)kprof_total);
+				}
+				ExplainPropertyText("GPU Kernel Profile", temp, es);
+			}
+			else
+			{
+				for (i=0; i < KERN_PROFILE__NUM_STAGES; i++)
+				{
+					snprintf(temp, sizeof(temp),
+							 "GPU Kernel Profile %s", kprof_labels[i]);
+					ExplainPropertyInteger(temp, "cycles",
+										   gts->kern_profile[i], es);
+				}
+			}
+		}
+	}
 	/* Properties of Arrow_Fdw/GpuCache if any */
 	if (gts->af_state)
 		ExplainArrowFdw(gts->af_state, rel, es, dcontext);
@@ -744,11 +1667,14 @@ pgstromExplainGpuTaskState(GpuTaskState *gts,
 	{
 		const char *cuda_source = pgstrom_cuda_source_file(gts->program_id);
 		const char *cuda_binary = pgstrom_cuda_binary_file(gts->program_id);
+		const char *build_info = pgstrom_cuda_program_build_info(gts->program_id);
 
 		if (cuda_source)
 			ExplainPropertyText("Kernel Source", cuda_source, es);
 		if (cuda_binary)
 			ExplainPropertyText("Kernel Binary", cuda_binary, es);
+		if (build_info)
+			ExplainPropertyText("Kernel Build", build_info, es);
 	}
 }
 
@@ -883,7 +1809,314 @@ pgstromInitGpuTask(GpuTaskState *gts, GpuTask *gtask)
 	gtask->task_kind    = gts->task_kind;
 	gtask->program_id   = gts->program_id;
 	gtask->gts          = gts;
+	gtask->task_id      = ++gts->last_task_id;
 	gtask->cpu_fallback = false;
+	gtask->adaptive_cpu = false;
+	gtask->fallback_errcode = ERRCODE_STROM_SUCCESS;
+	gtask->chunk_size   = 0;
+	gtask->process_usec = 0;
+	gtask->with_timer   = (gts->css.ss.ps.instrument != NULL);
+	gtask->timer_mask   = 0;
+	memset(gtask->ev_timer, 0, sizeof(gtask->ev_timer));
+	gtask->tv_dma_send  = 0;
+	gtask->tv_kern_exec = 0;
+	gtask->tv_dma_recv  = 0;
+	gtask->num_kern_exec = 0;
+}
+
+/*
+ * pgstromStatGpuQueryUpdate
+ *
+ * It accumulates the per-process counters of the GTS to the cumulative
+ * statistics of the current query. Each process (including parallel
+ * workers) reports its own portion, so the counters are never merged.
+ */
+void
+pgstromStatGpuQueryUpdate(GpuTaskState *gts)
+{
+	EState		   *estate = gts->css.ss.ps.state;
+	GpuQueryStatKey	key;
+	GpuQueryStatEntry *entry = NULL;
+	dlist_iter		iter;
+	uint32			hindex;
+
+	if (!gq_stat_head || gts->qstat_num_tasks == 0)
+		return;
+	memset(&key, 0, sizeof(GpuQueryStatKey));
+	key.userid = GetUserId();
+	key.dbid = MyDatabaseId;
+	if (estate && estate->es_plannedstmt)
+		key.queryid = estate->es_plannedstmt->queryId;
+	hindex = hash_any((unsigned char *)&key,
+					  sizeof(GpuQueryStatKey)) % GPU_QUERY_STAT_NSLOTS;
+
+	LWLockAcquire(&gq_stat_head->lock, LW_EXCLUSIVE);
+	dlist_foreach(iter, &gq_stat_head->hash_slots[hindex])
+	{
+		GpuQueryStatEntry *temp = dlist_container(GpuQueryStatEntry,
+												  chain, iter.cur);
+		if (memcmp(&temp->key, &key, sizeof(GpuQueryStatKey)) == 0)
+		{
+			entry = temp;
+			break;
+		}
+	}
+
+	if (!entry)
+	{
+		if (dlist_is_empty(&gq_stat_head->free_list))
+		{
+			GpuQueryStatEntry *victim = NULL;
+			int		i;
+
+			/* evict the entry that consumed the least GPU time */
+			for (i=0; i < pgstrom_stat_gpu_query_max; i++)
+			{
+				GpuQueryStatEntry *temp = &gq_stat_head->entries[i];
+
+				if (!victim || temp->gpu_usec < victim->gpu_usec)
+					victim = temp;
+			}
+			Assert(victim != NULL);
+			dlist_delete(&victim->chain);
+			dlist_push_head(&gq_stat_head->free_list, &victim->chain);
+		}
+		entry = dlist_container(GpuQueryStatEntry, chain,
+								dlist_pop_head_node(&gq_stat_head->free_list));
+		memset(entry, 0, sizeof(GpuQueryStatEntry));
+		memcpy(&entry->key, &key, sizeof(GpuQueryStatKey));
+		dlist_push_head(&gq_stat_head->hash_slots[hindex], &entry->chain);
+	}
+	entry->num_nodes++;
+	entry->num_tasks       += gts->qstat_num_tasks;
+	entry->kern_exec       += gts->qstat_kern_exec;
+	entry->gpu_usec        += gts->qstat_gpu_usec;
+	entry->fallback_chunks += gts->qstat_fallback_chunks;
+	entry->fallback_rows   += gts->qstat_fallback_rows;
+	entry->jit_usec        += gts->qstat_jit_usec;
+	LWLockRelease(&gq_stat_head->lock);
+
+	gts->qstat_num_tasks = 0;
+	gts->qstat_kern_exec = 0;
+	gts->qstat_gpu_usec = 0;
+	gts->qstat_fallback_chunks = 0;
+	gts->qstat_fallback_rows = 0;
+	gts->qstat_jit_usec = 0;
+}
+
+/*
+ * pgstrom_stat_gpu_query - SQL function to dump the cumulative statistics
+ * of GPU activity per query
+ */
+Datum pgstrom_stat_gpu_query(PG_FUNCTION_ARGS);
+
+Datum
+pgstrom_stat_gpu_query(PG_FUNCTION_ARGS)
+{
+	FuncCallContext *fncxt;
+	GpuQueryStatEntry *entry;
+	List	   *entry_list;
+	Datum		values[10];
+	bool		isnull[10];
+	HeapTuple	tuple;
+
+	if (SRF_IS_FIRSTCALL())
+	{
+		TupleDesc		tupdesc;
+		MemoryContext	oldcxt;
+		int				i;
+
+		fncxt = SRF_FIRSTCALL_INIT();
+		oldcxt = MemoryContextSwitchTo(fncxt->multi_call_memory_ctx);
+
+		tupdesc = CreateTemplateTupleDesc(10);
+		TupleDescInitEntry(tupdesc, (AttrNumber)  1, "userid",
+						   OIDOID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber)  2, "dbid",
+						   OIDOID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber)  3, "queryid",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber)  4, "gpu_nodes",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber)  5, "gpu_tasks",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber)  6, "kern_launches",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber)  7, "gpu_time",
+						   FLOAT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber)  8, "fallback_chunks",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber)  9, "fallback_rows",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 10, "jit_build_time",
+						   FLOAT8OID, -1, 0);
+		fncxt->tuple_desc = BlessTupleDesc(tupdesc);
+
+		entry_list = NIL;
+		if (gq_stat_head)
+		{
+			LWLockAcquire(&gq_stat_head->lock, LW_SHARED);
+			for (i=0; i < GPU_QUERY_STAT_NSLOTS; i++)
+			{
+				dlist_iter	iter;
+
+				dlist_foreach(iter, &gq_stat_head->hash_slots[i])
+				{
+					entry = palloc(sizeof(GpuQueryStatEntry));
+					memcpy(entry, dlist_container(GpuQueryStatEntry,
+												  chain, iter.cur),
+						   sizeof(GpuQueryStatEntry));
+					entry_list = lappend(entry_list, entry);
+				}
+			}
+			LWLockRelease(&gq_stat_head->lock);
+		}
+		fncxt->user_fctx = entry_list;
+
+		MemoryContextSwitchTo(oldcxt);
+	}
+	fncxt = SRF_PERCALL_SETUP();
+	entry_list = (List *)fncxt->user_fctx;
+	if (entry_list == NIL)
+		SRF_RETURN_DONE(fncxt);
+	entry = linitial(entry_list);
+	fncxt->user_fctx = list_delete_first(entry_list);
+
+	memset(isnull, 0, sizeof(isnull));
+	values[0] = ObjectIdGetDatum(entry->key.userid);
+	values[1] = ObjectIdGetDatum(entry->key.dbid);
+	values[2] = Int64GetDatum((int64)entry->key.queryid);
+	values[3] = Int64GetDatum(entry->num_nodes);
+	values[4] = Int64GetDatum(entry->num_tasks);
+	values[5] = Int64GetDatum(entry->kern_exec);
+	values[6] = Float8GetDatum((double)entry->gpu_usec / 1000.0);
+	values[7] = Int64GetDatum(entry->fallback_chunks);
+	values[8] = Int64GetDatum(entry->fallback_rows);
+	values[9] = Float8GetDatum((double)entry->jit_usec / 1000.0);
+
+	tuple = heap_form_tuple(fncxt->tuple_desc, values, isnull);
+
+	SRF_RETURN_NEXT(fncxt, HeapTupleGetDatum(tuple));
+}
+PG_FUNCTION_INFO_V1(pgstrom_stat_gpu_query);
+
+/*
+ * pgstrom_stat_gpu_reset - SQL function to reset the cumulative statistics
+ * of GPU activity, for both of devices and queries
+ */
+Datum pgstrom_stat_gpu_reset(PG_FUNCTION_ARGS);
+
+Datum
+pgstrom_stat_gpu_reset(PG_FUNCTION_ARGS)
+{
+	int		i;
+
+	gpuMemStatReset();
+	if (gq_stat_head)
+	{
+		LWLockAcquire(&gq_stat_head->lock, LW_EXCLUSIVE);
+		dlist_init(&gq_stat_head->free_list);
+		for (i=0; i < GPU_QUERY_STAT_NSLOTS; i++)
+			dlist_init(&gq_stat_head->hash_slots[i]);
+		for (i=0; i < pgstrom_stat_gpu_query_max; i++)
+			dlist_push_tail(&gq_stat_head->free_list,
+							&gq_stat_head->entries[i].chain);
+		LWLockRelease(&gq_stat_head->lock);
+	}
+	PG_RETURN_VOID();
+}
+PG_FUNCTION_INFO_V1(pgstrom_stat_gpu_reset);
+
+/*
+ * pgstrom_startup_gputasks
+ */
+static void
+pgstrom_startup_gputasks(void)
+{
+	size_t		required;
+	bool		found;
+	int			i;
+
+	if (shmem_startup_next)
+		(*shmem_startup_next)();
+
+	required = offsetof(GpuQueryStatHead,
+						entries[pgstrom_stat_gpu_query_max]);
+	gq_stat_head = ShmemInitStruct("GPU Query Statistics",
+								   MAXALIGN(required), &found);
+	if (found)
+		elog(ERROR, "Bug? GPU Query Statistics exists");
+	memset(gq_stat_head, 0, required);
+	LWLockInitialize(&gq_stat_head->lock, -1);
+	dlist_init(&gq_stat_head->free_list);
+	for (i=0; i < GPU_QUERY_STAT_NSLOTS; i++)
+		dlist_init(&gq_stat_head->hash_slots[i]);
+	for (i=0; i < pgstrom_stat_gpu_query_max; i++)
+		dlist_push_tail(&gq_stat_head->free_list,
+						&gq_stat_head->entries[i].chain);
+}
+
+/*
+ * __setup_async_append_walker
+ *
+ * It links the GPU nodes under the same Append node, to launch GpuTasks of
+ * the next partitions prior to their execution. Parallel-aware Append and
+ * Append with run-time partition pruning are not supported, because the
+ * children to be executed are not fixed. Nodes under Gather are also not,
+ * because the inner buffer of GpuJoin is built in co-operation with the
+ * parallel workers that may not reach the same partition.
+ */
+static bool
+__setup_async_append_walker(PlanState *ps, void *context)
+{
+	if (!ps)
+		return false;
+	if (IsA(ps, GatherState) || IsA(ps, GatherMergeState))
+		return false;
+	if (IsA(ps, AppendState) && !ps->plan->parallel_aware)
+	{
+		AppendState	   *as = (AppendState *) ps;
+		GpuTaskState   *gts_prev = NULL;
+		int				i;
+
+#if PG_VERSION_NUM >= 110000
+		if (as->as_prune_state)
+			goto skip;
+#endif
+		for (i=0; i < as->as_nplans; i++)
+		{
+			PlanState  *child = as->appendplans[i];
+
+			if (!pgstrom_planstate_is_gpuscan(child) &&
+				!pgstrom_planstate_is_gpujoin(child) &&
+				!pgstrom_planstate_is_gpupreagg(child))
+				continue;
+			if (gts_prev)
+				gts_prev->async_next = (GpuTaskState *) child;
+			gts_prev = (GpuTaskState *) child;
+		}
+	}
+#if PG_VERSION_NUM >= 110000
+skip:
+#endif
+	return planstate_tree_walker(ps, __setup_async_append_walker, context);
+}
+
+/*
+ * pgstrom_executor_start
+ */
+static void
+pgstrom_executor_start(QueryDesc *queryDesc, int eflags)
+{
+	if (executor_start_next)
+		executor_start_next(queryDesc, eflags);
+	else
+		standard_ExecutorStart(queryDesc, eflags);
+
+	if (pgstrom_enable_async_append &&
+		!IsParallelWorker() &&
+		(eflags & EXEC_FLAG_EXPLAIN_ONLY) == 0)
+		__setup_async_append_walker(queryDesc->planstate, NULL);
 }
 
 /*
@@ -892,5 +2125,63 @@ pgstromInitGpuTask(GpuTaskState *gts, GpuTask *gtask)
 void
 pgstrom_init_gputasks(void)
 {
-	/* nothing to do */
+	/* pg_strom.adaptive_chunk_size */
+	DefineCustomBoolVariable("pg_strom.adaptive_chunk_size",
+							 "Enables to adjust chunk size of heap scan at runtime",
+							 NULL,
+							 &pgstrom_adaptive_chunk_size,
+							 true,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	/* pg_strom.adaptive_execution */
+	DefineCustomBoolVariable("pg_strom.adaptive_execution",
+							 "Enables to switch GPU and CPU at runtime according to the measured throughput",
+							 NULL,
+							 &pgstrom_adaptive_execution,
+							 true,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	/* pg_strom.adaptive_execution_samples */
+	DefineCustomIntVariable("pg_strom.adaptive_execution_samples",
+							"Number of chunks to be sampled for each of GPU and CPU",
+							NULL,
+							&pgstrom_adaptive_execution_samples,
+							4,
+							1,
+							INT_MAX,
+							PGC_USERSET,
+							GUC_NOT_IN_SAMPLE,
+							NULL, NULL, NULL);
+	/* pg_strom.enable_async_append */
+	DefineCustomBoolVariable("pg_strom.enable_async_append",
+							 "Enables to launch GpuTasks of the next partitions under Append in advance",
+							 NULL,
+							 &pgstrom_enable_async_append,
+							 true,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	/* pg_strom.stat_gpu_query_max */
+	DefineCustomIntVariable("pg_strom.stat_gpu_query_max",
+							"Max number of queries tracked by pgstrom.stat_gpu_query",
+							NULL,
+							&pgstrom_stat_gpu_query_max,
+							1000,
+							0,
+							INT_MAX / sizeof(GpuQueryStatEntry),
+							PGC_POSTMASTER,
+							GUC_NOT_IN_SAMPLE,
+							NULL, NULL, NULL);
+	if (pgstrom_stat_gpu_query_max > 0)
+	{
+		RequestAddinShmemSpace(MAXALIGN(offsetof(GpuQueryStatHead,
+								entries[pgstrom_stat_gpu_query_max])));
+		shmem_startup_next = shmem_startup_hook;
+		shmem_startup_hook = pgstrom_startup_gputasks;
+	}
+	/* hook to link the GPU nodes under Append */
+	executor_start_next = ExecutorStart_hook;
+	ExecutorStart_hook = pgstrom_executor_start;
 }
@@ -32,6 +32,7 @@ typedef struct
 	Cost			inner_cost;		/* cost to setup inner heap/hash */
 	bool			inner_parallel;	/* inner relations support parallel? */
 	cl_int		   *sibling_param_id; /* only if partition-wise join child */
+	cl_int			preferred_gpu;	/* GPU affinity of partition-wise join */
 	struct {
 		JoinType	join_type;		/* one of JOIN_* */
 		double		join_nrows;		/* intermediate nrows in this depth */
@@ -44,6 +45,9 @@ typedef struct
 		Expr	   *gist_clause;	/* GiST index clause */
 		Selectivity	gist_selectivity; /* GiST index selectivity */
 		Size		ichunk_size;	/* expected inner chunk size */
+		cl_int		inner_nparts;	/* number of inner hash partitions */
+		pgstromFeedbackSignature join_signature;  /* cardinality feedback */
+		pgstromFeedbackSignature inner_signature; /* (same, for inner rel) */
 	} inners[FLEXIBLE_ARRAY_MEMBER];
 } GpuJoinPath;
 
@@ -69,6 +73,7 @@ typedef struct
 	/* inner-scan parameters */
 	cl_bool		inner_parallel;
 	cl_int		sibling_param_id;
+	cl_int		preferred_gpu;
 	/* BRIN-index support */
 	Oid			index_oid;			/* OID of BRIN-index, if any */
 	List	   *index_conds;		/* BRIN-index key conditions */
@@ -88,6 +93,8 @@ typedef struct
 	double		plan_nrows_out;
 	size_t		ichunk_size;
 	JoinType	join_type;
+	int			inner_nparts;			/* >1, if partitioned Hash-join */
+	bool		hash_bucketed;			/* true, if open-addressing buckets */
 	List	   *join_quals;
 	List	   *other_quals;
 	List	   *hash_inner_keys;		/* if Hash-join */
@@ -96,6 +103,8 @@ typedef struct
 	AttrNumber	gist_index_column;		/* if GiST-index */
 	AttrNumber	gist_index_ctid_resno;	/* if GiST-index */
 	Expr	   *gist_index_clause;		/* if GiST-index */
+	pgstromFeedbackSignature join_signature;	/* for cardinality feedback */
+	pgstromFeedbackSignature inner_signature;	/* for cardinality feedback */
 } GpuJoinInnerInfo;
 
 static inline void
@@ -122,6 +131,7 @@ form_gpujoin_info(CustomScan *cscan, GpuJoinInfo *gj_info)
 	privs = lappend(privs, makeInteger(gj_info->outer_nrows_per_block));
 	privs = lappend(privs, makeInteger(gj_info->inner_parallel));
 	privs = lappend(privs, makeInteger(gj_info->sibling_param_id));
+	privs = lappend(privs, makeInteger(gj_info->preferred_gpu));
 	privs = lappend(privs, makeInteger(gj_info->index_oid));
 	privs = lappend(privs, gj_info->index_conds);
 	exprs = lappend(exprs, gj_info->index_quals);
@@ -145,6 +155,10 @@ form_gpujoin_info(CustomScan *cscan, GpuJoinInfo *gj_info)
 		p_items = lappend(p_items, makeInteger(i_info->gist_index_column));
 		p_items = lappend(p_items, makeInteger(i_info->gist_index_ctid_resno));
 		e_items = lappend(e_items, i_info->gist_index_clause);
+		p_items = lappend(p_items, makeInteger(i_info->inner_nparts));
+		p_items = lappend(p_items, makeInteger(i_info->hash_bucketed));
+		p_items = lappend(p_items, pgstromFeedbackSignatureToList(i_info->join_signature));
+		p_items = lappend(p_items, pgstromFeedbackSignatureToList(i_info->inner_signature));
 
 		privs = lappend(privs, p_items);
 		exprs = lappend(exprs, e_items);
@@ -185,6 +199,7 @@ deform_gpujoin_info(CustomScan *cscan)
 	gj_info->outer_nrows_per_block = intVal(list_nth(privs, pindex++));
 	gj_info->inner_parallel = intVal(list_nth(privs, pindex++));
 	gj_info->sibling_param_id = intVal(list_nth(privs, pindex++));
+	gj_info->preferred_gpu = intVal(list_nth(privs, pindex++));
 	gj_info->index_oid = intVal(list_nth(privs, pindex++));
 	gj_info->index_conds = list_nth(privs, pindex++);
 	gj_info->index_quals = list_nth(exprs, eindex++);
@@ -208,6 +223,12 @@ deform_gpujoin_info(CustomScan *cscan)
 		i_info->gist_index_column = (AttrNumber)intVal(list_nth(p_items, 5));
 		i_info->gist_index_ctid_resno = (AttrNumber)intVal(list_nth(p_items, 6));
 		i_info->gist_index_clause = list_nth(e_items, 4);
+		i_info->inner_nparts = intVal(list_nth(p_items, 7));
+		i_info->hash_bucketed = intVal(list_nth(p_items, 8));
+		i_info->join_signature =
+			pgstromFeedbackSignatureFromList(list_nth(p_items, 9));
+		i_info->inner_signature =
+			pgstromFeedbackSignatureFromList(list_nth(p_items, 10));
 
 		gj_info->inner_infos = lappend(gj_info->inner_infos, i_info);
 	}
@@ -221,6 +242,41 @@ deform_gpujoin_info(CustomScan *cscan)
 	return gj_info;
 }
 
+/*
+ * gpujoinRuntimeFilter - range of the inner hash-key, to be pushed down
+ * to the outer Arrow_Fdw scan for record-batch skipping
+ */
+typedef struct
+{
+	ExprState	   *i_key_state;	/* inner hash-key */
+	AttrNumber		outer_anum;		/* outer column that joins to */
+	Oid				type_oid;
+	int32			type_mod;
+	int16			type_len;
+	Oid				collid;
+	Oid				ge_opr;			/* '>=' operator */
+	Oid				le_opr;			/* '<=' operator */
+	FmgrInfo	   *cmp_finfo;		/* btree comparison function */
+	bool			valid;			/* true, if min/max are set */
+	Datum			min_value;
+	Datum			max_value;
+} gpujoinRuntimeFilter;
+
+/*
+ * gpujoinInnerCacheVersion - version of the inner relation, to validate
+ * the inner buffer cache
+ */
+#define GPUJOIN_INNER_CACHE_NSLOTS		64
+#define GPUJOIN_INNER_CACHE_MAX_RELS	8
+
+typedef struct
+{
+	Oid			relid;
+	Oid			relfilenode;
+	BlockNumber	nblocks;
+	XLogRecPtr	vm_lsn;			/* max LSN of the visibility-map pages */
+} gpujoinInnerCacheVersion;
+
 /*
  * GpuJoinState - execution state object of GpuJoin
  */
@@ -245,6 +301,8 @@ typedef struct
 	JoinType			join_type;
 	double				nrows_ratio;
 	cl_uint				ichunk_size;
+	pgstromFeedbackSignature join_signature;	/* for cardinality feedback */
+	pgstromFeedbackSignature inner_signature;	/* for cardinality feedback */
 	ExprState		   *join_quals;
 	ExprState		   *other_quals;
 
@@ -253,6 +311,22 @@ typedef struct
 	 */
 	List			   *hash_outer_keys;
 	List			   *hash_inner_keys;
+	bool				hash_bucketed;
+
+	/*
+	 * Partitioned Hash-join; inner tuples are kept on the host memory
+	 * for each partition, then only one of them is loaded on the inner
+	 * buffer at once.
+	 */
+	int					inner_nparts;
+	slist_head		   *part_tuples;
+	size_t			   *part_nitems;
+	size_t			   *part_usage;
+
+	/*
+	 * Runtime join filter; list of gpujoinRuntimeFilter
+	 */
+	List			   *rfilter_list;
 
 	/*
 	 * Join properties; GiST index
@@ -267,6 +341,8 @@ typedef struct
 	cl_long				fallback_inner_index;
 	pg_crc32			fallback_inner_hash;
 	cl_bool				fallback_inner_matched;
+	cl_uint				fallback_skew_next;	/* next row-index and end of */
+	cl_uint				fallback_skew_end;	/* the heavy-hitter key, if any */
 } innerState;
 
 typedef struct
@@ -282,6 +358,13 @@ typedef struct
 	bool			m_kmrels_owner;
 	bool			inner_parallel;
 	MemoryContext	preload_memcxt;		/* memory context for preloading */
+	MemoryContext	partition_memcxt;	/* memory context for inner partitions */
+	cl_int			inner_part_depth;	/* depth of partitioned inner, or 0 */
+	cl_int			inner_curr_part;	/* current inner partition */
+	bool			inner_reloaded;		/* true, if rescan reloaded inner */
+	bool			inner_cache_enabled; /* true, if inner buffer is cachable */
+	uint64			inner_cache_key[2];	/* signature of the inner buffer */
+	gpujoinInnerCacheVersion *inner_cache_vers; /* versions prior to scan */
 
 	/*
 	 * Expressions to be used in the CPU fallback path
@@ -331,9 +414,13 @@ struct GpuJoinSharedState
 	int				phase;			/* one of INNER_PHASE__* above */
 	int				nr_workers_scanning;
 	int				nr_workers_setup;
+	pg_atomic_uint32 preload_next_depth; /* next depth to be preloaded */
 	pg_atomic_uint32 outer_scan_done;  /* non-zero, if outer is scanned */
 	pg_atomic_uint32 needs_colocation; /* non-zero, if colocation is needed */
 	cl_int			curr_outer_depth;
+	cl_int			inner_cache_index;	/* index of the inner buffer cache */
+	cl_int			inner_cache_dindex;	/* device index of the cached buffer */
+	bool			inner_cache_hit;	/* true, if cached buffer is reused */
 	struct {
 		int			nr_workers_gpujoin;
 		size_t		bytesize;		/* not zero, if allocated */
@@ -342,12 +429,51 @@ struct GpuJoinSharedState
 };
 typedef struct GpuJoinSharedState	GpuJoinSharedState;
 
+/*
+ * gpujoinInnerCacheHead - shared state of the inner buffer cache
+ *
+ * It keeps the host and device inner buffer (kern_multirels) built from the
+ * inner relations, to reuse them on the later queries that join the same
+ * inner relations with the same qualifiers. A cached buffer is valid only if
+ * all the pages of the inner relations are all-visible, because its contents
+ * are identical for any snapshots in this case. Any modification clears the
+ * all-visible bit, and VACUUM that sets the bit again updates LSN of the
+ * visibility-map page, so LSN of the visibility-map pages validates the cache.
+ */
+typedef struct
+{
+	bool		in_use;
+	bool		invalid;		/* to be released once refcnt gets 0 */
+	int			refcnt;
+	uint64		key[2];
+	uint64		last_used;
+	cl_uint		shmem_handle;	/* host inner buffer */
+	size_t		shmem_bytesize;
+	int			cuda_dindex;	/* device inner buffer */
+	size_t		bytesize;
+	CUipcMemHandle ipc_mhandle;
+	int			nrels;
+	gpujoinInnerCacheVersion vers[GPUJOIN_INNER_CACHE_MAX_RELS];
+} gpujoinInnerCacheEntry;
+
+typedef struct
+{
+	slock_t		lock;
+	uint64		lru_clock;
+	size_t		total_usage;
+	gpujoinInnerCacheEntry entries[GPUJOIN_INNER_CACHE_NSLOTS];
+} gpujoinInnerCacheHead;
+
 /*
  * GpuJoinRuntimeStat - shared runtime statistics
  */
 struct GpuJoinRuntimeStat
 {
 	GpuTaskRuntimeStat		c;		/* common statistics */
+	pg_atomic_uint64		result_ntasks;	/* # of tasks by outer chunks */
+	pg_atomic_uint64		result_nitems;	/* # of result rows and length */
+	pg_atomic_uint64		result_usage;	/* of the tasks above */
+	pg_atomic_uint64		suspend_count;	/* # of kernel suspend/resume */
 	struct {
 		pg_atomic_uint64	inner_nrooms;
 		pg_atomic_uint64	inner_usage;
@@ -397,6 +523,12 @@ typedef struct
 	kern_gpujoin	kern;		/* kern_gpujoin of this request */
 } GpuJoinTask;
 
+/* upper limit number of inner partitions by partitioned GpuHashJoin */
+#define GPUHASHJOIN_MAX_PARTITIONS		256
+
+/* upper limit length of the destination buffer by the runtime statistics */
+#define GPUJOIN_RESULT_MAX_LENGTH		(1UL << 30)
+
 /* static variables */
 static set_join_pathlist_hook_type set_join_pathlist_next;
 static CustomPathMethods	gpujoin_path_methods;
@@ -406,13 +538,46 @@ static bool					enable_gpunestloop;				/* GUC */
 static bool					enable_gpuhashjoin;				/* GUC */
 static bool					enable_gpugistindex;			/* GUC */
 static bool					enable_partitionwise_gpujoin;	/* GUC */
+static bool					enable_partitionwise_gpujoin_affinity; /* GUC */
+static bool					enable_gpuhashjoin_partition;	/* GUC */
+static int					gpuhashjoin_partition_size_kb;	/* GUC */
+static int					gpuhashjoin_partition_max_host_memory_kb; /* GUC */
+static bool					enable_gpuhashjoin_bloom;		/* GUC */
+static bool					enable_gpuhashjoin_open_addressing;	/* GUC */
+static bool					enable_gpuhashjoin_device_build;	/* GUC */
+static int					gpuhashjoin_skew_threshold;		/* GUC */
+static bool					enable_gpujoin_inner_peer_access;	/* GUC */
+static bool					enable_gpujoin_inner_cache;		/* GUC */
+static bool					enable_gpujoin_bushy;			/* GUC */
+static int					gpujoin_inner_cache_size_kb;	/* GUC */
+static shmem_startup_hook_type shmem_startup_next = NULL;
+static gpujoinInnerCacheHead *gj_inner_cache = NULL;
+static int					gj_inner_cache_refs[GPUJOIN_INNER_CACHE_NSLOTS];
 
 /* static functions */
 static void gpujoin_switch_task(GpuTaskState *gts, GpuTask *gtask);
 static GpuTask *gpujoin_next_task(GpuTaskState *gts);
+static bool gpujoin_speculative_task(GpuTaskState *gts, GpuTask *gtask);
+static pgstrom_data_store *gpujoin_bulk_exec(GpuTaskState *gts,
+											  GpuTask *gtask);
+static bool gpujoin_begin_exec(GpuTaskState *gts);
 static GpuTask *gpujoin_terminator_task(GpuTaskState *gts,
 										cl_bool *task_is_ready);
 static TupleTableSlot *gpujoin_next_tuple(GpuTaskState *gts);
+static void gpujoinLoadInnerPartition(GpuJoinState *gjs, int part);
+static void innerPreloadSelectPartition(innerState *istate, int part);
+static void __innerPreloadSetupHashBuffer(kern_data_store *kds,
+										  innerState *istate,
+										  cl_uint base_nitems,
+										  cl_uint base_usage);
+static void __innerPreloadSetupBloomFilter(kern_multirels *h_kmrels,
+										   innerState *istate);
+static void __innerPreloadSetupHashBuckets(kern_multirels *h_kmrels,
+										   kern_data_store *kds,
+										   int depth,
+										   cl_uint base_nitems,
+										   cl_uint nitems);
+static void __innerPreloadSetupHashSkew(kern_multirels *h_kmrels, int depth);
 static cl_uint get_tuple_hashvalue(innerState *istate,
 								   bool is_inner_hashkeys,
 								   TupleTableSlot *slot,
@@ -432,6 +597,12 @@ static size_t createGpuJoinSharedState(GpuJoinState *gjs,
 static void cleanupGpuJoinSharedStateOnAbort(dsm_segment *segment,
 											 Datum ptr);
 static void gpujoinColocateOuterJoinMapsToHost(GpuJoinState *gjs);
+static void gpujoinInnerCacheInit(GpuJoinState *gjs,
+								  GpuJoinInfo *gj_info,
+								  CustomScan *cscan);
+static bool gpujoinInnerCacheLookup(GpuJoinState *gjs);
+static void gpujoinInnerCacheStore(GpuJoinState *gjs);
+static void gpujoinInnerCacheDetach(GpuJoinSharedState *gj_sstate);
 
 /*
  * misc declarations
@@ -479,6 +650,20 @@ pgstrom_planstate_is_gpujoin(const PlanState *ps)
 	return false;
 }
 
+/*
+ * GpuJoinInnerIsPartitioned
+ *
+ * returns true, if GpuJoin scans the outer relation for each inner partition
+ */
+bool
+GpuJoinInnerIsPartitioned(const PlanState *ps)
+{
+	const GpuJoinState *gjs = (const GpuJoinState *) ps;
+
+	Assert(pgstrom_planstate_is_gpujoin(ps));
+	return (gjs->inner_part_depth > 0);
+}
+
 /*
  * gpujoin_get_optimal_gpus
  */
@@ -577,6 +762,14 @@ estimate_inner_buffersize(PlannerInfo *root,
 		Size		inner_nrows = (Size)inner_path->rows;
 		Size		chunk_size;
 		Size		htup_size;
+		double		fb_nrows_in;
+		double		fb_nrows_out;
+
+		/* number of inner rows loaded by the earlier execution, if any */
+		if (pgstromLookupCardinalityFeedback(gpath->inners[i].inner_signature,
+											 &fb_nrows_in,
+											 &fb_nrows_out))
+			inner_nrows = (Size)fb_nrows_out;
 
 		/*
 		 * NOTE: PathTarget->width is not reliable for base relations 
@@ -631,10 +824,17 @@ cost_gpujoin(PlannerInfo *root,
 	Cost		run_cost = 0.0;
 	Cost		startup_delay;
 	Size		inner_buffer_sz = 0;
-	double		gpu_ratio = pgstrom_gpu_operator_cost / cpu_operator_cost;
+	Size		inner_device_sz;
+	Size		avail_sz;
+	double		gpu_ratio = pgstrom_device_operator_cost() / cpu_operator_cost;
 	double		parallel_divisor = 1.0;
 	double		num_chunks;
 	double		outer_ntuples = outer_path->rows;
+	double		depth_nrows = outer_path->rows;
+	double		fb_nrows_in;
+	double		fb_nrows_out;
+	Relids		join_relids = outer_path->parent->relids;
+	int			inner_nparts = 1;
 	int			i, num_rels = gpath->num_rels;
 	bool		retval = false;
 
@@ -673,6 +873,32 @@ cost_gpujoin(PlannerInfo *root,
 		parallel_divisor = get_parallel_divisor(&gpath->cpath.path);
 	}
 
+	/*
+	 * Signatures of the inner relations and the join depths. If an earlier
+	 * execution of the same query shape recorded the actual number of rows,
+	 * it replaces the estimated selectivity of the join depth.
+	 */
+	for (i=0; i < num_rels; i++)
+	{
+		RelOptInfo *inner_rel = gpath->inners[i].scan_path->parent;
+
+		join_relids = bms_union(join_relids, inner_rel->relids);
+		gpath->inners[i].inner_signature =
+			pgstromCardinalityFeedbackSignature(root, inner_rel->relids, NIL);
+		gpath->inners[i].join_signature =
+			pgstromCardinalityFeedbackSignature(root, join_relids,
+												gpath->inners[i].join_quals);
+		if (pgstromLookupCardinalityFeedback(gpath->inners[i].join_signature,
+											 &fb_nrows_in,
+											 &fb_nrows_out) &&
+			fb_nrows_in > 0.0)
+		{
+			gpath->inners[i].join_nrows =
+				clamp_row_est(depth_nrows * fb_nrows_out / fb_nrows_in);
+		}
+		depth_nrows = gpath->inners[i].join_nrows;
+	}
+
 	/*
 	 * Estimation of inner hash/heap buffer, and number of internal loop
 	 * to process in-kernel Join logic
@@ -696,6 +922,48 @@ cost_gpujoin(PlannerInfo *root,
 		Cost		inner_run_cost;
 		QualCost	join_quals_cost;
 
+		gpath->inners[i].inner_nparts = 1;
+		/*
+		 * Partitioned GpuHashJoin - If inner hash table is too large
+		 * to load at once, inner tuples are split into multiple partitions
+		 * by their hash value, then GpuJoin scans the outer relation for
+		 * each partition. It is only valid for INNER JOIN, because outer
+		 * tuples that have no matched inner tuples in the current partition
+		 * may have pairs in the other partition.
+		 * All the inner tuples are kept on the host memory of the backend
+		 * during execution, without spill to temp files, so we don't choose
+		 * the partitioned path if the inner relation is larger than
+		 * pg_strom.gpuhashjoin_partition_max_host_memory.
+		 */
+		if (ichunk_size >= 0x60000000UL &&
+			enable_gpuhashjoin_partition &&
+			(double)ichunk_size <= ((double)gpuhashjoin_partition_max_host_memory_kb *
+									1024.0) &&
+			hash_quals != NIL &&
+			gpath->inners[i].join_type == JOIN_INNER &&
+			inner_nparts == 1 &&
+			parallel_nworkers == 0 &&
+			!gpath->sibling_param_id)
+		{
+			Size	part_sz = (Size)gpuhashjoin_partition_size_kb << 10;
+			Size	nparts = (ichunk_size + part_sz - 1) / part_sz;
+			int		j;
+
+			for (j=0; j < num_rels; j++)
+			{
+				if (gpath->inners[j].join_type == JOIN_RIGHT ||
+					gpath->inners[j].join_type == JOIN_FULL)
+					break;
+			}
+			if (j == num_rels && nparts <= GPUHASHJOIN_MAX_PARTITIONS)
+			{
+				inner_nparts = nparts;
+				ichunk_size = (ichunk_size + nparts - 1) / nparts;
+				gpath->inners[i].inner_nparts = nparts;
+				gpath->inners[i].ichunk_size = ichunk_size;
+			}
+		}
+
 		/*
 		 * FIXME: Right now, KDS_FORMAT_ROW/HASH does not support KDS size
 		 * larger than 4GB because of 32bit index from row_index[] or
@@ -761,7 +1029,7 @@ cost_gpujoin(PlannerInfo *root,
 			inner_cost += cpu_operator_cost * num_hashkeys * scan_path->rows;
 
 			/* cost to comput hash value by GPU */
-			run_cost += (pgstrom_gpu_operator_cost *
+			run_cost += (pgstrom_device_operator_cost() *
 						 num_hashkeys *
 						 outer_ntuples);
 			/* cost to evaluate join qualifiers */
@@ -811,12 +1079,38 @@ cost_gpujoin(PlannerInfo *root,
 		/* number of outer items on the next depth */
 		outer_ntuples = join_nrows / parallel_divisor;
 	}
+
+	/*
+	 * Inner buffer must be loaded onto the device memory at once (or per
+	 * partition), so we reject the path if it cannot fit the free device
+	 * memory under the current load, and penalize the path if it consumes
+	 * major portion of the free device memory.
+	 */
+	inner_device_sz = STROMALIGN(offsetof(kern_multirels,
+										  chunks[num_rels]));
+	for (i=0; i < num_rels; i++)
+		inner_device_sz += gpath->inners[i].ichunk_size;
+	avail_sz = gpuMemAvailableForPlanning(gpath->optimal_gpus);
+	if (inner_device_sz > avail_sz)
+	{
+		elog(DEBUG1, "expected inner buffer size (%zu) exceeds the free device memory (%zu)",
+			 inner_device_sz, avail_sz);
+		return false;
+	}
+	else if (inner_device_sz > avail_sz / 2)
+	{
+		inner_cost *= (1.0 + 2.0 * ((double)inner_device_sz /
+									(double)avail_sz - 0.5));
+	}
+
 	/* outer DMA send cost */
-	run_cost += (double)num_chunks * pgstrom_gpu_dma_cost;
+	run_cost += (double)num_chunks * pgstrom_device_dma_cost();
+	/* outer relation is scanned for each inner partition */
+	run_cost *= (double)inner_nparts;
 
 	/* inner DMA send cost */
 	inner_cost += ((double)inner_buffer_sz /
-				   (double)pgstrom_chunk_size()) * pgstrom_gpu_dma_cost;
+				   (double)pgstrom_chunk_size()) * pgstrom_device_dma_cost();
 
 	/* cost for GPU projection */
 	startup_cost += joinrel->reltarget->cost.startup;
@@ -869,7 +1163,9 @@ cost_gpujoin(PlannerInfo *root,
 			appendStringInfo(&buf, " %s%s ",
 							 join_type == JOIN_FULL ? "F" :
 							 join_type == JOIN_LEFT ? "L" :
-							 join_type == JOIN_RIGHT ? "R" : "I",
+							 join_type == JOIN_RIGHT ? "R" :
+							 join_type == JOIN_SEMI ? "S" :
+							 join_type == JOIN_ANTI ? "A" : "I",
 							 is_nestloop ? "NL" : "HJ");
 		}
 		__dump_gpujoin_rel(&buf, root, outer_path->parent);
@@ -924,6 +1220,10 @@ create_gpujoin_path(PlannerInfo *root,
 	}
 	if ((try_outer_parallel | try_inner_parallel) && !parallel_safe)
 		return NULL;
+	if (try_outer_parallel)
+		parallel_nworkers = pgstrom_gpu_parallel_workers(root,
+														 outer_path->parent,
+														 parallel_nworkers);
 
 	gjpath = palloc0(offsetof(GpuJoinPath, inners[num_rels + 1]));
 	NodeSetTag(gjpath, T_CustomPath);
@@ -938,6 +1238,7 @@ create_gpujoin_path(PlannerInfo *root,
 	gjpath->cpath.path.rows = joinrel->rows;
 	gjpath->cpath.flags = 0;
 	gjpath->cpath.methods = &gpujoin_path_methods;
+	gjpath->preferred_gpu = -1;
 	gjpath->outer_relid = 0;
 	gjpath->outer_quals = NULL;
 	gjpath->num_rels = num_rels;
@@ -953,7 +1254,9 @@ create_gpujoin_path(PlannerInfo *root,
 			hash_quals = ip_item->hash_quals;
 		else if (enable_gpunestloop &&
 				 (ip_item->join_type == JOIN_INNER ||
-				  ip_item->join_type == JOIN_LEFT))
+				  ip_item->join_type == JOIN_LEFT ||
+				  ip_item->join_type == JOIN_SEMI ||
+				  ip_item->join_type == JOIN_ANTI))
 			hash_quals = NIL;
 		else
 		{
@@ -971,6 +1274,7 @@ create_gpujoin_path(PlannerInfo *root,
 		gjpath->inners[i].gist_clause = ip_item->gist_clause;
 		gjpath->inners[i].gist_selectivity = ip_item->gist_selectivity;
 		gjpath->inners[i].ichunk_size = 0;		/* to be set later */
+		gjpath->inners[i].inner_nparts = 1;		/* to be set later */
 		i++;
 	}
 	Assert(i == num_rels);
@@ -1250,14 +1554,22 @@ fixup_gist_clause_for_device(PlannerInfo *root,
 						  &raw_typid,
 						  &raw_typmod,
 						  &raw_collid);
-	if (dindex->ivar_dtype->type_oid != raw_typid)
+	if (!dindex->ivar_dtype)
+	{
+		/* polymorphic index handler, like anyrange */
+		if (raw_typid != exprType((Node *)iarg) ||
+			!pgstrom_devtype_lookup(raw_typid))
+			return NULL;
+	}
+	else if (dindex->ivar_dtype->type_oid != raw_typid)
 		return NULL;	/* type mismatch */
 	ivar = makeVar(INDEX_VAR,
 				   indexcol + 1,
 				   raw_typid,
 				   raw_typmod,
 				   raw_collid, 0);
-	Assert(dindex->iarg_dtype->type_oid == exprType((Node *)iarg));
+	Assert(!dindex->iarg_dtype ||
+		   dindex->iarg_dtype->type_oid == exprType((Node *)iarg));
 
 	if (p_ivar)
 		*p_ivar = ivar;
@@ -1297,6 +1609,33 @@ match_clause_to_index(PlannerInfo *root,
 		else if (IsA(rinfo->clause, FuncExpr))
 			expr = match_funcclause_to_indexcol(root, rinfo, index, indexcol);
 
+		/*
+		 * Planner support function may return multiple index conditions
+		 * as an implicitly-ANDed list. The original qualifier is still
+		 * evaluated as a part of join-quals, so it is sufficient to pick
+		 * up one of the index conditions runnable on the device, instead
+		 * of giving up the GiST-index.
+		 */
+#if PG_VERSION_NUM >= 120000
+		if (expr && is_andclause(expr))
+		{
+			ListCell   *cell;
+
+			foreach (cell, ((BoolExpr *)expr)->args)
+			{
+				Expr   *arg = lfirst(cell);
+
+				if (fixup_gist_clause_for_device(root, index, indexcol,
+												 (OpExpr *)arg,
+												 NULL, NULL) != NULL)
+				{
+					expr = arg;
+					break;
+				}
+			}
+		}
+#endif
+
 		if (fixup_gist_clause_for_device(root, index, indexcol,
 										 (OpExpr *)expr,
 										 &ivar,
@@ -1746,6 +2085,8 @@ buildPartitionedGpuJoinPaths(PlannerInfo *root,
 	GpuJoinPath *gjpath_leader = NULL;
 	bool		assign_sibling_param_id = true;
 	int			parallel_nworkers = 0;
+	int			leaf_index = 0;
+	int			k;
 
 	inner_items_base = buildInnerPathItems(root,
 										   append_path,
@@ -1843,6 +2184,22 @@ buildPartitionedGpuJoinPaths(PlannerInfo *root,
 									 try_inner_parallel);
 		if (!gjpath)
 			return NIL;
+		/*
+		 * Assign GPUs to the leafs in round-robin, if outer-scan has no
+		 * preference on the GPUs (like NVME locality). It allows to run
+		 * partition leafs concurrently on multiple GPUs, by Parallel Append.
+		 */
+		if (enable_partitionwise_gpujoin_affinity &&
+			numDevAttrs > 1 &&
+			bms_is_empty(gjpath->optimal_gpus))
+			gjpath->preferred_gpu = leaf_index % numDevAttrs;
+		leaf_index++;
+		/* partitioned inner buffer cannot be shared by the siblings */
+		for (k=0; k < gjpath->num_rels; k++)
+		{
+			if (gjpath->inners[k].inner_nparts > 1)
+				assign_sibling_param_id = false;
+		}
 		if (!gjpath_leader)
 			gjpath_leader = gjpath;
 		else
@@ -2282,7 +2639,9 @@ try_add_gpujoin_paths(PlannerInfo *root,
 	if (join_type != JOIN_INNER &&
 		join_type != JOIN_FULL &&
 		join_type != JOIN_RIGHT &&
-		join_type != JOIN_LEFT)
+		join_type != JOIN_LEFT &&
+		join_type != JOIN_SEMI &&
+		join_type != JOIN_ANTI)
 		return;
 
 	/*
@@ -2339,6 +2698,13 @@ try_add_gpujoin_paths(PlannerInfo *root,
 
 		if (!pgstrom_device_expression(root, joinrel, rinfo->clause))
 			return;
+		/*
+		 * ANTI JOIN generates outer rows that have no matched inner rows,
+		 * thus, pushed-down qualifiers cannot be applied on the device
+		 * join; only the join-clauses are supported.
+		 */
+		if (join_type == JOIN_ANTI && rinfo->is_pushed_down)
+			return;
 	}
 
 	/*
@@ -2354,7 +2720,9 @@ try_add_gpujoin_paths(PlannerInfo *root,
 								  inner_path->parent->relids,
 								  join_type,
 								  restrict_clauses);
-	if (ip_item->hash_quals == NIL)
+	if (ip_item->hash_quals == NIL &&
+		join_type != JOIN_SEMI &&
+		join_type != JOIN_ANTI)
 		extract_gpugistindex_clause(ip_item,
 									root,
 									join_type,
@@ -2433,6 +2801,50 @@ try_add_gpujoin_paths(PlannerInfo *root,
 									 try_inner_parallel);
 }
 
+/*
+ * try_add_bushy_gpujoin_paths
+ *
+ * If the inner relation is a join, e.g, dimension-to-sub-dimension join
+ * of the snowflake schema, its cheapest GpuJoin path is also tried as
+ * the inner sub-tree, even if the cheapest path of the inner relation is
+ * not a GpuJoin. Unlike the outer side, the inner GpuJoin is not pulled
+ * up to the parent, so it makes a bushy plan.
+ */
+static void
+try_add_bushy_gpujoin_paths(PlannerInfo *root,
+							RelOptInfo *joinrel,
+							Path *outer_path,
+							RelOptInfo *innerrel,
+							JoinType join_type,
+							JoinPathExtraData *extra,
+							bool try_outer_parallel)
+{
+	const Path *pathnode;
+
+	if (!enable_gpujoin_bushy ||
+		innerrel->reloptkind != RELOPT_JOINREL ||
+		!innerrel->cheapest_total_path ||
+		pgstrom_path_is_gpujoin(innerrel->cheapest_total_path))
+		return;		/* already tried, if any */
+
+	pathnode = gpu_path_find_cheapest(root, innerrel, false, false);
+	if (!pathnode || !pgstrom_path_is_gpujoin(pathnode))
+		return;
+	if ((try_outer_parallel && !pathnode->parallel_safe) ||
+		bms_overlap(PATH_REQ_OUTER((Path *)pathnode),
+					outer_path->parent->relids))
+		return;
+
+	try_add_gpujoin_paths(root,
+						  joinrel,
+						  outer_path,
+						  pgstrom_copy_pathnode(pathnode),
+						  join_type,
+						  extra,
+						  try_outer_parallel,
+						  false);
+}
+
 /*
  * gpujoin_add_join_path
  *
@@ -2493,6 +2905,13 @@ gpujoin_add_join_path(PlannerInfo *root,
 								  false);
 			break;
 		}
+		try_add_bushy_gpujoin_paths(root,
+									joinrel,
+									outer_path,
+									innerrel,
+									jointype,
+									extra,
+									false);
 		break;
 	}
 	if (!joinrel->consider_parallel)
@@ -2532,6 +2951,13 @@ gpujoin_add_join_path(PlannerInfo *root,
 				half_parallel_done = true;
 				break;
 			}
+			try_add_bushy_gpujoin_paths(root,
+										joinrel,
+										outer_path,
+										innerrel,
+										jointype,
+										extra,
+										true);
 		}
 
 		if (!full_parallel_done)
@@ -2954,6 +3380,7 @@ PlanGpuJoinPath(PlannerInfo *root,
 		}
 		gj_info.sibling_param_id = param_id;
 	}
+	gj_info.preferred_gpu = gjpath->preferred_gpu;
 	gj_info.inner_parallel = gjpath->inner_parallel;
 
 	outer_nrows = outer_plan->plan_rows;
@@ -2971,6 +3398,9 @@ PlanGpuJoinPath(PlannerInfo *root,
 		i_info->plan_nrows_out = gjpath->inners[i].join_nrows;
 		i_info->ichunk_size = gjpath->inners[i].ichunk_size;
 		i_info->join_type = gjpath->inners[i].join_type;
+		i_info->inner_nparts = gjpath->inners[i].inner_nparts;
+		i_info->join_signature = gjpath->inners[i].join_signature;
+		i_info->inner_signature = gjpath->inners[i].inner_signature;
 
 		/* GpuHashJoin properties */
 		foreach (lc, gjpath->inners[i].hash_quals)
@@ -3190,6 +3620,72 @@ gpujoin_create_scan_state(CustomScan *node)
 	return (Node *) gjs;
 }
 
+/*
+ * gpujoinInitRuntimeFilter
+ *
+ * It checks whether the pair of hash-keys is available for the runtime
+ * join filter. It should be a simple column reference to the outer relation
+ * and pass-by-value data type that has btree operator family.
+ */
+static gpujoinRuntimeFilter *
+gpujoinInitRuntimeFilter(GpuJoinState *gjs,
+						 GpuJoinInfo *gj_info,
+						 Expr *i_expr,
+						 Expr *o_expr)
+{
+	Relation	relation = gjs->gts.css.ss.ss_currentRelation;
+	gpujoinRuntimeFilter *rfilter;
+	TypeCacheEntry *tcache;
+	Var		   *var = (Var *) o_expr;
+	Form_pg_attribute attr;
+	AttrNumber	anum;
+	Oid			ge_opr;
+	Oid			le_opr;
+
+	if (!relation || !IsA(var, Var) || var->varno != INDEX_VAR)
+		return NULL;
+	if (list_nth_int(gj_info->ps_src_depth, var->varattno - 1) != 0)
+		return NULL;
+	anum = list_nth_int(gj_info->ps_src_resno, var->varattno - 1);
+	if (anum <= 0 || anum > RelationGetNumberOfAttributes(relation))
+		return NULL;
+	attr = tupleDescAttr(RelationGetDescr(relation), anum - 1);
+	if (attr->atttypid != var->vartype ||
+		exprType((Node *)i_expr) != var->vartype)
+		return NULL;
+
+	tcache = lookup_type_cache(var->vartype,
+							   TYPECACHE_BTREE_OPFAMILY |
+							   TYPECACHE_CMP_PROC_FINFO);
+	if (!tcache->typbyval ||
+		!OidIsValid(tcache->btree_opf) ||
+		!OidIsValid(tcache->cmp_proc_finfo.fn_oid))
+		return NULL;
+	ge_opr = get_opfamily_member(tcache->btree_opf,
+								 var->vartype,
+								 var->vartype,
+								 BTGreaterEqualStrategyNumber);
+	le_opr = get_opfamily_member(tcache->btree_opf,
+								 var->vartype,
+								 var->vartype,
+								 BTLessEqualStrategyNumber);
+	if (!OidIsValid(ge_opr) || !OidIsValid(le_opr))
+		return NULL;
+
+	rfilter = palloc0(sizeof(gpujoinRuntimeFilter));
+	rfilter->outer_anum = anum;
+	rfilter->type_oid = var->vartype;
+	rfilter->type_mod = attr->atttypmod;
+	rfilter->type_len = tcache->typlen;
+	rfilter->collid = exprCollation((Node *)o_expr);
+	rfilter->ge_opr = ge_opr;
+	rfilter->le_opr = le_opr;
+	rfilter->cmp_finfo = &tcache->cmp_proc_finfo;
+	rfilter->valid = false;
+
+	return rfilter;
+}
+
 static void
 ExecInitGpuJoin(CustomScanState *node, EState *estate, int eflags)
 {
@@ -3211,8 +3707,24 @@ ExecInitGpuJoin(CustomScanState *node, EState *estate, int eflags)
 	gpujoinPseudoStack *pstack_head;
 	size_t			off, sz;
 
-	/* activate a GpuContext for CUDA kernel execution */
-	gjs->gts.gcontext = AllocGpuContext(gj_info->optimal_gpus, false, false);
+	/*
+	 * activate a GpuContext for CUDA kernel execution
+	 *
+	 * If partition-wise join assigned a particular GPU for this leaf,
+	 * and no other GPUs are preferable for the outer scan, we use the
+	 * preferred GPU to distribute the partition leafs on multiple GPUs.
+	 */
+	if (bms_is_empty(gj_info->optimal_gpus) &&
+		gj_info->preferred_gpu >= 0 &&
+		gj_info->preferred_gpu < numDevAttrs)
+	{
+		Bitmapset  *preferred_gpus = bms_make_singleton(gj_info->preferred_gpu);
+
+		gjs->gts.gcontext = AllocGpuContext(preferred_gpus, false, false);
+		bms_free(preferred_gpus);
+	}
+	else
+		gjs->gts.gcontext = AllocGpuContext(gj_info->optimal_gpus, false, false);
 
 	/*
 	 * Re-initialization of scan tuple-descriptor and projection-info,
@@ -3247,6 +3759,9 @@ ExecInitGpuJoin(CustomScanState *node, EState *estate, int eflags)
 	gjs->gts.cb_switch_task		= gpujoin_switch_task;
 	gjs->gts.cb_process_task	= gpujoin_process_task;
 	gjs->gts.cb_release_task	= gpujoin_release_task;
+	gjs->gts.cb_speculative_task = gpujoin_speculative_task;
+	gjs->gts.cb_bulk_exec		= gpujoin_bulk_exec;
+	gjs->gts.cb_begin_exec		= gpujoin_begin_exec;
 
 	/* DSM & GPU memory of inner buffer */
 	gjs->h_kmrels = NULL;
@@ -3256,6 +3771,11 @@ ExecInitGpuJoin(CustomScanState *node, EState *estate, int eflags)
 	gjs->preload_memcxt = AllocSetContextCreate(estate->es_query_cxt,
 												"Inner GPU Buffer Preloading",
 												ALLOCSET_DEFAULT_SIZES);
+	gjs->partition_memcxt = AllocSetContextCreate(estate->es_query_cxt,
+												"Inner GPU Buffer Partitions",
+												ALLOCSET_DEFAULT_SIZES);
+	gjs->inner_part_depth = 0;
+	gjs->inner_curr_part = 0;
 	if (gj_info->sibling_param_id >= 0)
 	{
 		ParamExecData  *param
@@ -3311,6 +3831,8 @@ ExecInitGpuJoin(CustomScanState *node, EState *estate, int eflags)
 
 		outerPlanState(gjs) = ExecInitNode(outerPlan(cscan), estate, eflags);
 		outer_desc = planStateResultTupleDesc(outerPlanState(gjs));
+		gjs->gts.outer_handoff =
+			GpuJoinSetupDeviceHandoff(&gjs->gts, outerPlanState(gjs));
 		nattrs = outer_desc->natts;
 		Assert(!OidIsValid(gj_info->index_oid));
 	}
@@ -3430,7 +3952,23 @@ ExecInitGpuJoin(CustomScanState *node, EState *estate, int eflags)
 		istate->depth = i + 1;
 		istate->nrows_ratio = i_info->plan_nrows_out / Max(i_info->plan_nrows_in, 1.0);
 		istate->ichunk_size = i_info->ichunk_size;
+		istate->join_signature = i_info->join_signature;
+		istate->inner_signature = i_info->inner_signature;
 		istate->join_type = i_info->join_type;
+		istate->inner_nparts = i_info->inner_nparts;
+		istate->hash_bucketed = i_info->hash_bucketed;
+		if (istate->inner_nparts > 1)
+		{
+			Assert(istate->join_type == JOIN_INNER &&
+				   i_info->hash_inner_keys != NIL);
+			istate->part_tuples = palloc0(sizeof(slist_head) *
+										  istate->inner_nparts);
+			istate->part_nitems = palloc0(sizeof(size_t) *
+										  istate->inner_nparts);
+			istate->part_usage  = palloc0(sizeof(size_t) *
+										  istate->inner_nparts);
+			gjs->inner_part_depth = istate->depth;
+		}
 
 		/*
 		 * NOTE: We need to deal with Var-node references carefully,
@@ -3476,6 +4014,29 @@ ExecInitGpuJoin(CustomScanState *node, EState *estate, int eflags)
 					lappend(istate->hash_inner_keys, i_expr_state);
 				istate->hash_outer_keys =
 					lappend(istate->hash_outer_keys, o_expr_state);
+				/*
+				 * Range of the inner keys at depth=1 shall be pushed down
+				 * to the outer Arrow_Fdw scan. Only INNER, RIGHT OUTER and
+				 * SEMI JOIN allow to skip outer tuples that never match.
+				 */
+				if (istate->depth == 1 &&
+					gjs->gts.af_state != NULL &&
+					(istate->join_type == JOIN_INNER ||
+					 istate->join_type == JOIN_RIGHT ||
+					 istate->join_type == JOIN_SEMI) &&
+					!gj_info->inner_parallel &&
+					gj_info->sibling_param_id < 0)
+				{
+					gpujoinRuntimeFilter *rfilter
+						= gpujoinInitRuntimeFilter(gjs, gj_info,
+												   i_expr, o_expr);
+					if (rfilter)
+					{
+						rfilter->i_key_state = i_expr_state;
+						istate->rfilter_list = lappend(istate->rfilter_list,
+													   rfilter);
+					}
+				}
 			}
 		}
 
@@ -3548,6 +4109,8 @@ ExecInitGpuJoin(CustomScanState *node, EState *estate, int eflags)
 		gjs->gts.css.custom_ps = lappend(gjs->gts.css.custom_ps,
 										 istate->state);
 	}
+	/* inner buffer cache, if available */
+	gpujoinInnerCacheInit(gjs, gj_info, cscan);
 	/* Pseudo GpuJoin stack */
 	sz = offsetof(gpujoinPseudoStack,
 				  ps_offset[gjs->num_rels+1]);
@@ -3602,6 +4165,16 @@ ExecReCheckGpuJoin(CustomScanState *node, TupleTableSlot *slot)
 	return true;
 }
 
+/*
+ * gpujoin_begin_exec
+ */
+static bool
+gpujoin_begin_exec(GpuTaskState *gts)
+{
+	ActivateGpuContext(gts->gcontext);
+	return GpuJoinInnerPreload(gts, NULL);
+}
+
 /*
  * ExecGpuJoin
  */
@@ -3610,14 +4183,62 @@ ExecGpuJoin(CustomScanState *node)
 {
 	GpuJoinState *gjs = (GpuJoinState *) node;
 
-	ActivateGpuContext(gjs->gts.gcontext);
-	if (!GpuJoinInnerPreload(&gjs->gts, NULL))
+	if (!gpujoin_begin_exec(&gjs->gts))
 		return NULL;
 	return ExecScan(&node->ss,
 					(ExecScanAccessMtd) pgstromExecGpuTaskState,
 					(ExecScanRecheckMtd) ExecReCheckGpuJoin);
 }
 
+/*
+ * gpujoinUpdateCardinalityFeedback
+ *
+ * It records the number of rows actually processed by each depth, and
+ * the number of inner rows, for the planning of the repeated query shapes.
+ * Parallel workers have already merged their statistics by ExecShutdown.
+ */
+static void
+gpujoinUpdateCardinalityFeedback(GpuJoinState *gjs)
+{
+	GpuJoinRuntimeStat *gj_rtstat;
+	double		nrows_in;
+	double		nrows_out;
+	int			depth;
+
+	if (!gjs->gj_sstate)
+		return;
+	gj_rtstat = GPUJOIN_RUNTIME_STAT(gjs->gj_sstate);
+	/* not executed, like EXPLAIN without ANALYZE */
+	if (pg_atomic_read_u64(&gj_rtstat->c.source_nitems) == 0)
+		return;
+
+	nrows_in = (double)pg_atomic_read_u64(&gj_rtstat->jstat[0].inner_nitems);
+	for (depth=1; depth <= gjs->num_rels; depth++)
+	{
+		innerState *istate = &gjs->inners[depth-1];
+		uint64		inner_nrooms;
+
+		nrows_out = (double)
+			(pg_atomic_read_u64(&gj_rtstat->jstat[depth].inner_nitems) +
+			 pg_atomic_read_u64(&gj_rtstat->jstat[depth].right_nitems));
+		if (nrows_in > 0.0)
+			pgstromUpdateCardinalityFeedback(istate->join_signature,
+											 nrows_in, nrows_out);
+		nrows_in = nrows_out;
+
+		/*
+		 * inner_nrooms is the largest partition if partitioned, and it is
+		 * not counted if the inner buffer is reused from the cache.
+		 */
+		inner_nrooms = pg_atomic_read_u64(&gj_rtstat->jstat[depth].inner_nrooms);
+		if (inner_nrooms > 0 &&
+			istate->inner_nparts <= 1 &&
+			!gjs->inner_reloaded)
+			pgstromUpdateCardinalityFeedback(istate->inner_signature,
+											 0.0, (double)inner_nrooms);
+	}
+}
+
 static void
 ExecEndGpuJoin(CustomScanState *node)
 {
@@ -3640,6 +4261,9 @@ ExecEndGpuJoin(CustomScanState *node)
 	}
 	/* then other private resources */
 	GpuJoinInnerUnload(&gjs->gts, false);
+	/* save the number of rows actually processed */
+	if (!IsParallelWorker())
+		gpujoinUpdateCardinalityFeedback(gjs);
 	/* shutdown the common portion */
 	pgstromReleaseGpuTaskState(&gjs->gts, NULL);
 }
@@ -3674,6 +4298,14 @@ ExecReScanGpuJoin(CustomScanState *node)
 		}
 		/* rewind the inner hash/heap buffer */
 		GpuJoinInnerUnload(&gjs->gts, true);
+		gjs->inner_reloaded = true;
+	}
+	else if (gjs->inner_part_depth > 0 &&
+			 gjs->inner_curr_part != 0 &&
+			 gjs->m_kmrels != 0UL)
+	{
+		/* rewind the partitioned inner hash table */
+		gpujoinLoadInnerPartition(gjs, 0);
 	}
 	/* common rescan handling */
 	pgstromRescanGpuTaskState(&gjs->gts);
@@ -3766,6 +4398,9 @@ ExplainGpuJoin(CustomScanState *node, List *ancestors, ExplainState *es)
 		Expr	   *gist_index_clause = i_info->gist_index_clause;
 		kern_data_store *kds_in = NULL;
 		kern_data_store *kds_gist = NULL;
+		size_t		bloom_sz = 0;
+		size_t		hbucket_sz = 0;
+		cl_uint		hskew_nkeys = 0;
 		int			indent_width;
 		double		exec_nrows_in = 0.0;
 		double		exec_nrows_out1 = 0.0;	/* by INNER JOIN */
@@ -3776,6 +4411,11 @@ ExplainGpuJoin(CustomScanState *node, List *ancestors, ExplainState *es)
 		{
 			kds_in = KERN_MULTIRELS_INNER_KDS(gjs->h_kmrels, depth);
 			kds_gist = KERN_MULTIRELS_GIST_INDEX(gjs->h_kmrels, depth);
+			bloom_sz = (GPUJOIN_BLOOM_BLOCK_SIZE *
+						gjs->h_kmrels->chunks[depth-1].bloom_nblocks);
+			hbucket_sz = (sizeof(kern_hashbucket) *
+						  gjs->h_kmrels->chunks[depth-1].hbucket_nbuckets);
+			hskew_nkeys = gjs->h_kmrels->chunks[depth-1].hskew_nkeys;
 		}
 
 		/* fetch number of rows */
@@ -3797,21 +4437,27 @@ ExplainGpuJoin(CustomScanState *node, List *ancestors, ExplainState *es)
 			appendStringInfo(&str, "GpuHash%sJoin",
 							 join_type == JOIN_FULL ? "Full" :
 							 join_type == JOIN_LEFT ? "Left" :
-							 join_type == JOIN_RIGHT ? "Right" : "");
+							 join_type == JOIN_RIGHT ? "Right" :
+							 join_type == JOIN_SEMI ? "Semi" :
+							 join_type == JOIN_ANTI ? "Anti" : "");
 		}
 		else if (i_info->gist_index_clause != NULL)
 		{
 			appendStringInfo(&str, "GpuGiST%sJoin",
 							 join_type == JOIN_FULL ? "Full" :
 							 join_type == JOIN_LEFT ? "Left" :
-							 join_type == JOIN_RIGHT ? "Right" : "");
+							 join_type == JOIN_RIGHT ? "Right" :
+							 join_type == JOIN_SEMI ? "Semi" :
+							 join_type == JOIN_ANTI ? "Anti" : "");
 		}
 		else
 		{
 			appendStringInfo(&str, "GpuNestLoop%s",
 							 join_type == JOIN_FULL ? "Full" :
 							 join_type == JOIN_LEFT ? "Left" :
-							 join_type == JOIN_RIGHT ? "Right" : "");
+							 join_type == JOIN_RIGHT ? "Right" :
+							 join_type == JOIN_SEMI ? "Semi" :
+							 join_type == JOIN_ANTI ? "Anti" : "");
 		}
 		snprintf(qlabel, sizeof(qlabel), "Depth%2d", depth);
 		indent_width = es->indent * 2 + strlen(qlabel) + 2;
@@ -3863,6 +4509,26 @@ ExplainGpuJoin(CustomScanState *node, List *ancestors, ExplainState *es)
 					appendStringInfo(es->str, ", IndexSize: %s",
 									 format_bytesz(kds_gist->length));
 				}
+				if (bloom_sz > 0)
+				{
+					appendStringInfo(es->str, ", BloomFilter: %s",
+									 format_bytesz(bloom_sz));
+				}
+				if (hbucket_sz > 0)
+				{
+					appendStringInfo(es->str, ", HashBuckets: %s",
+									 format_bytesz(hbucket_sz));
+				}
+				if (hskew_nkeys > 0)
+				{
+					appendStringInfo(es->str, ", HeavyHitters: %u",
+									 hskew_nkeys);
+				}
+				if (istate->inner_nparts > 1)
+				{
+					appendStringInfo(es->str, ", Partitions: %d",
+									 istate->inner_nparts);
+				}
 				appendStringInfoChar(es->str, '\n');
 			}
 		}
@@ -3913,6 +4579,31 @@ ExplainGpuJoin(CustomScanState *node, List *ancestors, ExplainState *es)
 							 "Depth% 2d Index Size", depth);
 					ExplainPropertyInteger(qlabel, NULL, kds_gist->length, es);
 				}
+				if (bloom_sz > 0)
+				{
+					snprintf(qlabel, sizeof(qlabel),
+							 "Depth% 2d Bloom Filter Size", depth);
+					ExplainPropertyInteger(qlabel, NULL, bloom_sz, es);
+				}
+				if (hbucket_sz > 0)
+				{
+					snprintf(qlabel, sizeof(qlabel),
+							 "Depth% 2d Hash Buckets Size", depth);
+					ExplainPropertyInteger(qlabel, NULL, hbucket_sz, es);
+				}
+				if (hskew_nkeys > 0)
+				{
+					snprintf(qlabel, sizeof(qlabel),
+							 "Depth% 2d Heavy Hitter Keys", depth);
+					ExplainPropertyInteger(qlabel, NULL, hskew_nkeys, es);
+				}
+				if (istate->inner_nparts > 1)
+				{
+					snprintf(qlabel, sizeof(qlabel),
+							 "Depth% 2d Inner Partitions", depth);
+					ExplainPropertyInteger(qlabel, NULL,
+										   istate->inner_nparts, es);
+				}
 			}
 		}
 
@@ -4016,6 +4707,21 @@ ExplainGpuJoin(CustomScanState *node, List *ancestors, ExplainState *es)
 		}
 		depth++;
 	}
+	/* number of kernel suspend/resume by overflow of the result buffer */
+	if (es->analyze && gj_rtstat && !pgstrom_regression_test_mode)
+	{
+		ExplainPropertyInteger("Kernel Suspends", NULL,
+							   pg_atomic_read_u64(&gj_rtstat->suspend_count),
+							   es);
+	}
+	/* inner buffer cache, if any */
+	if (es->analyze && gjs->gj_sstate &&
+		gjs->gj_sstate->inner_cache_index >= 0)
+	{
+		ExplainPropertyText("Inner Buffer Cache",
+							gjs->gj_sstate->inner_cache_hit
+							? "hit" : "stored", es);
+	}
 	/* other common field */
 	pgstromExplainGpuTaskState(&gjs->gts, es, dcontext);
 }
@@ -4060,13 +4766,7 @@ ExecGpuJoinInitDSM(CustomScanState *node,
 				  PointerGetDatum(gjs->gts.gcontext));
 	/* allocation of an empty multirel buffer */
 	coordinate = (char *)coordinate + len;
-	if (gjs->gts.outer_index_state)
-	{
-		gjs->gts.outer_index_map = (Bitmapset *)coordinate;
-		gjs->gts.outer_index_map->nwords = -1;		/* uninitialized */
-		coordinate = ((char *)coordinate +
-					  pgstromSizeOfBrinIndexMap(&gjs->gts));
-	}
+	coordinate = pgstromInitDSMBrinIndexMap(&gjs->gts, coordinate);
 	pgstromInitDSMGpuTaskState(&gjs->gts, pcxt, coordinate);
 }
 
@@ -4087,12 +4787,7 @@ ExecGpuJoinInitWorker(CustomScanState *node,
 				  SynchronizeGpuContextOnDSMDetach,
 				  PointerGetDatum(gjs->gts.gcontext));
 	coordinate = (char *)coordinate + gj_sstate->ss_length;
-	if (gjs->gts.outer_index_state)
-	{
-		gjs->gts.outer_index_map = (Bitmapset *)coordinate;
-		coordinate = ((char *)coordinate +
-					  pgstromSizeOfBrinIndexMap(&gjs->gts));
-	}
+	coordinate = pgstromInitWorkerBrinIndexMap(&gjs->gts, coordinate);
 	pgstromInitWorkerGpuTaskState(&gjs->gts, coordinate);
 }
 
@@ -4151,6 +4846,7 @@ ExecShutdownGpuJoin(CustomScanState *node)
 		 * state shall be copied to local memory for each!
 		 */
 		gj_sstate_old->shmem_handle = UINT_MAX;
+		gj_sstate_old->inner_cache_index = -1;
 		for (i=0; i < numDevAttrs; i++)
 		{
 			gj_sstate_old->pergpu[i].bytesize = 0;
@@ -4558,7 +5254,7 @@ gpujoin_codegen_hash_value(StringInfo source,
 	ListCell	   *lc;
 	StringInfoData	decl;
 	StringInfoData	body;
-
+	bool			hash_bucketed = enable_gpuhashjoin_open_addressing;
 
 	Assert(hash_outer_keys != NIL);
 	initStringInfo(&decl);
@@ -4592,7 +5288,11 @@ gpujoin_codegen_hash_value(StringInfo source,
 			dtype->type_name);
 		type_oid_list = list_append_unique_oid(type_oid_list,
 											   dtype->type_oid);
+		/* open-addressing hash-buckets, only if fixed-length keys */
+		if (dtype->type_length <= 0)
+			hash_bucketed = false;
 	}
+	i_info->hash_bucketed = hash_bucketed;
 
 	/*
 	 * variable/params declaration & initialization
@@ -5422,7 +6122,8 @@ gpujoin_codegen(PlannerInfo *root,
 						  &context,
 						  "gpujoin",
 						  cscan->scan.scanrelid,
-						  gj_info->outer_quals);
+						  gj_info->outer_quals,
+						  false);
 	extra_bufsz = context.extra_bufsz;
 
 	/*
@@ -5687,6 +6388,41 @@ GpuJoinSetupTask(struct kern_gpujoin *kgjoin, GpuTaskState *gts,
 	return (pos - (char *)kgjoin);
 }
 
+/*
+ * gpujoinEstimateResultLength
+ *
+ * It estimates length of the destination buffer for a task by the outer
+ * chunk, according to the results of the tasks already completed.
+ * If the destination buffer is too small, GPU kernel shall be suspended and
+ * resumed with a new buffer for each overflow; that costs another kernel
+ * launch and DMA round trip. On the other hands, the buffer length is
+ * rounded up to power of 2 times pgstrom_chunk_size(), because gpu_mmgr.c
+ * caches the recently released buffer of identical length.
+ */
+static size_t
+gpujoinEstimateResultLength(GpuJoinState *gjs, TupleDesc tupdesc)
+{
+	GpuJoinRuntimeStat *gj_rtstat = GPUJOIN_RUNTIME_STAT(gjs->gj_sstate);
+	uint64		ntasks = pg_atomic_read_u64(&gj_rtstat->result_ntasks);
+	uint64		nitems = pg_atomic_read_u64(&gj_rtstat->result_nitems);
+	uint64		usage  = pg_atomic_read_u64(&gj_rtstat->result_usage);
+	size_t		chunk_sz = pgstrom_chunk_size();
+	size_t		length;
+	size_t		required;
+
+	if (ntasks == 0)
+		return chunk_sz;
+	/* average result length per task, with 25% margin */
+	required = (KDS_calculateHeadSize(tupdesc) +
+				STROMALIGN(sizeof(cl_uint) * (nitems / ntasks)) +
+				STROMALIGN(usage / ntasks));
+	required += required / 4;
+	for (length = chunk_sz;
+		 length < required && length < GPUJOIN_RESULT_MAX_LENGTH;
+		 length *= 2);
+	return length;
+}
+
 /*
  * gpujoin_create_task
  */
@@ -5700,6 +6436,7 @@ gpujoin_create_task(GpuJoinState *gjs,
 	GpuContext	   *gcontext = gjs->gts.gcontext;
 	GpuJoinTask	   *pgjoin;
 	Size			required;
+	Size			dst_length = pgstrom_chunk_size();
 	CUdeviceptr		m_deviceptr;
 	CUresult		rc;
 
@@ -5718,9 +6455,11 @@ gpujoin_create_task(GpuJoinState *gjs,
 	memset(pgjoin, 0, offsetof(GpuJoinTask, kern));
 	pgstromInitGpuTask(&gjs->gts, &pgjoin->task);
 	pgjoin->pds_src = pds_src;
+	if (pds_src)
+		dst_length = gpujoinEstimateResultLength(gjs, scan_tupdesc);
 	pgjoin->pds_dst = PDS_create_row(gcontext,
 									 scan_tupdesc,
-									 pgstrom_chunk_size());
+									 dst_length);
 	pgjoin->outer_depth = outer_depth;
 
 	/* Is NVMe-Strom available to run this GpuJoin? */
@@ -5758,6 +6497,21 @@ GpuJoinExecOuterScanChunk(GpuTaskState *gts)
 	{
 		PlanState	   *outer_node = outerPlanState(gjs);
 		TupleTableSlot *slot;
+		bool			scan_done;
+
+		/* results of the outer GpuJoin on the device, if any */
+		if (gjs->gts.outer_handoff && !gjs->gts.scan_overflow)
+		{
+			pds = GpuJoinExecBulkChunk((GpuTaskState *) outer_node,
+									   &scan_done);
+			if (pds)
+				return pds;
+			if (scan_done)
+			{
+				gjs->gts.scan_overflow = (void *)(~0UL);
+				return NULL;
+			}
+		}
 
 		for (;;)
 		{
@@ -5799,6 +6553,75 @@ GpuJoinExecOuterScanChunk(GpuTaskState *gts)
 	return pds;
 }
 
+/*
+ * GpuJoinSetupDeviceHandoff
+ *
+ * It checks whether the parent GPU node (@gts) can take the result data
+ * store of the outer GpuJoin as its source as is; no projection and no
+ * host quals on the outer GpuJoin, and both runs on the same GpuContext.
+ * If OK, the outer GpuJoin keeps the results on the device.
+ */
+bool
+GpuJoinSetupDeviceHandoff(GpuTaskState *gts, PlanState *outer_ps)
+{
+	GpuTaskState   *outer_gts = (GpuTaskState *) outer_ps;
+
+	if (!pgstrom_bulkexec_enabled ||
+		!pgstrom_planstate_is_gpujoin(outer_ps) ||
+		outer_ps->ps_ProjInfo != NULL ||
+		outer_ps->qual != NULL ||
+		outer_gts->gcontext != gts->gcontext)
+		return false;
+	outer_gts->device_handoff = true;
+	/* CPU processing of the chunks makes no sense here */
+	outer_gts->adaptive_mode = GTS_ADAPTIVE__DISABLED;
+	return true;
+}
+
+/*
+ * GpuJoinExecBulkChunk
+ *
+ * It returns the result data store of the GpuJoin, for the parent GPU node
+ * set up by GpuJoinSetupDeviceHandoff. NULL means the rows must be fetched
+ * one by one (CPU fallback), unless @p_scan_done is set.
+ */
+pgstrom_data_store *
+GpuJoinExecBulkChunk(GpuTaskState *gts, bool *p_scan_done)
+{
+	PlanState	   *ps = &gts->css.ss.ps;
+	pgstrom_data_store *pds;
+
+	if (ps->instrument)
+		InstrStartNode(ps->instrument);
+	if (!gpujoin_begin_exec(gts))
+	{
+		*p_scan_done = true;
+		pds = NULL;
+	}
+	else
+		pds = pgstromBulkExecGpuTaskState(gts, p_scan_done);
+	if (ps->instrument)
+		InstrStopNode(ps->instrument, pds ? (double) pds->kds.nitems : 0.0);
+	return pds;
+}
+
+/*
+ * gpujoin_bulk_exec
+ */
+static pgstrom_data_store *
+gpujoin_bulk_exec(GpuTaskState *gts, GpuTask *gtask)
+{
+	GpuJoinTask	   *pgjoin = (GpuJoinTask *) gtask;
+	pgstrom_data_store *pds_dst = pgjoin->pds_dst;
+
+	if (!pds_dst || pds_dst->kds.format != KDS_FORMAT_ROW)
+		return NULL;
+	/* hand over the ownership of the results */
+	pgjoin->pds_dst = NULL;
+	pds_dst->device_resident = true;
+	return pds_dst;
+}
+
 /*
  * gpujoin_switch_task
  */
@@ -5807,6 +6630,21 @@ gpujoin_switch_task(GpuTaskState *gts, GpuTask *gtask)
 {
 }
 
+/*
+ * gpujoin_next_task_chunk
+ */
+static pgstrom_data_store *
+gpujoin_next_task_chunk(GpuJoinState *gjs)
+{
+	GpuTaskState   *gts = &gjs->gts;
+
+	if (gts->af_state)
+		return ExecScanChunkArrowFdw(gts);
+	if (gts->gc_state)
+		return ExecScanChunkGpuCache(gts);
+	return GpuJoinExecOuterScanChunk(gts);
+}
+
 /*
  * gpujoin_next_task
  */
@@ -5817,12 +6655,7 @@ gpujoin_next_task(GpuTaskState *gts)
 	GpuTask		   *gtask = NULL;
 	pgstrom_data_store *pds;
 
-	if (gjs->gts.af_state)
-		pds = ExecScanChunkArrowFdw(gts);
-	else if (gjs->gts.gc_state)
-		pds = ExecScanChunkGpuCache(gts);
-	else
-		pds = GpuJoinExecOuterScanChunk(gts);
+	pds = gpujoin_next_task_chunk(gjs);
 	if (pds)
 		gtask = gpujoin_create_task(gjs, pds, -1);
 	else
@@ -5832,18 +6665,53 @@ gpujoin_next_task(GpuTaskState *gts)
 }
 
 /*
- * gpujoinNextRightOuterJoinIfAny
+ * gpujoin_speculative_task
+ *
+ * It marks the GpuJoinTask to be processed by CPU, using the CPU fallback
+ * code with the inner buffer on the host memory. Only the chunks whose
+ * contents are already loaded on the host memory can run on CPU. RIGHT/FULL
+ * OUTER JOIN and partitioned inner hash are not supported, because they
+ * need co-operation with the GPU kernels for the other chunks.
  */
-int
-gpujoinNextRightOuterJoinIfAny(GpuTaskState *gts)
+static bool
+gpujoin_speculative_task(GpuTaskState *gts, GpuTask *gtask)
 {
-	GpuJoinState   *gjs = (GpuJoinState *)gts;
-	GpuJoinSharedState *gj_sstate = gjs->gj_sstate;
-	GpuContext	   *gcontext = gjs->gts.gcontext;
-	kern_multirels *h_kmrels = gjs->h_kmrels;
-	int				i, dindex = gcontext->cuda_dindex;
-	int				depth = -1;
-	uint32			needs_colocation;
+	GpuJoinState   *gjs = (GpuJoinState *) gts;
+	GpuJoinTask	   *pgjoin = (GpuJoinTask *) gtask;
+	pgstrom_data_store *pds_src = pgjoin->pds_src;
+	int				i;
+
+	if (!pds_src || pgjoin->outer_depth > 0 ||
+		!gjs->h_kmrels || gjs->h_kmrels->ojmaps_length > 0)
+		return false;
+	for (i=0; i < gjs->num_rels; i++)
+	{
+		if (gjs->inners[i].inner_nparts > 1)
+			return false;
+	}
+	if (pds_src->kds.format == KDS_FORMAT_ROW ||
+		(pds_src->kds.format == KDS_FORMAT_BLOCK &&
+		 pds_src->nblocks_uncached == 0))
+	{
+		pgjoin->task.cpu_fallback = true;
+		return true;
+	}
+	return false;
+}
+
+/*
+ * gpujoinNextRightOuterJoinIfAny
+ */
+int
+gpujoinNextRightOuterJoinIfAny(GpuTaskState *gts)
+{
+	GpuJoinState   *gjs = (GpuJoinState *)gts;
+	GpuJoinSharedState *gj_sstate = gjs->gj_sstate;
+	GpuContext	   *gcontext = gjs->gts.gcontext;
+	kern_multirels *h_kmrels = gjs->h_kmrels;
+	int				i, dindex = gcontext->cuda_dindex;
+	int				depth = -1;
+	uint32			needs_colocation;
 
 	if (gjs->sibling)
 	{
@@ -5947,6 +6815,138 @@ out_unlock:
 	return depth;
 }
 
+/*
+ * gpujoinLoadInnerPartition
+ *
+ * It replaces the partitioned inner hash table by the tuples of the
+ * supplied partition, on both of the host and device buffer. Caller must
+ * ensure no GpuTasks are in-progress.
+ */
+static void
+gpujoinLoadInnerPartition(GpuJoinState *gjs, int part)
+{
+	GpuContext	   *gcontext = gjs->gts.gcontext;
+	kern_multirels *h_kmrels = gjs->h_kmrels;
+	int				depth = gjs->inner_part_depth;
+	innerState	   *istate = &gjs->inners[depth - 1];
+	kern_data_store *kds;
+	cl_uint		   *bloom;
+	kern_hashbucket *hbuckets;
+	CUresult		rc;
+
+	Assert(h_kmrels != NULL && gjs->m_kmrels != 0UL && !gjs->sibling);
+	kds = KERN_MULTIRELS_INNER_KDS(h_kmrels, depth);
+	if (kds->format != KDS_FORMAT_HASH)
+		elog(ERROR, "GpuJoin: partitioned inner buffer must be KDS_FORMAT_HASH");
+
+	/* rewind the inner hash table, then setup by the new partition */
+	memset(KERN_DATA_STORE_HASHSLOT(kds), 0, sizeof(cl_uint) * kds->nslots);
+	innerPreloadSelectPartition(istate, part);
+	kds->nitems = istate->preload_nitems;
+	kds->usage  = __kds_packed(istate->preload_usage);
+	__innerPreloadSetupHashBuffer(kds, istate, 0, 0);
+	bloom = KERN_MULTIRELS_BLOOM_FILTER(h_kmrels, depth);
+	if (bloom)
+	{
+		memset(bloom, 0, GPUJOIN_BLOOM_BLOCK_SIZE *
+			   h_kmrels->chunks[depth-1].bloom_nblocks);
+		__innerPreloadSetupBloomFilter(h_kmrels, istate);
+	}
+	hbuckets = KERN_MULTIRELS_HASH_BUCKETS(h_kmrels, depth);
+	if (hbuckets)
+	{
+		memset(hbuckets, 0, sizeof(kern_hashbucket) *
+			   h_kmrels->chunks[depth-1].hbucket_nbuckets);
+		__innerPreloadSetupHashBuckets(h_kmrels, kds, depth,
+									   0, istate->preload_nitems);
+	}
+	istate->preload_nitems = 0;
+	istate->preload_usage = 0;
+	slist_init(&istate->preload_tuples);
+
+	/* send the partition to the device buffer */
+	GPUCONTEXT_PUSH(gcontext);
+	rc = cuMemcpyHtoD(gjs->m_kmrels + h_kmrels->chunks[depth-1].chunk_offset,
+					  kds, kds->length);
+	if (rc != CUDA_SUCCESS)
+		elog(ERROR, "failed on cuMemcpyHtoD: %s", errorText(rc));
+	if (bloom)
+	{
+		rc = cuMemcpyHtoD(gjs->m_kmrels + h_kmrels->chunks[depth-1].bloom_offset,
+						  bloom, GPUJOIN_BLOOM_BLOCK_SIZE *
+						  h_kmrels->chunks[depth-1].bloom_nblocks);
+		if (rc != CUDA_SUCCESS)
+			elog(ERROR, "failed on cuMemcpyHtoD: %s", errorText(rc));
+	}
+	if (hbuckets)
+	{
+		rc = cuMemcpyHtoD(gjs->m_kmrels + h_kmrels->chunks[depth-1].hbucket_offset,
+						  hbuckets, sizeof(kern_hashbucket) *
+						  h_kmrels->chunks[depth-1].hbucket_nbuckets);
+		if (rc != CUDA_SUCCESS)
+			elog(ERROR, "failed on cuMemcpyHtoD: %s", errorText(rc));
+	}
+	GPUCONTEXT_POP(gcontext);
+
+	gjs->inner_curr_part = part;
+}
+
+/*
+ * gpujoinNextInnerPartitionIfAny
+ *
+ * Partitioned GpuHashJoin scans the outer relation again for each inner
+ * partition. Once the outer scan of the current partition is completed,
+ * it switches the inner hash table to the next partition, then returns
+ * the first GpuTask of the new outer scan.
+ */
+static GpuTask *
+gpujoinNextInnerPartitionIfAny(GpuJoinState *gjs)
+{
+	GpuContext	   *gcontext = gjs->gts.gcontext;
+	innerState	   *istate = &gjs->inners[gjs->inner_part_depth - 1];
+	pgstrom_data_store *pds;
+	int				part;
+
+	/* no device buffer means no outer tuples at all */
+	if (gjs->m_kmrels == 0UL)
+		return NULL;
+
+	for (part = gjs->inner_curr_part + 1; part < istate->inner_nparts; part++)
+	{
+		/* empty partition never produces any join results */
+		if (istate->part_nitems[part] == 0)
+			continue;
+
+		gpujoinLoadInnerPartition(gjs, part);
+
+		/* rewind the outer scan */
+		if (outerPlanState(gjs))
+			ExecReScan(outerPlanState(gjs));
+		gjs->gts.scan_overflow = NULL;
+		pgstromRewindScanChunk(&gjs->gts);
+		if (gjs->gts.af_state)
+			ExecReScanArrowFdw(gjs->gts.af_state);
+		if (gjs->gts.gc_state)
+			ExecReScanGpuCache(gjs->gts.gc_state);
+		pg_atomic_write_u32(&gjs->gj_sstate->outer_scan_done, 0);
+
+		pds = gpujoin_next_task_chunk(gjs);
+		if (!pds)
+			break;		/* empty outer relation */
+
+		/* resume the asynchronous outer scan */
+		pthreadMutexLock(&gcontext->worker_mutex);
+		gjs->gts.scan_done = false;
+		pthreadMutexUnlock(&gcontext->worker_mutex);
+
+		return gpujoin_create_task(gjs, pds, -1);
+	}
+	gjs->inner_curr_part = istate->inner_nparts - 1;
+	pg_atomic_write_u32(&gjs->gj_sstate->outer_scan_done, 1);
+
+	return NULL;
+}
+
 /*
  * gpujoin_terminator_task
  */
@@ -5956,6 +6956,14 @@ gpujoin_terminator_task(GpuTaskState *gts, cl_bool *task_is_ready)
 	GpuJoinState   *gjs = (GpuJoinState *) gts;
 	GpuTask		   *gtask = NULL;
 	cl_int			outer_depth;
+
+	/* Has any inner partitions not processed yet? */
+	if (gjs->inner_part_depth > 0)
+	{
+		gtask = gpujoinNextInnerPartitionIfAny(gjs);
+		if (gtask)
+			return gtask;
+	}
 	
 	/* Has RIGHT/FULL OUTER JOIN? */
 	outer_depth = gpujoinNextRightOuterJoinIfAny(&gjs->gts);
@@ -6171,6 +7179,39 @@ gpujoinFallbackHashJoin(int depth, GpuJoinState *gjs)
 	cl_uint			hash;
 	bool			retval;
 
+	/* SEMI/ANTI JOIN don't walk on the hash-chain after the first match */
+	if (istate->fallback_inner_matched &&
+		(istate->join_type == JOIN_SEMI ||
+		 istate->join_type == JOIN_ANTI))
+		goto end;
+
+	/* resume the cooperative probe on the heavy-hitter key, if any */
+	if (istate->fallback_skew_end > 0)
+	{
+		cl_uint	   *row_index = KERN_DATA_STORE_ROWINDEX(kds_in);
+
+		do {
+			if (istate->fallback_skew_next >= istate->fallback_skew_end)
+			{
+				istate->fallback_skew_end = 0;
+				goto end;
+			}
+			khitem = (kern_hashitem *)
+				((char *)kds_in
+				 + __kds_unpack(row_index[istate->fallback_skew_next++])
+				 - offsetof(kern_hashitem, t));
+			gpujoin_fallback_tuple_extract(gjs->slot_fallback,
+										   kds_in,
+										   &khitem->t.htup.t_ctid,
+										   &khitem->t.htup,
+										   istate->inner_dst_resno,
+										   istate->inner_src_anum_min,
+										   istate->inner_src_anum_max);
+			retval = ExecQual(istate->other_quals, econtext);
+		} while (!retval);
+		goto matched;
+	}
+
 	do {
 		if (istate->fallback_inner_index == 0)
 		{
@@ -6214,6 +7255,11 @@ gpujoinFallbackHashJoin(int depth, GpuJoinState *gjs)
 		retval = ExecQual(istate->other_quals, econtext);
 	} while (!retval);
 
+matched:
+	istate->fallback_inner_matched = true;
+	/* ANTI JOIN never generates the matched combination */
+	if (istate->join_type == JOIN_ANTI)
+		return depth-1;
 	/* update outer join map */
 	if (ojmaps)
 		ojmaps[khitem->t.rowid] = 1;
@@ -6229,7 +7275,8 @@ gpujoinFallbackHashJoin(int depth, GpuJoinState *gjs)
 end:
 	if (!istate->fallback_inner_matched &&
 		(istate->join_type == JOIN_LEFT ||
-		 istate->join_type == JOIN_FULL))
+		 istate->join_type == JOIN_FULL ||
+		 istate->join_type == JOIN_ANTI))
 	{
 		istate->fallback_inner_matched = true;
 		gpujoin_fallback_tuple_extract(gjs->slot_fallback,
@@ -6244,6 +7291,7 @@ end:
 			istate++;
 			istate->fallback_inner_index = 0;
 			istate->fallback_inner_matched = false;
+			istate->fallback_skew_end = 0;
 		}
 		return depth+1;
 	}
@@ -6264,6 +7312,12 @@ gpujoinFallbackNestLoop(int depth, GpuJoinState *gjs)
 	cl_bool		   *ojmaps = KERN_MULTIRELS_OUTER_JOIN_MAP(h_kmrels, depth);
 	cl_uint			index;
 
+	/* SEMI/ANTI JOIN don't scan the inner rows after the first match */
+	if (istate->fallback_inner_matched &&
+		(istate->join_type == JOIN_SEMI ||
+		 istate->join_type == JOIN_ANTI))
+		istate->fallback_inner_index = kds_in->nitems;
+
 	for (index = istate->fallback_inner_index;
 		 index < kds_in->nitems;
 		 index++)
@@ -6282,6 +7336,10 @@ gpujoinFallbackNestLoop(int depth, GpuJoinState *gjs)
 		if (retval)
 		{
 			istate->fallback_inner_index = index + 1;
+			istate->fallback_inner_matched = true;
+			/* ANTI JOIN never generates the matched combination */
+			if (istate->join_type == JOIN_ANTI)
+				return depth-1;
 			/* update outer join map */
 			if (ojmaps)
 				ojmaps[index] = 1;
@@ -6291,6 +7349,7 @@ gpujoinFallbackNestLoop(int depth, GpuJoinState *gjs)
 				istate++;
 				istate->fallback_inner_index = 0;
 				istate->fallback_inner_matched = false;
+				istate->fallback_skew_end = 0;
 			}
 			return depth+1;
 		}
@@ -6298,7 +7357,8 @@ gpujoinFallbackNestLoop(int depth, GpuJoinState *gjs)
 
 	if (!istate->fallback_inner_matched &&
 		(istate->join_type == JOIN_LEFT ||
-		 istate->join_type == JOIN_FULL))
+		 istate->join_type == JOIN_FULL ||
+		 istate->join_type == JOIN_ANTI))
 	{
 		istate->fallback_inner_index = kds_in->nitems;
 		istate->fallback_inner_matched = true;
@@ -6316,6 +7376,7 @@ gpujoinFallbackNestLoop(int depth, GpuJoinState *gjs)
 			istate++;
 			istate->fallback_inner_index = 0;
 			istate->fallback_inner_matched = false;
+			istate->fallback_skew_end = 0;
 		}
 		return depth+1;
 	}
@@ -6354,6 +7415,7 @@ gpujoinFallbackLoadOuter(int depth, GpuJoinState *gjs)
 				istate++;
 				istate->fallback_inner_index = 0;
 				istate->fallback_inner_matched = false;
+				istate->fallback_skew_end = 0;
 			}
 			return depth + 1;
 		}
@@ -6366,8 +7428,9 @@ gpujoinFallbackLoadSource(int depth, GpuJoinState *gjs,
 						  pgstrom_data_store *pds_src)
 {
 	kern_data_store *kds_src = &pds_src->kds;
+	EState		   *estate = gjs->gts.css.ss.ps.state;
 	ExprContext	   *econtext = gjs->gts.css.ss.ps.ps_ExprContext;
-	bool			retval;
+	bool			retval = false;
 
 	Assert(depth == 0);
 	do {
@@ -6413,6 +7476,9 @@ gpujoinFallbackLoadSource(int depth, GpuJoinState *gjs,
 			if (!ItemIdIsNormal(lpp))
 				continue;
 			htup = (HeapTupleHeader)PageGetItem(pg_page, lpp);
+			if (!PageIsAllVisible(pg_page) &&
+				!pgstromHeapTupleSatisfiesMVCC(htup, estate->es_snapshot))
+				continue;
 			t_self.ip_blkid.bi_hi = block_nr >> 16;
 			t_self.ip_blkid.bi_lo = block_nr & 0xffff;
 			t_self.ip_posid = line_nr + 1;
@@ -6433,6 +7499,7 @@ gpujoinFallbackLoadSource(int depth, GpuJoinState *gjs,
 
 	/* rewind the next depth */
 	gjs->inners[0].fallback_inner_index = 0;
+	gjs->inners[0].fallback_skew_end = 0;
 	return 1;
 }
 
@@ -6610,6 +7677,7 @@ lnext:
 				{
 					/* restart from the head */
 					gjs->inners[depth].fallback_inner_index = 0;
+					gjs->inners[depth].fallback_skew_end = 0;
 				}
 				else if (l_state == UINT_MAX)
 				{
@@ -6617,6 +7685,27 @@ lnext:
 					gjs->fallback_thread_count = (thread_index + 1) << 10;
 					goto lnext;
 				}
+				else if (KERN_MULTIRELS_HASH_SKEW(h_kmrels, depth+1) &&
+						 (l_state & GPUJOIN_HASH_SKEW_LSTATE) != 0)
+				{
+					/* in the cooperative probe on the heavy-hitter key */
+					kern_hashskew *hskew = KERN_MULTIRELS_HASH_SKEW(h_kmrels,
+																	depth+1);
+					cl_uint		nkeys = h_kmrels->chunks[depth].hskew_nkeys;
+					cl_uint		rowid = (l_state & ~GPUJOIN_HASH_SKEW_LSTATE);
+					cl_uint		k;
+
+					for (k=0; k < nkeys; k++)
+					{
+						if (rowid >= hskew[k].row_base &&
+							rowid <  hskew[k].row_base + hskew[k].nitems)
+							break;
+					}
+					if (k == nkeys)
+						elog(ERROR, "Bug? GpuHashJoin heavy-hitter key row-index %u not found", rowid);
+					istate->fallback_skew_next = rowid;
+					istate->fallback_skew_end = hskew[k].row_base + hskew[k].nitems;
+				}
 				else
 				{
 					kern_hashitem  *khitem = (kern_hashitem *)
@@ -6627,6 +7716,7 @@ lnext:
 						((char *)khitem - (char *)kds_in);
 					istate->fallback_inner_hash = khitem->hash;
 					istate->fallback_inner_matched = matched;
+					istate->fallback_skew_end = 0;
 				}
 			}
 			else if (kds_in->format == KDS_FORMAT_ROW)
@@ -6648,6 +7738,7 @@ lnext:
 			 * level, so we shall suspend join from the head.
 			 */
 			istate->fallback_inner_index = 0;
+			istate->fallback_skew_end = 0;
 		}
 	}
 	else
@@ -6696,7 +7787,10 @@ gpujoinNextTupleFallback(GpuTaskState *gts,
 		gjs->fallback_thread_count = 0;
 		gjs->fallback_outer_index = 0;
 		for (i=0; i < num_rels; i++)
+		{
 			gjs->inners[i].fallback_inner_index = 0;
+			gjs->inners[i].fallback_skew_end = 0;
+		}
 
 		/*
 		 * Once CPU fallback happen, RIGHT/FULL OUTER JOIN map must
@@ -6877,6 +7971,8 @@ gpujoinUpdateRunTimeStat(GpuTaskState *gts, kern_gpujoin *kgjoin)
 		pg_atomic_fetch_add_u64(&gj_rtstat->c.debug_counter2, kgjoin->debug_counter2);
 	if (kgjoin->debug_counter3 != 0)
 		pg_atomic_fetch_add_u64(&gj_rtstat->c.debug_counter3, kgjoin->debug_counter3);
+	/* per-stage cycle counters if any */
+	updateGpuTaskRuntimeStatProfile(&gj_rtstat->c, &kgjoin->profile);
 	
 	/* reset counters (may be reused by the resumed kernel) */
 	kgjoin->source_nitems = 0;
@@ -6888,6 +7984,30 @@ gpujoinUpdateRunTimeStat(GpuTaskState *gts, kern_gpujoin *kgjoin)
 	}
 }
 
+/*
+ * gpujoinUpdateResultStat
+ *
+ * It accumulates the result rows of the task by the outer chunk, to estimate
+ * length of the destination buffer for the following tasks.
+ */
+static void
+gpujoinUpdateResultStat(GpuJoinTask *pgjoin, bool is_completed)
+{
+	GpuJoinState	   *gjs = (GpuJoinState *) pgjoin->task.gts;
+	GpuJoinRuntimeStat *gj_rtstat = GPUJOIN_RUNTIME_STAT(gjs->gj_sstate);
+	kern_data_store	   *kds_dst = &pgjoin->pds_dst->kds;
+
+	if (!is_completed)
+		pg_atomic_fetch_add_u64(&gj_rtstat->suspend_count, 1);
+	if (!pgjoin->pds_src)
+		return;		/* RIGHT OUTER JOIN */
+	pg_atomic_fetch_add_u64(&gj_rtstat->result_nitems, kds_dst->nitems);
+	pg_atomic_fetch_add_u64(&gj_rtstat->result_usage,
+							__kds_unpack(kds_dst->usage));
+	if (is_completed)
+		pg_atomic_fetch_add_u64(&gj_rtstat->result_ntasks, 1);
+}
+
 /*
  * gpujoin_throw_partial_result
  */
@@ -6903,13 +8023,22 @@ gpujoin_throw_partial_result(GpuJoinTask *pgjoin)
 	size_t			head_sz;
 	CUresult		rc;
 
-	/* async prefetch kds_dst; which should be on the device memory */
-	rc = cuMemPrefetchAsync((CUdeviceptr) &pds_dst->kds,
-							pds_dst->kds.length,
-							CU_DEVICE_CPU,
-							CU_STREAM_PER_THREAD);
-	if (rc != CUDA_SUCCESS)
-		werror("failed on cuMemPrefetchAsync: %s", errorText(rc));
+	gpujoinUpdateResultStat(pgjoin, false);
+
+	/*
+	 * async prefetch kds_dst; which should be on the device memory,
+	 * unless the parent GPU node takes it on the device as is.
+	 */
+	if (!gts->device_handoff)
+	{
+		rc = cuMemPrefetchAsync((CUdeviceptr) &pds_dst->kds,
+								pds_dst->kds.length,
+								CU_DEVICE_CPU,
+								CU_STREAM_PER_THREAD);
+		if (rc != CUDA_SUCCESS)
+			werror("failed on cuMemPrefetchAsync: %s", errorText(rc));
+		gpuMemStatDma(0, pds_dst->kds.length);
+	}
 
 	/* setup responder task with supplied @kds_dst, however, it does
 	 * not need pstack/suspend buffer */
@@ -7074,7 +8203,7 @@ gpujoin_process_inner_join(GpuJoinTask *pgjoin, CUmodule cuda_module)
 							   CU_STREAM_PER_THREAD);
 		if (rc != CUDA_SUCCESS)
 			werror("failed on cuMemcpyHtoD: %s", errorText(rc));
-
+		gpuMemStatDma(pds_src->kds.length, 0);
 	}
 	else if (pds_src->kds.format != KDS_FORMAT_COLUMN)
 	{
@@ -7084,7 +8213,12 @@ gpujoin_process_inner_join(GpuJoinTask *pgjoin, CUmodule cuda_module)
 								CU_STREAM_PER_THREAD);
 		if (rc != CUDA_SUCCESS)
 			werror("failed on cuMemPrefetchAsync: %s", errorText(rc));
+		if (!pds_src->device_resident)
+			gpuMemStatDma(pds_src->kds.length, 0);
 	}
+	/* decompress kds_src on the device, if compressed */
+	PDS_decompress_arrow(cuda_module, m_kds_src, pds_src,
+						 m_kgjoin + offsetof(kern_gpujoin, kerror));
 
 	/* Launch:
 	 * KERNEL_FUNCTION(void)
@@ -7115,6 +8249,7 @@ resume_kernel:
 	kern_args[4] = &m_kds_dst;
 	kern_args[5] = &m_nullptr;
 
+	gpuTaskTimerRecord(&pgjoin->task, GPUTASK_TIMER__KERN_BEGIN);
 	rc = cuLaunchKernel(kern_gpujoin_main,
 						grid_sz, 1, 1,
 						block_sz, 1, 1,
@@ -7125,6 +8260,7 @@ resume_kernel:
 	if (rc != CUDA_SUCCESS)
 		werror("failed on cuLaunchKernel: %s", errorText(rc));
 
+	gpuTaskTimerRecord(&pgjoin->task, GPUTASK_TIMER__KERN_END);
 	rc = cuEventRecord(CU_EVENT_PER_THREAD, CU_STREAM_PER_THREAD);
 	if (rc != CUDA_SUCCESS)
 		werror("failed on cuEventRecord: %s", errorText(rc));
@@ -7156,6 +8292,7 @@ resume_kernel:
 			goto resume_kernel;
 		}
 		gpujoinUpdateRunTimeStat(&gjs->gts, &pgjoin->kern);
+		gpujoinUpdateResultStat(pgjoin, true);
 		/* return task if any result rows */
 		retval = (pds_dst->kds.nitems > 0 ? 0 : -1);
 	}
@@ -7181,6 +8318,7 @@ resume_kernel:
 		{
 			pgjoin->pds_src = PDS_writeback_arrow(pds_src, m_kds_src);
 		}
+		pgjoin->task.fallback_errcode = pgjoin->task.kerror.errcode;
 		memset(&pgjoin->task.kerror, 0, sizeof(kern_errorbuf));
 		pgjoin->task.cpu_fallback = true;
 		pgjoin->kern.resume_context = (last_suspend != NULL);
@@ -7258,6 +8396,7 @@ resume_kernel:
 	kern_args[3] = &m_kds_dst;
 	kern_args[4] = &m_nullptr;
 
+	gpuTaskTimerRecord(&pgjoin->task, GPUTASK_TIMER__KERN_BEGIN);
 	rc = cuLaunchKernel(kern_gpujoin_main,
 						grid_sz, 1, 1,
 						block_sz, 1, 1,
@@ -7268,6 +8407,7 @@ resume_kernel:
 	if (rc != CUDA_SUCCESS)
 		werror("failed on cuLaunchKernel: %s", errorText(rc));
 
+	gpuTaskTimerRecord(&pgjoin->task, GPUTASK_TIMER__KERN_END);
 	rc = cuEventRecord(CU_EVENT_PER_THREAD, CU_STREAM_PER_THREAD);
 	if (rc != CUDA_SUCCESS)
 		werror("failed on cuEventRecord: %s", errorText(rc));
@@ -7304,6 +8444,7 @@ resume_kernel:
 	else if (pgstrom_cpu_fallback_enabled &&
 			 (pgjoin->task.kerror.errcode & ERRCODE_FLAGS_CPU_FALLBACK) != 0)
 	{
+		pgjoin->task.fallback_errcode = pgjoin->task.kerror.errcode;
 		memset(&pgjoin->task.kerror, 0, sizeof(kern_errorbuf));
 		pgjoin->task.cpu_fallback = true;
 		pgjoin->kern.resume_context = (last_suspend != NULL);
@@ -7428,6 +8569,126 @@ typedef struct
 	kern_tupitem titem;
 } tupleEntry;
 
+/*
+ * NOTE: hash value is mixed again to pick up the inner partition, because
+ * the hash-slot of KDS_FORMAT_HASH is also chosen by modulo of the same
+ * hash value, so partitions would have biased usage of the hash-slots.
+ */
+#define INNER_PARTITION_OF_HASH(hash,nparts)		\
+	(DatumGetUInt32(hash_uint32(hash)) % (nparts))
+
+/*
+ * innerPreloadUpdateRuntimeFilter
+ *
+ * It updates min/max range of the inner hash-keys. Note that ecxt_innertuple
+ * is already set by get_tuple_hashvalue().
+ */
+static void
+innerPreloadUpdateRuntimeFilter(innerState *istate)
+{
+	ListCell   *lc;
+
+	foreach (lc, istate->rfilter_list)
+	{
+		gpujoinRuntimeFilter *rfilter = lfirst(lc);
+		Datum		datum;
+		bool		isnull;
+
+		datum = ExecEvalExpr(rfilter->i_key_state,
+							 istate->econtext, &isnull);
+		if (isnull)
+			continue;
+		if (!rfilter->valid)
+		{
+			rfilter->min_value = datum;
+			rfilter->max_value = datum;
+			rfilter->valid = true;
+		}
+		else
+		{
+			if (DatumGetInt32(FunctionCall2Coll(rfilter->cmp_finfo,
+												rfilter->collid,
+												datum,
+												rfilter->min_value)) < 0)
+				rfilter->min_value = datum;
+			if (DatumGetInt32(FunctionCall2Coll(rfilter->cmp_finfo,
+												rfilter->collid,
+												datum,
+												rfilter->max_value)) > 0)
+				rfilter->max_value = datum;
+		}
+	}
+}
+
+/*
+ * gpujoinPushdownRuntimeFilter
+ *
+ * It pushes down the range of inner hash-keys at depth=1 to the outer
+ * Arrow_Fdw scan, as a form of (KEY >= MIN AND KEY <= MAX), to skip
+ * record-batches that never match any inner tuples.
+ */
+static void
+gpujoinPushdownRuntimeFilter(GpuJoinState *gjs)
+{
+	innerState *istate = &gjs->inners[0];
+	Index		scanrelid = ((Scan *)gjs->gts.css.ss.ps.plan)->scanrelid;
+	List	   *runtime_quals = NIL;
+	ListCell   *lc;
+
+	if (!gjs->gts.af_state || istate->rfilter_list == NIL)
+		return;
+	foreach (lc, istate->rfilter_list)
+	{
+		gpujoinRuntimeFilter *rfilter = lfirst(lc);
+		Var		   *var;
+		Expr	   *expr;
+
+		if (!rfilter->valid)
+			continue;
+		var = makeVar(scanrelid,
+					  rfilter->outer_anum,
+					  rfilter->type_oid,
+					  rfilter->type_mod,
+					  rfilter->collid,
+					  0);
+		expr = make_opclause(rfilter->ge_opr,
+							 BOOLOID,
+							 false,
+							 (Expr *)var,
+							 (Expr *)makeConst(rfilter->type_oid,
+											   -1,
+											   rfilter->collid,
+											   rfilter->type_len,
+											   rfilter->min_value,
+											   false,
+											   true),
+							 InvalidOid,
+							 rfilter->collid);
+		set_opfuncid((OpExpr *)expr);
+		runtime_quals = lappend(runtime_quals, expr);
+
+		expr = make_opclause(rfilter->le_opr,
+							 BOOLOID,
+							 false,
+							 (Expr *)copyObject(var),
+							 (Expr *)makeConst(rfilter->type_oid,
+											   -1,
+											   rfilter->collid,
+											   rfilter->type_len,
+											   rfilter->max_value,
+											   false,
+											   true),
+							 InvalidOid,
+							 rfilter->collid);
+		set_opfuncid((OpExpr *)expr);
+		runtime_quals = lappend(runtime_quals, expr);
+	}
+	/* also resets the runtime qualifiers by the previous inner, if any */
+	ExecRuntimeQualsArrowFdw(gjs->gts.af_state,
+							 &gjs->gts.css.ss,
+							 runtime_quals);
+}
+
 static void
 innerPreloadExecOneDepth(GpuJoinState *leader, innerState *istate)
 {
@@ -7488,8 +8749,12 @@ innerPreloadExecOneDepth(GpuJoinState *leader, innerState *istate)
 			 */
 			hash = get_tuple_hashvalue(istate, true, slot, &isnull);
 			if (isnull && (istate->join_type == JOIN_INNER ||
-						   istate->join_type == JOIN_LEFT))
+						   istate->join_type == JOIN_LEFT ||
+						   istate->join_type == JOIN_SEMI ||
+						   istate->join_type == JOIN_ANTI))
 				continue;
+			if (istate->rfilter_list != NIL)
+				innerPreloadUpdateRuntimeFilter(istate);
 		}
 		else if (istate->gist_irel)
 		{
@@ -7506,7 +8771,9 @@ innerPreloadExecOneDepth(GpuJoinState *leader, innerState *istate)
 			memcpy(&htup->t_self, DatumGetPointer(datum),
 				   sizeof(ItemPointerData));
 		}
-		entry = MemoryContextAlloc(leader->preload_memcxt,
+		entry = MemoryContextAlloc(istate->inner_nparts > 1
+								   ? leader->partition_memcxt
+								   : leader->preload_memcxt,
 								   offsetof(tupleEntry,
 											titem.htup) + htup->t_len);
 		memset(entry, 0, offsetof(tupleEntry, titem.htup));
@@ -7521,16 +8788,110 @@ innerPreloadExecOneDepth(GpuJoinState *leader, innerState *istate)
 		else
 			usage = offsetof(kern_tupitem, htup) + htup->t_len;
 
+		if (istate->inner_nparts > 1)
+		{
+			int		part = INNER_PARTITION_OF_HASH(hash, istate->inner_nparts);
+
+			istate->part_nitems[part]++;
+			istate->part_usage[part] += MAXALIGN(usage);
+			slist_push_head(&istate->part_tuples[part], &entry->chain);
+			continue;
+		}
 		istate->preload_nitems++;
 		istate->preload_usage += MAXALIGN(usage);
 		slist_push_head(&istate->preload_tuples, &entry->chain);
 	}
+
+	/*
+	 * Partitioned inner buffer shall be sized to the largest partition,
+	 * because it is reused for each partition.
+	 */
+	if (istate->inner_nparts > 1)
+	{
+		size_t	max_nitems = 0;
+		size_t	max_usage = 0;
+		int		part;
+
+		for (part=0; part < istate->inner_nparts; part++)
+		{
+			max_nitems = Max(max_nitems, istate->part_nitems[part]);
+			max_usage  = Max(max_usage,  istate->part_usage[part]);
+		}
+		pg_atomic_add_fetch_u64(&gj_rtstat->jstat[depth].inner_nrooms,
+								max_nitems);
+		pg_atomic_add_fetch_u64(&gj_rtstat->jstat[depth].inner_usage,
+								max_usage);
+		return;
+	}
 	pg_atomic_add_fetch_u64(&gj_rtstat->jstat[depth].inner_nrooms,
 							istate->preload_nitems);
 	pg_atomic_add_fetch_u64(&gj_rtstat->jstat[depth].inner_usage,
 							istate->preload_usage);
 }
 
+/*
+ * innerPreloadSelectPartition
+ *
+ * It attaches inner tuples of the given partition to the preload list of
+ * the partitioned depth, to setup the host inner buffer.
+ */
+static void
+innerPreloadSelectPartition(innerState *istate, int part)
+{
+	Assert(istate->inner_nparts > 1 && part < istate->inner_nparts);
+	istate->preload_tuples = istate->part_tuples[part];
+	istate->preload_nitems = istate->part_nitems[part];
+	istate->preload_usage  = istate->part_usage[part];
+}
+
+/*
+ * innerPreloadBloomFilterNBlocks
+ *
+ * It determines number of the Bloom-filter blocks for the inner hash table,
+ * or returns 0 if Bloom-filter makes no sense. Small hash table is usually
+ * kept in the L2 cache, and too small Bloom-filter towards the number of
+ * inner tuples cannot eliminate the outer tuples.
+ */
+static cl_uint
+innerPreloadBloomFilterNBlocks(size_t nrooms, size_t hash_length)
+{
+	size_t		nbits = nrooms * GPUJOIN_BLOOM_BITS_PER_ITEM;
+	size_t		nblocks = 1;
+
+	if (!enable_gpuhashjoin_bloom ||
+		nrooms == 0 ||
+		hash_length < GPUJOIN_BLOOM_MIN_HASH_LENGTH)
+		return 0;
+	while (nblocks * GPUJOIN_BLOOM_BLOCK_SIZE * BITS_PER_BYTE < nbits &&
+		   nblocks * GPUJOIN_BLOOM_BLOCK_SIZE < GPUJOIN_BLOOM_MAX_LENGTH)
+		nblocks <<= 1;
+	/* at least 8 bits per inner tuple */
+	if (nblocks * GPUJOIN_BLOOM_BLOCK_SIZE * BITS_PER_BYTE < nrooms * 8)
+		return 0;
+	return nblocks;
+}
+
+/*
+ * innerPreloadHashBucketNBuckets
+ *
+ * It determines number of the open-addressing hash-buckets for the inner
+ * hash table, or returns 0 if not built. Load factor is kept less than 50%
+ * to terminate the probe sequence in one bucket mostly.
+ */
+static cl_uint
+innerPreloadHashBucketNBuckets(innerState *istate, size_t nrooms)
+{
+	size_t		nbuckets = 1;
+
+	if (!istate->hash_bucketed || nrooms == 0)
+		return 0;
+	while (nbuckets * GPUJOIN_HASH_BUCKET_NITEMS < 2 * nrooms)
+		nbuckets <<= 1;
+	if (nbuckets > UINT_MAX)
+		return 0;
+	return nbuckets;
+}
+
 /*
  * innerPreloadAllocHostBuffer
  */
@@ -7564,6 +8925,8 @@ restart:
 		size_t		nrooms;
 		size_t		usage;
 		size_t		nbytes;
+		cl_uint		bloom_nblocks;
+		cl_uint		hbucket_nbuckets;
 
 		nrooms = pg_atomic_read_u64(&gj_rtstat->jstat[i+1].inner_nrooms);
 		usage  = pg_atomic_read_u64(&gj_rtstat->jstat[i+1].inner_usage);
@@ -7574,6 +8937,8 @@ restart:
 		}
 
 		nbytes = KDS_calculateHeadSize(tupdesc);
+		bloom_nblocks = 0;
+		hbucket_nbuckets = 0;
 		if (istate->hash_inner_keys != NIL)
 		{
 			nbytes += (STROMALIGN(sizeof(cl_uint) * nrooms) +
@@ -7585,6 +8950,8 @@ restart:
 									   KDS_FORMAT_HASH, nrooms);
 				kds->nslots = __KDS_NSLOTS(nrooms);
 			}
+			bloom_nblocks = innerPreloadBloomFilterNBlocks(nrooms, nbytes);
+			hbucket_nbuckets = innerPreloadHashBucketNBuckets(istate, nrooms);
 		}
 		else if (istate->gist_irel != NULL)
 		{
@@ -7633,6 +9000,60 @@ restart:
 		}
 		kmrels_ofs += nbytes;
 
+		/* Bloom-filter of the inner hash table, if any */
+		if (bloom_nblocks > 0)
+		{
+			if (h_kmrels)
+			{
+				h_kmrels->chunks[i].bloom_offset = kmrels_ofs;
+				h_kmrels->chunks[i].bloom_nblocks = bloom_nblocks;
+			}
+			kmrels_ofs += STROMALIGN(GPUJOIN_BLOOM_BLOCK_SIZE * bloom_nblocks);
+		}
+
+		/* open-addressing hash-buckets, aligned to the cache line */
+		if (hbucket_nbuckets > 0)
+		{
+			kmrels_ofs = TYPEALIGN(sizeof(kern_hashbucket), kmrels_ofs);
+			if (h_kmrels)
+			{
+				h_kmrels->chunks[i].hbucket_offset = kmrels_ofs;
+				h_kmrels->chunks[i].hbucket_nbuckets = hbucket_nbuckets;
+			}
+			kmrels_ofs += sizeof(kern_hashbucket) * (size_t)hbucket_nbuckets;
+		}
+
+		/*
+		 * Bloom-filter and hash-buckets are built on the device after the
+		 * inner buffer is copied, unless the inner hash table is partitioned;
+		 * it is rebuilt on the host buffer for each partition.
+		 */
+		if (h_kmrels &&
+			enable_gpuhashjoin_device_build &&
+			istate->inner_nparts <= 1 &&
+			(bloom_nblocks > 0 || hbucket_nbuckets > 0))
+			h_kmrels->chunks[i].device_build = true;
+
+		/*
+		 * heavy-hitter keys of the inner hash table; only INNER and RIGHT
+		 * OUTER JOIN, because the cooperative probe does not track whether
+		 * the outer row has any matched inner rows.
+		 */
+		if (istate->hash_inner_keys != NIL &&
+			istate->gist_irel == NULL &&
+			istate->inner_nparts <= 1 &&
+			(istate->join_type == JOIN_INNER ||
+			 istate->join_type == JOIN_RIGHT) &&
+			gpuhashjoin_skew_threshold > 0 &&
+			nrooms >= (size_t)gpuhashjoin_skew_threshold &&
+			nbytes < GPUJOIN_HASH_SKEW_MAX_LENGTH)
+		{
+			if (h_kmrels)
+				h_kmrels->chunks[i].hskew_offset = kmrels_ofs;
+			kmrels_ofs += STROMALIGN(sizeof(kern_hashskew) *
+									 GPUJOIN_HASH_SKEW_MAX_KEYS);
+		}
+
 		if (istate->join_type == JOIN_RIGHT ||
             istate->join_type == JOIN_FULL)
 		{
@@ -7649,6 +9070,11 @@ restart:
 			if (h_kmrels)
 				h_kmrels->chunks[i].left_outer = true;
 		}
+		if (h_kmrels)
+		{
+			h_kmrels->chunks[i].semi_join = (istate->join_type == JOIN_SEMI);
+			h_kmrels->chunks[i].anti_join = (istate->join_type == JOIN_ANTI);
+		}
 	}
 
 	/*
@@ -7766,42 +9192,261 @@ __innerPreloadSetupHashBuffer(kern_data_store *kds,
 }
 
 static void
-__innerPreloadSetupGiSTIndexWalker(char *base,
-								   BlockNumber blkno,
-								   BlockNumber nblocks,
-								   BlockNumber parent_blkno,
-								   OffsetNumber parent_offno)
+__innerPreloadSetupBloomFilter(kern_multirels *h_kmrels,
+							   innerState *istate)
 {
-	Page			page = (Page)(base + BLCKSZ * blkno);
-	PageHeader		hpage = (PageHeader) page;
-	GISTPageOpaque	op = GistPageGetOpaque(page);
-	OffsetNumber	i, maxoff;
+	cl_uint	   *bloom = KERN_MULTIRELS_BLOOM_FILTER(h_kmrels, istate->depth);
+	cl_uint		nblocks = h_kmrels->chunks[istate->depth-1].bloom_nblocks;
+	slist_iter	iter;
 
-	Assert(hpage->pd_lsn.xlogid == InvalidBlockNumber &&
-		   hpage->pd_lsn.xrecoff == InvalidOffsetNumber);
-	hpage->pd_lsn.xlogid = parent_blkno;
-	hpage->pd_lsn.xrecoff = parent_offno;
-	if ((op->flags & F_LEAF) != 0)
-		return;
-	maxoff = PageGetMaxOffsetNumber(page);
-	for (i=FirstOffsetNumber; i <= maxoff; i = OffsetNumberNext(i))
+	Assert(bloom != NULL && nblocks > 0);
+	slist_foreach (iter, &istate->preload_tuples)
 	{
-		ItemId		iid = PageGetItemId(page, i);
-        IndexTuple	it;
-		BlockNumber	child;
+		tupleEntry *entry = slist_container(tupleEntry, chain, iter.cur);
+		cl_uint	   *block;
+		cl_uint		masks[GPUJOIN_BLOOM_BLOCK_NWORDS];
+		int			j;
 
-		if (ItemIdIsDead(iid))
-			continue;
-		it = (IndexTuple) PageGetItem(page, iid);
-		child = BlockIdGetBlockNumber(&it->t_tid.ip_blkid);
-		if (child < nblocks)
-			__innerPreloadSetupGiSTIndexWalker(base, child, nblocks, blkno, i);
+		block = bloom + GPUJOIN_BLOOM_BLOCK_NWORDS *
+			__gpujoin_bloom_block_index(entry->hash, nblocks);
+		__gpujoin_bloom_block_masks(entry->hash, masks);
+		for (j=0; j < GPUJOIN_BLOOM_BLOCK_NWORDS; j++)
+			__atomic_fetch_or(&block[j], masks[j], __ATOMIC_RELAXED);
 	}
 }
 
+/*
+ * __innerPreloadSetupHashBuckets
+ *
+ * It registers the kern_hashitems already setup on the KDS_FORMAT_HASH
+ * (row-index between base_nitems and base_nitems + nitems) to the
+ * open-addressing hash-buckets. Concurrent workers may register the items
+ * simultaneously, so an entry is acquired by atomic operation.
+ */
 static void
-__innerPreloadSetupGiSTIndexBuffer(innerState *istate,
-								   kern_data_store *kds_gist)
+__innerPreloadSetupHashBuckets(kern_multirels *h_kmrels,
+							   kern_data_store *kds,
+							   int depth,
+							   cl_uint base_nitems,
+							   cl_uint nitems)
+{
+	kern_hashbucket *hbuckets = KERN_MULTIRELS_HASH_BUCKETS(h_kmrels, depth);
+	cl_uint		nbuckets = h_kmrels->chunks[depth-1].hbucket_nbuckets;
+	cl_uint	   *row_index = KERN_DATA_STORE_ROWINDEX(kds);
+	cl_uint		rowid;
+
+	Assert(hbuckets != NULL && nbuckets > 0);
+	for (rowid = base_nitems; rowid < base_nitems + nitems; rowid++)
+	{
+		kern_hashitem *khitem = (kern_hashitem *)
+			((char *)kds + __kds_unpack(row_index[rowid])
+			 - offsetof(kern_hashitem, t));
+		cl_uint		self = __kds_packed((char *)khitem - (char *)kds);
+		cl_uint		bindex = __gpujoin_hash_bucket_index(khitem->hash,
+														 nbuckets);
+		cl_uint		loop;
+		int			j;
+
+		for (loop=0; loop < nbuckets; loop++)
+		{
+			kern_hashbucket *hbucket = &hbuckets[bindex];
+
+			for (j=0; j < GPUJOIN_HASH_BUCKET_NITEMS; j++)
+			{
+				cl_uint		expected = 0;
+
+				if (hbucket->offset[j] == 0 &&
+					__atomic_compare_exchange_n(&hbucket->offset[j],
+												&expected, self,
+												false,
+												__ATOMIC_SEQ_CST,
+												__ATOMIC_SEQ_CST))
+				{
+					hbucket->hash[j] = khitem->hash;
+					goto next;
+				}
+			}
+			bindex = (bindex + 1) & (nbuckets - 1);
+		}
+		elog(ERROR, "Bug? no empty entry in the GpuHashJoin hash-buckets");
+	next:
+		;
+	}
+}
+
+/*
+ * __innerPreloadSetupHashSkew
+ *
+ * It picks up the heavy-hitter keys of the inner hash table by sampling,
+ * then rearranges their inner rows to the contiguous range of the row-index
+ * for the cooperative probe on GPU kernel (see gpujoin_exec_hashjoin_skew).
+ * Row-index is referenced by the outer-join map and right-outer-join, so
+ * both of the row-index and kern_tupitem->rowid are swapped consistently.
+ * Caller holds gj_sstate->mutex, so it must not raise an error.
+ */
+static int
+__innerPreloadHashSkewCompare(const void *__a, const void *__b)
+{
+	cl_uint		a = *((const cl_uint *)__a);
+	cl_uint		b = *((const cl_uint *)__b);
+
+	if (a < b)
+		return -1;
+	if (a > b)
+		return 1;
+	return 0;
+}
+
+static void
+__innerPreloadSetupHashSkew(kern_multirels *h_kmrels, int depth)
+{
+	kern_data_store *kds = KERN_MULTIRELS_INNER_KDS(h_kmrels, depth);
+	kern_hashskew *hskew = (kern_hashskew *)
+		((char *)h_kmrels + h_kmrels->chunks[depth-1].hskew_offset);
+	cl_uint	   *row_index = KERN_DATA_STORE_ROWINDEX(kds);
+	cl_uint		samples[GPUJOIN_HASH_SKEW_NSAMPLES];
+	cl_uint		cand_hash[GPUJOIN_HASH_SKEW_MAX_KEYS];
+	cl_uint		cand_count[GPUJOIN_HASH_SKEW_MAX_KEYS];
+	cl_uint		nsamples;
+	cl_uint		ncands = 0;
+	cl_uint		nkeys = 0;
+	cl_uint		row_next = 0;
+	cl_uint		i, j, k;
+
+	Assert(kds->format == KDS_FORMAT_HASH);
+	h_kmrels->chunks[depth-1].hskew_nkeys = 0;
+	if (gpuhashjoin_skew_threshold <= 0 ||
+		kds->nitems < (cl_uint)gpuhashjoin_skew_threshold)
+		return;
+
+	/* sampling of the hash values by fixed stride */
+	nsamples = Min(kds->nitems, GPUJOIN_HASH_SKEW_NSAMPLES);
+	for (i=0; i < nsamples; i++)
+	{
+		cl_uint		rowid = ((uint64)i * (uint64)kds->nitems) / nsamples;
+		kern_hashitem *khitem = (kern_hashitem *)
+			((char *)kds + __kds_unpack(row_index[rowid])
+			 - offsetof(kern_hashitem, t));
+		samples[i] = khitem->hash;
+	}
+	qsort(samples, nsamples, sizeof(cl_uint),
+		  __innerPreloadHashSkewCompare);
+
+	/* pick up the candidates of heavy-hitter keys */
+	for (i=0; i < nsamples; i=j)
+	{
+		cl_uint		count;
+
+		for (j=i+1; j < nsamples && samples[j] == samples[i]; j++);
+		count = j - i;
+		if (count < 2 ||
+			((double)count * (double)kds->nitems /
+			 (double)nsamples) < (double)gpuhashjoin_skew_threshold)
+			continue;
+		if (ncands < GPUJOIN_HASH_SKEW_MAX_KEYS)
+			k = ncands++;
+		else
+		{
+			cl_uint		__k;
+
+			/* replace the least frequent candidate */
+			for (k=0, __k=1; __k < ncands; __k++)
+			{
+				if (cand_count[__k] < cand_count[k])
+					k = __k;
+			}
+			if (cand_count[k] >= count)
+				continue;
+		}
+		cand_hash[k] = samples[i];
+		cand_count[k] = count;
+	}
+
+	/* rearrange the inner rows of the heavy-hitter keys */
+	for (k=0; k < ncands; k++)
+	{
+		cl_uint		hash = cand_hash[k];
+		cl_uint		nitems = 0;
+		kern_hashitem *khitem;
+
+		for (khitem = KERN_HASH_FIRST_ITEM(kds, hash);
+			 khitem != NULL;
+			 khitem = KERN_HASH_NEXT_ITEM(kds, khitem))
+		{
+			if (khitem->hash == hash)
+				nitems++;
+		}
+		if (nitems < (cl_uint)gpuhashjoin_skew_threshold)
+			continue;
+
+		hskew[nkeys].hash = hash;
+		hskew[nkeys].row_base = row_next;
+		hskew[nkeys].nitems = nitems;
+		nkeys++;
+		for (khitem = KERN_HASH_FIRST_ITEM(kds, hash);
+			 khitem != NULL;
+			 khitem = KERN_HASH_NEXT_ITEM(kds, khitem))
+		{
+			cl_uint		rowid = khitem->t.rowid;
+
+			if (khitem->hash != hash)
+				continue;
+			if (rowid != row_next)
+			{
+				kern_hashitem *kh_temp = (kern_hashitem *)
+					((char *)kds + __kds_unpack(row_index[row_next])
+					 - offsetof(kern_hashitem, t));
+
+				Assert(kh_temp->t.rowid == row_next);
+				row_index[rowid] = row_index[row_next];
+				kh_temp->t.rowid = rowid;
+				row_index[row_next] = __kds_packed((char *)&khitem->t -
+												   (char *)kds);
+				khitem->t.rowid = row_next;
+			}
+			row_next++;
+		}
+	}
+	h_kmrels->chunks[depth-1].hskew_nkeys = nkeys;
+}
+
+static void
+__innerPreloadSetupGiSTIndexWalker(char *base,
+								   BlockNumber blkno,
+								   BlockNumber nblocks,
+								   BlockNumber parent_blkno,
+								   OffsetNumber parent_offno)
+{
+	Page			page = (Page)(base + BLCKSZ * blkno);
+	PageHeader		hpage = (PageHeader) page;
+	GISTPageOpaque	op = GistPageGetOpaque(page);
+	OffsetNumber	i, maxoff;
+
+	Assert(hpage->pd_lsn.xlogid == InvalidBlockNumber &&
+		   hpage->pd_lsn.xrecoff == InvalidOffsetNumber);
+	hpage->pd_lsn.xlogid = parent_blkno;
+	hpage->pd_lsn.xrecoff = parent_offno;
+	if ((op->flags & F_LEAF) != 0)
+		return;
+	maxoff = PageGetMaxOffsetNumber(page);
+	for (i=FirstOffsetNumber; i <= maxoff; i = OffsetNumberNext(i))
+	{
+		ItemId		iid = PageGetItemId(page, i);
+        IndexTuple	it;
+		BlockNumber	child;
+
+		if (ItemIdIsDead(iid))
+			continue;
+		it = (IndexTuple) PageGetItem(page, iid);
+		child = BlockIdGetBlockNumber(&it->t_tid.ip_blkid);
+		if (child < nblocks)
+			__innerPreloadSetupGiSTIndexWalker(base, child, nblocks, blkno, i);
+	}
+}
+
+static void
+__innerPreloadSetupGiSTIndexBuffer(innerState *istate,
+								   kern_data_store *kds_gist)
 {
 	Relation	irel = istate->gist_irel;
 	char	   *base = (char *)KERN_DATA_STORE_BLOCK_PGPAGE(kds_gist, 0);
@@ -7944,6 +9589,114 @@ __innerPreloadInitGiSTIndex(GpuJoinState *gjs, CUdeviceptr m_kmrels)
    }
 }
 
+/*
+ * __innerPreloadBuildHashOnDevice
+ *
+ * It builds the Bloom-filter and the hash-buckets of the inner hash tables
+ * marked by 'device_build' on the device buffer just copied from the host.
+ * These areas are left zero-cleared on the host buffer, so the copied
+ * image is ready to run gpujoin_build_hash_buckets.
+ */
+static void
+__innerPreloadBuildHashOnDevice(GpuJoinState *gjs,
+								kern_multirels *h_kmrels,
+								CUdeviceptr m_kmrels)
+{
+	GpuContext	   *gcontext = gjs->gts.gcontext;
+	CUmodule		cuda_module = NULL;
+	CUfunction		f_build_hash = NULL;
+	CUresult		rc;
+	void		   *kern_args[2];
+	cl_int			grid_sz;
+	cl_int			block_sz;
+	cl_int			depth;
+
+	for (depth=1; depth <= h_kmrels->nrels; depth++)
+	{
+		kern_data_store *kds = KERN_MULTIRELS_INNER_KDS(h_kmrels, depth);
+
+		if (!h_kmrels->chunks[depth-1].device_build || kds->nitems == 0)
+			continue;
+		/* load the CUDA module and function */
+		if (!cuda_module)
+		{
+			cuda_module = GpuContextLookupModule(gcontext,
+												 gjs->gts.program_id);
+			rc = cuModuleGetFunction(&f_build_hash,
+									 cuda_module,
+									 "gpujoin_build_hash_buckets");
+			if (rc != CUDA_SUCCESS)
+				elog(ERROR, "failed on cuModuleGetFunction: %s", errorText(rc));
+			rc = gpuOptimalBlockSize(&grid_sz,
+									 &block_sz,
+									 f_build_hash,
+									 gcontext->cuda_device,
+									 0, 0);
+			if (rc != CUDA_SUCCESS)
+				elog(ERROR, "failed on gpuOptimalBlockSize: %s", errorText(rc));
+		}
+		/* launch gpujoin_build_hash_buckets */
+		kern_args[0] = &m_kmrels;
+		kern_args[1] = &depth;
+
+		rc = cuLaunchKernel(f_build_hash,
+							Min(grid_sz, (kds->nitems +
+										  block_sz - 1) / block_sz), 1, 1,
+							block_sz, 1, 1,
+							0,
+							CU_STREAM_PER_THREAD,
+							kern_args,
+							NULL);
+		if (rc != CUDA_SUCCESS)
+			elog(ERROR, "failed on cuLaunchKernel: %s", errorText(rc));
+	}
+
+	if (cuda_module)
+	{
+		rc = cuStreamSynchronize(CU_STREAM_PER_THREAD);
+		if (rc != CUDA_SUCCESS)
+			elog(ERROR, "failed on cuStreamSynchronize: %s", errorText(rc));
+	}
+}
+
+/*
+ * innerPreloadLookupPeerDeviceBuffer
+ *
+ * It looks up another GPU device that already holds the inner buffer, and
+ * the current device can access by peer access (NVLink or PCI-E).
+ * Returns the device index of the peer device, or -1 if not found.
+ */
+static int
+innerPreloadLookupPeerDeviceBuffer(GpuContext *gcontext,
+								   GpuJoinSharedState *gj_sstate)
+{
+	int			dindex;
+
+	if (!enable_gpujoin_inner_peer_access)
+		return -1;
+	for (dindex=0; dindex < numDevAttrs; dindex++)
+	{
+		CUdevice	peer_device;
+		CUresult	rc;
+		int			can_access = 0;
+
+		if (dindex == gcontext->cuda_dindex ||
+			gj_sstate->pergpu[dindex].bytesize == 0)
+			continue;
+		rc = cuDeviceGet(&peer_device, devAttrs[dindex].DEV_ID);
+		if (rc != CUDA_SUCCESS)
+			elog(ERROR, "failed on cuDeviceGet: %s", errorText(rc));
+		rc = cuDeviceCanAccessPeer(&can_access,
+								   gcontext->cuda_device,
+								   peer_device);
+		if (rc != CUDA_SUCCESS)
+			elog(ERROR, "failed on cuDeviceCanAccessPeer: %s", errorText(rc));
+		if (can_access)
+			return dindex;
+	}
+	return -1;
+}
+
 static void
 innerPreloadLoadDeviceBuffer(GpuJoinState *leader,
 							 GpuJoinState *gjs)
@@ -7953,8 +9706,12 @@ innerPreloadLoadDeviceBuffer(GpuJoinState *leader,
 	GpuJoinSharedState *gj_sstate = leader->gj_sstate;
 	kern_multirels *h_kmrels = gjs->h_kmrels;
 	int				dindex = gcontext->cuda_dindex;
+	int				peer_dindex = -1;
+
+	Assert(leader->sibling == gjs->sibling);
+	if (gj_sstate->pergpu[dindex].bytesize == 0)
+		peer_dindex = innerPreloadLookupPeerDeviceBuffer(gcontext, gj_sstate);
 
-	Assert(leader->sibling == gjs->sibling);	
 	if (sibling && sibling->pergpu[dindex].m_kmrels != 0UL)
 	{
 		/*
@@ -7965,6 +9722,29 @@ innerPreloadLoadDeviceBuffer(GpuJoinState *leader,
 		gjs->m_kmrels = sibling->pergpu[dindex].m_kmrels;
 		gjs->m_kmrels_owner = false;
 	}
+	else if (peer_dindex >= 0)
+	{
+		/*
+		 * Other GPU device already holds the inner buffer, and the current
+		 * device can access it by peer access. So, we map the inner buffer
+		 * of the peer device, instead of the own copy on the device memory.
+		 * Outer-join-map is also shared, thus, no colocation is needed.
+		 */
+		CUdeviceptr		m_kmrels;
+		CUresult		rc;
+
+		rc = gpuIpcOpenMemHandle(gcontext,
+								 &m_kmrels,
+								 gj_sstate->pergpu[peer_dindex].ipc_mhandle,
+								 CU_IPC_MEM_LAZY_ENABLE_PEER_ACCESS);
+		if (rc != CUDA_SUCCESS)
+			elog(ERROR, "failed on gpuIpcOpenMemHandle: %s", errorText(rc));
+
+		gjs->m_kmrels = m_kmrels;
+		gjs->m_kmrels_owner = true;
+		if (sibling)
+			sibling->pergpu[dindex].m_kmrels = m_kmrels;
+	}
 	else if (gj_sstate->pergpu[dindex].bytesize == 0)
 	{
 		CUdeviceptr		m_kmrels;
@@ -7991,6 +9771,7 @@ innerPreloadLoadDeviceBuffer(GpuJoinState *leader,
 		if (rc != CUDA_SUCCESS)
 			elog(ERROR, "failed on cuMemcpyHtoD: %s", errorText(rc));
 		__innerPreloadInitGiSTIndex(gjs, m_kmrels);
+		__innerPreloadBuildHashOnDevice(gjs, h_kmrels, m_kmrels);
 		GPUCONTEXT_POP(gcontext);
 
 		gjs->m_kmrels = m_kmrels;
@@ -8028,9 +9809,11 @@ GpuJoinInnerPreload(GpuTaskState *gts, CUdeviceptr *p_m_kmrels)
 	GpuContext	   *gcontext = gjs->gts.gcontext;
 	GpuJoinSharedState *gj_sstate;
 	kern_multirels *h_kmrels = NULL;
+	bool			inner_cache_store = false;
+	bool			preload_by_depth;
 	int				i, dindex = gcontext->cuda_dindex;
+	uint64			nvtx_range;
 
-	
 	/* Quick exit, if inner-buffer is now available */
 	if (gjs->m_kmrels != 0UL)
 	{
@@ -8039,6 +9822,7 @@ GpuJoinInnerPreload(GpuTaskState *gts, CUdeviceptr *p_m_kmrels)
 			*p_m_kmrels = gjs->m_kmrels;
 		return (gjs->h_kmrels != NULL);
 	}
+	nvtx_range = pgstromNvtxBegin("GpuJoinInnerPreload", gts, 0);
 
 	/* Allocation of a 'fake' shared-state, if single process */
 	if (!gjs->gj_sstate)
@@ -8056,6 +9840,19 @@ GpuJoinInnerPreload(GpuTaskState *gts, CUdeviceptr *p_m_kmrels)
 		leader = gjs;
 	gj_sstate = leader->gj_sstate;
 
+	/*
+	 * If inner relations are not parallel-aware, each parallel worker can
+	 * scan the individual depths concurrently; a worker claims the next depth
+	 * not scanned yet, until all the depths are claimed by someone. Tuples
+	 * of each depth are merged to the host inner buffer, as if inner scans
+	 * were parallel-aware.
+	 */
+	preload_by_depth = (IsParallelWorker() || gjs->gts.pcxt != NULL) &&
+		!gjs->inner_parallel &&
+		!gjs->inner_cache_enabled &&
+		!gjs->sibling &&
+		gjs->num_rels > 1;
+
 	/*
 	 * Inner PreLoad State Machine
 	 */
@@ -8064,16 +9861,34 @@ GpuJoinInnerPreload(GpuTaskState *gts, CUdeviceptr *p_m_kmrels)
 	{
 		case INNER_PHASE__SCAN_RELATIONS:
 			if (gjs->inner_parallel ||
+				preload_by_depth ||
 				gj_sstate->nr_workers_scanning == 0)
 			{
 				gj_sstate->nr_workers_scanning++;
 				SpinLockRelease(&gj_sstate->mutex);
 
 				/*
-				 * Scan inner relations, often in parallel
+				 * Scan inner relations, often in parallel, unless
+				 * the inner buffer cache is available.
 				 */
-				for (i=0; i < leader->num_rels; i++)
-					innerPreloadExecOneDepth(leader, &leader->inners[i]);
+				if (preload_by_depth)
+				{
+					while ((i = pg_atomic_fetch_add_u32(&gj_sstate->preload_next_depth,
+														1)) < leader->num_rels)
+						innerPreloadExecOneDepth(leader, &leader->inners[i]);
+					/* no runtime filter; depth=1 might be scanned by others */
+				}
+				else if (!gjs->inner_cache_enabled ||
+						 !gpujoinInnerCacheLookup(gjs))
+				{
+					for (i=0; i < leader->num_rels; i++)
+						innerPreloadExecOneDepth(leader, &leader->inners[i]);
+					/* runtime join filter for the outer Arrow_Fdw scan */
+					if (leader == gjs)
+						gpujoinPushdownRuntimeFilter(gjs);
+					/* this process built the inner buffer */
+					inner_cache_store = gjs->inner_cache_enabled;
+				}
 
 				/*
 				 * Once (parallel) scan completed, no other concurrent
@@ -8142,6 +9957,8 @@ GpuJoinInnerPreload(GpuTaskState *gts, CUdeviceptr *p_m_kmrels)
 				cl_uint		nitems_base;
 				cl_uint		usage_base;
 
+				if (istate->inner_nparts > 1)
+					innerPreloadSelectPartition(istate, leader->inner_curr_part);
 				SpinLockAcquire(&gj_sstate->mutex);
 				nitems_base = kds->nitems;
 				kds->nitems += istate->preload_nitems;
@@ -8154,9 +9971,21 @@ GpuJoinInnerPreload(GpuTaskState *gts, CUdeviceptr *p_m_kmrels)
 												  nitems_base,
 												  usage_base);
 				else if (kds->format == KDS_FORMAT_HASH)
+				{
 					__innerPreloadSetupHashBuffer(kds, istate,
 												  nitems_base,
 												  usage_base);
+					/* elsewhere, see __innerPreloadBuildHashOnDevice */
+					if (!h_kmrels->chunks[i].device_build)
+					{
+						if (h_kmrels->chunks[i].bloom_offset != 0)
+							__innerPreloadSetupBloomFilter(h_kmrels, istate);
+						if (h_kmrels->chunks[i].hbucket_offset != 0)
+							__innerPreloadSetupHashBuckets(h_kmrels, kds, i+1,
+														   nitems_base,
+														   istate->preload_nitems);
+					}
+				}
 				else
 					elog(ERROR, "unexpected inner-KDS format");
 				
@@ -8183,6 +10012,9 @@ GpuJoinInnerPreload(GpuTaskState *gts, CUdeviceptr *p_m_kmrels)
 					innerState *istate = &leader->inners[i];
 					kern_data_store *kds_gist;
 
+					/* rearrange the heavy-hitter keys, if any */
+					if (h_kmrels->chunks[i].hskew_offset != 0)
+						__innerPreloadSetupHashSkew(h_kmrels, i+1);
 					if (!istate->gist_irel)
 						continue;
 					kds_gist = (kern_data_store *)
@@ -8237,6 +10069,10 @@ GpuJoinInnerPreload(GpuTaskState *gts, CUdeviceptr *p_m_kmrels)
 	}
 	SpinLockRelease(&gj_sstate->mutex);
 
+	/* register the inner buffer built by this process to the cache */
+	if (inner_cache_store)
+		gpujoinInnerCacheStore(gjs);
+
 	/*
 	 * Any backend or worker process, that tried to fetch the inner buffer
 	 * after the 'phase' is switched to INNER_PHASE__GPUJOIN_CLOSING, shall
@@ -8245,6 +10081,7 @@ GpuJoinInnerPreload(GpuTaskState *gts, CUdeviceptr *p_m_kmrels)
 	 */
 	if (p_m_kmrels)
 		*p_m_kmrels = gjs->m_kmrels;
+	pgstromNvtxEnd(nvtx_range);
 	return (gjs->m_kmrels != 0UL);
 }
 
@@ -8285,7 +10122,8 @@ GpuJoinInnerUnload(GpuTaskState *gts, bool is_rescan)
 	if (gj_sstate && !IsParallelWorker())
 	{
 		char		name[200];
-		
+
+		gpujoinInnerCacheDetach(gj_sstate);
 		for (dindex=0; dindex < numDevAttrs; dindex++)
 		{
 			if (gj_sstate->pergpu[dindex].bytesize == 0)
@@ -8310,6 +10148,470 @@ GpuJoinInnerUnload(GpuTaskState *gts, bool is_rescan)
 	gjs->h_kmrels = NULL;
 	gjs->m_kmrels = 0UL;
 	gjs->m_kmrels_owner = false;
+
+	/* release the partitioned inner tuples, if any */
+	if (gjs->inner_part_depth > 0)
+	{
+		innerState *istate = &gjs->inners[gjs->inner_part_depth - 1];
+		int			part;
+
+		for (part=0; part < istate->inner_nparts; part++)
+		{
+			slist_init(&istate->part_tuples[part]);
+			istate->part_nitems[part] = 0;
+			istate->part_usage[part] = 0;
+		}
+		MemoryContextReset(gjs->partition_memcxt);
+		gjs->inner_curr_part = 0;
+	}
+
+	/* reset the runtime join filter, if any */
+	if (gjs->num_rels > 0)
+	{
+		ListCell   *lc;
+
+		foreach (lc, gjs->inners[0].rfilter_list)
+		{
+			gpujoinRuntimeFilter *rfilter = lfirst(lc);
+
+			rfilter->valid = false;
+		}
+	}
+}
+
+/*
+ * gpujoinInnerCacheInit
+ *
+ * It checks whether the inner buffer of this GpuJoin is cachable, and
+ * calculates the signature of the inner buffer. Only simple SeqScan on
+ * the permanent tables with immutable qualifiers are cachable.
+ */
+static void
+gpujoinInnerCacheInit(GpuJoinState *gjs,
+					  GpuJoinInfo *gj_info,
+					  CustomScan *cscan)
+{
+	StringInfoData buf;
+	ListCell   *lc1, *lc2;
+	int			i = 0;
+
+	gjs->inner_cache_enabled = false;
+	if (!enable_gpujoin_inner_cache ||
+		gpujoin_inner_cache_size_kb == 0 ||
+		IsParallelWorker() ||
+		gjs->sibling != NULL ||
+		gj_info->inner_parallel ||
+		gjs->inner_part_depth > 0 ||
+		gjs->num_rels > GPUJOIN_INNER_CACHE_MAX_RELS)
+		return;
+
+	initStringInfo(&buf);
+	forboth (lc1, cscan->custom_plans,
+			 lc2, gj_info->inner_infos)
+	{
+		Plan	   *plan = lfirst(lc1);
+		GpuJoinInnerInfo *i_info = lfirst(lc2);
+		innerState *istate = &gjs->inners[i++];
+		Relation	rel;
+
+		if (!IsA(plan, SeqScan) ||
+			!bms_is_empty(plan->allParam) ||
+			i_info->join_type == JOIN_RIGHT ||
+			i_info->join_type == JOIN_FULL ||
+			OidIsValid(i_info->gist_index_reloid) ||
+			contain_mutable_functions((Node *)plan->targetlist) ||
+			contain_mutable_functions((Node *)plan->qual) ||
+			contain_mutable_functions((Node *)i_info->hash_inner_keys))
+			goto bailout;
+		rel = ((ScanState *)istate->state)->ss_currentRelation;
+		if (!rel ||
+			RelationGetForm(rel)->relkind != RELKIND_RELATION ||
+			RelationGetForm(rel)->relrowsecurity ||
+			!RelationNeedsWAL(rel))
+			goto bailout;
+		appendStringInfo(&buf, "%u:%d:%d:%s:%s:%s:%s;",
+						 RelationGetRelid(rel),
+						 (int)i_info->join_type,
+						 (int)i_info->hash_bucketed,
+						 nodeToString(plan->targetlist),
+						 nodeToString(plan->qual),
+						 nodeToString(i_info->hash_inner_keys),
+						 bmsToString(istate->preload_flatten_attrs));
+	}
+	appendStringInfo(&buf, "bloom=%d", (int)enable_gpuhashjoin_bloom);
+
+	gjs->inner_cache_key[0] = DatumGetUInt64(hash_any_extended((unsigned char *)buf.data,
+																buf.len, 0));
+	gjs->inner_cache_key[1] = DatumGetUInt64(hash_any_extended((unsigned char *)buf.data,
+																buf.len, 0x5bd1e995));
+	gjs->inner_cache_vers = palloc0(sizeof(gpujoinInnerCacheVersion) *
+									gjs->num_rels);
+	gjs->inner_cache_enabled = true;
+bailout:
+	pfree(buf.data);
+}
+
+/*
+ * gpujoinInnerCacheGetVersion
+ *
+ * It returns the version of the inner relation, or false if any pages are
+ * not all-visible.
+ */
+static bool
+gpujoinInnerCacheGetVersion(Relation rel, gpujoinInnerCacheVersion *ver)
+{
+	BlockNumber	nblocks = RelationGetNumberOfBlocks(rel);
+	BlockNumber	all_visible;
+	BlockNumber	vm_nblocks;
+	BlockNumber	blkno;
+	XLogRecPtr	vm_lsn = InvalidXLogRecPtr;
+
+	visibilitymap_count(rel, &all_visible, NULL);
+	if (all_visible < nblocks)
+		return false;
+	if (nblocks > 0)
+	{
+		vm_nblocks = RelationGetNumberOfBlocksInFork(rel, VISIBILITYMAP_FORKNUM);
+		for (blkno=0; blkno < vm_nblocks; blkno++)
+		{
+			Buffer		buffer;
+
+			buffer = ReadBufferExtended(rel, VISIBILITYMAP_FORKNUM, blkno,
+										RBM_NORMAL, NULL);
+			LockBuffer(buffer, BUFFER_LOCK_SHARE);
+			vm_lsn = Max(vm_lsn, PageGetLSN(BufferGetPage(buffer)));
+			UnlockReleaseBuffer(buffer);
+		}
+	}
+	memset(ver, 0, sizeof(gpujoinInnerCacheVersion));
+	ver->relid = RelationGetRelid(rel);
+	ver->relfilenode = rel->rd_node.relNode;
+	ver->nblocks = nblocks;
+	ver->vm_lsn = vm_lsn;
+
+	return true;
+}
+
+static bool
+__gpujoinInnerCacheGetVersions(GpuJoinState *gjs,
+							   gpujoinInnerCacheVersion *vers)
+{
+	int			i;
+
+	for (i=0; i < gjs->num_rels; i++)
+	{
+		ScanState  *ss = (ScanState *)gjs->inners[i].state;
+
+		if (!gpujoinInnerCacheGetVersion(ss->ss_currentRelation, &vers[i]))
+			return false;
+	}
+	return true;
+}
+
+/*
+ * gpujoinInnerCacheReleaseEntry
+ */
+static void
+gpujoinInnerCacheReleaseEntry(gpujoinInnerCacheEntry *entry)
+{
+	char		name[200];
+	CUresult	rc;
+
+	rc = gpuMemFreePreserved(entry->cuda_dindex, entry->ipc_mhandle);
+	if (rc != CUDA_SUCCESS)
+		elog(WARNING, "failed on gpuMemFreePreserved: %s", errorText(rc));
+	snprintf(name, sizeof(name), "gpujoin_kmrels.%u.%08x.buf",
+			 PostPortNumber, entry->shmem_handle);
+	if (shm_unlink(name) != 0)
+		elog(WARNING, "failed on shm_unlink('%s'): %m", name);
+}
+
+/*
+ * gpujoinInnerCacheLookup
+ *
+ * It looks up the inner buffer cache. If found, the host and device inner
+ * buffer of the cache entry are attached to the GpuJoinSharedState, and
+ * the inner relations don't need to be scanned.
+ */
+static bool
+gpujoinInnerCacheLookup(GpuJoinState *gjs)
+{
+	GpuJoinSharedState *gj_sstate = gjs->gj_sstate;
+	gpujoinInnerCacheEntry *entry;
+	gpujoinInnerCacheEntry cached;
+	gpujoinInnerCacheEntry victim;
+	bool		has_victim = false;
+	int			cache_index = -1;
+	char		name[200];
+	int			k;
+
+	Assert(gjs->inner_cache_enabled && !gjs->sibling);
+	/* the versions prior to the scan */
+	if (!__gpujoinInnerCacheGetVersions(gjs, gjs->inner_cache_vers))
+	{
+		gjs->inner_cache_enabled = false;
+		return false;
+	}
+
+	SpinLockAcquire(&gj_inner_cache->lock);
+	for (k=0; k < GPUJOIN_INNER_CACHE_NSLOTS; k++)
+	{
+		entry = &gj_inner_cache->entries[k];
+		if (!entry->in_use ||
+			entry->invalid ||
+			entry->key[0] != gjs->inner_cache_key[0] ||
+			entry->key[1] != gjs->inner_cache_key[1])
+			continue;
+		if (entry->nrels == gjs->num_rels &&
+			memcmp(entry->vers, gjs->inner_cache_vers,
+				   sizeof(gpujoinInnerCacheVersion) * gjs->num_rels) == 0)
+		{
+			entry->refcnt++;
+			entry->last_used = ++gj_inner_cache->lru_clock;
+			gj_inner_cache_refs[k]++;
+			memcpy(&cached, entry, sizeof(gpujoinInnerCacheEntry));
+			cache_index = k;
+			break;
+		}
+		/* the cached buffer is already obsolete */
+		entry->invalid = true;
+		if (entry->refcnt == 0)
+		{
+			memcpy(&victim, entry, sizeof(gpujoinInnerCacheEntry));
+			gj_inner_cache->total_usage -= entry->bytesize;
+			entry->in_use = false;
+			has_victim = true;
+		}
+		break;
+	}
+	SpinLockRelease(&gj_inner_cache->lock);
+
+	if (has_victim)
+		gpujoinInnerCacheReleaseEntry(&victim);
+	if (cache_index < 0)
+		return false;
+
+	/* switch the host/device inner buffer to the cached one */
+	snprintf(name, sizeof(name), "gpujoin_kmrels.%u.%08x.buf",
+			 PostPortNumber, gj_sstate->shmem_handle);
+	if (shm_unlink(name) != 0)
+		elog(WARNING, "failed on shm_unlink('%s'): %m", name);
+	gj_sstate->shmem_handle = cached.shmem_handle;
+	gj_sstate->shmem_bytesize = cached.shmem_bytesize;
+	gj_sstate->pergpu[cached.cuda_dindex].bytesize = cached.bytesize;
+	memcpy(&gj_sstate->pergpu[cached.cuda_dindex].ipc_mhandle,
+		   &cached.ipc_mhandle, sizeof(CUipcMemHandle));
+	gj_sstate->inner_cache_index = cache_index;
+	gj_sstate->inner_cache_dindex = cached.cuda_dindex;
+	gj_sstate->inner_cache_hit = true;
+	/* no need to register the inner buffer again */
+	gjs->inner_cache_enabled = false;
+
+	return true;
+}
+
+/*
+ * gpujoinInnerCacheStore
+ *
+ * It registers the host and device inner buffer built by this process to
+ * the inner buffer cache, if the inner relations were not modified during
+ * the scan. Least recently used entries are evicted, if no room.
+ */
+static void
+gpujoinInnerCacheStore(GpuJoinState *gjs)
+{
+	GpuJoinSharedState *gj_sstate = gjs->gj_sstate;
+	gpujoinInnerCacheVersion vers[GPUJOIN_INNER_CACHE_MAX_RELS];
+	gpujoinInnerCacheEntry victims[GPUJOIN_INNER_CACHE_NSLOTS];
+	gpujoinInnerCacheEntry *entry;
+	int			nvictims = 0;
+	int			dindex = gjs->gts.gcontext->cuda_dindex;
+	int			cache_index = -1;
+	size_t		limit = (size_t)gpujoin_inner_cache_size_kb << 10;
+	size_t		bytesize = gj_sstate->pergpu[dindex].bytesize;
+	int			k;
+
+	gjs->inner_cache_enabled = false;
+	if (bytesize == 0 || bytesize > limit ||
+		gj_sstate->inner_cache_index >= 0)
+		return;
+	/* any modification during the scan? */
+	if (!__gpujoinInnerCacheGetVersions(gjs, vers) ||
+		memcmp(vers, gjs->inner_cache_vers,
+			   sizeof(gpujoinInnerCacheVersion) * gjs->num_rels) != 0)
+		return;
+
+	SpinLockAcquire(&gj_inner_cache->lock);
+	for (;;)
+	{
+		gpujoinInnerCacheEntry *lru = NULL;
+
+		if (cache_index < 0)
+		{
+			for (k=0; k < GPUJOIN_INNER_CACHE_NSLOTS; k++)
+			{
+				if (!gj_inner_cache->entries[k].in_use)
+				{
+					cache_index = k;
+					break;
+				}
+			}
+		}
+		if (cache_index >= 0 &&
+			gj_inner_cache->total_usage + bytesize <= limit)
+			break;
+		/* evict the least recently used entry */
+		for (k=0; k < GPUJOIN_INNER_CACHE_NSLOTS; k++)
+		{
+			entry = &gj_inner_cache->entries[k];
+			if (entry->in_use && entry->refcnt == 0 &&
+				(!lru || lru->last_used > entry->last_used))
+				lru = entry;
+		}
+		if (!lru)
+		{
+			cache_index = -1;
+			break;
+		}
+		memcpy(&victims[nvictims++], lru, sizeof(gpujoinInnerCacheEntry));
+		gj_inner_cache->total_usage -= lru->bytesize;
+		lru->in_use = false;
+	}
+
+	if (cache_index >= 0)
+	{
+		entry = &gj_inner_cache->entries[cache_index];
+		memset(entry, 0, sizeof(gpujoinInnerCacheEntry));
+		entry->in_use = true;
+		entry->refcnt = 1;
+		gj_inner_cache_refs[cache_index]++;
+		entry->key[0] = gjs->inner_cache_key[0];
+		entry->key[1] = gjs->inner_cache_key[1];
+		entry->last_used = ++gj_inner_cache->lru_clock;
+		entry->shmem_handle = gj_sstate->shmem_handle;
+		entry->shmem_bytesize = gj_sstate->shmem_bytesize;
+		entry->cuda_dindex = dindex;
+		entry->bytesize = bytesize;
+		memcpy(&entry->ipc_mhandle,
+			   &gj_sstate->pergpu[dindex].ipc_mhandle,
+			   sizeof(CUipcMemHandle));
+		entry->nrels = gjs->num_rels;
+		memcpy(entry->vers, vers,
+			   sizeof(gpujoinInnerCacheVersion) * gjs->num_rels);
+		gj_inner_cache->total_usage += bytesize;
+
+		gj_sstate->inner_cache_index = cache_index;
+		gj_sstate->inner_cache_dindex = dindex;
+		gj_sstate->inner_cache_hit = false;
+	}
+	SpinLockRelease(&gj_inner_cache->lock);
+
+	for (k=0; k < nvictims; k++)
+		gpujoinInnerCacheReleaseEntry(&victims[k]);
+}
+
+/*
+ * gpujoinInnerCacheDetach
+ *
+ * It detaches the inner buffer cache from the GpuJoinSharedState. The host
+ * and device inner buffer are owned by the cache, so callers must not
+ * release them.
+ */
+static void
+gpujoinInnerCacheDetach(GpuJoinSharedState *gj_sstate)
+{
+	gpujoinInnerCacheEntry *entry;
+	gpujoinInnerCacheEntry victim;
+	bool		has_victim = false;
+	int			dindex;
+
+	if (gj_sstate->inner_cache_index < 0)
+		return;
+	entry = &gj_inner_cache->entries[gj_sstate->inner_cache_index];
+	SpinLockAcquire(&gj_inner_cache->lock);
+	/* references might be already released at the transaction abort */
+	if (gj_inner_cache_refs[gj_sstate->inner_cache_index] > 0)
+	{
+		Assert(entry->in_use && entry->refcnt > 0);
+		gj_inner_cache_refs[gj_sstate->inner_cache_index]--;
+		if (--entry->refcnt == 0 && entry->invalid)
+		{
+			memcpy(&victim, entry, sizeof(gpujoinInnerCacheEntry));
+			gj_inner_cache->total_usage -= entry->bytesize;
+			entry->in_use = false;
+			has_victim = true;
+		}
+	}
+	SpinLockRelease(&gj_inner_cache->lock);
+
+	dindex = gj_sstate->inner_cache_dindex;
+	gj_sstate->shmem_handle = UINT_MAX;
+	gj_sstate->pergpu[dindex].bytesize = 0;
+	memset(&gj_sstate->pergpu[dindex].ipc_mhandle, 0, sizeof(CUipcMemHandle));
+	gj_sstate->inner_cache_index = -1;
+
+	if (has_victim)
+		gpujoinInnerCacheReleaseEntry(&victim);
+}
+
+/*
+ * gpujoinInnerCacheXactCallback
+ *
+ * It releases the references to the inner buffer cache, if transaction is
+ * aborted prior to GpuJoinInnerUnload().
+ */
+static void
+gpujoinInnerCacheXactCallback(XactEvent event, void *arg)
+{
+	gpujoinInnerCacheEntry victims[GPUJOIN_INNER_CACHE_NSLOTS];
+	int			nvictims = 0;
+	int			k;
+
+	if (event != XACT_EVENT_ABORT &&
+		event != XACT_EVENT_PARALLEL_ABORT)
+		return;
+	SpinLockAcquire(&gj_inner_cache->lock);
+	for (k=0; k < GPUJOIN_INNER_CACHE_NSLOTS; k++)
+	{
+		gpujoinInnerCacheEntry *entry = &gj_inner_cache->entries[k];
+
+		if (gj_inner_cache_refs[k] == 0)
+			continue;
+		Assert(entry->in_use && entry->refcnt >= gj_inner_cache_refs[k]);
+		entry->refcnt -= gj_inner_cache_refs[k];
+		gj_inner_cache_refs[k] = 0;
+		if (entry->refcnt == 0 && entry->invalid)
+		{
+			memcpy(&victims[nvictims++], entry, sizeof(gpujoinInnerCacheEntry));
+			gj_inner_cache->total_usage -= entry->bytesize;
+			entry->in_use = false;
+		}
+	}
+	SpinLockRelease(&gj_inner_cache->lock);
+
+	for (k=0; k < nvictims; k++)
+		gpujoinInnerCacheReleaseEntry(&victims[k]);
+}
+
+/*
+ * pgstrom_startup_gpujoin
+ */
+static void
+pgstrom_startup_gpujoin(void)
+{
+	bool		found;
+
+	if (shmem_startup_next)
+		(*shmem_startup_next)();
+
+	gj_inner_cache = ShmemInitStruct("GpuJoin Inner Buffer Cache",
+									 MAXALIGN(sizeof(gpujoinInnerCacheHead)),
+									 &found);
+	if (!IsUnderPostmaster)
+	{
+		memset(gj_inner_cache, 0, sizeof(gpujoinInnerCacheHead));
+		SpinLockInit(&gj_inner_cache->lock);
+	}
 }
 
 /*
@@ -8367,8 +10669,11 @@ createGpuJoinSharedState(GpuJoinState *gjs,
 	gj_sstate->phase = INNER_PHASE__SCAN_RELATIONS;
 	gj_sstate->nr_workers_scanning = 0;
 	gj_sstate->nr_workers_setup = 0;
+	pg_atomic_init_u32(&gj_sstate->preload_next_depth, 0);
 	pg_atomic_init_u32(&gj_sstate->outer_scan_done, 0);
 	pg_atomic_init_u32(&gj_sstate->needs_colocation, 0);
+	gj_sstate->inner_cache_index = -1;
+	gj_sstate->inner_cache_dindex = -1;
 
 	gj_rtstat = GPUJOIN_RUNTIME_STAT(gj_sstate);
 	SpinLockInit(&gj_rtstat->c.lock);
@@ -8389,6 +10694,7 @@ cleanupGpuJoinSharedStateOnAbort(dsm_segment *seg, Datum ptr)
 	int			dindex;
 	CUresult	rc;
 
+	gpujoinInnerCacheDetach(gj_sstate);
 	for (dindex=0; dindex < numDevAttrs; dindex++)
 	{
 		if (gj_sstate->pergpu[dindex].bytesize == 0)
@@ -8419,6 +10725,9 @@ cleanupGpuJoinSharedStateOnAbort(dsm_segment *seg, Datum ptr)
 void
 pgstrom_init_gpujoin(void)
 {
+	size_t		shared_buffer_size = (size_t)NBuffers * (size_t)BLCKSZ;
+	size_t		default_max_host_memory = 0;
+
 	/* turn on/off gpunestloop */
 	DefineCustomBoolVariable("pg_strom.enable_gpunestloop",
 							 "Enables the use of GpuNestLoop logic",
@@ -8456,9 +10765,133 @@ pgstrom_init_gpujoin(void)
 							 PGC_USERSET,
                              GUC_NOT_IN_SAMPLE,
                              NULL, NULL, NULL);
+	/* turn on/off GPU affinity of partition wise gpujoin */
+	DefineCustomBoolVariable("pg_strom.enable_partitionwise_gpujoin_affinity",
+							 "Enables to assign GPUs to the partition leafs of GpuJoin in round-robin",
+							 NULL,
+							 &enable_partitionwise_gpujoin_affinity,
+							 true,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
 #else
 	enable_partitionwise_gpujoin = false;
+	enable_partitionwise_gpujoin_affinity = false;
 #endif
+	/* turn on/off partitioned gpuhashjoin */
+	DefineCustomBoolVariable("pg_strom.enable_gpuhashjoin_partition",
+							 "(EXPERIMENTAL) Enables partitioned GpuHashJoin for large inner relation",
+							 NULL,
+							 &enable_gpuhashjoin_partition,
+							 true,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	/* turn on/off Bloom-filter of gpuhashjoin */
+	DefineCustomBoolVariable("pg_strom.enable_gpuhashjoin_bloom",
+							 "Enables Bloom-filter to probe the inner hash table of GpuHashJoin",
+							 NULL,
+							 &enable_gpuhashjoin_bloom,
+							 true,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	/* turn on/off open-addressing hash-buckets of gpuhashjoin */
+	DefineCustomBoolVariable("pg_strom.enable_gpuhashjoin_open_addressing",
+							 "Enables open-addressing hash-buckets to probe the inner hash table of GpuHashJoin",
+							 NULL,
+							 &enable_gpuhashjoin_open_addressing,
+							 true,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	/* turn on/off build of the hash-buckets on the device */
+	DefineCustomBoolVariable("pg_strom.enable_gpuhashjoin_device_build",
+							 "Enables to build Bloom-filter and hash-buckets of GpuHashJoin on the device",
+							 NULL,
+							 &enable_gpuhashjoin_device_build,
+							 true,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	/* threshold of the heavy-hitter keys in the inner hash table */
+	DefineCustomIntVariable("pg_strom.gpuhashjoin_skew_threshold",
+							"Number of inner rows per key to be probed cooperatively as heavy-hitter by GpuHashJoin",
+							"0 disables the cooperative probe",
+							&gpuhashjoin_skew_threshold,
+							4096,
+							0,
+							INT_MAX,
+							PGC_USERSET,
+							GUC_NOT_IN_SAMPLE,
+							NULL, NULL, NULL);
+	/* turn on/off bushy GpuJoin */
+	DefineCustomBoolVariable("pg_strom.enable_gpujoin_bushy",
+							 "Enables GpuJoin to take another GpuJoin as inner relation",
+							 NULL,
+							 &enable_gpujoin_bushy,
+							 true,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	/* turn on/off peer access to the inner buffer on other GPU device */
+	DefineCustomBoolVariable("pg_strom.enable_gpujoin_inner_peer_access",
+							 "Enables GpuJoin to share the inner buffer on other GPU device by peer access",
+							 NULL,
+							 &enable_gpujoin_inner_peer_access,
+							 false,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	/* turn on/off inner buffer cache */
+	DefineCustomBoolVariable("pg_strom.enable_gpujoin_inner_cache",
+							 "Enables GpuJoin to reuse the inner buffer built by the previous queries",
+							 NULL,
+							 &enable_gpujoin_inner_cache,
+							 false,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	/* total size of the inner buffer cache */
+	DefineCustomIntVariable("pg_strom.gpujoin_inner_cache_size",
+							"Total size of the GpuJoin inner buffer cache",
+							NULL,
+							&gpujoin_inner_cache_size_kb,
+							1024 * 1024,	/* default: 1GB */
+							0,				/* min: disabled */
+							INT_MAX,
+							PGC_SIGHUP,
+							GUC_NOT_IN_SAMPLE | GUC_UNIT_KB,
+							NULL, NULL, NULL);
+	/* size of the inner hash partition */
+	DefineCustomIntVariable("pg_strom.gpuhashjoin_partition_size",
+							"Size of inner hash partition of GpuHashJoin",
+							NULL,
+							&gpuhashjoin_partition_size_kb,
+							1024 * 1024,	/* default: 1GB */
+							32 * 1024,		/* min: 32MB */
+							1024 * 1024,	/* max: 1GB */
+							PGC_USERSET,
+							GUC_NOT_IN_SAMPLE | GUC_UNIT_KB,
+							NULL, NULL, NULL);
+	/*
+	 * pg_strom.gpuhashjoin_partition_max_host_memory
+	 *
+	 * Default: half of the system RAM except for the shared buffers.
+	 */
+	if (PAGE_SIZE * PHYS_PAGES > shared_buffer_size)
+		default_max_host_memory = (PAGE_SIZE * PHYS_PAGES -
+								   shared_buffer_size) / 2;
+	DefineCustomIntVariable("pg_strom.gpuhashjoin_partition_max_host_memory",
+							"Max estimated inner size of partitioned GpuHashJoin to be kept on the host memory",
+							NULL,
+							&gpuhashjoin_partition_max_host_memory_kb,
+							Min(default_max_host_memory >> 10, INT_MAX),
+							0,
+							INT_MAX,
+							PGC_USERSET,
+							GUC_NOT_IN_SAMPLE | GUC_UNIT_KB,
+							NULL, NULL, NULL);
 	/* setup path methods */
 	gpujoin_path_methods.CustomName				= "GpuJoin";
 	gpujoin_path_methods.PlanCustomPath			= PlanGpuJoinPath;
@@ -8486,4 +10919,10 @@ pgstrom_init_gpujoin(void)
 	/* hook registration */
 	set_join_pathlist_next = set_join_pathlist_hook;
 	set_join_pathlist_hook = gpujoin_add_join_path;
+
+	/* shared memory for the inner buffer cache */
+	RequestAddinShmemSpace(MAXALIGN(sizeof(gpujoinInnerCacheHead)));
+	shmem_startup_next = shmem_startup_hook;
+	shmem_startup_hook = pgstrom_startup_gpujoin;
+	RegisterXactCallback(gpujoinInnerCacheXactCallback, NULL);
 }
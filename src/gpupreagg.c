@@ -21,9 +21,14 @@ static CustomExecMethods	gpupreagg_exec_methods;
 static bool					enable_gpupreagg;				/* GUC */
 static bool					enable_pullup_outer_join;		/* GUC */
 static bool					enable_partitionwise_gpupreagg;	/* GUC */
+static bool					enable_gpupreagg_distinct;		/* GUC */
 static bool					enable_numeric_aggfuncs; 		/* GUC */
 static double				gpupreagg_reduction_threshold;	/* GUC */
+static double				gpupreagg_local_miss_threshold;	/* GUC */
+static bool					enable_gpupreagg_shared_final;	/* GUC */
+static int					gpupreagg_result_cache_size;	/* GUC */
 int							pgstrom_hll_register_bits;		/* GUC */
+int							pgstrom_quantile_sketch_bits;	/* GUC */
 
 
 typedef struct
@@ -51,6 +56,7 @@ typedef struct
 	cl_uint			extra_flags;
 	cl_uint			extra_bufsz;
 	List		   *used_params;	/* referenced Const/Param */
+	pgstromFeedbackSignature feedback_signature; /* for cardinality feedback */
 } GpuPreAggInfo;
 
 static inline void
@@ -82,6 +88,7 @@ form_gpupreagg_info(CustomScan *cscan, GpuPreAggInfo *gpa_info)
 	privs = lappend(privs, makeInteger(gpa_info->extra_flags));
 	privs = lappend(privs, makeInteger(gpa_info->extra_bufsz));
 	exprs = lappend(exprs, gpa_info->used_params);
+	privs = lappend(privs, pgstromFeedbackSignatureToList(gpa_info->feedback_signature));
 
 	cscan->custom_private = privs;
 	cscan->custom_exprs = exprs;
@@ -119,6 +126,8 @@ deform_gpupreagg_info(CustomScan *cscan)
 	gpa_info->extra_flags = intVal(list_nth(privs, pindex++));
 	gpa_info->extra_bufsz = intVal(list_nth(privs, pindex++));
 	gpa_info->used_params = list_nth(exprs, eindex++);
+	gpa_info->feedback_signature =
+		pgstromFeedbackSignatureFromList(list_nth(privs, pindex++));
 	Assert(pindex == list_length(privs));
 	Assert(eindex == list_length(exprs));
 
@@ -139,6 +148,8 @@ typedef struct
 	cl_int			num_accum_values;	/* __GPUPREAGG_NUM_ACCUM_VALUES */
 	cl_int			accum_extra_bufsz;	/* __GPUPREAGG_ACCUM_EXTRA_BUFSZ */
 	cl_int			local_hash_nrooms;	/* __GPUPREAGG_LOCAL_HASH_NROOMS */
+	pgstromFeedbackSignature feedback_signature; /* for cardinality feedback */
+	bool			final_counted;	/* final buffer is counted on rtstat */
 	TupleTableSlot *part_slot;	/* slot reflects tlist_part (kds_final) */
 	TupleTableSlot *prep_slot;	/* slot reflects tlist_prep (kds_slot) */
 	//TupleTableSlot *gpreagg_slot;	/* Slot reflects tlist_dev (w/o junks) */
@@ -157,22 +168,75 @@ typedef struct
 	size_t			plan_nrows_per_chunk;	/* planned nrows/chunk */
 	size_t			plan_nrows_in;	/* num of outer rows planned */
 	size_t			plan_ngroups;	/* num of groups planned */
+
+	/* adaptive choice of the local reduction */
+	bool			skip_local_reduction;	/* current policy */
+	cl_uint			skip_local_ntasks;		/* # of tasks in global only */
+	uint64			last_local_nitems;		/* local_nitems at last check */
+	uint64			last_local_nmisses;		/* local_nmisses at last check */
+
+	/* shared final buffer of NoGroup reduction on parallel workers */
+	bool			shared_final;	/* true, if registered to the shared one */
+
+	/* result cache of GpuPreAgg on GPU cache */
+	char		   *rcache_key;		/* NULL, if not cacheable */
+	GpuCacheScanVersion rcache_version;
+	struct GpuPreAggResultCache *rcache_hit; /* cached results being replayed */
+	cl_uint			rcache_index;	/* next tuple to be replayed */
+	bool			rcache_saving;	/* true, if results are being saved */
+	List		   *rcache_tuples;	/* results being saved */
+	size_t			rcache_usage;	/* size of the results being saved */
 } GpuPreAggState;
 
+/*
+ * Once the group cardinality turned out to be too large for the local
+ * hash-table, every N-th task still probes the local reduction to see
+ * whether the distribution of the grouping keys gets changed.
+ */
+#define GPUPREAGG_LOCAL_REDUCTION_PROBE_INTERVAL	16
+
 struct GpuPreAggRuntimeStat
 {
 	GpuTaskRuntimeStat	c;		/* common statistics */
+	pg_atomic_uint64	local_nitems;	/* # of rows tried local hash */
+	pg_atomic_uint64	local_nmisses;	/* # of rows missed local hash */
+	pg_atomic_uint64	global_only_ntasks; /* # of tasks by global only */
+	pg_atomic_uint64	final_nitems;	/* # of rows in the final buffers */
+	pg_atomic_uint64	final_nprocs;	/* # of processes returned them */
 };
 typedef struct GpuPreAggRuntimeStat	GpuPreAggRuntimeStat;
 
+/*
+ * NoGroup reduction on the parallel workers merges its own final buffer into
+ * the device memory shared by the workers on the same GPU device, then the
+ * last worker returns the merged result only. It allows to skip the merge
+ * of partial aggregation by every worker on the Finalize Aggregate.
+ */
+#define SHARED_FINAL__NONE			0
+#define SHARED_FINAL__ALLOCATING	1
+#define SHARED_FINAL__READY			2
+
 struct GpuPreAggSharedState
 {
 	dsm_handle		ss_handle;	/* DSM handle of the SharedState */
 	cl_uint			ss_length;	/* Length of the SharedState */
 	GpuPreAggRuntimeStat gpa_rtstat;	/* Run-time statistics */
+	ConditionVariable f_cond;	/* synchronization of the shared final */
+	slock_t			f_mutex;	/* mutex for the pergpu[] below */
+	struct {
+		int			phase;		/* one of SHARED_FINAL__* above */
+		int			nr_workers_active;	/* # of workers registered */
+		int			nr_workers_merged;	/* # of workers merged */
+		bool		emitted;	/* true, if merged result is returned */
+		size_t		bytesize;	/* not zero, if allocated */
+		CUipcMemHandle ipc_mhandle;	/* IPC handle of preserved memory */
+	} pergpu[FLEXIBLE_ARRAY_MEMBER];
 };
 typedef struct GpuPreAggSharedState	GpuPreAggSharedState;
 
+#define GPUPREAGG_SHARED_STATE_LENGTH()							\
+	MAXALIGN(offsetof(GpuPreAggSharedState, pergpu[numDevAttrs]))
+
 /*
  * GpuPreAggTask
  *
@@ -215,6 +279,7 @@ static bool		gpupreagg_build_path_target(PlannerInfo *root,
 											Path       *input_path,
 											Node      **p_havingQual,
 											bool       *p_can_pullup_outerscan,
+											double     *p_num_partial_groups,
 											AggClauseCosts *p_final_clause_costs);
 static void		gpupreagg_codegen(PlannerInfo *root,
 								  RelOptInfo *baserel,
@@ -232,6 +297,7 @@ static GpuTask *gpupreagg_terminator_task(GpuTaskState *gts,
 										  cl_bool *task_is_ready);
 static int  gpupreagg_process_task(GpuTask *gtask, CUmodule cuda_module);
 static void gpupreagg_release_task(GpuTask *gtask);
+static bool gpupreagg_begin_exec(GpuTaskState *gts);
 static TupleTableSlot *gpupreagg_next_tuple(GpuTaskState *gts);
 
 /*
@@ -248,6 +314,8 @@ static TupleTableSlot *gpupreagg_next_tuple(GpuTaskState *gts);
 #define ALTFUNC_EXPR_PCOV_Y2		109	/* PCOV_Y2(X,Y) */
 #define ALTFUNC_EXPR_PCOV_XY		110	/* PCOV_XY(X,Y) */
 #define ALTFUNC_EXPR_HLL_HASH		111	/* HLL_HASH(X) */
+#define ALTFUNC_EXPR_QSKETCH_KEY	112	/* QUANTILE_SKETCH_KEY(X) */
+#define ALTFUNC_EXPR_NUMERIC_FIXED	113	/* PSUM_NUMERIC_FIXED(X) */
 
 /*
  * XXX - GpuPreAgg with Numeric arguments are problematic because
@@ -274,6 +342,18 @@ __aggfunc_property_extra_sz__hll_count(void)
 	return MAXALIGN(VARHDRSZ + (1U << pgstrom_hll_register_bits));
 }
 
+static size_t
+__aggfunc_property_extra_sz__quantile_sketch(void)
+{
+	return MAXALIGN(QUANTILE_SKETCH_LENGTH(pgstrom_quantile_sketch_bits));
+}
+
+static size_t
+__aggfunc_property_extra_sz__numeric_fixed(void)
+{
+	return MAXALIGN(sizeof(kern_numeric_fixed));
+}
+
 /*
  * List of supported aggregate functions
  */
@@ -319,6 +399,12 @@ static aggfunc_catalog_t  aggfunc_catalog[] = {
 	  {ALTFUNC_EXPR_NROWS, ALTFUNC_EXPR_PSUM},
 	  NULL, 0, false
 	},
+	{ "avg",    1, {FLOAT2OID},
+	  "s:favg",     FLOAT8ARRAYOID,
+	  "s:pavg", 2, {INT8OID, FLOAT8OID},
+	  {ALTFUNC_EXPR_NROWS, ALTFUNC_EXPR_PSUM},
+	  NULL, 0, false
+	},
 	{ "avg",    1, {FLOAT4OID},
 	  "s:favg",     FLOAT8ARRAYOID,
 	  "s:pavg", 2, {INT8OID, FLOAT8OID},
@@ -332,6 +418,16 @@ static aggfunc_catalog_t  aggfunc_catalog[] = {
 	  NULL, 0, false
 	},
 #ifdef GPUPREAGG_SUPPORT_NUMERIC
+	/*
+	 * AVG(X) = EX_AVG_FIXED(PSUM_NUMERIC_FIXED(X)), if X has declared
+	 * precision and scale; elsewhere, it is calculated using float8.
+	 */
+	{ "avg",	1, {NUMERICOID},
+	  "s:favg_numeric_fixed", BYTEAOID,
+	  "varref", 1, {BYTEAOID},
+	  {ALTFUNC_EXPR_NUMERIC_FIXED},
+	  __aggfunc_property_extra_sz__numeric_fixed, 0, true
+	},
 	{ "avg",	1, {NUMERICOID},
 	  "s:favg_numeric", FLOAT8ARRAYOID,
 	  "s:pavg", 2, {INT8OID, FLOAT8OID},
@@ -540,6 +636,14 @@ static aggfunc_catalog_t  aggfunc_catalog[] = {
       __aggfunc_property_extra_sz__hll_count,
       0, false
     },
+	/* QUANTILE_SKETCH(X) = QUANTILE_COMBINE(QUANTILE_SKETCH_NEW(KEY(X))) */
+	{ "quantile_sketch", 1, {FLOAT8OID},
+	  "c:quantile_combine", BYTEAOID,
+	  "s:quantile_sketch_new", 1, {INT4OID},
+	  {ALTFUNC_EXPR_QSKETCH_KEY},
+	  __aggfunc_property_extra_sz__quantile_sketch,
+	  0, false
+	},
 	/* MAX(X) = MAX(PMAX(X)) */
 	{ "max",    1, {INT2OID},
 	  "s:fmax_int2", INT4OID,
@@ -698,6 +802,13 @@ static aggfunc_catalog_t  aggfunc_catalog[] = {
 	  {ALTFUNC_EXPR_PSUM},
 	  NULL, 0, false
 	},
+	/* SUM(float2) is accumulated by float8, not half-precision */
+	{ "sum",    1, {FLOAT2OID},
+	  "c:sum",      FLOAT8OID,
+	  "varref", 1, {FLOAT8OID},
+	  {ALTFUNC_EXPR_PSUM},
+	  NULL, 0, false
+	},
 	{ "sum",    1, {FLOAT4OID},
 	  "c:sum",      FLOAT4OID,
 	  "varref", 1, {FLOAT4OID},
@@ -711,6 +822,13 @@ static aggfunc_catalog_t  aggfunc_catalog[] = {
 	  NULL, 0, false
 	},
 #ifdef GPUPREAGG_SUPPORT_NUMERIC
+	/* SUM(X) = EX_SUM_FIXED(PSUM_NUMERIC_FIXED(X)), if X has typmod */
+	{ "sum",    1, {NUMERICOID},
+	  "s:fsum_numeric_fixed", BYTEAOID,
+	  "varref", 1, {BYTEAOID},
+	  {ALTFUNC_EXPR_NUMERIC_FIXED},
+	  __aggfunc_property_extra_sz__numeric_fixed, 0, true
+	},
 	{ "sum",    1, {NUMERICOID},
 	  "s:fsum_numeric", FLOAT8OID,
 	  "varref", 1, {FLOAT8OID},
@@ -749,6 +867,14 @@ static aggfunc_catalog_t  aggfunc_catalog[] = {
 	   ALTFUNC_EXPR_PSUM_X2},
 	  NULL, 0, false
 	},
+	{ "stddev",      1, {FLOAT2OID},
+	  "s:stddev",        FLOAT8ARRAYOID,
+	  "s:pvariance", 3, {INT8OID, FLOAT8OID, FLOAT8OID},
+	  {ALTFUNC_EXPR_NROWS,
+	   ALTFUNC_EXPR_PSUM,
+	   ALTFUNC_EXPR_PSUM_X2},
+	  NULL, 0, false
+	},
 	{ "stddev",      1, {FLOAT4OID},
 	  "s:stddev",        FLOAT8ARRAYOID,
 	  "s:pvariance", 3, {INT8OID, FLOAT8OID, FLOAT8OID},
@@ -800,6 +926,14 @@ static aggfunc_catalog_t  aggfunc_catalog[] = {
 	   ALTFUNC_EXPR_PSUM_X2},
 	  NULL, 0, false
 	},
+	{ "stddev_pop",  1, {FLOAT2OID},
+	  "s:stddev_pop",    FLOAT8ARRAYOID,
+	  "s:pvariance", 3, {INT8OID, FLOAT8OID, FLOAT8OID},
+	  {ALTFUNC_EXPR_NROWS,
+	   ALTFUNC_EXPR_PSUM,
+	   ALTFUNC_EXPR_PSUM_X2},
+	  NULL, 0, false
+	},
 	{ "stddev_pop",  1, {FLOAT4OID},
 	  "s:stddev_pop",    FLOAT8ARRAYOID,
 	  "s:pvariance", 3, {INT8OID, FLOAT8OID, FLOAT8OID},
@@ -851,6 +985,14 @@ static aggfunc_catalog_t  aggfunc_catalog[] = {
 	   ALTFUNC_EXPR_PSUM_X2},
 	  NULL, 0, false
 	},
+	{ "stddev_samp", 1, {FLOAT2OID},
+	  "s:stddev_samp",   FLOAT8ARRAYOID,
+	  "s:pvariance", 3, {INT8OID, FLOAT8OID, FLOAT8OID},
+	  {ALTFUNC_EXPR_NROWS,
+	   ALTFUNC_EXPR_PSUM,
+	   ALTFUNC_EXPR_PSUM_X2},
+	  NULL, 0, false
+	},
 	{ "stddev_samp", 1, {FLOAT4OID},
 	  "s:stddev_samp",   FLOAT8ARRAYOID,
 	  "s:pvariance", 3, {INT8OID, FLOAT8OID, FLOAT8OID},
@@ -902,6 +1044,14 @@ static aggfunc_catalog_t  aggfunc_catalog[] = {
 	   ALTFUNC_EXPR_PSUM_X2},
 	  NULL, 0, false
 	},
+	{ "variance",    1, {FLOAT2OID},
+	  "s:variance",      FLOAT8ARRAYOID,
+	  "s:pvariance", 3, {INT8OID, FLOAT8OID, FLOAT8OID},
+	  {ALTFUNC_EXPR_NROWS,
+	   ALTFUNC_EXPR_PSUM,
+	   ALTFUNC_EXPR_PSUM_X2},
+	  NULL, 0, false
+	},
 	{ "variance",    1, {FLOAT4OID},
 	  "s:variance",      FLOAT8ARRAYOID,
 	  "s:pvariance", 3, {INT8OID, FLOAT8OID, FLOAT8OID},
@@ -953,6 +1103,14 @@ static aggfunc_catalog_t  aggfunc_catalog[] = {
 	   ALTFUNC_EXPR_PSUM_X2},
 	  NULL, 0, false
 	},
+	{ "var_pop",     1, {FLOAT2OID},
+	  "s:var_pop",       FLOAT8ARRAYOID,
+	  "s:pvariance", 3, {INT8OID, FLOAT8OID, FLOAT8OID},
+	  {ALTFUNC_EXPR_NROWS,
+	   ALTFUNC_EXPR_PSUM,
+	   ALTFUNC_EXPR_PSUM_X2},
+	  NULL, 0, false
+	},
 	{ "var_pop",     1, {FLOAT4OID},
 	  "s:var_pop",       FLOAT8ARRAYOID,
 	  "s:pvariance", 3, {INT8OID, FLOAT8OID, FLOAT8OID},
@@ -1004,6 +1162,14 @@ static aggfunc_catalog_t  aggfunc_catalog[] = {
 	   ALTFUNC_EXPR_PSUM_X2},
 	  NULL, 0, false
 	},
+	{ "var_samp",    1, {FLOAT2OID},
+	  "s:var_samp",      FLOAT8ARRAYOID,
+	  "s:pvariance", 3, {INT8OID, FLOAT8OID, FLOAT8OID},
+	  {ALTFUNC_EXPR_NROWS,
+	   ALTFUNC_EXPR_PSUM,
+	   ALTFUNC_EXPR_PSUM_X2},
+	  NULL, 0, false
+	},
 	{ "var_samp",    1, {FLOAT4OID},
 	  "s:var_samp",      FLOAT8ARRAYOID,
 	  "s:pvariance", 3, {INT8OID, FLOAT8OID, FLOAT8OID},
@@ -1181,9 +1347,40 @@ static aggfunc_catalog_t  aggfunc_catalog[] = {
 	},
 };
 
+/*
+ * aggref_numeric_fixed_scale
+ *
+ * It returns the scale of fixed-point accumulator for the numeric argument
+ * of the supplied Aggref, or -1 if its precision and scale are unknown or
+ * too large to represent each value using 64bit integer.
+ */
+static int
+aggref_numeric_fixed_scale(Aggref *aggref)
+{
+	TargetEntry *tle;
+	int32		typmod;
+	int			precision;
+	int			scale;
+
+	if (list_length(aggref->args) != 1)
+		return -1;
+	tle = linitial(aggref->args);
+	if (exprType((Node *)tle->expr) != NUMERICOID)
+		return -1;
+	typmod = exprTypmod((Node *)tle->expr);
+	if (typmod < (int32) VARHDRSZ)
+		return -1;
+	precision = ((typmod - VARHDRSZ) >> 16) & 0xffff;
+	scale = (typmod - VARHDRSZ) & 0xffff;
+	if (precision > NUMERIC_FIXED_MAX_PRECISION || scale > precision)
+		return -1;
+	return scale;
+}
+
 static const aggfunc_catalog_t *
-aggfunc_lookup_by_oid(Oid aggfnoid)
+aggfunc_lookup_by_aggref(Aggref *aggref)
 {
+	Oid				aggfnoid = aggref->aggfnoid;
 	Form_pg_proc	proc;
 	HeapTuple		htup;
 	int				i;
@@ -1207,6 +1404,11 @@ aggfunc_lookup_by_oid(Oid aggfnoid)
 				/* Is NUMERIC with GpuPreAgg acceptable? */
 				if (catalog->numeric_aware && !enable_numeric_aggfuncs)
 					continue;
+				/* Is fixed-point accumulator available? */
+				if (catalog->partfn_nargs > 0 &&
+					catalog->partfn_argexprs[0] == ALTFUNC_EXPR_NUMERIC_FIXED &&
+					aggref_numeric_fixed_scale(aggref) < 0)
+					continue;
 				/* all ok */
 				ReleaseSysCache(htup);
 				return catalog;
@@ -1234,7 +1436,7 @@ cost_gpupreagg(PlannerInfo *root,
 			   List *index_quals,
 			   cl_long index_nblocks)
 {
-	double		gpu_cpu_ratio = pgstrom_gpu_operator_cost / cpu_operator_cost;
+	double		gpu_cpu_ratio = pgstrom_device_operator_cost() / cpu_operator_cost;
 	Cost		startup_cost;
 	Cost		run_cost;
 	int			num_group_keys = 0;
@@ -1314,9 +1516,23 @@ cost_gpupreagg(PlannerInfo *root,
 	}
 	if (num_group_keys == 0)
 		num_groups = 1.0;	/* AGG_PLAIN */
+	else
+	{
+		/*
+		 * The final buffer must be kept on the device memory; so we give up
+		 * GpuPreAgg if it cannot fit the free device memory under the
+		 * current load.
+		 */
+		double	final_sz = (num_groups *
+							MAXALIGN(offsetof(HeapTupleHeaderData,
+											  t_bits[BITMAPLEN(ncols)]) +
+									 target_partial->width));
+		if (final_sz > (double)gpuMemAvailableForPlanning(gpa_info->optimal_gpus))
+			return false;
+	}
 
 	/* Cost estimation for grouping */
-	startup_cost += (pgstrom_gpu_operator_cost *
+	startup_cost += (pgstrom_device_operator_cost() *
 					 num_group_keys *
 					 input_path->rows);
 	/* Cost estimation for aggregate function */
@@ -1365,6 +1581,28 @@ estimate_hashagg_tablesize(PlannerInfo *root, Path *path,
 	estimate_hashagg_tablesize((b),(c),(d))
 #endif
 
+/*
+ * gpupreagg_feedback_signature
+ *
+ * signature of the cardinality feedback; by the input relations and
+ * the grouping keys
+ */
+static pgstromFeedbackSignature
+gpupreagg_feedback_signature(PlannerInfo *root, Path *input_path)
+{
+	Query	   *parse = root->parse;
+	List	   *group_exprs;
+
+	/* SELECT DISTINCT without GROUP BY, if no groupClause */
+	group_exprs = get_sortgrouplist_exprs(parse->groupClause
+										  ? parse->groupClause
+										  : parse->distinctClause,
+										  parse->targetList);
+	return pgstromCardinalityFeedbackSignature(root,
+											   input_path->parent->relids,
+											   group_exprs);
+}
+
 /*
  * make_gpupreagg_path
  *
@@ -1411,7 +1649,9 @@ make_gpupreagg_path(PlannerInfo *root,
 	/* Number of workers if parallel */
 	if (group_rel->consider_parallel &&
 		input_path->parallel_safe)
-		parallel_nworkers = input_path->parallel_workers;
+		parallel_nworkers = pgstrom_gpu_parallel_workers(root,
+														 input_path->parent,
+														 input_path->parallel_workers);
 
 	/* cost estimation */
 	if (!cost_gpupreagg(root,
@@ -1428,6 +1668,8 @@ make_gpupreagg_path(PlannerInfo *root,
 		pfree(cpath);
 		return NULL;
 	}
+	gpa_info->feedback_signature = gpupreagg_feedback_signature(root,
+																input_path);
 	/* BRIN-index options */
 	gpa_info->index_oid = (index_opt ? index_opt->indexoid : InvalidOid);
 	gpa_info->index_conds = index_conds;
@@ -1555,6 +1797,11 @@ try_add_final_aggregation_paths(PlannerInfo *root,
 	can_sort = grouping_is_sortable(parse->groupClause);
 	can_hash = (parse->groupClause != NIL &&
 				parse->groupingSets == NIL &&
+#if PG_VERSION_NUM < 140000
+				final_clause_costs->numOrderedAggs == 0 &&
+#else
+				root->numOrderedAggs == 0 &&
+#endif
 				grouping_is_hashable(parse->groupClause));
 
 	/* make a final grouping path (nogroup) */
@@ -1616,7 +1863,7 @@ try_add_final_aggregation_paths(PlannerInfo *root,
 					create_groupingsets_path(root,
 											 group_rel,
 											 sort_path,
-											 (List *) parse->havingQual,
+											 havingQuals,
 											 rollup_strategy,
 											 rollup_data_list,
 											 final_clause_costs,
@@ -1677,7 +1924,13 @@ try_add_final_aggregation_paths(PlannerInfo *root,
 											 partial_path,
 											 final_clause_costs,
 											 num_groups);
-			if (hashaggtablesize < work_mem * 1024L)
+			/*
+			 * PG13 or later, HashAgg can spill the hash partitions to disk,
+			 * and merges them at the end, so we don't need to give up the
+			 * final hashed aggregation even if it exceeds work_mem.
+			 */
+			if (PG_VERSION_NUM >= 130000 ||
+				hashaggtablesize < work_mem * 1024L)
 			{
 				final_path = (Path *)
 					create_agg_path(root,
@@ -1708,6 +1961,7 @@ try_add_gpupreagg_append_paths(PlannerInfo *root,
 							   Path *input_path,
 							   List *havingQual,
 							   double num_groups,
+							   double num_partial_groups,
 							   AggClauseCosts *agg_final_costs,
 							   bool can_pullup_outerscan,
 							   bool try_outer_parallel)
@@ -1757,7 +2011,7 @@ retry:
 											  group_rel,
 											  curr_partial,
 											  sub_path,
-											  num_groups,
+											  num_partial_groups,
 											  can_pullup_outerscan,
 											  false);
 		if (!partial_path)
@@ -1839,7 +2093,10 @@ try_add_gpupreagg_paths(PlannerInfo *root,
 	Path		   *partial_path;
 	Node		   *havingQual;
 	double			num_groups;
+	double			num_partial_groups;
 	double			reduction_ratio;
+	double			fb_nrows_in;
+	double			fb_nrows_out;
 	bool			can_pullup_outerscan = true;
 	AggClauseCosts	final_clause_costs;
 
@@ -1862,11 +2119,50 @@ try_add_gpupreagg_paths(PlannerInfo *root,
 
 		num_groups = Max(pathnode->rows, 1.0);
 	}
-	reduction_ratio = input_path->rows / num_groups;
+
+	/*
+	 * In case of GROUPING SETS, ROLLUP or CUBE, GpuPreAgg runs partial
+	 * aggregation by the union of grouping-keys of all the grouping-sets
+	 * in a single pass, then the final GroupingSets node rolls up the
+	 * partial results for each level. So, number of the partial groups
+	 * is not a total number of groups in the grouping-sets.
+	 */
+	num_partial_groups = num_groups;
+	if (parse->groupingSets)
+	{
+		List   *group_exprs = get_sortgrouplist_exprs(parse->groupClause,
+													  parse->targetList);
+		num_partial_groups = estimate_num_groups(root,
+												 group_exprs,
+												 input_path->rows,
+#if PG_VERSION_NUM < 140000
+												 NULL);
+#else
+												 NULL, NULL);
+#endif
+	}
+
+	/*
+	 * If an earlier execution of the same query shape recorded the number
+	 * of groups, it replaces the estimation. It is the total number of
+	 * partial groups by all the processes, so exact unless parallel
+	 * execution; an upper bound of the groups elsewhere.
+	 */
+	if (parse->groupClause &&
+		pgstromLookupCardinalityFeedback(gpupreagg_feedback_signature(root,
+																	  input_path),
+										 &fb_nrows_in,
+										 &fb_nrows_out))
+	{
+		num_partial_groups = clamp_row_est(fb_nrows_out);
+		if (!parse->groupingSets)
+			num_groups = num_partial_groups;
+	}
+	reduction_ratio = input_path->rows / num_partial_groups;
 	if (reduction_ratio < gpupreagg_reduction_threshold)
 	{
 		elog(DEBUG2, "GpuPreAgg: %.0f -> %.0f reduction ratio (%.2f) is bad",
-			 input_path->rows, num_groups, reduction_ratio);
+			 input_path->rows, num_partial_groups, reduction_ratio);
 		return;
 	}
 
@@ -1878,8 +2174,19 @@ try_add_gpupreagg_paths(PlannerInfo *root,
 									 input_path,
 									 &havingQual,
 									 &can_pullup_outerscan,
+									 &num_partial_groups,
 									 &final_clause_costs))
 		return;
+	if (input_path->rows / num_partial_groups < reduction_ratio)
+	{
+		reduction_ratio = input_path->rows / num_partial_groups;
+		if (reduction_ratio < gpupreagg_reduction_threshold)
+		{
+			elog(DEBUG2, "GpuPreAgg: %.0f -> %.0f reduction ratio (%.2f) by DISTINCT keys is bad",
+				 input_path->rows, num_partial_groups, reduction_ratio);
+			return;
+		}
+	}
 
 	if (enable_partitionwise_gpupreagg)
 		try_add_gpupreagg_append_paths(root,
@@ -1889,6 +2196,7 @@ try_add_gpupreagg_paths(PlannerInfo *root,
 									   input_path,
 									   (List *) havingQual,
 									   num_groups,
+									   num_partial_groups,
 									   &final_clause_costs,
 									   can_pullup_outerscan,
 									   try_parallel_path);
@@ -1897,7 +2205,7 @@ try_add_gpupreagg_paths(PlannerInfo *root,
 										  group_rel,
 										  target_partial,
 										  input_path,
-										  num_groups,
+										  num_partial_groups,
 										  can_pullup_outerscan,
 										  try_parallel_path);
 	if (!partial_path ||
@@ -1913,6 +2221,171 @@ try_add_gpupreagg_paths(PlannerInfo *root,
 									&final_clause_costs);
 }
 
+/*
+ * try_add_gpupreagg_distinct_paths
+ *
+ * SELECT DISTINCT without aggregation is a GpuPreAgg that has only
+ * grouping-keys. It removes the duplicated rows on the device for each
+ * process, then Unique or HashAgg removes the rest across the processes.
+ */
+static void
+try_add_gpupreagg_distinct_paths(PlannerInfo *root,
+								 RelOptInfo *distinct_rel,
+								 Path *input_path,
+								 bool try_parallel_path)
+{
+	Query		   *parse = root->parse;
+	PathTarget	   *target_input = input_path->pathtarget;
+	PathTarget	   *target_partial = create_empty_pathtarget();
+	List		   *distinct_exprs = NIL;
+	Path		   *partial_path;
+	Path		   *final_path;
+	double			num_groups;
+	double			reduction_ratio;
+	double			fb_nrows_in;
+	double			fb_nrows_out;
+	bool			can_pullup_outerscan = true;
+	ListCell	   *lc;
+	int				i = 0;
+
+	foreach (lc, target_input->exprs)
+	{
+		Expr		   *expr = lfirst(lc);
+		Index			sortgroupref = get_pathtarget_sortgroupref(target_input, i++);
+		devtype_info   *dtype;
+
+		/* all the columns must be DISTINCT keys (no resjunk) */
+		if (!sortgroupref ||
+			!get_sortgroupref_clause_noerr(sortgroupref,
+										   parse->distinctClause))
+			return;
+		/*
+		 * Type of the DISTINCT key must have device equality-function,
+		 * like the grouping-keys
+		 */
+		dtype = pgstrom_devtype_lookup(exprType((Node *)expr));
+		if (!dtype || !dtype->hash_func ||
+			!pgstrom_devfunc_lookup_type_equal(dtype,
+											   exprCollation((Node *)expr)))
+		{
+			elog(DEBUG2, "DISTINCT contains unsupported type (%s): %s",
+				 format_type_be(exprType((Node *)expr)),
+				 nodeToString(expr));
+			pgstrom_record_offload_blocker("GpuPreAgg: DISTINCT contains unsupported type: %s",
+										   format_type_be(exprType((Node *)expr)));
+			return;
+		}
+		if (!pgstrom_device_expression(root, input_path->parent, expr))
+			can_pullup_outerscan = false;
+		add_column_to_pathtarget(target_partial, expr, sortgroupref);
+		distinct_exprs = lappend(distinct_exprs, expr);
+	}
+	set_pathtarget_cost_width(root, target_partial);
+
+	num_groups = estimate_num_groups(root,
+									 distinct_exprs,
+									 input_path->rows,
+#if PG_VERSION_NUM < 140000
+									 NULL);
+#else
+									 NULL, NULL);
+#endif
+	if (pgstromLookupCardinalityFeedback(gpupreagg_feedback_signature(root,
+																	  input_path),
+										 &fb_nrows_in,
+										 &fb_nrows_out))
+		num_groups = clamp_row_est(fb_nrows_out);
+	reduction_ratio = input_path->rows / num_groups;
+	if (reduction_ratio < gpupreagg_reduction_threshold)
+	{
+		elog(DEBUG2, "GpuPreAgg: %.0f -> %.0f reduction ratio (%.2f) by DISTINCT is bad",
+			 input_path->rows, num_groups, reduction_ratio);
+		return;
+	}
+
+	partial_path = prepend_gpupreagg_path(root,
+										  distinct_rel,
+										  target_partial,
+										  input_path,
+										  num_groups,
+										  can_pullup_outerscan,
+										  try_parallel_path);
+	if (!partial_path ||
+		(try_parallel_path && !IsA(partial_path, GatherPath)))
+		return;
+
+	/* Sort + Unique */
+	if (grouping_is_sortable(parse->distinctClause))
+	{
+		final_path = (Path *)
+			create_sort_path(root,
+							 distinct_rel,
+							 partial_path,
+							 root->distinct_pathkeys,
+							 -1.0);
+		final_path = (Path *)
+			create_upper_unique_path(root,
+									 distinct_rel,
+									 final_path,
+									 list_length(root->distinct_pathkeys),
+									 num_groups);
+		add_path(distinct_rel, final_path);
+	}
+	/* HashAgg */
+	if (enable_hashagg && grouping_is_hashable(parse->distinctClause))
+	{
+		final_path = (Path *)
+			create_agg_path(root,
+							distinct_rel,
+							partial_path,
+							partial_path->pathtarget,
+							AGG_HASHED,
+							AGGSPLIT_SIMPLE,
+							parse->distinctClause,
+							NIL,
+							NULL,
+							num_groups);
+		add_path(distinct_rel, final_path);
+	}
+}
+
+/*
+ * gpupreagg_add_distinct_paths
+ */
+static void
+gpupreagg_add_distinct_paths(PlannerInfo *root,
+							 RelOptInfo *input_rel,
+							 RelOptInfo *distinct_rel)
+{
+	Query	   *parse = root->parse;
+	ListCell   *lc;
+
+	/*
+	 * Only plain SELECT DISTINCT; other cases are already reduced by
+	 * the grouping stage, or DISTINCT ON needs the first row of groups.
+	 */
+	if (!parse->distinctClause ||
+		parse->hasDistinctOn ||
+		parse->hasAggs ||
+		parse->groupClause ||
+		parse->groupingSets ||
+		root->hasHavingQual ||
+		parse->hasWindowFuncs ||
+		parse->hasTargetSRFs)
+		return;
+
+	try_add_gpupreagg_distinct_paths(root, distinct_rel,
+									 input_rel->cheapest_total_path,
+									 false);
+	if (distinct_rel->consider_parallel)
+	{
+		foreach (lc, input_rel->partial_pathlist)
+			try_add_gpupreagg_distinct_paths(root, distinct_rel,
+											 lfirst(lc),
+											 true);
+	}
+}
+
 /*
  * gpupreagg_add_grouping_paths
  *
@@ -1931,7 +2404,8 @@ gpupreagg_add_grouping_paths(PlannerInfo *root,
 	if (create_upper_paths_next)
 		(*create_upper_paths_next)(root, stage, input_rel, group_rel, extra);
 
-	if (stage != UPPERREL_GROUP_AGG)
+	if (stage != UPPERREL_GROUP_AGG &&
+		stage != UPPERREL_DISTINCT)
 		return;
 
 	if (!pgstrom_enabled || !enable_gpupreagg)
@@ -1941,6 +2415,13 @@ gpupreagg_add_grouping_paths(PlannerInfo *root,
 	if (get_namespace_oid("pgstrom", true) == InvalidOid)
 		return;
 
+	if (stage == UPPERREL_DISTINCT)
+	{
+		if (enable_gpupreagg_distinct)
+			gpupreagg_add_distinct_paths(root, input_rel, group_rel);
+		return;
+	}
+
 	/* traditional GpuPreAgg + Agg path consideration */
 	input_path = input_rel->cheapest_total_path;
 	try_add_gpupreagg_paths(root, group_rel, input_path, false);
@@ -2047,6 +2528,16 @@ is_altfunc_expression(Node *node, int *p_extra_sz)
 			extra_sz = __aggfunc_property_extra_sz__hll_count();
 			retval = true;
 		}
+		else if (strcmp(NameStr(form_proc->proname), "quantile_sketch_new") == 0)
+		{
+			extra_sz = __aggfunc_property_extra_sz__quantile_sketch();
+			retval = true;
+		}
+		else if (strcmp(NameStr(form_proc->proname), "psum_numeric_fixed") == 0)
+		{
+			extra_sz = __aggfunc_property_extra_sz__numeric_fixed();
+			retval = true;
+		}
 	}
 	ReleaseSysCache(tuple);
 
@@ -2398,57 +2889,169 @@ make_altfunc_hll_hash(Aggref *aggref)
 }
 
 /*
- * __update_aggfunc_clause_cost
+ * make_altfunc_quantile_sketch_key - bucket-key of the quantile sketch
  */
-static void
-__update_aggfunc_clause_cost(PlannerInfo *root,
-							 Aggref *aggref_alt,
-							 Form_pg_aggregate agg_form,
-							 const aggfunc_catalog_t *aggfn_cat,
-							 AggClauseCosts *final_costs)
+static FuncExpr *
+make_altfunc_quantile_sketch_key(Aggref *aggref)
 {
-#if PG_VERSION_NUM < 140000
-	get_agg_clause_costs(root,
-						 (Node *)aggref_alt,
-						 AGGSPLIT_SIMPLE,
-						 final_costs);
-#else
-	/*
-	 * MEMO: PG14 revised get_agg_clause_costs() to calculate
-	 * the cost of aggregate functions that are tracked on
-	 * the PlannerInfo; thus, not alternative once replaced
-	 * by GpuPreAgg. So, we put simplified logic to calculate
-	 * per-tuple cost of the alternative functions.
-	 */
-	if (OidIsValid(agg_form->aggtransfn))
-		add_function_cost(root, agg_form->aggtransfn, NULL,
-						  &final_costs->transCost);
-	if (OidIsValid(agg_form->aggfinalfn))
-		add_function_cost(root, agg_form->aggfinalfn, NULL,
-						  &final_costs->finalCost);
-	if (aggfn_cat->partfn_extra_sz)
-		final_costs->transitionSpace += aggfn_cat->partfn_extra_sz();
-#endif
-}
+	TargetEntry	   *tle;
+	Oid				type_oid = FLOAT8OID;
+	Oid				func_oid;
+	FuncExpr	   *func = NULL;
 
-/*
- * make_alternative_aggref
- *
- * It makes an alternative final aggregate function towards the supplied
- * Aggref, and append its arguments on the target_partial/target_device.
- */
-static Node *
-make_alternative_aggref(PlannerInfo *root,
-						Aggref *aggref,
-						PathTarget *target_partial,
-						PathTarget *target_input,
-						RelOptInfo *input_rel,
-						AggClauseCosts *final_clause_costs)
-{
-	const aggfunc_catalog_t *aggfn_cat;
-	Aggref	   *aggref_new;
-	List	   *altfunc_args = NIL;
-	Expr	   *expr_host;
+	Assert(list_length(aggref->args) == 1);
+	tle = linitial(aggref->args);
+	Assert(IsA(tle, TargetEntry) &&
+		   exprType((Node *)tle->expr) == FLOAT8OID);
+	func_oid = get_function_oid("quantile_sketch_key",
+								buildoidvector(&type_oid, 1),
+								get_namespace_oid("pgstrom", false),
+								true);
+	if (!OidIsValid(func_oid))
+	{
+		elog(DEBUG2, "no such function: %s",
+			 funcname_signature_string("quantile_sketch_key", 1, NIL, &type_oid));
+		return NULL;
+	}
+	if (pgstrom_devfunc_lookup(func_oid,
+							   INT4OID,
+							   list_make1(tle->expr),
+							   InvalidOid))
+	{
+		func = makeFuncExpr(func_oid,
+							INT4OID,
+							list_make1(tle->expr),
+							InvalidOid,
+							InvalidOid,
+							COERCE_EXPLICIT_CALL);
+	}
+	else
+	{
+		elog(DEBUG2, "no such device function: %s",
+			 funcname_signature_string("quantile_sketch_key", 1, NIL, &type_oid));
+	}
+	return func;
+}
+
+/*
+ * make_altfunc_numeric_fixed - fixed-point accumulator of numeric
+ *
+ * PSUM_NUMERIC_FIXED(NUMERIC_FIXED(X, scale), scale)
+ */
+static FuncExpr *
+make_altfunc_numeric_fixed(Aggref *aggref)
+{
+	TargetEntry	   *tle;
+	Oid				namespace_oid = get_namespace_oid("pgstrom", false);
+	Oid				type_oids[2];
+	Oid				func_oid;
+	Const		   *scale;
+	Expr		   *expr;
+	int				scale_val = aggref_numeric_fixed_scale(aggref);
+
+	Assert(list_length(aggref->args) == 1 && scale_val >= 0);
+	tle = linitial(aggref->args);
+	Assert(IsA(tle, TargetEntry));
+	scale = makeConst(INT4OID,
+					  -1,
+					  InvalidOid,
+					  sizeof(int32),
+					  Int32GetDatum(scale_val),
+					  false,
+					  true);
+	/* scaled integer of the argument */
+	type_oids[0] = NUMERICOID;
+	type_oids[1] = INT4OID;
+	func_oid = get_function_oid("numeric_fixed",
+								buildoidvector(type_oids, 2),
+								namespace_oid, true);
+	if (!OidIsValid(func_oid))
+	{
+		elog(DEBUG2, "no such function: %s",
+			 funcname_signature_string("numeric_fixed", 2, NIL, type_oids));
+		return NULL;
+	}
+	expr = (Expr *)makeFuncExpr(func_oid,
+								INT8OID,
+								list_make2(tle->expr, scale),
+								InvalidOid,
+								InvalidOid,
+								COERCE_EXPLICIT_CALL);
+	/* rows unmatched to the filter shall not be counted */
+	expr = make_expr_conditional(expr, aggref->aggfilter, false);
+
+	/* accumulator */
+	type_oids[0] = INT8OID;
+	type_oids[1] = INT4OID;
+	func_oid = get_function_oid("psum_numeric_fixed",
+								buildoidvector(type_oids, 2),
+								namespace_oid, true);
+	if (!OidIsValid(func_oid))
+	{
+		elog(DEBUG2, "no such function: %s",
+			 funcname_signature_string("psum_numeric_fixed", 2, NIL, type_oids));
+		return NULL;
+	}
+	return makeFuncExpr(func_oid,
+						BYTEAOID,
+						list_make2(expr, copyObject(scale)),
+						InvalidOid,
+						InvalidOid,
+						COERCE_EXPLICIT_CALL);
+}
+
+/*
+ * __update_aggfunc_clause_cost
+ */
+static void
+__update_aggfunc_clause_cost(PlannerInfo *root,
+							 Aggref *aggref_alt,
+							 Form_pg_aggregate agg_form,
+							 const aggfunc_catalog_t *aggfn_cat,
+							 AggClauseCosts *final_costs)
+{
+#if PG_VERSION_NUM < 140000
+	get_agg_clause_costs(root,
+						 (Node *)aggref_alt,
+						 AGGSPLIT_SIMPLE,
+						 final_costs);
+#else
+	/*
+	 * MEMO: PG14 revised get_agg_clause_costs() to calculate
+	 * the cost of aggregate functions that are tracked on
+	 * the PlannerInfo; thus, not alternative once replaced
+	 * by GpuPreAgg. So, we put simplified logic to calculate
+	 * per-tuple cost of the alternative functions.
+	 */
+	if (OidIsValid(agg_form->aggtransfn))
+		add_function_cost(root, agg_form->aggtransfn, NULL,
+						  &final_costs->transCost);
+	if (OidIsValid(agg_form->aggfinalfn))
+		add_function_cost(root, agg_form->aggfinalfn, NULL,
+						  &final_costs->finalCost);
+	if (aggfn_cat && aggfn_cat->partfn_extra_sz)
+		final_costs->transitionSpace += aggfn_cat->partfn_extra_sz();
+#endif
+}
+
+/*
+ * make_alternative_aggref
+ *
+ * It makes an alternative final aggregate function towards the supplied
+ * Aggref, and append its arguments on the target_partial/target_device.
+ */
+static Node *
+make_alternative_aggref(PlannerInfo *root,
+						Aggref *aggref,
+						PathTarget *target_partial,
+						PathTarget *target_input,
+						RelOptInfo *input_rel,
+						AggClauseCosts *final_clause_costs)
+{
+	const aggfunc_catalog_t *aggfn_cat;
+	Aggref	   *aggref_new;
+	List	   *altfunc_args = NIL;
+	Expr	   *expr_host;
 	Oid			namespace_oid;
 	Oid			func_oid;
 	const char *func_name;
@@ -2462,23 +3065,29 @@ make_alternative_aggref(PlannerInfo *root,
 	{
 		elog(DEBUG2, "Aggregate with ORDER BY/DISTINCT is not supported: %s",
 			 nodeToString(aggref));
+		pgstrom_record_offload_blocker("GpuPreAgg: aggregate with ORDER BY/DISTINCT is not supported: %s",
+									   format_procedure(aggref->aggfnoid));
 		return NULL;
 	}
 	if (AGGKIND_IS_ORDERED_SET(aggref->aggkind))
 	{
 		elog(DEBUG2, "ORDERED SET Aggregation is not supported: %s",
 			 nodeToString(aggref));
+		pgstrom_record_offload_blocker("GpuPreAgg: ordered-set aggregate is not supported: %s",
+									   format_procedure(aggref->aggfnoid));
 		return NULL;
 	}
 
 	/*
 	 * Lookup properties of aggregate function
 	 */
-	aggfn_cat = aggfunc_lookup_by_oid(aggref->aggfnoid);
+	aggfn_cat = aggfunc_lookup_by_aggref(aggref);
 	if (!aggfn_cat)
 	{
 		elog(DEBUG2, "Aggregate function is not device executable: %s",
 			 format_procedure(aggref->aggfnoid));
+		pgstrom_record_offload_blocker("GpuPreAgg: aggregate function is not device executable: %s",
+									   format_procedure(aggref->aggfnoid));
 		return NULL;
 	}
 	/* sanity checks */
@@ -2531,6 +3140,12 @@ make_alternative_aggref(PlannerInfo *root,
 			case ALTFUNC_EXPR_HLL_HASH:	/* HLL_HASH(X) */
 				pfunc = make_altfunc_hll_hash(aggref);
 				break;
+			case ALTFUNC_EXPR_QSKETCH_KEY:	/* QUANTILE_SKETCH_KEY(X) */
+				pfunc = make_altfunc_quantile_sketch_key(aggref);
+				break;
+			case ALTFUNC_EXPR_NUMERIC_FIXED: /* PSUM_NUMERIC_FIXED(X) */
+				pfunc = make_altfunc_numeric_fixed(aggref);
+				break;
 			default:
 				elog(ERROR, "unknown alternative function code: %d", action);
 				break;
@@ -2663,9 +3278,120 @@ typedef struct
 	RelOptInfo *input_rel;
 	Bitmapset  *__pfunc_bitmap__;
 	List	   *groupby_keys;
+	List	   *distinct_keys;
+	Index		distinct_sortgroupref;
 	AggClauseCosts final_clause_costs;
 } gpupreagg_build_path_target_context;
 
+/*
+ * add_distinct_key_to_pathtarget
+ */
+static void
+add_distinct_key_to_pathtarget(PathTarget *target, Expr *expr,
+							   gpupreagg_build_path_target_context *con)
+{
+	ListCell   *lc;
+	int			i = 0;
+
+	foreach (lc, target->exprs)
+	{
+		if (equal(expr, lfirst(lc)))
+		{
+			if (get_pathtarget_sortgroupref(target, i) == 0)
+			{
+				if (!target->sortgrouprefs)
+					target->sortgrouprefs = (Index *)
+						palloc0(sizeof(Index) * list_length(target->exprs));
+				target->sortgrouprefs[i] = con->distinct_sortgroupref++;
+			}
+			return;
+		}
+		i++;
+	}
+	add_column_to_pathtarget(target, copyObject(expr),
+							 con->distinct_sortgroupref++);
+}
+
+/*
+ * make_distinct_aggref
+ *
+ * DISTINCT aggregate cannot be replaced by any partial state, however,
+ * its arguments can perform as a part of grouping-keys of GpuPreAgg.
+ * It eliminates duplicated values on the device side, then the final
+ * aggregation runs the DISTINCT aggregate as is, but on much smaller
+ * number of rows.
+ */
+static Node *
+make_distinct_aggref(Aggref *aggref,
+					 gpupreagg_build_path_target_context *con)
+{
+	Aggref	   *aggref_new;
+	HeapTuple	tuple;
+	ListCell   *lc;
+
+	Assert(aggref->aggdistinct != NIL);
+	if (aggref->aggorder != NIL ||
+		aggref->aggfilter != NULL ||
+		aggref->aggkind != AGGKIND_NORMAL)
+	{
+		elog(DEBUG2, "DISTINCT aggregate with ORDER BY/FILTER is not supported: %s",
+			 nodeToString(aggref));
+		pgstrom_record_offload_blocker("GpuPreAgg: DISTINCT aggregate with ORDER BY/FILTER is not supported: %s",
+									   format_procedure(aggref->aggfnoid));
+		return NULL;
+	}
+
+	foreach (lc, aggref->args)
+	{
+		TargetEntry	   *tle = lfirst(lc);
+		Node		   *expr = (Node *)tle->expr;
+		devtype_info   *dtype;
+		Node		   *temp;
+
+		/*
+		 * Type of the DISTINCT argument must have device equality-function,
+		 * like the grouping-keys
+		 */
+		dtype = pgstrom_devtype_lookup(exprType(expr));
+		if (!dtype || !dtype->hash_func ||
+			!pgstrom_devfunc_lookup_type_equal(dtype, exprCollation(expr)))
+		{
+			elog(DEBUG2, "DISTINCT aggregate contains unsupported type (%s): %s",
+				 format_type_be(exprType(expr)),
+				 nodeToString(expr));
+			pgstrom_record_offload_blocker("GpuPreAgg: DISTINCT aggregate contains unsupported type: %s",
+										   format_type_be(exprType(expr)));
+			return NULL;
+		}
+		/* device executable? */
+		temp = replace_expression_by_outerref(expr, con->target_input);
+		if (!pgstrom_device_expression(con->root, NULL, (Expr *)temp))
+			return NULL;
+	}
+	/* add DISTINCT arguments as grouping-keys of GpuPreAgg */
+	foreach (lc, aggref->args)
+	{
+		TargetEntry	   *tle = lfirst(lc);
+
+		add_distinct_key_to_pathtarget(con->target_partial, tle->expr, con);
+		con->distinct_keys = lappend(con->distinct_keys, tle->expr);
+	}
+	aggref_new = copyObject(aggref);
+
+	/* update the final aggregation costs */
+	tuple = SearchSysCache1(AGGFNOID, ObjectIdGetDatum(aggref->aggfnoid));
+	if (!HeapTupleIsValid(tuple))
+		elog(ERROR, "cache lookup failed for pg_aggregate %u",
+			 aggref->aggfnoid);
+	__update_aggfunc_clause_cost(con->root, aggref_new,
+								 (Form_pg_aggregate) GETSTRUCT(tuple),
+								 NULL,
+								 &con->final_clause_costs);
+	ReleaseSysCache(tuple);
+
+	return (Node *)aggref_new;
+}
+
 static Node *
 replace_expression_by_altfunc(Node *node,
 							  gpupreagg_build_path_target_context *con)
@@ -2677,12 +3403,18 @@ replace_expression_by_altfunc(Node *node,
 		return NULL;
 	if (IsA(node, Aggref))
 	{
-		Node   *aggfn = make_alternative_aggref(con->root,
-												(Aggref *)node,
-												con->target_partial,
-												con->target_input,
-												con->input_rel,
-												&con->final_clause_costs);
+		Aggref *aggref = (Aggref *)node;
+		Node   *aggfn;
+
+		if (aggref->aggdistinct != NIL)
+			aggfn = make_distinct_aggref(aggref, con);
+		else
+			aggfn = make_alternative_aggref(con->root,
+											aggref,
+											con->target_partial,
+											con->target_input,
+											con->input_rel,
+											&con->final_clause_costs);
 		if (!aggfn)
 			con->device_executable = false;
 		return aggfn;
@@ -2719,6 +3451,7 @@ gpupreagg_build_path_target(PlannerInfo *root,			/* in */
 							Path       *input_path,     /* in */
 							Node **p_havingQual,		/* out */
 							bool *p_can_pullup_outerscan, /* out */
+							double *p_num_partial_groups, /* out */
 							AggClauseCosts *p_final_clause_costs) /* out */
 {
 	gpupreagg_build_path_target_context con;
@@ -2737,6 +3470,19 @@ gpupreagg_build_path_target(PlannerInfo *root,			/* in */
 	con.target_input	= target_input;
 	con.input_rel       = input_rel;
 	con.groupby_keys    = NIL;
+	con.distinct_keys   = NIL;
+	/*
+	 * DISTINCT arguments are added to the grouping-keys of GpuPreAgg
+	 * with sortgroupref not used in the query.
+	 */
+	con.distinct_sortgroupref = 1;
+	foreach (lc, parse->targetList)
+	{
+		TargetEntry *tle = lfirst(lc);
+
+		if (con.distinct_sortgroupref <= tle->ressortgroupref)
+			con.distinct_sortgroupref = tle->ressortgroupref + 1;
+	}
 
 	/*
 	 * NOTE: Not to inject unnecessary projection on the sub-path node,
@@ -2765,6 +3511,8 @@ gpupreagg_build_path_target(PlannerInfo *root,			/* in */
 				elog(DEBUG2, "GROUP BY contains unsupported type (%s): %s",
 					 format_type_be(exprType((Node *)expr)),
 					 nodeToString((Node *)expr));
+				pgstrom_record_offload_blocker("GpuPreAgg: GROUP BY contains unsupported type: %s",
+											   format_type_be(exprType((Node *)expr)));
 				return false;
 			}
 			coll_oid = exprCollation((Node *)expr);
@@ -2773,6 +3521,8 @@ gpupreagg_build_path_target(PlannerInfo *root,			/* in */
 				elog(DEBUG2, "GROUP BY contains unsupported type (%s): %s",
 					 format_type_be(exprType((Node *)expr)),
 					 nodeToString((Node *)expr));
+				pgstrom_record_offload_blocker("GpuPreAgg: GROUP BY contains unsupported type: %s",
+											   format_type_be(exprType((Node *)expr)));
 				return false;
 			}
 
@@ -2796,6 +3546,7 @@ gpupreagg_build_path_target(PlannerInfo *root,			/* in */
 			{
 				elog(DEBUG2, "alt-aggregation is not device executable: %s",
 					 nodeToString((Node *)expr));
+				pgstrom_record_offload_blocker("GpuPreAgg: target-list is not device executable");
 				return false;
 			}
 			if (exprType((Node *)expr) != exprType((Node *)temp))
@@ -2816,6 +3567,7 @@ gpupreagg_build_path_target(PlannerInfo *root,			/* in */
 		{
 			elog(DEBUG2, "HAVING clause is not device executable: %s",
 				 nodeToString((Node *)parse->havingQual));
+			pgstrom_record_offload_blocker("GpuPreAgg: HAVING clause is not device executable");
 			return false;
 		}
 	}
@@ -2823,6 +3575,30 @@ gpupreagg_build_path_target(PlannerInfo *root,			/* in */
 	memcpy(p_final_clause_costs, &con.final_clause_costs,
 		   sizeof(AggClauseCosts));
 
+	/*
+	 * If DISTINCT arguments are added to the grouping-keys, GpuPreAgg
+	 * generates more groups than the final aggregation.
+	 */
+	if (con.distinct_keys != NIL)
+	{
+		List   *group_exprs = NIL;
+
+		i = 0;
+		foreach (lc, target_partial->exprs)
+		{
+			if (get_pathtarget_sortgroupref(target_partial, i++))
+				group_exprs = lappend(group_exprs, lfirst(lc));
+		}
+		*p_num_partial_groups = estimate_num_groups(root,
+													group_exprs,
+													input_path->rows,
+#if PG_VERSION_NUM < 140000
+													NULL);
+#else
+													NULL, NULL);
+#endif
+	}
+
 	set_pathtarget_cost_width(root, target_final);
 	set_pathtarget_cost_width(root, target_partial);
 
@@ -3401,6 +4177,45 @@ codegen_projection_partial_funcion(FuncExpr *f, codegen_context *context)
 
 		expr = (Expr *)hfunc;
 	}
+	else if (strcmp(proc_name, "quantile_sketch_new") == 0)
+	{
+		FuncExpr   *kfunc;
+		char	   *kfunc_name;
+		Oid			kfunc_namespace;
+
+		Assert(list_length(f->args) == 1);
+		kfunc = linitial(f->args);
+		Assert(IsA(kfunc, FuncExpr));
+		kfunc_name = get_func_name(kfunc->funcid);
+		kfunc_namespace = get_func_namespace(kfunc->funcid);
+		if (strcmp(kfunc_name, "quantile_sketch_key") != 0 ||
+			kfunc_namespace != get_namespace_oid("pgstrom", false))
+			elog(ERROR, "Bug? quantile_sketch_new() is invoked with %s",
+				 format_procedure(kfunc->funcid));
+		pfree(kfunc_name);
+
+		dfunc = pgstrom_devfunc_lookup(kfunc->funcid,
+									   kfunc->funcresulttype,
+									   kfunc->args,
+									   kfunc->inputcollid);
+		if (!dfunc)
+			elog(ERROR, "device function lookup failed: %s",
+				 format_procedure(kfunc->funcid));
+		pgstrom_devfunc_track(context, dfunc);
+
+		expr = (Expr *)kfunc;
+	}
+	else if (strcmp(proc_name, "psum_numeric_fixed") == 0)
+	{
+		/* the scaled integer; scale is given to aggcalc_init_* */
+		Assert(list_length(f->args) == 2);
+		expr = linitial(f->args);
+		Assert(exprType((Node *)expr) == INT8OID);
+		dtype = pgstrom_devtype_lookup_and_track(INT8OID, context);
+		if (!dtype)
+			elog(ERROR, "device type lookup failed: %s",
+				 format_type_be(INT8OID));
+	}
 	else
 	{
 		elog(ERROR, "Bug? unexpected partial aggregate function: %s",
@@ -4091,6 +4906,24 @@ gpupreagg_codegen_common_calc(TargetEntry *tle,
 				 aggcalc_mode);
 		return sbuffer;
 	}
+	else if (strcmp(func_name, "quantile_sketch_new") == 0)
+	{
+		pfree(func_name);
+		/* quantile sketch is also bytea */
+		snprintf(sbuffer, sizeof(sbuffer),
+				 "aggcalc_%s_quantile_sketch",
+				 aggcalc_mode);
+		return sbuffer;
+	}
+	else if (strcmp(func_name, "psum_numeric_fixed") == 0)
+	{
+		pfree(func_name);
+		/* fixed-point accumulator is also bytea */
+		snprintf(sbuffer, sizeof(sbuffer),
+				 "aggcalc_%s_numeric_fixed",
+				 aggcalc_mode);
+		return sbuffer;
+	}
 	else
 		elog(ERROR, "Bug? unexpected partial function expression: %s",
 			 nodeToString(f));
@@ -4135,6 +4968,37 @@ gpupreagg_codegen_common_calc(TargetEntry *tle,
 	return sbuffer;
 }
 
+/*
+ * gpupreagg_codegen_init_extra_args
+ *
+ * additional arguments of aggcalc_init_* for the partial function that
+ * uses extra buffer.
+ */
+static const char *
+gpupreagg_codegen_init_extra_args(TargetEntry *tle)
+{
+	FuncExpr	   *f = (FuncExpr *)tle->expr;
+	char		   *func_name;
+	static char		sbuffer[64];
+
+	Assert(IsA(f, FuncExpr));
+	sbuffer[0] = '\0';
+	func_name = get_func_name(f->funcid);
+	if (strcmp(func_name, "psum_numeric_fixed") == 0)
+	{
+		Const	   *scale = lsecond(f->args);
+
+		if (!IsA(scale, Const) || scale->constisnull)
+			elog(ERROR, "Bug? psum_numeric_fixed() has no constant scale: %s",
+				 nodeToString(f));
+		snprintf(sbuffer, sizeof(sbuffer), ", %d",
+				 DatumGetInt32(scale->constvalue));
+	}
+	pfree(func_name);
+
+	return sbuffer;
+}
+
 /*
  * code generator for initialization of a slot
  */
@@ -4192,22 +5056,26 @@ gpupreagg_codegen_init_slot(StringInfo kern,
 		}
 		else
 		{
+			const char *extra_args = gpupreagg_codegen_init_extra_args(tle);
+
 			label = gpupreagg_codegen_common_calc(tle, context, "init");
 			appendStringInfo(
 				&fbuf,
-				"  %s(&dst_dclass[%d], &dst_values[%d], dst_extras);\n"
+				"  %s(&dst_dclass[%d], &dst_values[%d], dst_extras%s);\n"
 				"  dst_extras += %u;\n",
 				label,
 				count1 + count2,
 				count1 + count2,
+				extra_args,
 				extra_sz);
 			appendStringInfo(
 				&lbuf,
-				"  %s(&dst_dclass[%d], &dst_values[%d], dst_extras);\n"
+				"  %s(&dst_dclass[%d], &dst_values[%d], dst_extras%s);\n"
 				"  dst_extras += %u;\n",
 				label,
 				count1,
 				count1,
+				extra_args,
 				extra_sz);
 			extra_total += extra_sz;
 			count1++;
@@ -4438,7 +5306,8 @@ gpupreagg_codegen(PlannerInfo *root,
 	/* gpuscan_quals_eval */
 	codegen_gpuscan_quals(&body, &context, "gpupreagg",
 						  cscan->scan.scanrelid,
-						  gpa_info->outer_quals);
+						  gpa_info->outer_quals,
+						  false);
 	/* gpupreagg_projection_xxxx */
 	gpupreagg_codegen_projection(&body,
 								 &context,
@@ -4560,6 +5429,8 @@ assign_gpupreagg_session_info(StringInfo buf, GpuTaskState *gts)
 					 gpas->local_hash_nrooms);
 	appendStringInfo(buf, "#define __GPUPREAGG_HLL_REGISTER_BITS %u\n",
 					 pgstrom_hll_register_bits);
+	appendStringInfo(buf, "#define __GPUPREAGG_QUANTILE_SKETCH_BITS %u\n",
+					 pgstrom_quantile_sketch_bits);
 
 	/*
 	 * definition of GPUPREAGG_COMBINED_JOIN disables a dummy definition
@@ -4646,6 +5517,241 @@ CreateGpuPreAggScanState(CustomScan *cscan)
 	return (Node *) gpas;
 }
 
+/*
+ * GpuPreAggResultCache
+ *
+ * GpuPreAgg on a table with GPU cache saves its results (partial aggregates
+ * before the final Agg node) on the per-backend memory, with the version
+ * of GPU cache contents. The repeated queries on the same plan replay the
+ * results, unless any REDO logs are written to the GPU cache since then.
+ */
+typedef struct GpuPreAggResultCache
+{
+	dlist_node		chain;		/* LRU list */
+	char		   *key;		/* plan and session info */
+	GpuCacheScanVersion version;
+	int				refcnt;		/* number of scans replaying the results */
+	size_t			usage;		/* memory consumption */
+	cl_uint			nitems;
+	HeapTuple		tuples[FLEXIBLE_ARRAY_MEMBER];
+} GpuPreAggResultCache;
+
+static MemoryContext	gpupreagg_rcache_memcxt = NULL;
+static dlist_head		gpupreagg_rcache_list;
+static size_t			gpupreagg_rcache_usage = 0;
+
+static void
+gpupreagg_release_result_cache(GpuPreAggResultCache *rcache)
+{
+	cl_uint		i;
+
+	Assert(rcache->refcnt == 0);
+	dlist_delete(&rcache->chain);
+	gpupreagg_rcache_usage -= rcache->usage;
+	for (i=0; i < rcache->nitems; i++)
+		pfree(rcache->tuples[i]);
+	pfree(rcache->key);
+	pfree(rcache);
+}
+
+static void
+gpupreagg_unpin_result_cache(void *arg)
+{
+	GpuPreAggResultCache *rcache = arg;
+
+	Assert(rcache->refcnt > 0);
+	rcache->refcnt--;
+}
+
+/*
+ * gpupreagg_result_cache_key
+ *
+ * It returns the key of result cache, or NULL if GpuPreAgg is not cacheable;
+ * results must depend only on the GPU cache contents and the plan.
+ */
+static char *
+gpupreagg_result_cache_key(GpuPreAggState *gpas,
+						   GpuPreAggInfo *gpa_info,
+						   const char *session_info)
+{
+	CustomScan	   *cscan = (CustomScan *) gpas->gts.css.ss.ps.plan;
+	Relation		scan_rel = gpas->gts.css.ss.ss_currentRelation;
+	StringInfoData	buf;
+	ListCell	   *lc;
+
+	if (gpupreagg_result_cache_size <= 0 ||
+		!scan_rel ||
+		!gpas->gts.gc_state ||
+		cscan->scan.plan.parallel_aware ||
+		IsParallelWorker() ||
+		!bms_is_empty(cscan->scan.plan.allParam))
+		return NULL;
+	foreach (lc, gpa_info->used_params)
+	{
+		if (!IsA(lfirst(lc), Const))
+			return NULL;
+	}
+	if (contain_mutable_functions((Node *)gpa_info->outer_quals) ||
+		contain_mutable_functions((Node *)gpa_info->tlist_prep))
+		return NULL;
+
+	initStringInfo(&buf);
+	appendStringInfo(&buf, "%u %s %s %s",
+					 RelationGetRelid(scan_rel),
+					 nodeToString(cscan->custom_private),
+					 nodeToString(cscan->custom_scan_tlist),
+					 session_info);
+	return buf.data;
+}
+
+/*
+ * gpupreagg_lookup_result_cache
+ */
+static void
+gpupreagg_lookup_result_cache(GpuPreAggState *gpas)
+{
+	EState		   *estate = gpas->gts.css.ss.ps.state;
+	dlist_mutable_iter iter;
+
+	if (!gpuCacheGetScanVersion(gpas->gts.gc_state,
+								estate->es_snapshot,
+								&gpas->rcache_version))
+		return;
+	dlist_foreach_modify(iter, &gpupreagg_rcache_list)
+	{
+		GpuPreAggResultCache *rcache
+			= dlist_container(GpuPreAggResultCache, chain, iter.cur);
+		MemoryContextCallback *cb;
+
+		if (strcmp(rcache->key, gpas->rcache_key) != 0)
+			continue;
+		if (memcmp(&rcache->version, &gpas->rcache_version,
+				   sizeof(GpuCacheScanVersion)) != 0)
+		{
+			/* GPU cache contents are already updated */
+			if (rcache->refcnt == 0)
+				gpupreagg_release_result_cache(rcache);
+			continue;
+		}
+		/* move to the head of LRU, and pin it until end of the query */
+		dlist_move_head(&gpupreagg_rcache_list, &rcache->chain);
+		cb = MemoryContextAlloc(estate->es_query_cxt,
+								sizeof(MemoryContextCallback));
+		cb->func = gpupreagg_unpin_result_cache;
+		cb->arg = rcache;
+		MemoryContextRegisterResetCallback(estate->es_query_cxt, cb);
+		rcache->refcnt++;
+		gpas->rcache_hit = rcache;
+		gpas->rcache_index = 0;
+		return;
+	}
+	gpas->rcache_saving = true;
+}
+
+/*
+ * gpupreagg_save_result_cache
+ */
+static void
+gpupreagg_save_result_cache(GpuPreAggState *gpas)
+{
+	GpuPreAggResultCache *rcache;
+	MemoryContext	oldcxt;
+	size_t			limit = (size_t)gpupreagg_result_cache_size << 10;
+	size_t			usage;
+	dlist_mutable_iter iter;
+	ListCell	   *lc;
+	cl_uint			i = 0;
+
+	gpas->rcache_saving = false;
+	usage = (offsetof(GpuPreAggResultCache,
+					  tuples[list_length(gpas->rcache_tuples)]) +
+			 strlen(gpas->rcache_key) + 1 +
+			 gpas->rcache_usage);
+	if (usage > limit)
+		return;
+	/* release the older entries, if no room */
+	dlist_reverse_foreach_modify(iter, &gpupreagg_rcache_list)
+	{
+		GpuPreAggResultCache *curr
+			= dlist_container(GpuPreAggResultCache, chain, iter.cur);
+
+		if (gpupreagg_rcache_usage + usage <= limit)
+			break;
+		if (curr->refcnt == 0)
+			gpupreagg_release_result_cache(curr);
+	}
+	if (gpupreagg_rcache_usage + usage > limit)
+		return;
+
+	if (!gpupreagg_rcache_memcxt)
+		gpupreagg_rcache_memcxt = AllocSetContextCreate(CacheMemoryContext,
+														"GpuPreAgg Result Cache",
+														ALLOCSET_DEFAULT_SIZES);
+	oldcxt = MemoryContextSwitchTo(gpupreagg_rcache_memcxt);
+	rcache = palloc0(offsetof(GpuPreAggResultCache,
+							  tuples[list_length(gpas->rcache_tuples)]));
+	rcache->key = pstrdup(gpas->rcache_key);
+	memcpy(&rcache->version, &gpas->rcache_version,
+		   sizeof(GpuCacheScanVersion));
+	rcache->usage = usage;
+	foreach (lc, gpas->rcache_tuples)
+		rcache->tuples[i++] = heap_copytuple((HeapTuple) lfirst(lc));
+	rcache->nitems = i;
+	MemoryContextSwitchTo(oldcxt);
+
+	dlist_push_head(&gpupreagg_rcache_list, &rcache->chain);
+	gpupreagg_rcache_usage += usage;
+}
+
+/*
+ * gpupreagg_exec_scan_access
+ *
+ * It replays the cached results, or saves the results to be cached, if any.
+ */
+static TupleTableSlot *
+gpupreagg_exec_scan_access(GpuPreAggState *gpas)
+{
+	GpuPreAggResultCache *rcache = gpas->rcache_hit;
+	TupleTableSlot *slot;
+
+	if (rcache)
+	{
+		slot = gpas->gts.css.ss.ss_ScanTupleSlot;
+		if (gpas->rcache_index >= rcache->nitems)
+			return ExecClearTuple(slot);
+		ExecForceStoreHeapTuple(rcache->tuples[gpas->rcache_index++],
+								slot, false);
+		return slot;
+	}
+	slot = pgstromExecGpuTaskState(&gpas->gts);
+	if (gpas->rcache_saving)
+	{
+		if (TupIsNull(slot))
+			gpupreagg_save_result_cache(gpas);
+		else
+		{
+			EState	   *estate = gpas->gts.css.ss.ps.state;
+			MemoryContext oldcxt;
+			HeapTuple	tuple;
+
+			oldcxt = MemoryContextSwitchTo(estate->es_query_cxt);
+			tuple = ExecCopySlotHeapTuple(slot);
+			gpas->rcache_tuples = lappend(gpas->rcache_tuples, tuple);
+			gpas->rcache_usage += (sizeof(HeapTuple) +
+								   HEAPTUPLESIZE + tuple->t_len);
+			MemoryContextSwitchTo(oldcxt);
+			/* too large results to be cached */
+			if (gpas->rcache_usage > ((size_t)gpupreagg_result_cache_size << 10))
+			{
+				list_free_deep(gpas->rcache_tuples);
+				gpas->rcache_tuples = NIL;
+				gpas->rcache_saving = false;
+			}
+		}
+	}
+	return slot;
+}
+
 /*
  * ExecInitGpuPreAgg
  */
@@ -4685,6 +5791,7 @@ ExecInitGpuPreAgg(CustomScanState *node, EState *estate, int eflags)
 	gpas->gts.cb_next_tuple      = gpupreagg_next_tuple;
 	gpas->gts.cb_process_task    = gpupreagg_process_task;
 	gpas->gts.cb_release_task    = gpupreagg_release_task;
+	gpas->gts.cb_begin_exec      = gpupreagg_begin_exec;
 	gpas->num_group_keys		= gpa_info->num_group_keys;
 	gpas->num_accum_values		= gpa_info->num_accum_values;
 	gpas->accum_extra_bufsz		= gpa_info->accum_extra_bufsz;
@@ -4712,10 +5819,16 @@ ExecInitGpuPreAgg(CustomScanState *node, EState *estate, int eflags)
 		outer_ps = ExecInitNode(outer_plan, estate, eflags);
 		if (enable_pullup_outer_join &&
 			pgstrom_planstate_is_gpujoin(outer_ps) &&
+			!GpuJoinInnerIsPartitioned(outer_ps) &&
 			!outer_ps->ps_ProjInfo)
 		{
 			gpas->combined_gpujoin = true;
 		}
+		else
+		{
+			gpas->gts.outer_handoff =
+				GpuJoinSetupDeviceHandoff(&gpas->gts, outer_ps);
+		}
 		outerPlanState(gpas) = outer_ps;
 		/* GpuPreAgg don't need re-initialization of projection info */
 		outer_tupdesc = planStateResultTupleDesc(outer_ps);
@@ -4772,6 +5885,7 @@ ExecInitGpuPreAgg(CustomScanState *node, EState *estate, int eflags)
 		 : gpa_info->outer_nrows);
     gpas->plan_nrows_in		= gpa_info->outer_nrows;
 	gpas->plan_ngroups		= gpa_info->plan_ngroups;
+	gpas->feedback_signature = gpa_info->feedback_signature;
 
 	/* Get CUDA program and async build if any */
 	if (gpas->combined_gpujoin)
@@ -4796,6 +5910,14 @@ ExecInitGpuPreAgg(CustomScanState *node, EState *estate, int eflags)
 												 kern_define.data,
 												 false,
 												 explain_only);
+		/* results already cached, if any */
+		if (!explain_only)
+		{
+			gpas->rcache_key = gpupreagg_result_cache_key(gpas, gpa_info,
+														  kern_define.data);
+			if (gpas->rcache_key)
+				gpupreagg_lookup_result_cache(gpas);
+		}
 		pfree(kern_define.data);
 	}
 	gpas->gts.program_id = program_id;
@@ -4814,6 +5936,23 @@ ExecReCheckGpuPreAgg(CustomScanState *node, TupleTableSlot *slot)
 	return true;
 }
 
+/*
+ * gpupreagg_begin_exec
+ */
+static bool
+gpupreagg_begin_exec(GpuTaskState *gts)
+{
+	GpuPreAggState *gpas = (GpuPreAggState *) gts;
+
+	/* no need to run GPU kernels, if cached results are replayed */
+	if (gpas->rcache_hit)
+		return false;
+	ActivateGpuContext(gpas->gts.gcontext);
+	if (!gpas->gpa_sstate)
+		createGpuPreAggSharedState(gpas, NULL, NULL);
+	return true;
+}
+
 /*
  * ExecGpuPreAgg
  */
@@ -4822,14 +5961,35 @@ ExecGpuPreAgg(CustomScanState *node)
 {
 	GpuPreAggState *gpas = (GpuPreAggState *) node;
 
-	ActivateGpuContext(gpas->gts.gcontext);
-	if (!gpas->gpa_sstate)
-		createGpuPreAggSharedState(gpas, NULL, NULL);
+	gpupreagg_begin_exec(&gpas->gts);
 	return ExecScan(&node->ss,
-					(ExecScanAccessMtd) pgstromExecGpuTaskState,
+					(ExecScanAccessMtd) gpupreagg_exec_scan_access,
 					(ExecScanRecheckMtd) ExecReCheckGpuPreAgg);
 }
 
+/*
+ * gpupreaggUpdateCardinalityFeedback
+ *
+ * It records the total number of input rows and groups by all the processes,
+ * for the planning of the repeated query shapes.
+ */
+static void
+gpupreaggUpdateCardinalityFeedback(GpuPreAggState *gpas)
+{
+	GpuPreAggRuntimeStat *gpa_rtstat = gpas->gpa_rtstat;
+	uint64		nrows_in;
+
+	if (!gpa_rtstat || gpas->num_group_keys == 0)
+		return;
+	if (pg_atomic_read_u64(&gpa_rtstat->final_nprocs) == 0)
+		return;
+	nrows_in = (pg_atomic_read_u64(&gpa_rtstat->c.source_nitems) -
+				pg_atomic_read_u64(&gpa_rtstat->c.nitems_filtered));
+	pgstromUpdateCardinalityFeedback(gpas->feedback_signature,
+									 (double)nrows_in,
+									 (double)pg_atomic_read_u64(&gpa_rtstat->final_nitems));
+}
+
 /*
  * ExecEndGpuPreAgg
  */
@@ -4871,6 +6031,9 @@ ExecEndGpuPreAgg(CustomScanState *node)
 		ExecDropSingleTupleTableSlot(gpas->prep_slot);
 	if (gpas->outer_slot)
 		ExecDropSingleTupleTableSlot(gpas->outer_slot);
+	/* save the number of groups actually produced */
+	if (!IsParallelWorker())
+		gpupreaggUpdateCardinalityFeedback(gpas);
 	releaseGpuPreAggSharedState(gpas);
 	pgstromReleaseGpuTaskState(&gpas->gts, gt_rtstat);
 }
@@ -4894,6 +6057,15 @@ ExecReScanGpuPreAgg(CustomScanState *node)
 	pgstromRescanGpuTaskState(&gpas->gts);
 	/* reset other stuff */
 	gpas->terminator_done = false;
+	gpas->final_counted = false;
+	/* replay the cached results again, or give up saving partial results */
+	gpas->rcache_index = 0;
+	if (gpas->rcache_saving)
+	{
+		list_free_deep(gpas->rcache_tuples);
+		gpas->rcache_tuples = NIL;
+		gpas->rcache_saving = false;
+	}
 }
 
 /*
@@ -4902,7 +6074,7 @@ ExecReScanGpuPreAgg(CustomScanState *node)
 static Size
 ExecGpuPreAggEstimateDSM(CustomScanState *node, ParallelContext *pcxt)
 {
-	return (MAXALIGN(sizeof(GpuPreAggSharedState)) +
+	return (GPUPREAGG_SHARED_STATE_LENGTH() +
 			pgstromSizeOfBrinIndexMap((GpuTaskState *) node) +
 			pgstromEstimateDSMGpuTaskState((GpuTaskState *)node, pcxt));
 }
@@ -4926,13 +6098,7 @@ ExecGpuPreAggInitDSM(CustomScanState *node,
 	/* allocation of shared state */
 	len = createGpuPreAggSharedState(gpas, pcxt, coordinate);
 	coordinate = (char *)coordinate + len;
-	if (gpas->gts.outer_index_state)
-	{
-		gpas->gts.outer_index_map = (Bitmapset *)coordinate;
-		gpas->gts.outer_index_map->nwords = -1;	/* uninitialized */
-		coordinate = ((char *)coordinate +
-					  pgstromSizeOfBrinIndexMap(&gpas->gts));
-	}
+	coordinate = pgstromInitDSMBrinIndexMap(&gpas->gts, coordinate);
 	pgstromInitDSMGpuTaskState(&gpas->gts, pcxt, coordinate);
 	pg_memory_barrier();
 }
@@ -4956,12 +6122,7 @@ ExecGpuPreAggInitWorker(CustomScanState *node,
 				  SynchronizeGpuContextOnDSMDetach,
 				  PointerGetDatum(gpas->gts.gcontext));
 	coordinate = (char *)coordinate + gpa_sstate->ss_length;
-	if (gpas->gts.outer_index_state)
-	{
-		gpas->gts.outer_index_map = (Bitmapset *)coordinate;
-		coordinate = ((char *)coordinate +
-					  pgstromSizeOfBrinIndexMap(&gpas->gts));
-	}
+	coordinate = pgstromInitWorkerBrinIndexMap(&gpas->gts, coordinate);
 	pgstromInitWorkerGpuTaskState(&gpas->gts, coordinate);
 }
 
@@ -4972,6 +6133,7 @@ static void
 ExecGpuPreAggReInitializeDSM(CustomScanState *node,
 							 ParallelContext *pcxt, void *coordinate)
 {
+	resetGpuPreAggSharedState((GpuPreAggState *) node);
 	pgstromReInitializeDSMGpuTaskState((GpuTaskState *) node);
 }
 
@@ -4983,7 +6145,8 @@ ExecShutdownGpuPreAgg(CustomScanState *node)
 {
 	GpuPreAggState	   *gpas = (GpuPreAggState *) node;
 	GpuPreAggRuntimeStat *gpa_rtstat_old = gpas->gpa_rtstat;
-	GpuPreAggRuntimeStat *gpa_rtstat_new;
+	GpuPreAggSharedState *gpa_sstate_old = gpas->gpa_sstate;
+	GpuPreAggSharedState *gpa_sstate_new;
 
 	/*
 	 * If this GpuPreAgg node is located under the inner side of
@@ -4999,12 +6162,17 @@ ExecShutdownGpuPreAgg(CustomScanState *node)
 	{
 		EState	   *estate = gpas->gts.css.ss.ps.state;
 
-		gpa_rtstat_new = MemoryContextAlloc(estate->es_query_cxt,
-											sizeof(GpuPreAggRuntimeStat));
-		memcpy(gpa_rtstat_new,
-			   gpa_rtstat_old,
-			   sizeof(GpuPreAggRuntimeStat));
-		gpas->gpa_rtstat = gpa_rtstat_new;
+		/*
+		 * Also keeps IPC handles of the shared final buffer, to release
+		 * them on ExecEnd after the DSM segment is detached.
+		 */
+		gpa_sstate_new = MemoryContextAlloc(estate->es_query_cxt,
+											gpa_sstate_old->ss_length);
+		memcpy(gpa_sstate_new,
+			   gpa_sstate_old,
+			   gpa_sstate_old->ss_length);
+		gpas->gpa_sstate = gpa_sstate_new;
+		gpas->gpa_rtstat = &gpa_sstate_new->gpa_rtstat;
 	}
 	pgstromShutdownDSMGpuTaskState(&gpas->gts);
 }
@@ -5096,6 +6264,9 @@ ExplainGpuPreAgg(CustomScanState *node, List *ancestors, ExplainState *es)
 							gpa_info->outer_total_cost,
 							gpa_info->outer_nrows,
 							gpa_info->outer_width);
+	/* results replayed from the result cache? */
+	if (gpas->rcache_hit)
+		ExplainPropertyText("Result Cache", "hit", es);
 	/* combined GpuJoin + GpuPreAgg? */
 	if (gpas->combined_gpujoin)
 		ExplainPropertyText("Combined GpuJoin", "enabled", es);
@@ -5112,6 +6283,15 @@ ExplainGpuPreAgg(CustomScanState *node, List *ancestors, ExplainState *es)
 		if (fallback_count > 0)
 			ExplainPropertyInteger("Num of CPU fallback rows",
 								   NULL, fallback_count, es);
+		if (gpas->num_group_keys > 0 && gpas->local_hash_nrooms > 0)
+		{
+			uint64		global_only_ntasks
+				= pg_atomic_read_u64(&gpa_rtstat->global_only_ntasks);
+
+			if (global_only_ntasks > 0)
+				ExplainPropertyInteger("Num of tasks by global reduction only",
+									   NULL, global_only_ntasks, es);
+		}
 	}
 }
 
@@ -5126,7 +6306,7 @@ createGpuPreAggSharedState(GpuPreAggState *gpas,
 	EState	   *estate = gpas->gts.css.ss.ps.state;
 	GpuPreAggSharedState *gpa_sstate;
 	GpuPreAggRuntimeStat *gpa_rtstat;
-	size_t		ss_length = MAXALIGN(sizeof(GpuPreAggSharedState));
+	size_t		ss_length = GPUPREAGG_SHARED_STATE_LENGTH();
 
 	if (dsm_addr)
 		gpa_sstate = dsm_addr;
@@ -5138,6 +6318,8 @@ createGpuPreAggSharedState(GpuPreAggState *gpas,
 
 	gpa_rtstat = &gpa_sstate->gpa_rtstat;
 	SpinLockInit(&gpa_rtstat->c.lock);
+	ConditionVariableInit(&gpa_sstate->f_cond);
+	SpinLockInit(&gpa_sstate->f_mutex);
 
 	gpas->gpa_sstate = gpa_sstate;
 	gpas->gpa_rtstat = gpa_rtstat;
@@ -5151,7 +6333,24 @@ createGpuPreAggSharedState(GpuPreAggState *gpas,
 static void
 releaseGpuPreAggSharedState(GpuPreAggState *gpas)
 {
-	/* to be moved to shutdown handler?? */
+	GpuPreAggSharedState *gpa_sstate = gpas->gpa_sstate;
+	CUresult	rc;
+	int			dindex;
+
+	/* only the backend which set up DSM releases the shared final buffer */
+	if (!gpa_sstate || IsParallelWorker())
+		return;
+	for (dindex=0; dindex < numDevAttrs; dindex++)
+	{
+		if (gpa_sstate->pergpu[dindex].bytesize == 0)
+			continue;
+		rc = gpuMemFreePreserved(dindex,
+								 gpa_sstate->pergpu[dindex].ipc_mhandle);
+		if (rc != CUDA_SUCCESS)
+			elog(WARNING, "failed on gpuMemFreePreserved: %s",
+				 errorText(rc));
+		gpa_sstate->pergpu[dindex].bytesize = 0;
+	}
 }
 
 /*
@@ -5160,7 +6359,220 @@ releaseGpuPreAggSharedState(GpuPreAggState *gpas)
 static void
 resetGpuPreAggSharedState(GpuPreAggState *gpas)
 {
-	/* nothing to do */
+	GpuPreAggSharedState *gpa_sstate = gpas->gpa_sstate;
+
+	gpas->shared_final = false;
+	if (!gpa_sstate || IsParallelWorker())
+		return;
+	releaseGpuPreAggSharedState(gpas);
+	memset(gpa_sstate->pergpu, 0,
+		   offsetof(GpuPreAggSharedState, pergpu[numDevAttrs]) -
+		   offsetof(GpuPreAggSharedState, pergpu[0]));
+}
+
+/*
+ * gpupreagg_register_shared_final
+ *
+ * It registers the current worker to the final buffer shared by the workers
+ * on the same device, if NoGroup reduction runs on the parallel workers.
+ * Accumulated values must not have any extra buffer, because the pointers
+ * on the shared device memory are not valid on the other processes.
+ */
+static void
+gpupreagg_register_shared_final(GpuPreAggState *gpas)
+{
+	GpuPreAggSharedState *gpa_sstate = gpas->gpa_sstate;
+	cl_int		dindex = gpas->gts.gcontext->cuda_dindex;
+
+	if (gpas->shared_final ||
+		!enable_gpupreagg_shared_final ||
+		gpas->num_group_keys > 0 ||
+		gpas->accum_extra_bufsz > 0 ||
+		!gpa_sstate ||
+		gpa_sstate->ss_handle == UINT_MAX)
+		return;
+
+	SpinLockAcquire(&gpa_sstate->f_mutex);
+	if (!gpa_sstate->pergpu[dindex].emitted)
+	{
+		gpa_sstate->pergpu[dindex].nr_workers_active++;
+		gpas->shared_final = true;
+	}
+	SpinLockRelease(&gpa_sstate->f_mutex);
+}
+
+/*
+ * gpupreagg_merge_shared_final
+ *
+ * It merges the final buffer of the current worker into the shared one.
+ * If current worker is the last one, the merged result is written back to
+ * the own final buffer to be returned. Elsewhere, it returns nothing.
+ */
+static void
+gpupreagg_merge_shared_final(GpuPreAggState *gpas)
+{
+	GpuContext	   *gcontext = gpas->gts.gcontext;
+	GpuPreAggSharedState *gpa_sstate = gpas->gpa_sstate;
+	pgstrom_data_store *pds_final;
+	kern_data_store *kds_head;
+	kern_gpupreagg *kgpreagg = NULL;
+	CUmodule		cuda_module;
+	CUfunction		kern_merge_shared;
+	CUdeviceptr		m_kds_shared = 0UL;
+	CUdeviceptr		m_kds_final;
+	CUdeviceptr		m_kgpreagg;
+	CUresult		rc;
+	cl_int			dindex = gcontext->cuda_dindex;
+	size_t			f_length;
+	bool			is_allocator = false;
+	bool			is_last = false;
+	void		   *kern_args[4];
+
+	Assert(gpas->shared_final);
+	gpupreagg_alloc_final_buffer(gpas);
+	pds_final = gpas->pds_final;
+	m_kds_final = (CUdeviceptr)&pds_final->kds;
+	f_length = KERN_DATA_STORE_SLOT_LENGTH(&pds_final->kds, 1);
+
+	/* wait for allocation of the shared final buffer by other workers */
+	ConditionVariablePrepareToSleep(&gpa_sstate->f_cond);
+	for (;;)
+	{
+		SpinLockAcquire(&gpa_sstate->f_mutex);
+		if (gpa_sstate->pergpu[dindex].phase == SHARED_FINAL__NONE)
+		{
+			gpa_sstate->pergpu[dindex].phase = SHARED_FINAL__ALLOCATING;
+			is_allocator = true;
+		}
+		if (gpa_sstate->pergpu[dindex].phase != SHARED_FINAL__ALLOCATING ||
+			is_allocator)
+		{
+			SpinLockRelease(&gpa_sstate->f_mutex);
+			break;
+		}
+		SpinLockRelease(&gpa_sstate->f_mutex);
+		ConditionVariableSleep(&gpa_sstate->f_cond, PG_WAIT_EXTENSION);
+	}
+	ConditionVariableCancelSleep();
+
+	if (is_allocator)
+	{
+		rc = gpuMemAllocPreserved(dindex,
+								  &gpa_sstate->pergpu[dindex].ipc_mhandle,
+								  f_length);
+		if (rc != CUDA_SUCCESS)
+			elog(ERROR, "failed on gpuMemAllocPreserved: %s", errorText(rc));
+		gpa_sstate->pergpu[dindex].bytesize = f_length;
+	}
+	rc = gpuIpcOpenMemHandle(gcontext,
+							 &m_kds_shared,
+							 gpa_sstate->pergpu[dindex].ipc_mhandle,
+							 CU_IPC_MEM_LAZY_ENABLE_PEER_ACCESS);
+	if (rc != CUDA_SUCCESS)
+		elog(ERROR, "failed on gpuIpcOpenMemHandle: %s", errorText(rc));
+
+	GPUCONTEXT_PUSH(gcontext);
+	if (is_allocator)
+	{
+		/* init the shared final buffer by the header of own one */
+		kds_head = alloca(KERN_DATA_STORE_HEAD_LENGTH(&pds_final->kds));
+		memcpy(kds_head, &pds_final->kds,
+			   KERN_DATA_STORE_HEAD_LENGTH(&pds_final->kds));
+		kds_head->length = f_length;
+		kds_head->nitems = 0;
+		kds_head->usage  = 0;
+		kds_head->nrooms = 1;
+		rc = cuMemcpyHtoD(m_kds_shared, kds_head,
+						  KERN_DATA_STORE_HEAD_LENGTH(kds_head));
+		if (rc != CUDA_SUCCESS)
+			elog(ERROR, "failed on cuMemcpyHtoD: %s", errorText(rc));
+
+		SpinLockAcquire(&gpa_sstate->f_mutex);
+		gpa_sstate->pergpu[dindex].phase = SHARED_FINAL__READY;
+		SpinLockRelease(&gpa_sstate->f_mutex);
+		ConditionVariableBroadcast(&gpa_sstate->f_cond);
+	}
+
+	/* merge the own final buffer, if any */
+	if (pds_final->kds.nitems > 0)
+	{
+		cuda_module = GpuContextLookupModule(gcontext,
+											 gpas->gts.program_id);
+		rc = cuModuleGetFunction(&kern_merge_shared,
+								 cuda_module,
+								 "kern_gpupreagg_nogroup_merge_shared");
+		if (rc != CUDA_SUCCESS)
+			elog(ERROR, "failed on cuModuleGetFunction: %s", errorText(rc));
+
+		rc = gpuMemAllocManaged(gcontext,
+								&m_kgpreagg,
+								offsetof(kern_gpupreagg, data),
+								CU_MEM_ATTACH_GLOBAL);
+		if (rc != CUDA_SUCCESS)
+			elog(ERROR, "failed on gpuMemAllocManaged: %s", errorText(rc));
+		kgpreagg = (kern_gpupreagg *) m_kgpreagg;
+		memset(kgpreagg, 0, offsetof(kern_gpupreagg, data));
+
+		kern_args[0] = &m_kgpreagg;
+		kern_args[1] = &gpas->gts.kern_params;
+		kern_args[2] = &m_kds_shared;
+		kern_args[3] = &m_kds_final;
+		rc = cuLaunchKernel(kern_merge_shared,
+							1, 1, 1,
+							MAXWARPS_PER_BLOCK, 1, 1,
+							0,
+							CU_STREAM_PER_THREAD,
+							kern_args,
+							NULL);
+		if (rc != CUDA_SUCCESS)
+			elog(ERROR, "failed on cuLaunchKernel: %s", errorText(rc));
+
+		rc = cuStreamSynchronize(CU_STREAM_PER_THREAD);
+		if (rc != CUDA_SUCCESS)
+			elog(ERROR, "failed on cuStreamSynchronize: %s", errorText(rc));
+		if (kgpreagg->kerror.errcode != ERRCODE_STROM_SUCCESS)
+		{
+			GPUCONTEXT_POP(gcontext);
+			elog(ERROR, "GpuPreAgg: failed on merge of the shared final buffer (%s)",
+				 kgpreagg->kerror.message);
+		}
+		gpuMemFree(gcontext, m_kgpreagg);
+	}
+
+	/* is current worker the last one? */
+	SpinLockAcquire(&gpa_sstate->f_mutex);
+	gpa_sstate->pergpu[dindex].nr_workers_merged++;
+	if (gpa_sstate->pergpu[dindex].nr_workers_merged ==
+		gpa_sstate->pergpu[dindex].nr_workers_active)
+	{
+		gpa_sstate->pergpu[dindex].emitted = true;
+		is_last = true;
+	}
+	SpinLockRelease(&gpa_sstate->f_mutex);
+
+	if (is_last)
+	{
+		kern_data_store *kds_shared = alloca(f_length);
+
+		rc = cuMemcpyDtoH(kds_shared, m_kds_shared, f_length);
+		if (rc != CUDA_SUCCESS)
+			elog(ERROR, "failed on cuMemcpyDtoH: %s", errorText(rc));
+		Assert(kds_shared->nitems <= 1);
+		memcpy(KERN_DATA_STORE_VALUES(&pds_final->kds, 0),
+			   KERN_DATA_STORE_VALUES(kds_shared, 0),
+			   f_length - KERN_DATA_STORE_SLOT_LENGTH(kds_shared, 0));
+		pds_final->kds.nitems = kds_shared->nitems;
+	}
+	else
+	{
+		/* the last worker shall return the merged result */
+		pds_final->kds.nitems = 0;
+	}
+	GPUCONTEXT_POP(gcontext);
+
+	rc = gpuIpcCloseMemHandle(gcontext, m_kds_shared);
+	if (rc != CUDA_SUCCESS)
+		elog(WARNING, "failed on gpuIpcCloseMemHandle: %s", errorText(rc));
 }
 
 /*
@@ -5205,7 +6617,7 @@ gpupreagg_alloc_final_buffer(GpuPreAggState *gpas)
 		else
 			f_hash_nslots = gpas->plan_ngroups;
 
-		f_hash_length = 0xffffe000UL;	/* almost 4GB managed */
+		f_hash_length = 0x3ffffe000UL;	/* almost 16GB managed */
 		/*
 		 * The final hash-slot allocation. It initially use the leading
 		 * offsetof(kern_global_hashslot, slots[f_hash_nslots]) bytes
@@ -5213,6 +6625,11 @@ gpupreagg_alloc_final_buffer(GpuPreAggState *gpas)
 		 * is used physically at that time.
 		 * Once @f_hash_nslots becomes unsufficient, GPU kernel expand
 		 * the hash-slot on the demand.
+		 * Its virtual length is as large as the final buffer, because
+		 * hash-slot with 4GB limitation runs out prior to the final buffer
+		 * when number of groups reaches to hundreds millions. Once physical
+		 * usage of the managed memory exceeds the device memory, the unified
+		 * memory evicts the older pages to the host memory.
 		 */
 		rc = gpuMemAllocManaged(gcontext,
 								&m_fhash,
@@ -5228,6 +6645,55 @@ gpupreagg_alloc_final_buffer(GpuPreAggState *gpas)
 	gpas->f_hash_length = f_hash_length;
 }
 
+/*
+ * gpupreagg_choose_local_reduction
+ *
+ * It determines whether the next task skips the local reduction, according
+ * to the run-time statistics by the tasks completed since the last check.
+ * If most of rows missed the local hash-table, the group cardinality is
+ * too large to fit it (likely, the planner estimation was wrong), thus,
+ * the local reduction is pure overhead. It returns true in this case.
+ */
+static bool
+gpupreagg_choose_local_reduction(GpuPreAggState *gpas)
+{
+	GpuPreAggRuntimeStat *gpa_rtstat = gpas->gpa_rtstat;
+	uint64		curr_nitems;
+	uint64		curr_nmisses;
+	uint64		nitems;
+	uint64		nmisses;
+
+	Assert(gpas->num_group_keys > 0);
+	if (gpas->local_hash_nrooms == 0)
+		return true;	/* no local hash-table at all */
+
+	curr_nitems  = pg_atomic_read_u64(&gpa_rtstat->local_nitems);
+	curr_nmisses = pg_atomic_read_u64(&gpa_rtstat->local_nmisses);
+	nitems  = curr_nitems  - gpas->last_local_nitems;
+	nmisses = curr_nmisses - gpas->last_local_nmisses;
+	if (nitems > 0)
+	{
+		bool	skip_local_reduction
+			= ((double)nmisses > gpupreagg_local_miss_threshold *
+			                     (double)nitems);
+		if (gpas->skip_local_reduction != skip_local_reduction)
+			elog(DEBUG2, "GpuPreAgg: %s local reduction (%lu of %lu rows missed)",
+				 skip_local_reduction ? "disables" : "enables",
+				 nmisses, nitems);
+		gpas->skip_local_reduction = skip_local_reduction;
+		gpas->skip_local_ntasks    = 0;
+		gpas->last_local_nitems    = curr_nitems;
+		gpas->last_local_nmisses   = curr_nmisses;
+	}
+
+	if (!gpas->skip_local_reduction)
+		return false;
+	/* probe the local reduction periodically */
+	if (++gpas->skip_local_ntasks % GPUPREAGG_LOCAL_REDUCTION_PROBE_INTERVAL == 0)
+		return false;
+	return true;
+}
+
 /*
  * gpupreagg_create_task - constructor of GpuPreAggTask
  */
@@ -5344,9 +6810,12 @@ gpupreagg_create_task(GpuPreAggState *gpas,
 	{
 		Assert(m_kmrels == 0UL);
 	}
-	/* if any grouping keys, determine the reduction policy later */
+	/* if any grouping keys, determine the reduction policy */
 	gpreagg->kern.num_group_keys = gpas->num_group_keys;
 	gpreagg->kern.suspend_size = suspend_sz;
+	if (gpas->num_group_keys > 0)
+		gpreagg->kern.skip_local_reduction
+			= gpupreagg_choose_local_reduction(gpas);
 
 	return &gpreagg->task;
 }
@@ -5366,6 +6835,9 @@ gpupreagg_next_task(GpuTaskState *gts)
 	pgstrom_data_store *pds = NULL;
 	CUdeviceptr		m_kmrels = 0UL;
 
+	/* prior to scan, register to the shared final buffer if any */
+	gpupreagg_register_shared_final(gpas);
+
 	if (gpas->combined_gpujoin)
 	{
 		GpuTaskState   *outer_gts = (GpuTaskState *) outerPlanState(gpas);
@@ -5388,8 +6860,18 @@ gpupreagg_next_task(GpuTaskState *gts)
 		PlanState	   *outer_ps = outerPlanState(gpas);
 		TupleDesc		tupdesc = ExecGetResultType(outer_ps);
 		TupleTableSlot *slot;
+		bool			scan_done;
 
-		while (true)
+		/* results of the outer GpuJoin on the device, if any */
+		if (gpas->gts.outer_handoff && !gpas->gts.scan_overflow)
+		{
+			pds = GpuJoinExecBulkChunk((GpuTaskState *) outer_ps,
+									   &scan_done);
+			if (scan_done)
+				gpas->gts.scan_overflow = (void *)(~0UL);
+		}
+
+		while (!pds || !pds->device_resident)
 		{
 			if (gpas->gts.scan_overflow)
 			{
@@ -5454,6 +6936,10 @@ gpupreagg_terminator_task(GpuTaskState *gts, cl_bool *task_is_ready)
 			GpuJoinInnerPreload(outer_gts, &m_kmrels))
 			return gpupreagg_create_task(gpas, NULL, m_kmrels, outer_depth);
 	}
+	/* merge to the shared final buffer, if parallel NoGroup reduction */
+	if (gpas->shared_final)
+		gpupreagg_merge_shared_final(gpas);
+
 	/* setup a terminator task */
 	gpas->terminator_done = true;
 	*task_is_ready = true;
@@ -5530,6 +7016,18 @@ gpupreagg_next_tuple(GpuTaskState *gts)
 	}
 	else if (gpas->gts.curr_index < pds_final->kds.nitems)
 	{
+		if (gpas->gts.curr_index == 0)
+		{
+			GpuPreAggRuntimeStat *gpa_rtstat = gpas->gpa_rtstat;
+
+			pg_atomic_add_fetch_u64(&gpa_rtstat->final_nitems,
+									pds_final->kds.nitems);
+			if (!gpas->final_counted)
+			{
+				pg_atomic_add_fetch_u64(&gpa_rtstat->final_nprocs, 1);
+				gpas->final_counted = true;
+			}
+		}
 		slot = gpas->part_slot;
 		ExecClearTuple(slot);
 		PDS_fetch_tuple(slot, pds_final, &gpas->gts);
@@ -5637,6 +7135,16 @@ gpupreaggUpdateRunTimeStat(GpuTaskState *gts, kern_gpupreagg *kgpreagg)
 							(int64)kgpreagg->nitems_real);
 	pg_atomic_add_fetch_u64(&gpa_rtstat->c.nitems_filtered,
 							(int64)kgpreagg->nitems_filtered);
+	if (kgpreagg->skip_local_reduction)
+		pg_atomic_add_fetch_u64(&gpa_rtstat->global_only_ntasks, 1);
+	else if (kgpreagg->local_nitems > 0)
+	{
+		pg_atomic_add_fetch_u64(&gpa_rtstat->local_nmisses,
+								(int64)kgpreagg->local_nmisses);
+		pg_atomic_add_fetch_u64(&gpa_rtstat->local_nitems,
+								(int64)kgpreagg->local_nitems);
+	}
+	updateGpuTaskRuntimeStatProfile(&gpa_rtstat->c, &kgpreagg->profile);
 	//TODO: other statistics
 }
 
@@ -5659,6 +7167,7 @@ gpupreagg_throw_partial_result(GpuPreAggTask *gpreagg,
 							CU_STREAM_PER_THREAD);
 	if (rc != CUDA_SUCCESS)
 		werror("failed on cuMemPrefetchAsync: %s", errorText(rc));
+	gpuMemStatDma(0, gpreagg->kds_slot_length);
 
 	/* setup responder task with supplied @kds_slot */
 	rc = gpuMemAllocManaged(gcontext,
@@ -5711,6 +7220,8 @@ gpupreagg_process_reduction_task(GpuPreAggTask *gpreagg,
 	CUdeviceptr		m_kds_final = (CUdeviceptr)&pds_final->kds;
 	CUdeviceptr		m_fhash = gpas->m_fhash;
 	bool			m_kds_src_release = false;
+	bool			nogroup_arrow = false;
+	size_t			kds_slot_length = gpreagg->kds_slot_length;
 	cl_int			grid_sz;
 	cl_int			block_sz;
 	void		   *last_suspend = NULL;
@@ -5724,6 +7235,24 @@ gpupreagg_process_reduction_task(GpuPreAggTask *gpreagg,
 	 */
 	gpupreagg_init_final_hash(gpreagg, cuda_module);
 
+	/*
+	 * NoGroup reduction on Apache Arrow input runs the setup and reduction
+	 * at once, without materialization of kds_slot.
+	 */
+	if (gpreagg->kern.num_group_keys == 0 &&
+		pds_src->kds.format == KDS_FORMAT_ARROW)
+	{
+		nogroup_arrow = true;
+		kds_slot_length = KERN_DATA_STORE_HEAD_LENGTH(gpas->kds_slot_head);
+
+		rc = cuModuleGetFunction(&kern_setup,
+								 cuda_module,
+								 "kern_gpupreagg_nogroup_arrow");
+		if (rc != CUDA_SUCCESS)
+			werror("failed on cuModuleGetFunction: %s", errorText(rc));
+		goto setup_device_memory;
+	}
+
 	/*
 	 * Lookup kernel functions
 	 */
@@ -5761,6 +7290,7 @@ gpupreagg_process_reduction_task(GpuPreAggTask *gpreagg,
 	/*
 	 * Device memory allocation for short term
 	 */
+setup_device_memory:
 
 	/* kds_src */
 	if (gpreagg->with_nvme_strom)
@@ -5812,10 +7342,10 @@ gpupreagg_process_reduction_task(GpuPreAggTask *gpreagg,
 		m_kds_src = (CUdeviceptr)&pds_src->kds;
 	}
 
-	/* kds_slot */
+	/* kds_slot (header only, if nogroup_arrow) */
 	rc = gpuMemAllocManaged(gcontext,
 							&m_kds_slot,
-							gpreagg->kds_slot_length,
+							kds_slot_length,
 							CU_MEM_ATTACH_GLOBAL);
 	if (rc == CUDA_ERROR_OUT_OF_MEMORY)
 		goto out_of_resource;
@@ -5824,8 +7354,9 @@ gpupreagg_process_reduction_task(GpuPreAggTask *gpreagg,
 
 	memcpy((void *)m_kds_slot, gpas->kds_slot_head,
 		   KERN_DATA_STORE_HEAD_LENGTH(gpas->kds_slot_head));
-	((kern_data_store *)m_kds_slot)->length = gpreagg->kds_slot_length;
-	((kern_data_store *)m_kds_slot)->nrooms = gpreagg->kds_slot_nrooms;
+	((kern_data_store *)m_kds_slot)->length = kds_slot_length;
+	((kern_data_store *)m_kds_slot)->nrooms = (nogroup_arrow ? 0 :
+											   gpreagg->kds_slot_nrooms);
 
 	/*
 	 * OK, kick a series of GpuPreAgg invocations
@@ -5844,6 +7375,7 @@ gpupreagg_process_reduction_task(GpuPreAggTask *gpreagg,
 							   CU_STREAM_PER_THREAD);
 		if (rc != CUDA_SUCCESS)
 			werror("failed on cuMemcpyHtoD: %s", errorText(rc));
+		gpuMemStatDma(pds_src->kds.length, 0);
 	}
 	else if (pds_src->kds.format != KDS_FORMAT_COLUMN)
 	{
@@ -5853,6 +7385,50 @@ gpupreagg_process_reduction_task(GpuPreAggTask *gpreagg,
 								CU_STREAM_PER_THREAD);
 		if (rc != CUDA_SUCCESS)
 			werror("failed on cuMemPrefetchAsync: %s", errorText(rc));
+		if (!pds_src->device_resident)
+			gpuMemStatDma(pds_src->kds.length, 0);
+	}
+	/* decompress kds_src on the device, if compressed */
+	PDS_decompress_arrow(cuda_module, m_kds_src, pds_src,
+						 m_gpreagg + offsetof(kern_gpupreagg, kerror));
+
+	if (nogroup_arrow)
+	{
+		/*
+		 * Launch:
+		 * KERNEL_FUNCTION(void)
+		 * kern_gpupreagg_nogroup_arrow(kern_gpupreagg *kgpreagg,
+		 *                              kern_parambuf *kparams,
+		 *                              kern_data_store *kds_src,
+		 *                              kern_data_store *kds_slot,
+		 *                              kern_data_store *kds_final)
+		 */
+		rc = gpuOptimalBlockSize(&grid_sz,
+								 &block_sz,
+								 kern_setup,
+								 CU_DEVICE_PER_THREAD,
+								 0, 0);
+		if (rc != CUDA_SUCCESS)
+			werror("failed on gpuOptimalBlockSize: %s", errorText(rc));
+		gpreagg->kern.grid_sz = grid_sz;
+		gpreagg->kern.block_sz = block_sz;
+
+		kern_args[0] = &m_gpreagg;
+		kern_args[1] = &gpas->gts.kern_params;
+		kern_args[2] = &m_kds_src;
+		kern_args[3] = &m_kds_slot;
+		kern_args[4] = &m_kds_final;
+		gpuTaskTimerRecord(&gpreagg->task, GPUTASK_TIMER__KERN_BEGIN);
+		rc = cuLaunchKernel(kern_setup,
+							grid_sz, 1, 1,
+							block_sz, 1, 1,
+							0,
+							CU_STREAM_PER_THREAD,
+							kern_args,
+							NULL);
+		if (rc != CUDA_SUCCESS)
+			werror("failed on cuLaunchKernel: %s", errorText(rc));
+		goto kernel_sync;
 	}
 
 	/*
@@ -5880,6 +7456,7 @@ resume_kernel:
 	kern_args[2] = &m_kds_src;
 	kern_args[3] = &m_kds_extra;
 	kern_args[4] = &m_kds_slot;
+	gpuTaskTimerRecord(&gpreagg->task, GPUTASK_TIMER__KERN_BEGIN);
 	rc = cuLaunchKernel(kern_setup,
 						gpreagg->kern.grid_sz, 1, 1,
 						gpreagg->kern.block_sz, 1, 1,
@@ -5913,6 +7490,7 @@ resume_kernel:
 	kern_args[3] = &m_kds_slot;
 	kern_args[4] = &m_kds_final;
 	kern_args[5] = &m_fhash;
+	gpuTaskTimerRecord(&gpreagg->task, GPUTASK_TIMER__KERN_BEGIN);
 	rc = cuLaunchKernel(kern_reduction,
 						grid_sz, 1, 1,
 						block_sz, 1, 1,
@@ -5922,7 +7500,8 @@ resume_kernel:
 						NULL);
 	if (rc != CUDA_SUCCESS)
 		werror("failed on cuLaunchKernel: %s", errorText(rc));
-
+kernel_sync:
+	gpuTaskTimerRecord(&gpreagg->task, GPUTASK_TIMER__KERN_END);
 	rc = cuEventRecord(CU_EVENT_PER_THREAD, CU_STREAM_PER_THREAD);
 	if (rc != CUDA_SUCCESS)
 		werror("failed on cuEventRecord: %s", errorText(rc));
@@ -5978,6 +7557,7 @@ resume_kernel:
 		 * not built yet. So, CPU fallback routine has to refer the kds_src.
 		 * Elsewhere, we can reuse kds_slot built by the kernel.
 		 */
+		gpreagg->task.fallback_errcode = gpreagg->task.kerror.errcode;
 		memset(&gpreagg->task.kerror, 0, sizeof(kern_errorbuf));
 		gpreagg->task.cpu_fallback = true;
 
@@ -6029,6 +7609,7 @@ resume_kernel:
 									CU_STREAM_PER_THREAD);
 			if (rc != CUDA_SUCCESS)
 				werror("failed on cuMemPrefetchAsync: %s", errorText(rc));
+			gpuMemStatDma(0, gpreagg->kds_slot_length);
 			gpreagg->kds_slot = (kern_data_store *) m_kds_slot;
 			m_kds_slot = 0UL;
 		}
@@ -6062,7 +7643,7 @@ gpupreagg_process_combined_task(GpuPreAggTask *gpreagg, CUmodule cuda_module)
 	pgstrom_data_store *pds_src = gpreagg->pds_src;
 	kern_gpujoin   *kgjoin = gpreagg->kgjoin;
 	CUfunction		kern_gpujoin_main;
-	CUfunction		kern_gpupreagg_reduction;
+	CUfunction		kern_gpupreagg_reduction = NULL;
 	CUdeviceptr		m_gpreagg = (CUdeviceptr)&gpreagg->kern;
 	CUdeviceptr		m_kgjoin = (CUdeviceptr)kgjoin;
 	CUdeviceptr		m_kparams = gpreagg->m_kparams;
@@ -6074,6 +7655,9 @@ gpupreagg_process_combined_task(GpuPreAggTask *gpreagg, CUmodule cuda_module)
 	CUdeviceptr		m_fhash = gpas->m_fhash;
 	CUresult		rc;
 	bool			m_kds_src_release = false;
+	bool			nogroup_fused = (gpreagg->kern.num_group_keys == 0);
+	size_t			kds_slot_length = gpreagg->kds_slot_length;
+	cl_uint			kds_slot_nrooms = gpreagg->kds_slot_nrooms;
 	cl_int			grid_sz;
 	cl_int			block_sz;
 	void		   *kern_args[10];
@@ -6089,23 +7673,39 @@ gpupreagg_process_combined_task(GpuPreAggTask *gpreagg, CUmodule cuda_module)
 	/*
 	 * Lookup kernel functions
 	 *
-	 * XXX - needs to kick RIGHT OUTER JOIN
+	 * NoGroup reduction is fused into the projection of GpuJoin; each joined
+	 * row is accumulated on the private buffer, then merged to the final
+	 * buffer at the end of the GpuJoin kernel. So, kds_slot has no rows
+	 * and only its header is referenced to know the layout of tlist_prep.
 	 */
-	rc = cuModuleGetFunction(&kern_gpujoin_main,
-							 cuda_module,
-							 pds_src != NULL
-							 ? "kern_gpujoin_main"
-							 : "kern_gpujoin_right_outer");
-	if (rc != CUDA_SUCCESS)
-		werror("failed on cuModuleGetFunction: %s", errorText(rc));
+	if (nogroup_fused)
+	{
+		rc = cuModuleGetFunction(&kern_gpujoin_main,
+								 cuda_module,
+								 pds_src != NULL
+								 ? "kern_gpujoin_main_nogroup"
+								 : "kern_gpujoin_right_outer_nogroup");
+		if (rc != CUDA_SUCCESS)
+			werror("failed on cuModuleGetFunction: %s", errorText(rc));
+		kds_slot_length = KERN_DATA_STORE_HEAD_LENGTH(gpas->kds_slot_head);
+		kds_slot_nrooms = 0;
+	}
+	else
+	{
+		rc = cuModuleGetFunction(&kern_gpujoin_main,
+								 cuda_module,
+								 pds_src != NULL
+								 ? "kern_gpujoin_main"
+								 : "kern_gpujoin_right_outer");
+		if (rc != CUDA_SUCCESS)
+			werror("failed on cuModuleGetFunction: %s", errorText(rc));
 
-	rc = cuModuleGetFunction(&kern_gpupreagg_reduction,
-							 cuda_module,
-							 gpreagg->kern.num_group_keys == 0
-							 ? "kern_gpupreagg_nogroup_reduction"
-							 : "kern_gpupreagg_groupby_reduction");
-	if (rc != CUDA_SUCCESS)
-		werror("failed on cuModuleGetFunction: %s", errorText(rc));
+		rc = cuModuleGetFunction(&kern_gpupreagg_reduction,
+								 cuda_module,
+								 "kern_gpupreagg_groupby_reduction");
+		if (rc != CUDA_SUCCESS)
+			werror("failed on cuModuleGetFunction: %s", errorText(rc));
+	}
 
 	/* allocation of kds_src */
 	if (!pds_src)
@@ -6164,7 +7764,7 @@ gpupreagg_process_combined_task(GpuPreAggTask *gpreagg, CUmodule cuda_module)
 	 */
 	rc = gpuMemAllocManaged(gcontext,
 							&m_kds_slot,
-							gpreagg->kds_slot_length,
+							kds_slot_length,
 							CU_MEM_ATTACH_GLOBAL);
 	if (rc == CUDA_ERROR_OUT_OF_MEMORY)
 		goto out_of_resource;
@@ -6173,8 +7773,8 @@ gpupreagg_process_combined_task(GpuPreAggTask *gpreagg, CUmodule cuda_module)
 
 	memcpy((kern_data_store *)m_kds_slot, gpas->kds_slot_head,
 		   KERN_DATA_STORE_HEAD_LENGTH(gpas->kds_slot_head));
-	((kern_data_store *)m_kds_slot)->length = gpreagg->kds_slot_length;
-	((kern_data_store *)m_kds_slot)->nrooms = gpreagg->kds_slot_nrooms;
+	((kern_data_store *)m_kds_slot)->length = kds_slot_length;
+	((kern_data_store *)m_kds_slot)->nrooms = kds_slot_nrooms;
 
 	/*
 	 * OK, kick a series of GpuPreAgg invocations
@@ -6193,6 +7793,7 @@ gpupreagg_process_combined_task(GpuPreAggTask *gpreagg, CUmodule cuda_module)
 								   CU_STREAM_PER_THREAD);
 			if (rc != CUDA_SUCCESS)
 				werror("failed on cuMemcpyHtoDAsync: %s", errorText(rc));
+			gpuMemStatDma(pds_src->kds.length, 0);
 		}
 		else if (pds_src->kds.format != KDS_FORMAT_COLUMN)
 		{
@@ -6202,7 +7803,12 @@ gpupreagg_process_combined_task(GpuPreAggTask *gpreagg, CUmodule cuda_module)
 									CU_STREAM_PER_THREAD);
 			if (rc != CUDA_SUCCESS)
 				werror("failed on cuMemPrefetchAsync: %s", errorText(rc));
+			if (!pds_src->device_resident)
+				gpuMemStatDma(pds_src->kds.length, 0);
 		}
+		/* decompress kds_src on the device, if compressed */
+		PDS_decompress_arrow(cuda_module, m_kds_src, pds_src,
+							 m_gpreagg + offsetof(kern_gpupreagg, kerror));
 	}
 resume_kernel:
 	/* make kds_slot empty again */
@@ -6228,6 +7834,9 @@ resume_kernel:
 	 *                     cl_int outer_depth,
 	 *                     kern_data_store *kds_dst,
 	 *                     kern_parambuf *kparams_gpreagg)
+	 *
+	 * (*_nogroup variants take kern_gpupreagg *kgpreagg and
+	 *  kern_data_store *kds_final in addition)
 	 */
 	rc = gpuOptimalBlockSize(&grid_sz,
 							 &block_sz,
@@ -6248,13 +7857,18 @@ resume_kernel:
 		kern_args[4] = &m_kds_extra;
 		kern_args[5] = &m_kds_slot;
 		kern_args[6] = &gpas->gts.kern_params;
+		kern_args[7] = &m_gpreagg;
+		kern_args[8] = &m_kds_final;
 	}
 	else
 	{
 		kern_args[3] = &gpreagg->outer_depth;
 		kern_args[4] = &m_kds_slot;
 		kern_args[5] = &gpas->gts.kern_params;
+		kern_args[6] = &m_gpreagg;
+		kern_args[7] = &m_kds_final;
 	}
+	gpuTaskTimerRecord(&gpreagg->task, GPUTASK_TIMER__KERN_BEGIN);
 	rc = cuLaunchKernel(kern_gpujoin_main,
 						grid_sz, 1, 1,
 						block_sz, 1, 1,
@@ -6264,11 +7878,13 @@ resume_kernel:
 						NULL);
 	if (rc != CUDA_SUCCESS)
 		werror("failed on cuLaunchKernel: %s", errorText(rc));
+	if (nogroup_fused)
+		goto kernel_sync;
 
 	/*
 	 * Launch:
 	 * KERNEL_FUNCTION(void)
-	 * gpupreagg_XXXX_reduction(kern_gpupreagg *kgpreagg,
+	 * gpupreagg_groupby_reduction(kern_gpupreagg *kgpreagg,
 	 *                          kern_parambuf *kparams,
 	 *                          kern_errorbuf *kgjoin_errorbuf,
 	 *                          kern_data_store *kds_slot,
@@ -6289,6 +7905,7 @@ resume_kernel:
 	kern_args[3] = &m_kds_slot;
 	kern_args[4] = &m_kds_final;
 	kern_args[5] = &m_fhash;
+	gpuTaskTimerRecord(&gpreagg->task, GPUTASK_TIMER__KERN_BEGIN);
 	rc = cuLaunchKernel(kern_gpupreagg_reduction,
 						grid_sz, 1, 1,
 						block_sz, 1, 1,
@@ -6298,7 +7915,8 @@ resume_kernel:
 						NULL);
 	if (rc != CUDA_SUCCESS)
 		werror("failed on cuLaunchKernel: %s", errorText(rc));
-
+kernel_sync:
+	gpuTaskTimerRecord(&gpreagg->task, GPUTASK_TIMER__KERN_END);
 	rc = cuEventRecord(CU_EVENT_PER_THREAD, CU_STREAM_PER_THREAD);
 	if (rc != CUDA_SUCCESS)
 		werror("failed on cuEventRecord: %s", errorText(rc));
@@ -6311,14 +7929,19 @@ resume_kernel:
 	if (kgjoin->kerror.errcode != ERRCODE_STROM_SUCCESS)
 	{
 		if (pgstrom_cpu_fallback_enabled &&
-			(kgjoin->kerror.errcode & ERRCODE_FLAGS_CPU_FALLBACK) != 0)
+			(kgjoin->kerror.errcode & ERRCODE_FLAGS_CPU_FALLBACK) != 0 &&
+			!gpreagg->kern.final_buffer_modified)
 		{
 			/*
 			 * CPU fallback without partial results - If GpuJoin reported
 			 * CpuReCheck error, obviously, it didn't touch the final buffer.
 			 * So, CPU fallback routine will generate results based on the
 			 * source buffer.
+			 * Only the fused NoGroup reduction may touch the final buffer,
+			 * by the blocks completed prior to the error; it is not
+			 * recoverable by CPU fallback any more.
 			 */
+			gpreagg->task.fallback_errcode = kgjoin->kerror.errcode;
 			memset(&kgjoin->kerror, 0, sizeof(kern_errorbuf));
 			gpreagg->task.cpu_fallback = true;
 
@@ -6371,6 +7994,7 @@ resume_kernel:
 			 * during the reduction process prior to modification of the
 			 * final buffer.
 			 */
+			gpreagg->task.fallback_errcode = gpreagg->kern.kerror.errcode;
 			memset(&gpreagg->kern.kerror, 0, sizeof(kern_errorbuf));
 
 			Assert(gpreagg->kern.suspend_count == 0);
@@ -6396,11 +8020,12 @@ resume_kernel:
 			else
 			{
 				rc = cuMemPrefetchAsync(m_kds_slot,
-										gpreagg->kds_slot_length,
+										kds_slot_length,
 										CU_DEVICE_CPU,
 										CU_STREAM_PER_THREAD);
 				if (rc != CUDA_SUCCESS)
 					werror("failed on cuMemPrefetchAsync: %s", errorText(rc));
+				gpuMemStatDma(0, kds_slot_length);
 				gpreagg->task.cpu_fallback = true;
 				gpreagg->kds_slot = (kern_data_store *) m_kds_slot;
 				m_kds_slot = 0UL;
@@ -6536,6 +8161,15 @@ pgstrom_init_gpupreagg(void)
 							 PGC_USERSET,
                              GUC_NOT_IN_SAMPLE,
                              NULL, NULL, NULL);
+	/* pg_strom.enable_gpupreagg_distinct */
+	DefineCustomBoolVariable("pg_strom.enable_gpupreagg_distinct",
+							 "Enables GpuPreAgg for deduplication of SELECT DISTINCT",
+							 NULL,
+							 &enable_gpupreagg_distinct,
+							 true,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
 	/* pg_strom.enable_numeric_aggfuncs */
 	DefineCustomBoolVariable("pg_strom.enable_numeric_aggfuncs",
 							 "Enables aggregate functions on numeric type",
@@ -6556,6 +8190,17 @@ pgstrom_init_gpupreagg(void)
 							PGC_USERSET,
 							GUC_NOT_IN_SAMPLE,
 							NULL, NULL, NULL);
+	/* pg_strom.quantile_sketch_bits */
+	DefineCustomIntVariable("pg_strom.quantile_sketch_bits",
+							"Accuracy of quantile_sketch() for percentile estimation",
+							NULL,
+							&pgstrom_quantile_sketch_bits,
+							3,
+							1,
+							QUANTILE_SKETCH_KEY_BITS,
+							PGC_USERSET,
+							GUC_NOT_IN_SAMPLE,
+							NULL, NULL, NULL);
 	/* pg_strom.gpupreagg_reduction_threshold */
 	DefineCustomRealVariable("pg_strom.gpupreagg_reduction_threshold",
 							 "Minimus reduction ratio to use GpuPreAgg",
@@ -6567,6 +8212,39 @@ pgstrom_init_gpupreagg(void)
 							 PGC_USERSET,
 							 GUC_NOT_IN_SAMPLE,
 							 NULL, NULL, NULL);
+	/* pg_strom.enable_gpupreagg_shared_final */
+	DefineCustomBoolVariable("pg_strom.enable_gpupreagg_shared_final",
+							 "Enables the final buffer of NoGroup GpuPreAgg shared by parallel workers",
+							 NULL,
+							 &enable_gpupreagg_shared_final,
+							 true,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	/* pg_strom.gpupreagg_local_miss_threshold */
+	DefineCustomRealVariable("pg_strom.gpupreagg_local_miss_threshold",
+							 "Ratio of rows missed local hash to skip local reduction",
+							 NULL,
+							 &gpupreagg_local_miss_threshold,
+							 0.5,
+							 0.0,
+							 1.0,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	/* pg_strom.gpupreagg_result_cache_size */
+	DefineCustomIntVariable("pg_strom.gpupreagg_result_cache_size",
+							"Size of per-session cache for results of GpuPreAgg on GPU cache",
+							NULL,
+							&gpupreagg_result_cache_size,
+							0,
+							0,
+							INT_MAX,
+							PGC_USERSET,
+							GUC_NOT_IN_SAMPLE | GUC_UNIT_KB,
+							NULL, NULL, NULL);
+	dlist_init(&gpupreagg_rcache_list);
+
 	/* initialization of path method table */
 	memset(&gpupreagg_path_methods, 0, sizeof(CustomPathMethods));
 	gpupreagg_path_methods.CustomName          = "GpuPreAgg";
@@ -19,6 +19,19 @@ static CustomScanMethods	gpuscan_plan_methods;
 static CustomExecMethods	gpuscan_exec_methods;
 bool						enable_gpuscan;		/* GUC */
 static bool					enable_pullup_outer_scan;
+static bool					enable_gpuscan_adaptive_quals;	/* GUC */
+static bool					enable_gpuscan_speculative_cpu;	/* GUC */
+
+/*
+ * Adaptive ordering of the device qualifiers
+ *
+ * If GpuScan has multiple device qualifiers, the generated code evaluates
+ * them in the order given by kern_gpuscan of each task, and counts the
+ * number of evaluations/passed rows for the first several chunks. Then,
+ * GpuScan re-orders the qualifiers according to the measured selectivity
+ * and the estimated cost, for the tasks created later.
+ */
+#define GPUSCAN_ADAPTIVE_NCHUNKS		4
 
 /*
  * form/deform interface of private field of CustomScan(GpuScan)
@@ -35,6 +48,8 @@ typedef struct {
 	Oid			index_oid;		/* OID of BRIN-index, if any */
 	List	   *index_conds;	/* BRIN-index key conditions */
 	List	   *index_quals;	/* original BRIN-index qualifier */
+	bool		arrow_vectorized; /* has vectorized quals for Arrow */
+	List	   *adaptive_costs;	/* cost of dev_quals, if adaptive ordering */
 } GpuScanInfo;
 
 static inline void
@@ -54,6 +69,8 @@ form_gpuscan_info(CustomScan *cscan, GpuScanInfo *gs_info)
 	privs = lappend(privs, makeInteger(gs_info->index_oid));
 	privs = lappend(privs, gs_info->index_conds);
 	exprs = lappend(exprs, gs_info->index_quals);
+	privs = lappend(privs, makeInteger(gs_info->arrow_vectorized));
+	privs = lappend(privs, gs_info->adaptive_costs);
 
 	cscan->custom_private = privs;
 	cscan->custom_exprs = exprs;
@@ -79,12 +96,16 @@ deform_gpuscan_info(CustomScan *cscan)
 	gs_info->index_oid = intVal(list_nth(privs, pindex++));
 	gs_info->index_conds = list_nth(privs, pindex++);
 	gs_info->index_quals = list_nth(exprs, eindex++);
+	gs_info->arrow_vectorized = intVal(list_nth(privs, pindex++));
+	gs_info->adaptive_costs = list_nth(privs, pindex++);
 
 	return gs_info;
 }
 
 typedef struct {
 	GpuTaskRuntimeStat	c;		/* common statistics */
+	pg_atomic_uint64	bytes_scanned;	/* length of the source buffers */
+	pg_atomic_uint64	bytes_received;	/* length of the DMA receive */
 } GpuScanRuntimeStat;
 
 typedef struct {
@@ -98,6 +119,15 @@ typedef struct {
 	GpuScanSharedState *gs_sstate;
 	GpuScanRuntimeStat *gs_rtstat;
 	ExprState	   *dev_quals;		/* quals to be run on the device */
+	bool			arrow_vectorized; /* has vectorized quals for Arrow */
+	/* adaptive ordering of the device qualifiers */
+	cl_int			adaptive_nquals;
+	cl_int		   *adaptive_costs;
+	cl_uchar	   *adaptive_order;
+	cl_uint			adaptive_nchunks;	/* # of sampled chunks */
+	cl_ulong		adaptive_nevals[GPUSCAN_ADAPTIVE_NQUALS_MAX];
+	cl_ulong		adaptive_npassed[GPUSCAN_ADAPTIVE_NQUALS_MAX];
+	bool			adaptive_reordered;
 	/* resource for CPU fallback */
 	cl_uint			fallback_group_id;
 	cl_uint			fallback_local_id;
@@ -124,6 +154,7 @@ static TupleTableSlot *gpuscan_next_tuple(GpuTaskState *gts);
 static void gpuscan_switch_task(GpuTaskState *gts, GpuTask *gtask);
 static int gpuscan_process_task(GpuTask *gtask, CUmodule cuda_module);
 static void gpuscan_release_task(GpuTask *gtask);
+static bool gpuscan_begin_exec(GpuTaskState *gts);
 
 static void createGpuScanSharedState(GpuScanState *gss,
 									 ParallelContext *pcxt,
@@ -146,7 +177,7 @@ cost_for_dma_receive(RelOptInfo *rel, double ntuples)
 		MAXALIGN(offsetof(HeapTupleHeaderData,
 						  t_bits[BITMAPLEN(nattrs)])) +
 		MAXALIGN(reltarget->width);
-	return pgstrom_gpu_dma_cost *
+	return pgstrom_device_dma_cost() *
 		(((double)width_per_tuple * ntuples) / (double)pgstrom_chunk_size());
 }
 
@@ -346,10 +377,9 @@ gpuscan_add_scan_path(PlannerInfo *root,
 			= compute_parallel_worker(baserel,
 									  baserel->pages, -1.0,
 									  max_parallel_workers_per_gather);
-		/*
-		 * XXX - Do we need a something specific logic for GpuScan to adjust
-		 * parallel_workers.
-		 */
+		/* GPU-bound scan needs less workers than CPU scan */
+		parallel_nworkers = pgstrom_gpu_parallel_workers(root, baserel,
+														 parallel_nworkers);
 		if (parallel_nworkers <= 0)
 			return;
 
@@ -419,13 +449,256 @@ reorder_devqual_clauses(PlannerInfo *root, List *dev_quals, List *dev_costs)
 	return results;
 }
 
+/*
+ * codegen_gpuscan_quals_vectorized
+ *
+ * It generates an alternative qualifier for KDS_FORMAT_ARROW, if all the
+ * device quals are simple comparison between an integer column and a
+ * constant (like 'x >= 100 AND x < 200'). The generated function evaluates
+ * 32 rows per thread, with vector loads of the fixed-width values and
+ * word-by-word reference to the null bitmap, then returns the selection
+ * bitmap of the rows.
+ * Comparison on int1/int2 columns with a constant in the range of the
+ * column type is evaluated by SIMD-within-a-register intrinsics, 4 values
+ * per 32bit (int1) or 64bit (int2) load, instead of widening each value.
+ */
+static bool
+codegen_gpuscan_quals_vectorized(StringInfo kern,
+								 const char *component,
+								 Index scanrelid,
+								 List *dev_quals_list)
+{
+	StringInfoData	decl;
+	StringInfoData	fetch;
+	StringInfoData	swar;
+	StringInfoData	cond;
+	Bitmapset	   *varattnos = NULL;
+	ListCell	   *lc;
+	bool			retval = false;
+
+	if (scanrelid == 0 || dev_quals_list == NIL)
+		return false;
+
+	initStringInfo(&decl);
+	initStringInfo(&fetch);
+	initStringInfo(&swar);
+	initStringInfo(&cond);
+	foreach (lc, dev_quals_list)
+	{
+		OpExpr	   *op = lfirst(lc);
+		Node	   *larg;
+		Node	   *rarg;
+		Var		   *var;
+		Const	   *con;
+		List	   *interp_list;
+		ListCell   *cell;
+		int			strategy = 0;
+		int64		cval;
+		const char *opname;
+		const char *vcmp_name;
+
+		if (!IsA(op, OpExpr) || list_length(op->args) != 2)
+			goto bailout;
+		larg = linitial(op->args);
+		rarg = lsecond(op->args);
+		if (IsA(larg, Var) && IsA(rarg, Const))
+		{
+			var = (Var *) larg;
+			con = (Const *) rarg;
+		}
+		else if (IsA(larg, Const) && IsA(rarg, Var))
+		{
+			var = (Var *) rarg;
+			con = (Const *) larg;
+		}
+		else
+			goto bailout;
+		if (var->varno != scanrelid ||
+			var->varattno <= 0 ||
+			var->varlevelsup > 0 ||
+			con->constisnull)
+			goto bailout;
+
+		/* only integer comparison in btree operator family */
+		interp_list = get_op_btree_interpretation(op->opno);
+		foreach (cell, interp_list)
+		{
+			OpBtreeInterpretation *interp = lfirst(cell);
+
+			if ((interp->oplefttype == INT1OID ||
+				 interp->oplefttype == INT2OID ||
+				 interp->oplefttype == INT4OID ||
+				 interp->oplefttype == INT8OID) &&
+				(interp->oprighttype == INT1OID ||
+				 interp->oprighttype == INT2OID ||
+				 interp->oprighttype == INT4OID ||
+				 interp->oprighttype == INT8OID))
+			{
+				strategy = interp->strategy;
+				break;
+			}
+		}
+		list_free_deep(interp_list);
+		/* commute the operator, if constant is on the left side */
+		if ((Node *) con == larg)
+		{
+			if (strategy == BTLessStrategyNumber)
+				strategy = BTGreaterStrategyNumber;
+			else if (strategy == BTLessEqualStrategyNumber)
+				strategy = BTGreaterEqualStrategyNumber;
+			else if (strategy == BTGreaterEqualStrategyNumber)
+				strategy = BTLessEqualStrategyNumber;
+			else if (strategy == BTGreaterStrategyNumber)
+				strategy = BTLessStrategyNumber;
+		}
+		switch (strategy)
+		{
+			case BTLessStrategyNumber:
+				opname = "<";
+				vcmp_name = "lt";
+				break;
+			case BTLessEqualStrategyNumber:
+				opname = "<=";
+				vcmp_name = "le";
+				break;
+			case BTEqualStrategyNumber:
+				opname = "==";
+				vcmp_name = "eq";
+				break;
+			case BTGreaterEqualStrategyNumber:
+				opname = ">=";
+				vcmp_name = "ge";
+				break;
+			case BTGreaterStrategyNumber:
+				opname = ">";
+				vcmp_name = "gt";
+				break;
+			default:
+				goto bailout;
+		}
+
+		if (con->consttype == INT1OID)
+			cval = (int8) con->constvalue;
+		else if (con->consttype == INT2OID)
+			cval = DatumGetInt16(con->constvalue);
+		else if (con->consttype == INT4OID)
+			cval = DatumGetInt32(con->constvalue);
+		else if (con->consttype == INT8OID)
+			cval = DatumGetInt64(con->constvalue);
+		else
+			goto bailout;
+		/* INT64_MIN is not a valid literal */
+		if (cval == PG_INT64_MIN)
+			goto bailout;
+
+		if (!bms_is_member(var->varattno, varattnos))
+		{
+			const char *vtype;
+
+			if (var->vartype == INT1OID)
+				vtype = "cl_char";
+			else if (var->vartype == INT2OID)
+				vtype = "cl_short";
+			else if (var->vartype == INT4OID)
+				vtype = "cl_int";
+			else if (var->vartype == INT8OID)
+				vtype = "cl_long";
+			else
+				goto bailout;
+			appendStringInfo(
+				&decl,
+				"  %s KVEC_%u[4];\n",
+				vtype, var->varattno);
+			appendStringInfo(
+				&decl,
+				"  mask &= arrow_vectorized_nullmask(kds,%u,word_index);\n",
+				var->varattno - 1);
+			appendStringInfo(
+				&fetch,
+				"    arrow_vectorized_fetch(kds,%u,row_base+i,KVEC_%u);\n",
+				var->varattno - 1,
+				var->varattno);
+			varattnos = bms_add_member(varattnos, var->varattno);
+		}
+		if (var->vartype == INT1OID && cval >= PG_INT8_MIN && cval <= PG_INT8_MAX)
+			appendStringInfo(
+				&swar,
+				"    m4 &= arrow_vectorized_%s_int1(KVEC_%u, %ld);\n",
+				vcmp_name, var->varattno, cval);
+		else if (var->vartype == INT2OID && cval >= PG_INT16_MIN && cval <= PG_INT16_MAX)
+			appendStringInfo(
+				&swar,
+				"    m4 &= arrow_vectorized_%s_int2(KVEC_%u, %ld);\n",
+				vcmp_name, var->varattno, cval);
+		else
+			appendStringInfo(
+				&cond,
+				"%s(cl_long)KVEC_%u[j] %s %ldL",
+				cond.len > 0 ? " &&\n          " : "",
+				var->varattno, opname, cval);
+	}
+	/* rows evaluated one by one, if any non-SWAR comparison */
+	if (cond.len > 0)
+	{
+		char   *temp = pstrdup(cond.data);
+
+		resetStringInfo(&cond);
+		appendStringInfo(
+			&cond,
+			"    for (j=0; j < 4; j++)\n"
+			"    {\n"
+			"      if (!(%s))\n"
+			"        m4 &= ~(1U << j);\n"
+			"    }\n", temp);
+		pfree(temp);
+	}
+
+	appendStringInfo(
+		kern,
+		"DEVICE_FUNCTION(cl_uint)\n"
+		"%s_quals_eval_arrow_vectorized(kern_context *kcxt,\n"
+		"                                    kern_data_store *kds,\n"
+		"                                    cl_uint word_index)\n"
+		"{\n"
+		"  cl_uint row_base = 32 * word_index;\n"
+		"  cl_uint mask = ~0U;\n"
+		"  cl_int  i, j;\n"
+		"%s\n"
+		"  for (i=0; i < 32 && mask != 0; i+=4)\n"
+		"  {\n"
+		"    cl_uint m4 = 0x0fU;\n"
+		"%s%s%s"
+		"    mask &= ~((~m4 & 0x0fU) << i);\n"
+		"  }\n"
+		"  return mask;\n"
+		"}\n\n",
+		component,
+		decl.data,
+		fetch.data,
+		swar.data,
+		cond.data);
+	retval = true;
+bailout:
+	pfree(decl.data);
+	pfree(fetch.data);
+	pfree(swar.data);
+	pfree(cond.data);
+	bms_free(varattnos);
+
+	return retval;
+}
+
 /*
  * Code generator for GpuScan's qualifier
+ *
+ * It returns true, if vectorized qualifier for KDS_FORMAT_ARROW is also
+ * generated.
  */
-void
+bool
 codegen_gpuscan_quals(StringInfo kern, codegen_context *context,
 					  const char *component,
-					  Index scanrelid, List *dev_quals_list)
+					  Index scanrelid, List *dev_quals_list,
+					  bool adaptive_order)
 {
 	devtype_info   *dtype;
 	StringInfoData	tfunc;
@@ -436,6 +709,8 @@ codegen_gpuscan_quals(StringInfo kern, codegen_context *context,
 	Var			   *var;
 	char		   *expr_code = NULL;
 	ListCell	   *lc;
+	bool			retval;
+	int				nquals = list_length(dev_quals_list);
 
 	initStringInfo(&tfunc);		/* = ROW/BLOCK */
 	initStringInfo(&afunc);		/* = ARROW */
@@ -445,8 +720,64 @@ codegen_gpuscan_quals(StringInfo kern, codegen_context *context,
 	if (scanrelid == 0 || dev_quals_list == NIL)
 		goto output;
 	/* Let's walk on the device expression tree */
-	dev_quals = (Node *)make_flat_ands_explicit(dev_quals_list);
-	expr_code = pgstrom_codegen_expression(dev_quals, context);
+	if (adaptive_order &&
+		nquals > 1 && nquals <= GPUSCAN_ADAPTIVE_NQUALS_MAX)
+	{
+		int			i;
+
+		/*
+		 * Each qualifier is evaluated in the order of <component>_quals_order[],
+		 * and the number of evaluated/passed rows are counted if
+		 * <component>_quals_nevals is not NULL. These variables are set up
+		 * on the kernel entry (see gpuscan_setup_quals_order).
+		 */
+		resetStringInfo(&temp);
+		appendStringInfo(
+			&temp,
+			"  {\n"
+			"    cl_bool __retval = true;\n"
+			"    cl_int  __k, __q;\n\n"
+			"    for (__k=0; __retval && __k < %d; __k++)\n"
+			"    {\n"
+			"      __q = %s_quals_order[__k];\n"
+			"      switch (__q)\n"
+			"      {\n",
+			nquals, component);
+		i = 0;
+		foreach (lc, dev_quals_list)
+		{
+			char   *code = pgstrom_codegen_expression(lfirst(lc), context);
+
+			appendStringInfo(
+				&temp,
+				"        case %d:\n"
+				"          __retval = EVAL(%s);\n"
+				"          break;\n",
+				i++, code);
+		}
+		appendStringInfo(
+			&temp,
+			"        default:\n"
+			"          break;\n"
+			"      }\n"
+			"      if (%s_quals_nevals)\n"
+			"      {\n"
+			"        atomicAdd(&%s_quals_nevals[__q], 1U);\n"
+			"        if (__retval)\n"
+			"          atomicAdd(&%s_quals_npassed[__q], 1U);\n"
+			"      }\n"
+			"    }\n"
+			"    return __retval;\n"
+			"  }\n",
+			component, component, component);
+		expr_code = pstrdup(temp.data);
+	}
+	else
+	{
+		dev_quals = (Node *)make_flat_ands_explicit(dev_quals_list);
+		expr_code = pgstrom_codegen_expression(dev_quals, context);
+		expr_code = psprintf("  return EVAL(%s);\n", expr_code);
+	}
 	/* Sanity check of used_vars */
 	foreach (lc, context->used_vars)
 	{
@@ -579,9 +910,7 @@ codegen_gpuscan_quals(StringInfo kern, codegen_context *context,
 	}
 output:
 	if (!expr_code)
-		expr_code = pstrdup("true");
-	else
-		expr_code = psprintf("EVAL(%s)", expr_code);
+		expr_code = pstrdup("  return true;\n");
 
 	appendStringInfo(
 		kern,
@@ -593,7 +922,7 @@ output:
 		"{\n"
 		"  void *addr __attribute__((unused));\n"
 		"%s\n"
-		"  return %s;\n"
+		"%s"
 		"}\n\n"
 		"DEVICE_FUNCTION(cl_bool)\n"
 		"%s_quals_eval_arrow(kern_context *kcxt,\n"
@@ -602,7 +931,7 @@ output:
 		"{\n"
 		"  void *addr __attribute__((unused));\n"
 		"%s\n"
-		"  return %s;\n"
+		"%s"
 		"}\n\n"
 		"DEVICE_FUNCTION(cl_bool)\n"
 		"%s_quals_eval_column(kern_context *kcxt,\n"
@@ -612,17 +941,21 @@ output:
 		"{\n"
 		"  void *addr __attribute__((unused));\n"
 		"%s\n"
-		"  return %s;\n"
+		"%s"
 		"}\n\n",
 		component, tfunc.data, expr_code,
 		component, afunc.data, expr_code,
 		component, cfunc.data, expr_code);
-
+	/* vectorized variant for KDS_FORMAT_ARROW, if possible */
+	retval = codegen_gpuscan_quals_vectorized(kern, component,
+											  scanrelid, dev_quals_list);
 	pfree(tfunc.data);
 	pfree(afunc.data);
 	pfree(cfunc.data);
 	pfree(temp.data);
 	pfree(expr_code);
+
+	return retval;
 }
 
 /*
@@ -947,8 +1280,21 @@ codegen_gpuscan_projection(StringInfo kern,
 
 	/*
 	 * step.5 - execution of expression node, then store the result.
+	 * Common sub-expressions across the target-list are evaluated once.
 	 */
 	resetStringInfo(&temp);
+	{
+		List	   *exprs_list = NIL;
+
+		foreach (lc, tlist_dev)
+		{
+			TargetEntry	   *tle = lfirst(lc);
+
+			if (!varremaps[tle->resno-1])
+				exprs_list = lappend(exprs_list, tle->expr);
+		}
+		pgstrom_codegen_common_subexprs(&temp, exprs_list, context);
+	}
 	foreach (lc, tlist_dev)
 	{
 		TargetEntry	   *tle = lfirst(lc);
@@ -983,6 +1329,8 @@ codegen_gpuscan_projection(StringInfo kern,
 		type_oid_list = list_append_unique_oid(type_oid_list,
 											   dtype->type_oid);
 	}
+	context->cse_exprs = NIL;
+	context->cse_widths = NIL;
 	appendStringInfoString(&tbody, temp.data);
 	appendStringInfoString(&abody, temp.data);
 	appendStringInfoString(&cbody, temp.data);
@@ -1308,6 +1656,7 @@ PlanGpuScanPath(PlannerInfo *root,
 	List		   *host_quals = NIL;
 	List		   *dev_quals = NIL;
 	List		   *dev_costs = NIL;
+	List		   *adaptive_costs = NIL;
 	List		   *index_quals = NIL;
 	List		   *tlist_dev = NIL;
 	List		   *outer_refs = NIL;
@@ -1315,6 +1664,7 @@ PlanGpuScanPath(PlannerInfo *root,
 	Bitmapset	   *varattnos = NULL;
 	cl_int			qual_extra_sz = 0;
 	cl_int			i, j;
+	bool			arrow_vectorized;
 	StringInfoData	kern;
 	codegen_context	context;
 
@@ -1354,6 +1704,27 @@ PlanGpuScanPath(PlannerInfo *root,
 	dev_quals = extract_actual_clauses(dev_quals, false);
 	index_quals = extract_actual_clauses(gs_info->index_quals, false);
 
+	/*
+	 * Static cost of the device qualifiers, for the adaptive ordering
+	 * at run-time
+	 */
+	if (enable_gpuscan_adaptive_quals &&
+		list_length(dev_quals) > 1 &&
+		list_length(dev_quals) <= GPUSCAN_ADAPTIVE_NQUALS_MAX)
+	{
+		foreach (cell, dev_quals)
+		{
+			int		devcost;
+
+			if (!pgstrom_device_expression_devcost(root,
+												   baserel,
+												   lfirst(cell),
+												   &devcost))
+				elog(ERROR, "Bug? device qualifier is not executable");
+			adaptive_costs = lappend_int(adaptive_costs, Max(devcost, 1));
+		}
+	}
+
 	/*
 	 * Code construction for the CUDA kernel code
 	 */
@@ -1362,8 +1733,11 @@ PlanGpuScanPath(PlannerInfo *root,
 
 	initStringInfo(&kern);
 	pgstrom_init_codegen_context(&context, root, baserel);
-	codegen_gpuscan_quals(&kern, &context, "gpuscan",
-						  baserel->relid, dev_quals);
+	arrow_vectorized = codegen_gpuscan_quals(&kern, &context, "gpuscan",
+											 baserel->relid, dev_quals,
+											 adaptive_costs != NIL);
+	if (!baseRelIsArrowFdw(baserel))
+		arrow_vectorized = false;
 	qual_extra_sz = context.extra_bufsz;
 	context.extra_bufsz = 0;
 	tlist_dev = build_gpuscan_projection(root,
@@ -1422,6 +1796,8 @@ PlanGpuScanPath(PlannerInfo *root,
 	gs_info->used_params = context.used_params;
 	gs_info->dev_quals = dev_quals;
 	gs_info->index_quals = index_quals;
+	gs_info->arrow_vectorized = arrow_vectorized;
+	gs_info->adaptive_costs = adaptive_costs;
 	form_gpuscan_info(cscan, gs_info);
 
 	return &cscan->scan.plan;
@@ -1593,12 +1969,24 @@ void
 assign_gpuscan_session_info(StringInfo buf, GpuTaskState *gts)
 {
 	CustomScan *cscan = (CustomScan *)gts->css.ss.ps.plan;
+	bool		arrow_vectorized = false;
+	int			adaptive_nquals = 0;
+
+	if (pgstrom_planstate_is_gpuscan(&gts->css.ss.ps))
+	{
+		arrow_vectorized = ((GpuScanState *) gts)->arrow_vectorized;
+		adaptive_nquals = ((GpuScanState *) gts)->adaptive_nquals;
+	}
 
 	appendStringInfo(
 		buf,
 		"/* GpuScan session info */\n"
-		"#define GPUSCAN_HAS_DEVICE_PROJECTION %d\n\n",
-		cscan->custom_scan_tlist != NIL ? 1 : 0);
+		"#define GPUSCAN_HAS_DEVICE_PROJECTION %d\n"
+		"#define GPUSCAN_HAS_ARROW_VECTORIZED_QUALS %d\n"
+		"#define GPUSCAN_ADAPTIVE_NQUALS %d\n\n",
+		cscan->custom_scan_tlist != NIL ? 1 : 0,
+		arrow_vectorized ? 1 : 0,
+		adaptive_nquals);
 }
 
 /*
@@ -1675,6 +2063,26 @@ ExecInitGpuScan(CustomScanState *node, EState *estate, int eflags)
 	gss->gts.cb_switch_task = gpuscan_switch_task;
 	gss->gts.cb_process_task = gpuscan_process_task;
 	gss->gts.cb_release_task = gpuscan_release_task;
+	gss->gts.cb_speculative_task = gpuscan_speculative_task;
+	gss->gts.cb_begin_exec  = gpuscan_begin_exec;
+	gss->arrow_vectorized = gs_info->arrow_vectorized;
+	gss->adaptive_nquals = list_length(gs_info->adaptive_costs);
+	if (gss->adaptive_nquals > 0)
+	{
+		ListCell   *lc;
+		int			i = 0;
+
+		gss->adaptive_costs = palloc(sizeof(cl_int) * gss->adaptive_nquals);
+		gss->adaptive_order = palloc(sizeof(cl_uchar) * gss->adaptive_nquals);
+		foreach (lc, gs_info->adaptive_costs)
+		{
+			gss->adaptive_costs[i] = lfirst_int(lc);
+			gss->adaptive_order[i] = i;
+			i++;
+		}
+	}
+	gss->adaptive_nchunks = 0;
+	gss->adaptive_reordered = false;
 
 	/* initialize device qualifiers/projection stuff, for CPU fallback */
 	dev_quals_raw = (List *)
@@ -1702,6 +2110,8 @@ ExecInitGpuScan(CustomScanState *node, EState *estate, int eflags)
 								gs_info->index_oid,
 								gs_info->index_conds,
 								gs_info->index_quals);
+	/* or, zone-map if no BRIN-index */
+	pgstromExecInitZoneMapIndexMap(&gss->gts, gs_info->dev_quals);
 
 	/* Get CUDA program and async build if any */
 	initStringInfo(&kern_define);
@@ -1761,6 +2171,20 @@ ExecReCheckGpuScan(CustomScanState *node, TupleTableSlot *epq_slot)
 	return retval;
 }
 
+/*
+ * gpuscan_begin_exec
+ */
+static bool
+gpuscan_begin_exec(GpuTaskState *gts)
+{
+	GpuScanState   *gss = (GpuScanState *) gts;
+
+	ActivateGpuContext(gss->gts.gcontext);
+	if (!gss->gs_sstate)
+		createGpuScanSharedState(gss, NULL, NULL);
+	return true;
+}
+
 /*
  * ExecGpuScan
  */
@@ -1769,9 +2193,7 @@ ExecGpuScan(CustomScanState *node)
 {
 	GpuScanState   *gss = (GpuScanState *) node;
 
-	ActivateGpuContext(gss->gts.gcontext);
-	if (!gss->gs_sstate)
-		createGpuScanSharedState(gss, NULL, NULL);
+	gpuscan_begin_exec(&gss->gts);
 	return ExecScan(&node->ss,
 					(ExecScanAccessMtd) pgstromExecGpuTaskState,
 					(ExecScanRecheckMtd) ExecReCheckGpuScan);
@@ -1842,13 +2264,7 @@ ExecGpuScanInitDSM(CustomScanState *node,
 				  SynchronizeGpuContextOnDSMDetach,
 				  PointerGetDatum(gss->gts.gcontext));
 	coordinate = ((char *)coordinate + gss->gs_sstate->ss_length);
-	if (gss->gts.outer_index_state)
-	{
-		gss->gts.outer_index_map = (Bitmapset *)coordinate;
-		gss->gts.outer_index_map->nwords = -1;	/* uninitialized */
-		coordinate = ((char *)coordinate +
-					  pgstromSizeOfBrinIndexMap(&gss->gts));
-	}
+	coordinate = pgstromInitDSMBrinIndexMap(&gss->gts, coordinate);
 	pgstromInitDSMGpuTaskState(&gss->gts, pcxt, coordinate);
 }
 
@@ -1869,12 +2285,7 @@ ExecGpuScanInitWorker(CustomScanState *node,
 				  PointerGetDatum(gss->gts.gcontext));
 	coordinate = ((char *)coordinate +
 				  MAXALIGN(sizeof(GpuScanSharedState)));
-	if (gss->gts.outer_index_state)
-	{
-		gss->gts.outer_index_map = (Bitmapset *)coordinate;
-		coordinate = ((char *)coordinate +
-					  pgstromSizeOfBrinIndexMap(&gss->gts));
-	}
+	coordinate = pgstromInitWorkerBrinIndexMap(&gss->gts, coordinate);
 	pgstromInitWorkerGpuTaskState(&gss->gts, coordinate);
 }
 
@@ -1977,6 +2388,52 @@ ExplainGpuScan(CustomScanState *node, List *ancestors, ExplainState *es)
 			ExplainPropertyInteger("Rows Removed by GPU Filter", NULL,
 								   gss->gts.outer_instrument.nfiltered1 /
 								   gss->gts.outer_instrument.nloops, es);
+		if (es->analyze && gss->adaptive_reordered)
+		{
+			StringInfoData buf;
+			int		i;
+
+			/* show the qualifiers in the order of run-time evaluation */
+			initStringInfo(&buf);
+			for (i=0; i < gss->adaptive_nquals; i++)
+			{
+				Node   *qual = list_nth(gs_info->dev_quals,
+										gss->adaptive_order[i]);
+
+				exprstr = deparse_expression(qual, dcontext,
+											 es->verbose, false);
+				appendStringInfo(&buf, "%s%s",
+								 i == 0 ? "" : ", ", exprstr);
+			}
+			ExplainPropertyText("GPU Filter Order", buf.data, es);
+			pfree(buf.data);
+		}
+	}
+	/* Show amount of the data scanned and received */
+	if (es->analyze && gs_rtstat)
+	{
+		uint64		scanned_sz = pg_atomic_read_u64(&gs_rtstat->bytes_scanned);
+		uint64		received_sz = pg_atomic_read_u64(&gs_rtstat->bytes_received);
+
+		if (scanned_sz > 0)
+		{
+			if (es->format == EXPLAIN_FORMAT_TEXT)
+			{
+				exprstr = psprintf("%s scanned, %s received (%.2f%%)",
+								   format_bytesz(scanned_sz),
+								   format_bytesz(received_sz),
+								   100.0 * (double) received_sz /
+								   (double) scanned_sz);
+				ExplainPropertyText("Data Transfer", exprstr, es);
+			}
+			else
+			{
+				ExplainPropertyInteger("Bytes-Scanned", NULL,
+									   scanned_sz, es);
+				ExplainPropertyInteger("Bytes-Received", NULL,
+									   received_sz, es);
+			}
+		}
 	}
 	/* BRIN-index properties */
 	pgstromExplainBrinIndexMap(&gss->gts, es, dcontext);
@@ -2075,10 +2532,83 @@ gpuscan_create_task(GpuScanState *gss,
 	gscan->pds_src = pds_src;
 	gscan->pds_dst = pds_dst;
 	gscan->kern.suspend_sz = suspend_sz;
+	/* current order of the device qualifiers */
+	if (gss->adaptive_nquals > 0)
+	{
+		memcpy(gscan->kern.quals_order, gss->adaptive_order,
+			   sizeof(cl_uchar) * gss->adaptive_nquals);
+		gscan->kern.quals_sampling =
+			(gss->adaptive_nchunks < GPUSCAN_ADAPTIVE_NCHUNKS);
+	}
 
 	return gscan;
 }
 
+/*
+ * gpuscan_adaptive_reorder_quals
+ *
+ * It accumulates the number of evaluated/passed rows for each qualifier
+ * sampled by the kernel, then re-orders the qualifiers by the rank;
+ * cost / (1 - selectivity), once GPUSCAN_ADAPTIVE_NCHUNKS chunks are
+ * sampled. The qualifier with smallest rank shall be evaluated first.
+ * The new order is applied to the tasks created later, because each task
+ * carries its own order in kern_gpuscan.
+ */
+static void
+gpuscan_adaptive_reorder_quals(GpuScanState *gss, GpuScanTask *gscan)
+{
+	cl_int		nquals = gss->adaptive_nquals;
+	double		rank[GPUSCAN_ADAPTIVE_NQUALS_MAX];
+	cl_uchar	order[GPUSCAN_ADAPTIVE_NQUALS_MAX];
+	int			i, j;
+
+	if (nquals == 0 ||
+		!gscan->kern.quals_sampling ||
+		gscan->task.cpu_fallback ||
+		gscan->task.adaptive_cpu ||
+		gss->adaptive_nchunks >= GPUSCAN_ADAPTIVE_NCHUNKS)
+		return;
+	for (i=0; i < nquals; i++)
+	{
+		gss->adaptive_nevals[i] += gscan->kern.quals_nevals[i];
+		gss->adaptive_npassed[i] += gscan->kern.quals_npassed[i];
+	}
+	if (++gss->adaptive_nchunks < GPUSCAN_ADAPTIVE_NCHUNKS)
+		return;
+
+	/*
+	 * MEMO: qualifiers never evaluated (because the prior ones filtered
+	 * out all the rows) keep the current relative position, by the
+	 * rank larger than any others.
+	 */
+	for (i=0; i < nquals; i++)
+	{
+		cl_int	k = gss->adaptive_order[i];
+
+		order[i] = k;
+		if (gss->adaptive_nevals[k] == 0)
+			rank[k] = DBL_MAX;
+		else
+			rank[k] = (double) gss->adaptive_costs[k] /
+				Max(1.0 - ((double) gss->adaptive_npassed[k] /
+						   (double) gss->adaptive_nevals[k]), 1.0e-6);
+	}
+	/* insertion sort; stable for the qualifiers with same rank */
+	for (i=1; i < nquals; i++)
+	{
+		cl_uchar	k = order[i];
+
+		for (j=i; j > 0 && rank[order[j-1]] > rank[k]; j--)
+			order[j] = order[j-1];
+		order[j] = k;
+	}
+	if (memcmp(gss->adaptive_order, order, sizeof(cl_uchar) * nquals) != 0)
+	{
+		memcpy(gss->adaptive_order, order, sizeof(cl_uchar) * nquals);
+		gss->adaptive_reordered = true;
+	}
+}
+
 static void
 gpuscan_switch_task(GpuTaskState *gts, GpuTask *gtask)
 {
@@ -2086,6 +2616,7 @@ gpuscan_switch_task(GpuTaskState *gts, GpuTask *gtask)
 
 	gss->fallback_group_id = 0;
 	gss->fallback_local_id = 0;
+	gpuscan_adaptive_reorder_quals(gss, (GpuScanTask *) gtask);
 }
 
 /*
@@ -2111,6 +2642,31 @@ gpuscan_next_task(GpuTaskState *gts)
 	return &gscan->task;
 }
 
+/*
+ * gpuscan_speculative_task
+ *
+ * It marks the GpuScanTask to be processed by CPU, using the CPU fallback
+ * code, while the GPU program is still being built. Only the chunks whose
+ * contents are already loaded on the host memory can run on CPU.
+ */
+static bool
+gpuscan_speculative_task(GpuTaskState *gts, GpuTask *gtask)
+{
+	GpuScanTask	   *gscan = (GpuScanTask *) gtask;
+	pgstrom_data_store *pds_src = gscan->pds_src;
+
+	if (!enable_gpuscan_speculative_cpu || gts->gc_state)
+		return false;
+	if (pds_src->kds.format == KDS_FORMAT_ROW ||
+		(pds_src->kds.format == KDS_FORMAT_BLOCK &&
+		 pds_src->nblocks_uncached == 0))
+	{
+		gscan->task.cpu_fallback = true;
+		return true;
+	}
+	return false;
+}
+
 /*
  * gpuscan_next_tuple_suspended_tuple
  */
@@ -2164,6 +2720,7 @@ static bool
 gpuscan_next_tuple_suspended_block(GpuScanState *gss, GpuScanTask *gscan)
 {
 	pgstrom_data_store *pds_src = gscan->pds_src;
+	Snapshot	snapshot = gss->gts.css.ss.ps.state->es_snapshot;
 	gpuscanSuspendContext *con;
 	cl_uint		group_id;
 	cl_uint		local_id;
@@ -2221,6 +2778,9 @@ gpuscan_next_tuple_suspended_block(GpuScanState *gss, GpuScanTask *gscan)
 				tuple->t_tableOid = pds_src->kds.table_oid;
 				tuple->t_data = (HeapTupleHeader)((char *)hpage +
 												  ItemIdGetOffset(lpp));
+				if (!PageIsAllVisible(hpage) &&
+					!pgstromHeapTupleSatisfiesMVCC(tuple->t_data, snapshot))
+					continue;
 				ExecForceStoreHeapTuple(tuple, gss->base_slot, false);
 
 				return true;
@@ -2379,6 +2939,7 @@ __gpuscan_process_task(GpuTask *gtask, CUmodule cuda_module)
 	CUdeviceptr		m_kds_src = 0UL;
 	CUdeviceptr		m_kds_extra = 0UL;
 	CUdeviceptr		m_kds_dst = (CUdeviceptr)&pds_dst->kds;
+	CUdeviceptr		m_arrow_selmap = 0UL;
 	bool			m_kds_src_release = false;
 	const char	   *kern_fname;
 	void		   *kern_args[5];
@@ -2491,6 +3052,7 @@ __gpuscan_process_task(GpuTask *gtask, CUmodule cuda_module)
 							   CU_STREAM_PER_THREAD);
 		if (rc != CUDA_SUCCESS)
 			werror("failed on cuMemcpyHtoDAsync: %s", errorText(rc));
+		gpuMemStatDma(pds_src->kds.length, 0);
 	}
 	else if (pds_src->kds.format != KDS_FORMAT_COLUMN)
 	{
@@ -2500,8 +3062,13 @@ __gpuscan_process_task(GpuTask *gtask, CUmodule cuda_module)
 								CU_STREAM_PER_THREAD);
 		if (rc != CUDA_SUCCESS)
 			werror("failed on cuMemPrefetchAsync: %s", errorText(rc));
+		gpuMemStatDma(pds_src->kds.length, 0);
 	}
 
+	/* decompress kds_src on the device, if compressed */
+	PDS_decompress_arrow(cuda_module, m_kds_src, pds_src,
+						 m_gpuscan + offsetof(kern_gpuscan, kerror));
+
 	/* head of the kds_dst, if any */
 	length = KERN_DATA_STORE_HEAD_LENGTH(&pds_dst->kds);
 	rc = cuMemPrefetchAsync(m_kds_dst,
@@ -2511,6 +3078,63 @@ __gpuscan_process_task(GpuTask *gtask, CUmodule cuda_module)
 	if (rc != CUDA_SUCCESS)
 		werror("failed on cuMemPrefetchAsync: %s", errorText(rc));
 
+	/*
+	 * KERNEL_FUNCTION(void)
+	 * kern_gpuscan_quals_arrow_vectorized(kern_gpuscan *kgpuscan,
+	 *                                     kern_parambuf *kparams,
+	 *                                     kern_data_store *kds_src)
+	 *
+	 * If WHERE-clause is simple enough, it builds the selection bitmap
+	 * prior to the main kernel, then it skips per-row evaluation.
+	 * It is just an optimization, so we fall back to the per-row
+	 * evaluation on the lack of device memory.
+	 */
+	gscan->kern.arrow_selmap = NULL;
+	if (pds_src->kds.format == KDS_FORMAT_ARROW &&
+		pds_src->kds.nitems > 0 &&
+		gss->arrow_vectorized)
+	{
+		CUfunction	kern_arrow_vectorized;
+
+		rc = cuModuleGetFunction(&kern_arrow_vectorized,
+								 cuda_module,
+								 "kern_gpuscan_quals_arrow_vectorized");
+		if (rc != CUDA_SUCCESS)
+			werror("failed on cuModuleGetFunction: %s", errorText(rc));
+
+		length = sizeof(cl_uint) * ((pds_src->kds.nitems + 31) / 32);
+		rc = gpuMemAlloc(gcontext, &m_arrow_selmap, length);
+		if (rc == CUDA_ERROR_OUT_OF_MEMORY)
+			m_arrow_selmap = 0UL;
+		else if (rc != CUDA_SUCCESS)
+			werror("failed on gpuMemAlloc: %s", errorText(rc));
+		else
+		{
+			rc = gpuOptimalBlockSize(&grid_sz,
+									 &block_sz,
+									 kern_arrow_vectorized,
+									 CU_DEVICE_PER_THREAD,
+									 0, 0);
+			if (rc != CUDA_SUCCESS)
+				werror("failed on gpuOptimalBlockSize: %s", errorText(rc));
+			gscan->kern.arrow_selmap = (cl_uint *)m_arrow_selmap;
+
+			kern_args[0] = &m_gpuscan;
+			kern_args[1] = &gss->gts.kern_params;
+			kern_args[2] = &m_kds_src;
+			gpuTaskTimerRecord(&gscan->task, GPUTASK_TIMER__KERN_BEGIN);
+			rc = cuLaunchKernel(kern_arrow_vectorized,
+								grid_sz, 1, 1,
+								block_sz, 1, 1,
+								0,
+								CU_STREAM_PER_THREAD,
+								kern_args,
+								NULL);
+			if (rc != CUDA_SUCCESS)
+				werror("failed on cuLaunchKernel: %s", errorText(rc));
+		}
+	}
+
 	/*
 	 * KERNEL_FUNCTION(void)
 	 * gpuscan_exec_quals_XXXX(kern_gpuscan *kgpuscan,
@@ -2537,6 +3161,7 @@ resume_kernel:
 	kern_args[3] = &m_kds_extra;
 	kern_args[4] = &m_kds_dst;
 
+	gpuTaskTimerRecord(&gscan->task, GPUTASK_TIMER__KERN_BEGIN);
 	rc = cuLaunchKernel(kern_gpuscan_quals,
 						grid_sz, 1, 1,
 						block_sz, 1, 1,
@@ -2547,6 +3172,7 @@ resume_kernel:
 	if (rc != CUDA_SUCCESS)
 		werror("failed on cuLaunchKernel: %s", errorText(rc));
 
+	gpuTaskTimerRecord(&gscan->task, GPUTASK_TIMER__KERN_END);
 	rc = cuEventRecord(CU_EVENT_PER_THREAD, CU_STREAM_PER_THREAD);
 	if (rc != CUDA_SUCCESS)
 		werror("failed on cuEventRecord: %s", errorText(rc));
@@ -2575,6 +3201,15 @@ resume_kernel:
 								nitems_in);
 		pg_atomic_add_fetch_u64(&gs_rtstat->c.nitems_filtered,
 								nitems_in - nitems_out);
+		updateGpuTaskRuntimeStatProfile(&gs_rtstat->c, &gscan->kern.profile);
+		if (!gscan->kern.resume_context)
+			pg_atomic_add_fetch_u64(&gs_rtstat->bytes_scanned,
+									pds_src->kds.length);
+		/*
+		 * MEMO: kds_dst is already compacted by the kernel; the qualified
+		 * rows are packed at the head of the slot array, and their extra
+		 * area is packed at the tail. So, we receive only these portions.
+		 */
 		if (nitems_out > 0)
 		{
 			length = KERN_DATA_STORE_SLOT_LENGTH(&pds_dst->kds, nitems_out);
@@ -2584,6 +3219,8 @@ resume_kernel:
 									CU_STREAM_PER_THREAD);
 			if (rc != CUDA_SUCCESS)
 				werror("failed on cuMemPrefetchAsync: %s", errorText(rc));
+			pg_atomic_add_fetch_u64(&gs_rtstat->bytes_received, length);
+			gpuMemStatDma(0, length);
 
 			if (pds_dst->kds.usage > 0)
 			{
@@ -2595,6 +3232,8 @@ resume_kernel:
 										CU_STREAM_PER_THREAD);
 				if (rc != CUDA_SUCCESS)
 					werror("failed on cuMemPrefetchAsync: %s", errorText(rc));
+				pg_atomic_add_fetch_u64(&gs_rtstat->bytes_received, length);
+				gpuMemStatDma(0, length);
 			}
 		}
 
@@ -2652,6 +3291,7 @@ resume_kernel:
 			{
 				gscan->pds_src = PDS_writeback_arrow(pds_src, m_kds_src);
 			}
+			gscan->task.fallback_errcode = gscan->task.kerror.errcode;
 			memset(&gscan->task.kerror, 0, sizeof(kern_errorbuf));
 			gscan->task.cpu_fallback = true;
 			/* restore suspend context, if any */
@@ -2667,6 +3307,11 @@ resume_kernel:
 out_of_resource:
 	if (m_kds_src_release)
 		gpuMemFree(gcontext, m_kds_src);
+	if (m_arrow_selmap)
+	{
+		gpuMemFree(gcontext, m_arrow_selmap);
+		gscan->kern.arrow_selmap = NULL;
+	}
 	return retval;
 }
 
@@ -2754,6 +3399,24 @@ pgstrom_init_gpuscan(void)
 							 PGC_USERSET,
                              GUC_NOT_IN_SAMPLE,
                              NULL, NULL, NULL);
+	/* pg_strom.gpuscan_adaptive_quals */
+	DefineCustomBoolVariable("pg_strom.gpuscan_adaptive_quals",
+							 "Enables run-time re-ordering of GpuScan qualifiers",
+							 NULL,
+							 &enable_gpuscan_adaptive_quals,
+							 true,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	/* pg_strom.gpuscan_speculative_cpu */
+	DefineCustomBoolVariable("pg_strom.gpuscan_speculative_cpu",
+							 "Enables GpuScan to run on CPU during GPU program build",
+							 NULL,
+							 &enable_gpuscan_speculative_cpu,
+							 true,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
 
 	/* setup path methods */
 	memset(&gpuscan_path_methods, 0, sizeof(gpuscan_path_methods));
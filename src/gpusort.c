@@ -0,0 +1,2954 @@
+/*
+ * gpusort.c
+ *
+ * GPU accelerated sorting on the results of the outer plan
+ * ----
+ * Copyright 2011-2021 (C) KaiGai Kohei <kaigai@kaigai.gr.jp>
+ * Copyright 2014-2021 (C) PG-Strom Developers Team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the PostgreSQL License.
+ */
+#include "pg_strom.h"
+#include "cuda_gpusort.h"
+
+static create_upper_paths_hook_type create_upper_paths_next;
+static CustomPathMethods	gpusort_path_methods;
+static CustomScanMethods	gpusort_plan_methods;
+static CustomExecMethods	gpusort_exec_methods;
+bool						enable_gpusort;		/* GUC */
+static bool					enable_gpusort_radix;	/* GUC */
+static bool					enable_gpusort_window;	/* GUC */
+static int					gpusort_max_host_memory_kb;	/* GUC */
+
+/*
+ * window functions that GpuSort can run on the sorted rows
+ */
+#define GPUSORT_WINFUNC__ROW_NUMBER		1
+#define GPUSORT_WINFUNC__RANK			2
+#define GPUSORT_WINFUNC__DENSE_RANK		3
+
+/*
+ * form/deform interface of private field of CustomScan(GpuSort)
+ */
+typedef struct {
+	const Bitmapset *optimal_gpus; /* optimal GPUs */
+	char	   *kern_source;	/* source of the CUDA kernel */
+	cl_uint		extra_flags;	/* extra libraries to be included */
+	cl_uint		extra_bufsz;	/* buffer size of temporary varlena datum */
+	List	   *used_params;
+	List	   *sort_keys;		/* resno of the sorting keys */
+	List	   *sort_ops;		/* OID of the sorting operators */
+	List	   *sort_collations;/* OID of the sorting collations */
+	List	   *sort_nulls_first; /* NULLS FIRST, or not */
+	cl_long		sort_bound;		/* top-K bound by LIMIT, or 0 if none */
+	List	   *radix_keybits;	/* bits of the radix sort keys, or NIL */
+	Index		winref;			/* winref of the window, or 0 if none */
+	cl_int		num_part_keys;	/* number of PARTITION BY keys */
+	List	   *window_funcs;	/* GPUSORT_WINFUNC__* of the window functions */
+} GpuSortInfo;
+
+static inline void
+form_gpusort_info(CustomScan *cscan, GpuSortInfo *gs_info)
+{
+	List	   *privs = NIL;
+	List	   *exprs = NIL;
+
+	privs = lappend(privs, bms_to_pglist(gs_info->optimal_gpus));
+	privs = lappend(privs, makeString(gs_info->kern_source));
+	privs = lappend(privs, makeInteger(gs_info->extra_flags));
+	privs = lappend(privs, makeInteger(gs_info->extra_bufsz));
+	exprs = lappend(exprs, gs_info->used_params);
+	privs = lappend(privs, gs_info->sort_keys);
+	privs = lappend(privs, gs_info->sort_ops);
+	privs = lappend(privs, gs_info->sort_collations);
+	privs = lappend(privs, gs_info->sort_nulls_first);
+	privs = lappend(privs, makeInteger(gs_info->sort_bound));
+	privs = lappend(privs, gs_info->radix_keybits);
+	privs = lappend(privs, makeInteger(gs_info->winref));
+	privs = lappend(privs, makeInteger(gs_info->num_part_keys));
+	privs = lappend(privs, gs_info->window_funcs);
+
+	cscan->custom_private = privs;
+	cscan->custom_exprs = exprs;
+}
+
+static inline GpuSortInfo *
+deform_gpusort_info(CustomScan *cscan)
+{
+	GpuSortInfo *gs_info = palloc0(sizeof(GpuSortInfo));
+	List	   *privs = cscan->custom_private;
+	List	   *exprs = cscan->custom_exprs;
+	int			pindex = 0;
+	int			eindex = 0;
+
+	gs_info->optimal_gpus = bms_from_pglist(list_nth(privs, pindex++));
+	gs_info->kern_source = strVal(list_nth(privs, pindex++));
+	gs_info->extra_flags = intVal(list_nth(privs, pindex++));
+	gs_info->extra_bufsz = intVal(list_nth(privs, pindex++));
+	gs_info->used_params = list_nth(exprs, eindex++);
+	gs_info->sort_keys = list_nth(privs, pindex++);
+	gs_info->sort_ops = list_nth(privs, pindex++);
+	gs_info->sort_collations = list_nth(privs, pindex++);
+	gs_info->sort_nulls_first = list_nth(privs, pindex++);
+	gs_info->sort_bound = intVal(list_nth(privs, pindex++));
+	gs_info->radix_keybits = list_nth(privs, pindex++);
+	gs_info->winref = intVal(list_nth(privs, pindex++));
+	gs_info->num_part_keys = intVal(list_nth(privs, pindex++));
+	gs_info->window_funcs = list_nth(privs, pindex++);
+
+	return gs_info;
+}
+
+typedef struct {
+	GpuTaskRuntimeStat	c;		/* common statistics */
+} GpuSortRuntimeStat;
+
+typedef struct {
+	dsm_handle		ss_handle;		/* DSM handle of the SharedState */
+	cl_uint			ss_length;		/* Length of the SharedState */
+	GpuSortRuntimeStat gs_rtstat;
+} GpuSortSharedState;
+
+typedef struct {
+	GpuTaskState	gts;
+	GpuSortSharedState *gs_sstate;
+	GpuSortRuntimeStat *gs_rtstat;
+	/* sorting keys */
+	int				num_sort_keys;
+	AttrNumber	   *sort_keys;
+	Oid			   *sort_ops;
+	Oid			   *sort_collations;
+	bool		   *sort_nulls_first;
+	cl_long			sort_bound;
+	cl_uint		   *radix_keybits;	/* bits of the radix sort keys, if any */
+	SortSupport		ssup;		/* for merge / CPU sort of the runs */
+	/* window functions */
+	int				num_part_keys;
+	int				num_window_funcs;
+	int			   *window_funcs;	/* GPUSORT_WINFUNC__* */
+	TupleTableSlot *input_slot;		/* slot for the outer rows */
+	MemoryContext	win_cxt;		/* keys of the current peer group */
+	Datum		   *win_values;
+	bool		   *win_isnull;
+	cl_long			win_count;
+	cl_long			win_row_number;
+	cl_long			win_rank;
+	cl_long			win_dense_rank;
+	/* state of the input stream */
+	bool			input_done;
+	size_t			max_buffer_size;
+	/* out-of-core sorting with multiple sorted runs */
+	bool			multi_runs;
+	bool			merge_started;
+	cl_uint			num_runs;
+	List		   *sorted_runs;	/* list of GpuSortTask already sorted */
+	struct GpuSortMergeRun *merge_runs;
+	binaryheap	   *merge_heap;
+	cl_long			merge_count;
+	/* resource for CPU fallback */
+	Tuplesortstate *tuplesort;
+	bool			tuplesort_done;
+	TupleTableSlot *fallback_slot;
+} GpuSortState;
+
+typedef struct
+{
+	GpuTask				task;
+	/* all the outer rows in KDS_FORMAT_ROW, if any */
+	pgstrom_data_store *pds_src;
+	cl_uint			   *sorted_index;	/* result index after the sorting */
+	cl_uchar		   *window_flags;	/* GPUSORT_WINDOW_* flags, if any */
+	bool				is_merge_run;	/* a sorted run to be merged */
+	bool				is_merge_task;	/* terminator task to merge the runs */
+	bool				retained;		/* run is kept until merge end */
+	kern_gpusort		kern;
+} GpuSortTask;
+
+/*
+ * GpuSortMergeRun - current status of the sorted run during k-way merge
+ */
+typedef struct GpuSortMergeRun
+{
+	GpuSortTask	   *gsort;
+	cl_uint			nitems;
+	cl_uint			curr_pos;
+	Datum		   *values;		/* sorting keys of the head row */
+	bool		   *isnull;
+} GpuSortMergeRun;
+
+/*
+ * static functions
+ */
+static GpuTask  *gpusort_next_task(GpuTaskState *gts);
+static GpuTask  *gpusort_terminator_task(GpuTaskState *gts,
+										 cl_bool *task_is_ready);
+static TupleTableSlot *gpusort_next_tuple(GpuTaskState *gts);
+static int gpusort_process_task(GpuTask *gtask, CUmodule cuda_module);
+static void gpusort_release_task(GpuTask *gtask);
+
+static void createGpuSortSharedState(GpuSortState *gss);
+static void gpusort_release_merge_runs(GpuSortState *gss);
+
+/*
+ * gpusort_lookup_sortkey
+ *
+ * It checks whether the sorting key can be compared on the device, or not.
+ * GpuSort uses the comparison function of the default btree operator class
+ * of the data type, so the sorting operator must be either of '<' or '>'
+ * operator of the same operator class.
+ */
+static bool
+gpusort_lookup_sortkey(Expr *sortkey, Oid sort_op, Oid sort_collid,
+					   devtype_info **p_dtype,
+					   devfunc_info **p_dfunc,
+					   bool *p_is_desc)
+{
+	Oid				type_oid = exprType((Node *)sortkey);
+	devtype_info   *dtype;
+	devfunc_info   *dfunc;
+	TypeCacheEntry *tcache;
+
+	dtype = pgstrom_devtype_lookup(type_oid);
+	if (!dtype)
+		return false;
+	dfunc = pgstrom_devfunc_lookup_type_compare(dtype, sort_collid);
+	if (!dfunc)
+		return false;
+	tcache = lookup_type_cache(type_oid, TYPECACHE_LT_OPR |
+										 TYPECACHE_GT_OPR);
+	if (sort_op == tcache->lt_opr)
+		*p_is_desc = false;
+	else if (sort_op == tcache->gt_opr)
+		*p_is_desc = true;
+	else
+		return false;
+
+	if (p_dtype)
+		*p_dtype = dtype;
+	if (p_dfunc)
+		*p_dfunc = dfunc;
+	return true;
+}
+
+/*
+ * gpusort_lookup_sortkey_by_ref
+ */
+static Expr *
+gpusort_lookup_sortkey_by_ref(PathTarget *target, Index sortgroupref)
+{
+	ListCell   *lc;
+	int			i = 0;
+
+	foreach (lc, target->exprs)
+	{
+		if (get_pathtarget_sortgroupref(target, i) == sortgroupref)
+			return (Expr *) lfirst(lc);
+		i++;
+	}
+	return NULL;
+}
+
+/*
+ * gpusort_radix_key_bits
+ *
+ * It returns the width of sorting key in bits, if the data type has
+ * order-preserving unsigned integer representation for the radix sort.
+ * Otherwise, it returns 0.
+ */
+static int
+gpusort_radix_key_bits(Oid type_oid)
+{
+	switch (type_oid)
+	{
+		case INT2OID:
+			return 16;
+		case INT4OID:
+		case FLOAT4OID:
+		case DATEOID:
+			return 32;
+		case INT8OID:
+		case FLOAT8OID:
+		case TIMESTAMPOID:
+		case TIMESTAMPTZOID:
+			return 64;
+		default:
+			break;
+	}
+	return 0;
+}
+
+/*
+ * gpusort_tuple_width - width of a row on the KDS_FORMAT_ROW buffer
+ */
+static double
+gpusort_tuple_width(PathTarget *target)
+{
+	int			nattrs = list_length(target->exprs);
+
+	return (double)(sizeof(cl_uint) +
+					offsetof(kern_tupitem, htup) +
+					MAXALIGN(offsetof(HeapTupleHeaderData,
+									  t_bits[BITMAPLEN(nattrs)])) +
+					MAXALIGN(target->width));
+}
+
+/*
+ * gpusort_fits_host_memory
+ *
+ * The sorted runs are kept on the managed memory until the final merge,
+ * then they migrate to the host memory; no temp-file spill. So we don't
+ * choose GpuSort if the estimated input exceeds
+ * pg_strom.gpusort_max_host_memory, and let the CPU Sort that spills
+ * to the temp files handle it. Note that the top-K bound does not reduce
+ * the consumption, because every run keeps the entire rows.
+ */
+static bool
+gpusort_fits_host_memory(Path *input_path)
+{
+	double		total_sz = (gpusort_tuple_width(input_path->pathtarget) *
+							Max(input_path->rows, 1.0));
+
+	return (total_sz <= (double)gpusort_max_host_memory_kb * 1024.0);
+}
+
+/*
+ * cost_gpusort - cost estimation for GpuSort
+ */
+static void
+cost_gpusort(PlannerInfo *root, CustomPath *cpath, Path *input_path,
+			 int num_sort_keys, List *radix_keybits, cl_long sort_bound)
+{
+	PathTarget *target = input_path->pathtarget;
+	double		ntuples = Max(input_path->rows, 2.0);
+	double		nfetches = ntuples;
+	double		width_per_tuple;
+	Cost		comparison_cost = 2.0 * pgstrom_device_operator_cost();
+	Cost		startup_cost;
+	Cost		run_cost;
+
+	/* all the outer rows must be read before the sorting */
+	startup_cost = input_path->total_cost;
+	/* fixed cost to setup/launch GPU kernel */
+	startup_cost += pgstrom_gpu_setup_cost;
+	/* cost to load the outer rows onto the KDS_FORMAT_ROW buffer */
+	startup_cost += cpu_tuple_cost * ntuples;
+	/* cost for DMA send of the KDS_FORMAT_ROW buffer */
+	width_per_tuple = gpusort_tuple_width(target);
+	startup_cost += pgstrom_device_dma_cost() *
+		((width_per_tuple * ntuples) / (double)pgstrom_chunk_size());
+	if (radix_keybits != NIL)
+	{
+		ListCell   *lc;
+		int			num_passes = 0;
+
+		/* radix sorting on the device; digits and NULL flag for each key */
+		foreach (lc, radix_keybits)
+			num_passes += lfirst_int(lc) / GPUSORT_RADIX_BITS + 1;
+		startup_cost += (pgstrom_device_operator_cost() *
+						 (double)num_passes * ntuples);
+	}
+	else
+	{
+		/* bitonic sorting on the device */
+		startup_cost += (comparison_cost * (double)num_sort_keys *
+						 ntuples * log2(ntuples));
+	}
+	/*
+	 * cost to fetch the sorted rows; only the top-K rows are written back
+	 * to the host, if bounded.
+	 */
+	if (sort_bound > 0 && sort_bound < ntuples)
+		nfetches = (double) sort_bound;
+	startup_cost += pgstrom_device_dma_cost() *
+		((width_per_tuple * nfetches) / (double)pgstrom_chunk_size());
+	run_cost = cpu_operator_cost * nfetches;
+
+	cpath->path.rows = input_path->rows;
+	cpath->path.startup_cost = startup_cost;
+	cpath->path.total_cost = startup_cost + run_cost;
+}
+
+/*
+ * gpusort_check_sortkeys
+ *
+ * It checks whether every sorting key is executable on the device, and
+ * returns the bits of the radix sort keys if all the keys are fixed-width.
+ */
+static bool
+gpusort_check_sortkeys(PathTarget *target, List *sort_clauses,
+					   List **p_radix_keybits)
+{
+	List	   *radix_keybits = NIL;
+	bool		radix_sortable = enable_gpusort_radix;
+	ListCell   *lc;
+
+	foreach (lc, sort_clauses)
+	{
+		SortGroupClause *sgc = lfirst(lc);
+		Expr	   *sortkey;
+		bool		is_desc;
+
+		if (!OidIsValid(sgc->sortop))
+			return false;
+		sortkey = gpusort_lookup_sortkey_by_ref(target,
+												sgc->tleSortGroupRef);
+		if (!sortkey)
+			return false;
+		if (!gpusort_lookup_sortkey(sortkey,
+									sgc->sortop,
+									exprCollation((Node *)sortkey),
+									NULL, NULL, &is_desc))
+		{
+			elog(DEBUG2, "GpuSort: sorting key is not device executable: %s",
+				 nodeToString(sortkey));
+			pgstrom_record_offload_blocker("GpuSort: sorting key is not device executable: %s",
+										   format_type_be(exprType((Node *)sortkey)));
+			return false;
+		}
+		if (radix_sortable)
+		{
+			int		keybits = gpusort_radix_key_bits(exprType((Node *)sortkey));
+
+			if (keybits > 0)
+				radix_keybits = lappend_int(radix_keybits, keybits);
+			else
+				radix_sortable = false;
+		}
+	}
+	/* radix sort is available if all the keys are fixed-width */
+	*p_radix_keybits = (radix_sortable ? radix_keybits : NIL);
+	return true;
+}
+
+/*
+ * gpusort_get_sort_bound
+ *
+ * It returns the number of rows required by the constant LIMIT/OFFSET
+ * clause, or 0 if unbounded. root->limit_tuples is not available here,
+ * because the planner clears it on the queries with aggregates, GROUP BY,
+ * DISTINCT or window functions, to avoid bounded sort under the grouping;
+ * however, GpuSort on the ordered relation is the last step prior to the
+ * LIMIT, so we can apply the bound as preprocess_limit() does.
+ */
+static cl_long
+gpusort_get_sort_bound(PlannerInfo *root, Path *input_path)
+{
+	Query	   *parse = root->parse;
+	Const	   *con;
+	double		nrows = 0.0;
+
+	if (!parse->limitCount)
+		return 0;
+	/* SRFs and row-locks run on the sorted rows, prior to the LIMIT */
+	if (parse->hasTargetSRFs || parse->rowMarks != NIL)
+		return 0;
+#if PG_VERSION_NUM >= 130000
+	/* WITH TIES may return more rows than the LIMIT */
+	if (parse->limitOption != LIMIT_OPTION_COUNT)
+		return 0;
+#endif
+	/*
+	 * The bound is embedded in the plan, so Param shall not be estimated
+	 * unlike preprocess_limit(); the generic plan may be reused.
+	 */
+	con = (Const *) parse->limitCount;
+	if (!IsA(con, Const) || con->constisnull)
+		return 0;
+	nrows = (double) DatumGetInt64(con->constvalue);
+	if (nrows <= 0.0)
+		return 0;
+	if (parse->limitOffset)
+	{
+		con = (Const *) parse->limitOffset;
+		if (!IsA(con, Const))
+			return 0;
+		if (!con->constisnull && DatumGetInt64(con->constvalue) > 0)
+			nrows += (double) DatumGetInt64(con->constvalue);
+	}
+	if (nrows >= input_path->rows || nrows >= (double) INT_MAX)
+		return 0;
+	return (cl_long) nrows;
+}
+
+/*
+ * create_gpusort_path - constructor of CustomPath(GpuSort) node
+ */
+static Path *
+create_gpusort_path(PlannerInfo *root,
+					RelOptInfo *ordered_rel,
+					Path *input_path)
+{
+	Query		   *parse = root->parse;
+	PathTarget	   *target = input_path->pathtarget;
+	CustomPath	   *cpath;
+	GpuSortInfo	   *gs_info;
+	List		   *radix_keybits;
+
+	if (parse->sortClause == NIL)
+		return NULL;
+	/*
+	 * Our executor does not support parameterized or partial input paths
+	 */
+	if (input_path->param_info != NULL || input_path->parallel_aware)
+		return NULL;
+	/* Is every sorting key executable on the device? */
+	if (!gpusort_check_sortkeys(target, parse->sortClause, &radix_keybits))
+		return NULL;
+	/* Are the sorted runs fit to the host memory? */
+	if (!gpusort_fits_host_memory(input_path))
+		return NULL;
+
+	gs_info = palloc0(sizeof(GpuSortInfo));
+	gs_info->optimal_gpus = gpujoin_get_optimal_gpus(input_path);
+	gs_info->radix_keybits = radix_keybits;
+	/*
+	 * If LIMIT clause is constant, we need to return only the top-K rows.
+	 * It is typical for the queries like 'ORDER BY agg DESC LIMIT N' on
+	 * top of GpuPreAgg or GpuJoin.
+	 */
+	gs_info->sort_bound = gpusort_get_sort_bound(root, input_path);
+
+	cpath = makeNode(CustomPath);
+	cpath->path.pathtype		= T_CustomScan;
+	cpath->path.parent			= ordered_rel;
+	cpath->path.pathtarget		= target;
+	cpath->path.param_info		= NULL;
+	cpath->path.parallel_aware	= false;
+	cpath->path.parallel_safe	= false;
+	cpath->path.parallel_workers = 0;
+	cpath->path.pathkeys		= root->sort_pathkeys;
+	cpath->flags				= 0;
+	cpath->custom_paths			= list_make1(input_path);
+	cpath->custom_private		= list_make2(gs_info, NIL);
+	cpath->methods				= &gpusort_path_methods;
+	cost_gpusort(root, cpath, input_path,
+				 list_length(parse->sortClause),
+				 gs_info->radix_keybits,
+				 gs_info->sort_bound);
+
+	return &cpath->path;
+}
+
+/*
+ * gpusort_window_func_kind
+ *
+ * It returns GPUSORT_WINFUNC__* if the window function is a ranking
+ * function that GpuSort can compute on the sorted rows, or 0.
+ */
+static int
+gpusort_window_func_kind(WindowFunc *wfunc)
+{
+	const char *func_name;
+
+	if (wfunc->args != NIL ||
+		wfunc->aggfilter != NULL ||
+		wfunc->winagg ||
+		get_func_namespace(wfunc->winfnoid) != PG_CATALOG_NAMESPACE)
+		return 0;
+	func_name = get_func_name(wfunc->winfnoid);
+	if (strcmp(func_name, "row_number") == 0)
+		return GPUSORT_WINFUNC__ROW_NUMBER;
+	if (strcmp(func_name, "rank") == 0)
+		return GPUSORT_WINFUNC__RANK;
+	if (strcmp(func_name, "dense_rank") == 0)
+		return GPUSORT_WINFUNC__DENSE_RANK;
+	return 0;
+}
+
+static bool
+gpusort_window_func_walker(Node *node, List **p_window_exprs)
+{
+	if (!node)
+		return false;
+	if (IsA(node, WindowFunc))
+	{
+		*p_window_exprs = list_append_unique(*p_window_exprs, node);
+		return false;
+	}
+	return expression_tree_walker(node, gpusort_window_func_walker,
+								  (void *) p_window_exprs);
+}
+
+/*
+ * gpusort_lookup_window_clause
+ */
+static WindowClause *
+gpusort_lookup_window_clause(Query *parse, Index winref)
+{
+	ListCell   *lc;
+
+	foreach (lc, parse->windowClause)
+	{
+		WindowClause *wc = lfirst(lc);
+
+		if (wc->winref == winref)
+			return wc;
+	}
+	elog(ERROR, "Bug? GpuSort could not find window clause for winref %u",
+		 winref);
+}
+
+/*
+ * create_gpusort_window_path
+ *
+ * It constructs CustomPath(GpuSort) node that sorts the rows according to
+ * the PARTITION BY and ORDER BY clause of the window, then computes the
+ * ranking window functions on the sorted rows; instead of Sort + WindowAgg.
+ * Only a single window with row_number, rank and dense_rank is supported.
+ */
+static Path *
+create_gpusort_window_path(PlannerInfo *root,
+						   RelOptInfo *window_rel,
+						   Path *input_path,
+						   PathTarget *target)
+{
+	CustomPath	   *cpath;
+	GpuSortInfo	   *gs_info;
+	WindowClause   *wc;
+	List		   *window_exprs = NIL;
+	List		   *window_funcs = NIL;
+	List		   *sort_clauses;
+	List		   *radix_keybits;
+	Index			winref = 0;
+	double			ntuples;
+	ListCell	   *lc;
+
+	if (input_path->param_info != NULL || input_path->parallel_aware)
+		return NULL;
+	/* Are all the window functions supported? */
+	foreach (lc, target->exprs)
+		gpusort_window_func_walker((Node *) lfirst(lc), &window_exprs);
+	foreach (lc, window_exprs)
+	{
+		WindowFunc *wfunc = lfirst(lc);
+		int			kind = gpusort_window_func_kind(wfunc);
+
+		if (kind == 0)
+			return NULL;
+		if (winref == 0)
+			winref = wfunc->winref;
+		else if (winref != wfunc->winref)
+			return NULL;	/* multiple windows are not supported */
+		window_funcs = lappend_int(window_funcs, kind);
+	}
+	if (winref == 0)
+		return NULL;
+	wc = gpusort_lookup_window_clause(root->parse, winref);
+	sort_clauses = list_concat(list_copy(wc->partitionClause),
+							   list_copy(wc->orderClause));
+	if (sort_clauses == NIL)
+		return NULL;	/* no need to sort the rows */
+	if (!gpusort_check_sortkeys(input_path->pathtarget,
+								sort_clauses, &radix_keybits))
+		return NULL;
+	if (!gpusort_fits_host_memory(input_path))
+		return NULL;
+
+	gs_info = palloc0(sizeof(GpuSortInfo));
+	gs_info->optimal_gpus = gpujoin_get_optimal_gpus(input_path);
+	gs_info->radix_keybits = radix_keybits;
+	gs_info->winref = winref;
+	gs_info->num_part_keys = list_length(wc->partitionClause);
+	gs_info->window_funcs = window_funcs;
+
+	cpath = makeNode(CustomPath);
+	cpath->path.pathtype		= T_CustomScan;
+	cpath->path.parent			= window_rel;
+	cpath->path.pathtarget		= target;
+	cpath->path.param_info		= NULL;
+	cpath->path.parallel_aware	= false;
+	cpath->path.parallel_safe	= false;
+	cpath->path.parallel_workers = 0;
+	cpath->path.pathkeys =
+		make_pathkeys_for_sortclauses(root, sort_clauses,
+									  make_tlist_from_pathtarget(input_path->pathtarget));
+	cpath->flags				= 0;
+	cpath->custom_paths			= list_make1(input_path);
+	cpath->custom_private		= list_make2(gs_info, window_exprs);
+	cpath->methods				= &gpusort_path_methods;
+	cost_gpusort(root, cpath, input_path,
+				 list_length(sort_clauses),
+				 gs_info->radix_keybits, 0);
+	/* boundary of partitions and peers on GPU, then ranks on CPU */
+	ntuples = Max(input_path->rows, 2.0);
+	cpath->path.startup_cost += (2.0 * pgstrom_device_operator_cost() *
+								 (double) list_length(sort_clauses) * ntuples);
+	cpath->path.total_cost += (2.0 * pgstrom_device_operator_cost() *
+							   (double) list_length(sort_clauses) * ntuples +
+							   cpu_operator_cost *
+							   (double) list_length(window_funcs) * ntuples);
+	return &cpath->path;
+}
+
+/*
+ * gpusort_add_ordered_paths
+ */
+static void
+gpusort_add_ordered_paths(PlannerInfo *root,
+						  RelOptInfo *input_rel,
+						  RelOptInfo *ordered_rel)
+{
+	PathTarget *target = root->upper_targets[UPPERREL_ORDERED];
+	Path	   *input_path;
+	Path	   *sorted_path;
+
+	/* no need to sort, if cheapest path is already sorted */
+	input_path = input_rel->cheapest_total_path;
+	if (pathkeys_contained_in(root->sort_pathkeys, input_path->pathkeys))
+		return;
+
+	sorted_path = create_gpusort_path(root, ordered_rel, input_path);
+	if (!sorted_path)
+		return;
+	/* Add projection step if needed */
+	if (target && sorted_path->pathtarget != target)
+		sorted_path = apply_projection_to_path(root, ordered_rel,
+											   sorted_path, target);
+	add_path(ordered_rel, sorted_path);
+}
+
+/*
+ * gpusort_add_window_paths
+ */
+static void
+gpusort_add_window_paths(PlannerInfo *root,
+						 RelOptInfo *input_rel,
+						 RelOptInfo *window_rel)
+{
+	PathTarget *target = root->upper_targets[UPPERREL_WINDOW];
+	Path	   *window_path;
+
+	if (!enable_gpusort_window || !target)
+		return;
+	window_path = create_gpusort_window_path(root, window_rel,
+											 input_rel->cheapest_total_path,
+											 target);
+	if (window_path)
+		add_path(window_rel, window_path);
+}
+
+/*
+ * gpusort_add_upper_paths
+ *
+ * entrypoint to add sorting path by GpuSort logic
+ */
+static void
+gpusort_add_upper_paths(PlannerInfo *root,
+						UpperRelationKind stage,
+						RelOptInfo *input_rel,
+						RelOptInfo *output_rel,
+						void *extra)
+{
+	if (create_upper_paths_next)
+		(*create_upper_paths_next)(root, stage, input_rel, output_rel, extra);
+
+	if (stage != UPPERREL_ORDERED && stage != UPPERREL_WINDOW)
+		return;
+
+	if (!pgstrom_enabled || !enable_gpusort)
+		return;
+
+	/* CREATE EXTENSION pg_strom; was not executed */
+	if (get_namespace_oid("pgstrom", true) == InvalidOid)
+		return;
+
+	if (stage == UPPERREL_ORDERED)
+		gpusort_add_ordered_paths(root, input_rel, output_rel);
+	else
+		gpusort_add_window_paths(root, input_rel, output_rel);
+}
+
+/*
+ * __codegen_gpusort_keycomp
+ *
+ * It generates a comparison function of the leading @nkeys sorting keys.
+ */
+static void
+__codegen_gpusort_keycomp(StringInfo kern,
+						  codegen_context *context,
+						  List *outer_tlist,
+						  GpuSortInfo *gs_info,
+						  const char *func_name,
+						  int nkeys)
+{
+	StringInfoData	decl;
+	StringInfoData	body;
+	ListCell	   *lc1, *lc2, *lc3, *lc4;
+	int				keyno = 1;
+
+	/* no sorting keys to be compared; e.g, without PARTITION BY */
+	if (nkeys == 0)
+	{
+		appendStringInfo(
+			kern,
+			"DEVICE_FUNCTION(cl_int)\n"
+			"%s(kern_context *kcxt,\n"
+			"    kern_data_store *kds_src,\n"
+			"    cl_uint x_index,\n"
+			"    cl_uint y_index)\n"
+			"{\n"
+			"  return 0;\n"
+			"}\n",
+			func_name);
+		return;
+	}
+	initStringInfo(&decl);
+	initStringInfo(&body);
+
+	forfour (lc1, gs_info->sort_keys,
+			 lc2, gs_info->sort_ops,
+			 lc3, gs_info->sort_collations,
+			 lc4, gs_info->sort_nulls_first)
+	{
+		AttrNumber		resno = lfirst_int(lc1);
+		Oid				sort_op = lfirst_oid(lc2);
+		Oid				sort_collid = lfirst_oid(lc3);
+		bool			nulls_first = (lfirst_int(lc4) != 0);
+		TargetEntry	   *tle = list_nth(outer_tlist, resno - 1);
+		devtype_info   *dtype;
+		devfunc_info   *dfunc;
+		bool			is_desc;
+
+		if (keyno > nkeys)
+			break;
+		if (!gpusort_lookup_sortkey(tle->expr, sort_op, sort_collid,
+									&dtype, &dfunc, &is_desc))
+			elog(ERROR, "Bug? GpuSort: sorting key is not device executable: %s",
+				 nodeToString(tle->expr));
+		pgstrom_devfunc_track(context, dfunc);
+		context->extra_bufsz += 2 * MAXALIGN(dtype->extra_sz);
+
+		appendStringInfo(
+			&decl,
+			"  pg_%s_t KVAR_X%d;\n"
+			"  pg_%s_t KVAR_Y%d;\n",
+			dtype->type_name, keyno,
+			dtype->type_name, keyno);
+		appendStringInfo(
+			&body,
+			"\n"
+			"  /* sorting key %d */\n"
+			"  if (kds_src->format == KDS_FORMAT_ROW)\n"
+			"  {\n"
+			"    addr = kern_get_datum_tuple(kds_src->colmeta,\n"
+			"                                &x_tup->htup, %d);\n"
+			"    pg_datum_ref(kcxt, KVAR_X%d, addr);\n"
+			"    addr = kern_get_datum_tuple(kds_src->colmeta,\n"
+			"                                &y_tup->htup, %d);\n"
+			"    pg_datum_ref(kcxt, KVAR_Y%d, addr);\n"
+			"  }\n"
+			"  else\n"
+			"  {\n"
+			"    pg_datum_ref_slot(kcxt, KVAR_X%d,\n"
+			"                      KERN_DATA_STORE_DCLASS(kds_src, x_index)[%d],\n"
+			"                      KERN_DATA_STORE_VALUES(kds_src, x_index)[%d]);\n"
+			"    pg_datum_ref_slot(kcxt, KVAR_Y%d,\n"
+			"                      KERN_DATA_STORE_DCLASS(kds_src, y_index)[%d],\n"
+			"                      KERN_DATA_STORE_VALUES(kds_src, y_index)[%d]);\n"
+			"  }\n"
+			"  if (!KVAR_X%d.isnull || !KVAR_Y%d.isnull)\n"
+			"  {\n"
+			"    if (KVAR_X%d.isnull)\n"
+			"      return %d;\n"
+			"    if (KVAR_Y%d.isnull)\n"
+			"      return %d;\n"
+			"    comp = pgfn_%s(kcxt, KVAR_X%d, KVAR_Y%d);\n"
+			"    if (comp.isnull)\n"
+			"      return 0;\n"
+			"    if (comp.value != 0)\n"
+			"      return (comp.value > 0 ? %d : %d);\n"
+			"  }\n",
+			keyno,
+			resno - 1, keyno,
+			resno - 1, keyno,
+			keyno, resno - 1, resno - 1,
+			keyno, resno - 1, resno - 1,
+			keyno, keyno,
+			keyno, nulls_first ? -1 : 1,
+			keyno, nulls_first ? 1 : -1,
+			dfunc->func_devname, keyno, keyno,
+			is_desc ? -1 : 1,
+			is_desc ? 1 : -1);
+		keyno++;
+	}
+
+	appendStringInfo(
+		kern,
+		"DEVICE_FUNCTION(cl_int)\n"
+		"%s(kern_context *kcxt,\n"
+		"    kern_data_store *kds_src,\n"
+		"    cl_uint x_index,\n"
+		"    cl_uint y_index)\n"
+		"{\n"
+		"  kern_tupitem *x_tup = NULL;\n"
+		"  kern_tupitem *y_tup = NULL;\n"
+		"  void *addr;\n"
+		"  pg_int4_t comp;\n"
+		"%s"
+		"\n"
+		"  assert(kds_src->format == KDS_FORMAT_ROW ||\n"
+		"         kds_src->format == KDS_FORMAT_SLOT);\n"
+		"  if (kds_src->format == KDS_FORMAT_ROW)\n"
+		"  {\n"
+		"    x_tup = KERN_DATA_STORE_TUPITEM(kds_src, x_index);\n"
+		"    y_tup = KERN_DATA_STORE_TUPITEM(kds_src, y_index);\n"
+		"  }\n"
+		"%s"
+		"  return 0;\n"
+		"}\n",
+		func_name,
+		decl.data,
+		body.data);
+
+	pfree(decl.data);
+	pfree(body.data);
+}
+
+/*
+ * codegen_gpusort_keycomp
+ *
+ * It generates the device functions below:
+ *
+ * DEVICE_FUNCTION(cl_bool)
+ * gpusort_quals_eval(kern_context *kcxt,
+ *                    kern_data_store *kds,
+ *                    cl_uint row_index);
+ *
+ * DEVICE_FUNCTION(cl_int)
+ * gpusort_keycomp(kern_context *kcxt,
+ *                 kern_data_store *kds_src,
+ *                 cl_uint x_index,
+ *                 cl_uint y_index);
+ *
+ * DEVICE_FUNCTION(cl_int)
+ * gpusort_partition_keycomp(kern_context *kcxt,
+ *                           kern_data_store *kds_src,
+ *                           cl_uint x_index,
+ *                           cl_uint y_index);
+ *
+ * kds_src is either KDS_FORMAT_ROW or KDS_FORMAT_SLOT.
+ */
+static void
+codegen_gpusort_keycomp(StringInfo kern,
+						codegen_context *context,
+						List *outer_tlist,
+						GpuSortInfo *gs_info)
+{
+	appendStringInfoString(
+		kern,
+		"DEVICE_FUNCTION(cl_bool)\n"
+		"gpusort_quals_eval(kern_context *kcxt,\n"
+		"                   kern_data_store *kds,\n"
+		"                   cl_uint row_index)\n"
+		"{\n"
+		"  return true;\n"
+		"}\n\n");
+	__codegen_gpusort_keycomp(kern, context, outer_tlist, gs_info,
+							  "gpusort_keycomp",
+							  list_length(gs_info->sort_keys));
+	appendStringInfoChar(kern, '\n');
+	__codegen_gpusort_keycomp(kern, context, outer_tlist, gs_info,
+							  "gpusort_partition_keycomp",
+							  gs_info->num_part_keys);
+}
+
+/*
+ * codegen_gpusort_radix_key
+ *
+ * It generates the device function below:
+ *
+ * DEVICE_FUNCTION(cl_ulong)
+ * gpusort_radix_key(kern_context *kcxt,
+ *                   kern_data_store *kds_src,
+ *                   cl_uint row_index,
+ *                   cl_int keyno,
+ *                   cl_bool null_pass);
+ *
+ * It is never called by the bitonic sorting, so it is a stub function
+ * unless all the sorting keys are fixed-width.
+ */
+static void
+codegen_gpusort_radix_key(StringInfo kern,
+						  codegen_context *context,
+						  List *outer_tlist,
+						  GpuSortInfo *gs_info)
+{
+	ListCell	   *lc1, *lc2, *lc3, *lc4;
+	int				keyno = 0;
+
+	appendStringInfoString(
+		kern,
+		"DEVICE_FUNCTION(cl_ulong)\n"
+		"gpusort_radix_key(kern_context *kcxt,\n"
+		"                  kern_data_store *kds_src,\n"
+		"                  cl_uint row_index,\n"
+		"                  cl_int keyno,\n"
+		"                  cl_bool null_pass)\n"
+		"{\n");
+	if (gs_info->radix_keybits == NIL)
+	{
+		appendStringInfoString(
+			kern,
+			"  return 0UL;\n"
+			"}\n");
+		return;
+	}
+	appendStringInfoString(
+		kern,
+		"  kern_tupitem *tupitem = NULL;\n"
+		"  void *addr;\n"
+		"\n"
+		"  if (kds_src->format == KDS_FORMAT_ROW)\n"
+		"    tupitem = KERN_DATA_STORE_TUPITEM(kds_src, row_index);\n"
+		"  switch (keyno)\n"
+		"  {\n");
+
+	forfour (lc1, gs_info->sort_keys,
+			 lc2, gs_info->sort_ops,
+			 lc3, gs_info->radix_keybits,
+			 lc4, gs_info->sort_nulls_first)
+	{
+		AttrNumber		resno = lfirst_int(lc1);
+		Oid				sort_op = lfirst_oid(lc2);
+		int				keybits = lfirst_int(lc3);
+		bool			nulls_first = (lfirst_int(lc4) != 0);
+		TargetEntry	   *tle = list_nth(outer_tlist, resno - 1);
+		Oid				type_oid = exprType((Node *)tle->expr);
+		devtype_info   *dtype;
+		TypeCacheEntry *tcache;
+		const char	   *conv;
+
+		dtype = pgstrom_devtype_lookup_and_track(type_oid, context);
+		if (!dtype || gpusort_radix_key_bits(type_oid) != keybits)
+			elog(ERROR, "Bug? GpuSort: sorting key is not radix sortable: %s",
+				 nodeToString(tle->expr));
+		switch (type_oid)
+		{
+			case INT2OID:
+				conv = "(cl_ulong)((cl_ushort)KVAR_%d.value ^ 0x8000U)";
+				break;
+			case INT4OID:
+			case DATEOID:
+				conv = "(cl_ulong)((cl_uint)KVAR_%d.value ^ 0x80000000U)";
+				break;
+			case INT8OID:
+			case TIMESTAMPOID:
+			case TIMESTAMPTZOID:
+				conv = "((cl_ulong)KVAR_%d.value ^ 0x8000000000000000UL)";
+				break;
+			case FLOAT4OID:
+				conv = "gpusort_radix_float4(KVAR_%d.value)";
+				break;
+			case FLOAT8OID:
+				conv = "gpusort_radix_float8(KVAR_%d.value)";
+				break;
+			default:
+				elog(ERROR, "Bug? unexpected radix sort key type: %s",
+					 format_type_be(type_oid));
+		}
+		tcache = lookup_type_cache(type_oid, TYPECACHE_GT_OPR);
+
+		appendStringInfo(
+			kern,
+			"  case %d:\n"
+			"    {\n"
+			"      pg_%s_t KVAR_%d;\n"
+			"\n"
+			"      if (tupitem)\n"
+			"      {\n"
+			"        addr = kern_get_datum_tuple(kds_src->colmeta,\n"
+			"                                    &tupitem->htup, %d);\n"
+			"        pg_datum_ref(kcxt, KVAR_%d, addr);\n"
+			"      }\n"
+			"      else\n"
+			"      {\n"
+			"        pg_datum_ref_slot(kcxt, KVAR_%d,\n"
+			"                          KERN_DATA_STORE_DCLASS(kds_src, row_index)[%d],\n"
+			"                          KERN_DATA_STORE_VALUES(kds_src, row_index)[%d]);\n"
+			"      }\n"
+			"      if (null_pass)\n"
+			"        return (KVAR_%d.isnull ? %s : %s);\n"
+			"      if (KVAR_%d.isnull)\n"
+			"        return 0UL;\n"
+			"      return ",
+			keyno,
+			dtype->type_name, keyno,
+			resno - 1,
+			keyno,
+			keyno, resno - 1, resno - 1,
+			keyno,
+			nulls_first ? "0UL" : "1UL",
+			nulls_first ? "1UL" : "0UL",
+			keyno);
+		if (sort_op == tcache->gt_opr)
+		{
+			/* DESC ordering */
+			appendStringInfoString(kern, "(~");
+			appendStringInfo(kern, conv, keyno);
+			if (keybits < 64)
+				appendStringInfo(kern, " & 0x%lxUL);\n",
+								 (1UL << keybits) - 1);
+			else
+				appendStringInfoString(kern, ");\n");
+		}
+		else
+		{
+			appendStringInfo(kern, conv, keyno);
+			appendStringInfoString(kern, ";\n");
+		}
+		appendStringInfoString(kern, "    }\n");
+		keyno++;
+	}
+	appendStringInfoString(
+		kern,
+		"  default:\n"
+		"    break;\n"
+		"  }\n"
+		"  return 0UL;\n"
+		"}\n");
+}
+
+/*
+ * PlanGpuSortPath
+ */
+static Plan *
+PlanGpuSortPath(PlannerInfo *root,
+				RelOptInfo *rel,
+				CustomPath *best_path,
+				List *tlist,
+				List *clauses,
+				List *custom_plans)
+{
+	GpuSortInfo	   *gs_info = linitial(best_path->custom_private);
+	List		   *window_exprs = lsecond(best_path->custom_private);
+	List		   *sort_clauses = root->parse->sortClause;
+	Plan		   *outer_plan;
+	CustomScan	   *cscan;
+	ListCell	   *lc;
+	StringInfoData	kern;
+	codegen_context	context;
+
+	Assert(list_length(custom_plans) == 1);
+	Assert(clauses == NIL);
+	outer_plan = linitial(custom_plans);
+
+	/* window functions sort the rows by PARTITION BY + ORDER BY */
+	if (gs_info->winref != 0)
+	{
+		WindowClause   *wc = gpusort_lookup_window_clause(root->parse,
+														  gs_info->winref);
+		sort_clauses = list_concat(list_copy(wc->partitionClause),
+								   list_copy(wc->orderClause));
+	}
+
+	/* sorting keys according to the outer target-list */
+	foreach (lc, sort_clauses)
+	{
+		SortGroupClause *sgc = lfirst(lc);
+		TargetEntry	   *tle;
+
+		tle = get_sortgroupclause_tle(sgc, outer_plan->targetlist);
+		gs_info->sort_keys = lappend_int(gs_info->sort_keys, tle->resno);
+		gs_info->sort_ops = lappend_oid(gs_info->sort_ops, sgc->sortop);
+		gs_info->sort_collations = lappend_oid(gs_info->sort_collations,
+											   exprCollation((Node *)tle->expr));
+		gs_info->sort_nulls_first = lappend_int(gs_info->sort_nulls_first,
+												sgc->nulls_first);
+	}
+
+	/*
+	 * Code construction for the CUDA kernel code
+	 */
+	initStringInfo(&kern);
+	pgstrom_init_codegen_context(&context, root, NULL);
+	codegen_gpusort_keycomp(&kern, &context,
+							outer_plan->targetlist,
+							gs_info);
+	appendStringInfoChar(&kern, '\n');
+	codegen_gpusort_radix_key(&kern, &context,
+							  outer_plan->targetlist,
+							  gs_info);
+	/* merge declaration */
+	if (context.decl.len > 0)
+		appendStringInfoChar(&context.decl, '\n');
+	appendStringInfoString(&context.decl, kern.data);
+
+	/*
+	 * Construction of GpuSortPlan node; on top of CustomPlan node
+	 */
+	cscan = makeNode(CustomScan);
+	cscan->scan.plan.targetlist = tlist;
+	cscan->scan.plan.qual = NIL;
+	cscan->scan.plan.lefttree = outer_plan;
+	cscan->scan.plan.righttree = NULL;
+	cscan->scan.scanrelid = 0;
+	cscan->flags = best_path->flags;
+	cscan->methods = &gpusort_plan_methods;
+	cscan->custom_plans = NIL;
+	cscan->custom_scan_tlist = copyObject(outer_plan->targetlist);
+	/* results of the window functions follow the outer rows */
+	foreach (lc, window_exprs)
+	{
+		TargetEntry	   *tle;
+
+		tle = makeTargetEntry(copyObject(lfirst(lc)),
+							  list_length(cscan->custom_scan_tlist) + 1,
+							  NULL,
+							  false);
+		cscan->custom_scan_tlist = lappend(cscan->custom_scan_tlist, tle);
+	}
+
+	gs_info->kern_source = context.decl.data;
+	gs_info->extra_flags = context.extra_flags | DEVKERNEL_NEEDS_GPUSORT;
+	gs_info->extra_bufsz = context.extra_bufsz;
+	gs_info->used_params = context.used_params;
+	form_gpusort_info(cscan, gs_info);
+
+	return &cscan->scan.plan;
+}
+
+/*
+ * gpusort_create_scan_state - allocation of GpuSortState
+ */
+static Node *
+gpusort_create_scan_state(CustomScan *cscan)
+{
+	GpuSortState   *gss = MemoryContextAllocZero(CurTransactionContext,
+												 sizeof(GpuSortState));
+	/* Set tag and executor callbacks */
+	NodeSetTag(gss, T_CustomScanState);
+	gss->gts.css.flags = cscan->flags;
+	if (cscan->methods == &gpusort_plan_methods)
+		gss->gts.css.methods = &gpusort_exec_methods;
+	else
+		elog(ERROR, "Bug? unexpected CustomPlanMethods");
+
+	return (Node *) gss;
+}
+
+/*
+ * ExecInitGpuSort
+ */
+static void
+ExecInitGpuSort(CustomScanState *node, EState *estate, int eflags)
+{
+	GpuSortState   *gss = (GpuSortState *) node;
+	CustomScan	   *cscan = (CustomScan *)node->ss.ps.plan;
+	GpuSortInfo	   *gs_info = deform_gpusort_info(cscan);
+	GpuContext	   *gcontext;
+	TupleDesc		outer_tupdesc;
+	bool			explain_only = ((eflags & EXEC_FLAG_EXPLAIN_ONLY) != 0);
+	ListCell	   *lc1, *lc2, *lc3, *lc4;
+	int				i = 0;
+	StringInfoData	kern_define;
+	ProgramId		program_id;
+
+	/* gpusort always has an outer plan */
+	Assert(node->ss.ss_currentRelation == NULL);
+	Assert(outerPlan(cscan) != NULL);
+
+	/* setup GpuContext for CUDA kernel execution */
+	gcontext = AllocGpuContext(gs_info->optimal_gpus, false, false);
+	gss->gts.gcontext = gcontext;
+
+	/* setup common GpuTaskState fields */
+	pgstromInitGpuTaskState(&gss->gts,
+							gcontext,
+							GpuTaskKind_GpuSort,
+							NIL,
+							NIL,
+							gs_info->used_params,
+							gs_info->optimal_gpus,
+							0,
+							eflags);
+	gss->gts.cb_next_task   = gpusort_next_task;
+	gss->gts.cb_terminator_task = gpusort_terminator_task;
+	gss->gts.cb_next_tuple  = gpusort_next_tuple;
+	gss->gts.cb_process_task = gpusort_process_task;
+	gss->gts.cb_release_task = gpusort_release_task;
+
+	/*
+	 * initialization of the outer relation; like Sort, GpuSort saves all
+	 * the outer rows, so no need to support backward scan and so on.
+	 */
+	outerPlanState(gss) = ExecInitNode(outerPlan(cscan), estate,
+									   eflags & ~(EXEC_FLAG_REWIND |
+												  EXEC_FLAG_BACKWARD |
+												  EXEC_FLAG_MARK));
+	outer_tupdesc = planStateResultTupleDesc(outerPlanState(gss));
+	if (outer_tupdesc->natts + list_length(gs_info->window_funcs) !=
+		list_length(cscan->custom_scan_tlist))
+		elog(ERROR, "Bug? GpuSort has incompatible outer target-list");
+
+	/* sorting keys */
+	gss->num_sort_keys = list_length(gs_info->sort_keys);
+	gss->sort_keys = palloc0(sizeof(AttrNumber) * gss->num_sort_keys);
+	gss->sort_ops = palloc0(sizeof(Oid) * gss->num_sort_keys);
+	gss->sort_collations = palloc0(sizeof(Oid) * gss->num_sort_keys);
+	gss->sort_nulls_first = palloc0(sizeof(bool) * gss->num_sort_keys);
+	forfour (lc1, gs_info->sort_keys,
+			 lc2, gs_info->sort_ops,
+			 lc3, gs_info->sort_collations,
+			 lc4, gs_info->sort_nulls_first)
+	{
+		gss->sort_keys[i] = lfirst_int(lc1);
+		gss->sort_ops[i] = lfirst_oid(lc2);
+		gss->sort_collations[i] = lfirst_oid(lc3);
+		gss->sort_nulls_first[i] = (lfirst_int(lc4) != 0);
+		i++;
+	}
+	gss->sort_bound = gs_info->sort_bound;
+	/* window functions */
+	gss->num_part_keys = gs_info->num_part_keys;
+	gss->num_window_funcs = list_length(gs_info->window_funcs);
+	if (gss->num_window_funcs > 0)
+	{
+		gss->window_funcs = palloc0(sizeof(int) * gss->num_window_funcs);
+		i = 0;
+		foreach (lc1, gs_info->window_funcs)
+			gss->window_funcs[i++] = lfirst_int(lc1);
+		gss->input_slot = MakeSingleTupleTableSlot(outer_tupdesc,
+												   &TTSOpsHeapTuple);
+		gss->win_cxt = AllocSetContextCreate(estate->es_query_cxt,
+											 "GpuSort window keys",
+											 ALLOCSET_SMALL_SIZES);
+		gss->win_values = palloc0(sizeof(Datum) * gss->num_sort_keys);
+		gss->win_isnull = palloc0(sizeof(bool) * gss->num_sort_keys);
+	}
+	else
+		gss->input_slot = node->ss.ss_ScanTupleSlot;
+	/* sort support for the k-way merge on CPU */
+	gss->ssup = palloc0(sizeof(SortSupportData) * gss->num_sort_keys);
+	for (i=0; i < gss->num_sort_keys; i++)
+	{
+		SortSupport	ssup = &gss->ssup[i];
+
+		ssup->ssup_cxt = CurrentMemoryContext;
+		ssup->ssup_collation = gss->sort_collations[i];
+		ssup->ssup_nulls_first = gss->sort_nulls_first[i];
+		ssup->ssup_attno = gss->sort_keys[i];
+		ssup->abbreviate = false;
+		PrepareSortSupportFromOrderingOp(gss->sort_ops[i], ssup);
+	}
+	if (gs_info->radix_keybits != NIL)
+	{
+		gss->radix_keybits = palloc0(sizeof(cl_uint) * gss->num_sort_keys);
+		i = 0;
+		foreach (lc1, gs_info->radix_keybits)
+			gss->radix_keybits[i++] = lfirst_int(lc1);
+	}
+	/*
+	 * GpuSort keeps the outer rows on the managed memory, but a run to be
+	 * sorted at once should not exceed the capacity of the device memory,
+	 * because the sorting kernels make random accesses on the buffer.
+	 * Larger input is split into multiple sorted runs; they are written
+	 * back to the host memory once sorted, then merged on CPU.
+	 */
+	gss->max_buffer_size = Min(KDS_OFFSET_MAX_SIZE,
+							   devAttrs[gcontext->cuda_dindex].DEV_TOTAL_MEMSZ / 2);
+	/* slot for CPU fallback */
+	gss->fallback_slot = MakeSingleTupleTableSlot(outer_tupdesc,
+												  &TTSOpsMinimalTuple);
+	/* Get CUDA program and async build if any */
+	initStringInfo(&kern_define);
+	pgstrom_build_session_info(&kern_define,
+							   &gss->gts,
+							   gs_info->extra_flags);
+	program_id = pgstrom_create_cuda_program(gcontext,
+											 gs_info->extra_flags,
+											 gs_info->extra_bufsz,
+											 gs_info->kern_source,
+											 kern_define.data,
+											 false,
+											 explain_only);
+	gss->gts.program_id = program_id;
+	pfree(kern_define.data);
+}
+
+/*
+ * ExecReCheckGpuSort
+ */
+static bool
+ExecReCheckGpuSort(CustomScanState *node, TupleTableSlot *slot)
+{
+	/* GpuSort shall not be used on EPQ recheck */
+	return true;
+}
+
+/*
+ * ExecGpuSort
+ */
+static TupleTableSlot *
+ExecGpuSort(CustomScanState *node)
+{
+	GpuSortState   *gss = (GpuSortState *) node;
+
+	ActivateGpuContext(gss->gts.gcontext);
+	if (!gss->gs_sstate)
+		createGpuSortSharedState(gss);
+	return ExecScan(&node->ss,
+					(ExecScanAccessMtd) pgstromExecGpuTaskState,
+					(ExecScanRecheckMtd) ExecReCheckGpuSort);
+}
+
+/*
+ * ExecEndGpuSort
+ */
+static void
+ExecEndGpuSort(CustomScanState *node)
+{
+	GpuSortState	   *gss = (GpuSortState *)node;
+	GpuTaskRuntimeStat *gt_rtstat = (GpuTaskRuntimeStat *) gss->gs_rtstat;
+
+	/* wait for completion of asynchronous GpuTaks */
+	SynchronizeGpuContext(gss->gts.gcontext);
+	/* clean up subtree */
+	ExecEndNode(outerPlanState(node));
+	/* release the sorted runs, if any */
+	gpusort_release_merge_runs(gss);
+	/* release CPU fallback resources */
+	if (gss->tuplesort)
+		tuplesort_end(gss->tuplesort);
+	if (gss->fallback_slot)
+		ExecDropSingleTupleTableSlot(gss->fallback_slot);
+	if (gss->num_window_funcs > 0 && gss->input_slot)
+		ExecDropSingleTupleTableSlot(gss->input_slot);
+	pgstromReleaseGpuTaskState(&gss->gts, gt_rtstat);
+}
+
+/*
+ * ExecReScanGpuSort
+ */
+static void
+ExecReScanGpuSort(CustomScanState *node)
+{
+	GpuSortState	   *gss = (GpuSortState *) node;
+	PlanState		   *outer_ps = outerPlanState(node);
+
+	/* wait for completion of asynchronous GpuTaks */
+	SynchronizeGpuContext(gss->gts.gcontext);
+	/* release the current task; all the outer rows must be reloaded */
+	if (gss->gts.curr_task)
+	{
+		gss->gts.cb_release_task(gss->gts.curr_task);
+		gss->gts.curr_task = NULL;
+		gss->gts.curr_index = 0;
+	}
+	if (gss->tuplesort)
+	{
+		tuplesort_end(gss->tuplesort);
+		gss->tuplesort = NULL;
+	}
+	gpusort_release_merge_runs(gss);
+	gss->tuplesort_done = false;
+	gss->input_done = false;
+	gss->multi_runs = false;
+	gss->merge_started = false;
+	gss->num_runs = 0;
+	gss->win_count = 0;
+	gss->gts.scan_overflow = NULL;
+	/* common rescan handling */
+	pgstromRescanGpuTaskState(&gss->gts);
+	gss->gts.scan_done = false;
+	/*
+	 * if chgParam of subnode is not null then plan will be re-scanned by
+	 * first ExecProcNode.
+	 */
+	if (outer_ps->chgParam == NULL)
+		ExecReScan(outer_ps);
+}
+
+/*
+ * ExplainGpuSort - EXPLAIN callback
+ */
+static void
+ExplainGpuSort(CustomScanState *node, List *ancestors, ExplainState *es)
+{
+	GpuSortState	   *gss = (GpuSortState *) node;
+	GpuSortRuntimeStat *gs_rtstat = gss->gs_rtstat;
+	CustomScan		   *cscan = (CustomScan *) gss->gts.css.ss.ps.plan;
+	List			   *dcontext;
+	List			   *sort_keys = NIL;
+	bool				useprefix;
+	StringInfoData		buf;
+	int					i;
+
+	/* merge run-time statistics */
+	InstrEndLoop(&gss->gts.outer_instrument);
+	if (gs_rtstat)
+		mergeGpuTaskRuntimeStat(&gss->gts, &gs_rtstat->c);
+
+	/* Set up deparsing context */
+	dcontext = set_deparse_context_planstate(es->deparse_cxt,
+											 (Node *)&gss->gts.css.ss.ps,
+											 ancestors);
+	useprefix = (list_length(es->rtable) > 1 || es->verbose);
+
+	/* Show sorting keys */
+	initStringInfo(&buf);
+	for (i=0; i < gss->num_sort_keys; i++)
+	{
+		TargetEntry	   *tle = list_nth(cscan->custom_scan_tlist,
+									   gss->sort_keys[i] - 1);
+		Oid				type_oid = exprType((Node *)tle->expr);
+		TypeCacheEntry *tcache;
+		bool			is_desc;
+
+		tcache = lookup_type_cache(type_oid, TYPECACHE_GT_OPR);
+		is_desc = (gss->sort_ops[i] == tcache->gt_opr);
+
+		resetStringInfo(&buf);
+		appendStringInfoString(&buf, deparse_expression((Node *)tle->expr,
+														dcontext,
+														useprefix,
+														false));
+		if (is_desc)
+			appendStringInfoString(&buf, " DESC");
+		if (gss->sort_nulls_first[i] && !is_desc)
+			appendStringInfoString(&buf, " NULLS FIRST");
+		else if (!gss->sort_nulls_first[i] && is_desc)
+			appendStringInfoString(&buf, " NULLS LAST");
+		sort_keys = lappend(sort_keys, pstrdup(buf.data));
+	}
+	ExplainPropertyList("GPU Sort Keys", sort_keys, es);
+	if (gss->sort_bound > 0)
+		ExplainPropertyInteger("GPU Sort Bound", NULL,
+							   gss->sort_bound, es);
+	if (gss->num_window_funcs > 0)
+	{
+		List	   *window_funcs = NIL;
+
+		for (i=0; i < gss->num_window_funcs; i++)
+		{
+			switch (gss->window_funcs[i])
+			{
+				case GPUSORT_WINFUNC__ROW_NUMBER:
+					window_funcs = lappend(window_funcs, "row_number()");
+					break;
+				case GPUSORT_WINFUNC__RANK:
+					window_funcs = lappend(window_funcs, "rank()");
+					break;
+				case GPUSORT_WINFUNC__DENSE_RANK:
+					window_funcs = lappend(window_funcs, "dense_rank()");
+					break;
+				default:
+					elog(ERROR, "Bug? unknown GpuSort window function: %d",
+						 gss->window_funcs[i]);
+			}
+		}
+		ExplainPropertyList("GPU Window Functions", window_funcs, es);
+		ExplainPropertyInteger("GPU Window Partition Keys", NULL,
+							   gss->num_part_keys, es);
+	}
+	if (es->analyze && gss->num_runs > 1)
+		ExplainPropertyInteger("GPU Sorted Runs", NULL,
+							   gss->num_runs, es);
+
+	/* Show sorting method, if executed */
+	if (es->analyze && gss->input_done)
+	{
+		if (!gss->tuplesort)
+			ExplainPropertyText("Sort Method",
+								gss->radix_keybits ? "GPU Radix" : "GPU Bitonic",
+								es);
+		else
+		{
+			TuplesortInstrumentation stats;
+
+			tuplesort_get_stats(gss->tuplesort, &stats);
+			resetStringInfo(&buf);
+			appendStringInfo(&buf, "CPU Fallback (%s)",
+							 tuplesort_method_name(stats.sortMethod));
+			ExplainPropertyText("Sort Method", buf.data, es);
+		}
+	}
+	pfree(buf.data);
+	/* common portion of EXPLAIN */
+	pgstromExplainGpuTaskState(&gss->gts, es, dcontext);
+}
+
+/*
+ * createGpuSortSharedState
+ *
+ * GpuSort never runs on the parallel workers, because it must consume all
+ * the outer rows at once. So, the shared state is always local.
+ */
+static void
+createGpuSortSharedState(GpuSortState *gss)
+{
+	EState	   *estate = gss->gts.css.ss.ps.state;
+	GpuSortSharedState *gs_sstate;
+	GpuSortRuntimeStat *gs_rtstat;
+	size_t		ss_length = MAXALIGN(sizeof(GpuSortSharedState));
+
+	gs_sstate = MemoryContextAlloc(estate->es_query_cxt, ss_length);
+	memset(gs_sstate, 0, ss_length);
+	gs_sstate->ss_handle = UINT_MAX;
+	gs_sstate->ss_length = ss_length;
+
+	gs_rtstat = &gs_sstate->gs_rtstat;
+	SpinLockInit(&gs_rtstat->c.lock);
+
+	gss->gs_sstate = gs_sstate;
+	gss->gs_rtstat = gs_rtstat;
+}
+
+/*
+ * gpusort_begin_tuplesort
+ *
+ * It switches GpuSort to the CPU fallback mode; rows already loaded onto
+ * the pds_src (if any) are moved to the tuplesort state.
+ */
+static void
+gpusort_begin_tuplesort(GpuSortState *gss, pgstrom_data_store *pds_src)
+{
+	TupleTableSlot *slot = gss->input_slot;
+	size_t			i;
+
+	Assert(!gss->tuplesort);
+	gss->tuplesort = tuplesort_begin_heap(slot->tts_tupleDescriptor,
+										  gss->num_sort_keys,
+										  gss->sort_keys,
+										  gss->sort_ops,
+										  gss->sort_collations,
+										  gss->sort_nulls_first,
+										  work_mem,
+										  NULL,
+										  false);
+	if (gss->sort_bound > 0)
+		tuplesort_set_bound(gss->tuplesort, gss->sort_bound);
+	if (pds_src)
+	{
+		for (i=0; i < pds_src->kds.nitems; i++)
+		{
+			if (!KDS_fetch_tuple_row(slot, &pds_src->kds,
+									 &gss->gts.curr_tuple, i))
+				elog(ERROR, "Bug? GpuSort could not fetch row at %zu", i);
+			tuplesort_puttupleslot(gss->tuplesort, slot);
+		}
+		ExecClearTuple(slot);
+	}
+}
+
+/*
+ * gpusort_expand_buffer
+ *
+ * It expands the KDS_FORMAT_ROW buffer twice. Row-index is placed at the
+ * head of the buffer, and tuples are placed from the tail, so we have to
+ * adjust the offset of the tuples.
+ * If we cannot expand the buffer any more, it returns NULL.
+ */
+static pgstrom_data_store *
+gpusort_expand_buffer(GpuSortState *gss, pgstrom_data_store *pds_old)
+{
+	kern_data_store *kds_old = &pds_old->kds;
+	kern_data_store *kds_new;
+	pgstrom_data_store *pds_new;
+	TupleDesc	tupdesc = gss->input_slot->tts_tupleDescriptor;
+	size_t		head_sz = KERN_DATA_STORE_HEAD_LENGTH(kds_old);
+	size_t		usage = __kds_unpack(kds_old->usage);
+	size_t		length;
+	size_t		shift;
+	cl_uint	   *row_index_old;
+	cl_uint	   *row_index_new;
+	size_t		i;
+
+	if (kds_old->nitems >= kds_old->nrooms ||
+		2 * kds_old->length > gss->max_buffer_size)
+		return NULL;
+
+	pds_new = PDS_create_row(gss->gts.gcontext,
+							 tupdesc,
+							 2 * kds_old->length);
+	kds_new = &pds_new->kds;
+	length = kds_new->length;
+	shift = length - kds_old->length;
+
+	memcpy(kds_new, kds_old, head_sz);
+	kds_new->length = length;
+	row_index_old = KERN_DATA_STORE_ROWINDEX(kds_old);
+	row_index_new = KERN_DATA_STORE_ROWINDEX(kds_new);
+	for (i=0; i < kds_old->nitems; i++)
+		row_index_new[i] = row_index_old[i] + __kds_packed(shift);
+	memcpy((char *)kds_new + length - usage,
+		   (char *)kds_old + kds_old->length - usage,
+		   usage);
+	PDS_release(pds_old);
+
+	return pds_new;
+}
+
+/*
+ * gpusort_load_outer_rows
+ *
+ * It loads the outer rows onto a KDS_FORMAT_ROW buffer. If the outer rows
+ * are too large to sort on the device at once, it returns a partial chunk
+ * as a sorted run; these runs are merged on CPU at the end.
+ */
+static pgstrom_data_store *
+gpusort_load_outer_rows(GpuSortState *gss)
+{
+	PlanState	   *outer_ps = outerPlanState(gss);
+	TupleDesc		tupdesc = ExecGetResultType(outer_ps);
+	pgstrom_data_store *pds = NULL;
+	pgstrom_data_store *pds_new;
+	TupleTableSlot *slot;
+
+	for (;;)
+	{
+		if (gss->gts.scan_overflow)
+		{
+			slot = gss->gts.scan_overflow;
+			gss->gts.scan_overflow = NULL;
+		}
+		else
+		{
+			slot = ExecProcNode(outer_ps);
+			if (TupIsNull(slot))
+			{
+				gss->input_done = true;
+				break;
+			}
+		}
+		/* create a new data-store on demand */
+		if (!pds)
+			pds = PDS_create_row(gss->gts.gcontext,
+								 tupdesc,
+								 pgstrom_chunk_size());
+		while (!PDS_insert_tuple(pds, slot))
+		{
+			pds_new = gpusort_expand_buffer(gss, pds);
+			if (!pds_new)
+			{
+				if (pds->kds.nitems == 0)
+					elog(ERROR, "GpuSort: too large outer row for the buffer (%zu bytes)",
+						 (size_t)pds->kds.length);
+				elog(DEBUG2, "GpuSort: a sorted run (nitems=%u, length=%zu)",
+					 pds->kds.nitems, (size_t)pds->kds.length);
+				gss->gts.scan_overflow = slot;
+				gss->multi_runs = true;
+				return pds;
+			}
+			pds = pds_new;
+		}
+	}
+	return pds;
+}
+
+/*
+ * gpusort_create_task - constructor of GpuSortTask
+ */
+static GpuSortTask *
+gpusort_create_task(GpuSortState *gss, pgstrom_data_store *pds_src)
+{
+	GpuContext	   *gcontext = gss->gts.gcontext;
+	GpuSortTask	   *gsort;
+	cl_uint			nitems = (pds_src ? pds_src->kds.nitems : 0);
+	size_t			length;
+	size_t			extra_sz = 0;
+	size_t			window_sz = 0;
+	CUdeviceptr		m_deviceptr;
+	CUresult		rc;
+
+	length = (offsetof(GpuSortTask, kern) +
+			  KERN_GPUSORT_LENGTH(nitems));
+	/* work area of the radix sort; it is never touched by the host */
+	if (gss->radix_keybits && pds_src)
+		extra_sz = KERN_GPUSORT_RADIX_LENGTH(nitems);
+	/* boundary flags of the window, unless it is a sorted run to be merged */
+	if (gss->num_window_funcs > 0 && pds_src && !gss->multi_runs)
+		window_sz = KERN_GPUSORT_WINDOW_LENGTH(nitems);
+	rc = gpuMemAllocManaged(gcontext,
+							&m_deviceptr,
+							length + extra_sz + window_sz,
+							CU_MEM_ATTACH_GLOBAL);
+	if (rc != CUDA_SUCCESS)
+		elog(ERROR, "failed on gpuMemAllocManaged: %s", errorText(rc));
+	gsort = (GpuSortTask *) m_deviceptr;
+	memset(gsort, 0, length);
+	pgstromInitGpuTask(&gss->gts, &gsort->task);
+	gsort->pds_src = pds_src;
+	if (window_sz > 0)
+		gsort->window_flags = (cl_uchar *)((char *)gsort + length + extra_sz);
+	gsort->kern.nitems_in = nitems;
+
+	return gsort;
+}
+
+/*
+ * gpusort_next_task
+ */
+static GpuTask *
+gpusort_next_task(GpuTaskState *gts)
+{
+	GpuSortState	   *gss = (GpuSortState *) gts;
+	GpuSortTask		   *gsort;
+	pgstrom_data_store *pds;
+
+	if (gss->input_done)
+		return NULL;
+	pds = gpusort_load_outer_rows(gss);
+	if (!pds)
+		return NULL;	/* an empty result */
+	gsort = gpusort_create_task(gss, pds);
+	gsort->is_merge_run = gss->multi_runs;
+	gss->num_runs++;
+
+	return &gsort->task;
+}
+
+/*
+ * gpusort_terminator_task
+ *
+ * If GpuSort produced multiple sorted runs, it launches a terminator task
+ * to merge them once all the runs are sorted.
+ */
+static GpuTask *
+gpusort_terminator_task(GpuTaskState *gts, cl_bool *task_is_ready)
+{
+	GpuSortState   *gss = (GpuSortState *) gts;
+	GpuSortTask	   *gsort;
+
+	if (!gss->multi_runs || gss->merge_started)
+		return NULL;
+	gss->merge_started = true;
+
+	gsort = gpusort_create_task(gss, NULL);
+	gsort->is_merge_task = true;
+	*task_is_ready = true;
+
+	return &gsort->task;
+}
+
+/*
+ * gpusort_window_cpu_flags
+ *
+ * It checks the boundary of partitions and peer groups by comparison to the
+ * previous row on CPU, if GPU did not mark them; e.g, CPU fallback or k-way
+ * merge of the sorted runs.
+ */
+static cl_uchar
+gpusort_window_cpu_flags(GpuSortState *gss, TupleTableSlot *slot)
+{
+	TupleDesc		tupdesc = slot->tts_tupleDescriptor;
+	MemoryContext	oldcxt;
+	cl_uchar		flags = 0;
+	int				i;
+
+	if (gss->win_count == 0)
+		flags = (GPUSORT_WINDOW_NEW_PARTITION | GPUSORT_WINDOW_NEW_PEER);
+	else
+	{
+		for (i=0; i < gss->num_sort_keys; i++)
+		{
+			Datum	value;
+			bool	isnull;
+
+			value = slot_getattr(slot, gss->sort_keys[i], &isnull);
+			if (ApplySortComparator(gss->win_values[i],
+									gss->win_isnull[i],
+									value, isnull,
+									&gss->ssup[i]) != 0)
+			{
+				flags = GPUSORT_WINDOW_NEW_PEER;
+				if (i < gss->num_part_keys)
+					flags |= GPUSORT_WINDOW_NEW_PARTITION;
+				break;
+			}
+		}
+	}
+	/* save the sorting keys of the head row of the new peer group */
+	if (flags != 0)
+	{
+		MemoryContextReset(gss->win_cxt);
+		oldcxt = MemoryContextSwitchTo(gss->win_cxt);
+		for (i=0; i < gss->num_sort_keys; i++)
+		{
+			Form_pg_attribute attr = TupleDescAttr(tupdesc, gss->sort_keys[i] - 1);
+			Datum	value;
+			bool	isnull;
+
+			value = slot_getattr(slot, gss->sort_keys[i], &isnull);
+			gss->win_values[i] = (isnull ? 0 : datumCopy(value,
+														 attr->attbyval,
+														 attr->attlen));
+			gss->win_isnull[i] = isnull;
+		}
+		MemoryContextSwitchTo(oldcxt);
+	}
+	return flags;
+}
+
+/*
+ * gpusort_window_projection
+ *
+ * It computes the ranking window functions according to the boundary flags,
+ * then stores the outer row and the results on the scan slot.
+ */
+static TupleTableSlot *
+gpusort_window_projection(GpuSortState *gss, TupleTableSlot *in_slot,
+						  cl_uchar flags)
+{
+	TupleTableSlot *slot = gss->gts.css.ss.ss_ScanTupleSlot;
+	int				natts = in_slot->tts_tupleDescriptor->natts;
+	cl_long			value;
+	int				i;
+
+	if ((flags & GPUSORT_WINDOW_NEW_PARTITION) != 0)
+	{
+		gss->win_row_number = 1;
+		gss->win_rank = 1;
+		gss->win_dense_rank = 1;
+	}
+	else
+	{
+		gss->win_row_number++;
+		if ((flags & GPUSORT_WINDOW_NEW_PEER) != 0)
+		{
+			gss->win_rank = gss->win_row_number;
+			gss->win_dense_rank++;
+		}
+	}
+	gss->win_count++;
+
+	slot_getallattrs(in_slot);
+	ExecClearTuple(slot);
+	memcpy(slot->tts_values, in_slot->tts_values, sizeof(Datum) * natts);
+	memcpy(slot->tts_isnull, in_slot->tts_isnull, sizeof(bool) * natts);
+	for (i=0; i < gss->num_window_funcs; i++)
+	{
+		switch (gss->window_funcs[i])
+		{
+			case GPUSORT_WINFUNC__ROW_NUMBER:
+				value = gss->win_row_number;
+				break;
+			case GPUSORT_WINFUNC__RANK:
+				value = gss->win_rank;
+				break;
+			case GPUSORT_WINFUNC__DENSE_RANK:
+				value = gss->win_dense_rank;
+				break;
+			default:
+				elog(ERROR, "Bug? unknown GpuSort window function: %d",
+					 gss->window_funcs[i]);
+		}
+		slot->tts_values[natts + i] = Int64GetDatum(value);
+		slot->tts_isnull[natts + i] = false;
+	}
+	ExecStoreVirtualTuple(slot);
+
+	return slot;
+}
+
+/*
+ * gpusort_next_tuple_fallback
+ */
+static TupleTableSlot *
+gpusort_next_tuple_fallback(GpuSortState *gss, GpuSortTask *gsort)
+{
+	TupleTableSlot *slot = gss->fallback_slot;
+
+	if (!gss->tuplesort_done)
+	{
+		if (!gss->tuplesort)
+			gpusort_begin_tuplesort(gss, gsort->pds_src);
+		tuplesort_performsort(gss->tuplesort);
+		gss->tuplesort_done = true;
+	}
+	if (!tuplesort_gettupleslot(gss->tuplesort, true, false, slot, NULL))
+		return NULL;
+	if (gss->num_window_funcs > 0)
+		slot = gpusort_window_projection(gss, slot,
+										 gpusort_window_cpu_flags(gss, slot));
+	return slot;
+}
+
+/*
+ * gpusort_fetch_sortkeys
+ */
+static void
+gpusort_fetch_sortkeys(GpuSortState *gss, kern_data_store *kds,
+					   cl_uint row_index, Datum *values, bool *isnull)
+{
+	TupleDesc		tupdesc = gss->input_slot->tts_tupleDescriptor;
+	kern_tupitem   *tupitem = KERN_DATA_STORE_TUPITEM(kds, row_index);
+	HeapTupleData	tuple;
+	int				i;
+
+	tuple.t_len = tupitem->t_len;
+	tuple.t_self = tupitem->htup.t_ctid;
+	tuple.t_tableOid = kds->table_oid;
+	tuple.t_data = &tupitem->htup;
+	for (i=0; i < gss->num_sort_keys; i++)
+		values[i] = heap_getattr(&tuple, gss->sort_keys[i], tupdesc, &isnull[i]);
+}
+
+/*
+ * gpusort_compare_sortkeys
+ */
+static int
+gpusort_compare_sortkeys(GpuSortState *gss,
+						 Datum *x_values, bool *x_isnull,
+						 Datum *y_values, bool *y_isnull)
+{
+	int		i, comp;
+
+	for (i=0; i < gss->num_sort_keys; i++)
+	{
+		comp = ApplySortComparator(x_values[i], x_isnull[i],
+								   y_values[i], y_isnull[i],
+								   &gss->ssup[i]);
+		if (comp != 0)
+			return comp;
+	}
+	return 0;
+}
+
+/*
+ * gpusort_sort_run_by_cpu
+ *
+ * A sorted run may not be sorted on the device, if GPU kernel reported
+ * an error that can be recovered by CPU fallback. In this case, we sort
+ * the rows of the run by CPU prior to the k-way merge.
+ */
+typedef struct
+{
+	GpuSortState   *gss;
+	kern_data_store *kds;
+	Datum		   *x_values;
+	bool		   *x_isnull;
+	Datum		   *y_values;
+	bool		   *y_isnull;
+} gpusort_cpusort_arg;
+
+static int
+gpusort_cpusort_compare(const void *__x, const void *__y, void *__arg)
+{
+	gpusort_cpusort_arg *arg = __arg;
+
+	gpusort_fetch_sortkeys(arg->gss, arg->kds, *((const cl_uint *)__x),
+						   arg->x_values, arg->x_isnull);
+	gpusort_fetch_sortkeys(arg->gss, arg->kds, *((const cl_uint *)__y),
+						   arg->y_values, arg->y_isnull);
+	return gpusort_compare_sortkeys(arg->gss,
+									arg->x_values, arg->x_isnull,
+									arg->y_values, arg->y_isnull);
+}
+
+static void
+gpusort_sort_run_by_cpu(GpuSortState *gss, GpuSortTask *gsort)
+{
+	EState		   *estate = gss->gts.css.ss.ps.state;
+	kern_data_store *kds = &gsort->pds_src->kds;
+	gpusort_cpusort_arg arg;
+	cl_uint		   *sorted_index;
+	cl_uint			i;
+
+	sorted_index = MemoryContextAllocHuge(estate->es_query_cxt,
+										  sizeof(cl_uint) * kds->nitems);
+	for (i=0; i < kds->nitems; i++)
+		sorted_index[i] = i;
+	arg.gss = gss;
+	arg.kds = kds;
+	arg.x_values = palloc(sizeof(Datum) * gss->num_sort_keys);
+	arg.x_isnull = palloc(sizeof(bool)  * gss->num_sort_keys);
+	arg.y_values = palloc(sizeof(Datum) * gss->num_sort_keys);
+	arg.y_isnull = palloc(sizeof(bool)  * gss->num_sort_keys);
+	qsort_arg(sorted_index, kds->nitems, sizeof(cl_uint),
+			  gpusort_cpusort_compare, &arg);
+	pfree(arg.x_values);
+	pfree(arg.x_isnull);
+	pfree(arg.y_values);
+	pfree(arg.y_isnull);
+
+	gsort->sorted_index = sorted_index;
+	gsort->kern.nitems_out = kds->nitems;
+	if (gss->sort_bound > 0 && gss->sort_bound < kds->nitems)
+		gsort->kern.nitems_out = gss->sort_bound;
+	pg_atomic_add_fetch_u64(&gss->gs_rtstat->c.fallback_count,
+							kds->nitems);
+}
+
+/*
+ * gpusort_merge_run_fetch - load the sorting keys of the head row
+ */
+static bool
+gpusort_merge_run_fetch(GpuSortState *gss, GpuSortMergeRun *run)
+{
+	GpuSortTask	   *gsort = run->gsort;
+
+	if (run->curr_pos >= run->nitems)
+		return false;
+	gpusort_fetch_sortkeys(gss, &gsort->pds_src->kds,
+						   gsort->sorted_index[run->curr_pos],
+						   run->values, run->isnull);
+	return true;
+}
+
+/*
+ * gpusort_merge_heap_compare
+ *
+ * binaryheap is a max-heap, so it inverts the result of comparison to
+ * pick up the smallest head row.
+ */
+static int
+gpusort_merge_heap_compare(Datum a, Datum b, void *arg)
+{
+	GpuSortState   *gss = arg;
+	GpuSortMergeRun *x_run = &gss->merge_runs[DatumGetInt32(a)];
+	GpuSortMergeRun *y_run = &gss->merge_runs[DatumGetInt32(b)];
+
+	return -gpusort_compare_sortkeys(gss,
+									 x_run->values, x_run->isnull,
+									 y_run->values, y_run->isnull);
+}
+
+/*
+ * gpusort_begin_merge
+ */
+static void
+gpusort_begin_merge(GpuSortState *gss)
+{
+	EState	   *estate = gss->gts.css.ss.ps.state;
+	MemoryContext oldcxt;
+	int			nruns = list_length(gss->sorted_runs);
+	int			i = 0;
+	ListCell   *lc;
+
+	oldcxt = MemoryContextSwitchTo(estate->es_query_cxt);
+	gss->merge_runs = palloc0(sizeof(GpuSortMergeRun) * Max(nruns, 1));
+	gss->merge_heap = binaryheap_allocate(Max(nruns, 1),
+										  gpusort_merge_heap_compare,
+										  gss);
+	foreach (lc, gss->sorted_runs)
+	{
+		GpuSortTask	   *gsort = lfirst(lc);
+		GpuSortMergeRun *run = &gss->merge_runs[i];
+
+		if (gsort->task.cpu_fallback)
+			gpusort_sort_run_by_cpu(gss, gsort);
+		run->gsort = gsort;
+		run->nitems = gsort->kern.nitems_out;
+		run->curr_pos = 0;
+		run->values = palloc(sizeof(Datum) * gss->num_sort_keys);
+		run->isnull = palloc(sizeof(bool) * gss->num_sort_keys);
+		if (gpusort_merge_run_fetch(gss, run))
+			binaryheap_add_unordered(gss->merge_heap, Int32GetDatum(i));
+		i++;
+	}
+	binaryheap_build(gss->merge_heap);
+	gss->merge_count = 0;
+	MemoryContextSwitchTo(oldcxt);
+}
+
+/*
+ * gpusort_next_tuple_merge
+ *
+ * It returns the rows of the sorted runs with k-way merge.
+ */
+static TupleTableSlot *
+gpusort_next_tuple_merge(GpuSortState *gss)
+{
+	TupleTableSlot *slot = gss->input_slot;
+	GpuSortMergeRun *run;
+	int			i;
+
+	if (!gss->merge_heap)
+		gpusort_begin_merge(gss);
+	if (binaryheap_empty(gss->merge_heap))
+		return NULL;
+	if (gss->sort_bound > 0 && gss->merge_count >= gss->sort_bound)
+		return NULL;
+	i = DatumGetInt32(binaryheap_first(gss->merge_heap));
+	run = &gss->merge_runs[i];
+	if (!KDS_fetch_tuple_row(slot, &run->gsort->pds_src->kds,
+							 &gss->gts.curr_tuple,
+							 run->gsort->sorted_index[run->curr_pos]))
+		elog(ERROR, "Bug? GpuSort result index is out of range");
+	run->curr_pos++;
+	if (gpusort_merge_run_fetch(gss, run))
+		binaryheap_replace_first(gss->merge_heap, Int32GetDatum(i));
+	else
+		(void) binaryheap_remove_first(gss->merge_heap);
+	gss->merge_count++;
+	if (gss->num_window_funcs > 0)
+		slot = gpusort_window_projection(gss, slot,
+										 gpusort_window_cpu_flags(gss, slot));
+	return slot;
+}
+
+/*
+ * gpusort_next_tuple
+ */
+static TupleTableSlot *
+gpusort_next_tuple(GpuTaskState *gts)
+{
+	GpuSortState	   *gss = (GpuSortState *) gts;
+	GpuSortTask		   *gsort = (GpuSortTask *) gts->curr_task;
+	TupleTableSlot	   *slot;
+
+	if (gsort->is_merge_task)
+		return gpusort_next_tuple_merge(gss);
+	if (gsort->is_merge_run)
+	{
+		/* sorted run is kept until the k-way merge */
+		if (!gsort->retained)
+		{
+			MemoryContext	oldcxt;
+
+			oldcxt = MemoryContextSwitchTo(gts->css.ss.ps.state->es_query_cxt);
+			gss->sorted_runs = lappend(gss->sorted_runs, gsort);
+			MemoryContextSwitchTo(oldcxt);
+			gsort->retained = true;
+		}
+		return NULL;
+	}
+	if (gsort->task.cpu_fallback)
+		return gpusort_next_tuple_fallback(gss, gsort);
+
+	if (gts->curr_index >= gsort->kern.nitems_out)
+		return NULL;
+	slot = gss->input_slot;
+	if (!KDS_fetch_tuple_row(slot, &gsort->pds_src->kds,
+							 &gts->curr_tuple,
+							 gsort->sorted_index[gts->curr_index]))
+		elog(ERROR, "Bug? GpuSort result index is out of range");
+	if (gss->num_window_funcs > 0)
+	{
+		cl_uchar	flags;
+
+		if (gsort->window_flags)
+			flags = gsort->window_flags[gts->curr_index];
+		else
+			flags = gpusort_window_cpu_flags(gss, slot);
+		slot = gpusort_window_projection(gss, slot, flags);
+	}
+	gts->curr_index++;
+	return slot;
+}
+
+/*
+ * gpusort_launch_bitonic
+ *
+ * It enqueues a series of the bitonic sorting kernels.
+ */
+static void
+gpusort_launch_bitonic(GpuSortState *gss, GpuSortTask *gsort,
+					   CUmodule cuda_module, void **kern_args)
+{
+	cl_uint		   *p_unitsz = kern_args[3];
+	cl_bool		   *p_reversing = kern_args[4];
+	cl_uint			nitems = gsort->kern.nitems_in;
+	size_t			part_sz = 2 * BITONIC_MAX_LOCAL_SZ;
+	size_t			block_sz;
+	size_t			unitsz;
+	size_t			nthreads;
+	CUfunction		kern_gpusort_local;
+	CUfunction		kern_gpusort_step;
+	CUfunction		kern_gpusort_merge;
+	cl_int			grid_sz;
+	cl_int			local_block_sz;
+	cl_int			step_block_sz;
+	CUresult		rc;
+
+	rc = cuModuleGetFunction(&kern_gpusort_local,
+							 cuda_module,
+							 "kern_gpusort_bitonic_local");
+	if (rc != CUDA_SUCCESS)
+		werror("failed on cuModuleGetFunction: %s", errorText(rc));
+	rc = cuModuleGetFunction(&kern_gpusort_step,
+							 cuda_module,
+							 "kern_gpusort_bitonic_step");
+	if (rc != CUDA_SUCCESS)
+		werror("failed on cuModuleGetFunction: %s", errorText(rc));
+	rc = cuModuleGetFunction(&kern_gpusort_merge,
+							 cuda_module,
+							 "kern_gpusort_bitonic_merge");
+	if (rc != CUDA_SUCCESS)
+		werror("failed on cuModuleGetFunction: %s", errorText(rc));
+
+	/*
+	 * KERNEL_FUNCTION_MAXTHREADS(void)
+	 * kern_gpusort_bitonic_local(kern_gpusort *kgpusort,
+	 *                            kern_parambuf *kparams,
+	 *                            kern_data_store *kds_src)
+	 */
+	rc = gpuOptimalBlockSize(&grid_sz,
+							 &local_block_sz,
+							 kern_gpusort_local,
+							 CU_DEVICE_PER_THREAD,
+							 0, 0);
+	if (rc != CUDA_SUCCESS)
+		werror("failed on gpuOptimalBlockSize: %s", errorText(rc));
+	grid_sz = (nitems + part_sz - 1) / part_sz;
+	gpuTaskTimerRecord(&gsort->task, GPUTASK_TIMER__KERN_BEGIN);
+	rc = cuLaunchKernel(kern_gpusort_local,
+						grid_sz, 1, 1,
+						local_block_sz, 1, 1,
+						0,
+						CU_STREAM_PER_THREAD,
+						kern_args,
+						NULL);
+	if (rc != CUDA_SUCCESS)
+		werror("failed on cuLaunchKernel: %s", errorText(rc));
+
+	/*
+	 * Merge the sorted partitions. Inter-partitions steps are processed
+	 * by kern_gpusort_bitonic_step, then kern_gpusort_bitonic_merge runs
+	 * the remaining steps within the partition on the shared memory.
+	 */
+	rc = gpuOptimalBlockSize(&grid_sz,
+							 &step_block_sz,
+							 kern_gpusort_step,
+							 CU_DEVICE_PER_THREAD,
+							 0, 0);
+	if (rc != CUDA_SUCCESS)
+		werror("failed on gpuOptimalBlockSize: %s", errorText(rc));
+	for (block_sz = 2 * part_sz; block_sz / 2 < nitems; block_sz *= 2)
+	{
+		for (unitsz = block_sz; unitsz > part_sz; unitsz /= 2)
+		{
+			/*
+			 * KERNEL_FUNCTION_MAXTHREADS(void)
+			 * kern_gpusort_bitonic_step(kern_gpusort *kgpusort,
+			 *                           kern_parambuf *kparams,
+			 *                           kern_data_store *kds_src,
+			 *                           cl_uint unitsz,
+			 *                           cl_bool reversing)
+			 */
+			*p_unitsz = unitsz;
+			*p_reversing = (unitsz == block_sz);
+			nthreads = ((nitems + unitsz - 1) / unitsz) * (unitsz / 2);
+			grid_sz = (nthreads + step_block_sz - 1) / step_block_sz;
+			gpuTaskTimerRecord(&gsort->task, GPUTASK_TIMER__KERN_BEGIN);
+			rc = cuLaunchKernel(kern_gpusort_step,
+								grid_sz, 1, 1,
+								step_block_sz, 1, 1,
+								0,
+								CU_STREAM_PER_THREAD,
+								kern_args,
+								NULL);
+			if (rc != CUDA_SUCCESS)
+				werror("failed on cuLaunchKernel: %s", errorText(rc));
+		}
+		/*
+		 * KERNEL_FUNCTION_MAXTHREADS(void)
+		 * kern_gpusort_bitonic_merge(kern_gpusort *kgpusort,
+		 *                            kern_parambuf *kparams,
+		 *                            kern_data_store *kds_src)
+		 */
+		grid_sz = (nitems + part_sz - 1) / part_sz;
+		gpuTaskTimerRecord(&gsort->task, GPUTASK_TIMER__KERN_BEGIN);
+		rc = cuLaunchKernel(kern_gpusort_merge,
+							grid_sz, 1, 1,
+							local_block_sz, 1, 1,
+							0,
+							CU_STREAM_PER_THREAD,
+							kern_args,
+							NULL);
+		if (rc != CUDA_SUCCESS)
+			werror("failed on cuLaunchKernel: %s", errorText(rc));
+	}
+	gsort->sorted_index = KERN_GPUSORT_RESULT_INDEX(&gsort->kern)->results;
+}
+
+/*
+ * gpusort_launch_radix
+ *
+ * It enqueues a series of the LSD radix sorting kernels. Sorting keys are
+ * processed from the last one, and each key is sorted by the digits from
+ * the least significant one, then sorted by the NULL flag. Because every
+ * pass is stable, the final order follows the all sorting keys.
+ */
+static void
+gpusort_launch_radix(GpuSortState *gss, GpuSortTask *gsort,
+					 CUmodule cuda_module)
+{
+	cl_uint			nitems = gsort->kern.nitems_in;
+	CUdeviceptr		m_gpusort = (CUdeviceptr)&gsort->kern;
+	CUdeviceptr		m_kds_src = (CUdeviceptr)&gsort->pds_src->kds;
+	char		   *pos = (char *)&gsort->kern + KERN_GPUSORT_LENGTH(nitems);
+	cl_ulong	   *keys_in;
+	cl_ulong	   *keys_out;
+	cl_uint		   *index_in;
+	cl_uint		   *index_out;
+	cl_uint		   *hist;
+	void		   *temp;
+	cl_int			keyno;
+	cl_bool			null_pass;
+	cl_uint			shift;
+	cl_uint			tilesz;
+	cl_uint			nhists;
+	cl_uint			nblocks;
+	CUfunction		kern_radix_keyset;
+	CUfunction		kern_radix_count;
+	CUfunction		kern_radix_scan;
+	CUfunction		kern_radix_scatter;
+	cl_int			grid_sz;
+	cl_int			scatter_grid_sz;
+	cl_int			keyset_block_sz;
+	cl_int			scan_block_sz;
+	cl_int			block_sz;
+	void		   *keyset_args[7];
+	void		   *count_args[6];
+	void		   *scan_args[4];
+	void		   *scatter_args[9];
+	CUresult		rc;
+
+	/* work area of the radix sort */
+	keys_in = (cl_ulong *) pos;
+	pos += STROMALIGN(sizeof(cl_ulong) * nitems);
+	keys_out = (cl_ulong *) pos;
+	pos += STROMALIGN(sizeof(cl_ulong) * nitems);
+	index_in = KERN_GPUSORT_RESULT_INDEX(&gsort->kern)->results;
+	index_out = (cl_uint *) pos;
+	pos += STROMALIGN(sizeof(cl_uint) * nitems);
+	hist = (cl_uint *) pos;
+
+	rc = cuModuleGetFunction(&kern_radix_keyset,
+							 cuda_module,
+							 "kern_gpusort_radix_keyset");
+	if (rc != CUDA_SUCCESS)
+		werror("failed on cuModuleGetFunction: %s", errorText(rc));
+	rc = cuModuleGetFunction(&kern_radix_count,
+							 cuda_module,
+							 "kern_gpusort_radix_count");
+	if (rc != CUDA_SUCCESS)
+		werror("failed on cuModuleGetFunction: %s", errorText(rc));
+	rc = cuModuleGetFunction(&kern_radix_scan,
+							 cuda_module,
+							 "kern_gpusort_radix_scan");
+	if (rc != CUDA_SUCCESS)
+		werror("failed on cuModuleGetFunction: %s", errorText(rc));
+	rc = cuModuleGetFunction(&kern_radix_scatter,
+							 cuda_module,
+							 "kern_gpusort_radix_scatter");
+	if (rc != CUDA_SUCCESS)
+		werror("failed on cuModuleGetFunction: %s", errorText(rc));
+
+	/* keyset kernel runs on the optimal grid size */
+	rc = gpuOptimalBlockSize(&grid_sz,
+							 &keyset_block_sz,
+							 kern_radix_keyset,
+							 CU_DEVICE_PER_THREAD,
+							 0, 0);
+	if (rc != CUDA_SUCCESS)
+		werror("failed on gpuOptimalBlockSize: %s", errorText(rc));
+	grid_sz = Min(grid_sz, (nitems + keyset_block_sz - 1) / keyset_block_sz);
+
+	/*
+	 * count and scatter kernels must have identical grid/block size,
+	 * because the histogram is built per thread-block.
+	 */
+	rc = gpuOptimalBlockSize(&scatter_grid_sz,
+							 &block_sz,
+							 kern_radix_scatter,
+							 CU_DEVICE_PER_THREAD,
+							 0, 0);
+	if (rc != CUDA_SUCCESS)
+		werror("failed on gpuOptimalBlockSize: %s", errorText(rc));
+	block_sz = Min(block_sz, GPUSORT_RADIX_MAX_NWARPS *
+				   devAttrs[gss->gts.gcontext->cuda_dindex].WARP_SIZE);
+	nblocks = Min((nitems + block_sz - 1) / block_sz,
+				  GPUSORT_RADIX_MAX_NBLOCKS);
+	tilesz = (nitems + nblocks - 1) / nblocks;
+	nblocks = (nitems + tilesz - 1) / tilesz;
+	nhists = GPUSORT_RADIX_NBUCKETS * nblocks;
+
+	rc = gpuOptimalBlockSize(&grid_sz,
+							 &scan_block_sz,
+							 kern_radix_scan,
+							 CU_DEVICE_PER_THREAD,
+							 0, sizeof(cl_uint));
+	if (rc != CUDA_SUCCESS)
+		werror("failed on gpuOptimalBlockSize: %s", errorText(rc));
+
+	keyset_args[0] = &m_gpusort;
+	keyset_args[1] = &gss->gts.kern_params;
+	keyset_args[2] = &m_kds_src;
+	keyset_args[3] = &index_in;
+	keyset_args[4] = &keys_in;
+	keyset_args[5] = &keyno;
+	keyset_args[6] = &null_pass;
+
+	count_args[0] = &m_gpusort;
+	count_args[1] = &gss->gts.kern_params;
+	count_args[2] = &keys_in;
+	count_args[3] = &hist;
+	count_args[4] = &shift;
+	count_args[5] = &tilesz;
+
+	scan_args[0] = &m_gpusort;
+	scan_args[1] = &gss->gts.kern_params;
+	scan_args[2] = &hist;
+	scan_args[3] = &nhists;
+
+	scatter_args[0] = &m_gpusort;
+	scatter_args[1] = &gss->gts.kern_params;
+	scatter_args[2] = &keys_in;
+	scatter_args[3] = &keys_out;
+	scatter_args[4] = &index_in;
+	scatter_args[5] = &index_out;
+	scatter_args[6] = &hist;
+	scatter_args[7] = &shift;
+	scatter_args[8] = &tilesz;
+
+	for (keyno = gss->num_sort_keys - 1; keyno >= 0; keyno--)
+	{
+		cl_uint		keybits = gss->radix_keybits[keyno];
+		int			k;
+
+		for (k=0; k < 2; k++)
+		{
+			cl_uint		nbits = (k == 0 ? keybits : 1);
+
+			null_pass = (k != 0);
+			/*
+			 * KERNEL_FUNCTION(void)
+			 * kern_gpusort_radix_keyset(kern_gpusort *kgpusort,
+			 *                           kern_parambuf *kparams,
+			 *                           kern_data_store *kds_src,
+			 *                           cl_uint *index_in,
+			 *                           cl_ulong *keys,
+			 *                           cl_int keyno,
+			 *                           cl_bool null_pass)
+			 */
+			gpuTaskTimerRecord(&gsort->task, GPUTASK_TIMER__KERN_BEGIN);
+			rc = cuLaunchKernel(kern_radix_keyset,
+								grid_sz, 1, 1,
+								keyset_block_sz, 1, 1,
+								0,
+								CU_STREAM_PER_THREAD,
+								keyset_args,
+								NULL);
+			if (rc != CUDA_SUCCESS)
+				werror("failed on cuLaunchKernel: %s", errorText(rc));
+
+			for (shift = 0; shift < nbits; shift += GPUSORT_RADIX_BITS)
+			{
+				/*
+				 * KERNEL_FUNCTION_MAXTHREADS(void)
+				 * kern_gpusort_radix_count(kern_gpusort *kgpusort,
+				 *                          kern_parambuf *kparams,
+				 *                          cl_ulong *keys_in,
+				 *                          cl_uint *hist,
+				 *                          cl_uint shift,
+				 *                          cl_uint tilesz)
+				 */
+				gpuTaskTimerRecord(&gsort->task, GPUTASK_TIMER__KERN_BEGIN);
+				rc = cuLaunchKernel(kern_radix_count,
+									nblocks, 1, 1,
+									block_sz, 1, 1,
+									0,
+									CU_STREAM_PER_THREAD,
+									count_args,
+									NULL);
+				if (rc != CUDA_SUCCESS)
+					werror("failed on cuLaunchKernel: %s", errorText(rc));
+				/*
+				 * KERNEL_FUNCTION_MAXTHREADS(void)
+				 * kern_gpusort_radix_scan(kern_gpusort *kgpusort,
+				 *                         kern_parambuf *kparams,
+				 *                         cl_uint *hist,
+				 *                         cl_uint nhists)
+				 */
+				gpuTaskTimerRecord(&gsort->task, GPUTASK_TIMER__KERN_BEGIN);
+				rc = cuLaunchKernel(kern_radix_scan,
+									1, 1, 1,
+									scan_block_sz, 1, 1,
+									sizeof(cl_uint) * scan_block_sz,
+									CU_STREAM_PER_THREAD,
+									scan_args,
+									NULL);
+				if (rc != CUDA_SUCCESS)
+					werror("failed on cuLaunchKernel: %s", errorText(rc));
+				/*
+				 * KERNEL_FUNCTION_MAXTHREADS(void)
+				 * kern_gpusort_radix_scatter(kern_gpusort *kgpusort,
+				 *                            kern_parambuf *kparams,
+				 *                            cl_ulong *keys_in,
+				 *                            cl_ulong *keys_out,
+				 *                            cl_uint *index_in,
+				 *                            cl_uint *index_out,
+				 *                            cl_uint *hist,
+				 *                            cl_uint shift,
+				 *                            cl_uint tilesz)
+				 */
+				gpuTaskTimerRecord(&gsort->task, GPUTASK_TIMER__KERN_BEGIN);
+				rc = cuLaunchKernel(kern_radix_scatter,
+									nblocks, 1, 1,
+									block_sz, 1, 1,
+									0,
+									CU_STREAM_PER_THREAD,
+									scatter_args,
+									NULL);
+				if (rc != CUDA_SUCCESS)
+					werror("failed on cuLaunchKernel: %s", errorText(rc));
+				/* swap the input/output buffer for the next pass */
+				temp = keys_in;
+				keys_in = keys_out;
+				keys_out = temp;
+				temp = index_in;
+				index_in = index_out;
+				index_out = temp;
+			}
+		}
+	}
+	gsort->sorted_index = index_in;
+}
+
+/*
+ * gpusort_launch_window
+ *
+ * It enqueues the kernel to mark the boundary of partitions and peer groups
+ * on the sorted rows, for the ranking window functions.
+ */
+static void
+gpusort_launch_window(GpuSortState *gss, GpuSortTask *gsort,
+					  CUmodule cuda_module)
+{
+	cl_uint			nitems = gsort->kern.nitems_in;
+	CUdeviceptr		m_gpusort = (CUdeviceptr)&gsort->kern;
+	CUdeviceptr		m_kds_src = (CUdeviceptr)&gsort->pds_src->kds;
+	CUfunction		kern_window_flags;
+	void		   *kern_args[5];
+	cl_int			grid_sz;
+	cl_int			block_sz;
+	CUresult		rc;
+
+	rc = cuModuleGetFunction(&kern_window_flags,
+							 cuda_module,
+							 "kern_gpusort_window_flags");
+	if (rc != CUDA_SUCCESS)
+		werror("failed on cuModuleGetFunction: %s", errorText(rc));
+	rc = gpuOptimalBlockSize(&grid_sz,
+							 &block_sz,
+							 kern_window_flags,
+							 CU_DEVICE_PER_THREAD,
+							 0, 0);
+	if (rc != CUDA_SUCCESS)
+		werror("failed on gpuOptimalBlockSize: %s", errorText(rc));
+	grid_sz = Min(grid_sz, (nitems + block_sz - 1) / block_sz);
+
+	/*
+	 * KERNEL_FUNCTION(void)
+	 * kern_gpusort_window_flags(kern_gpusort *kgpusort,
+	 *                           kern_parambuf *kparams,
+	 *                           kern_data_store *kds_src,
+	 *                           cl_uint *sorted_index,
+	 *                           cl_uchar *window_flags)
+	 */
+	kern_args[0] = &m_gpusort;
+	kern_args[1] = &gss->gts.kern_params;
+	kern_args[2] = &m_kds_src;
+	kern_args[3] = &gsort->sorted_index;
+	kern_args[4] = &gsort->window_flags;
+	gpuTaskTimerRecord(&gsort->task, GPUTASK_TIMER__KERN_BEGIN);
+	rc = cuLaunchKernel(kern_window_flags,
+						grid_sz, 1, 1,
+						block_sz, 1, 1,
+						0,
+						CU_STREAM_PER_THREAD,
+						kern_args,
+						NULL);
+	if (rc != CUDA_SUCCESS)
+		werror("failed on cuLaunchKernel: %s", errorText(rc));
+}
+
+/*
+ * gpusort_process_task
+ */
+static int
+gpusort_process_task(GpuTask *gtask, CUmodule cuda_module)
+{
+	GpuSortState   *gss = (GpuSortState *) gtask->gts;
+	GpuSortTask	   *gsort = (GpuSortTask *) gtask;
+	pgstrom_data_store *pds_src = gsort->pds_src;
+	CUfunction		kern_gpusort_setup;
+	CUdeviceptr		m_gpusort = (CUdeviceptr)&gsort->kern;
+	CUdeviceptr		m_kds_src;
+	void		   *kern_args[5];
+	cl_uint			nitems;
+	cl_uint			nfetches;
+	cl_uint			unitsz = 0;
+	cl_bool			reversing = false;
+	cl_int			grid_sz;
+	cl_int			block_sz;
+	CUresult		rc;
+
+	/* rows are already moved to the tuplesort state */
+	if (gtask->cpu_fallback)
+		return 0;
+	Assert(pds_src->kds.format == KDS_FORMAT_ROW);
+	nitems = pds_src->kds.nitems;
+	m_kds_src = (CUdeviceptr)&pds_src->kds;
+
+	rc = cuModuleGetFunction(&kern_gpusort_setup,
+							 cuda_module,
+							 "kern_gpusort_setup_index");
+	if (rc != CUDA_SUCCESS)
+		werror("failed on cuModuleGetFunction: %s", errorText(rc));
+
+	/*
+	 * OK, enqueue a series of requests
+	 */
+	rc = cuMemPrefetchAsync(m_gpusort,
+							KERN_GPUSORT_LENGTH(nitems),
+							CU_DEVICE_PER_THREAD,
+							CU_STREAM_PER_THREAD);
+	if (rc != CUDA_SUCCESS)
+		werror("failed on cuMemPrefetchAsync: %s", errorText(rc));
+	gpuMemStatDma(KERN_GPUSORT_LENGTH(nitems), 0);
+	rc = cuMemPrefetchAsync(m_kds_src,
+							pds_src->kds.length,
+							CU_DEVICE_PER_THREAD,
+							CU_STREAM_PER_THREAD);
+	if (rc != CUDA_SUCCESS)
+		werror("failed on cuMemPrefetchAsync: %s", errorText(rc));
+	gpuMemStatDma(pds_src->kds.length, 0);
+
+	kern_args[0] = &m_gpusort;
+	kern_args[1] = &gss->gts.kern_params;
+	kern_args[2] = &m_kds_src;
+	kern_args[3] = &unitsz;
+	kern_args[4] = &reversing;
+
+	/*
+	 * KERNEL_FUNCTION(void)
+	 * kern_gpusort_setup_index(kern_gpusort *kgpusort,
+	 *                          kern_parambuf *kparams,
+	 *                          kern_data_store *kds_src)
+	 */
+	rc = gpuOptimalBlockSize(&grid_sz,
+							 &block_sz,
+							 kern_gpusort_setup,
+							 CU_DEVICE_PER_THREAD,
+							 0, sizeof(cl_uint));
+	if (rc != CUDA_SUCCESS)
+		werror("failed on gpuOptimalBlockSize: %s", errorText(rc));
+	grid_sz = Min(grid_sz, (nitems + block_sz - 1) / block_sz);
+	gpuTaskTimerRecord(&gsort->task, GPUTASK_TIMER__KERN_BEGIN);
+	rc = cuLaunchKernel(kern_gpusort_setup,
+						grid_sz, 1, 1,
+						block_sz, 1, 1,
+						sizeof(cl_uint) * block_sz,
+						CU_STREAM_PER_THREAD,
+						kern_args,
+						NULL);
+	if (rc != CUDA_SUCCESS)
+		werror("failed on cuLaunchKernel: %s", errorText(rc));
+
+	if (gss->radix_keybits)
+		gpusort_launch_radix(gss, gsort, cuda_module);
+	else
+		gpusort_launch_bitonic(gss, gsort, cuda_module, kern_args);
+	if (gsort->window_flags)
+		gpusort_launch_window(gss, gsort, cuda_module);
+	gpuTaskTimerRecord(&gsort->task, GPUTASK_TIMER__KERN_END);
+
+	/*
+	 * write back the result index and rows to the host. If top-K bound
+	 * exists, only the leading portion of the result index is written back,
+	 * and the rows referenced are migrated on demand.
+	 */
+	nfetches = nitems;
+	if (gss->sort_bound > 0 && gss->sort_bound < nitems)
+		nfetches = gss->sort_bound;
+	rc = cuMemPrefetchAsync(m_gpusort,
+							KERN_GPUSORT_LENGTH(0),
+							CU_DEVICE_CPU,
+							CU_STREAM_PER_THREAD);
+	if (rc != CUDA_SUCCESS)
+		werror("failed on cuMemPrefetchAsync: %s", errorText(rc));
+	gpuMemStatDma(0, KERN_GPUSORT_LENGTH(0));
+	rc = cuMemPrefetchAsync((CUdeviceptr)gsort->sorted_index,
+							sizeof(cl_uint) * nfetches,
+							CU_DEVICE_CPU,
+							CU_STREAM_PER_THREAD);
+	if (rc != CUDA_SUCCESS)
+		werror("failed on cuMemPrefetchAsync: %s", errorText(rc));
+	gpuMemStatDma(0, sizeof(cl_uint) * nfetches);
+	if (nfetches == nitems)
+	{
+		rc = cuMemPrefetchAsync(m_kds_src,
+								pds_src->kds.length,
+								CU_DEVICE_CPU,
+								CU_STREAM_PER_THREAD);
+		if (rc != CUDA_SUCCESS)
+			werror("failed on cuMemPrefetchAsync: %s", errorText(rc));
+		gpuMemStatDma(0, pds_src->kds.length);
+	}
+	if (gsort->window_flags)
+	{
+		rc = cuMemPrefetchAsync((CUdeviceptr)gsort->window_flags,
+								sizeof(cl_uchar) * nitems,
+								CU_DEVICE_CPU,
+								CU_STREAM_PER_THREAD);
+		if (rc != CUDA_SUCCESS)
+			werror("failed on cuMemPrefetchAsync: %s", errorText(rc));
+		gpuMemStatDma(0, sizeof(cl_uchar) * nitems);
+	}
+
+	rc = cuEventRecord(CU_EVENT_PER_THREAD, CU_STREAM_PER_THREAD);
+	if (rc != CUDA_SUCCESS)
+		werror("failed on cuEventRecord: %s", errorText(rc));
+
+	/* Point of synchronization */
+	rc = cuEventSynchronize(CU_EVENT_PER_THREAD);
+	if (rc != CUDA_SUCCESS)
+		werror("failed on cuEventSynchronize: %s", errorText(rc));
+
+	/*
+	 * Check GPU kernel status
+	 */
+	memcpy(&gsort->task.kerror,
+		   &gsort->kern.kerror, sizeof(kern_errorbuf));
+	if (gsort->task.kerror.errcode == ERRCODE_STROM_SUCCESS)
+	{
+		GpuSortRuntimeStat *gs_rtstat = gss->gs_rtstat;
+		gpusortResultIndex *kresults = KERN_GPUSORT_RESULT_INDEX(&gsort->kern);
+
+		gsort->kern.nitems_out = kresults->nitems;
+		if (gss->sort_bound > 0 && gss->sort_bound < kresults->nitems)
+			gsort->kern.nitems_out = gss->sort_bound;
+		pg_atomic_add_fetch_u64(&gs_rtstat->c.source_nitems,
+								gsort->kern.nitems_in);
+		pg_atomic_add_fetch_u64(&gs_rtstat->c.nitems_filtered,
+								gsort->kern.nitems_in -
+								kresults->nitems);
+	}
+	else if (pgstrom_cpu_fallback_enabled &&
+			 (gsort->task.kerror.errcode & ERRCODE_FLAGS_CPU_FALLBACK) != 0)
+	{
+		gsort->task.fallback_errcode = gsort->task.kerror.errcode;
+		memset(&gsort->task.kerror, 0, sizeof(kern_errorbuf));
+		gsort->task.cpu_fallback = true;
+	}
+	return 0;
+}
+
+/*
+ * gpusort_release_task
+ */
+static void
+__gpusort_release_task(GpuSortTask *gsort)
+{
+	GpuTaskState   *gts = gsort->task.gts;
+
+	if (gsort->pds_src)
+		PDS_release(gsort->pds_src);
+	gpuMemFree(gts->gcontext, (CUdeviceptr) gsort);
+}
+
+static void
+gpusort_release_task(GpuTask *gtask)
+{
+	GpuSortTask	   *gsort = (GpuSortTask *) gtask;
+
+	/* sorted runs are released at end of the k-way merge */
+	if (gsort->retained)
+		return;
+	if (gsort->is_merge_task)
+		gpusort_release_merge_runs((GpuSortState *) gsort->task.gts);
+	__gpusort_release_task(gsort);
+}
+
+/*
+ * gpusort_release_merge_runs
+ */
+static void
+gpusort_release_merge_runs(GpuSortState *gss)
+{
+	ListCell   *lc;
+
+	foreach (lc, gss->sorted_runs)
+		__gpusort_release_task((GpuSortTask *) lfirst(lc));
+	list_free(gss->sorted_runs);
+	gss->sorted_runs = NIL;
+	if (gss->merge_heap)
+		binaryheap_free(gss->merge_heap);
+	gss->merge_heap = NULL;
+	gss->merge_runs = NULL;
+	gss->merge_count = 0;
+}
+
+/*
+ * pgstrom_init_gpusort
+ */
+void
+pgstrom_init_gpusort(void)
+{
+	size_t		shared_buffer_size = (size_t)NBuffers * (size_t)BLCKSZ;
+	size_t		default_max_host_memory = 0;
+
+	/* pg_strom.enable_gpusort */
+	DefineCustomBoolVariable("pg_strom.enable_gpusort",
+							 "Enables the use of GPU accelerated sorting",
+							 NULL,
+							 &enable_gpusort,
+							 false,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	/* pg_strom.enable_gpusort_radix */
+	DefineCustomBoolVariable("pg_strom.enable_gpusort_radix",
+							 "Enables the radix sort for fixed-width keys on GpuSort",
+							 NULL,
+							 &enable_gpusort_radix,
+							 true,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	/* pg_strom.enable_gpusort_window */
+	DefineCustomBoolVariable("pg_strom.enable_gpusort_window",
+							 "Enables the ranking window functions on GpuSort",
+							 NULL,
+							 &enable_gpusort_window,
+							 true,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	/*
+	 * pg_strom.gpusort_max_host_memory
+	 *
+	 * Default: half of the system RAM except for the shared buffers.
+	 */
+	if (PAGE_SIZE * PHYS_PAGES > shared_buffer_size)
+		default_max_host_memory = (PAGE_SIZE * PHYS_PAGES -
+								   shared_buffer_size) / 2;
+	DefineCustomIntVariable("pg_strom.gpusort_max_host_memory",
+							"Max estimated input size of GpuSort to be kept on the host memory",
+							NULL,
+							&gpusort_max_host_memory_kb,
+							Min(default_max_host_memory >> 10, INT_MAX),
+							0,
+							INT_MAX,
+							PGC_USERSET,
+							GUC_NOT_IN_SAMPLE | GUC_UNIT_KB,
+							NULL, NULL, NULL);
+
+	/* setup path methods */
+	memset(&gpusort_path_methods, 0, sizeof(gpusort_path_methods));
+	gpusort_path_methods.CustomName			= "GpuSort";
+	gpusort_path_methods.PlanCustomPath		= PlanGpuSortPath;
+
+	/* setup plan methods */
+	memset(&gpusort_plan_methods, 0, sizeof(gpusort_plan_methods));
+	gpusort_plan_methods.CustomName			= "GpuSort";
+	gpusort_plan_methods.CreateCustomScanState = gpusort_create_scan_state;
+	RegisterCustomScanMethods(&gpusort_plan_methods);
+
+	/* setup exec methods */
+	memset(&gpusort_exec_methods, 0, sizeof(gpusort_exec_methods));
+	gpusort_exec_methods.CustomName         = "GpuSort";
+	gpusort_exec_methods.BeginCustomScan    = ExecInitGpuSort;
+	gpusort_exec_methods.ExecCustomScan     = ExecGpuSort;
+	gpusort_exec_methods.EndCustomScan      = ExecEndGpuSort;
+	gpusort_exec_methods.ReScanCustomScan   = ExecReScanGpuSort;
+	gpusort_exec_methods.ExplainCustomScan  = ExplainGpuSort;
+
+	/* hook registration */
+	create_upper_paths_next = create_upper_paths_hook;
+	create_upper_paths_hook = gpusort_add_upper_paths;
+}
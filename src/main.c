@@ -17,8 +17,10 @@ PG_MODULE_MAGIC;
  * miscellaneous GUC parameters
  */
 bool		pgstrom_enabled;
+bool		pgstrom_bulkexec_enabled;
 bool		pgstrom_cpu_fallback_enabled;
 bool		pgstrom_regression_test_mode;
+static bool	pgstrom_explain_offload_blockers;	/* GUC */
 
 /* cost factors */
 double		pgstrom_gpu_setup_cost;
@@ -28,9 +30,15 @@ double		pgstrom_gpu_operator_cost;
 /* misc static variables */
 static HTAB				   *gpu_path_htable = NULL;
 static planner_hook_type	planner_hook_next = NULL;
+static ExplainOneQuery_hook_type explain_one_query_next = NULL;
 static CustomPathMethods	pgstrom_dummy_path_methods;
 static CustomScanMethods	pgstrom_dummy_plan_methods;
 
+/* reasons why GPU offload was blocked, collected during EXPLAIN */
+static bool					offload_blockers_enabled = false;
+static List				   *offload_blockers = NIL;
+static MemoryContext		offload_blockers_memcxt = NULL;
+
 /* misc variables */
 long		PAGE_SIZE;
 long		PAGE_MASK;
@@ -76,6 +84,15 @@ pgstrom_init_common_guc(void)
 							 PGC_USERSET,
 							 GUC_NOT_IN_SAMPLE,
 							 NULL, NULL, NULL);
+	/* turn on/off hand-off of the results between GPU nodes on device */
+	DefineCustomBoolVariable("pg_strom.bulkexec",
+							 "Enables to hand over the results of GpuJoin to the parent GPU node on the device",
+							 NULL,
+							 &pgstrom_bulkexec_enabled,
+							 true,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
 	/* turn on/off CPU fallback if GPU could not execute the query */
 	DefineCustomBoolVariable("pg_strom.cpu_fallback",
 							 "Enables CPU fallback if GPU required re-run",
@@ -127,6 +144,15 @@ pgstrom_init_common_guc(void)
 							 PGC_USERSET,
 							 GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE,
 							 NULL, NULL, NULL);
+	/* reports the reason why GPU offload was blocked in EXPLAIN */
+	DefineCustomBoolVariable("pg_strom.explain_offload_blockers",
+							 "Shows the reason why expressions or operators were not offloaded to GPU in EXPLAIN",
+							 NULL,
+							 &pgstrom_explain_offload_blockers,
+							 false,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
 }
 
 /*
@@ -513,6 +539,154 @@ pgstrom_post_planner(Query *parse,
 	return pstmt;
 }
 
+/*
+ * pgstrom_record_offload_blocker
+ *
+ * It records the reason why an expression or operator was not offloaded to
+ * GPU, to be shown by EXPLAIN. It does nothing unless EXPLAIN is running with
+ * pg_strom.explain_offload_blockers = on.
+ */
+void
+pgstrom_record_offload_blocker(const char *fmt, ...)
+{
+	MemoryContext oldcxt;
+	StringInfoData buf;
+	ListCell   *lc;
+	char	   *message;
+	va_list		ap;
+	int			needed;
+
+	if (!offload_blockers_enabled)
+		return;
+	oldcxt = MemoryContextSwitchTo(offload_blockers_memcxt);
+	initStringInfo(&buf);
+	for (;;)
+	{
+		va_start(ap, fmt);
+		needed = appendStringInfoVA(&buf, fmt, ap);
+		va_end(ap);
+		if (needed == 0)
+			break;
+		enlargeStringInfo(&buf, needed);
+	}
+	message = buf.data;
+	/* same reason shall be reported many times during path construction */
+	foreach (lc, offload_blockers)
+	{
+		if (strcmp((char *)lfirst(lc), message) == 0)
+		{
+			pfree(message);
+			message = NULL;
+			break;
+		}
+	}
+	if (message)
+		offload_blockers = lappend(offload_blockers, message);
+	MemoryContextSwitchTo(oldcxt);
+}
+
+/*
+ * pgstrom_explain_one_query
+ *
+ * It plans the query as standard ExplainOneQuery() doing, but collects the
+ * reasons why GPU offload was blocked during the planning, then shows them
+ * next to the query plan.
+ */
+static void
+pgstrom_explain_one_query(Query *query,
+						  int cursorOptions,
+						  IntoClause *into,
+						  ExplainState *es,
+						  const char *queryString,
+						  ParamListInfo params,
+						  QueryEnvironment *queryEnv)
+{
+	bool		saved_enabled = offload_blockers_enabled;
+	List	   *saved_blockers = offload_blockers;
+	MemoryContext saved_memcxt = offload_blockers_memcxt;
+	List	   *blockers;
+
+	PG_TRY();
+	{
+		offload_blockers_enabled = (pgstrom_enabled &&
+									pgstrom_explain_offload_blockers);
+		offload_blockers = NIL;
+		offload_blockers_memcxt = CurrentMemoryContext;
+
+		if (explain_one_query_next)
+		{
+			explain_one_query_next(query, cursorOptions, into, es,
+								   queryString, params, queryEnv);
+		}
+		else
+		{
+			PlannedStmt *plan;
+			instr_time	planstart;
+			instr_time	planduration;
+#if PG_VERSION_NUM >= 130000
+			BufferUsage	bufusage_start;
+			BufferUsage	bufusage;
+
+			if (es->buffers)
+				bufusage_start = pgBufferUsage;
+#endif
+			INSTR_TIME_SET_CURRENT(planstart);
+#if PG_VERSION_NUM >= 130000
+			plan = pg_plan_query(query, queryString, cursorOptions, params);
+#else
+			plan = pg_plan_query(query, cursorOptions, params);
+#endif
+			INSTR_TIME_SET_CURRENT(planduration);
+			INSTR_TIME_SUBTRACT(planduration, planstart);
+			/* no more reasons to be collected after the planning */
+			offload_blockers_enabled = false;
+#if PG_VERSION_NUM >= 130000
+			if (es->buffers)
+			{
+				memset(&bufusage, 0, sizeof(BufferUsage));
+				BufferUsageAccumDiff(&bufusage, &pgBufferUsage,
+									 &bufusage_start);
+			}
+			ExplainOnePlan(plan, into, es, queryString, params, queryEnv,
+						   &planduration, (es->buffers ? &bufusage : NULL));
+#else
+			ExplainOnePlan(plan, into, es, queryString, params, queryEnv,
+						   &planduration);
+#endif
+		}
+	}
+	PG_CATCH();
+	{
+		offload_blockers_enabled = saved_enabled;
+		offload_blockers = saved_blockers;
+		offload_blockers_memcxt = saved_memcxt;
+		PG_RE_THROW();
+	}
+	PG_END_TRY();
+	blockers = offload_blockers;
+	offload_blockers_enabled = saved_enabled;
+	offload_blockers = saved_blockers;
+	offload_blockers_memcxt = saved_memcxt;
+
+	if (blockers != NIL)
+	{
+		ExplainOpenGroup("GPU Offload", NULL, true, es);
+		if (es->format == EXPLAIN_FORMAT_TEXT)
+		{
+			ListCell   *lc;
+
+			foreach (lc, blockers)
+				ExplainPropertyText("GPU Offload Blocker",
+									(char *)lfirst(lc), es);
+		}
+		else
+		{
+			ExplainPropertyList("GPU Offload Blockers", blockers, es);
+		}
+		ExplainCloseGroup("GPU Offload", NULL, true, es);
+	}
+}
+
 /*
  * Routines to support user's extra GPU logic
  */
@@ -592,7 +766,10 @@ _PG_init(void)
 	pgstrom_init_gpuscan();
 	pgstrom_init_gpujoin();
 	pgstrom_init_gpupreagg();
+	pgstrom_init_gpusort();
 	pgstrom_init_relscan();
+	pgstrom_init_zonemap();
+	pgstrom_init_feedback();
 	pgstrom_init_arrow_fdw();
 	pgstrom_init_gpu_cache();
 
@@ -610,4 +787,7 @@ _PG_init(void)
 	/* planner hook registration */
 	planner_hook_next = (planner_hook ? planner_hook : standard_planner);
 	planner_hook = pgstrom_post_planner;
+	/* EXPLAIN hook registration */
+	explain_one_query_next = ExplainOneQuery_hook;
+	ExplainOneQuery_hook = pgstrom_explain_one_query;
 }
@@ -1536,6 +1536,246 @@ pgstrom_abort_if(PG_FUNCTION_ARGS)
 }
 PG_FUNCTION_INFO_V1(pgstrom_abort_if);
 
+/*
+ * ----------------------------------------------------------------
+ *
+ * SQL functions for vector similarity search
+ *
+ * ----------------------------------------------------------------
+ */
+Datum pgstrom_l2_distance(PG_FUNCTION_ARGS);
+Datum pgstrom_inner_product(PG_FUNCTION_ARGS);
+Datum pgstrom_negative_inner_product(PG_FUNCTION_ARGS);
+Datum pgstrom_cosine_distance(PG_FUNCTION_ARGS);
+
+static float4 *
+__fetch_float4_vector(ArrayType *array, int *p_nitems)
+{
+	if (ARR_ELEMTYPE(array) != FLOAT4OID)
+		elog(ERROR, "vector must be float4[]");
+	if (array_contains_nulls(array))
+		ereport(ERROR,
+				(errcode(ERRCODE_NULL_VALUE_NOT_ALLOWED),
+				 errmsg("vector must not contain nulls")));
+	*p_nitems = ArrayGetNItems(ARR_NDIM(array), ARR_DIMS(array));
+	return (float4 *) ARR_DATA_PTR(array);
+}
+
+static void
+__compute_float4_vector(FunctionCallInfo fcinfo,
+						double *p_l2, double *p_dot,
+						double *p_norm1, double *p_norm2)
+{
+	ArrayType  *array1 = PG_GETARG_ARRAYTYPE_P(0);
+	ArrayType  *array2 = PG_GETARG_ARRAYTYPE_P(1);
+	float4	   *x, *y;
+	int			i, nitems1, nitems2;
+	double		l2 = 0.0, dot = 0.0, norm1 = 0.0, norm2 = 0.0;
+
+	x = __fetch_float4_vector(array1, &nitems1);
+	y = __fetch_float4_vector(array2, &nitems2);
+	if (nitems1 != nitems2)
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_EXCEPTION),
+				 errmsg("different vector dimensions %d and %d",
+						nitems1, nitems2)));
+	for (i=0; i < nitems1; i++)
+	{
+		double	xv = x[i];
+		double	yv = y[i];
+
+		l2    += (xv - yv) * (xv - yv);
+		dot   += xv * yv;
+		norm1 += xv * xv;
+		norm2 += yv * yv;
+	}
+	*p_l2 = l2;
+	*p_dot = dot;
+	*p_norm1 = norm1;
+	*p_norm2 = norm2;
+}
+
+Datum
+pgstrom_l2_distance(PG_FUNCTION_ARGS)
+{
+	double		l2, dot, norm1, norm2;
+
+	__compute_float4_vector(fcinfo, &l2, &dot, &norm1, &norm2);
+	PG_RETURN_FLOAT8(sqrt(l2));
+}
+PG_FUNCTION_INFO_V1(pgstrom_l2_distance);
+
+Datum
+pgstrom_inner_product(PG_FUNCTION_ARGS)
+{
+	double		l2, dot, norm1, norm2;
+
+	__compute_float4_vector(fcinfo, &l2, &dot, &norm1, &norm2);
+	PG_RETURN_FLOAT8(dot);
+}
+PG_FUNCTION_INFO_V1(pgstrom_inner_product);
+
+Datum
+pgstrom_negative_inner_product(PG_FUNCTION_ARGS)
+{
+	double		l2, dot, norm1, norm2;
+
+	__compute_float4_vector(fcinfo, &l2, &dot, &norm1, &norm2);
+	PG_RETURN_FLOAT8(-dot);
+}
+PG_FUNCTION_INFO_V1(pgstrom_negative_inner_product);
+
+Datum
+pgstrom_cosine_distance(PG_FUNCTION_ARGS)
+{
+	double		l2, dot, norm1, norm2;
+	double		sim;
+
+	__compute_float4_vector(fcinfo, &l2, &dot, &norm1, &norm2);
+	if (norm1 == 0.0 || norm2 == 0.0)
+		PG_RETURN_FLOAT8(get_float8_nan());
+	sim = dot / sqrt(norm1 * norm2);
+	/* keep in range, against the rounding error */
+	if (sim > 1.0)
+		sim = 1.0;
+	else if (sim < -1.0)
+		sim = -1.0;
+	PG_RETURN_FLOAT8(1.0 - sim);
+}
+PG_FUNCTION_INFO_V1(pgstrom_cosine_distance);
+
+/*
+ * ----------------------------------------------------------------
+ *
+ * SQL functions for time-series data
+ *
+ * ----------------------------------------------------------------
+ */
+Datum pgstrom_time_bucket_timestamp(PG_FUNCTION_ARGS);
+Datum pgstrom_time_bucket_timestamp_origin(PG_FUNCTION_ARGS);
+Datum pgstrom_time_bucket_timestamptz(PG_FUNCTION_ARGS);
+Datum pgstrom_time_bucket_timestamptz_origin(PG_FUNCTION_ARGS);
+Datum pgstrom_time_bucket_timestamptz_zone(PG_FUNCTION_ARGS);
+
+/* 2000-01-03 (Monday); see time_bucket_internal() in cuda_timelib.cu */
+#define TIME_BUCKET_DEFAULT_ORIGIN		(2 * USECS_PER_DAY)
+
+static Timestamp
+__time_bucket(Interval *iv, Timestamp ts, Timestamp origin)
+{
+	Timestamp	result;
+
+	if (TIMESTAMP_NOT_FINITE(ts))
+		return ts;
+	if (iv->month != 0)
+	{
+		struct pg_tm tm, otm;
+		fsec_t		fsec, ofsec;
+		int64		base, months;
+
+		if (iv->month < 0 || iv->day != 0 || iv->time != 0)
+			ereport(ERROR,
+					(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+					 errmsg("month intervals cannot have day or time component")));
+		if (timestamp2tm(ts, NULL, &tm, &fsec, NULL, NULL) != 0 ||
+			timestamp2tm(origin, NULL, &otm, &ofsec, NULL, NULL) != 0)
+			ereport(ERROR,
+					(errcode(ERRCODE_DATETIME_VALUE_OUT_OF_RANGE),
+					 errmsg("timestamp out of range")));
+		base = (int64)otm.tm_year * MONTHS_PER_YEAR + (otm.tm_mon - 1);
+		months = (int64)tm.tm_year * MONTHS_PER_YEAR + (tm.tm_mon - 1) - base;
+		months -= ((months % iv->month) + iv->month) % iv->month;
+		months += base;
+		tm.tm_mon  = ((months % MONTHS_PER_YEAR) + MONTHS_PER_YEAR) % MONTHS_PER_YEAR;
+		tm.tm_year = (months - tm.tm_mon) / MONTHS_PER_YEAR;
+		tm.tm_mon += 1;
+		tm.tm_mday = 1;
+		tm.tm_hour = 0;
+		tm.tm_min  = 0;
+		tm.tm_sec  = 0;
+		if (tm2timestamp(&tm, 0, NULL, &result) != 0)
+			ereport(ERROR,
+					(errcode(ERRCODE_DATETIME_VALUE_OUT_OF_RANGE),
+					 errmsg("timestamp out of range")));
+	}
+	else
+	{
+		int64		width = (int64)iv->day * USECS_PER_DAY + iv->time;
+		int64		rem;
+
+		if (width <= 0)
+			ereport(ERROR,
+					(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+					 errmsg("period must be greater than 0")));
+		rem = (ts - origin) % width;
+		if (rem < 0)
+			rem += width;
+		result = ts - rem;
+	}
+	return result;
+}
+
+Datum
+pgstrom_time_bucket_timestamp(PG_FUNCTION_ARGS)
+{
+	Interval   *iv = PG_GETARG_INTERVAL_P(0);
+	Timestamp	ts = PG_GETARG_TIMESTAMP(1);
+
+	PG_RETURN_TIMESTAMP(__time_bucket(iv, ts, TIME_BUCKET_DEFAULT_ORIGIN));
+}
+PG_FUNCTION_INFO_V1(pgstrom_time_bucket_timestamp);
+
+Datum
+pgstrom_time_bucket_timestamp_origin(PG_FUNCTION_ARGS)
+{
+	Interval   *iv = PG_GETARG_INTERVAL_P(0);
+	Timestamp	ts = PG_GETARG_TIMESTAMP(1);
+	Timestamp	origin = PG_GETARG_TIMESTAMP(2);
+
+	PG_RETURN_TIMESTAMP(__time_bucket(iv, ts, origin));
+}
+PG_FUNCTION_INFO_V1(pgstrom_time_bucket_timestamp_origin);
+
+Datum
+pgstrom_time_bucket_timestamptz(PG_FUNCTION_ARGS)
+{
+	Interval   *iv = PG_GETARG_INTERVAL_P(0);
+	TimestampTz	ts = PG_GETARG_TIMESTAMPTZ(1);
+
+	PG_RETURN_TIMESTAMPTZ(__time_bucket(iv, ts, TIME_BUCKET_DEFAULT_ORIGIN));
+}
+PG_FUNCTION_INFO_V1(pgstrom_time_bucket_timestamptz);
+
+Datum
+pgstrom_time_bucket_timestamptz_origin(PG_FUNCTION_ARGS)
+{
+	Interval   *iv = PG_GETARG_INTERVAL_P(0);
+	TimestampTz	ts = PG_GETARG_TIMESTAMPTZ(1);
+	TimestampTz	origin = PG_GETARG_TIMESTAMPTZ(2);
+
+	PG_RETURN_TIMESTAMPTZ(__time_bucket(iv, ts, origin));
+}
+PG_FUNCTION_INFO_V1(pgstrom_time_bucket_timestamptz_origin);
+
+Datum
+pgstrom_time_bucket_timestamptz_zone(PG_FUNCTION_ARGS)
+{
+	Interval   *iv = PG_GETARG_INTERVAL_P(0);
+	TimestampTz	ts = PG_GETARG_TIMESTAMPTZ(1);
+	Datum		zone = PG_GETARG_DATUM(2);
+	Timestamp	local;
+
+	if (TIMESTAMP_NOT_FINITE(ts))
+		PG_RETURN_TIMESTAMPTZ(ts);
+	/* bucketing on the local time of the zone */
+	local = DatumGetTimestamp(DirectFunctionCall2(timestamptz_zone, zone,
+												  TimestampTzGetDatum(ts)));
+	local = __time_bucket(iv, local, TIME_BUCKET_DEFAULT_ORIGIN);
+	PG_RETURN_DATUM(DirectFunctionCall2(timestamp_zone, zone,
+										TimestampGetDatum(local)));
+}
+PG_FUNCTION_INFO_V1(pgstrom_time_bucket_timestamptz_zone);
+
 /*
  * Simple wrapper for read(2) and write(2) to ensure full-buffer read and
  * write, regardless of i/o-size and signal interrupts.
@@ -204,6 +204,7 @@ typedef HeapScanDesc					TableScanDesc;
 typedef HeapScanDescData				TableScanDescData;
 typedef ParallelHeapScanDesc			ParallelTableScanDesc;
 typedef ParallelHeapScanDescData		ParallelTableScanDescData;
+typedef HeapUpdateFailureData			TM_FailureData;
 
 #define table_open(a,b)					heap_open(a,b)
 #define table_openrv(a,b)				heap_openrv(a,b)
@@ -277,6 +278,13 @@ ExecFetchSlotHeapTuple(TupleTableSlot *slot,
 #if PG_VERSION_NUM < 130000
 #define HeapCheckForSerializableConflictOut(a,b,c,d,e)	\
 	CheckForSerializableConflictOut(a,b,c,d,e)
+/*
+ * CheckForSerializableConflictOutNeeded() was also added at PG13.
+ * For the older versions, we assume SSI check is needed if serializable
+ * isolation level, as a conservative approximation.
+ */
+#define CheckForSerializableConflictOutNeeded(rel,snapshot)	\
+	IsolationIsSerializable()
 #endif
 
 /*
@@ -347,6 +355,14 @@ add_function_cost(PlannerInfo *root, Oid funcid, Node *node,
 #define GetCommandTagName(tag)		(tag)
 #endif
 
+/*
+ * MEMO: PG13 moved heap_tuple_untoast_attr() in tuptoaster.c to
+ * detoast_attr() in detoast.c, as a part of the table AM refactoring.
+ */
+#if PG_VERSION_NUM < 130000
+#define detoast_attr(attr)			heap_tuple_untoast_attr(attr)
+#endif
+
 /*
  * PG13 replaced set_deparse_context_planstate by set_deparse_context_plan.
  * As literal, it allows to construct a deparse context by Plan-node,
@@ -21,21 +21,26 @@
 
 #include "access/brin.h"
 #include "access/brin_revmap.h"
+#include "access/clog.h"
+#include "access/genam.h"
 #include "access/generic_xlog.h"
 #include "access/gist.h"
 #include "access/hash.h"
 #include "access/heapam.h"
 #include "access/heapam_xlog.h"
 #if PG_VERSION_NUM >= 130000
+#include "access/detoast.h"
 #include "access/heaptoast.h"
 #endif
 #include "access/htup_details.h"
 #include "access/reloptions.h"
 #include "access/relscan.h"
+#include "access/subtrans.h"
 #if PG_VERSION_NUM >= 140000
 #include "access/syncscan.h"
 #endif
 #include "access/sysattr.h"
+#include "access/transam.h"
 #if PG_VERSION_NUM < 130000
 #include "access/tuptoaster.h"
 #endif
@@ -97,10 +102,12 @@
 #include "executor/nodeIndexscan.h"
 #include "executor/nodeCustom.h"
 #include "executor/nodeSubplan.h"
+#include "executor/spi.h"
 #include "fmgr.h"
 #include "foreign/fdwapi.h"
 #include "foreign/foreign.h"
 #include "funcapi.h"
+#include "lib/binaryheap.h"
 #include "lib/ilist.h"
 #include "lib/stringinfo.h"
 #include "libpq/be-fsstubs.h"
@@ -166,6 +173,7 @@
 #include "storage/shmem.h"
 #include "storage/smgr.h"
 #include "storage/spin.h"
+#include "tcop/tcopprot.h"
 #include "utils/array.h"
 #include "utils/arrayaccess.h"
 #include "utils/builtins.h"
@@ -201,6 +209,7 @@
 #if PG_VERSION_NUM < 120000
 #include "utils/tqual.h"
 #endif
+#include "utils/tuplesort.h"
 #include "utils/typcache.h"
 #include "utils/uuid.h"
 #include "utils/varbit.h"
@@ -209,6 +218,9 @@
 #define CUDA_API_PER_THREAD_DEFAULT_STREAM		1
 #include <cuda.h>
 #include <nvrtc.h>
+#ifdef WITH_NVTX
+#include <nvtx3/nvToolsExt.h>
+#endif
 #include <assert.h>
 #include <pthread.h>
 #include <unistd.h>
@@ -262,6 +274,9 @@
 #include "pg_compat.h"
 
 #define RESTRACK_HASHSIZE		53
+#define GPUMEM_SLAB_MIN_BIT		8		/* 256B */
+#define GPUMEM_SLAB_MAX_BIT		13		/* 8KB */
+#define GPUMEM_SLAB_NCLASSES	(GPUMEM_SLAB_MAX_BIT - GPUMEM_SLAB_MIN_BIT + 1)
 typedef struct GpuContext
 {
 	dlist_node		chain;
@@ -280,6 +295,11 @@ typedef struct GpuContext
 	dlist_head		gm_iomap_list;		/* list of I/O map memory segments */
 	dlist_head		gm_managed_list;	/* list of managed memory segments */
 	dlist_head		gm_hostmem_list;	/* list of Host memory segments */
+	slock_t			gm_slab_lock;
+	dlist_head		gm_slab_normal[GPUMEM_SLAB_NCLASSES];	/* slabs of small device memory */
+	dlist_head		gm_slab_managed[GPUMEM_SLAB_NCLASSES];	/* slabs of small managed memory */
+	pg_atomic_uint64 gm_query_usage;	/* device memory used by the query */
+	pg_atomic_uint64 gm_query_peak;		/* its peak usage */
 	/* error information buffer */
 	pg_atomic_uint32 error_level;
 	int				error_code;
@@ -324,6 +344,43 @@ typedef struct GpuTaskSharedState	GpuTaskSharedState;
 typedef struct ArrowFdwState		ArrowFdwState;
 typedef struct GpuCacheState		GpuCacheState;
 
+/*
+ * GpuCacheScanVersion - identifier of the GPU cache contents; see
+ * gpuCacheGetScanVersion() in gpu_cache.c
+ */
+typedef struct
+{
+	Oid			database_oid;
+	Oid			table_oid;
+	Datum		signature;
+	uint64		load_timestamp;	/* last initial loading */
+	uint64		write_pos;		/* end of the REDO logs written */
+} GpuCacheScanVersion;
+
+/*
+ * Reasons of CPU fallback, classified by the error code reported by GPU
+ * kernel; see pgstrom_cpu_fallback_reason() in gpu_tasks.c.
+ */
+#define GPUTASK_FALLBACK__SPECULATIVE	0	/* CPU took the chunk by itself */
+#define GPUTASK_FALLBACK__OUT_OF_MEMORY	1	/* buffer or heap exhausted */
+#define GPUTASK_FALLBACK__VARLENA		2	/* compressed or external varlena */
+#define GPUTASK_FALLBACK__NUMERIC		3	/* numeric out of range */
+#define GPUTASK_FALLBACK__RECURSION		4	/* too deep recursion */
+#define GPUTASK_FALLBACK__VISIBILITY	5	/* visibility check needed */
+#define GPUTASK_FALLBACK__UNSUPPORTED	6	/* unsupported feature on device */
+#define GPUTASK_FALLBACK__OTHERS		7
+#define GPUTASK_FALLBACK__NUM_REASONS	8
+
+/*
+ * State of the adaptive execution between GPU and CPU; see
+ * adaptive_account_task() in gpu_tasks.c.
+ */
+#define GTS_ADAPTIVE__DISABLED		0
+#define GTS_ADAPTIVE__SAMPLE_GPU	1	/* measuring chunks by GPU */
+#define GTS_ADAPTIVE__SAMPLE_CPU	2	/* measuring chunks by CPU */
+#define GTS_ADAPTIVE__RUN_GPU		3	/* GPU was faster */
+#define GTS_ADAPTIVE__RUN_CPU		4	/* CPU was faster */
+
 /*
  * GpuTaskState
  *
@@ -343,6 +400,10 @@ struct GpuTaskState
 	List		   *used_params;	/* Const/Param expressions */
 	const Bitmapset *optimal_gpus;	/* GPUs preference on plan time */
 	bool			scan_done;		/* True, if no more rows to read */
+	bool			device_handoff;	/* True, if parent GPU node takes the
+									 * results on the device as is */
+	uint64			query_id;		/* queryId of the PlannedStmt */
+	cl_uint			last_task_id;	/* task_id of the last GpuTask */
 
 	/* fields for outer scan */
 	Cost			outer_startup_cost;	/* copy from the outer path node */
@@ -353,6 +414,8 @@ struct GpuTaskState
 	Bitmapset	   *outer_refs;		/* referenced outer attributes */
 	Instrumentation	outer_instrument; /* runtime statistics, if any */
 	TupleTableSlot *scan_overflow;	/* temporary buffer, if no space on PDS */
+	bool			outer_handoff;	/* outer GpuJoin hands over its results
+									 * on the device; see device_handoff */
 	/* BRIN index support on outer relation, if any */
 	struct pgstromIndexState *outer_index_state;
 	Bitmapset	   *outer_index_map;
@@ -369,6 +432,8 @@ struct GpuTaskState
 	 */
 	struct NVMEScanState *nvme_sstate;
 	long			nvme_count;			/* # of blocks loaded by SSD2GPU */
+	long			nvme_cached_count;	/* # of blocks copied from the shared
+										 * buffer, under NVMe-Strom mode */
 
 	/*
 	 * fields to fetch rows from the current task
@@ -384,6 +449,8 @@ struct GpuTaskState
 	cl_long			curr_index;		/* current position on the curr_task */
 	cl_long			curr_lp_index;	/* index of LinePointer in a block */
 	HeapTupleData	curr_tuple;		/* internal use of PDS_fetch() */
+	MemoryContext	fetch_memcxt;	/* datum built by PDS_fetch(); reset
+									 * for each row */
 	struct GpuTask *curr_task;	/* a GpuTask currently processed */
 
 	/* callbacks used by gputasks.c */
@@ -395,13 +462,56 @@ struct GpuTaskState
 	int			  (*cb_process_task)(GpuTask *gtask,
 									 CUmodule cuda_module);
 	void		  (*cb_release_task)(GpuTask *gtask);
+	bool		  (*cb_speculative_task)(GpuTaskState *gts, GpuTask *gtask);
+	struct pgstrom_data_store *(*cb_bulk_exec)(GpuTaskState *gts,
+											   GpuTask *gtask);
+	bool		  (*cb_begin_exec)(GpuTaskState *gts);
+	/* asynchronous execution of the children of Append */
+	GpuTaskState   *async_next;		/* next GPU node under the same Append */
+	bool			async_launched;	/* GpuTasks are already launched */
 	/* list of GpuTasks (protexted with GpuContext->mutex) */
 	dlist_head		ready_tasks;	/* list of tasks already processed */
 	cl_uint			num_running_tasks;	/* # of running tasks */
 	cl_uint			num_ready_tasks;	/* # of ready tasks */
+	cl_int			num_async_limit;	/* adaptive limit of in-flight tasks */
+	/* adaptive chunk size of heap scan */
+	size_t			chunk_size_curr;	/* current chunk size */
+	cl_int			chunk_size_dir;		/* +1:grow, -1:shrink, 0:stable */
+	cl_int			chunk_num_tasks;	/* # of tasks at the current size */
+	cl_ulong		chunk_sum_usec;		/* sum of process time */
+	double			chunk_tput_prev;	/* throughput at the previous size */
+	cl_long			heap_readahead_pos;	/* next position to be read-ahead */
+	/* adaptive execution between GPU and CPU */
+	cl_int			adaptive_mode;		/* one of GTS_ADAPTIVE__* */
+	cl_uint			adaptive_nchunks[2];	/* # of sampled chunks (GPU/CPU) */
+	double			adaptive_cost[2];	/* sum of usec per MB (GPU/CPU) */
+	double			adaptive_curr_usec;	/* usec consumed by the curr_task */
+	cl_ulong		num_adaptive_cpu;	/* # of chunks processed by CPU */
+
+	/* per-phase timing in usec, for EXPLAIN ANALYZE */
+	cl_ulong		tv_build_chunk;		/* chunk build on CPU */
+	cl_ulong		tv_dma_send;		/* DMA host-to-device */
+	cl_ulong		tv_kern_exec;		/* GPU kernel execution */
+	cl_ulong		tv_dma_recv;		/* DMA device-to-host */
+	cl_ulong		tv_wait_task;		/* wait for GpuTask completion */
+	cl_ulong		tv_jit_build;		/* wait for JIT build of GPU code */
+	cl_ulong		num_kern_exec;		/* # of kernel launches */
+	/* per-stage cycle counters (pg_strom.debug_kernel_profiling) */
+	cl_ulong		kern_profile[KERN_PROFILE__NUM_STAGES];
+
+	/* per-process counters for pgstrom.stat_gpu_query (never merged) */
+	cl_ulong		qstat_num_tasks;
+	cl_ulong		qstat_kern_exec;
+	cl_ulong		qstat_gpu_usec;
+	cl_ulong		qstat_fallback_chunks;
+	cl_ulong		qstat_fallback_rows;
+	cl_ulong		qstat_jit_usec;
 
 	/* misc fields */
 	cl_long			num_cpu_fallbacks;	/* # of CPU fallback chunks */
+	cl_ulong		fallback_reasons[GPUTASK_FALLBACK__NUM_REASONS];
+	size_t			gpumem_peak;	/* peak device memory of the workers */
+	cl_ulong		adaptive_cpu_count;	/* chunks by CPU in the workers */
 	uint64			debug_counter0;
 	uint64			debug_counter1;
 	uint64			debug_counter2;
@@ -421,6 +531,9 @@ struct GpuTaskSharedState
 	pg_atomic_uint32 af_rbatch_index;
 	pg_atomic_uint32 af_rbatch_nload; /* # of loaded record-batches */
 	pg_atomic_uint32 af_rbatch_nskip; /* # of skipped record-batches */
+	pg_atomic_uint64 af_rbatch_comp_sz;	/* compressed bytes loaded */
+	pg_atomic_uint64 af_rbatch_raw_sz;	/* decompressed bytes of the above */
+	pg_atomic_uint64 af_rbatch_gpu_comp_sz;	/* compressed bytes by GPU */
 	/* for gpu_cache file scan  */
 	pg_atomic_uint32 gc_fetch_count;
 	/* for block-based regular table scan */
@@ -443,8 +556,22 @@ typedef struct
 	pg_atomic_uint64	source_nitems;
 	pg_atomic_uint64	nitems_filtered;
 	pg_atomic_uint64	nvme_count;
+	pg_atomic_uint64	nvme_cached_count;
 	pg_atomic_uint64	brin_count;
 	pg_atomic_uint64	fallback_count;
+	pg_atomic_uint64	fallback_reasons[GPUTASK_FALLBACK__NUM_REASONS];
+	pg_atomic_uint64	gpumem_peak;
+	pg_atomic_uint64	adaptive_cpu_count;
+	/* per-phase timing */
+	pg_atomic_uint64	tv_build_chunk;
+	pg_atomic_uint64	tv_dma_send;
+	pg_atomic_uint64	tv_kern_exec;
+	pg_atomic_uint64	tv_dma_recv;
+	pg_atomic_uint64	tv_wait_task;
+	pg_atomic_uint64	tv_jit_build;
+	pg_atomic_uint64	num_kern_exec;
+	/* per-stage cycle counters */
+	pg_atomic_uint64	kern_profile[KERN_PROFILE__NUM_STAGES];
 	/* debug counter */
 	pg_atomic_uint64	debug_counter0;
 	pg_atomic_uint64	debug_counter1;
@@ -464,9 +591,36 @@ mergeGpuTaskRuntimeStatParallelWorker(GpuTaskState *gts,
 				 &gts->outer_instrument);
 	SpinLockRelease(&gt_rtstat->lock);
 	pg_atomic_add_fetch_u64(&gt_rtstat->nvme_count, gts->nvme_count);
+	pg_atomic_add_fetch_u64(&gt_rtstat->nvme_cached_count,
+							gts->nvme_cached_count);
 	pg_atomic_add_fetch_u64(&gt_rtstat->brin_count, gts->outer_brin_count);
 	pg_atomic_add_fetch_u64(&gt_rtstat->fallback_count,
 							gts->num_cpu_fallbacks);
+	for (int i=0; i < GPUTASK_FALLBACK__NUM_REASONS; i++)
+	{
+		if (gts->fallback_reasons[i] != 0)
+			pg_atomic_add_fetch_u64(&gt_rtstat->fallback_reasons[i],
+									gts->fallback_reasons[i]);
+	}
+	pg_atomic_add_fetch_u64(&gt_rtstat->gpumem_peak,
+							pg_atomic_read_u64(&gts->gcontext->gm_query_peak));
+	pg_atomic_add_fetch_u64(&gt_rtstat->adaptive_cpu_count,
+							gts->num_adaptive_cpu);
+	/* per-phase timing */
+	pg_atomic_add_fetch_u64(&gt_rtstat->tv_build_chunk, gts->tv_build_chunk);
+	pg_atomic_add_fetch_u64(&gt_rtstat->tv_dma_send, gts->tv_dma_send);
+	pg_atomic_add_fetch_u64(&gt_rtstat->tv_kern_exec, gts->tv_kern_exec);
+	pg_atomic_add_fetch_u64(&gt_rtstat->tv_dma_recv, gts->tv_dma_recv);
+	pg_atomic_add_fetch_u64(&gt_rtstat->tv_wait_task, gts->tv_wait_task);
+	pg_atomic_add_fetch_u64(&gt_rtstat->tv_jit_build, gts->tv_jit_build);
+	pg_atomic_add_fetch_u64(&gt_rtstat->num_kern_exec, gts->num_kern_exec);
+	/* per-stage cycle counters */
+	for (int i=0; i < KERN_PROFILE__NUM_STAGES; i++)
+	{
+		if (gts->kern_profile[i] != 0)
+			pg_atomic_add_fetch_u64(&gt_rtstat->kern_profile[i],
+									gts->kern_profile[i]);
+	}
 	/* debug counter */
 	if (gts->debug_counter0 != 0)
 		pg_atomic_add_fetch_u64(&gt_rtstat->debug_counter0, gts->debug_counter0);
@@ -489,8 +643,26 @@ mergeGpuTaskRuntimeStat(GpuTaskState *gts,
 	gts->outer_instrument.nfiltered1 = (double)
 		pg_atomic_read_u64(&gt_rtstat->nitems_filtered);
 	gts->nvme_count += pg_atomic_read_u64(&gt_rtstat->nvme_count);
+	gts->nvme_cached_count +=
+		pg_atomic_read_u64(&gt_rtstat->nvme_cached_count);
 	gts->outer_brin_count += pg_atomic_read_u64(&gt_rtstat->brin_count);
 	gts->num_cpu_fallbacks += pg_atomic_read_u64(&gt_rtstat->fallback_count);
+	for (int i=0; i < GPUTASK_FALLBACK__NUM_REASONS; i++)
+		gts->fallback_reasons[i] +=
+			pg_atomic_read_u64(&gt_rtstat->fallback_reasons[i]);
+	gts->gpumem_peak += pg_atomic_read_u64(&gt_rtstat->gpumem_peak);
+	gts->adaptive_cpu_count +=
+		pg_atomic_read_u64(&gt_rtstat->adaptive_cpu_count);
+
+	gts->tv_build_chunk += pg_atomic_read_u64(&gt_rtstat->tv_build_chunk);
+	gts->tv_dma_send += pg_atomic_read_u64(&gt_rtstat->tv_dma_send);
+	gts->tv_kern_exec += pg_atomic_read_u64(&gt_rtstat->tv_kern_exec);
+	gts->tv_dma_recv += pg_atomic_read_u64(&gt_rtstat->tv_dma_recv);
+	gts->tv_wait_task += pg_atomic_read_u64(&gt_rtstat->tv_wait_task);
+	gts->tv_jit_build += pg_atomic_read_u64(&gt_rtstat->tv_jit_build);
+	gts->num_kern_exec += pg_atomic_read_u64(&gt_rtstat->num_kern_exec);
+	for (int i=0; i < KERN_PROFILE__NUM_STAGES; i++)
+		gts->kern_profile[i] += pg_atomic_read_u64(&gt_rtstat->kern_profile[i]);
 
 	gts->debug_counter0 += pg_atomic_read_u64(&gt_rtstat->debug_counter0);
 	gts->debug_counter1 += pg_atomic_read_u64(&gt_rtstat->debug_counter1);
@@ -503,6 +675,39 @@ mergeGpuTaskRuntimeStat(GpuTaskState *gts,
 			   sizeof(BufferUsage));
 }
 
+/*
+ * updateGpuTaskRuntimeStatProfile
+ *
+ * It accumulates the per-stage cycle counters written back by the GPU kernel,
+ * then resets them because the kernel may be resumed on the same buffer.
+ */
+static inline void
+updateGpuTaskRuntimeStatProfile(GpuTaskRuntimeStat *gt_rtstat,
+								kern_profile *kprof)
+{
+	for (int i=0; i < KERN_PROFILE__NUM_STAGES; i++)
+	{
+		if (kprof->cycles[i] != 0)
+			pg_atomic_add_fetch_u64(&gt_rtstat->kern_profile[i],
+									kprof->cycles[i]);
+		kprof->cycles[i] = 0;
+	}
+}
+
+/*
+ * GpuTask timer events
+ *
+ * GPUTASK_TIMER__BEGIN and __END are recorded by the GPU worker around
+ * cb_process_task; __KERN_BEGIN and __KERN_END are recorded by the handler
+ * prior to the first kernel launch and after the last kernel launch
+ * (including suspend/resume retries).
+ */
+#define GPUTASK_TIMER__BEGIN			0
+#define GPUTASK_TIMER__KERN_BEGIN		1
+#define GPUTASK_TIMER__KERN_END			2
+#define GPUTASK_TIMER__END				3
+#define GPUTASK_TIMER__NUM_EVENTS		4
+
 /*
  * GpuTask
  *
@@ -516,7 +721,20 @@ struct GpuTask
 	GpuTaskKind		task_kind;		/* same with GTS's one */
 	ProgramId		program_id;		/* same with GTS's one */
 	GpuTaskState   *gts;			/* GTS reference in the backend */
+	cl_uint			task_id;		/* sequential number in the GTS */
 	bool			cpu_fallback;	/* true, if task needs CPU fallback */
+	bool			adaptive_cpu;	/* true, if processed by CPU on purpose */
+	cl_int			fallback_errcode; /* errcode that caused CPU fallback */
+	size_t			chunk_size;		/* adaptive chunk size on build */
+	cl_ulong		process_usec;	/* time consumed by cb_process_task */
+	/* per-phase timing by CUDA events, if EXPLAIN ANALYZE */
+	bool			with_timer;
+	cl_uint			timer_mask;		/* bitmap of the recorded events */
+	CUevent			ev_timer[GPUTASK_TIMER__NUM_EVENTS];
+	cl_ulong		tv_dma_send;	/* usec of DMA host-to-device */
+	cl_ulong		tv_kern_exec;	/* usec of GPU kernel execution */
+	cl_ulong		tv_dma_recv;	/* usec of DMA device-to-host */
+	cl_uint			num_kern_exec;	/* # of kernel launches */
 };
 
 /*
@@ -526,6 +744,7 @@ typedef struct NVMEScanState
 {
 	cl_uint			nrows_per_block;
 	cl_uint			nblocks_per_chunk;
+	cl_uint			stripe_pages;	/* stripe size in PAGE_SIZE, if any */
 	BlockNumber		curr_segno;
 	Buffer			curr_vmbuffer;
 	BlockNumber		nr_segs;
@@ -557,6 +776,9 @@ typedef struct pgstrom_data_store
 	 * If NULL, KDS is preliminary loaded by CPU and filesystem, and
 	 * PDS is also allocated on managed memory area. So, worker don't
 	 * need to kick DMA operations explicitly.
+	 * @gpu_decompress is true, if KDS contains compressed buffers listed on
+	 * the kern_arrow_decomp table, to be decompressed on the device side
+	 * by PDS_decompress_arrow() prior to the main kernel.
 	 *
 	 * NOTE: Extra information for KDS_FORMAT_COLUMN
 	 * @gc_sstate points the GpuCacheShareState for reference IPC handle
@@ -566,6 +788,13 @@ typedef struct pgstrom_data_store
 	cl_uint				nblocks_uncached;	/* for KDS_FORMAT_BLOCK */
 	GPUDirectFileDesc	filedesc;
 	strom_io_vector	   *iovec;				/* for KDS_FORMAT_ARROW */
+	cl_bool				gpu_decompress;		/* for KDS_FORMAT_ARROW */
+	/*
+	 * NOTE: @device_resident is true, if KDS is the result of the child
+	 * GPU node handed over on the device memory (see device_handoff of
+	 * GpuTaskState), thus, no DMA is needed to send it to the device.
+	 */
+	cl_bool				device_resident;
 	/* for KDS_FORMAT_COLUMN */
 	void			   *gc_sstate;
 	CUdeviceptr			m_kds_main;
@@ -624,6 +853,8 @@ extern cl_int			numDevAttrs;
 extern cl_uint			devBaselineMaxThreadsPerBlock;
 #define cpu_only_mode()		(numDevAttrs == 0)
 extern void pgstrom_init_gpu_device(void);
+extern double pgstrom_device_dma_cost(void);
+extern double pgstrom_device_operator_cost(void);
 
 #define GPUKERNEL_MAX_SM_MULTIPLICITY		4
 
@@ -709,6 +940,26 @@ extern CUresult gpuMemFreePreserved(cl_int cuda_dindex,
 									CUipcMemHandle m_handle);
 extern CUresult gpuIpcCloseMemHandle(GpuContext *gcontext,
 									 CUdeviceptr m_deviceptr);
+extern CUresult gpuIpcOpenMemHandleCached(GpuContext *gcontext,
+										  Oid database_oid,
+										  Oid table_oid,
+										  int slot,
+										  CUipcMemHandle m_handle,
+										  CUdeviceptr *p_deviceptr);
+extern void		gpuIpcCloseMemHandleCached(GpuContext *gcontext,
+										   CUdeviceptr m_deviceptr);
+extern void		gpuIpcInvalidateMemHandleCached(Oid database_oid,
+												Oid table_oid);
+extern bool		gpuTaskAdmit(GpuContext *gcontext);
+extern void		gpuTaskAdmitRelease(GpuContext *gcontext);
+extern double	gpuMemUsageRatio(GpuContext *gcontext);
+extern bool		gpuMemQueryLimitExceeded(GpuContext *gcontext);
+extern size_t	gpuMemQueryPeakUsage(GpuContext *gcontext);
+extern size_t	gpuMemAvailableForPlanning(const Bitmapset *optimal_gpus);
+extern void		gpuMemStatDma(size_t send_sz, size_t recv_sz);
+extern void		gpuMemStatTask(GpuContext *gcontext,
+							   cl_uint num_kern_exec, cl_ulong busy_usec);
+extern void		gpuMemStatReset(void);
 
 #define gpuMemAllocRaw(a,b,c)				\
 	__gpuMemAllocRaw((a),(b),(c),__FILE__,__LINE__)
@@ -755,6 +1006,8 @@ extern __thread int				GpuWorkerIndex;
 
 extern __thread CUevent			CU_EVENT_PER_THREAD;
 
+extern void gpuTaskTimerRecord(GpuTask *gtask, int event);
+
 extern void GpuContextWorkerReportError(int elevel,
 										int errcode,
 										const char *__filename, int lineno,
@@ -806,6 +1059,7 @@ extern bool trackCudaProgram(GpuContext *gcontext, ProgramId program_id,
 							 const char *filename, int lineno);
 extern void untrackCudaProgram(GpuContext *gcontext, ProgramId program_id);
 extern bool trackGpuMem(GpuContext *gcontext, CUdeviceptr devptr, void *extra,
+						size_t bytesize,
 						const char *filename, int lineno);
 extern void *lookupGpuMem(GpuContext *gcontext, CUdeviceptr devptr);
 extern void *untrackGpuMem(GpuContext *gcontext, CUdeviceptr devptr);
@@ -918,6 +1172,8 @@ extern void pgstromInitGpuTaskState(GpuTaskState *gts,
 									cl_uint outer_nrows_per_block,
 									cl_int eflags);
 extern TupleTableSlot *pgstromExecGpuTaskState(GpuTaskState *gts);
+extern pgstrom_data_store *pgstromBulkExecGpuTaskState(GpuTaskState *gts,
+													   bool *p_scan_done);
 extern void pgstromRescanGpuTaskState(GpuTaskState *gts);
 extern void pgstromReleaseGpuTaskState(GpuTaskState *gts,
 									   GpuTaskRuntimeStat *gt_rtstat);
@@ -935,8 +1191,27 @@ extern void pgstromReInitializeDSMGpuTaskState(GpuTaskState *gts);
 extern void pgstromShutdownDSMGpuTaskState(GpuTaskState *gts);
 
 extern void pgstromInitGpuTask(GpuTaskState *gts, GpuTask *gtask);
+extern void pgstromStatGpuQueryUpdate(GpuTaskState *gts);
 extern void pgstrom_init_gputasks(void);
 
+/*
+ * NVTX range annotations for Nsight Systems (built with PGSTROM_NVTX=1)
+ *
+ * We use start/end ranges, not push/pop, because a range interrupted by
+ * elog(ERROR) must not be a parent of the later ranges on the thread.
+ */
+#ifdef WITH_NVTX
+extern uint64 __pgstromNvtxBegin(const char *label,
+								 uint64 query_id, cl_uint task_id);
+extern void __pgstromNvtxEnd(uint64 range_id);
+#define pgstromNvtxBegin(label,gts,task_id)				\
+	__pgstromNvtxBegin((label), (gts) ? (gts)->query_id : 0, (task_id))
+#define pgstromNvtxEnd(range_id)		__pgstromNvtxEnd(range_id)
+#else
+#define pgstromNvtxBegin(label,gts,task_id)		(0UL)
+#define pgstromNvtxEnd(range_id)				((void)(range_id))
+#endif
+
 /*
  * cuda_program.c
  */
@@ -953,11 +1228,15 @@ extern ProgramId __pgstrom_create_cuda_program(GpuContext *gcontext,
 	__pgstrom_create_cuda_program((a),(b),(c),(d),(e),(f),(g),	\
 								  __FILE__,__LINE__)
 extern CUmodule pgstrom_load_cuda_program(ProgramId program_id);
+extern bool pgstrom_cuda_program_is_ready(ProgramId program_id);
+extern char *pgstrom_cuda_program_build_info(ProgramId program_id);
 extern void pgstrom_put_cuda_program(GpuContext *gcontext,
 									 ProgramId program_id);
 extern void pgstrom_build_session_info(StringInfo str,
 									   GpuTaskState *gts,
 									   cl_uint extra_flags);
+extern void pgstrom_codegen_tz_state(StringInfo buf, const char *varname,
+									 bool is_static, pg_tz *tz);
 
 extern char *pgstrom_cuda_source_string(ProgramId program_id);
 extern const char *pgstrom_cuda_source_file(ProgramId program_id);
@@ -977,6 +1256,8 @@ typedef struct codegen_context {
 	List	   *used_params;/* list of Const/Param in use */
 	List	   *used_vars;	/* list of Var in use */
 	List	   *pseudo_tlist;	/* pseudo tlist expression, if any */
+	List	   *cse_exprs;	/* common sub-expressions already evaluated */
+	List	   *cse_widths;	/* width of the cse_exprs */
 	uint32_t	extra_flags;	/* external libraries to be included */
 	uint32_t	extra_bufsz;	/* required size of temporary varlena buffer */
 	int			devcost;	/* relative device cost */
@@ -1004,6 +1285,9 @@ extern bool pgstrom_devtype_can_relabel(Oid src_type_oid,
 extern devindex_info *pgstrom_devindex_lookup(Oid opcode,
 											  Oid opfamily);
 extern char *pgstrom_codegen_expression(Node *expr, codegen_context *context);
+extern void pgstrom_codegen_common_subexprs(StringInfo body,
+											List *exprs_list,
+											codegen_context *context);
 extern void pgstrom_union_type_declarations(StringInfo buf,
 											const char *name,
 											List *type_oid_list);
@@ -1076,6 +1360,7 @@ extern pgstrom_data_store *__PDS_create_slot(GpuContext *gcontext,
 extern pgstrom_data_store *__PDS_create_block(GpuContext *gcontext,
 											  TupleDesc tupdesc,
 											  NVMEScanState *nvme_sstate,
+											  cl_uint nrooms,
 											  const char *fname, int lineno);
 #define PDS_create_row(a,b,c)					\
 	__PDS_create_row((a),(b),(c),__FILE__,__LINE__)
@@ -1083,8 +1368,8 @@ extern pgstrom_data_store *__PDS_create_block(GpuContext *gcontext,
 	__PDS_create_hash((a),(b),(c),__FILE__,__LINE__)
 #define PDS_create_slot(a,b,c)					\
 	__PDS_create_slot((a),(b),(c),__FILE__,__LINE__)
-#define PDS_create_block(a,b,c)					\
-	__PDS_create_block((a),(b),(c),__FILE__,__LINE__)
+#define PDS_create_block(a,b,c,d)				\
+	__PDS_create_block((a),(b),(c),(d),__FILE__,__LINE__)
 #define KDS_clone(a,b)							\
 	__KDS_clone((a),(b),__FILE__,__LINE__)
 #define PDS_clone(a)							\
@@ -1103,6 +1388,10 @@ extern void __PDS_fillup_arrow(pgstrom_data_store *pds_dst,
 extern pgstrom_data_store *PDS_fillup_arrow(pgstrom_data_store *pds_src);
 extern pgstrom_data_store *PDS_writeback_arrow(pgstrom_data_store *pds_src,
 											   CUdeviceptr m_kds_src);
+extern void PDS_decompress_arrow(CUmodule cuda_module,
+								 CUdeviceptr m_kds,
+								 pgstrom_data_store *pds,
+								 CUdeviceptr m_kerror);
 extern bool KDS_insert_tuple(kern_data_store *kds,
 							 TupleTableSlot *slot);
 #define PDS_insert_tuple(pds,slot)	KDS_insert_tuple(&(pds)->kds,slot)
@@ -1137,6 +1426,9 @@ extern int pgstrom_common_relscan_cost(PlannerInfo *root,
 									   cl_uint *p_nrows_per_block,
 									   Cost *p_startup_cost,
 									   Cost *p_run_cost);
+extern int	pgstrom_gpu_parallel_workers(PlannerInfo *root,
+										 RelOptInfo *rel,
+										 int parallel_workers);
 extern Bitmapset *pgstrom_pullup_outer_refs(PlannerInfo *root,
 											RelOptInfo *base_rel,
 											Bitmapset *referenced);
@@ -1146,12 +1438,18 @@ extern const Bitmapset *GetOptimalGpusForRelation(PlannerInfo *root,
 extern bool ScanPathWillUseNvmeStrom(PlannerInfo *root,
 									 RelOptInfo *baserel);
 extern bool RelationCanUseNvmeStrom(Relation relation);
+extern size_t GetStripeSizeOfDevice(dev_t st_dev);
 
 extern void pgstromExecInitBrinIndexMap(GpuTaskState *gts,
 										Oid index_oid,
 										List *index_conds,
 										List *index_quals);
+extern void pgstromExecInitZoneMapIndexMap(GpuTaskState *gts,
+										   List *outer_quals);
 extern Size pgstromSizeOfBrinIndexMap(GpuTaskState *gts);
+extern void *pgstromInitDSMBrinIndexMap(GpuTaskState *gts, void *coordinate);
+extern void *pgstromInitWorkerBrinIndexMap(GpuTaskState *gts,
+										   void *coordinate);
 extern void pgstromExecGetBrinIndexMap(GpuTaskState *gts);
 extern void pgstromExecEndBrinIndexMap(GpuTaskState *gts);
 extern void pgstromExecRewindBrinIndexMap(GpuTaskState *gts);
@@ -1161,6 +1459,9 @@ extern void pgstromExplainBrinIndexMap(GpuTaskState *gts,
 
 extern pgstrom_data_store *pgstromExecScanChunk(GpuTaskState *gts);
 extern void pgstromRewindScanChunk(GpuTaskState *gts);
+extern bool pgstromXidInMVCCSnapshot(TransactionId xid, Snapshot snapshot);
+extern bool pgstromHeapTupleSatisfiesMVCC(HeapTupleHeader tuple,
+										  Snapshot snapshot);
 
 extern void pgstromExplainOuterScan(GpuTaskState *gts,
 									List *deparse_context,
@@ -1172,18 +1473,59 @@ extern void pgstromExplainOuterScan(GpuTaskState *gts,
 									double outer_plan_rows,
 									int outer_plan_width);
 
+extern bool		pgstrom_gpu_mvcc_check;
+extern int		pgstrom_gpu_mvcc_clog_xids;
 extern void pgstrom_init_relscan(void);
 
+/*
+ * zonemap.c
+ */
+typedef struct pgstromZoneMapState pgstromZoneMapState;
+
+extern pgstromZoneMapState *pgstromExecBeginZoneMap(ScanState *ss,
+													List *outer_quals,
+													BlockNumber *p_range_sz);
+extern bool pgstromExecCheckZoneMap(pgstromZoneMapState *zm_state,
+									cl_uint index);
+extern List *pgstromZoneMapQuals(pgstromZoneMapState *zm_state);
+extern void pgstromExecEndZoneMap(pgstromZoneMapState *zm_state);
+extern void pgstrom_init_zonemap(void);
+
+/*
+ * feedback.c
+ */
+typedef struct
+{
+	cl_ulong	hash;		/* hash of the serialized plan shape */
+	cl_uint		keylen;		/* length of the serialized plan shape,
+							 * or 0 if invalid signature */
+} pgstromFeedbackSignature;
+
+extern pgstromFeedbackSignature
+pgstromCardinalityFeedbackSignature(PlannerInfo *root,
+									Relids relids,
+									List *exprs);
+extern List *pgstromFeedbackSignatureToList(pgstromFeedbackSignature signature);
+extern pgstromFeedbackSignature pgstromFeedbackSignatureFromList(List *l);
+extern bool pgstromLookupCardinalityFeedback(pgstromFeedbackSignature signature,
+											 double *p_nrows_in,
+											 double *p_nrows_out);
+extern void pgstromUpdateCardinalityFeedback(pgstromFeedbackSignature signature,
+											 double nrows_in,
+											 double nrows_out);
+extern void pgstrom_init_feedback(void);
+
 /*
  * gpuscan.c
  */
 extern bool enable_gpuscan;		/* GUC */
 extern Cost cost_for_dma_receive(RelOptInfo *rel, double ntuples);
-extern void codegen_gpuscan_quals(StringInfo kern,
+extern bool codegen_gpuscan_quals(StringInfo kern,
 								  codegen_context *context,
 								  const char *component,
 								  Index scanrelid,
-								  List *dev_quals_list);
+								  List *dev_quals_list,
+								  bool adaptive_order);
 extern bool pgstrom_pullup_outer_scan(PlannerInfo *root,
 									  const Path *outer_path,
 									  Index *p_outer_relid,
@@ -1237,8 +1579,12 @@ extern ProgramId GpuJoinCreateCombinedProgram(PlanState *node,
 											  const char *gpa_kern_source,
 											  bool explain_only);
 extern bool GpuJoinInnerPreload(GpuTaskState *gts, CUdeviceptr *p_m_kmrels);
+extern bool GpuJoinInnerIsPartitioned(const PlanState *ps);
 extern void GpuJoinInnerUnload(GpuTaskState *gts, bool is_rescan);
 extern pgstrom_data_store *GpuJoinExecOuterScanChunk(GpuTaskState *gts);
+extern bool GpuJoinSetupDeviceHandoff(GpuTaskState *gts, PlanState *outer_ps);
+extern pgstrom_data_store *GpuJoinExecBulkChunk(GpuTaskState *gts,
+												bool *p_scan_done);
 extern int  gpujoinNextRightOuterJoinIfAny(GpuTaskState *gts);
 extern TupleTableSlot *gpujoinNextTupleFallbackUpper(GpuTaskState *gts,
 													 struct kern_gpujoin *kgjoin,
@@ -1251,6 +1597,7 @@ extern void gpujoinUpdateRunTimeStat(GpuTaskState *gts,
  * gpupreagg.c
  */
 extern int	pgstrom_hll_register_bits;
+extern int	pgstrom_quantile_sketch_bits;
 extern bool pgstrom_path_is_gpupreagg(const Path *pathnode);
 extern bool pgstrom_plan_is_gpupreagg(const Plan *plan);
 extern bool pgstrom_planstate_is_gpupreagg(const PlanState *ps);
@@ -1260,9 +1607,16 @@ extern void assign_gpupreagg_session_info(StringInfo buf,
 										  GpuTaskState *gts);
 extern void pgstrom_init_gpupreagg(void);
 
+/*
+ * gpusort.c
+ */
+extern bool enable_gpusort;
+extern void pgstrom_init_gpusort(void);
+
 /*
  * arrow_fdw.c and arrow_read.c
  */
+extern int	arrow_io_parallelism;
 extern bool baseRelIsArrowFdw(RelOptInfo *baserel);
 extern bool RelationIsArrowFdw(Relation frel);
 extern Bitmapset *GetOptimalGpusForArrowFdw(PlannerInfo *root,
@@ -1277,6 +1631,9 @@ extern ArrowFdwState *ExecInitArrowFdw(ScanState *ss,
 									   Bitmapset *outer_refs);
 extern pgstrom_data_store *ExecScanChunkArrowFdw(GpuTaskState *gts);
 extern void ExecReScanArrowFdw(ArrowFdwState *af_state);
+extern void ExecRuntimeQualsArrowFdw(ArrowFdwState *af_state,
+									 ScanState *ss,
+									 List *runtime_quals);
 extern void ExecEndArrowFdw(ArrowFdwState *af_state);
 
 extern void ExecInitDSMArrowFdw(ArrowFdwState *af_state,
@@ -1300,6 +1657,9 @@ extern bool RelationHasGpuCache(Relation rel);
 extern GpuCacheState *ExecInitGpuCache(ScanState *ss, int eflags,
 									   Bitmapset *outer_refs);
 extern pgstrom_data_store *ExecScanChunkGpuCache(GpuTaskState *gts);
+extern bool gpuCacheGetScanVersion(GpuCacheState *gcache_state,
+								   Snapshot snapshot,
+								   GpuCacheScanVersion *version);
 extern void ExecReScanGpuCache(GpuCacheState *gcache_state);
 extern void ExecEndGpuCache(GpuCacheState *gcache_state);
 
@@ -1405,6 +1765,33 @@ extern void		gpuDirectFileReadIOV(const GPUDirectFileDesc *gds_fdesc,
 									 unsigned long iomap_handle,
 									 off_t m_offset,
 									 strom_io_vector *iovec);
+extern bool		gpuDirectFileWriteIsSupported(void);
+extern void		gpuDirectFileWriteIOV(const GPUDirectFileDesc *gds_fdesc,
+									  CUdeviceptr m_segment,
+									  unsigned long iomap_handle,
+									  off_t m_offset,
+									  strom_io_vector *iovec);
+typedef struct GpuDirectTempFile
+{
+	File		vfd;		/* temporary file by OpenTemporaryFile */
+	GPUDirectFileDesc dfile;
+	size_t		f_tail;		/* tail of the file; PAGE_SIZE aligned */
+} GpuDirectTempFile;
+
+extern GpuDirectTempFile *gpuDirectTempFileCreate(GpuContext *gcontext);
+extern off_t	gpuDirectTempFileWrite(GpuDirectTempFile *tfile,
+									   CUdeviceptr m_segment,
+									   unsigned long iomap_handle,
+									   off_t m_offset,
+									   size_t length);
+extern void		gpuDirectTempFileRead(GpuDirectTempFile *tfile,
+									  CUdeviceptr m_segment,
+									  unsigned long iomap_handle,
+									  off_t m_offset,
+									  off_t f_pos,
+									  size_t length);
+extern void		gpuDirectTempFileClose(GpuContext *gcontext,
+									   GpuDirectTempFile *tfile);
 extern void	extraSysfsSetupDistanceMap(const char *manual_config);
 extern Bitmapset *extraSysfsLookupOptimalGpus(int fdesc);
 extern ssize_t extraSysfsPrintNvmeInfo(int index, char *buffer, ssize_t buffer_sz);
@@ -1441,6 +1828,8 @@ extern bool	gpu_path_remember(PlannerInfo *root,
 
 extern void _PG_init(void);
 extern const char *pgstrom_strerror(cl_int errcode);
+extern void pgstrom_record_offload_blocker(const char *fmt, ...)
+			pg_attribute_printf(1, 2);
 
 extern void pgstrom_explain_expression(List *expr_list, const char *qlabel,
 									   PlanState *planstate,
@@ -1851,6 +2240,16 @@ pthreadRWLockWriteLock(pthread_rwlock_t *rwlock)
 		wfatal("failed on pthread_rwlock_wrlock: %m");
 }
 
+static inline bool
+pthreadRWLockReadTryLock(pthread_rwlock_t *rwlock)
+{
+	if ((errno = pthread_rwlock_tryrdlock(rwlock)) == 0)
+		return true;
+	if (errno != EBUSY)
+		wfatal("failed on pthread_rwlock_tryrdlock: %m");
+	return false;
+}
+
 static inline bool
 pthreadRWLockWriteTryLock(pthread_rwlock_t *rwlock)
 {
@@ -21,6 +21,12 @@ typedef struct
 
 /*--- static variables ---*/
 static bool		pgstrom_enable_brin;
+static bool		pgstrom_gpudirect_clean_buffers;
+static int		pgstrom_heap_readahead_chunks;
+static bool		pgstrom_detoast_on_load;
+static int		pgstrom_max_parallel_workers_per_gpu;
+bool			pgstrom_gpu_mvcc_check;			/* GUC */
+int				pgstrom_gpu_mvcc_clog_xids;		/* GUC */
 
 /*
  * simple_match_clause_to_indexcol
@@ -414,6 +420,61 @@ pgstrom_tryfind_brinindex(PlannerInfo *root,
 	return indexOpt;
 }
 
+/*
+ * __gpuParallelNumDevices
+ *
+ * Number of GPUs to be used by the parallel scan on the relation; GPUs close
+ * to the storage if SSD-to-GPU Direct SQL, or all the GPUs elsewhere.
+ */
+static int
+__gpuParallelNumDevices(PlannerInfo *root, RelOptInfo *rel)
+{
+	int		ndevices = 0;
+
+	if (rel->reloptkind == RELOPT_BASEREL ||
+		rel->reloptkind == RELOPT_OTHER_MEMBER_REL)
+		ndevices = bms_num_members(GetOptimalGpusForRelation(root, rel));
+	return (ndevices > 0 ? ndevices : Max(numDevAttrs, 1));
+}
+
+/*
+ * pgstrom_gpu_parallel_workers
+ *
+ * It adjusts the number of parallel workers estimated by the standard logic
+ * for the GPU-bound scans. Each worker process creates its own GPU context
+ * and contends for the same device, so more processes than the device can
+ * keep busy just add overheads. If CPU does not load the blocks (GPU cache
+ * or SSD-to-GPU Direct SQL), number of the processes is limited to the GPUs
+ * multiplied by pg_strom.max_parallel_workers_per_gpu. A few processes
+ * with deeper asynchronous tasks (pg_strom.max_async_tasks) are usually
+ * faster in this case.
+ */
+int
+pgstrom_gpu_parallel_workers(PlannerInfo *root,
+							 RelOptInfo *rel,
+							 int parallel_workers)
+{
+	int		nprocs;
+
+	if (parallel_workers <= 0 ||
+		pgstrom_max_parallel_workers_per_gpu <= 0 ||
+		(rel->reloptkind != RELOPT_BASEREL &&
+		 rel->reloptkind != RELOPT_OTHER_MEMBER_REL))
+		return parallel_workers;
+	/* CPU loads the blocks, then more workers are likely beneficial */
+	if (!baseRelHasGpuCache(root, rel) &&
+		!ScanPathWillUseNvmeStrom(root, rel))
+		return parallel_workers;
+
+	nprocs = (__gpuParallelNumDevices(root, rel) *
+			  pgstrom_max_parallel_workers_per_gpu);
+#if PG_VERSION_NUM >= 110000
+	if (parallel_leader_participation)
+#endif
+		nprocs--;
+	return Max(Min(parallel_workers, nprocs), 1);
+}
+
 /*
  * pgstrom_common_relscan_cost
  */
@@ -437,7 +498,8 @@ pgstrom_common_relscan_cost(PlannerInfo *root,
 	Cost		run_cost = 0.0;
 	Cost		index_scan_cost = 0.0;
 	Cost		disk_scan_cost = 0.0;
-	double		gpu_ratio = pgstrom_gpu_operator_cost / cpu_operator_cost;
+	double		gpu_ratio = pgstrom_device_operator_cost() / cpu_operator_cost;
+	double		gpu_penalty = 1.0;
 	double		parallel_divisor;
 	double		ntuples = scan_rel->tuples;
 	double		nblocks = scan_rel->pages;
@@ -539,6 +601,19 @@ pgstrom_common_relscan_cost(PlannerInfo *root,
 		 */
 		startup_cost += pgstrom_gpu_setup_cost / 2
 			+ (pgstrom_gpu_setup_cost / (2 * parallel_divisor));
+
+		/*
+		 * Processes on the same GPU share its capacity, so GPU portion of
+		 * the cost is not discounted by the processes more than the device
+		 * can run concurrently.
+		 */
+		if (pgstrom_max_parallel_workers_per_gpu > 0)
+		{
+			double	gpu_divisor = (__gpuParallelNumDevices(root, scan_rel) *
+								   pgstrom_max_parallel_workers_per_gpu);
+			if (parallel_divisor > gpu_divisor)
+				gpu_penalty = parallel_divisor / gpu_divisor;
+		}
 	}
 	else
 	{
@@ -594,11 +669,11 @@ pgstrom_common_relscan_cost(PlannerInfo *root,
 	/* Cost for GPU qualifiers */
 	cost_qual_eval_node(&qcost, (Node *)scan_quals, root);
 	startup_cost += qcost.startup;
-	run_cost += qcost.per_tuple * gpu_ratio * ntuples;
+	run_cost += qcost.per_tuple * gpu_ratio * ntuples * gpu_penalty;
 	ntuples *= selectivity;
 
 	/* Cost for DMA transfer (host/storage --> GPU) */
-	run_cost += pgstrom_gpu_dma_cost * nchunks;
+	run_cost += pgstrom_device_dma_cost() * nchunks * gpu_penalty;
 
 	*p_parallel_divisor = parallel_divisor;
 	*p_scan_ntuples = ntuples / parallel_divisor;
@@ -815,6 +890,90 @@ RelationCanUseNvmeStrom(Relation relation)
 	return !bms_is_empty(GetOptimalGpusForTablespace(tablespace_oid));
 }
 
+/*
+ * GetStripeSizeOfDevice
+ *
+ * It returns the stripe (chunk) size of the striped block device, like
+ * md-raid0 or dm-stripe, or 0 if not striped.
+ * A striped device reports its chunk size as minimum_io_size and the full
+ * stripe width as optimal_io_size. P2P DMA requests across the stripe
+ * boundary are split by the block layer, and it leads uneven queue depth
+ * of the underlying NVMe drives, so i/o vector builder breaks chunks on
+ * the boundary.
+ */
+typedef struct
+{
+	dev_t		st_dev;
+	size_t		stripe_sz;
+} device_stripe_size_hentry;
+
+static HTAB	   *device_stripe_size_htable = NULL;
+
+static size_t
+__readSysfsBlockQueueAttr(dev_t st_dev, const char *attname)
+{
+	const char *fmt[] = { "/sys/dev/block/%u:%u/queue/%s",
+						  "/sys/dev/block/%u:%u/../queue/%s" };	/* partition */
+	char		path[MAXPGPATH];
+	char		buf[80];
+	int			i;
+
+	for (i=0; i < lengthof(fmt); i++)
+	{
+		FILE   *filp;
+		bool	ok;
+
+		snprintf(path, sizeof(path), fmt[i],
+				 major(st_dev), minor(st_dev), attname);
+		filp = AllocateFile(path, "r");
+		if (!filp)
+			continue;
+		ok = (fgets(buf, sizeof(buf), filp) != NULL);
+		FreeFile(filp);
+		if (ok)
+			return strtoul(buf, NULL, 10);
+	}
+	return 0;
+}
+
+size_t
+GetStripeSizeOfDevice(dev_t st_dev)
+{
+	device_stripe_size_hentry *hentry;
+	bool		found;
+
+	if (!device_stripe_size_htable)
+	{
+		HASHCTL		hctl;
+
+		memset(&hctl, 0, sizeof(HASHCTL));
+		hctl.keysize = sizeof(dev_t);
+		hctl.entrysize = sizeof(device_stripe_size_hentry);
+		device_stripe_size_htable
+			= hash_create("DeviceStripeSize", 32,
+						  &hctl, HASH_ELEM | HASH_BLOBS);
+	}
+	hentry = (device_stripe_size_hentry *)
+		hash_search(device_stripe_size_htable,
+					&st_dev,
+					HASH_ENTER,
+					&found);
+	if (!found)
+	{
+		size_t		io_min = __readSysfsBlockQueueAttr(st_dev, "minimum_io_size");
+		size_t		io_opt = __readSysfsBlockQueueAttr(st_dev, "optimal_io_size");
+
+		Assert(hentry->st_dev == st_dev);
+		if (io_min >= BLCKSZ && io_opt > io_min && io_opt % io_min == 0)
+			hentry->stripe_sz = io_min;
+		else
+			hentry->stripe_sz = 0;
+		elog(DEBUG2, "block device (%u:%u) stripe size = %zu",
+			 major(st_dev), minor(st_dev), hentry->stripe_sz);
+	}
+	return hentry->stripe_sz;
+}
+
 /*
  * ScanPathWillUseNvmeStrom - Optimizer Hint
  */
@@ -901,8 +1060,29 @@ typedef struct pgstromIndexState
 	int			num_runtime_keys;
 	bool		runtime_key_ready;
 	ExprContext *runtime_econtext;
+	pgstromZoneMapState *zm_state;	/* valid, if zone-map instead of BRIN */
 } pgstromIndexState;
 
+/*
+ * pgstromIndexMapShared - coordination state of the BRIN-index map
+ *
+ * It is located just in front of the Bitmapset (outer_index_map). On parallel
+ * execution, the leader and workers pick up a stripe of the bitmap words
+ * by turns, then evaluate the ranges in the stripe concurrently. Because
+ * each stripe consists of whole bitmapwords, no one writes the same word.
+ */
+typedef struct
+{
+	cl_uint		nranges;		/* number of ranges; determined by the leader */
+	pg_atomic_uint32 next_word;	/* next bitmapword to be processed */
+	pg_atomic_uint32 done_words;/* number of bitmapwords already processed */
+} pgstromIndexMapShared;
+
+#define BRIN_MAP_WORDS_PER_STRIPE	8
+#define BRIN_MAP_SHARED_SIZE		MAXALIGN(sizeof(pgstromIndexMapShared))
+#define BRIN_MAP_GET_SHARED(map)	\
+	((pgstromIndexMapShared *)((char *)(map) - BRIN_MAP_SHARED_SIZE))
+
 /*
  * pgstromExecInitBrinIndexMap
  */
@@ -961,6 +1141,38 @@ pgstromExecInitBrinIndexMap(GpuTaskState *gts,
 	gts->outer_index_state = pi_state;
 }
 
+/*
+ * pgstromExecInitZoneMapIndexMap
+ *
+ * It tries to use the zone-map (pgstrom.zonemap) of the relation, if no
+ * BRIN-index is chosen by the planner. The map of skipped ranges shall be
+ * built in the same way as BRIN-index.
+ */
+void
+pgstromExecInitZoneMapIndexMap(GpuTaskState *gts, List *outer_quals)
+{
+	pgstromIndexState *pi_state;
+	pgstromZoneMapState *zm_state;
+	Relation	relation = gts->css.ss.ss_currentRelation;
+	BlockNumber	range_sz;
+
+	if (gts->outer_index_state || !relation || outer_quals == NIL)
+		return;
+	zm_state = pgstromExecBeginZoneMap(&gts->css.ss, outer_quals, &range_sz);
+	if (!zm_state)
+		return;
+
+	pi_state = palloc0(sizeof(pgstromIndexState));
+	pi_state->index_oid = InvalidOid;
+	pi_state->index_quals = (Node *)
+		make_ands_explicit(pgstromZoneMapQuals(zm_state));
+	pi_state->nblocks = RelationGetNumberOfBlocks(relation);
+	pi_state->range_sz = range_sz;
+	pi_state->zm_state = zm_state;
+
+	gts->outer_index_state = pi_state;
+}
+
 /*
  * pgstromSizeOfBrinIndexMap
  */
@@ -975,20 +1187,75 @@ pgstromSizeOfBrinIndexMap(GpuTaskState *gts)
 
 	nwords = (pi_state->nblocks +
 			  pi_state->range_sz - 1) / pi_state->range_sz;
-	return STROMALIGN(offsetof(Bitmapset, words) +
+	return STROMALIGN(BRIN_MAP_SHARED_SIZE +
+					  offsetof(Bitmapset, words) +
 					  sizeof(bitmapword) * nwords);
 
 }
 
+/*
+ * pgstromInitDSMBrinIndexMap / pgstromInitWorkerBrinIndexMap
+ *
+ * It assigns the BRIN-index map on the DSM segment, and returns the next
+ * coordinate.
+ */
+static void
+__pgstromInitBrinIndexMap(GpuTaskState *gts, char *buffer)
+{
+	pgstromIndexState *pi_state = gts->outer_index_state;
+	pgstromIndexMapShared *bm_shared = (pgstromIndexMapShared *)buffer;
+
+	bm_shared->nranges = (pi_state->nblocks +
+						  pi_state->range_sz - 1) / pi_state->range_sz;
+	pg_atomic_init_u32(&bm_shared->next_word, 0);
+	pg_atomic_init_u32(&bm_shared->done_words, 0);
+	gts->outer_index_map = (Bitmapset *)(buffer + BRIN_MAP_SHARED_SIZE);
+	gts->outer_index_map->nwords = -1;		/* uninitialized */
+}
+
+void *
+pgstromInitDSMBrinIndexMap(GpuTaskState *gts, void *coordinate)
+{
+	if (!gts->outer_index_state)
+		return coordinate;
+	__pgstromInitBrinIndexMap(gts, coordinate);
+	return (char *)coordinate + pgstromSizeOfBrinIndexMap(gts);
+}
+
+void *
+pgstromInitWorkerBrinIndexMap(GpuTaskState *gts, void *coordinate)
+{
+	pgstromIndexMapShared *bm_shared = coordinate;
+	pgstromIndexState *pi_state = gts->outer_index_state;
+
+	if (!pi_state)
+		return coordinate;
+	/*
+	 * the relation may be extended after the leader's initialization, so
+	 * worker follows the number of ranges determined by the leader.
+	 */
+	pi_state->nblocks = Min((BlockNumber)bm_shared->nranges *
+							pi_state->range_sz, pi_state->nblocks);
+	gts->outer_index_map = (Bitmapset *)
+		((char *)coordinate + BRIN_MAP_SHARED_SIZE);
+	return (char *)coordinate + STROMALIGN(BRIN_MAP_SHARED_SIZE +
+										   offsetof(Bitmapset, words) +
+										   sizeof(bitmapword) *
+										   bm_shared->nranges);
+}
+
 /*
  * pgstromExecGetBrinIndexMap
  *
  * Also see bringetbitmap
+ *
+ * It evaluates the ranges in [start_word, end_word) of the bitmap words.
  */
 static void
 __pgstromExecGetBrinIndexMap(pgstromIndexState *pi_state,
 							 Bitmapset *brin_map,
-							 Snapshot snapshot)
+							 Snapshot snapshot,
+							 int start_word, int end_word)
 {
 	BrinDesc	   *bdesc = pi_state->brin_desc;
 	TupleDesc		bd_tupdesc = bdesc->bd_tupdesc;
@@ -996,13 +1263,12 @@ __pgstromExecGetBrinIndexMap(pgstromIndexState *pi_state,
 	BlockNumber		range_sz = pi_state->range_sz;
 	BlockNumber		heapBlk;
 	BlockNumber		index;
+	BlockNumber		end_index;
 	Buffer			buf = InvalidBuffer;
 	FmgrInfo	   *consistentFn;
 	BrinMemTuple   *dtup;
 	BrinTuple	   *btup	__attribute__((unused)) = NULL;
 	Size			btupsz	__attribute__((unused)) = 0;
-	int				nranges;
-	int				nwords;
 	MemoryContext	oldcxt;
 	MemoryContext	perRangeCxt;
 
@@ -1017,18 +1283,17 @@ __pgstromExecGetBrinIndexMap(pgstromIndexState *pi_state,
 										ALLOCSET_DEFAULT_SIZES);
 	oldcxt = MemoryContextSwitchTo(perRangeCxt);
 
-	nranges = (pi_state->nblocks +
-			   pi_state->range_sz - 1) / pi_state->range_sz;
-	nwords = (nranges + BITS_PER_BITMAPWORD - 1) / BITS_PER_BITMAPWORD;
 	Assert(brin_map->nwords < 0);
-	memset(brin_map->words, 0, sizeof(bitmapword) * nwords);
+	memset(brin_map->words + start_word, 0,
+		   sizeof(bitmapword) * (end_word - start_word));
 	/*
-	 * Now scan the revmap.  We start by querying for heap page 0,
-	 * incrementing by the number of pages per range; this gives us a full
-	 * view of the table.
+	 * Now scan the revmap.  We start by querying for the first heap page
+	 * of the stripe, incrementing by the number of pages per range.
 	 */
-	for (heapBlk = 0, index = 0;
-		 heapBlk < nblocks;
+	index = start_word * BITS_PER_BITMAPWORD;
+	end_index = end_word * BITS_PER_BITMAPWORD;
+	for (heapBlk = index * range_sz;
+		 heapBlk < nblocks && index < end_index;
 		 heapBlk += range_sz, index++)
 	{
 		BrinTuple  *tup;
@@ -1086,9 +1351,8 @@ __pgstromExecGetBrinIndexMap(pgstromIndexState *pi_state,
 										   PointerGetDatum(key));
 					if (!DatumGetBool(rv))
 					{
-						if (index / BITS_PER_BITMAPWORD < nwords)
-							brin_map->words[index / BITS_PER_BITMAPWORD]
-								|= (1U << (index % BITS_PER_BITMAPWORD));
+						brin_map->words[index / BITS_PER_BITMAPWORD]
+							|= ((bitmapword)1 << (index % BITS_PER_BITMAPWORD));
 						break;
 					}
 				}
@@ -1100,89 +1364,157 @@ __pgstromExecGetBrinIndexMap(pgstromIndexState *pi_state,
 
 	if (buf != InvalidBuffer)
 		ReleaseBuffer(buf);
+}
+
+static void
+__pgstromExecGetZoneMapIndexMap(pgstromIndexState *pi_state,
+								Bitmapset *brin_map)
+{
+	cl_uint		index;
+	int			nranges;
+	int			nwords;
+
+	nranges = (pi_state->nblocks +
+			   pi_state->range_sz - 1) / pi_state->range_sz;
+	nwords = (nranges + BITS_PER_BITMAPWORD - 1) / BITS_PER_BITMAPWORD;
+	Assert(brin_map->nwords < 0);
+	memset(brin_map->words, 0, sizeof(bitmapword) * nwords);
+	for (index = 0; index < nranges; index++)
+	{
+		CHECK_FOR_INTERRUPTS();
+
+		if (!pgstromExecCheckZoneMap(pi_state->zm_state, index))
+			brin_map->words[index / BITS_PER_BITMAPWORD]
+				|= ((bitmapword)1 << (index % BITS_PER_BITMAPWORD));
+	}
 	/* mark this bitmapset is ready */
 	pg_memory_barrier();
 	brin_map->nwords = nwords;
 }
 
+/*
+ * __pgstromExecWaitBrinIndexMap
+ *
+ * It waits for completion of the BRIN-index map by other processes.
+ * Only the leader wakes up the workers, so we also check the map
+ * periodically, if the last stripe was processed by another worker.
+ */
+static void
+__pgstromExecWaitBrinIndexMap(Bitmapset *brin_map)
+{
+	ResetLatch(MyLatch);
+	while (brin_map->nwords < 0)
+	{
+		int		ev;
+
+		CHECK_FOR_INTERRUPTS();
+
+		ev = WaitLatch(MyLatch,
+					   WL_LATCH_SET |
+					   WL_TIMEOUT |
+					   WL_POSTMASTER_DEATH,
+					   10L,
+					   PG_WAIT_EXTENSION);
+		if (ev & WL_POSTMASTER_DEATH)
+			elog(FATAL, "unexpected postmaster dead");
+		ResetLatch(MyLatch);
+	}
+}
+
+/*
+ * __pgstromExecWakeupBrinIndexMap
+ */
+static void
+__pgstromExecWakeupBrinIndexMap(GpuTaskState *gts)
+{
+	ParallelContext *pcxt = gts->pcxt;
+	pid_t		pid;
+	int			i;
+
+	if (!pcxt)
+		return;
+	for (i=0; i < pcxt->nworkers_launched; i++)
+	{
+		if (GetBackgroundWorkerPid(pcxt->worker[i].bgwhandle,
+								   &pid) == BGWH_STARTED)
+			ProcSendSignal(pid);
+	}
+}
+
 void
 pgstromExecGetBrinIndexMap(GpuTaskState *gts)
 {
 	pgstromIndexState *pi_state = gts->outer_index_state;
+	EState	   *estate = gts->css.ss.ps.state;
+	Bitmapset  *brin_map;
+	pgstromIndexMapShared *bm_shared;
+	cl_uint		nwords;
+
+	if (gts->outer_index_map && gts->outer_index_map->nwords >= 0)
+		return;		/* already built */
 
-	if (!gts->outer_index_map || gts->outer_index_map->nwords < 0)
+	if (!gts->outer_index_map)
 	{
-		EState	   *estate = gts->css.ss.ps.state;
+		char   *buffer;
+
+		Assert(!IsParallelWorker());
+		buffer = MemoryContextAlloc(estate->es_query_cxt,
+									pgstromSizeOfBrinIndexMap(gts));
+		__pgstromInitBrinIndexMap(gts, buffer);
+	}
+	brin_map = gts->outer_index_map;
+	bm_shared = BRIN_MAP_GET_SHARED(brin_map);
+	nwords = (bm_shared->nranges +
+			  BITS_PER_BITMAPWORD - 1) / BITS_PER_BITMAPWORD;
+	if (nwords == 0)
+	{
+		brin_map->nwords = 0;	/* empty relation */
+		return;
+	}
 
-		if (!gts->outer_index_map)
+	if (pi_state->zm_state)
+	{
+		/* zone-map is built by the leader solely */
+		if (IsParallelWorker())
+			__pgstromExecWaitBrinIndexMap(brin_map);
+		else
 		{
-			Assert(!IsParallelWorker());
-			gts->outer_index_map
-				= MemoryContextAlloc(estate->es_query_cxt,
-									 pgstromSizeOfBrinIndexMap(gts));
-			gts->outer_index_map->nwords = -1;
+			__pgstromExecGetZoneMapIndexMap(pi_state, brin_map);
+			__pgstromExecWakeupBrinIndexMap(gts);
 		}
+		return;
+	}
 
-		ResetLatch(MyLatch);
-		while (gts->outer_index_map->nwords < 0)
+	/*
+	 * BRIN-index map is built by the leader and workers concurrently;
+	 * everybody picks up a stripe of the bitmap words by turns, until
+	 * no stripes are left.
+	 */
+	for (;;)
+	{
+		cl_uint		start_word;
+		cl_uint		end_word;
+
+		start_word = pg_atomic_fetch_add_u32(&bm_shared->next_word,
+											 BRIN_MAP_WORDS_PER_STRIPE);
+		if (start_word >= nwords)
+			break;
+		end_word = Min(start_word + BRIN_MAP_WORDS_PER_STRIPE, nwords);
+		__pgstromExecGetBrinIndexMap(pi_state, brin_map,
+									 estate->es_snapshot,
+									 start_word, end_word);
+		pg_memory_barrier();
+		if (pg_atomic_add_fetch_u32(&bm_shared->done_words,
+									end_word - start_word) == nwords)
 		{
+			/* mark this bitmapset is ready */
+			brin_map->nwords = nwords;
 			if (!IsParallelWorker())
-			{
-				__pgstromExecGetBrinIndexMap(pi_state,
-											 gts->outer_index_map,
-											 estate->es_snapshot);
-				/* wake up parallel workers if any */
-				if (gts->pcxt)
-				{
-					ParallelContext *pcxt = gts->pcxt;
-					pid_t		pid;
-					int			i;
-
-					for (i=0; i < pcxt->nworkers_launched; i++)
-					{
-						if (GetBackgroundWorkerPid(pcxt->worker[i].bgwhandle,
-												   &pid) == BGWH_STARTED)
-							ProcSendSignal(pid);
-					}
-				}
-#if 0
-				{
-					Bitmapset *map = gts->outer_index_map;
-					int		i;
-
-					elog(INFO, "BRIN-index (%s) range_sz = %d",
-						 RelationGetRelationName(pi_state->index_rel),
-						 pi_state->range_sz);
-					for (i=0; i < map->nwords; i += 4)
-					{
-						elog(INFO, "% 6d: %08x %08x %08x %08x",
-							 i * BITS_PER_BITMAPWORD,
-							 i+3 < map->nwords ? map->words[i+3] : 0,
-							 i+2 < map->nwords ? map->words[i+2] : 0,
-							 i+1 < map->nwords ? map->words[i+1] : 0,
-							 i   < map->nwords ? map->words[i]   : 0);
-					}
-				}
-#endif
-			}
-			else
-			{
-				int		ev;
-
-				/* wait for completion of BRIN-index preload */
-				CHECK_FOR_INTERRUPTS();
-
-				ev = WaitLatch(MyLatch,
-							   WL_LATCH_SET |
-							   WL_POSTMASTER_DEATH,
-							   -1,
-							   PG_WAIT_EXTENSION);
-				if (ev & WL_POSTMASTER_DEATH)
-					elog(FATAL, "unexpected postmaster dead");
-				ResetLatch(MyLatch);
-			}
+				__pgstromExecWakeupBrinIndexMap(gts);
+			return;
 		}
 	}
+	__pgstromExecWaitBrinIndexMap(brin_map);
 }
 
 void
@@ -1192,6 +1524,11 @@ pgstromExecEndBrinIndexMap(GpuTaskState *gts)
 
 	if (!pi_state)
 		return;
+	if (pi_state->zm_state)
+	{
+		pgstromExecEndZoneMap(pi_state->zm_state);
+		return;
+	}
 	brinRevmapTerminate(pi_state->brin_revmap);
 	index_close(pi_state->index_rel, NoLock);
 }
@@ -1209,15 +1546,20 @@ pgstromExplainBrinIndexMap(GpuTaskState *gts,
 						   List *dcontext)
 {
 	pgstromIndexState *pi_state = gts->outer_index_state;
+	const char *label = "BRIN";
 	char	   *conds_str;
 	char		temp[128];
+	char		name[40];
 
 	if (!pi_state)
 		return;
+	if (pi_state->zm_state)
+		label = "Zone-map";
 
 	conds_str = deparse_expression(pi_state->index_quals,
 								   dcontext, es->verbose, false);
-	ExplainPropertyText("BRIN cond", conds_str, es);
+	snprintf(name, sizeof(name), "%s cond", label);
+	ExplainPropertyText(name, conds_str, es);
 	if (es->analyze)
 	{
 		if (es->format == EXPLAIN_FORMAT_TEXT)
@@ -1227,14 +1569,17 @@ pgstromExplainBrinIndexMap(GpuTaskState *gts,
 					 (long)pi_state->nblocks,
 					 100.0 * ((double) gts->outer_brin_count /
 							  (double) pi_state->nblocks));
-			ExplainPropertyText("BRIN skipped", temp, es);
+			snprintf(name, sizeof(name), "%s skipped", label);
+			ExplainPropertyText(name, temp, es);
 		}
 		else
 		{
-			ExplainPropertyInteger("BRIN fetched", NULL,
+			snprintf(name, sizeof(name), "%s fetched", label);
+			ExplainPropertyInteger(name, NULL,
 								   pi_state->nblocks -
 								   gts->outer_brin_count, es);
-			ExplainPropertyInteger("BRIN skipped", NULL,
+			snprintf(name, sizeof(name), "%s skipped", label);
+			ExplainPropertyInteger(name, NULL,
 								   gts->outer_brin_count, es);
 		}
 	}
@@ -1259,7 +1604,8 @@ typedef struct {
 static inline void
 updatePDSHeapScanBlockState(pgstrom_data_store *pds,
 							PDSHeapScanBlockState *bstate,
-							BlockNumber blknum)
+							BlockNumber blknum,
+							cl_uint stripe_pages)
 {
 	strom_io_vector *iovec = bstate->iovec;
 	strom_io_chunk	*iochunk;
@@ -1269,7 +1615,8 @@ updatePDSHeapScanBlockState(pgstrom_data_store *pds,
 	if (iovec->nr_chunks > 0)
 	{
 		iochunk = &iovec->ioc[iovec->nr_chunks - 1];
-		if (iochunk->fchunk_id + iochunk->nr_pages == fchunk_id)
+		if (iochunk->fchunk_id + iochunk->nr_pages == fchunk_id &&
+			(stripe_pages == 0 || fchunk_id % stripe_pages != 0))
 		{
 			/* continuous region - expand the last chunk */
 			iochunk->nr_pages += pages_per_block;
@@ -1305,6 +1652,178 @@ mergePDSHeapScanBlockState(pgstrom_data_store *pds,
 									   ioc[iovec->nr_chunks]));
 }
 
+/*
+ * pgstromXidInMVCCSnapshot - same as XidInMVCCSnapshot()
+ */
+bool
+pgstromXidInMVCCSnapshot(TransactionId xid, Snapshot snapshot)
+{
+	uint32		i;
+
+	if (TransactionIdPrecedes(xid, snapshot->xmin))
+		return false;
+	if (TransactionIdFollowsOrEquals(xid, snapshot->xmax))
+		return true;
+	if (!snapshot->takenDuringRecovery)
+	{
+		if (!snapshot->suboverflowed)
+		{
+			for (i=0; i < snapshot->subxcnt; i++)
+			{
+				if (TransactionIdEquals(xid, snapshot->subxip[i]))
+					return true;
+			}
+		}
+		else
+		{
+			xid = SubTransGetTopmostTransaction(xid);
+			if (TransactionIdPrecedes(xid, snapshot->xmin))
+				return false;
+		}
+		for (i=0; i < snapshot->xcnt; i++)
+		{
+			if (TransactionIdEquals(xid, snapshot->xip[i]))
+				return true;
+		}
+	}
+	else
+	{
+		if (snapshot->suboverflowed)
+		{
+			xid = SubTransGetTopmostTransaction(xid);
+			if (TransactionIdPrecedes(xid, snapshot->xmin))
+				return false;
+		}
+		for (i=0; i < snapshot->subxcnt; i++)
+		{
+			if (TransactionIdEquals(xid, snapshot->subxip[i]))
+				return true;
+		}
+	}
+	return false;
+}
+
+/*
+ * pgstromHeapTupleSatisfiesMVCC
+ *
+ * Same as HeapTupleSatisfiesMVCC(), but never sets hint bits, because
+ * the heap blocks loaded by GPUDirect SQL are not associated with any
+ * shared buffers. It is used by the CPU fallback code, to check visibility
+ * of the tuples on the blocks without all-visible flag.
+ */
+bool
+pgstromHeapTupleSatisfiesMVCC(HeapTupleHeader tuple, Snapshot snapshot)
+{
+	TransactionId	xmax;
+
+	if (!HeapTupleHeaderXminCommitted(tuple))
+	{
+		if (HeapTupleHeaderXminInvalid(tuple))
+			return false;
+		/* Used by pre-9.0 binary upgrades */
+		if (tuple->t_infomask & HEAP_MOVED_OFF)
+		{
+			TransactionId	xvac = HeapTupleHeaderGetXvac(tuple);
+
+			if (TransactionIdIsCurrentTransactionId(xvac))
+				return false;
+			if (!pgstromXidInMVCCSnapshot(xvac, snapshot) &&
+				TransactionIdDidCommit(xvac))
+				return false;
+		}
+		else if (tuple->t_infomask & HEAP_MOVED_IN)
+		{
+			TransactionId	xvac = HeapTupleHeaderGetXvac(tuple);
+
+			if (!TransactionIdIsCurrentTransactionId(xvac))
+			{
+				if (pgstromXidInMVCCSnapshot(xvac, snapshot) ||
+					!TransactionIdDidCommit(xvac))
+					return false;
+			}
+		}
+		else if (TransactionIdIsCurrentTransactionId(HeapTupleHeaderGetRawXmin(tuple)))
+		{
+			if (HeapTupleHeaderGetCmin(tuple) >= snapshot->curcid)
+				return false;	/* inserted after scan started */
+			if (tuple->t_infomask & HEAP_XMAX_INVALID)
+				return true;
+			if (HEAP_XMAX_IS_LOCKED_ONLY(tuple->t_infomask))
+				return true;
+			if (tuple->t_infomask & HEAP_XMAX_IS_MULTI)
+			{
+				xmax = HeapTupleGetUpdateXid(tuple);
+				if (!TransactionIdIsCurrentTransactionId(xmax))
+					return true;
+				return (HeapTupleHeaderGetCmax(tuple) >= snapshot->curcid);
+			}
+			if (!TransactionIdIsCurrentTransactionId(HeapTupleHeaderGetRawXmax(tuple)))
+				return true;	/* deleting subtransaction must have aborted */
+			return (HeapTupleHeaderGetCmax(tuple) >= snapshot->curcid);
+		}
+		else if (pgstromXidInMVCCSnapshot(HeapTupleHeaderGetRawXmin(tuple),
+										  snapshot))
+			return false;
+		else if (!TransactionIdDidCommit(HeapTupleHeaderGetRawXmin(tuple)))
+			return false;
+	}
+	else if (!HeapTupleHeaderXminFrozen(tuple) &&
+			 pgstromXidInMVCCSnapshot(HeapTupleHeaderGetRawXmin(tuple),
+									  snapshot))
+	{
+		/* xmin is committed, but maybe not according to our snapshot */
+		return false;
+	}
+
+	/* by here, the inserting transaction has committed */
+	if (tuple->t_infomask & HEAP_XMAX_INVALID)
+		return true;
+	if (HEAP_XMAX_IS_LOCKED_ONLY(tuple->t_infomask))
+		return true;
+	if (tuple->t_infomask & HEAP_XMAX_IS_MULTI)
+	{
+		xmax = HeapTupleGetUpdateXid(tuple);
+		if (TransactionIdIsCurrentTransactionId(xmax))
+			return (HeapTupleHeaderGetCmax(tuple) >= snapshot->curcid);
+		if (pgstromXidInMVCCSnapshot(xmax, snapshot))
+			return true;
+		return !TransactionIdDidCommit(xmax);
+	}
+
+	xmax = HeapTupleHeaderGetRawXmax(tuple);
+	if (!(tuple->t_infomask & HEAP_XMAX_COMMITTED))
+	{
+		if (TransactionIdIsCurrentTransactionId(xmax))
+			return (HeapTupleHeaderGetCmax(tuple) >= snapshot->curcid);
+		if (pgstromXidInMVCCSnapshot(xmax, snapshot))
+			return true;
+		return !TransactionIdDidCommit(xmax);
+	}
+	/* xmax transaction committed */
+	return pgstromXidInMVCCSnapshot(xmax, snapshot);
+}
+
+/*
+ * heapScanDeviceMvccCheck
+ *
+ * It checks whether the device code can check visibility of the tuples on
+ * the blocks without all-visible flag, so these blocks can be loaded by
+ * GPUDirect SQL also.
+ * Snapshot with overflowed subxip[] is not supported, because the device
+ * code cannot map sub-transactions to their top-level transaction, thus
+ * may consider hinted xmin/xmax of in-progress sub-transaction committed.
+ */
+static inline bool
+heapScanDeviceMvccCheck(GpuTaskState *gts, Snapshot snapshot)
+{
+	return (pgstrom_gpu_mvcc_check &&
+			pgstrom_cpu_fallback_enabled &&
+			IsMVCCSnapshot(snapshot) &&
+			!snapshot->takenDuringRecovery &&
+			!snapshot->suboverflowed &&
+			!IsolationIsSerializable());
+}
+
 static bool
 PDS_exec_heapscan_block(GpuTaskState *gts,
 						pgstrom_data_store *pds,
@@ -1333,12 +1852,14 @@ PDS_exec_heapscan_block(GpuTaskState *gts,
 
 	/*
 	 * NVMe-Strom can be applied only when filesystem supports the feature,
-	 * and the current source block is all-visible.
+	 * and the current source block is all-visible, or device code can check
+	 * MVCC visibility of the tuples (see kern_check_visibility_heap).
 	 * Elsewhere, we will go fallback with synchronized buffer scan.
 	 */
 	if (RelationCanUseNvmeStrom(relation) &&
-		VM_ALL_VISIBLE(relation, blknum,
-					   &nvme_sstate->curr_vmbuffer))
+		(VM_ALL_VISIBLE(relation, blknum,
+						&nvme_sstate->curr_vmbuffer) ||
+		 heapScanDeviceMvccCheck(gts, snapshot)))
 	{
 		BufferTag	newTag;
 		uint32		newHash;
@@ -1355,6 +1876,21 @@ PDS_exec_heapscan_block(GpuTaskState *gts,
 		/* check whether the block exists on the shared buffer? */
 		LWLockAcquire(newPartitionLock, LW_SHARED);
 		buf_id = BufTableLookup(&newTag, newHash);
+		if (buf_id >= 0 && pgstrom_gpudirect_clean_buffers)
+		{
+			/*
+			 * A clean buffer has identical contents to the block on the
+			 * storage, so we can load it by SSD2GPU Direct DMA as well,
+			 * instead of the memcpy and visibility checks by CPU.
+			 * It reduces the CPU load of chunk building when buffer hit
+			 * ratio is moderate, with cost of extra i/o bandwidth.
+			 */
+			BufferDesc *bufHdr = GetBufferDescriptor(buf_id);
+			uint32		buf_state = pg_atomic_read_u32(&bufHdr->state);
+
+			if ((buf_state & (BM_VALID | BM_DIRTY)) == BM_VALID)
+				buf_id = -1;
+		}
 		if (buf_id < 0)
 		{
 			BlockNumber	segno = blknum / RELSEG_SIZE;
@@ -1374,7 +1910,8 @@ PDS_exec_heapscan_block(GpuTaskState *gts,
 			{
 				if (pds->filedesc.rawfd < 0)
 					memcpy(&pds->filedesc, dfile, sizeof(GPUDirectFileDesc));
-				updatePDSHeapScanBlockState(pds, bstate, blknum);
+				updatePDSHeapScanBlockState(pds, bstate, blknum,
+											nvme_sstate->stripe_pages);
 				pds->kds.nitems++;
 				retval = true;
 			}
@@ -1444,13 +1981,163 @@ PDS_exec_heapscan_block(GpuTaskState *gts,
 	return true;
 }
 
+/*
+ * heapScanNeedsDetoast
+ *
+ * It checks whether the device code references any varlena columns, thus
+ * compressed or external datum may lead CPU fallback on the device side.
+ */
+static bool
+heapScanNeedsDetoast(GpuTaskState *gts, TupleDesc tupdesc)
+{
+	int		j;
+
+	if (!pgstrom_detoast_on_load)
+		return false;
+	for (j = bms_next_member(gts->outer_refs, -1);
+		 j >= 0;
+		 j = bms_next_member(gts->outer_refs, j))
+	{
+		AttrNumber	anum = j + FirstLowInvalidHeapAttributeNumber;
+
+		if (anum > 0 && anum <= tupdesc->natts &&
+			tupleDescAttr(tupdesc, anum-1)->attlen == -1)
+			return true;
+	}
+	return false;
+}
+
+/*
+ * heapScanDetoastTuple
+ *
+ * It returns a copy of the tuple whose compressed or external varlena
+ * columns referenced by the device code are expanded to the plain form,
+ * or NULL if the tuple contains no such columns. The identity and
+ * visibility fields of the header are kept, like toast_flatten_tuple().
+ * Caller must not hold the buffer lock if @fetch_external, because
+ * external datum is fetched from the toast relation.
+ */
+static HeapTuple
+heapScanDetoastTuple(GpuTaskState *gts, TupleDesc tupdesc,
+					 HeapTuple tuple, bool fetch_external)
+{
+	HeapTupleHeader	olddata = tuple->t_data;
+	HeapTupleHeader	newdata;
+	HeapTuple		newtup;
+	Datum			values[MaxTupleAttributeNumber];
+	bool			isnull[MaxTupleAttributeNumber];
+	bool			freeable[MaxTupleAttributeNumber];
+	bool			has_toasted = false;
+	int				j;
+
+	if (!HeapTupleHasVarWidth(tuple))
+		return NULL;
+	heap_deform_tuple(tuple, tupdesc, values, isnull);
+	for (j=0; j < tupdesc->natts; j++)
+	{
+		Form_pg_attribute attr = tupleDescAttr(tupdesc, j);
+		struct varlena *vl;
+
+		freeable[j] = false;
+		if (isnull[j] || attr->attlen != -1 ||
+			!bms_is_member(attr->attnum - FirstLowInvalidHeapAttributeNumber,
+						   gts->outer_refs))
+			continue;
+		vl = (struct varlena *) DatumGetPointer(values[j]);
+		if (VARATT_IS_EXTERNAL(vl) ? fetch_external : VARATT_IS_COMPRESSED(vl))
+		{
+			values[j] = PointerGetDatum(detoast_attr(vl));
+			freeable[j] = true;
+			has_toasted = true;
+		}
+	}
+	if (!has_toasted)
+		return NULL;
+
+	newtup = heap_form_tuple(tupdesc, values, isnull);
+	newdata = newtup->t_data;
+	/* copy the identity fields, and visibility hint bits */
+	memcpy(&newdata->t_choice, &olddata->t_choice,
+		   sizeof(olddata->t_choice));
+	newdata->t_ctid = olddata->t_ctid;
+	newdata->t_infomask &= ~HEAP_XACT_MASK;
+	newdata->t_infomask |= (olddata->t_infomask & HEAP_XACT_MASK);
+	newdata->t_infomask2 &= ~HEAP2_XACT_MASK;
+	newdata->t_infomask2 |= (olddata->t_infomask2 & HEAP2_XACT_MASK);
+	newtup->t_self = tuple->t_self;
+	newtup->t_tableOid = tuple->t_tableOid;
+
+	for (j=0; j < tupdesc->natts; j++)
+	{
+		if (freeable[j])
+			pfree(DatumGetPointer(values[j]));
+	}
+	return newtup;
+}
+
+/*
+ * heapScanPutTuple - put a tuple on the KDS_FORMAT_ROW
+ */
+static inline void
+heapScanPutTuple(kern_data_store *kds, cl_uint rowid,
+				 HeapTupleHeader t_data, uint32 t_len,
+				 ItemPointer t_self)
+{
+	kern_tupitem   *tup_item;
+	size_t			curr_usage;
+
+	curr_usage = (__kds_unpack(kds->usage) +
+				  MAXALIGN(offsetof(kern_tupitem, htup) + t_len));
+	tup_item = (kern_tupitem *)((char *)kds + kds->length - curr_usage);
+	tup_item->rowid = rowid;
+	tup_item->t_len = t_len;
+	memcpy(&tup_item->htup, t_data, t_len);
+	memcpy(&tup_item->htup.t_ctid, t_self, sizeof(ItemPointerData));
+
+	KERN_DATA_STORE_ROWINDEX(kds)[rowid]
+		= __kds_packed((uintptr_t)tup_item - (uintptr_t)kds);
+	kds->usage = __kds_packed(curr_usage);
+}
+
+/*
+ * heapScanPutExpandedTuple
+ *
+ * It puts the expanded tuple instead of the original one, if the KDS still
+ * has room for the growth. Elsewhere, caller puts the original one, and the
+ * device code shall run CPU fallback on the row.
+ */
+static bool
+heapScanPutExpandedTuple(kern_data_store *kds, cl_uint rowid,
+						 HeapTuple newtup, uint32 orig_len,
+						 Size *p_detoast_slack)
+{
+	Size	orig_sz = MAXALIGN(offsetof(kern_tupitem, htup) + orig_len);
+	Size	new_sz = MAXALIGN(offsetof(kern_tupitem, htup) + newtup->t_len);
+
+	if (new_sz > orig_sz)
+	{
+		if (new_sz - orig_sz > *p_detoast_slack)
+			return false;
+		*p_detoast_slack -= (new_sz - orig_sz);
+	}
+	heapScanPutTuple(kds, rowid, newtup->t_data, newtup->t_len,
+					 &newtup->t_self);
+	return true;
+}
+
 /*
  * PDS_exec_heapscan_row - PDS scan for KDS_FORMAT_ROW format
+ *
+ * If pg_strom.detoast_on_load is enabled, compressed or external varlena
+ * columns referenced by the device code are expanded here, in the bulk
+ * for each block, not to run CPU fallback for each row on the device.
+ * External datum is fetched after the buffer lock is released.
  */
 static bool
 PDS_exec_heapscan_row(GpuTaskState *gts, pgstrom_data_store *pds)
 {
 	Relation		relation = gts->css.ss.ss_currentRelation;
+	TupleDesc		tupdesc = RelationGetDescr(relation);
 	HeapScanDesc	hscan = (HeapScanDesc)gts->css.ss.ss_currentScanDesc;
 	BlockNumber		blknum = hscan->rs_cblock;
 	Snapshot		snapshot = ((TableScanDesc)hscan)->rs_snapshot;
@@ -1462,10 +2149,13 @@ PDS_exec_heapscan_row(GpuTaskState *gts, pgstrom_data_store *pds)
 	int				ntup;
 	OffsetNumber	lineoff;
 	ItemId			lpp;
-	uint		   *tup_index;
-	kern_tupitem   *tup_item;
 	bool			all_visible;
+	bool			check_serializable;
+	bool			needs_detoast;
+	List		   *external_tuples = NIL;
+	ListCell	   *lc;
 	Size			max_consume;
+	Size			detoast_slack;
 
 	/* Load the target buffer */
 	buffer = ReadBufferExtended(relation, MAIN_FORKNUM, blknum,
@@ -1498,56 +2188,106 @@ PDS_exec_heapscan_row(GpuTaskState *gts, pgstrom_data_store *pds)
 		UnlockReleaseBuffer(buffer);
 		return false;
 	}
+	/* expanded datum can consume the space out of the estimation above */
+	detoast_slack = kds->length - max_consume;
+	needs_detoast = heapScanNeedsDetoast(gts, tupdesc);
 
 	/*
 	 * Logic is almost same as heapgetpage() doing.
+	 * If the page is all-visible and no SSI check is needed, we can skip
+	 * per-tuple visibility checks; setup of HeapTupleData also.
+	 * Append-mostly tables usually have most pages in this state.
 	 */
 	all_visible = PageIsAllVisible(page) && !snapshot->takenDuringRecovery;
-
-	/* TODO: make SerializationNeededForRead() an external function
-	 * on the core side. It kills necessity of setting up HeapTupleData
-	 * when all_visible and non-serialized transaction.
-	 */
-	tup_index = KERN_DATA_STORE_ROWINDEX(kds) + kds->nitems;
+	check_serializable = CheckForSerializableConflictOutNeeded(relation,
+															   snapshot);
 	for (lineoff = FirstOffsetNumber, lpp = PageGetItemId(page, lineoff);
 		 lineoff <= lines;
 		 lineoff++, lpp++)
 	{
-		HeapTupleData	tup;
-		size_t			curr_usage;
-		bool			valid;
+		HeapTupleHeader	t_data;
+		uint32			t_len;
+		ItemPointerData	t_self;
 
 		if (!ItemIdIsNormal(lpp))
 			continue;
 
-		tup.t_tableOid = RelationGetRelid(relation);
-		tup.t_data = (HeapTupleHeader) PageGetItem((Page) page, lpp);
-		tup.t_len = ItemIdGetLength(lpp);
-		ItemPointerSet(&tup.t_self, blknum, lineoff);
+		t_data = (HeapTupleHeader) PageGetItem((Page) page, lpp);
+		t_len = ItemIdGetLength(lpp);
+		ItemPointerSet(&t_self, blknum, lineoff);
 
-		if (all_visible)
-			valid = true;
-		else
-			valid = HeapTupleSatisfiesVisibility(&tup, snapshot, buffer);
+		if (!all_visible || check_serializable)
+		{
+			HeapTupleData	tup;
+			bool			valid;
 
-		HeapCheckForSerializableConflictOut(valid, relation,
-											&tup, buffer, snapshot);
-		if (!valid)
-			continue;
+			tup.t_tableOid = RelationGetRelid(relation);
+			tup.t_data = t_data;
+			tup.t_len = t_len;
+			tup.t_self = t_self;
+			if (all_visible)
+				valid = true;
+			else
+				valid = HeapTupleSatisfiesVisibility(&tup, snapshot, buffer);
 
-		/* put tuple */
-		curr_usage = (__kds_unpack(kds->usage) +
-					  MAXALIGN(offsetof(kern_tupitem, htup) + tup.t_len));
-		tup_item = (kern_tupitem *)((char *)kds + kds->length - curr_usage);
-		tup_item->rowid = kds->nitems + ntup;
-		tup_item->t_len = tup.t_len;
-		memcpy(&tup_item->htup, tup.t_data, tup.t_len);
-		memcpy(&tup_item->htup.t_ctid, &tup.t_self, sizeof(ItemPointerData));
+			HeapCheckForSerializableConflictOut(valid, relation,
+												&tup, buffer, snapshot);
+			if (!valid)
+				continue;
+		}
 
-		tup_index[ntup++] = __kds_packed((uintptr_t)tup_item - (uintptr_t)kds);
-		kds->usage = __kds_packed(curr_usage);
+		if (needs_detoast)
+		{
+			HeapTupleData	tup;
+			HeapTuple		newtup;
+
+			tup.t_tableOid = RelationGetRelid(relation);
+			tup.t_data = t_data;
+			tup.t_len = t_len;
+			tup.t_self = t_self;
+			if (HeapTupleHasExternal(&tup))
+			{
+				/* fetch toast relation later, without buffer lock */
+				external_tuples = lappend(external_tuples,
+										  heap_copytuple(&tup));
+				continue;
+			}
+			newtup = heapScanDetoastTuple(gts, tupdesc, &tup, false);
+			if (newtup)
+			{
+				bool	done = heapScanPutExpandedTuple(kds, kds->nitems + ntup,
+														newtup, t_len,
+														&detoast_slack);
+				heap_freetuple(newtup);
+				if (done)
+				{
+					ntup++;
+					continue;
+				}
+			}
+		}
+		/* put tuple */
+		heapScanPutTuple(kds, kds->nitems + ntup++, t_data, t_len, &t_self);
 	}
 	UnlockReleaseBuffer(buffer);
+
+	foreach (lc, external_tuples)
+	{
+		HeapTuple	tup = lfirst(lc);
+		HeapTuple	newtup = heapScanDetoastTuple(gts, tupdesc, tup, true);
+
+		if (!newtup ||
+			!heapScanPutExpandedTuple(kds, kds->nitems + ntup,
+									  newtup, tup->t_len,
+									  &detoast_slack))
+			heapScanPutTuple(kds, kds->nitems + ntup,
+							 tup->t_data, tup->t_len, &tup->t_self);
+		ntup++;
+		if (newtup)
+			heap_freetuple(newtup);
+		heap_freetuple(tup);
+	}
+	list_free(external_tuples);
 	Assert(ntup <= MaxHeapTuplesPerPage);
 	Assert(kds->nitems + ntup <= kds->nrooms);
 	kds->nitems += ntup;
@@ -1570,6 +2310,63 @@ heapscan_report_location(HeapScanDesc hscan)
 #endif
 }
 
+/*
+ * heapScanChunkNBlocks - number of blocks per chunk (KDS_FORMAT_BLOCK),
+ * according to the adaptive chunk size
+ */
+static inline cl_uint
+heapScanChunkNBlocks(GpuTaskState *gts)
+{
+	NVMEScanState *nvme_sstate = gts->nvme_sstate;
+	cl_uint		nblocks = gts->chunk_size_curr / BLCKSZ;
+
+	return Max(Min(nblocks, nvme_sstate->nblocks_per_chunk), 1);
+}
+
+/*
+ * heapScanReadAhead
+ *
+ * On the buffered heap scan (no GPUDirect SQL), it gives the kernel hints
+ * to read-ahead the blocks of the next pg_strom.heap_readahead_chunks
+ * chunks by posix_fadvise(WILLNEED) through PrefetchBuffer(), so storage
+ * i/o overlaps with the GPU execution of the current chunk. Ranges that
+ * shall be skipped by BRIN-index are not prefetched.
+ * @curr_pos is the position of the scan relative to the @startblock.
+ */
+static void
+heapScanReadAhead(GpuTaskState *gts,
+				  Bitmapset *brin_map, cl_long brin_range_sz,
+				  BlockNumber startblock, cl_long curr_pos)
+{
+#ifdef USE_PREFETCH
+	Relation	relation = gts->css.ss.ss_currentRelation;
+	HeapScanDesc hscan = (HeapScanDesc)gts->css.ss.ss_currentScanDesc;
+	cl_long		nblocks = hscan->rs_nblocks;
+	cl_long		distance;
+	cl_long		pos;
+
+	if (pgstrom_heap_readahead_chunks <= 0 || gts->nvme_sstate)
+		return;
+	distance = ((cl_long)pgstrom_heap_readahead_chunks *
+				Max(gts->chunk_size_curr / BLCKSZ, 1));
+	pos = Max(gts->heap_readahead_pos, curr_pos);
+	while (pos < nblocks && pos < curr_pos + distance)
+	{
+		BlockNumber	blknum = (startblock + pos) % nblocks;
+
+		if (brin_map && bms_is_member(blknum / brin_range_sz, brin_map))
+		{
+			/* skip to the next range */
+			pos += brin_range_sz - (blknum % brin_range_sz);
+			continue;
+		}
+		PrefetchBuffer(relation, MAIN_FORKNUM, blknum);
+		pos++;
+	}
+	gts->heap_readahead_pos = pos;
+#endif
+}
+
 /*
  * pgstromExecHeapScanChunkParallel - read the heap relation by parallel scan
  */
@@ -1600,6 +2397,7 @@ pgstromExecHeapScanChunkParallel(GpuTaskState *gts,
 			hscan->rs_cblock = InvalidBlockNumber;
 			hscan->rs_numblocks = 0;		/* force to get next blocks */
 			hscan->rs_inited = true;
+			gts->heap_readahead_pos = 0;
 		}
 		else if (hscan->rs_cblock == InvalidBlockNumber)
 		{
@@ -1638,7 +2436,7 @@ pgstromExecHeapScanChunkParallel(GpuTaskState *gts,
 				nr_blocks = pds->kds.nrooms - pds->kds.nitems;
 			}
 			else
-				nr_blocks = nvme_sstate->nblocks_per_chunk;
+				nr_blocks = heapScanChunkNBlocks(gts);
 
 		retry_lock:
 			SpinLockAcquire(&gtss->pbs_mutex);
@@ -1744,6 +2542,9 @@ pgstromExecHeapScanChunkParallel(GpuTaskState *gts,
 			/* update # of blocks already allocated to workers */
 			gtss->pbs_nallocated = nr_allocated;
 			SpinLockRelease(&gtss->pbs_mutex);
+			/* read-ahead the blocks to be allocated next */
+			heapScanReadAhead(gts, brin_map, brin_range_sz,
+							  startblock, nr_allocated);
 
 			hscan->rs_cblock = page;
 			hscan->rs_numblocks = nr_blocks;
@@ -1757,7 +2558,8 @@ pgstromExecHeapScanChunkParallel(GpuTaskState *gts,
 			{
 				pds = PDS_create_block(gts->gcontext,
 									   RelationGetDescr(relation),
-									   gts->nvme_sstate);
+									   gts->nvme_sstate,
+									   heapScanChunkNBlocks(gts));
 				pds->kds.table_oid = RelationGetRelid(relation);
 				initPDSHeapScanBlockState(pds, bstate);
 			}
@@ -1771,7 +2573,7 @@ pgstromExecHeapScanChunkParallel(GpuTaskState *gts,
 			{
 				pds = PDS_create_row(gts->gcontext,
 									 RelationGetDescr(relation),
-									 pgstrom_chunk_size());
+									 gts->chunk_size_curr);
 				pds->kds.table_oid = RelationGetRelid(relation);
 			}
 			if (!PDS_exec_heapscan_row(gts, pds))
@@ -1821,6 +2623,7 @@ pgstromExecHeapScanChunk(GpuTaskState *gts,
 			hscan->rs_cblock = hscan->rs_startblock;
 			Assert(hscan->rs_numblocks == InvalidBlockNumber);
 			hscan->rs_inited = true;
+			gts->heap_readahead_pos = 0;
 		}
 		else if (hscan->rs_cblock == InvalidBlockNumber)
 		{
@@ -1828,6 +2631,12 @@ pgstromExecHeapScanChunk(GpuTaskState *gts,
 			break;
 		}
 		page = hscan->rs_cblock;
+		/* read-ahead the next chunks, once per chunk */
+		if (!pds)
+			heapScanReadAhead(gts, brin_map, brin_range_sz,
+							  hscan->rs_startblock,
+							  (page + hscan->rs_nblocks -
+							   hscan->rs_startblock) % hscan->rs_nblocks);
 
 		/*
 		 * If any, check BRIN-index bitmap, then moves to the next range
@@ -1857,7 +2666,8 @@ pgstromExecHeapScanChunk(GpuTaskState *gts,
 			{
 				pds =  PDS_create_block(gts->gcontext,
 										RelationGetDescr(rel),
-										gts->nvme_sstate);
+										gts->nvme_sstate,
+										heapScanChunkNBlocks(gts));
 				pds->kds.table_oid = RelationGetRelid(rel);
 				initPDSHeapScanBlockState(pds, bstate);
 			}
@@ -1870,7 +2680,7 @@ pgstromExecHeapScanChunk(GpuTaskState *gts,
 			{
 				pds = PDS_create_row(gts->gcontext,
 									 RelationGetDescr(rel),
-									 pgstrom_chunk_size());
+									 gts->chunk_size_curr);
 				pds->kds.table_oid = RelationGetRelid(rel);
 			}
 			if (!PDS_exec_heapscan_row(gts, pds))
@@ -1908,7 +2718,10 @@ pgstromExecScanChunk(GpuTaskState *gts)
 	Bitmapset	   *brin_map;
 	cl_long			brin_range_sz = 0;
 	pgstrom_data_store *pds = NULL;
+	uint64			nvtx_range;
 
+	nvtx_range = pgstromNvtxBegin("ExecScanChunk", gts,
+								  gts->last_task_id + 1);
 	/*
 	 * Setup scan-descriptor, if the scan is not parallel, of if we're
 	 * executing a scan that was intended to be parallel serially.
@@ -1978,13 +2791,18 @@ pgstromExecScanChunk(GpuTaskState *gts)
 	if (pds)
 	{
 		if (pds->kds.format == KDS_FORMAT_BLOCK)
+		{
 			gts->nvme_count += pds->nblocks_uncached;
+			gts->nvme_cached_count += (pds->kds.nitems -
+									   pds->nblocks_uncached);
+		}
 		InstrStopNode(&gts->outer_instrument, (double)pds->kds.nitems);
 	}
 	else
 	{
 		InstrStopNode(&gts->outer_instrument, 0.0);
 	}
+	pgstromNvtxEnd(nvtx_range);
 	return pds;
 }
 
@@ -2192,6 +3010,66 @@ pgstrom_init_relscan(void)
 							 PGC_USERSET,
                              GUC_NOT_IN_SAMPLE,
                              NULL, NULL, NULL);
+	/* pg_strom.gpudirect_clean_buffers */
+	DefineCustomBoolVariable("pg_strom.gpudirect_clean_buffers",
+							 "Loads clean shared buffers by GPUDirect SQL, not by CPU copy",
+							 NULL,
+							 &pgstrom_gpudirect_clean_buffers,
+							 false,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	/* pg_strom.heap_readahead_chunks */
+	DefineCustomIntVariable("pg_strom.heap_readahead_chunks",
+							"Number of chunks to be read-ahead on heap scan without GPUDirect SQL",
+							NULL,
+							&pgstrom_heap_readahead_chunks,
+							2,
+							0,
+							64,
+							PGC_USERSET,
+							GUC_NOT_IN_SAMPLE,
+							NULL, NULL, NULL);
+	/* pg_strom.detoast_on_load */
+	DefineCustomBoolVariable("pg_strom.detoast_on_load",
+							 "Expands compressed or external varlena referenced by GPU on loading heap blocks",
+							 NULL,
+							 &pgstrom_detoast_on_load,
+							 true,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	/* pg_strom.max_parallel_workers_per_gpu */
+	DefineCustomIntVariable("pg_strom.max_parallel_workers_per_gpu",
+							"Max number of processes per GPU for parallel scan without CPU loading",
+							NULL,
+							&pgstrom_max_parallel_workers_per_gpu,
+							2,
+							0,
+							1024,
+							PGC_USERSET,
+							GUC_NOT_IN_SAMPLE,
+							NULL, NULL, NULL);
+	/* pg_strom.gpu_mvcc_check */
+	DefineCustomBoolVariable("pg_strom.gpu_mvcc_check",
+							 "Enables MVCC visibility checks by GPU on the heap blocks loaded by GPUDirect SQL",
+							 NULL,
+							 &pgstrom_gpu_mvcc_check,
+							 true,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	/* pg_strom.gpu_mvcc_clog_xids */
+	DefineCustomIntVariable("pg_strom.gpu_mvcc_clog_xids",
+							"Number of recent transactions whose commit status is sent to GPU",
+							NULL,
+							&pgstrom_gpu_mvcc_clog_xids,
+							16384,
+							0,
+							1048576,
+							PGC_USERSET,
+							GUC_NOT_IN_SAMPLE,
+							NULL, NULL, NULL);
 	/*
 	 * pg_strom.nvme_distance_map
 	 *
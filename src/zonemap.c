@@ -0,0 +1,819 @@
+/*
+ * zonemap.c
+ *
+ * Zone-map; min/max statistics per block-range of PostgreSQL tables
+ * ----
+ * Copyright 2011-2021 (C) KaiGai Kohei <kaigai@kaigai.gr.jp>
+ * Copyright 2014-2021 (C) PG-Strom Developers Team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the PostgreSQL License.
+ */
+#include "pg_strom.h"
+
+/*
+ * Definition of pgstrom.zonemap
+ *
+ * A row of pgstrom.zonemap keeps an array of ZoneMapItem for a particular
+ * column of the table. Only fixed-length and pass-by-value types are
+ * supported, so min/max values are stored as Datum as is.
+ */
+#define Natts_pgstrom_zonemap			7
+#define Anum_pgstrom_zonemap_relid		1
+#define Anum_pgstrom_zonemap_attnum		2
+#define Anum_pgstrom_zonemap_atttypid	3
+#define Anum_pgstrom_zonemap_relfilenode 4
+#define Anum_pgstrom_zonemap_range_sz	5
+#define Anum_pgstrom_zonemap_nblocks	6
+#define Anum_pgstrom_zonemap_stats		7
+
+typedef struct
+{
+	cl_uint		nitems;		/* number of non-NULL values in the range */
+	cl_uint		nnulls;		/* number of NULL values in the range */
+	Datum		min_value;
+	Datum		max_value;
+} ZoneMapItem;
+
+/*
+ * pgstromZoneMapState - executor state of the zone-map
+ */
+struct pgstromZoneMapState
+{
+	BlockNumber	range_sz;
+	cl_uint		nranges;
+	List	   *orig_quals;		/* for EXPLAIN */
+	ExprState  *eval_state;
+	ExprContext *econtext;
+	Bitmapset  *load_attrs;
+	ZoneMapItem **zm_items;		/* per attribute, NULL if not loaded */
+};
+
+/* static variables */
+static bool		pgstrom_enable_zonemap;		/* GUC */
+static Oid		__zonemap_invalidate_function_oid = InvalidOid;
+
+PG_FUNCTION_INFO_V1(pgstrom_zonemap_refresh);
+PG_FUNCTION_INFO_V1(pgstrom_zonemap_invalidate);
+
+#define ZONEMAP_TRIGGER_NAME	"pgstrom_zonemap_invalidate"
+
+/*
+ * zonemap_table_oid - OID of pgstrom.zonemap, if any
+ */
+static Oid
+zonemap_table_oid(bool missing_ok)
+{
+	Oid			namespace_oid;
+	Oid			table_oid = InvalidOid;
+
+	namespace_oid = get_namespace_oid("pgstrom", missing_ok);
+	if (OidIsValid(namespace_oid))
+		table_oid = get_relname_relid("zonemap", namespace_oid);
+	if (!OidIsValid(table_oid) && !missing_ok)
+		elog(ERROR, "pgstrom.zonemap is not defined");
+	return table_oid;
+}
+
+/*
+ * zonemap_invalidate_function_oid
+ */
+static Oid
+zonemap_invalidate_function_oid(void)
+{
+	if (!OidIsValid(__zonemap_invalidate_function_oid))
+	{
+		Oid			namespace_oid;
+		oidvector	argtypes;
+		HeapTuple	tuple;
+
+		namespace_oid = get_namespace_oid("pgstrom", true);
+		if (!OidIsValid(namespace_oid))
+			return InvalidOid;
+
+		memset(&argtypes, 0, sizeof(oidvector));
+		SET_VARSIZE(&argtypes, offsetof(oidvector, values[0]));
+		argtypes.ndim = 1;
+		argtypes.dataoffset = 0;
+		argtypes.elemtype = OIDOID;
+		argtypes.dim1 = 0;
+		argtypes.lbound1 = 0;
+
+		tuple = SearchSysCache3(PROCNAMEARGSNSP,
+								CStringGetDatum("zonemap_invalidate"),
+								PointerGetDatum(&argtypes),
+								ObjectIdGetDatum(namespace_oid));
+		if (HeapTupleIsValid(tuple))
+		{
+			__zonemap_invalidate_function_oid = PgProcTupleGetOid(tuple);
+			ReleaseSysCache(tuple);
+		}
+	}
+	return __zonemap_invalidate_function_oid;
+}
+
+/*
+ * zonemapHasInvalidationTrigger
+ *
+ * Zone-map is valid only if the table has the invalidation trigger that
+ * fires on any INSERT, UPDATE and TRUNCATE, regardless of the replication
+ * role. Elsewhere, we cannot trust the min/max statistics.
+ */
+static bool
+zonemapHasInvalidationTrigger(Relation rel)
+{
+	TriggerDesc *trigdesc = rel->trigdesc;
+	Oid			func_oid = zonemap_invalidate_function_oid();
+	int			i;
+
+	if (!trigdesc || !OidIsValid(func_oid))
+		return false;
+	for (i=0; i < trigdesc->numtriggers; i++)
+	{
+		Trigger	   *trig = &trigdesc->triggers[i];
+
+		if (trig->tgfoid == func_oid &&
+			trig->tgenabled == TRIGGER_FIRES_ALWAYS &&
+			TRIGGER_FOR_AFTER(trig->tgtype) &&
+			!TRIGGER_FOR_ROW(trig->tgtype) &&
+			TRIGGER_FOR_INSERT(trig->tgtype) &&
+			TRIGGER_FOR_UPDATE(trig->tgtype) &&
+			TRIGGER_FOR_TRUNCATE(trig->tgtype))
+			return true;
+	}
+	return false;
+}
+
+/*
+ * zonemapEnsureInvalidationTrigger
+ */
+static void
+zonemapEnsureInvalidationTrigger(Relation rel)
+{
+	char	   *relname;
+	char	   *sql;
+	int			rv;
+
+	if (zonemapHasInvalidationTrigger(rel))
+		return;
+
+	relname = quote_qualified_identifier(get_namespace_name(rel->rd_rel->relnamespace),
+										 RelationGetRelationName(rel));
+	if (SPI_connect() != SPI_OK_CONNECT)
+		elog(ERROR, "failed on SPI_connect");
+	sql = psprintf("SELECT 1 FROM pg_catalog.pg_trigger"
+				   " WHERE tgrelid = %u AND tgname = '%s'",
+				   RelationGetRelid(rel), ZONEMAP_TRIGGER_NAME);
+	rv = SPI_execute(sql, true, 0);
+	if (rv != SPI_OK_SELECT)
+		elog(ERROR, "failed on SPI_execute: %s", SPI_result_code_string(rv));
+	if (SPI_processed == 0)
+	{
+		sql = psprintf("CREATE TRIGGER %s"
+					   " AFTER INSERT OR UPDATE OR TRUNCATE ON %s"
+					   " FOR EACH STATEMENT"
+					   " EXECUTE PROCEDURE pgstrom.zonemap_invalidate()",
+					   ZONEMAP_TRIGGER_NAME, relname);
+		rv = SPI_execute(sql, false, 0);
+		if (rv != SPI_OK_UTILITY)
+			elog(ERROR, "failed on SPI_execute: %s",
+				 SPI_result_code_string(rv));
+	}
+	/* must fire also on the logical replication apply */
+	sql = psprintf("ALTER TABLE %s ENABLE ALWAYS TRIGGER %s",
+				   relname, ZONEMAP_TRIGGER_NAME);
+	rv = SPI_execute(sql, false, 0);
+	if (rv != SPI_OK_UTILITY)
+		elog(ERROR, "failed on SPI_execute: %s", SPI_result_code_string(rv));
+	SPI_finish();
+}
+
+/*
+ * zonemapRemoveEntries
+ *
+ * It removes all the zone-map entries of the table. Note that we use the
+ * latest snapshot to find out the entries, because an entry built by the
+ * concurrent transaction might be invisible to the transaction snapshot
+ * (if repeatable read), but has to be removed. Entries already removed by
+ * the concurrent transaction shall be simply ignored.
+ */
+static void
+zonemapRemoveEntries(Relation zm_rel, Oid table_oid)
+{
+	Snapshot	snapshot;
+	SysScanDesc	sscan;
+	ScanKeyData	skey;
+	HeapTuple	tuple;
+	CommandId	cid = GetCurrentCommandId(true);
+
+	ScanKeyInit(&skey,
+				Anum_pgstrom_zonemap_relid,
+				BTEqualStrategyNumber, F_OIDEQ,
+				ObjectIdGetDatum(table_oid));
+	snapshot = RegisterSnapshot(GetLatestSnapshot());
+	sscan = systable_beginscan(zm_rel, InvalidOid, false,
+							   snapshot, 1, &skey);
+	while (HeapTupleIsValid(tuple = systable_getnext(sscan)))
+	{
+		TM_FailureData	tmfd;
+
+		(void) heap_delete(zm_rel, &tuple->t_self, cid,
+						   InvalidSnapshot, true, &tmfd, false);
+	}
+	systable_endscan(sscan);
+	UnregisterSnapshot(snapshot);
+}
+
+/*
+ * zonemapAttributeIsSupported
+ */
+static bool
+zonemapAttributeIsSupported(Form_pg_attribute attr)
+{
+	TypeCacheEntry *tcache;
+
+	if (attr->attisdropped ||
+		!attr->attbyval ||
+		attr->attlen <= 0)
+		return false;
+	tcache = lookup_type_cache(attr->atttypid, TYPECACHE_CMP_PROC_FINFO);
+	return OidIsValid(tcache->cmp_proc_finfo.fn_oid);
+}
+
+/*
+ * pgstrom_zonemap_refresh
+ *
+ * It (re-)builds the zone-map of the supplied table. Once VACUUM or bulk-
+ * loading is completed, the zone-map has to be refreshed, because any
+ * INSERT/UPDATE/TRUNCATE invalidates the zone-map.
+ */
+Datum
+pgstrom_zonemap_refresh(PG_FUNCTION_ARGS)
+{
+	Oid			table_oid = PG_GETARG_OID(0);
+	int32		range_sz = PG_GETARG_INT32(1);
+	Relation	rel;
+	Relation	zm_rel;
+	TupleDesc	tupdesc;
+	BlockNumber	nblocks;
+	cl_uint		nranges;
+	Snapshot	snapshot;
+	TableScanDesc scan;
+	HeapTuple	tuple;
+	Datum	   *values;
+	bool	   *isnull;
+	ZoneMapItem **zm_items;
+	FmgrInfo  **zm_cmp;
+	int			j;
+
+	if (range_sz <= 0)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("zone-map range size must be positive")));
+	/* block concurrent writes and refresh */
+	rel = table_open(table_oid, ShareRowExclusiveLock);
+	if (rel->rd_rel->relkind != RELKIND_RELATION &&
+		rel->rd_rel->relkind != RELKIND_MATVIEW)
+		ereport(ERROR,
+				(errcode(ERRCODE_WRONG_OBJECT_TYPE),
+				 errmsg("\"%s\" is not a table or materialized view",
+						RelationGetRelationName(rel))));
+	if (!pg_class_ownercheck(table_oid, GetUserId()))
+		aclcheck_error(ACLCHECK_NOT_OWNER,
+					   get_relkind_objtype(rel->rd_rel->relkind),
+					   RelationGetRelationName(rel));
+	zonemapEnsureInvalidationTrigger(rel);
+
+	tupdesc = RelationGetDescr(rel);
+	nblocks = RelationGetNumberOfBlocks(rel);
+	nranges = (nblocks + range_sz - 1) / range_sz;
+	values = palloc(sizeof(Datum) * tupdesc->natts);
+	isnull = palloc(sizeof(bool)  * tupdesc->natts);
+	zm_items = palloc0(sizeof(ZoneMapItem *) * tupdesc->natts);
+	zm_cmp = palloc0(sizeof(FmgrInfo *) * tupdesc->natts);
+	for (j=0; j < tupdesc->natts; j++)
+	{
+		Form_pg_attribute attr = tupleDescAttr(tupdesc, j);
+
+		if (!zonemapAttributeIsSupported(attr))
+			continue;
+		zm_items[j] = MemoryContextAllocHuge(CurrentMemoryContext,
+											 sizeof(ZoneMapItem) * nranges);
+		memset(zm_items[j], 0, sizeof(ZoneMapItem) * nranges);
+		zm_cmp[j] = &lookup_type_cache(attr->atttypid,
+									   TYPECACHE_CMP_PROC_FINFO)->cmp_proc_finfo;
+	}
+
+	/*
+	 * MEMO: we need the latest snapshot, not the transaction snapshot,
+	 * because writer transactions committed prior to the ShareRowExclusive
+	 * lock might not be visible, even though they could not remove the
+	 * zone-map entry we are now building.
+	 */
+	snapshot = RegisterSnapshot(GetLatestSnapshot());
+	scan = table_beginscan(rel, snapshot, 0, NULL);
+	while ((tuple = heap_getnext(scan, ForwardScanDirection)) != NULL)
+	{
+		BlockNumber	index = ItemPointerGetBlockNumber(&tuple->t_self) / range_sz;
+
+		if (index >= nranges)
+			elog(ERROR, "Bug? block %u of \"%s\" is out of the zone-map",
+				 ItemPointerGetBlockNumber(&tuple->t_self),
+				 RelationGetRelationName(rel));
+		heap_deform_tuple(tuple, tupdesc, values, isnull);
+		for (j=0; j < tupdesc->natts; j++)
+		{
+			Form_pg_attribute attr = tupleDescAttr(tupdesc, j);
+			ZoneMapItem *zm_item;
+
+			if (!zm_items[j])
+				continue;
+			zm_item = &zm_items[j][index];
+			if (isnull[j])
+				zm_item->nnulls++;
+			else if (zm_item->nitems++ == 0)
+			{
+				zm_item->min_value = values[j];
+				zm_item->max_value = values[j];
+			}
+			else
+			{
+				if (DatumGetInt32(FunctionCall2Coll(zm_cmp[j],
+													attr->attcollation,
+													values[j],
+													zm_item->min_value)) < 0)
+					zm_item->min_value = values[j];
+				if (DatumGetInt32(FunctionCall2Coll(zm_cmp[j],
+													attr->attcollation,
+													values[j],
+													zm_item->max_value)) > 0)
+					zm_item->max_value = values[j];
+			}
+		}
+		CHECK_FOR_INTERRUPTS();
+	}
+	table_endscan(scan);
+	UnregisterSnapshot(snapshot);
+
+	/* write out the new zone-map */
+	zm_rel = table_open(zonemap_table_oid(false), RowExclusiveLock);
+	zonemapRemoveEntries(zm_rel, table_oid);
+	for (j=0; j < tupdesc->natts; j++)
+	{
+		Form_pg_attribute attr = tupleDescAttr(tupdesc, j);
+		Datum		zm_values[Natts_pgstrom_zonemap];
+		bool		zm_isnull[Natts_pgstrom_zonemap];
+		size_t		sz = sizeof(ZoneMapItem) * nranges;
+		bytea	   *stats;
+
+		if (!zm_items[j])
+			continue;
+		stats = palloc(VARHDRSZ + sz);
+		SET_VARSIZE(stats, VARHDRSZ + sz);
+		memcpy(VARDATA(stats), zm_items[j], sz);
+
+		memset(zm_isnull, 0, sizeof(zm_isnull));
+		zm_values[Anum_pgstrom_zonemap_relid - 1]
+			= ObjectIdGetDatum(table_oid);
+		zm_values[Anum_pgstrom_zonemap_attnum - 1]
+			= Int16GetDatum(attr->attnum);
+		zm_values[Anum_pgstrom_zonemap_atttypid - 1]
+			= ObjectIdGetDatum(attr->atttypid);
+		zm_values[Anum_pgstrom_zonemap_relfilenode - 1]
+			= ObjectIdGetDatum(rel->rd_node.relNode);
+		zm_values[Anum_pgstrom_zonemap_range_sz - 1]
+			= Int32GetDatum(range_sz);
+		zm_values[Anum_pgstrom_zonemap_nblocks - 1]
+			= Int32GetDatum(nblocks);
+		zm_values[Anum_pgstrom_zonemap_stats - 1]
+			= PointerGetDatum(stats);
+		tuple = heap_form_tuple(RelationGetDescr(zm_rel),
+								zm_values, zm_isnull);
+		simple_heap_insert(zm_rel, tuple);
+
+		heap_freetuple(tuple);
+		pfree(stats);
+		pfree(zm_items[j]);
+	}
+	table_close(zm_rel, RowExclusiveLock);
+	table_close(rel, NoLock);
+
+	PG_RETURN_INT64(nranges);
+}
+
+/*
+ * pgstrom_zonemap_invalidate
+ *
+ * AFTER INSERT OR UPDATE OR TRUNCATE statement trigger to remove zone-map
+ * of the table.
+ */
+Datum
+pgstrom_zonemap_invalidate(PG_FUNCTION_ARGS)
+{
+	TriggerData	   *trigdata = (TriggerData *) fcinfo->context;
+	Oid				zm_relid;
+
+	if (!CALLED_AS_TRIGGER(fcinfo))
+		elog(ERROR, "%s: must be called as trigger",
+			 get_func_name(fcinfo->flinfo->fn_oid));
+	if (!TRIGGER_FIRED_FOR_STATEMENT(trigdata->tg_event) ||
+		!TRIGGER_FIRED_AFTER(trigdata->tg_event))
+		elog(ERROR, "%s: must be declared as AFTER STATEMENT trigger",
+			 trigdata->tg_trigger->tgname);
+
+	zm_relid = zonemap_table_oid(true);
+	if (OidIsValid(zm_relid))
+	{
+		Relation	zm_rel = table_open(zm_relid, RowExclusiveLock);
+
+		zonemapRemoveEntries(zm_rel, RelationGetRelid(trigdata->tg_relation));
+		table_close(zm_rel, RowExclusiveLock);
+	}
+	PG_RETURN_POINTER(NULL);
+}
+
+/*
+ * pgstromExecBeginZoneMap / pgstromExecCheckZoneMap / pgstromExecEndZoneMap
+ *
+ * ... are executor routines for the zone-map, like min/max statistics of
+ * Arrow_Fdw. The supplied qualifiers are transformed to the conditions
+ * on the min values (INNER_VAR) and max values (OUTER_VAR) of the range.
+ */
+static bool
+__buildZoneMapOper(ScanState *ss, OpExpr *op, bool reverse,
+				   Bitmapset **p_load_attrs,
+				   List **p_eval_quals)
+{
+	Index		scanrelid = ((Scan *)ss->ps.plan)->scanrelid;
+	Oid			opcode;
+	Var		   *var;
+	Node	   *arg;
+	Oid			opfamily = InvalidOid;
+	StrategyNumber strategy = InvalidStrategy;
+	CatCList   *catlist;
+	int			i;
+
+	if (!reverse)
+	{
+		opcode = op->opno;
+		var = linitial(op->args);
+		arg = lsecond(op->args);
+	}
+	else
+	{
+		opcode = get_commutator(op->opno);
+		var = lsecond(op->args);
+		arg = linitial(op->args);
+	}
+	/* Is it VAR <OPER> ARG form? */
+	if (!IsA(var, Var) || var->varno != scanrelid || var->varattno <= 0)
+		return false;
+	if (contain_var_clause(arg) ||
+		contain_volatile_functions(arg))
+		return false;
+
+	catlist = SearchSysCacheList1(AMOPOPID, ObjectIdGetDatum(opcode));
+	for (i=0; i < catlist->n_members; i++)
+	{
+		HeapTuple	tuple = &catlist->members[i]->tuple;
+		Form_pg_amop amop = (Form_pg_amop) GETSTRUCT(tuple);
+
+		if (amop->amopmethod == BRIN_AM_OID)
+		{
+			opfamily = amop->amopfamily;
+			strategy = amop->amopstrategy;
+			break;
+		}
+	}
+	ReleaseSysCacheList(catlist);
+
+	if (strategy == BTLessStrategyNumber ||
+		strategy == BTLessEqualStrategyNumber)
+	{
+		/* (VAR < ARG) --> (Min < ARG) */
+		/* (VAR <= ARG) --> (Min <= ARG) */
+		*p_eval_quals = lappend(*p_eval_quals,
+								make_opclause(opcode,
+											  op->opresulttype,
+											  op->opretset,
+											  (Expr *)makeVar(INNER_VAR,
+															  var->varattno,
+															  var->vartype,
+															  var->vartypmod,
+															  var->varcollid,
+															  0),
+											  (Expr *)copyObject(arg),
+											  op->opcollid,
+											  op->inputcollid));
+	}
+	else if (strategy == BTGreaterEqualStrategyNumber ||
+			 strategy == BTGreaterStrategyNumber)
+	{
+		/* (VAR >= ARG) --> (Max >= ARG) */
+		/* (VAR > ARG) --> (Max > ARG) */
+		*p_eval_quals = lappend(*p_eval_quals,
+								make_opclause(opcode,
+											  op->opresulttype,
+											  op->opretset,
+											  (Expr *)makeVar(OUTER_VAR,
+															  var->varattno,
+															  var->vartype,
+															  var->vartypmod,
+															  var->varcollid,
+															  0),
+											  (Expr *)copyObject(arg),
+											  op->opcollid,
+											  op->inputcollid));
+	}
+	else if (strategy == BTEqualStrategyNumber)
+	{
+		/* (VAR = ARG) --> (Max >= ARG && Min <= ARG) */
+		opcode = get_opfamily_member(opfamily, var->vartype,
+									 exprType((Node *)arg),
+									 BTGreaterEqualStrategyNumber);
+		if (!OidIsValid(opcode))
+			return false;
+		*p_eval_quals = lappend(*p_eval_quals,
+								make_opclause(opcode,
+											  op->opresulttype,
+											  op->opretset,
+											  (Expr *)makeVar(OUTER_VAR,
+															  var->varattno,
+															  var->vartype,
+															  var->vartypmod,
+															  var->varcollid,
+															  0),
+											  (Expr *)copyObject(arg),
+											  op->opcollid,
+											  op->inputcollid));
+		opcode = get_opfamily_member(opfamily, var->vartype,
+									 exprType((Node *)arg),
+									 BTLessEqualStrategyNumber);
+		if (!OidIsValid(opcode))
+			return false;
+		*p_eval_quals = lappend(*p_eval_quals,
+								make_opclause(opcode,
+											  op->opresulttype,
+											  op->opretset,
+											  (Expr *)makeVar(INNER_VAR,
+															  var->varattno,
+															  var->vartype,
+															  var->vartypmod,
+															  var->varcollid,
+															  0),
+											  (Expr *)copyObject(arg),
+											  op->opcollid,
+											  op->inputcollid));
+	}
+	else
+	{
+		return false;
+	}
+	*p_load_attrs = bms_add_member(*p_load_attrs, var->varattno);
+	return true;
+}
+
+/*
+ * __loadZoneMapItems - fetch the zone-map entry of the column, if valid
+ */
+static ZoneMapItem *
+__loadZoneMapItems(Relation rel, Relation zm_rel, Snapshot snapshot,
+				   AttrNumber attnum,
+				   BlockNumber *p_range_sz,
+				   cl_uint *p_nranges)
+{
+	Form_pg_attribute attr = tupleDescAttr(RelationGetDescr(rel), attnum-1);
+	TupleDesc	zm_tupdesc = RelationGetDescr(zm_rel);
+	SysScanDesc	sscan;
+	ScanKeyData	skey[2];
+	HeapTuple	tuple;
+	ZoneMapItem *zm_items = NULL;
+
+	ScanKeyInit(&skey[0],
+				Anum_pgstrom_zonemap_relid,
+				BTEqualStrategyNumber, F_OIDEQ,
+				ObjectIdGetDatum(RelationGetRelid(rel)));
+	ScanKeyInit(&skey[1],
+				Anum_pgstrom_zonemap_attnum,
+				BTEqualStrategyNumber, F_INT2EQ,
+				Int16GetDatum(attnum));
+	sscan = systable_beginscan(zm_rel, InvalidOid, false,
+							   snapshot, 2, skey);
+	tuple = systable_getnext(sscan);
+	if (HeapTupleIsValid(tuple))
+	{
+		Datum		values[Natts_pgstrom_zonemap];
+		bool		isnull[Natts_pgstrom_zonemap];
+		BlockNumber	range_sz;
+		BlockNumber	nblocks;
+		bytea	   *stats;
+		cl_uint		nranges;
+
+		heap_deform_tuple(tuple, zm_tupdesc, values, isnull);
+		if (isnull[Anum_pgstrom_zonemap_atttypid - 1] ||
+			isnull[Anum_pgstrom_zonemap_relfilenode - 1] ||
+			isnull[Anum_pgstrom_zonemap_range_sz - 1] ||
+			isnull[Anum_pgstrom_zonemap_nblocks - 1] ||
+			isnull[Anum_pgstrom_zonemap_stats - 1])
+			goto out;
+		/*
+		 * The zone-map is no longer valid if the table is rewritten
+		 * (VACUUM FULL, CLUSTER, ...), or the column type is altered.
+		 *
+		 * MEMO: blocks added after the refresh are not covered by the
+		 * zone-map, thus always scanned. Any writer making rows visible
+		 * to our snapshot has removed the entry on its commit, so rows
+		 * within the covered blocks are consistent with the min/max.
+		 */
+		if (DatumGetObjectId(values[Anum_pgstrom_zonemap_atttypid - 1])
+			!= attr->atttypid ||
+			DatumGetObjectId(values[Anum_pgstrom_zonemap_relfilenode - 1])
+			!= rel->rd_node.relNode)
+			goto out;
+		range_sz = DatumGetInt32(values[Anum_pgstrom_zonemap_range_sz - 1]);
+		nblocks = DatumGetInt32(values[Anum_pgstrom_zonemap_nblocks - 1]);
+		if (range_sz == 0)
+			goto out;
+		nranges = (nblocks + range_sz - 1) / range_sz;
+		if (*p_range_sz != 0 && (*p_range_sz != range_sz ||
+								 *p_nranges  != nranges))
+			goto out;
+		stats = DatumGetByteaP(values[Anum_pgstrom_zonemap_stats - 1]);
+		if (VARSIZE_ANY_EXHDR(stats) != sizeof(ZoneMapItem) * nranges)
+			goto out;
+		zm_items = palloc(sizeof(ZoneMapItem) * nranges);
+		memcpy(zm_items, VARDATA_ANY(stats), sizeof(ZoneMapItem) * nranges);
+		*p_range_sz = range_sz;
+		*p_nranges = nranges;
+	}
+out:
+	systable_endscan(sscan);
+
+	return zm_items;
+}
+
+pgstromZoneMapState *
+pgstromExecBeginZoneMap(ScanState *ss, List *outer_quals,
+						BlockNumber *p_range_sz)
+{
+	Relation	rel = ss->ss_currentRelation;
+	EState	   *estate = ss->ps.state;
+	TupleDesc	tupdesc = RelationGetDescr(rel);
+	pgstromZoneMapState *zm_state;
+	Relation	zm_rel;
+	Oid			zm_relid;
+	List	   *orig_quals = NIL;
+	List	   *eval_quals = NIL;
+	Bitmapset  *load_attrs = NULL;
+	ZoneMapItem **zm_items;
+	BlockNumber	range_sz = 0;
+	cl_uint		nranges = 0;
+	ExprContext *econtext;
+	Expr	   *eval_expr;
+	ListCell   *lc;
+	int			anum;
+
+	if (!pgstrom_enable_zonemap || !rel ||
+		(rel->rd_rel->relkind != RELKIND_RELATION &&
+		 rel->rd_rel->relkind != RELKIND_MATVIEW))
+		return NULL;
+	zm_relid = zonemap_table_oid(true);
+	if (!OidIsValid(zm_relid) || !zonemapHasInvalidationTrigger(rel))
+		return NULL;
+
+	foreach (lc, outer_quals)
+	{
+		OpExpr	   *op = lfirst(lc);
+
+		if (IsA(op, OpExpr) && list_length(op->args) == 2 &&
+			(__buildZoneMapOper(ss, op, false, &load_attrs, &eval_quals) ||
+			 __buildZoneMapOper(ss, op, true,  &load_attrs, &eval_quals)))
+		{
+			orig_quals = lappend(orig_quals, op);
+		}
+	}
+	if (!orig_quals)
+		return NULL;
+
+	/* load the zone-map of the referenced columns */
+	zm_items = palloc0(sizeof(ZoneMapItem *) * tupdesc->natts);
+	zm_rel = table_open(zm_relid, AccessShareLock);
+	for (anum = bms_next_member(load_attrs, -1);
+		 anum >= 0;
+		 anum = bms_next_member(load_attrs, anum))
+	{
+		zm_items[anum-1] = __loadZoneMapItems(rel, zm_rel,
+											  estate->es_snapshot,
+											  anum,
+											  &range_sz,
+											  &nranges);
+		if (!zm_items[anum-1])
+		{
+			table_close(zm_rel, AccessShareLock);
+			return NULL;
+		}
+	}
+	table_close(zm_rel, AccessShareLock);
+
+	if (list_length(eval_quals) == 1)
+		eval_expr = linitial(eval_quals);
+	else
+		eval_expr = make_andclause(eval_quals);
+
+	econtext = CreateExprContext(estate);
+	econtext->ecxt_innertuple = MakeSingleTupleTableSlot(tupdesc, &TTSOpsVirtual);
+	econtext->ecxt_outertuple = MakeSingleTupleTableSlot(tupdesc, &TTSOpsVirtual);
+
+	zm_state = palloc0(sizeof(pgstromZoneMapState));
+	zm_state->range_sz = range_sz;
+	zm_state->nranges = nranges;
+	zm_state->orig_quals = orig_quals;
+	zm_state->eval_state = ExecInitExpr(eval_expr, &ss->ps);
+	zm_state->econtext = econtext;
+	zm_state->load_attrs = load_attrs;
+	zm_state->zm_items = zm_items;
+
+	*p_range_sz = range_sz;
+	return zm_state;
+}
+
+/*
+ * pgstromExecCheckZoneMap
+ *
+ * It returns false, if the range shall never have any rows that satisfy
+ * the qualifiers.
+ */
+bool
+pgstromExecCheckZoneMap(pgstromZoneMapState *zm_state, cl_uint index)
+{
+	ExprContext	   *econtext = zm_state->econtext;
+	TupleTableSlot *min_values = econtext->ecxt_innertuple;
+	TupleTableSlot *max_values = econtext->ecxt_outertuple;
+	int				anum;
+	Datum			datum;
+	bool			isnull;
+
+	if (index >= zm_state->nranges)
+		return true;
+	ExecStoreAllNullTuple(min_values);
+	ExecStoreAllNullTuple(max_values);
+	for (anum = bms_next_member(zm_state->load_attrs, -1);
+		 anum >= 0;
+		 anum = bms_next_member(zm_state->load_attrs, anum))
+	{
+		ZoneMapItem *zm_item = &zm_state->zm_items[anum-1][index];
+
+		/*
+		 * All the qualifiers are strict operators; if the range has no
+		 * non-NULL values, no rows in the range can satisfy them.
+		 */
+		if (zm_item->nitems == 0)
+			return false;
+		min_values->tts_values[anum-1] = zm_item->min_value;
+		min_values->tts_isnull[anum-1] = false;
+		max_values->tts_values[anum-1] = zm_item->max_value;
+		max_values->tts_isnull[anum-1] = false;
+	}
+	datum = ExecEvalExprSwitchContext(zm_state->eval_state, econtext, &isnull);
+	ResetExprContext(econtext);
+	if (!isnull && DatumGetBool(datum))
+		return true;
+	return false;
+}
+
+/*
+ * pgstromExplainZoneMap
+ */
+List *
+pgstromZoneMapQuals(pgstromZoneMapState *zm_state)
+{
+	return zm_state->orig_quals;
+}
+
+void
+pgstromExecEndZoneMap(pgstromZoneMapState *zm_state)
+{
+	ExprContext	   *econtext = zm_state->econtext;
+
+	ExecDropSingleTupleTableSlot(econtext->ecxt_innertuple);
+	ExecDropSingleTupleTableSlot(econtext->ecxt_outertuple);
+	econtext->ecxt_innertuple = NULL;
+	econtext->ecxt_outertuple = NULL;
+}
+
+/*
+ * pgstrom_init_zonemap
+ */
+void
+pgstrom_init_zonemap(void)
+{
+	/* pg_strom.enable_zonemap */
+	DefineCustomBoolVariable("pg_strom.enable_zonemap",
+							 "Enables to use zone-map of tables",
+							 NULL,
+							 &pgstrom_enable_zonemap,
+							 true,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+}
@@ -0,0 +1,295 @@
+#
+# benchlib.py - common routines of the benchmark harness (SSBM, TPC-H)
+#
+# Copyright 2011-2021 (C) KaiGai Kohei <kaigai@kaigai.gr.jp>
+# Copyright 2014-2021 (C) PG-Strom Developers Team
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the PostgreSQL License.
+#
+import datetime
+import json
+import os
+import re
+import shutil
+import statistics
+import subprocess
+import sys
+
+TEST_DIR = os.path.dirname(os.path.abspath(__file__))
+STROM_BUILD_ROOT = os.path.abspath(os.path.join(TEST_DIR, '..'))
+
+ENGINES = {
+    'strom'  : 'on',
+    'pgsql'  : 'off',
+}
+EXPLAIN_MARKER = '@@BENCH_EXPLAIN@@'
+
+def elog(msg):
+    print(msg, file=sys.stderr, flush=True)
+
+def psql(dbname, script, check=True):
+    proc = subprocess.run(['psql', '-X', '-q', '-A', '-t',
+                           '-v', 'ON_ERROR_STOP=1', '-d', dbname],
+                          input=script, stdout=subprocess.PIPE,
+                          stderr=subprocess.PIPE, universal_newlines=True)
+    if check and proc.returncode != 0:
+        elog(proc.stderr)
+        raise RuntimeError('psql exited with %d' % proc.returncode)
+    return proc.stdout
+
+def lookup_command(name, path):
+    if path:
+        return os.path.abspath(path)
+    cmd = shutil.which(name)
+    if cmd:
+        return cmd
+    for d in ['utils', 'arrow-tools']:
+        cmd = os.path.join(STROM_BUILD_ROOT, d, name)
+        if os.access(cmd, os.X_OK):
+            return cmd
+    raise RuntimeError('command "%s" not found' % name)
+
+def parse_choices(arg, choices, what):
+    items = [v.strip() for v in arg.split(',') if v.strip()]
+    for v in items:
+        if v not in choices:
+            raise RuntimeError('unknown %s "%s"' % (what, v))
+    return items
+
+#
+# parse_queries - extract the queries marked by '--<qname>' lines
+#
+def parse_queries(fname, pattern):
+    queries = []
+    qname = None
+    qbody = ''
+    with open(fname) as f:
+        for line in f:
+            m = re.match(r'^--(%s)\s*$' % pattern, line)
+            if m:
+                if qname:
+                    queries.append((qname, qbody))
+                qname = m.group(1)
+                qbody = ''
+            elif qname and not line.startswith('\\'):
+                qbody += line
+    if qname:
+        queries.append((qname, qbody))
+    results = []
+    for qname, qbody in queries:
+        stmts = [s.strip() for s in qbody.split(';')]
+        stmts = [s for s in stmts
+                 if s and not s.lower().startswith('explain')]
+        if len(stmts) != 1:
+            raise RuntimeError('unexpected query format at %s' % qname)
+        results.append((qname, stmts[0]))
+    return results
+
+#
+# setup_gpu_cache - copies the tables into a schema with GPU Cache
+#
+def setup_gpu_cache(dbname, src_schema, dst_schema, tables):
+    script = 'CREATE SCHEMA %s;\n' % dst_schema
+    for tname, nrows in tables:
+        script += """
+CREATE TABLE %(dst)s.%(tname)s (LIKE %(src)s.%(tname)s);
+CREATE TRIGGER row_sync AFTER INSERT OR UPDATE OR DELETE
+    ON %(dst)s.%(tname)s FOR ROW
+    EXECUTE FUNCTION pgstrom.gpucache_sync_trigger('max_num_rows=%(nrows)d');
+ALTER TABLE %(dst)s.%(tname)s ENABLE ALWAYS TRIGGER row_sync;
+INSERT INTO %(dst)s.%(tname)s SELECT * FROM %(src)s.%(tname)s;
+VACUUM ANALYZE %(dst)s.%(tname)s;
+""" % { 'src' : src_schema, 'dst' : dst_schema,
+        'tname' : tname, 'nrows' : int(nrows * 1.2) }
+    psql(dbname, script)
+
+#
+# setup_arrow_fdw - dumps the tables to Arrow files, then maps them
+#
+def setup_arrow_fdw(dbname, src_schema, dst_schema, tables,
+                    pg2arrow, arrow_dir, suffix):
+    os.makedirs(arrow_dir, exist_ok=True)
+    script = 'CREATE SCHEMA %s;\n' % dst_schema
+    for tname in tables:
+        arrow_file = os.path.join(arrow_dir, '%s_%s_%s.arrow'
+                                  % (src_schema, tname, suffix))
+        elog('dumping %s.%s to %s' % (src_schema, tname, arrow_file))
+        if os.path.exists(arrow_file):
+            os.unlink(arrow_file)
+        subprocess.run([pg2arrow, '-d', dbname,
+                        '-c', 'SELECT * FROM %s.%s' % (src_schema, tname),
+                        '-o', arrow_file], check=True)
+        script += ("IMPORT FOREIGN SCHEMA %s\n"
+                   "  FROM SERVER arrow_fdw\n"
+                   "  INTO %s\n"
+                   "OPTIONS (file '%s');\n" % (tname, dst_schema, arrow_file))
+    psql(dbname, script)
+
+#
+# collect_gpu_stats - pick up GPU statistics from EXPLAIN (FORMAT JSON)
+#
+def collect_gpu_stats(plan, results):
+    if plan.get('Node Type') == 'Custom Scan':
+        stat = { 'node' : plan.get('Custom Plan Provider') }
+        for key, val in plan.items():
+            if key.startswith('GPU ') or key in ('CPU fallbacks',
+                                                 'Actual Total Time',
+                                                 'Actual Rows'):
+                stat[key] = val
+        results.append(stat)
+    for child in plan.get('Plans', []):
+        collect_gpu_stats(child, results)
+    return results
+
+def drop_caches(args):
+    if args.restart_cmd:
+        subprocess.run(args.restart_cmd, shell=True, check=True)
+    subprocess.run(['sudo', 'sysctl', '-w', 'vm.drop_caches=1'],
+                   stdout=subprocess.DEVNULL, check=True)
+
+#
+# run_query - run a query (1 + nloops) times on a session, then EXPLAIN it
+#
+def run_query(args, search_path, enabled, query):
+    script = ("SET search_path = %s;\n"
+              "SET pg_strom.enabled = %s;\n" % (search_path, enabled))
+    if args.setup:
+        script += args.setup + ';\n'
+    script += '\\timing on\n'
+    for i in range(args.nloops + 1):
+        script += "\\o /dev/null\n%s;\n\\o\n" % query
+    script += ('\\timing off\n'
+               '\\echo %s\n'
+               'EXPLAIN (ANALYZE, VERBOSE, FORMAT JSON) %s;\n'
+               % (EXPLAIN_MARKER, query))
+    out = psql(args.dbname, script)
+    head, _, tail = out.partition(EXPLAIN_MARKER)
+    times = [float(t) for t in re.findall(r'^Time: ([0-9.]+) ms', head,
+                                          re.MULTILINE)]
+    if len(times) != args.nloops + 1:
+        raise RuntimeError('unexpected output of psql:\n%s' % head)
+    plan = json.loads(tail)[0]
+    return {
+        'first_ms'   : times[0],
+        'warm_ms'    : statistics.median(times[1:]) if args.nloops > 0
+                       else times[0],
+        'runs_ms'    : times[1:],
+        'explain_ms' : plan.get('Execution Time'),
+        'gpu_stats'  : collect_gpu_stats(plan['Plan'], []),
+    }
+
+#
+# run_benchmark - runs the queries on the variants and engines, then saves
+# the result on the log directory unless -o is given.
+#
+def run_benchmark(args, bench_name, variants, queries, log_dir):
+    selected = parse_choices(args.variants, variants, 'variant')
+    engines = parse_choices(args.engines, ENGINES, 'engine')
+    if args.queries:
+        qnames = parse_choices(args.queries, [q for q, _ in queries], 'query')
+        queries = [(q, s) for q, s in queries if q in qnames]
+    now = datetime.datetime.now()
+    githash = psql(args.dbname, 'SELECT pgstrom.githash();').strip()
+
+    result = {
+        'benchmark' : bench_name,
+        'label'     : args.label or githash,
+        'githash'   : githash,
+        'dbname'    : args.dbname,
+        'timestamp' : now.isoformat(timespec='seconds'),
+        'nloops'    : args.nloops,
+        'cold'      : args.cold,
+        'results'   : [],
+    }
+    for variant in selected:
+        for engine in engines:
+            for qname, query in queries:
+                if args.cold:
+                    drop_caches(args)
+                elog('%s / %s / %s' % (variant, engine, qname))
+                r = run_query(args, variants[variant],
+                              ENGINES[engine], query)
+                r.update({ 'variant' : variant,
+                           'engine'  : engine,
+                           'query'   : qname })
+                result['results'].append(r)
+                elog('    first=%.2fms warm=%.2fms'
+                     % (r['first_ms'], r['warm_ms']))
+    if args.output:
+        fname = args.output
+    else:
+        os.makedirs(log_dir, exist_ok=True)
+        fname = os.path.join(log_dir, '%s_%s_%s.json'
+                             % (bench_name, args.dbname,
+                                now.strftime('%Y%m%d_%H%M%S')))
+    with open(fname, 'w') as f:
+        json.dump(result, f, indent=2)
+    elog('result was written on %s' % fname)
+
+#
+# compare_results - reports the difference of two results, then returns 1
+# if any query gets slower than the threshold.
+#
+def compare_results(args):
+    with open(args.base) as f:
+        base = json.load(f)
+    with open(args.new) as f:
+        new = json.load(f)
+    key = lambda r: (r['variant'], r['engine'], r['query'])
+    base_map = { key(r) : r for r in base['results'] }
+    nregress = 0
+
+    print('base: %s (%s)' % (base['label'], base['timestamp']))
+    print('new:  %s (%s)' % (new['label'], new['timestamp']))
+    print('%-7s %-6s %-5s %12s %12s %8s' % ('variant', 'engine', 'query',
+                                            'base[ms]', 'new[ms]', 'diff'))
+    for r in new['results']:
+        b = base_map.get(key(r))
+        if not b:
+            continue
+        for metric in ('first_ms', 'warm_ms'):
+            t0, t1 = b[metric], r[metric]
+            ratio = (t1 - t0) / t0 * 100.0 if t0 > 0 else 0.0
+            mark = ''
+            if ratio > args.threshold and t1 - t0 > args.min_diff:
+                mark = '  << REGRESSION'
+                nregress += 1
+            elif ratio < -args.threshold and t0 - t1 > args.min_diff:
+                mark = '  (improved)'
+            print('%-7s %-6s %-5s %12.2f %12.2f %+7.1f%%%s'
+                  % (r['variant'], r['engine'],
+                     r['query'] + ('' if metric == 'warm_ms' else '*'),
+                     t0, t1, ratio, mark))
+    print('(*) first run of the query; cold if --cold was given')
+    if nregress > 0:
+        print('%d regression(s) detected' % nregress)
+        return 1
+    return 0
+
+#
+# add_run_arguments / add_compare_arguments - common command line options
+#
+def add_run_arguments(p, dbname, variants):
+    p.add_argument('-d', '--dbname', default=dbname)
+    p.add_argument('-V', '--variants', default=variants)
+    p.add_argument('-e', '--engines', default='strom,pgsql')
+    p.add_argument('-q', '--queries',
+                   help='comma separated list of queries to run')
+    p.add_argument('-n', '--nloops', type=int, default=3,
+                   help='number of warm runs per query')
+    p.add_argument('--cold', action='store_true',
+                   help='drop OS page caches prior to each query')
+    p.add_argument('--restart-cmd',
+                   help='command to restart PostgreSQL with --cold')
+    p.add_argument('--setup', help='SQL commands to run prior to queries')
+    p.add_argument('--label', help='label of the result (default: githash)')
+    p.add_argument('-o', '--output', help='output JSON file')
+
+def add_compare_arguments(p):
+    p.add_argument('base')
+    p.add_argument('new')
+    p.add_argument('--threshold', type=float, default=5.0,
+                   help='regression threshold in percent')
+    p.add_argument('--min-diff', type=float, default=10.0,
+                   help='ignore differences less than this [ms]')
@@ -0,0 +1,968 @@
+/*
+ * kern_microbench.cu
+ *
+ * Micro-benchmark of the device functions in the pre-built GPU libraries.
+ * It runs the SQL functions over synthetic columns in KDS_FORMAT_ARROW or
+ * KDS_FORMAT_COLUMN, then reports the throughput in rows/s and GB/s.
+ * --
+ * Copyright 2011-2021 (C) KaiGai Kohei <kaigai@kaigai.gr.jp>
+ * Copyright 2014-2021 (C) PG-Strom Developers Team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the PostgreSQL License.
+ */
+#define KERN_CONTEXT_VARLENA_BUFSZ		512
+#define KERN_CONTEXT_STACK_LIMIT		8192
+#include "cuda_common.h"
+#include "cuda_primitive.h"
+#include "cuda_jsonlib.h"
+#include "cuda_postgis.h"
+#include <getopt.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ----------------------------------------------------------------
+ *
+ * Session information; usually, constructed by pgstrom_build_session_info
+ * on run-time compilation. Microbench assumes UTF-8 and UTC.
+ *
+ * ----------------------------------------------------------------
+ */
+DEVICE_FUNCTION(cl_int)
+pg_database_encoding_max_length(void)
+{
+	return 4;
+}
+
+DEVICE_FUNCTION(cl_int)
+pg_wchar_mblen(const char *str)
+{
+	cl_uchar	c = *((const cl_uchar *)str);
+
+	if ((c & 0x80) == 0)
+		return 1;
+	else if ((c & 0xe0) == 0xc0)
+		return 2;
+	else if ((c & 0xf0) == 0xe0)
+		return 3;
+	else if ((c & 0xf8) == 0xf0)
+		return 4;
+	return 1;
+}
+
+DEVICE_FUNCTION(Timestamp)
+SetEpochTimestamp(void)
+{
+	return -946684800000000LL;
+}
+
+static __device__ cl_long	__session_timezone_state_ats[] = { 0 };
+static __device__ cl_uchar	__session_timezone_state_types[] = { 0 };
+static __device__ tz_ttinfo	__session_timezone_state_ttis[] = {
+	{ 0, false, 0, false, false },
+};
+static __device__ tz_lsinfo	__session_timezone_state_lsis[] = {
+	{ 0, 0 },
+};
+__device__ const tz_state	session_timezone_state =
+{
+	0,		/* leapcnt */
+	0,		/* timecnt */
+	1,		/* typecnt */
+	4,		/* charcnt */
+	false,	/* goback */
+	false,	/* goahead */
+	__session_timezone_state_ats,
+	__session_timezone_state_types,
+	__session_timezone_state_ttis,
+	__session_timezone_state_lsis,
+	0,		/* defaulttype */
+};
+
+DEVICE_FUNCTION(cl_uint)
+pg_extras_array_from_arrow(kern_context *kcxt, char *dest,
+						   kern_colmeta *smeta, char *base,
+						   cl_uint start, cl_uint end)
+{
+	return 0;
+}
+
+DEVICE_FUNCTION(cl_bool)
+pg_extras_composite_from_arrow(kern_context *kcxt,
+							   kern_colmeta *smeta,
+							   char *base, cl_uint rowidx,
+							   cl_char *p_dclass,
+							   Datum *p_datum)
+{
+	return false;
+}
+
+/* ----------------------------------------------------------------
+ *
+ * Layout of the synthetic data stores
+ *
+ * Columns 0-4 are common for both of the formats, so a benchmark function
+ * can run on either of them. The latter columns are format specific, because
+ * numeric and timestamp are usually supplied by Arrow_Fdw, and jsonb is not
+ * supported by Arrow_Fdw.
+ *
+ * ----------------------------------------------------------------
+ */
+#define MB_COL__INT8_A		0
+#define MB_COL__INT8_B		1
+#define MB_COL__FLOAT8_X	2
+#define MB_COL__FLOAT8_Y	3
+#define MB_COL__TEXT		4
+#define MB_COL__NUMERIC_A	5	/* arrow only */
+#define MB_COL__NUMERIC_B	6	/* arrow only */
+#define MB_COL__TIMESTAMP	7	/* arrow only */
+#define MB_COL__JSONB		5	/* column only */
+#define MB_NCOLS_ARROW		8
+#define MB_NCOLS_COLUMN		6
+
+struct mbench_fetch_arrow
+{
+	template <typename T>
+	__device__ static void
+	ref(kern_context *kcxt, T &result,
+		kern_data_store *kds, kern_data_extra *extra,
+		cl_uint colidx, cl_uint rowidx)
+	{
+		pg_datum_ref_arrow(kcxt, result, kds, colidx, rowidx);
+	}
+};
+
+struct mbench_fetch_column
+{
+	template <typename T>
+	__device__ static void
+	ref(kern_context *kcxt, T &result,
+		kern_data_store *kds, kern_data_extra *extra,
+		cl_uint colidx, cl_uint rowidx)
+	{
+		void   *addr = kern_get_datum_column(kds, extra, colidx, rowidx);
+
+		pg_datum_ref(kcxt, result, addr);
+	}
+};
+
+DEVICE_INLINE(pg_text_t)
+mbench_cstring_to_text(const char *str, cl_int length)
+{
+	pg_text_t	result;
+
+	result.isnull = false;
+	result.value  = (char *)str;
+	result.length = length;
+
+	return result;
+}
+
+/*
+ * Benchmark functions; each returns a checksum of the result to prevent
+ * the compiler from eliminating the function invocation.
+ */
+template <class FETCH>
+struct mbench_int8pl
+{
+	__device__ cl_ulong
+	operator()(kern_context *kcxt, kern_data_store *kds,
+			   kern_data_extra *extra, cl_uint rowidx)
+	{
+		pg_int8_t	a, b, r;
+
+		FETCH::ref(kcxt, a, kds, extra, MB_COL__INT8_A, rowidx);
+		FETCH::ref(kcxt, b, kds, extra, MB_COL__INT8_B, rowidx);
+		r = pgfn_int8pl(kcxt, a, b);
+		return (r.isnull ? 0 : (cl_ulong)r.value);
+	}
+};
+
+template <class FETCH>
+struct mbench_float8mul
+{
+	__device__ cl_ulong
+	operator()(kern_context *kcxt, kern_data_store *kds,
+			   kern_data_extra *extra, cl_uint rowidx)
+	{
+		pg_float8_t	x, y, r;
+
+		FETCH::ref(kcxt, x, kds, extra, MB_COL__FLOAT8_X, rowidx);
+		FETCH::ref(kcxt, y, kds, extra, MB_COL__FLOAT8_Y, rowidx);
+		r = pgfn_float8mul(kcxt, x, y);
+		return (r.isnull ? 0 : (cl_ulong)__double_as_longlong(r.value));
+	}
+};
+
+template <class FETCH>
+struct mbench_texteq
+{
+	__device__ cl_ulong
+	operator()(kern_context *kcxt, kern_data_store *kds,
+			   kern_data_extra *extra, cl_uint rowidx)
+	{
+		pg_text_t	t;
+		pg_bool_t	r;
+
+		FETCH::ref(kcxt, t, kds, extra, MB_COL__TEXT, rowidx);
+		r = pgfn_texteq(kcxt, t, mbench_cstring_to_text("kmbexabcqt", 10));
+		return (!r.isnull && r.value ? 1 : 0);
+	}
+};
+
+template <class FETCH>
+struct mbench_textlike
+{
+	__device__ cl_ulong
+	operator()(kern_context *kcxt, kern_data_store *kds,
+			   kern_data_extra *extra, cl_uint rowidx)
+	{
+		pg_text_t	t;
+		pg_bool_t	r;
+
+		FETCH::ref(kcxt, t, kds, extra, MB_COL__TEXT, rowidx);
+		r = pgfn_textlike(kcxt, t, mbench_cstring_to_text("%abc%", 5));
+		return (!r.isnull && r.value ? 1 : 0);
+	}
+};
+
+template <class FETCH>
+struct mbench_st_dwithin
+{
+	__device__ cl_ulong
+	operator()(kern_context *kcxt, kern_data_store *kds,
+			   kern_data_extra *extra, cl_uint rowidx)
+	{
+		pg_float8_t	x, y, cx, cy, dist;
+		pg_geometry_t g1, g2;
+		pg_bool_t	r;
+
+		FETCH::ref(kcxt, x, kds, extra, MB_COL__FLOAT8_X, rowidx);
+		FETCH::ref(kcxt, y, kds, extra, MB_COL__FLOAT8_Y, rowidx);
+		cx.isnull = false;
+		cx.value = 500.0;
+		cy.isnull = false;
+		cy.value = 500.0;
+		dist.isnull = false;
+		dist.value = 250.0;
+		g1 = pgfn_st_makepoint2(kcxt, x, y);
+		g2 = pgfn_st_makepoint2(kcxt, cx, cy);
+		r = pgfn_st_dwithin(kcxt, g1, g2, dist);
+		return (!r.isnull && r.value ? 1 : 0);
+	}
+};
+
+struct mbench_numeric_add
+{
+	__device__ cl_ulong
+	operator()(kern_context *kcxt, kern_data_store *kds,
+			   kern_data_extra *extra, cl_uint rowidx)
+	{
+		pg_numeric_t a, b, r;
+		cl_ulong	lo;
+
+		mbench_fetch_arrow::ref(kcxt, a, kds, extra, MB_COL__NUMERIC_A, rowidx);
+		mbench_fetch_arrow::ref(kcxt, b, kds, extra, MB_COL__NUMERIC_B, rowidx);
+		r = pgfn_numeric_add(kcxt, a, b);
+		if (r.isnull)
+			return 0;
+		memcpy(&lo, &r.value, sizeof(cl_ulong));
+		return lo;
+	}
+};
+
+struct mbench_numeric_mul
+{
+	__device__ cl_ulong
+	operator()(kern_context *kcxt, kern_data_store *kds,
+			   kern_data_extra *extra, cl_uint rowidx)
+	{
+		pg_numeric_t a, b, r;
+		cl_ulong	lo;
+
+		mbench_fetch_arrow::ref(kcxt, a, kds, extra, MB_COL__NUMERIC_A, rowidx);
+		mbench_fetch_arrow::ref(kcxt, b, kds, extra, MB_COL__NUMERIC_B, rowidx);
+		r = pgfn_numeric_mul(kcxt, a, b);
+		if (r.isnull)
+			return 0;
+		memcpy(&lo, &r.value, sizeof(cl_ulong));
+		return lo;
+	}
+};
+
+struct mbench_date_part
+{
+	__device__ cl_ulong
+	operator()(kern_context *kcxt, kern_data_store *kds,
+			   kern_data_extra *extra, cl_uint rowidx)
+	{
+		pg_timestamp_t ts;
+		pg_float8_t	r;
+
+		mbench_fetch_arrow::ref(kcxt, ts, kds, extra, MB_COL__TIMESTAMP, rowidx);
+		r = pgfn_date_part_timestamp(kcxt, mbench_cstring_to_text("year", 4), ts);
+		return (r.isnull ? 0 : (cl_ulong)r.value);
+	}
+};
+
+struct mbench_jsonb_field_text
+{
+	__device__ cl_ulong
+	operator()(kern_context *kcxt, kern_data_store *kds,
+			   kern_data_extra *extra, cl_uint rowidx)
+	{
+		pg_jsonb_t	j;
+		pg_text_t	r;
+
+		mbench_fetch_column::ref(kcxt, j, kds, extra, MB_COL__JSONB, rowidx);
+		r = pgfn_jsonb_object_field_text(kcxt, j, mbench_cstring_to_text("b", 1));
+		return (r.isnull ? 0 : (cl_ulong)r.length);
+	}
+};
+
+/*
+ * kern_microbench_main - the benchmark kernel; it applies FUNC on every row
+ */
+template <class FUNC>
+__global__ void
+kern_microbench_main(kern_data_store *kds,
+					 kern_data_extra *extra,
+					 kern_errorbuf *kerror,
+					 cl_ulong *p_checksum)
+{
+	FUNC		func;
+	union {
+		kern_context kcxt;
+		char	__dummy__[sizeof(kern_context) +
+						  MAXALIGN(KERN_CONTEXT_VARLENA_BUFSZ)];
+	} __kcxt;
+	kern_context *kcxt = &__kcxt.kcxt;
+	cl_ulong	checksum = 0;
+	cl_uint		index;
+
+	INIT_KERNEL_CONTEXT(kcxt, NULL);
+	for (index = get_global_id();
+		 index < kds->nitems;
+		 index += get_global_size())
+	{
+		kcxt->vlpos = kcxt->vlbuf;		/* rewind */
+		checksum += func(kcxt, kds, extra, index);
+	}
+	atomicAdd(p_checksum, checksum);
+	kern_writeback_error_status(kerror, kcxt);
+}
+
+/* ----------------------------------------------------------------
+ *
+ * Host code
+ *
+ * ----------------------------------------------------------------
+ */
+typedef struct
+{
+	const char *fname;
+	const char *layout;			/* "arrow" or "column" */
+	cudaError_t (*launch)(kern_data_store *kds,
+						  kern_data_extra *extra,
+						  kern_errorbuf *kerror,
+						  cl_ulong *p_checksum);
+	int			refcols[3];		/* referenced columns, -1 terminated */
+} mbench_entry;
+
+template <class FUNC>
+static cudaError_t
+mbench_launch(kern_data_store *kds,
+			  kern_data_extra *extra,
+			  kern_errorbuf *kerror,
+			  cl_ulong *p_checksum)
+{
+	int			grid_sz;
+	int			block_sz;
+	cudaError_t	rc;
+
+	rc = cudaOccupancyMaxPotentialBlockSize(&grid_sz, &block_sz,
+											kern_microbench_main<FUNC>);
+	if (rc != cudaSuccess)
+		return rc;
+	kern_microbench_main<FUNC><<<grid_sz, block_sz>>>(kds, extra,
+													  kerror, p_checksum);
+	return cudaGetLastError();
+}
+
+#define MB_ARROW	"arrow"
+#define MB_COLUMN	"column"
+static mbench_entry	mbench_catalog[] = {
+	{ "int8pl",           MB_ARROW,  mbench_launch<mbench_int8pl<mbench_fetch_arrow> >,
+	  { MB_COL__INT8_A, MB_COL__INT8_B, -1 } },
+	{ "int8pl",           MB_COLUMN, mbench_launch<mbench_int8pl<mbench_fetch_column> >,
+	  { MB_COL__INT8_A, MB_COL__INT8_B, -1 } },
+	{ "float8mul",        MB_ARROW,  mbench_launch<mbench_float8mul<mbench_fetch_arrow> >,
+	  { MB_COL__FLOAT8_X, MB_COL__FLOAT8_Y, -1 } },
+	{ "float8mul",        MB_COLUMN, mbench_launch<mbench_float8mul<mbench_fetch_column> >,
+	  { MB_COL__FLOAT8_X, MB_COL__FLOAT8_Y, -1 } },
+	{ "numeric_add",      MB_ARROW,  mbench_launch<mbench_numeric_add>,
+	  { MB_COL__NUMERIC_A, MB_COL__NUMERIC_B, -1 } },
+	{ "numeric_mul",      MB_ARROW,  mbench_launch<mbench_numeric_mul>,
+	  { MB_COL__NUMERIC_A, MB_COL__NUMERIC_B, -1 } },
+	{ "texteq",           MB_ARROW,  mbench_launch<mbench_texteq<mbench_fetch_arrow> >,
+	  { MB_COL__TEXT, -1 } },
+	{ "texteq",           MB_COLUMN, mbench_launch<mbench_texteq<mbench_fetch_column> >,
+	  { MB_COL__TEXT, -1 } },
+	{ "textlike",         MB_ARROW,  mbench_launch<mbench_textlike<mbench_fetch_arrow> >,
+	  { MB_COL__TEXT, -1 } },
+	{ "textlike",         MB_COLUMN, mbench_launch<mbench_textlike<mbench_fetch_column> >,
+	  { MB_COL__TEXT, -1 } },
+	{ "date_part",        MB_ARROW,  mbench_launch<mbench_date_part>,
+	  { MB_COL__TIMESTAMP, -1 } },
+	{ "jsonb_field_text", MB_COLUMN, mbench_launch<mbench_jsonb_field_text>,
+	  { MB_COL__JSONB, -1 } },
+	{ "st_dwithin",       MB_ARROW,  mbench_launch<mbench_st_dwithin<mbench_fetch_arrow> >,
+	  { MB_COL__FLOAT8_X, MB_COL__FLOAT8_Y, -1 } },
+	{ "st_dwithin",       MB_COLUMN, mbench_launch<mbench_st_dwithin<mbench_fetch_column> >,
+	  { MB_COL__FLOAT8_X, MB_COL__FLOAT8_Y, -1 } },
+	{ NULL, NULL, NULL, { -1 } },
+};
+
+/* command line options */
+static cl_uint		mb_nrows = 10000000;
+static int			mb_nloops = 10;
+static const char  *mb_filter = NULL;
+static const char  *mb_output = NULL;
+static const char  *mb_baseline = NULL;
+static double		mb_threshold = 5.0;
+/* consumption of the extra buffer by varlena columns of KDS_FORMAT_COLUMN */
+static size_t		mb_column_extra_usage[MB_NCOLS_COLUMN];
+
+#define elog(fmt,...)								\
+	do {											\
+		fprintf(stderr, "%s:%d " fmt "\n",			\
+				__FILE__, __LINE__, ##__VA_ARGS__);	\
+		exit(2);									\
+	} while(0)
+
+static void *
+mbench_alloc(size_t sz)
+{
+	void	   *ptr;
+	cudaError_t	rc;
+
+	rc = cudaMallocManaged(&ptr, sz, cudaMemAttachGlobal);
+	if (rc != cudaSuccess)
+		elog("failed on cudaMallocManaged(%zu): %s",
+			 sz, cudaGetErrorString(rc));
+	memset(ptr, 0, sz);
+	return ptr;
+}
+
+/* deterministic pseudo random number; results are comparable over runs */
+static cl_ulong		mb_random_seed = 0x2545f4914f6cdd1dUL;
+
+static cl_ulong
+mbench_random(void)
+{
+	mb_random_seed ^= mb_random_seed << 13;
+	mb_random_seed ^= mb_random_seed >> 7;
+	mb_random_seed ^= mb_random_seed << 17;
+	return mb_random_seed;
+}
+
+/*
+ * mbench_random_text - random lower-case string in 8-24 bytes; one of 16
+ * strings contains the "abc" token for LIKE operator.
+ */
+static int
+mbench_random_text(char *buf)
+{
+	int		len = 8 + mbench_random() % 17;
+	int		i;
+
+	for (i=0; i < len; i++)
+		buf[i] = 'a' + mbench_random() % 26;
+	if (mbench_random() % 16 == 0)
+		memcpy(buf + mbench_random() % (len - 3), "abc", 3);
+	return len;
+}
+
+/*
+ * mbench_random_jsonb - binary jsonb of {"a":<text>, "b":<text>}
+ */
+static int
+mbench_random_jsonb(char *buf)
+{
+	char		temp[2][32];
+	int			tlen[2];
+	cl_uint	   *children;
+	char	   *pos;
+	int			i;
+
+	for (i=0; i < 2; i++)
+		tlen[i] = mbench_random_text(temp[i]);
+	/* JsonbContainer header; object with 2 pairs */
+	((cl_uint *)buf)[1] = 2 | 0x20000000U;		/* JB_FOBJECT */
+	/* JEntry of keys and values; length of string */
+	children = (cl_uint *)(buf + 2 * sizeof(cl_uint));
+	children[0] = 1;
+	children[1] = 1;
+	children[2] = tlen[0];
+	children[3] = tlen[1];
+	pos = (char *)(children + 4);
+	*pos++ = 'a';
+	*pos++ = 'b';
+	for (i=0; i < 2; i++)
+	{
+		memcpy(pos, temp[i], tlen[i]);
+		pos += tlen[i];
+	}
+	SET_VARSIZE(buf, pos - buf);
+	return pos - buf;
+}
+
+static void
+mbench_init_colmeta(kern_colmeta *cmeta, const char *attname,
+					cl_short attlen, cl_char attalign, int colidx)
+{
+	memset(cmeta, 0, sizeof(kern_colmeta));
+	cmeta->attbyval = (attlen > 0 && attlen <= sizeof(Datum));
+	cmeta->attalign = attalign;
+	cmeta->attlen = attlen;
+	cmeta->attnum = colidx + 1;
+	cmeta->attcacheoff = -1;
+	cmeta->atttypkind = TYPE_KIND__BASE;
+	strncpy(cmeta->attname.data, attname, NAMEDATALEN);
+}
+
+static kern_data_store *
+mbench_build_arrow(void)
+{
+	kern_data_store *kds;
+	kern_colmeta   *cmeta;
+	size_t		head_sz;
+	size_t		extra_sz = (size_t)mb_nrows * 24;
+	size_t		length;
+	size_t		offset;
+	char	   *extra;
+	cl_uint	   *text_offset;
+	cl_uint		i, j;
+	struct {
+		const char *attname;
+		cl_short	unitsz;
+		cl_short	attlen;
+	} catalog[MB_NCOLS_ARROW] = {
+		{ "int8_a",    sizeof(cl_long),    sizeof(cl_long) },
+		{ "int8_b",    sizeof(cl_long),    sizeof(cl_long) },
+		{ "float8_x",  sizeof(cl_double),  sizeof(cl_double) },
+		{ "float8_y",  sizeof(cl_double),  sizeof(cl_double) },
+		{ "text",      sizeof(cl_uint),    -1 },
+		{ "numeric_a", 2*sizeof(cl_ulong), -1 },
+		{ "numeric_b", 2*sizeof(cl_ulong), -1 },
+		{ "timestamp", sizeof(cl_long),    sizeof(cl_long) },
+	};
+
+	head_sz = STROMALIGN(offsetof(kern_data_store,
+								  colmeta[MB_NCOLS_ARROW]));
+	length = head_sz + MAXALIGN(extra_sz);
+	for (j=0; j < MB_NCOLS_ARROW; j++)
+		length += MAXALIGN(catalog[j].unitsz * (size_t)(mb_nrows + 1));
+	kds = (kern_data_store *)mbench_alloc(length);
+	kds->length = length;
+	kds->nitems = mb_nrows;
+	kds->nrooms = mb_nrows;
+	kds->ncols  = MB_NCOLS_ARROW;
+	kds->format = KDS_FORMAT_ARROW;
+	kds->has_varlena = true;
+	kds->nr_colmeta = MB_NCOLS_ARROW;
+
+	offset = head_sz;
+	for (j=0; j < MB_NCOLS_ARROW; j++)
+	{
+		size_t	sz = MAXALIGN(catalog[j].unitsz * (size_t)(mb_nrows + 1));
+
+		cmeta = &kds->colmeta[j];
+		mbench_init_colmeta(cmeta, catalog[j].attname, catalog[j].attlen,
+							catalog[j].attlen > 0 ? catalog[j].attlen
+												  : sizeof(cl_int), j);
+		cmeta->values_offset = __kds_packed(offset);
+		cmeta->values_length = __kds_packed(sz);
+		offset += sz;
+	}
+	/* numeric(12,2) as Decimal128 */
+	kds->colmeta[MB_COL__NUMERIC_A].attopts.decimal.precision = 12;
+	kds->colmeta[MB_COL__NUMERIC_A].attopts.decimal.scale = 2;
+	kds->colmeta[MB_COL__NUMERIC_B].attopts.decimal.precision = 12;
+	kds->colmeta[MB_COL__NUMERIC_B].attopts.decimal.scale = 2;
+	/* timestamp in microseconds */
+	kds->colmeta[MB_COL__TIMESTAMP].attopts.timestamp.unit
+		= ArrowTimeUnit__MicroSecond;
+	/* extra buffer of the text column */
+	cmeta = &kds->colmeta[MB_COL__TEXT];
+	cmeta->extra_offset = __kds_packed(offset);
+	cmeta->extra_length = __kds_packed(MAXALIGN(extra_sz));
+	extra = (char *)kds + offset;
+	text_offset = (cl_uint *)((char *)kds +
+							  __kds_unpack(cmeta->values_offset));
+
+	/* fill up the values */
+	text_offset[0] = 0;
+	for (i=0; i < mb_nrows; i++)
+	{
+		cl_long	   *ival;
+		cl_double  *fval;
+		cl_ulong   *dval;
+
+		for (j=MB_COL__INT8_A; j <= MB_COL__INT8_B; j++)
+		{
+			ival = (cl_long *)((char *)kds + __kds_unpack(kds->colmeta[j].values_offset));
+			ival[i] = mbench_random() % 1000000;
+		}
+		for (j=MB_COL__FLOAT8_X; j <= MB_COL__FLOAT8_Y; j++)
+		{
+			fval = (cl_double *)((char *)kds + __kds_unpack(kds->colmeta[j].values_offset));
+			fval[i] = (double)(mbench_random() % 1000000) / 1000.0;
+		}
+		for (j=MB_COL__NUMERIC_A; j <= MB_COL__NUMERIC_B; j++)
+		{
+			dval = (cl_ulong *)((char *)kds + __kds_unpack(kds->colmeta[j].values_offset));
+			dval[2*i]   = mbench_random() % 100000000UL;	/* lo */
+			dval[2*i+1] = 0;								/* hi */
+		}
+		ival = (cl_long *)((char *)kds + __kds_unpack(kds->colmeta[MB_COL__TIMESTAMP].values_offset));
+		/* 1990-01-01 ... 2030-01-01 */
+		ival[i] = (631152000L + mbench_random() % 1262304000L) * 1000000L;
+
+		text_offset[i+1] = text_offset[i] + mbench_random_text(extra + text_offset[i]);
+	}
+	return kds;
+}
+
+static kern_data_store *
+mbench_build_column(kern_data_extra **p_extra)
+{
+	kern_data_store *kds;
+	kern_data_extra *extra;
+	kern_colmeta   *cmeta;
+	size_t		head_sz;
+	size_t		extra_sz;
+	size_t		length;
+	size_t		offset;
+	cl_uint		i, j;
+	struct {
+		const char *attname;
+		cl_short	attlen;
+	} catalog[MB_NCOLS_COLUMN] = {
+		{ "int8_a",    sizeof(cl_long) },
+		{ "int8_b",    sizeof(cl_long) },
+		{ "float8_x",  sizeof(cl_double) },
+		{ "float8_y",  sizeof(cl_double) },
+		{ "text",      -1 },
+		{ "jsonb",     -1 },
+	};
+
+	head_sz = STROMALIGN(offsetof(kern_data_store,
+								  colmeta[MB_NCOLS_COLUMN]));
+	length = head_sz;
+	for (j=0; j < MB_NCOLS_COLUMN; j++)
+		length += MAXALIGN((catalog[j].attlen > 0
+							? catalog[j].attlen
+							: sizeof(cl_uint)) * (size_t)mb_nrows);
+	kds = (kern_data_store *)mbench_alloc(length);
+	kds->length = length;
+	kds->nitems = mb_nrows;
+	kds->nrooms = mb_nrows;
+	kds->ncols  = MB_NCOLS_COLUMN;
+	kds->format = KDS_FORMAT_COLUMN;
+	kds->has_varlena = true;
+	kds->nr_colmeta = MB_NCOLS_COLUMN;
+
+	offset = head_sz;
+	for (j=0; j < MB_NCOLS_COLUMN; j++)
+	{
+		cl_short	attlen = catalog[j].attlen;
+		size_t		sz = MAXALIGN((attlen > 0 ? attlen : sizeof(cl_uint)) *
+								  (size_t)mb_nrows);
+		cmeta = &kds->colmeta[j];
+		mbench_init_colmeta(cmeta, catalog[j].attname, attlen,
+							attlen > 0 ? attlen : sizeof(cl_int), j);
+		cmeta->values_offset = __kds_packed(offset);
+		cmeta->values_length = __kds_packed(sz);
+		offset += sz;
+	}
+	/* text (up to 24 bytes) and jsonb (up to 80 bytes) in the extra buffer */
+	extra_sz = offsetof(kern_data_extra, data) +
+		(MAXALIGN(VARHDRSZ + 24) + MAXALIGN(VARHDRSZ + 80)) * (size_t)mb_nrows;
+	extra = (kern_data_extra *)mbench_alloc(extra_sz);
+	extra->length = extra_sz;
+	extra->usage = offsetof(kern_data_extra, data);
+
+	for (i=0; i < mb_nrows; i++)
+	{
+		cl_long	   *ival;
+		cl_double  *fval;
+		cl_uint	   *vofs;
+		char	   *vl;
+		int			sz;
+
+		for (j=MB_COL__INT8_A; j <= MB_COL__INT8_B; j++)
+		{
+			ival = (cl_long *)((char *)kds + __kds_unpack(kds->colmeta[j].values_offset));
+			ival[i] = mbench_random() % 1000000;
+		}
+		for (j=MB_COL__FLOAT8_X; j <= MB_COL__FLOAT8_Y; j++)
+		{
+			fval = (cl_double *)((char *)kds + __kds_unpack(kds->colmeta[j].values_offset));
+			fval[i] = (double)(mbench_random() % 1000000) / 1000.0;
+		}
+		/* text */
+		vofs = (cl_uint *)((char *)kds + __kds_unpack(kds->colmeta[MB_COL__TEXT].values_offset));
+		vl = (char *)extra + extra->usage;
+		sz = mbench_random_text(vl + VARHDRSZ);
+		SET_VARSIZE(vl, VARHDRSZ + sz);
+		vofs[i] = __kds_packed(extra->usage);
+		extra->usage += MAXALIGN(VARHDRSZ + sz);
+		mb_column_extra_usage[MB_COL__TEXT] += MAXALIGN(VARHDRSZ + sz);
+		/* jsonb */
+		vofs = (cl_uint *)((char *)kds + __kds_unpack(kds->colmeta[MB_COL__JSONB].values_offset));
+		vl = (char *)extra + extra->usage;
+		sz = mbench_random_jsonb(vl);
+		vofs[i] = __kds_packed(extra->usage);
+		extra->usage += MAXALIGN(sz);
+		mb_column_extra_usage[MB_COL__JSONB] += MAXALIGN(sz);
+	}
+	*p_extra = extra;
+	return kds;
+}
+
+/*
+ * mbench_scan_bytes - bytes to be scanned per run by the benchmark function
+ */
+static size_t
+mbench_scan_bytes(mbench_entry *entry, kern_data_store *kds)
+{
+	size_t		total = 0;
+	int			i;
+
+	for (i=0; entry->refcols[i] >= 0; i++)
+	{
+		kern_colmeta   *cmeta = &kds->colmeta[entry->refcols[i]];
+
+		total += __kds_unpack(cmeta->values_length);
+		if (kds->format == KDS_FORMAT_ARROW)
+			total += __kds_unpack(cmeta->extra_length);
+		else
+			total += mb_column_extra_usage[entry->refcols[i]];
+	}
+	return total;
+}
+
+static int
+mbench_compare_float(const void *a, const void *b)
+{
+	float	fa = *((const float *)a);
+	float	fb = *((const float *)b);
+
+	return (fa < fb ? -1 : (fa > fb ? 1 : 0));
+}
+
+/*
+ * mbench_baseline_lookup - rows/s of the function in the baseline file
+ */
+static double
+mbench_baseline_lookup(FILE *filp, const char *fname, const char *layout)
+{
+	char		linebuf[1024];
+	char		b_fname[256];
+	char		b_layout[64];
+	double		b_rows_per_sec;
+
+	if (!filp)
+		return -1.0;
+	rewind(filp);
+	while (fgets(linebuf, sizeof(linebuf), filp) != NULL)
+	{
+		if (linebuf[0] == '#')
+			continue;
+		if (sscanf(linebuf, "%255s %63s %*u %*f %lf",
+				   b_fname, b_layout, &b_rows_per_sec) == 3 &&
+			strcmp(b_fname, fname) == 0 &&
+			strcmp(b_layout, layout) == 0)
+			return b_rows_per_sec;
+	}
+	return -1.0;
+}
+
+static void
+usage(const char *command)
+{
+	fprintf(stderr,
+			"usage: %s [options]\n"
+			"\n"
+			"Options:\n"
+			"  -n NROWS     number of rows (default: 10000000)\n"
+			"  -l NLOOPS    number of measured runs (default: 10)\n"
+			"  -f FUNC      run only the functions containing FUNC\n"
+			"  -o FILE      write out the result to FILE\n"
+			"  -b FILE      compare the result with the baseline FILE\n"
+			"  -t PERCENT   threshold of regression (default: 5.0)\n"
+			"  -d DEVICE    CUDA device ordinal (default: 0)\n"
+			"  -h           print this message\n",
+			command);
+	exit(1);
+}
+
+int main(int argc, char * const argv[])
+{
+	kern_data_store *kds_arrow;
+	kern_data_store *kds_column;
+	kern_data_extra *extra;
+	kern_errorbuf  *kerror;
+	cl_ulong	   *checksum;
+	cudaEvent_t		ev_start;
+	cudaEvent_t		ev_stop;
+	cudaDeviceProp	dprop;
+	cudaError_t		rc;
+	FILE		   *f_output = NULL;
+	FILE		   *f_baseline = NULL;
+	float		   *elapsed;
+	int				device_id = 0;
+	int				nregressions = 0;
+	int				c, i, k;
+
+	while ((c = getopt(argc, argv, "n:l:f:o:b:t:d:h")) >= 0)
+	{
+		switch (c)
+		{
+			case 'n':
+				mb_nrows = atol(optarg);
+				break;
+			case 'l':
+				mb_nloops = atoi(optarg);
+				break;
+			case 'f':
+				mb_filter = optarg;
+				break;
+			case 'o':
+				mb_output = optarg;
+				break;
+			case 'b':
+				mb_baseline = optarg;
+				break;
+			case 't':
+				mb_threshold = atof(optarg);
+				break;
+			case 'd':
+				device_id = atoi(optarg);
+				break;
+			default:
+				usage(argv[0]);
+		}
+	}
+	if (optind != argc || mb_nrows == 0 || mb_nloops < 1)
+		usage(argv[0]);
+
+	rc = cudaSetDevice(device_id);
+	if (rc != cudaSuccess)
+		elog("failed on cudaSetDevice: %s", cudaGetErrorString(rc));
+	rc = cudaGetDeviceProperties(&dprop, device_id);
+	if (rc != cudaSuccess)
+		elog("failed on cudaGetDeviceProperties: %s", cudaGetErrorString(rc));
+	if (mb_output)
+	{
+		f_output = fopen(mb_output, "w");
+		if (!f_output)
+			elog("failed to open '%s': %m", mb_output);
+		fprintf(f_output, "# device: %s, nrows: %u, nloops: %d\n",
+				dprop.name, mb_nrows, mb_nloops);
+		fprintf(f_output, "# function\tlayout\tnrows\tmsec\trows_per_sec\tgb_per_sec\n");
+	}
+	if (mb_baseline)
+	{
+		f_baseline = fopen(mb_baseline, "r");
+		if (!f_baseline)
+			elog("failed to open '%s': %m", mb_baseline);
+	}
+
+	kds_arrow  = mbench_build_arrow();
+	kds_column = mbench_build_column(&extra);
+	kerror     = (kern_errorbuf *)mbench_alloc(sizeof(kern_errorbuf));
+	checksum   = (cl_ulong *)mbench_alloc(sizeof(cl_ulong));
+	elapsed    = (float *)calloc(mb_nloops, sizeof(float));
+	if (!elapsed)
+		elog("out of memory");
+	cudaEventCreate(&ev_start);
+	cudaEventCreate(&ev_stop);
+
+	printf("device: %s, nrows: %u, nloops: %d\n",
+		   dprop.name, mb_nrows, mb_nloops);
+	printf("%-18s %-7s %10s %14s %9s %s\n",
+		   "function", "layout", "msec", "rows/s", "GB/s", "checksum");
+	for (i=0; mbench_catalog[i].fname != NULL; i++)
+	{
+		mbench_entry   *entry = &mbench_catalog[i];
+		kern_data_store *kds;
+		size_t			nbytes;
+		double			msec, rows_per_sec, gb_per_sec, base;
+
+		if (mb_filter && !strstr(entry->fname, mb_filter))
+			continue;
+		kds = (strcmp(entry->layout, MB_ARROW) == 0 ? kds_arrow : kds_column);
+		nbytes = mbench_scan_bytes(entry, kds);
+
+		/* warm-up run; also moves the managed memory onto the device */
+		for (k=-1; k < mb_nloops; k++)
+		{
+			memset(kerror, 0, sizeof(kern_errorbuf));
+			*checksum = 0;
+			cudaEventRecord(ev_start);
+			rc = entry->launch(kds, extra, kerror, checksum);
+			if (rc != cudaSuccess)
+				elog("failed on kernel launch (%s): %s",
+					 entry->fname, cudaGetErrorString(rc));
+			cudaEventRecord(ev_stop);
+			rc = cudaEventSynchronize(ev_stop);
+			if (rc != cudaSuccess)
+				elog("failed on kernel execution (%s): %s",
+					 entry->fname, cudaGetErrorString(rc));
+			if (kerror->errcode != ERRCODE_STROM_SUCCESS)
+				elog("%s (%s) raised an error: %s (%s:%d)",
+					 entry->fname, entry->layout, kerror->message,
+					 kerror->filename, kerror->lineno);
+			if (k >= 0)
+				cudaEventElapsedTime(&elapsed[k], ev_start, ev_stop);
+		}
+		qsort(elapsed, mb_nloops, sizeof(float), mbench_compare_float);
+		msec = elapsed[mb_nloops / 2];
+		rows_per_sec = (double)mb_nrows / (msec / 1000.0);
+		gb_per_sec = (double)nbytes / (msec / 1000.0) / 1.0e9;
+
+		printf("%-18s %-7s %10.3f %14.0f %9.2f %016llx",
+			   entry->fname, entry->layout, msec,
+			   rows_per_sec, gb_per_sec, *checksum);
+		base = mbench_baseline_lookup(f_baseline, entry->fname, entry->layout);
+		if (base > 0.0)
+		{
+			double	diff = 100.0 * (rows_per_sec - base) / base;
+
+			printf(" %+.1f%%", diff);
+			if (diff < -mb_threshold)
+			{
+				printf(" REGRESSION");
+				nregressions++;
+			}
+		}
+		putchar('\n');
+		if (f_output)
+			fprintf(f_output, "%s\t%s\t%u\t%.3f\t%.0f\t%.3f\n",
+					entry->fname, entry->layout, mb_nrows,
+					msec, rows_per_sec, gb_per_sec);
+	}
+	if (f_output)
+		fclose(f_output);
+	if (f_baseline)
+		fclose(f_baseline);
+	if (nregressions > 0)
+	{
+		fprintf(stderr, "%d function(s) are slower than the baseline by %.1f%%\n",
+				nregressions, mb_threshold);
+		return 1;
+	}
+	return 0;
+}
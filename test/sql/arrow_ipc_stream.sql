@@ -0,0 +1,94 @@
+---
+--- Test for pgstrom.arrow_ipc_stream()
+---
+SET pg_strom.regression_test_mode = on;
+SET client_min_messages = error;
+DROP SCHEMA IF EXISTS regtest_arrow_ipc_stream_temp CASCADE;
+CREATE SCHEMA regtest_arrow_ipc_stream_temp;
+RESET client_min_messages;
+
+SET search_path = regtest_arrow_ipc_stream_temp,public;
+CREATE TABLE rt_data (
+  id    int,
+  a     int8,
+  b     float8,
+  c     text,
+  memo  text
+);
+ALTER TABLE rt_data ALTER memo SET STORAGE external;
+SELECT pgstrom.random_setseed(20211020);
+INSERT INTO rt_data (
+  SELECT x, pgstrom.random_int(1, -100000, 100000),
+            pgstrom.random_float(1, -1000.0, 1000.0),
+            pgstrom.random_text_len(1, 40),
+            pgstrom.random_text_len(1, 60)
+    FROM generate_series(1,100000) x);
+-- out-of-line values; device code cannot touch them without CPU fallback
+INSERT INTO rt_data (
+  SELECT x, pgstrom.random_int(1, -100000, 100000),
+            pgstrom.random_float(1, -1000.0, 1000.0),
+            pgstrom.random_text_len(1, 40),
+            repeat(md5(x::text), 200)
+    FROM generate_series(100001,100100) x);
+
+-- force to use GpuScan, instead of SeqScan
+SET enable_seqscan = off;
+SET max_parallel_workers_per_gather = 0;
+-- not to print kernel source code
+SET pg_strom.debug_kernel_source = off;
+
+-- Schema, a RecordBatch and EOS; every message begins with continuation
+SELECT count(*) cnt, bool_and(substring(chunk, 1, 4) = '\xffffffff') ok
+  FROM pgstrom.arrow_ipc_stream('SELECT id, a, b, c FROM rt_data WHERE id <= 10');
+SELECT chunk = '\xffffffff00000000' ok
+  FROM pgstrom.arrow_ipc_stream('SELECT id, a, b, c FROM rt_data WHERE id <= 10')
+       WITH ORDINALITY AS t(chunk, n)
+ ORDER BY n DESC LIMIT 1;
+-- empty result has Schema and EOS only
+SELECT count(*) cnt
+  FROM pgstrom.arrow_ipc_stream('SELECT id, a, b, c FROM rt_data WHERE false');
+-- RecordBatch is split by the batch size
+SELECT count(*) > 100 ok1, sum(length(chunk)) > 800000 ok2
+  FROM pgstrom.arrow_ipc_stream('SELECT a FROM rt_data', 4);
+SELECT count(*) FROM pgstrom.arrow_ipc_stream('SELECT a FROM rt_data', 1);	-- error
+SELECT count(*) FROM pgstrom.arrow_ipc_stream('DELETE FROM rt_data WHERE false');	-- error
+
+-- GpuScan and the CPU produce an identical stream
+SET pg_strom.enabled = on;
+SELECT n, chunk
+  INTO test01g
+  FROM pgstrom.arrow_ipc_stream('SELECT id, a, b, c FROM rt_data
+                                  WHERE b > 0.0 ORDER BY id', 64)
+       WITH ORDINALITY AS t(chunk, n);
+SET pg_strom.enabled = off;
+SELECT n, chunk
+  INTO test01p
+  FROM pgstrom.arrow_ipc_stream('SELECT id, a, b, c FROM rt_data
+                                  WHERE b > 0.0 ORDER BY id', 64)
+       WITH ORDINALITY AS t(chunk, n);
+(SELECT * FROM test01g EXCEPT SELECT * FROM test01p) ORDER BY n;
+(SELECT * FROM test01p EXCEPT SELECT * FROM test01g) ORDER BY n;
+
+-- GpuScan with CPU fallback
+SET pg_strom.enabled = on;
+SET pg_strom.cpu_fallback = on;
+SELECT n, chunk
+  INTO test02g
+  FROM pgstrom.arrow_ipc_stream('SELECT id, a, substring(memo, 1, 20) m
+                                   FROM rt_data
+                                  WHERE memo LIKE ''%abc%'' ORDER BY id', 64)
+       WITH ORDINALITY AS t(chunk, n);
+RESET pg_strom.cpu_fallback;
+SET pg_strom.enabled = off;
+SELECT n, chunk
+  INTO test02p
+  FROM pgstrom.arrow_ipc_stream('SELECT id, a, substring(memo, 1, 20) m
+                                   FROM rt_data
+                                  WHERE memo LIKE ''%abc%'' ORDER BY id', 64)
+       WITH ORDINALITY AS t(chunk, n);
+(SELECT * FROM test02g EXCEPT SELECT * FROM test02p) ORDER BY n;
+(SELECT * FROM test02p EXCEPT SELECT * FROM test02g) ORDER BY n;
+
+-- cleanup temporary resource
+SET client_min_messages = error;
+DROP SCHEMA regtest_arrow_ipc_stream_temp CASCADE;
@@ -91,6 +91,61 @@ SELECT id,z INTO test03p FROM regtest_data
 SET pg_strom.enabled = off;
 SELECT * FROM regtest_data WHERE null = ANY (x);
 
+-- array functions: cardinality / array_ndims / array_length
+UPDATE regtest_data
+   SET x = array[array[id, id+1], array[id+2, null]]
+ WHERE id % 17 = 5;
+UPDATE regtest_data
+   SET z = '{}'
+ WHERE id % 19 = 7;
+SET pg_strom.enabled = on;
+SELECT id, cardinality(x) x_card, array_ndims(x) x_ndims,
+           array_length(x, 1) x_len1, array_length(x, 2) x_len2,
+           cardinality(y) y_card, array_length(z, 1) z_len1,
+           array_ndims(z) z_ndims
+  INTO test05g
+  FROM regtest_data
+ WHERE id > 0;
+SET pg_strom.enabled = off;
+SELECT id, cardinality(x) x_card, array_ndims(x) x_ndims,
+           array_length(x, 1) x_len1, array_length(x, 2) x_len2,
+           cardinality(y) y_card, array_length(z, 1) z_len1,
+           array_ndims(z) z_ndims
+  INTO test05p
+  FROM regtest_data
+ WHERE id > 0;
+(SELECT * FROM test05g EXCEPT SELECT * FROM test05p) ORDER BY id;
+(SELECT * FROM test05p EXCEPT SELECT * FROM test05g) ORDER BY id;
+
+SET pg_strom.enabled = on;
+SELECT id INTO test06g FROM regtest_data
+ WHERE cardinality(x) > 3 OR array_length(z, 1) IS NULL;
+SET pg_strom.enabled = off;
+SELECT id INTO test06p FROM regtest_data
+ WHERE cardinality(x) > 3 OR array_length(z, 1) IS NULL;
+(SELECT * FROM test06g EXCEPT SELECT * FROM test06p) ORDER BY id;
+(SELECT * FROM test06p EXCEPT SELECT * FROM test06g) ORDER BY id;
+
+-- array functions with CPU fallback
+ALTER TABLE regtest_data ALTER x SET STORAGE external;
+UPDATE regtest_data
+   SET x = array(SELECT generate_series(1, 2000 + id % 100))
+ WHERE id % 100 = 11;
+SET pg_strom.enabled = on;
+SET pg_strom.cpu_fallback = on;
+SELECT id, cardinality(x) x_card, array_length(x, 1) x_len1
+  INTO test07g
+  FROM regtest_data
+ WHERE id > 0;
+RESET pg_strom.cpu_fallback;
+SET pg_strom.enabled = off;
+SELECT id, cardinality(x) x_card, array_length(x, 1) x_len1
+  INTO test07p
+  FROM regtest_data
+ WHERE id > 0;
+(SELECT * FROM test07g EXCEPT SELECT * FROM test07p) ORDER BY id;
+(SELECT * FROM test07p EXCEPT SELECT * FROM test07g) ORDER BY id;
+
 -- cleanup
 SET client_min_messages = error;
 DROP SCHEMA regtest_dexpr_scalar_array_op_temp CASCADE;
@@ -0,0 +1,100 @@
+--
+-- test for vector distance functions / operators
+--
+SET pg_strom.regression_test_mode = on;
+SET client_min_messages = error;
+DROP SCHEMA IF EXISTS regtest_dfunc_vector_temp CASCADE;
+CREATE SCHEMA regtest_dfunc_vector_temp;
+RESET client_min_messages;
+
+SET search_path = regtest_dfunc_vector_temp,public;
+CREATE TABLE rt_vector (
+  id   int,
+  a    float4[],   -- 16-dimension vector of integer values
+  b    float4[]    -- 16-dimension vector of integer values
+);
+SELECT pgstrom.random_setseed(20211019);
+INSERT INTO rt_vector (
+  SELECT x, array(SELECT pgstrom.random_int(0, -10, 10)::float4
+                    FROM generate_series(1, 16 + x * 0)),
+            array(SELECT pgstrom.random_int(0, -10, 10)::float4
+                    FROM generate_series(1, 16 + x * 0))
+    FROM generate_series(1,20000) x);
+UPDATE rt_vector SET a = NULL WHERE id % 53 = 0;
+UPDATE rt_vector SET b = array_fill(0.0::float4, array[16]) WHERE id % 59 = 0;
+
+-- force to use GpuScan, instead of SeqScan
+SET enable_seqscan = off;
+-- not to print kernel source code
+SET pg_strom.debug_kernel_source = off;
+
+-- distance functions and operators in projection
+SET pg_strom.enabled = on;
+SELECT id, a <-> b d1, a <#> b d2, round((a <=> b)::numeric, 12) d3,
+       l2_distance(a, '{1,2,3,4,5,6,7,8,8,7,6,5,4,3,2,1}') d4,
+       inner_product(a, '{1,2,3,4,5,6,7,8,8,7,6,5,4,3,2,1}') d5,
+       negative_inner_product(b, a) d6,
+       round(cosine_distance(b, b)::numeric, 12) d7
+  INTO test01g
+  FROM rt_vector
+ WHERE id > 0;
+SET pg_strom.enabled = off;
+SELECT id, a <-> b d1, a <#> b d2, round((a <=> b)::numeric, 12) d3,
+       l2_distance(a, '{1,2,3,4,5,6,7,8,8,7,6,5,4,3,2,1}') d4,
+       inner_product(a, '{1,2,3,4,5,6,7,8,8,7,6,5,4,3,2,1}') d5,
+       negative_inner_product(b, a) d6,
+       round(cosine_distance(b, b)::numeric, 12) d7
+  INTO test01p
+  FROM rt_vector
+ WHERE id > 0;
+(SELECT * FROM test01g EXCEPT SELECT * FROM test01p) ORDER BY id;
+(SELECT * FROM test01p EXCEPT SELECT * FROM test01g) ORDER BY id;
+
+-- distance operators in filter
+SET pg_strom.enabled = on;
+SELECT id
+  INTO test02g
+  FROM rt_vector
+ WHERE a <-> '{1,2,3,4,5,6,7,8,8,7,6,5,4,3,2,1}' < 30.5
+    OR a <#> b < -150.5
+    OR a <=> b > 1.75;
+SET pg_strom.enabled = off;
+SELECT id
+  INTO test02p
+  FROM rt_vector
+ WHERE a <-> '{1,2,3,4,5,6,7,8,8,7,6,5,4,3,2,1}' < 30.5
+    OR a <#> b < -150.5
+    OR a <=> b > 1.75;
+(SELECT * FROM test02g EXCEPT SELECT * FROM test02p) ORDER BY id;
+(SELECT * FROM test02p EXCEPT SELECT * FROM test02g) ORDER BY id;
+
+-- invalid vectors
+SET pg_strom.enabled = off;
+SELECT a <-> '{1,2,3}' FROM rt_vector WHERE id = 1;	-- error
+SELECT '{1,null,3}'::float4[] <-> '{1,2,3}';	-- error
+
+-- distance functions with CPU fallback
+ALTER TABLE rt_vector ALTER a SET STORAGE external;
+ALTER TABLE rt_vector ALTER b SET STORAGE external;
+UPDATE rt_vector
+   SET a = array(SELECT (x % 7)::float4 FROM generate_series(1, 1024) x),
+       b = array(SELECT (x % 5)::float4 FROM generate_series(1, 1024) x)
+ WHERE id % 100 = 7;
+SET pg_strom.enabled = on;
+SET pg_strom.cpu_fallback = on;
+SELECT id, a <-> b d1, a <#> b d2, round((a <=> b)::numeric, 12) d3
+  INTO test03g
+  FROM rt_vector
+ WHERE id > 0;
+RESET pg_strom.cpu_fallback;
+SET pg_strom.enabled = off;
+SELECT id, a <-> b d1, a <#> b d2, round((a <=> b)::numeric, 12) d3
+  INTO test03p
+  FROM rt_vector
+ WHERE id > 0;
+(SELECT * FROM test03g EXCEPT SELECT * FROM test03p) ORDER BY id;
+(SELECT * FROM test03p EXCEPT SELECT * FROM test03g) ORDER BY id;
+
+-- cleanup temporary resource
+SET client_min_messages = error;
+DROP SCHEMA regtest_dfunc_vector_temp CASCADE;
@@ -234,6 +234,61 @@ SELECT id, ((v)->>'num1')::numeric + ((v)->'comp'->>'ival')::numeric v1,
 (SELECT * FROM test06g EXCEPT SELECT * FROM test06p) ORDER BY id;
 (SELECT * FROM test06p EXCEPT SELECT * FROM test06g) ORDER BY id;
 
+-- jsonb containment operator (@>)
+SET pg_strom.enabled = on;
+SELECT id, v @> '{"bval" : true}' c1,
+           v @> '{"bval" : false, "ival" : null}' c2,
+           v @> '{}' c3,
+           v @> '[]' c4
+  INTO test07g
+  FROM rt_jsonb_o
+ WHERE id > 0;
+SET pg_strom.enabled = off;
+SELECT id, v @> '{"bval" : true}' c1,
+           v @> '{"bval" : false, "ival" : null}' c2,
+           v @> '{}' c3,
+           v @> '[]' c4
+  INTO test07p
+  FROM rt_jsonb_o
+ WHERE id > 0;
+(SELECT * FROM test07g EXCEPT SELECT * FROM test07p) ORDER BY id;
+(SELECT * FROM test07p EXCEPT SELECT * FROM test07g) ORDER BY id;
+
+SET pg_strom.enabled = on;
+SELECT id, v @> '[true]' c1,
+           v @> '[null, false]' c2,
+           v @> 'true' c3,
+           v @> '{"bval" : true}' c4
+  INTO test08g
+  FROM rt_jsonb_a
+ WHERE id > 0;
+SET pg_strom.enabled = off;
+SELECT id, v @> '[true]' c1,
+           v @> '[null, false]' c2,
+           v @> 'true' c3,
+           v @> '{"bval" : true}' c4
+  INTO test08p
+  FROM rt_jsonb_a
+ WHERE id > 0;
+(SELECT * FROM test08g EXCEPT SELECT * FROM test08p) ORDER BY id;
+(SELECT * FROM test08p EXCEPT SELECT * FROM test08g) ORDER BY id;
+
+-- nested container on the right-hand side needs CPU fallback
+SET pg_strom.enabled = on;
+SET pg_strom.cpu_fallback = on;
+SELECT id, (v)->>'str1' str1
+  INTO test09g
+  FROM rt_jsonb_c
+ WHERE v @> '{"comp" : {"bval" : true}}';
+RESET pg_strom.cpu_fallback;
+SET pg_strom.enabled = off;
+SELECT id, (v)->>'str1' str1
+  INTO test09p
+  FROM rt_jsonb_c
+ WHERE v @> '{"comp" : {"bval" : true}}';
+(SELECT * FROM test09g EXCEPT SELECT * FROM test09p) ORDER BY id;
+(SELECT * FROM test09p EXCEPT SELECT * FROM test09g) ORDER BY id;
+
 -- cleanup temporary resource
 SET client_min_messages = error;
 DROP SCHEMA regtest_dtype_jsonb_temp CASCADE;
@@ -306,6 +306,89 @@ SELECT id, length(tc1) v1,
 (SELECT * FROM test32g EXCEPT SELECT * FROM test32p) ORDER BY id;
 (SELECT * FROM test32p EXCEPT SELECT * FROM test32g) ORDER BY id;
 
+-- lower / upper (C collation only)
+SET pg_strom.enabled = on;
+SELECT id, lower(tc1) v1, upper(tc2) v2, lower(vc1) v3, upper(vc2) v4
+  INTO test33g
+  FROM rt_text
+ WHERE id > 0;
+SET pg_strom.enabled = off;
+SELECT id, lower(tc1) v1, upper(tc2) v2, lower(vc1) v3, upper(vc2) v4
+  INTO test33p
+  FROM rt_text
+ WHERE id > 0;
+(SELECT * FROM test33g EXCEPT SELECT * FROM test33p) ORDER BY id;
+(SELECT * FROM test33p EXCEPT SELECT * FROM test33g) ORDER BY id;
+
+-- strpos / position / char_length
+SET pg_strom.enabled = on;
+SELECT id, strpos(tc1, 'a') v1, strpos(tc1, substring(tc2, 3, 2)) v2,
+           position('-' in tc1) v3, strpos(vc1, '') v4,
+           char_length(tc2) v5
+  INTO test34g
+  FROM rt_text
+ WHERE id > 0;
+SET pg_strom.enabled = off;
+SELECT id, strpos(tc1, 'a') v1, strpos(tc1, substring(tc2, 3, 2)) v2,
+           position('-' in tc1) v3, strpos(vc1, '') v4,
+           char_length(tc2) v5
+  INTO test34p
+  FROM rt_text
+ WHERE id > 0;
+(SELECT * FROM test34g EXCEPT SELECT * FROM test34p) ORDER BY id;
+(SELECT * FROM test34p EXCEPT SELECT * FROM test34g) ORDER BY id;
+
+-- split_part
+SET pg_strom.enabled = on;
+SELECT id, split_part(tc1, '-', 1) v1, split_part(tc1, '-', 2) v2,
+           split_part(tc1, '-', 4) v3, split_part(vc1, '', 1) v4
+  INTO test35g
+  FROM rt_text
+ WHERE id > 0;
+SET pg_strom.enabled = off;
+SELECT id, split_part(tc1, '-', 1) v1, split_part(tc1, '-', 2) v2,
+           split_part(tc1, '-', 4) v3, split_part(vc1, '', 1) v4
+  INTO test35p
+  FROM rt_text
+ WHERE id > 0;
+(SELECT * FROM test35g EXCEPT SELECT * FROM test35p) ORDER BY id;
+(SELECT * FROM test35p EXCEPT SELECT * FROM test35g) ORDER BY id;
+
+-- concat_ws
+SET pg_strom.enabled = on;
+SELECT id, concat_ws('/', vc1, vc2) v1, concat_ws(', ', tc1, vc1, tc2) v2
+  INTO test36g
+  FROM rt_text
+ WHERE id > 0;
+SET pg_strom.enabled = off;
+SELECT id, concat_ws('/', vc1, vc2) v1, concat_ws(', ', tc1, vc1, tc2) v2
+  INTO test36p
+  FROM rt_text
+ WHERE id > 0;
+(SELECT * FROM test36g EXCEPT SELECT * FROM test36p) ORDER BY id;
+(SELECT * FROM test36p EXCEPT SELECT * FROM test36g) ORDER BY id;
+
+-- text functions with CPU fallback
+ALTER TABLE rt_text ALTER tc2 SET STORAGE external;
+UPDATE rt_text SET tc2 = repeat(tc2 || '-', 40)
+ WHERE id % 100 = 13;
+SET pg_strom.enabled = on;
+SET pg_strom.cpu_fallback = on;
+SELECT id, upper(tc2) v1, strpos(tc2, '-') v2, split_part(tc2, '-', 2) v3,
+           concat_ws('/', vc1, tc2) v4
+  INTO test37g
+  FROM rt_text
+ WHERE id > 0;
+RESET pg_strom.cpu_fallback;
+SET pg_strom.enabled = off;
+SELECT id, upper(tc2) v1, strpos(tc2, '-') v2, split_part(tc2, '-', 2) v3,
+           concat_ws('/', vc1, tc2) v4
+  INTO test37p
+  FROM rt_text
+ WHERE id > 0;
+(SELECT * FROM test37g EXCEPT SELECT * FROM test37p) ORDER BY id;
+(SELECT * FROM test37p EXCEPT SELECT * FROM test37g) ORDER BY id;
+
 -- cleanup temporary resource
 SET client_min_messages = error;
 DROP SCHEMA regtest_dtype_text_temp CASCADE;
@@ -922,6 +922,93 @@ SELECT * FROM test45g AS a, test45p AS b WHERE a.id=b.id AND
   OR ABS(a.v12 - b.v12) > 0.1
 ) LIMIT 5;
 
+-- time_bucket
+SELECT pgstrom.time_bucket('15 minutes', '2021-10-15 13:47:10'::timestamp)
+         = '2021-10-15 13:45:00'::timestamp c1,
+       pgstrom.time_bucket('1 week', '2021-10-15 13:47:10'::timestamp)
+         = '2021-10-11 00:00:00'::timestamp c2,
+       pgstrom.time_bucket('3 months', '2021-11-15 13:47:10'::timestamp)
+         = '2021-10-01 00:00:00'::timestamp c3,
+       pgstrom.time_bucket('1 hour', '2021-10-15 13:17:10'::timestamp,
+                           '2000-01-01 00:30:00'::timestamp)
+         = '2021-10-15 12:30:00'::timestamp c4,
+       pgstrom.time_bucket('1 day', '2021-10-15 03:00:00+09'::timestamptz)
+         = '2021-10-14 00:00:00+00'::timestamptz c5,
+       pgstrom.time_bucket('1 day', '2021-10-15 03:00:00+00'::timestamptz,
+                           'Asia/Tokyo'::text)
+         = '2021-10-15 00:00:00+09'::timestamptz c6;
+SELECT pgstrom.time_bucket('1 month 1 day', '2021-10-15'::timestamp);	-- error
+SELECT pgstrom.time_bucket('0 seconds', '2021-10-15'::timestamp);	-- error
+
+SET pg_strom.enabled = on;
+SELECT id, pgstrom.time_bucket('15 minutes', ts1) v1,
+           pgstrom.time_bucket('1 day', ts2) v2,
+           pgstrom.time_bucket('1 week', ts3) v3,
+           pgstrom.time_bucket('1 month', ts4) v4,
+           pgstrom.time_bucket('3 hours', ts1, '2000-01-01 01:30:00'::timestamp) v5,
+           pgstrom.time_bucket('1 hour', tsz1) v6,
+           pgstrom.time_bucket('2 months', tsz2) v7,
+           pgstrom.time_bucket('1 day', tsz3, 'Asia/Tokyo'::text) v8,
+           pgstrom.time_bucket('6 hours', tsz4, 'America/New_York'::text) v9
+  INTO test46g
+  FROM rt_datetime
+ WHERE id > 0;
+SET pg_strom.enabled = off;
+SELECT id, pgstrom.time_bucket('15 minutes', ts1) v1,
+           pgstrom.time_bucket('1 day', ts2) v2,
+           pgstrom.time_bucket('1 week', ts3) v3,
+           pgstrom.time_bucket('1 month', ts4) v4,
+           pgstrom.time_bucket('3 hours', ts1, '2000-01-01 01:30:00'::timestamp) v5,
+           pgstrom.time_bucket('1 hour', tsz1) v6,
+           pgstrom.time_bucket('2 months', tsz2) v7,
+           pgstrom.time_bucket('1 day', tsz3, 'Asia/Tokyo'::text) v8,
+           pgstrom.time_bucket('6 hours', tsz4, 'America/New_York'::text) v9
+  INTO test46p
+  FROM rt_datetime
+ WHERE id > 0;
+(SELECT * FROM test46g EXCEPT SELECT * FROM test46p) ORDER BY id;
+(SELECT * FROM test46p EXCEPT SELECT * FROM test46g) ORDER BY id;
+
+SET pg_strom.enabled = on;
+SELECT pgstrom.time_bucket('1 month', ts1) b, count(*) cnt, sum(ival) sum
+  INTO test47g
+  FROM rt_datetime
+ GROUP BY 1;
+SET pg_strom.enabled = off;
+SELECT pgstrom.time_bucket('1 month', ts1) b, count(*) cnt, sum(ival) sum
+  INTO test47p
+  FROM rt_datetime
+ GROUP BY 1;
+(SELECT * FROM test47g EXCEPT SELECT * FROM test47p) ORDER BY b;
+(SELECT * FROM test47p EXCEPT SELECT * FROM test47g) ORDER BY b;
+
+-- time_bucket with CPU fallback
+ALTER TABLE rt_datetime ADD memo text;
+ALTER TABLE rt_datetime ALTER memo SET STORAGE external;
+UPDATE rt_datetime
+   SET memo = CASE WHEN id % 100 = 3
+                   THEN repeat(md5(id::text), 200)
+                   ELSE md5(id::text)
+              END;
+SET pg_strom.enabled = on;
+SET pg_strom.cpu_fallback = on;
+SELECT id, pgstrom.time_bucket('1 week', ts1) v1,
+           pgstrom.time_bucket('1 month', tsz1) v2,
+           pgstrom.time_bucket('1 day', tsz2, 'Asia/Tokyo'::text) v3
+  INTO test48g
+  FROM rt_datetime
+ WHERE memo LIKE '%a%';
+RESET pg_strom.cpu_fallback;
+SET pg_strom.enabled = off;
+SELECT id, pgstrom.time_bucket('1 week', ts1) v1,
+           pgstrom.time_bucket('1 month', tsz1) v2,
+           pgstrom.time_bucket('1 day', tsz2, 'Asia/Tokyo'::text) v3
+  INTO test48p
+  FROM rt_datetime
+ WHERE memo LIKE '%a%';
+(SELECT * FROM test48g EXCEPT SELECT * FROM test48p) ORDER BY id;
+(SELECT * FROM test48p EXCEPT SELECT * FROM test48g) ORDER BY id;
+
 -- cleanup temporary resource
 SET client_min_messages = error;
 DROP SCHEMA regtest_dtype_time_temp CASCADE;
@@ -0,0 +1,90 @@
+---
+--- test cases for GPU Cache statistics
+---
+SET pg_strom.regression_test_mode = on;
+SET client_min_messages = error;
+DROP SCHEMA IF EXISTS gpu_cache_stat_temp_test CASCADE;
+CREATE SCHEMA gpu_cache_stat_temp_test;
+RESET client_min_messages;
+SET search_path = gpu_cache_stat_temp_test,public;
+
+CREATE TABLE cache_stat_table (
+  id   int,
+  a    int4,
+  b    float8
+);
+SELECT pgstrom.random_setseed(20211021);
+-- rows prior to the trigger are loaded by the initial loading
+INSERT INTO cache_stat_table (
+  SELECT x, pgstrom.random_int(1, -100000, 100000),
+            pgstrom.random_float(1, -1000.0, 1000.0)
+    FROM generate_series(1,4000) x);
+CREATE TRIGGER row_sync_stat AFTER INSERT OR UPDATE OR DELETE ON cache_stat_table FOR ROW
+    EXECUTE FUNCTION pgstrom.gpucache_sync_trigger('gpu_device_id=0,max_num_rows=5000,redo_buffer_size=150m,gpu_sync_threshold=10m,gpu_sync_interval=4');
+ALTER TABLE cache_stat_table ENABLE ALWAYS TRIGGER row_sync_stat;
+
+-- Force to use GPU Cache
+SET enable_seqscan = off;
+SET pg_strom.debug_kernel_source = off;
+
+---
+--- initial loading and scan on the GPU cache
+---
+SET pg_strom.enabled = on;
+SELECT id, a, b INTO test01g FROM cache_stat_table WHERE a % 3 = 0;
+SET pg_strom.enabled = off;
+SELECT id, a, b INTO test01p FROM cache_stat_table WHERE a % 3 = 0;
+(SELECT * FROM test01g EXCEPT SELECT * FROM test01p) ORDER BY id;
+(SELECT * FROM test01p EXCEPT SELECT * FROM test01g) ORDER BY id;
+
+SELECT load_progress = 1.0 AS load_ok,
+       load_nitems = 4000 AS nitems_ok,
+       load_time >= 0.0 AS time_ok,
+       scan_cached > 0 AS cached_ok,
+       scan_fallback = 0 AS fallback_ok,
+       array_length(apply_latency_hist, 1) = 8 AS hist_ok
+  FROM pgstrom.gpucache_stat
+ WHERE table_name = 'cache_stat_table' AND database_name = current_database();
+
+---
+--- REDO log application
+---
+SELECT apply_count, apply_nitems
+  INTO stat_prev
+  FROM pgstrom.gpucache_stat
+ WHERE table_name = 'cache_stat_table' AND database_name = current_database();
+UPDATE cache_stat_table SET a = a + 1 WHERE id % 40 = 0;
+SELECT pgstrom.gpucache_apply_redo('cache_stat_table') = 0 AS apply_redo_result;
+SELECT s.apply_count > p.apply_count AS count_ok,
+       s.apply_nitems >= p.apply_nitems + 100 AS nitems_ok,
+       s.apply_time >= 0.0 AS time_ok,
+       (SELECT sum(x) FROM unnest(s.apply_latency_hist) x) = s.apply_count AS hist_ok
+  FROM pgstrom.gpucache_stat s, stat_prev p
+ WHERE table_name = 'cache_stat_table' AND database_name = current_database();
+
+---
+--- scan falls back to the table on the corrupted GPU cache
+---
+-- update to make the table corrupted (more than max_num_rows)
+UPDATE cache_stat_table SET b = b / 2 WHERE id in (SELECT id FROM cache_stat_table LIMIT 1000);
+SELECT pgstrom.gpucache_apply_redo('cache_stat_table') > 0 AS apply_redo_result;
+SET pg_strom.enabled = on;
+SELECT id, a, b INTO test02g FROM cache_stat_table WHERE a % 3 = 0;
+SET pg_strom.enabled = off;
+SELECT id, a, b INTO test02p FROM cache_stat_table WHERE a % 3 = 0;
+(SELECT * FROM test02g EXCEPT SELECT * FROM test02p) ORDER BY id;
+(SELECT * FROM test02p EXCEPT SELECT * FROM test02g) ORDER BY id;
+SELECT scan_fallback > 0 AS fallback_ok
+  FROM pgstrom.gpucache_stat
+ WHERE table_name = 'cache_stat_table' AND database_name = current_database();
+
+-- Recover GPUCache; it runs the initial loading again
+SELECT pgstrom.gpucache_recovery('cache_stat_table') = 0;
+SELECT load_progress = 1.0 AS load_ok,
+       load_nitems >= 4000 AS nitems_ok
+  FROM pgstrom.gpucache_stat
+ WHERE table_name = 'cache_stat_table' AND database_name = current_database();
+
+-- cleanup temporary resource
+SET client_min_messages = error;
+DROP SCHEMA gpu_cache_stat_temp_test CASCADE;
@@ -0,0 +1,150 @@
+---
+--- Test for SEMI / ANTI JOIN on GpuHashJoin and GpuNestLoop
+---
+SET pg_strom.regression_test_mode = on;
+SET client_min_messages = error;
+DROP SCHEMA IF EXISTS regtest_gpujoin_semi_anti_temp CASCADE;
+CREATE SCHEMA regtest_gpujoin_semi_anti_temp;
+RESET client_min_messages;
+
+SET search_path = regtest_gpujoin_semi_anti_temp, public;
+CREATE TABLE rt_outer (
+  id    int,
+  key   int,
+  memo  text
+);
+ALTER TABLE rt_outer ALTER memo SET STORAGE external;
+CREATE TABLE rt_inner (
+  key   int,
+  val   int
+);
+SELECT pgstrom.random_setseed(20211015);
+INSERT INTO rt_outer (
+  SELECT x, pgstrom.random_int(1, 0, 2000), pgstrom.random_text_len(1, 60)
+    FROM generate_series(1,20000) x);
+-- out-of-line values; device code cannot touch them without CPU fallback
+INSERT INTO rt_outer (
+  SELECT x, pgstrom.random_int(1, 0, 2000), repeat(md5(x::text), 200)
+    FROM generate_series(20001,20100) x);
+-- every key appears three times, to check SEMI JOIN emits an outer row once
+INSERT INTO rt_inner (
+  SELECT (x % 300) * 7, x FROM generate_series(1,900) x);
+
+-- force to use GpuJoin, instead of the built-in JOIN
+SET enable_seqscan = off;
+SET enable_hashjoin = off;
+SET enable_mergejoin = off;
+SET enable_nestloop = off;
+SET max_parallel_workers_per_gather = 0;
+-- not to print kernel source code
+SET pg_strom.debug_kernel_source = off;
+
+-- SEMI JOIN by GpuHashJoin
+SET pg_strom.enabled = on;
+SELECT id, key, memo LIKE '%a%' m
+  INTO test01g
+  FROM rt_outer o
+ WHERE EXISTS (SELECT 1 FROM rt_inner i WHERE i.key = o.key);
+SET pg_strom.enabled = off;
+SELECT id, key, memo LIKE '%a%' m
+  INTO test01p
+  FROM rt_outer o
+ WHERE EXISTS (SELECT 1 FROM rt_inner i WHERE i.key = o.key);
+(SELECT * FROM test01g EXCEPT SELECT * FROM test01p) ORDER BY id;
+(SELECT * FROM test01p EXCEPT SELECT * FROM test01g) ORDER BY id;
+SELECT (SELECT count(*) FROM test01g) = (SELECT count(*) FROM test01p) ok;
+
+-- SEMI JOIN by IN sub-query
+SET pg_strom.enabled = on;
+SELECT id, key
+  INTO test02g
+  FROM rt_outer o
+ WHERE key IN (SELECT key FROM rt_inner WHERE val % 3 = 0);
+SET pg_strom.enabled = off;
+SELECT id, key
+  INTO test02p
+  FROM rt_outer o
+ WHERE key IN (SELECT key FROM rt_inner WHERE val % 3 = 0);
+(SELECT * FROM test02g EXCEPT SELECT * FROM test02p) ORDER BY id;
+(SELECT * FROM test02p EXCEPT SELECT * FROM test02g) ORDER BY id;
+
+-- ANTI JOIN by GpuHashJoin
+SET pg_strom.enabled = on;
+SELECT id, key, memo LIKE '%a%' m
+  INTO test03g
+  FROM rt_outer o
+ WHERE NOT EXISTS (SELECT 1 FROM rt_inner i WHERE i.key = o.key);
+SET pg_strom.enabled = off;
+SELECT id, key, memo LIKE '%a%' m
+  INTO test03p
+  FROM rt_outer o
+ WHERE NOT EXISTS (SELECT 1 FROM rt_inner i WHERE i.key = o.key);
+(SELECT * FROM test03g EXCEPT SELECT * FROM test03p) ORDER BY id;
+(SELECT * FROM test03p EXCEPT SELECT * FROM test03g) ORDER BY id;
+
+-- SEMI JOIN by GpuNestLoop
+SET pg_strom.enabled = on;
+SELECT id, key
+  INTO test04g
+  FROM rt_outer o
+ WHERE EXISTS (SELECT 1 FROM rt_inner i
+                WHERE o.key BETWEEN i.key AND i.key + 2);
+SET pg_strom.enabled = off;
+SELECT id, key
+  INTO test04p
+  FROM rt_outer o
+ WHERE EXISTS (SELECT 1 FROM rt_inner i
+                WHERE o.key BETWEEN i.key AND i.key + 2);
+(SELECT * FROM test04g EXCEPT SELECT * FROM test04p) ORDER BY id;
+(SELECT * FROM test04p EXCEPT SELECT * FROM test04g) ORDER BY id;
+SELECT (SELECT count(*) FROM test04g) = (SELECT count(*) FROM test04p) ok;
+
+-- ANTI JOIN by GpuNestLoop
+SET pg_strom.enabled = on;
+SELECT id, key
+  INTO test05g
+  FROM rt_outer o
+ WHERE NOT EXISTS (SELECT 1 FROM rt_inner i
+                    WHERE o.key BETWEEN i.key AND i.key + 2);
+SET pg_strom.enabled = off;
+SELECT id, key
+  INTO test05p
+  FROM rt_outer o
+ WHERE NOT EXISTS (SELECT 1 FROM rt_inner i
+                    WHERE o.key BETWEEN i.key AND i.key + 2);
+(SELECT * FROM test05g EXCEPT SELECT * FROM test05p) ORDER BY id;
+(SELECT * FROM test05p EXCEPT SELECT * FROM test05g) ORDER BY id;
+
+-- SEMI / ANTI JOIN with CPU fallback
+SET pg_strom.enabled = on;
+SET pg_strom.cpu_fallback = on;
+SELECT id, key, substring(memo, 1, 20) m
+  INTO test06g
+  FROM rt_outer o
+ WHERE EXISTS (SELECT 1 FROM rt_inner i WHERE i.key = o.key)
+   AND memo LIKE '%abc%';
+SELECT id, key, substring(memo, 1, 20) m
+  INTO test07g
+  FROM rt_outer o
+ WHERE NOT EXISTS (SELECT 1 FROM rt_inner i WHERE i.key = o.key)
+   AND memo LIKE '%abc%';
+RESET pg_strom.cpu_fallback;
+SET pg_strom.enabled = off;
+SELECT id, key, substring(memo, 1, 20) m
+  INTO test06p
+  FROM rt_outer o
+ WHERE EXISTS (SELECT 1 FROM rt_inner i WHERE i.key = o.key)
+   AND memo LIKE '%abc%';
+SELECT id, key, substring(memo, 1, 20) m
+  INTO test07p
+  FROM rt_outer o
+ WHERE NOT EXISTS (SELECT 1 FROM rt_inner i WHERE i.key = o.key)
+   AND memo LIKE '%abc%';
+(SELECT * FROM test06g EXCEPT SELECT * FROM test06p) ORDER BY id;
+(SELECT * FROM test06p EXCEPT SELECT * FROM test06g) ORDER BY id;
+(SELECT * FROM test07g EXCEPT SELECT * FROM test07p) ORDER BY id;
+(SELECT * FROM test07p EXCEPT SELECT * FROM test07g) ORDER BY id;
+
+-- cleanup temporary resource
+SET client_min_messages = error;
+DROP SCHEMA regtest_gpujoin_semi_anti_temp CASCADE;
@@ -0,0 +1,104 @@
+---
+--- Test for DISTINCT aggregates on GpuPreAgg
+---
+SET pg_strom.regression_test_mode = on;
+SET client_min_messages = error;
+DROP SCHEMA IF EXISTS regtest_gpupreagg_distinct_temp CASCADE;
+CREATE SCHEMA regtest_gpupreagg_distinct_temp;
+RESET client_min_messages;
+
+SET search_path = regtest_gpupreagg_distinct_temp, public;
+CREATE TABLE rt_data (
+  id    int,
+  gkey  int,
+  ival  int,
+  tval  text,
+  memo  text
+);
+ALTER TABLE rt_data ALTER memo SET STORAGE external;
+SELECT pgstrom.random_setseed(20211016);
+INSERT INTO rt_data (
+  SELECT x, pgstrom.random_int(0, 1, 40),
+            pgstrom.random_int(1, 1, 500),
+            pgstrom.random_text_len(1, 2),
+            pgstrom.random_text_len(1, 60)
+    FROM generate_series(1,50000) x);
+-- out-of-line values; device code cannot touch them without CPU fallback
+INSERT INTO rt_data (
+  SELECT x, pgstrom.random_int(0, 1, 40),
+            pgstrom.random_int(1, 1, 500),
+            pgstrom.random_text_len(1, 2),
+            repeat(md5(x::text), 200)
+    FROM generate_series(50001,50100) x);
+
+-- force to use GpuScan, instead of SeqScan
+SET enable_seqscan = off;
+SET max_parallel_workers_per_gather = 0;
+-- not to print kernel source code
+SET pg_strom.debug_kernel_source = off;
+
+-- count(DISTINCT) with GROUP BY
+SET pg_strom.enabled = on;
+SELECT gkey, count(DISTINCT ival) dcnt, count(*) cnt, sum(ival) sum
+  INTO test01g
+  FROM rt_data
+ GROUP BY gkey;
+SET pg_strom.enabled = off;
+SELECT gkey, count(DISTINCT ival) dcnt, count(*) cnt, sum(ival) sum
+  INTO test01p
+  FROM rt_data
+ GROUP BY gkey;
+(SELECT * FROM test01g EXCEPT SELECT * FROM test01p) ORDER BY gkey;
+(SELECT * FROM test01p EXCEPT SELECT * FROM test01g) ORDER BY gkey;
+
+-- multiple DISTINCT aggregates on different arguments
+SET pg_strom.enabled = on;
+SELECT gkey, count(DISTINCT ival) dcnt_i, count(DISTINCT tval) dcnt_t,
+       sum(DISTINCT ival) dsum, max(ival) max
+  INTO test02g
+  FROM rt_data
+ GROUP BY gkey;
+SET pg_strom.enabled = off;
+SELECT gkey, count(DISTINCT ival) dcnt_i, count(DISTINCT tval) dcnt_t,
+       sum(DISTINCT ival) dsum, max(ival) max
+  INTO test02p
+  FROM rt_data
+ GROUP BY gkey;
+(SELECT * FROM test02g EXCEPT SELECT * FROM test02p) ORDER BY gkey;
+(SELECT * FROM test02p EXCEPT SELECT * FROM test02g) ORDER BY gkey;
+
+-- DISTINCT aggregate without GROUP BY
+SET pg_strom.enabled = on;
+SELECT count(DISTINCT ival) dcnt, count(DISTINCT tval) dcnt_t, count(*) cnt
+  INTO test03g
+  FROM rt_data
+ WHERE id % 3 = 0;
+SET pg_strom.enabled = off;
+SELECT count(DISTINCT ival) dcnt, count(DISTINCT tval) dcnt_t, count(*) cnt
+  INTO test03p
+  FROM rt_data
+ WHERE id % 3 = 0;
+SELECT * FROM test03g EXCEPT SELECT * FROM test03p;
+SELECT * FROM test03p EXCEPT SELECT * FROM test03g;
+
+-- DISTINCT aggregate with CPU fallback
+SET pg_strom.enabled = on;
+SET pg_strom.cpu_fallback = on;
+SELECT gkey, count(DISTINCT ival) dcnt, count(*) cnt
+  INTO test04g
+  FROM rt_data
+ WHERE memo LIKE '%abc%'
+ GROUP BY gkey;
+RESET pg_strom.cpu_fallback;
+SET pg_strom.enabled = off;
+SELECT gkey, count(DISTINCT ival) dcnt, count(*) cnt
+  INTO test04p
+  FROM rt_data
+ WHERE memo LIKE '%abc%'
+ GROUP BY gkey;
+(SELECT * FROM test04g EXCEPT SELECT * FROM test04p) ORDER BY gkey;
+(SELECT * FROM test04p EXCEPT SELECT * FROM test04g) ORDER BY gkey;
+
+-- cleanup temporary resource
+SET client_min_messages = error;
+DROP SCHEMA regtest_gpupreagg_distinct_temp CASCADE;
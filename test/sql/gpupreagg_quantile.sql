@@ -0,0 +1,102 @@
+---
+--- Test for quantile_sketch() and related functions
+---
+SET pg_strom.regression_test_mode = on;
+SET client_min_messages = error;
+DROP SCHEMA IF EXISTS regtest_gpupreagg_quantile_temp CASCADE;
+CREATE SCHEMA regtest_gpupreagg_quantile_temp;
+RESET client_min_messages;
+
+SET search_path = regtest_gpupreagg_quantile_temp, public;
+CREATE TABLE rt_data (
+  id    int,
+  gkey  int,
+  fval  float8,
+  memo  text
+);
+ALTER TABLE rt_data ALTER memo SET STORAGE external;
+SELECT pgstrom.random_setseed(20211017);
+INSERT INTO rt_data (
+  SELECT x, pgstrom.random_int(0, 1, 20),
+            pgstrom.random_float(1, -10000.0, 10000.0),
+            pgstrom.random_text_len(1, 60)
+    FROM generate_series(1,100000) x);
+-- out-of-line values; device code cannot touch them without CPU fallback
+INSERT INTO rt_data (
+  SELECT x, pgstrom.random_int(0, 1, 20),
+            pgstrom.random_float(1, -10000.0, 10000.0),
+            repeat(md5(x::text), 200)
+    FROM generate_series(100001,100100) x);
+
+-- force to use GpuScan, instead of SeqScan
+SET enable_seqscan = off;
+SET max_parallel_workers_per_gather = 0;
+-- not to print kernel source code
+SET pg_strom.debug_kernel_source = off;
+SET pg_strom.quantile_sketch_bits = 3;
+
+-- GPU and CPU build an identical sketch
+SET pg_strom.enabled = on;
+SELECT gkey, quantile_sketch(fval) qs
+  INTO test01g
+  FROM rt_data
+ GROUP BY gkey;
+SET pg_strom.enabled = off;
+SELECT gkey, quantile_sketch(fval) qs
+  INTO test01p
+  FROM rt_data
+ GROUP BY gkey;
+(SELECT * FROM test01g EXCEPT SELECT * FROM test01p) ORDER BY gkey;
+(SELECT * FROM test01p EXCEPT SELECT * FROM test01g) ORDER BY gkey;
+
+-- estimated percentile is within the relative error 2^-(bits+1)
+SELECT gkey, percentile_disc(0.1) WITHIN GROUP (ORDER BY fval) p10,
+             percentile_disc(0.5) WITHIN GROUP (ORDER BY fval) p50,
+             percentile_disc(0.99) WITHIN GROUP (ORDER BY fval) p99
+  INTO test02p
+  FROM rt_data
+ GROUP BY gkey;
+SELECT count(*)
+  FROM test01g g, test02p p
+ WHERE g.gkey = p.gkey
+   AND (abs(quantile_sketch_percentile(qs, 0.1) - p10) > abs(p10) * 0.0625 OR
+        abs(quantile_sketch_percentile(qs, 0.5) - p50) > abs(p50) * 0.0625 OR
+        abs(quantile_sketch_percentile(qs, 0.99) - p99) > abs(p99) * 0.0625);
+SELECT count(*)
+  FROM test01g
+ WHERE quantile_sketch_percentile(qs, ARRAY[0.1, 0.5, 0.99])
+    != ARRAY[quantile_sketch_percentile(qs, 0.1),
+             quantile_sketch_percentile(qs, 0.5),
+             quantile_sketch_percentile(qs, 0.99)];
+
+-- quantile_combine() of the partial sketches is the sketch of the whole
+SET pg_strom.enabled = on;
+SELECT quantile_sketch(fval) qs
+  INTO test03g
+  FROM rt_data;
+SELECT (SELECT quantile_combine(qs) FROM test01g) = qs ok
+  FROM test03g;
+SELECT (SELECT quantile_combine(qs) FROM test01p) = qs ok
+  FROM test03g;
+
+-- quantile_sketch() with CPU fallback
+SET pg_strom.enabled = on;
+SET pg_strom.cpu_fallback = on;
+SELECT gkey, quantile_sketch(fval) qs
+  INTO test04g
+  FROM rt_data
+ WHERE memo LIKE '%abc%'
+ GROUP BY gkey;
+RESET pg_strom.cpu_fallback;
+SET pg_strom.enabled = off;
+SELECT gkey, quantile_sketch(fval) qs
+  INTO test04p
+  FROM rt_data
+ WHERE memo LIKE '%abc%'
+ GROUP BY gkey;
+(SELECT * FROM test04g EXCEPT SELECT * FROM test04p) ORDER BY gkey;
+(SELECT * FROM test04p EXCEPT SELECT * FROM test04g) ORDER BY gkey;
+
+-- cleanup temporary resource
+SET client_min_messages = error;
+DROP SCHEMA regtest_gpupreagg_quantile_temp CASCADE;
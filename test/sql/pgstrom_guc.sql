@@ -13,3 +13,54 @@ SHOW pg_strom.gpu_operator_cost;
 SHOW pg_strom.gpu_dma_cost;
 SHOW pg_strom.pullup_outer_scan;
 SHOW pg_strom.pullup_outer_join;
+SHOW pg_strom.enable_gpusort;
+SHOW pg_strom.enable_gpusort_radix;
+SHOW pg_strom.enable_gpuhashjoin_partition;
+SHOW pg_strom.gpuhashjoin_partition_size;
+SHOW pg_strom.enable_gpuhashjoin_bloom;
+SHOW pg_strom.enable_gpuhashjoin_open_addressing;
+SHOW pg_strom.enable_gpujoin_inner_peer_access;
+SHOW pg_strom.enable_gpujoin_inner_cache;
+SHOW pg_strom.gpujoin_inner_cache_size;
+SHOW pg_strom.gpuhashjoin_skew_threshold;
+SHOW pg_strom.enable_partitionwise_gpujoin_affinity;
+SHOW pg_strom.quantile_sketch_bits;
+SHOW pg_strom.enable_gpusort_window;
+SHOW pg_strom.gpupreagg_local_miss_threshold;
+SHOW pg_strom.enable_gpupreagg_shared_final;
+SHOW pg_strom.enable_zonemap;
+SHOW pg_strom.gpuscan_adaptive_quals;
+SHOW arrow_fdw.metadata_cache_dir;
+SHOW arrow_fdw.io_merge_gap;
+SHOW arrow_fdw.readahead_batches;
+SHOW arrow_fdw.late_materialization;
+SHOW pg_strom.max_device_tasks;
+SHOW pg_strom.query_priority;
+SHOW pg_strom.memory_aware_planning;
+SHOW pg_strom.persistent_program_cache;
+SHOW pg_strom.persistent_program_cache_size;
+SHOW pg_strom.gpuscan_speculative_cpu;
+SHOW pg_strom.gpudirect_clean_buffers;
+SHOW arrow_fdw.io_parallelism;
+SHOW pg_strom.adaptive_chunk_size;
+SHOW pg_strom.heap_readahead_chunks;
+SHOW pg_strom.detoast_on_load;
+SHOW pg_strom.gpu_mvcc_check;
+SHOW pg_strom.gpu_mvcc_clog_xids;
+SHOW pg_strom.stat_gpu_query_max;
+SHOW pg_strom.debug_kernel_profiling;
+SHOW pg_strom.explain_offload_blockers;
+SHOW pg_strom.max_gpu_memory_per_query;
+SHOW pg_strom.device_cost_model;
+SHOW pg_strom.adaptive_execution;
+SHOW pg_strom.adaptive_execution_samples;
+SHOW pg_strom.cardinality_feedback;
+SHOW pg_strom.enable_gpujoin_bushy;
+SHOW pg_strom.bulkexec;
+SHOW pg_strom.enable_async_append;
+SHOW arrow_fdw.sync_scan;
+SHOW pg_strom.gpupreagg_result_cache_size;
+SHOW pg_strom.max_parallel_workers_per_gpu;
+SHOW pg_strom.enable_gpuhashjoin_device_build;
+SHOW pg_strom.enable_gpupreagg_distinct;
+SHOW arrow_fdw.consumer;
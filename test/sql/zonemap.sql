@@ -0,0 +1,152 @@
+---
+--- Test for zone-map (min/max statistics) of heap tables
+---
+SET pg_strom.regression_test_mode = on;
+SET client_min_messages = error;
+DROP SCHEMA IF EXISTS regtest_zonemap_temp CASCADE;
+CREATE SCHEMA regtest_zonemap_temp;
+RESET client_min_messages;
+
+SET search_path = regtest_zonemap_temp, public;
+CREATE TABLE rt_data (
+  id    int,
+  ival  int8,
+  fval  float8,
+  memo  text
+);
+ALTER TABLE rt_data ALTER memo SET STORAGE external;
+SELECT pgstrom.random_setseed(20211018);
+INSERT INTO rt_data (
+  SELECT x, x * 10 + pgstrom.random_int(1, 0, 9),
+            pgstrom.random_float(1, -1000.0, 1000.0),
+            pgstrom.random_text_len(1, 60)
+    FROM generate_series(1,100000) x);
+-- out-of-line values; device code cannot touch them without CPU fallback
+INSERT INTO rt_data (
+  SELECT x, x * 10 + pgstrom.random_int(1, 0, 9),
+            pgstrom.random_float(1, -1000.0, 1000.0),
+            repeat(md5(x::text), 200)
+    FROM generate_series(100001,100100) x);
+
+-- force to use GpuScan, instead of SeqScan
+SET enable_seqscan = off;
+SET max_parallel_workers_per_gather = 0;
+-- not to print kernel source code
+SET pg_strom.debug_kernel_source = off;
+
+-- number of ranges skipped by zone-map, or NULL if not used
+CREATE FUNCTION zonemap_skipped(qry text)
+RETURNS bigint AS $$
+DECLARE
+  plan  text;
+BEGIN
+  EXECUTE 'EXPLAIN (ANALYZE, COSTS OFF, TIMING OFF, SUMMARY OFF, FORMAT JSON) '
+          || qry INTO plan;
+  RETURN (regexp_match(plan, '"Zone-map skipped": ([0-9]+)'))[1]::bigint;
+END;
+$$ LANGUAGE plpgsql;
+
+-- build zone-map; text column is not supported
+SELECT pgstrom.zonemap_refresh('rt_data', 16) > 0 ok;
+SELECT attname
+  FROM pgstrom.zonemap z, pg_attribute a
+ WHERE z.zm_relid = 'rt_data'::regclass
+   AND a.attrelid = z.zm_relid AND a.attnum = z.zm_attnum
+ ORDER BY a.attnum;
+SELECT pgstrom.zonemap_refresh('rt_data', 0);	-- error
+
+-- GpuScan with zone-map
+SET pg_strom.enabled = on;
+SELECT id, ival, fval
+  INTO test01g
+  FROM rt_data
+ WHERE id BETWEEN 20000 AND 30000;
+SELECT zonemap_skipped('SELECT * FROM rt_data WHERE id BETWEEN 20000 AND 30000') > 0 ok;
+SELECT id, ival
+  INTO test02g
+  FROM rt_data
+ WHERE ival > 950000 AND fval < 0.0;
+SET pg_strom.enable_zonemap = off;
+SELECT id, ival, fval
+  INTO test01z
+  FROM rt_data
+ WHERE id BETWEEN 20000 AND 30000;
+SELECT zonemap_skipped('SELECT * FROM rt_data WHERE id BETWEEN 20000 AND 30000') IS NULL ok;
+RESET pg_strom.enable_zonemap;
+SET pg_strom.enabled = off;
+SELECT id, ival, fval
+  INTO test01p
+  FROM rt_data
+ WHERE id BETWEEN 20000 AND 30000;
+SELECT id, ival
+  INTO test02p
+  FROM rt_data
+ WHERE ival > 950000 AND fval < 0.0;
+(SELECT * FROM test01g EXCEPT SELECT * FROM test01p) ORDER BY id;
+(SELECT * FROM test01p EXCEPT SELECT * FROM test01g) ORDER BY id;
+(SELECT * FROM test01z EXCEPT SELECT * FROM test01p) ORDER BY id;
+(SELECT * FROM test01p EXCEPT SELECT * FROM test01z) ORDER BY id;
+(SELECT * FROM test02g EXCEPT SELECT * FROM test02p) ORDER BY id;
+(SELECT * FROM test02p EXCEPT SELECT * FROM test02g) ORDER BY id;
+
+-- DELETE keeps zone-map, but INSERT invalidates it
+DELETE FROM rt_data WHERE id % 7 = 0;
+SELECT count(*) > 0 ok FROM pgstrom.zonemap WHERE zm_relid = 'rt_data'::regclass;
+SET pg_strom.enabled = on;
+SELECT id, ival, fval
+  INTO test03g
+  FROM rt_data
+ WHERE id BETWEEN 20000 AND 30000;
+SELECT zonemap_skipped('SELECT * FROM rt_data WHERE id BETWEEN 20000 AND 30000') > 0 ok;
+SET pg_strom.enabled = off;
+SELECT id, ival, fval
+  INTO test03p
+  FROM rt_data
+ WHERE id BETWEEN 20000 AND 30000;
+(SELECT * FROM test03g EXCEPT SELECT * FROM test03p) ORDER BY id;
+(SELECT * FROM test03p EXCEPT SELECT * FROM test03g) ORDER BY id;
+
+INSERT INTO rt_data VALUES (25000, 999999, 0.0, 'new');
+SELECT count(*) FROM pgstrom.zonemap WHERE zm_relid = 'rt_data'::regclass;
+SELECT pgstrom.zonemap_refresh('rt_data') > 0 ok;
+SET pg_strom.enabled = on;
+SELECT id, ival, fval
+  INTO test04g
+  FROM rt_data
+ WHERE id BETWEEN 20000 AND 30000;
+SELECT zonemap_skipped('SELECT * FROM rt_data WHERE id BETWEEN 20000 AND 30000') > 0 ok;
+SET pg_strom.enabled = off;
+SELECT id, ival, fval
+  INTO test04p
+  FROM rt_data
+ WHERE id BETWEEN 20000 AND 30000;
+(SELECT * FROM test04g EXCEPT SELECT * FROM test04p) ORDER BY id;
+(SELECT * FROM test04p EXCEPT SELECT * FROM test04g) ORDER BY id;
+
+-- UPDATE also invalidates zone-map, then no ranges are skipped
+UPDATE rt_data SET fval = 0.0 WHERE id = 25001;
+SELECT count(*) FROM pgstrom.zonemap WHERE zm_relid = 'rt_data'::regclass;
+SET pg_strom.enabled = on;
+SELECT zonemap_skipped('SELECT * FROM rt_data WHERE id BETWEEN 20000 AND 30000') IS NULL ok;
+SELECT pgstrom.zonemap_refresh('rt_data') > 0 ok;
+SELECT zonemap_skipped('SELECT * FROM rt_data WHERE id BETWEEN 20000 AND 30000') > 0 ok;
+
+-- GpuScan with zone-map and CPU fallback
+SET pg_strom.enabled = on;
+SET pg_strom.cpu_fallback = on;
+SELECT id, ival, substring(memo, 1, 20) m
+  INTO test05g
+  FROM rt_data
+ WHERE id > 90000 AND memo LIKE '%abc%';
+RESET pg_strom.cpu_fallback;
+SET pg_strom.enabled = off;
+SELECT id, ival, substring(memo, 1, 20) m
+  INTO test05p
+  FROM rt_data
+ WHERE id > 90000 AND memo LIKE '%abc%';
+(SELECT * FROM test05g EXCEPT SELECT * FROM test05p) ORDER BY id;
+(SELECT * FROM test05p EXCEPT SELECT * FROM test05g) ORDER BY id;
+
+-- cleanup temporary resource
+SET client_min_messages = error;
+DROP SCHEMA regtest_zonemap_temp CASCADE;
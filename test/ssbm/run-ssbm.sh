@@ -1,7 +1,11 @@
 #!/bin/sh
-
-YMD=`date +%Y%m%d`
-DIR=~/ssbm-logs
+#
+# run-ssbm.sh - runs SSBM queries on the heap tables with/without PG-Strom
+#
+# It is a shorthand of ssbm-bench.py; see the script for more options.
+# The result is saved on ~/ssbm-logs as JSON, and can be compared with
+# the prior results using 'ssbm-bench.py compare'.
+#
 CWD=`dirname $0`
 DBNAME="ssbm"
 
@@ -9,22 +13,4 @@ if [ -n "$1" ]; then
   DBNAME="$1"
 fi
 
-mkdir -p ${DIR} || exit 1
-
-sudo sysctl -w vm.drop_caches=1
-psql ${DBNAME} -a -f ${CWD}/ssbm-all-pgsql.sql > ${DIR}/log_pgsql_${DBNAME}_${YMD}a.log
-
-sudo sysctl -w vm.drop_caches=1
-psql ${DBNAME} -a -f ${CWD}/ssbm-all-pgsql.sql > ${DIR}/log_pgsql_${DBNAME}_${YMD}b.log
-
-sudo sysctl -w vm.drop_caches=1
-psql ${DBNAME} -a -f ${CWD}/ssbm-all-pgsql.sql > ${DIR}/log_pgsql_${DBNAME}_${YMD}c.log
-
-sudo sysctl -w vm.drop_caches=1
-psql ${DBNAME} -a -f ${CWD}/ssbm-all-strom.sql > ${DIR}/log_strom_${DBNAME}_${YMD}a.log
-
-sudo sysctl -w vm.drop_caches=1
-psql ${DBNAME} -a -f ${CWD}/ssbm-all-strom.sql > ${DIR}/log_strom_${DBNAME}_${YMD}b.log
-
-sudo sysctl -w vm.drop_caches=1
-psql ${DBNAME} -a -f ${CWD}/ssbm-all-strom.sql > ${DIR}/log_strom_${DBNAME}_${YMD}c.log
+exec ${CWD}/ssbm-bench.py run -d ${DBNAME} -V heap -e pgsql,strom --cold
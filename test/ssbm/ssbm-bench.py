@@ -0,0 +1,126 @@
+#!/usr/bin/env python3
+#
+# ssbm-bench.py - Star Schema Benchmark harness of PG-Strom
+#
+# Usage:
+#   ssbm-bench.py load    [-d DBNAME] [-s SCALE] [-V VARIANTS] [--dbgen PATH]
+#                         [--pg2arrow PATH] [--arrow-dir DIR]
+#   ssbm-bench.py run     [-d DBNAME] [-V VARIANTS] [-e ENGINES] [-q QUERIES]
+#                         [-n NLOOPS] [--cold] [--restart-cmd CMD] [-o FILE]
+#                         [--label LABEL]
+#   ssbm-bench.py compare BASE.json NEW.json [--threshold PCT] [--min-diff MS]
+#
+# 'load' generates the SSBM dataset using dbgen-ssbm, then sets up three
+# variants of the lineorder table; 'heap' (regular PostgreSQL table),
+# 'gcache' (heap table with GPU Cache) and 'arrow' (Arrow_Fdw foreign table).
+# Dimension tables are shared by all the variants on the 'ssbm' schema.
+#
+# 'run' executes the 13 queries of SSBM on the variants and engines, then
+# writes out a JSON file with per-query time and GPU statistics reported by
+# EXPLAIN (ANALYZE, VERBOSE). Unless -o is given, the result is saved on
+# ~/ssbm-logs as the history of benchmark results.
+#
+# 'compare' reports the difference of two results, and exits with 1 if any
+# query gets slower than the threshold.
+#
+# Copyright 2011-2021 (C) KaiGai Kohei <kaigai@kaigai.gr.jp>
+# Copyright 2014-2021 (C) PG-Strom Developers Team
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the PostgreSQL License.
+#
+import argparse
+import os
+import subprocess
+import sys
+
+SSBM_DIR = os.path.dirname(os.path.abspath(__file__))
+sys.path.insert(0, os.path.join(SSBM_DIR, '..'))
+from benchlib import *
+
+SSBM_DDL_FILE = os.path.join(SSBM_DIR, 'ssbm-ddl.sql')
+SSBM_QUERY_FILE = os.path.join(SSBM_DIR, 'ssbm-all-strom.sql')
+SSBM_LOG_DIR = os.path.expanduser('~/ssbm-logs')
+
+SSBM_VARIANTS = {
+    'heap'   : 'ssbm',
+    'gcache' : 'ssbm_gcache, ssbm',
+    'arrow'  : 'ssbm_arrow, ssbm',
+}
+SSBM_TABLES = [('customer', 'c'),
+               ('date1',    'd'),
+               ('lineorder','l'),
+               ('part',     'p'),
+               ('supplier', 's')]
+
+#
+# load command
+#
+def ssbm_load(args):
+    variants = parse_choices(args.variants, SSBM_VARIANTS, 'variant')
+    dbgen = lookup_command('dbgen-ssbm', args.dbgen)
+    nrows = 6000000 * args.scale
+
+    elog('generating SSBM dataset (scale factor=%d) on %s'
+         % (args.scale, args.dbname))
+    with open(SSBM_DDL_FILE) as f:
+        ddl = f.read()
+    script = ('DROP SCHEMA IF EXISTS ssbm, ssbm_gcache, ssbm_arrow CASCADE;\n'
+              'CREATE SCHEMA ssbm;\n'
+              'SET search_path = ssbm;\n' + ddl + '\n')
+    for tname, opt in SSBM_TABLES:
+        script += ("\\copy %s FROM PROGRAM '%s -q -s%d -X -T%s' "
+                   "DELIMITER '|'\n" % (tname, dbgen, args.scale, opt))
+    script += 'VACUUM ANALYZE;\n'
+    psql(args.dbname, script)
+
+    if 'gcache' in variants:
+        elog('setting up GPU Cache variant')
+        setup_gpu_cache(args.dbname, 'ssbm', 'ssbm_gcache',
+                        [('lineorder', nrows)])
+
+    if 'arrow' in variants:
+        elog('setting up Arrow_Fdw variant')
+        setup_arrow_fdw(args.dbname, 'ssbm', 'ssbm_arrow', ['lineorder'],
+                        lookup_command('pg2arrow', args.pg2arrow),
+                        os.path.abspath(args.arrow_dir or SSBM_LOG_DIR),
+                        'sf%d' % args.scale)
+
+def main():
+    parser = argparse.ArgumentParser(description='SSBM benchmark of PG-Strom')
+    sub = parser.add_subparsers(dest='command')
+
+    p = sub.add_parser('load', help='generate and load the dataset')
+    p.add_argument('-d', '--dbname', default='ssbm')
+    p.add_argument('-s', '--scale', type=int, default=10)
+    p.add_argument('-V', '--variants', default='heap,gcache,arrow')
+    p.add_argument('--dbgen', help='path to dbgen-ssbm')
+    p.add_argument('--pg2arrow', help='path to pg2arrow')
+    p.add_argument('--arrow-dir', help='directory to put Arrow file')
+
+    p = sub.add_parser('run', help='run the queries')
+    add_run_arguments(p, 'ssbm', 'heap,gcache,arrow')
+
+    p = sub.add_parser('compare', help='compare two results')
+    add_compare_arguments(p)
+
+    args = parser.parse_args()
+    try:
+        if args.command == 'load':
+            ssbm_load(args)
+        elif args.command == 'run':
+            run_benchmark(args, 'ssbm', SSBM_VARIANTS,
+                          parse_queries(SSBM_QUERY_FILE, r'Q\d_\d'),
+                          SSBM_LOG_DIR)
+        elif args.command == 'compare':
+            return compare_results(args)
+        else:
+            parser.print_help()
+            return 1
+    except (RuntimeError, subprocess.CalledProcessError) as e:
+        elog('ssbm-bench: %s' % e)
+        return 1
+    return 0
+
+if __name__ == '__main__':
+    sys.exit(main())
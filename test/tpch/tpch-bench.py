@@ -0,0 +1,143 @@
+#!/usr/bin/env python3
+#
+# tpch-bench.py - TPC-H benchmark harness of PG-Strom
+#
+# Usage:
+#   tpch-bench.py load    --dbgen PATH [-d DBNAME] [-s SCALE] [-V VARIANTS]
+#                         [--pg2arrow PATH] [--arrow-dir DIR] [--work-dir DIR]
+#   tpch-bench.py run     [-d DBNAME] [-V VARIANTS] [-e ENGINES] [-q QUERIES]
+#                         [-n NLOOPS] [--cold] [--restart-cmd CMD] [-o FILE]
+#                         [--label LABEL]
+#   tpch-bench.py compare BASE.json NEW.json [--threshold PCT] [--min-diff MS]
+#
+# Unlike SSBM, dbgen of TPC-H is not bundled because of its license terms.
+# Build it from the TPC-H tools distributed by TPC, then give its path with
+# --dbgen; dists.dss must be located on the same directory.
+#
+# 'load' generates the TPC-H dataset, then sets up three variants of the
+# lineitem and orders tables; 'heap' (regular PostgreSQL table), 'gcache'
+# (heap table with GPU Cache) and 'arrow' (Arrow_Fdw foreign table).
+# Other tables are shared by all the variants on the 'tpch' schema.
+#
+# 'run' and 'compare' are equivalent to ssbm-bench.py, but on the 22 queries
+# of TPC-H. The result is saved on ~/tpch-logs unless -o is given.
+#
+# Copyright 2011-2021 (C) KaiGai Kohei <kaigai@kaigai.gr.jp>
+# Copyright 2014-2021 (C) PG-Strom Developers Team
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the PostgreSQL License.
+#
+import argparse
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+
+TPCH_DIR = os.path.dirname(os.path.abspath(__file__))
+sys.path.insert(0, os.path.join(TPCH_DIR, '..'))
+from benchlib import *
+
+TPCH_DDL_FILE = os.path.join(TPCH_DIR, 'tpch-ddl.sql')
+TPCH_QUERY_FILE = os.path.join(TPCH_DIR, 'tpch-queries.sql')
+TPCH_LOG_DIR = os.path.expanduser('~/tpch-logs')
+
+TPCH_VARIANTS = {
+    'heap'   : 'tpch',
+    'gcache' : 'tpch_gcache, tpch',
+    'arrow'  : 'tpch_arrow, tpch',
+}
+TPCH_TABLES = ['region', 'nation', 'part', 'supplier',
+               'partsupp', 'customer', 'orders', 'lineitem']
+# fact tables to be replaced by the variants, and number of rows per SF
+TPCH_FACT_TABLES = [('lineitem', 6000000),
+                    ('orders',   1500000)]
+
+#
+# load command
+#
+def tpch_load(args):
+    variants = parse_choices(args.variants, TPCH_VARIANTS, 'variant')
+    dbgen = lookup_command('dbgen', args.dbgen)
+    work_dir = tempfile.mkdtemp(prefix='tpch-', dir=args.work_dir)
+
+    try:
+        elog('generating TPC-H dataset (scale factor=%d) on %s'
+             % (args.scale, work_dir))
+        env = dict(os.environ,
+                   DSS_CONFIG=os.path.dirname(dbgen),
+                   DSS_PATH=work_dir)
+        subprocess.run([dbgen, '-f', '-s', str(args.scale)],
+                       cwd=work_dir, env=env, check=True)
+
+        elog('loading TPC-H dataset on %s' % args.dbname)
+        with open(TPCH_DDL_FILE) as f:
+            ddl = f.read()
+        script = ('DROP SCHEMA IF EXISTS tpch, tpch_gcache, tpch_arrow CASCADE;\n'
+                  'CREATE SCHEMA tpch;\n'
+                  'SET search_path = tpch;\n' + ddl + '\n')
+        for tname in TPCH_TABLES:
+            fname = os.path.join(work_dir, '%s.tbl' % tname)
+            # dbgen puts a delimiter at the end of line also
+            subprocess.run(['sed', '-i', 's/|$//', fname], check=True)
+            script += "\\copy %s FROM '%s' DELIMITER '|'\n" % (tname, fname)
+        script += 'VACUUM ANALYZE;\n'
+        psql(args.dbname, script)
+    finally:
+        shutil.rmtree(work_dir, ignore_errors=True)
+
+    if 'gcache' in variants:
+        elog('setting up GPU Cache variant')
+        setup_gpu_cache(args.dbname, 'tpch', 'tpch_gcache',
+                        [(tname, nrows * args.scale)
+                         for tname, nrows in TPCH_FACT_TABLES])
+
+    if 'arrow' in variants:
+        elog('setting up Arrow_Fdw variant')
+        setup_arrow_fdw(args.dbname, 'tpch', 'tpch_arrow',
+                        [tname for tname, _ in TPCH_FACT_TABLES],
+                        lookup_command('pg2arrow', args.pg2arrow),
+                        os.path.abspath(args.arrow_dir or TPCH_LOG_DIR),
+                        'sf%d' % args.scale)
+
+def main():
+    parser = argparse.ArgumentParser(description='TPC-H benchmark of PG-Strom')
+    sub = parser.add_subparsers(dest='command')
+
+    p = sub.add_parser('load', help='generate and load the dataset')
+    p.add_argument('-d', '--dbname', default='tpch')
+    p.add_argument('-s', '--scale', type=int, default=10)
+    p.add_argument('-V', '--variants', default='heap,gcache,arrow')
+    p.add_argument('--dbgen', required=True,
+                   help='path to dbgen of the TPC-H tools')
+    p.add_argument('--pg2arrow', help='path to pg2arrow')
+    p.add_argument('--arrow-dir', help='directory to put Arrow files')
+    p.add_argument('--work-dir', help='directory to put generated files')
+
+    p = sub.add_parser('run', help='run the queries')
+    add_run_arguments(p, 'tpch', 'heap,gcache,arrow')
+
+    p = sub.add_parser('compare', help='compare two results')
+    add_compare_arguments(p)
+
+    args = parser.parse_args()
+    try:
+        if args.command == 'load':
+            tpch_load(args)
+        elif args.command == 'run':
+            run_benchmark(args, 'tpch', TPCH_VARIANTS,
+                          parse_queries(TPCH_QUERY_FILE, r'Q\d+'),
+                          TPCH_LOG_DIR)
+        elif args.command == 'compare':
+            return compare_results(args)
+        else:
+            parser.print_help()
+            return 1
+    except (RuntimeError, subprocess.CalledProcessError) as e:
+        elog('tpch-bench: %s' % e)
+        return 1
+    return 0
+
+if __name__ == '__main__':
+    sys.exit(main())
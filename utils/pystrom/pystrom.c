@@ -1,6 +1,7 @@
 #include <Python.h>
 #include <cuda_runtime_api.h>
 #include "cuda_common.h"
+#include "cuda_gcache.h"
 
 /* supported data types */
 #define BOOLOID 16
@@ -14,9 +15,6 @@ static PyObject *
 create_ndarray_normal(cl_uint type_oid, cl_ulong nitems, cl_ulong nattrs)
 {
 	PyObject   *mod_cupy = NULL;
-	PyObject   *mod_core = NULL;
-	PyObject   *mod_dtype = NULL;
-	PyObject   *dtype = NULL;
 	PyObject   *result = NULL;
 	const char *type_code;
 
@@ -51,35 +49,14 @@ create_ndarray_normal(cl_uint type_oid, cl_ulong nitems, cl_ulong nattrs)
 		PyErr_Format(PyExc_SystemError, "could not import 'cupy' module");
 		goto bailout;
 	}
-	mod_core = PyObject_GetAttrString(mod_cupy, "core");
-	if (!mod_core)
-	{
-		PyErr_Format(PyExc_SystemError, "cupy.core was not found");
-		goto bailout;
-	}
-	mod_dtype = PyObject_GetAttrString(mod_core, "_dtype");
-	if (!mod_dtype)
-	{
-		PyErr_Format(PyExc_SystemError,
-					 "cupy.core._dtype was not found");
-		goto bailout;
-	}
-	dtype = PyObject_CallMethod(mod_dtype, "get_dtype",
-								"(s)", type_code);
-	if (!dtype)
-		goto bailout;
-
-	result = PyObject_CallMethod(mod_core, "ndarray",
-								 "(k k) O O s",
+	result = PyObject_CallMethod(mod_cupy, "ndarray",
+								 "(k k) s O O s",
 								 nitems, nattrs,
-								 dtype,
+								 type_code,
+								 Py_None,
 								 Py_None,
 								 "F");
 bailout:
-	if (dtype)
-		Py_DECREF(dtype);
-	if (mod_core)
-		Py_DECREF(mod_core);
 	if (mod_cupy)
 		Py_DECREF(mod_cupy);
 	return result;
@@ -129,7 +106,7 @@ setup_ndarray_from_kds(PyObject *ndarray,
 	}
 	dest = (char *)PyLong_AsLong(devptr);
 
-	/* copy from Gstore_fdw to ndarray buffer */
+	/* copy from GPU cache to ndarray buffer */
 	switch (type_oid)
 	{
 		case BOOLOID:
@@ -165,14 +142,14 @@ setup_ndarray_from_kds(PyObject *ndarray,
 
 		assert(cmeta->atttypid == type_oid &&
 			   cmeta->attlen == type_len);
-		offset = __kds_unpack(cmeta->va_offset);
-		length = __kds_unpack(cmeta->va_length);
+		offset = __kds_unpack(cmeta->values_offset);
+		length = __kds_unpack(cmeta->values_length);
 		nbytes = type_len * nitems;
 		if (length < nbytes)
 		{
 			cudaStreamSynchronize(0);
 			PyErr_Format(PyExc_SystemError,
-						 "Bug? values array of Gstore_fdw is too short");
+						 "Bug? values array of GPU cache is too short");
 			goto bailout;
 		}
 		rc = cudaMemcpyAsync(dest, m_kds + offset, nbytes,
@@ -199,11 +176,11 @@ bailout:
 
 static int
 check_ndarray_column(kern_colmeta *cmeta, size_t nitems,
-					 NameData *cname, cl_uint *p_type_oid)
+					 cl_uint *p_type_oid)
 {
 	cl_uint		type_oid = *p_type_oid;
-	size_t		va_offset = __kds_unpack(cmeta->va_offset);
-	size_t		va_length = __kds_unpack(cmeta->va_length);
+	size_t		values_offset = __kds_unpack(cmeta->values_offset);
+	size_t		values_length = __kds_unpack(cmeta->values_length);
 	size_t		dataLen;
 
 	/* check data type consistency */
@@ -228,10 +205,11 @@ check_ndarray_column(kern_colmeta *cmeta, size_t nitems,
 	*p_type_oid = type_oid;
 
 	/* other sanity checks */
-	if (va_offset == 0)
+	if (values_offset == 0)
 	{
 		PyErr_Format(PyExc_ValueError,
-					 "column '%s' contains no data", cname->data);
+					 "column '%s' is not cached on the GPU cache",
+					 cmeta->attname.data);
 		return 1;
 	}
 
@@ -241,45 +219,190 @@ check_ndarray_column(kern_colmeta *cmeta, size_t nitems,
 	{
 		PyErr_Format(PyExc_ValueError,
 					 "column '%s' is not fixed length numeric values",
-					 cname->data);
+					 cmeta->attname.data);
 		return 1;
 	}
 
-	dataLen = MAXALIGN(cmeta->attlen * nitems);
-	if (va_length < dataLen)
+	dataLen = cmeta->attlen * nitems;
+	if (values_length < dataLen)
 	{
 		PyErr_Format(PyExc_ValueError,
 					 "Bug? column '%s' is shorter than expected length",
-					 cname->data);
+					 cmeta->attname.data);
 		return 1;
 	}
-	if (va_length > dataLen)
+	return 0;
+}
+
+/*
+ * setup_visibility_mask
+ *
+ * GPU cache keeps deleted or not-yet-committed rows in the main buffer,
+ * until its compaction. So, we build a mask of the visible rows using the
+ * system column, and also check NULLs of the visible rows.
+ */
+static int
+setup_visibility_mask(const char *m_kds,		/* device pointer */
+					  kern_data_store *kds,		/* host buffer */
+					  cl_int nattrs, cl_int *attIndex,
+					  cl_bool *mask, cl_uint *p_nvisibles)
+{
+	kern_colmeta   *smeta = &kds->colmeta[kds->nr_colmeta - 1];
+	GpuCacheSysattr *sysattr = NULL;
+	cl_uchar	   *nullmap = NULL;
+	size_t			nitems = kds->nitems;
+	size_t			nbytes;
+	cl_uint			nvisibles = 0;
+	cl_uint			i, j;
+	cudaError_t		rc;
+	int				retval = 1;
+
+	nbytes = sizeof(GpuCacheSysattr) * nitems;
+	if (smeta->attlen != sizeof(GpuCacheSysattr) ||
+		__kds_unpack(smeta->values_length) < nbytes)
 	{
-		PyErr_Format(PyExc_ValueError,
-					 "column '%s' contains NULLs",
-					 cname->data);
-		return 1;
+		PyErr_Format(PyExc_SystemError,
+					 "Bug? system column of GPU cache is corrupted");
+		goto bailout;
 	}
-	return 0;
+	sysattr = malloc(nbytes + 1);
+	if (!sysattr)
+	{
+		PyErr_Format(PyExc_SystemError, "Out of memory: %m");
+		goto bailout;
+	}
+	rc = cudaMemcpy(sysattr, m_kds + __kds_unpack(smeta->values_offset),
+					nbytes, cudaMemcpyDeviceToHost);
+	if (rc != cudaSuccess)
+	{
+		PyErr_Format(PyExc_SystemError,
+					 "failed on cudaMemcpy: %s",
+					 cudaGetErrorString(rc));
+		goto bailout;
+	}
+	/* only committed and not deleted rows are visible */
+	for (i=0; i < nitems; i++)
+	{
+		mask[i] = (sysattr[i].xmin == 2 &&	/* FrozenTransactionId */
+				   sysattr[i].xmax == 0);	/* InvalidTransactionId */
+		if (mask[i])
+			nvisibles++;
+	}
+
+	/* visible rows must not contain NULLs */
+	nbytes = (nitems + 7) / 8;
+	nullmap = malloc(nbytes + 1);
+	if (!nullmap)
+	{
+		PyErr_Format(PyExc_SystemError, "Out of memory: %m");
+		goto bailout;
+	}
+	for (j=0; j < nattrs; j++)
+	{
+		kern_colmeta   *cmeta = &kds->colmeta[attIndex[j]];
+
+		if (cmeta->nullmap_offset == 0)
+			continue;
+		rc = cudaMemcpy(nullmap, m_kds + __kds_unpack(cmeta->nullmap_offset),
+						nbytes, cudaMemcpyDeviceToHost);
+		if (rc != cudaSuccess)
+		{
+			PyErr_Format(PyExc_SystemError,
+						 "failed on cudaMemcpy: %s",
+						 cudaGetErrorString(rc));
+			goto bailout;
+		}
+		for (i=0; i < nitems; i++)
+		{
+			if (mask[i] && (nullmap[i>>3] & (1 << (i & 7))) == 0)
+			{
+				PyErr_Format(PyExc_ValueError,
+							 "column '%s' contains NULLs",
+							 cmeta->attname.data);
+				goto bailout;
+			}
+		}
+	}
+	*p_nvisibles = nvisibles;
+	retval = 0;
+bailout:
+	if (nullmap)
+		free(nullmap);
+	if (sysattr)
+		free(sysattr);
+	return retval;
 }
 
+/*
+ * apply_visibility_mask
+ *
+ * It returns a new ndarray that contains only visible rows, by boolean
+ * indexing on the device.
+ */
+static PyObject *
+apply_visibility_mask(PyObject *ndarray, cl_bool *mask, size_t nitems)
+{
+	PyObject   *mod_numpy = NULL;
+	PyObject   *mod_cupy = NULL;
+	PyObject   *h_bytes = NULL;
+	PyObject   *h_mask = NULL;
+	PyObject   *d_mask = NULL;
+	PyObject   *result = NULL;
+
+	mod_numpy = PyImport_ImportModule("numpy");
+	if (!mod_numpy)
+	{
+		PyErr_Format(PyExc_SystemError, "could not import 'numpy' module");
+		goto bailout;
+	}
+	mod_cupy = PyImport_ImportModule("cupy");
+	if (!mod_cupy)
+	{
+		PyErr_Format(PyExc_SystemError, "could not import 'cupy' module");
+		goto bailout;
+	}
+	h_bytes = PyBytes_FromStringAndSize((const char *)mask, nitems);
+	if (!h_bytes)
+		goto bailout;
+	h_mask = PyObject_CallMethod(mod_numpy, "frombuffer", "(O s)",
+								 h_bytes, "?");
+	if (!h_mask)
+		goto bailout;
+	d_mask = PyObject_CallMethod(mod_cupy, "asarray", "(O)", h_mask);
+	if (!d_mask)
+		goto bailout;
+	result = PyObject_GetItem(ndarray, d_mask);
+bailout:
+	if (d_mask)
+		Py_DECREF(d_mask);
+	if (h_mask)
+		Py_DECREF(h_mask);
+	if (h_bytes)
+		Py_DECREF(h_bytes);
+	if (mod_cupy)
+		Py_DECREF(mod_cupy);
+	if (mod_numpy)
+		Py_DECREF(mod_numpy);
+	return result;
+}
 
 static PyObject *
 pystrom_ipc_import(PyObject *self, PyObject *args)
 {
 	Py_buffer		ipc_token;
-	gstoreIpcHandle gs_handle;
+	GpuCacheIpcHandle gc_handle;
 	cudaIpcMemHandle_t ipc_handle;
 	PyObject	   *attnameList = NULL;
 	cudaError_t		rc;
-	void		   *m_devptr;
+	void		   *m_devptr = NULL;
 	char			__buffer[KDS_LEAST_LENGTH];
 	char		   *buffer = __buffer;
 	size_t			length = KDS_LEAST_LENGTH;
 	kern_data_store *kds;
-	NameData	   *attNames;
 	cl_int		   *attIndex = NULL;
+	cl_bool		   *mask = NULL;
 	cl_uint			i, j, nattrs = 0;
+	cl_uint			nvisibles = 0;
 	cl_uint			type_oid = 0;
 	PyObject	   *ndarray = NULL;
 
@@ -287,28 +410,39 @@ pystrom_ipc_import(PyObject *self, PyObject *args)
 						 &ipc_token,
 						 &PyList_Type,
 						 &attnameList))
-		Py_RETURN_NONE;
+		return NULL;
 
 	/*
 	 * Import GPU device memory using IPC memory handle
 	 */
-	if (ipc_token.len != sizeof(gstoreIpcHandle))
+	if (ipc_token.len != sizeof(GpuCacheIpcHandle))
 	{
 		PyErr_Format(PyExc_ValueError,
-					 "IPC token length mismatch: %d of %d",
-					 ipc_token.len, sizeof(gstoreIpcHandle));
-		Py_RETURN_NONE;
+					 "IPC token length mismatch: %zd of %zu",
+					 ipc_token.len, sizeof(GpuCacheIpcHandle));
+		PyBuffer_Release(&ipc_token);
+		return NULL;
 	}
-	memcpy(&gs_handle, ipc_token.buf, ipc_token.len);
-	if (VARSIZE(&gs_handle) != sizeof(gs_handle) ||
-		gs_handle.magic != GSTORE_IPC_HANDLE_MAGIC)
+	memcpy(&gc_handle, ipc_token.buf, ipc_token.len);
+	PyBuffer_Release(&ipc_token);
+	if (VARSIZE(&gc_handle) != sizeof(gc_handle) ||
+		gc_handle.magic != GPUCACHE_IPC_HANDLE_MAGIC)
 	{
 		PyErr_Format(PyExc_ValueError,
 					 "IPC token corruption (vl_len: %d, magic: %08x)",
-					 VARSIZE(&gs_handle), gs_handle.magic);
-		Py_RETURN_NONE;
+					 VARSIZE(&gc_handle), gc_handle.magic);
+		return NULL;
+	}
+	rc = cudaSetDevice(gc_handle.cuda_device_id);
+	if (rc != cudaSuccess)
+	{
+		PyErr_Format(PyExc_SystemError,
+					 "Failed on cudaSetDevice(%d): %s",
+					 gc_handle.cuda_device_id,
+					 cudaGetErrorString(rc));
+		return NULL;
 	}
-	memcpy(&ipc_handle, gs_handle.ipc_handle, sizeof(cudaIpcMemHandle_t));
+	memcpy(&ipc_handle, gc_handle.ipc_mhandle, sizeof(cudaIpcMemHandle_t));
 	rc = cudaIpcOpenMemHandle(&m_devptr, ipc_handle,
 							  cudaIpcMemLazyEnablePeerAccess);
 	if (rc != cudaSuccess)
@@ -316,7 +450,7 @@ pystrom_ipc_import(PyObject *self, PyObject *args)
 		PyErr_Format(PyExc_SystemError,
 					 "Failed on cudaIpcOpenMemHandle: %s",
 					 cudaGetErrorString(rc));
-		Py_RETURN_NONE;
+		return NULL;
 	}
 
 memcpy_retry:
@@ -342,12 +476,12 @@ memcpy_retry:
 		}
 		goto memcpy_retry;
 	}
-
-	attNames = KERN_DATA_STORE_ATTNAMES(kds);
-	if (!attNames)
+	if (kds->format != KDS_FORMAT_COLUMN ||
+		kds->table_oid != gc_handle.table_oid ||
+		kds->length > gc_handle.main_size)
 	{
 		PyErr_Format(PyExc_SystemError,
-					 "Bug? Gstore_fdw has no attribute names");
+					 "Bug? IPC token does not point a valid GPU cache");
 		goto bailout;
 	}
 
@@ -367,7 +501,9 @@ memcpy_retry:
 
 			for (j=0; j < kds->ncols; j++)
 			{
-				PyObject   *cname = PyUnicode_FromString(attNames[j].data);
+				PyObject   *cname;
+
+				cname = PyUnicode_FromString(kds->colmeta[j].attname.data);
 				if (PyUnicode_Compare(aname, cname) == 0)
 				{
 					cmeta = &kds->colmeta[j];
@@ -383,8 +519,7 @@ memcpy_retry:
 							 PyUnicode_AsUTF8(aname));
 				goto bailout;
 			}
-			if (check_ndarray_column(cmeta, kds->nitems,
-									 &attNames[j], &type_oid))
+			if (check_ndarray_column(cmeta, kds->nitems, &type_oid))
 				goto bailout;
 
 			attIndex[i] = j;
@@ -402,23 +537,37 @@ memcpy_retry:
 		{
 			kern_colmeta   *cmeta = &kds->colmeta[j];
 
-			/* skip system column */
-			if (cmeta->attnum < 0)
+			/* skip system and not-cached columns */
+			if (cmeta->attnum < 0 || cmeta->values_offset == 0)
 				continue;
 
-			if (check_ndarray_column(cmeta, kds->nitems,
-									 &attNames[j], &type_oid))
+			if (check_ndarray_column(cmeta, kds->nitems, &type_oid))
 				goto bailout;
 
 			attIndex[i++] = j;
 		}
 		nattrs = i;
 	}
+	if (nattrs == 0)
+	{
+		PyErr_Format(PyExc_ValueError, "no columns to be imported");
+		goto bailout;
+	}
+	/* visibility checks */
+	mask = calloc(kds->nitems + 1, sizeof(cl_bool));
+	if (!mask)
+	{
+		PyErr_Format(PyExc_SystemError, "Out of memory: %m");
+		goto bailout;
+	}
+	if (setup_visibility_mask(m_devptr, kds, nattrs, attIndex,
+							  mask, &nvisibles))
+		goto bailout;
 	/* creation of ndarray */
 	ndarray = create_ndarray_normal(type_oid, kds->nitems, nattrs);
 	if (!ndarray)
 		goto bailout;
-	/* copy from the Gstore_fdw */
+	/* copy from the GPU cache (device-to-device) */
 	if (setup_ndarray_from_kds(ndarray, m_devptr,
 							   kds, type_oid, nattrs, attIndex))
 	{
@@ -426,27 +575,37 @@ memcpy_retry:
 		ndarray = NULL;
 		goto bailout;
 	}
+	/* remove invisible rows, if any */
+	if (nvisibles < kds->nitems)
+	{
+		PyObject   *temp = apply_visibility_mask(ndarray, mask, kds->nitems);
+
+		Py_DECREF(ndarray);
+		ndarray = temp;
+	}
 
 	/* ok, release temporary resources */
 bailout:
+	if (mask)
+		free(mask);
 	if (attIndex)
 		free(attIndex);
 	if (buffer != __buffer)
 		free(buffer);
 
 	rc = cudaIpcCloseMemHandle(m_devptr);
-	if (rc != cudaSuccess)
+	if (rc != cudaSuccess && ndarray)
 	{
+		Py_DECREF(ndarray);
+		ndarray = NULL;
 		PyErr_Format(PyExc_SystemError, "failed on cudaIpcCloseMemHandle: %s",
 					 cudaGetErrorString(rc));
 	}
-	if (!ndarray)
-		Py_RETURN_NONE;
 	return ndarray;
 }
 
 static PyMethodDef pystrom_methods[] = {
-	{"ipc_import", (PyCFunction)pystrom_ipc_import, METH_VARARGS, "Import Gstore_fdw as cupy.core.ndarray"},
+	{"ipc_import", (PyCFunction)pystrom_ipc_import, METH_VARARGS, "Import GPU cache as cupy.ndarray"},
 	{NULL, NULL, 0, NULL},
 };
 
@@ -3,7 +3,7 @@ import pystrom
 
 conn = psycopg2.connect("host=localhost dbname=postgres")
 curr = conn.cursor()
-curr.execute("select gstore_export_ipchandle('ft')::bytea")
+curr.execute("select pgstrom.gpucache_export_ipchandle('ft')")
 row = curr.fetchone()
 conn.close()
 